@@ -43,6 +43,7 @@ template <> struct AccumulateType<char, false> { using type = int64_t; };
 template <> struct AccumulateType<int16_t, false> { using type = int64_t; };
 template <> struct AccumulateType<int32_t, false> { using type = int64_t; };
 template <> struct AccumulateType<int64_t, false> { using type = int64_t; };
+template <> struct AccumulateType<bool, false> {using type = int64_t; };
 
 template<typename T, bool is_cuda>
 using acc_type = typename AccumulateType<T, is_cuda>::type;
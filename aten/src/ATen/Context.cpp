@@ -67,6 +67,15 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+int64_t Context::benchmarkWorkspaceLimitCuDNN() const {
+  return benchmark_workspace_limit_cudnn;
+}
+
+void Context::setBenchmarkWorkspaceLimitCuDNN(int64_t limit) {
+  TORCH_CHECK(limit >= 0, "cuDNN benchmark workspace limit must be non-negative, but got ", limit);
+  benchmark_workspace_limit_cudnn = limit;
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
@@ -104,6 +104,10 @@ class CAFFE2_API Context {
   void setUserEnabledMkldnn(bool e);
   bool benchmarkCuDNN() const;
   void setBenchmarkCuDNN(bool);
+  // Upper bound, in bytes, on the workspace of the algorithms tried when
+  // benchmarking cuDNN convolutions; 0 means no limit.
+  int64_t benchmarkWorkspaceLimitCuDNN() const;
+  void setBenchmarkWorkspaceLimitCuDNN(int64_t);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
   at::QEngine qEngine() const;
@@ -126,6 +130,7 @@ class CAFFE2_API Context {
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  int64_t benchmark_workspace_limit_cudnn = 0;
   bool enabled_mkldnn = true;
   c10::optional<at::QEngine> quantized_engine = c10::nullopt;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
@@ -3,6 +3,10 @@
 #include <ATen/Parallel.h>
 #include <c10/core/thread_pool.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 namespace at {
 
 class CAFFE2_API PTThreadPool : public c10::ThreadPool {
@@ -16,4 +20,20 @@ public:
       }) {}
 };
 
+// Thread pool whose workers are spread evenly across `num_numa_nodes` NUMA
+// nodes: worker i of n is bound (CPU and memory) to node i * num_numa_nodes / n.
+class CAFFE2_API PTNUMAThreadPool : public c10::ThreadPool {
+public:
+  explicit PTNUMAThreadPool(
+      int pool_size,
+      int num_numa_nodes)
+    : c10::ThreadPool(pool_size, -1, [pool_size, num_numa_nodes,
+          next_worker = std::make_shared<std::atomic<int>>(0)](){
+        c10::setThreadName("PTThreadPool");
+        int worker = (*next_worker)++;
+        c10::NUMABind(worker * num_numa_nodes / std::max(pool_size, 1));
+        at::init_num_threads();
+      }) {}
+};
+
 } // namespace at
@@ -127,6 +127,8 @@ CAFFE2_API int intraop_default_num_threads();
 
 } // namespace at
 
+#include <ATen/ParallelAutotune.h>
+
 #if AT_PARALLEL_OPENMP
 #include <ATen/ParallelOpenMP.h>
 #elif AT_PARALLEL_NATIVE
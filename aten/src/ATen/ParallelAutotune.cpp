@@ -0,0 +1,146 @@
+#include <ATen/Parallel.h>
+#include <ATen/ParallelAutotune.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace at {
+
+namespace {
+
+const char* kFileHeader = "# ATen grain size autotuning v1";
+
+// Weight of a new sample in the running estimate.
+constexpr double kSampleWeight = 0.125;
+
+std::atomic<bool> autotuning_enabled{[]() {
+  const char* value = std::getenv("ATEN_AUTOTUNE_GRAIN_SIZE");
+  return value != nullptr && std::string(value) != "0";
+}()};
+
+struct Registry {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<internal::AutotuneCallSite>>
+      sites;
+
+  internal::AutotuneCallSite* get(const std::string& name) {
+    auto& site = sites[name];
+    if (!site) {
+      site.reset(new internal::AutotuneCallSite());
+    }
+    return site.get();
+  }
+};
+
+Registry& registry() {
+  // Leaked, so that parallel regions running during static destruction can
+  // still use their call sites.
+  static Registry* registry_ = new Registry();
+  return *registry_;
+}
+
+} // namespace
+
+void set_grain_size_autotuning(bool enabled) {
+  autotuning_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool get_grain_size_autotuning() {
+  return autotuning_enabled.load(std::memory_order_relaxed);
+}
+
+void save_grain_size_autotuning(const std::string& filename) {
+  std::ofstream out(filename);
+  TORCH_CHECK(out, "Cannot open ", filename, " for writing");
+  out.precision(std::numeric_limits<double>::max_digits10);
+  out << kFileHeader << "\n";
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (const auto& entry : reg.sites) {
+    if (entry.second->num_samples.load() > 0) {
+      out << entry.second->ns_per_element.load() << " " << entry.first << "\n";
+    }
+  }
+  TORCH_CHECK(out, "Failed to write ", filename);
+}
+
+void load_grain_size_autotuning(const std::string& filename) {
+  std::ifstream in(filename);
+  TORCH_CHECK(in, "Cannot open ", filename, " for reading");
+  std::string line;
+  TORCH_CHECK(
+      std::getline(in, line) && line == kFileHeader,
+      filename, " is not a grain size autotuning file");
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    double ns_per_element;
+    std::string name;
+    TORCH_CHECK(
+        fields >> ns_per_element >> name && ns_per_element >= 0,
+        "Malformed line in ", filename, ": ", line);
+    internal::AutotuneCallSite* site = reg.get(name);
+    site->ns_per_element.store(ns_per_element);
+    site->num_samples.store(1);
+  }
+}
+
+namespace internal {
+
+AutotuneCallSite* register_autotune_call_site(const char* name) {
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  return reg.get(name);
+}
+
+int64_t AutotuneCallSite::grain_size(int64_t numel, int64_t grain_size) const {
+  double cost = ns_per_element.load(std::memory_order_relaxed);
+  if (num_samples.load(std::memory_order_relaxed) == 0 || cost <= 0) {
+    return grain_size;
+  }
+  // Never split into more than a few tasks per thread: parallel_reduce
+  // allocates one partial result per grain.
+  int64_t min_grain_size = divup(numel, 4 * (int64_t)get_num_threads());
+  double tuned = std::min(
+      kAutotuneTargetTaskNs / cost,
+      (double)std::numeric_limits<int64_t>::max() / 2);
+  return std::max({(int64_t)tuned, min_grain_size, (int64_t)1});
+}
+
+void AutotuneCallSite::record(int64_t numel, int64_t grain_size, int64_t ns) {
+  if (numel <= 0) {
+    return;
+  }
+  // Charge the elapsed time to every thread that took part, so that the
+  // estimate is in thread-nanoseconds per element and includes the cost of
+  // waking up and synchronizing the threads.
+  int64_t num_tasks = 1;
+  int num_threads = get_num_threads();
+  bool nested_serial = in_parallel_region();
+#if AT_PARALLEL_NATIVE_WS
+  nested_serial = false;
+#endif
+  if (numel > grain_size && num_threads > 1 && !nested_serial) {
+    num_tasks = std::min<int64_t>(
+        num_threads, grain_size > 0 ? divup(numel, grain_size) : numel);
+  }
+  double sample = (double)ns * num_tasks / numel;
+  double cost = ns_per_element.load(std::memory_order_relaxed);
+  // Concurrent updates may lose a sample, which is fine for an estimate.
+  if (num_samples.fetch_add(1, std::memory_order_relaxed) == 0) {
+    cost = sample;
+  } else {
+    cost += kSampleWeight * (sample - cost);
+  }
+  ns_per_element.store(cost, std::memory_order_relaxed);
+}
+
+} // namespace internal
+} // namespace at
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+namespace at {
+
+// Grain size autotuning.
+//
+// When enabled, every call site of parallel_for and parallel_reduce (i.e.
+// every distinct loop body type) keeps a running estimate of how long one
+// element of its loop takes, measured from its own calls. The grain size
+// passed by the kernel is then replaced by the number of elements that take
+// about internal::kAutotuneTargetTaskNs, so cheap loops over mid-sized ranges
+// stay on the calling thread instead of paying for waking up the pool, and
+// expensive loops are split over more threads than their hard-coded grain
+// size would allow.
+//
+// Autotuning is disabled by default. Enable it with
+// set_grain_size_autotuning(true) or by setting the environment variable
+// ATEN_AUTOTUNE_GRAIN_SIZE=1. The estimates can be saved to a file and loaded
+// into another process running the same binary, which then starts out tuned.
+
+CAFFE2_API void set_grain_size_autotuning(bool enabled);
+CAFFE2_API bool get_grain_size_autotuning();
+
+// Writes the per-call-site estimates collected so far to `filename`.
+CAFFE2_API void save_grain_size_autotuning(const std::string& filename);
+// Reads estimates written by save_grain_size_autotuning(). Loaded estimates
+// replace the ones of matching call sites.
+CAFFE2_API void load_grain_size_autotuning(const std::string& filename);
+
+namespace internal {
+
+// Cost of a task that is worth handing to another thread.
+constexpr int64_t kAutotuneTargetTaskNs = 20000;
+
+class CAFFE2_API AutotuneCallSite {
+ public:
+  // Grain size to use instead of `grain_size` for a range of `numel` elements.
+  int64_t grain_size(int64_t numel, int64_t grain_size) const;
+
+  // Records that `numel` elements took `ns` nanoseconds when run with
+  // `grain_size`.
+  void record(int64_t numel, int64_t grain_size, int64_t ns);
+
+  std::atomic<double> ns_per_element{0.0};
+  std::atomic<int64_t> num_samples{0};
+};
+
+CAFFE2_API AutotuneCallSite* register_autotune_call_site(const char* name);
+
+// Picks the grain size of a parallel_for/parallel_reduce call and times it.
+// The type of the loop body identifies the call site.
+template <class F>
+class AutotuneScope {
+ public:
+  AutotuneScope(int64_t numel, int64_t grain_size)
+      : site_(nullptr), numel_(numel), grain_size_(grain_size) {
+    if (C10_LIKELY(!get_grain_size_autotuning())) {
+      return;
+    }
+    static AutotuneCallSite* site =
+        register_autotune_call_site(typeid(F).name());
+    site_ = site;
+    grain_size_ = site_->grain_size(numel, grain_size);
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  ~AutotuneScope() {
+    if (site_) {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_).count();
+      site_->record(numel_, grain_size_, ns);
+    }
+  }
+
+  AutotuneScope(const AutotuneScope&) = delete;
+  AutotuneScope& operator=(const AutotuneScope&) = delete;
+
+  int64_t grain_size() const {
+    return grain_size_;
+  }
+
+ private:
+  AutotuneCallSite* site_;
+  int64_t numel_;
+  int64_t grain_size_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace internal
+} // namespace at
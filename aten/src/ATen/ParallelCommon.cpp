@@ -64,6 +64,9 @@ std::string get_parallel_info() {
 
   ss << "std::thread::hardware_concurrency() : "
      << std::thread::hardware_concurrency() << std::endl;
+  ss << "NUMA nodes : "
+     << (c10::IsNUMAEnabled() ? std::to_string(c10::GetNumNUMANodes())
+                              : "[disabled]") << std::endl;
 
   ss << "Environment variables:" << std::endl;
   ss << "\tOMP_NUM_THREADS : "
@@ -74,6 +77,8 @@ std::string get_parallel_info() {
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
   ss << "OpenMP";
+  #elif AT_PARALLEL_NATIVE_WS
+  ss << "native work-stealing thread pool";
   #elif AT_PARALLEL_NATIVE
   ss << "native thread pool";
   #elif AT_PARALLEL_NATIVE_TBB
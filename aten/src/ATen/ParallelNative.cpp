@@ -1,6 +1,9 @@
 #if AT_PARALLEL_NATIVE
 #include <ATen/Parallel.h>
 #include <ATen/PTThreadPool.h>
+#if AT_PARALLEL_NATIVE_WS
+#include <ATen/WorkStealingThreadPool.h>
+#endif
 
 #ifndef C10_MOBILE
 #include <c10/core/thread_pool.h>
@@ -36,10 +39,6 @@ void _set_thread_num(size_t thread_num) {
   thread_num_ = thread_num;
 }
 
-void _unset_thread_num() {
-  thread_num_ = 0;
-}
-
 #ifndef C10_MOBILE
 
 const int NOT_SET = -1;
@@ -65,13 +64,34 @@ int _num_pool_threads(int nthreads) {
   return nthreads - 1;
 }
 
+std::shared_ptr<TaskThreadPoolBase> _create_intraop_pool() {
+  int pool_size = _num_pool_threads(num_intraop_threads.exchange(CONSUMED));
+  // When NUMA is enabled (--caffe2_cpu_numa_enabled), spread the workers over
+  // the NUMA nodes so that memory bandwidth scales with the number of sockets;
+  // memory allocated by a worker then lands on its node.
+  int num_numa_nodes = c10::GetNumNUMANodes();
+#if AT_PARALLEL_NATIVE_WS
+  return std::make_shared<WorkStealingThreadPool>(
+      pool_size, [pool_size, num_numa_nodes](size_t worker) {
+        c10::setThreadName("PTThreadPool");
+        if (num_numa_nodes > 1) {
+          c10::NUMABind(worker * num_numa_nodes / std::max(pool_size, 1));
+        }
+        at::init_num_threads();
+      });
+#endif
+  if (num_numa_nodes > 1) {
+    return std::make_shared<PTNUMAThreadPool>(pool_size, num_numa_nodes);
+  }
+  return ThreadPoolRegistry()->Create(
+      "C10",
+      /* device_id */ 0,
+      /* pool_size */ pool_size,
+      /* create_new */ true); // create a separate thread pool for intra-op
+}
+
 TaskThreadPoolBase& _get_intraop_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
+  static std::shared_ptr<TaskThreadPoolBase> pool = _create_intraop_pool();
   return *pool;
 }
 
@@ -100,16 +120,24 @@ void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
 }
 
 // RAII guard helps to support in_parallel_region() and get_thread_num() API.
+// Restores the previous values on destruction, since parallel regions nest
+// with the work-stealing pool.
 struct ParallelRegionGuard {
-  ParallelRegionGuard(int64_t task_id) {
+  ParallelRegionGuard(int64_t task_id)
+      : prev_in_parallel_region_(in_parallel_region_),
+        prev_thread_num_(thread_num_) {
     _set_thread_num(task_id);
     _set_in_parallel_region(true);
   }
 
   ~ParallelRegionGuard() {
-    _set_in_parallel_region(false);
-    _unset_thread_num();
+    _set_in_parallel_region(prev_in_parallel_region_);
+    _set_thread_num(prev_thread_num_);
   }
+
+ private:
+  bool prev_in_parallel_region_;
+  size_t prev_thread_num_;
 };
 
 } // namespace
@@ -125,6 +153,19 @@ void _parallel_run(
   std::tie(num_tasks, chunk_size) =
       internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
 
+#if AT_PARALLEL_NATIVE_WS && !defined(C10_MOBILE)
+  // Tasks are handed out to idle threads on demand; thread_id rather than
+  // task_id identifies the executing thread. Nested calls (from inside a
+  // task, or from an inter-op task running on the pool) are split across
+  // idle workers as well.
+  auto& pool = static_cast<WorkStealingThreadPool&>(_get_intraop_pool());
+  pool.parallelRun(num_tasks, [&](size_t task_id, size_t thread_id) {
+    int64_t local_start = begin + task_id * chunk_size;
+    int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
+    ParallelRegionGuard guard(thread_id);
+    f(local_start, local_end, task_id);
+  });
+#else
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
   std::vector<std::shared_ptr<c10::ivalue::Future>> futures(num_tasks);
@@ -156,6 +197,7 @@ void _parallel_run(
   if (eptr) {
     std::rethrow_exception(eptr);
   }
+#endif // AT_PARALLEL_NATIVE_WS && !defined(C10_MOBILE)
 }
 
 } // namespace internal
@@ -194,7 +236,13 @@ void set_num_threads(int nthreads) {
     }
   }
 #else
-  TORCH_CHECK(false, "set_num_threads is not supported for mobile.");
+  TORCH_CHECK(nthreads > 0, "Expected positive number of threads");
+  // The mobile thread pool can be resized at any time, and QNNPACK and NNPACK
+  // run on it as well.
+  caffe2::ThreadPool* pool = caffe2::mobile_threadpool();
+  if (pool) {
+    pool->setNumThreads(nthreads);
+  }
 #endif // C10_MOBILE
 }
 
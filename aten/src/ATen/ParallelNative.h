@@ -15,13 +15,29 @@ inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
   // Choose number of tasks based on grain size and number of threads.
+#if AT_PARALLEL_NATIVE_WS
+  // The work-stealing pool balances the load dynamically, so give it several
+  // tasks per thread to move around.
+  size_t chunk_size = divup((end - begin), get_num_threads() * 8);
+#else
   size_t chunk_size = divup((end - begin), get_num_threads());
+#endif
   // Make sure each task is at least grain_size size.
   chunk_size = std::max((size_t)grain_size, chunk_size);
   size_t num_tasks = divup((end - begin), chunk_size);
   return std::make_tuple(num_tasks, chunk_size);
 }
 
+// Nested parallel regions run serially, except with the work-stealing pool,
+// which can split them across idle workers without deadlocking.
+inline bool _serialize_nested_region() {
+#if AT_PARALLEL_NATIVE_WS
+  return get_num_threads() == 1;
+#else
+  return in_parallel_region();
+#endif
+}
+
 CAFFE2_API void _parallel_run(
   const int64_t begin,
   const int64_t end,
@@ -40,14 +56,17 @@ inline void parallel_for(
   if (begin >= end) {
     return;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  internal::AutotuneScope<F> autotune(end - begin, grain_size);
+  const int64_t tuned_grain_size = autotune.grain_size();
+  if ((end - begin) < tuned_grain_size ||
+      internal::_serialize_nested_region()) {
     f(begin, end);
     return;
   }
   internal::_parallel_run(
       begin,
       end,
-      grain_size,
+      tuned_grain_size,
       [f](int64_t start, int64_t end, size_t /* unused */) {
         f(start, end);
       }
@@ -66,18 +85,21 @@ inline scalar_t parallel_reduce(
   if (begin >= end) {
     return ident;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  internal::AutotuneScope<F> autotune(end - begin, grain_size);
+  const int64_t tuned_grain_size = autotune.grain_size();
+  if ((end - begin) < tuned_grain_size ||
+      internal::_serialize_nested_region()) {
     return f(begin, end, ident);
   }
   size_t num_tasks, chunk_size;
   std::tie(num_tasks, chunk_size) =
-      internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
+      internal::calc_num_tasks_and_chunk_size(begin, end, tuned_grain_size);
   std::vector<scalar_t> results(num_tasks);
   scalar_t* results_data = results.data();
   internal::_parallel_run(
       begin,
       end,
-      grain_size,
+      tuned_grain_size,
       [f, ident, results_data](int64_t start, int64_t end, size_t task_id) {
         results_data[task_id] = f(start, end, ident);
       }
@@ -25,7 +25,9 @@ inline void parallel_for(
   if (begin >= end) {
     return;
   }
-  if ((end - begin) < grain_size || get_num_threads() == 1) {
+  internal::AutotuneScope<F> autotune(end - begin, grain_size);
+  const int64_t tuned_grain_size = autotune.grain_size();
+  if ((end - begin) < tuned_grain_size || get_num_threads() == 1) {
     f(begin, end);
     return;
   }
@@ -33,7 +35,7 @@ inline void parallel_for(
   // Choose number of tasks based on grain size and number of threads.
   int64_t chunk_size = divup((end - begin), get_num_threads());
   // Make sure each task is at least grain_size size.
-  chunk_size = std::max(grain_size, chunk_size);
+  chunk_size = std::max(tuned_grain_size, chunk_size);
 
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
@@ -64,14 +66,16 @@ inline scalar_t parallel_reduce(
   if (begin >= end) {
     return ident;
   }
-  if ((end - begin) < grain_size || get_num_threads() == 1) {
+  internal::AutotuneScope<F> autotune(end - begin, grain_size);
+  const int64_t tuned_grain_size = autotune.grain_size();
+  if ((end - begin) < tuned_grain_size || get_num_threads() == 1) {
     return f(begin, end, ident);
   }
 
   // Choose number of tasks based on grain size and number of threads.
   int64_t chunk_size = divup((end - begin), get_num_threads());
   // Make sure each task is at least grain_size size.
-  chunk_size = std::max(grain_size, chunk_size);
+  chunk_size = std::max(tuned_grain_size, chunk_size);
 
   scalar_t result;
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
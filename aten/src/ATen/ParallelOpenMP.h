@@ -23,16 +23,18 @@ inline void parallel_for(
     return;
   }
 #ifdef _OPENMP
+  internal::AutotuneScope<F> autotune(end - begin, grain_size);
+  const int64_t tuned_grain_size = autotune.grain_size();
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
 
-#pragma omp parallel if (!omp_in_parallel() && ((end - begin) > grain_size))
+#pragma omp parallel if (!omp_in_parallel() && ((end - begin) > tuned_grain_size))
   {
     // choose number of tasks based on grain size and number of threads
     // can't use num_threads clause due to bugs in GOMP's thread pool (See #32008)
     int64_t num_threads = omp_get_num_threads();
-    if (grain_size > 0) {
-      num_threads = std::min(num_threads, divup((end - begin), grain_size));
+    if (tuned_grain_size > 0) {
+      num_threads = std::min(num_threads, divup((end - begin), tuned_grain_size));
     }
 
     int64_t tid = omp_get_thread_num();
@@ -70,16 +72,18 @@ inline scalar_t parallel_reduce(
   } else if (in_parallel_region() || get_num_threads() == 1) {
     return f(begin, end, ident);
   } else {
-    const int64_t num_results = divup((end - begin), grain_size);
+    internal::AutotuneScope<F> autotune(end - begin, grain_size);
+    const int64_t tuned_grain_size = autotune.grain_size();
+    const int64_t num_results = divup((end - begin), tuned_grain_size);
     std::vector<scalar_t> results(num_results);
     scalar_t* results_data = results.data();
     std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
     std::exception_ptr eptr;
-#pragma omp parallel for if ((end - begin) >= grain_size)
+#pragma omp parallel for if ((end - begin) >= tuned_grain_size)
     for (int64_t id = 0; id < num_results; id++) {
-      int64_t i = begin + id * grain_size;
+      int64_t i = begin + id * tuned_grain_size;
       try {
-        results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
+        results_data[id] = f(i, i + std::min(end - i, tuned_grain_size), ident);
       } catch (...) {
         if (!err_flag.test_and_set()) {
           eptr = std::current_exception();
@@ -77,7 +77,9 @@ void launch(std::function<void()> func) {
     getThreadLocalDebugInfo()
   );
 
-#if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
+#if AT_EXPERIMENTAL_SINGLE_THREAD_POOL || AT_PARALLEL_NATIVE_WS
+  // Inter-op tasks share the intra-op workers, so that kernels called from
+  // them can still use all idle threads.
   intraop_launch(fn);
 #else
   get_pool().run(fn);
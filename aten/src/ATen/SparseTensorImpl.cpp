@@ -107,6 +107,7 @@ void SparseTensorImpl::set_indices_and_values_unsafe(const Tensor& indices, cons
     "values has incorrect size, expected ", expected_values_size, ", got ", new_values_size
   );
 
+  clear_csr_cache();
   indices_ = indices;
   values_ = values;
   AT_ASSERT(device() == values_.device());
@@ -4,6 +4,10 @@
 #include <c10/core/TensorImpl.h>
 #include <c10/util/Exception.h>
 
+#include <mutex>
+#include <tuple>
+#include <utility>
+
 namespace at {
 struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // Stored in COO format, indices + values.
@@ -29,6 +33,18 @@ struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // because many algorithms proceed by merging two sorted lists (of indices).
   bool coalesced_ = false;
 
+  // The CSR form of a coalesced matrix (sparse_dim == 2, dense_dim == 0):
+  // the row pointers and the column indices, in the index type the backend
+  // wants.  Sparse-dense matmul computes it on first use and reuses it for
+  // later calls with the same tensor, which is what workloads that multiply
+  // by the same adjacency matrix many times need.
+  //
+  // Like coalesced_, the cache assumes that the indices of a coalesced
+  // tensor are never modified in place.  Every setter below drops it.
+  Tensor csr_crow_indices_;
+  Tensor csr_col_indices_;
+  mutable std::mutex csr_mutex_;
+
 public:
   // Public for now...
   explicit SparseTensorImpl(at::DispatchKeySet, const caffe2::TypeMeta&);
@@ -40,6 +56,21 @@ public:
   Tensor indices() const { return indices_; }
   Tensor values() const { return values_; }
 
+  // Returns the cached CSR row pointers and column indices, or undefined
+  // tensors if they have not been computed since the last change.
+  std::pair<Tensor, Tensor> csr_cache() const {
+    std::lock_guard<std::mutex> lock(csr_mutex_);
+    return {csr_crow_indices_, csr_col_indices_};
+  }
+  void set_csr_cache(const Tensor& crow_indices, const Tensor& col_indices) {
+    std::lock_guard<std::mutex> lock(csr_mutex_);
+    csr_crow_indices_ = crow_indices;
+    csr_col_indices_ = col_indices;
+  }
+  void clear_csr_cache() {
+    set_csr_cache(Tensor(), Tensor());
+  }
+
   IntArrayRef strides() const override;
   bool is_contiguous(at::MemoryFormat memory_format=at::MemoryFormat::Contiguous) const override;
   int64_t stride(int64_t d) const override;
@@ -56,6 +87,7 @@ public:
   // respect to indices and values
   void raw_resize_(int64_t sparse_dim, int64_t dense_dim, IntArrayRef size) {
     TORCH_CHECK(allow_tensor_metadata_change(), "raw_resize_ ", err_msg_tensor_metadata_change_not_allowed);
+    clear_csr_cache();
     sizes_ = size.vec();
     sparse_dim_ = sparse_dim;
     dense_dim_ = dense_dim;
@@ -86,6 +118,7 @@ public:
   // (this could make some of the stored indices out-of-bound and thus unsafe).
   void resize_(int64_t sparse_dim, int64_t dense_dim, IntArrayRef size) {
     TORCH_CHECK(allow_tensor_metadata_change(), "resize_ ", err_msg_tensor_metadata_change_not_allowed);
+    clear_csr_cache();
     TORCH_CHECK(sparse_dim + dense_dim == static_cast<int64_t>(size.size()), "number of dimensions must be sparse_dim (", sparse_dim, ") + dense_dim (", dense_dim, "), but got ", size.size());
     if (nnz() > 0) {
       auto alt_options_msg = "You could try the following options:\n\
@@ -161,6 +194,7 @@ public:
 
   void set_coalesced(bool coalesced) {
     TORCH_CHECK(allow_tensor_metadata_change(), "set_coalesced ", err_msg_tensor_metadata_change_not_allowed);
+    clear_csr_cache();
     coalesced_ = coalesced;
   }
 
@@ -168,6 +202,7 @@ public:
   void set_nnz_and_narrow(int64_t new_nnz) {
     TORCH_CHECK(allow_tensor_metadata_change(), "set_nnz_and_narrow ", err_msg_tensor_metadata_change_not_allowed);
     AT_ASSERT(new_nnz <= nnz());
+    clear_csr_cache();
     indices_ = indices_.narrow(1, 0, new_nnz);
     values_ = values_.narrow(0, 0, new_nnz);
   }
@@ -238,6 +273,8 @@ private:
     dest_sparse_impl->indices_ = src_sparse_impl->indices();
     dest_sparse_impl->values_ = src_sparse_impl->values();
     dest_sparse_impl->coalesced_ = src_sparse_impl->coalesced();
+    std::tie(dest_sparse_impl->csr_crow_indices_, dest_sparse_impl->csr_col_indices_) =
+        src_sparse_impl->csr_cache();
   }
 };
 
@@ -0,0 +1,307 @@
+#include <ATen/WorkStealingThreadPool.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+
+namespace at {
+
+namespace {
+// Pool that owns the current thread, if any, and the thread's index in it.
+thread_local const WorkStealingThreadPool* current_pool_ = nullptr;
+thread_local size_t current_worker_ = 0;
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    std::function<void(size_t)> init_thread) {
+  size_t num_threads = pool_size < 0 ? defaultNumThreads() : pool_size;
+  queues_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    queues_.emplace_back(new WorkerQueue());
+  }
+  num_idle_ = num_threads;
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i, init_thread]() {
+      current_pool_ = this;
+      current_worker_ = i;
+      if (init_thread) {
+        init_thread(i);
+      }
+      main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+    wakeup_.notify_all();
+  }
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    tasks_.push(func);
+  }
+  notify();
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return num_idle_.load();
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_pool_ == this;
+}
+
+void WorkStealingThreadPool::parallelRun(
+    size_t n,
+    const std::function<void(size_t, size_t)>& fn) {
+  if (n == 0) {
+    return;
+  }
+  size_t thread_id = 0;
+  WorkerQueue* own_queue = &shared_queue_;
+  if (inThreadPool()) {
+    thread_id = current_worker_ + 1;
+    own_queue = queues_[current_worker_].get();
+  }
+
+  Job job;
+  job.fn = &fn;
+  job.remaining = n;
+
+  // Deal out the indices evenly; the calling thread keeps the first share. A
+  // nested call from worker k deals the shares out to the other workers.
+  size_t num_shares = std::min(n, queues_.size() + 1);
+  size_t share = n / num_shares;
+  size_t extra = n % num_shares;
+  size_t own_end = share + (extra > 0 ? 1 : 0);
+  size_t begin = own_end;
+  for (size_t i = 1; i < num_shares; ++i) {
+    size_t end = begin + share + (i < extra ? 1 : 0);
+    WorkerQueue& queue = *queues_[(thread_id + i - 1) % queues_.size()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.ranges.push_back({&job, begin, end});
+    }
+    begin = end;
+  }
+  if (num_shares > 1) {
+    notify(/* all */ true);
+  }
+
+  execute({&job, 0, own_end}, thread_id, own_queue);
+  wait_for(&job, thread_id, own_queue);
+
+  if (job.eptr) {
+    std::rethrow_exception(job.eptr);
+  }
+}
+
+void WorkStealingThreadPool::main_loop(size_t index) {
+  while (true) {
+    // Read the epoch before looking for work, so that work published while we
+    // look keeps us from going to sleep.
+    uint64_t epoch = epoch_.load();
+
+    Range range;
+    if (pop_or_steal(index, &range)) {
+      --num_idle_;
+      execute(range, index + 1, queues_[index].get());
+      ++num_idle_;
+      continue;
+    }
+
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(tasks_mutex_);
+      if (!tasks_.empty()) {
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+    }
+    if (task) {
+      --num_idle_;
+      try {
+        task();
+      } catch (const std::exception&) {
+      }
+      ++num_idle_;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++num_sleeping_;
+    while (running_ && epoch_.load() == epoch) {
+      wakeup_.wait(lock);
+    }
+    --num_sleeping_;
+    if (!running_) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingThreadPool::pop_or_steal(size_t index, Range* range) {
+  {
+    // Own work is taken from the back: it was split off most recently and is
+    // the most likely to still be in cache.
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.ranges.empty()) {
+      *range = queue.ranges.back();
+      queue.ranges.pop_back();
+      return true;
+    }
+  }
+  // Steal from the front, where the largest ranges are.
+  auto steal = [range](WorkerQueue& victim) {
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.ranges.empty()) {
+      return false;
+    }
+    *range = victim.ranges.front();
+    victim.ranges.pop_front();
+    return true;
+  };
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    if (steal(*queues_[(index + i) % queues_.size()])) {
+      return true;
+    }
+  }
+  return steal(shared_queue_);
+}
+
+bool WorkStealingThreadPool::take_from_job(
+    Job* job,
+    WorkerQueue* own,
+    Range* range) {
+  auto take = [job, range](WorkerQueue& queue) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto it = queue.ranges.begin(); it != queue.ranges.end(); ++it) {
+      if (it->job == job) {
+        *range = *it;
+        queue.ranges.erase(it);
+        return true;
+      }
+    }
+    return false;
+  };
+  if (take(*own)) {
+    return true;
+  }
+  for (auto& queue : queues_) {
+    if (queue.get() != own && take(*queue)) {
+      return true;
+    }
+  }
+  return own != &shared_queue_ && take(shared_queue_);
+}
+
+void WorkStealingThreadPool::wait_for(
+    Job* job,
+    size_t thread_id,
+    WorkerQueue* queue) {
+  while (true) {
+    // Same protocol as in main_loop(): a finishing job and newly published
+    // ranges both bump the epoch.
+    uint64_t epoch = epoch_.load();
+    if (job->remaining.load() == 0) {
+      return;
+    }
+    Range range;
+    if (take_from_job(job, queue, &range)) {
+      execute(range, thread_id, queue);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    ++num_waiting_;
+    while (epoch_.load() == epoch) {
+      job_progress_.wait(lock);
+    }
+    --num_waiting_;
+  }
+}
+
+void WorkStealingThreadPool::execute(
+    Range range,
+    size_t thread_id,
+    WorkerQueue* queue) {
+  Job* job = range.job;
+  while (range.begin < range.end) {
+    if (range.end - range.begin > 1 && num_idle_.load() > 0) {
+      // Someone is looking for work: hand out the upper half, unless an
+      // earlier half is still waiting to be picked up. (Ranges of other jobs
+      // in the queue belong to calls that this thread is nested in.)
+      size_t mid = range.begin + (range.end - range.begin) / 2;
+      bool pushed = false;
+      {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->ranges.empty() || queue->ranges.back().job != job) {
+          queue->ranges.push_back({job, mid, range.end});
+          pushed = true;
+        }
+      }
+      if (pushed) {
+        range.end = mid;
+        notify();
+      }
+    }
+
+    try {
+      (*job->fn)(range.begin, thread_id);
+    } catch (...) {
+      if (!job->err_flag.test_and_set()) {
+        job->eptr = std::current_exception();
+      }
+    }
+    ++range.begin;
+
+    if (--job->remaining == 0) {
+      // The job lives on the stack of the thread waiting for it and may be
+      // destroyed from here on.
+      ++epoch_;
+      notify_waiters();
+    }
+  }
+}
+
+void WorkStealingThreadPool::notify(bool all) {
+  ++epoch_;
+  if (num_sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    if (all) {
+      wakeup_.notify_all();
+    } else {
+      wakeup_.notify_one();
+    }
+  }
+  notify_waiters();
+}
+
+void WorkStealingThreadPool::notify_waiters() {
+  if (num_waiting_.load() > 0) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    job_progress_.notify_all();
+  }
+}
+
+} // namespace at
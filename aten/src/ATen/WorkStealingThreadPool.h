@@ -0,0 +1,126 @@
+#pragma once
+
+#include <c10/core/thread_pool.h>
+#include <c10/macros/Macros.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace at {
+
+// Thread pool for intra-op parallelism that balances imbalanced loads by work
+// stealing.
+//
+// parallelRun(n, fn) calls fn for every index in [0, n). The index range is
+// first dealt out evenly to the calling thread and the workers. Each worker
+// keeps the ranges it owns in its own deque and executes them from the back;
+// idle workers steal ranges from the front of other deques, which is where the
+// largest ranges are. Whenever some worker is idle, the thread executing a
+// range splits off its upper half and pushes it onto its deque (adaptive
+// splitting), so a skewed range ends up spread over all threads instead of
+// keeping one thread busy while the others wait.
+//
+// parallelRun() may be called concurrently from several threads, and also
+// from inside fn or a task running on the pool (nested parallelism). Once the
+// calling thread has run out of its own indices, it keeps executing indices of
+// its call that have not been taken by anyone yet, and sleeps only when there
+// are none. It never executes indices of other calls while it waits, since it
+// may be suspended in the middle of one of them.
+//
+// Plain tasks submitted through run() are executed in FIFO order by whichever
+// worker becomes idle first.
+class CAFFE2_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  // `init_thread` is called with the worker index on every worker thread
+  // before it starts processing tasks.
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      std::function<void(size_t)> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  void run(const std::function<void()>& func) override;
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  // Calls fn(index, thread_id) for every index in [0, n) and returns once all
+  // calls have finished. thread_id is 0 for threads outside the pool and
+  // 1 + worker index for the pool threads, so it is always less than
+  // size() + 1, and no two concurrent calls of fn for the same parallelRun()
+  // share a thread_id. If any call throws, the remaining indices are still
+  // executed and the first exception is rethrown.
+  void parallelRun(size_t n, const std::function<void(size_t, size_t)>& fn);
+
+ private:
+  struct Job {
+    const std::function<void(size_t, size_t)>* fn;
+    std::atomic<size_t> remaining;
+    std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+    std::exception_ptr eptr;
+  };
+
+  struct Range {
+    Job* job;
+    size_t begin;
+    size_t end;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Range> ranges;
+  };
+
+  void main_loop(size_t index);
+
+  bool pop_or_steal(size_t index, Range* range);
+
+  // Takes a range of `job` out of any queue, preferring `own`.
+  bool take_from_job(Job* job, WorkerQueue* own, Range* range);
+
+  // Helps executing `job` until all of its indices have finished.
+  void wait_for(Job* job, size_t thread_id, WorkerQueue* queue);
+
+  // Executes `range` on thread `thread_id`, pushing split-off halves onto
+  // `queue` while there are idle workers.
+  void execute(Range range, size_t thread_id, WorkerQueue* queue);
+
+  // Wakes up one (or all) sleeping workers, and all threads waiting in
+  // parallelRun(), after new work was published.
+  void notify(bool all = false);
+
+  // Wakes up all threads waiting in parallelRun() after the epoch changed.
+  void notify_waiters();
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  // Ranges split off by threads that are not part of the pool; only stolen
+  // by the workers.
+  WorkerQueue shared_queue_;
+
+  std::mutex tasks_mutex_;
+  std::queue<std::function<void()>> tasks_;
+
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> num_idle_{0};
+  std::atomic<size_t> num_sleeping_{0};
+  std::atomic<uint64_t> epoch_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wakeup_;
+  bool running_ = true;
+  std::atomic<size_t> num_waiting_{0};
+  std::mutex wait_mutex_;
+  std::condition_variable job_progress_;
+};
+
+} // namespace at
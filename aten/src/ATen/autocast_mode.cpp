@@ -0,0 +1,263 @@
+#include <ATen/ATen.h>
+#include <ATen/autocast_mode.h>
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <c10/core/impl/LocalDispatchKeySet.h>
+#include <c10/util/intrusive_ptr.h>
+
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace at {
+namespace autocast {
+
+bool is_enabled() {
+  return c10::impl::tls_is_dispatch_key_included(c10::DispatchKey::AutocastTensorId);
+}
+
+void set_enabled(bool new_enabled) {
+  c10::impl::tls_set_dispatch_key_included(c10::DispatchKey::AutocastTensorId, new_enabled);
+}
+
+namespace {
+
+// Casts of float32 leaf tensors that require grad, i.e. of the weights, to
+// float16.  The casts are reused by all the ops of a region that use the
+// same weight.  The key is only compared, never dereferenced; the weak
+// reference keeps the TensorImpl allocation alive so that its address cannot
+// be reused by another tensor while the entry exists.
+using weakref_type = c10::weak_intrusive_ptr<TensorImpl, UndefinedTensorImpl>;
+using val_type = std::tuple<weakref_type, Tensor>;
+thread_local std::unordered_map<TensorImpl*, val_type> cached_casts;
+
+// Nesting depth of autocast regions on this thread.  The cache is cleared
+// when the outermost region exits.
+thread_local int nesting = 0;
+
+} // namespace
+
+void clear_cache() {
+  cached_casts.clear();
+}
+
+int increment_nesting() {
+  return ++nesting;
+}
+
+int decrement_nesting() {
+  return --nesting;
+}
+
+namespace {
+
+// Only floating point CUDA tensors are cast.  Double tensors are left alone:
+// a user who asked for double precision presumably needs it.
+inline bool is_eligible(const Tensor& arg) {
+  return arg.defined() && arg.is_cuda() && arg.is_floating_point() &&
+      arg.scalar_type() != at::kDouble;
+}
+
+Tensor cached_cast(at::ScalarType to_type, const Tensor& arg) {
+  if (!is_eligible(arg) || arg.scalar_type() == to_type) {
+    return arg;
+  }
+  bool can_try_cache = to_type == at::kHalf && arg.scalar_type() == at::kFloat &&
+      arg.requires_grad() && arg.is_leaf();
+  if (!can_try_cache) {
+    return arg.to(to_type);
+  }
+  auto it = cached_casts.find(arg.unsafeGetTensorImpl());
+  if (it != cached_casts.end()) {
+    return std::get<1>(it->second);
+  }
+  auto casted = arg.to(to_type);
+  cached_casts.emplace(
+      arg.unsafeGetTensorImpl(),
+      val_type{weakref_type(arg.getIntrusivePtr()), casted});
+  return casted;
+}
+
+std::vector<Tensor> cached_cast(at::ScalarType to_type, TensorList arg) {
+  std::vector<Tensor> vec;
+  vec.reserve(arg.size());
+  for (const auto& t : arg) {
+    vec.push_back(cached_cast(to_type, t));
+  }
+  return vec;
+}
+
+// Arguments that are not tensors pass through
+template <typename T>
+inline T cached_cast(at::ScalarType to_type, T arg) {
+  return arg;
+}
+
+// The widest floating point type among the eligible tensor arguments.  Ops
+// like cat or addcmul have to see a single type, so mixing float16 and
+// float32 inputs runs them in float32.
+inline at::ScalarType prioritize(at::ScalarType current, const Tensor& next_arg) {
+  if (!is_eligible(next_arg)) {
+    return current;
+  }
+  auto next = next_arg.scalar_type();
+  if (current == at::kFloat || next == at::kFloat) {
+    return at::kFloat;
+  }
+  TORCH_INTERNAL_ASSERT(current == at::kHalf && next == at::kHalf,
+                        "Unexpected floating point type ", next, " in autocast");
+  return at::kHalf;
+}
+
+inline at::ScalarType prioritize(at::ScalarType current, TensorList list) {
+  for (const auto& t : list) {
+    current = prioritize(current, t);
+  }
+  return current;
+}
+
+template <typename T>
+inline at::ScalarType prioritize(at::ScalarType current, T next_arg) {
+  return current;
+}
+
+inline at::ScalarType promote_type(at::ScalarType current) {
+  return current;
+}
+
+template <typename Arg0, typename... Args>
+inline at::ScalarType promote_type(at::ScalarType current, Arg0 arg0, Args... args) {
+  return promote_type(prioritize(current, arg0), args...);
+}
+
+enum class CastPolicy : uint8_t {
+  fp16,    // Cast all inputs to float16
+  fp32,    // Cast all inputs to float32
+  promote, // Cast all inputs to the widest type among them
+};
+
+// Wraps the function F with the cast policy.  The autocast key is excluded
+// while F runs, so the ops F calls, including the casts, are not autocast
+// again.
+template <CastPolicy policy, class Redispatch, Redispatch* F, class Ret, class ArgList>
+struct WrapFunction_ {};
+
+template <class Redispatch, Redispatch* F, class Ret, class... Args>
+struct WrapFunction_<CastPolicy::fp16, Redispatch, F, Ret, c10::guts::typelist::typelist<Args...>> {
+  static Ret call(Args... args) {
+    c10::impl::ExcludeDispatchKeyGuard no_autocast(c10::DispatchKey::AutocastTensorId);
+    return (*F)(cached_cast(at::kHalf, args)...);
+  }
+};
+
+template <class Redispatch, Redispatch* F, class Ret, class... Args>
+struct WrapFunction_<CastPolicy::fp32, Redispatch, F, Ret, c10::guts::typelist::typelist<Args...>> {
+  static Ret call(Args... args) {
+    c10::impl::ExcludeDispatchKeyGuard no_autocast(c10::DispatchKey::AutocastTensorId);
+    return (*F)(cached_cast(at::kFloat, args)...);
+  }
+};
+
+template <class Redispatch, Redispatch* F, class Ret, class... Args>
+struct WrapFunction_<CastPolicy::promote, Redispatch, F, Ret, c10::guts::typelist::typelist<Args...>> {
+  static Ret call(Args... args) {
+    c10::impl::ExcludeDispatchKeyGuard no_autocast(c10::DispatchKey::AutocastTensorId);
+    auto to_type = promote_type(at::kHalf, args...);
+    return (*F)(cached_cast(to_type, args)...);
+  }
+};
+
+template <CastPolicy policy, class Registered, class Redispatch, Redispatch* F>
+struct WrapFunction final {
+  using type = WrapFunction_<
+      policy,
+      Redispatch,
+      F,
+      typename c10::guts::function_traits<Registered>::return_type,
+      typename c10::guts::function_traits<Registered>::parameter_types>;
+};
+
+// SIGNATURE is the C++ signature of the at:: function, which also picks the
+// overload of FUNC to wrap.
+#define KERNEL(FUNC, REGISTER_SCHEMA, SIGNATURE, POLICY)                             \
+  .op(torch::RegisterOperators::options()                                            \
+    .schema(REGISTER_SCHEMA)                                                         \
+    .impl_unboxedOnlyKernel<                                                         \
+        SIGNATURE,                                                                   \
+        &WrapFunction<CastPolicy::POLICY, SIGNATURE, SIGNATURE, &FUNC>::type::call>( \
+        c10::DispatchKey::AutocastTensorId)                                          \
+    .aliasAnalysis(c10::AliasAnalysisKind::FROM_SCHEMA))
+
+// Ops without an autocast kernel skip the autocast key
+static auto fallthrough = c10::Dispatcher::singleton().registerBackendFallbackKernel(
+    c10::DispatchKey::AutocastTensorId,
+    c10::KernelFunction::makeFallthrough());
+
+static auto registry = torch::RegisterOperators()
+  // fp16
+  KERNEL(at::_convolution, "aten::_convolution(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, bool transposed, int[] output_padding, int groups, bool benchmark, bool deterministic, bool cudnn_enabled) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, bool, IntArrayRef, int64_t, bool, bool, bool), fp16)
+  KERNEL(at::conv1d, "aten::conv1d(Tensor input, Tensor weight, Tensor? bias=None, int[1] stride=1, int[1] padding=0, int[1] dilation=1, int groups=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t), fp16)
+  KERNEL(at::conv2d, "aten::conv2d(Tensor input, Tensor weight, Tensor? bias=None, int[2] stride=1, int[2] padding=0, int[2] dilation=1, int groups=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t), fp16)
+  KERNEL(at::conv3d, "aten::conv3d(Tensor input, Tensor weight, Tensor? bias=None, int[3] stride=1, int[3] padding=0, int[3] dilation=1, int groups=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t), fp16)
+  KERNEL(at::conv_transpose1d, "aten::conv_transpose1d(Tensor input, Tensor weight, Tensor? bias=None, int[1] stride=1, int[1] padding=0, int[1] output_padding=0, int groups=1, int[1] dilation=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t, IntArrayRef), fp16)
+  KERNEL(at::conv_transpose2d, "aten::conv_transpose2d.input(Tensor input, Tensor weight, Tensor? bias=None, int[2] stride=1, int[2] padding=0, int[2] output_padding=0, int groups=1, int[2] dilation=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t, IntArrayRef), fp16)
+  KERNEL(at::conv_transpose3d, "aten::conv_transpose3d.input(Tensor input, Tensor weight, Tensor? bias=None, int[3] stride=1, int[3] padding=0, int[3] output_padding=0, int groups=1, int[3] dilation=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, int64_t, IntArrayRef), fp16)
+  KERNEL(at::convolution, "aten::convolution(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, bool transposed, int[] output_padding, int groups) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, bool, IntArrayRef, int64_t), fp16)
+  KERNEL(at::prelu, "aten::prelu(Tensor self, Tensor weight) -> Tensor", Tensor (const Tensor &, const Tensor &), fp16)
+  KERNEL(at::addmm, "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar, Scalar), fp16)
+  KERNEL(at::addmv, "aten::addmv(Tensor self, Tensor mat, Tensor vec, *, Scalar beta=1, Scalar alpha=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar, Scalar), fp16)
+  KERNEL(at::addr, "aten::addr(Tensor self, Tensor vec1, Tensor vec2, *, Scalar beta=1, Scalar alpha=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar, Scalar), fp16)
+  KERNEL(at::matmul, "aten::matmul(Tensor self, Tensor other) -> Tensor", Tensor (const Tensor &, const Tensor &), fp16)
+  KERNEL(at::mm, "aten::mm(Tensor self, Tensor mat2) -> Tensor", Tensor (const Tensor &, const Tensor &), fp16)
+  KERNEL(at::mv, "aten::mv(Tensor self, Tensor vec) -> Tensor", Tensor (const Tensor &, const Tensor &), fp16)
+  KERNEL(at::linear, "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &), fp16)
+  KERNEL(at::addbmm, "aten::addbmm(Tensor self, Tensor batch1, Tensor batch2, *, Scalar beta=1, Scalar alpha=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar, Scalar), fp16)
+  KERNEL(at::baddbmm, "aten::baddbmm(Tensor self, Tensor batch1, Tensor batch2, *, Scalar beta=1, Scalar alpha=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar, Scalar), fp16)
+  KERNEL(at::bmm, "aten::bmm(Tensor self, Tensor mat2) -> Tensor", Tensor (const Tensor &, const Tensor &), fp16)
+  KERNEL(at::chain_matmul, "aten::chain_matmul(Tensor[] matrices) -> Tensor", Tensor (TensorList), fp16)
+  // fp32
+  KERNEL(at::exp, "aten::exp(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::log, "aten::log(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::log1p, "aten::log1p(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::reciprocal, "aten::reciprocal(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::rsqrt, "aten::rsqrt(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::erfinv, "aten::erfinv(Tensor self) -> Tensor", Tensor (const Tensor &), fp32)
+  KERNEL(at::pow, "aten::pow.Tensor_Scalar(Tensor self, Scalar exponent) -> Tensor", Tensor (const Tensor &, Scalar), fp32)
+  KERNEL(at::pow, "aten::pow.Tensor_Tensor(Tensor self, Tensor exponent) -> Tensor", Tensor (const Tensor &, const Tensor &), fp32)
+  KERNEL(at::softplus, "aten::softplus(Tensor self, Scalar beta=1, Scalar threshold=20) -> Tensor", Tensor (const Tensor &, Scalar, Scalar), fp32)
+  KERNEL(at::softmax, "aten::softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, int64_t, c10::optional<ScalarType>), fp32)
+  KERNEL(at::log_softmax, "aten::log_softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, int64_t, c10::optional<ScalarType>), fp32)
+  KERNEL(at::sum, "aten::sum(Tensor self, *, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, c10::optional<ScalarType>), fp32)
+  KERNEL(at::sum, "aten::sum.dim_IntList(Tensor self, int[1] dim, bool keepdim=False, *, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, IntArrayRef, bool, c10::optional<ScalarType>), fp32)
+  KERNEL(at::prod, "aten::prod(Tensor self, *, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, c10::optional<ScalarType>), fp32)
+  KERNEL(at::cumsum, "aten::cumsum(Tensor self, int dim, *, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, int64_t, c10::optional<ScalarType>), fp32)
+  KERNEL(at::cumprod, "aten::cumprod(Tensor self, int dim, *, ScalarType? dtype=None) -> Tensor", Tensor (const Tensor &, int64_t, c10::optional<ScalarType>), fp32)
+  KERNEL(at::norm, "aten::norm.Scalar(Tensor self, Scalar p=2) -> Tensor", Tensor (const Tensor &, Scalar), fp32)
+  KERNEL(at::norm, "aten::norm.ScalarOpt_dim(Tensor self, Scalar? p, int[1] dim, bool keepdim=False) -> Tensor", Tensor (const Tensor &, c10::optional<Scalar>, IntArrayRef, bool), fp32)
+  KERNEL(at::dist, "aten::dist(Tensor self, Tensor other, Scalar p=2) -> Tensor", Tensor (const Tensor &, const Tensor &, Scalar), fp32)
+  KERNEL(at::cosine_similarity, "aten::cosine_similarity(Tensor x1, Tensor x2, int dim=1, float eps=1e-08) -> Tensor", Tensor (const Tensor &, const Tensor &, int64_t, double), fp32)
+  KERNEL(at::layer_norm, "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor? weight=None, Tensor? bias=None, float eps=1e-05, bool cudnn_enable=True) -> Tensor", Tensor (const Tensor &, IntArrayRef, const Tensor &, const Tensor &, double, bool), fp32)
+  KERNEL(at::group_norm, "aten::group_norm(Tensor input, int num_groups, Tensor? weight=None, Tensor? bias=None, float eps=1e-05, bool cudnn_enabled=True) -> Tensor", Tensor (const Tensor &, int64_t, const Tensor &, const Tensor &, double, bool), fp32)
+  KERNEL(at::mse_loss, "aten::mse_loss(Tensor self, Tensor target, int reduction=Mean) -> Tensor", Tensor (const Tensor &, const Tensor &, int64_t), fp32)
+  KERNEL(at::l1_loss, "aten::l1_loss(Tensor self, Tensor target, int reduction=Mean) -> Tensor", Tensor (const Tensor &, const Tensor &, int64_t), fp32)
+  KERNEL(at::smooth_l1_loss, "aten::smooth_l1_loss(Tensor self, Tensor target, int reduction=Mean) -> Tensor", Tensor (const Tensor &, const Tensor &, int64_t), fp32)
+  KERNEL(at::kl_div, "aten::kl_div(Tensor self, Tensor target, int reduction=Mean) -> Tensor", Tensor (const Tensor &, const Tensor &, int64_t), fp32)
+  KERNEL(at::nll_loss, "aten::nll_loss(Tensor self, Tensor target, Tensor? weight=None, int reduction=Mean, int ignore_index=-100) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, int64_t, int64_t), fp32)
+  KERNEL(at::binary_cross_entropy_with_logits, "aten::binary_cross_entropy_with_logits(Tensor self, Tensor target, Tensor? weight=None, Tensor? pos_weight=None, int reduction=Mean) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, const Tensor &, int64_t), fp32)
+  // promote
+  KERNEL(at::addcdiv, "aten::addcdiv(Tensor self, Tensor tensor1, Tensor tensor2, *, Scalar value=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar), promote)
+  KERNEL(at::addcmul, "aten::addcmul(Tensor self, Tensor tensor1, Tensor tensor2, *, Scalar value=1) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, Scalar), promote)
+  KERNEL(at::atan2, "aten::atan2(Tensor self, Tensor other) -> Tensor", Tensor (const Tensor &, const Tensor &), promote)
+  KERNEL(at::bilinear, "aten::bilinear(Tensor input1, Tensor input2, Tensor weight, Tensor? bias) -> Tensor", Tensor (const Tensor &, const Tensor &, const Tensor &, const Tensor &), promote)
+  KERNEL(at::cross, "aten::cross(Tensor self, Tensor other, int? dim=None) -> Tensor", Tensor (const Tensor &, const Tensor &, c10::optional<int64_t>), promote)
+  KERNEL(at::dot, "aten::dot(Tensor self, Tensor tensor) -> Tensor", Tensor (const Tensor &, const Tensor &), promote)
+  KERNEL(at::cat, "aten::cat(Tensor[] tensors, int dim=0) -> Tensor", Tensor (TensorList, int64_t), promote)
+  KERNEL(at::stack, "aten::stack(Tensor[] tensors, int dim=0) -> Tensor", Tensor (TensorList, int64_t), promote)
+  ;
+
+#undef KERNEL
+
+} // namespace
+} // namespace autocast
+} // namespace at
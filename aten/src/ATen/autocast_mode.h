@@ -0,0 +1,33 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+// Autocasting runs selected CUDA ops in a precision chosen per op, so that
+// float32 models can use half precision where it is safe and fast (matmuls
+// and convolutions) without changing the model code.  Inside an autocast
+// region:
+//
+//  - matmul and convolution class ops cast their floating point CUDA inputs
+//    to float16,
+//  - reductions, softmax, losses and ops that need the range of float32 cast
+//    their inputs to float32,
+//  - ops that take several tensors (cat, stack, addcmul, ...) cast their
+//    inputs to the widest floating point type among them.
+//
+// The casts are done by kernels registered for DispatchKey::AutocastTensorId,
+// which is added to the thread-local included set while autocasting is
+// enabled.  Float32 leaf tensors that require grad (i.e. the weights) are cast
+// to float16 once per region; the casts are cached until the outermost region
+// exits and calls clear_cache().
+
+namespace at {
+namespace autocast {
+
+CAFFE2_API bool is_enabled();
+CAFFE2_API void set_enabled(bool enabled);
+CAFFE2_API void clear_cache();
+CAFFE2_API int increment_nesting();
+CAFFE2_API int decrement_nesting();
+
+} // namespace autocast
+} // namespace at
@@ -2,6 +2,43 @@
 
 namespace c10 {
 
+namespace {
+
+// Whether an argument of this type may be a tensor or a list of tensors at
+// runtime. Types that are neither, nor may contain them, are skipped by boxed
+// dispatch.
+bool mayHoldTensors(const TypePtr& type) {
+  switch (type->kind()) {
+    case TypeKind::IntType:
+    case TypeKind::FloatType:
+    case TypeKind::BoolType:
+    case TypeKind::StringType:
+    case TypeKind::NoneType:
+    case TypeKind::NumberType:
+    case TypeKind::DeviceObjType:
+      return false;
+    case TypeKind::OptionalType:
+      return mayHoldTensors(type->expect<OptionalType>()->getElementType());
+    case TypeKind::ListType:
+      return mayHoldTensors(type->expect<ListType>()->getElementType());
+    default:
+      return true;
+  }
+}
+
+} // namespace
+
+uint64_t DispatchKeyExtractor::makeTensorArgsBitfield(const FunctionSchema& schema) {
+  uint64_t bitfield = 0;
+  const auto& args = schema.arguments();
+  for (size_t i = 0; i < args.size() && i < 64; ++i) {
+    if (mayHoldTensors(args[i].type())) {
+      bitfield |= uint64_t(1) << i;
+    }
+  }
+  return bitfield;
+}
+
 void DispatchKeyExtractor::setOperatorHasKernelForBackend(DispatchKey k, bool has_kernel) {
   if (has_kernel) {
     operatorHasKernelForBackend_ = operatorHasKernelForBackend_.add(k);
@@ -98,7 +98,7 @@ namespace detail {
 struct CAFFE2_API DispatchKeyExtractor final {
 public:
   static DispatchKeyExtractor make(const FunctionSchema& schema) {
-    return DispatchKeyExtractor(schema.arguments().size());
+    return DispatchKeyExtractor(schema.arguments().size(), makeTensorArgsBitfield(schema));
   }
 
   DispatchKey getDispatchKeyBoxed(DispatchKeySet backendsWithoutFallthrough, const torch::jit::Stack* stack) const {
@@ -106,7 +106,12 @@ public:
     //      but boxed doesn't yet. See https://github.com/pytorch/pytorch/issues/26428
 
     DispatchKeySet ks;
-    for (const auto& ivalue : torch::jit::last(*stack, num_args_)) {
+    auto args = torch::jit::last(*stack, num_args_);
+    for (size_t i = 0; i < num_args_; ++i) {
+      if (!mayHoldTensors_(i)) {
+        continue;
+      }
+      const auto& ivalue = args[i];
       if (C10_LIKELY(ivalue.isTensor())) {
         // NB: Take care not to introduce a refcount bump (there's
         // no safe toTensorRef method, alas)
@@ -149,17 +154,29 @@ private:
     return impl::dispatchTypeId(ks, backendsWithoutFallthrough | operatorHasKernelForBackend_);
   }
 
-  explicit DispatchKeyExtractor(size_t num_args)
+  // Returns a bitfield with bit i set if argument i of the schema may hold a
+  // tensor. Arguments after the 64th are always checked.
+  static uint64_t makeTensorArgsBitfield(const FunctionSchema& schema);
+
+  bool mayHoldTensors_(size_t arg) const {
+    return arg >= 64 || (tensor_args_ >> arg) & 1;
+  }
+
+  explicit DispatchKeyExtractor(size_t num_args, uint64_t tensor_args)
   : num_args_(num_args)
+  , tensor_args_(tensor_args)
   , operatorHasKernelForBackend_() {}
 
   // this is caching the index so we don't have to parse the schema inputs
   // again and again for each dispatcher lookup.
   // num_args_ is allowed to be zero; that just means you must do the
   // fallthrough
-  // TODO: a potential optimization is to store a bitfield of arg locations,
   size_t num_args_;
 
+  // The arguments that boxed dispatch looks at, so that the ints, floats
+  // and other scalars of an operator are skipped without inspecting them.
+  uint64_t tensor_args_;
+
   // Set of backends for which the operator has explicitly registered a kernel.
   DispatchKeySet operatorHasKernelForBackend_;
 };
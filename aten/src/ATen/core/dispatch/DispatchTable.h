@@ -80,14 +80,29 @@ private:
  * consider the operator add(Tensor, Tensor), the dispatch table for this
  * operator may contain implementations for various dynamic tensor types, such
  * as CPUTensorId, CUDATensorId, etc.
+ *
+ * Besides the kernels registered for the operator itself, the table caches
+ * which kernel a call with a given dispatch key ends up in, i.e. the
+ * operator's kernel for that key, else the backend fallback kernel for that
+ * key, else the catch-all kernel. That way, a call only needs a single
+ * lookup instead of walking this chain. The cache is recomputed whenever a
+ * kernel of the operator or a backend fallback kernel changes.
  */
 class DispatchTable final {
  public:
-  explicit DispatchTable(const FunctionSchema& schema)
+  explicit DispatchTable(const FunctionSchema& schema, const impl::KernelFunctionTable* backendFallbackKernels)
   : kernels_()
   , catchallKernel_()
+  , backendFallbackKernels_(backendFallbackKernels)
+  , dispatchCache_()
   , dispatchKeyExtractor_(DispatchKeyExtractor::make(schema))
-  , operatorName_(toString(schema.operator_name())) {}
+  , operatorName_(toString(schema.operator_name())) {
+    updateDispatchCache();
+  }
+
+  // dispatchCache_ points into this object
+  DispatchTable(const DispatchTable&) = delete;
+  DispatchTable& operator=(const DispatchTable&) = delete;
 
   /**
    * Register a kernel in the table at some dispatch key.
@@ -97,6 +112,7 @@ class DispatchTable final {
   void setKernel(DispatchKey dispatchKey, KernelFunction kernel) {
     auto result = kernels_.setKernel(dispatchKey, std::move(kernel));
     dispatchKeyExtractor_.setOperatorHasKernelForBackend(dispatchKey, true);
+    updateDispatchCache();
     if (result == impl::KernelFunctionTable::SetKernelResult::OVERWROTE_EXISTING_KERNEL) {
       TORCH_WARN("Registered a kernel for operator ", operatorName_, " with dispatch key ", toString(dispatchKey), " that overwrote a previously registered kernel with the same dispatch key for the same operator.");
     }
@@ -110,6 +126,7 @@ class DispatchTable final {
   void removeKernelIfExists(DispatchKey dispatchKey) {
     kernels_.removeKernelIfExists(dispatchKey);
     dispatchKeyExtractor_.setOperatorHasKernelForBackend(dispatchKey, false);
+    updateDispatchCache();
   }
 
   /**
@@ -123,6 +140,7 @@ class DispatchTable final {
       TORCH_WARN("Registered a catch-all kernel for operator ", operatorName_," that overwrote a previously registered catch-all kernel for the same operator.");
     }
     catchallKernel_ = std::move(kernel);
+    updateDispatchCache();
   }
 
   /**
@@ -131,6 +149,7 @@ class DispatchTable final {
   void removeCatchallKernel() {
     TORCH_INTERNAL_ASSERT(catchallKernel_.isValid(), "Tried to remove the catch-all kernel for operator ", operatorName_," but there is no catch-all kernel registered.");
     catchallKernel_ = {};
+    updateDispatchCache();
   }
 
   bool isEmpty() const {
@@ -180,6 +199,32 @@ class DispatchTable final {
     return &catchallKernel_;
   }
 
+  /**
+   * Returns the kernel a call with the given dispatch key is dispatched to,
+   * or nullptr if there is none.
+   */
+  const KernelFunction* lookupCached(DispatchKey dispatchKey) const {
+    return dispatchCache_[static_cast<uint8_t>(dispatchKey)];
+  }
+
+  /**
+   * Recomputes the kernel each dispatch key is dispatched to. Must be called
+   * after the backend fallback kernels changed.
+   */
+  void updateDispatchCache() {
+    for (uint8_t iter = 0; iter != static_cast<uint8_t>(DispatchKey::NumDispatchKeys); ++iter) {
+      auto dispatchKey = static_cast<DispatchKey>(iter);
+      const KernelFunction* kernel = lookup(dispatchKey);
+      if (kernel == nullptr && backendFallbackKernels_ != nullptr && (*backendFallbackKernels_)[dispatchKey].isValid()) {
+        kernel = &(*backendFallbackKernels_)[dispatchKey];
+      }
+      if (kernel == nullptr) {
+        kernel = lookupCatchallKernel();
+      }
+      dispatchCache_[iter] = kernel;
+    }
+  }
+
   const DispatchKeyExtractor& dispatchKeyExtractor() const {
     return dispatchKeyExtractor_;
   }
@@ -192,6 +237,9 @@ private:
 
   impl::KernelFunctionTable kernels_;
   KernelFunction catchallKernel_;
+  // Owned by the Dispatcher.
+  const impl::KernelFunctionTable* backendFallbackKernels_;
+  std::array<const KernelFunction*, static_cast<uint8_t>(DispatchKey::NumDispatchKeys)> dispatchCache_;
   DispatchKeyExtractor dispatchKeyExtractor_;
   std::string operatorName_;
 };
@@ -76,7 +76,7 @@ OperatorHandle Dispatcher::findOrRegisterSchema_(FunctionSchema&& schema, Operat
   }
 
   OperatorName op_name = schema.operator_name();
-  operators_.emplace_back(std::move(schema), std::move(options));
+  operators_.emplace_back(std::move(schema), std::move(options), &backendFallbackKernels_);
   OperatorHandle handle(--operators_.end());
   operatorLookupTable_.write([&] (ska::flat_hash_map<OperatorName, OperatorHandle>& operatorLookupTable) {
     operatorLookupTable.emplace(op_name, handle);
@@ -127,11 +127,15 @@ void Dispatcher::deregisterSchema_(const OperatorHandle& op, const OperatorName&
 }
 
 RegistrationHandleRAII Dispatcher::registerBackendFallbackKernel(DispatchKey dispatchKey, KernelFunction kernel) {
+  // we need a lock to avoid concurrent writes and to iterate over operators_
+  std::lock_guard<std::mutex> lock(mutex_);
+
   auto inserted = backendFallbackKernels_.setKernel(dispatchKey, std::move(kernel));
   TORCH_CHECK(inserted == impl::KernelFunctionTable::SetKernelResult::ADDED_NEW_KERNEL, "Tried to register a backend fallback kernel for ", dispatchKey, " but there was already one registered.");
   if (kernel.isFallthrough()) {
     backendsWithoutFallthrough_ = backendsWithoutFallthrough_.remove(dispatchKey);
   }
+  updateBackendFallbacks_();
 
   return RegistrationHandleRAII([this, dispatchKey] {
     deregisterBackendFallbackKernel_(dispatchKey);
@@ -139,9 +143,21 @@ RegistrationHandleRAII Dispatcher::registerBackendFallbackKernel(DispatchKey dis
 }
 
 void Dispatcher::deregisterBackendFallbackKernel_(DispatchKey dispatchKey) {
+  // we need a lock to avoid concurrent writes and to iterate over operators_
+  std::lock_guard<std::mutex> lock(mutex_);
+
   auto result = backendFallbackKernels_.removeKernelIfExists(dispatchKey);
   backendsWithoutFallthrough_ = backendsWithoutFallthrough_.add(dispatchKey);
   TORCH_INTERNAL_ASSERT(result == impl::KernelFunctionTable::RemoveKernelIfExistsResult::REMOVED_KERNEL, "Tried to deregister a backend fallback kernel for ", dispatchKey, " but there was none registered.");
+  updateBackendFallbacks_();
+}
+
+void Dispatcher::updateBackendFallbacks_() {
+  // precondition: mutex_ is locked
+
+  for (auto& def : operators_) {
+    def.op.updateBackendFallbacks();
+  }
 }
 
 RegistrationHandleRAII Dispatcher::registerKernel(const OperatorHandle& op, DispatchKey dispatch_key, KernelFunction kernel) {
@@ -17,9 +17,9 @@ namespace {
   }
 }
 
-OperatorEntry::OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options)
+OperatorEntry::OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options, const KernelFunctionTable* backendFallbackKernels)
 : schema_(std::move(schema))
-, dispatchTable_(schema_)
+, dispatchTable_(schema_, backendFallbackKernels)
 , kernels_()
 , catchAllKernels_()
 , options_(std::move(options)) {
@@ -93,6 +93,12 @@ void OperatorEntry::deregisterCatchallKernel_(std::list<KernelFunction>::iterato
   updateCatchallDispatchTable_();
 }
 
+void OperatorEntry::updateBackendFallbacks() {
+  std::unique_lock<std::mutex> lock(kernelsMutex_);
+
+  dispatchTable_.updateDispatchCache();
+}
+
 void OperatorEntry::updateDispatchTable_(DispatchKey dispatch_key) {
   // precondition: kernelsMutex_ is locked
 
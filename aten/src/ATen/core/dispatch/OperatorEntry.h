@@ -16,7 +16,7 @@ namespace impl {
 // and its dispatch table. This is not part of the public API.
 class OperatorEntry final {
 public:
-  explicit OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options);
+  explicit OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options, const KernelFunctionTable* backendFallbackKernels);
 
   OperatorEntry(const OperatorEntry&) = delete;
   OperatorEntry(OperatorEntry&&) noexcept = delete;
@@ -44,6 +44,9 @@ public:
     options_.setAliasAnalysis(a);
   }
 
+  // Called by the Dispatcher after a backend fallback kernel changed.
+  void updateBackendFallbacks();
+
 private:
   void deregisterKernel_(DispatchKey dispatch_key, std::list<KernelFunction>::iterator kernel);
   void deregisterCatchallKernel_(std::list<KernelFunction>::iterator kernel);
@@ -88,6 +88,9 @@ namespace c10 {
   _(prim, ConstantChunk)             \
   _(prim, MMTreeReduce)              \
   _(prim, MMBatchSide)               \
+  _(prim, MMBatchGroup)              \
+  _(prim, AllocateStorage)           \
+  _(prim, AllocateTensor)            \
   _(prim, min)                       \
   _(prim, max)                       \
   _(prim, abs)                       \
@@ -281,8 +281,8 @@ void ivalue::Object::resizeObject(size_t slot) {
 
 static bool CompareKeys(const std::pair<IValue, IValue>& aWrap,
                         const std::pair<IValue, IValue>& bWrap) {
-  const auto a = aWrap.first;
-  const auto b = bWrap.first;
+  const auto& a = aWrap.first;
+  const auto& b = bWrap.first;
   if (a.isString() && b.isString()) {
     return a.toStringRef().compare(b.toStringRef()) < 0;
   } else if (a.isInt() && b.isInt()) {
@@ -251,6 +251,9 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
     AT_ASSERT(!completed());
     completed_ = true;
     value_ = std::move(value);
+    // Callbacks may call value() or chain other futures, so they run without
+    // holding the lock.
+    lock.unlock();
 
     fireCallbacks();
     finished_cv_.notify_all();
@@ -266,6 +269,7 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
     completed_ = true;
     has_error = true;
     error = std::move(error_);
+    lock.unlock();
 
     fireCallbacks();
     finished_cv_.notify_all();
@@ -1,4 +1,5 @@
 #include <ATen/core/op_registration/op_registration.h>
+#include <c10/util/InitStats.h>
 #if !defined(CAFFE2_IS_XPLAT_BUILD)
 #include <torch/csrc/jit/script/function_schema_parser.h>
 #endif
@@ -37,6 +38,7 @@ private:
 };
 
 void RegisterOperators::checkSchemaAndRegisterOp_(Options&& options) {
+  InitTimer timer("c10::RegisterOperators");
   TORCH_CHECK(options.schemaOrName_.has_value(), "In operator registration: Tried to register an operator without specifying a schema or operator name.");
   if (options.schemaOrName_->is_right()) {
     // schema was explicitly specified. Check it matches the inferred one and register the op.
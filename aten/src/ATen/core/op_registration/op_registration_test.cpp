@@ -12,6 +12,7 @@
 
 #include <ATen/core/boxing/test_helpers.h>
 #include <ATen/core/op_registration/op_registration.h>
+#include <ATen/core/op_registration/op_whitelist.h>
 #include <ATen/core/Tensor.h>
 #include <functional>
 
@@ -560,6 +561,49 @@ TEST(OperatorRegistrationTest, whenRegisteringMultipleKernelsInSameOpCallAndCall
   }, "CUDATensorId");
 }
 
+struct MockMixedArgsKernel final : OperatorKernel {
+  MockMixedArgsKernel(bool* called): called_(called) {}
+
+  void operator()(int64_t, const c10::List<Tensor>&, double, const c10::optional<Tensor>&, std::string, c10::List<int64_t>) {
+    *called_ = true;
+  }
+private:
+  bool* called_;
+};
+
+TEST(OperatorRegistrationTest, givenOpWithMixedArguments_whenCallingBoxed_thenDispatchesOnTensorArguments) {
+  bool called_kernel_cpu = false;
+  bool called_kernel_cuda = false;
+  auto registrar = c10::RegisterOperators().op("_test::mixed(int a, Tensor[] b, float c, Tensor? d, str e, int[] f) -> ()", c10::RegisterOperators::options()
+    .kernel<MockMixedArgsKernel>(c10::DispatchKey::CPUTensorId, &called_kernel_cpu)
+    .kernel<MockMixedArgsKernel>(c10::DispatchKey::CUDATensorId, &called_kernel_cuda));
+
+  auto op = Dispatcher::singleton().findSchema({"_test::mixed", ""});
+  ASSERT_TRUE(op.has_value()); // assert schema is registered
+
+  // The dispatch key comes from the tensor list
+  called_kernel_cpu = called_kernel_cuda = false;
+  callOp(*op, 1, c10::List<Tensor>({dummyTensor(c10::DispatchKey::CUDATensorId)}), 2.0, c10::IValue(), std::string("text"), c10::List<int64_t>({3, 4}));
+  EXPECT_FALSE(called_kernel_cpu);
+  EXPECT_TRUE(called_kernel_cuda);
+
+  // The dispatch key comes from the optional tensor
+  called_kernel_cpu = called_kernel_cuda = false;
+  callOp(*op, 1, c10::List<Tensor>(), 2.0, dummyTensor(c10::DispatchKey::CUDATensorId), std::string("text"), c10::List<int64_t>({3, 4}));
+  EXPECT_FALSE(called_kernel_cpu);
+  EXPECT_TRUE(called_kernel_cuda);
+
+  called_kernel_cpu = called_kernel_cuda = false;
+  callOp(*op, 1, c10::List<Tensor>({dummyTensor(c10::DispatchKey::CPUTensorId)}), 2.0, dummyTensor(c10::DispatchKey::CPUTensorId), std::string("text"), c10::List<int64_t>());
+  EXPECT_TRUE(called_kernel_cpu);
+  EXPECT_FALSE(called_kernel_cuda);
+
+  // Without any tensor there is no backend to dispatch to
+  expectThrows<c10::Error>([&] {
+    callOp(*op, 1, c10::List<Tensor>(), 2.0, c10::IValue(), std::string("text"), c10::List<int64_t>({3, 4}));
+  }, "There were no tensor arguments to this function");
+}
+
 TEST(OperatorRegistrationTest, whenRegisteringMultipleKernelsInSameOpCallOutOfScopeAndCalling_thenFails) {
   auto registrar0 = c10::RegisterOperators().op("_test::dummy(Tensor dummy) -> ()");
   {
@@ -784,6 +828,29 @@ TEST(OperatorRegistrationTest, whenRegisteringBackendFallbackKernelAndCatchallKe
   EXPECT_EQ("hello _test::dummy", stack[1].toString()->string());
 }
 
+TEST(OperatorRegistrationTest, whenRegisteringBackendFallbackKernelAfterOperator_thenCallsFallbackKernel) {
+  auto registrar1 = c10::RegisterOperators().op("_test::dummy(Tensor dummy, str input) -> ()", c10::RegisterOperators::options()
+      .catchAllKernel([] (Tensor, std::string) {
+        called = true;
+      }));
+  auto op = Dispatcher::singleton().findSchema({"_test::dummy", ""});
+  ASSERT_TRUE(op.has_value());
+
+  {
+    auto registrar = c10::Dispatcher::singleton().registerBackendFallbackKernel(c10::DispatchKey::CPUTensorId, c10::KernelFunction::makeFromBoxedFunction<&backend_fallback_kernel>());
+
+    called = false;
+    auto stack = callOp(*op, dummyTensor(c10::DispatchKey::CPUTensorId), "hello ");
+    EXPECT_FALSE(called);
+    EXPECT_EQ("hello _test::dummy", stack[1].toString()->string());
+  }
+
+  // after the fallback kernel is deregistered, the catch-all kernel is called again
+  called = false;
+  callOp(*op, dummyTensor(c10::DispatchKey::CPUTensorId), "hello ");
+  EXPECT_TRUE(called);
+}
+
 bool called_autograd = false;
 bool called_nonautograd = false;
 
@@ -1287,6 +1354,30 @@ TEST(OperatorRegistrationTest, testAvailableArgTypes) {
     "(Dict(str, Dict(int, str)?[])[] a) -> Dict(str, Dict(int, str)?[])[]");
 }
 
+TEST(OperatorRegistrationTest, whenCheckingOpWhitelist_thenMatchesWholeOperatorNames) {
+  using c10::impl::op_whitelist_contains;
+  using c10::impl::op_name_from_schema;
+  static_assert(op_whitelist_contains("aten::add.Tensor;aten::conv2d", "aten::conv2d"), "");
+  static_assert(op_whitelist_contains("aten::add.Tensor;aten::conv2d", "aten::add.Tensor"), "");
+  static_assert(!op_whitelist_contains("aten::add.Tensor;aten::conv2d", "aten::add"), "");
+  static_assert(!op_whitelist_contains("aten::add.Tensor;aten::conv2d", "aten::conv"), "");
+  static_assert(!op_whitelist_contains("", "aten::add"), "");
+  static_assert(op_name_from_schema("aten::add.Tensor(Tensor self, Tensor other) -> Tensor").compare("aten::add.Tensor") == 0, "");
+  static_assert(op_name_from_schema("aten::add.Tensor").compare("aten::add.Tensor") == 0, "");
+}
+
+TEST(OperatorRegistrationTest, whenRegisteringSelectively_thenOnlyRegistersSelectedOps) {
+  auto registrar = c10::RegisterOperators();
+  c10::impl::if_op_selected<true>([&](auto _) {
+    std::move(_(registrar)).op("_test::selected(Tensor dummy) -> ()", RegisterOperators::options().kernel<DummyKernel>(c10::DispatchKey::CPUTensorId));
+  });
+  c10::impl::if_op_selected<false>([&](auto _) {
+    std::move(_(registrar)).op("_test::not_selected(Tensor dummy) -> ()", RegisterOperators::options().kernel<DummyKernel>(c10::DispatchKey::CPUTensorId));
+  });
+  EXPECT_TRUE(Dispatcher::singleton().findSchema({"_test::selected", ""}).has_value());
+  EXPECT_FALSE(Dispatcher::singleton().findSchema({"_test::not_selected", ""}).has_value());
+}
+
 }
 
 #pragma GCC diagnostic pop
@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * Selective build of operator registrations.
+ *
+ * A custom build can be configured with a list of the operators its models
+ * need (SELECTED_OP_LIST, e.g. the output of binaries/dump_operator_names.cc).
+ * CMake turns that list into C10_OPERATOR_WHITELIST, a ';'-separated string
+ * of operator names in c10/macros/cmake_macros.h, and registrations that use
+ * the helpers below are compiled in only if their operator is in it:
+ *
+ * > static auto registry = c10::RegisterOperators();
+ * > TORCH_SELECTIVE_OP(registry, "my_op::add.Tensor(Tensor a, Tensor b) -> Tensor",
+ * >     c10::RegisterOperators::options().kernel<&add_kernel>(DispatchKey::CPUTensorId));
+ *
+ * The registration and its kernel are not only skipped at library load, they
+ * are never instantiated, so the kernel doesn't take up space in the binary
+ * either. Without a whitelist, every operator is registered.
+ */
+
+#include <c10/macros/Macros.h>
+#include <c10/util/string_view.h>
+
+#include <utility>
+
+namespace c10 {
+namespace impl {
+
+// Whether `item` is one of the ';'-separated entries of `list`.
+constexpr bool op_whitelist_contains(string_view list, string_view item) {
+  size_t begin = 0;
+  while (begin < list.size()) {
+    size_t end = list.find(';', begin);
+    if (end == string_view::npos) {
+      end = list.size();
+    }
+    if (list.substr(begin, end - begin).compare(item) == 0) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+
+// The operator name of a schema, e.g. "aten::add.Tensor" for
+// "aten::add.Tensor(Tensor self, Tensor other) -> Tensor". A name without
+// arguments is returned as is.
+constexpr string_view op_name_from_schema(string_view schema) {
+  return schema.substr(0, schema.find('('));
+}
+
+// Whether the operator of `schema` is part of this build.
+constexpr bool op_whitelist_check(string_view schema) {
+#ifdef C10_OPERATOR_WHITELIST
+  return op_whitelist_contains(
+      C10_OPERATOR_WHITELIST, op_name_from_schema(schema));
+#else
+  return true;
+#endif
+}
+
+struct op_selected_identity final {
+  template <class T>
+  constexpr T&& operator()(T&& value) const noexcept {
+    return std::forward<T>(value);
+  }
+};
+
+// Calls `register_op` with an identity functor if `Selected`, and does
+// nothing otherwise. `register_op` should be a generic lambda that routes the
+// registration through the functor, so that nothing in it is instantiated for
+// an operator that isn't selected.
+template <bool Selected, class Func>
+inline std::enable_if_t<Selected> if_op_selected(Func&& register_op) {
+  std::forward<Func>(register_op)(op_selected_identity());
+}
+
+template <bool Selected, class Func>
+inline std::enable_if_t<!Selected> if_op_selected(Func&& /*register_op*/) {}
+
+} // namespace impl
+} // namespace c10
+
+// Registers an operator with the c10::RegisterOperators `registry` if it is
+// part of this build, see above.
+#define TORCH_SELECTIVE_OP(registry, schema, ...)                              \
+  ::c10::impl::if_op_selected<::c10::impl::op_whitelist_check(schema)>(        \
+      [&](auto _) { std::move(_(registry)).op(schema, __VA_ARGS__); })
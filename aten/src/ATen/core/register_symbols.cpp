@@ -1,4 +1,5 @@
 #include <ATen/core/interned_strings_class.h>
+#include <c10/util/InitStats.h>
 
 namespace c10 {
 
@@ -28,6 +29,8 @@ InternedStrings::InternedStrings()
   // operator[]s) which would take several minutes to optimize. A
   // static C array of constexpr-constructible structs takes instead
   // no time to compile.
+  InitTimer timer("c10::InternedStrings");
+  string_to_sym_.reserve(static_cast<size_t>(_keys::num_symbols));
   for (const auto& entry : entries) {
     string_to_sym_[entry.qual_name] = entry.sym;
     sym_to_info_[entry.sym] = {
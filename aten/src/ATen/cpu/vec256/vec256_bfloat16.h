@@ -0,0 +1,468 @@
+#pragma once
+
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec256/vec256_base.h>
+#include <ATen/cpu/vec256/vec256_float.h>
+#include <c10/util/BFloat16.h>
+
+#include <tuple>
+
+namespace at {
+namespace vec256 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+// Note [Vec256 of reduced floating point types]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BFloat16 and Half have no arithmetic instructions on the CPUs we compile
+// for, so Vec256<BFloat16> and Vec256<Half> hold 16 raw 16 bit values, and
+// every operation widens them to two Vec256<float>, runs the float operation
+// and rounds the results back to nearest even, as the scalar conversions do.
+// Loads and stores move half the bytes of float, which is what makes them
+// worth it for memory bound kernels. Operations that only look at the bits,
+// like abs, neg and the bitwise operators, never convert.
+//
+// Vec256ReducedFloat is the part shared by both types, which only differ in
+// how they convert from and to float: see cvt_to_fp32 and cvt_from_fp32.
+
+#if defined(__AVX2__) && !defined(_MSC_VER)
+
+// Widens the 16 values of a to float, the first 8 in o1 and the last 8 in o2
+template <typename T>
+inline void cvt_to_fp32(const __m256i& a, __m256& o1, __m256& o2);
+
+// Rounds the 8 floats of a and the 8 floats of b to the 16 values returned
+template <typename T>
+inline __m256i cvt_from_fp32(const __m256& a, const __m256& b);
+
+template <>
+inline void cvt_to_fp32<BFloat16>(const __m256i& a, __m256& o1, __m256& o2) {
+  // A bfloat16 is the upper half of the float with the same value
+  __m128i lo = _mm256_extractf128_si256(a, 0);
+  __m128i hi = _mm256_extractf128_si256(a, 1);
+  o1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(lo), 16));
+  o2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(hi), 16));
+}
+
+// The vector version of c10::detail::round_to_nearest_even
+inline __m256i cvtfp32_bf16_rne(const __m256& a) {
+  const __m256i ones = _mm256_set1_epi32(0x1);
+  const __m256i bias = _mm256_set1_epi32(0x7FFF);
+  const __m256i nan = _mm256_set1_epi32(0x7FC0);
+  __m256i bits = _mm256_castps_si256(a);
+  // rounding_bias = ((bits >> 16) & 1) + 0x7FFF
+  __m256i t = _mm256_and_si256(_mm256_srli_epi32(bits, 16), ones);
+  t = _mm256_add_epi32(t, bias);
+  t = _mm256_srli_epi32(_mm256_add_epi32(t, bits), 16);
+  // NaNs become the canonical quiet NaN instead of being rounded to infinity
+  __m256i ordered = _mm256_castps_si256(_mm256_cmp_ps(a, a, _CMP_ORD_Q));
+  return _mm256_blendv_epi8(nan, t, ordered);
+}
+
+template <>
+inline __m256i cvt_from_fp32<BFloat16>(const __m256& a, const __m256& b) {
+  // The values fit in 16 bits, so the saturation of packus does nothing. It
+  // packs per 128 bit lane: {a0-3, b0-3, a4-7, b4-7}, which the permutation
+  // puts back in order.
+  __m256i packed =
+      _mm256_packus_epi32(cvtfp32_bf16_rne(a), cvtfp32_bf16_rne(b));
+  return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+// Packs the results of two float comparisons to 16 bit masks
+inline __m256i merge_compare_result(const __m256& a, const __m256& b) {
+  __m256i packed = _mm256_packs_epi32(
+      _mm256_castps_si256(a), _mm256_castps_si256(b));
+  return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+// See Note [Vec256 of reduced floating point types]
+template <typename T>
+struct Vec256ReducedFloat {
+protected:
+  __m256i values;
+
+  template <typename Op>
+  Vec256<T> map_as_fp32(const Op& op) const {
+    __m256 lo, hi;
+    cvt_to_fp32<T>(values, lo, hi);
+    return cvt_from_fp32<T>(op(Vec256<float>(lo)), op(Vec256<float>(hi)));
+  }
+  template <typename Op>
+  Vec256<T> map2_as_fp32(const Vec256<T>& b, const Op& op) const {
+    __m256 a_lo, a_hi, b_lo, b_hi;
+    cvt_to_fp32<T>(values, a_lo, a_hi);
+    cvt_to_fp32<T>(b, b_lo, b_hi);
+    return cvt_from_fp32<T>(
+        op(Vec256<float>(a_lo), Vec256<float>(b_lo)),
+        op(Vec256<float>(a_hi), Vec256<float>(b_hi)));
+  }
+  template <typename Op>
+  Vec256<T> compare_as_fp32(const Vec256<T>& b, const Op& op) const {
+    __m256 a_lo, a_hi, b_lo, b_hi;
+    cvt_to_fp32<T>(values, a_lo, a_hi);
+    cvt_to_fp32<T>(b, b_lo, b_hi);
+    return merge_compare_result(
+        op(Vec256<float>(a_lo), Vec256<float>(b_lo)),
+        op(Vec256<float>(a_hi), Vec256<float>(b_hi)));
+  }
+public:
+  using value_type = T;
+  static constexpr int size() {
+    return 16;
+  }
+  Vec256ReducedFloat() {}
+  Vec256ReducedFloat(__m256i v) : values(v) {}
+  Vec256ReducedFloat(T val) {
+    values = _mm256_set1_epi16(static_cast<int16_t>(val.x));
+  }
+  Vec256ReducedFloat(T val1, T val2, T val3, T val4,
+                     T val5, T val6, T val7, T val8,
+                     T val9, T val10, T val11, T val12,
+                     T val13, T val14, T val15, T val16) {
+    values = _mm256_setr_epi16(
+        val1.x, val2.x, val3.x, val4.x, val5.x, val6.x, val7.x, val8.x,
+        val9.x, val10.x, val11.x, val12.x, val13.x, val14.x, val15.x, val16.x);
+  }
+  operator __m256i() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec256<T> blend(const Vec256<T>& a, const Vec256<T>& b) {
+    __at_align32__ int16_t tmp_mask[size()];
+    for (int i = 0; i < size(); ++i) {
+      tmp_mask[i] = (mask >> i) & 0x1 ? -1 : 0;
+    }
+    return _mm256_blendv_epi8(
+        a, b, _mm256_load_si256(reinterpret_cast<const __m256i*>(tmp_mask)));
+  }
+  static Vec256<T> blendv(const Vec256<T>& a, const Vec256<T>& b,
+                          const Vec256<T>& mask) {
+    return _mm256_blendv_epi8(a, b, mask);
+  }
+  static Vec256<T> arange(T base = 0.f, T step = 1.f) {
+    __at_align32__ T tmp_values[size()];
+    for (int i = 0; i < size(); ++i) {
+      tmp_values[i] = static_cast<float>(base) + i * static_cast<float>(step);
+    }
+    return loadu(tmp_values);
+  }
+  static Vec256<T> set(const Vec256<T>& a, const Vec256<T>& b,
+                       int64_t count = size()) {
+    __at_align32__ int16_t tmp_mask[size()];
+    for (int i = 0; i < size(); ++i) {
+      tmp_mask[i] = i < count ? -1 : 0;
+    }
+    return _mm256_blendv_epi8(
+        a, b, _mm256_load_si256(reinterpret_cast<const __m256i*>(tmp_mask)));
+  }
+  static Vec256<T> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size())
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __at_align32__ int16_t tmp_values[size()];
+    // Ensure uninitialized memory does not change the output value
+    // See https://github.com/pytorch/pytorch/issues/32502 for more details
+    for (auto i = 0; i < size(); ++i) {
+      tmp_values[i] = 0;
+    }
+    std::memcpy(tmp_values, ptr, count * sizeof(T));
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(tmp_values));
+  }
+  void store(void* ptr, int64_t count = size()) const {
+    if (count == size()) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), values);
+    } else if (count > 0) {
+      __at_align32__ int16_t tmp_values[size()];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(tmp_values), values);
+      std::memcpy(ptr, tmp_values, count * sizeof(T));
+    }
+  }
+  const T& operator[](int idx) const = delete;
+  T& operator[](int idx) = delete;
+  int zero_mask() const {
+    // returns an integer mask where all zero elements are translated to 1-bit and others are translated to 0-bit
+    __m256 lo, hi;
+    cvt_to_fp32<T>(values, lo, hi);
+    const __m256 zero = _mm256_set1_ps(0.0f);
+    int mask_lo = _mm256_movemask_ps(_mm256_cmp_ps(lo, zero, _CMP_EQ_OQ));
+    int mask_hi = _mm256_movemask_ps(_mm256_cmp_ps(hi, zero, _CMP_EQ_OQ));
+    return mask_lo | (mask_hi << 8);
+  }
+  Vec256<T> map(T (*f)(T)) const {
+    __at_align32__ T tmp[size()];
+    store(tmp);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  // Both types keep the sign in the highest bit
+  Vec256<T> abs() const {
+    return _mm256_and_si256(values, _mm256_set1_epi16(0x7FFF));
+  }
+  Vec256<T> angle() const {
+    return _mm256_setzero_si256();
+  }
+  Vec256<T> real() const {
+    return values;
+  }
+  Vec256<T> imag() const {
+    return _mm256_setzero_si256();
+  }
+  Vec256<T> conj() const {
+    return values;
+  }
+  Vec256<T> neg() const {
+    return _mm256_xor_si256(values, _mm256_set1_epi16(-0x8000));
+  }
+  Vec256<T> acos() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.acos(); });
+  }
+  Vec256<T> asin() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.asin(); });
+  }
+  Vec256<T> atan() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.atan(); });
+  }
+  Vec256<T> atan2(const Vec256<T>& b) const {
+    return map2_as_fp32(b, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x.atan2(y);
+    });
+  }
+  Vec256<T> erf() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.erf(); });
+  }
+  Vec256<T> erfc() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.erfc(); });
+  }
+  Vec256<T> erfinv() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.erfinv(); });
+  }
+  Vec256<T> exp() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.exp(); });
+  }
+  Vec256<T> expm1() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.expm1(); });
+  }
+  Vec256<T> log() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.log(); });
+  }
+  Vec256<T> log2() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.log2(); });
+  }
+  Vec256<T> log10() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.log10(); });
+  }
+  Vec256<T> log1p() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.log1p(); });
+  }
+  Vec256<T> frac() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.frac(); });
+  }
+  Vec256<T> sin() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.sin(); });
+  }
+  Vec256<T> sinh() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.sinh(); });
+  }
+  Vec256<T> cos() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.cos(); });
+  }
+  Vec256<T> cosh() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.cosh(); });
+  }
+  Vec256<T> ceil() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.ceil(); });
+  }
+  Vec256<T> floor() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.floor(); });
+  }
+  Vec256<T> round() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.round(); });
+  }
+  Vec256<T> tan() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.tan(); });
+  }
+  Vec256<T> tanh() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.tanh(); });
+  }
+  Vec256<T> trunc() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.trunc(); });
+  }
+  Vec256<T> lgamma() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.lgamma(); });
+  }
+  Vec256<T> sqrt() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.sqrt(); });
+  }
+  Vec256<T> reciprocal() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.reciprocal(); });
+  }
+  Vec256<T> rsqrt() const {
+    return map_as_fp32([](const Vec256<float>& x) { return x.rsqrt(); });
+  }
+  Vec256<T> pow(const Vec256<T>& b) const {
+    return map2_as_fp32(b, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x.pow(y);
+    });
+  }
+  // The masks have all the 16 bits of a lane set, like the float ones have
+  // all the 32 bits set.
+  Vec256<T> operator==(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x == y;
+    });
+  }
+  Vec256<T> operator!=(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x != y;
+    });
+  }
+  Vec256<T> operator<(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x < y;
+    });
+  }
+  Vec256<T> operator<=(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x <= y;
+    });
+  }
+  Vec256<T> operator>(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x > y;
+    });
+  }
+  Vec256<T> operator>=(const Vec256<T>& other) const {
+    return compare_as_fp32(other, [](const Vec256<float>& x, const Vec256<float>& y) {
+      return x >= y;
+    });
+  }
+};
+
+template <typename T, typename Op>
+Vec256<T> inline binary_op_as_fp32(const Vec256<T>& a, const Vec256<T>& b, const Op& op) {
+  __m256 a_lo, a_hi, b_lo, b_hi;
+  cvt_to_fp32<T>(a, a_lo, a_hi);
+  cvt_to_fp32<T>(b, b_lo, b_hi);
+  return cvt_from_fp32<T>(
+      op(Vec256<float>(a_lo), Vec256<float>(b_lo)),
+      op(Vec256<float>(a_hi), Vec256<float>(b_hi)));
+}
+
+template <typename T, typename Op>
+Vec256<T> inline ternary_op_as_fp32(const Vec256<T>& a, const Vec256<T>& b,
+                                    const Vec256<T>& c, const Op& op) {
+  __m256 a_lo, a_hi, b_lo, b_hi, c_lo, c_hi;
+  cvt_to_fp32<T>(a, a_lo, a_hi);
+  cvt_to_fp32<T>(b, b_lo, b_hi);
+  cvt_to_fp32<T>(c, c_lo, c_hi);
+  return cvt_from_fp32<T>(
+      op(Vec256<float>(a_lo), Vec256<float>(b_lo), Vec256<float>(c_lo)),
+      op(Vec256<float>(a_hi), Vec256<float>(b_hi), Vec256<float>(c_hi)));
+}
+
+// Specializes the free functions of Vec256<T> for a reduced floating point
+// type, after its class
+#define DEFINE_REDUCED_FLOAT_BINARY_OP(T, name, expr)                       \
+template <>                                                                 \
+Vec256<T> inline name(const Vec256<T>& a, const Vec256<T>& b) {             \
+  return binary_op_as_fp32(                                                 \
+      a, b, [](const Vec256<float>& x, const Vec256<float>& y) {            \
+        return expr;                                                        \
+      });                                                                   \
+}
+
+#define DEFINE_REDUCED_FLOAT_OPS(T)                                         \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, operator+, x + y)                         \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, operator-, x - y)                         \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, operator*, x * y)                         \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, operator/, x / y)                         \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, maximum, maximum(x, y))                   \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, minimum, minimum(x, y))                   \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, clamp_max, clamp_max(x, y))               \
+DEFINE_REDUCED_FLOAT_BINARY_OP(T, clamp_min, clamp_min(x, y))               \
+                                                                            \
+template <>                                                                 \
+Vec256<T> inline clamp(const Vec256<T>& a, const Vec256<T>& min,            \
+                       const Vec256<T>& max) {                              \
+  return ternary_op_as_fp32(                                                \
+      a, min, max,                                                          \
+      [](const Vec256<float>& x, const Vec256<float>& lo,                   \
+         const Vec256<float>& hi) { return clamp(x, lo, hi); });            \
+}                                                                           \
+                                                                            \
+template <>                                                                 \
+Vec256<T> inline fmadd(const Vec256<T>& a, const Vec256<T>& b,              \
+                       const Vec256<T>& c) {                                \
+  return ternary_op_as_fp32(                                                \
+      a, b, c,                                                              \
+      [](const Vec256<float>& x, const Vec256<float>& y,                    \
+         const Vec256<float>& z) { return fmadd(x, y, z); });               \
+}                                                                           \
+                                                                            \
+template <>                                                                 \
+Vec256<T> inline operator&(const Vec256<T>& a, const Vec256<T>& b) {        \
+  return _mm256_and_si256(a, b);                                            \
+}                                                                           \
+                                                                            \
+template <>                                                                 \
+Vec256<T> inline operator|(const Vec256<T>& a, const Vec256<T>& b) {        \
+  return _mm256_or_si256(a, b);                                             \
+}                                                                           \
+                                                                            \
+template <>                                                                 \
+Vec256<T> inline operator^(const Vec256<T>& a, const Vec256<T>& b) {        \
+  return _mm256_xor_si256(a, b);                                            \
+}
+
+template <> class Vec256<BFloat16> : public Vec256ReducedFloat<BFloat16> {
+public:
+  using Vec256ReducedFloat<BFloat16>::Vec256ReducedFloat;
+  Vec256() {}
+};
+
+DEFINE_REDUCED_FLOAT_OPS(BFloat16)
+
+// Converts to float, e.g. to accumulate in float, the first 8 values in the
+// first vector
+inline std::tuple<Vec256<float>, Vec256<float>> convert_bfloat16_float(
+    const Vec256<BFloat16>& a) {
+  __m256 o1, o2;
+  cvt_to_fp32<BFloat16>(a, o1, o2);
+  return std::make_tuple(o1, o2);
+}
+
+inline Vec256<BFloat16> convert_float_bfloat16(
+    const Vec256<float>& a, const Vec256<float>& b) {
+  return cvt_from_fp32<BFloat16>(a, b);
+}
+
+#else // defined(__AVX2__) && !defined(_MSC_VER)
+
+inline std::tuple<Vec256<float>, Vec256<float>> convert_bfloat16_float(
+    const Vec256<BFloat16>& a) {
+  constexpr int64_t K = Vec256<BFloat16>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ BFloat16 arr2[K];
+  a.store(arr2);
+  convert(arr2, arr, K);
+  return std::make_tuple(
+      Vec256<float>::loadu(arr),
+      Vec256<float>::loadu(arr + Vec256<float>::size()));
+}
+
+inline Vec256<BFloat16> convert_float_bfloat16(
+    const Vec256<float>& a, const Vec256<float>& b) {
+  constexpr int64_t K = Vec256<BFloat16>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ BFloat16 arr2[K];
+  a.store(arr);
+  b.store(arr + Vec256<float>::size());
+  convert(arr, arr2, K);
+  return Vec256<BFloat16>::loadu(arr2);
+}
+
+#endif // defined(__AVX2__) && !defined(_MSC_VER)
+
+}}}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec256/vec256_base.h>
+#include <ATen/cpu/vec256/vec256_bfloat16.h>
+#include <c10/util/Half.h>
+
+namespace at {
+namespace vec256 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+// See Note [Vec256 of reduced floating point types]. The conversions are
+// single F16C instructions, which every CPU with AVX2 has.
+#if defined(__AVX2__) && defined(__F16C__) && !defined(_MSC_VER)
+
+template <>
+inline void cvt_to_fp32<Half>(const __m256i& a, __m256& o1, __m256& o2) {
+  o1 = _mm256_cvtph_ps(_mm256_extractf128_si256(a, 0));
+  o2 = _mm256_cvtph_ps(_mm256_extractf128_si256(a, 1));
+}
+
+template <>
+inline __m256i cvt_from_fp32<Half>(const __m256& a, const __m256& b) {
+  __m128i lo = _mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m128i hi = _mm256_cvtps_ph(b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  return _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+template <> class Vec256<Half> : public Vec256ReducedFloat<Half> {
+public:
+  using Vec256ReducedFloat<Half>::Vec256ReducedFloat;
+  Vec256() {}
+};
+
+DEFINE_REDUCED_FLOAT_OPS(Half)
+
+inline std::tuple<Vec256<float>, Vec256<float>> convert_half_float(
+    const Vec256<Half>& a) {
+  __m256 o1, o2;
+  cvt_to_fp32<Half>(a, o1, o2);
+  return std::make_tuple(o1, o2);
+}
+
+inline Vec256<Half> convert_float_half(
+    const Vec256<float>& a, const Vec256<float>& b) {
+  return cvt_from_fp32<Half>(a, b);
+}
+
+#else // defined(__AVX2__) && defined(__F16C__) && !defined(_MSC_VER)
+
+inline std::tuple<Vec256<float>, Vec256<float>> convert_half_float(
+    const Vec256<Half>& a) {
+  constexpr int64_t K = Vec256<Half>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ Half arr2[K];
+  a.store(arr2);
+  convert(arr2, arr, K);
+  return std::make_tuple(
+      Vec256<float>::loadu(arr),
+      Vec256<float>::loadu(arr + Vec256<float>::size()));
+}
+
+inline Vec256<Half> convert_float_half(
+    const Vec256<float>& a, const Vec256<float>& b) {
+  constexpr int64_t K = Vec256<Half>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ Half arr2[K];
+  a.store(arr);
+  b.store(arr + Vec256<float>::size());
+  convert(arr, arr2, K);
+  return Vec256<Half>::loadu(arr2);
+}
+
+#endif // defined(__AVX2__) && defined(__F16C__) && !defined(_MSC_VER)
+
+}}}
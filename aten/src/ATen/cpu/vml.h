@@ -37,10 +37,14 @@
 // [Note SSE-AVX transitions]
 // There is a bug in Glibc2.23
 // https://bugs.launchpad.net/ubuntu/+source/glibc/+bug/1663280. Calling zeroall
-// when using AVX/AVX2 code resolves this.
+// when using AVX/AVX2 code resolves this. BFloat16 is computed with the float
+// functions.
 #if defined(__AVX__) && defined(__GLIBC__) && __GLIBC_MINOR__ == 23
 #define DL_RUNTIME_BUG(op, type)                              \
-  using value_t = typename at::native::ztype<type>::value_t;  \
+  using value_t = typename std::conditional<                  \
+      std::is_same<type, c10::BFloat16>::value,               \
+      float,                                                  \
+      typename at::native::ztype<type>::value_t>::type;       \
   volatile value_t x = (value_t)(1);                          \
   x = std::op(x);                                             \
   _mm256_zeroall();
@@ -1,4 +1,5 @@
 #include <ATen/CUDAGenerator.h>
+#include <ATen/cuda/CUDAGraphsUtils.h>
 #include <c10/cuda/CUDAFunctions.h>
 
 namespace at {
@@ -142,11 +143,101 @@ uint64_t CUDAGenerator::philox_offset_per_thread() {
  * See Note [Acquire lock when using random generators]
  */
 std::pair<uint64_t, uint64_t> CUDAGenerator::philox_engine_inputs(uint64_t increment) {
+  TORCH_CHECK(!at::cuda::currentStreamIsCapturing(),
+              "This CUDA RNG consumer is not safe for CUDA graph capture: it "
+              "reads the seed and offset on the host. Use philox_cuda_state() "
+              "instead, or run it outside of the captured region.");
   uint64_t offset = this->philox_offset_per_thread_;
   this->philox_offset_per_thread_ += increment;
   return std::make_pair(this->seed_, offset);
 }
 
+/**
+ * Note [CUDA Graph-safe RNG states]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A kernel captured into a CUDA graph is replayed with the arguments it was
+ * captured with, so a seed and offset passed by value would make every replay
+ * draw the same randoms. Instead, while a graph is being captured:
+ *
+ *   - CUDAGraph::capture_begin() calls capture_prologue() with two device
+ *     scalars that will hold the seed and the base offset of each replay.
+ *   - philox_cuda_state() hands out those pointers together with the offset
+ *     of the kernel relative to the start of the graph, and advances the
+ *     latter instead of philox_offset_per_thread_.
+ *   - capture_epilogue() returns the total offset the graph consumes, which
+ *     CUDAGraph::replay() reserves (through philox_engine_inputs()) before
+ *     every launch, writing the resulting seed and offset to the two scalars.
+ *
+ * Each replay thus advances the generator like running the captured ops
+ * eagerly would, and kernels read the actual values with
+ * at::cuda::philox::unpack().
+ *
+ * Only the default generator of the capturing device is prepared this way,
+ * so other generators refuse to be used during capture.
+ */
+
+/**
+ * Gets the PhiloxCudaState to be passed to a kernel using
+ * curandStatePhilox4_32_10. Same as philox_engine_inputs(), except that it
+ * can be used while a CUDA graph is being captured.
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+PhiloxCudaState CUDAGenerator::philox_cuda_state(uint64_t increment) {
+  if (at::cuda::currentStreamIsCapturing()) {
+    TORCH_CHECK(graph_expects_this_gen_,
+                "philox_cuda_state for an unexpected CUDA generator used during "
+                "capture. Only the default generator of the capturing device "
+                "may be used inside a CUDA graph.");
+    // rounds up to a multiple of 4, like the offsets curand uses
+    increment = ((increment + 3) / 4) * 4;
+    TORCH_CHECK(offset_intragraph_ + increment <= UINT32_MAX,
+                "The philox offset consumed by a CUDA graph overflowed");
+    uint32_t offset = this->offset_intragraph_;
+    this->offset_intragraph_ += increment;
+    return PhiloxCudaState(this->seed_extragraph_,
+                           this->offset_extragraph_,
+                           offset);
+  }
+  TORCH_CHECK(!graph_expects_this_gen_,
+              "CUDA generator expects graph capture to be underway, "
+              "but the current stream is not capturing.");
+  uint64_t offset = this->philox_offset_per_thread_;
+  this->philox_offset_per_thread_ += increment;
+  return PhiloxCudaState(this->seed_, offset);
+}
+
+/**
+ * Prepares the generator for a CUDA graph capture: until capture_epilogue(),
+ * kernels read their seed and base offset from the given device scalars.
+ *
+ * See Note [CUDA Graph-safe RNG states]
+ */
+void CUDAGenerator::capture_prologue(int64_t* seed_extragraph, int64_t* offset_extragraph) {
+  TORCH_CHECK(!graph_expects_this_gen_,
+              "The CUDA generator is already used by a graph being captured");
+  seed_extragraph_ = seed_extragraph;
+  offset_extragraph_ = offset_extragraph;
+  offset_intragraph_ = 0;
+  graph_expects_this_gen_ = true;
+}
+
+/**
+ * Ends the capture started by capture_prologue() and returns the philox
+ * offset consumed by one replay of the captured graph.
+ *
+ * See Note [CUDA Graph-safe RNG states]
+ */
+uint64_t CUDAGenerator::capture_epilogue() {
+  TORCH_CHECK(graph_expects_this_gen_,
+              "capture_epilogue called without a matching capture_prologue");
+  graph_expects_this_gen_ = false;
+  seed_extragraph_ = nullptr;
+  offset_extragraph_ = nullptr;
+  return offset_intragraph_;
+}
+
 /*
  * Gets the DeviceType of CUDAGenerator.
  * Used for type checking during run time.
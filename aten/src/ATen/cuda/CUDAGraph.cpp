@@ -0,0 +1,161 @@
+#include <ATen/cuda/CUDAGraph.h>
+
+#include <ATen/CUDAGenerator.h>
+#include <ATen/Functions.h>
+#include <c10/cuda/CUDAGuard.h>
+
+#include <mutex>
+
+namespace at {
+namespace cuda {
+
+CUDAGraph::CUDAGraph() {
+#if !AT_CUDA_GRAPHS_ENABLED()
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_begin() {
+#if AT_CUDA_GRAPHS_ENABLED()
+  TORCH_CHECK(!capturing_ && !has_graph_exec_,
+              "This CUDAGraph instance already owns a captured graph. "
+              "To capture a new graph, create a new instance or call reset() first.");
+
+  auto stream = at::cuda::getCurrentCUDAStream();
+  TORCH_CHECK(stream != at::cuda::getDefaultCUDAStream(),
+              "CUDA graphs must be captured on a non-default stream. "
+              "(However, after capture, it's ok to replay them on the "
+              "default stream.)");
+  capture_stream_ = stream;
+  capture_dev_ = stream.device_index();
+
+  // The RNG consumers of the graph read their seed and offset from these on
+  // replay, see Note [CUDA Graph-safe RNG states]
+  auto options = TensorOptions().device(Device(kCUDA, capture_dev_)).dtype(kLong);
+  seed_extragraph_ = at::empty({1}, options);
+  offset_extragraph_ = at::empty({1}, options);
+  auto gen = at::cuda::detail::getDefaultCUDAGenerator(capture_dev_);
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    gen->capture_prologue(seed_extragraph_.data_ptr<int64_t>(),
+                          offset_extragraph_.data_ptr<int64_t>());
+  }
+
+  // Captured allocations are served from a private pool, so that the memory
+  // the graph uses stays reserved for its replays.
+  mempool_id_ = c10::cuda::CUDACachingAllocator::createPool("cuda graph");
+  mempool_guard_.reset(new c10::cuda::CUDACachingAllocator::MemPoolGuard(mempool_id_));
+  c10::cuda::CUDACachingAllocator::notifyCaptureBegin();
+  capturing_ = true;
+
+  // cudaStreamCaptureModeGlobal makes other threads' calls that are unsafe
+  // during capture (e.g. cudaStreamSynchronize on the legacy stream) fail
+  // instead of silently invalidating the capture.
+  cudaError_t err = cudaStreamBeginCapture(stream, cudaStreamCaptureModeGlobal);
+  if (err != cudaSuccess) {
+    capturing_ = false;
+    c10::cuda::CUDACachingAllocator::notifyCaptureEnd();
+    mempool_guard_.reset();
+    c10::cuda::CUDACachingAllocator::releasePool(mempool_id_);
+    mempool_id_ = 0;
+    {
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      gen->capture_epilogue();
+    }
+    AT_CUDA_CHECK(err);
+  }
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_end() {
+#if AT_CUDA_GRAPHS_ENABLED()
+  TORCH_CHECK(capturing_, "capture_end() called without a matching capture_begin()");
+  auto stream = at::cuda::getCurrentCUDAStream();
+  TORCH_CHECK(stream == *capture_stream_,
+              "Capture must end on the same stream it began on.");
+
+  cudaError_t err = cudaStreamEndCapture(stream, &graph_);
+  // restore the allocator and the generator even if the capture failed
+  capturing_ = false;
+  c10::cuda::CUDACachingAllocator::notifyCaptureEnd();
+  mempool_guard_.reset();
+  auto gen = at::cuda::detail::getDefaultCUDAGenerator(capture_dev_);
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    wholegraph_increment_ = gen->capture_epilogue();
+  }
+  AT_CUDA_CHECK(err);
+  TORCH_CHECK(graph_ != nullptr, "Invalid capture.");
+
+  AT_CUDA_CHECK(cudaGraphInstantiate(&graph_exec_, graph_, nullptr, nullptr, 0));
+  has_graph_exec_ = true;
+
+  // the instantiated graph is independent of the graph it was made from
+  AT_CUDA_CHECK(cudaGraphDestroy(graph_));
+  graph_ = nullptr;
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::replay() {
+#if AT_CUDA_GRAPHS_ENABLED()
+  TORCH_CHECK(has_graph_exec_,
+              "Called CUDAGraph::replay without a preceding successful capture.");
+
+  c10::cuda::CUDAGuard device_guard(capture_dev_);
+
+  if (wholegraph_increment_ > 0) {
+    // Reserves the philox offsets of all RNG consumers in the graph, which
+    // read the seed and base offset from the device scalars.
+    auto gen = at::cuda::detail::getDefaultCUDAGenerator(capture_dev_);
+    std::pair<uint64_t, uint64_t> rng_engine_inputs;
+    {
+      // See Note [Acquire lock when using random generators]
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      rng_engine_inputs = gen->philox_engine_inputs(wholegraph_increment_);
+    }
+    seed_extragraph_.fill_(static_cast<int64_t>(rng_engine_inputs.first));
+    offset_extragraph_.fill_(static_cast<int64_t>(rng_engine_inputs.second));
+  }
+
+  AT_CUDA_CHECK(cudaGraphLaunch(graph_exec_, at::cuda::getCurrentCUDAStream()));
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::reset() {
+#if AT_CUDA_GRAPHS_ENABLED()
+  // A capture that is still in progress is left as is; the stream is unusable
+  // until the capture is ended anyway.
+  if (capturing_) {
+    return;
+  }
+  if (has_graph_exec_) {
+    C10_CUDA_CHECK_WARN(cudaGraphExecDestroy(graph_exec_));
+    graph_exec_ = nullptr;
+    has_graph_exec_ = false;
+  }
+  if (mempool_id_ != 0) {
+    // the blocks of the pool that are still in use (e.g. the outputs of the
+    // graph) are returned to the system when they are freed
+    c10::cuda::CUDACachingAllocator::releasePool(mempool_id_);
+    mempool_id_ = 0;
+  }
+  seed_extragraph_.reset();
+  offset_extragraph_.reset();
+  wholegraph_increment_ = 0;
+#endif
+}
+
+CUDAGraph::~CUDAGraph() {
+  reset();
+}
+
+} // namespace cuda
+} // namespace at
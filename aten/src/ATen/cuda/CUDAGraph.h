@@ -0,0 +1,86 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <ATen/cuda/CUDAGraphsUtils.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAStream.h>
+#include <c10/util/Optional.h>
+
+#include <memory>
+
+namespace at {
+namespace cuda {
+
+/*
+* CUDAGraph records the kernels a sequence of ops enqueues on the current
+* stream, and replays all of them with a single launch. For small inputs this
+* removes the CPU overhead of launching each kernel (and of the dispatch
+* leading to it), which otherwise dominates.
+*
+*   at::cuda::CUDAStreamGuard guard(at::cuda::getStreamFromPool());
+*   at::cuda::CUDAGraph graph;
+*   graph.capture_begin();
+*   auto out = model(static_input);     // recorded, not executed
+*   graph.capture_end();
+*   static_input.copy_(new_input);
+*   graph.replay();                     // writes the new result into out
+*
+* A replay runs the recorded kernels on the same memory as during capture:
+* - Tensors allocated by the captured ops come from a private pool of the
+*   caching allocator (see CUDACachingAllocator.h) that is reserved for the
+*   graph until it is reset. Tensors the captured ops read from or write to
+*   must be kept alive (and should be updated in place) for as long as the
+*   graph is replayed.
+* - RNG ops draw fresh randoms on every replay, advancing the default
+*   generator of the device as running them eagerly would (see Note
+*   [CUDA Graph-safe RNG states]). Other generators cannot be used.
+* - Shapes, and any decision the ops took on the host, are frozen.
+*
+* Capture must happen on a stream other than the default stream, and the
+* captured ops must not synchronize with the device (e.g. Tensor::item()).
+* CUDA graphs require CUDA 11 and are not supported on ROCm.
+*/
+struct TORCH_CUDA_API CUDAGraph {
+  CUDAGraph();
+  ~CUDAGraph();
+
+  CUDAGraph(const CUDAGraph&) = delete;
+  CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+  // Starts recording the work enqueued on the current stream
+  void capture_begin();
+  // Stops recording and instantiates the graph
+  void capture_end();
+  // Launches the captured graph on the current stream
+  void replay();
+  // Destroys the graph and returns its private pool to the allocator
+  void reset();
+
+ protected:
+#if AT_CUDA_GRAPHS_ENABLED()
+  cudaGraph_t graph_ = nullptr;
+  cudaGraphExec_t graph_exec_ = nullptr;
+#endif
+
+  // a capture is in progress
+  bool capturing_ = false;
+  // graph_exec_ holds an instantiated graph
+  bool has_graph_exec_ = false;
+
+  // private pool of the captured allocations, 0 if none
+  c10::cuda::CUDACachingAllocator::MemPoolId mempool_id_ = 0;
+  std::unique_ptr<c10::cuda::CUDACachingAllocator::MemPoolGuard> mempool_guard_;
+
+  // stream and device the graph was captured on
+  c10::optional<CUDAStream> capture_stream_;
+  DeviceIndex capture_dev_ = -1;
+
+  // device scalars holding the seed and base philox offset of a replay
+  Tensor seed_extragraph_;
+  Tensor offset_extragraph_;
+  // philox offset consumed by one replay
+  uint64_t wholegraph_increment_ = 0;
+};
+
+} // namespace cuda
+} // namespace at
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/cuda/CUDAContext.h>
+
+// Stream capture (cudaStreamBeginCapture / cudaStreamIsCapturing with the
+// capture modes) is only usable from CUDA 11 on, and HIP has no equivalent.
+#if !defined(__HIP_PLATFORM_HCC__) && defined(CUDART_VERSION) && CUDART_VERSION >= 11000
+#define AT_CUDA_GRAPHS_ENABLED() 1
+#else
+#define AT_CUDA_GRAPHS_ENABLED() 0
+#endif
+
+namespace at {
+namespace cuda {
+
+// Whether the current stream of the current device is being captured into a
+// CUDA graph. Work enqueued on it is recorded rather than executed.
+inline bool currentStreamIsCapturing() {
+#if AT_CUDA_GRAPHS_ENABLED()
+  cudaStreamCaptureStatus is_capturing;
+  AT_CUDA_CHECK(cudaStreamIsCapturing(at::cuda::getCurrentCUDAStream(),
+                                      &is_capturing));
+  return is_capturing == cudaStreamCaptureStatusActive;
+#else
+  return false;
+#endif
+}
+
+} // namespace cuda
+} // namespace at
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+namespace at {
+
+// Seed and offset of the philox stream a CUDA RNG kernel draws from, as
+// returned by CUDAGenerator::philox_cuda_state().
+//
+// Outside of CUDA graph capture these are plain values. While a graph is
+// being captured the values are not known yet: each replay of the graph must
+// use fresh randoms, so the kernel reads the seed and the base offset of the
+// whole graph from device memory that CUDAGraph::replay() fills before every
+// launch, and adds the offset of the kernel within the graph to the latter.
+// Kernels turn the state into a (seed, offset) pair with
+// at::cuda::philox::unpack() (see ATen/cuda/PhiloxUtils.cuh).
+struct PhiloxCudaState {
+  PhiloxCudaState() = default;
+  // Called when not capturing
+  PhiloxCudaState(uint64_t seed, uint64_t offset) {
+    seed_ = seed;
+    offset_.val = offset;
+  }
+  // Called when capturing
+  PhiloxCudaState(int64_t* seed,
+                  int64_t* offset_extragraph,
+                  uint32_t offset_intragraph) {
+    seed_ptr_ = seed;
+    offset_.ptr = offset_extragraph;
+    offset_intragraph_ = offset_intragraph;
+    captured_ = true;
+  }
+
+  union Payload {
+    uint64_t val;
+    int64_t* ptr;
+  };
+
+  uint64_t seed_ = 0;
+  int64_t* seed_ptr_ = nullptr;
+  Payload offset_;
+  uint32_t offset_intragraph_ = 0;
+  bool captured_ = false;
+};
+
+} // namespace at
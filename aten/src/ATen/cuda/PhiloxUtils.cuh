@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ATen/cuda/PhiloxCudaState.h>
+
+#include <utility>
+
+namespace at {
+namespace cuda {
+namespace philox {
+
+// Returns the (seed, offset) pair to pass to curand_init() for a
+// PhiloxCudaState. When the kernel was captured into a CUDA graph, they are
+// read from the device memory CUDAGraph::replay() fills before each launch.
+__device__ __forceinline__ std::pair<uint64_t, uint64_t>
+unpack(at::PhiloxCudaState arg) {
+  if (arg.captured_) {
+    return std::make_pair(
+        static_cast<uint64_t>(*arg.seed_ptr_),
+        static_cast<uint64_t>(*(arg.offset_.ptr) + arg.offset_intragraph_));
+  } else {
+    return std::make_pair(arg.seed_, arg.offset_.val);
+  }
+}
+
+} // namespace philox
+} // namespace cuda
+} // namespace at
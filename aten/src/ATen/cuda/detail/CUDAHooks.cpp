@@ -18,6 +18,7 @@
 
 #if AT_CUDNN_ENABLED()
 #include <ATen/cudnn/cudnn-wrapper.h>
+#include <ATen/native/cudnn/ConvBenchmarkCache.h>
 #endif
 
 #ifdef USE_MAGMA
@@ -333,10 +334,30 @@ void CUDAHooks::cuFFTClearPlanCache(int64_t device_index) const {
 #endif
 }
 
+void CUDAHooks::cuDNNSaveBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  at::native::detail::cudnn_save_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot save the cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
+int64_t CUDAHooks::cuDNNLoadBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  return at::native::detail::cudnn_load_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot load the cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
 int CUDAHooks::getNumGPUs() const {
   return at::cuda::device_count();
 }
 
+void CUDAHooks::deviceSynchronize() const {
+  AT_CUDA_CHECK(cudaDeviceSynchronize());
+}
+
 // Sigh, the registry doesn't support namespaces :(
 using at::CUDAHooksRegistry;
 using at::RegistererCUDAHooksRegistry;
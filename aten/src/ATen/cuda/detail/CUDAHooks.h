@@ -34,7 +34,10 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const override;
   int64_t cuFFTGetPlanCacheSize(int64_t device_index) const override;
   void cuFFTClearPlanCache(int64_t device_index) const override;
+  void cuDNNSaveBenchmarkCache(const std::string& path) const override;
+  int64_t cuDNNLoadBenchmarkCache(const std::string& path) const override;
   int getNumGPUs() const override;
+  void deviceSynchronize() const override;
 };
 
 }}} // at::cuda::detail
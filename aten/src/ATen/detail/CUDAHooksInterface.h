@@ -152,9 +152,22 @@ struct CAFFE2_API CUDAHooksInterface {
     TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
+  virtual void cuDNNSaveBenchmarkCache(const std::string& path) const {
+    TORCH_CHECK(false, "Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual int64_t cuDNNLoadBenchmarkCache(const std::string& path) const {
+    TORCH_CHECK(false, "Cannot access cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual int getNumGPUs() const {
     return 0;
   }
+
+  // Waits for the work on the current device to finish
+  virtual void deviceSynchronize() const {
+    TORCH_CHECK(false, "Cannot synchronize CUDA device without ATen_cuda library. ", CUDA_HELP);
+  }
 };
 
 // NB: dummy argument to suppress "ISO C++11 requires at least one argument
@@ -1,21 +1,16 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
+#include <ATen/native/AdaptivePooling.h>
 #include <tuple>
 
 
 namespace at {
 namespace native {
 
-namespace {
-
-  inline int start_index(int a, int b, int c) {
-    return (int)std::floor((float)(a * c) / b);
-  }
+DEFINE_DISPATCH(adaptive_avg_pool2d_channels_last_kernel);
 
-  inline int end_index(int a, int b, int c) {
-    return (int)std::ceil((float)((a + 1) * c) / b);
-  }
+namespace {
 
   template <typename scalar_t>
   static void adaptive_avg_pool2d_single_out_frame(
@@ -128,6 +123,15 @@ namespace {
     auto osizeH = output_size[0];
     auto osizeW = output_size[1];
 
+    if (input.ndimension() == 4 &&
+        input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+        (input.scalar_type() == at::kFloat || input.scalar_type() == at::kDouble)) {
+      auto input_channels_last = input.contiguous(at::MemoryFormat::ChannelsLast);
+      output.resize_({input.size(-4), sizeD, osizeH, osizeW}, at::MemoryFormat::ChannelsLast);
+      adaptive_avg_pool2d_channels_last_kernel(kCPU, output, input_channels_last, output_size);
+      return;
+    }
+
     /* resize output */
     if (input.ndimension() == 3 || input.size(-4) == 1)
     {
@@ -326,7 +330,8 @@ namespace {
       return at::mkldnn_adaptive_avg_pool2d(input, output_size);
     }
 
-    // TODO: fastpath for Channels_last should be explored later;
+    // channels last inputs are left to the channels last kernel of
+    // _adaptive_avg_pool2d, which keeps the output channels last
     if (input.suggest_memory_format() == at::MemoryFormat::Contiguous && !input.is_quantized() && output_size[0] == 1 && output_size[1] == 1) {
       // in this case, adaptive pooling is just computing mean over hw
       // dimensions, which can be done more efficiently
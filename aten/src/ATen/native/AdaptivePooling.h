@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+namespace {
+
+  inline int start_index(int a, int b, int c) {
+    return (int)std::floor((float)(a * c) / b);
+  }
+
+  inline int end_index(int a, int b, int c) {
+    return (int)std::ceil((float)((a + 1) * c) / b);
+  }
+
+} // namespace
+
+// Average pooling of a 4-D channels last input into a channels last output
+// of the given spatial size.
+using adaptive_avg_pool2d_fn = void(*)(Tensor& output, const Tensor& input, IntArrayRef output_size);
+
+DECLARE_DISPATCH(adaptive_avg_pool2d_fn, adaptive_avg_pool2d_channels_last_kernel);
+
+} // at::native
+} // at
@@ -1,6 +1,7 @@
 #include <limits>
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/core/grad_mode.h>
 #include <ATen/native/cpu/DepthwiseConvKernel.h>
 #include <ATen/native/utils/ParamUtils.h>
 #include <ATen/native/ConvUtils.h>
@@ -15,6 +16,7 @@ constexpr int MIOPEN_DIM_MAX = 5;
 namespace at { namespace native {
 
 DEFINE_DISPATCH(convolution_depthwise3x3_winograd_stub);
+DEFINE_DISPATCH(convolution_depthwise_channels_last_stub);
 
 struct ConvParams {
   std::vector<int64_t> stride;
@@ -42,6 +44,9 @@ struct ConvParams {
   bool use_miopen(const at::Tensor& input, bool bias_defined) const;
   bool use_mkldnn(const at::Tensor& input) const;
   bool use_nnpack(const at::Tensor& input) const;
+  bool use_cpu_depthwise_channels_last(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_conv1x1(const at::Tensor& input, const at::Tensor& weight) const;
+  int64_t cpu_winograd_output_tile_size(const at::Tensor& input, const at::Tensor& weight) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
@@ -238,6 +243,80 @@ auto ConvParams::use_nnpack(const at::Tensor& input) const -> bool {
   return false;
 }
 
+// CPU convolutions that don't need the im2col buffer of thnn_conv2d. They
+// come after mkldnn and NNPACK, which are preferred when they are available:
+// - 1x1 kernels without padding are a matrix product of the weight with the
+//   (strided) input, done without copying the input, also in channels last.
+// - 3x3 kernels with stride 1 use Winograd F(2x2, 3x3), or F(4x4, 3x3) when
+//   the output is large enough for its bigger tiles, when there are enough
+//   channels for the transforms to pay off.
+auto ConvParams::use_cpu_conv1x1(const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  return input.device().type() == c10::DeviceType::CPU &&
+         (input.scalar_type() == at::kFloat || input.scalar_type() == at::kDouble) &&
+         input.scalar_type() == weight.scalar_type() &&
+         !input.is_mkldnn() &&
+         input.ndimension() == 4 &&
+         weight.ndimension() == 4 &&
+         weight.size(2) == 1 &&
+         weight.size(3) == 1 &&
+         groups == 1 &&
+         !transposed &&
+         !is_padded();
+}
+
+// Returns the output tile size, or 0 if Winograd convolution shouldn't be used.
+auto ConvParams::cpu_winograd_output_tile_size(const at::Tensor& input, const at::Tensor& weight) const -> int64_t {
+  constexpr int64_t min_channels = 16;
+  bool use_winograd =
+      input.device().type() == c10::DeviceType::CPU &&
+      (input.scalar_type() == at::kFloat || input.scalar_type() == at::kDouble) &&
+      input.scalar_type() == weight.scalar_type() &&
+      !input.is_mkldnn() &&
+      input.ndimension() == 4 &&
+      weight.ndimension() == 4 &&
+      weight.size(2) == 3 &&
+      weight.size(3) == 3 &&
+      input.size(1) >= min_channels &&
+      weight.size(0) >= min_channels &&
+      groups == 1 &&
+      !transposed &&
+      !is_strided() &&
+      !is_dilated() &&
+      !is_padding_neg();
+  if (!use_winograd) {
+    return 0;
+  }
+  int64_t output_height = input.size(2) + 2 * padding[0] - 2;
+  int64_t output_width = input.size(3) + 2 * padding[1] - 2;
+  if (output_height < 2 || output_width < 2) {
+    return 0;
+  }
+  return (output_height >= 8 && output_width >= 8) ? 4 : 2;
+}
+
+// Depthwise convolutions of channels last inputs run in channels last, without
+// going through mkldnn or the per group loop, which both need contiguous
+// inputs. There is no backward for this kernel, so it is only used when no
+// gradient is needed.
+auto ConvParams::use_cpu_depthwise_channels_last(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const -> bool {
+  const bool requires_grad = at::GradMode::is_enabled() &&
+      (input.requires_grad() || weight.requires_grad() || (bias.defined() && bias.requires_grad()));
+  return input.device().type() == c10::DeviceType::CPU &&
+         (input.scalar_type() == at::kFloat || input.scalar_type() == at::kDouble) &&
+         input.scalar_type() == weight.scalar_type() &&
+         !input.is_mkldnn() &&
+         input.ndimension() == 4 &&
+         weight.ndimension() == 4 &&
+         input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+         input.size(1) == groups &&
+         groups > 1 &&
+         weight.size(0) == groups &&
+         !transposed &&
+         !is_padding_neg() &&
+         !requires_grad;
+}
+
 // We currently only have depthwise support for the case where groups ==
 // nInputPlane and nInputPlane == nOutputPlane (the latter due to the lack of
 // a depthwise multiplier)
@@ -492,6 +571,39 @@ static at::Tensor subtensor(at::Tensor& tensor, int dim, int groups, int g) {
   return tensor.narrow(dim, n * g, n).contiguous();
 }
 
+// A 1x1 convolution without padding is a matrix product of the weight with the
+// input, subsampled by the stride. Channels last inputs are multiplied as a
+// (batch * height * width) x channels matrix and give a channels last output,
+// other inputs are multiplied one batch element at a time.
+static at::Tensor conv1x1_as_mm(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias, IntArrayRef stride) {
+  auto memory_format = input.suggest_memory_format();
+  auto x = input;
+  if (stride[0] != 1 || stride[1] != 1) {
+    x = x.slice(2, 0, x.size(2), stride[0]).slice(3, 0, x.size(3), stride[1]);
+  }
+  x = x.contiguous(memory_format);
+  const int64_t batch_size = x.size(0);
+  const int64_t channels = x.size(1);
+  const int64_t height = x.size(2);
+  const int64_t width = x.size(3);
+  const int64_t output_channels = weight.size(0);
+  auto weight_2d = weight.reshape({output_channels, channels});
+
+  if (memory_format == at::MemoryFormat::ChannelsLast) {
+    auto rows = x.permute({0, 2, 3, 1}).view({-1, channels});
+    auto output = bias.defined() ? at::addmm(bias, rows, weight_2d.t()) : at::mm(rows, weight_2d.t());
+    return output.view({batch_size, height, width, output_channels}).permute({0, 3, 1, 2});
+  }
+  auto x_3d = x.view({batch_size, channels, height * width});
+  auto weight_3d = weight_2d.expand({batch_size, output_channels, channels});
+  auto output = bias.defined()
+      ? at::baddbmm(bias.view({1, output_channels, 1}).expand({batch_size, output_channels, height * width}),
+                    weight_3d, x_3d)
+      : at::bmm(weight_3d, x_3d);
+  return output.view({batch_size, output_channels, height, width});
+}
+
 
 at::Tensor conv1d(
     const Tensor& input, const Tensor& weight, const Tensor& bias,
@@ -688,6 +800,10 @@ at::Tensor _convolution(
           input.contiguous(), weight, bias,
           params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
     }
+  } else if (params.use_cpu_depthwise_channels_last(input, weight, bias)) {
+    output = convolution_depthwise_channels_last_stub(
+        input.device().type(), input.contiguous(at::MemoryFormat::ChannelsLast), weight,
+        bias.defined() ? bias.contiguous() : bias, params.stride, params.padding, params.dilation);
   } else if (params.use_mkldnn(input)) {
 #if AT_MKLDNN_ENABLED()
     TORCH_CHECK(input.options().type_equal(weight.options()),
@@ -709,6 +825,10 @@ at::Tensor _convolution(
     if (params.use_cpu_depthwise3x3_winograd(input, weight)) {
       output = convolution_depthwise3x3_winograd_stub(
         input.device().type(), input, weight, bias, params.stride, params.padding, params.groups);
+    } else if (params.use_cpu_conv1x1(input, weight)) {
+      output = conv1x1_as_mm(input, weight, bias, params.stride);
+    } else if (auto tile_size = params.cpu_winograd_output_tile_size(input, weight)) {
+      output = at::_winograd_convolution(input.contiguous(), weight, bias, params.padding, tile_size);
     } else if (params.groups == 1) {
       output = at::_convolution_nogroup(
           input.contiguous(), weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
@@ -1056,4 +1176,14 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   return std::tuple<Tensor,Tensor,Tensor>{ggO, gI, gW};
 }
 
+// The benchmark caches live in ATen_cuda, so these go through the CUDA hooks.
+// See native/cudnn/ConvBenchmarkCache.h for more details.
+void _cudnn_save_benchmark_cache(std::string path) {
+  detail::getCUDAHooks().cuDNNSaveBenchmarkCache(path);
+}
+
+int64_t _cudnn_load_benchmark_cache(std::string path) {
+  return detail::getCUDAHooks().cuDNNLoadBenchmarkCache(path);
+}
+
 }} // at::native
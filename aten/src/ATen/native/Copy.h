@@ -11,7 +11,10 @@ namespace native {
 
 using copy_fn = void (*)(TensorIterator&, bool non_blocking);
 
+using transpose_copy_fn = void (*)(TensorIterator&, int64_t dim);
+
 DECLARE_DISPATCH(copy_fn, copy_stub);
+DECLARE_DISPATCH(transpose_copy_fn, transpose_copy_stub);
 
 } // namespace native
 } // namespace at
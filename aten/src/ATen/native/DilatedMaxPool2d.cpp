@@ -9,6 +9,8 @@
 namespace at {
 namespace native {
 
+DEFINE_DISPATCH(max_pool2d_channels_last_kernel);
+
 namespace {
 
 template <typename scalar_t>
@@ -171,6 +173,18 @@ void max_pool2d_with_indices_out_cpu_template(
     inputHeight, inputWidth,
     outputHeight, outputWidth);
 
+  if (input_.ndimension() == 4 && input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+    output.resize_({nbatch, nInputPlane, outputHeight, outputWidth}, at::MemoryFormat::ChannelsLast);
+    indices.resize_({nbatch, nInputPlane, outputHeight, outputWidth}, at::MemoryFormat::ChannelsLast);
+    max_pool2d_channels_last_kernel(
+      kCPU, output, indices, input,
+      kW, kH, dW, dH,
+      padW, padH,
+      dilationW, dilationH);
+    return;
+  }
+
   /* get contiguous input */
   Tensor input = input_.contiguous();
 
@@ -299,7 +313,7 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
           Tensor& gradInput,
           const Tensor& gradOutput_,
           const Tensor& input,
-          const Tensor& indices,
+          const Tensor& indices_,
           IntArrayRef kernel_size,
           IntArrayRef stride,
           IntArrayRef padding,
@@ -333,8 +347,10 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
   TORCH_CHECK((input.ndimension() == 3 || input.ndimension() == 4),
     "non-empty 3D or 4D (batch mode) tensor expected for input");
 
-  /* get contiguous gradOutput */
+  /* get contiguous gradOutput and indices, which are channels last if the
+     input is */
   const Tensor gradOutput = gradOutput_.contiguous();
+  const Tensor indices = indices_.contiguous();
 
   /* resize */
   gradInput.resize_as_(input);
@@ -5,6 +5,8 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/native/Distance.h>
 
+#include <numeric>
+
 namespace at { namespace native {
 
 DEFINE_DISPATCH(pdist_forward_stub);
@@ -110,6 +112,74 @@ Tensor cdist(const Tensor& x1, const Tensor& x2, const double p, c10::optional<i
   return result;
 }
 
+// Upper bound, in elements, on the block of distances cdist_topk holds at once.
+constexpr int64_t cdist_topk_block_numel = 1 << 22;
+
+// k nearest rows of x2 for every row of x1 without materializing the full
+// r1 x r2 distance matrix. x1 is split into row blocks and each block is
+// compared against x2 one tile at a time; the running k best of a block are
+// merged with the k best of every new tile. Only one tile of distances and
+// the running results are alive at a time, so memory stays bounded by
+// cdist_topk_block_numel however large r1 and r2 are.
+std::tuple<Tensor, Tensor> cdist_topk(const Tensor& x1, const Tensor& x2, int64_t k, const double p, c10::optional<int64_t> compute_mode) {
+  TORCH_CHECK(x1.dim() >= 2, "cdist_topk only supports at least 2D tensors, X1 got: ", x1.dim(), "D");
+  TORCH_CHECK(x2.dim() >= 2, "cdist_topk only supports at least 2D tensors, X2 got: ", x2.dim(), "D");
+  TORCH_CHECK(x1.size(-1) == x2.size(-1), "X1 and X2 must have the same number of columns. X1: ", x1.size(-1), " X2: ", x2.size(-1));
+  int64_t r1 = x1.size(-2);
+  int64_t r2 = x2.size(-2);
+  TORCH_CHECK(k >= 0 && k <= r2, "cdist_topk: k (", k, ") must be between 0 and the number of rows of X2 (", r2, ")");
+
+  IntArrayRef batch_tensor1(x1.sizes().data(), x1.dim() - 2);
+  IntArrayRef batch_tensor2(x2.sizes().data(), x2.dim() - 2);
+  std::vector<int64_t> expand_batch_portion = infer_size(batch_tensor1, batch_tensor2);
+  std::vector<int64_t> tensor1_expand_size(expand_batch_portion);
+  tensor1_expand_size.insert(tensor1_expand_size.end(), {r1, x1.size(-1)});
+  std::vector<int64_t> tensor2_expand_size(expand_batch_portion);
+  tensor2_expand_size.insert(tensor2_expand_size.end(), {r2, x2.size(-1)});
+  Tensor tensor1_expanded = x1.expand(tensor1_expand_size);
+  Tensor tensor2_expanded = x2.expand(tensor2_expand_size);
+
+  if (r1 == 0 || k == 0) {
+    std::vector<int64_t> output_shape(expand_batch_portion);
+    output_shape.insert(output_shape.end(), {r1, k});
+    return std::make_tuple(at::empty(output_shape, x1.options()),
+                           at::empty(output_shape, x1.options().dtype(kLong)));
+  }
+
+  int64_t batch_product = std::accumulate(expand_batch_portion.begin(), expand_batch_portion.end(), static_cast<int64_t>(1), std::multiplies<int64_t>());
+  int64_t r2_tile = std::min(r2, std::max<int64_t>(k, 1024));
+  int64_t r1_tile = std::max<int64_t>(1, cdist_topk_block_numel / (batch_product * (r2_tile + k)));
+
+  std::vector<Tensor> values;
+  std::vector<Tensor> indices;
+  for (int64_t i = 0; i < r1; i += r1_tile) {
+    Tensor x1_block = tensor1_expanded.narrow(-2, i, std::min(r1_tile, r1 - i));
+    Tensor best_values, best_indices;
+    // The first tile has at least k rows, so best_* always hold k columns.
+    for (int64_t j = 0; j < r2; j += r2_tile) {
+      int64_t tile = std::min(r2_tile, r2 - j);
+      Tensor dist = at::cdist(x1_block, tensor2_expanded.narrow(-2, j, tile), p, compute_mode);
+      Tensor tile_values, tile_indices;
+      std::tie(tile_values, tile_indices) = dist.topk(std::min(k, tile), -1, /*largest=*/false, /*sorted=*/false);
+      tile_indices.add_(j);
+      if (!best_values.defined()) {
+        best_values = tile_values;
+        best_indices = tile_indices;
+        continue;
+      }
+      Tensor merged_indices = at::cat({best_indices, tile_indices}, -1);
+      Tensor positions;
+      std::tie(best_values, positions) = at::cat({best_values, tile_values}, -1).topk(k, -1, /*largest=*/false, /*sorted=*/false);
+      best_indices = merged_indices.gather(-1, positions);
+    }
+    Tensor order;
+    std::tie(best_values, order) = best_values.sort(-1);
+    values.push_back(best_values);
+    indices.push_back(best_indices.gather(-1, order));
+  }
+  return std::make_tuple(at::cat(values, -2), at::cat(indices, -2));
+}
+
 Tensor _cdist_backward(const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& cdist) {
   TORCH_CHECK(x1.is_contiguous(), "_cdist_backward requires X1 to be contiguous");
   TORCH_CHECK(x2.is_contiguous(), "_cdist_backward requires X2 to be contiguous");
@@ -19,7 +19,6 @@
 #include <type_traits>
 #include <functional>
 #include <assert.h>
-#include <cpuinfo.h>
 #include <float.h>
 
 namespace {
@@ -112,13 +111,14 @@ int64_t sample_poisson(double lambda, at::CPUGenerator* generator) {
 namespace at {
 namespace native {
 
-DEFINE_DISPATCH(bernoulli_mkl_stub);
+DEFINE_DISPATCH(bernoulli_scalar_stub);
 DEFINE_DISPATCH(cauchy_stub);
 DEFINE_DISPATCH(exponential_stub);
 DEFINE_DISPATCH(multinomial_stub);
 DEFINE_DISPATCH(geometric_stub);
 DEFINE_DISPATCH(log_normal_stub);
 DEFINE_DISPATCH(normal_stub);
+DEFINE_DISPATCH(uniform_stub);
 
 Tensor bernoulli(const Tensor& self, Generator* gen) {
   return at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT).bernoulli_(self, gen);
@@ -168,22 +168,7 @@ Tensor& bernoulli_tensor_cpu_(Tensor& self, const Tensor& p_, Generator* gen) {
 
 Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   TORCH_CHECK(0 <= p && p <= 1, "bernoulli_ expects p to be in [0, 1], but got p=", p);
-#if AT_MKL_ENABLED()
-  if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
-    bernoulli_mkl_stub(kCPU, self, p, gen);
-    return self;
-  }
-#endif
-  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
-    CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-    // See Note [Acquire lock when using random generators]
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    CPU_tensor_apply1<scalar_t>(
-        self, [generator, p](scalar_t& ret_val) {
-          at::bernoulli_distribution<double> bernoulli(p);
-          ret_val = static_cast<scalar_t>(bernoulli(generator));
-        });
-  });
+  bernoulli_scalar_stub(kCPU, self, p, gen);
   return self;
 }
 
@@ -220,6 +205,11 @@ Tensor& normal_cpu_(Tensor& self, double mean, double std, Generator* gen) {
   return self;
 }
 
+Tensor& uniform_cpu_(Tensor& self, double from, double to, Generator* gen) {
+  uniform_stub(kCPU, self, from, to, gen);
+  return self;
+}
+
 Tensor& normal_out_cpu(Tensor& output, const Tensor& mean, double std, Generator* gen) {
   normal_cpu_(output, 0, std, gen);
   output.add_(mean);
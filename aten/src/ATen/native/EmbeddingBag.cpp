@@ -41,204 +41,100 @@ bool isFastPathIndexSelectScale(const Tensor& src, const Tensor& scale, Tensor&
   return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1 && scale.stride(0) == 1;
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& /*offsets*/,
-                             bool /*include_last_offset*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<int64_t>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* src_data = src.data_ptr<T>();
-  auto* output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
+// Returns the offsets of the bags followed by the end of the last bag, the
+// form that the perfkernels and the loops over bags take. `storage` holds
+// them unless `offsets` already ends with the end of the last bag.
+const int64_t* offsets_include_last(
+    const Tensor& offsets,
+    int64_t num_indices,
+    bool include_last_offset,
+    std::vector<int64_t>& storage) {
+  if (include_last_offset) {
+    return offsets.data_ptr<int64_t>();
   }
+  storage.resize(offsets.numel() + 1);
+  std::memcpy(
+      storage.data(), offsets.data_ptr<int64_t>(), sizeof(int64_t) * offsets.numel());
+  storage[offsets.numel()] = num_indices;
+  return storage.data();
 }
 
-template<>
-void index_select_add<float>(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& offsets,
-                             bool include_last_offset) {
-  int64_t ddim = src.size(1);
-  auto* src_data = src.data_ptr<float>();
+// This function fuses the following three fns for every bag:
+// index_select (using select_indices as the index)
+// mul (scaling by per_sample_weights, if `scale` is defined)
+// sum (over the bag, divided by the size of the bag if `normalize_by_lengths`)
+// without creating an intermediary tensor to hold the selected embeddings.
+// Bags are reduced in parallel, by the perfkernels for contiguous float
+// embeddings.
+template<typename T>
+void index_select_add(const Tensor &select_indices,
+                      const Tensor &scale,
+                      const Tensor &src,
+                      Tensor &output,
+                      const Tensor& offsets,
+                      bool include_last_offset,
+                      bool normalize_by_lengths) {
   auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* output_data = output.data_ptr<float>();
-
-  if (isFastPathIndexSelect(src, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
-    std::vector<int64_t> offsets_include_last;
-
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
-
+  int64_t ddim = src.size(1);
+  int64_t num_weights = src.size(0);
+  int64_t output_size = output.size(0);
+  std::vector<int64_t> storage;
+  auto* offsets_data = offsets_include_last(
+      offsets, select_indices.numel(), include_last_offset, storage);
+
+  bool fast_path = scale.defined()
+      ? isFastPathIndexSelectScale(src, scale, output)
+      : isFastPathIndexSelect(src, output);
+  if (std::is_same<T, float>::value && fast_path) {
+    auto* src_data = src.data_ptr<float>();
+    auto* output_data = output.data_ptr<float>();
+    auto* scale_data = scale.defined() ? scale.data_ptr<float>() : nullptr;
     at::parallel_for(
         0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
           caffe2::EmbeddingLookupIdx(
               /*block_size=*/ddim,
               /*output_size=*/end_idx - start_idx,
               /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.size(0),
+              /*data_size=*/num_weights,
               /*input=*/src_data,
               /*indices=*/select_indices_data + offsets_data[start_idx],
               /*offsets=*/offsets_data + start_idx,
-              /*weights=*/nullptr,
+              /*weights=*/scale_data ? scale_data + offsets_data[start_idx] : nullptr,
               /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
+              /*normalize_by_lengths=*/normalize_by_lengths,
               /*out=*/output_data + start_idx * ddim);
         });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto numel = add_indices.numel();
-    for (int64_t i = 0; i < numel; i++) {
-      THBlas_axpy<float>(
-          ddim,
-          1,
-          src_data + src_stride0 * select_indices_data[i],
-          src_stride1,
-          output_data + output_stride0 * add_indices_data[i],
-          output_stride1);
-    }
+    return;
   }
-}
 
-// This function fuses the following three fns:
-// index_select (using select_indices as the index)
-// mul (scaling by per_sample_weights)
-// index_add (using add_indices as the index)
-template<typename T>
-static void index_select_scale_add(const Tensor &select_indices,
-                                   const Tensor &add_indices,
-                                   const Tensor &scale,
-                                   const Tensor &src,
-                                   Tensor &output,
-                                   const Tensor& /*offsets*/,
-                                   bool /*include_last_offset*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<int64_t>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
   auto* src_data = src.data_ptr<T>();
   auto* output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
+  auto* scale_data = scale.defined() ? scale.data_ptr<T>() : nullptr;
+  auto scale_stride = scale.defined() ? scale.stride(0) : 0;
   auto src_stride0 = src.stride(0);
   auto src_stride1 = src.stride(1);
   auto output_stride0 = output.stride(0);
   auto output_stride1 = output.stride(1);
-
-  auto* scale_data = scale.data_ptr<T>();
-  auto scale_stride = scale.stride(0);
-
-  for (int64_t i = 0; i < numel; i++) {
-    auto* src_base = src_data + src_stride0 * select_indices_data[i];
-    auto* output_base = output_data + output_stride0 * add_indices_data[i];
-    auto scale = scale_data[i * scale_stride];
-    for (int64_t j = 0; j < ddim; j++) {
-      output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
-    }
-  }
-}
-
-template<>
-void index_select_scale_add<float>(const Tensor &select_indices,
-                                          const Tensor &add_indices,
-                                          const Tensor &scale,
-                                          const Tensor &src,
-                                          Tensor &output,
-                                          const Tensor& offsets,
-                                          bool include_last_offset) {
-  int64_t ddim = src.size(1);
-  auto* scale_data = scale.data_ptr<float>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* src_data = src.data_ptr<float>();
-  auto* output_data = output.data_ptr<float>();
-
-  if (isFastPathIndexSelectScale(src, scale, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
-    std::vector<int64_t> offsets_include_last;
-
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
-
-    at::parallel_for(
-        0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
-          caffe2::EmbeddingLookupIdx(
-              /*block_size=*/ddim,
-              /*output_size=*/end_idx - start_idx,
-              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.size(0),
-              /*input=*/src_data,
-              /*indices=*/select_indices_data + offsets_data[start_idx],
-              /*offsets=*/offsets_data + start_idx,
-              /*weights=*/scale_data + offsets_data[start_idx],
-              /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
-              /*out=*/output_data + start_idx * ddim);
-        });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto scale_stride = scale.stride(0);
-    auto numel = add_indices.numel();
-
-
-    for (int64_t i = 0; i < numel; i++) {
-      auto* src_base = src_data + src_stride0 * select_indices_data[i];
-      auto* output_base = output_data + output_stride0 * add_indices_data[i];
-      auto scale = scale_data[i * scale_stride];
-      for (int64_t j = 0; j < ddim; j++) {
-        output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+  at::parallel_for(0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+    for (int64_t bag = start_idx; bag < end_idx; bag++) {
+      auto* output_base = output_data + output_stride0 * bag;
+      for (int64_t i = offsets_data[bag]; i < offsets_data[bag + 1]; i++) {
+        auto idx = select_indices_data[i];
+        TORCH_CHECK(
+            idx >= 0 && idx < num_weights,
+            "embedding_bag: index ", idx, " is out of bounds for size ", num_weights);
+        THBlas_axpy<T>(ddim, scale_data ? scale_data[i * scale_stride] : T(1),
+                src_data + src_stride0 * idx, src_stride1,
+                output_base, output_stride1);
+      }
+      auto length = offsets_data[bag + 1] - offsets_data[bag];
+      if (normalize_by_lengths && length > 0) {
+        for (int64_t j = 0; j < ddim; j++) {
+          output_base[j * output_stride1] /= length;
+        }
       }
     }
-  }
+  });
 }
 
 }  // namespace
@@ -265,26 +161,6 @@ static at::Tensor make_bag_size(
   return bag_size;
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    // Avoid dividing by 0 for empty bags.
-    // Instead we want empty bags to return all 0s
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = std::max(indices.size(0), static_cast<int64_t>(1));
-      output /= bag_size_;
-    } else {
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size, LEGACY_CONTIGUOUS_MEMORY_FORMAT))
-                           .to(output.options())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -311,14 +187,17 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
     const Tensor& offset2bag,
     const Tensor& output,
     const Tensor& bag_size,
-    const Tensor& offsets) {
+    const Tensor& offsets,
+    bool include_last_offset) {
 
     auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.options());
 
-    int64_t numel = indices.numel();
     int64_t dims = weight.size(1);
+    int64_t num_weights = weight.size(0);
     auto* indices_data = indices.data_ptr<int64_t>();
-    auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
+    std::vector<int64_t> storage;
+    auto* offsets_data = offsets_include_last(
+        offsets, indices.numel(), include_last_offset, storage);
 
     auto* max_indices_data = max_indices.data_ptr<int64_t>();
     auto max_indices_stride = max_indices.stride(0);
@@ -329,21 +208,27 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
     auto weight_stride1 = weight.stride(1);
     auto output_stride = output.stride(0);
 
-    for (int i = 0; i < numel; i++) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-      for (int dim = 0; dim < dims; dim++) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item = weight_data[weight_stride0 * word_idx + dim * weight_stride1];
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
+    at::parallel_for(0, output.size(0), 1, [&](int64_t start_idx, int64_t end_idx) {
+      for (int64_t bag = start_idx; bag < end_idx; bag++) {
+        auto* output_base = output_data + output_stride * bag;
+        auto* max_indices_base = max_indices_data + max_indices_stride * bag;
+        for (int64_t i = offsets_data[bag]; i < offsets_data[bag + 1]; i++) {
+          auto word_idx = indices_data[i];
+          TORCH_CHECK(
+              word_idx >= 0 && word_idx < num_weights,
+              "embedding_bag: index ", word_idx, " is out of bounds for size ", num_weights);
+          bool is_first_for_bag = i == offsets_data[bag];
+          auto* weight_base = weight_data + weight_stride0 * word_idx;
+          for (int64_t dim = 0; dim < dims; dim++) {
+            auto weight_item = weight_base[dim * weight_stride1];
+            if (is_first_for_bag || weight_item > output_base[dim]) {
+              output_base[dim] = weight_item;
+              max_indices_base[dim] = word_idx;
+            }
+          }
         }
       }
-    }
+    });
 
     return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
 }
@@ -398,45 +283,19 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
        weight.size(1)},
       weight.options());
 
-  // To save compute, if we are going to go down the fast path case for the 'sum'
-  // mode, we skip calculating offset2bag, since it is not going to be used.
-  auto fast_path_sum = [&weight, &per_sample_weights, &output]() {
-    if (per_sample_weights.defined()) {
-      return isFastPathIndexSelectScale(weight, per_sample_weights, output);
-    } else {
-      return isFastPathIndexSelect(weight, output);
-    }
-  };
-
-  // Use an empty 0-element tensor as a sentinel that we have skipped the
-  // creation of offset2bag because autograd chokes when trying to use an
-  // undefined tensor as an input to a backward op.
+  // The loops over bags only need the offsets, so offset2bag is left to the
+  // backward, which creates it from the offsets when it is empty. Use an empty
+  // 0-element tensor as that sentinel because autograd chokes when trying to
+  // use an undefined tensor as an input to a backward op.
   Tensor offset2bag = at::empty({0}, offsets.options());
-  if (mode == MODE_MEAN || mode == MODE_MAX || !fast_path_sum()) {
-    // If the last entries are empty, that the last offsets are irrelevant as they
-    // won't change anything in the assignment of ID -> bag, but index_add would
-    // throw out of bounds error. So to keep it simple we just add one more
-    // entry to the end then get rid of it after make_offset2bag.
-    offset2bag = at::zeros(
-       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-    make_offset2bag(offsets, indices, offset2bag);
-
-    offset2bag.resize_({indices.sizes()[0]});
-  }
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
     AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
-      if (per_sample_weights.defined()) {
-        AT_ASSERT(mode == MODE_SUM);
-        index_select_scale_add<scalar_t>(
-            indices, offset2bag, per_sample_weights, weight, output, offsets, include_last_offset);
-      } else {
-        index_select_add<scalar_t>(indices, offset2bag, weight, output, offsets, include_last_offset);
-      }
+      index_select_add<scalar_t>(
+          indices, per_sample_weights, weight, output, offsets,
+          include_last_offset, /*normalize_by_lengths=*/mode == MODE_MEAN);
     });
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
     at::optional<Tensor> maybe_per_sample_weights;
     if (per_sample_weights.defined()) {
@@ -445,7 +304,7 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.scalar_type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(
-            weight, indices, offset2bag, output, bag_size, offsets);
+            weight, indices, offset2bag, output, bag_size, offsets, include_last_offset);
       }
     );
   }
@@ -747,6 +606,51 @@ Tensor _embedding_bag_per_sample_weights_backward_cpu(
   );
 }
 
+// Gathers the rows of the gradient of the bags for every sample and scales
+// them by 1 / bag_size for the mean or by per_sample_weights, in a single
+// pass. These are the values of the sparse gradient.
+template <typename scalar_t>
+static Tensor _embedding_bag_sparse_backward_values_cpu(
+    const Tensor& grad,
+    const Tensor& offset2bag,
+    const Tensor& bag_size,
+    int64_t mode,
+    const Tensor& per_sample_weights) {
+  auto num_samples = offset2bag.numel();
+  auto ddim = grad.size(1);
+  auto index_grad = at::empty({num_samples, ddim}, grad.options());
+
+  auto* grad_data = grad.data_ptr<scalar_t>();
+  auto grad_stride0 = grad.stride(0);
+  auto grad_stride1 = grad.stride(1);
+  auto* index_grad_data = index_grad.data_ptr<scalar_t>();
+  auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
+  auto* bag_size_data = mode == MODE_MEAN ? bag_size.data_ptr<int64_t>() : nullptr;
+  auto* per_sample_weights_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<scalar_t>() : nullptr;
+  auto per_sample_weights_stride =
+      per_sample_weights.defined() ? per_sample_weights.stride(0) : 0;
+
+  parallel_for(0, num_samples, 64, [&](int64_t begin, int64_t end) {
+    for (int64_t sample_idx = begin; sample_idx < end; sample_idx++) {
+      auto bag_idx = offset2bag_data[sample_idx];
+      scalar_t scale = 1;
+      if (bag_size_data) {
+        scale /= bag_size_data[bag_idx];
+      }
+      if (per_sample_weights_data) {
+        scale *= per_sample_weights_data[sample_idx * per_sample_weights_stride];
+      }
+      auto* grad_base = grad_data + grad_stride0 * bag_idx;
+      auto* index_grad_base = index_grad_data + ddim * sample_idx;
+      for (int64_t j = 0; j < ddim; j++) {
+        index_grad_base[j] = grad_base[j * grad_stride1] * scale;
+      }
+    }
+  });
+  return index_grad;
+}
+
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
@@ -757,12 +661,24 @@ Tensor _embedding_bag_sparse_backward(
   // for more details.
 
   Tensor grad = grad_;
-  Tensor index_grad = grad_.index_select(0, offset2bag);
-  index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
-                                       offset2bag, bag_size_);
+  Tensor index_grad;
   if (per_sample_weights.defined()) {
     AT_ASSERT(mode == MODE_SUM);
-    index_grad.mul_(per_sample_weights.unsqueeze(1));
+  }
+  if (grad.device().type() == kCPU) {
+    index_grad = AT_DISPATCH_FLOATING_TYPES(
+      grad.scalar_type(), "embedding_bag_sparse_backward_cpu", [&]() {
+        return _embedding_bag_sparse_backward_values_cpu<scalar_t>(
+            grad, offset2bag, bag_size_, mode, per_sample_weights);
+      }
+    );
+  } else {
+    index_grad = grad_.index_select(0, offset2bag);
+    index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
+                                         offset2bag, bag_size_);
+    if (per_sample_weights.defined()) {
+      index_grad.mul_(per_sample_weights.unsqueeze(1));
+    }
   }
   return native::embedding_backward(index_grad, indices, num_weights, -1,
                                     scale_grad_by_freq, true);
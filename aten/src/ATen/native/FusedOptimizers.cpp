@@ -0,0 +1,119 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/FusedOptimizers.h>
+
+#include <cmath>
+
+namespace at {
+namespace native {
+
+void adam_step(
+    const Tensor& param,
+    const Tensor& grad_,
+    const Tensor& exp_avg,
+    const Tensor& exp_avg_sq,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    int64_t step,
+    bool decoupled_weight_decay) {
+  Tensor grad = grad_;
+  if (weight_decay != 0) {
+    if (decoupled_weight_decay) {
+      param.mul_(1 - lr * weight_decay);
+    } else {
+      grad = grad.add(param, weight_decay);
+    }
+  }
+  const double bias_correction1 = 1 - std::pow(beta1, step);
+  const double bias_correction2 = 1 - std::pow(beta2, step);
+  exp_avg.mul_(beta1).add_(grad, 1 - beta1);
+  exp_avg_sq.mul_(beta2).addcmul_(grad, grad, 1 - beta2);
+  auto denom = (exp_avg_sq.sqrt() / std::sqrt(bias_correction2)).add_(eps);
+  param.addcdiv_(exp_avg, denom, -lr / bias_correction1);
+}
+
+void sgd_step(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& momentum_buffer,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_step) {
+  Tensor d_p = grad;
+  if (weight_decay != 0) {
+    d_p = d_p.add(param, weight_decay);
+  }
+  if (momentum != 0) {
+    if (first_step) {
+      momentum_buffer.copy_(d_p);
+    } else {
+      momentum_buffer.mul_(momentum).add_(d_p, 1 - dampening);
+    }
+    if (nesterov) {
+      d_p = d_p.add(momentum_buffer, momentum);
+    } else {
+      d_p = momentum_buffer;
+    }
+  }
+  param.add_(d_p, -lr);
+}
+
+void check_fused_optimizer_lists(const char* name, std::initializer_list<TensorList> lists) {
+  const auto n = lists.begin()->size();
+  for (const auto& list : lists) {
+    TORCH_CHECK(list.size() == n, name, ": expected all tensor lists to have the same length");
+    for (size_t i = 0; i < n; i++) {
+      TORCH_CHECK(list[i].sizes() == (*lists.begin())[i].sizes(),
+                  name, ": expected the tensors at index ", i, " of all lists to have the same size");
+    }
+  }
+}
+
+void fused_adam_cpu(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    int64_t step,
+    bool decoupled_weight_decay) {
+  check_fused_optimizer_lists("_fused_adam", {params, grads, exp_avgs, exp_avg_sqs});
+  for (size_t i = 0; i < params.size(); i++) {
+    adam_step(params[i], grads[i], exp_avgs[i], exp_avg_sqs[i],
+              lr, beta1, beta2, eps, weight_decay, step, decoupled_weight_decay);
+  }
+}
+
+void fused_sgd_cpu(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_step) {
+  if (momentum != 0) {
+    check_fused_optimizer_lists("_fused_sgd", {params, grads, momentum_buffers});
+  } else {
+    check_fused_optimizer_lists("_fused_sgd", {params, grads});
+  }
+  for (size_t i = 0; i < params.size(); i++) {
+    sgd_step(params[i], grads[i], momentum != 0 ? momentum_buffers[i] : Tensor(),
+             lr, momentum, dampening, weight_decay, nesterov, first_step);
+  }
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// Single-tensor steps of the fused optimizers. They implement the same math as
+// the multi-tensor CUDA kernels, and are used on the CPU and for the tensors
+// the kernels do not support.
+
+void adam_step(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& exp_avg,
+    const Tensor& exp_avg_sq,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    int64_t step,
+    bool decoupled_weight_decay);
+
+// momentum_buffer is only used if momentum != 0. On the first step it is set to
+// the gradient, like in torch.optim.SGD.
+void sgd_step(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& momentum_buffer,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_step);
+
+void check_fused_optimizer_lists(const char* name, std::initializer_list<TensorList> lists);
+
+} // namespace native
+} // namespace at
@@ -3,10 +3,12 @@
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/LinearAlgebraUtils.h>
+#include <ATen/native/cpu/SmallGemmKernel.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/LegacyTHFunctionsCPU.h>
 #include <ATen/core/grad_mode.h>
+#include <cstdlib>
 #include <functional>
 #include <numeric>
 #include <vector>
@@ -156,6 +158,101 @@ Tensor& addr_out(Tensor &result, const Tensor& self, const Tensor& vec1, const T
   return at::_addr_out(result, self, vec1, vec2, beta, alpha);
 }
 
+// Products of float and double matrices with at most this many multiply-adds
+// (per batch item for bmm/baddbmm) go through small_gemm_stub instead of
+// BLAS, whose fixed cost per call dominates at these sizes. Like the other size
+// thresholds below it has not been benchmarked on many CPUs, so it can be
+// changed with the environment variable ATEN_SMALL_GEMM_MAX_MNK; 0 disables the
+// small GEMM kernel.
+static constexpr int64_t kSmallGemmDefaultMaxMNK = 64 * 64 * 64;
+
+static int64_t small_gemm_max_mnk() {
+  static const int64_t max_mnk = [] {
+    const char* env = std::getenv("ATEN_SMALL_GEMM_MAX_MNK");
+    return env != nullptr ? static_cast<int64_t>(std::atoll(env))
+                          : kSmallGemmDefaultMaxMNK;
+  }();
+  return max_mnk;
+}
+
+// Whether result = beta * result + alpha * mat1 @ mat2 can use the small GEMM
+// kernel. The operands are either all 2D or all 3D, with matching sizes, and
+// result already has its final shape.
+static bool use_small_gemm(const Tensor& result, const Tensor& mat1, const Tensor& mat2) {
+  const auto scalar_type = result.scalar_type();
+  if ((scalar_type != kFloat && scalar_type != kDouble) ||
+      mat1.scalar_type() != scalar_type || mat2.scalar_type() != scalar_type) {
+    return false;
+  }
+  const int64_t m = mat1.size(-2);
+  const int64_t k = mat1.size(-1);
+  const int64_t n = mat2.size(-1);
+  if (m == 0 || n == 0 || k == 0 || m * n * k > small_gemm_max_mnk()) {
+    return false;
+  }
+  return (result.stride(-1) == 1 || n == 1) &&
+      !result.is_alias_of(mat1) && !result.is_alias_of(mat2);
+}
+
+// Whether mm/addmm can take the small GEMM path; all the other cases, including
+// the invalid ones, are left to TH, which reports the errors. Named tensors are
+// left to TH too, which propagates their names. This is checked before result
+// is resized, which must not change mat1 or mat2.
+static bool is_small_mm(const Tensor& result, const Tensor& mat1, const Tensor& mat2) {
+  return mat1.dim() == 2 && mat2.dim() == 2 && mat1.size(1) == mat2.size(0) &&
+      !result.has_names() && !mat1.has_names() && !mat2.has_names() &&
+      !result.is_alias_of(mat1) && !result.is_alias_of(mat2) &&
+      mat1.size(0) * mat1.size(1) * mat2.size(1) <= small_gemm_max_mnk();
+}
+
+Tensor mm_cpu(const Tensor& self, const Tensor& mat2) {
+  Tensor result = at::empty({0}, self.options());
+  return at::native::mm_out_cpu(result, self, mat2);
+}
+
+Tensor& mm_out_cpu(Tensor& result, const Tensor& self, const Tensor& mat2) {
+  if (is_small_mm(result, self, mat2)) {
+    result.resize_({self.size(0), mat2.size(1)});
+    if (use_small_gemm(result, self, mat2)) {
+      small_gemm_stub(kCPU, result, self, mat2, 0, 1);
+      return result;
+    }
+  }
+  return legacy::cpu::_th_mm_out(result, self, mat2);
+}
+
+Tensor addmm_cpu(const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  Tensor result = at::empty({0}, self.options());
+  return at::native::addmm_out_cpu(result, self, mat1, mat2, beta, alpha);
+}
+
+Tensor& addmm_out_cpu(Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  if (is_small_mm(result, mat1, mat2) && !self.has_names() &&
+      !result.is_alias_of(self) &&
+      is_expandable_to(self.sizes(), {mat1.size(0), mat2.size(1)})) {
+    result.resize_({mat1.size(0), mat2.size(1)});
+    if (use_small_gemm(result, mat1, mat2)) {
+      // self is not read when beta is 0, see small_gemm_stub
+      if (beta.toDouble() != 0.0) {
+        result.copy_(self.expand({mat1.size(0), mat2.size(1)}));
+      }
+      small_gemm_stub(kCPU, result, mat1, mat2, beta, alpha);
+      return result;
+    }
+  }
+  return legacy::cpu::_th_addmm_out(result, self, mat1, mat2, beta, alpha);
+}
+
+Tensor& addmm__cpu(Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  if (is_small_mm(self, mat1, mat2) && self.dim() == 2 &&
+      self.size(0) == mat1.size(0) && self.size(1) == mat2.size(1) &&
+      use_small_gemm(self, mat1, mat2)) {
+    small_gemm_stub(kCPU, self, mat1, mat2, beta, alpha);
+    return self;
+  }
+  return legacy::cpu::_th_addmm_(self, mat1, mat2, beta, alpha);
+}
+
 template <typename scalar_t, bool is_bmm>
 inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const Tensor& mat2, Scalar beta_, Scalar alpha_) {
   int64_t bs = result.size(0);
@@ -199,6 +296,9 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
 }
 
 // This tries to apply some optimizations to bmm/baddbmm:
+// - When the matrices of float and double operands are small enough for the
+//   small GEMM kernel (see use_small_gemm), it is applied to every batch item,
+//   in parallel over the batch dimension.
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
@@ -245,7 +345,9 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             || (t.stride(1) == 1 && t.stride(2) >= t.size(1));
   };
 
-  if (contraction_size * res_rows * res_cols < 400) {
+  if (use_small_gemm(self_or_result, batch1, batch2)) {
+    small_gemm_stub(kCPU, self_or_result, batch1, batch2, beta, alpha);
+  } else if (contraction_size * res_rows * res_cols < 400) {
     if (is_bmm_out) {
       AT_DISPATCH_ALL_TYPES(batch1.scalar_type(), "bmm", [&] {
           baddbmm_cpu_kernel<scalar_t, true>(self_or_result, batch1, batch2, beta, alpha);
@@ -666,5 +768,7 @@ Tensor chain_matmul(TensorList matrices) {
   }
 }
 
+DEFINE_DISPATCH(small_gemm_stub);
+
 } // namespace native
 } // namespace at
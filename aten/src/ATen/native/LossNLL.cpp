@@ -3,6 +3,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/cpu/SoftmaxKernel.h>
 
 namespace at {
 namespace native {
@@ -323,6 +324,31 @@ void nll_loss_backward_out_cpu_template(
       });
 }
 
+void cross_entropy_loss_check_inputs(
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight) {
+  TORCH_CHECK(input.dim() == 2, "input tensor should be 2D");
+  TORCH_CHECK(
+      target.dim() == 1,
+      "1D target tensor expected, multi-target not supported");
+  TORCH_CHECK(
+      input.size(0) == target.size(0),
+      "size mismatch (got input: ",
+      input.sizes(),
+      ", target: ",
+      target.sizes(),
+      ")");
+  TORCH_CHECK(input.size(1) > 0, "input tensor should have at least one class");
+  TORCH_CHECK(
+      !weight.defined() || weight.numel() == input.size(1),
+      "weight tensor should be defined either for all ",
+      input.size(1),
+      " classes or no classes"
+      " but got weight tensor of shape: ",
+      weight.sizes());
+}
+
 } // namespace
 
 std::tuple<Tensor&, Tensor&> nll_loss_forward_out_cpu(
@@ -393,5 +419,91 @@ Tensor nll_loss_backward_cpu(
   return grad_input;
 }
 
+std::tuple<Tensor, Tensor, Tensor> cross_entropy_loss_forward_cpu(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index) {
+  cross_entropy_loss_check_inputs(self, target, weight);
+  auto input = self.contiguous();
+  auto losses = at::empty({input.size(0)}, input.options());
+  auto lse = at::empty({input.size(0)}, input.options());
+  auto target_weight = at::empty({input.size(0)}, input.options());
+  cross_entropy_lastdim_kernel(
+      kCPU,
+      losses,
+      lse,
+      target_weight,
+      input,
+      target.contiguous(),
+      optional_contiguous(weight),
+      ignore_index);
+  return std::make_tuple(losses, lse, target_weight);
+}
+
+Tensor cross_entropy_loss_backward_cpu(
+    const Tensor& grad_losses,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& lse,
+    const Tensor& target_weight) {
+  cross_entropy_loss_check_inputs(self, target, Tensor());
+  const auto batch_size = self.size(0);
+  check_dim_size(grad_losses, 1, 0, batch_size);
+  check_dim_size(lse, 1, 0, batch_size);
+  check_dim_size(target_weight, 1, 0, batch_size);
+  auto input = self.contiguous();
+  auto grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  cross_entropy_backward_lastdim_kernel(
+      kCPU,
+      grad_input,
+      grad_losses.contiguous(),
+      input,
+      target.contiguous(),
+      lse.contiguous(),
+      target_weight.contiguous());
+  return grad_input;
+}
+
+// log_softmax followed by nll_loss. (N, C) inputs go through a fused kernel
+// that reads the input once and never materializes the log probabilities;
+// the other shapes and types are composed from the two functions.
+Tensor cross_entropy_loss(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t reduction,
+    int64_t ignore_index) {
+  const auto scalar_type = self.scalar_type();
+  const bool fused = self.dim() == 2 && target.dim() == 1 && self.size(1) > 0 &&
+      (scalar_type == kFloat || scalar_type == kDouble ||
+       (scalar_type == kHalf && self.is_cuda()));
+  if (!fused) {
+    return at::nll_loss(
+        at::log_softmax(self, 1), target, weight, reduction, ignore_index);
+  }
+
+  Tensor losses, lse, target_weight;
+  std::tie(losses, lse, target_weight) =
+      at::_cross_entropy_loss_forward(self, target, weight, ignore_index);
+  if (reduction == Reduction::None) {
+    return losses;
+  }
+  auto loss = losses.sum();
+  if (reduction == Reduction::Mean) {
+    // Like nll_loss, a zero total weight only gives NaN for an empty
+    // input, see #15870.
+    auto total_weight = target_weight.sum();
+    if (self.numel() != 0) {
+      total_weight.masked_fill_(total_weight.eq(0), 1);
+    }
+    loss = loss / total_weight;
+  }
+  return loss;
+}
+
+DEFINE_DISPATCH(cross_entropy_lastdim_kernel);
+DEFINE_DISPATCH(cross_entropy_backward_lastdim_kernel);
+
 } // namespace native
 } // namespace at
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <limits>
 #include <type_traits>
+#include <c10/util/BFloat16.h>
 #include <c10/util/math_compat.h>
 
 #ifndef M_PIf
@@ -101,6 +102,11 @@ Date:  February 1996
 
 #undef CENTRAL_RANGE
 
+// Used by vec256<c10::BFloat16>::map
+static inline c10::BFloat16 calc_erfinv(c10::BFloat16 a) {
+  return calc_erfinv(static_cast<float>(a));
+}
+
 static inline double polevl(double x, double *A, size_t len) {
   double result = 0;
   for (size_t i = 0; i <= len; i++) {
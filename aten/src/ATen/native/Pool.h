@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/div_rtn.h>
+#include <ATen/native/DispatchStub.h>
 #include <tuple>
 
 #pragma once
@@ -258,5 +259,12 @@ avg_pool3d_backward_shape_check(
 
 } // namespace
 
+// Max pooling of a 4-D channels last input into a channels last output, with
+// the indices of the maxima in their input plane, like the generic kernel.
+using max_pool2d_fn = void(*)(Tensor& output, Tensor& indices, const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH, int dilationW, int dilationH);
+
+DECLARE_DISPATCH(max_pool2d_fn, max_pool2d_channels_last_kernel);
+
 } // at::native
 } // at
@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
@@ -9,6 +10,9 @@
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(lstm_gates_stub);
+DEFINE_DISPATCH(gru_gates_stub);
+
 namespace {
 
 // Check if pytorch is compiled with MIOpen.
@@ -172,26 +176,19 @@ struct QuantizedCellParamsDynamic {
   }
 
   Tensor linear_ih(const Tensor& input_ih) const {
-    const auto kFuncName = "quantized::linear_dynamic";
-    const auto kOvrldName = "";
-    const std::vector<c10::IValue> output_ih_list =
-        callOp(kFuncName, kOvrldName, input_ih, w_ih);
-    TORCH_INTERNAL_ASSERT(
-        output_ih_list.size() == 1,
-        "The output vector should have exact one element");
-    const Tensor output_ih = output_ih_list[0].toTensor();
-    return output_ih;
+    return linear_dynamic(input_ih, w_ih);
   }
   Tensor linear_hh(const Tensor& input_hh) const {
-    const auto kFuncName = "quantized::linear_dynamic";
-    const auto kOvrldName = "";
-    const std::vector<c10::IValue> output_hh_list =
-        callOp(kFuncName, kOvrldName, input_hh, w_hh);
-    TORCH_INTERNAL_ASSERT(
-        output_hh_list.size() == 1,
-        "The output vector should have exact one element");
-    const Tensor output_hh = output_hh_list[0].toTensor();
-    return output_hh;
+    return linear_dynamic(input_hh, w_hh);
+  }
+
+ private:
+  // Called once per step for w_hh, so the operator is looked up only once
+  // and called without boxing the arguments.
+  static Tensor linear_dynamic(const Tensor& input, const Tensor& packed) {
+    static const auto op = c10::Dispatcher::singleton().findSchemaOrThrow(
+        "quantized::linear_dynamic", "");
+    return op.callUnboxed<Tensor, Tensor, Tensor>(input, packed);
   }
 };
 
@@ -342,6 +339,70 @@ static std::vector<QuantizedCellParamsFP16> gather_quantized_params_fp16(
   return result;
 }
 
+// The elementwise part of the gates is computed with the fused CPU kernels
+// below (lstm_gates_stub / gru_gates_stub) whenever autograd is not involved:
+// always for the quantized cell params, which are only used for inference,
+// and for float params when neither the gates nor the hidden state require
+// grad, e.g. under no_grad.
+template <typename cell_params>
+struct uses_fused_cpu_gates : std::false_type {};
+template <>
+struct uses_fused_cpu_gates<CellParams> : std::true_type {};
+template <>
+struct uses_fused_cpu_gates<QuantizedCellParams> : std::true_type {};
+template <>
+struct uses_fused_cpu_gates<QuantizedCellParamsDynamic> : std::true_type {};
+template <>
+struct uses_fused_cpu_gates<QuantizedCellParamsFP16> : std::true_type {};
+
+template <typename cell_params>
+bool use_fused_cpu_gates(const Tensor& gates, const Tensor& hidden) {
+  return uses_fused_cpu_gates<cell_params>::value && gates.device().is_cpu() &&
+      gates.scalar_type() == kFloat && hidden.scalar_type() == kFloat &&
+      !gates.requires_grad() && !hidden.requires_grad();
+}
+
+// The elementwise part of an LSTM cell in a single pass: `gates` holds the
+// input, forget, cell and output gates of every batch element, before their
+// nonlinearities.
+tpair_of<Tensor> fused_lstm_gates_cpu(const Tensor& gates, const Tensor& cx) {
+  const auto gates_contig = gates.contiguous();
+  const auto cx_contig = cx.contiguous();
+  const int64_t batch = cx_contig.size(0);
+  const int64_t hidden_size = cx_contig.size(1);
+  TORCH_CHECK(
+      gates_contig.size(0) == batch && gates_contig.size(1) == 4 * hidden_size,
+      "Expected LSTM gates of size ", IntArrayRef{batch, 4 * hidden_size},
+      ", got ", gates_contig.sizes());
+  auto hy = at::empty_like(cx_contig);
+  auto cy = at::empty_like(cx_contig);
+  lstm_gates_stub(kCPU, hy, cy, gates_contig, cx_contig);
+  return std::make_tuple(std::move(hy), std::move(cy));
+}
+
+// The elementwise part of a GRU cell in a single pass: `igates` and `hgates`
+// hold the reset, input and new gates computed from the input and from the
+// hidden state.
+Tensor fused_gru_gates_cpu(
+    const Tensor& igates,
+    const Tensor& hgates,
+    const Tensor& hx) {
+  const auto igates_contig = igates.contiguous();
+  const auto hgates_contig = hgates.contiguous();
+  const auto hx_contig = hx.contiguous();
+  const int64_t batch = hx_contig.size(0);
+  const int64_t hidden_size = hx_contig.size(1);
+  TORCH_CHECK(
+      igates_contig.sizes() == hgates_contig.sizes() &&
+          igates_contig.size(0) == batch &&
+          igates_contig.size(1) == 3 * hidden_size,
+      "Expected GRU gates of size ", IntArrayRef{batch, 3 * hidden_size},
+      ", got ", igates_contig.sizes(), " and ", hgates_contig.sizes());
+  auto hy = at::empty_like(hx_contig);
+  gru_gates_stub(kCPU, hy, igates_contig, hgates_contig, hx_contig);
+  return hy;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // HIDDEN STATE FUNCTIONS
 //
@@ -442,6 +503,9 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
 
     const auto gates = params.linear_hh(hx).add_(
         pre_compute_input ? input : params.linear_ih(input));
+    if (use_fused_cpu_gates<cell_params>(gates, cx)) {
+      return fused_lstm_gates_cpu(gates, cx);
+    }
     auto chunked_gates = gates.chunk(4, 1);
     auto ingate = chunked_gates[0].sigmoid_();
     auto forgetgate = chunked_gates[1].sigmoid_();
@@ -472,10 +536,13 @@ struct GRUCell : Cell<Tensor, cell_params> {
       // Slice off the workspace argument (it's needed only for AD).
       return std::move(std::get<0>(result));
     }
-    const auto chunked_igates = pre_compute_input
-        ? input.chunk(3, 1)
-        : params.linear_ih(input).chunk(3, 1);
-    auto chunked_hgates = params.linear_hh(hidden).chunk(3, 1);
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    const auto hgates = params.linear_hh(hidden);
+    if (use_fused_cpu_gates<cell_params>(hgates, hidden)) {
+      return fused_gru_gates_cpu(igates, hgates, hidden);
+    }
+    const auto chunked_igates = igates.chunk(3, 1);
+    auto chunked_hgates = hgates.chunk(3, 1);
     const auto reset_gate =
         chunked_hgates[0].add_(chunked_igates[0]).sigmoid_();
     const auto input_gate =
@@ -609,6 +676,26 @@ struct FullBidirectionalLayer
   FullLayer<dir_hidden_type, cell_params> layer_;
 };
 
+// Collects the output of one step of a packed layer, which covers rows
+// [offset, offset + step_output.size(0)) of the packed output. When autograd
+// is not recording (checked on the first step), the rows are copied straight
+// into a packed output of `total_rows` rows allocated up front, so step outputs
+// are freed as we go and no final cat is needed. Otherwise the steps are kept
+// for a cat at the end, which autograd can differentiate without copies into
+// slices.
+void packed_output_step(Tensor& output, std::vector<Tensor>& step_outputs,
+                        const Tensor& step_output, int64_t total_rows,
+                        int64_t offset, bool first_step) {
+  if (first_step && !step_output.requires_grad()) {
+    output = at::empty({total_rows, step_output.size(1)}, step_output.options());
+  }
+  if (output.defined()) {
+    output.narrow(0, offset, step_output.size(0)).copy_(step_output);
+  } else {
+    step_outputs.push_back(step_output);
+  }
+}
+
 template<typename hidden_type, typename cell_params>
 struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
   using output_type =
@@ -645,10 +732,10 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     // are completed now). The sliced parts are also saved, because we will need
     // to return a tensor of final hidden state.
     auto hidden = input_hidden;
+    Tensor output;
     for (int64_t i = 0; i < num_steps; ++i) {
       const int64_t batch_size = batch_sizes[i];
       auto step_input = input_ptr->narrow(0, input_offset, batch_size);
-      input_offset += batch_size;
       const int64_t dec = last_batch_size - batch_size;
       if (dec > 0) {
         hiddens.emplace_back(
@@ -658,12 +745,17 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
 
       last_batch_size = batch_size;
       hidden = cell_(step_input, hidden, params, pre_compute_input);
-      step_outputs.push_back(hidden_as_output(hidden));
+      packed_output_step(output, step_outputs, hidden_as_output(hidden),
+                         input.data.size(0), input_offset, i == 0);
+      input_offset += batch_size;
     }
     hiddens.emplace_back(hidden);
     std::reverse(hiddens.begin(), hiddens.end());
 
-    return {PackedSequence{at::cat(step_outputs, 0), input.batch_sizes},
+    if (!output.defined()) {
+      output = at::cat(step_outputs, 0);
+    }
+    return {PackedSequence{std::move(output), input.batch_sizes},
             hidden_concat(hiddens)};
   }
 
@@ -702,6 +794,7 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     // and progressively expand the hidden states, as we move backwards over the
     // 1D list of inputs.
     auto hidden = hidden_slice(input_hidden, 0, batch_sizes[num_steps - 1]);
+    Tensor output;
     for (int64_t i = num_steps - 1; i >= 0; --i) {
       const int64_t batch_size = batch_sizes[i];
       const int64_t inc = batch_size - last_batch_size;
@@ -714,10 +807,14 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
       input_offset -= batch_size;
       last_batch_size = batch_size;
       hidden = cell_(step_input, hidden, params, pre_compute_input);
-      step_outputs.emplace_back(hidden_as_output(hidden));
+      packed_output_step(output, step_outputs, hidden_as_output(hidden),
+                         input.data.size(0), input_offset, i == num_steps - 1);
+    }
+    if (!output.defined()) {
+      std::reverse(step_outputs.begin(), step_outputs.end());
+      output = at::cat(step_outputs, 0);
     }
-    std::reverse(step_outputs.begin(), step_outputs.end());
-    return {PackedSequence{at::cat(step_outputs, 0), input.batch_sizes},
+    return {PackedSequence{std::move(output), input.batch_sizes},
             hidden};
   }
 
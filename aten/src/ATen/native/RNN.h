@@ -27,6 +27,13 @@ DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_miopen_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_miopen_stub);
 
+// The elementwise part of LSTM and GRU cells on CPU. All tensors are
+// contiguous float tensors; the outputs are already allocated.
+using lstm_gates_fn = void(*)(Tensor& hy, Tensor& cy, const Tensor& gates, const Tensor& cx);
+using gru_gates_fn = void(*)(Tensor& hy, const Tensor& igates, const Tensor& hgates, const Tensor& hx);
+DECLARE_DISPATCH(lstm_gates_fn, lstm_gates_stub);
+DECLARE_DISPATCH(gru_gates_fn, gru_gates_stub);
+
 inline void check_device(const Tensor& input, const TensorList& params, const TensorList& hiddens) {
   auto input_device = input.device();
 
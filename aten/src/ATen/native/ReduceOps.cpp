@@ -29,8 +29,11 @@ DEFINE_DISPATCH(and_stub);
 DEFINE_DISPATCH(or_stub);
 DEFINE_DISPATCH(min_values_stub);
 DEFINE_DISPATCH(max_values_stub);
+DEFINE_DISPATCH(min_max_stub);
 DEFINE_DISPATCH(argmax_stub);
 DEFINE_DISPATCH(argmin_stub);
+DEFINE_DISPATCH(cumsum_stub);
+DEFINE_DISPATCH(cumprod_stub);
 
 #define OPTION_TYPE_EQUALITY_CHECK(option, out, self) \
 { \
@@ -180,6 +183,45 @@ static TensorIterator make_reduction(
   return TensorIterator::reduce_op(viewed_result1, viewed_result2, self.to(dtype));
 }
 
+template <typename Stub>
+static Tensor& cum_out_impl(Tensor& result, const Tensor& self, int64_t dim, Stub& stub, const char* name) {
+  TORCH_CHECK(result.scalar_type() == self.scalar_type(),
+      name, ": expected result to have dtype ", self.scalar_type(),
+      " but got ", result.scalar_type());
+  dim = maybe_wrap_dim(dim, self.dim());
+  result.resize_as_(self);
+  if (self.numel() == 0) {
+    return result;
+  }
+  auto self_ = self.contiguous();
+  if (result.is_contiguous()) {
+    stub(self.device().type(), result, self_, dim);
+  } else {
+    auto result_ = at::empty_like(self_, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    stub(self.device().type(), result_, self_, dim);
+    result.copy_(result_);
+  }
+  return result;
+}
+
+Tensor& _cumsum_out(Tensor& result, const Tensor& self, int64_t dim) {
+  return cum_out_impl(result, self, dim, cumsum_stub, "cumsum");
+}
+
+Tensor _cumsum(const Tensor& self, int64_t dim) {
+  auto result = at::empty({0}, self.options());
+  return at::native::_cumsum_out(result, self, dim);
+}
+
+Tensor& _cumprod_out(Tensor& result, const Tensor& self, int64_t dim) {
+  return cum_out_impl(result, self, dim, cumprod_stub, "cumprod");
+}
+
+Tensor _cumprod(const Tensor& self, int64_t dim) {
+  auto result = at::empty({0}, self.options());
+  return at::native::_cumprod_out(result, self, dim);
+}
+
 Tensor cumsum(const Tensor& self, int64_t dim, c10::optional<ScalarType> dtype) {
   auto result = [&]() {
     NoNamesGuard guard;
@@ -675,6 +717,23 @@ Tensor max_values(const Tensor& self, IntArrayRef dims, bool keepdim) {
   }
 }
 
+std::tuple<Tensor, Tensor> _aminmax(const Tensor& self, IntArrayRef dims, bool keepdim) {
+  TORCH_CHECK(self.device().type() == DeviceType::CPU || self.device().type() == DeviceType::CUDA,
+              "_aminmax only supports CPU AND CUDA device type, got: ", self.device().type());
+  TORCH_CHECK(self.layout() == Layout::Strided,
+              "_aminmax only supports strided layout, got: ", self.layout());
+  Tensor min = at::empty({0}, self.options());
+  Tensor max = at::empty({0}, self.options());
+  auto iter = make_reduction("_aminmax", min, max, self, dims, keepdim, self.scalar_type());
+  TORCH_CHECK(iter.numel() > 0, "_aminmax on a tensor with no elements is not defined.");
+  min_max_stub(iter.device_type(), iter);
+  return std::make_tuple(min, max);
+}
+
+std::tuple<Tensor, Tensor> _aminmax(const Tensor& self) {
+  return at::native::_aminmax(self, {}, false);
+}
+
 Tensor min_values(const Tensor& self, DimnameList dims, bool keepdim) {
   TORCH_CHECK(false, "NYI: min_values with names");
   return at::min_values(self, dimnames_to_positions(self, dims), keepdim);
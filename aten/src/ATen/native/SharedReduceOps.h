@@ -336,6 +336,34 @@ struct ArgMinOps :
   public detail::ArgReductionOps<detail::LessOrNan<scalar_t>> {
 };
 
+// Computes the minimum and the maximum in a single pass, res_t holds both.
+// NaN propagates to both of them.
+template <typename scalar_t, typename res_t>
+struct MinMaxOps {
+  using acc_t = detail::pair<scalar_t, scalar_t>;
+
+  inline C10_DEVICE acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    return combine(acc, acc_t(data, data));
+  }
+
+  inline C10_DEVICE acc_t combine(acc_t a, acc_t b) const {
+    return acc_t(
+        detail::LessOrNan<scalar_t>{}(a.first, b.first) ? a.first : b.first,
+        detail::GreaterOrNan<scalar_t>{}(a.second, b.second) ? a.second : b.second);
+  }
+
+  inline C10_DEVICE res_t project(acc_t acc) const {
+    return res_t(acc.first, acc.second);
+  }
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+  inline C10_DEVICE acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return acc_t(WARP_SHFL_DOWN(acc.first, offset),
+                 WARP_SHFL_DOWN(acc.second, offset));
+  }
+#endif
+};
+
 }} // namespace at::native
 
 #undef MAX
@@ -277,6 +277,12 @@ Tensor log_softmax(const Tensor& input_, const int64_t dim_, c10::optional<Scala
   return result;
 }
 
+Tensor masked_softmax_cpu(const Tensor& self, const Tensor& mask) {
+  TORCH_CHECK(mask.scalar_type() == ScalarType::Bool,
+              "_masked_softmax: expected mask to be a bool tensor, but got ", mask.scalar_type());
+  return self.masked_fill(mask, -std::numeric_limits<double>::infinity()).softmax(-1);
+}
+
 DEFINE_DISPATCH(softmax_lastdim_kernel);
 DEFINE_DISPATCH(log_softmax_lastdim_kernel);
 DEFINE_DISPATCH(softmax_backward_lastdim_kernel);
@@ -1,6 +1,7 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <array>
+#include <unordered_map>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/native/TypeProperties.h>
@@ -1026,14 +1027,189 @@ FastSetupType TensorIterator::compute_fast_setup_type() {
   return FastSetupType::NONE;
 }
 
+// Note [TensorIterator plan cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// For small tensors, computing the broadcast shape, the result type, the
+// dimension order and the coalesced strides in build() costs more than the
+// kernel itself. Within a TensorIteratorPlanCacheGuard, build() keeps the
+// result of that work in a thread local cache, keyed on everything it depends
+// on: the iterator configuration and, for every operand, whether it is
+// defined, whether it is an output and/or also an input, its requested
+// device and dtype, and its dtype, device, sizes and strides. A later
+// iterator with the same key gets the cached strides and dtypes and has its
+// missing outputs allocated with the cached sizes and strides.
+//
+// Only elementwise iterators over unnamed, non-quantized operands are cached,
+// and a plan is only stored if build() did not replace, resize or restride
+// any operand it was given (e.g. to cast it to the common dtype), because
+// those side effects cannot be replayed from the plan. The memory overlap
+// checks depend on the data pointers and run on every call.
+
+struct OperandPlan {
+  TensorIterator::StrideVector stride_bytes;
+  Device device = kCPU;
+  ScalarType target_dtype = ScalarType::Undefined;
+  ScalarType current_dtype = ScalarType::Undefined;
+  // Sizes and strides of an output allocated by build(); empty otherwise
+  DimVector alloc_sizes;
+  DimVector alloc_strides;
+};
+
+struct TensorIteratorPlan {
+  DimVector shape;
+  DimVector perm;
+  ScalarType common_dtype = ScalarType::Undefined;
+  bool has_coalesced_dimensions = false;
+  bool all_ops_same_shape = false;
+  bool requires_channels_last_output = false;
+  SmallVector<OperandPlan, 4> operands;
+};
+
+namespace {
+
+struct PlanKeyHash {
+  size_t operator()(const TensorIterator::PlanKey& key) const {
+    size_t seed = key.size();
+    for (auto v : key) {
+      seed ^= std::hash<int64_t>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+// Plenty for the handful of geometries a model uses; when a thread goes past
+// it, its cache is simply dropped and refilled.
+constexpr size_t plan_cache_max_size = 1024;
+
+thread_local bool plan_cache_enabled = false;
+thread_local std::unordered_map<TensorIterator::PlanKey, TensorIteratorPlan, PlanKeyHash> plan_cache;
+
+} // namespace
+
+TensorIteratorPlanCacheGuard::TensorIteratorPlanCacheGuard(bool enabled)
+  : prev_(plan_cache_enabled) {
+  plan_cache_enabled = enabled;
+}
+
+TensorIteratorPlanCacheGuard::~TensorIteratorPlanCacheGuard() {
+  plan_cache_enabled = prev_;
+}
+
+size_t TensorIteratorPlanCacheGuard::cache_size() {
+  return plan_cache.size();
+}
+
+void TensorIteratorPlanCacheGuard::clear_cache() {
+  plan_cache.clear();
+}
+
+bool TensorIterator::compute_plan_key(PlanKey& key) const {
+  if (is_reduction_) {
+    return false;
+  }
+  key.push_back(num_outputs_);
+  key.push_back(static_cast<int64_t>(common_dtype_strategy_));
+  key.push_back(resize_outputs_);
+  key.push_back(allow_cpu_scalars_);
+  key.push_back(promote_gpu_output_dtypes_);
+  for (const auto& op : operands_) {
+    const auto& t = op.tensor;
+    key.push_back(t.defined());
+    key.push_back(op.is_output);
+    key.push_back(op.is_read_write);
+    key.push_back(static_cast<int64_t>(op.target_dtype));
+    key.push_back(static_cast<int64_t>(op.device.type()));
+    key.push_back(op.device.index());
+    if (!t.defined()) {
+      if (!op.is_output) {
+        return false;
+      }
+      continue;
+    }
+    if (t.has_names() || isQIntType(op.current_dtype)) {
+      return false;
+    }
+    key.push_back(static_cast<int64_t>(op.current_dtype));
+    key.push_back(static_cast<int64_t>(t.device().type()));
+    key.push_back(t.device().index());
+    key.push_back(t.unsafeGetTensorImpl()->is_wrapped_number());
+    key.push_back(t.dim());
+    key.append(t.sizes().begin(), t.sizes().end());
+    key.append(t.strides().begin(), t.strides().end());
+  }
+  return true;
+}
+
+TensorIteratorPlan TensorIterator::make_plan() const {
+  TensorIteratorPlan plan;
+  plan.shape = shape_;
+  plan.perm = perm_;
+  plan.common_dtype = common_dtype_;
+  plan.has_coalesced_dimensions = has_coalesced_dimensions_;
+  plan.all_ops_same_shape = all_ops_same_shape_;
+  plan.requires_channels_last_output = requires_channels_last_output_;
+  for (const auto& op : operands_) {
+    OperandPlan op_plan;
+    op_plan.stride_bytes = op.stride_bytes;
+    op_plan.device = op.device;
+    op_plan.target_dtype = op.target_dtype;
+    op_plan.current_dtype = op.current_dtype;
+    plan.operands.push_back(std::move(op_plan));
+  }
+  return plan;
+}
+
+void TensorIterator::apply_plan(const TensorIteratorPlan& plan) {
+  shape_ = plan.shape;
+  perm_ = plan.perm;
+  common_dtype_ = plan.common_dtype;
+  has_coalesced_dimensions_ = plan.has_coalesced_dimensions;
+  all_ops_same_shape_ = plan.all_ops_same_shape;
+  requires_channels_last_output_ = plan.requires_channels_last_output;
+  for (size_t i = 0; i < operands_.size(); i++) {
+    auto& op = operands_[i];
+    const auto& op_plan = plan.operands[i];
+    op.stride_bytes = op_plan.stride_bytes;
+    op.device = op_plan.device;
+    op.target_dtype = op_plan.target_dtype;
+    op.current_dtype = op_plan.current_dtype;
+    if (!op.tensor.defined()) {
+      op.tensor = at::empty_strided(op_plan.alloc_sizes, op_plan.alloc_strides, op.options());
+    }
+    op.data = op.tensor.data_ptr();
+  }
+}
+
 void TensorIterator::build() {
-  // check input tensors memory format to use it during output allocation
-  analyze_memory_format();
   // set is_output and is_read_write flags on appropriate tensors
   mark_outputs();
   // Check that the outputs have no internal overlap
   // and do not share memory with inputs.
   check_mem_overlaps();
+
+  PlanKey plan_key;
+  bool use_plan_cache = plan_cache_enabled && compute_plan_key(plan_key);
+  if (use_plan_cache) {
+    auto it = plan_cache.find(plan_key);
+    if (it != plan_cache.end()) {
+      apply_plan(it->second);
+      return;
+    }
+  }
+  // The operands as they were given, to check that the plan is replayable
+  SmallVector<Tensor, 4> given;
+  SmallVector<DimVector, 4> given_sizes;
+  SmallVector<DimVector, 4> given_strides;
+  if (use_plan_cache) {
+    for (const auto& op : operands_) {
+      given.push_back(op.tensor);
+      given_sizes.emplace_back(op.tensor.defined() ? op.tensor.sizes() : IntArrayRef());
+      given_strides.emplace_back(op.tensor.defined() ? op.tensor.strides() : IntArrayRef());
+    }
+  }
+
+  // check input tensors memory format to use it during output allocation
+  analyze_memory_format();
   // Check that input dimensions are aligned correctly & compute outnames.
   compute_names();
   // compute the broadcasted shape
@@ -1058,6 +1234,26 @@ void TensorIterator::build() {
     TORCH_INTERNAL_ASSERT(op.tensor.defined());
     op.data = op.tensor.data_ptr();
   }
+
+  if (use_plan_cache) {
+    TensorIteratorPlan plan = make_plan();
+    for (size_t i = 0; i < operands_.size(); i++) {
+      const auto& op = operands_[i];
+      if (!given[i].defined()) {
+        plan.operands[i].alloc_sizes = op.tensor.sizes();
+        plan.operands[i].alloc_strides = op.tensor.strides();
+      } else if (!op.tensor.is_same(given[i]) ||
+                 op.original_tensor.defined() ||
+                 !op.tensor.sizes().equals(given_sizes[i]) ||
+                 !op.tensor.strides().equals(given_strides[i])) {
+        return;
+      }
+    }
+    if (plan_cache.size() >= plan_cache_max_size) {
+      plan_cache.clear();
+    }
+    plan_cache.emplace(std::move(plan_key), std::move(plan));
+  }
 }
 
 SplitUntil32Bit TensorIterator::with_32bit_indexing() const {
@@ -131,6 +131,7 @@ struct CAFFE2_API OperandInfo {
 };
 
 struct SplitUntil32Bit;
+struct TensorIteratorPlan;
 
 enum class FastSetupType : uint8_t {
   NONE,
@@ -374,6 +375,12 @@ protected:
   void coalesce_dimensions();
   void analyze_memory_format();
 
+  // See Note [TensorIterator plan cache]
+  using PlanKey = SmallVector<int64_t, 32>;
+  bool compute_plan_key(PlanKey& key) const;
+  TensorIteratorPlan make_plan() const;
+  void apply_plan(const TensorIteratorPlan& plan);
+
 protected:
   DimVector shape_;
   DimVector perm_;
@@ -393,6 +400,25 @@ protected:
   bool all_ops_same_shape_ = false;
   bool requires_channels_last_output_ = false;
 };
+
+/// While one of these is alive, TensorIterator::build() on the current thread
+/// caches the iteration plan it computes (shape, strides, dtypes and output
+/// allocation) keyed on the geometry, dtypes and devices of the operands, and
+/// reuses it for later iterators over operands with the same geometry.
+/// See Note [TensorIterator plan cache].
+struct CAFFE2_API TensorIteratorPlanCacheGuard {
+  TensorIteratorPlanCacheGuard(bool enabled = true);
+  ~TensorIteratorPlanCacheGuard();
+
+  /// Number of plans cached by the current thread
+  static size_t cache_size();
+  /// Drops every plan cached by the current thread
+  static void clear_cache();
+
+ private:
+  bool prev_;
+};
+
 /// A container-like struct that acts as if it contains splits of a
 /// TensorIterator that can use 32-bit indexing. Taken together the splits cover
 /// the original TensorIterator.
@@ -16,6 +16,9 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/Copy.h>
 #include <ATen/MemoryOverlap.h>
+#include <ATen/Parallel.h>
+#include <cstring>
+#include <numeric>
 
 namespace at {
 namespace native {
@@ -69,6 +72,83 @@ static inline void check_cat_shape_except_dim(const Tensor & first, const Tensor
   }
 }
 
+// Copies the inputs that are dense in the memory format of result into it with
+// a single parallel loop. result must be dense in memory_format. In that
+// layout, the output is `outer` rows, and each row is made of one run of
+// (input size in dim) * inner elements of each input, one after the other. So
+// the offsets of the runs in a row are computed once, and every thread copies
+// the runs that intersect its range of the output with memcpy. The inputs for
+// which dense is false are left out and have to be copied by the caller.
+static void cat_dense_kernel(Tensor& result, TensorList tensors, int64_t dim,
+                             at::MemoryFormat memory_format, const std::vector<bool>& dense) {
+  std::vector<int64_t> order(result.dim());
+  std::iota(order.begin(), order.end(), 0);
+  if (memory_format == at::MemoryFormat::ChannelsLast) {
+    order = {0, 2, 3, 1};
+  }
+  int64_t outer = 1;
+  int64_t inner = 1;
+  bool before_dim = true;
+  for (auto d : order) {
+    if (d == dim) {
+      before_dim = false;
+    } else if (before_dim) {
+      outer *= result.size(d);
+    } else {
+      inner *= result.size(d);
+    }
+  }
+
+  // run_offsets[j] is the offset of the run of input j in a row
+  const int64_t ninputs = tensors.size();
+  std::vector<int64_t> run_offsets(ninputs + 1, 0);
+  std::vector<const char*> input_data(ninputs, nullptr);
+  for (int64_t j = 0; j < ninputs; j++) {
+    const auto& tensor = tensors[j];
+    bool skipped = tensor.numel() == 0 && tensor.dim() == 1;
+    run_offsets[j + 1] = run_offsets[j] + (skipped ? 0 : tensor.size(dim) * inner);
+    if (dense[j]) {
+      input_data[j] = static_cast<const char*>(tensor.data_ptr());
+    }
+  }
+  const int64_t row_size = run_offsets[ninputs];
+  if (outer == 0 || row_size == 0) {
+    return;
+  }
+
+  const size_t element_size = result.dtype().itemsize();
+  char* result_data = static_cast<char*>(result.data_ptr());
+  at::parallel_for(0, outer * row_size, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    int64_t row = begin / row_size;
+    int64_t pos = begin % row_size;
+    // the run containing pos; empty runs are never found
+    int64_t j = std::upper_bound(run_offsets.begin(), run_offsets.end(), pos) - run_offsets.begin() - 1;
+    for (int64_t i = begin; i < end;) {
+      int64_t run_size = run_offsets[j + 1] - run_offsets[j];
+      int64_t n = std::min(run_offsets[j + 1] - pos, end - i);
+      if (input_data[j] != nullptr) {
+        std::memcpy(result_data + i * element_size,
+                    input_data[j] + (row * run_size + pos - run_offsets[j]) * element_size,
+                    n * element_size);
+      }
+      i += n;
+      pos += n;
+      // move to the next non-empty run
+      while (j < ninputs && run_offsets[j + 1] == pos) {
+        j++;
+      }
+      if (j == ninputs) {
+        row++;
+        pos = 0;
+        j = 0;
+        while (run_offsets[j + 1] == 0) {
+          j++;
+        }
+      }
+    }
+  });
+}
+
 Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   // previously, size [0] tensors were the only possible empty tensors; thus, it wasn't possible
   // to cat empty tensors unless all the other tensors were 1-dimensional, so we allowed these tensors
@@ -107,6 +187,9 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   // when the input tensors are of the same size and strides,
   // reuse the same iterator for all input tensors
   bool reuse_iterator = true;
+  // the output keeps the memory format the inputs share
+  auto memory_format = notSkippedTensor.suggest_memory_format();
+  bool same_memory_format = true;
 
   // compute size of the result in the cat dimension
   int64_t cat_dim_size = 0;
@@ -121,15 +204,47 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
         tensor.strides() != notSkippedTensor.strides()) {
       reuse_iterator = false;
     }
+    if (tensor.suggest_memory_format() != memory_format) {
+      same_memory_format = false;
+    }
   }
 
   // compute the size of the result
   auto result_size = notSkippedTensor.sizes().vec();
   result_size[dim] = cat_dim_size;
-  result.resize_(result_size);
+  if (result.sizes() != result_size) {
+    result.resize_(result_size, same_memory_format ? memory_format : at::MemoryFormat::Contiguous);
+  }
+
+  // inputs that can be copied by cat_dense_kernel
+  memory_format = result.suggest_memory_format();
+  bool use_dense_kernel = false;
+  std::vector<bool> dense(tensors.size(), false);
+  if (result.is_contiguous(memory_format)) {
+    for (size_t j = 0; j < tensors.size(); j++) {
+      const auto& tensor = tensors[j];
+      dense[j] = !should_skip(tensor) && tensor.scalar_type() == result.scalar_type() &&
+                 tensor.is_contiguous(memory_format);
+      use_dense_kernel |= dense[j];
+    }
+  }
 
   int64_t offset = 0;
-  if (reuse_iterator && result.is_contiguous()) {
+  if (use_dense_kernel) {
+    cat_dense_kernel(result, tensors, dim, memory_format, dense);
+    // copy the other inputs
+    for (size_t j = 0; j < tensors.size(); j++) {
+      const auto& tensor = tensors[j];
+      if (should_skip(tensor)) {
+        continue;
+      }
+      auto slice_dim_size = tensor.size(dim);
+      if (!dense[j]) {
+        result.narrow(dim, offset, slice_dim_size).copy_(tensor);
+      }
+      offset += slice_dim_size;
+    }
+  } else if (reuse_iterator && result.is_contiguous()) {
     auto source_slice = notSkippedTensor;
     auto slice_dim_size = source_slice.size(dim);
     auto result_slice = result.narrow(dim, 0, slice_dim_size);
@@ -2,17 +2,142 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
 #include <set>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
+#include <type_traits>
+#include <vector>
 
 namespace at {
 namespace native{
 
 namespace {
 
+// Inputs with at least this many elements are split by hash into
+// 2^kUniquePartitionBits partitions, which hold disjoint sets of values and
+// are hashed in parallel.
+constexpr int64_t kUniqueParallelThreshold = 1 << 16;
+constexpr int kUniquePartitionBits = 6;
+// Number of input elements per task of the passes over the input.
+constexpr int64_t kUniqueChunkSize = 1 << 16;
+
+template <typename scalar_t>
+inline uint64_t unique_hash(scalar_t value) {
+  // std::hash is the identity for integers (and maps 0.0 and -0.0 to the same
+  // value for floating types), so its bits are mixed with the finalizer of
+  // MurmurHash3 to spread them over the partitions and the table slots.
+  uint64_t h = std::hash<scalar_t>()(value);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Open addressing (linear probing) hash table of the distinct values of one
+// partition of the input, which are numbered in order of first occurrence.
+template <typename scalar_t>
+struct UniqueHashTable {
+  // a copy of the value is kept in its slot to compare it without going
+  // through values; id is -1 for empty slots
+  struct Slot {
+    int64_t id;
+    scalar_t value;
+  };
+
+  std::vector<scalar_t> values;
+  std::vector<uint64_t> hashes;
+  std::vector<int64_t> counts;
+  std::vector<Slot> slots = std::vector<Slot>(16, Slot{-1, scalar_t()});
+
+  // Returns the number of value, after counting one more occurrence of it.
+  int64_t insert(scalar_t value, uint64_t hash) {
+    const uint64_t mask = slots.size() - 1;
+    for (uint64_t pos = hash & mask;; pos = (pos + 1) & mask) {
+      Slot& slot = slots[pos];
+      if (slot.id < 0) {
+        const int64_t id = values.size();
+        slot = Slot{id, value};
+        values.push_back(value);
+        hashes.push_back(hash);
+        counts.push_back(1);
+        if (2 * values.size() > slots.size()) {
+          grow();
+        }
+        return id;
+      }
+      if (slot.value == value) {
+        counts[slot.id]++;
+        return slot.id;
+      }
+    }
+  }
+
+  void grow() {
+    std::vector<Slot>(2 * slots.size(), Slot{-1, scalar_t()}).swap(slots);
+    const uint64_t mask = slots.size() - 1;
+    for (size_t id = 0; id < values.size(); id++) {
+      uint64_t pos = hashes[id] & mask;
+      while (slots[pos].id >= 0) {
+        pos = (pos + 1) & mask;
+      }
+      slots[pos] = Slot{static_cast<int64_t>(id), values[id]};
+    }
+  }
+};
+
+// Returns the indices of the n values in ascending order of the values.
+template <typename scalar_t>
+std::vector<int64_t> unique_sort_indices(const scalar_t* values, int64_t n, std::false_type /* radix */) {
+  std::vector<int64_t> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::sort(indices.begin(), indices.end(),
+      [&](int64_t a, int64_t b) { return values[a] < values[b]; });
+  return indices;
+}
+
+// Least significant digit radix sort of the order preserving unsigned keys of
+// integral values, one byte at a time. Bytes that are the same for all the
+// values (e.g. the high bytes of small ids) are skipped.
+template <typename scalar_t>
+std::vector<int64_t> unique_sort_indices(const scalar_t* values, int64_t n, std::true_type /* radix */) {
+  using key_t = typename std::make_unsigned<scalar_t>::type;
+  constexpr int kKeyBits = 8 * sizeof(key_t);
+  // flipping the sign bit orders negative values before positive ones
+  const key_t sign_flip = std::is_signed<scalar_t>::value ? static_cast<key_t>(key_t(1) << (kKeyBits - 1)) : 0;
+  std::vector<key_t> keys(n);
+  std::vector<key_t> keys_tmp(n);
+  std::vector<int64_t> indices(n);
+  std::vector<int64_t> indices_tmp(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = static_cast<key_t>(values[i]) ^ sign_flip;
+    indices[i] = i;
+  }
+  for (int shift = 0; shift < kKeyBits; shift += 8) {
+    int64_t offsets[257] = {0};
+    for (int64_t i = 0; i < n; i++) {
+      offsets[((keys[i] >> shift) & 0xff) + 1]++;
+    }
+    if (std::find(offsets + 1, offsets + 257, n) != offsets + 257) {
+      continue;
+    }
+    std::partial_sum(offsets, offsets + 257, offsets);
+    for (int64_t i = 0; i < n; i++) {
+      const int64_t pos = offsets[(keys[i] >> shift) & 0xff]++;
+      keys_tmp[pos] = keys[i];
+      indices_tmp[pos] = indices[i];
+    }
+    keys.swap(keys_tmp);
+    indices.swap(indices_tmp);
+  }
+  return indices;
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
     const Tensor& self,
@@ -22,50 +147,140 @@ std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data_ptr<scalar_t>();
   int64_t numel = input.numel();
-  Tensor output;
   Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
   Tensor counts = at::empty({0}, self.options().dtype(kLong));
 
-  std::unordered_set<scalar_t> set(input_data, input_data + numel);
-  output = at::empty({static_cast<int64_t>(set.size())}, input.options());
-  scalar_t *output_data = output.data_ptr<scalar_t>();
-
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
+  const int64_t num_partitions = numel >= kUniqueParallelThreshold ? (1 << kUniquePartitionBits) : 1;
+  auto partition_of = [num_partitions](uint64_t hash) -> int64_t {
+    return num_partitions == 1 ? 0 : static_cast<int64_t>(hash >> (64 - kUniquePartitionBits));
+  };
+
+  // The values of partition p are partition_values[partition_offsets[p]] up
+  // to partition_values[partition_offsets[p + 1]], in input order, and
+  // partition_elements holds their indices in the input (when return_inverse).
+  // With a single partition, they are all the elements and neither is used.
+  std::vector<int64_t> partition_offsets(num_partitions + 1, 0);
+  Tensor partition_values;
+  std::vector<int64_t> partition_elements;
+  if (num_partitions > 1) {
+    const int64_t num_chunks = divup(numel, kUniqueChunkSize);
+    // number of elements of every chunk in every partition, then the position
+    // of the next element of every chunk in partition_values
+    std::vector<int64_t> chunk_offsets(num_chunks * num_partitions, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* chunk_counts = chunk_offsets.data() + c * num_partitions;
+        const int64_t chunk_end = std::min(numel, (c + 1) * kUniqueChunkSize);
+        for (int64_t i = c * kUniqueChunkSize; i < chunk_end; i++) {
+          chunk_counts[partition_of(unique_hash(input_data[i]))]++;
+        }
+      }
+    });
+    int64_t offset = 0;
+    for (int64_t p = 0; p < num_partitions; p++) {
+      partition_offsets[p] = offset;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        const int64_t count = chunk_offsets[c * num_partitions + p];
+        chunk_offsets[c * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_offsets[num_partitions] = offset;
+    partition_values = at::empty({numel}, input.options());
+    scalar_t* partition_values_data = partition_values.data_ptr<scalar_t>();
+    partition_elements.resize(return_inverse ? numel : 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* next = chunk_offsets.data() + c * num_partitions;
+        const int64_t chunk_end = std::min(numel, (c + 1) * kUniqueChunkSize);
+        for (int64_t i = c * kUniqueChunkSize; i < chunk_end; i++) {
+          const int64_t pos = next[partition_of(unique_hash(input_data[i]))]++;
+          partition_values_data[pos] = input_data[i];
+          if (return_inverse) {
+            partition_elements[pos] = i;
+          }
+        }
+      }
+    });
   } else {
-    std::copy(set.begin(), set.end(), output_data);
+    partition_offsets[1] = numel;
   }
+  const scalar_t* values_data = num_partitions == 1 ? input_data : partition_values.data_ptr<scalar_t>();
 
-  if (return_inverse || return_counts) {
+  // Numbers the distinct values of every partition. The number of the value
+  // at every position of values_data is written to ids for now, which is
+  // inverse_indices itself when there is a single partition.
+  if (return_inverse) {
     inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data_ptr<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int64_t i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
-    }
-    for(int64_t i = 0; i < numel; ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
-    }
-    if (return_counts) {
-      std::unordered_map<scalar_t, int64_t> counts_map;
-      counts_map.reserve(output.numel());
-      for (int64_t i = 0; i < output.numel(); ++i) {
-        counts_map[output_data[i]] = 0;
+  }
+  int64_t* inverse_data = inverse_indices.data_ptr<int64_t>();
+  std::vector<int64_t> partition_ids(num_partitions > 1 && return_inverse ? numel : 0);
+  int64_t* ids = num_partitions == 1 ? inverse_data : partition_ids.data();
+  std::vector<UniqueHashTable<scalar_t>> tables(num_partitions);
+  at::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      auto& table = tables[p];
+      for (int64_t pos = partition_offsets[p]; pos < partition_offsets[p + 1]; pos++) {
+        const int64_t id = table.insert(values_data[pos], unique_hash(values_data[pos]));
+        if (return_inverse) {
+          ids[pos] = id;
+        }
       }
-      for(int64_t i = 0; i < numel; i++) {
-        counts_map[input_data[i]] += 1;
+    }
+  });
+
+  // the values of partition p come at unique_offsets[p] in the output
+  std::vector<int64_t> unique_offsets(num_partitions + 1, 0);
+  for (int64_t p = 0; p < num_partitions; p++) {
+    unique_offsets[p + 1] = unique_offsets[p] + tables[p].values.size();
+  }
+  const int64_t num_unique = unique_offsets[num_partitions];
+  Tensor output = at::empty({num_unique}, input.options());
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  if (return_counts) {
+    counts.resize_({num_unique});
+  }
+  int64_t* counts_data = counts.data_ptr<int64_t>();
+  at::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      const auto& table = tables[p];
+      std::copy(table.values.begin(), table.values.end(), output_data + unique_offsets[p]);
+      if (return_counts) {
+        std::copy(table.counts.begin(), table.counts.end(), counts_data + unique_offsets[p]);
       }
-      counts.resize_(output.sizes());
-      counts.fill_(0);
-      int64_t *counts_data = counts.data_ptr<int64_t>();
-      for(int64_t i = 0; i < output.numel(); i++) {
-        counts_data[i] = counts_map[output_data[i]];
+    }
+  });
+  tables.clear();
+
+  // position in the output of the value numbered id in the order above
+  std::vector<int64_t> positions;
+  if (sorted) {
+    const std::vector<int64_t> order = unique_sort_indices(
+        output_data, num_unique,
+        std::integral_constant<bool, std::is_integral<scalar_t>::value && !std::is_same<scalar_t, bool>::value>());
+    positions.resize(num_unique);
+    std::vector<scalar_t> values(output_data, output_data + num_unique);
+    std::vector<int64_t> value_counts(counts_data, counts_data + counts.numel());
+    for (int64_t k = 0; k < num_unique; k++) {
+      positions[order[k]] = k;
+      output_data[k] = values[order[k]];
+      if (return_counts) {
+        counts_data[k] = value_counts[order[k]];
       }
     }
   }
+
+  if (return_inverse) {
+    at::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        for (int64_t pos = partition_offsets[p]; pos < partition_offsets[p + 1]; pos++) {
+          const int64_t i = num_partitions == 1 ? pos : partition_elements[pos];
+          const int64_t id = unique_offsets[p] + ids[pos];
+          inverse_data[i] = sorted ? positions[id] : id;
+        }
+      }
+    });
+  }
   return std::make_tuple(output, inverse_indices, counts);
 }
 
@@ -77,7 +292,7 @@ std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data_ptr<scalar_t>();
   int64_t numel = input.numel();
-  Tensor output = at::empty({numel}, input.options());
+  Tensor output = at::empty({0}, input.options());
   Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
   Tensor counts = at::empty({0}, self.options().dtype(kLong));
 
@@ -86,36 +301,57 @@ std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
   }
 
   if (numel > 0) {
-    scalar_t *output_data = output.data_ptr<scalar_t>();
-    int64_t *inverse_data = inverse_indices.data_ptr<int64_t>();;
-    int64_t *counts_data = nullptr;
-    *output_data = *input_data;
-
-    if (return_counts) {
-      counts.resize_({numel});
-      counts_data = counts.data_ptr<int64_t>();
-    }
-    scalar_t *p = output_data;
-    int64_t *q = counts_data;
-    int64_t last = 0;
-    for (int64_t i = 0; i < numel; i++) {
-      if (input_data[i] != *p) {
-        *(++p) = input_data[i];
-        if (return_counts) {
-          *(q++) = i - last;
-          last = i;
+    auto is_first = [input_data](int64_t i) {
+      return i == 0 || input_data[i] != input_data[i - 1];
+    };
+    // number of the first run starting in every chunk of the input
+    const int64_t num_chunks = divup(numel, kUniqueChunkSize);
+    std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        const int64_t chunk_end = std::min(numel, (c + 1) * kUniqueChunkSize);
+        int64_t num_first = 0;
+        for (int64_t i = c * kUniqueChunkSize; i < chunk_end; i++) {
+          num_first += is_first(i);
         }
+        chunk_offsets[c + 1] = num_first;
       }
-      if (return_inverse) {
-        inverse_data[i] = p - output_data;
+    });
+    std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+    const int64_t output_size = chunk_offsets[num_chunks];
+
+    output.resize_({output_size});
+    scalar_t* output_data = output.data_ptr<scalar_t>();
+    int64_t* inverse_data = inverse_indices.data_ptr<int64_t>();
+    // the index of the first element of every run, to compute the counts
+    std::vector<int64_t> run_begins(return_counts ? output_size + 1 : 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        const int64_t chunk_end = std::min(numel, (c + 1) * kUniqueChunkSize);
+        int64_t run = chunk_offsets[c] - 1;
+        for (int64_t i = c * kUniqueChunkSize; i < chunk_end; i++) {
+          if (is_first(i)) {
+            output_data[++run] = input_data[i];
+            if (return_counts) {
+              run_begins[run] = i;
+            }
+          }
+          if (return_inverse) {
+            inverse_data[i] = run;
+          }
+        }
       }
-    }
-    int64_t output_size = p - output_data + 1;
+    });
     if (return_counts) {
-      *q = numel - last;
+      run_begins[output_size] = numel;
       counts.resize_({output_size});
+      int64_t* counts_data = counts.data_ptr<int64_t>();
+      at::parallel_for(0, output_size, kUniqueChunkSize, [&](int64_t begin, int64_t end) {
+        for (int64_t k = begin; k < end; k++) {
+          counts_data[k] = run_begins[k + 1] - run_begins[k];
+        }
+      });
     }
-    output.resize_({output_size});
   }
 
   return std::make_tuple(output, inverse_indices, counts);
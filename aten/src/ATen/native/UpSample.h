@@ -1,7 +1,10 @@
+#pragma once
+
 #include <math.h>
 
 #include <ATen/ATen.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/DispatchStub.h>
 
 
 /**
@@ -286,5 +289,17 @@ static inline scalar_t cubic_interp1d(
   return x0 * coeffs[0] + x1 * coeffs[1] + x2 * coeffs[2] + x3 * coeffs[3];
 }
 
+// Upsampling of a 4-D channels last input into a channels last output, which
+// is already resized.
+using upsample_nearest2d_fn = void(*)(
+    Tensor& output, const Tensor& input,
+    c10::optional<double> scales_h, c10::optional<double> scales_w);
+using upsample_bilinear2d_fn = void(*)(
+    Tensor& output, const Tensor& input, bool align_corners,
+    c10::optional<double> scales_h, c10::optional<double> scales_w);
+
+DECLARE_DISPATCH(upsample_nearest2d_fn, upsample_nearest2d_channels_last_kernel);
+DECLARE_DISPATCH(upsample_bilinear2d_fn, upsample_bilinear2d_channels_last_kernel);
+
 } // namespace native
 } // namespace at
@@ -7,6 +7,9 @@
 
 namespace at {
 namespace native {
+
+DEFINE_DISPATCH(upsample_bilinear2d_channels_last_kernel);
+
 namespace {
 
 template <typename scalar_t>
@@ -188,6 +191,14 @@ static void upsample_bilinear2d_out_cpu_template(
       output_height,
       output_width);
 
+  if (input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+      (input_.scalar_type() == at::kFloat || input_.scalar_type() == at::kDouble)) {
+    auto input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+    output.resize_({nbatch, channels, output_height, output_width}, at::MemoryFormat::ChannelsLast);
+    upsample_bilinear2d_channels_last_kernel(kCPU, output, input, align_corners, scales_h, scales_w);
+    return;
+  }
+
   auto input = input_.contiguous();
 
   output.resize_({nbatch, channels, output_height, output_width});
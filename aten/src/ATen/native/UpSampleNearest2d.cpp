@@ -4,6 +4,9 @@
 
 namespace at {
 namespace native {
+
+DEFINE_DISPATCH(upsample_nearest2d_channels_last_kernel);
+
 namespace {
 
 template <typename scalar_t>
@@ -149,6 +152,14 @@ static void upsample_nearest2d_out_cpu_template(
       output_height,
       output_width);
 
+  if (input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+      (input_.scalar_type() == at::kFloat || input_.scalar_type() == at::kDouble)) {
+    auto input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+    output.resize_({nbatch, channels, output_height, output_width}, at::MemoryFormat::ChannelsLast);
+    upsample_nearest2d_channels_last_kernel(kCPU, output, input, scales_h, scales_w);
+    return;
+  }
+
   auto input = input_.contiguous();
 
   output.resize_({nbatch, channels, output_height, output_width});
@@ -0,0 +1,247 @@
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/ConvUtils.h>
+
+namespace at {
+namespace native {
+
+// Winograd convolution F(m x m, 3 x 3) for 3x3 kernels and stride 1, see
+// "Fast Algorithms for Convolutional Neural Networks" (Lavin and Gray, 2015).
+//
+// The output is split in m x m tiles. Each tile is computed from an
+// alpha x alpha (alpha = m + 2) patch d of the input as
+//   Y = A^T [U . V] A,  with U = G g G^T and V = B^T d B
+// where g is the 3x3 kernel and . is the elementwise product. Summing over
+// the input channels, each of the alpha x alpha elementwise products becomes
+// a matrix product of the transformed weights (output channels x input
+// channels) and the transformed input (input channels x tiles). Those are
+// done with a single bmm, and no im2col buffer is needed.
+
+namespace {
+
+struct WinogradTransform {
+  int64_t m;
+  int64_t alpha;
+  const double* BT;  // alpha x alpha
+  const double* G;   // alpha x 3
+  const double* AT;  // m x alpha
+};
+
+constexpr double F2x3_BT[] = {
+  1,  0, -1,  0,
+  0,  1,  1,  0,
+  0, -1,  1,  0,
+  0,  1,  0, -1,
+};
+constexpr double F2x3_G[] = {
+  1,    0,    0,
+  0.5,  0.5,  0.5,
+  0.5, -0.5,  0.5,
+  0,    0,    1,
+};
+constexpr double F2x3_AT[] = {
+  1, 1,  1,  0,
+  0, 1, -1, -1,
+};
+
+constexpr double F4x3_BT[] = {
+  4,  0, -5,  0, 1, 0,
+  0, -4, -4,  1, 1, 0,
+  0,  4, -4, -1, 1, 0,
+  0, -2, -1,  2, 1, 0,
+  0,  2, -1, -2, 1, 0,
+  0,  4,  0, -5, 0, 1,
+};
+constexpr double F4x3_G[] = {
+  1.0 / 4,         0,         0,
+  -1.0 / 6,  -1.0 / 6, -1.0 / 6,
+  -1.0 / 6,   1.0 / 6, -1.0 / 6,
+  1.0 / 24,  1.0 / 12,  1.0 / 6,
+  1.0 / 24, -1.0 / 12,  1.0 / 6,
+  0,                0,         1,
+};
+constexpr double F4x3_AT[] = {
+  1, 1,  1, 1,  1, 0,
+  0, 1, -1, 2, -2, 0,
+  0, 1,  1, 4,  4, 0,
+  0, 1, -1, 8, -8, 1,
+};
+
+WinogradTransform winograd_transform(int64_t output_tile_size) {
+  if (output_tile_size == 2) {
+    return {2, 4, F2x3_BT, F2x3_G, F2x3_AT};
+  }
+  TORCH_CHECK(output_tile_size == 4,
+      "_winograd_convolution: output_tile_size must be 2 or 4, but got ", output_tile_size);
+  return {4, 6, F4x3_BT, F4x3_G, F4x3_AT};
+}
+
+// out (rows x cols) = lhs (rows x inner) * rhs (inner x cols), where rhs is
+// stored transposed (cols x inner) if rhs_transposed is set.
+template <typename scalar_t, typename lhs_t, typename rhs_t>
+inline void small_matmul(scalar_t* out, const lhs_t* lhs, const rhs_t* rhs, bool rhs_transposed,
+                         int64_t rows, int64_t inner, int64_t cols) {
+  for (int64_t i = 0; i < rows; i++) {
+    for (int64_t j = 0; j < cols; j++) {
+      scalar_t sum = 0;
+      for (int64_t k = 0; k < inner; k++) {
+        auto l = lhs[i * inner + k];
+        auto r = rhs_transposed ? rhs[j * inner + k] : rhs[k * cols + j];
+        sum += static_cast<scalar_t>(l) * static_cast<scalar_t>(r);
+      }
+      out[i * cols + j] = sum;
+    }
+  }
+}
+
+template <typename scalar_t>
+void winograd_convolution_kernel(
+    Tensor& output, const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntArrayRef padding, const WinogradTransform& t) {
+  const int64_t batch_size = input.size(0);
+  const int64_t input_channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_channels = weight.size(0);
+  const int64_t output_height = output.size(2);
+  const int64_t output_width = output.size(3);
+  const int64_t m = t.m;
+  const int64_t alpha = t.alpha;
+  const int64_t tiles_h = (output_height + m - 1) / m;
+  const int64_t tiles_w = (output_width + m - 1) / m;
+  const int64_t num_tiles = batch_size * tiles_h * tiles_w;
+
+  // U: alpha^2 x output channels x input channels
+  auto U = at::empty({alpha * alpha, output_channels, input_channels}, input.options());
+  {
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    scalar_t* U_data = U.data_ptr<scalar_t>();
+    const int64_t kernels = output_channels * input_channels;
+    at::parallel_for(0, kernels, 0, [&](int64_t begin, int64_t end) {
+      std::vector<scalar_t> tmp(alpha * 3), u(alpha * alpha);
+      for (int64_t kc = begin; kc < end; kc++) {
+        const scalar_t* g = weight_data + kc * 9;
+        small_matmul(tmp.data(), t.G, g, false, alpha, 3, 3);
+        small_matmul(u.data(), tmp.data(), t.G, true, alpha, 3, alpha);
+        for (int64_t xi = 0; xi < alpha * alpha; xi++) {
+          U_data[xi * kernels + kc] = u[xi];
+        }
+      }
+    });
+  }
+
+  // V: alpha^2 x input channels x tiles
+  auto V = at::empty({alpha * alpha, input_channels, num_tiles}, input.options());
+  {
+    const scalar_t* input_data = input.data_ptr<scalar_t>();
+    scalar_t* V_data = V.data_ptr<scalar_t>();
+    const int64_t plane_stride = input_channels * num_tiles;
+    at::parallel_for(0, batch_size * input_channels, 0, [&](int64_t begin, int64_t end) {
+      std::vector<scalar_t> d(alpha * alpha), tmp(alpha * alpha), v(alpha * alpha);
+      for (int64_t nc = begin; nc < end; nc++) {
+        const int64_t n = nc / input_channels;
+        const int64_t c = nc % input_channels;
+        const scalar_t* plane = input_data + nc * input_height * input_width;
+        for (int64_t th = 0; th < tiles_h; th++) {
+          for (int64_t tw = 0; tw < tiles_w; tw++) {
+            // gather the patch, zero outside of the input
+            const int64_t y0 = th * m - padding[0];
+            const int64_t x0 = tw * m - padding[1];
+            for (int64_t i = 0; i < alpha; i++) {
+              const int64_t y = y0 + i;
+              for (int64_t j = 0; j < alpha; j++) {
+                const int64_t x = x0 + j;
+                d[i * alpha + j] = (y >= 0 && y < input_height && x >= 0 && x < input_width)
+                    ? plane[y * input_width + x] : scalar_t(0);
+              }
+            }
+            small_matmul(tmp.data(), t.BT, d.data(), false, alpha, alpha, alpha);
+            small_matmul(v.data(), tmp.data(), t.BT, true, alpha, alpha, alpha);
+            const int64_t tile = (n * tiles_h + th) * tiles_w + tw;
+            for (int64_t xi = 0; xi < alpha * alpha; xi++) {
+              V_data[xi * plane_stride + c * num_tiles + tile] = v[xi];
+            }
+          }
+        }
+      }
+    });
+  }
+
+  // M: alpha^2 x output channels x tiles
+  auto M = at::bmm(U, V);
+
+  const scalar_t* M_data = M.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  const int64_t plane_stride = output_channels * num_tiles;
+  at::parallel_for(0, batch_size * output_channels, 0, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> mt(alpha * alpha), tmp(m * alpha), y(m * m);
+    for (int64_t nk = begin; nk < end; nk++) {
+      const int64_t n = nk / output_channels;
+      const int64_t k = nk % output_channels;
+      scalar_t* plane = output_data + nk * output_height * output_width;
+      const scalar_t b = bias_data ? bias_data[k] : scalar_t(0);
+      for (int64_t th = 0; th < tiles_h; th++) {
+        for (int64_t tw = 0; tw < tiles_w; tw++) {
+          const int64_t tile = (n * tiles_h + th) * tiles_w + tw;
+          for (int64_t xi = 0; xi < alpha * alpha; xi++) {
+            mt[xi] = M_data[xi * plane_stride + k * num_tiles + tile];
+          }
+          small_matmul(tmp.data(), t.AT, mt.data(), false, m, alpha, alpha);
+          small_matmul(y.data(), tmp.data(), t.AT, true, m, alpha, m);
+          // the last tiles may stick out of the output
+          const int64_t rows = std::min(m, output_height - th * m);
+          const int64_t cols = std::min(m, output_width - tw * m);
+          for (int64_t i = 0; i < rows; i++) {
+            for (int64_t j = 0; j < cols; j++) {
+              plane[(th * m + i) * output_width + tw * m + j] = y[i * m + j] + b;
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+} // namespace
+
+Tensor _winograd_convolution_cpu(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef padding,
+    int64_t output_tile_size) {
+  TORCH_CHECK(input.dim() == 4, "_winograd_convolution: expected a 4-D input, but got ", input.dim(), "-D");
+  TORCH_CHECK(weight.dim() == 4 && weight.size(2) == 3 && weight.size(3) == 3,
+      "_winograd_convolution: expected a 3x3 kernel, but got weight of size ", weight.sizes());
+  TORCH_CHECK(input.size(1) == weight.size(1),
+      "_winograd_convolution: expected input to have ", weight.size(1), " channels, but got ", input.size(1));
+  TORCH_CHECK(!bias.defined() || (bias.dim() == 1 && bias.size(0) == weight.size(0)),
+      "_winograd_convolution: expected bias of size ", weight.size(0));
+  TORCH_CHECK(padding.size() == 2, "_winograd_convolution: expected 2 padding values");
+  const auto t = winograd_transform(output_tile_size);
+
+  auto output_size = conv_output_size(input.sizes(), weight.sizes(), padding, {1, 1});
+  TORCH_CHECK(output_size[2] > 0 && output_size[3] > 0,
+      "_winograd_convolution: input of size ", input.sizes(), " is too small for the kernel");
+  auto output = at::empty(output_size, input.options());
+  if (output.numel() == 0) {
+    return output;
+  }
+  if (input.size(1) == 0) {
+    return bias.defined() ? output.copy_(bias.view({1, -1, 1, 1}).expand_as(output)) : output.zero_();
+  }
+
+  auto input_ = input.contiguous();
+  auto weight_ = weight.contiguous();
+  auto bias_ = bias.defined() ? bias.contiguous() : bias;
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "_winograd_convolution", [&] {
+    winograd_convolution_kernel<scalar_t>(output, input_, weight_, bias_, padding, t);
+  });
+  return output;
+}
+
+} // namespace native
+} // namespace at
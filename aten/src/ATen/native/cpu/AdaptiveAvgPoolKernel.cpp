@@ -0,0 +1,72 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/AdaptivePooling.h>
+
+namespace at { namespace native {
+namespace {
+
+// Each window is averaged for Vec256<scalar_t>::size() contiguous channels at
+// once, and the work is split over the output rows of all the batch elements.
+template <typename scalar_t>
+void cpu_adaptive_avg_pool_channels_last(
+    Tensor& output,
+    const Tensor& input,
+    IntArrayRef output_size) {
+  using Vec = vec256::Vec256<scalar_t>;
+
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_height = output_size[0];
+  const int64_t output_width = output_size[1];
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(0, nbatch * output_height, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t n = i / output_height;
+      const int64_t oh = i % output_height;
+      const int64_t ih0 = start_index(oh, output_height, input_height);
+      const int64_t ih1 = end_index(oh, output_height, input_height);
+      const scalar_t* input_n = input_data + n * input_height * input_width * channels;
+
+      for (int64_t ow = 0; ow < output_width; ow++) {
+        const int64_t iw0 = start_index(ow, output_width, input_width);
+        const int64_t iw1 = end_index(ow, output_width, input_width);
+        const Vec kernel_size(static_cast<scalar_t>((ih1 - ih0) * (iw1 - iw0)));
+        scalar_t* out = output_data + (i * output_width + ow) * channels;
+
+        for (int64_t c = 0; c < channels; c += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+          Vec sum(0);
+          for (int64_t ih = ih0; ih < ih1; ih++) {
+            for (int64_t iw = iw0; iw < iw1; iw++) {
+              sum = sum + Vec::loadu(input_n + (ih * input_width + iw) * channels + c, count);
+            }
+          }
+          (sum / kernel_size).store(out + c, count);
+        }
+      }
+    }
+  });
+}
+
+void adaptive_avg_pool2d_channels_last_kernel_impl(
+    Tensor& output,
+    const Tensor& input,
+    IntArrayRef output_size) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "adaptive_avg_pool2d_channels_last", [&] {
+    cpu_adaptive_avg_pool_channels_last<scalar_t>(output, input, output_size);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(adaptive_avg_pool2d_channels_last_kernel, &adaptive_avg_pool2d_channels_last_kernel_impl);
+
+}} // namespace at::native
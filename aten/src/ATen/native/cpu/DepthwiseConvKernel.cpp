@@ -1,6 +1,8 @@
 #include <ATen/native/cpu/DepthwiseConvKernel.h>
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
 
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
@@ -297,9 +299,105 @@ Tensor _convolution_depthwise3x3_winograd(
   return output;
 }
 
+// Depthwise convolution of a channels last input, with one filter per channel.
+// The taps of a pixel are applied to Vec256<scalar_t>::size() contiguous
+// channels at once, and the work is split over the output rows of all the
+// batch elements.
+template <typename scalar_t>
+void convolution_depthwise_channels_last_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation) {
+  using Vec = vec256::Vec256<scalar_t>;
+
+  const int64_t batch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t in_rows = input.size(2);
+  const int64_t in_cols = input.size(3);
+  const int64_t kernel_rows = weight.size(2);
+  const int64_t kernel_cols = weight.size(3);
+  const int64_t out_rows = output.size(2);
+  const int64_t out_cols = output.size(3);
+
+  // kernel_rows x kernel_cols x channels, so that the taps are contiguous too
+  const Tensor weight_hwc = weight.permute({2, 3, 0, 1}).contiguous();
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* weight_data = weight_hwc.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(0, batch * out_rows, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t n = i / out_rows;
+      const int64_t oh = i % out_rows;
+      const scalar_t* input_n = input_data + n * in_rows * in_cols * channels;
+
+      for (int64_t ow = 0; ow < out_cols; ow++) {
+        scalar_t* out = output_data + (i * out_cols + ow) * channels;
+        for (int64_t c = 0; c < channels; c += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+          Vec sum = bias_data ? Vec::loadu(bias_data + c, count) : Vec(0);
+          for (int64_t kh = 0; kh < kernel_rows; kh++) {
+            const int64_t ih = oh * stride[0] - padding[0] + kh * dilation[0];
+            if (ih < 0 || ih >= in_rows) {
+              continue;
+            }
+            for (int64_t kw = 0; kw < kernel_cols; kw++) {
+              const int64_t iw = ow * stride[1] - padding[1] + kw * dilation[1];
+              if (iw < 0 || iw >= in_cols) {
+                continue;
+              }
+              sum = vec256::fmadd(
+                  Vec::loadu(input_n + (ih * in_cols + iw) * channels + c, count),
+                  Vec::loadu(weight_data + (kh * kernel_cols + kw) * channels + c, count),
+                  sum);
+            }
+          }
+          sum.store(out + c, count);
+        }
+      }
+    }
+  });
+}
+
+Tensor _convolution_depthwise_channels_last(
+    const Tensor & input,
+    const Tensor & weight,
+    const Tensor & bias,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation)
+{
+  const auto calc_output_dimension = [](
+    const int64_t input, const int64_t kernel, const int64_t stride, const int64_t padding, const int64_t dilation) {
+    return 1 + (input + 2 * padding - dilation * (kernel - 1) - 1) / stride;
+  };
+
+  Tensor output = at::empty(
+    {input.size(0),
+     weight.size(0),
+     calc_output_dimension(input.size(2), weight.size(2), stride[0], padding[0], dilation[0]),
+     calc_output_dimension(input.size(3), weight.size(3), stride[1], padding[1], dilation[1])},
+    input.options(),
+    at::MemoryFormat::ChannelsLast);
+
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "convolution_depthwise_channels_last", [&] {
+    convolution_depthwise_channels_last_kernel<scalar_t>(
+        output, input, weight, bias, stride, padding, dilation);
+  });
+
+  return output;
+}
+
 }  // namespace
 
 REGISTER_DISPATCH(convolution_depthwise3x3_winograd_stub, &_convolution_depthwise3x3_winograd);
+REGISTER_DISPATCH(convolution_depthwise_channels_last_stub, &_convolution_depthwise_channels_last);
 
 }  // namespace native
 }  // namespace at
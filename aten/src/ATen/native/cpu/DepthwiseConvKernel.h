@@ -4,7 +4,8 @@
 #include <ATen/native/DispatchStub.h>
 
 /*
-  Depthwise 3x3 Winograd convolution operator
+  Depthwise 3x3 Winograd convolution operator, and depthwise convolution of
+  channels last tensors.
 */
 
 namespace at {
@@ -15,5 +16,11 @@ using convolution_depthwise3x3_winograd_fn =
 
 DECLARE_DISPATCH(convolution_depthwise3x3_winograd_fn, convolution_depthwise3x3_winograd_stub);
 
+// input, weight, bias, stride, padding, dilation
+using convolution_depthwise_channels_last_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef);
+
+DECLARE_DISPATCH(convolution_depthwise_channels_last_fn, convolution_depthwise_channels_last_stub);
+
 }  // namespace native
 }  // namespace at
@@ -203,40 +203,33 @@ struct Dist {
     int64_t m = t1.size(-1);
 
     scalar_t * const res_start = result.data_ptr<scalar_t>();
-    int64_t combs = r1 * r2;
     int64_t size1 = r1 * m;
     int64_t size2 = r2 * m;
 
-    parallel_for(0, combs * d, internal::GRAIN_SIZE / (16 * m), [=](int64_t start, int64_t end) {
-      scalar_t * res = res_start + start;
-      const scalar_t * const res_end = res_start + end;
-      int64_t l = start / combs;
-      int64_t k = start % combs;
-      int64_t i = k / r2;
-      int64_t j = k % r2;
-      i = i * m;
-      j = j * m;
-
-      while (res != res_end) {
-        const scalar_t * self_i = t1_start + size1 * l + i;
-        const scalar_t * self_j = t2_start + size2 * l + j;
-
-        scalar_t agg = 0;
-        for (int x = 0; x < m; x++) {
-          scalar_t a = *(self_i + x);
-          scalar_t b = *(self_j + x);
-          agg = F::red(agg, F::map(std::abs(a-b), p));
-        }
-        *res = F::finish(agg, p);
-
-        res += 1;
-        j += m;
-        if (j == size2) {
-          j = 0;
-          i += m;
-          if (i == size1) {
-            i = 0;
-            l += 1;
+    // Every thread takes a chunk of rows of t1 and compares them against the
+    // rows of t2 one tile at a time. A tile is about 32K elements, so it stays
+    // in L2 while the whole chunk is compared against it, instead of
+    // streaming all of t2 from memory for each row of t1.
+    const int64_t r2_tile = std::max<int64_t>(1, 32768 / m);
+    const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (16 * m * r2));
+
+    parallel_for(0, d * r1, grain_size, [=](int64_t start, int64_t end) {
+      for (int64_t j_start = 0; j_start < r2; j_start += r2_tile) {
+        const int64_t j_end = std::min(r2, j_start + r2_tile);
+        for (int64_t row = start; row < end; row++) {
+          const int64_t l = row / r1;
+          const scalar_t * const self_i = t1_start + size1 * l + (row % r1) * m;
+          const scalar_t * self_j = t2_start + size2 * l + j_start * m;
+          scalar_t * res = res_start + row * r2 + j_start;
+
+          for (int64_t j = j_start; j < j_end; j++, self_j += m, res++) {
+            scalar_t agg = 0;
+            for (int x = 0; x < m; x++) {
+              scalar_t a = *(self_i + x);
+              scalar_t b = *(self_j + x);
+              agg = F::red(agg, F::map(std::abs(a-b), p));
+            }
+            *res = F::finish(agg, p);
           }
         }
       }
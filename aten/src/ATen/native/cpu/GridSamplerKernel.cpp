@@ -161,6 +161,12 @@ namespace at { namespace native { namespace {
  *  Now you should be able tp understand everything about the implementation of
  *  2D forward kernel shown at the beginning of this note.
  *
+ *  The 3D kernels follow the same pattern with an additional z vector, using
+ *  `ApplyGridSample<scalar_t, 3, interp, padding>` and
+ *  `grid_sample_3d_grid_slice_iterator`. The latter also takes a range of
+ *  output depths, so that the 3D forward can be parallelized over both the
+ *  batch and the output depth.
+ *
  **/
 
 
@@ -763,6 +769,419 @@ struct ApplyGridSample<scalar_t, 2, GridSamplerInterpolation::Nearest,
   }
 };
 
+template<typename scalar_t, GridSamplerPadding padding, bool align_corners>
+struct ApplyGridSample<scalar_t, 3, GridSamplerInterpolation::Bilinear,
+                       padding, align_corners> {
+  using Vec = Vec256<scalar_t>;
+  using integer_t = int_same_size_t<scalar_t>;
+  using iVec = Vec256<integer_t>;
+
+  const int64_t inp_D;
+  const int64_t inp_H;
+  const int64_t inp_W;
+  const int64_t inp_sD;
+  const int64_t inp_sH;
+  const int64_t inp_sW;
+  const int64_t C;
+  const int64_t inp_sC;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_D;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_H;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_W;
+  const bool must_in_bound = padding != GridSamplerPadding::Zeros;
+
+  ApplyGridSample(const TensorAccessor<scalar_t, 5>& input)
+    : inp_D(input.size(2))
+    , inp_H(input.size(3))
+    , inp_W(input.size(4))
+    , inp_sD(input.stride(2))
+    , inp_sH(input.stride(3))
+    , inp_sW(input.stride(4))
+    , C(input.size(1))
+    , inp_sC(input.stride(1))
+    , compute_D(input.size(2))
+    , compute_H(input.size(3))
+    , compute_W(input.size(4)) {}
+
+  inline std::tuple<
+    Vec, Vec, Vec, Vec, Vec, Vec,           // distances to 6 sides
+    Vec, Vec, Vec, Vec, Vec, Vec, Vec, Vec, // interpolation weights wrt 8 corners
+    Vec, Vec, Vec, Vec, Vec, Vec, Vec, Vec, // in_bound masks
+    iVec, iVec, iVec                        // z_t, y_n and x_w
+  >
+  compute_interp_params(const Vec& x, const Vec& y, const Vec& z) const {
+    // Same as the 2D case, with a top (t) and a bottom (b) layer of corners
+    // along the D dimension.
+    auto x_w = x.floor();
+    auto y_n = y.floor();
+    auto z_t = z.floor();
+
+    // get distances to each side
+    auto w = x - x_w;
+    auto e = Vec(1) - w;
+    auto n = y - y_n;
+    auto s = Vec(1) - n;
+    auto t = z - z_t;
+    auto b = Vec(1) - t;
+
+    // get interpolation weights for each neighbor
+    // e.g., for the tnw corner, the weight is
+    // `dist_to_east * dist_to_south * dist_to_bottom`.
+    auto tnw = e * s * b;
+    auto tne = w * s * b;
+    auto tsw = e * n * b;
+    auto tse = w * n * b;
+    auto bnw = e * s * t;
+    auto bne = w * s * t;
+    auto bsw = e * n * t;
+    auto bse = w * n * t;
+
+    auto i_x_w = convert_to_int_of_same_size(x_w);
+    auto i_y_n = convert_to_int_of_same_size(y_n);
+    auto i_z_t = convert_to_int_of_same_size(z_t);
+    auto i_x_e = i_x_w + iVec(1);
+    auto i_y_s = i_y_n + iVec(1);
+    auto i_z_b = i_z_t + iVec(1);
+
+    auto w_mask = must_in_bound ? iVec(-1)  // true = all ones
+                                : (i_x_w > iVec(-1)) & (i_x_w < iVec(inp_W));
+    auto n_mask = must_in_bound ? iVec(-1)  // true = all ones
+                                : (i_y_n > iVec(-1)) & (i_y_n < iVec(inp_H));
+    auto t_mask = must_in_bound ? iVec(-1)  // true = all ones
+                                : (i_z_t > iVec(-1)) & (i_z_t < iVec(inp_D));
+    auto e_mask = must_in_bound ? (i_x_e < iVec(inp_W))
+                                : (i_x_e > iVec(-1)) & (i_x_e < iVec(inp_W));
+    auto s_mask = must_in_bound ? (i_y_s < iVec(inp_H))
+                                : (i_y_s > iVec(-1)) & (i_y_s < iVec(inp_H));
+    auto b_mask = must_in_bound ? (i_z_b < iVec(inp_D))
+                                : (i_z_b > iVec(-1)) & (i_z_b < iVec(inp_D));
+    auto tnw_mask = cast<scalar_t>(must_in_bound ? iVec(-1) : (w_mask & n_mask & t_mask));
+    auto tne_mask = cast<scalar_t>(e_mask & n_mask & t_mask);
+    auto tsw_mask = cast<scalar_t>(w_mask & s_mask & t_mask);
+    auto tse_mask = cast<scalar_t>(e_mask & s_mask & t_mask);
+    auto bnw_mask = cast<scalar_t>(w_mask & n_mask & b_mask);
+    auto bne_mask = cast<scalar_t>(e_mask & n_mask & b_mask);
+    auto bsw_mask = cast<scalar_t>(w_mask & s_mask & b_mask);
+    auto bse_mask = cast<scalar_t>(e_mask & s_mask & b_mask);
+
+    return std::make_tuple(
+      n, s, w, e, t, b,
+      tnw, tne, tsw, tse, bnw, bne, bsw, bse,
+      tnw_mask, tne_mask, tsw_mask, tse_mask, bnw_mask, bne_mask, bsw_mask, bse_mask,
+      i_z_t, i_y_n, i_x_w);
+  }
+
+  inline void forward(TensorAccessor<scalar_t, 4>& out_slice,
+                      const TensorAccessor<scalar_t, 4>& inp_slice,
+                      int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                      const Vec& grid_z, int64_t len) const {
+    auto x = compute_W.apply(grid_x);
+    auto y = compute_H.apply(grid_y);
+    auto z = compute_D.apply(grid_z);
+
+    Vec n, s, w, e, t, b;
+    Vec tnw, tne, tsw, tse, bnw, bne, bsw, bse;
+    Vec tnw_mask, tne_mask, tsw_mask, tse_mask, bnw_mask, bne_mask, bsw_mask, bse_mask;
+    iVec i_z_t, i_y_n, i_x_w;
+
+    std::tie(
+      n, s, w, e, t, b,
+      tnw, tne, tsw, tse, bnw, bne, bsw, bse,
+      tnw_mask, tne_mask, tsw_mask, tse_mask, bnw_mask, bne_mask, bsw_mask, bse_mask,
+      i_z_t, i_y_n, i_x_w) = compute_interp_params(x, y, z);
+
+    auto i_tnw_offset = i_z_t * iVec(inp_sD) + i_y_n * iVec(inp_sH) + i_x_w * iVec(inp_sW);
+    auto i_tne_offset = i_tnw_offset + iVec(inp_sW);
+    auto i_tsw_offset = i_tnw_offset + iVec(inp_sH);
+    auto i_tse_offset = i_tsw_offset + iVec(inp_sW);
+    auto i_bnw_offset = i_tnw_offset + iVec(inp_sD);
+    auto i_bne_offset = i_bnw_offset + iVec(inp_sW);
+    auto i_bsw_offset = i_bnw_offset + iVec(inp_sH);
+    auto i_bse_offset = i_bsw_offset + iVec(inp_sW);
+
+    #ifndef _MSC_VER
+    # pragma unroll
+    #endif
+    for (int64_t c = 0; c < C; ++c) {
+      auto inp_slice_C_ptr = inp_slice[c].data();
+
+      // mask_gather zeros out the mask, so we need to make copies
+      Vec tnw_mask_copy = tnw_mask;
+      Vec tne_mask_copy = tne_mask;
+      Vec tsw_mask_copy = tsw_mask;
+      Vec tse_mask_copy = tse_mask;
+      Vec bnw_mask_copy = bnw_mask;
+      Vec bne_mask_copy = bne_mask;
+      Vec bsw_mask_copy = bsw_mask;
+      Vec bse_mask_copy = bse_mask;
+      auto tnw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tnw_offset, tnw_mask_copy);
+      auto tne_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tne_offset, tne_mask_copy);
+      auto tsw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tsw_offset, tsw_mask_copy);
+      auto tse_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tse_offset, tse_mask_copy);
+      auto bnw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bnw_offset, bnw_mask_copy);
+      auto bne_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bne_offset, bne_mask_copy);
+      auto bsw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bsw_offset, bsw_mask_copy);
+      auto bse_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bse_offset, bse_mask_copy);
+
+      auto interpolated = (tnw_val * tnw) + (tne_val * tne) + (tsw_val * tsw) + (tse_val * tse)
+                        + (bnw_val * bnw) + (bne_val * bne) + (bsw_val * bsw) + (bse_val * bse);
+      interpolated.store(out_slice[c].data() + offset, len);
+    }
+  }
+
+  inline void backward(TensorAccessor<scalar_t, 4>& gInp_slice,
+                       TensorAccessor<scalar_t, 4>& gGrid_slice,
+                       const TensorAccessor<scalar_t, 4>& gOut_slice,
+                       const TensorAccessor<scalar_t, 4>& inp_slice,
+                       int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                       const Vec& grid_z, int64_t len) const {
+    Vec x, y, z, gx_mult, gy_mult, gz_mult;
+    std::tie(x, gx_mult) = compute_W.apply_get_grad(grid_x);
+    std::tie(y, gy_mult) = compute_H.apply_get_grad(grid_y);
+    std::tie(z, gz_mult) = compute_D.apply_get_grad(grid_z);
+
+    Vec n, s, w, e, t, b;
+    Vec tnw, tne, tsw, tse, bnw, bne, bsw, bse;
+    Vec tnw_mask, tne_mask, tsw_mask, tse_mask, bnw_mask, bne_mask, bsw_mask, bse_mask;
+    iVec i_z_t, i_y_n, i_x_w;
+
+    std::tie(
+      n, s, w, e, t, b,
+      tnw, tne, tsw, tse, bnw, bne, bsw, bse,
+      tnw_mask, tne_mask, tsw_mask, tse_mask, bnw_mask, bne_mask, bsw_mask, bse_mask,
+      i_z_t, i_y_n, i_x_w) = compute_interp_params(x, y, z);
+
+    auto i_tnw_offset = i_z_t * iVec(inp_sD) + i_y_n * iVec(inp_sH) + i_x_w * iVec(inp_sW);
+    auto i_tne_offset = i_tnw_offset + iVec(inp_sW);
+    auto i_tsw_offset = i_tnw_offset + iVec(inp_sH);
+    auto i_tse_offset = i_tsw_offset + iVec(inp_sW);
+    auto i_bnw_offset = i_tnw_offset + iVec(inp_sD);
+    auto i_bne_offset = i_bnw_offset + iVec(inp_sW);
+    auto i_bsw_offset = i_bnw_offset + iVec(inp_sH);
+    auto i_bse_offset = i_bsw_offset + iVec(inp_sW);
+
+    // gInp is contiguous
+    auto i_gInp_tnw_offset = (i_z_t * iVec(inp_H) + i_y_n) * iVec(inp_W) + i_x_w;
+    auto i_gInp_tne_offset = i_gInp_tnw_offset + iVec(1);
+    auto i_gInp_tsw_offset = i_gInp_tnw_offset + iVec(inp_W);
+    auto i_gInp_tse_offset = i_gInp_tsw_offset + iVec(1);
+    auto i_gInp_bnw_offset = i_gInp_tnw_offset + iVec(inp_H * inp_W);
+    auto i_gInp_bne_offset = i_gInp_bnw_offset + iVec(1);
+    auto i_gInp_bsw_offset = i_gInp_bnw_offset + iVec(inp_W);
+    auto i_gInp_bse_offset = i_gInp_bsw_offset + iVec(1);
+
+    // See the 2D backward on why we go through temporary arrays here.
+
+    integer_t i_gInp_tnw_offset_arr[iVec::size()];
+    integer_t i_gInp_tne_offset_arr[iVec::size()];
+    integer_t i_gInp_tsw_offset_arr[iVec::size()];
+    integer_t i_gInp_tse_offset_arr[iVec::size()];
+    integer_t i_gInp_bnw_offset_arr[iVec::size()];
+    integer_t i_gInp_bne_offset_arr[iVec::size()];
+    integer_t i_gInp_bsw_offset_arr[iVec::size()];
+    integer_t i_gInp_bse_offset_arr[iVec::size()];
+    i_gInp_tnw_offset.store(i_gInp_tnw_offset_arr);
+    i_gInp_tne_offset.store(i_gInp_tne_offset_arr);
+    i_gInp_tsw_offset.store(i_gInp_tsw_offset_arr);
+    i_gInp_tse_offset.store(i_gInp_tse_offset_arr);
+    i_gInp_bnw_offset.store(i_gInp_bnw_offset_arr);
+    i_gInp_bne_offset.store(i_gInp_bne_offset_arr);
+    i_gInp_bsw_offset.store(i_gInp_bsw_offset_arr);
+    i_gInp_bse_offset.store(i_gInp_bse_offset_arr);
+
+    integer_t i_tnw_mask_arr[iVec::size()];
+    integer_t i_tne_mask_arr[iVec::size()];
+    integer_t i_tsw_mask_arr[iVec::size()];
+    integer_t i_tse_mask_arr[iVec::size()];
+    integer_t i_bnw_mask_arr[iVec::size()];
+    integer_t i_bne_mask_arr[iVec::size()];
+    integer_t i_bsw_mask_arr[iVec::size()];
+    integer_t i_bse_mask_arr[iVec::size()];
+    tnw_mask.store(i_tnw_mask_arr);
+    tne_mask.store(i_tne_mask_arr);
+    tsw_mask.store(i_tsw_mask_arr);
+    tse_mask.store(i_tse_mask_arr);
+    bnw_mask.store(i_bnw_mask_arr);
+    bne_mask.store(i_bne_mask_arr);
+    bsw_mask.store(i_bsw_mask_arr);
+    bse_mask.store(i_bse_mask_arr);
+
+    scalar_t gInp_corner_arr[Vec::size()];
+
+    auto gx = Vec(0), gy = Vec(0), gz = Vec(0);
+    #ifndef _MSC_VER
+    # pragma unroll
+    #endif
+    for (int64_t c = 0; c < C; ++c) {
+      auto inp_slice_C_ptr = inp_slice[c].data();
+      auto gInp_slice_C_ptr = gInp_slice[c].data();
+      auto gOut = Vec::loadu(gOut_slice[c].data() + offset, len);
+
+      (tnw * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_tnw_offset_arr, i_tnw_mask_arr, len);
+      (tne * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_tne_offset_arr, i_tne_mask_arr, len);
+      (tsw * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_tsw_offset_arr, i_tsw_mask_arr, len);
+      (tse * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_tse_offset_arr, i_tse_mask_arr, len);
+      (bnw * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_bnw_offset_arr, i_bnw_mask_arr, len);
+      (bne * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_bne_offset_arr, i_bne_mask_arr, len);
+      (bsw * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_bsw_offset_arr, i_bsw_mask_arr, len);
+      (bse * gOut).store(gInp_corner_arr);
+      mask_scatter_add(gInp_corner_arr, gInp_slice_C_ptr, i_gInp_bse_offset_arr, i_bse_mask_arr, len);
+
+      // mask_gather zeros out the mask, so we need to make copies
+      Vec tnw_mask_copy = tnw_mask;
+      Vec tne_mask_copy = tne_mask;
+      Vec tsw_mask_copy = tsw_mask;
+      Vec tse_mask_copy = tse_mask;
+      Vec bnw_mask_copy = bnw_mask;
+      Vec bne_mask_copy = bne_mask;
+      Vec bsw_mask_copy = bsw_mask;
+      Vec bse_mask_copy = bse_mask;
+      auto tnw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tnw_offset, tnw_mask_copy);
+      auto tne_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tne_offset, tne_mask_copy);
+      auto tsw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tsw_offset, tsw_mask_copy);
+      auto tse_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_tse_offset, tse_mask_copy);
+      auto bnw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bnw_offset, bnw_mask_copy);
+      auto bne_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bne_offset, bne_mask_copy);
+      auto bsw_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bsw_offset, bsw_mask_copy);
+      auto bse_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_C_ptr, i_bse_offset, bse_mask_copy);
+
+      gx = gx + ((tne_val - tnw_val) * s * b + (tse_val - tsw_val) * n * b +
+                 (bne_val - bnw_val) * s * t + (bse_val - bsw_val) * n * t) * gOut;
+      gy = gy + ((tsw_val - tnw_val) * e * b + (tse_val - tne_val) * w * b +
+                 (bsw_val - bnw_val) * e * t + (bse_val - bne_val) * w * t) * gOut;
+      gz = gz + ((bnw_val - tnw_val) * e * s + (bne_val - tne_val) * w * s +
+                 (bsw_val - tsw_val) * e * n + (bse_val - tse_val) * w * n) * gOut;
+    }
+
+    gx = gx * gx_mult;
+    gy = gy * gy_mult;
+    gz = gz * gz_mult;
+
+    // There is no interleave3, so write the three coordinates one by one.
+    scalar_t gx_arr[Vec::size()];
+    scalar_t gy_arr[Vec::size()];
+    scalar_t gz_arr[Vec::size()];
+    gx.store(gx_arr);
+    gy.store(gy_arr);
+    gz.store(gz_arr);
+    auto gGrid_ptr = gGrid_slice.data() + offset * 3;
+    for (int64_t i = 0; i < len; i++, gGrid_ptr += 3) {
+      gGrid_ptr[0] = gx_arr[i];
+      gGrid_ptr[1] = gy_arr[i];
+      gGrid_ptr[2] = gz_arr[i];
+    }
+  }
+};
+
+template<typename scalar_t, GridSamplerPadding padding, bool align_corners>
+struct ApplyGridSample<scalar_t, 3, GridSamplerInterpolation::Nearest,
+                       padding, align_corners> {
+  using Vec = Vec256<scalar_t>;
+  using integer_t = int_same_size_t<scalar_t>;
+  using iVec = Vec256<integer_t>;
+
+  const int64_t inp_D;
+  const int64_t inp_H;
+  const int64_t inp_W;
+  const int64_t inp_sD;
+  const int64_t inp_sH;
+  const int64_t inp_sW;
+  const int64_t C;
+  const int64_t inp_sC;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_D;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_H;
+  const ComputeLocation<scalar_t, padding, align_corners> compute_W;
+  const bool must_in_bound = padding != GridSamplerPadding::Zeros;
+
+  ApplyGridSample(const TensorAccessor<scalar_t, 5>& input)
+    : inp_D(input.size(2))
+    , inp_H(input.size(3))
+    , inp_W(input.size(4))
+    , inp_sD(input.stride(2))
+    , inp_sH(input.stride(3))
+    , inp_sW(input.stride(4))
+    , C(input.size(1))
+    , inp_sC(input.stride(1))
+    , compute_D(input.size(2))
+    , compute_H(input.size(3))
+    , compute_W(input.size(4)) {}
+
+  inline std::tuple<iVec, iVec, iVec, iVec>  // in_bound mask, z, y and x
+  compute_nearest(const Vec& x, const Vec& y, const Vec& z) const {
+    auto i_x_nearest = convert_to_int_of_same_size(x.round());
+    auto i_y_nearest = convert_to_int_of_same_size(y.round());
+    auto i_z_nearest = convert_to_int_of_same_size(z.round());
+
+    auto i_mask = must_in_bound ? iVec(-1)
+                                : (i_x_nearest > iVec(-1)) & (i_x_nearest < iVec(inp_W)) &
+                                  (i_y_nearest > iVec(-1)) & (i_y_nearest < iVec(inp_H)) &
+                                  (i_z_nearest > iVec(-1)) & (i_z_nearest < iVec(inp_D));
+    return std::make_tuple(i_mask, i_z_nearest, i_y_nearest, i_x_nearest);
+  }
+
+  inline void forward(TensorAccessor<scalar_t, 4>& out_slice,
+                      const TensorAccessor<scalar_t, 4>& inp_slice,
+                      int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                      const Vec& grid_z, int64_t len) const {
+    iVec i_mask, i_z_nearest, i_y_nearest, i_x_nearest;
+    std::tie(i_mask, i_z_nearest, i_y_nearest, i_x_nearest) =
+      compute_nearest(compute_W.apply(grid_x), compute_H.apply(grid_y), compute_D.apply(grid_z));
+    auto mask = cast<scalar_t>(i_mask);
+
+    auto i_offset = i_z_nearest * iVec(inp_sD) + i_y_nearest * iVec(inp_sH) + i_x_nearest * iVec(inp_sW);
+
+    auto out_ptr = out_slice.data() + offset;
+    auto out_sC = out_slice.stride(0);
+    auto inp_slice_ptr = inp_slice.data();
+    #ifndef _MSC_VER
+    # pragma unroll
+    #endif
+    for (int64_t c = 0; c < C; ++c, out_ptr += out_sC, inp_slice_ptr += inp_sC) {
+      // mask_gather zeros out the mask, so we need to make a copy
+      auto mask_copy = mask;
+      auto inp_val = mask_gather<sizeof(scalar_t)>(Vec(0), inp_slice_ptr, i_offset, mask_copy);
+      inp_val.store(static_cast<void*>(out_ptr), len);
+    }
+  }
+
+  inline void backward(TensorAccessor<scalar_t, 4>& gInp_slice,
+                       TensorAccessor<scalar_t, 4>& gGrid_slice,
+                       const TensorAccessor<scalar_t, 4>& gOut_slice,
+                       const TensorAccessor<scalar_t, 4>& inp_slice,
+                       int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                       const Vec& grid_z, int64_t len) const {
+    iVec i_mask, i_z_nearest, i_y_nearest, i_x_nearest;
+    std::tie(i_mask, i_z_nearest, i_y_nearest, i_x_nearest) =
+      compute_nearest(compute_W.apply(grid_x), compute_H.apply(grid_y), compute_D.apply(grid_z));
+
+    // gInp is contiguous
+    auto i_gInp_offset = (i_z_nearest * iVec(inp_H) + i_y_nearest) * iVec(inp_W) + i_x_nearest;
+
+    integer_t mask_arr[iVec::size()];
+    i_mask.store(mask_arr);
+    integer_t gInp_offset_arr[iVec::size()];
+    i_gInp_offset.store(gInp_offset_arr);
+
+    #ifndef _MSC_VER
+    # pragma unroll
+    #endif
+    for (int64_t c = 0; c < C; ++c) {
+      mask_scatter_add(gOut_slice[c].data() + offset, gInp_slice[c].data(),
+                       gInp_offset_arr, mask_arr, len);
+    }
+
+    // grid has zero 0 gradient in Nearest mode
+    auto gGrid_ptr = gGrid_slice.data() + offset * 3;
+    std::memset(gGrid_ptr, 0, sizeof(scalar_t) * len * 3);
+  }
+};
+
 // ~~~~~~~~~~~~~~~~~~ grid_sample_2d_grid_slice_iterator ~~~~~~~~~~~~~~~~~~~~~~
 // Function to apply a vectorized function on a grid slice tensor (without batch
 // dimension).
@@ -884,6 +1303,91 @@ static inline void grid_sample_2d_grid_slice_iterator(
   }
 }
 
+// ~~~~~~~~~~~~~~~~~~ grid_sample_3d_grid_slice_iterator ~~~~~~~~~~~~~~~~~~~~~~
+// Same as grid_sample_2d_grid_slice_iterator, but for the output depths in
+// [d_begin, d_end) of a 3D grid slice, so that the work on a single sample can
+// be split over its depth. `spatial_offset` is still relative to the start of
+// the whole slice.
+// There is no deinterleave3, so the x, y and z values are loaded with a strided
+// gather unless the W dimension is contiguous. In exchange, all the dimensions
+// that have a constant stride between them are walked as a single line.
+
+template<typename scalar_t, typename ApplyFn>
+static inline void grid_sample_3d_grid_slice_iterator(
+    const TensorAccessor<scalar_t, 4>& grid_slice, int64_t d_begin, int64_t d_end,
+    const ApplyFn &apply_fn) {
+  int64_t out_H = grid_slice.size(1);
+  int64_t out_W = grid_slice.size(2);
+  int64_t grid_sD = grid_slice.stride(0);
+  int64_t grid_sH = grid_slice.stride(1);
+  int64_t grid_sW = grid_slice.stride(2);
+  int64_t grid_sCoor = grid_slice.stride(3);
+  auto grid_ptr = grid_slice.data();
+
+  using Vec = Vec256<scalar_t>;
+  using iVec = Vec256<int_same_size_t<scalar_t>>;
+  constexpr int64_t step = Vec::size();
+
+  const int64_t out_HW = out_H * out_W;
+  if (d_begin >= d_end || out_HW == 0) {
+    return;
+  }
+
+  // Function to apply along `total_size` grid locations that are `stride`
+  // apart in memory.
+  auto line_fn = [&](const scalar_t *grid_ptr_line, int64_t stride,
+                     int64_t out_base_offset, int64_t total_size) {
+    // the gather offsets are relative to a base pointer that moves along, so
+    // that they stay small
+    auto i_offsets = iVec::arange(0, stride);
+    for (int64_t i = 0; i < total_size; i += step) {
+      auto len = std::min(step, total_size - i);
+      auto grid_ptr_x = grid_ptr_line + i * stride;
+      auto grid_ptr_y = grid_ptr_x + grid_sCoor;
+      auto grid_ptr_z = grid_ptr_y + grid_sCoor;
+      Vec x, y, z;
+      if (stride == 1) {
+        // loadu fills the lanes past `len` with zeros, which are valid grid
+        // sample locations
+        x = Vec::loadu(grid_ptr_x, len);
+        y = Vec::loadu(grid_ptr_y, len);
+        z = Vec::loadu(grid_ptr_z, len);
+      } else {
+        if (len < step) {
+          // prevents illegal memory access, sets the exceeding offsets to zero
+          i_offsets = iVec::set(iVec(0), i_offsets, len);
+        }
+        x = vec256::gather<sizeof(scalar_t)>(grid_ptr_x, i_offsets);
+        y = vec256::gather<sizeof(scalar_t)>(grid_ptr_y, i_offsets);
+        z = vec256::gather<sizeof(scalar_t)>(grid_ptr_z, i_offsets);
+      }
+      apply_fn(x, y, z, out_base_offset + i, len);
+    }
+  };
+
+  if (out_W == 1 || grid_sH == out_W * grid_sW) {
+    // [H, W] is a single line.
+    auto grid_sHW = out_W == 1 ? grid_sH : grid_sW;
+    if (d_end - d_begin == 1 || out_HW == 1 || grid_sD == out_HW * grid_sHW) {
+      // [d_begin:d_end, H, W] is a single line too.
+      line_fn(grid_ptr + d_begin * grid_sD, out_HW == 1 ? grid_sD : grid_sHW,
+              d_begin * out_HW, (d_end - d_begin) * out_HW);
+    } else {
+      for (int64_t d = d_begin; d < d_end; d++) {
+        line_fn(grid_ptr + d * grid_sD, grid_sHW, d * out_HW, out_HW);
+      }
+    }
+  } else {
+    // General case: one line for each (d, h).
+    for (int64_t d = d_begin; d < d_end; d++) {
+      for (int64_t h = 0; h < out_H; h++) {
+        line_fn(grid_ptr + d * grid_sD + h * grid_sH, grid_sW,
+                (d * out_H + h) * out_W, out_W);
+      }
+    }
+  }
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Grid Sample Kernels ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Use the structs & functions defined above to calculate grid sample forward
 // and backward.
@@ -1026,10 +1530,160 @@ grid_sampler_2d_backward_cpu_kernel_impl(const Tensor& grad_output_,
   return std::make_tuple(grad_input, grad_grid);
 }
 
+Tensor grid_sampler_3d_cpu_kernel_impl(const Tensor& input, const Tensor& grid,
+                                       int64_t interpolation_mode,
+                                       int64_t padding_mode, bool align_corners) {
+  auto N = input.size(0);
+  auto D = grid.size(1);
+  auto H = grid.size(2);
+  auto W = grid.size(3);
+  auto output = at::empty({N, input.size(1), D, H, W}, input.options());
+  // The output is written in disjoint D slices, so the work is split over the
+  // output depths of all the samples.
+  auto spatial_size = H * W;
+  auto grain_size = spatial_size == 0 ? (N * D + 1)
+                                      : at::divup(at::internal::GRAIN_SIZE, spatial_size * 6 /* 3d * 2 tensors*/);
+
+#define HANDLE_CASE(interp, padding, align_corners)                            \
+  case padding: {                                                              \
+    ApplyGridSample<scalar_t, 3, interp, padding, align_corners>               \
+    grid_sample(inp_acc);                                                      \
+    parallel_for(0, N * D, grain_size, [&](int64_t begin, int64_t end) {       \
+      for (int64_t i = begin; i < end; ) {                                     \
+        auto n = i / D;                                                        \
+        auto d_begin = i % D;                                                  \
+        auto d_end = std::min(D, d_begin + end - i);                           \
+        auto out_slice = out_acc[n];                                           \
+        auto inp_slice = inp_acc[n];                                           \
+        grid_sample_3d_grid_slice_iterator(                                    \
+          grid_acc[n], d_begin, d_end,                                         \
+          [&](const Vec256<scalar_t>& grid_x, const Vec256<scalar_t>& grid_y,  \
+              const Vec256<scalar_t>& grid_z,                                  \
+              int64_t spatial_offset, int64_t len) {                           \
+            grid_sample.forward(out_slice, inp_slice, spatial_offset,          \
+                                grid_x, grid_y, grid_z, len);                  \
+          });                                                                  \
+        i += d_end - d_begin;                                                  \
+      }                                                                        \
+    });                                                                        \
+    return;                                                                    \
+  }
+
+#define HANDLE_INTERP(interp, align_corners)                                   \
+  case interp: {                                                               \
+    switch (static_cast<GridSamplerPadding>(padding_mode)) {                   \
+      HANDLE_CASE(interp, GridSamplerPadding::Zeros, align_corners);           \
+      HANDLE_CASE(interp, GridSamplerPadding::Border, align_corners);          \
+      HANDLE_CASE(interp, GridSamplerPadding::Reflection, align_corners);      \
+    }                                                                          \
+    return;                                                                    \
+  }
+
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "grid_sampler_3d_cpu_kernel_impl", [&] {
+    auto out_acc = output.accessor<scalar_t, 5>();
+    auto inp_acc = input.accessor<scalar_t, 5>();
+    auto grid_acc = grid.accessor<scalar_t, 5>();
+    if (align_corners) {
+      switch (static_cast<GridSamplerInterpolation>(interpolation_mode)) {
+        HANDLE_INTERP(GridSamplerInterpolation::Bilinear, true);
+        HANDLE_INTERP(GridSamplerInterpolation::Nearest, true);
+      }
+    } else {
+      switch (static_cast<GridSamplerInterpolation>(interpolation_mode)) {
+        HANDLE_INTERP(GridSamplerInterpolation::Bilinear, false);
+        HANDLE_INTERP(GridSamplerInterpolation::Nearest, false);
+      }
+    }
+  });
+#undef HANDLE_CASE
+#undef HANDLE_INTERP
+
+  return output;
+}
+
+std::tuple<Tensor, Tensor>
+grid_sampler_3d_backward_cpu_kernel_impl(const Tensor& grad_output_,
+                                         const Tensor& input,
+                                         const Tensor& grid,
+                                         int64_t interpolation_mode,
+                                         int64_t padding_mode,
+                                         bool align_corners) {
+  // grad_output should be contiguous most of time. Ensuring that it is
+  // contiguous can greatly simplify this code.
+  auto grad_output = grad_output_.contiguous();
+
+  auto grad_input = at::zeros_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto grad_grid = at::empty_like(grid, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  // Different output locations of a sample can scatter into the same
+  // grad_input element, so unlike the forward the work is only split over N.
+  auto N = input.size(0);
+  auto spatial_size = grid.size(1) * grid.size(2) * grid.size(3);
+  auto grain_size = spatial_size == 0 ? (N + 1)
+                                      : at::divup(at::internal::GRAIN_SIZE, spatial_size * 15 /* 3d * 5 tensors*/);
+
+#define HANDLE_CASE(interp, padding, align_corners)                              \
+  case padding: {                                                                \
+    ApplyGridSample<scalar_t, 3, interp, padding, align_corners>                 \
+    grid_sample(inp_acc);                                                        \
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {             \
+      for (int64_t n = begin; n < end; n++) {                                    \
+        auto gInp_slice = gInp_acc[n];                                           \
+        auto gGrid_slice = gGrid_acc[n];                                         \
+        auto gOut_slice = gOut_acc[n];                                           \
+        auto inp_slice = inp_acc[n];                                             \
+        grid_sample_3d_grid_slice_iterator(                                      \
+          grid_acc[n], 0, grid_acc.size(1),                                      \
+          [&](const Vec256<scalar_t>& grid_x, const Vec256<scalar_t>& grid_y,    \
+              const Vec256<scalar_t>& grid_z,                                    \
+              int64_t spatial_offset, int64_t len) {                             \
+            grid_sample.backward(gInp_slice, gGrid_slice, gOut_slice, inp_slice, \
+                                 spatial_offset, grid_x, grid_y, grid_z, len);   \
+          });                                                                    \
+      }                                                                          \
+    });                                                                          \
+    return;                                                                      \
+  }
+
+#define HANDLE_INTERP(interp, align_corners)                                \
+  case interp: {                                                            \
+    switch (static_cast<GridSamplerPadding>(padding_mode)) {                \
+      HANDLE_CASE(interp, GridSamplerPadding::Zeros, align_corners);        \
+      HANDLE_CASE(interp, GridSamplerPadding::Border, align_corners);       \
+      HANDLE_CASE(interp, GridSamplerPadding::Reflection, align_corners);   \
+    }                                                                       \
+    return;                                                                 \
+  }
+
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "grid_sampler_3d_backward_cpu_kernel_impl", [&] {
+    auto gInp_acc = grad_input.accessor<scalar_t, 5>();
+    auto gGrid_acc = grad_grid.accessor<scalar_t, 5>();
+    auto inp_acc = input.accessor<scalar_t, 5>();
+    auto grid_acc = grid.accessor<scalar_t, 5>();
+    auto gOut_acc = grad_output.accessor<scalar_t, 5>();
+    if (align_corners) {
+      switch (static_cast<GridSamplerInterpolation>(interpolation_mode)) {
+        HANDLE_INTERP(GridSamplerInterpolation::Bilinear, true);
+        HANDLE_INTERP(GridSamplerInterpolation::Nearest, true);
+      }
+    } else {
+      switch (static_cast<GridSamplerInterpolation>(interpolation_mode)) {
+        HANDLE_INTERP(GridSamplerInterpolation::Bilinear, false);
+        HANDLE_INTERP(GridSamplerInterpolation::Nearest, false);
+      }
+    }
+  });
+#undef HANDLE_CASE
+#undef HANDLE_INTERP
+
+  return std::make_tuple(grad_input, grad_grid);
+}
+
 }
 
 REGISTER_DISPATCH(grid_sampler_2d_cpu_kernel, &grid_sampler_2d_cpu_kernel_impl);
 REGISTER_DISPATCH(grid_sampler_2d_backward_cpu_kernel, &grid_sampler_2d_backward_cpu_kernel_impl);
+REGISTER_DISPATCH(grid_sampler_3d_cpu_kernel, &grid_sampler_3d_cpu_kernel_impl);
+REGISTER_DISPATCH(grid_sampler_3d_backward_cpu_kernel, &grid_sampler_3d_backward_cpu_kernel_impl);
 
 
 }}  // namespace at::native
@@ -24,9 +24,16 @@
 //
 // See BinaryOpsKernel.cpp for the complete implementation
 //
+// cpu_kernel_vec also vectorizes operands that are not contiguous: strided
+// operands are gathered into vectors (and the output scattered), and inputs
+// that are only contiguous along the outer dimension of a 2-d loop, e.g.
+// transposed or channels-last inputs, are transposed tile by tile into a
+// small buffer first.
 //
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstring>
 #include <c10/util/C++17.h>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/cpu/IsContiguous.h>
@@ -183,6 +190,182 @@ static inline void unroll_contiguous_scalar_checks(
   }
 }
 
+// Loads the elements at `ptr`, `ptr + stride`, ... into a vector: a
+// contiguous load, a broadcast, or a gather for other strides. The gathers
+// go through raw storage since the quantized types have no default
+// constructor.
+template <typename Vec, typename scalar_t>
+static inline Vec load_strided(const char* C10_RESTRICT ptr, int64_t stride) {
+  if (stride == sizeof(scalar_t)) {
+    return Vec::loadu(ptr);
+  } else if (stride == 0) {
+    return Vec(*(const scalar_t*)ptr);
+  }
+  __at_align32__ char tmp[Vec::size() * sizeof(scalar_t)];
+  for (int64_t k = 0; k < Vec::size(); k++) {
+    std::memcpy(tmp + k * sizeof(scalar_t), ptr + k * stride, sizeof(scalar_t));
+  }
+  return Vec::loadu(tmp);
+}
+
+// Stores the elements of a vector at `ptr`, `ptr + stride`, ...
+template <typename Vec, typename scalar_t>
+static inline void store_strided(const Vec& vec, char* C10_RESTRICT ptr, int64_t stride) {
+  if (stride == sizeof(scalar_t)) {
+    vec.store(ptr);
+    return;
+  }
+  __at_align32__ char tmp[Vec::size() * sizeof(scalar_t)];
+  vec.store(tmp);
+  for (int64_t k = 0; k < Vec::size(); k++) {
+    std::memcpy(ptr + k * stride, tmp + k * sizeof(scalar_t), sizeof(scalar_t));
+  }
+}
+
+template <typename traits, typename scalar_t, std::size_t... INDEX>
+typename traits::ArgsTuple
+dereference_vec_strided_impl(char* C10_RESTRICT data[], const int64_t* strides, int64_t i,
+                             std::index_sequence<INDEX...>) {
+  using Vec = typename traits::result_type;
+  return std::make_tuple(
+      load_strided<Vec, scalar_t>(data[INDEX] + i * strides[INDEX], strides[INDEX])...);
+}
+
+template <typename traits, typename scalar_t>
+typename traits::ArgsTuple
+dereference_vec_strided(char* C10_RESTRICT data[], const int64_t* strides, int64_t i) {
+  using Indices = std::make_index_sequence<traits::arity>;
+  return dereference_vec_strided_impl<traits, scalar_t>(data, strides, i, Indices{});
+}
+
+// Explicitly vectorized loop for operands with arbitrary strides. All inputs
+// and outputs must be the same type. Every operand that isn't contiguous or a
+// scalar is gathered into (or, for the output, scattered from) a vector.
+template <typename func_t, typename vec_func_t>
+static inline void
+strided_vectorized_loop(char** C10_RESTRICT data_, const int64_t* strides_, int64_t n, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<vec_func_t>;
+  using scalar_t = typename function_traits<func_t>::result_type;
+  using Vec = Vec256<scalar_t>;
+  constexpr int ntensors = traits::arity + 1;
+
+  char* C10_RESTRICT data[ntensors];
+  int64_t strides[ntensors];
+  for (int arg = 0; arg < ntensors; arg++) {
+    data[arg] = data_[arg];
+    strides[arg] = strides_[arg];
+  }
+
+  int64_t i = 0;
+  for (; i <= n - Vec::size(); i += Vec::size()) {
+    auto args = dereference_vec_strided<traits, scalar_t>(&data[1], &strides[1], i);
+    auto out = c10::guts::apply(std::forward<vec_func_t>(vop), std::move(args));
+    store_strided<Vec, scalar_t>(out, data[0] + i * strides[0], strides[0]);
+  }
+  if (i < n) {
+    basic_loop(data, strides, i, n, std::forward<func_t>(op));
+  }
+}
+
+// Explicitly vectorized loop over one row of a 2-d loop: the contiguous loop
+// if all operands are contiguous or a single input is a scalar, the strided
+// loop otherwise.
+template <typename func_t, typename vec_func_t>
+static inline void
+vectorized_row_loop(char** C10_RESTRICT data, const int64_t* strides, int64_t n, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<func_t>;
+  if (is_contiguous<traits>(strides)) {
+    vectorized_loop(data, n, 0, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+  } else {
+    using Indices = std::make_index_sequence<traits::arity>;
+    unroll_contiguous_scalar_checks<traits>(strides, Indices{}, [&](size_t idx) {
+      if (idx) {
+        vectorized_loop(data, n, idx, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+      } else {
+        strided_vectorized_loop(data, strides, n, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+      }
+    });
+  }
+}
+
+// The number of elements along the inner dimension of a tile that an input
+// is transposed into.
+constexpr int64_t kTransposeTileSize = 64;
+
+// Whether an input is only contiguous along the outer dimension of a 2-d
+// loop, e.g. a transposed input, and is better read tile by tile.
+template <typename scalar_t>
+static inline bool should_transpose(int64_t inner_stride, int64_t outer_stride) {
+  return inner_stride != sizeof(scalar_t) && inner_stride != 0 &&
+      outer_stride == sizeof(scalar_t);
+}
+
+// 2-d loop that transposes the inputs which are only contiguous along the
+// outer dimension into tiles of Vec::size() rows. The tiles are filled with
+// contiguous reads, so every cache line of these inputs is read once, and
+// the rows of the tiles then go through the contiguous vectorized loop.
+// `strides` holds the inner strides of the `ntensors` operands followed by
+// their outer strides.
+template <typename func_t, typename vec_func_t>
+static inline void
+transposed_tile_loop(char** C10_RESTRICT data, const int64_t* strides, int ntensors_,
+                     int64_t size0, int64_t size1, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<vec_func_t>;
+  using scalar_t = typename function_traits<func_t>::result_type;
+  using Vec = Vec256<scalar_t>;
+  constexpr int ntensors = traits::arity + 1;
+  const int64_t* outer_strides = &strides[ntensors_];
+
+  bool transpose[ntensors];
+  for (int arg = 0; arg < ntensors; arg++) {
+    transpose[arg] = arg > 0 && should_transpose<scalar_t>(strides[arg], outer_strides[arg]);
+  }
+
+  // The quantized types have no default constructor, so the tiles live in
+  // raw storage.
+  using tile_t = scalar_t[Vec::size()][kTransposeTileSize];
+  __at_align32__ char tile_storage[ntensors * sizeof(tile_t)];
+  tile_t* tiles = reinterpret_cast<tile_t*>(tile_storage);
+  char* row_data[ntensors];
+  int64_t row_strides[ntensors];
+  int64_t j = 0;
+  for (; j + Vec::size() <= size1; j += Vec::size()) {
+    for (int64_t i0 = 0; i0 < size0; i0 += kTransposeTileSize) {
+      const int64_t len = std::min(kTransposeTileSize, size0 - i0);
+      for (int arg = 1; arg < ntensors; arg++) {
+        if (!transpose[arg]) {
+          continue;
+        }
+        const char* ptr = data[arg] + j * outer_strides[arg] + i0 * strides[arg];
+        for (int64_t i = 0; i < len; i++) {
+          const scalar_t* column = (const scalar_t*)(ptr + i * strides[arg]);
+          for (int64_t k = 0; k < Vec::size(); k++) {
+            tiles[arg][k][i] = column[k];
+          }
+        }
+      }
+      for (int64_t k = 0; k < Vec::size(); k++) {
+        for (int arg = 0; arg < ntensors; arg++) {
+          if (transpose[arg]) {
+            row_data[arg] = (char*)tiles[arg][k];
+            row_strides[arg] = sizeof(scalar_t);
+          } else {
+            row_data[arg] = data[arg] + (j + k) * outer_strides[arg] + i0 * strides[arg];
+            row_strides[arg] = strides[arg];
+          }
+        }
+        vectorized_row_loop(row_data, row_strides, len, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+      }
+    }
+  }
+  for (; j < size1; j++) {
+    for (int arg = 0; arg < ntensors; arg++) {
+      row_data[arg] = data[arg] + j * outer_strides[arg];
+    }
+    vectorized_row_loop(row_data, strides, size0, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+  }
+}
+
 template <typename func_t>
 void cpu_kernel(TensorIterator& iter, func_t&& op) {
   using traits = function_traits<func_t>;
@@ -206,18 +389,31 @@ void cpu_kernel_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop) {
   using traits = function_traits<func_t>;
   TORCH_INTERNAL_ASSERT(iter.ntensors() >= traits::arity + 1);
 
-  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
-    if (is_contiguous<traits>(strides)) {
-      return vectorized_loop(data, n, 0, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
-    } else {
-      using Indices = std::make_index_sequence<traits::arity>;
-      unroll_contiguous_scalar_checks<traits>(strides, Indices{}, [&](size_t idx) {
-        if (idx) {
-          vectorized_loop(data, n, idx, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
-        } else {
-          basic_loop(data, strides, 0, n, std::forward<func_t>(op));
+  using scalar_t = typename traits::result_type;
+  using Vec = Vec256<scalar_t>;
+  constexpr int ntensors = traits::arity + 1;
+
+  const int ntensors_ = iter.ntensors();
+  iter.for_each([&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    const int64_t* outer_strides = &strides[ntensors_];
+    if (size1 >= Vec::size() && size0 >= Vec::size()) {
+      for (int arg = 1; arg < ntensors; arg++) {
+        if (should_transpose<scalar_t>(strides[arg], outer_strides[arg])) {
+          return transposed_tile_loop(
+              data, strides, ntensors_, size0, size1,
+              std::forward<func_t>(op), std::forward<vec_func_t>(vop));
         }
-      });
+      }
+    }
+    char* row_data[ntensors];
+    for (int arg = 0; arg < ntensors; arg++) {
+      row_data[arg] = data[arg];
+    }
+    for (int64_t j = 0; j < size1; j++) {
+      vectorized_row_loop(row_data, strides, size0, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+      for (int arg = 0; arg < ntensors; arg++) {
+        row_data[arg] += outer_strides[arg];
+      }
     }
   });
   iter.cast_outputs();
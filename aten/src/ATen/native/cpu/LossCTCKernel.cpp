@@ -0,0 +1,365 @@
+// Copyright (c) 2018 MathInf GmbH, Thomas Viehmann
+// Licensed under the BSD-3-Clause license
+// This is the CPU implementation of the Connectionist Temporal Loss.
+// We mostly follow Graves.
+// 1. Graves et al: http://www.cs.toronto.edu/~graves/icml_2006.pdf
+// We use the equations from above link, but note that [1] has 1-based indexing and we (of course) use 0-based.
+// Graves et al call the probabilities y, we use log_probs (also calling them inputs)
+
+#include <ATen/native/cpu/LossCTCKernel.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/TensorUtils.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// this ad-hoc converts from targets (l in [1]) to augmented targets (l' in [1]) note that no bound-checking is done
+template<typename target_t>
+static inline int64_t get_target_prime(target_t* target, int64_t offset, int64_t stride, int64_t idx, int64_t BLANK) {
+  if (idx % 2 == 0) {
+    return BLANK;
+  } else {
+    return target[offset + stride * (idx / 2)];
+  }
+}
+
+// One row of the log-space alpha or beta recursion, eq (6)/(7) and (10)/(11):
+//   out[s] = log(exp(x1[s]) + exp(x2[s]) + exp(x3[s] + skip[s])) + lp[s]
+// x1, x2 and x3 are the previous row shifted by 0, 1 and 2 states, skip[s] is 0 where
+// the transition over a blank is allowed and -inf where it is not, and lp[s] is
+// log_probs gathered at target'[s]. Nothing depends on out within a row, so the row
+// is computed a full vector of states at a time.
+template<typename scalar_t>
+static inline void ctc_log_add_row(scalar_t* out, const scalar_t* x1, const scalar_t* x2, const scalar_t* x3,
+                                   const scalar_t* skip, const scalar_t* lp, int64_t n) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec neginf(-std::numeric_limits<scalar_t>::infinity());
+  const Vec zero(0);
+  for (int64_t s = 0; s < n; s += Vec::size()) {
+    int64_t count = std::min<int64_t>(Vec::size(), n - s);
+    Vec la1 = Vec::loadu(x1 + s, count);
+    Vec la2 = Vec::loadu(x2 + s, count);
+    Vec la3 = Vec::loadu(x3 + s, count) + Vec::loadu(skip + s, count);
+    Vec lamax = vec256::maximum(vec256::maximum(la1, la2), la3);
+    lamax = Vec::blendv(lamax, zero, lamax == neginf); // cannot do neginf-neginf
+    Vec res = ((la1 - lamax).exp() + (la2 - lamax).exp() + (la3 - lamax).exp()).log() + lamax + Vec::loadu(lp + s, count);
+    res.store(out + s, count);
+  }
+}
+
+// This kernel is a relatively straightforward implementation of the alpha calculation in the forward backward algorithm (section 4.1).
+// A (minor) twist is that we are using log-calculations to enhance numerical stability (log_probs and log_alpha).
+// The function returns the loss and the alphas, the alphas are kept for the backward step. The wrapper (ctc_loss below) hides
+// the alphas from the user by only returning the loss.
+template<typename scalar_t, ScalarType target_scalar_type>
+std::tuple<Tensor, Tensor> ctc_loss_cpu_template(const Tensor& log_probs, const Tensor& targets, IntArrayRef input_lengths, IntArrayRef target_lengths, int64_t BLANK) {
+  // log_probs: input_len x batch_size x num_labels
+  // targets [int64]: batch_size x target_length OR sum(target_lengths)
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+
+  CheckedFrom c = "ctc_loss_cpu";
+  auto log_probs_arg = TensorArg(log_probs, "log_probs", 1);
+  auto targets_arg = TensorArg(targets, "targets", 2);
+  checkScalarType(c, targets_arg, target_scalar_type);
+  checkDim(c, log_probs_arg, 3);
+  checkDimRange(c, targets_arg, 1, 3);
+
+  int64_t batch_size = log_probs.size(1);
+  int64_t num_labels = log_probs.size(2);
+  TORCH_CHECK((0 <= BLANK) && (BLANK < num_labels), "blank must be in label range");
+  TORCH_CHECK((int64_t) input_lengths.size() == batch_size, "input_lengths must be of size batch_size");
+  TORCH_CHECK((int64_t) target_lengths.size() == batch_size, "target_lengths must be of size batch_size");
+
+  size_t tg_target_stride;
+  int64_t max_target_length = 0;
+  std::vector<int64_t> tg_batch_offsets(batch_size);
+  if (targets.dim() == 1) { // concatenated targets
+    int64_t pos = 0;
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = pos;
+      pos += target_lengths[i];
+      if (max_target_length < target_lengths[i])
+         max_target_length = target_lengths[i];
+    }
+    tg_target_stride = targets.stride(0);
+    checkSize(c, targets_arg, 0, pos);
+  }
+  else { // batch x max_target_length
+    // dim is 2
+    int64_t tg_batch_stride = targets.stride(0);
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = i * tg_batch_stride;
+      if (max_target_length < target_lengths[i])
+        max_target_length = target_lengths[i];
+    }
+    tg_target_stride = targets.stride(1);
+    checkSize(c, targets_arg, 0, batch_size);
+    TORCH_CHECK(targets.size(1) >= max_target_length,
+             "Expected tensor to have size at least ", max_target_length, " at dimension 1, but got size ", targets.size(1), " for ", targets_arg,
+             " (while checking arguments for ", c, ")");
+  }
+  int64_t max_input_length = log_probs.size(0);
+  for (int64_t b = 0; b < batch_size; b++) {
+    TORCH_CHECK(input_lengths[b] <= max_input_length,
+             "Expected input_lengths to have value at most ", max_input_length, ", but got value ", input_lengths[b],
+             " (while checking arguments for ", c, ")");
+  }
+
+  Tensor log_alpha = at::empty({batch_size, log_probs.size(0), 2*max_target_length+1}, log_probs.options());
+  Tensor neg_log_likelihood = at::empty({batch_size}, log_probs.options());
+
+  auto lpp  = log_probs.permute({1,0,2});
+  auto log_probs_a_global = lpp.accessor<scalar_t, 3>();
+  auto log_alpha_a_global = log_alpha.accessor<scalar_t, 3>();
+  auto targets_data = targets.data_ptr<target_t>();
+  auto neg_log_likelihood_a = neg_log_likelihood.accessor<scalar_t, 1>();
+
+  // alpha calculation for the first row, the three equations for alpha_1 above eq (6)
+  // first the default
+  log_alpha.narrow(1, 0, 1).fill_(neginf);
+  at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
+    // per-thread scratch: target', the skip mask, log_probs gathered at target' and
+    // the previous row of alpha with two neginf states in front of it
+    std::vector<int64_t> target_prime(2*max_target_length+1);
+    std::vector<scalar_t> skip(2*max_target_length+1);
+    std::vector<scalar_t> lp(2*max_target_length+1);
+    std::vector<scalar_t> prev(2*max_target_length+3, neginf);
+    for (int64_t b = start; b < end; b++) {
+      int64_t input_length = input_lengths[b];
+      int64_t target_length = target_lengths[b];
+      auto log_probs_a = log_probs_a_global[b];
+      auto log_alpha_a = log_alpha_a_global[b];
+      int64_t tg_batch_offset = tg_batch_offsets[b];
+      int64_t num_states = 2*target_length+1;
+
+      for (int64_t s=0; s<num_states; s++) {
+        target_prime[s] = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+        // the third summand of eq (6) only exists if target'[s-2] != target'[s]
+        skip[s] = (s > 1 && target_prime[s-2] != target_prime[s]) ? 0 : neginf;
+      }
+
+      // the first two items of alpha_t above eq (6)
+      log_alpha_a[0][0] = log_probs_a[0][BLANK];
+      if (target_length > 0)
+        log_alpha_a[0][1] = log_probs_a[0][target_prime[1]];
+
+      // now the loop over the inputs
+      for (int64_t t=1; t<input_length; t++) {
+        for (int64_t s=0; s<num_states; s++) {
+          prev[s+2] = log_alpha_a[t-1][s];
+          lp[s] = log_probs_a[t][target_prime[s]];
+        }
+        // this is the assignment of eq (6), the three summands are alpha_{t-1} at s, s-1 and s-2
+        ctc_log_add_row(&log_alpha_a[t][0], prev.data() + 2, prev.data() + 1, prev.data(),
+                        skip.data(), lp.data(), num_states);
+      }
+      // the likelihood is the the sum of the last two alphas, eq (8), the loss is the negative log likelihood
+      if (target_length == 0) {
+        // if the target is empty then there is no preceding BLANK state and hence there is no path to merge
+        neg_log_likelihood_a[b] = -log_alpha_a[input_length-1][0];
+      } else {
+        scalar_t l1 = log_alpha_a[input_length-1][target_length*2];
+        scalar_t l2 = log_alpha_a[input_length-1][target_length*2-1];
+        scalar_t m = std::max(l1, l2);
+        m = ((m == neginf) ? 0 : m);
+        scalar_t log_likelihood = std::log(std::exp(l1-m)+std::exp(l2-m))+m;
+        neg_log_likelihood_a[b] = -log_likelihood;
+      }
+    }
+  });
+
+  return std::make_tuple(neg_log_likelihood, log_alpha);
+}
+
+// This is the backward. It consists of two phases:
+// a) computing the beta analogous to the alphas in the forward (backward half of the forward-backward algorithm) (eq (10) and (11))
+// b) collecting the per-activation characters for all s and wrapping the gradient (eq (16), the collection is the sum)
+template<typename scalar_t, ScalarType target_scalar_type>
+Tensor ctc_loss_backward_cpu_template(const Tensor& grad_out, const Tensor& log_probs, const Tensor& targets, IntArrayRef input_lengths, IntArrayRef target_lengths,
+                                      const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK, bool zero_infinity) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+  int64_t max_input_length = log_probs.size(0);
+  int64_t batch_size = log_probs.size(1);
+  int64_t num_labels = log_probs.size(2);
+  Tensor grad = at::full_like(log_probs, neginf, LEGACY_CONTIGUOUS_MEMORY_FORMAT); // at this point, this is log of empty sum
+
+  // The admin bits. We don't do much checking and assume that the forward did.
+  int64_t tg_target_stride;
+  int64_t max_target_length;
+  std::vector<int64_t> tg_batch_offsets(batch_size);
+
+  if (targets.dim() == 1) { // concatenated targets
+    int64_t pos = 0;
+    max_target_length = 0;
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = pos;
+      pos += target_lengths[i];
+      if (max_target_length < target_lengths[i])
+        max_target_length = target_lengths[i];
+    }
+    tg_target_stride = targets.stride(0);
+  }
+  else { // batch x max_target_length
+    // dim is 2
+    int64_t tg_batch_stride = targets.stride(0);
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = i * tg_batch_stride;
+    }
+    tg_target_stride = targets.stride(1);
+    max_target_length = targets.size(1);
+  }
+
+  auto lpp  = log_probs.permute({1,0,2});
+  auto log_probs_a_global = lpp.accessor<scalar_t, 3>();
+  auto log_alpha_a_global = log_alpha.accessor<scalar_t, 3>();
+  auto gp = grad.permute({1,0,2});
+  auto grad_a_global = gp.accessor<scalar_t, 3>();
+  auto targets_data = targets.data_ptr<target_t>();
+  bool log_probs_rows_contiguous = log_probs.stride(2) == 1;
+
+  at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
+    // Only two rows of beta are alive at any time: the gradient at t only needs beta_t,
+    // so we keep beta_{t+1} and beta_t (each with two neginf states after the end)
+    // instead of a full batch x time x states table.
+    std::vector<int64_t> target_prime(2*max_target_length+1);
+    std::vector<scalar_t> skip(2*max_target_length+1);
+    std::vector<scalar_t> lp(2*max_target_length+1);
+    std::vector<scalar_t> beta_next(2*max_target_length+3);
+    std::vector<scalar_t> beta_cur(2*max_target_length+3);
+    for (int64_t b = start; b < end; b++) {
+      scalar_t nll = neg_log_likelihood.accessor<scalar_t, 1>()[b];
+      if (zero_infinity &&  nll == std::numeric_limits<scalar_t>::infinity()) {
+        grad.narrow(1, b, 1).zero_();
+        continue;
+      }
+
+      auto log_probs_a = log_probs_a_global[b];
+      auto log_alpha_a = log_alpha_a_global[b];
+      auto grad_a = grad_a_global[b];
+      int64_t input_length = input_lengths[b];
+      int64_t target_length = target_lengths[b];
+      int64_t tg_batch_offset = tg_batch_offsets[b];
+      int64_t num_states = 2*target_length+1;
+
+      for (int64_t s=0; s<num_states; s++) {
+        target_prime[s] = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+      }
+      for (int64_t s=0; s<num_states; s++) {
+        // the third summand of eq (10) only exists if target'[s+2] != target'[s]
+        skip[s] = (s < 2*target_length-1 && target_prime[s+2] != target_prime[s]) ? 0 : neginf;
+      }
+
+      // the initialization of beta before eq (10)
+      // here we do the fill for each batch item separately, as the input lengths will differ, so the t in which
+      // we start varies
+      std::fill(beta_next.begin(), beta_next.end(), neginf);
+      std::fill(beta_cur.begin(), beta_cur.end(), neginf);
+      if (input_length > 0) {
+        beta_next[2*target_length] = log_probs_a[input_length-1][BLANK];
+        grad_a[input_length-1][BLANK] = log_alpha_a[input_length-1][2*target_length] + beta_next[2*target_length];
+
+        if (target_length > 0) {
+          auto current_target_prime = target_prime[2*target_length-1];
+          beta_next[2*target_length-1] = log_probs_a[input_length-1][current_target_prime];
+
+          // the first two are a blank and a non-blank, so we know they are different and we don't need to do log+
+          grad_a[input_length-1][current_target_prime] = log_alpha_a[input_length-1][2*target_length-1] + beta_next[2*target_length-1];
+        }
+      }
+
+      // now loop applying eq (10) / (11)
+      for (int64_t t=input_length-2; t>=0; t--) {
+        for (int64_t s=0; s<num_states; s++) {
+          lp[s] = log_probs_a[t][target_prime[s]];
+        }
+        // the three summands are beta_{t+1} at s, s+1 and s+2
+        ctc_log_add_row(beta_cur.data(), beta_next.data(), beta_next.data() + 1, beta_next.data() + 2,
+                        skip.data(), lp.data(), num_states);
+
+        // now that we have beta, we fill in the sum of alpha*beta in eq (16)
+        // in contrast to the cuda implementation, we only parallelize over the batch, so we don't have a concurrency
+        // issue (several s can map to the same target character)
+        // collected[b, t, target'[s]] "log+=" log_alpha[t, s]+log_beta[t, s]
+        for (int64_t s=0; s<num_states; s++) {
+          scalar_t log_alpha_beta =  log_alpha_a[t][s] + beta_cur[s];
+          scalar_t &lcab = grad_a[t][target_prime[s]];
+          if (lcab == neginf) {
+            lcab = log_alpha_beta;
+          } else {
+            scalar_t max = std::max(lcab, log_alpha_beta);
+            lcab = std::log(std::exp(lcab-max)+std::exp(log_alpha_beta-max))+max;
+          }
+        }
+        std::swap(beta_cur, beta_next);
+      }
+
+      // now grad has the sum of eq (16)
+      // now we wrap up the calculation by adding in the remaining items of eq (16)
+      // grad is the output gradient, nll is the loss. Note that the likelihood -nll is the Z of eq (16)
+      scalar_t gr =  grad_out.accessor<scalar_t, 1>()[b];
+      for (int64_t t = 0; t < input_length; t++) { // or go for the full thing?
+        if (log_probs_rows_contiguous) {
+          using Vec = vec256::Vec256<scalar_t>;
+          vec256::map2(
+              [nll, gr](Vec res, Vec lp) {
+                return (lp.exp() - (res + Vec(nll) - lp).exp()) * Vec(gr);
+              },
+              &grad_a[t][0], &grad_a[t][0], &log_probs_a[t][0], num_labels);
+        } else {
+          for (int64_t c = 0; c < num_labels; c++) {
+            scalar_t& res = grad_a[t][c];
+            scalar_t lp = log_probs_a[t][c];
+            res = (std::exp(lp)-std::exp(res + nll - lp)) * gr;
+          }
+        }
+      }
+      // zero the remainder
+      if (input_length < max_input_length) {
+        grad.narrow(0, input_length, max_input_length - input_length).narrow(1, b, 1).zero_();
+      }
+    }
+  });
+  return grad;
+}
+
+static std::tuple<Tensor, Tensor> ctc_loss_kernel_impl(const Tensor& log_probs, const Tensor& targets, IntArrayRef input_lengths, IntArrayRef target_lengths, int64_t BLANK) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.scalar_type(), "ctc_loss_cpu", [&] {
+      if (targets.scalar_type() == kLong) {
+        return ctc_loss_cpu_template<scalar_t, kLong>(log_probs, targets, input_lengths, target_lengths, BLANK);
+      } else {
+        return ctc_loss_cpu_template<scalar_t, kInt>(log_probs, targets, input_lengths, target_lengths, BLANK);
+      }
+  });
+}
+
+static Tensor ctc_loss_backward_kernel_impl(const Tensor& grad, const Tensor& log_probs, const Tensor& targets, IntArrayRef input_lengths, IntArrayRef target_lengths,
+                                            const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK, bool zero_infinity) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.scalar_type(), "ctc_loss_backward_cpu", [&] {
+      if (targets.scalar_type() == kLong) {
+        return ctc_loss_backward_cpu_template<scalar_t,kLong>(grad, log_probs, targets, input_lengths, target_lengths, neg_log_likelihood, log_alpha, BLANK, zero_infinity);
+      } else {
+        return ctc_loss_backward_cpu_template<scalar_t,kInt>(grad, log_probs, targets, input_lengths, target_lengths, neg_log_likelihood, log_alpha, BLANK, zero_infinity);
+      }
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(ctc_loss_cpu_kernel, &ctc_loss_kernel_impl);
+REGISTER_DISPATCH(ctc_loss_backward_cpu_kernel, &ctc_loss_backward_kernel_impl);
+
+} } // at::native
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+#include <tuple>
+
+namespace at { namespace native {
+
+using ctc_loss_fn = std::tuple<Tensor, Tensor>(*)(const Tensor&, const Tensor&, IntArrayRef, IntArrayRef, int64_t);
+using ctc_loss_backward_fn = Tensor(*)(const Tensor&, const Tensor&, const Tensor&, IntArrayRef, IntArrayRef,
+                                       const Tensor&, const Tensor&, int64_t, bool);
+DECLARE_DISPATCH(ctc_loss_fn, ctc_loss_cpu_kernel);
+DECLARE_DISPATCH(ctc_loss_backward_fn, ctc_loss_backward_cpu_kernel);
+
+}}  // namespace at::native
@@ -0,0 +1,112 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/Pool.h>
+
+namespace at { namespace native {
+namespace {
+
+// The channels of a pixel are contiguous in channels last tensors, so each
+// window is reduced for Vec256<scalar_t>::size() channels at once, and the
+// work is split over the output rows of all the batch elements. The indices
+// of the maxima are tracked in integer vectors of the same width, which the
+// caller checked can hold any index of an input plane.
+template <typename scalar_t>
+void cpu_max_pool_channels_last(
+    Tensor& output,
+    Tensor& indices,
+    const Tensor& input,
+    int kW, int kH,
+    int dW, int dH,
+    int padW, int padH,
+    int dilationW, int dilationH) {
+  using Vec = vec256::Vec256<scalar_t>;
+  using integer_t = vec256::int_same_size_t<scalar_t>;
+  using iVec = vec256::Vec256<integer_t>;
+
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_height = output.size(2);
+  const int64_t output_width = output.size(3);
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* indices_data = indices.data_ptr<int64_t>();
+
+  // blendv only looks at the bits of the mask, so this is "true" everywhere
+  const Vec all_true = Vec(0) == Vec(0);
+
+  at::parallel_for(0, nbatch * output_height, 0, [&](int64_t begin, int64_t end) {
+    integer_t index_buffer[iVec::size()];
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t n = i / output_height;
+      const int64_t oh = i % output_height;
+      int64_t hstart = oh * dH - padH;
+      const int64_t hend = std::min(hstart + (kH - 1) * dilationH + 1, input_height);
+      while (hstart < 0) {
+        hstart += dilationH;
+      }
+      const scalar_t* input_n = input_data + n * input_height * input_width * channels;
+
+      for (int64_t ow = 0; ow < output_width; ow++) {
+        int64_t wstart = ow * dW - padW;
+        const int64_t wend = std::min(wstart + (kW - 1) * dilationW + 1, input_width);
+        while (wstart < 0) {
+          wstart += dilationW;
+        }
+        scalar_t* out = output_data + (i * output_width + ow) * channels;
+        int64_t* ind = indices_data + (i * output_width + ow) * channels;
+
+        for (int64_t c = 0; c < channels; c += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+          Vec maxval(-std::numeric_limits<scalar_t>::infinity());
+          iVec maxindex(static_cast<integer_t>(hstart * input_width + wstart));
+          for (int64_t y = hstart; y < hend; y += dilationH) {
+            for (int64_t x = wstart; x < wend; x += dilationW) {
+              const int64_t index = y * input_width + x;
+              Vec val = Vec::loadu(input_n + index * channels + c, count);
+              // same as (val > maxval) || isnan(val): NaN lanes aren't equal
+              // to themselves and take the all true mask
+              Vec mask = Vec::blendv(all_true, val > maxval, val == val);
+              maxval = Vec::blendv(maxval, val, mask);
+              maxindex = iVec::blendv(
+                  maxindex, iVec(static_cast<integer_t>(index)), vec256::cast<integer_t>(mask));
+            }
+          }
+          maxval.store(out + c, count);
+          maxindex.store(index_buffer, count);
+          for (int64_t k = 0; k < count; k++) {
+            ind[c + k] = index_buffer[k];
+          }
+        }
+      }
+    }
+  });
+}
+
+void max_pool2d_channels_last_kernel_impl(
+    Tensor& output,
+    Tensor& indices,
+    const Tensor& input,
+    int kW, int kH,
+    int dW, int dH,
+    int padW, int padH,
+    int dilationW, int dilationH) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "max_pool2d_channels_last", [&] {
+    TORCH_CHECK(input.size(2) * input.size(3) <= std::numeric_limits<vec256::int_same_size_t<scalar_t>>::max(),
+        "max_pool2d: input planes of size ", input.size(2), "x", input.size(3), " are too large "
+        "for the channels last kernel");
+    cpu_max_pool_channels_last<scalar_t>(
+        output, indices, input, kW, kH, dW, dH, padW, padH, dilationW, dilationH);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_channels_last_kernel, &max_pool2d_channels_last_kernel_impl);
+
+}} // namespace at::native
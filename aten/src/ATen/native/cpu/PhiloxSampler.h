@@ -0,0 +1,128 @@
+#pragma once
+
+#include <ATen/CPUGenerator.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+#include <algorithm>
+#include <mutex>
+
+/*
+  Counter based sampling for the CPU distribution kernels.
+
+  Instead of drawing every element from the mt19937 engine of the CPUGenerator
+  under its mutex, a kernel draws a single philox seed from the generator and
+  then reads the random words of element i straight from the philox stream of
+  that seed, at a position computed from i. Chunks of the output can therefore
+  be filled by any number of threads in any order, and the result only depends
+  on the state of the generator (not on the number of threads).
+*/
+
+namespace at { namespace native { namespace {
+
+// Number of philox blocks computed side by side, so that the rounds can be
+// vectorized by the compiler.
+constexpr int64_t kPhiloxLanes = 8;
+
+// Number of items of a kernel filled per inner iteration of a thread.
+constexpr int64_t kPhiloxChunkItems = 1024;
+
+// Draws the seed of the philox stream used by one kernel call, advancing the
+// CPUGenerator so that the next call uses a different stream.
+inline uint64_t philox_seed(CPUGenerator* generator) {
+  // See Note [Acquire lock when using random generators]
+  std::lock_guard<std::mutex> lock(generator->mutex_);
+  return generator->random64();
+}
+
+// Writes the four 32 bit words of the philox blocks
+// [block_begin, block_begin + n_blocks) of the stream of seed to out. The words
+// are the ones at::philox_engine(seed) returns after skipping block_begin
+// blocks, i.e. word w of the stream is out[w - 4 * block_begin].
+inline void philox_blocks(uint64_t seed, uint64_t block_begin, int64_t n_blocks, uint32_t* out) {
+  constexpr uint32_t kPhilox10A = 0x9E3779B9;
+  constexpr uint32_t kPhilox10B = 0xBB67AE85;
+  constexpr uint32_t kPhiloxSA = 0xD2511F53;
+  constexpr uint32_t kPhiloxSB = 0xCD9E8D57;
+  for (int64_t b = 0; b < n_blocks; b += kPhiloxLanes) {
+    uint32_t c0[kPhiloxLanes], c1[kPhiloxLanes], c2[kPhiloxLanes], c3[kPhiloxLanes];
+    for (int64_t l = 0; l < kPhiloxLanes; l++) {
+      const uint64_t block = block_begin + b + l;
+      c0[l] = static_cast<uint32_t>(block);
+      c1[l] = static_cast<uint32_t>(block >> 32);
+      // the subsequence is always 0
+      c2[l] = 0;
+      c3[l] = 0;
+    }
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+    for (int round = 0; round < 10; round++) {
+      for (int64_t l = 0; l < kPhiloxLanes; l++) {
+        const uint64_t p0 = static_cast<uint64_t>(kPhiloxSA) * c0[l];
+        const uint64_t p1 = static_cast<uint64_t>(kPhiloxSB) * c2[l];
+        const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+        const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+        c0[l] = n0;
+        c1[l] = static_cast<uint32_t>(p1);
+        c2[l] = n2;
+        c3[l] = static_cast<uint32_t>(p0);
+      }
+      k0 += kPhilox10A;
+      k1 += kPhilox10B;
+    }
+    const int64_t lanes = std::min(kPhiloxLanes, n_blocks - b);
+    for (int64_t l = 0; l < lanes; l++) {
+      uint32_t* block_out = out + 4 * (b + l);
+      block_out[0] = c0[l];
+      block_out[1] = c1[l];
+      block_out[2] = c2[l];
+      block_out[3] = c3[l];
+    }
+  }
+}
+
+// Splits [0, n_items) into chunks filled in parallel, and calls
+// f(begin, end, words) for each of them, where words holds the
+// kWordsPerItem * (end - begin) random words of the items of the chunk. The
+// words of item i are words kWordsPerItem * i and up of the philox stream of
+// seed, regardless of how the items are split between threads.
+template <int64_t kWordsPerItem, typename func_t>
+void philox_parallel_for(int64_t n_items, uint64_t seed, int64_t grain_size, const func_t& f) {
+  at::parallel_for(0, n_items, grain_size, [&](int64_t begin, int64_t end) {
+    // one extra block on each side for chunks not starting or ending on a
+    // block boundary
+    uint32_t buffer[kPhiloxChunkItems * kWordsPerItem + 8];
+    for (int64_t chunk_begin = begin; chunk_begin < end; chunk_begin += kPhiloxChunkItems) {
+      const int64_t chunk_end = std::min(end, chunk_begin + kPhiloxChunkItems);
+      const int64_t word_begin = chunk_begin * kWordsPerItem;
+      const int64_t word_end = chunk_end * kWordsPerItem;
+      const int64_t block_begin = word_begin / 4;
+      const int64_t block_end = (word_end + 3) / 4;
+      philox_blocks(seed, block_begin, block_end - block_begin, buffer);
+      f(chunk_begin, chunk_end, buffer + (word_begin - 4 * block_begin));
+    }
+  });
+}
+
+// Uniform values in [0, 1) made from the top 24 (float) or 53 (double) bits of
+// kWords random words.
+template <typename scalar_t>
+struct PhiloxUniform;
+
+template <>
+struct PhiloxUniform<float> {
+  static constexpr int64_t kWords = 1;
+  static inline float sample(const uint32_t* words) {
+    return (words[0] >> 8) * (1.0f / (1u << 24));
+  }
+};
+
+template <>
+struct PhiloxUniform<double> {
+  static constexpr int64_t kWords = 2;
+  static inline double sample(const uint32_t* words) {
+    const uint64_t bits = (static_cast<uint64_t>(words[0]) << 32) | words[1];
+    return (bits >> 11) * (1.0 / (static_cast<uint64_t>(1) << 53));
+  }
+};
+
+}}}  // namespace at::native::<anonymous>
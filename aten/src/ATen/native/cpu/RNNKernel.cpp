@@ -0,0 +1,86 @@
+#include <ATen/native/RNN.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+using Vec = Vec256<float>;
+
+inline Vec sigmoid(const Vec& x) {
+  const Vec one(1.f);
+  return one / (one + x.neg().exp());
+}
+
+// `gates` holds the input, forget, cell and output gates of every batch
+// element, before their nonlinearities.
+void lstm_gates_kernel(Tensor& hy, Tensor& cy, const Tensor& gates, const Tensor& cx) {
+  const int64_t batch = cx.size(0);
+  const int64_t hidden_size = cx.size(1);
+  const float* gates_data = gates.data_ptr<float>();
+  const float* cx_data = cx.data_ptr<float>();
+  float* hy_data = hy.data_ptr<float>();
+  float* cy_data = cy.data_ptr<float>();
+  at::parallel_for(
+      0, batch, internal::GRAIN_SIZE / (4 * hidden_size + 1),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; ++b) {
+          const float* g = gates_data + b * 4 * hidden_size;
+          const float* c = cx_data + b * hidden_size;
+          float* h_out = hy_data + b * hidden_size;
+          float* c_out = cy_data + b * hidden_size;
+          for (int64_t j = 0; j < hidden_size; j += Vec::size()) {
+            const int64_t count = std::min<int64_t>(Vec::size(), hidden_size - j);
+            const Vec ingate = sigmoid(Vec::loadu(g + j, count));
+            const Vec forgetgate = sigmoid(Vec::loadu(g + hidden_size + j, count));
+            const Vec cellgate = Vec::loadu(g + 2 * hidden_size + j, count).tanh();
+            const Vec outgate = sigmoid(Vec::loadu(g + 3 * hidden_size + j, count));
+            const Vec c_new = forgetgate * Vec::loadu(c + j, count) + ingate * cellgate;
+            c_new.store(c_out + j, count);
+            (outgate * c_new.tanh()).store(h_out + j, count);
+          }
+        }
+      });
+}
+
+// `igates` and `hgates` hold the reset, input and new gates computed from the
+// input and from the hidden state.
+void gru_gates_kernel(Tensor& hy, const Tensor& igates, const Tensor& hgates, const Tensor& hx) {
+  const int64_t batch = hx.size(0);
+  const int64_t hidden_size = hx.size(1);
+  const float* igates_data = igates.data_ptr<float>();
+  const float* hgates_data = hgates.data_ptr<float>();
+  const float* hx_data = hx.data_ptr<float>();
+  float* hy_data = hy.data_ptr<float>();
+  at::parallel_for(
+      0, batch, internal::GRAIN_SIZE / (3 * hidden_size + 1),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; ++b) {
+          const float* ig = igates_data + b * 3 * hidden_size;
+          const float* hg = hgates_data + b * 3 * hidden_size;
+          const float* h = hx_data + b * hidden_size;
+          float* h_out = hy_data + b * hidden_size;
+          for (int64_t j = 0; j < hidden_size; j += Vec::size()) {
+            const int64_t count = std::min<int64_t>(Vec::size(), hidden_size - j);
+            const Vec reset_gate = sigmoid(
+                Vec::loadu(ig + j, count) + Vec::loadu(hg + j, count));
+            const Vec input_gate = sigmoid(
+                Vec::loadu(ig + hidden_size + j, count) +
+                Vec::loadu(hg + hidden_size + j, count));
+            const Vec new_gate = (Vec::loadu(ig + 2 * hidden_size + j, count) +
+                reset_gate * Vec::loadu(hg + 2 * hidden_size + j, count)).tanh();
+            ((Vec::loadu(h + j, count) - new_gate) * input_gate + new_gate)
+                .store(h_out + j, count);
+          }
+        }
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_gates_stub, &lstm_gates_kernel);
+REGISTER_DISPATCH(gru_gates_stub, &gru_gates_kernel);
+
+}} // namespace at::native
@@ -161,6 +161,9 @@ struct all_same : guts::conjunction<
 // reduce: (acc_t, data_t, index_t) -> acc_t adds one data point to the accumulated value.
 // combine: (acc_t, acc_t) -> acc_t combines two accumulated values into one.
 // project: acc_t -> out_t finishes the reduction, getting the required output.
+// For a reduction with several outputs, such as var_mean, out_t is a
+// std::tuple with one element per output, so that all of them are computed in
+// a single pass over the input.
 //
 // Additionally, acc_t must be default-constructible:
 // acc_t {} is an identity for combine,
@@ -2,8 +2,12 @@
 #include <iterator>
 #include <algorithm>
 #include <limits>
+#include <functional>
+#include <vector>
 
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/TensorIterator.h>
@@ -207,6 +211,124 @@ static void argmin_kernel_impl(TensorIterator &iter) {
   });
 }
 
+static void min_max_kernel_impl(TensorIterator &iter) {
+  AT_DISPATCH_ALL_TYPES(iter.dtype(2), "min_max_cpu", [&] {
+    binary_kernel_reduce(
+      iter,
+      MinMaxOps<scalar_t, std::tuple<scalar_t, scalar_t>>{},
+      std::pair<scalar_t, scalar_t>(upper_bound<scalar_t>(), lower_bound<scalar_t>()));
+  });
+}
+
+// Inclusive scan along `dim` of a contiguous tensor, viewed as
+// [outer, dim_size, inner]. Values are accumulated in acc_t and rounded to
+// scalar_t only when they are stored.
+//
+// A single long row (cumsum of a big 1-D tensor) is scanned in two passes:
+// every thread reduces its own block to a total, the block totals are turned
+// into exclusive offsets serially, and then every thread rescans its block
+// starting from its offset. This reads the input twice, so it is only used
+// when there are too few rows to keep all threads busy otherwise.
+//
+// All other shapes are split across threads by column. Each thread walks its
+// columns down `dim` together, so the innermost loop runs over contiguous
+// elements and is vectorized by the compiler.
+template <typename scalar_t, typename acc_t, typename BinaryOp>
+static void cpu_cum_base_kernel(
+    Tensor& result,
+    const Tensor& self,
+    int64_t dim,
+    acc_t init,
+    BinaryOp op) {
+  int64_t dim_size = self.dim() == 0 ? 1 : self.size(dim);
+  int64_t outer = 1;
+  for (int64_t i = 0; i < dim; i++) {
+    outer *= self.size(i);
+  }
+  int64_t inner = self.numel() / (outer * dim_size);
+
+  const scalar_t* self_data = self.data_ptr<scalar_t>();
+  scalar_t* result_data = result.data_ptr<scalar_t>();
+
+  int64_t num_threads = at::get_num_threads();
+  if (inner == 1 && outer < num_threads &&
+      dim_size >= 2 * at::internal::GRAIN_SIZE) {
+    int64_t num_blocks = std::min<int64_t>(
+        num_threads, at::divup(dim_size, at::internal::GRAIN_SIZE));
+    int64_t block_size = at::divup(dim_size, num_blocks);
+    std::vector<acc_t> offsets(num_blocks);
+    for (int64_t o = 0; o < outer; o++) {
+      const scalar_t* self_row = self_data + o * dim_size;
+      scalar_t* result_row = result_data + o * dim_size;
+      at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          int64_t i_end = std::min(dim_size, (b + 1) * block_size);
+          acc_t acc = init;
+          for (int64_t i = b * block_size; i < i_end; i++) {
+            acc = op(acc, static_cast<acc_t>(self_row[i]));
+          }
+          offsets[b] = acc;
+        }
+      });
+      acc_t acc = init;
+      for (int64_t b = 0; b < num_blocks; b++) {
+        acc_t total = offsets[b];
+        offsets[b] = acc;
+        acc = op(acc, total);
+      }
+      at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          int64_t i_end = std::min(dim_size, (b + 1) * block_size);
+          acc_t acc = offsets[b];
+          for (int64_t i = b * block_size; i < i_end; i++) {
+            acc = op(acc, static_cast<acc_t>(self_row[i]));
+            result_row[i] = static_cast<scalar_t>(acc);
+          }
+        }
+      });
+    }
+    return;
+  }
+
+  int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / dim_size);
+  at::parallel_for(0, outer * inner, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> acc;
+    for (int64_t col = begin; col < end;) {
+      int64_t o = col / inner;
+      int64_t j_begin = col % inner;
+      int64_t j_end = std::min(inner, j_begin + (end - col));
+      int64_t len = j_end - j_begin;
+      acc.assign(len, init);
+      acc_t* acc_data = acc.data();
+      const scalar_t* self_ptr = self_data + o * dim_size * inner + j_begin;
+      scalar_t* result_ptr = result_data + o * dim_size * inner + j_begin;
+      for (int64_t i = 0; i < dim_size; i++) {
+        for (int64_t j = 0; j < len; j++) {
+          acc_data[j] = op(acc_data[j], static_cast<acc_t>(self_ptr[j]));
+          result_ptr[j] = static_cast<scalar_t>(acc_data[j]);
+        }
+        self_ptr += inner;
+        result_ptr += inner;
+      }
+      col += len;
+    }
+  });
+}
+
+static void cumsum_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim) {
+  AT_DISPATCH_ALL_TYPES_AND2(kBool, kBFloat16, self.scalar_type(), "cumsum_cpu", [&] {
+    using acc_t = acc_type<scalar_t, false>;
+    cpu_cum_base_kernel<scalar_t>(result, self, dim, acc_t(0), std::plus<acc_t>());
+  });
+}
+
+static void cumprod_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim) {
+  AT_DISPATCH_ALL_TYPES_AND2(kBool, kBFloat16, self.scalar_type(), "cumprod_cpu", [&] {
+    using acc_t = acc_type<scalar_t, false>;
+    cpu_cum_base_kernel<scalar_t>(result, self, dim, acc_t(1), std::multiplies<acc_t>());
+  });
+}
+
 }  // anonymous namespace
 
 REGISTER_DISPATCH(sum_stub, &sum_kernel_impl);
@@ -220,5 +342,8 @@ REGISTER_DISPATCH(min_values_stub, &min_values_kernel_impl);
 REGISTER_DISPATCH(max_values_stub, &max_values_kernel_impl);
 REGISTER_DISPATCH(argmax_stub, &argmax_kernel_impl);
 REGISTER_DISPATCH(argmin_stub, &argmin_kernel_impl);
+REGISTER_DISPATCH(min_max_stub, &min_max_kernel_impl);
+REGISTER_DISPATCH(cumsum_stub, &cumsum_cpu_kernel);
+REGISTER_DISPATCH(cumprod_stub, &cumprod_cpu_kernel);
 
 }}  // namespace at::native
@@ -1,5 +1,7 @@
 #include <ATen/native/ScatterGatherShapeChecks.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/Dispatch.h>
+#include <ATen/MemoryOverlap.h>
 #include <ATen/Parallel.h>
 
 namespace at { namespace native {
@@ -149,12 +151,47 @@ void cpu_scatter_gather_base_kernel(
       if (serial_exec) {
         iter.serial_for_each(loop, {0, iter.numel()});
       } else {
-        iter.for_each(loop);
+        // Every element of `iter` walks a whole line of `index` along `dim`,
+        // so the grain size is scaled down by the length of that line.
+        int64_t grain_size = std::max<int64_t>(
+          1, at::internal::GRAIN_SIZE / ensure_nonempty_size(index, dim));
+        at::parallel_for(0, iter.numel(), grain_size, [&](int64_t begin, int64_t end) {
+          iter.serial_for_each(loop, {begin, end});
+        });
       }
     }
   );
 }
 
+void scatter_add_1d_by_destination(Tensor& self, const Tensor& index, const Tensor& src) {
+  int64_t self_size = ensure_nonempty_size(self, 0);
+  int64_t self_stride = ensure_nonempty_stride(self, 0);
+  int64_t index_size = ensure_nonempty_size(index, 0);
+  int64_t index_stride = ensure_nonempty_stride(index, 0);
+  int64_t src_stride = ensure_nonempty_stride(src, 0);
+  const int64_t* index_data = index.data_ptr<int64_t>();
+
+  AT_DISPATCH_ALL_TYPES_AND2(
+    ScalarType::Bool, ScalarType::Half, self.scalar_type(),
+    "scatter_add_", [&] {
+      scalar_t* self_data = self.data_ptr<scalar_t>();
+      const scalar_t* src_data = src.data_ptr<scalar_t>();
+      int64_t grain_size = divup(self_size, at::get_num_threads());
+      at::parallel_for(0, self_size, grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t i = 0; i < index_size; ++i) {
+          int64_t idx = index_data[i * index_stride];
+          TORCH_CHECK(idx >= 0 && idx < self_size,
+                      "index ", index_data[i * index_stride], " is out of bounds for dimension 0",
+                      " with size ", self_size);
+          if (idx >= begin && idx < end) {
+            self_data[idx * self_stride] += src_data[i * src_stride];
+          }
+        }
+      });
+    }
+  );
+}
+
 void gather_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
   if (index.numel() == 0) {
     return;
@@ -199,6 +236,19 @@ void scatter_add_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, cons
   int64_t index_dim_size = ensure_nonempty_size(index, dim);
   int64_t self_dim_size = ensure_nonempty_size(self, dim);
 
+  // Different elements of the iterator below update different lines of
+  // `self`, so they can run in parallel unless `self` overlaps itself.
+  bool serial_exec = has_internal_overlap(self) == MemOverlap::YES;
+
+  // A one-dimensional scatter is a single line, so split it by destination
+  // instead: every thread scans all of `index` and only adds into its own
+  // range of `self`.
+  if (!serial_exec && ensure_nonempty_dim(self.dim()) == 1 &&
+      index_dim_size >= at::internal::GRAIN_SIZE && at::get_num_threads() > 1) {
+    scatter_add_1d_by_destination(self, index, src);
+    return;
+  }
+
   cpu_scatter_gather_base_kernel(
     self, dim, index, src,
     "scatter_add_", [&] (
@@ -215,8 +265,7 @@ void scatter_add_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, cons
                     " with size ", self_dim_size);
         self_data[idx_dim * self_dim_stride] += src_data[i * src_dim_stride];
       }
-    },
-      /*serial_exec=*/true);
+    }, serial_exec);
 }
 
 } // anonymous napespace
@@ -0,0 +1,205 @@
+#include <ATen/native/cpu/SmallGemmKernel.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at {
+namespace native {
+namespace {
+
+// Computes a tile of kRows rows and (up to) two vectors of columns of C,
+// keeping the whole tile in registers while going over k. The rows of B are
+// contiguous; A may have any strides since it is read one value at a time.
+// kFull is false for the last columns of a row, which are loaded and stored
+// count0 and count1 at a time.
+template <typename scalar_t, int kRows, bool kFull>
+inline void small_gemm_tile(
+    int64_t k,
+    const scalar_t* a,
+    int64_t a_row_stride,
+    int64_t a_col_stride,
+    const scalar_t* b,
+    int64_t b_row_stride,
+    scalar_t* c,
+    int64_t c_row_stride,
+    int64_t count0,
+    int64_t count1,
+    scalar_t alpha,
+    scalar_t beta) {
+  using Vec = vec256::Vec256<scalar_t>;
+  Vec acc0[kRows];
+  Vec acc1[kRows];
+  for (int r = 0; r < kRows; r++) {
+    acc0[r] = Vec(0);
+    acc1[r] = Vec(0);
+  }
+  for (int64_t l = 0; l < k; l++) {
+    const scalar_t* b_row = b + l * b_row_stride;
+    const Vec b0 = kFull ? Vec::loadu(b_row) : Vec::loadu(b_row, count0);
+    const Vec b1 = kFull ? Vec::loadu(b_row + Vec::size())
+                         : Vec::loadu(b_row + Vec::size(), count1);
+    for (int r = 0; r < kRows; r++) {
+      const Vec a_val(a[r * a_row_stride + l * a_col_stride]);
+      acc0[r] = acc0[r] + a_val * b0;
+      acc1[r] = acc1[r] + a_val * b1;
+    }
+  }
+  const Vec alpha_vec(alpha);
+  const Vec beta_vec(beta);
+  for (int r = 0; r < kRows; r++) {
+    scalar_t* c_row = c + r * c_row_stride;
+    Vec out0 = alpha_vec * acc0[r];
+    Vec out1 = alpha_vec * acc1[r];
+    // like BLAS, C is not read when beta is 0, so that NaN in it is ignored
+    if (beta != scalar_t(0)) {
+      out0 = out0 + beta_vec * (kFull ? Vec::loadu(c_row) : Vec::loadu(c_row, count0));
+      out1 = out1 + beta_vec *
+          (kFull ? Vec::loadu(c_row + Vec::size()) : Vec::loadu(c_row + Vec::size(), count1));
+    }
+    if (kFull) {
+      out0.store(c_row);
+      out1.store(c_row + Vec::size());
+    } else {
+      out0.store(c_row, count0);
+      out1.store(c_row + Vec::size(), count1);
+    }
+  }
+}
+
+template <typename scalar_t, int kRows>
+inline void small_gemm_rows(
+    int64_t n,
+    int64_t k,
+    const scalar_t* a,
+    int64_t a_row_stride,
+    int64_t a_col_stride,
+    const scalar_t* b,
+    int64_t b_row_stride,
+    scalar_t* c,
+    int64_t c_row_stride,
+    scalar_t alpha,
+    scalar_t beta) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr int64_t kTileCols = 2 * Vec::size();
+  int64_t j = 0;
+  for (; j + kTileCols <= n; j += kTileCols) {
+    small_gemm_tile<scalar_t, kRows, true>(
+        k, a, a_row_stride, a_col_stride, b + j, b_row_stride,
+        c + j, c_row_stride, Vec::size(), Vec::size(), alpha, beta);
+  }
+  if (j < n) {
+    const int64_t count0 = std::min<int64_t>(Vec::size(), n - j);
+    const int64_t count1 = n - j - count0;
+    small_gemm_tile<scalar_t, kRows, false>(
+        k, a, a_row_stride, a_col_stride, b + j, b_row_stride,
+        c + j, c_row_stride, count0, count1, alpha, beta);
+  }
+}
+
+template <typename scalar_t>
+void small_gemm(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    const scalar_t* a,
+    int64_t a_row_stride,
+    int64_t a_col_stride,
+    const scalar_t* b,
+    int64_t b_row_stride,
+    scalar_t* c,
+    int64_t c_row_stride,
+    scalar_t alpha,
+    scalar_t beta) {
+  constexpr int64_t kTileRows = 4;
+  int64_t i = 0;
+  for (; i + kTileRows <= m; i += kTileRows) {
+    small_gemm_rows<scalar_t, kTileRows>(
+        n, k, a + i * a_row_stride, a_row_stride, a_col_stride, b,
+        b_row_stride, c + i * c_row_stride, c_row_stride, alpha, beta);
+  }
+  // remaining rows
+  const scalar_t* a_tail = a + i * a_row_stride;
+  scalar_t* c_tail = c + i * c_row_stride;
+  switch (m - i) {
+    case 3:
+      small_gemm_rows<scalar_t, 3>(
+          n, k, a_tail, a_row_stride, a_col_stride, b, b_row_stride,
+          c_tail, c_row_stride, alpha, beta);
+      break;
+    case 2:
+      small_gemm_rows<scalar_t, 2>(
+          n, k, a_tail, a_row_stride, a_col_stride, b, b_row_stride,
+          c_tail, c_row_stride, alpha, beta);
+      break;
+    case 1:
+      small_gemm_rows<scalar_t, 1>(
+          n, k, a_tail, a_row_stride, a_col_stride, b, b_row_stride,
+          c_tail, c_row_stride, alpha, beta);
+      break;
+    default:
+      break;
+  }
+}
+
+void small_gemm_kernel(
+    Tensor& result,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    Scalar beta_,
+    Scalar alpha_) {
+  const bool batched = result.dim() == 3;
+  const int64_t batch_size = batched ? result.size(0) : 1;
+  const int64_t m = mat1.size(-2);
+  const int64_t k = mat1.size(-1);
+  const int64_t n = mat2.size(-1);
+  // the batch strides of 2D operands are never used
+  const int64_t a_batch_stride = batched ? mat1.stride(0) : 0;
+  const int64_t b_batch_stride = batched ? mat2.stride(0) : 0;
+  const int64_t c_batch_stride = batched ? result.stride(0) : 0;
+  // The tiles load whole rows of B, whose columns are copied together first
+  // if they are not contiguous (e.g. when mat2 is transposed).
+  const bool pack_b = mat2.stride(-1) != 1 && n > 1;
+
+  AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "small_gemm", [&] {
+    const scalar_t alpha = alpha_.to<scalar_t>();
+    const scalar_t beta = beta_.to<scalar_t>();
+    const scalar_t* a_data = mat1.data_ptr<scalar_t>();
+    const scalar_t* b_data = mat2.data_ptr<scalar_t>();
+    scalar_t* c_data = result.data_ptr<scalar_t>();
+    const int64_t grain_size =
+        std::max<int64_t>(1, internal::GRAIN_SIZE / (m * n * k));
+    at::parallel_for(0, batch_size, grain_size, [&](int64_t begin, int64_t end) {
+      std::vector<scalar_t> b_buffer(pack_b ? k * n : 0);
+      for (int64_t bi = begin; bi < end; bi++) {
+        const scalar_t* b = b_data + bi * b_batch_stride;
+        int64_t b_row_stride = mat2.stride(-2);
+        if (pack_b) {
+          for (int64_t l = 0; l < k; l++) {
+            for (int64_t j = 0; j < n; j++) {
+              b_buffer[l * n + j] = b[l * mat2.stride(-2) + j * mat2.stride(-1)];
+            }
+          }
+          b = b_buffer.data();
+          b_row_stride = n;
+        }
+        small_gemm<scalar_t>(
+            m, n, k,
+            a_data + bi * a_batch_stride, mat1.stride(-2), mat1.stride(-1),
+            b, b_row_stride,
+            c_data + bi * c_batch_stride, result.stride(-2),
+            alpha, beta);
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(small_gemm_stub, &small_gemm_kernel);
+
+} // namespace native
+} // namespace at
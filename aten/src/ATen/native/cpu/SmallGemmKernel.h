@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+/*
+  Matrix products of small float and double matrices, which are dominated by
+  the per call overhead of BLAS.
+*/
+
+namespace at {
+namespace native {
+
+// result = beta * result + alpha * mat1 @ mat2 for 2D operands, or for every
+// item of 3D (batched) operands. result must have unit stride in its last
+// dimension and must not overlap mat1 or mat2; it is not read when beta is 0.
+using small_gemm_fn = void (*)(Tensor&, const Tensor&, const Tensor&, Scalar, Scalar);
+
+DECLARE_DISPATCH(small_gemm_fn, small_gemm_stub);
+
+}  // namespace native
+}  // namespace at
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <numeric>
 
 #include <ATen/Dispatch.h>
@@ -184,6 +185,143 @@ inline void _vec_host_softmax_backward_lastdim(
       });
 }
 
+// Fused log_softmax + nll_loss over the last dimension. Each row is read once:
+// every lane keeps the running max of the values it has seen and the sum of
+// their exponentials relative to that max. Since one of the two exponents in
+// the update is always zero, rescaling the sum costs a single exp of
+// -|x - max| per value. The per row results are the weighted losses, the log
+// of the softmax denominator (kept for backward) and the weight of the target.
+template <typename scalar_t>
+inline void _vec_cross_entropy_lastdim(
+    scalar_t* losses_data,
+    scalar_t* lse_data,
+    scalar_t* target_weight_data,
+    scalar_t* input_data_base,
+    int64_t* target_data,
+    scalar_t* weight_data,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t ignore_index) {
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          scalar_t* input_data = input_data_base + i * dim_size;
+          // Start from the lowest finite value rather than -inf, so that -inf
+          // inputs give exp(-inf) = 0 instead of exp(-inf + inf) = NaN.
+          Vec max_vec(std::numeric_limits<scalar_t>::lowest());
+          Vec sum_vec(0);
+          auto update = [&](const Vec& x) {
+            Vec e = (x - max_vec).abs().neg().exp();
+            Vec is_new_max = x > max_vec;
+            sum_vec = Vec::blendv(sum_vec + e, sum_vec * e + Vec(1), is_new_max);
+            max_vec = Vec::blendv(max_vec, x, is_new_max);
+          };
+          int64_t d = 0;
+          for (; d < dim_size - (dim_size % Vec::size()); d += Vec::size()) {
+            update(Vec::loadu(input_data + d));
+          }
+          if (dim_size - d > 0) {
+            update(Vec::set(
+                Vec(-std::numeric_limits<scalar_t>::infinity()),
+                Vec::loadu(input_data + d, dim_size - d),
+                dim_size - d));
+          }
+          scalar_t max_input = vec256::vec_reduce_all<scalar_t>(
+              [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+              max_vec,
+              Vec::size());
+          // the lanes are combined relative to the max of the whole row
+          lse_data[i] = max_input;
+          losses_data[i] = vec256::vec_reduce_all<scalar_t>(
+              [](Vec& x, Vec& y) { return x + y; },
+              sum_vec * (max_vec - Vec(max_input)).exp(),
+              Vec::size());
+        }
+        // See [Note AVX-SSE transitions] for why this should call the
+        // vectorized version (aside from perf improvements).
+        vec256::map(
+            [](Vec x) { return x.log(); },
+            losses_data + begin,
+            losses_data + begin,
+            end - begin);
+        for (int64_t i = begin; i < end; i++) {
+          const scalar_t max_input = lse_data[i];
+          const scalar_t log_sum = losses_data[i];
+          lse_data[i] = max_input + log_sum;
+
+          const auto cur_target = target_data[i];
+          if (cur_target == ignore_index) {
+            losses_data[i] = 0;
+            target_weight_data[i] = 0;
+            continue;
+          }
+          TORCH_CHECK_INDEX(
+              cur_target >= 0 && cur_target < dim_size,
+              "Target ",
+              cur_target,
+              " is out of bounds.");
+          const scalar_t cur_weight = weight_data != nullptr
+              ? weight_data[cur_target]
+              : static_cast<scalar_t>(1);
+          // Same order of operations as in _vec_log_softmax_lastdim.
+          losses_data[i] =
+              -(input_data_base[i * dim_size + cur_target] - max_input - log_sum) * cur_weight;
+          target_weight_data[i] = cur_weight;
+        }
+      });
+}
+
+// The gradient of row i is
+//   grad_losses[i] * target_weight[i] * (softmax(input[i]) - one_hot(target[i]))
+// which is written in one pass from the input and the saved log denominator.
+template <typename scalar_t>
+inline void _vec_cross_entropy_backward_lastdim(
+    scalar_t* grad_input_data_base,
+    scalar_t* grad_losses_data,
+    scalar_t* input_data_base,
+    int64_t* target_data,
+    scalar_t* lse_data,
+    scalar_t* target_weight_data,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          scalar_t* grad_input_data = grad_input_data_base + i * dim_size;
+          scalar_t* input_data = input_data_base + i * dim_size;
+          const scalar_t scale = grad_losses_data[i] * target_weight_data[i];
+          // also covers the ignored rows, whose target may not be a class
+          if (scale == 0) {
+            std::fill(grad_input_data, grad_input_data + dim_size, static_cast<scalar_t>(0));
+            continue;
+          }
+          const scalar_t lse = lse_data[i];
+          vec256::map(
+              [scale, lse](Vec x) { return (x - Vec(lse)).exp() * Vec(scale); },
+              grad_input_data,
+              input_data,
+              dim_size);
+          grad_input_data[target_data[i]] -= scale;
+        }
+      });
+}
+
 template <typename scalar_t, bool LogSoftMax>
 struct vec_host_softmax_lastdim {
   static void apply(Tensor& output, const Tensor& input) {
@@ -261,6 +399,50 @@ static void log_softmax_backward_lastdim_kernel_impl(
       });
 }
 
+static void cross_entropy_lastdim_kernel_impl(
+    Tensor& losses,
+    Tensor& lse,
+    Tensor& target_weight,
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index) {
+  AT_DISPATCH_FLOATING_TYPES(
+      input.scalar_type(), "cross_entropy_lastdim_kernel_impl", [&] {
+        _vec_cross_entropy_lastdim<scalar_t>(
+            losses.data_ptr<scalar_t>(),
+            lse.data_ptr<scalar_t>(),
+            target_weight.data_ptr<scalar_t>(),
+            input.data_ptr<scalar_t>(),
+            target.data_ptr<int64_t>(),
+            weight.defined() ? weight.data_ptr<scalar_t>() : nullptr,
+            input.size(0),
+            input.size(1),
+            ignore_index);
+      });
+}
+
+static void cross_entropy_backward_lastdim_kernel_impl(
+    Tensor& grad_input,
+    const Tensor& grad_losses,
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& lse,
+    const Tensor& target_weight) {
+  AT_DISPATCH_FLOATING_TYPES(
+      input.scalar_type(), "cross_entropy_backward_lastdim_kernel_impl", [&] {
+        _vec_cross_entropy_backward_lastdim<scalar_t>(
+            grad_input.data_ptr<scalar_t>(),
+            grad_losses.data_ptr<scalar_t>(),
+            input.data_ptr<scalar_t>(),
+            target.data_ptr<int64_t>(),
+            lse.data_ptr<scalar_t>(),
+            target_weight.data_ptr<scalar_t>(),
+            input.size(0),
+            input.size(1));
+      });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(softmax_lastdim_kernel, &softmax_lastdim_kernel_impl);
@@ -271,5 +453,9 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     log_softmax_backward_lastdim_kernel,
     &log_softmax_backward_lastdim_kernel_impl);
+REGISTER_DISPATCH(cross_entropy_lastdim_kernel, &cross_entropy_lastdim_kernel_impl);
+REGISTER_DISPATCH(
+    cross_entropy_backward_lastdim_kernel,
+    &cross_entropy_backward_lastdim_kernel_impl);
 
 }} // namespace at::native
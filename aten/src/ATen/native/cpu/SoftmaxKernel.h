@@ -14,5 +14,13 @@ DECLARE_DISPATCH(forward_fn, log_softmax_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, softmax_backward_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, log_softmax_backward_lastdim_kernel);
 
+// losses, lse, target_weight, input, target, weight, ignore_index
+using cross_entropy_fn = void(*)(Tensor &, Tensor &, Tensor &, const Tensor &, const Tensor &, const Tensor &, int64_t);
+// grad_input, grad_losses, input, target, lse, target_weight
+using cross_entropy_backward_fn = void(*)(Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &);
+
+DECLARE_DISPATCH(cross_entropy_fn, cross_entropy_lastdim_kernel);
+DECLARE_DISPATCH(cross_entropy_backward_fn, cross_entropy_backward_lastdim_kernel);
+
 }
 }
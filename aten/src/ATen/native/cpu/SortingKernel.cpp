@@ -9,77 +9,142 @@ namespace at { namespace native {
 
 namespace {
 
-static void topk_kernel(
+// The order of the topk results: NaN is larger than any other value for numpy
+// compatibility.
+template <typename scalar_t>
+struct TopKGreater {
+  bool operator()(const std::pair<scalar_t, int64_t>& x, const std::pair<scalar_t, int64_t>& y) const {
+    return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
+  }
+};
+
+template <typename scalar_t>
+struct TopKLess {
+  bool operator()(const std::pair<scalar_t, int64_t>& x, const std::pair<scalar_t, int64_t>& y) const {
+    return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
+  }
+};
+
+// Puts the first min(k, end - begin) elements of values[begin:end] in the
+// order of `comp` into `queue`, with their indices. They are sorted if
+// `sorted` or if k is small.
+template <typename scalar_t, typename Comp>
+static void topk_select(
+    TensorAccessor<scalar_t, 1> values,
+    int64_t begin,
+    int64_t end,
+    int64_t k,
+    bool sorted,
+    Comp comp,
+    std::vector<std::pair<scalar_t, int64_t>>& queue) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  const int64_t n = end - begin;
+  k = std::min(k, n);
+  queue.clear();
+  if (k == 0) {
+    return;
+  }
+  if (k * 64 <= n) {
+    // For a small k, keep the top k elements seen so far in a heap with the
+    // last of them at the front, instead of copying the whole slice.
+    queue.reserve(k);
+    for (int64_t j = begin; j < begin + k; j++) {
+      queue.emplace_back(values[j], j);
+    }
+    std::make_heap(queue.begin(), queue.end(), comp);
+    for (int64_t j = begin + k; j < end; j++) {
+      const elem_t elem(values[j], j);
+      if (comp(elem, queue.front())) {
+        std::pop_heap(queue.begin(), queue.end(), comp);
+        queue.back() = elem;
+        std::push_heap(queue.begin(), queue.end(), comp);
+      }
+    }
+    std::sort_heap(queue.begin(), queue.end(), comp);
+    return;
+  }
+
+  queue.resize(n);
+  for (int64_t j = 0; j < n; j++) {
+    queue[j].first = values[begin + j];
+    queue[j].second = begin + j;
+  }
+  std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(), comp);
+  if (sorted) {
+    std::sort(queue.begin(), queue.begin() + k - 1, comp);
+  }
+  queue.resize(k);
+}
+
+template <typename scalar_t, typename Comp>
+static void topk_impl(
     Tensor& values,
     Tensor& indices,
     const Tensor& self,
     int64_t k,
     int64_t dim,
-    bool largest,
-    bool sorted) {
-  AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
-    dim_apply(
-        {self, values, indices},
-        dim,
-        [&](int64_t i, TensorList tl) {
-          auto tmp_values = tl[0].accessor<scalar_t, 1>();
-          auto mode_values = tl[1].accessor<scalar_t, 1>();
-          auto mode_indices = tl[2].accessor<int64_t, 1>();
+    bool sorted,
+    Comp comp) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  const int64_t n = self.dim() > 0 ? self.size(dim) : 1;
+  const int64_t num_slices = self.numel() / n;
 
-          auto n = tmp_values.size(0);
-          auto use_partial_sort = k * 64 <= n;
+  auto write_results = [k](const std::vector<elem_t>& queue, TensorList tl) {
+    auto mode_values = tl[1].accessor<scalar_t, 1>();
+    auto mode_indices = tl[2].accessor<int64_t, 1>();
+    for (int64_t j = 0; j < k; j++) {
+      mode_values[j] = queue[j].first;
+      mode_indices[j] = queue[j].second;
+    }
+  };
 
-          using elem_t = std::pair<scalar_t, int64_t>;
-          std::vector<elem_t> queue(n);
-          for (int64_t j = 0; j < n; j++) {
-            queue[j].first = tmp_values[j];
-            queue[j].second = j;
-          }
+  // A single large slice, e.g. all scores of a query, is split into chunks.
+  // The top k elements of every chunk are found in parallel, and the top k
+  // of these candidates are the result.
+  const int64_t num_chunks = std::min<int64_t>(
+      at::get_num_threads(), n / std::max(internal::GRAIN_SIZE, k * 64));
+  if (num_slices == 1 && num_chunks > 1 && !at::in_parallel_region()) {
+    dim_apply({self, values, indices}, dim, [&](int64_t i, TensorList tl) {
+      auto tmp_values = tl[0].accessor<scalar_t, 1>();
+      std::vector<std::vector<elem_t>> candidates(num_chunks);
+      at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t chunk = begin; chunk < end; chunk++) {
+          topk_select(
+              tmp_values, n * chunk / num_chunks, n * (chunk + 1) / num_chunks,
+              k, sorted, comp, candidates[chunk]);
+        }
+      });
+      std::vector<elem_t> queue;
+      for (const auto& chunk_candidates : candidates) {
+        queue.insert(queue.end(), chunk_candidates.begin(), chunk_candidates.end());
+      }
+      std::partial_sort(queue.begin(), queue.begin() + k, queue.end(), comp);
+      write_results(queue, tl);
+    });
+    return;
+  }
 
-          // we want NaN to be sorted as top for numpy compatibility
-          if (use_partial_sort) {
-            if (largest) {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-            } else {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-            }
-          } else {
-            if (largest) {
-              std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k - 1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                  });
-              }
-            } else {
-              std::nth_element(queue.begin(), queue.begin() + k -1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k -1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                  });
-              }
-            }
-          }
+  dim_apply({self, values, indices}, dim, [&](int64_t i, TensorList tl) {
+    std::vector<elem_t> queue;
+    topk_select(tl[0].accessor<scalar_t, 1>(), 0, n, k, sorted, comp, queue);
+    write_results(queue, tl);
+  });
+}
 
-          for (int64_t j = 0; j < k; j++) {
-            mode_values[j] = queue[j].first;
-            mode_indices[j] = queue[j].second;
-          }
-        });
+static void topk_kernel(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t k,
+    int64_t dim,
+    bool largest,
+    bool sorted) {
+  AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
+    if (largest) {
+      topk_impl<scalar_t>(values, indices, self, k, dim, sorted, TopKGreater<scalar_t>());
+    } else {
+      topk_impl<scalar_t>(values, indices, self, k, dim, sorted, TopKLess<scalar_t>());
+    }
   });
 }
 
@@ -20,10 +20,7 @@
 #include <ATen/native/Math.h>
 #include <ATen/core/DistributionsHelper.h>
 #include <ATen/native/cpu/DistributionTemplates.h>
-
-#if AT_MKL_ENABLED()
-#include <mkl.h>
-#endif
+#include <ATen/native/cpu/PhiloxSampler.h>
 
 namespace at { namespace native {
 namespace {
@@ -31,7 +28,7 @@ namespace {
 using namespace vec256;
 
 static void sigmoid_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "sigmoid_cpu", [&]() {
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), "sigmoid_cpu", [&]() {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t { return ((scalar_t)(1) / ((scalar_t)(1) + std::exp((-a)))); },
@@ -138,7 +135,7 @@ static void logical_not_kernel(TensorIterator& iter) {
 }
 
 static void reciprocal_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "reciprocal_cpu", [&]() {
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), "reciprocal_cpu", [&]() {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t { return decltype(a)(1.0) / a; },
@@ -147,7 +144,7 @@ static void reciprocal_kernel(TensorIterator& iter) {
 }
 
 static void neg_kernel(TensorIterator& iter) {
-  AT_DISPATCH_ALL_TYPES_AND_COMPLEX(iter.dtype(), "neg_cpu", [&]() {
+  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND(kBFloat16, iter.dtype(), "neg_cpu", [&]() {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t { return -a; },
@@ -258,65 +255,6 @@ static void cauchy_kernel(TensorIterator& iter, double median, double sigma, Gen
   templates::cauchy_kernel(iter, median, sigma, generator);
 }
 
-#if !AT_MKL_ENABLED()
-void bernoulli_mkl_kernel(Tensor &output, const double p, Generator* gen) {
-  // Use AT_ASSERTM because this should never be reached, and AT_ASSERTM tells
-  // users to report this as a bug.
-  AT_ASSERTM(false, "ATen not compiled with MKL");
-}
-#else
-void bernoulli_mkl_kernel(Tensor &self, const double p, Generator* gen) {
-  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-  int64_t seed;
-  {
-    // See Note [Acquire lock when using random generators]
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    seed = generator->random();
-  }
-  int64_t n = self.numel();
-  bool contig = self.is_contiguous();
-
-  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
-    at::Tensor tmp_int_tensor;
-    if (std::is_same<scalar_t, int>::value && contig) {
-      tmp_int_tensor = self;
-    } else {
-      tmp_int_tensor = at::empty(self.sizes(), self.options().dtype(at::kInt));
-    }
-
-    scalar_t *self_ptr = self.data_ptr<scalar_t>();
-    int *sample_int_ptr = tmp_int_tensor.data_ptr<int>();
-
-    auto sample = [&](int64_t begin, int64_t end) {
-      int64_t len = end - begin;
-      if (len > 0) {
-        VSLStreamStatePtr stream;
-        vslNewStream(&stream, VSL_BRNG_MCG31, seed);
-        vslSkipAheadStream(stream, begin);
-        viRngBernoulli(VSL_RNG_METHOD_BERNOULLI_ICDF, stream, len,
-          sample_int_ptr + begin, p);
-        vslDeleteStream(&stream);
-
-        // vectorized copy if using buffer and contiguous, i.e., being non-int
-        // type and contiguous
-        if (!std::is_same<scalar_t, int>::value && contig) {
-          scalar_t *self_seg = self_ptr + begin;
-          int* tmp_seg = sample_int_ptr + begin;
-          at::vec256::convert<int, scalar_t>(tmp_seg, self_seg, len);
-        }
-      }
-    };
-
-    parallel_for(0, n, /* grain_size= */ 800, sample);
-
-    // copy_ if using buffer and non contiguous
-    if (!contig) {
-      self.copy_(tmp_int_tensor);
-    }
-  });
-}
-#endif
-
 static void exponential_kernel(TensorIterator& iter, double lambda, Generator* gen) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "exponential_cpu", [&]() {
     CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
@@ -350,123 +288,106 @@ static void log_normal_kernel(TensorIterator& iter, double mean, double std, Gen
   });
 }
 
-#ifdef __AVX2__
-#include <ATen/native/cpu/avx_mathfun.h>
-
-static void normal_fill_16_AVX2(float *data,
-                         const __m256* two_pi,
-                         const __m256* one,
-                         const __m256* minus_two,
-                         const __m256* mean,
-                         const __m256* std_v) {
-  const __m256 u1 = _mm256_sub_ps(*one, _mm256_loadu_ps(data));
-  const __m256 u2 = _mm256_loadu_ps(data + 8);
-  // sincos256_ps and log256_ps are from avx_mathfun.h
-  const __m256 radius = _mm256_sqrt_ps(_mm256_mul_ps(*minus_two, log256_ps(u1)));
-  const __m256 theta = _mm256_mul_ps(*two_pi, u2);
-  __m256 sintheta, costheta;
-  sincos256_ps(theta, &sintheta, &costheta);
-  const __m256 n1 = _mm256_mul_ps(radius, costheta);
-  const __m256 n2 = _mm256_mul_ps(radius, sintheta);
-  _mm256_storeu_ps(data, _mm256_fmadd_ps(n1, *std_v, *mean));
-  _mm256_storeu_ps(data + 8, _mm256_fmadd_ps(n2, *std_v, *mean));
+// The CPU kernels of uniform_, normal_ and bernoulli_(p) sample from a philox
+// stream drawn from the generator, see PhiloxSampler.h. Outputs that are not contiguous are
+// sampled into a contiguous buffer and copied.
+template <typename scalar_t, typename fill_t>
+void philox_fill(Tensor& self, const fill_t& fill) {
+  Tensor out = self.is_contiguous() ? self : at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  fill(out.data_ptr<scalar_t>(), out.numel());
+  if (!out.is_same(self)) {
+    self.copy_(out);
+  }
 }
 
-void normal_fill_AVX2(Tensor& self, const float mean, const float std, Generator* gen) {
-  float *data = self.data_ptr<float>();
-  auto size = self.numel();
+static void uniform_kernel(Tensor& self, double from_, double to_, Generator* gen) {
   CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-  std::lock_guard<std::mutex> lock(generator->mutex_);
-  for (int64_t i = 0; i < size; ++i) {
-    at::uniform_real_distribution<float> uniform(0, 1);
-    data[i] = uniform(generator);
-  }
-   const __m256 two_pi = _mm256_set1_ps(2.0f * M_PI);
-  const __m256 one = _mm256_set1_ps(1.0f);
-  const __m256 minus_two = _mm256_set1_ps(-2.0f);
-  const __m256 mean_v = _mm256_set1_ps(mean);
-  const __m256 std_v = _mm256_set1_ps(std);
-
-  for (int64_t i = 0; i < size - 15; i += 16) {
-    normal_fill_16_AVX2(data + i, &two_pi, &one, &minus_two, &mean_v, &std_v);
-  }
-
-  if (size % 16 != 0) {
-    // Recompute the last 16 values.
-    data = data + size - 16;
-    for (int64_t i = 0; i < 16; ++i) {
-      at::uniform_real_distribution<float> uniform(0, 1);
-      data[i] = uniform(generator);
-    }
-    normal_fill_16_AVX2(data, &two_pi, &one, &minus_two, &mean_v, &std_v);
-  }
-}
-#endif
-
-template <typename scalar_t>
-static void normal_fill_16(scalar_t *data, const scalar_t mean, const scalar_t std) {
-  for (int j = 0; j < 8; ++j) {
-    const scalar_t u1 = 1 - data[j]; // [0, 1) -> (0, 1] for log.
-    const scalar_t u2 = data[j + 8];
-    const scalar_t radius = std::sqrt(-2 * std::log(u1));
-    const scalar_t theta = 2.0f * M_PI * u2;
-    data[j] = radius * std::cos(theta) * std + mean;
-    data[j + 8] = radius * std::sin(theta) * std + mean;
-  }
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "uniform_cpu", [&] {
+    const auto from = static_cast<scalar_t>(from_);
+    const auto to = static_cast<scalar_t>(to_);
+    TORCH_CHECK(from <= to,
+      "uniform_ expects to return a [from, to) range, but found from=", from,
+      " > to=", to);
+    TORCH_CHECK((to - from) <= std::numeric_limits<scalar_t>::max(),
+      "uniform_ expects to-from <= std::numeric_limits<", toString(self.scalar_type()),
+      ">::max(), but found to=", to, " and from=", from,
+      " which result in to-from to exceed the limit");
+    using Uniform = PhiloxUniform<scalar_t>;
+    const scalar_t range = to - from;
+    const uint64_t seed = philox_seed(generator);
+    philox_fill<scalar_t>(self, [&](scalar_t* data, int64_t n) {
+      philox_parallel_for<Uniform::kWords>(n, seed, internal::GRAIN_SIZE,
+          [&](int64_t begin, int64_t end, const uint32_t* words) {
+        for (int64_t i = begin; i < end; i++) {
+          data[i] = Uniform::sample(words + (i - begin) * Uniform::kWords) * range + from;
+        }
+      });
+    });
+  });
 }
 
-template <typename scalar_t>
-void normal_fill(Tensor& self, const scalar_t mean, const scalar_t std, Generator* gen) {
-  scalar_t *data = self.data_ptr<scalar_t>();
-  auto size = self.numel();
+static void normal_kernel(Tensor& self, double mean_, double std_, Generator* gen) {
   CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-  std::lock_guard<std::mutex> lock(generator->mutex_);
-  for (int64_t i = 0; i < size; ++i) {
-    at::uniform_real_distribution<scalar_t> uniform(0, 1);
-    data[i] = uniform(generator);
-  }
-
-  for (int64_t i = 0; i < size - 15; i += 16) {
-    normal_fill_16<scalar_t>(data + i, mean, std);
-  }
-  if (size % 16 != 0) {
-    // Recompute the last 16 values.
-    data = data + size - 16;
-    for (int64_t i = 0; i < 16; ++i) {
-      at::uniform_real_distribution<scalar_t> uniform(0, 1);
-      data[i] = uniform(generator);
-    }
-    normal_fill_16<scalar_t>(data, mean, std);
-  }
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "normal_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    using Uniform = PhiloxUniform<scalar_t>;
+    const Vec mean_vec(static_cast<scalar_t>(mean_));
+    const Vec std_vec(static_cast<scalar_t>(std_));
+    const Vec minus_two(-2);
+    const Vec two_pi(2 * M_PI);
+    const uint64_t seed = philox_seed(generator);
+    philox_fill<scalar_t>(self, [&](scalar_t* data, int64_t n) {
+      // Box-Muller: every item makes the pair of values 2 * i and 2 * i + 1
+      // out of two uniform values.
+      philox_parallel_for<2 * Uniform::kWords>((n + 1) / 2, seed, internal::GRAIN_SIZE / 2,
+          [&](int64_t begin, int64_t end, const uint32_t* words) {
+        const int64_t len = end - begin;
+        scalar_t u1[kPhiloxChunkItems];
+        scalar_t u2[kPhiloxChunkItems];
+        for (int64_t i = 0; i < len; i++) {
+          // [0, 1) -> (0, 1] for log
+          u1[i] = 1 - Uniform::sample(words + 2 * i * Uniform::kWords);
+          u2[i] = Uniform::sample(words + (2 * i + 1) * Uniform::kWords);
+        }
+        for (int64_t i = 0; i < len; i += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), len - i);
+          const Vec radius = (minus_two * Vec::loadu(u1 + i, count).log()).sqrt();
+          const Vec theta = two_pi * Vec::loadu(u2 + i, count);
+          vec256::fmadd(radius * theta.cos(), std_vec, mean_vec).store(u1 + i, count);
+          vec256::fmadd(radius * theta.sin(), std_vec, mean_vec).store(u2 + i, count);
+        }
+        for (int64_t i = 0; i < len; i++) {
+          data[2 * (begin + i)] = u1[i];
+        }
+        // the second value of the last item is dropped when n is odd
+        const int64_t second_end = std::min(len, n / 2 - begin);
+        for (int64_t i = 0; i < second_end; i++) {
+          data[2 * (begin + i) + 1] = u2[i];
+        }
+      });
+    });
+  });
 }
 
-void normal_kernel(Tensor& self, double mean, double std, Generator* gen) {
-  auto size = self.numel();
-  if (self.scalar_type() == ScalarType::Float && size >= 16 && self.is_contiguous()) {
-#ifdef __AVX2__
-    normal_fill_AVX2(self, static_cast<float>(mean), static_cast<float>(std), gen);
-#else
-    normal_fill(self, static_cast<float>(mean), static_cast<float>(std), gen);
-#endif
-  } else {
-    AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "norma_cpu", [&] {
-      if (size >= 16 && self.is_contiguous()) {
-        normal_fill<scalar_t>(self, static_cast<scalar_t>(mean), static_cast<scalar_t>(std), gen);
-      } else {
-        auto iter = TensorIterator::nullary_op(self);
-        CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
-        std::lock_guard<std::mutex> lock(generator->mutex_);
-        cpu_serial_kernel(iter, [mean, std, generator]() -> scalar_t {
-          at::normal_distribution<double> normal(mean, std);
-          return (scalar_t)normal(generator);
-        });
-      }
+static void bernoulli_scalar_kernel(Tensor& self, double p, Generator* gen) {
+  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  // a random word w gives true with probability p when w < p * 2^32
+  const uint64_t threshold = static_cast<uint64_t>(p * 4294967296.0);
+  const uint64_t seed = philox_seed(generator);
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
+    philox_fill<scalar_t>(self, [&](scalar_t* data, int64_t n) {
+      philox_parallel_for<1>(n, seed, internal::GRAIN_SIZE,
+          [&](int64_t begin, int64_t end, const uint32_t* words) {
+        for (int64_t i = begin; i < end; i++) {
+          data[i] = static_cast<scalar_t>(words[i - begin] < threshold);
+        }
+      });
     });
-  }
+  });
 }
 
 static void rsqrt_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "rsqrt_cpu", [&] {
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), "rsqrt_cpu", [&] {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t {
@@ -481,7 +402,7 @@ static void rsqrt_kernel(TensorIterator& iter) {
 #define IMPLEMENT_FLOAT_KERNEL(dispatchtypes, op)                             \
   static void op##_kernel(TensorIterator& iter) {                             \
     TORCH_INTERNAL_ASSERT(iter.ntensors() == 2);                              \
-    AT_DISPATCH_FLOATING_TYPES(iter.dtype(), op##_vml_cpu, [&]() {            \
+    AT_DISPATCH_FLOATING_TYPES_AND(kBFloat16, iter.dtype(), op##_vml_cpu, [&]() { \
       iter.serial_for_each(                                                   \
           [&](char** data_, const int64_t* strides, int64_t n) { \
             scalar_t* out_data = reinterpret_cast<scalar_t*>(data_[0]);       \
@@ -512,7 +433,7 @@ static void rsqrt_kernel(TensorIterator& iter) {
 #define IMPLEMENT_COMPLEX_KERNEL(dispatchtypes, op)                             \
   static void op##_kernel(TensorIterator& iter) {                             \
     TORCH_INTERNAL_ASSERT(iter.ntensors() == 2);                              \
-    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), op##_vml_cpu, [&]() {\
+    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), op##_vml_cpu, [&]() { \
       iter.serial_for_each(                                                   \
           [&](char** data_, const int64_t* strides, int64_t n) {              \
             scalar_t* out_data = reinterpret_cast<scalar_t*>(data_[0]);       \
@@ -544,12 +465,13 @@ static void rsqrt_kernel(TensorIterator& iter) {
 
 REGISTER_DISPATCH(rsqrt_stub, &rsqrt_kernel);
 REGISTER_DISPATCH(sigmoid_stub, &sigmoid_kernel);
-REGISTER_DISPATCH(bernoulli_mkl_stub, &bernoulli_mkl_kernel);
+REGISTER_DISPATCH(bernoulli_scalar_stub, &bernoulli_scalar_kernel);
 REGISTER_DISPATCH(cauchy_stub, &cauchy_kernel);
 REGISTER_DISPATCH(exponential_stub, &exponential_kernel);
 REGISTER_DISPATCH(geometric_stub, &geometric_kernel);
 REGISTER_DISPATCH(log_normal_stub, &log_normal_kernel);
 REGISTER_DISPATCH(normal_stub, &normal_kernel);
+REGISTER_DISPATCH(uniform_stub, &uniform_kernel);
 REGISTER_DISPATCH(abs_stub, &abs_kernel);
 REGISTER_DISPATCH(angle_stub, &angle_kernel);
 REGISTER_DISPATCH(real_stub, &real_kernel);
@@ -0,0 +1,154 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/UpSample.h>
+
+namespace at { namespace native {
+namespace {
+
+// The source pixels and weights of an output pixel are the same for all its
+// channels, which are contiguous in channels last tensors. They are found
+// once per pixel, and the channels are interpolated Vec256<scalar_t>::size()
+// at a time. The work is split over the output rows of all the batch elements.
+
+template <typename scalar_t>
+void cpu_upsample_nearest_channels_last(
+    Tensor& output,
+    const Tensor& input,
+    c10::optional<double> scales_h,
+    c10::optional<double> scales_w) {
+  using Vec = vec256::Vec256<scalar_t>;
+
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_height = output.size(2);
+  const int64_t output_width = output.size(3);
+
+  const float height_scale = compute_scales_value<float>(scales_h, input_height, output_height);
+  const float width_scale = compute_scales_value<float>(scales_w, input_width, output_width);
+  const bool same_size = input_height == output_height && input_width == output_width;
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(0, nbatch * output_height, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t n = i / output_height;
+      const int64_t oh = i % output_height;
+      const int64_t ih = same_size ? oh
+          : nearest_neighbor_compute_source_index(height_scale, oh, input_height);
+      const scalar_t* input_row = input_data + (n * input_height + ih) * input_width * channels;
+
+      for (int64_t ow = 0; ow < output_width; ow++) {
+        const int64_t iw = same_size ? ow
+            : nearest_neighbor_compute_source_index(width_scale, ow, input_width);
+        const scalar_t* in = input_row + iw * channels;
+        scalar_t* out = output_data + (i * output_width + ow) * channels;
+
+        for (int64_t c = 0; c < channels; c += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+          Vec::loadu(in + c, count).store(out + c, count);
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void cpu_upsample_bilinear_channels_last(
+    Tensor& output,
+    const Tensor& input,
+    bool align_corners,
+    c10::optional<double> scales_h,
+    c10::optional<double> scales_w) {
+  using Vec = vec256::Vec256<scalar_t>;
+
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_height = output.size(2);
+  const int64_t output_width = output.size(3);
+
+  // special case: just copy
+  if (input_height == output_height && input_width == output_width) {
+    output.copy_(input);
+    return;
+  }
+
+  const scalar_t rheight = area_pixel_compute_scale<scalar_t>(
+      input_height, output_height, align_corners, scales_h);
+  const scalar_t rwidth = area_pixel_compute_scale<scalar_t>(
+      input_width, output_width, align_corners, scales_w);
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(0, nbatch * output_height, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t n = i / output_height;
+      const int64_t oh = i % output_height;
+      const scalar_t h1r = area_pixel_compute_source_index<scalar_t>(
+          rheight, oh, align_corners, /*cubic=*/false);
+      const int64_t h1 = h1r;
+      const int64_t h1p = (h1 < input_height - 1) ? 1 : 0;
+      const Vec h1lambda(h1r - h1);
+      const Vec h0lambda(static_cast<scalar_t>(1.) - (h1r - h1));
+      const scalar_t* input_row = input_data + (n * input_height + h1) * input_width * channels;
+
+      for (int64_t ow = 0; ow < output_width; ow++) {
+        const scalar_t w1r = area_pixel_compute_source_index<scalar_t>(
+            rwidth, ow, align_corners, /*cubic=*/false);
+        const int64_t w1 = w1r;
+        const int64_t w1p = (w1 < input_width - 1) ? 1 : 0;
+        const Vec w1lambda(w1r - w1);
+        const Vec w0lambda(static_cast<scalar_t>(1.) - (w1r - w1));
+
+        const scalar_t* in00 = input_row + w1 * channels;
+        const scalar_t* in01 = in00 + w1p * channels;
+        const scalar_t* in10 = in00 + h1p * input_width * channels;
+        const scalar_t* in11 = in10 + w1p * channels;
+        scalar_t* out = output_data + (i * output_width + ow) * channels;
+
+        for (int64_t c = 0; c < channels; c += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+          Vec top = w0lambda * Vec::loadu(in00 + c, count) + w1lambda * Vec::loadu(in01 + c, count);
+          Vec bottom = w0lambda * Vec::loadu(in10 + c, count) + w1lambda * Vec::loadu(in11 + c, count);
+          (h0lambda * top + h1lambda * bottom).store(out + c, count);
+        }
+      }
+    }
+  });
+}
+
+void upsample_nearest2d_channels_last_kernel_impl(
+    Tensor& output,
+    const Tensor& input,
+    c10::optional<double> scales_h,
+    c10::optional<double> scales_w) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "upsample_nearest2d_channels_last", [&] {
+    cpu_upsample_nearest_channels_last<scalar_t>(output, input, scales_h, scales_w);
+  });
+}
+
+void upsample_bilinear2d_channels_last_kernel_impl(
+    Tensor& output,
+    const Tensor& input,
+    bool align_corners,
+    c10::optional<double> scales_h,
+    c10::optional<double> scales_w) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "upsample_bilinear2d_channels_last", [&] {
+    cpu_upsample_bilinear_channels_last<scalar_t>(output, input, align_corners, scales_h, scales_w);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(upsample_nearest2d_channels_last_kernel, &upsample_nearest2d_channels_last_kernel_impl);
+REGISTER_DISPATCH(upsample_bilinear2d_channels_last_kernel, &upsample_bilinear2d_channels_last_kernel_impl);
+
+}} // namespace at::native
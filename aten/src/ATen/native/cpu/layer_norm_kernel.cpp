@@ -1,10 +1,14 @@
 #include <ATen/native/layer_norm.h>
 
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
+#include <vector>
 
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vec256/vec256.h>
 
@@ -13,6 +17,50 @@ namespace native {
 
 namespace {
 
+// BFloat16 rows are converted to float before they are used, so that the
+// moments and the gradients are accumulated in float. Float and double rows
+// are used in place.
+template <typename T>
+struct LayerNormAccType {
+  using type = T;
+};
+
+template <>
+struct LayerNormAccType<BFloat16> {
+  using type = float;
+};
+
+template <typename T>
+const T* RowAsAcc(const T* row, T* /* buffer */, int64_t /* N */) {
+  return row;
+}
+
+const float* RowAsAcc(const BFloat16* row, float* buffer, int64_t N) {
+  for (int64_t j = 0; j < N; ++j) {
+    buffer[j] = static_cast<float>(row[j]);
+  }
+  return buffer;
+}
+
+// Where the results of an output row are written before StoreRow.
+template <typename T>
+T* OutRowAsAcc(T* row, T* /* buffer */) {
+  return row;
+}
+
+float* OutRowAsAcc(BFloat16* /* row */, float* buffer) {
+  return buffer;
+}
+
+template <typename T>
+void StoreRow(const T* /* acc_row */, T* /* row */, int64_t /* N */) {}
+
+void StoreRow(const float* acc_row, BFloat16* row, int64_t N) {
+  for (int64_t j = 0; j < N; ++j) {
+    row[j] = static_cast<BFloat16>(acc_row[j]);
+  }
+}
+
 template <typename T>
 void LayerNormKernelImplInternal(
     const Tensor& X,
@@ -20,48 +68,63 @@ void LayerNormKernelImplInternal(
     const Tensor& beta,
     int64_t M,
     int64_t N,
-    T eps,
+    double eps,
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  using Vec = vec256::Vec256<T>;
+  using T_ACC = typename LayerNormAccType<T>::type;
+  using Vec = vec256::Vec256<T_ACC>;
+  constexpr bool kConvert = !std::is_same<T, T_ACC>::value;
   DCHECK_EQ(X.numel(), M * N);
   DCHECK(!gamma.defined() || gamma.numel() == N);
   DCHECK(!beta.defined() || beta.numel() == N);
-  T* X_data = X.data_ptr<T>();
-  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
-  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  const T* X_data = X.data_ptr<T>();
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
-  const T c = T(1) / static_cast<T>(N);
+  std::vector<T_ACC> param_buffer(kConvert ? 2 * N : 0);
+  const T_ACC* gamma_data = gamma.defined()
+      ? RowAsAcc(gamma.data_ptr<T>(), param_buffer.data(), N)
+      : nullptr;
+  const T_ACC* beta_data = beta.defined()
+      ? RowAsAcc(beta.data_ptr<T>(), param_buffer.data() + N, N)
+      : nullptr;
+  const T_ACC c = T_ACC(1) / static_cast<T_ACC>(N);
   const bool gamma_null = gamma_data == nullptr;
   const bool beta_null = beta_data == nullptr;
   at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    std::vector<T_ACC> row_buffer(kConvert ? 2 * N : 0);
     for (int64_t i = start; i < end; ++i) {
-      T* X_ptr = X_data + i * N;
-      T* Y_ptr = Y_data + i * N;
-      T mean_val = vec256::reduce_all<T>(
-          [](Vec& x, Vec& y) { return x + y; },
-          X_ptr,
-          N);
-      T rstd_val = vec256::map_reduce_all<T>(
-          [](Vec x) { return x * x; },
-          [](Vec x, Vec y) { return x + y; },
-          X_ptr,
-          N);
+      const T_ACC* X_ptr = RowAsAcc(X_data + i * N, row_buffer.data(), N);
+      T_ACC* Y_ptr = OutRowAsAcc(Y_data + i * N, row_buffer.data() + N);
+      // Both moments in one pass. The missing lanes of the last vector are
+      // zero and do not change the sums.
+      Vec sum1_vec(0);
+      Vec sum2_vec(0);
+      for (int64_t j = 0; j < N; j += Vec::size()) {
+        const Vec x_vec = Vec::loadu(X_ptr + j, std::min<int64_t>(Vec::size(), N - j));
+        sum1_vec = sum1_vec + x_vec;
+        sum2_vec = sum2_vec + x_vec * x_vec;
+      }
+      T_ACC mean_val = vec256::vec_reduce_all<T_ACC>(
+          [](Vec& x, Vec& y) { return x + y; }, sum1_vec, Vec::size());
+      T_ACC rstd_val = vec256::vec_reduce_all<T_ACC>(
+          [](Vec& x, Vec& y) { return x + y; }, sum2_vec, Vec::size());
       mean_val *= c;
-      rstd_val = std::max(rstd_val * c - mean_val * mean_val, T(0));
-      rstd_val = T(1) / std::sqrt(rstd_val + eps);
-      const T scale = rstd_val;
-      const T bias = -rstd_val * mean_val;
-      for (int64_t j = 0; j < N; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
-        const T beta_v = beta_null ? T(0) : beta_data[j];
-        Y_ptr[j] = (X_ptr[j] * scale + bias) * gamma_v + beta_v;
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, T_ACC(0));
+      rstd_val = T_ACC(1) / std::sqrt(rstd_val + static_cast<T_ACC>(eps));
+      const Vec scale(rstd_val);
+      const Vec bias(-rstd_val * mean_val);
+      for (int64_t j = 0; j < N; j += Vec::size()) {
+        const int64_t count = std::min<int64_t>(Vec::size(), N - j);
+        const Vec gamma_vec = gamma_null ? Vec(1) : Vec::loadu(gamma_data + j, count);
+        const Vec beta_vec = beta_null ? Vec(0) : Vec::loadu(beta_data + j, count);
+        ((Vec::loadu(X_ptr + j, count) * scale + bias) * gamma_vec + beta_vec)
+            .store(Y_ptr + j, count);
       }
-      mean_data[i] = mean_val;
-      rstd_data[i] = rstd_val;
+      StoreRow(Y_ptr, Y_data + i * N, N);
+      mean_data[i] = static_cast<T>(mean_val);
+      rstd_data[i] = static_cast<T>(rstd_val);
     }
   });
 }
@@ -76,12 +139,17 @@ void LayerNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "LayerNormKernelImpl", [&]() {
-    LayerNormKernelImplInternal<scalar_t>(
-        X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
-  });
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, X.scalar_type(), "LayerNormKernelImpl", [&]() {
+        LayerNormKernelImplInternal<scalar_t>(
+            X, gamma, beta, M, N, eps, Y, mean, rstd);
+      });
 }
 
+// The backward reuses the saved mean and rstd and reads every row twice: the
+// first pass computes the two row sums needed by dX and adds the row's share
+// of dgamma and dbeta to partial sums owned by the thread, the second pass
+// writes dX. The partial sums of all the threads are added up at the end.
 template <typename T>
 void LayerNormBackwardKernelImplInternal(
     const Tensor& dY,
@@ -94,6 +162,9 @@ void LayerNormBackwardKernelImplInternal(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
+  using T_ACC = typename LayerNormAccType<T>::type;
+  using Vec = vec256::Vec256<T_ACC>;
+  constexpr bool kConvert = !std::is_same<T, T_ACC>::value;
   DCHECK_EQ(dY.numel(), M * N);
   DCHECK_EQ(X.numel(), M * N);
   DCHECK_EQ(mean.numel(), M);
@@ -103,52 +174,97 @@ void LayerNormBackwardKernelImplInternal(
   const T* X_data = X.template data_ptr<T>();
   const T* mean_data = mean.template data_ptr<T>();
   const T* rstd_data = rstd.template data_ptr<T>();
-  const T* gamma_data =
-      gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
+  std::vector<T_ACC> param_buffer(kConvert ? N : 0);
+  const T_ACC* gamma_data = gamma.defined()
+      ? RowAsAcc(gamma.template data_ptr<T>(), param_buffer.data(), N)
+      : nullptr;
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
   T* dgamma_data = dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
-  if (dgamma_data != nullptr) {
-    std::memset(dgamma_data, 0, N * sizeof(T));
-  }
   T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
-  if (dbeta_data != nullptr) {
-    std::memset(dbeta_data, 0, N * sizeof(T));
-  }
-  const T scale = T(1) / static_cast<T>(N);
+  const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
   const bool gamma_null = gamma_data == nullptr;
-  for (int64_t i = 0; i < M; ++i) {
-    const T* dY_ptr = dY_data + i * N;
-    const T* X_ptr = X_data + i * N;
-    if (dX_data != nullptr) {
-      T* dX_ptr = dX_data + i * N;
-      T ds = 0;
-      T db = 0;
-      for (int64_t j = 0; j < N; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
-        ds += dY_ptr[j] * X_ptr[j] * gamma_v;
-        db += dY_ptr[j] * gamma_v;
+  const bool dgamma_null = dgamma_data == nullptr;
+  const bool dbeta_null = dbeta_data == nullptr;
+
+  // dgamma and dbeta of thread t are at [2 * t * N, (2 * t + 1) * N) and
+  // [(2 * t + 1) * N, (2 * t + 2) * N).
+  const int num_threads = at::get_num_threads();
+  std::vector<T_ACC> buffer(
+      dgamma_null && dbeta_null ? 0 : 2 * num_threads * N, T_ACC(0));
+
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    T_ACC* dgamma_acc = dgamma_null && dbeta_null
+        ? nullptr
+        : buffer.data() + 2 * at::get_thread_num() * N;
+    T_ACC* dbeta_acc = dgamma_acc == nullptr ? nullptr : dgamma_acc + N;
+    std::vector<T_ACC> row_buffer(kConvert ? 3 * N : 0);
+    for (int64_t i = start; i < end; ++i) {
+      const T_ACC* dY_ptr = RowAsAcc(dY_data + i * N, row_buffer.data(), N);
+      const T_ACC* X_ptr = RowAsAcc(X_data + i * N, row_buffer.data() + N, N);
+      const T_ACC mean_val = static_cast<T_ACC>(mean_data[i]);
+      const T_ACC rstd_val = static_cast<T_ACC>(rstd_data[i]);
+      const Vec a_vec(rstd_val);
+      const Vec b_vec(-rstd_val * mean_val);
+      Vec ds_vec(0);
+      Vec db_vec(0);
+      for (int64_t j = 0; j < N; j += Vec::size()) {
+        const int64_t count = std::min<int64_t>(Vec::size(), N - j);
+        const Vec dy_vec = Vec::loadu(dY_ptr + j, count);
+        const Vec x_vec = Vec::loadu(X_ptr + j, count);
+        const Vec gamma_vec = gamma_null ? Vec(1) : Vec::loadu(gamma_data + j, count);
+        ds_vec = ds_vec + dy_vec * x_vec * gamma_vec;
+        db_vec = db_vec + dy_vec * gamma_vec;
+        if (!dgamma_null) {
+          (Vec::loadu(dgamma_acc + j, count) + dy_vec * (a_vec * x_vec + b_vec))
+              .store(dgamma_acc + j, count);
+        }
+        if (!dbeta_null) {
+          (Vec::loadu(dbeta_acc + j, count) + dy_vec).store(dbeta_acc + j, count);
+        }
       }
-      const T a = rstd_data[i];
-      const T b = (db * mean_data[i] - ds) * a * a * a * scale;
-      const T c = -b * mean_data[i] - db * a * scale;
-      for (int64_t j = 0; j < N; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
-        dX_ptr[j] = a * dY_ptr[j] * gamma_v + b * X_ptr[j] + c;
+      if (dX_data == nullptr) {
+        continue;
       }
-    }
-    if (dgamma_data != nullptr) {
-      const T a = rstd_data[i];
-      const T b = -a * mean_data[i];
-      for (int64_t j = 0; j < N; ++j) {
-        dgamma_data[j] += dY_ptr[j] * (a * X_ptr[j] + b);
+      const T_ACC ds = vec256::vec_reduce_all<T_ACC>(
+          [](Vec& x, Vec& y) { return x + y; }, ds_vec, Vec::size());
+      const T_ACC db = vec256::vec_reduce_all<T_ACC>(
+          [](Vec& x, Vec& y) { return x + y; }, db_vec, Vec::size());
+      const T_ACC a = rstd_val;
+      const T_ACC b = (db * mean_val - ds) * a * a * a * scale;
+      const T_ACC c = -b * mean_val - db * a * scale;
+      T_ACC* dX_ptr = OutRowAsAcc(dX_data + i * N, row_buffer.data() + 2 * N);
+      for (int64_t j = 0; j < N; j += Vec::size()) {
+        const int64_t count = std::min<int64_t>(Vec::size(), N - j);
+        const Vec gamma_vec = gamma_null ? Vec(1) : Vec::loadu(gamma_data + j, count);
+        (Vec(a) * Vec::loadu(dY_ptr + j, count) * gamma_vec +
+         Vec(b) * Vec::loadu(X_ptr + j, count) + Vec(c))
+            .store(dX_ptr + j, count);
       }
+      StoreRow(dX_ptr, dX_data + i * N, N);
     }
-    if (dbeta_data != nullptr) {
-      for (int64_t j = 0; j < N; ++j) {
-        dbeta_data[j] += dY_ptr[j];
+  });
+
+  if (dgamma_null && dbeta_null) {
+    return;
+  }
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / (2 * num_threads));
+  at::parallel_for(0, N, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t j = start; j < end; ++j) {
+      T_ACC dgamma_v = 0;
+      T_ACC dbeta_v = 0;
+      for (int t = 0; t < num_threads; ++t) {
+        dgamma_v += buffer[2 * t * N + j];
+        dbeta_v += buffer[(2 * t + 1) * N + j];
+      }
+      if (!dgamma_null) {
+        dgamma_data[j] = static_cast<T>(dgamma_v);
+      }
+      if (!dbeta_null) {
+        dbeta_data[j] = static_cast<T>(dbeta_v);
       }
     }
-  }
+  });
 }
 
 void LayerNormBackwardKernelImpl(
@@ -162,17 +278,163 @@ void LayerNormBackwardKernelImpl(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  AT_DISPATCH_FLOATING_TYPES(
-      X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
         LayerNormBackwardKernelImplInternal<scalar_t>(
             dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
       });
 }
 
+// Dropout, the residual add and the moments are computed in one pass over X
+// and R that also writes S = dropout(X) + R, which the backward needs. The
+// dropout mask is generated on the fly by DropoutKeepMask4 and not stored.
+template <typename T>
+void DropoutAddLayerNormKernelImplInternal(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    const Tensor& rng_state,
+    Tensor* Y,
+    Tensor* S,
+    Tensor* mean,
+    Tensor* rstd) {
+  using Vec = vec256::Vec256<T>;
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK_EQ(R.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  const T* X_data = X.data_ptr<T>();
+  const T* R_data = R.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  T* Y_data = Y->data_ptr<T>();
+  T* S_data = S->data_ptr<T>();
+  T* mean_data = mean->data_ptr<T>();
+  T* rstd_data = rstd->data_ptr<T>();
+  const int64_t* rng_data = rng_state.data_ptr<int64_t>();
+  const uint64_t seed = static_cast<uint64_t>(rng_data[0]);
+  const uint64_t offset = static_cast<uint64_t>(rng_data[1]);
+  const float p_val = static_cast<float>(p);
+  const T keep_scale = T(1) / (T(1) - static_cast<T>(p));
+  const T c = T(1) / static_cast<T>(N);
+  const bool gamma_null = gamma_data == nullptr;
+  const bool beta_null = beta_data == nullptr;
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const T* X_ptr = X_data + i * N;
+      const T* R_ptr = R_data + i * N;
+      T* S_ptr = S_data + i * N;
+      T* Y_ptr = Y_data + i * N;
+      T sum1 = 0;
+      T sum2 = 0;
+      for (int64_t j = 0; j < N; j += 4) {
+        bool keep[4];
+        DropoutKeepMask4(seed, offset, N, i, j, p_val, keep);
+        const int64_t count = std::min<int64_t>(4, N - j);
+        for (int64_t k = 0; k < count; ++k) {
+          const T s = keep[k] ? X_ptr[j + k] * keep_scale + R_ptr[j + k]
+                              : R_ptr[j + k];
+          S_ptr[j + k] = s;
+          sum1 += s;
+          sum2 += s * s;
+        }
+      }
+      const T mean_val = sum1 * c;
+      T rstd_val = std::max(sum2 * c - mean_val * mean_val, T(0));
+      rstd_val = T(1) / std::sqrt(rstd_val + static_cast<T>(eps));
+      const Vec scale(rstd_val);
+      const Vec bias(-rstd_val * mean_val);
+      for (int64_t j = 0; j < N; j += Vec::size()) {
+        const int64_t count = std::min<int64_t>(Vec::size(), N - j);
+        const Vec gamma_vec = gamma_null ? Vec(1) : Vec::loadu(gamma_data + j, count);
+        const Vec beta_vec = beta_null ? Vec(0) : Vec::loadu(beta_data + j, count);
+        ((Vec::loadu(S_ptr + j, count) * scale + bias) * gamma_vec + beta_vec)
+            .store(Y_ptr + j, count);
+      }
+      mean_data[i] = mean_val;
+      rstd_data[i] = rstd_val;
+    }
+  });
+}
+
+void DropoutAddLayerNormKernelImpl(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    const Tensor& rng_state,
+    Tensor* Y,
+    Tensor* S,
+    Tensor* mean,
+    Tensor* rstd) {
+  AT_DISPATCH_FLOATING_TYPES(
+      X.scalar_type(), "DropoutAddLayerNormKernelImpl", [&]() {
+        DropoutAddLayerNormKernelImplInternal<scalar_t>(
+            X, R, gamma, beta, M, N, p, eps, rng_state, Y, S, mean, rstd);
+      });
+}
+
+template <typename T>
+void DropoutMaskScaleKernelImplInternal(
+    const Tensor& dS,
+    const Tensor& rng_state,
+    int64_t M,
+    int64_t N,
+    double p,
+    Tensor* dX) {
+  DCHECK_EQ(dS.numel(), M * N);
+  const T* dS_data = dS.data_ptr<T>();
+  T* dX_data = dX->data_ptr<T>();
+  const int64_t* rng_data = rng_state.data_ptr<int64_t>();
+  const uint64_t seed = static_cast<uint64_t>(rng_data[0]);
+  const uint64_t offset = static_cast<uint64_t>(rng_data[1]);
+  const float p_val = static_cast<float>(p);
+  const T keep_scale = T(1) / (T(1) - static_cast<T>(p));
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const T* dS_ptr = dS_data + i * N;
+      T* dX_ptr = dX_data + i * N;
+      for (int64_t j = 0; j < N; j += 4) {
+        bool keep[4];
+        DropoutKeepMask4(seed, offset, N, i, j, p_val, keep);
+        const int64_t count = std::min<int64_t>(4, N - j);
+        for (int64_t k = 0; k < count; ++k) {
+          dX_ptr[j + k] = keep[k] ? dS_ptr[j + k] * keep_scale : T(0);
+        }
+      }
+    }
+  });
+}
+
+void DropoutMaskScaleKernelImpl(
+    const Tensor& dS,
+    const Tensor& rng_state,
+    int64_t M,
+    int64_t N,
+    double p,
+    Tensor* dX) {
+  AT_DISPATCH_FLOATING_TYPES(
+      dS.scalar_type(), "DropoutMaskScaleKernelImpl", [&]() {
+        DropoutMaskScaleKernelImplInternal<scalar_t>(
+            dS, rng_state, M, N, p, dX);
+      });
+}
+
 } // namespace
 
 REGISTER_DISPATCH(LayerNormKernel, &LayerNormKernelImpl);
 REGISTER_DISPATCH(LayerNormBackwardKernel, &LayerNormBackwardKernelImpl);
+REGISTER_DISPATCH(DropoutAddLayerNormKernel, &DropoutAddLayerNormKernelImpl);
+REGISTER_DISPATCH(DropoutMaskScaleKernel, &DropoutMaskScaleKernelImpl);
 
 } // namespace native
 } // namespace at
@@ -284,6 +284,161 @@ static void launch_kernel(int64_t N, const func_t& f, array_t data) {
 template<int nt, int vt, typename func_t, typename array_t, std::enable_if_t<!detail::has_same_arg_types<func_t>::value, int> = 0>
 static void launch_kernel(int64_t N, const func_t& f, array_t data) {}
 
+// Vectorized kernel for iterators that are not trivially 1d, but whose innermost
+// dimension is contiguous in every operand, e.g. `input + bias` where `bias` is
+// broadcast along the outer dimensions. Each thread handles `vec_size` consecutive
+// elements of one row, so the offsets are computed once per vector instead of
+// once per element.
+template<int vec_size, int num_threads, typename func_t, typename array_t, typename offset_calc_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void vectorized_nd_kernel(int N, func_t f, array_t data, offset_calc_t offset_calc) {
+  using traits = function_traits<func_t>;
+  using return_t = typename traits::result_type;
+  using arg_t = detail::arg_type::type<func_t>;
+  using return_vec_t = memory::aligned_vector<return_t, vec_size>;
+  using arg_vec_t = memory::aligned_vector<arg_t, vec_size>;
+  constexpr int arity = traits::arity;
+  constexpr int nargs = traits::arity == 0 ? 1 : traits::arity;
+
+  // N is the number of vectors, not the number of elements
+  int vec_idx = num_threads * blockIdx.x + threadIdx.x;
+  if (vec_idx >= N) {
+    return;
+  }
+  auto offsets = offset_calc.get(vec_idx * vec_size);
+
+  // load
+  arg_t args[vec_size][nargs];
+  #pragma unroll
+  for (int i = 0; i < arity; i++) {
+    arg_vec_t v = *reinterpret_cast<arg_vec_t *>(data[i + 1] + offsets[i + 1]);
+    #pragma unroll
+    for (int j = 0; j < vec_size; j++) {
+      args[j][i] = v.val[j];
+    }
+  }
+
+  // compute
+  return_vec_t results;
+  #pragma unroll
+  for (int j = 0; j < vec_size; j++) {
+    results.val[j] = detail::invoke_with_array(f, args[j]);
+  }
+
+  // store
+  *reinterpret_cast<return_vec_t *>(data[0] + offsets[0]) = results;
+}
+
+namespace detail {
+
+// Returns the widest vector that `vectorized_nd_kernel` can use for `iter`:
+// every operand must be contiguous in the innermost dimension, the size of
+// that dimension must be a multiple of the vector size, and the base pointers
+// and the strides of all outer dimensions must keep each vector aligned.
+template<typename func_t, typename array_t>
+inline int can_vectorize_nd_up_to(const TensorIterator& iter, array_t pointers) {
+  if (iter.ndim() < 2 || !iter.has_contiguous_first_dim()) {
+    return 1;
+  }
+  int vec_size = can_vectorize_up_to<func_t>(pointers);
+  for (; vec_size > 1; vec_size /= 2) {
+    bool aligned = iter.shape()[0] % vec_size == 0;
+    for (int arg = 0; aligned && arg < iter.ntensors(); arg++) {
+      int64_t vec_bytes = iter.element_size(arg) * vec_size;
+      for (int dim = 1; dim < iter.ndim(); dim++) {
+        if (iter.shape()[dim] > 1 && iter.strides(arg)[dim] % vec_bytes != 0) {
+          aligned = false;
+          break;
+        }
+      }
+    }
+    if (aligned) {
+      break;
+    }
+  }
+  return vec_size;
+}
+
+}  // namespace detail
+
+// Launches `vectorized_nd_kernel` if `iter` allows it, returns false otherwise
+// so the caller can fall back to the per-element kernel.
+template<typename func_t, typename array_t, std::enable_if_t<detail::has_same_arg_types<func_t>::value, int> = 0>
+static bool launch_vectorized_nd_kernel(const TensorIterator& iter, const func_t& f, array_t data) {
+  constexpr int ntensors = function_traits<func_t>::arity + 1;
+  int vec_size = detail::can_vectorize_nd_up_to<func_t>(iter, data);
+  if (vec_size == 1) {
+    return false;
+  }
+  int64_t N = iter.numel() / vec_size;
+  TORCH_INTERNAL_ASSERT(N > 0 && N <= std::numeric_limits<int32_t>::max());
+  auto offset_calc = legacy::make_offset_calculator<ntensors>(iter);
+  using offset_calc_t = decltype(offset_calc);
+  dim3 block(launch_size_nd);
+  dim3 grid((N + block.x - 1) / block.x);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  switch (vec_size) {
+  case 4:
+    vectorized_nd_kernel<4, launch_size_nd, func_t, array_t, offset_calc_t><<<grid, block, 0, stream>>>(N, f, data, offset_calc);
+    break;
+  case 2:
+    vectorized_nd_kernel<2, launch_size_nd, func_t, array_t, offset_calc_t><<<grid, block, 0, stream>>>(N, f, data, offset_calc);
+    break;
+  default:
+    TORCH_INTERNAL_ASSERT(false, "Unexpected vectorization size");
+  }
+  AT_CUDA_CHECK(cudaGetLastError());
+  return true;
+}
+
+template<typename func_t, typename array_t, std::enable_if_t<!detail::has_same_arg_types<func_t>::value, int> = 0>
+static bool launch_vectorized_nd_kernel(const TensorIterator& iter, const func_t& f, array_t data) {
+  return false;
+}
+
+// Dtypes of type promoting kernels are only known at runtime, so their loads
+// can not be vectorized. Instead, each thread fetches and casts all of its
+// `thread_work_size` elements before storing any result, so that the loads
+// are not serialized behind the stores.
+template<int num_threads, int thread_work_size, typename func_t, typename array_t, typename strides_t, typename dtypes_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void unrolled_casting_kernel(int N, func_t f, array_t data, strides_t strides, dtypes_t dtypes) {
+  using return_t = typename function_traits<func_t>::result_type;
+  int idx = num_threads * thread_work_size * blockIdx.x + threadIdx.x;
+
+  // load and compute
+  return_t results[thread_work_size];
+  #pragma unroll
+  for (int i = 0; i < thread_work_size; i++) {
+    int linear_idx = idx + num_threads * i;
+    if (linear_idx < N) {
+      results[i] = legacy::invoke(f, &data.data[1], &strides.data[1], &dtypes.data[1], linear_idx);
+    }
+  }
+
+  // store
+  #pragma unroll
+  for (int i = 0; i < thread_work_size; i++) {
+    int linear_idx = idx + num_threads * i;
+    if (linear_idx < N) {
+      c10::cast_and_store<return_t>(dtypes[0], data[0] + strides[0] * linear_idx, results[i]);
+    }
+  }
+}
+
+template<int nt, int vt, typename func_t, typename array_t, typename strides_t, typename dtypes_t>
+static void launch_unrolled_casting_kernel(int64_t N, const func_t& f, array_t data, strides_t strides, dtypes_t dtypes) {
+  TORCH_INTERNAL_ASSERT(N >= 0 && N <= std::numeric_limits<int32_t>::max());
+  if (N == 0) {
+    return;
+  }
+  dim3 block(nt);
+  dim3 grid((N + block.x * vt - 1) / (block.x * vt));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  unrolled_casting_kernel<nt, vt, func_t, array_t, strides_t, dtypes_t><<<grid, block, 0, stream>>>(N, f, data, strides, dtypes);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 } // namespace modern
 
 }} // namespace at::native
@@ -3,6 +3,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/CUDAEvent.h>
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <c10/cuda/CUDAStream.h>
 #include <ATen/native/Copy.h>
 #include <ATen/native/TensorIterator.h>
@@ -174,6 +175,18 @@ static void copy_kernel_cuda(TensorIterator& iter, bool non_blocking) {
   int64_t nbytes = iter.numel() * iter.element_size(0);
   CUDAStream stream = getCurrentCUDAStream();
 
+  // A copy from pageable memory goes through a staging buffer of the driver
+  // and does not overlap with host work. For non-blocking copies, stage the
+  // source in a pinned buffer from the caching host allocator instead, so the
+  // copy is asynchronous and the source can be reused right away.
+  at::DataPtr staging;
+  if (non_blocking && kind == cudaMemcpyHostToDevice && nbytes > 0 &&
+      !at::detail::getCUDAHooks().isPinnedPtr(src)) {
+    staging = getTHCCachingHostAllocator()->allocate(nbytes);
+    std::memcpy(staging.get(), src, nbytes);
+    src = staging.get();
+  }
+
   AT_CUDA_CHECK(cudaMemcpyAsync(dst, src, nbytes, kind, stream));
 
   if (non_blocking) {
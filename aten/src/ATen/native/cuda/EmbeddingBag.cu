@@ -120,8 +120,6 @@ Tensor embedding_bag_backward_cuda_sum_avg(
                                    bool scale_grad_by_freq, int64_t mode,
                                    const Tensor& per_sample_weights) {
 
-  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.options());
-
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
   ptrdiff_t numel = indices.numel();
@@ -131,8 +129,6 @@ Tensor embedding_bag_backward_cuda_sum_avg(
     return at::zeros({num_weights, grad.size(1)}, grad.options());
   }
 
-  int64_t stride = grad_weight.stride(0);
-
   auto sorted_indices = at::empty_like(indices, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   auto orig_indices = at::empty_like(indices, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   using device_ptr = thrust::device_ptr<int64_t>;
@@ -188,12 +184,12 @@ Tensor embedding_bag_backward_cuda_sum_avg(
       mode == MODE_MEAN, offset2bag, bag_size, per_sample_weights);
 }
 
-template <typename scalar_t>
+// gradWeight is accumulated in accscalar_t, since atomic adds on Half are
+// emulated with a compare-and-swap loop and round after every addition.
+template <typename scalar_t, typename accscalar_t>
 __global__ void EmbeddingBag_accGradParametersKernel_max(
     int64_t *max_indices, scalar_t *gradOutput,
-    scalar_t *gradWeight, int64_t stride, int64_t numBags) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
+    accscalar_t *gradWeight, int64_t stride, int64_t numBags) {
 
   int64_t chunksPerBag = THCCeilDiv(stride, (int64_t)blockDim.x);
   int64_t numChunks = numBags * chunksPerBag;
@@ -209,7 +205,7 @@ __global__ void EmbeddingBag_accGradParametersKernel_max(
       if (word_idx >= 0) {
         // If bag is empty, we have max_indices[idx] set to -1 in forward.
         gpuAtomicAdd(&(gradWeight[word_idx * stride + featureDim]),
-                gradOutput[bag * stride + featureDim]);
+                static_cast<accscalar_t>(gradOutput[bag * stride + featureDim]));
       }
     }
   }
@@ -219,7 +215,8 @@ Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
                                    const Tensor &max_indices,
                                    int64_t num_weights) {
 
-  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.options());
+  const auto grad_weight_type = grad.scalar_type() == kHalf ? kFloat : grad.scalar_type();
+  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.options().dtype(grad_weight_type));
 
   int64_t stride = grad_weight.stride(0);
 
@@ -236,14 +233,15 @@ Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
 
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       grad.scalar_type(), "embedding_bag_backward_cuda_max", [&] {
+        using accscalar_t = acc_type<scalar_t, true>;
         EmbeddingBag_accGradParametersKernel_max<
-            scalar_t><<<grid, block, 0, stream>>>(
+            scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
             max_indices.data_ptr<int64_t>(), grad.data_ptr<scalar_t>(),
-            grad_weight.data_ptr<scalar_t>(), stride, numBags);
+            grad_weight.data_ptr<accscalar_t>(), stride, numBags);
       });
 
   THCudaCheck(cudaGetLastError());
-  return grad_weight;
+  return grad_weight.to(grad.scalar_type());
 }
 }
 
@@ -282,12 +280,14 @@ _embedding_bag_cuda(const Tensor &weight, const Tensor &indices,
 
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
-  auto output = at::zeros({numBags, featureSize}, weight.options());
+  // The kernel writes every element of output (and of max_indices in max
+  // mode), so they don't need to be zeroed first.
+  auto output = at::empty({numBags, featureSize}, weight.options());
 
   Tensor max_indices;
 
   if (mode == MODE_MAX) {
-    max_indices = at::zeros({numBags, featureSize}, indices.options());
+    max_indices = at::empty({numBags, featureSize}, indices.options());
   } else {
     // No need to allocate if we aren't doing a backwards pass
     max_indices = at::zeros({0}, indices.options());
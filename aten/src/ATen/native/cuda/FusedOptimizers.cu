@@ -0,0 +1,212 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/FusedOptimizers.h>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
+
+#include <cmath>
+
+namespace at { namespace native {
+
+namespace {
+
+// Splits the tensors into the ones multi_tensor_apply can handle, which are
+// returned as operand lists, and the ones the caller has to update one by one.
+// The operands of a fused tensor must be contiguous CUDA tensors on the device
+// and with the dtype of the first parameter.
+std::vector<std::vector<Tensor>> partition_fusable(
+    std::initializer_list<TensorList> lists,
+    std::vector<size_t>& unfused) {
+  const auto& params = *lists.begin();
+  std::vector<std::vector<Tensor>> fused(lists.size());
+  if (params.size() == 0) {
+    return fused;
+  }
+  const auto device = params[0].device();
+  const auto dtype = params[0].scalar_type();
+  for (size_t i = 0; i < params.size(); i++) {
+    bool fusable = true;
+    for (const auto& list : lists) {
+      const auto& t = list[i];
+      fusable &= t.is_cuda() && t.device() == device && t.scalar_type() == dtype &&
+          t.is_contiguous() && t.numel() < std::numeric_limits<int>::max();
+    }
+    if (fusable) {
+      size_t d = 0;
+      for (const auto& list : lists) {
+        fused[d++].push_back(list[i]);
+      }
+    } else {
+      unfused.push_back(i);
+    }
+  }
+  return fused;
+}
+
+template <typename scalar_t>
+struct AdamFunctor {
+  using accscalar_t = acc_type<scalar_t, true>;
+
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<4>& tl,
+      accscalar_t lr,
+      accscalar_t beta1,
+      accscalar_t beta2,
+      accscalar_t eps,
+      accscalar_t weight_decay,
+      accscalar_t bias_correction1,
+      accscalar_t bias_correction2_sqrt,
+      bool decoupled_weight_decay) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+
+    scalar_t* param = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const scalar_t* grad = static_cast<scalar_t*>(tl.addresses[1][tensor_loc]) + offset;
+    scalar_t* exp_avg = static_cast<scalar_t*>(tl.addresses[2][tensor_loc]) + offset;
+    scalar_t* exp_avg_sq = static_cast<scalar_t*>(tl.addresses[3][tensor_loc]) + offset;
+
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      accscalar_t p = param[i];
+      accscalar_t g = grad[i];
+      if (decoupled_weight_decay) {
+        p *= 1 - lr * weight_decay;
+      } else {
+        g += weight_decay * p;
+      }
+      accscalar_t m = beta1 * static_cast<accscalar_t>(exp_avg[i]) + (1 - beta1) * g;
+      accscalar_t v = beta2 * static_cast<accscalar_t>(exp_avg_sq[i]) + (1 - beta2) * g * g;
+      accscalar_t denom = ::sqrt(v) / bias_correction2_sqrt + eps;
+      param[i] = p - (lr / bias_correction1) * m / denom;
+      exp_avg[i] = m;
+      exp_avg_sq[i] = v;
+    }
+  }
+};
+
+template <typename scalar_t, int depth>
+struct SGDFunctor {
+  using accscalar_t = acc_type<scalar_t, true>;
+
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      accscalar_t lr,
+      accscalar_t momentum,
+      accscalar_t dampening,
+      accscalar_t weight_decay,
+      bool nesterov,
+      bool first_step) {
+    int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    int64_t offset = static_cast<int64_t>(chunk_idx) * chunk_size;
+    int n = min(tl.sizes[tensor_loc] - static_cast<int>(offset), chunk_size);
+
+    scalar_t* param = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const scalar_t* grad = static_cast<scalar_t*>(tl.addresses[1][tensor_loc]) + offset;
+    scalar_t* momentum_buffer = depth > 2
+        ? static_cast<scalar_t*>(tl.addresses[depth - 1][tensor_loc]) + offset
+        : nullptr;
+
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+      accscalar_t p = param[i];
+      accscalar_t d_p = static_cast<accscalar_t>(grad[i]) + weight_decay * p;
+      if (depth > 2) {
+        accscalar_t buf = first_step
+            ? d_p
+            : momentum * static_cast<accscalar_t>(momentum_buffer[i]) + (1 - dampening) * d_p;
+        momentum_buffer[i] = buf;
+        d_p = nesterov ? d_p + momentum * buf : buf;
+      }
+      param[i] = p - lr * d_p;
+    }
+  }
+};
+
+} // namespace
+
+void fused_adam_cuda(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    int64_t step,
+    bool decoupled_weight_decay) {
+  check_fused_optimizer_lists("_fused_adam", {params, grads, exp_avgs, exp_avg_sqs});
+  std::vector<size_t> unfused;
+  auto lists = partition_fusable({params, grads, exp_avgs, exp_avg_sqs}, unfused);
+  if (!lists[0].empty()) {
+    const double bias_correction1 = 1 - std::pow(beta1, step);
+    const double bias_correction2 = 1 - std::pow(beta2, step);
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(lists[0][0].scalar_type(), "fused_adam_cuda", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      multi_tensor_apply<4>(
+          lists,
+          AdamFunctor<scalar_t>(),
+          static_cast<accscalar_t>(lr),
+          static_cast<accscalar_t>(beta1),
+          static_cast<accscalar_t>(beta2),
+          static_cast<accscalar_t>(eps),
+          static_cast<accscalar_t>(weight_decay),
+          static_cast<accscalar_t>(bias_correction1),
+          static_cast<accscalar_t>(std::sqrt(bias_correction2)),
+          decoupled_weight_decay);
+    });
+  }
+  for (auto i : unfused) {
+    adam_step(params[i], grads[i], exp_avgs[i], exp_avg_sqs[i],
+              lr, beta1, beta2, eps, weight_decay, step, decoupled_weight_decay);
+  }
+}
+
+void fused_sgd_cuda(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_step) {
+  std::vector<size_t> unfused;
+  std::vector<std::vector<Tensor>> lists;
+  if (momentum != 0) {
+    check_fused_optimizer_lists("_fused_sgd", {params, grads, momentum_buffers});
+    lists = partition_fusable({params, grads, momentum_buffers}, unfused);
+  } else {
+    check_fused_optimizer_lists("_fused_sgd", {params, grads});
+    lists = partition_fusable({params, grads}, unfused);
+  }
+  if (!lists[0].empty()) {
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(lists[0][0].scalar_type(), "fused_sgd_cuda", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      if (momentum != 0) {
+        multi_tensor_apply<3>(
+            lists, SGDFunctor<scalar_t, 3>(),
+            static_cast<accscalar_t>(lr), static_cast<accscalar_t>(momentum),
+            static_cast<accscalar_t>(dampening), static_cast<accscalar_t>(weight_decay),
+            nesterov, first_step);
+      } else {
+        multi_tensor_apply<2>(
+            lists, SGDFunctor<scalar_t, 2>(),
+            static_cast<accscalar_t>(lr), static_cast<accscalar_t>(momentum),
+            static_cast<accscalar_t>(dampening), static_cast<accscalar_t>(weight_decay),
+            nesterov, first_step);
+      }
+    });
+  }
+  for (auto i : unfused) {
+    sgd_step(params[i], grads[i], momentum != 0 ? momentum_buffers[i] : Tensor(),
+             lr, momentum, dampening, weight_decay, nesterov, first_step);
+  }
+}
+
+}} // namespace at::native
@@ -6,6 +6,8 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/AccumulateType.h>
+#include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/WrapDimUtils.h>
 
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCGeneral.h>
@@ -13,6 +15,9 @@
 #include <ATen/cuda/CUDAContext.h>
 #include <THC/THCThrustAllocator.cuh>
 #include <thrust/execution_policy.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/reduce.h>
 #include <thrust/sort.h>
 
 #include <c10/macros/Macros.h>
@@ -86,6 +91,24 @@ __global__ void indexing_backward_kernel(
   }
 }
 
+template <typename scalar_t, typename accscalar_t>
+struct cast_to_acc_type {
+  __device__ accscalar_t operator()(scalar_t v) const {
+    return static_cast<accscalar_t>(v);
+  }
+};
+
+// Adds the per-segment sums produced by reduce_by_key. The keys are unique,
+// so every output element is written by exactly one thread.
+template <typename scalar_t, typename accscalar_t>
+__global__ void add_segment_sums_kernel(
+  const int64_t* unique_indices, const accscalar_t* sums, scalar_t* grad_weight, int64_t num_segments) {
+  int64_t idx = blockIdx.x * (int64_t)blockDim.x + threadIdx.x;
+  if (idx < num_segments) {
+    scalar_t* out = grad_weight + unique_indices[idx];
+    *out = static_cast<scalar_t>(static_cast<accscalar_t>(*out) + sums[idx]);
+  }
+}
 
 }    
 
@@ -207,17 +230,51 @@ void index_put_accum_kernel(Tensor & self, TensorList indices, const Tensor & va
       auto orig_data = device_ptr(orig_indices.data_ptr<int64_t>());
       thrust::copy(policy, count_iter, count_iter + num_indices, orig_data);
     
-      // Sort the inputs into sorted with the corresponding indices; we
-      // don't need a stable or multidimensional sort, so just use Thrust
-      // directly
-      // Sort; a stable sort is not required
+      // Sort the inputs into sorted with the corresponding indices. The sort
+      // is stable so that duplicates are accumulated in their original order,
+      // which makes the result deterministic.
       // NB - not passing comparator causes thrust to use radix sort, and it hurts perf A LOT, at least for medium (few K) sized indices
       auto sorted_data = device_ptr(sorted_indices.data_ptr<int64_t>());
-      thrust::sort_by_key(policy, sorted_data, sorted_data + num_indices, orig_data, ThrustLTOp<int64_t>());
+      thrust::stable_sort_by_key(policy, sorted_data, sorted_data + num_indices, orig_data, ThrustLTOp<int64_t>());
       }
       TORCH_INTERNAL_ASSERT(linearIndex.numel()*sliceSize*nElemBefore == value.numel(), "number of flattened indices did not match number of elements in the value tensor", linearIndex.numel()*sliceSize*nElemBefore, value.numel());
       TORCH_CHECK(self.numel() < std::numeric_limits<int>::max(), "index_put_ with accumulation is not supported on large tensors, number of source elements =", self.numel(), "file a support request on github");
       TORCH_CHECK(value.numel() < std::numeric_limits<int>::max(), "index_put_ with accumulation is not supported on large tensors, number of source elements =", value.numel(), "file a support request on github");
+
+      if (sliceSize == 1 && nElemBefore == 1) {
+        // Every index addresses a single element (e.g. scatter_add_), so a
+        // warp per index would leave all but one of its lanes idle. Reduce
+        // the runs of equal indices instead and add each sum once.
+        AT_DISPATCH_ALL_TYPES_AND2(at::ScalarType::Half, at::ScalarType::Bool,
+        value_.scalar_type(), "indexing_backward", [&] {
+          using accscalar_t = at::acc_type<scalar_t, true>;
+          auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+          auto policy = thrust::cuda::par(allocator).on(stream);
+          auto unique_indices = at::empty_like(sorted_indices, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+          auto sums = at::empty({num_indices}, value_.options().dtype(c10::impl::CPPTypeToScalarType<accscalar_t>::value));
+          auto sorted_data = device_ptr(sorted_indices.data_ptr<int64_t>());
+          auto values = thrust::make_transform_iterator(
+              thrust::make_permutation_iterator(
+                  thrust::device_ptr<scalar_t>(value_.data_ptr<scalar_t>()),
+                  device_ptr(orig_indices.data_ptr<int64_t>())),
+              cast_to_acc_type<scalar_t, accscalar_t>());
+          auto unique_data = device_ptr(unique_indices.data_ptr<int64_t>());
+          auto ends = thrust::reduce_by_key(policy, sorted_data, sorted_data + num_indices, values,
+              unique_data, thrust::device_ptr<accscalar_t>(sums.data_ptr<accscalar_t>()));
+          int64_t num_segments = ends.first - unique_data;
+          const int threads = 512;
+          add_segment_sums_kernel<scalar_t, accscalar_t><<<THCCeilDiv(num_segments, (int64_t) threads), threads, 0, stream>>>(
+            unique_indices.data_ptr<int64_t>(),
+            sums.data_ptr<accscalar_t>(),
+            src_.data_ptr<scalar_t>(),
+            num_segments);
+        });
+        THCudaCheck(cudaGetLastError());
+        if (permuted)
+            self.copy_(src_.permute(inversePerm));
+        return;
+      }
+
       const int UNROLL = 4;
       const int indices_per_block = 4;
       dim3 grid(THCCeilDiv(num_indices, (int64_t) indices_per_block),
@@ -244,7 +301,97 @@ void index_put_accum_kernel(Tensor & self, TensorList indices, const Tensor & va
 }
 
 REGISTER_CUDA_DISPATCH(index_put_accum_stub, &index_put_accum_kernel);
+
+// index_add_ and scatter_add_ are expressed as index_put_ with accumulation, so
+// that all of them sort the indices and reduce duplicates without atomics.
+bool can_use_sorted_accumulate(const Tensor & self, const Tensor & source) {
+  switch (self.scalar_type()) {
+#define DEFINE_CASE(ctype, name) case ScalarType::name:
+    AT_FORALL_SCALAR_TYPES_AND2(Half, Bool, DEFINE_CASE)
+#undef DEFINE_CASE
+      return self.dim() > 0 &&
+          self.numel() < std::numeric_limits<int>::max() &&
+          source.numel() < std::numeric_limits<int>::max();
+    default:
+      return false;
+  }
+}
+
+void sorted_accumulate(Tensor & self, TensorList indices, const Tensor & value, bool unsafe) {
+  if (self.is_contiguous()) {
+    index_put_accum_kernel(self, indices, value, unsafe);
+  } else {
+    auto self_ = self.contiguous();
+    index_put_accum_kernel(self_, indices, value, unsafe);
+    self.copy_(self_);
+  }
+}
 } //anonymous
+
+Tensor & index_add_cuda_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
+  if (!can_use_sorted_accumulate(self, source)) {
+    return legacy::cuda::_th_index_add_(self, dim, index, source);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+
+  auto numel = index.numel();
+  TORCH_CHECK_INDEX(index.dim() <= 1, "index_add_(): Index is supposed to be a vector");
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "index_add_(): Expected dtype int64 for index");
+  TORCH_CHECK(self.scalar_type() == source.scalar_type(),
+              "index_add_(): self and source must have the same scalar type");
+  TORCH_CHECK(self.dim() == source.dim(),
+              "index_add_(): self and source must have the same number of dimensions");
+  TORCH_CHECK(numel == source.size(dim),
+              "index_add_(): Number of indices should be equal to source.size(dim)");
+
+  std::vector<Tensor> indices(dim + 1);
+  indices[dim] = index.reshape(-1);
+  sorted_accumulate(self, indices, source, /*unsafe=*/false);
+  return self;
+}
+
+Tensor & scatter_add_cuda_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & src) {
+  if (!can_use_sorted_accumulate(self, src) || index.dim() != self.dim() || src.dim() != self.dim()) {
+    return legacy::cuda::_th_scatter_add_(self, dim, index, src);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "scatter_add_(): Expected dtype int64 for index");
+  TORCH_CHECK(self.scalar_type() == src.scalar_type(),
+              "scatter_add_(): self and src must have the same scalar type");
+  for (int64_t d = 0; d < self.dim(); d++) {
+    TORCH_CHECK(index.size(d) <= src.size(d),
+                "scatter_add_(): Expected index ", index.sizes(), " to be smaller than src ", src.sizes());
+    TORCH_CHECK(d == dim || index.size(d) <= self.size(d),
+                "scatter_add_(): Expected index ", index.sizes(), " to be smaller than self ", self.sizes(),
+                " apart from dimension ", dim);
+  }
+  if (index.numel() == 0) {
+    return self;
+  }
+  auto max_idx = index.max().item<int64_t>();
+  auto min_idx = index.min().item<int64_t>();
+  TORCH_CHECK_INDEX(min_idx >= 0 && max_idx < self.size(dim),
+                    "scatter_add_(): index out of bounds for dimension ", dim, " with size ", self.size(dim));
+
+  // Every dimension other than `dim` is indexed by its own position, so each
+  // element of src is added to exactly one element of self.
+  std::vector<Tensor> indices(self.dim());
+  auto value = src;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d == dim) {
+      indices[d] = index;
+    } else {
+      std::vector<int64_t> shape(self.dim(), 1);
+      shape[d] = index.size(d);
+      indices[d] = at::arange(index.size(d), index.options()).view(shape);
+    }
+    value = value.narrow(d, 0, index.size(d));
+  }
+  sorted_accumulate(self, indices, value, /*unsafe=*/true);
+  return self;
+}
+
 } //at
 } //native
 
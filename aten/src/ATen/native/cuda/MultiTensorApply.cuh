@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <c10/macros/Macros.h>
+
+#include <limits>
+#include <vector>
+
+namespace at { namespace native {
+
+// multi_tensor_apply runs a functor over the elements of several lists of
+// tensors with as few kernel launches as possible. Every tensor is cut into
+// chunks of kMultiTensorChunkSize elements, and each block of a launch works
+// on one chunk. The pointers and sizes of the tensors of a launch are passed
+// by value in a TensorListMetadata kernel argument, whose capacity bounds the
+// number of tensors and chunks per launch.
+//
+// tensor_lists[d][t] is the d-th operand of the t-th tensor. All the operands
+// of a tensor must be contiguous and have the same number of elements.
+
+constexpr int kMultiTensorBlockSize = 512;
+constexpr int kMultiTensorChunkSize = 65536;
+
+// Kernel arguments are limited to 4KB
+constexpr int depth_to_max_tensors[5] = {110, 64, 48, 36, 30};
+constexpr int depth_to_max_blocks[5] = {320, 320, 320, 320, 320};
+
+template <int n>
+struct TensorListMetadata {
+  void* addresses[n][depth_to_max_tensors[n - 1]];
+  int sizes[depth_to_max_tensors[n - 1]];
+  unsigned char block_to_tensor[depth_to_max_blocks[n - 1]];
+  int block_to_chunk[depth_to_max_blocks[n - 1]];
+};
+
+template <typename T, typename U, typename... ArgTypes>
+C10_LAUNCH_BOUNDS_1(kMultiTensorBlockSize)
+__global__ void multi_tensor_apply_kernel(T tensor_list_meta, U callable, ArgTypes... args) {
+  callable(kMultiTensorChunkSize, tensor_list_meta, args...);
+}
+
+template <int depth, typename T, typename... ArgTypes>
+void multi_tensor_apply(
+    const std::vector<std::vector<Tensor>>& tensor_lists,
+    T callable,
+    ArgTypes... args) {
+  TORCH_CHECK(tensor_lists.size() == depth, "multi_tensor_apply: expected ", depth, " tensor lists");
+  const size_t n_tensors = tensor_lists[0].size();
+  if (n_tensors == 0) {
+    return;
+  }
+  for (int d = 0; d < depth; d++) {
+    TORCH_INTERNAL_ASSERT(tensor_lists[d].size() == n_tensors);
+    for (size_t t = 0; t < n_tensors; t++) {
+      TORCH_INTERNAL_ASSERT(tensor_lists[d][t].is_contiguous());
+      TORCH_INTERNAL_ASSERT(tensor_lists[d][t].numel() == tensor_lists[0][t].numel());
+      TORCH_INTERNAL_ASSERT(tensor_lists[d][t].numel() < std::numeric_limits<int>::max());
+    }
+  }
+
+  const c10::cuda::CUDAGuard device_guard(tensor_lists[0][0].device());
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  TensorListMetadata<depth> tl;
+  int loc_block = 0;
+  int loc_tensor = 0;
+  for (size_t t = 0; t < n_tensors; t++) {
+    int64_t numel = tensor_lists[0][t].numel();
+    if (numel == 0) {
+      continue;
+    }
+    tl.sizes[loc_tensor] = numel;
+    for (int d = 0; d < depth; d++) {
+      tl.addresses[d][loc_tensor] = tensor_lists[d][t].data_ptr();
+    }
+    loc_tensor++;
+
+    int chunks = (numel + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+    for (int chunk = 0; chunk < chunks; chunk++) {
+      tl.block_to_tensor[loc_block] = loc_tensor - 1;
+      tl.block_to_chunk[loc_block] = chunk;
+      loc_block++;
+
+      bool tensors_full = loc_tensor == depth_to_max_tensors[depth - 1] && chunk == chunks - 1;
+      bool blocks_full = loc_block == depth_to_max_blocks[depth - 1];
+      bool last_chunk = t == n_tensors - 1 && chunk == chunks - 1;
+      if (tensors_full || blocks_full || last_chunk) {
+        multi_tensor_apply_kernel<<<loc_block, kMultiTensorBlockSize, 0, stream>>>(
+            tl, callable, args...);
+        AT_CUDA_CHECK(cudaGetLastError());
+
+        // Resume with the current tensor if it has chunks left
+        loc_block = 0;
+        if (chunk == chunks - 1) {
+          loc_tensor = 0;
+        } else {
+          tl.sizes[0] = tl.sizes[loc_tensor - 1];
+          for (int d = 0; d < depth; d++) {
+            tl.addresses[d][0] = tl.addresses[d][loc_tensor - 1];
+          }
+          loc_tensor = 1;
+        }
+      }
+    }
+  }
+  // The last non-empty tensor may be followed by empty ones
+  if (loc_block != 0) {
+    multi_tensor_apply_kernel<<<loc_block, kMultiTensorBlockSize, 0, stream>>>(
+        tl, callable, args...);
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+}
+
+}} // namespace at::native
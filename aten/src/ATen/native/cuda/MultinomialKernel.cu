@@ -4,6 +4,7 @@
 #include <ATen/native/UnaryOps.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/PhiloxUtils.cuh>
 #include <ATen/native/cuda/LaunchUtils.h>
 #include <ATen/AccumulateType.h>
 
@@ -113,7 +114,7 @@ __device__ int binarySearchForMultinomial(scalar_t* cumdist,
 
 template <typename scalar_t>
 __global__ void
-sampleMultinomialWithReplacement(std::pair<uint64_t, uint64_t> seeds,
+sampleMultinomialWithReplacement(PhiloxCudaState philox_args,
                                  int totalSamples,
                                  int64_t* dest,
                                  int64_t distributions,
@@ -127,6 +128,7 @@ sampleMultinomialWithReplacement(std::pair<uint64_t, uint64_t> seeds,
   // global index formula for 1D grid of 2D blocks
   int idx = blockIdx.x * blockDim.x * blockDim.y + threadIdx.y * blockDim.x + threadIdx.x;
 
+  auto seeds = at::cuda::philox::unpack(philox_args);
   curandStatePhilox4_32_10_t state;
   curand_init(seeds.first, idx, seeds.second, &state);
 
@@ -160,7 +162,7 @@ sampleMultinomialWithReplacement(std::pair<uint64_t, uint64_t> seeds,
 
 template <typename scalar_t>
 __global__ void
-sampleMultinomialWithoutReplacement(std::pair<uint64_t, uint64_t> seeds,
+sampleMultinomialWithoutReplacement(PhiloxCudaState philox_args,
                                     int totalSamples,
                                     int sample,
                                     int64_t* dest,
@@ -175,6 +177,7 @@ sampleMultinomialWithoutReplacement(std::pair<uint64_t, uint64_t> seeds,
   // global index formula for 1D grid of 2D blocks
   int idx = blockIdx.x * blockDim.x * blockDim.y + threadIdx.y * blockDim.x + threadIdx.x;
 
+  auto seeds = at::cuda::philox::unpack(philox_args);
   curandStatePhilox4_32_10_t state;
   curand_init(seeds.first, idx, seeds.second, &state);
 
@@ -410,9 +413,9 @@ void multinomial_kernel_impl(Tensor& result, const Tensor& self, const int64_t n
       renormRows(normDist);
 
       // Prefix sum along rows
-      legacy::cuda::_th_cumsum_out(prefixSum, normDist, 1);
+      at::_cumsum_out(prefixSum, normDist, 1);
 
-      std::pair<uint64_t, uint64_t> rng_engine_inputs;
+      PhiloxCudaState rng_engine_inputs;
 
       if (with_replacement) {
         {
@@ -422,7 +425,7 @@ void multinomial_kernel_impl(Tensor& result, const Tensor& self, const int64_t n
           // each thread will utilize one random, however, since we have to use
           // curand_uniform4 (See Note [Register spilling in curand call for CUDA < 10]),
           // offset is 4.
-          rng_engine_inputs = gen->philox_engine_inputs(4);
+          rng_engine_inputs = gen->philox_cuda_state(4);
         }
         // Sample with replacement
 
@@ -464,7 +467,7 @@ void multinomial_kernel_impl(Tensor& result, const Tensor& self, const int64_t n
             renormRows(normDist);
 
             // Prefix sum along rows
-            legacy::cuda::_th_cumsum_out(prefixSum, normDist, 1);
+            at::_cumsum_out(prefixSum, normDist, 1);
           }
           {
             // See Note [Acquire lock when using random generators]
@@ -473,7 +476,7 @@ void multinomial_kernel_impl(Tensor& result, const Tensor& self, const int64_t n
             // each thread will utilize one random, however, since we have to use
             // curand_uniform4 (See Note [Register spilling in curand call for CUDA < 10]),
             // offset is 4.
-            rng_engine_inputs = gen->philox_engine_inputs(4);
+            rng_engine_inputs = gen->philox_cuda_state(4);
           }
 
           // The kernel can only draw one sample before we have to
@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <cuda_fp16.h>
+#include <algorithm>
 #include <cfloat>
 #include <limits>
 #include <stdint.h>
@@ -60,9 +61,13 @@ __device__ __forceinline__ void warp_reduce(acc_t* sum) {
 // input_t=half,  acc_t=float, output_t=half  => read half tensor, float accumulators, write half tensor.
 // input_t=half,  acc_t=float, output_t=float => read half tensor, float accumulators, write float tensor.
 // input_t_float, acc_t=float, output_t=half  => read float tensor, float accumulators, write half tensor.
+// is_masked is a flag indicating whether the elements for which `mask` is true should be treated as -inf.
+// Sample b uses mask row (b / mask_row_div) % mask_rows, so that a mask broadcast over leading dimensions
+// does not have to be materialized.
 
-template <typename input_t, typename output_t, typename acc_t, int log2_elements, bool is_log_softmax>
-__global__ void softmax_warp_forward(output_t *dst, const input_t *src, int batch_size, int stride, int element_count)
+template <typename input_t, typename output_t, typename acc_t, int log2_elements, bool is_log_softmax, bool is_masked>
+__global__ void softmax_warp_forward(output_t *dst, const input_t *src, int batch_size, int stride, int element_count,
+                                     const bool *mask, int mask_row_div, int mask_rows)
 {
     // WARP_SIZE and WARP_BATCH must match the return values batches_per_warp and warp_size of method warp_softmax_forward_kernel.
     constexpr int next_power_of_two = 1 << log2_elements;
@@ -93,10 +98,17 @@ __global__ void softmax_warp_forward(output_t *dst, const input_t *src, int batc
     acc_t elements[WARP_BATCH][WARP_ITERATIONS];
     for (int i = 0;  i < WARP_BATCH;  ++i) {
         int batch_element_count = (i >= local_batches) ? 0 : element_count;
+        const bool *mask_row = is_masked
+            ? mask + ((first_batch + i) / mask_row_div % mask_rows) * element_count + local_idx
+            : nullptr;
         for (int it = 0;  it < WARP_ITERATIONS;  ++it) {
             int element_index = local_idx + it * WARP_SIZE;
             if (element_index < batch_element_count) {
-                elements[i][it] = src[i*element_count+it*WARP_SIZE];
+                if (is_masked && mask_row[it*WARP_SIZE]) {
+                    elements[i][it] = -std::numeric_limits<acc_t>::infinity();
+                } else {
+                    elements[i][it] = src[i*element_count+it*WARP_SIZE];
+                }
             } else {
                 elements[i][it] = -std::numeric_limits<acc_t>::infinity();
             }
@@ -231,14 +243,193 @@ __global__ void softmax_warp_backward(output_t *gradInput, const input_t *grad,
     }
 }
 
+// The softmax_block_* methods handle samples of up to max_persistent_softmax_elements elements, which
+// are too large for one warp to keep in registers. One block of SOFTMAX_BLOCK_THREADS threads works on
+// one sample. Each thread keeps BLOCK_ITERATIONS elements of the sample in registers, so the sample is
+// read from global memory only once, like in the softmax_warp_* methods.
+constexpr int SOFTMAX_BLOCK_THREADS = 512;
+
+template <typename acc_t, template<typename> class ReduceOp>
+__device__ __forceinline__ acc_t block_reduce(acc_t val, acc_t *smem) {
+    constexpr int WARPS = SOFTMAX_BLOCK_THREADS / C10_WARP_SIZE;
+    warp_reduce<acc_t, 1, C10_WARP_SIZE, ReduceOp>(&val);
+    if (threadIdx.x % C10_WARP_SIZE == 0) {
+        smem[threadIdx.x / C10_WARP_SIZE] = val;
+    }
+    __syncthreads();
+    ReduceOp<acc_t> r;
+    acc_t result = smem[0];
+    #pragma unroll
+    for (int i = 1;  i < WARPS;  ++i) {
+        result = r(result, smem[i]);
+    }
+    // smem is reused by the next reduction
+    __syncthreads();
+    return result;
+}
+
+template <typename input_t, typename output_t, typename acc_t, int log2_elements, bool is_log_softmax, bool is_masked>
+C10_LAUNCH_BOUNDS_1(SOFTMAX_BLOCK_THREADS)
+__global__ void softmax_block_forward(output_t *dst, const input_t *src, int stride, int element_count,
+                                      const bool *mask, int mask_row_div, int mask_rows)
+{
+    constexpr int BLOCK_ITERATIONS = (1 << log2_elements) / SOFTMAX_BLOCK_THREADS;
+    __shared__ acc_t smem[SOFTMAX_BLOCK_THREADS / C10_WARP_SIZE];
+
+    int batch = blockIdx.x;
+    int local_idx = threadIdx.x;
+    src += batch * stride + local_idx;
+    dst += batch * stride + local_idx;
+    const bool *mask_row = is_masked
+        ? mask + (batch / mask_row_div % mask_rows) * element_count + local_idx
+        : nullptr;
+
+    // load data from global memory
+    acc_t elements[BLOCK_ITERATIONS];
+    #pragma unroll
+    for (int it = 0;  it < BLOCK_ITERATIONS;  ++it) {
+        int element_index = local_idx + it * SOFTMAX_BLOCK_THREADS;
+        if (element_index < element_count && !(is_masked && mask_row[it*SOFTMAX_BLOCK_THREADS])) {
+            elements[it] = src[it*SOFTMAX_BLOCK_THREADS];
+        } else {
+            elements[it] = -std::numeric_limits<acc_t>::infinity();
+        }
+    }
+
+    // compute max_value
+    acc_t max_value = elements[0];
+    #pragma unroll
+    for (int it = 1;  it < BLOCK_ITERATIONS;  ++it) {
+        max_value = (max_value > elements[it]) ? max_value : elements[it];
+    }
+    max_value = block_reduce<acc_t, Max>(max_value, smem);
+
+    acc_t sum = 0;
+    #pragma unroll
+    for (int it = 0;  it < BLOCK_ITERATIONS;  ++it) {
+        if (is_log_softmax) {
+          sum += std::exp(elements[it] - max_value);
+        } else {
+          elements[it] = std::exp(elements[it] - max_value);
+          sum += elements[it];
+        }
+    }
+    sum = block_reduce<acc_t, Add>(sum, smem);
+
+    // store result
+    if (is_log_softmax) sum = max_value + std::log(sum);
+    #pragma unroll
+    for (int it = 0;  it < BLOCK_ITERATIONS;  ++it) {
+        int element_index = local_idx + it * SOFTMAX_BLOCK_THREADS;
+        if (element_index < element_count) {
+            if (is_log_softmax) {
+                dst[it*SOFTMAX_BLOCK_THREADS] = elements[it] - sum;
+            } else {
+                dst[it*SOFTMAX_BLOCK_THREADS] = elements[it] / sum;
+            }
+        }
+    }
+}
+
+template <typename input_t, typename output_t, typename acc_t, int log2_elements, bool is_log_softmax>
+C10_LAUNCH_BOUNDS_1(SOFTMAX_BLOCK_THREADS)
+__global__ void softmax_block_backward(output_t *gradInput, const input_t *grad, const input_t *output, int stride, int element_count)
+{
+    constexpr int BLOCK_ITERATIONS = (1 << log2_elements) / SOFTMAX_BLOCK_THREADS;
+    __shared__ acc_t smem[SOFTMAX_BLOCK_THREADS / C10_WARP_SIZE];
+
+    int thread_offset = blockIdx.x * stride + threadIdx.x;
+    grad += thread_offset;
+    output += thread_offset;
+    gradInput += thread_offset;
+
+    // load data from global memory
+    acc_t grad_reg[BLOCK_ITERATIONS];
+    acc_t output_reg[BLOCK_ITERATIONS];
+    #pragma unroll
+    for (int it = 0;  it < BLOCK_ITERATIONS;  ++it) {
+        int element_index = threadIdx.x + it * SOFTMAX_BLOCK_THREADS;
+        if (element_index < element_count) {
+            grad_reg[it] = grad[it*SOFTMAX_BLOCK_THREADS];
+            output_reg[it] = output[it*SOFTMAX_BLOCK_THREADS];
+        } else {
+            grad_reg[it] = acc_t(0);
+            output_reg[it] = acc_t(0);
+        }
+    }
+
+    acc_t sum = grad_reg[0];
+    #pragma unroll
+    for (int it = 1;  it < BLOCK_ITERATIONS;  ++it) {
+        sum += grad_reg[it];
+    }
+    sum = block_reduce<acc_t, Add>(sum, smem);
+
+    // store result
+    #pragma unroll
+    for (int it = 0;  it < BLOCK_ITERATIONS;  ++it) {
+        int element_index = threadIdx.x + it * SOFTMAX_BLOCK_THREADS;
+        if (element_index < element_count) {
+            // compute gradients
+            if (is_log_softmax) {
+                gradInput[it*SOFTMAX_BLOCK_THREADS] = (grad_reg[it] - std::exp(output_reg[it]) * sum);
+            } else {
+                gradInput[it*SOFTMAX_BLOCK_THREADS] = (grad_reg[it] - output_reg[it] * sum);
+            }
+        }
+    }
+}
+
 } // end of anonymous namespace
 
-template<typename input_t, typename output_t, typename acc_t, bool is_log_softmax>
-void dispatch_softmax_forward(output_t *dst, const input_t *src, int softmax_elements, int softmax_elements_stride, int batch_count)
+// Largest softmax dimension handled by dispatch_softmax_forward and dispatch_softmax_backward.
+constexpr int max_persistent_softmax_elements = 16384;
+
+// Whether a sample of `softmax_elements` elements is small enough for one warp to keep in registers.
+template <typename input_t>
+inline bool use_warp_softmax(int softmax_elements) {
+    return softmax_elements <= 1024 && softmax_elements * sizeof(input_t) <= 4096;
+}
+
+template<typename input_t, typename output_t, typename acc_t, bool is_log_softmax, bool is_masked = false>
+void dispatch_softmax_forward(output_t *dst, const input_t *src, int softmax_elements, int softmax_elements_stride, int batch_count,
+                              const bool *mask = nullptr, int mask_row_div = 1, int mask_rows = 1)
 {
-    TORCH_INTERNAL_ASSERT( softmax_elements >= 0 && softmax_elements <= 1024 );
+    TORCH_INTERNAL_ASSERT( softmax_elements >= 0 && softmax_elements <= max_persistent_softmax_elements );
     if (softmax_elements == 0) {
         return;
+    } else if (!use_warp_softmax<input_t>(softmax_elements)) {
+        // One block per sample; samples shorter than the block still get one element per thread.
+        int log2_elements = std::max(log2_ceil(softmax_elements), 9);
+        // Launch code would be more elegant if C++ supported FOR CONSTEXPR
+        switch (log2_elements) {
+            case 9: // 512
+                softmax_block_forward<input_t, output_t, acc_t, 9, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            case 10: // 1024
+                softmax_block_forward<input_t, output_t, acc_t, 10, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            case 11: // 2048
+                softmax_block_forward<input_t, output_t, acc_t, 11, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            case 12: // 4096
+                softmax_block_forward<input_t, output_t, acc_t, 12, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            case 13: // 8192
+                softmax_block_forward<input_t, output_t, acc_t, 13, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            case 14: // 16384
+                softmax_block_forward<input_t, output_t, acc_t, 14, is_log_softmax, is_masked>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
+                break;
+            default:
+                break;
+        }
     } else {
         int log2_elements = log2_ceil(softmax_elements);
         const int next_power_of_two = 1 << log2_elements;
@@ -259,48 +450,48 @@ void dispatch_softmax_forward(output_t *dst, const input_t *src, int softmax_ele
         // Launch code would be more elegant if C++ supported FOR CONSTEXPR
         switch (log2_elements) {
             case 0: // 1
-                softmax_warp_forward<input_t, output_t, acc_t, 0, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 0, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 1: // 2
-                softmax_warp_forward<input_t, output_t, acc_t, 1, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 1, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 2: // 4
-                softmax_warp_forward<input_t, output_t, acc_t, 2, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 2, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 3: // 8
-                softmax_warp_forward<input_t, output_t, acc_t, 3, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 3, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 4: // 16
-                softmax_warp_forward<input_t, output_t, acc_t, 4, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 4, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 5: // 32
-                softmax_warp_forward<input_t, output_t, acc_t, 5, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 5, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 6: // 64
-                softmax_warp_forward<input_t, output_t, acc_t, 6, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 6, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 7: // 128
-                softmax_warp_forward<input_t, output_t, acc_t, 7, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 7, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 8: // 256
-                softmax_warp_forward<input_t, output_t, acc_t, 8, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 8, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 9: // 512
-                softmax_warp_forward<input_t, output_t, acc_t, 9, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 9, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             case 10: // 1024
-                softmax_warp_forward<input_t, output_t, acc_t, 10, is_log_softmax>
-                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements);
+                softmax_warp_forward<input_t, output_t, acc_t, 10, is_log_softmax, is_masked>
+                    <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(dst, src, batch_count, softmax_elements_stride, softmax_elements, mask, mask_row_div, mask_rows);
                 break;
             default:
                 break;
@@ -311,9 +502,40 @@ void dispatch_softmax_forward(output_t *dst, const input_t *src, int softmax_ele
 template<typename input_t, typename output_t, typename acc_t, bool is_log_softmax>
 void dispatch_softmax_backward(output_t *grad_input, const input_t *grad, const input_t *output, int softmax_elements, int softmax_elements_stride, int batch_count)
 {
-    TORCH_INTERNAL_ASSERT( softmax_elements >= 0 && softmax_elements <= 1024 );
+    TORCH_INTERNAL_ASSERT( softmax_elements >= 0 && softmax_elements <= max_persistent_softmax_elements );
     if (softmax_elements == 0) {
        return;
+    } else if (!use_warp_softmax<input_t>(softmax_elements)) {
+        int log2_elements = std::max(log2_ceil(softmax_elements), 9);
+        // Launch code would be more elegant if C++ supported FOR CONSTEXPR
+        switch (log2_elements) {
+            case 9: // 512
+                softmax_block_backward<input_t, output_t, acc_t, 9, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            case 10: // 1024
+                softmax_block_backward<input_t, output_t, acc_t, 10, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            case 11: // 2048
+                softmax_block_backward<input_t, output_t, acc_t, 11, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            case 12: // 4096
+                softmax_block_backward<input_t, output_t, acc_t, 12, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            case 13: // 8192
+                softmax_block_backward<input_t, output_t, acc_t, 13, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            case 14: // 16384
+                softmax_block_backward<input_t, output_t, acc_t, 14, is_log_softmax>
+                    <<<batch_count, SOFTMAX_BLOCK_THREADS, 0, at::cuda::getCurrentCUDAStream()>>>(grad_input, grad, output, softmax_elements_stride, softmax_elements);
+                break;
+            default:
+                break;
+        }
     } else {
         int log2_elements = log2_ceil(softmax_elements);
         const int next_power_of_two = 1 << log2_elements;
@@ -382,4 +604,3 @@ void dispatch_softmax_backward(output_t *grad_input, const input_t *grad, const
         }
     }
 }
-
@@ -256,6 +256,55 @@ static void launch_kernel(int64_t N, const func_t& f, array_t data) {
 template<int nt, int vt, typename func_t, typename array_t, std::enable_if_t<!detail::has_same_arg_types<func_t>::value, int> = 0>
 static void launch_kernel(int64_t N, const func_t& f, array_t data) {}
 
+// Vectorized memory access is not enabled on ROCm, see the note in Loops.cuh.
+template<typename func_t, typename array_t>
+static bool launch_vectorized_nd_kernel(const TensorIterator& iter, const func_t& f, array_t data) {
+  return false;
+}
+
+// Dtypes of type promoting kernels are only known at runtime, so their loads
+// can not be vectorized. Instead, each thread fetches and casts all of its
+// `thread_work_size` elements before storing any result, so that the loads
+// are not serialized behind the stores.
+template<int num_threads, int thread_work_size, typename func_t, typename array_t, typename strides_t, typename dtypes_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void unrolled_casting_kernel(int N, func_t f, array_t data, strides_t strides, dtypes_t dtypes) {
+  using return_t = typename function_traits<func_t>::result_type;
+  int idx = num_threads * thread_work_size * blockIdx.x + threadIdx.x;
+
+  // load and compute
+  return_t results[thread_work_size];
+  #pragma unroll
+  for (int i = 0; i < thread_work_size; i++) {
+    int linear_idx = idx + num_threads * i;
+    if (linear_idx < N) {
+      results[i] = legacy::invoke(f, &data.data[1], &strides.data[1], &dtypes.data[1], linear_idx);
+    }
+  }
+
+  // store
+  #pragma unroll
+  for (int i = 0; i < thread_work_size; i++) {
+    int linear_idx = idx + num_threads * i;
+    if (linear_idx < N) {
+      c10::cast_and_store<return_t>(dtypes[0], data[0] + strides[0] * linear_idx, results[i]);
+    }
+  }
+}
+
+template<int nt, int vt, typename func_t, typename array_t, typename strides_t, typename dtypes_t>
+static void launch_unrolled_casting_kernel(int64_t N, const func_t& f, array_t data, strides_t strides, dtypes_t dtypes) {
+  TORCH_INTERNAL_ASSERT(N >= 0 && N <= std::numeric_limits<int32_t>::max());
+  if (N == 0) {
+    return;
+  }
+  dim3 block(nt);
+  dim3 grid((N + block.x * vt - 1) / (block.x * vt));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  unrolled_casting_kernel<nt, vt, func_t, array_t, strides_t, dtypes_t><<<grid, block, 0, stream>>>(N, f, data, strides, dtypes);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 } // namespace modern
 
 }} // namespace at::native
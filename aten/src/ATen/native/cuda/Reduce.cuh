@@ -756,15 +756,30 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t id
     config.output_mult[1] = config.split_output(block_height);
   }
 
-  if (config.input_mult[1] != 0 && config.values_per_thread() >= 256 && num_outputs <= 4096) {
-    // Divide the input across thread-blocks if the amount of work per-thread
-    // is large enough and the size of the output is small enough. This will
-    // require a reduction using global memory.
-    config.ctas_per_output = div_up(config.values_per_thread(), 16);
+  constexpr int min_values_per_thread = 16;
+  constexpr int max_values_per_thread = 256;
+  const int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor / config.num_threads;
+  const int num_mp = at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+  const int target_grid_size = num_mp * blocks_per_sm;
+  int grid_x = config.grid().x;
+  if (config.input_mult[1] != 0 && config.values_per_thread() >= max_values_per_thread && grid_x < target_grid_size) {
+    // Divide the input across thread-blocks if the outputs alone launch too
+    // few blocks to fill the device, e.g. a full reduction or a per-channel
+    // reduction of a large feature map. Launch just enough blocks to fill
+    // the device, unless that would leave a thread with more than
+    // max_values_per_thread values or fewer than min_values_per_thread. The
+    // last block to finish combines the partial results in a fixed order,
+    // so the result does not depend on the scheduling of the blocks.
+    int ctas_per_output1 = div_up(target_grid_size, grid_x);
+    int ctas_per_output2 = div_up(config.values_per_thread(), min_values_per_thread);
+    int ctas_per_output3 = div_up(config.values_per_thread(), max_values_per_thread);
+    config.ctas_per_output = std::max(std::min(ctas_per_output1, ctas_per_output2), ctas_per_output3);
     if (config.ctas_per_output > 65535) {
       config.ctas_per_output = 65535;
     }
-    config.input_mult[2] = config.split_input(config.ctas_per_output);
+    if (config.ctas_per_output > 1) {
+      config.input_mult[2] = config.split_input(config.ctas_per_output);
+    }
   }
 
   at::DataPtr buffer;
@@ -198,6 +198,15 @@ void argmin_kernel_cuda_impl(TensorIterator& iter) {
     thrust::pair<acc_t, int64_t>(at::numeric_limits<acc_t>::upper_bound(), 0));
 };
 
+template <typename scalar_t, typename acc_t=scalar_t>
+void min_max_kernel_cuda_impl(TensorIterator& iter) {
+  gpu_reduce_kernel<scalar_t, scalar_t>(
+    iter,
+    MinMaxOps<acc_t, thrust::tuple<scalar_t, scalar_t>>{},
+    thrust::pair<acc_t, acc_t>(at::numeric_limits<acc_t>::upper_bound(),
+                               at::numeric_limits<acc_t>::lower_bound()));
+};
+
 void argmax_kernel_cuda(TensorIterator& iter) {
   if (iter.dtype(1) == kHalf) {
     // Instead of implementing is_nan and warp_shfl_down
@@ -222,6 +231,16 @@ void argmin_kernel_cuda(TensorIterator& iter) {
   }
 }
 
+void min_max_kernel_cuda(TensorIterator& iter) {
+  if (iter.dtype(2) == kHalf) {
+    min_max_kernel_cuda_impl<at::Half, float>(iter);
+  } else {
+    AT_DISPATCH_ALL_TYPES(iter.dtype(2), "min_max_cuda", [&]() {
+      min_max_kernel_cuda_impl<scalar_t>(iter);
+    });
+  }
+}
+
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_cuda);
 REGISTER_DISPATCH(sum_stub, &sum_kernel_cuda);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_cuda);
@@ -233,5 +252,6 @@ REGISTER_DISPATCH(max_values_stub, &max_values_kernel_cuda);
 REGISTER_DISPATCH(min_values_stub, &min_values_kernel_cuda);
 REGISTER_DISPATCH(argmax_stub, &argmax_kernel_cuda);
 REGISTER_DISPATCH(argmin_stub, &argmin_kernel_cuda);
+REGISTER_DISPATCH(min_max_stub, &min_max_kernel_cuda);
 
 }} // namespace at::native
@@ -0,0 +1,268 @@
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/ReduceOps.h>
+
+#include <cub/device/device_scan.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+template <typename scalar_t>
+struct SumOp {
+  __device__ __forceinline__ scalar_t operator()(const scalar_t a, const scalar_t b) const {
+    return a + b;
+  }
+};
+
+template <typename scalar_t>
+struct ProdOp {
+  __device__ __forceinline__ scalar_t operator()(const scalar_t a, const scalar_t b) const {
+    return a * b;
+  }
+};
+
+/* Perform an inclusive scan along an outer dimension of a tensor.
+ *
+ * - num_orows is the size of the flattened outer dimensions;
+ * - num_irows is the size of the flattened inner dimensions;
+ * - row_size is the size of the dimension along which to scan;
+ *
+ * Thread blocks with the same blockIdx.x process an "outer row" (i.e. an
+ * element of the flattened outer dimensions, which contains several "inner
+ * rows"). Each thread processes a single inner row at a time, so neighbouring
+ * threads read neighbouring elements.
+ */
+template <typename scalar_t, class BinaryOp>
+__global__ void scan_outer_dim_kernel(
+    scalar_t* tgt_, const scalar_t* src_,
+    unsigned num_orows, unsigned num_irows, unsigned row_size,
+    scalar_t init, BinaryOp binary_op) {
+  for (unsigned orow = blockIdx.x; orow < num_orows; orow += gridDim.x) {
+    for (unsigned irow = blockIdx.y * blockDim.x + threadIdx.x; irow < num_irows;
+         irow += gridDim.y * blockDim.x) {
+      const scalar_t* src = src_ + orow * row_size * num_irows + irow;
+      scalar_t* tgt = tgt_ + orow * row_size * num_irows + irow;
+      scalar_t acc = init;
+
+      for (unsigned col = 0; col < row_size; ++col) {
+        acc = binary_op(acc, *src);
+        *tgt = acc;
+
+        src += num_irows;
+        tgt += num_irows;
+      }
+    }
+  }
+}
+
+/* Perform an inclusive scan along the innermost dimension of a tensor.
+ *
+ * - num_rows is the size of the flattened outer dimensions;
+ * - row_size is the size of the innermost dimension;
+ *
+ * Each thread block scans num_threads_y rows at once, num_threads_x threads
+ * per row, with a work-efficient up-sweep/down-sweep over 2 * num_threads_x
+ * elements at a time. The block shape is picked from the row size so that
+ * short rows do not leave most of the block idle.
+ */
+template <typename scalar_t, int num_threads_x, int num_threads_y, class BinaryOp>
+__global__ void scan_innermost_dim_kernel(
+    scalar_t* tgt_, const scalar_t* src_,
+    unsigned num_rows, unsigned row_size,
+    scalar_t init, BinaryOp binary_op) {
+  __shared__ scalar_t sbuf[num_threads_y][2 * num_threads_x];
+
+  scalar_t* row_buf = sbuf[threadIdx.y];
+
+  for (unsigned block_row = blockIdx.x * blockDim.y;
+       block_row < num_rows;
+       block_row += blockDim.y * gridDim.x) {
+    unsigned row = block_row + threadIdx.y;
+    scalar_t block_total = init;
+
+    const scalar_t* row_src = src_ + row * row_size;
+    scalar_t* row_tgt = tgt_ + row * row_size;
+
+    // Perform scan on one block at a time, keeping track of the total value of
+    // all blocks processed so far.
+    for (unsigned block_col = 0; block_col < row_size; block_col += 2 * num_threads_x) {
+      // Load data into shared memory (two values per thread).
+      unsigned col1 = block_col + threadIdx.x;
+      unsigned col2 = block_col + num_threads_x + threadIdx.x;
+      if (row < num_rows) {
+        row_buf[threadIdx.x] = col1 < row_size ? row_src[col1] : init;
+        row_buf[num_threads_x + threadIdx.x] = col2 < row_size ? row_src[col2] : init;
+
+        // Add the total value of all previous blocks to the first value of this block.
+        if (threadIdx.x == 0) {
+          row_buf[0] = binary_op(row_buf[0], block_total);
+        }
+      }
+      __syncthreads();
+
+      // Parallel reduction (up-sweep).
+      for (unsigned s = num_threads_x, d = 1; s >= 1; s >>= 1, d <<= 1) {
+        if (row < num_rows && threadIdx.x < s) {
+          unsigned offset = (2 * threadIdx.x + 1) * d - 1;
+          row_buf[offset + d] = binary_op(row_buf[offset], row_buf[offset + d]);
+        }
+        __syncthreads();
+      }
+
+      // Down-sweep.
+      for (unsigned s = 2, d = num_threads_x / 2; d >= 1; s <<= 1, d >>= 1) {
+        if (row < num_rows && threadIdx.x < s - 1) {
+          unsigned offset = 2 * (threadIdx.x + 1) * d - 1;
+          row_buf[offset + d] = binary_op(row_buf[offset], row_buf[offset + d]);
+        }
+        __syncthreads();
+      }
+
+      // Write back to output.
+      if (row < num_rows) {
+        if (col1 < row_size) row_tgt[col1] = row_buf[threadIdx.x];
+        if (col2 < row_size) row_tgt[col2] = row_buf[num_threads_x + threadIdx.x];
+      }
+      block_total = row_buf[2 * num_threads_x - 1];
+      __syncthreads();
+    }
+  }
+}
+
+template <typename scalar_t, class BinaryOp>
+void scan_outer_dim(
+    scalar_t* tgt, const scalar_t* src,
+    unsigned num_orows, unsigned num_irows, unsigned row_size,
+    scalar_t init, BinaryOp binary_op) {
+  dim3 threads(std::min(512u, num_irows));
+  unsigned max_grid_dim = 1024;
+  dim3 grid(std::min(max_grid_dim, num_orows),
+            std::min(max_grid_dim, (num_irows + threads.x - 1) / threads.x));
+  scan_outer_dim_kernel<<<grid, threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+      tgt, src, num_orows, num_irows, row_size, init, binary_op);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+template <typename scalar_t, int num_threads_x, int num_threads_y, class BinaryOp>
+void launch_scan_innermost_dim(
+    scalar_t* tgt, const scalar_t* src, unsigned num_rows, unsigned row_size,
+    scalar_t init, BinaryOp binary_op) {
+  dim3 threads(num_threads_x, num_threads_y);
+  dim3 grid(std::min(1024u, (num_rows + num_threads_y - 1) / num_threads_y));
+  scan_innermost_dim_kernel<scalar_t, num_threads_x, num_threads_y>
+      <<<grid, threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+          tgt, src, num_rows, row_size, init, binary_op);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+template <typename scalar_t, class BinaryOp>
+void scan_innermost_dim(
+    scalar_t* tgt, const scalar_t* src, unsigned num_rows, unsigned row_size,
+    scalar_t init, BinaryOp binary_op) {
+  // Keep 512 threads per block, but give short rows fewer threads each and
+  // pack more of them into a block.
+  if (row_size <= 8) {
+    launch_scan_innermost_dim<scalar_t, 4, 128>(tgt, src, num_rows, row_size, init, binary_op);
+  } else if (row_size <= 16) {
+    launch_scan_innermost_dim<scalar_t, 8, 64>(tgt, src, num_rows, row_size, init, binary_op);
+  } else {
+    launch_scan_innermost_dim<scalar_t, 16, 32>(tgt, src, num_rows, row_size, init, binary_op);
+  }
+}
+
+// Device-wide scan of `num_rows` contiguous rows, one cub::DeviceScan per row.
+// cub's single-pass decoupled look-back scan keeps the whole device busy on
+// a single row, which the kernels above cannot do with only a few rows.
+template <typename scalar_t>
+struct CubScan {
+  static constexpr bool supported = true;
+
+  template <class BinaryOp>
+  static void run(
+      const Tensor& result, const Tensor& self, int64_t num_rows, int64_t row_size,
+      BinaryOp binary_op) {
+    const scalar_t* src = self.data_ptr<scalar_t>();
+    scalar_t* tgt = result.data_ptr<scalar_t>();
+    auto stream = at::cuda::getCurrentCUDAStream();
+
+    size_t temp_storage_bytes = 0;
+    AT_CUDA_CHECK(cub::DeviceScan::InclusiveScan(
+        nullptr, temp_storage_bytes, src, tgt, binary_op,
+        static_cast<int>(row_size), stream));
+    auto temp_storage = at::empty(
+        {static_cast<int64_t>(temp_storage_bytes)}, self.options().dtype(kByte));
+    for (int64_t row = 0; row < num_rows; row++) {
+      AT_CUDA_CHECK(cub::DeviceScan::InclusiveScan(
+          temp_storage.data_ptr(), temp_storage_bytes,
+          src + row * row_size, tgt + row * row_size, binary_op,
+          static_cast<int>(row_size), stream));
+    }
+  }
+};
+
+// cub does not know how to accumulate at::Half, so half tensors always use
+// the kernels above.
+template <>
+struct CubScan<at::Half> {
+  static constexpr bool supported = false;
+
+  template <class BinaryOp>
+  static void run(const Tensor&, const Tensor&, int64_t, int64_t, BinaryOp) {
+    TORCH_INTERNAL_ASSERT(false, "cub scan does not support Half");
+  }
+};
+
+// Rows at least this long, and at most this many of them, go to cub.
+constexpr int64_t cub_min_row_size = 1 << 16;
+constexpr int64_t cub_max_num_rows = 16;
+
+template <typename scalar_t, class BinaryOp>
+void scan_dim(
+    Tensor& result, const Tensor& self, int64_t dim, scalar_t init,
+    BinaryOp binary_op) {
+  int64_t row_size = self.dim() == 0 ? 1 : self.size(dim);
+  int64_t num_orows = 1;
+  for (int64_t i = 0; i < dim; i++) {
+    num_orows *= self.size(i);
+  }
+  int64_t num_irows = self.numel() / (num_orows * row_size);
+  TORCH_CHECK(self.numel() <= std::numeric_limits<int>::max(),
+      "cumsum/cumprod on CUDA tensors with more than INT_MAX elements is not supported");
+
+  if (CubScan<scalar_t>::supported && num_irows == 1 &&
+      (num_orows == 1 ||
+       (row_size >= cub_min_row_size && num_orows <= cub_max_num_rows))) {
+    CubScan<scalar_t>::run(result, self, num_orows, row_size, binary_op);
+  } else if (num_irows == 1) {
+    scan_innermost_dim<scalar_t>(
+        result.data_ptr<scalar_t>(), self.data_ptr<scalar_t>(),
+        num_orows, row_size, init, binary_op);
+  } else {
+    scan_outer_dim<scalar_t>(
+        result.data_ptr<scalar_t>(), self.data_ptr<scalar_t>(),
+        num_orows, num_irows, row_size, init, binary_op);
+  }
+}
+
+void cumsum_cuda_kernel(Tensor& result, const Tensor& self, int64_t dim) {
+  AT_DISPATCH_ALL_TYPES_AND2(kHalf, kBool, self.scalar_type(), "cumsum_cuda", [&] {
+    scan_dim<scalar_t>(result, self, dim, scalar_t(0), SumOp<scalar_t>());
+  });
+}
+
+void cumprod_cuda_kernel(Tensor& result, const Tensor& self, int64_t dim) {
+  AT_DISPATCH_ALL_TYPES_AND2(kHalf, kBool, self.scalar_type(), "cumprod_cuda", [&] {
+    scan_dim<scalar_t>(result, self, dim, scalar_t(1), ProdOp<scalar_t>());
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(cumsum_stub, &cumsum_cuda_kernel);
+REGISTER_DISPATCH(cumprod_stub, &cumprod_cuda_kernel);
+
+}} // namespace at::native
@@ -485,6 +485,82 @@ cunn_SoftMaxBackward(scalar_t *gradInput, outscalar_t *output, outscalar_t *grad
 
 
 
+// Fused log_softmax + nll_loss, one block per sample. Each thread keeps an
+// online max and sum of exponentials over its share of the row (see
+// _vec_cross_entropy_lastdim in cpu/SoftMaxKernel.cpp), so the input is read
+// once, and the partial sums are rescaled to the block max before they are
+// added up.
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyForward(scalar_t *losses, accscalar_t *lse, scalar_t *target_weight,
+                         scalar_t *input, int64_t *target, scalar_t *weight,
+                         int classes, int64_t ignore_index)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<accscalar_t*>(smem);
+  input += blockIdx.x * classes;
+
+  accscalar_t threadMax = -at::numeric_limits<accscalar_t>::max();
+  accscalar_t threadSum = 0;
+  for (int offset = threadIdx.x; offset < classes; offset += blockDim.x) {
+    accscalar_t v = input[offset];
+    // one of exp(v - threadMax) and exp(threadMax - v) is the rescaling
+    // factor, the other one is 1
+    accscalar_t e = std::exp(-::abs(v - threadMax));
+    if (v > threadMax) {
+      threadSum = threadSum * e + 1;
+      threadMax = v;
+    } else {
+      threadSum += e;
+    }
+  }
+  accscalar_t max_k = blockReduce<Max, accscalar_t>(
+      sdata, threadMax, Max<accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
+  accscalar_t sumAll = blockReduce<Add, accscalar_t>(
+      sdata, threadSum * std::exp(threadMax - max_k), Add<accscalar_t>(), static_cast<accscalar_t>(0));
+
+  if (threadIdx.x == 0) {
+    accscalar_t logsum = std::log(sumAll);
+    lse[blockIdx.x] = max_k + logsum;
+    int64_t cur_target = target[blockIdx.x];
+    if (cur_target == ignore_index) {
+      losses[blockIdx.x] = static_cast<scalar_t>(0);
+      target_weight[blockIdx.x] = static_cast<scalar_t>(0);
+    } else {
+      CUDA_KERNEL_ASSERT(cur_target >= 0 && cur_target < classes);
+      accscalar_t cur_weight = weight != nullptr ? static_cast<accscalar_t>(weight[cur_target])
+                                                 : static_cast<accscalar_t>(1);
+      losses[blockIdx.x] = static_cast<scalar_t>(
+          -(static_cast<accscalar_t>(input[cur_target]) - max_k - logsum) * cur_weight);
+      target_weight[blockIdx.x] = static_cast<scalar_t>(cur_weight);
+    }
+  }
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyBackward(scalar_t *gradInput, scalar_t *gradLosses, scalar_t *input,
+                          int64_t *target, accscalar_t *lse, scalar_t *target_weight,
+                          int classes)
+{
+  gradInput += blockIdx.x * classes;
+  input += blockIdx.x * classes;
+
+  const accscalar_t scale = static_cast<accscalar_t>(gradLosses[blockIdx.x]) *
+                            static_cast<accscalar_t>(target_weight[blockIdx.x]);
+  const accscalar_t lse_k = lse[blockIdx.x];
+  // ignored samples have a zero scale, so their target is never used
+  const int64_t cur_target = target[blockIdx.x];
+  for (int offset = threadIdx.x; offset < classes; offset += blockDim.x) {
+    accscalar_t grad = scale == 0 ? static_cast<accscalar_t>(0)
+                                  : std::exp(static_cast<accscalar_t>(input[offset]) - lse_k) * scale;
+    if (offset == cur_target) {
+      grad -= scale;
+    }
+    gradInput[offset] = static_cast<scalar_t>(grad);
+  }
+}
+
 template<template<typename, typename, typename> class Epilogue, bool is_log_softmax>
 Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_to_float){
   if (half_to_float) AT_ASSERTM(input_.scalar_type() == ScalarType::Half,"conversion is supported for Half type only");
@@ -513,7 +589,7 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
       AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.scalar_type(), "host_softmax", [&] {
       using accscalar_t = acc_type<scalar_t, true>;
       if (!half_to_float) {
-        if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
+        if (dim_size <= max_persistent_softmax_elements) {
           dispatch_softmax_forward<scalar_t, scalar_t, accscalar_t, is_log_softmax>(
               output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size, dim_size, outer_size);
         } else {
@@ -523,7 +599,7 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
           );
         }
       } else {
-        if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
+        if (dim_size <= max_persistent_softmax_elements) {
           dispatch_softmax_forward<scalar_t, accscalar_t, accscalar_t, is_log_softmax>(
               output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size, dim_size, outer_size);
         } else {
@@ -597,7 +673,7 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
     AT_DISPATCH_FLOATING_TYPES_AND_HALF(gI.scalar_type(), "host_softmax_backward", [&] {
     using accscalar_t = acc_type<scalar_t, true>;
     if (!half_to_float) {
-      if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
+      if (dim_size <= max_persistent_softmax_elements) {
         dispatch_softmax_backward<scalar_t, scalar_t, accscalar_t, is_log_softmax>(
             gI.data_ptr<scalar_t>(), grad.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(), dim_size, dim_size, outer_size);
       } else {
@@ -607,7 +683,7 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
         );
       }
     } else {
-      if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
+      if (dim_size <= max_persistent_softmax_elements) {
         dispatch_softmax_backward<accscalar_t, scalar_t, accscalar_t, is_log_softmax>(
             gI.data_ptr<scalar_t>(), grad.data_ptr<accscalar_t>(), output.data_ptr<accscalar_t>(), dim_size, dim_size, outer_size);
       } else {
@@ -678,5 +754,138 @@ Tensor softmax_backward_cuda(const Tensor &grad, const Tensor &output, int64_t d
   return host_softmax_backward<SoftMaxBackwardEpilogue,false>(tmp, output, dim, half_to_float);
 }
 
+Tensor masked_softmax_cuda(const Tensor& self_, const Tensor& mask_) {
+  TORCH_CHECK(mask_.scalar_type() == ScalarType::Bool,
+              "_masked_softmax: expected mask to be a bool tensor, but got ", mask_.scalar_type());
+  TORCH_CHECK(self_.dim() > 0, "_masked_softmax: expected self to have at least one dimension");
+  int64_t dim_size = self_.size(-1);
+  if (dim_size > max_persistent_softmax_elements) {
+    return self_.masked_fill(mask_, -std::numeric_limits<double>::infinity()).softmax(-1);
+  }
+  auto self = self_.contiguous();
+  auto mask = mask_.expand(self.sizes());
+  Tensor output = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (self.numel() == 0) {
+    return output;
+  }
+  int64_t rows = self.numel() / dim_size;
+
+  // A mask that only varies over a contiguous run of the leading dimensions
+  // (e.g. a key padding mask of shape (N, 1, 1, S) applied to (N, H, L, S))
+  // is not materialized: row r uses mask row (r / mask_row_div) % mask_rows.
+  int64_t lo = 0, hi = -1;
+  for (int64_t d = 0; d < self.dim() - 1; d++) {
+    if (mask.stride(d) != 0 && mask.size(d) > 1) {
+      if (hi < 0) lo = d;
+      hi = d;
+    }
+  }
+  bool broadcast_in_run = false;
+  for (int64_t d = lo; d <= hi; d++) {
+    broadcast_in_run |= mask.stride(d) == 0 && mask.size(d) > 1;
+  }
+  int64_t mask_row_div = 1, mask_rows = rows;
+  Tensor mask_rows_t;
+  if (broadcast_in_run) {
+    mask_rows_t = mask.contiguous();
+  } else {
+    mask_rows = 1;
+    mask_rows_t = mask;
+    for (int64_t d = self.dim() - 2; d >= 0; d--) {
+      if (d > hi) {
+        mask_row_div *= self.size(d);
+      } else if (d >= lo) {
+        mask_rows *= self.size(d);
+      }
+      if (d < lo || d > hi) {
+        mask_rows_t = mask_rows_t.narrow(d, 0, 1);
+      }
+    }
+    mask_rows_t = mask_rows_t.contiguous();
+  }
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.scalar_type(), "masked_softmax", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    dispatch_softmax_forward<scalar_t, scalar_t, accscalar_t, /*is_log_softmax=*/false, /*is_masked=*/true>(
+        output.data_ptr<scalar_t>(), self.data_ptr<scalar_t>(), dim_size, dim_size, rows,
+        mask_rows_t.data_ptr<bool>(), mask_row_div, mask_rows);
+  });
+  THCudaCheck(cudaGetLastError());
+  return output;
+}
+
+std::tuple<Tensor, Tensor, Tensor> cross_entropy_loss_forward_cuda(
+    const Tensor &self, const Tensor &target, const Tensor &weight, int64_t ignore_index) {
+  TORCH_CHECK(self.dim() == 2, "input tensor should be 2D");
+  TORCH_CHECK(target.dim() == 1, "1D target tensor expected, multi-target not supported");
+  TORCH_CHECK(self.size(0) == target.size(0),
+              "size mismatch (got input: ", self.sizes(), ", target: ", target.sizes(), ")");
+  TORCH_CHECK(self.size(1) > 0, "input tensor should have at least one class");
+  TORCH_CHECK(!weight.defined() || weight.numel() == self.size(1),
+              "weight tensor should be defined either for all ", self.size(1),
+              " classes or no classes but got weight tensor of shape: ", weight.sizes());
+  auto input = self.contiguous();
+  auto target_ = target.contiguous();
+  auto weight_ = weight.defined() ? weight.contiguous() : weight;
+  const int64_t batch_size = input.size(0);
+  const int64_t classes = input.size(1);
+  auto losses = at::empty({batch_size}, input.options());
+  auto target_weight = at::empty({batch_size}, input.options());
+  // the log denominators are kept in the accumulation type
+  auto lse = at::empty({batch_size}, input.options().dtype(
+      input.scalar_type() == ScalarType::Half ? ScalarType::Float : input.scalar_type()));
+
+  if (batch_size > 0) {
+    cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+    dim3 grid(batch_size);
+    dim3 block = SoftMax_getBlockSize(2, classes);
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.scalar_type(), "cross_entropy_loss_forward_cuda", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      cunn_CrossEntropyForward<scalar_t, accscalar_t>
+        <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+          losses.data_ptr<scalar_t>(), lse.data_ptr<accscalar_t>(), target_weight.data_ptr<scalar_t>(),
+          input.data_ptr<scalar_t>(), target_.data_ptr<int64_t>(),
+          weight_.defined() ? weight_.data_ptr<scalar_t>() : nullptr,
+          classes, ignore_index);
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  return std::make_tuple(losses, lse, target_weight);
+}
+
+Tensor cross_entropy_loss_backward_cuda(
+    const Tensor &grad_losses, const Tensor &self, const Tensor &target,
+    const Tensor &lse, const Tensor &target_weight) {
+  TORCH_CHECK(self.dim() == 2, "input tensor should be 2D");
+  const int64_t batch_size = self.size(0);
+  const int64_t classes = self.size(1);
+  check_dim_size(grad_losses, 1, 0, batch_size);
+  check_dim_size(target, 1, 0, batch_size);
+  check_dim_size(lse, 1, 0, batch_size);
+  check_dim_size(target_weight, 1, 0, batch_size);
+  auto input = self.contiguous();
+  auto grad_losses_ = grad_losses.contiguous();
+  auto target_ = target.contiguous();
+  auto lse_ = lse.contiguous();
+  auto target_weight_ = target_weight.contiguous();
+  auto grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+
+  if (input.numel() > 0) {
+    cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+    dim3 grid(batch_size);
+    dim3 block = SoftMax_getBlockSize(2, classes);
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.scalar_type(), "cross_entropy_loss_backward_cuda", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      cunn_CrossEntropyBackward<scalar_t, accscalar_t>
+        <<<grid, block, 0, stream>>>(
+          grad_input.data_ptr<scalar_t>(), grad_losses_.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(),
+          target_.data_ptr<int64_t>(), lse_.data_ptr<accscalar_t>(), target_weight_.data_ptr<scalar_t>(),
+          classes);
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  return grad_input;
+}
+
 }
 }
@@ -0,0 +1,168 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/WrapDimUtils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/cuda/Sort.cuh>
+
+#include <cuda_fp16.h>
+#include <cub/device/device_segmented_radix_sort.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+// cub knows how to radix sort CUDA's half, not at::Half
+template <typename scalar_t>
+struct cub_key_type {
+  using type = scalar_t;
+};
+
+template <>
+struct cub_key_type<at::Half> {
+  using type = __half;
+};
+
+// Sorts the `nsegments` contiguous rows of length `nsort` of `keys_in`, and
+// permutes `values_in` along with them. All slices are sorted by one launch.
+template <typename scalar_t>
+void segmented_sort_pairs(
+    const Tensor& keys_in,
+    Tensor& keys_out,
+    const Tensor& values_in,
+    Tensor& values_out,
+    int64_t nsegments,
+    int64_t nsort,
+    bool descending) {
+  using key_t = typename cub_key_type<scalar_t>::type;
+  const key_t* keys_in_ptr = reinterpret_cast<const key_t*>(keys_in.data_ptr<scalar_t>());
+  key_t* keys_out_ptr = reinterpret_cast<key_t*>(keys_out.data_ptr<scalar_t>());
+  const int64_t* values_in_ptr = values_in.data_ptr<int64_t>();
+  int64_t* values_out_ptr = values_out.data_ptr<int64_t>();
+
+  int num_items = nsegments * nsort;
+  auto offsets = at::arange(0, num_items + 1, nsort, keys_in.options().dtype(kInt));
+  const int* offsets_ptr = offsets.data_ptr<int>();
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  // The first call only computes the size of the temporary storage
+  size_t temp_storage_bytes = 0;
+  auto sort = [&](void* temp_storage) {
+    if (descending) {
+      AT_CUDA_CHECK(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+          temp_storage, temp_storage_bytes,
+          keys_in_ptr, keys_out_ptr, values_in_ptr, values_out_ptr,
+          num_items, nsegments, offsets_ptr, offsets_ptr + 1,
+          0, sizeof(key_t) * 8, stream));
+    } else {
+      AT_CUDA_CHECK(cub::DeviceSegmentedRadixSort::SortPairs(
+          temp_storage, temp_storage_bytes,
+          keys_in_ptr, keys_out_ptr, values_in_ptr, values_out_ptr,
+          num_items, nsegments, offsets_ptr, offsets_ptr + 1,
+          0, sizeof(key_t) * 8, stream));
+    }
+  };
+  sort(nullptr);
+  auto temp_storage = at::empty(
+      {static_cast<int64_t>(temp_storage_bytes)}, keys_in.options().dtype(kByte));
+  sort(temp_storage.data_ptr());
+}
+
+} // namespace
+
+bool can_use_segmented_sort(const Tensor& self) {
+  switch (self.scalar_type()) {
+#define DEFINE_CASE(ctype, name) case ScalarType::name:
+    AT_FORALL_SCALAR_TYPES_AND(Half, DEFINE_CASE)
+#undef DEFINE_CASE
+      return self.numel() < std::numeric_limits<int>::max();
+    default:
+      return false;
+  }
+}
+
+void segmented_sort_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending,
+    const Tensor& payload) {
+  TORCH_INTERNAL_ASSERT(can_use_segmented_sort(self));
+  TORCH_INTERNAL_ASSERT(values.sizes() == self.sizes() && indices.sizes() == self.sizes());
+  if (self.numel() == 0) {
+    return;
+  }
+  int64_t nsort = self.size(dim);
+  int64_t nsegments = self.numel() / nsort;
+  bool innermost = dim == self.dim() - 1;
+
+  // The keys are copied with the sorted dimension innermost. The copy also
+  // turns every NaN into the positive quiet NaN, whose bit pattern radix
+  // sorts after +inf.
+  auto self_t = self.transpose(dim, -1);
+  auto keys_in = at::empty(self_t.sizes(), self.options());
+  auto keys_out = innermost && values.is_contiguous() ? values : at::empty_like(keys_in);
+  Tensor values_in;
+  if (payload.defined()) {
+    values_in = payload.transpose(dim, -1).contiguous();
+  } else {
+    values_in = at::arange(nsort, indices.options()).expand(self_t.sizes()).contiguous();
+  }
+  auto values_out = innermost && indices.is_contiguous() && !payload.defined()
+      ? indices : at::empty_like(values_in);
+
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Half, self.scalar_type(), "segmented_sort_cuda", [&] {
+    auto iter = TensorIterator::unary_op(keys_in, self_t);
+    gpu_kernel(iter, []GPU_LAMBDA(scalar_t a) -> scalar_t {
+      return a != a ? std::numeric_limits<scalar_t>::quiet_NaN() : a;
+    });
+    segmented_sort_pairs<scalar_t>(
+        keys_in, keys_out, values_in, values_out, nsegments, nsort, descending);
+  });
+
+  if (!keys_out.is_same(values)) {
+    values.copy_(keys_out.transpose(dim, -1));
+  }
+  if (!values_out.is_same(indices)) {
+    indices.copy_(values_out.transpose(dim, -1));
+  }
+}
+
+std::tuple<Tensor&, Tensor&> sort_out_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  if (!can_use_segmented_sort(self)) {
+    return legacy::cuda::_th_sort_out(values, indices, self, dim, descending);
+  }
+  TORCH_CHECK(values.scalar_type() == self.scalar_type(),
+              "sort(): expected values to have dtype ", self.scalar_type(),
+              " but got ", values.scalar_type());
+  TORCH_CHECK(indices.scalar_type() == kLong,
+              "sort(): expected indices to have dtype Long but got ", indices.scalar_type());
+  dim = maybe_wrap_dim(dim, self.dim());
+  values.resize_(self.sizes());
+  indices.resize_(self.sizes());
+  if (self.dim() == 0 || self.size(dim) == 1) {
+    values.copy_(self);
+    indices.zero_();
+    return std::forward_as_tuple(values, indices);
+  }
+  segmented_sort_cuda(values, indices, self, dim, descending);
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> sort_cuda(const Tensor& self, int64_t dim, bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return sort_out_cuda(values, indices, self, dim, descending);
+}
+
+}} // namespace at::native
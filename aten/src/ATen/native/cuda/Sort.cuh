@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at { namespace native {
+
+// Whether segmented_sort_cuda supports `self`. Otherwise callers fall back
+// to the THC sort.
+bool can_use_segmented_sort(const Tensor& self);
+
+// Sorts every slice of `self` along `dim` with a single segmented radix sort
+// launch, writing the sorted keys to `values` and the position of each key
+// within its slice to `indices`. Both outputs must already have the shape of
+// `self`. If `payload` is given, its elements are permuted along with the
+// keys and written to `indices` instead of the positions.
+//
+// Like the comparison based sorts, NaN compares greater than every number.
+// The sort is stable.
+void segmented_sort_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending,
+    const Tensor& payload = Tensor());
+
+}} // namespace at::native
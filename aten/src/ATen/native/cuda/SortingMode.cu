@@ -0,0 +1,141 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/native/SortingUtils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/macros/Macros.h>
+
+#include <ATen/native/cuda/Sort.cuh>
+
+namespace at {
+namespace native {
+
+namespace {
+
+constexpr int MODE_BLOCK_SIZE = 256;
+
+// One block per slice of the sorted input. Each thread measures the runs of
+// equal values that start at its positions, then the block picks the longest
+// run. Ties go to the smallest value, and the index reported is the one of
+// the last appearance of the mode, since the sort is stable.
+template <typename scalar_t>
+C10_LAUNCH_BOUNDS_1(MODE_BLOCK_SIZE)
+__global__ void compute_mode_kernel(
+    const scalar_t* sorted_values,
+    const int64_t* sorted_indices,
+    int64_t slice_size,
+    scalar_t* mode_values,
+    int64_t* mode_indices) {
+  __shared__ int64_t counts[MODE_BLOCK_SIZE];
+  __shared__ int64_t positions[MODE_BLOCK_SIZE];
+
+  const scalar_t* slice = sorted_values + blockIdx.x * slice_size;
+
+  int64_t best_count = 0;
+  int64_t best_position = 0;
+  for (int64_t i = threadIdx.x; i < slice_size; i += blockDim.x) {
+    if (i > 0 && slice[i] == slice[i - 1]) {
+      continue;
+    }
+    int64_t end = i + 1;
+    while (end < slice_size && slice[end] == slice[i]) {
+      end++;
+    }
+    // Positions increase within a thread, so a strictly longer run is
+    // needed to replace the current one
+    if (end - i > best_count) {
+      best_count = end - i;
+      best_position = end - 1;
+    }
+  }
+  counts[threadIdx.x] = best_count;
+  positions[threadIdx.x] = best_position;
+  __syncthreads();
+
+  for (int stride = blockDim.x / 2; stride > 0; stride /= 2) {
+    if (threadIdx.x < stride) {
+      int64_t other_count = counts[threadIdx.x + stride];
+      int64_t other_position = positions[threadIdx.x + stride];
+      if (other_count > counts[threadIdx.x] ||
+          (other_count == counts[threadIdx.x] && other_position < positions[threadIdx.x])) {
+        counts[threadIdx.x] = other_count;
+        positions[threadIdx.x] = other_position;
+      }
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    mode_values[blockIdx.x] = slice[positions[0]];
+    mode_indices[blockIdx.x] = sorted_indices[blockIdx.x * slice_size + positions[0]];
+  }
+}
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> _mode_out_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool keepdim) {
+  if (!can_use_segmented_sort(self)) {
+    return legacy::cuda::_th_mode_out(values, indices, self, dim, keepdim);
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  _reduction_with_indices_allocate_or_resize_output(
+      values, indices, self, dim, keepdim);
+  if (self.dim() == 0 && self.numel() == 1) {
+    values.copy_(self);
+    indices.zero_();
+    return std::forward_as_tuple(values, indices);
+  }
+  if (self.numel() == 0) {
+    return std::forward_as_tuple(values, indices);
+  }
+
+  // Move `dim` innermost, keeping the order of the other dimensions, so that
+  // the slices come out of the sort in the order of the output elements
+  std::vector<int64_t> permutation;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d != dim) {
+      permutation.push_back(d);
+    }
+  }
+  permutation.push_back(dim);
+  auto self_t = self.permute(permutation);
+
+  // Sort all the slices with one launch
+  auto sorted_values = at::empty(self_t.sizes(), self.options());
+  auto sorted_indices = at::empty(self_t.sizes(), indices.options());
+  segmented_sort_cuda(
+      sorted_values, sorted_indices, self_t, self.dim() - 1, /*descending=*/false);
+
+  int64_t slice_size = self.size(dim);
+  int64_t num_slices = self.numel() / slice_size;
+  auto mode_values = at::empty({num_slices}, self.options());
+  auto mode_indices = at::empty({num_slices}, indices.options());
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Half, self.scalar_type(), "mode_cuda", [&] {
+    compute_mode_kernel<scalar_t><<<num_slices, MODE_BLOCK_SIZE, 0, stream>>>(
+        sorted_values.data_ptr<scalar_t>(),
+        sorted_indices.data_ptr<int64_t>(),
+        slice_size,
+        mode_values.data_ptr<scalar_t>(),
+        mode_indices.data_ptr<int64_t>());
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+
+  values.copy_(mode_values.view(values.sizes()));
+  indices.copy_(mode_indices.view(indices.sizes()));
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> _mode_cuda(const Tensor& self, int64_t dim, bool keepdim) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return _mode_out_cuda(values, indices, self, dim, keepdim);
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,272 @@
+#include <ATen/ATen.h>
+#include <ATen/native/SortingUtils.h>
+#include <c10/macros/Macros.h>
+#include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/detail/TensorInfo.cuh>
+#include <THC/THCDeviceUtils.cuh> // only for THCRoundUp?
+#include <THC/THCNumerics.cuh>
+#include <THC/THCScanUtils.cuh>
+#include <THC/THCTensorMathReduce.cuh> // AddOp
+
+#include <ATen/native/cuda/Sort.cuh>
+#include <ATen/native/cuda/SortingCommon.cuh>
+#include <ATen/native/cuda/SortingRadixSelect.cuh>
+
+namespace at {
+namespace native {
+
+namespace {
+
+template <typename scalar_t, typename index_t, int Dim, bool Order>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void gatherTopK(
+    cuda::detail::TensorInfo<scalar_t, index_t> input,
+    index_t inputSliceSize,
+    index_t outputSliceSize, // aka `k`
+
+    index_t numInputSlices,
+    index_t inputWithinSliceStride,
+
+    cuda::detail::TensorInfo<scalar_t, index_t> topK,
+    index_t topKWithinSliceStride,
+
+    cuda::detail::TensorInfo<int64_t, index_t> indices,
+    index_t indicesWithinSliceStride) {
+  // Indices are limited to integer fp precision, so counts can fit in
+  // int32, regardless of index_t
+#ifdef __HIP_PLATFORM_HCC__
+  __shared__ int smem[64];
+#else
+  __shared__ int smem[32]; // one per each warp, up to warp limit
+#endif
+
+  index_t slice = getLinearBlockId<index_t>();
+  if (slice >= numInputSlices) {
+    return;
+  }
+
+  // Find the start offset for our slice
+  index_t sliceStartIndex =
+      cuda::detail::IndexToOffset<scalar_t, index_t, Dim>::get(slice, input);
+  index_t topKSliceStartIndex =
+      cuda::detail::IndexToOffset<scalar_t, index_t, Dim>::get(slice, topK);
+  index_t indicesSliceStartIndex =
+      cuda::detail::IndexToOffset<int64_t, index_t, Dim>::get(slice, indices);
+
+  scalar_t* inputSliceStart = &input.data[sliceStartIndex];
+  scalar_t* topKSliceStart = &topK.data[topKSliceStartIndex];
+  int64_t* indicesSliceStart = &indices.data[indicesSliceStartIndex];
+
+  // Find the k-th highest element in our input
+  scalar_t topKValue = static_cast<scalar_t>(0);
+  radixSelect<
+      scalar_t,
+      typename TopKTypeConfig<scalar_t>::RadixType,
+      index_t,
+      Order>(
+      inputSliceStart,
+      outputSliceSize,
+      inputSliceSize,
+      inputWithinSliceStride,
+      smem,
+      &topKValue);
+
+  // Every value that is strictly less/greater than `pattern`
+  // (depending on sort dir) in sorted int format is in the top-K.
+  // The top-K value itself might not be unique.
+  //
+  // Since there are a variable number of elements that we see that
+  // are within the top-k, we don't know at what index to write out
+  // the resulting values.
+  // In order to get this, we perform an exclusive prefix sum of
+  // `hasTopK`. This will return the resulting index into which we
+  // need to write the result, if a thread has a result.
+
+  // All threads need to participate in the loop and the prefix sum,
+  // but not necessarily in the load; hence loop bounds being rounded
+  // up to a multiple of the block dim.
+  index_t numIterations = THCRoundUp(inputSliceSize, (index_t) blockDim.x);
+  index_t writeIndexStart = 0;
+
+  for (index_t i = threadIdx.x; i < numIterations; i += blockDim.x) {
+    bool inRange = (i < inputSliceSize);
+    scalar_t v = inRange ? doLdg(&inputSliceStart[i * inputWithinSliceStride])
+                         : static_cast<scalar_t>(0);
+    bool hasTopK;
+    if (Order) {
+      hasTopK = inRange && (THCNumerics<scalar_t>::gt(v, topKValue));
+    } else {
+      hasTopK = inRange && (THCNumerics<scalar_t>::lt(v, topKValue));
+    }
+
+    int index;
+    int carry;
+    exclusiveBinaryPrefixScan<int, true>(smem, hasTopK, &index, &carry, AddOp<int>());
+
+    if (hasTopK) {
+      int writeIndex = writeIndexStart + index;
+      CUDA_KERNEL_ASSERT(writeIndex < outputSliceSize);
+
+      index_t topKOffset = writeIndex * topKWithinSliceStride;
+      index_t indexOffset = writeIndex * indicesWithinSliceStride;
+
+      topKSliceStart[topKOffset] = v;
+      indicesSliceStart[indexOffset] = i;
+    }
+
+    writeIndexStart += carry;
+  }
+
+  // We need to fill in the rest with actual == top-K values.
+  // The number that we need is outputSliceSize -
+  // writeIndexStart. There might be more than that number available,
+  // in which case we have to choose the first seen set. We do this
+  // via a prefix sum to calculate indices for writing results.
+  CUDA_KERNEL_ASSERT(outputSliceSize >= writeIndexStart);
+  index_t topKRemaining = (outputSliceSize - writeIndexStart);
+
+  for (index_t i = threadIdx.x; i < numIterations; i += blockDim.x) {
+    bool inRange = (i < inputSliceSize);
+    scalar_t v = inRange ? doLdg(&inputSliceStart[i * inputWithinSliceStride])
+                         : static_cast<scalar_t>(0);
+    bool hasTopK = inRange && (THCNumerics<scalar_t>::eq(v, topKValue));
+
+    int index;
+    int carry;
+    exclusiveBinaryPrefixScan<int, true>(smem, hasTopK, &index, &carry, AddOp<int>());
+
+    if (hasTopK && index < topKRemaining) {
+      int writeIndex = writeIndexStart + index;
+      CUDA_KERNEL_ASSERT(writeIndex < outputSliceSize);
+
+      index_t topKOffset = writeIndex * topKWithinSliceStride;
+      index_t indexOffset = writeIndex * indicesWithinSliceStride;
+
+      topKSliceStart[topKOffset] = v;
+      indicesSliceStart[indexOffset] = i;
+    }
+
+    if (carry >= topKRemaining) {
+      break;
+    }
+
+    topKRemaining -= carry;
+    writeIndexStart += carry;
+  }
+}
+
+struct TopKLauncher {
+  int64_t k;
+  bool largest;
+
+  TopKLauncher(int64_t k, bool largest) : k(k), largest(largest) {}
+
+  template <typename scalar_t, typename index_t, int all_dims>
+  inline void launch(
+      cuda::detail::TensorInfo<scalar_t, index_t> values_info,
+      int collapse_values_dim,
+      cuda::detail::TensorInfo<int64_t, index_t> indices_info,
+      int collapse_indices_dim,
+      cuda::detail::TensorInfo<scalar_t, index_t> self_info,
+      int collapse_self_dim,
+      int64_t num_slices,
+      int64_t slice_size) {
+    dim3 grid;
+    if (!getGridFromTiles(num_slices, grid)) {
+      AT_ERROR("slices are too many");
+    }
+
+    dim3 block(
+        std::min(THCRoundUp(slice_size, (int64_t)C10_WARP_SIZE), (int64_t)1024));
+    auto stream = at::cuda::getCurrentCUDAStream();
+    // The actual dimension that the k-selection is running in
+    // may have changed from collapseDims()
+    if (largest) {
+      gatherTopK<scalar_t, index_t, all_dims, true><<<grid, block, 0, stream>>>(
+          self_info,
+          slice_size,
+          k,
+          num_slices,
+          self_info.strides[collapse_self_dim],
+          values_info,
+          values_info.strides[collapse_values_dim],
+          indices_info,
+          indices_info.strides[collapse_indices_dim]);
+    } else {
+      gatherTopK<scalar_t, index_t, all_dims, false><<<grid, block, 0, stream>>>(
+          self_info,
+          slice_size,
+          k,
+          num_slices,
+          self_info.strides[collapse_self_dim],
+          values_info,
+          values_info.strides[collapse_values_dim],
+          indices_info,
+          indices_info.strides[collapse_indices_dim]);
+    }
+  }
+};
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> topk_out_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t k,
+    int64_t dim_,
+    bool largest,
+    bool sorted) {
+  int64_t dim = maybe_wrap_dim(dim_, self.dim(), /*wrap_scalar=*/true);
+  TORCH_CHECK(
+      k >= 0 && k <= (self.dim() > 0 ? self.size(dim) : 1),
+      "selected index k out of range");
+
+  _allocate_or_resize_output_with_indices(values, indices, self, dim_, k);
+  if (self.dim() == 0 && self.numel() == 1) {
+    values.copy_(self);
+    indices.zero_();
+    return std::forward_as_tuple(values, indices);
+  }
+  if (self.numel() == 0 || k == 0) {
+    return std::forward_as_tuple(values, indices);
+  }
+
+  TORCH_CHECK(
+      self.dim() <= MAX_TENSORINFO_DIMS,
+      "cannot operate on more than ",
+      MAX_TENSORINFO_DIMS,
+      " dimensions");
+
+  // Select the top-k of every slice with one block per slice
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Half, self.scalar_type(), "topk_cuda", [&] {
+    if (cuda::detail::canUse32BitIndexMath(self) &&
+        cuda::detail::canUse32BitIndexMath(values) &&
+        cuda::detail::canUse32BitIndexMath(indices)) {
+      run_launcher<scalar_t, uint32_t>(
+          values, indices, self, dim, TopKLauncher(k, largest));
+    } else {
+      run_launcher<scalar_t, uint64_t>(
+          values, indices, self, dim, TopKLauncher(k, largest));
+    }
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+
+  // The selection does not order the results, so sort all the slices
+  // together, carrying the selected indices along with the values
+  if (sorted && k > 1) {
+    if (can_use_segmented_sort(values)) {
+      segmented_sort_cuda(values, indices, values, dim, largest, /*payload=*/indices);
+    } else {
+      Tensor sorted_values, sorted_perm;
+      std::tie(sorted_values, sorted_perm) = values.sort(dim, largest);
+      indices.copy_(indices.gather(dim, sorted_perm));
+      values.copy_(sorted_values);
+    }
+  }
+
+  return std::forward_as_tuple(values, indices);
+}
+
+} // namespace native
+} // namespace at
@@ -151,6 +151,87 @@ __global__ void upsample_bilinear2d_backward_out_frame(
   }
 }
 
+// Backward (adjoint) operation 1 <- 2 for integer upscale factors without
+// align_corners. Instead of scattering every element of grad_output with
+// atomics, each thread gathers one element of grad_input from the output
+// pixels whose interpolation reads it. With an integer factor those lie in a
+// window of about 3 * factor rows and columns around factor * (h1, w1). The
+// weights are recomputed exactly as in the kernel above, so both agree on
+// which output pixels contribute, and the sum is accumulated in accscalar_t.
+template <typename scalar_t, typename accscalar_t>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void upsample_bilinear2d_backward_gather_out_frame(
+    const size_t nc,
+    const int height1,
+    const int width1,
+    const int height2,
+    const int width2,
+    const int height_factor,
+    const int width_factor,
+    const accscalar_t rheight,
+    const accscalar_t rwidth,
+    scalar_t* __restrict__ idata,
+    const scalar_t* __restrict__ odata) {
+  const size_t i_numel = nc * width1 * height1;
+  for (size_t index = blockDim.x * blockIdx.x + threadIdx.x; index < i_numel;
+       index += blockDim.x * gridDim.x) {
+    size_t index_temp = index;
+    const int w1 = index_temp % width1;
+    index_temp /= width1;
+    const int h1 = index_temp % height1;
+    const size_t c = index_temp / height1;
+
+    const int h2_begin = max((h1 - 1) * height_factor - 1, 0);
+    const int h2_end = min((h1 + 2) * height_factor + 1, height2);
+    const int w2_begin = max((w1 - 1) * width_factor - 1, 0);
+    const int w2_end = min((w1 + 2) * width_factor + 1, width2);
+
+    const scalar_t* odata_c = odata + c * height2 * width2;
+    accscalar_t grad = 0;
+    for (int h2 = h2_begin; h2 < h2_end; h2++) {
+      const accscalar_t h1r = area_pixel_compute_source_index<accscalar_t>(
+          rheight, h2, /*align_corners=*/false, /*cubic=*/false);
+      const int h1_src = h1r;
+      const int h1p = (h1_src < height1 - 1) ? 1 : 0;
+      const accscalar_t h1lambda = h1r - h1_src;
+      const accscalar_t h0lambda = static_cast<accscalar_t>(1) - h1lambda;
+      accscalar_t hweight = 0;
+      if (h1_src == h1) {
+        hweight += h0lambda;
+      }
+      if (h1_src + h1p == h1) {
+        hweight += h1lambda;
+      }
+      if (hweight == static_cast<accscalar_t>(0)) {
+        continue;
+      }
+
+      accscalar_t row_grad = 0;
+      for (int w2 = w2_begin; w2 < w2_end; w2++) {
+        const accscalar_t w1r = area_pixel_compute_source_index<accscalar_t>(
+            rwidth, w2, /*align_corners=*/false, /*cubic=*/false);
+        const int w1_src = w1r;
+        const int w1p = (w1_src < width1 - 1) ? 1 : 0;
+        const accscalar_t w1lambda = w1r - w1_src;
+        const accscalar_t w0lambda = static_cast<accscalar_t>(1) - w1lambda;
+        accscalar_t wweight = 0;
+        if (w1_src == w1) {
+          wweight += w0lambda;
+        }
+        if (w1_src + w1p == w1) {
+          wweight += w1lambda;
+        }
+        if (wweight != static_cast<accscalar_t>(0)) {
+          row_grad += wweight *
+              static_cast<accscalar_t>(odata_c[h2 * width2 + w2]);
+        }
+      }
+      grad += hweight * row_grad;
+    }
+    idata[index] = static_cast<scalar_t>(grad);
+  }
+}
+
 static void upsample_bilinear2d_out_cuda_template(
     Tensor& output,
     const Tensor& input,
@@ -269,15 +350,62 @@ static void upsample_bilinear2d_backward_out_cuda_template(
   
   // A contiguous tensor is required for the kernel launch config
   grad_input.contiguous();
+
+  const int num_threads = std::min(
+      at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, 1024);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  // Upscaling by integer factors (the common case in decoders) can gather
+  // instead of scatter, which needs neither atomics nor zeroing grad_input.
+  const bool integer_factors = !align_corners &&
+      output_height % input_height == 0 && output_width % input_width == 0;
+  const int height_factor = output_height / input_height;
+  const int width_factor = output_width / input_width;
+  const bool use_gather = integer_factors &&
+      (!scales_h.has_value() || scales_h.value() == height_factor) &&
+      (!scales_w.has_value() || scales_w.value() == width_factor);
+
+  if (use_gather) {
+    const size_t num_kernels = nbatch * channels * input_height * input_width;
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+        grad_output.scalar_type(), "upsample_bilinear2d_backward_gather_out_frame", [&] {
+          using accscalar_t = at::acc_type<scalar_t, true>;
+
+          auto idata = grad_input.data_ptr<scalar_t>();
+          auto odata = grad_output.data_ptr<scalar_t>();
+
+          const accscalar_t rheight = area_pixel_compute_scale<accscalar_t>(
+              input_height, output_height, align_corners, scales_h);
+          const accscalar_t rwidth = area_pixel_compute_scale<accscalar_t>(
+              input_width, output_width, align_corners, scales_w);
+
+          upsample_bilinear2d_backward_gather_out_frame<scalar_t, accscalar_t>
+              <<<cuda::ATenCeilDiv(num_kernels, static_cast<size_t>(num_threads)),
+                 num_threads,
+                 0,
+                 stream>>>(
+                  nbatch * channels,
+                  input_height,
+                  input_width,
+                  output_height,
+                  output_width,
+                  height_factor,
+                  width_factor,
+                  rheight,
+                  rwidth,
+                  idata,
+                  odata);
+        });
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
+
   // initialization to zero is required here. As we launch one thread per output
   // element, and atomicAdd to input gradient. Given a sparse sampling case, our
   // threads are not covering the whole input tensor.
   grad_input.zero_();
 
   const size_t num_kernels = nbatch * channels * output_height * output_width;
-  const int num_threads = std::min(
-      at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, 1024);
-  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       grad_output.scalar_type(), "upsample_bilinear2d_backward_out_frame", [&] {
@@ -2,9 +2,11 @@
 
 #include <ATen/ATen.h>
 #include <ATen/AccumulateType.h>
+#include <ATen/CUDAGenerator.h>
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/PhiloxUtils.cuh>
 #include <ATen/cuda/detail/IndexUtils.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
@@ -96,17 +98,22 @@ __global__ void LayerNormForwardCUDAKernel(
   }
 }
 
+// Computes dX of one row per block. The two row sums are reduced over the
+// block and turned into the coefficients of dX without a round trip through
+// global memory, so dX takes a single launch.
 template <typename T>
-__global__ void ComputeInternalGradientsCUDAKernel(
+__global__ void LayerNormBackwardFusedCUDAKernel(
     int64_t N,
     const T* dY,
     const T* X,
+    const T* mean,
+    const T* rstd,
     const T* gamma,
-    acc_type<T, true>* ds,
-    acc_type<T, true>* db) {
+    T* dX) {
   using T_ACC = acc_type<T, true>;
   __shared__ T_ACC ds_shared[C10_WARP_SIZE];
   __shared__ T_ACC db_shared[C10_WARP_SIZE];
+  __shared__ T_ACC coeffs[2];
   const int64_t i = blockIdx.x;
   T_ACC sum1 = 0;
   T_ACC sum2 = 0;
@@ -120,55 +127,23 @@ __global__ void ComputeInternalGradientsCUDAKernel(
   }
   sum1 = BlockReduceSum<T_ACC>(sum1, ds_shared);
   sum2 = BlockReduceSum<T_ACC>(sum2, db_shared);
+  const T_ACC mean_v = static_cast<T_ACC>(mean[i]);
+  const T_ACC rstd_v = static_cast<T_ACC>(rstd[i]);
   if (threadIdx.x == 0) {
-    ds[i] = sum1;
-    db[i] = sum2;
-  }
-}
-
-template <typename T>
-__global__ void ComputeGradientFusedParamsCUDAKernel(
-    int64_t M,
-    int64_t N,
-    const T* mean,
-    const T* rstd,
-    const acc_type<T, true>* ds,
-    const acc_type<T, true>* db,
-    acc_type<T, true>* c1,
-    acc_type<T, true>* c2) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
-  if (index < M) {
     const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
-    const T_ACC a = (db[index] * static_cast<T_ACC>(mean[index]) - ds[index]) *
-        static_cast<T_ACC>(rstd[index]) * static_cast<T_ACC>(rstd[index]) *
-        static_cast<T_ACC>(rstd[index]) * s;
-    c1[index] = a;
-    c2[index] =
-        -(a * static_cast<T_ACC>(mean[index]) +
-          db[index] * static_cast<T_ACC>(rstd[index]) * s);
+    const T_ACC b = (sum2 * mean_v - sum1) * rstd_v * rstd_v * rstd_v * s;
+    coeffs[0] = b;
+    coeffs[1] = -(b * mean_v + sum2 * rstd_v * s);
   }
-}
-
-template <typename T>
-__global__ void LayerNormBackwardCUDAKenrel(
-    int64_t N,
-    const T* dY,
-    const T* X,
-    const T* gamma,
-    const T* a,
-    const acc_type<T, true>* b,
-    const acc_type<T, true>* c,
-    T* dX) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t i = blockIdx.x;
+  __syncthreads();
+  const T_ACC b = coeffs[0];
+  const T_ACC c = coeffs[1];
   for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
     const int64_t index = i * N + j;
     const T_ACC gamma_v =
         gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
-    dX[index] =
-        static_cast<T_ACC>(a[i]) * static_cast<T_ACC>(dY[index]) * gamma_v +
-        b[i] * static_cast<T_ACC>(X[index]) + c[i];
+    dX[index] = rstd_v * static_cast<T_ACC>(dY[index]) * gamma_v +
+        b * static_cast<T_ACC>(X[index]) + c;
   }
 }
 
@@ -279,6 +254,117 @@ __global__ void GammaBetaBackwardCUDAKernel(
   }
 }
 
+// Normalizes one row of S = dropout(X) + R per block. Dropout, the residual
+// add and the moments take one pass over X and R that also writes S, and the
+// row of S is read back by the same block, so no dropout mask is stored.
+template <typename T>
+__global__ void DropoutAddLayerNormForwardCUDAKernel(
+    int64_t N,
+    float p,
+    T eps,
+    PhiloxCudaState philox_args,
+    const T* X,
+    const T* R,
+    const T* gamma,
+    const T* beta,
+    int64_t* rng_state,
+    T* S,
+    T* Y,
+    T* mean,
+    T* rstd) {
+  using T_ACC = acc_type<T, true>;
+  __shared__ T_ACC m_shared[C10_WARP_SIZE];
+  __shared__ T_ACC v_shared[C10_WARP_SIZE];
+  __shared__ T_ACC moments[2];
+  const auto seeds = at::cuda::philox::unpack(philox_args);
+  // The generator counts its offset in 32-bit values, philox_engine in
+  // groups of four.
+  const uint64_t offset = seeds.second / 4;
+  const int64_t i = blockIdx.x;
+  if (i == 0 && threadIdx.x == 0) {
+    rng_state[0] = static_cast<int64_t>(seeds.first);
+    rng_state[1] = static_cast<int64_t>(offset);
+  }
+  const T_ACC keep_scale = T_ACC(1) / (T_ACC(1) - static_cast<T_ACC>(p));
+  T_ACC sum1 = 0;
+  T_ACC sum2 = 0;
+  for (int64_t j = threadIdx.x * 4; j < N; j += blockDim.x * 4) {
+    bool keep[4];
+    DropoutKeepMask4(seeds.first, offset, N, i, j, p, keep);
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      if (j + k < N) {
+        const int64_t index = i * N + j + k;
+        T_ACC s = static_cast<T_ACC>(R[index]);
+        if (keep[k]) {
+          s += static_cast<T_ACC>(X[index]) * keep_scale;
+        }
+        const T s_val = static_cast<T>(s);
+        S[index] = s_val;
+        sum1 += static_cast<T_ACC>(s_val);
+        sum2 += static_cast<T_ACC>(s_val) * static_cast<T_ACC>(s_val);
+      }
+    }
+  }
+  sum1 = BlockReduceSum<T_ACC>(sum1, m_shared);
+  sum2 = BlockReduceSum<T_ACC>(sum2, v_shared);
+  if (threadIdx.x == 0) {
+    const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
+    sum1 *= scale;
+    sum2 = c10::cuda::compat::max(sum2 * scale - sum1 * sum1, T_ACC(0));
+    sum2 = c10::cuda::compat::rsqrt(sum2 + static_cast<T_ACC>(eps));
+    moments[0] = sum1;
+    moments[1] = sum2;
+    mean[i] = sum1;
+    rstd[i] = sum2;
+  }
+  __syncthreads();
+  const T_ACC mean_v = moments[0];
+  const T_ACC rstd_v = moments[1];
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    const int64_t index = i * N + j;
+    const T_ACC gamma_v =
+        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
+    const T_ACC beta_v =
+        beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta[j]);
+    Y[index] = (static_cast<T_ACC>(S[index]) - mean_v) * rstd_v * gamma_v +
+        beta_v;
+  }
+}
+
+// dX = dS * mask / (1 - p), with the mask of DropoutAddLayerNormForwardCUDAKernel
+// regenerated from rng_state. Each thread handles four columns of a row.
+template <typename T>
+__global__ void DropoutMaskScaleCUDAKernel(
+    int64_t M,
+    int64_t N,
+    float p,
+    const int64_t* rng_state,
+    const T* dS,
+    T* dX) {
+  using T_ACC = acc_type<T, true>;
+  const uint64_t seed = static_cast<uint64_t>(rng_state[0]);
+  const uint64_t offset = static_cast<uint64_t>(rng_state[1]);
+  const T_ACC keep_scale = T_ACC(1) / (T_ACC(1) - static_cast<T_ACC>(p));
+  const int64_t groups_per_row = (N + 3) / 4;
+  for (int64_t g = blockIdx.x * blockDim.x + threadIdx.x; g < M * groups_per_row;
+       g += blockDim.x * gridDim.x) {
+    const int64_t i = g / groups_per_row;
+    const int64_t j = (g % groups_per_row) * 4;
+    bool keep[4];
+    DropoutKeepMask4(seed, offset, N, i, j, p, keep);
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      if (j + k < N) {
+        const int64_t index = i * N + j + k;
+        dX[index] = keep[k]
+            ? static_cast<T>(static_cast<T_ACC>(dS[index]) * keep_scale)
+            : T(0);
+      }
+    }
+  }
+}
+
 template <typename T>
 void LayerNormKernelImplInternal(
     const Tensor& X,
@@ -318,13 +404,86 @@ void LayerNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      X.scalar_type(), "LayerNormKernelImpl", [&]() {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      X.scalar_type(),
+      "LayerNormKernelImpl",
+      [&]() {
         LayerNormKernelImplInternal<scalar_t>(
             X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
       });
 }
 
+template <typename T>
+void DropoutAddLayerNormKernelImplInternal(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double p,
+    T eps,
+    PhiloxCudaState philox_args,
+    Tensor* rng_state,
+    Tensor* Y,
+    Tensor* S,
+    Tensor* mean,
+    Tensor* rstd) {
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK_EQ(R.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  const T* X_data = X.data_ptr<T>();
+  const T* R_data = R.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  DropoutAddLayerNormForwardCUDAKernel<T>
+      <<<M, kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
+          N,
+          static_cast<float>(p),
+          eps,
+          philox_args,
+          X_data,
+          R_data,
+          gamma_data,
+          beta_data,
+          rng_state->data_ptr<int64_t>(),
+          S->data_ptr<T>(),
+          Y->data_ptr<T>(),
+          mean->data_ptr<T>(),
+          rstd->data_ptr<T>());
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+void DropoutMaskScaleKernelImpl(
+    const Tensor& dS,
+    const Tensor& rng_state,
+    int64_t M,
+    int64_t N,
+    double p,
+    Tensor* dX) {
+  const int64_t num_groups = M * ((N + 3) / 4);
+  const int64_t B = std::min<int64_t>(
+      (num_groups + kCUDANumThreads - 1) / kCUDANumThreads,
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 8);
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+      dS.scalar_type(), "DropoutMaskScaleKernelImpl", [&]() {
+        DropoutMaskScaleCUDAKernel<scalar_t>
+            <<<B, kCUDANumThreads, 0, cuda_stream>>>(
+                M,
+                N,
+                static_cast<float>(p),
+                rng_state.data_ptr<int64_t>(),
+                dS.data_ptr<scalar_t>(),
+                dX->data_ptr<scalar_t>());
+      });
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 template <typename T>
 void LayerNormBackwardKernelImplInternal(
     const Tensor& dY,
@@ -337,7 +496,6 @@ void LayerNormBackwardKernelImplInternal(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  using T_ACC = acc_type<T, true>;
   DCHECK_EQ(dY.numel(), M * N);
   DCHECK_EQ(X.numel(), M * N);
   DCHECK_EQ(mean.numel(), M);
@@ -352,38 +510,9 @@ void LayerNormBackwardKernelImplInternal(
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
   if (dX_data != nullptr) {
-    const auto kAccType = X.scalar_type() == kHalf ? kFloat : X.scalar_type();
-    Tensor ds = at::empty({M}, X.options().dtype(kAccType));
-    Tensor db = at::empty({M}, X.options().dtype(kAccType));
-    Tensor scale = at::empty({M}, X.options().dtype(kAccType));
-    Tensor bias = at::empty({M}, X.options().dtype(kAccType));
-    T_ACC* ds_data = ds.template data_ptr<T_ACC>();
-    T_ACC* db_data = db.template data_ptr<T_ACC>();
-    T_ACC* scale_data = scale.template data_ptr<T_ACC>();
-    T_ACC* bias_data = bias.template data_ptr<T_ACC>();
-    ComputeInternalGradientsCUDAKernel<T>
+    LayerNormBackwardFusedCUDAKernel<T>
         <<<M, kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
-            N, dY_data, X_data, gamma_data, ds_data, db_data);
-    const int64_t B = (M + kCUDANumThreads - 1) / kCUDANumThreads;
-    ComputeGradientFusedParamsCUDAKernel<T>
-        <<<B, kCUDANumThreads, 0, cuda_stream>>>(
-            M,
-            N,
-            mean_data,
-            rstd_data,
-            ds_data,
-            db_data,
-            scale_data,
-            bias_data);
-    LayerNormBackwardCUDAKenrel<T><<<M, kCUDANumThreads, 0, cuda_stream>>>(
-        N,
-        dY_data,
-        X_data,
-        gamma_data,
-        rstd_data,
-        scale_data,
-        bias_data,
-        dX_data);
+            N, dY_data, X_data, mean_data, rstd_data, gamma_data, dX_data);
   }
   if (dgamma->defined() || dbeta->defined()) {
     T* dgamma_data =
@@ -432,8 +561,12 @@ void LayerNormBackwardKernelImpl(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      X.scalar_type(),
+      "LayerNormBackwardKernelImpl",
+      [&]() {
         LayerNormBackwardKernelImplInternal<scalar_t>(
             dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
       });
@@ -485,9 +618,46 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cuda(
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
 
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_cuda(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma /* optional */,
+    const Tensor& beta /* optional */,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    Generator* gen_) {
+  Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor S = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor mean = at::empty({M}, X.options());
+  Tensor rstd = at::empty({M}, X.options());
+  Tensor rng_state = at::empty({2}, X.options().dtype(kLong));
+  if (M > 0) {
+    auto gen = get_generator_or_default<CUDAGenerator>(
+        gen_, cuda::detail::getDefaultCUDAGenerator());
+    PhiloxCudaState philox_args;
+    {
+      // Every philox subsequence is used for a single group of four values.
+      // See Note [Acquire lock when using random generators]
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      philox_args = gen->philox_cuda_state(4);
+    }
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+        X.scalar_type(), "DropoutAddLayerNormKernelImpl", [&]() {
+          DropoutAddLayerNormKernelImplInternal<scalar_t>(
+              X, R, gamma, beta, M, N, p, static_cast<scalar_t>(eps),
+              philox_args, &rng_state, &Y, &S, &mean, &rstd);
+        });
+  }
+  return std::make_tuple(
+      std::move(Y), std::move(S), std::move(mean), std::move(rstd),
+      std::move(rng_state));
+}
 
 REGISTER_DISPATCH(LayerNormKernel, &LayerNormKernelImpl);
 REGISTER_DISPATCH(LayerNormBackwardKernel, &LayerNormBackwardKernelImpl);
+REGISTER_DISPATCH(DropoutMaskScaleKernel, &DropoutMaskScaleKernelImpl);
 
 } // namespace native
 } // namespace at
@@ -78,10 +78,15 @@ std::tuple<at::Tensor,at::Tensor> cudnn_convolution_transpose_backward(
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/cudnn/ConvBenchmarkCache.h>
 #include <ATen/native/utils/ParamsHash.h>
 
 #include <ATen/TensorUtils.h>
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <functional>
 #include <iterator>
 #include <sstream>
@@ -292,6 +297,101 @@ BenchmarkCache<cudnnConvolutionFwdAlgoPerf_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgoPerf_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgoPerf_t> bwd_filter_algos;
 
+// ---------------------------------------------------------------------
+//
+// Benchmark cache serialization
+//
+// ---------------------------------------------------------------------
+
+// A cache file is a CacheFileHeader followed by the forward, backward data
+// and backward filter caches, each stored as a uint64_t entry count and that
+// many CacheFileEntry records.  Everything is written in native byte order;
+// the header already ties a file to one cuDNN version and one GPU model.
+constexpr char cache_file_magic[8] = {'C', 'U', 'D', 'N', 'N', 'B', 'C', '\0'};
+constexpr uint32_t cache_file_version = 1;
+
+struct CacheFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t params_size;
+  uint64_t cudnn_version;
+  char device_name[256];
+};
+
+struct CacheFileEntry {
+  ConvolutionParams params;
+  int32_t algo;
+  int32_t status;
+  int32_t determinism;
+  int32_t math_type;
+  uint64_t memory;
+  float time;
+};
+
+CacheFileHeader currentCacheFileHeader() {
+  CacheFileHeader header;
+  memset(&header, 0, sizeof(CacheFileHeader));
+  memcpy(header.magic, cache_file_magic, sizeof(header.magic));
+  header.version = cache_file_version;
+  header.params_size = sizeof(ConvolutionParams);
+  header.cudnn_version = cudnnGetVersion();
+  strncpy(header.device_name, at::cuda::getCurrentDeviceProperties()->name,
+          sizeof(header.device_name) - 1);
+  return header;
+}
+
+template <typename perf_t>
+void writeBenchmarkCache(std::ostream& out, BenchmarkCache<perf_t>& cache) {
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  uint64_t count = cache.map.size();
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const auto& kv : cache.map) {
+    // memset so that struct padding does not leak into the file
+    CacheFileEntry entry;
+    memset(&entry, 0, sizeof(CacheFileEntry));
+    entry.params = kv.first;
+    entry.algo = static_cast<int32_t>(kv.second.algo);
+    entry.status = static_cast<int32_t>(kv.second.status);
+    entry.determinism = static_cast<int32_t>(kv.second.determinism);
+    entry.math_type = static_cast<int32_t>(kv.second.mathType);
+    entry.memory = kv.second.memory;
+    entry.time = kv.second.time;
+    out.write(reinterpret_cast<const char*>(&entry), sizeof(CacheFileEntry));
+  }
+}
+
+// Entries already in the cache win over the ones in the file.
+template <typename perf_t>
+int64_t readBenchmarkCache(std::istream& in, BenchmarkCache<perf_t>& cache, const std::string& path) {
+  using algo_t = decltype(perf_t().algo);
+  uint64_t count;
+  in.read(reinterpret_cast<char*>(&count), sizeof(count));
+  TORCH_CHECK(in, "cuDNN benchmark cache file ", path, " is truncated");
+  std::vector<CacheFileEntry> entries;
+  for (uint64_t i = 0; i < count; i++) {
+    CacheFileEntry entry;
+    in.read(reinterpret_cast<char*>(&entry), sizeof(CacheFileEntry));
+    TORCH_CHECK(in, "cuDNN benchmark cache file ", path, " is truncated");
+    entries.push_back(entry);
+  }
+
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  int64_t inserted = 0;
+  for (const auto& entry : entries) {
+    perf_t perf;
+    memset(&perf, 0, sizeof(perf_t));
+    perf.algo = static_cast<algo_t>(entry.algo);
+    perf.status = static_cast<cudnnStatus_t>(entry.status);
+    perf.determinism = static_cast<cudnnDeterminism_t>(entry.determinism);
+    perf.mathType = static_cast<cudnnMathType_t>(entry.math_type);
+    perf.memory = entry.memory;
+    perf.time = entry.time;
+    inserted += cache.map.emplace(entry.params, perf).second;
+  }
+  return inserted;
+}
+
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -369,13 +469,16 @@ size_t getMaxWorkspaceSize(
     size_t free_gpu_mem = 0;
 
     THCudaCheck(THCudaMemGetInfo(state, &free_gpu_mem, &total_gpu_mem, &max_block_size));
+    // Algorithms that need more than the user's limit are not benchmarked at all
+    const size_t ws_limit = static_cast<size_t>(globalContext().benchmarkWorkspaceLimitCuDNN());
 
     for (int i = 0; i < n_algo; i++) {
         cudnnStatus_t err;
         size_t sz;
         err = getWorkspaceSize(args, algo[i], &sz);
         if (CUDNN_STATUS_SUCCESS != err || sz == 0
-            || sz < max_ws_size || sz > max_block_size) continue;
+            || sz < max_ws_size || sz > max_block_size
+            || (ws_limit > 0 && sz > ws_limit)) continue;
         max_ws_size = sz;
     }
     return max_ws_size;
@@ -1247,6 +1350,57 @@ Tensor cudnn_convolution_transpose_backward_weight(
       padding, stride, dilation, groups, benchmark, deterministic);
 }
 
+namespace detail {
+
+void cudnn_save_benchmark_cache_impl(const std::string& path) {
+  // Write to a temporary file and rename it over the destination, so that
+  // processes loading a shared cache never see a partially written file.
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    TORCH_CHECK(out, "could not open ", tmp_path, " to save the cuDNN benchmark cache");
+    CacheFileHeader header = currentCacheFileHeader();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+    writeBenchmarkCache(out, fwd_algos);
+    writeBenchmarkCache(out, bwd_data_algos);
+    writeBenchmarkCache(out, bwd_filter_algos);
+    TORCH_CHECK(out, "failed to write the cuDNN benchmark cache to ", tmp_path);
+  }
+  TORCH_CHECK(std::rename(tmp_path.c_str(), path.c_str()) == 0,
+              "could not rename ", tmp_path, " to ", path);
+}
+
+int64_t cudnn_load_benchmark_cache_impl(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  TORCH_CHECK(in, "could not open cuDNN benchmark cache file ", path);
+  CacheFileHeader header;
+  in.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader));
+  TORCH_CHECK(in && memcmp(header.magic, cache_file_magic, sizeof(header.magic)) == 0,
+              path, " is not a cuDNN benchmark cache file");
+
+  CacheFileHeader current = currentCacheFileHeader();
+  if (header.version != current.version || header.params_size != current.params_size) {
+    TORCH_WARN("ignoring cuDNN benchmark cache ", path,
+               ": it was written by an incompatible version of PyTorch");
+    return 0;
+  }
+  if (header.cudnn_version != current.cudnn_version ||
+      strncmp(header.device_name, current.device_name, sizeof(header.device_name)) != 0) {
+    header.device_name[sizeof(header.device_name) - 1] = '\0';
+    TORCH_WARN("ignoring cuDNN benchmark cache ", path, ": it was written with cuDNN ",
+               header.cudnn_version, " on ", header.device_name, ", but this process uses cuDNN ",
+               current.cudnn_version, " on ", current.device_name);
+    return 0;
+  }
+
+  int64_t inserted = readBenchmarkCache(in, fwd_algos, path);
+  inserted += readBenchmarkCache(in, bwd_data_algos, path);
+  inserted += readBenchmarkCache(in, bwd_filter_algos, path);
+  return inserted;
+}
+
+} // namespace detail
+
 }}  // namespace at::native
 
 #endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace at { namespace native { namespace detail {
+
+// Serialization of the cuDNN convolution benchmark caches (fwd_algos,
+// bwd_data_algos and bwd_filter_algos in native/cudnn/Conv.cpp).
+//
+// The file records the cuDNN version and the name of the current device, and
+// a file written under a different cuDNN version or on a different GPU model
+// is ignored on load, so the same file can be shared by every process running
+// on the same kind of machine.
+//
+// Like the cuFFT plan cache, these are only valid when ATen_cuda is loaded, so
+// they are reached through the CUDA hooks (at cuda/detail/CUDAHooks.cpp) from
+// the native functions _cudnn_save_benchmark_cache and
+// _cudnn_load_benchmark_cache (at native/Convolution.cpp).
+void cudnn_save_benchmark_cache_impl(const std::string& path);
+int64_t cudnn_load_benchmark_cache_impl(const std::string& path);
+
+}}} // namespace at::native::detail
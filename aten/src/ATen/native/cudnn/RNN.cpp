@@ -8,8 +8,12 @@
 #include <ATen/cuda/CUDAConfig.h>
 #include <ATen/cuda/CUDAEvent.h>
 #include <ATen/cuda/Exceptions.h>
+#include <ATen/native/utils/ParamsHash.h>
 #include <c10/util/Exception.h>
 
+#include <mutex>
+#include <unordered_map>
+
 #if !AT_CUDNN_ENABLED()
 
 namespace at { namespace native {
@@ -1167,46 +1171,107 @@ DropoutState& get_dropout_state(double dropout_p, bool train, TensorOptions opti
   return state;
 }
 
+// Everything the layout of a flat cuDNN weight buffer depends on.
+struct WeightBufLayoutParams {
+  int device_id;
+  cudnnRNNMode_t mode;
+  cudnnDataType_t datatype;
+  int64_t input_size;
+  int64_t hidden_size;
+  int64_t num_layers;
+  bool bidirectional;
+};
+
+struct WeightBufLayout {
+  int64_t num_params = 0;
+  // Offsets (in bytes, from the start of the buffer) of the weights and biases
+  // that get_expected_data_ptrs() returns. Empty until the first buffer large
+  // enough to hold num_params was seen.
+  std::vector<ptrdiff_t> expected_offsets;
+};
+
+// Checking whether RNN weights are flattened takes an RNN descriptor and a
+// cuDNN query per weight and bias of every layer, but the answer only depends
+// on the RNN configuration, so it is computed once per configuration.
+std::unordered_map<
+    WeightBufLayoutParams,
+    WeightBufLayout,
+    ParamsHash<WeightBufLayoutParams>,
+    ParamsEqual<WeightBufLayoutParams>> weight_buf_layouts;
+std::mutex weight_buf_layouts_mutex;
+
 Tensor try_get_weight_buf(
       const Tensor& input, TensorList parameters, bool has_biases,
       cudnnRNNMode_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
-  // Prepare all relevant descriptors
-  auto handle = getCudnnHandle();
   auto datatype = getCudnnDataType(input);
 
-  RNNDescriptorParams rnn;
-  rnn.set(mode, hidden_size, num_layers, bidirectional, promote_rnn_math_type(datatype), datatype);
-  RNNDescriptor rnn_desc = rnn.descriptor(handle);
-
-  TensorGeometry x_geom ({1, input.size(-1)});
-  TensorDescriptor x_desc;
-  x_desc.set(datatype, x_geom.sizes(), x_geom.strides(), 5);
-
-  auto num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
+  WeightBufLayoutParams key;
+  // ParamsHash and ParamsEqual read the padding bytes too
+  memset(&key, 0, sizeof(key));
+  key.device_id = input.get_device();
+  key.mode = mode;
+  key.datatype = datatype;
+  key.input_size = input.size(-1);
+  key.hidden_size = hidden_size;
+  key.num_layers = num_layers;
+  key.bidirectional = bidirectional;
 
   // Try to get parameter storage
   auto & any_param = parameters.at(0);
   auto param_storage = any_param.storage();
   auto weight_buf = at::empty({0}, any_param.options()).set_(param_storage);
-  if (weight_buf.size(0) < num_params) {
-    return {};
-  } else if (weight_buf.size(0) > num_params) {
+
+  int64_t num_params;
+  std::vector<ptrdiff_t> expected_offsets;
+  {
+    std::lock_guard<std::mutex> guard(weight_buf_layouts_mutex);
+    auto& layout = weight_buf_layouts[key];
+    if (layout.num_params == 0 ||
+        (layout.expected_offsets.empty() && weight_buf.size(0) >= layout.num_params)) {
+      // Prepare all relevant descriptors
+      auto handle = getCudnnHandle();
+
+      RNNDescriptorParams rnn;
+      rnn.set(mode, hidden_size, num_layers, bidirectional, promote_rnn_math_type(datatype), datatype);
+      RNNDescriptor rnn_desc = rnn.descriptor(handle);
+
+      TensorGeometry x_geom ({1, input.size(-1)});
+      TensorDescriptor x_desc;
+      x_desc.set(datatype, x_geom.sizes(), x_geom.strides(), 5);
+
+      layout.num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
+
+      if (weight_buf.size(0) >= layout.num_params) {
+        auto expected_data_ptrs = get_expected_data_ptrs(
+            weight_buf.narrow(0, 0, layout.num_params), handle, rnn, rnn_desc, x_desc, datatype);
+        layout.expected_offsets.reserve(expected_data_ptrs.size());
+        for (void* data_ptr : expected_data_ptrs) {
+          layout.expected_offsets.push_back(
+              (char*)data_ptr - (char*)weight_buf.data_ptr());
+        }
+      }
+    }
+    num_params = layout.num_params;
+    if (weight_buf.size(0) < num_params) {
+      return {};
+    }
+    expected_offsets = layout.expected_offsets;
+  }
+  if (weight_buf.size(0) > num_params) {
     weight_buf = weight_buf.narrow(0, 0, num_params);
   }
 
-  // Get and check data pointers
-  auto expected_data_ptrs = get_expected_data_ptrs(
-      weight_buf, handle, rnn, rnn_desc, x_desc, datatype);
-
+  // Check data pointers
+  auto weight_buf_ptr = (char*)weight_buf.data_ptr();
   int64_t num_parameters = parameters.size();
-  int64_t num_ptrs = expected_data_ptrs.size();
+  int64_t num_ptrs = expected_offsets.size();
   AT_ASSERT(num_ptrs == (num_parameters * (has_biases ? 1 : 2)));
   AT_ASSERT(num_ptrs % (has_biases ? 4 : 2) == 0);
   for (int64_t param_i = 0, ptr_i = 0;
        ptr_i < num_ptrs;
        ptr_i += (has_biases ? 2 : 4), param_i += 2) {
-    if (expected_data_ptrs[ptr_i] != parameters[param_i].data_ptr()) return {};
-    if (expected_data_ptrs[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
+    if (weight_buf_ptr + expected_offsets[ptr_i] != parameters[param_i].data_ptr()) return {};
+    if (weight_buf_ptr + expected_offsets[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
   }
   if (!parameters[num_parameters - 1].is_contiguous()) return {};
   return weight_buf;
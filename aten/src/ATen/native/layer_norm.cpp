@@ -9,6 +9,7 @@
 #include <ATen/ATen.h>
 #include <ATen/AccumulateType.h>
 #include <ATen/CPUApplyUtils.h>
+#include <ATen/CPUGenerator.h>
 #include <ATen/Config.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
@@ -60,13 +61,82 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
 
-Tensor layer_norm(
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_cpu(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma /* optional */,
+    const Tensor& beta /* optional */,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    Generator* gen) {
+  Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor S = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor mean = at::empty({M}, X.options());
+  Tensor rstd = at::empty({M}, X.options());
+  Tensor rng_state = at::empty({2}, X.options().dtype(kLong));
+  {
+    auto generator = get_generator_or_default<CPUGenerator>(
+        gen, detail::getDefaultCPUGenerator());
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    rng_state.data_ptr<int64_t>()[0] =
+        static_cast<int64_t>(generator->random64());
+    rng_state.data_ptr<int64_t>()[1] = 0;
+  }
+  if (M > 0) {
+    DropoutAddLayerNormKernel(
+        kCPU, X, R, gamma, beta, M, N, p, eps, rng_state, &Y, &S, &mean, &rstd);
+  }
+  return std::make_tuple(
+      std::move(Y), std::move(S), std::move(mean), std::move(rstd),
+      std::move(rng_state));
+}
+
+// The gradient of S = dropout(input) + residual comes from the layer_norm
+// backward. The residual takes it as is, and the input takes it through the
+// dropout mask that DropoutMaskScaleKernel regenerates from rng_state.
+std::tuple<Tensor, Tensor, Tensor, Tensor> _dropout_add_layer_norm_backward(
+    const Tensor& dY,
+    const Tensor& S,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& gamma,
+    const Tensor& rng_state,
+    int64_t M,
+    int64_t N,
+    double p,
+    std::array<bool, 4> grad_input_mask) {
+  Tensor dS;
+  Tensor dgamma;
+  Tensor dbeta;
+  std::tie(dS, dgamma, dbeta) = at::native_layer_norm_backward(
+      dY, S, mean, rstd, gamma, M, N,
+      {grad_input_mask[0] || grad_input_mask[1], grad_input_mask[2],
+       grad_input_mask[3]});
+  Tensor dX;
+  if (grad_input_mask[0]) {
+    dX = at::empty_like(dS, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    if (M > 0) {
+      DropoutMaskScaleKernel(
+          dS.device().type(), dS, rng_state, M, N, p, &dX);
+    }
+  }
+  return std::make_tuple(
+      std::move(dX), grad_input_mask[1] ? dS : Tensor(), std::move(dgamma),
+      std::move(dbeta));
+}
+
+namespace {
+
+// Checks the arguments of layer_norm and returns the sizes (M, N) of the
+// input viewed as a matrix with one row per normalized slice.
+std::pair<int64_t, int64_t> layer_norm_sizes(
     const Tensor& input,
     IntArrayRef normalized_shape,
     const Tensor& weight /* optional */,
-    const Tensor& bias /* optional */,
-    double eps,
-    bool /* cudnn_enable, deprecated */) {
+    const Tensor& bias /* optional */) {
   const int normalized_ndim = normalized_shape.size();
   TORCH_CHECK(
       normalized_ndim >= 1,
@@ -116,14 +186,69 @@ Tensor layer_norm(
       1LL,
       std::multiplies<int64_t>());
 
+  return std::make_pair(M, N);
+}
+
+} // namespace
+
+Tensor layer_norm(
+    const Tensor& input,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double eps,
+    bool /* cudnn_enable, deprecated */) {
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_sizes(input, normalized_shape, weight, bias);
+
   const auto& X = input.is_contiguous() ? input : input.contiguous();
   const auto& gamma = weight.is_contiguous() ? weight : weight.contiguous();
   const auto& beta = bias.is_contiguous() ? bias : bias.contiguous();
   return std::get<0>(at::native_layer_norm(X, gamma, beta, M, N, eps));
 }
 
+Tensor dropout_add_layer_norm(
+    const Tensor& input,
+    const Tensor& residual,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double p,
+    bool train,
+    double eps) {
+  TORCH_CHECK(p >= 0 && p <= 1, "dropout probability has to be between 0 and 1, but got ", p);
+  TORCH_CHECK(
+      input.sizes().equals(residual.sizes()),
+      "Expected input and residual to have the same shape, but got ",
+      input.sizes(), " and ", residual.sizes());
+  TORCH_CHECK(
+      input.scalar_type() == residual.scalar_type(),
+      "Expected input and residual to have the same dtype, but got ",
+      input.scalar_type(), " and ", residual.scalar_type());
+  if (!train || p == 0) {
+    return at::layer_norm(input + residual, normalized_shape, weight, bias, eps);
+  }
+  if (p == 1) {
+    return at::layer_norm(
+        input.mul(at::zeros({}, input.options())) + residual,
+        normalized_shape, weight, bias, eps);
+  }
+
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_sizes(input, normalized_shape, weight, bias);
+
+  const auto& X = input.is_contiguous() ? input : input.contiguous();
+  const auto& R = residual.is_contiguous() ? residual : residual.contiguous();
+  const auto& gamma = weight.is_contiguous() ? weight : weight.contiguous();
+  const auto& beta = bias.is_contiguous() ? bias : bias.contiguous();
+  return std::get<0>(
+      at::_dropout_add_layer_norm(X, R, gamma, beta, M, N, p, eps, nullptr));
+}
+
 DEFINE_DISPATCH(LayerNormKernel);
 DEFINE_DISPATCH(LayerNormBackwardKernel);
+DEFINE_DISPATCH(DropoutAddLayerNormKernel);
+DEFINE_DISPATCH(DropoutMaskScaleKernel);
 
 } // namespace native
 } // namespace at
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/ATen.h>
+#include <ATen/core/PhiloxRNGEngine.h>
 #include <ATen/native/DispatchStub.h>
 
 namespace at {
@@ -29,8 +30,53 @@ using backward_fn = void (*)(
     Tensor* /* dgamma */,
     Tensor* /* dbeta */);
 
+using dropout_add_forward_fn = void (*)(
+    const Tensor& /* X */,
+    const Tensor& /* R */,
+    const Tensor& /* gamma */,
+    const Tensor& /* beta */,
+    int64_t /* M */,
+    int64_t /* N */,
+    double /* p */,
+    double /* eps */,
+    const Tensor& /* rng_state */,
+    Tensor* /* Y */,
+    Tensor* /* S */,
+    Tensor* /* mean */,
+    Tensor* /* rstd */);
+
+using dropout_mask_scale_fn = void (*)(
+    const Tensor& /* dS */,
+    const Tensor& /* rng_state */,
+    int64_t /* M */,
+    int64_t /* N */,
+    double /* p */,
+    Tensor* /* dX */);
+
 DECLARE_DISPATCH(forward_fn, LayerNormKernel);
 DECLARE_DISPATCH(backward_fn, LayerNormBackwardKernel);
+DECLARE_DISPATCH(dropout_add_forward_fn, DropoutAddLayerNormKernel);
+DECLARE_DISPATCH(dropout_mask_scale_fn, DropoutMaskScaleKernel);
+
+// dropout_add_layer_norm does not keep its dropout mask: the backward
+// regenerates it from the (seed, offset) pair saved in rng_state. Element j
+// of row i is kept when lane j % 4 of philox subsequence
+// i * ceil(N / 4) + j / 4 is at least p, so any device can generate a row
+// four columns at a time. `j` must be a multiple of 4.
+C10_HOST_DEVICE inline void DropoutKeepMask4(
+    uint64_t seed,
+    uint64_t offset,
+    int64_t N,
+    int64_t i,
+    int64_t j,
+    float p,
+    bool* keep) {
+  at::philox_engine engine(seed, i * ((N + 3) / 4) + j / 4, offset);
+  for (int k = 0; k < 4; ++k) {
+    // The top 24 bits map exactly onto floats in [0, 1).
+    keep[k] = static_cast<float>(engine() >> 8) * (1.0f / 16777216.0f) >= p;
+  }
+}
 
 } // namespace native
 } // namespace at
@@ -0,0 +1,159 @@
+// Contains the implementation of the MKL DFTI descriptor cache, the CPU
+// counterpart of native/cuda/CuFFTPlanCache.h.
+
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/mkl/Descriptors.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace at { namespace native { namespace detail {
+
+constexpr int mkl_fft_max_rank = 3;
+
+// This POD struct is used to let us easily compute hashes of the
+// parameters.
+// It will be the **key** to the descriptor cache. It holds everything the
+// descriptor is configured with, so that two calls with the same key can run
+// the same committed descriptor.
+struct MKLFFTParams
+{
+  at::ScalarType scalar_type_;
+  int64_t batch_;
+  int64_t input_dist_;
+  int64_t output_dist_;
+  int64_t input_strides_[mkl_fft_max_rank];
+  int64_t output_strides_[mkl_fft_max_rank];
+  int64_t signal_sizes_[mkl_fft_max_rank];
+  uint8_t signal_ndim_;  // between 1 and mkl_fft_max_rank
+  bool complex_input_;
+  bool complex_output_;
+  bool inverse_;
+  bool normalized_;
+};
+
+// NB: This can't be a constructor, because then MKLFFTParams
+// would not be a POD anymore.
+// The strides and distances are in elements of the (complex or real) type the
+// descriptor sees, like MKL expects them.
+static inline void setMKLFFTParams(MKLFFTParams* params,
+    const Tensor& input, const Tensor& output, int64_t signal_ndim,
+    bool complex_input, bool complex_output, bool inverse,
+    IntArrayRef checked_signal_sizes, bool normalized) {
+
+  memset(params, 0, sizeof(MKLFFTParams));
+  params->scalar_type_ = input.scalar_type();
+  params->batch_ = input.size(0);
+  params->input_dist_ = complex_input ? input.stride(0) >> 1 : input.stride(0);
+  params->output_dist_ = complex_output ? output.stride(0) >> 1 : output.stride(0);
+  for (int64_t i = 0; i != signal_ndim; ++i) {
+    params->input_strides_[i] = complex_input ? input.stride(i + 1) >> 1 : input.stride(i + 1);
+    params->output_strides_[i] = complex_output ? output.stride(i + 1) >> 1 : output.stride(i + 1);
+    params->signal_sizes_[i] = checked_signal_sizes[i];
+  }
+  params->signal_ndim_ = (uint8_t) signal_ndim;
+  params->complex_input_ = complex_input;
+  params->complex_output_ = complex_output;
+  params->inverse_ = inverse;
+  params->normalized_ = normalized;
+}
+
+constexpr size_t MKL_FFT_DEFAULT_CACHE_SIZE = 4096;
+
+// Committed descriptors are only read by DftiCompute*, so one descriptor can
+// run on several threads at once. The cache hands out shared pointers, so a
+// descriptor evicted while it runs is freed once that run is done.
+class MKLFFTParamsLRUCache {
+public:
+  using descriptor_t = std::shared_ptr<DftiDescriptor>;
+  using kv_t = typename std::pair<MKLFFTParams, descriptor_t>;
+  using map_t = typename std::unordered_map<std::reference_wrapper<MKLFFTParams>,
+                                            typename std::list<kv_t>::iterator,
+                                            ParamsHash<MKLFFTParams>,
+                                            ParamsEqual<MKLFFTParams>>;
+  using map_kkv_iter_t = typename map_t::iterator;
+
+  MKLFFTParamsLRUCache() : MKLFFTParamsLRUCache(MKL_FFT_DEFAULT_CACHE_SIZE) {}
+
+  MKLFFTParamsLRUCache(int64_t max_size) {
+    _set_max_size(max_size);
+  }
+
+  // If key is in this cache, return the cached descriptor. Otherwise, emplace
+  // the descriptor made by make_descriptor(key) in this cache and return it.
+  // This is similar to c++ 17 try_emplace.
+  template<typename F>
+  descriptor_t try_emplace_value(MKLFFTParams& key, F make_descriptor) {
+    AT_ASSERT(_max_size > 0);
+
+    map_kkv_iter_t map_it = _cache_map.find(key);
+    // Hit, put to list front
+    if (map_it != _cache_map.end()) {
+      _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
+      return map_it->second->second;
+    }
+
+    // Miss
+    // make the descriptor first, so that a failure leaves the cache unchanged
+    descriptor_t descriptor = make_descriptor(key);
+    // remove if needed
+    if (_usage_list.size() >= _max_size) {
+      auto last = _usage_list.end();
+      last--;
+      _cache_map.erase(last->first);
+      _usage_list.pop_back();
+    }
+
+    // put new descriptor at list front, then insert into _cache_map
+    _usage_list.emplace_front(key, std::move(descriptor));
+    auto kv_it = _usage_list.begin();
+    _cache_map.emplace(std::piecewise_construct,
+                std::forward_as_tuple(kv_it->first),
+                std::forward_as_tuple(kv_it));
+    return kv_it->second;
+  }
+
+  void clear() {
+    _cache_map.clear();
+    _usage_list.clear();
+  }
+
+  void resize(int64_t new_size) {
+    _set_max_size(new_size);
+    auto cur_size = _usage_list.size();
+    if (cur_size > _max_size) {
+      auto delete_it = _usage_list.end();
+      for (size_t i = 0; i < cur_size - _max_size; i++) {
+        delete_it--;
+        _cache_map.erase(delete_it->first);
+      }
+      _usage_list.erase(delete_it, _usage_list.end());
+    }
+  }
+
+  size_t size() const { return _cache_map.size(); }
+
+  size_t max_size() const noexcept { return _max_size; }
+
+  std::mutex mutex;
+
+private:
+  // Only sets size and does value check. Does not resize the data structures.
+  void _set_max_size(int64_t new_size) {
+    TORCH_CHECK(new_size >= 0,
+             "MKL FFT plan cache size must be non-negative, but got ", new_size);
+    _max_size = static_cast<size_t>(new_size);
+  }
+
+  std::list<kv_t> _usage_list;
+  map_t _cache_map;
+  size_t _max_size;
+};
+
+}}} // namespace at::native::detail
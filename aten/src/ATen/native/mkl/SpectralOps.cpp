@@ -15,6 +15,22 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
   AT_ERROR("fft: ATen not compiled with MKL support");
 }
 
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  AT_ERROR("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  AT_ERROR("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  AT_ERROR("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
+void _mkl_fft_clear_plan_cache() {
+  AT_ERROR("MKL FFT plan cache: ATen not compiled with MKL support");
+}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -30,11 +46,14 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include <vector>
 #include <numeric>
 #include <cmath>
+#include <memory>
+#include <mutex>
 
 #include <mkl_dfti.h>
 #include <ATen/mkl/Exceptions.h>
 #include <ATen/mkl/Descriptors.h>
 #include <ATen/mkl/Limits.h>
+#include <ATen/native/mkl/MKLFFTPlanCache.h>
 
 
 namespace at { namespace native {
@@ -144,13 +163,105 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// NOTE [ MKL FFT descriptor cache ]
+// Creating and committing a DFTI descriptor precomputes the twiddle factors of
+// the transform, which can cost more than the transform itself for small
+// signals. So, like cuFFT plans (see native/cuda/CuFFTPlanCache.h), committed
+// descriptors are kept in an LRU cache keyed by everything they are
+// configured with. The cache is shared by all threads, its capacity is
+// controlled with torch.backends.mkl.fft_plan_cache.
+
+static detail::MKLFFTParamsLRUCache& mkl_fft_plan_cache() {
+  static detail::MKLFFTParamsLRUCache cache;
+  return cache;
+}
+
+// Creates and commits the descriptor for the transform described by params.
+static std::shared_ptr<DftiDescriptor> make_dfti_descriptor(const detail::MKLFFTParams& params) {
+  const int64_t signal_ndim = params.signal_ndim_;
+  // precision
+  DFTI_CONFIG_VALUE prec = params.scalar_type_ == ScalarType::Double ? DFTI_DOUBLE : DFTI_SINGLE;
+  // signal type
+  DFTI_CONFIG_VALUE signal_type;
+  if (!params.inverse_) {
+    signal_type = params.complex_input_ ? DFTI_COMPLEX : DFTI_REAL;
+  } else {
+    signal_type = params.complex_output_ ? DFTI_COMPLEX : DFTI_REAL;
+  }
+  // create descriptor with signal size
+  std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes_, params.signal_sizes_ + signal_ndim);
+  auto descriptor = std::make_shared<DftiDescriptor>();
+  descriptor->init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG) params.batch_));
+
+  // batch dim stride, i.e., dist between each data
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_DISTANCE, (MKL_LONG) params.input_dist_));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_DISTANCE, (MKL_LONG) params.output_dist_));
+  // signal strides
+  // first val is offset, set to zero (ignored)
+  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
+  for (int64_t i = 1; i <= signal_ndim; i++) {
+    mkl_istrides[i] = params.input_strides_[i - 1];
+    mkl_ostrides[i] = params.output_strides_[i - 1];
+  }
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (!params.complex_input_ || !params.complex_output_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized_ || params.inverse_) {
+    auto signal_numel = at::prod_intlist(IntArrayRef(params.signal_sizes_, signal_ndim));
+    double double_scale;
+    if (params.normalized_) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(),
+      params.inverse_ ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor->get()));
+  return descriptor;
+}
+
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  auto& plan_cache = mkl_fft_plan_cache();
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.max_size();
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  auto& plan_cache = mkl_fft_plan_cache();
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  plan_cache.resize(max_size);
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  auto& plan_cache = mkl_fft_plan_cache();
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  return plan_cache.size();
+}
+
+void _mkl_fft_clear_plan_cache() {
+  auto& plan_cache = mkl_fft_plan_cache();
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  plan_cache.clear();
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
                 bool inverse, IntArrayRef checked_signal_sizes,
                 bool normalized, bool onesided,
                 IntArrayRef output_sizes) {
-  int64_t batch = self.size(0);
   Tensor input = self;
   // real/imag dimension must aligned when viewed as of complex type
   if (complex_input) {
@@ -194,75 +305,34 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
   }
   Tensor output = at::empty(output_sizes, input.options());
 
-  // precision
-  DFTI_CONFIG_VALUE prec;
-  if (input.scalar_type() == ScalarType::Float) {
-    prec = DFTI_SINGLE;
-  } else if (input.scalar_type() == ScalarType::Double) {
-    prec = DFTI_DOUBLE;
-  } else {
+  if (input.scalar_type() != ScalarType::Float && input.scalar_type() != ScalarType::Double) {
     std::ostringstream ss;
     ss << "MKL FFT doesn't support tensor of type: "
        << toString(input.scalar_type());
     AT_ERROR(ss.str());
   }
-  // signal type
-  DFTI_CONFIG_VALUE signal_type;
-  if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
-  } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
-  }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
 
-  auto istrides = input.strides();
-  auto ostrides = output.strides();
-  // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
-  // signal strides
-  // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
-  for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
-  }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
+  // See NOTE [ MKL FFT descriptor cache ]
+  detail::MKLFFTParams params;
+  detail::setMKLFFTParams(&params, input, output, signal_ndim, complex_input,
+                          complex_output, inverse, checked_signal_sizes, normalized);
+  std::shared_ptr<DftiDescriptor> descriptor;
+  {
+    auto& plan_cache = mkl_fft_plan_cache();
+    std::lock_guard<std::mutex> guard(plan_cache.mutex);
+    if (plan_cache.max_size() > 0) {
+      descriptor = plan_cache.try_emplace_value(params, make_dfti_descriptor);
     }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
   }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  if (!descriptor) {
+    // cache is disabled
+    descriptor = make_dfti_descriptor(params);
+  }
   // run
   if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeForward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeBackward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
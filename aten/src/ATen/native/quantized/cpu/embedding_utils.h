@@ -0,0 +1,38 @@
+#pragma once
+
+#include <c10/util/Half.h>
+
+#include <cstdint>
+
+namespace at {
+namespace native {
+
+// Rowwise quantized embedding tables, as packed by
+// quantized::embedding_bag_byte_prepack and
+// quantized::embedding_bag_4bit_prepack: a uint8 tensor with one row per
+// embedding, each row holding its quantized values followed by the scale and
+// the bias (the minimum of the row) it was quantized with.
+//
+//   byte: D uint8 values, float scale, float bias. This is the layout of
+//         caffe2's Fused8BitRowwiseQuantized tensors.
+//   4bit: D / 2 bytes of two values each, the even column in the low nibble,
+//         Half scale, Half bias. D has to be even.
+
+constexpr int64_t embedding_byte_row_bytes(int64_t columns) {
+  return columns + 2 * sizeof(float);
+}
+
+constexpr int64_t embedding_byte_columns(int64_t row_bytes) {
+  return row_bytes - 2 * sizeof(float);
+}
+
+constexpr int64_t embedding_4bit_row_bytes(int64_t columns) {
+  return columns / 2 + 2 * sizeof(c10::Half);
+}
+
+constexpr int64_t embedding_4bit_columns(int64_t row_bytes) {
+  return (row_bytes - 2 * sizeof(c10::Half)) * 2;
+}
+
+} // namespace native
+} // namespace at
@@ -3,6 +3,9 @@
 #include "init_qnnpack.h"
 #include <ATen/ATen.h>
 #include <ATen/Config.h>
+#include <ATen/Parallel.h>
+#include <caffe2/utils/threadpool/ThreadPool.h>
+#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 #include <pytorch_qnnpack.h>
 
 namespace at {
@@ -18,6 +21,62 @@ void initQNNPACK() {
       "failed to initialize QNNPACK");
 }
 
+#if !(defined(C10_MOBILE) && AT_PARALLEL_NATIVE)
+namespace {
+
+// A caffe2::ThreadPool that runs its work through at::parallel_for, for
+// the builds in which ATen's intra-op pool isn't caffe2::mobile_threadpool().
+class IntraOpThreadPool final : public caffe2::ThreadPool {
+ public:
+  IntraOpThreadPool() : caffe2::ThreadPool(0) {}
+
+  int getNumThreads() const override {
+    return at::get_num_threads();
+  }
+
+  void setNumThreads(size_t numThreads) override {
+    at::set_num_threads(numThreads);
+  }
+
+  void run(const std::function<void(int, size_t)>& fn, size_t range) override {
+    at::parallel_for(0, range, 1, [&fn](int64_t begin, int64_t end) {
+      const int thread_id = at::get_thread_num();
+      for (int64_t i = begin; i < end; ++i) {
+        fn(thread_id, i);
+      }
+    });
+  }
+};
+
+} // namespace
+#endif
+
+namespace {
+
+caffe2::ThreadPool* intra_op_threadpool() {
+#if defined(C10_MOBILE) && AT_PARALLEL_NATIVE
+  // ATen's intra-op pool already is the mobile thread pool.
+  return caffe2::mobile_threadpool();
+#else
+  static IntraOpThreadPool pool;
+  return &pool;
+#endif
+}
+
+// Have caffe2 workspaces hand the same pool to their operators (among them
+// the caffe2 Int8 QNNPACK operators), instead of each starting a pool of its
+// own next to ATen's.
+C10_UNUSED const bool shared_threadpool_registered = []() {
+  caffe2::ThreadPool::setSharedThreadPoolGetter(&intra_op_threadpool);
+  return true;
+}();
+
+} // namespace
+
+pthreadpool_t qnnpack_threadpool() {
+  return reinterpret_cast<pthreadpool_t>(intra_op_threadpool());
+}
+
 } // namespace native
 } // namespace at
 
@@ -2,11 +2,19 @@
 
 #ifdef USE_PYTORCH_QNNPACK
 
+#include <caffe2/utils/threadpool/pthreadpool.h>
+
 namespace at {
 namespace native {
 
 void initQNNPACK();
 
+// The thread pool to run QNNPACK operators on. Its work runs on ATen's
+// intra-op threads, so that quantized and float operators share one pool
+// and at::set_num_threads() applies to both. caffe2 workspaces hand the
+// same pool to their operators, see caffe2::ThreadPool::sharedThreadPool().
+pthreadpool_t qnnpack_threadpool();
+
 } // namespace native
 } // namespace at
 
@@ -1,5 +1,6 @@
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/UpSample.h>
 #include <ATen/native/cpu/Loops.h>
@@ -14,6 +15,9 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 namespace at {
 namespace native {
@@ -1080,6 +1084,84 @@ void q_batch_norm_kernel(
 
 }
 
+// y[i] = table[x[i]] for a table of 256 bytes. Bytes don't have a gather, so
+// the table is split into rows that fit the byte shuffles: with AVX2, the
+// shuffle of one of 16 rows of 16 bytes is picked by the high nibble of x.
+// On ARM, the table lookups take up to 64 (aarch64) or 32 (armv7) bytes and
+// leave the lanes whose index is out of range alone, so subtracting the
+// offset of a row is enough to select it.
+void apply_lut(int64_t n, const uint8_t* x, const uint8_t* table, uint8_t* y) {
+  int64_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+  __m256i rows[16];
+  for (int k = 0; k < 16; ++k) {
+    rows[k] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table + 16 * k)));
+  }
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  for (; i + 32 <= n; i += 32) {
+    const __m256i xv =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+    const __m256i lo = _mm256_and_si256(xv, low_nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(xv, 4), low_nibble);
+    __m256i result = _mm256_setzero_si256();
+    for (int k = 0; k < 16; ++k) {
+      const __m256i row_selected = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(k));
+      result = _mm256_blendv_epi8(
+          result, _mm256_shuffle_epi8(rows[k], lo), row_selected);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i), result);
+  }
+#elif defined(__aarch64__)
+  uint8x16x4_t rows[4];
+  for (int k = 0; k < 4; ++k) {
+    for (int j = 0; j < 4; ++j) {
+      rows[k].val[j] = vld1q_u8(table + 64 * k + 16 * j);
+    }
+  }
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t xv = vld1q_u8(x + i);
+    uint8x16_t result = vqtbl4q_u8(rows[0], xv);
+    for (int k = 1; k < 4; ++k) {
+      result = vqtbx4q_u8(
+          result, rows[k], vsubq_u8(xv, vdupq_n_u8(static_cast<uint8_t>(64 * k))));
+    }
+    vst1q_u8(y + i, result);
+  }
+#elif defined(__ARM_NEON__)
+  uint8x8x4_t rows[8];
+  for (int k = 0; k < 8; ++k) {
+    for (int j = 0; j < 4; ++j) {
+      rows[k].val[j] = vld1_u8(table + 32 * k + 8 * j);
+    }
+  }
+  for (; i + 8 <= n; i += 8) {
+    const uint8x8_t xv = vld1_u8(x + i);
+    uint8x8_t result = vtbl4_u8(rows[0], xv);
+    for (int k = 1; k < 8; ++k) {
+      result = vtbx4_u8(
+          result, rows[k], vsub_u8(xv, vdup_n_u8(static_cast<uint8_t>(32 * k))));
+    }
+    vst1_u8(y + i, result);
+  }
+#endif
+  for (; i < n; ++i) {
+    y[i] = table[x[i]];
+  }
+}
+
+// qx and qy are 1-byte quantized tensors of the same size and memory format,
+// lut holds the 256 bytes of qy for the byte values of qx.
+void qlut_kernel(const Tensor& qx, const Tensor& lut, Tensor& qy) {
+  const auto* x = reinterpret_cast<const uint8_t*>(qx.data_ptr());
+  const auto* table = reinterpret_cast<const uint8_t*>(lut.data_ptr());
+  auto* y = reinterpret_cast<uint8_t*>(qy.data_ptr());
+  at::parallel_for(
+      0, qx.numel(), at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        apply_lut(end - begin, x + begin, table, y + begin);
+      });
+}
+
 } // namespace
 
 REGISTER_DISPATCH(qrelu_stub, &qrelu_kernel);
@@ -1102,6 +1184,7 @@ REGISTER_DISPATCH(qcat_nhwc_stub, &qcat_nhwc_kernel<false>);
 REGISTER_DISPATCH(qcat_relu_nhwc_stub, &qcat_nhwc_kernel<true>);
 REGISTER_DISPATCH(qtopk_stub, &qtopk_kernel);
 REGISTER_DISPATCH(qbatch_norm_stub, &q_batch_norm_kernel<false>);
+REGISTER_DISPATCH(qlut_stub, &qlut_kernel);
 
 } // namespace native
 } // namespace at
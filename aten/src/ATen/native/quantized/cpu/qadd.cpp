@@ -7,7 +7,6 @@
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
 
@@ -117,8 +116,10 @@ class QAdd final : public c10::OperatorKernel {
 #ifdef USE_PYTORCH_QNNPACK
 Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   TORCH_CHECK(qa.ndimension() > 0, "qnnpack_add(): Got empty input tensor.");
-  Tensor qa_contig = qa.contiguous();
-  Tensor qb_contig = qb.contiguous();
+  // Both inputs take the layout of qa, which the output keeps.
+  const auto memory_format = qa.suggest_memory_format();
+  Tensor qa_contig = qa.contiguous(memory_format);
+  Tensor qb_contig = qb.contiguous(memory_format);
 
   const auto a_zero_point = qa_contig.q_zero_point();
   const auto b_zero_point = qb_contig.q_zero_point();
@@ -126,7 +127,11 @@ Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   const auto b_scale = qb_contig.q_scale();
 
   Tensor qy = at::_empty_affine_quantized(
-      qa_contig.sizes(), at::device(kCPU).dtype(kQUInt8), scale, zero_point);
+      qa_contig.sizes(),
+      at::device(kCPU).dtype(kQUInt8),
+      scale,
+      zero_point,
+      memory_format);
 
   if (qa_contig.size(0) == 0) {
     return qy;
@@ -178,7 +183,7 @@ Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
       setupStatus == pytorch_qnnp_status_success,
       "failed to setup QNNPACK Add operator");
 
-  pthreadpool_t threadpool = caffe2::mobile_pthreadpool();
+  pthreadpool_t threadpool = qnnpack_threadpool();
   const pytorch_qnnp_status runStatus =
       pytorch_qnnp_run_operator(qnnpack_operator, threadpool);
 
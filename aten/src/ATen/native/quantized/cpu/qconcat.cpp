@@ -17,16 +17,29 @@ DEFINE_DISPATCH(qcat_relu_nhwc_stub);
 
 namespace {
 
+// The NHWC kernel is used if the first input is channels last, like the
+// output of a quantized conv. The other inputs are converted if they aren't
+// channels last already, which is cheaper than concatenating through a
+// dequantized NCHW copy of all of them.
 bool is_cat_nhwc_fast_path(const c10::List<Tensor>& qxs, int dim) {
   TORCH_CHECK(qxs.size() > 0);
-  bool is_fast_path = dim == 1;
+  bool is_fast_path = dim == 1 &&
+      qxs.get(0).is_contiguous(c10::MemoryFormat::ChannelsLast);
   for (const at::Tensor& qx : qxs) {
     is_fast_path &= qx.dim() == 4;
-    is_fast_path &= qx.is_contiguous(c10::MemoryFormat::ChannelsLast);
   }
   return is_fast_path;
 }
 
+c10::List<Tensor> to_channels_last(const c10::List<Tensor>& qxs) {
+  c10::List<Tensor> result;
+  result.reserve(qxs.size());
+  for (const at::Tensor& qx : qxs) {
+    result.push_back(qx.contiguous(c10::MemoryFormat::ChannelsLast));
+  }
+  return result;
+}
+
 bool is_valid_quantization_scheme(const Tensor& t) {
   const auto qtype = t.qscheme();
   return (qtype == kPerTensorAffine) || (qtype == kPerTensorSymmetric);
@@ -43,10 +56,11 @@ Tensor quantized_cat_impl(
     double scale,
     int64_t zero_point) {
   if (is_cat_nhwc_fast_path(qxs, dim)) {
+    const auto qxs_nhwc = to_channels_last(qxs);
     if (ReLUFused) {
-      return qcat_relu_nhwc_stub(at::kCPU, qxs, dim, scale, zero_point);
+      return qcat_relu_nhwc_stub(at::kCPU, qxs_nhwc, dim, scale, zero_point);
     } else {
-      return qcat_nhwc_stub(at::kCPU, qxs, dim, scale, zero_point);
+      return qcat_nhwc_stub(at::kCPU, qxs_nhwc, dim, scale, zero_point);
     }
   }
 
@@ -60,7 +74,9 @@ Tensor quantized_cat_impl(
         x_qscheme == qx.qscheme(), "Quantization schemes must be the same.");
     xs.push_back(qx.dequantize());
   }
-  const Tensor y = at::cat(xs, dim);
+  // Keep the layout of the first input.
+  const Tensor y =
+      at::cat(xs, dim).contiguous(qxs.get(0).suggest_memory_format());
   Tensor qy;
   AT_DISPATCH_QINT_TYPES(x_dtype, "qcat", [&]() {
     qy = at::quantize_per_tensor(y, scale, zero_point, SCALAR_TYPE);
@@ -8,8 +8,8 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
+#include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 namespace at {
 namespace native {
@@ -626,7 +626,7 @@ class QConvInt8 final : public c10::OperatorKernel {
         output.q_scale(),
         output.q_zero_point(),
         reinterpret_cast<uint8_t*>(output.data_ptr<c10::quint8>()),
-        caffe2::mobile_pthreadpool());
+        qnnpack_threadpool());
 
     TORCH_INTERNAL_ASSERT(
         run_status == pytorch_qnnp_status_success,
@@ -637,6 +637,43 @@ class QConvInt8 final : public c10::OperatorKernel {
 #endif
 };
 
+// Conv followed by the residual add and ReLU of a ResNet block, with the
+// result of the conv quantized at (conv_scale, conv_zero_point) as in the
+// unfused graph. Neither the fbgemm nor the QNNPACK output pipeline of the conv
+// can read a second tensor, so the add and the ReLU run together in one pass
+// over the output of the conv instead of two.
+template <int kSpatialDim>
+class QConvAddReluInt8 final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor act,
+      Tensor packed_weight,
+      Tensor other,
+      torch::List<int64_t> stride,
+      torch::List<int64_t> padding,
+      torch::List<int64_t> dilation,
+      int64_t groups,
+      double conv_scale,
+      int64_t conv_zero_point,
+      double output_scale,
+      int64_t output_zero_point) {
+    Tensor conv_output = QConvInt8<kSpatialDim, false>()(
+        act,
+        packed_weight,
+        stride,
+        padding,
+        dilation,
+        groups,
+        conv_scale,
+        conv_zero_point);
+    static const auto add_relu =
+        c10::Dispatcher::singleton().findSchemaOrThrow(
+            "quantized::add_relu", "");
+    return add_relu.callUnboxed<Tensor, Tensor, Tensor, double, int64_t>(
+        conv_output, other, output_scale, output_zero_point);
+  }
+};
+
 static auto registry =
     c10::RegisterOperators()
         .op("quantized::conv2d",
@@ -645,6 +682,9 @@ static auto registry =
         .op("quantized::conv2d_relu",
             c10::RegisterOperators::options().kernel<QConvInt8<2, true>>(
                 DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::conv2d_add_relu",
+            c10::RegisterOperators::options().kernel<QConvAddReluInt8<2>>(
+                DispatchKey::QuantizedCPUTensorId))
         .op("quantized::conv3d",
             c10::RegisterOperators::options().kernel<QConvInt8<3, false>>(
                 DispatchKey::QuantizedCPUTensorId))
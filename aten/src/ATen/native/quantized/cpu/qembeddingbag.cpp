@@ -0,0 +1,270 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/embedding_utils.h>
+
+#include <caffe2/perfkernels/fused_8bit_rowwise_embedding_lookup_idx.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace at {
+namespace native {
+namespace {
+
+const int64_t MODE_SUM = 0;
+const int64_t MODE_MEAN = 1;
+
+// Checks the arguments shared by the lookups and returns the offsets of the
+// bags followed by the end of the last bag, in `storage` unless `offsets`
+// already ends with it.
+const int64_t* check_and_get_offsets(
+    const char* op_name,
+    const Tensor& indices,
+    const Tensor& offsets,
+    int64_t mode,
+    const c10::optional<Tensor>& per_sample_weights,
+    bool include_last_offset,
+    std::vector<int64_t>& storage) {
+  TORCH_CHECK(
+      indices.dim() == 1 && offsets.dim() == 1,
+      op_name,
+      ": Expected indices and offsets to be 1-D tensors");
+  TORCH_CHECK(
+      indices.scalar_type() == kLong || indices.scalar_type() == kInt,
+      op_name,
+      ": Expected indices to be int32 or int64, got ",
+      indices.scalar_type());
+  TORCH_CHECK(
+      offsets.scalar_type() == kLong,
+      op_name,
+      ": Expected offsets to be int64, got ",
+      offsets.scalar_type());
+  TORCH_CHECK(
+      mode == MODE_SUM || mode == MODE_MEAN,
+      op_name,
+      ": Only the sum (0) and mean (1) modes are supported, got ",
+      mode);
+  if (per_sample_weights.has_value()) {
+    TORCH_CHECK(
+        mode == MODE_SUM,
+        op_name,
+        ": per_sample_weights are only supported in the sum mode");
+    TORCH_CHECK(
+        per_sample_weights->scalar_type() == kFloat &&
+            per_sample_weights->dim() == 1 &&
+            per_sample_weights->numel() == indices.numel(),
+        op_name,
+        ": Expected per_sample_weights to be a float tensor of the size of "
+        "indices");
+  }
+  TORCH_CHECK(
+      !include_last_offset || offsets.numel() > 0,
+      op_name,
+      ": include_last_offset needs at least one offset");
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  if (include_last_offset) {
+    return offsets_data;
+  }
+  storage.resize(offsets.numel() + 1);
+  std::memcpy(
+      storage.data(), offsets_data, sizeof(int64_t) * offsets.numel());
+  storage[offsets.numel()] = indices.numel();
+  return storage.data();
+}
+
+template <typename IndexType>
+void embedding_bag_byte_impl(
+    const Tensor& packed_weight,
+    const Tensor& indices,
+    const int64_t* offsets_data,
+    int64_t output_size,
+    bool normalize_by_lengths,
+    const float* per_sample_weights_data,
+    Tensor& output) {
+  const int64_t block_size = embedding_byte_columns(packed_weight.size(1));
+  const int64_t data_size = packed_weight.size(0);
+  const auto* weight_data = packed_weight.data_ptr<uint8_t>();
+  const auto* indices_data = indices.data_ptr<IndexType>();
+  auto* output_data = output.data_ptr<float>();
+  at::parallel_for(0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+    caffe2::Fused8BitRowwiseEmbeddingLookupIdx<IndexType, uint8_t, float>(
+        /*block_size=*/block_size,
+        /*output_size=*/end_idx - start_idx,
+        /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
+        /*data_size=*/data_size,
+        /*input=*/weight_data,
+        /*indices=*/indices_data + offsets_data[start_idx],
+        /*offsets=*/offsets_data + start_idx,
+        /*weights=*/per_sample_weights_data
+            ? per_sample_weights_data + offsets_data[start_idx]
+            : nullptr,
+        /*normalize_by_lengths=*/normalize_by_lengths,
+        /*out=*/output_data + start_idx * block_size);
+  });
+}
+
+// There is no perfkernel for 4-bit rows, each bag is reduced by a loop over
+// its rows instead.
+template <typename IndexType>
+void embedding_bag_4bit_impl(
+    const Tensor& packed_weight,
+    const Tensor& indices,
+    const int64_t* offsets_data,
+    int64_t output_size,
+    bool normalize_by_lengths,
+    const float* per_sample_weights_data,
+    Tensor& output) {
+  const int64_t row_bytes = packed_weight.size(1);
+  const int64_t block_size = output.size(1);
+  const int64_t data_size = packed_weight.size(0);
+  const auto* weight_data = packed_weight.data_ptr<uint8_t>();
+  const auto* indices_data = indices.data_ptr<IndexType>();
+  auto* output_data = output.data_ptr<float>();
+  at::parallel_for(0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+    for (int64_t bag = start_idx; bag < end_idx; ++bag) {
+      float* out = output_data + bag * block_size;
+      std::fill(out, out + block_size, 0.f);
+      for (int64_t i = offsets_data[bag]; i < offsets_data[bag + 1]; ++i) {
+        const int64_t idx = indices_data[i];
+        TORCH_CHECK(
+            idx >= 0 && idx < data_size,
+            "quantized::embedding_bag_4bit: index ",
+            idx,
+            " is out of bounds for size ",
+            data_size);
+        const uint8_t* row = weight_data + idx * row_bytes;
+        const auto* scale_bias = reinterpret_cast<const at::Half*>(
+            row + row_bytes - 2 * sizeof(at::Half));
+        const float weight =
+            per_sample_weights_data ? per_sample_weights_data[i] : 1.f;
+        const float scale = weight * static_cast<float>(scale_bias[0]);
+        const float bias = weight * static_cast<float>(scale_bias[1]);
+        for (int64_t j = 0; j < block_size; ++j) {
+          const uint8_t quantized = (row[j / 2] >> ((j % 2) * 4)) & 0xf;
+          out[j] += scale * quantized + bias;
+        }
+      }
+      const int64_t length = offsets_data[bag + 1] - offsets_data[bag];
+      if (normalize_by_lengths && length > 0) {
+        for (int64_t j = 0; j < block_size; ++j) {
+          out[j] /= length;
+        }
+      }
+    }
+  });
+}
+
+template <bool k4Bit>
+class QEmbeddingBag final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor packed_weight,
+      Tensor indices,
+      Tensor offsets,
+      int64_t mode,
+      c10::optional<Tensor> per_sample_weights,
+      bool include_last_offset) {
+    const char* op_name = k4Bit ? "quantized::embedding_bag_4bit"
+                                : "quantized::embedding_bag_byte";
+    TORCH_CHECK(
+        packed_weight.scalar_type() == kByte && packed_weight.dim() == 2 &&
+            packed_weight.is_contiguous(),
+        op_name,
+        ": Expected a weight packed by ",
+        k4Bit ? "quantized::embedding_bag_4bit_prepack"
+              : "quantized::embedding_bag_byte_prepack");
+    indices = indices.contiguous();
+    offsets = offsets.contiguous();
+    if (per_sample_weights.has_value()) {
+      per_sample_weights = per_sample_weights->contiguous();
+    }
+    std::vector<int64_t> storage;
+    const int64_t* offsets_data = check_and_get_offsets(
+        op_name,
+        indices,
+        offsets,
+        mode,
+        per_sample_weights,
+        include_last_offset,
+        storage);
+    const int64_t output_size =
+        include_last_offset ? offsets.numel() - 1 : offsets.numel();
+    const int64_t block_size = k4Bit
+        ? embedding_4bit_columns(packed_weight.size(1))
+        : embedding_byte_columns(packed_weight.size(1));
+    Tensor output = at::empty(
+        {output_size, block_size}, packed_weight.options().dtype(kFloat));
+    const float* per_sample_weights_data = per_sample_weights.has_value()
+        ? per_sample_weights->data_ptr<float>()
+        : nullptr;
+
+    if (indices.scalar_type() == kLong) {
+      run<int64_t>(
+          packed_weight,
+          indices,
+          offsets_data,
+          output_size,
+          mode == MODE_MEAN,
+          per_sample_weights_data,
+          output);
+    } else {
+      run<int32_t>(
+          packed_weight,
+          indices,
+          offsets_data,
+          output_size,
+          mode == MODE_MEAN,
+          per_sample_weights_data,
+          output);
+    }
+    return output;
+  }
+
+ private:
+  template <typename IndexType>
+  static void run(
+      const Tensor& packed_weight,
+      const Tensor& indices,
+      const int64_t* offsets_data,
+      int64_t output_size,
+      bool normalize_by_lengths,
+      const float* per_sample_weights_data,
+      Tensor& output) {
+    if (k4Bit) {
+      embedding_bag_4bit_impl<IndexType>(
+          packed_weight,
+          indices,
+          offsets_data,
+          output_size,
+          normalize_by_lengths,
+          per_sample_weights_data,
+          output);
+    } else {
+      embedding_bag_byte_impl<IndexType>(
+          packed_weight,
+          indices,
+          offsets_data,
+          output_size,
+          normalize_by_lengths,
+          per_sample_weights_data,
+          output);
+    }
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte(Tensor weight, Tensor indices, Tensor offsets, "
+            "int mode=0, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingBag<false>>(
+                DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit(Tensor weight, Tensor indices, Tensor offsets, "
+            "int mode=0, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options().kernel<QEmbeddingBag<true>>(
+                DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -0,0 +1,175 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/embedding_utils.h>
+
+#include <caffe2/perfkernels/fused_8bit_rowwise_conversion.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace at {
+namespace native {
+namespace {
+
+void check_embedding_weight(const char* op_name, const Tensor& weight) {
+  TORCH_CHECK(
+      weight.scalar_type() == kFloat && weight.dim() == 2,
+      op_name,
+      ": Expected a 2-D float weight, got a ",
+      weight.dim(),
+      "-D ",
+      weight.scalar_type(),
+      " tensor");
+}
+
+void check_packed_weight(const char* op_name, const Tensor& packed_weight) {
+  TORCH_CHECK(
+      packed_weight.scalar_type() == kByte && packed_weight.dim() == 2,
+      op_name,
+      ": Expected a 2-D uint8 packed weight");
+}
+
+// The weight of quantized::embedding_bag_byte, see embedding_utils.h.
+class QEmbeddingBagBytePackWeight final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    check_embedding_weight("quantized::embedding_bag_byte_prepack", weight);
+    const auto weight_contig = weight.contiguous();
+    const int64_t rows = weight_contig.size(0);
+    const int64_t columns = weight_contig.size(1);
+    Tensor packed_weight = at::empty(
+        {rows, embedding_byte_row_bytes(columns)},
+        weight_contig.options().dtype(kByte));
+    const float* weight_data = weight_contig.data_ptr<float>();
+    uint8_t* packed_data = packed_weight.data_ptr<uint8_t>();
+    at::parallel_for(0, rows, 1, [&](int64_t start_idx, int64_t end_idx) {
+      caffe2::FloatToFused8BitRowwiseQuantized(
+          weight_data + start_idx * columns,
+          end_idx - start_idx,
+          columns,
+          packed_data + start_idx * embedding_byte_row_bytes(columns));
+    });
+    return packed_weight;
+  }
+};
+
+class QEmbeddingBagByteUnpackWeight final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    check_packed_weight("quantized::embedding_bag_byte_unpack", packed_weight);
+    const auto packed_contig = packed_weight.contiguous();
+    const int64_t rows = packed_contig.size(0);
+    const int64_t row_bytes = packed_contig.size(1);
+    const int64_t columns = embedding_byte_columns(row_bytes);
+    Tensor weight =
+        at::empty({rows, columns}, packed_contig.options().dtype(kFloat));
+    const uint8_t* packed_data = packed_contig.data_ptr<uint8_t>();
+    float* weight_data = weight.data_ptr<float>();
+    at::parallel_for(0, rows, 1, [&](int64_t start_idx, int64_t end_idx) {
+      caffe2::Fused8BitRowwiseQuantizedToFloat(
+          packed_data + start_idx * row_bytes,
+          end_idx - start_idx,
+          row_bytes,
+          weight_data + start_idx * columns);
+    });
+    return weight;
+  }
+};
+
+// The weight of quantized::embedding_bag_4bit, see embedding_utils.h. The
+// scale and the bias are rounded to Half before the row is quantized with
+// them, so that unpacking gives back the values the lookup works with.
+class QEmbeddingBag4BitPackWeight final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    check_embedding_weight("quantized::embedding_bag_4bit_prepack", weight);
+    TORCH_CHECK(
+        weight.size(1) % 2 == 0,
+        "quantized::embedding_bag_4bit_prepack: Expected an even embedding "
+        "dimension, got ",
+        weight.size(1));
+    const auto weight_contig = weight.contiguous();
+    const int64_t rows = weight_contig.size(0);
+    const int64_t columns = weight_contig.size(1);
+    const int64_t row_bytes = embedding_4bit_row_bytes(columns);
+    Tensor packed_weight =
+        at::empty({rows, row_bytes}, weight_contig.options().dtype(kByte));
+    const float* weight_data = weight_contig.data_ptr<float>();
+    uint8_t* packed_data = packed_weight.data_ptr<uint8_t>();
+    at::parallel_for(0, rows, 1, [&](int64_t start_idx, int64_t end_idx) {
+      for (int64_t row = start_idx; row < end_idx; ++row) {
+        const float* input = weight_data + row * columns;
+        uint8_t* output = packed_data + row * row_bytes;
+        const auto minmax = std::minmax_element(input, input + columns);
+        const at::Half bias = *minmax.first;
+        const float range = *minmax.second - static_cast<float>(bias);
+        const at::Half scale = range == 0 ? 1.0f : range / 15;
+        const float inverse_scale = 1.0f / static_cast<float>(scale);
+        std::fill(output, output + columns / 2, 0);
+        for (int64_t col = 0; col < columns; ++col) {
+          const float quantized = std::nearbyint(
+              (input[col] - static_cast<float>(bias)) * inverse_scale);
+          const auto value =
+              static_cast<uint8_t>(std::max(0.0f, std::min(15.0f, quantized)));
+          output[col / 2] |= value << ((col % 2) * 4);
+        }
+        auto* scale_bias = reinterpret_cast<at::Half*>(output + columns / 2);
+        scale_bias[0] = scale;
+        scale_bias[1] = bias;
+      }
+    });
+    return packed_weight;
+  }
+};
+
+class QEmbeddingBag4BitUnpackWeight final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    check_packed_weight("quantized::embedding_bag_4bit_unpack", packed_weight);
+    const auto packed_contig = packed_weight.contiguous();
+    const int64_t rows = packed_contig.size(0);
+    const int64_t row_bytes = packed_contig.size(1);
+    const int64_t columns = embedding_4bit_columns(row_bytes);
+    Tensor weight =
+        at::empty({rows, columns}, packed_contig.options().dtype(kFloat));
+    const uint8_t* packed_data = packed_contig.data_ptr<uint8_t>();
+    float* weight_data = weight.data_ptr<float>();
+    at::parallel_for(0, rows, 1, [&](int64_t start_idx, int64_t end_idx) {
+      for (int64_t row = start_idx; row < end_idx; ++row) {
+        const uint8_t* input = packed_data + row * row_bytes;
+        float* output = weight_data + row * columns;
+        const auto* scale_bias =
+            reinterpret_cast<const at::Half*>(input + columns / 2);
+        const float scale = scale_bias[0];
+        const float bias = scale_bias[1];
+        for (int64_t col = 0; col < columns; ++col) {
+          const uint8_t quantized = (input[col / 2] >> ((col % 2) * 4)) & 0xf;
+          output[col] = scale * quantized + bias;
+        }
+      }
+    });
+    return weight;
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagBytePackWeight>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_byte_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagByteUnpackWeight>(
+                    DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitPackWeight>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitUnpackWeight>(
+                    DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
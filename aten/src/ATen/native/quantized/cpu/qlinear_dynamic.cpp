@@ -3,9 +3,9 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
+#include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
 #include <ATen/native/quantized/cpu/quant_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
 #include <string>
@@ -308,7 +308,7 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
         bias_ptr,
         output.data_ptr<float>(),
         rows_w /* output_stride */,
-        caffe2::mobile_pthreadpool() /* threadpool */);
+        qnnpack_threadpool() /* threadpool */);
 
     TORCH_INTERNAL_ASSERT(
         runStatus == pytorch_qnnp_status_success,
@@ -0,0 +1,97 @@
+#include <ATen/ATen.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+#include <ATen/quantized/Quantizer.h>
+
+#include <cstdint>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qlut_stub);
+
+// Note [Quantized lookup tables]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A chain of elementwise quantized ops on an 8-bit tensor can only produce
+// 256 different outputs, one for every byte value of its input. Instead of
+// running the chain on the tensor, with one pass over the memory per op, it
+// runs on the 256 byte values:
+//
+//   %domain = quantized::lut_domain(%x)
+//   %lut = <the chain>(%domain)
+//   %y = quantized::apply_lut(%x, %lut)
+//
+// lut_domain returns the 256 values of the dtype, ordered by their byte and
+// quantized with the qparams of %x, so entry b of %lut is the result of the
+// chain for the input byte b. apply_lut then does the single pass over %x,
+// and its output has the qparams the chain produced. The scale and zero
+// point of %x are only known at run time, which is why the table is built
+// by every call; it's a few hundred elements.
+
+namespace {
+
+void check_lut_input(const char* op_name, const Tensor& qx) {
+  TORCH_CHECK(
+      qx.qscheme() == kPerTensorAffine,
+      op_name,
+      ": Only per tensor affine quantized tensors are supported");
+  TORCH_CHECK(
+      qx.scalar_type() == kQUInt8 || qx.scalar_type() == kQInt8,
+      op_name,
+      ": Only quint8 and qint8 tensors are supported, got ",
+      qx.scalar_type());
+}
+
+class QLutDomain final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor qx) {
+    check_lut_input("quantized::lut_domain", qx);
+    Tensor domain = at::_empty_affine_quantized(
+        {256},
+        qx.options(),
+        qx.q_scale(),
+        qx.q_zero_point(),
+        MemoryFormat::Contiguous);
+    auto* data = reinterpret_cast<uint8_t*>(domain.data_ptr());
+    for (int i = 0; i < 256; ++i) {
+      data[i] = static_cast<uint8_t>(i);
+    }
+    return domain;
+  }
+};
+
+class QApplyLut final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor qx, Tensor lut) {
+    check_lut_input("quantized::apply_lut", qx);
+    check_lut_input("quantized::apply_lut", lut);
+    TORCH_CHECK(
+        lut.numel() == 256,
+        "quantized::apply_lut: Expected a table of 256 entries, got ",
+        lut.numel());
+    const auto memory_format = qx.suggest_memory_format();
+    const Tensor qx_contig = qx.contiguous(memory_format);
+    const Tensor lut_contig = lut.contiguous();
+    Tensor qy = at::_empty_affine_quantized(
+        qx_contig.sizes(),
+        qx_contig.options().dtype(lut.scalar_type()),
+        lut.q_scale(),
+        lut.q_zero_point(),
+        memory_format);
+    qlut_stub(qx.device().type(), qx_contig, lut_contig, qy);
+    return qy;
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::lut_domain(Tensor qx) -> Tensor",
+            c10::RegisterOperators::options().kernel<QLutDomain>(
+                DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::apply_lut(Tensor qx, Tensor lut) -> Tensor qy",
+            c10::RegisterOperators::options().kernel<QApplyLut>(
+                DispatchKey::QuantizedCPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
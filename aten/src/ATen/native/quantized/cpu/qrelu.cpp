@@ -7,7 +7,6 @@
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
 
@@ -24,7 +23,7 @@ Tensor qnnpack_relu(Tensor input) {
   TORCH_CHECK(
       input.ndimension() > 0, "qnnpack_relu(): Got empty input tensor");
 
-  Tensor input_contig = input.contiguous();
+  Tensor input_contig = input.contiguous(input.suggest_memory_format());
 
   const auto zero_point = input_contig.q_zero_point();
 
@@ -57,7 +56,8 @@ Tensor qnnpack_relu(Tensor input) {
       input_contig.sizes(),
       input.options(),
       input_contig.q_scale(),
-      input_contig.q_zero_point());
+      input_contig.q_zero_point(),
+      input_contig.suggest_memory_format());
 
   size_t num_elems_y = volume / qy.size(0);
 
@@ -72,7 +72,7 @@ Tensor qnnpack_relu(Tensor input) {
       setupStatus == pytorch_qnnp_status_success,
       "failed to setup QNNPACK Relu operator");
 
-  pthreadpool_t threadpool = caffe2::mobile_pthreadpool();
+  pthreadpool_t threadpool = qnnpack_threadpool();
 
   const pytorch_qnnp_status runStatus =
       pytorch_qnnp_run_operator(qnnpack_operator, threadpool);
@@ -117,9 +117,10 @@ Tensor& quantized_leaky_relu_out(Tensor& result, const Tensor& self,
 }
 
 Tensor quantized_leaky_relu(const Tensor& self, Scalar negval) {
-  const auto qx = self.contiguous();
+  const auto qx = self.contiguous(self.suggest_memory_format());
   auto qy = at::_empty_affine_quantized(qx.sizes(), self.options(),
-                                        qx.q_scale(), qx.q_zero_point());
+                                        qx.q_scale(), qx.q_zero_point(),
+                                        qx.suggest_memory_format());
   qrelu_leaky_stub(self.device().type(), qy, qx, negval);
   return qy;
 }
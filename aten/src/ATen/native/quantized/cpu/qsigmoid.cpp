@@ -7,7 +7,6 @@
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
 
@@ -28,7 +27,7 @@ Tensor qnnpack_sigmoid(Tensor input) {
 
   initQNNPACK();
 
-  Tensor input_contig = input.contiguous();
+  Tensor input_contig = input.contiguous(input.suggest_memory_format());
   size_t num_elems = input_contig.numel() / input_contig.size(0);
 
   const auto zero_point = input_contig.q_zero_point();
@@ -51,7 +50,8 @@ Tensor qnnpack_sigmoid(Tensor input) {
     input_contig.sizes(),
     input.options(),
     output_scale,
-    output_zero_point);
+    output_zero_point,
+    input_contig.suggest_memory_format());
 
   const pytorch_qnnp_status setupStatus = pytorch_qnnp_setup_sigmoid_nc_q8(
     sigmoid_op,
@@ -63,7 +63,7 @@ Tensor qnnpack_sigmoid(Tensor input) {
   TORCH_INTERNAL_ASSERT(setupStatus == pytorch_qnnp_status_success,
                         "failed to setup QNNPACK sigmoid operator");
 
-  pthreadpool_t threadpool = caffe2::mobile_pthreadpool();
+  pthreadpool_t threadpool = qnnpack_threadpool();
 
   const pytorch_qnnp_status runStatus =
     pytorch_qnnp_run_operator(sigmoid_op, threadpool);
@@ -7,7 +7,6 @@
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
-#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
 
@@ -27,7 +26,7 @@ Tensor qnnpack_tanh(Tensor input) {
 
   initQNNPACK();
 
-  Tensor input_contig = input.contiguous();
+  Tensor input_contig = input.contiguous(input.suggest_memory_format());
   size_t num_elems = input_contig.numel() / input_contig.size(0);
 
   const auto zero_point = input_contig.q_zero_point();
@@ -50,7 +49,8 @@ Tensor qnnpack_tanh(Tensor input) {
     input_contig.sizes(),
     input.options(),
     output_scale,
-    output_zero_point);
+    output_zero_point,
+    input_contig.suggest_memory_format());
 
   const pytorch_qnnp_status setupStatus = pytorch_qnnp_setup_tanh_nc_q8(
     tanh_op,
@@ -62,7 +62,7 @@ Tensor qnnpack_tanh(Tensor input) {
   TORCH_INTERNAL_ASSERT(setupStatus == pytorch_qnnp_status_success,
                         "failed to setup QNNPACK TanH operator");
 
-  pthreadpool_t threadpool = caffe2::mobile_pthreadpool();
+  pthreadpool_t threadpool = qnnpack_threadpool();
 
   const pytorch_qnnp_status runStatus =
     pytorch_qnnp_run_operator(tanh_op, threadpool);
@@ -0,0 +1,262 @@
+// Optimizer steps for sparse gradients, like the ones of sparse embeddings.
+// They update only the rows of the parameter and of its state that the
+// gradient touches, so that the cost of a step does not grow with the size of
+// the parameter.
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/SparseTensorUtils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace at { namespace native {
+
+using namespace at::sparse;
+
+namespace {
+
+constexpr int64_t kSparseStepGrainSize = 32768;
+
+void check_sparse_step_args(
+    const char* name,
+    const Tensor& param,
+    const Tensor& grad,
+    std::initializer_list<Tensor> states) {
+  TORCH_CHECK(grad.is_sparse(), name, ": expected a sparse gradient");
+  TORCH_CHECK(grad.sizes() == param.sizes(),
+              name, ": expected the gradient to have the size of the parameter, ",
+              param.sizes(), ", but got ", grad.sizes());
+  TORCH_CHECK(grad.scalar_type() == param.scalar_type() && grad.device() == param.device(),
+              name, ": expected the gradient to have the dtype and device of the parameter");
+  for (const auto& state : states) {
+    TORCH_CHECK(state.sizes() == param.sizes() && state.scalar_type() == param.scalar_type() &&
+                state.device() == param.device(),
+                name, ": expected the optimizer state to have the size, dtype and device of the parameter");
+  }
+}
+
+// Runs fn on contiguous versions of the parameter and its states, and copies
+// the results back into the tensors that were not contiguous.
+template <typename Fn>
+void with_contiguous(std::vector<Tensor> tensors, const Fn& fn) {
+  std::vector<Tensor> contiguous;
+  contiguous.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    contiguous.push_back(t.contiguous());
+  }
+  fn(contiguous);
+  for (size_t i = 0; i < tensors.size(); i++) {
+    if (!contiguous[i].is_same(tensors[i])) {
+      tensors[i].copy_(contiguous[i]);
+    }
+  }
+}
+
+// Groups the entries of an uncoalesced sparse gradient by row of the
+// parameter, viewed as a matrix whose rows are indexed by the flattened sparse
+// indices. perm lists the entries in row order, keeping the input order of
+// the entries of a row, and starts holds the position in perm of the first
+// entry of every row, followed by nnz.
+void segment_rows(
+    const Tensor& grad,
+    int64_t num_rows,
+    std::vector<int64_t>& rows,
+    std::vector<int64_t>& perm,
+    std::vector<int64_t>& starts) {
+  const int64_t nnz = grad._nnz();
+  const auto flat = flatten_indices(grad._indices(), grad.sizes()).contiguous();
+  const int64_t* keys = flat.data_ptr<int64_t>();
+  rows.assign(keys, keys + nnz);
+  for (int64_t i = 0; i < nnz; i++) {
+    TORCH_CHECK(rows[i] >= 0 && rows[i] < num_rows,
+                "sparse optimizer step: gradient index ", rows[i], " is out of bounds for ",
+                num_rows, " rows");
+  }
+  perm.resize(nnz);
+  std::iota(perm.begin(), perm.end(), 0);
+  if (!grad.is_coalesced()) {
+    std::stable_sort(perm.begin(), perm.end(), [&](int64_t a, int64_t b) {
+      return rows[a] < rows[b];
+    });
+  }
+  starts.clear();
+  for (int64_t i = 0; i < nnz; i++) {
+    if (i == 0 || rows[perm[i]] != rows[perm[i - 1]]) {
+      starts.push_back(i);
+    }
+  }
+  starts.push_back(nnz);
+}
+
+// Sums the gradient entries of every touched row, in parallel over the rows,
+// and calls update(row, summed_grad) once per row. Different rows update
+// disjoint parts of the parameter and of its state.
+template <typename scalar_t, typename Update>
+void for_each_touched_row(const Tensor& grad, int64_t num_rows, int64_t row_size, const Update& update) {
+  std::vector<int64_t> rows, perm, starts;
+  segment_rows(grad, num_rows, rows, perm, starts);
+  const auto values = grad._values().contiguous();
+  const scalar_t* values_data = values.data_ptr<scalar_t>();
+  const int64_t num_segments = starts.size() - 1;
+  const int64_t grain_size = std::max<int64_t>(1, kSparseStepGrainSize / std::max<int64_t>(row_size, 1));
+  at::parallel_for(0, num_segments, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> g(row_size);
+    for (int64_t s = begin; s < end; s++) {
+      const scalar_t* first = values_data + perm[starts[s]] * row_size;
+      std::copy(first, first + row_size, g.begin());
+      for (int64_t e = starts[s] + 1; e < starts[s + 1]; e++) {
+        const scalar_t* entry = values_data + perm[e] * row_size;
+        for (int64_t j = 0; j < row_size; j++) {
+          g[j] += entry[j];
+        }
+      }
+      update(rows[perm[starts[s]]], g.data());
+    }
+  });
+}
+
+int64_t sparse_rows(const Tensor& grad) {
+  int64_t num_rows = 1;
+  for (int64_t d = 0; d < grad.sparse_dim(); d++) {
+    num_rows *= grad.size(d);
+  }
+  return num_rows;
+}
+
+} // namespace
+
+// Adagrad, as in torch.optim.Adagrad: sum += g^2, param -= lr * g / (sqrt(sum) + eps),
+// with g the sum of the gradient entries of a row.
+void sparse_adagrad_step_cpu(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& sum,
+    double lr,
+    double eps) {
+  check_sparse_step_args("_sparse_adagrad_step", param, grad, {sum});
+  if (grad._nnz() == 0) {
+    return;
+  }
+  const int64_t num_rows = sparse_rows(grad);
+  const int64_t row_size = num_rows ? param.numel() / num_rows : 0;
+  with_contiguous({param, sum}, [&](std::vector<Tensor>& t) {
+    AT_DISPATCH_FLOATING_TYPES(param.scalar_type(), "sparse_adagrad_step_cpu", [&] {
+      scalar_t* param_data = t[0].data_ptr<scalar_t>();
+      scalar_t* sum_data = t[1].data_ptr<scalar_t>();
+      for_each_touched_row<scalar_t>(grad, num_rows, row_size, [&](int64_t row, const scalar_t* g) {
+        scalar_t* p = param_data + row * row_size;
+        scalar_t* s = sum_data + row * row_size;
+        for (int64_t j = 0; j < row_size; j++) {
+          s[j] += g[j] * g[j];
+          p[j] -= lr * g[j] / (std::sqrt(s[j]) + eps);
+        }
+      });
+    });
+  });
+}
+
+// Adam restricted to the touched rows, as in torch.optim.SparseAdam: the
+// moments of the other rows do not decay.
+void sparse_adam_step_cpu(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& exp_avg,
+    const Tensor& exp_avg_sq,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    int64_t step) {
+  check_sparse_step_args("_sparse_adam_step", param, grad, {exp_avg, exp_avg_sq});
+  if (grad._nnz() == 0) {
+    return;
+  }
+  const int64_t num_rows = sparse_rows(grad);
+  const int64_t row_size = num_rows ? param.numel() / num_rows : 0;
+  const double bias_correction1 = 1 - std::pow(beta1, step);
+  const double bias_correction2 = 1 - std::pow(beta2, step);
+  const double step_size = lr * std::sqrt(bias_correction2) / bias_correction1;
+  with_contiguous({param, exp_avg, exp_avg_sq}, [&](std::vector<Tensor>& t) {
+    AT_DISPATCH_FLOATING_TYPES(param.scalar_type(), "sparse_adam_step_cpu", [&] {
+      scalar_t* param_data = t[0].data_ptr<scalar_t>();
+      scalar_t* exp_avg_data = t[1].data_ptr<scalar_t>();
+      scalar_t* exp_avg_sq_data = t[2].data_ptr<scalar_t>();
+      for_each_touched_row<scalar_t>(grad, num_rows, row_size, [&](int64_t row, const scalar_t* g) {
+        scalar_t* p = param_data + row * row_size;
+        scalar_t* m = exp_avg_data + row * row_size;
+        scalar_t* v = exp_avg_sq_data + row * row_size;
+        for (int64_t j = 0; j < row_size; j++) {
+          m[j] += (1 - beta1) * (g[j] - m[j]);
+          v[j] += (1 - beta2) * (g[j] * g[j] - v[j]);
+          p[j] -= step_size * m[j] / (std::sqrt(v[j]) + eps);
+        }
+      });
+    });
+  });
+}
+
+// The CUDA versions coalesce the gradient and update the touched rows with
+// index_select and index_add_, which touch the same rows as the CPU kernels.
+void sparse_adagrad_step_cuda(
+    const Tensor& param,
+    const Tensor& grad_,
+    const Tensor& sum,
+    double lr,
+    double eps) {
+  check_sparse_step_args("_sparse_adagrad_step", param, grad_, {sum});
+  if (grad_._nnz() == 0) {
+    return;
+  }
+  const auto grad = grad_.coalesce();
+  const int64_t num_rows = sparse_rows(grad);
+  const auto rows = flatten_indices(grad._indices(), grad.sizes());
+  const auto g = grad._values().reshape({grad._nnz(), -1});
+  with_contiguous({param, sum}, [&](std::vector<Tensor>& t) {
+    auto param_rows = t[0].view({num_rows, -1});
+    auto sum_rows = t[1].view({num_rows, -1});
+    const auto new_sum = sum_rows.index_select(0, rows).addcmul_(g, g);
+    sum_rows.index_copy_(0, rows, new_sum);
+    param_rows.index_add_(0, rows, g.div(new_sum.sqrt_().add_(eps)).mul_(-lr));
+  });
+}
+
+void sparse_adam_step_cuda(
+    const Tensor& param,
+    const Tensor& grad_,
+    const Tensor& exp_avg,
+    const Tensor& exp_avg_sq,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    int64_t step) {
+  check_sparse_step_args("_sparse_adam_step", param, grad_, {exp_avg, exp_avg_sq});
+  if (grad_._nnz() == 0) {
+    return;
+  }
+  const auto grad = grad_.coalesce();
+  const int64_t num_rows = sparse_rows(grad);
+  const auto rows = flatten_indices(grad._indices(), grad.sizes());
+  const auto g = grad._values().reshape({grad._nnz(), -1});
+  const double bias_correction1 = 1 - std::pow(beta1, step);
+  const double bias_correction2 = 1 - std::pow(beta2, step);
+  const double step_size = lr * std::sqrt(bias_correction2) / bias_correction1;
+  with_contiguous({param, exp_avg, exp_avg_sq}, [&](std::vector<Tensor>& t) {
+    auto param_rows = t[0].view({num_rows, -1});
+    auto exp_avg_rows = t[1].view({num_rows, -1});
+    auto exp_avg_sq_rows = t[2].view({num_rows, -1});
+    auto m = exp_avg_rows.index_select(0, rows);
+    m.add_(g.sub(m), 1 - beta1);
+    auto v = exp_avg_sq_rows.index_select(0, rows);
+    v.add_(g.mul(g).sub_(v), 1 - beta2);
+    exp_avg_rows.index_copy_(0, rows, m);
+    exp_avg_sq_rows.index_copy_(0, rows, v);
+    param_rows.index_add_(0, rows, m.div(v.sqrt().add_(eps)).mul_(-step_size));
+  });
+}
+
+}} // namespace at::native
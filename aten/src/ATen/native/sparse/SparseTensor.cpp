@@ -8,7 +8,9 @@
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/SparseTensorUtils.h>
 
-#include <TH/THBlasUtils.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -352,6 +354,81 @@ SparseTensor& copy_sparse_(SparseTensor& self, const SparseTensor& src, bool non
   return self._coalesced_(src.is_coalesced());
 }
 
+namespace {
+
+// Number of keys below which coalescing does not use threads
+constexpr int64_t kCoalesceGrainSize = 32768;
+
+// Returns the permutation that stably sorts the keys. This is a least
+// significant digit radix sort of the keys relative to the smallest one, one
+// byte per pass, where the bytes above the range of the keys and the bytes
+// that are the same for all the keys are skipped. Every pass counts the digits
+// of contiguous chunks of keys in parallel, and then moves every chunk in
+// parallel to the positions given by the prefix sum of the counts in (digit,
+// chunk) order.
+std::vector<int64_t> radix_sort_permutation(const int64_t* keys_in, int64_t n) {
+  const auto minmax = std::minmax_element(keys_in, keys_in + n);
+  const uint64_t min_key = static_cast<uint64_t>(*minmax.first);
+  const uint64_t range = static_cast<uint64_t>(*minmax.second) - min_key;
+
+  std::vector<uint64_t> keys(n);
+  std::vector<uint64_t> keys_tmp(n);
+  std::vector<int64_t> perm(n);
+  std::vector<int64_t> perm_tmp(n);
+  at::parallel_for(0, n, kCoalesceGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      keys[i] = static_cast<uint64_t>(keys_in[i]) - min_key;
+      perm[i] = i;
+    }
+  });
+
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), divup(n, kCoalesceGrainSize)));
+  const int64_t chunk_size = divup(n, num_chunks);
+  std::vector<int64_t> offsets(num_chunks * 256);
+  for (int shift = 0; shift < 64 && (range >> shift) != 0; shift += 8) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* counts = offsets.data() + c * 256;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          counts[(keys[i] >> shift) & 0xff]++;
+        }
+      }
+    });
+    int64_t sum = 0;
+    bool skip = false;
+    for (int digit = 0; digit < 256 && !skip; digit++) {
+      int64_t digit_count = 0;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * 256 + digit];
+        offsets[c * 256 + digit] = sum;
+        sum += count;
+        digit_count += count;
+      }
+      skip = digit_count == n;
+    }
+    if (skip) {
+      continue;
+    }
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* positions = offsets.data() + c * 256;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          const int64_t pos = positions[(keys[i] >> shift) & 0xff]++;
+          keys_tmp[pos] = keys[i];
+          perm_tmp[pos] = perm[i];
+        }
+      }
+    });
+    keys.swap(keys_tmp);
+    perm.swap(perm_tmp);
+  }
+  return perm;
+}
+
+} // namespace
+
 SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   AT_ASSERT(self.defined());
   TORCH_INTERNAL_ASSERT(at::impl::variable_excluded_from_dispatch());
@@ -374,54 +451,124 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
 
-  LongTensor indices_scalar = flatten_indices(indices, self.sizes());
+  LongTensor indices_scalar = flatten_indices(indices, self.sizes()).contiguous();
+  const int64_t* keys = indices_scalar.data_ptr<int64_t>();
+
+  // Indices that are already sorted (e.g. produced by an op that merges
+  // coalesced tensors, but not flagged as such) need no sort, and no merge
+  // either if they are also unique.
+  bool sorted = true;
+  bool unique = true;
+  {
+    const int64_t num_chunks = divup(nnz - 1, kCoalesceGrainSize);
+    std::vector<char> chunk_sorted(num_chunks, 1);
+    std::vector<char> chunk_unique(num_chunks, 1);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        for (int64_t i = c * kCoalesceGrainSize + 1; i < std::min(nnz, (c + 1) * kCoalesceGrainSize + 1); i++) {
+          if (keys[i] < keys[i - 1]) {
+            chunk_sorted[c] = 0;
+            break;
+          }
+          if (keys[i] == keys[i - 1]) {
+            chunk_unique[c] = 0;
+          }
+        }
+      }
+    });
+    for (int64_t c = 0; c < num_chunks; c++) {
+      sorted &= chunk_sorted[c] != 0;
+      unique &= chunk_unique[c] != 0;
+    }
+  }
+  if (sorted && unique) {
+    SparseTensor dst = self.clone();
+    dst._coalesced_(true);
+    return dst;
+  }
+
+  std::vector<int64_t> perm;
+  if (sorted) {
+    perm.resize(nnz);
+    std::iota(perm.begin(), perm.end(), 0);
+  } else {
+    perm = radix_sort_permutation(keys, nnz);
+  }
+
+  // The unique keys start the segments of equal sorted keys. Count the
+  // segments that start in every chunk, then find where they start.
+  const int64_t num_chunks = divup(nnz, kCoalesceGrainSize);
+  std::vector<int64_t> chunk_segments(num_chunks + 1, 0);
+  auto is_segment_start = [&](int64_t j) {
+    return j == 0 || keys[perm[j]] != keys[perm[j - 1]];
+  };
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t count = 0;
+      for (int64_t j = c * kCoalesceGrainSize; j < std::min(nnz, (c + 1) * kCoalesceGrainSize); j++) {
+        count += is_segment_start(j);
+      }
+      chunk_segments[c + 1] = count;
+    }
+  });
+  std::partial_sum(chunk_segments.begin(), chunk_segments.end(), chunk_segments.begin());
+  const int64_t new_nnz = chunk_segments[num_chunks];
+  std::vector<int64_t> segment_starts(new_nnz + 1);
+  segment_starts[new_nnz] = nnz;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t s = chunk_segments[c];
+      for (int64_t j = c * kCoalesceGrainSize; j < std::min(nnz, (c + 1) * kCoalesceGrainSize); j++) {
+        if (is_segment_start(j)) {
+          segment_starts[s++] = j;
+        }
+      }
+    }
+  });
 
   SparseTensor dst = new_sparse(self.options());
   get_sparse_impl(dst)->resize_(sparse_dim, dense_dim, self.sizes());
-  // TODO: is there a more idiomatic way to do this?
-  LongTensor newIndices = at::empty(indices.sizes(), indices.options());
-  Tensor newValues = at::empty(values.sizes(), values.options());
+  std::vector<int64_t> new_values_size = values.sizes().vec();
+  new_values_size[0] = new_nnz;
+  LongTensor newIndices = at::empty({sparse_dim, new_nnz}, indices.options());
+  Tensor newValues = at::empty(new_values_size, values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
-  // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
 
-  int64_t i = -1;
+  // Every segment is summed, in input order, into one entry of the result
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data_ptr<scalar_t>();
         scalar_t* newValues_ptr = newValues.data_ptr<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-            }
-          } else {
-            ++i;
+        at::parallel_for(0, new_nnz, std::max<int64_t>(1, kCoalesceGrainSize / std::max<int64_t>(1, blockSize)),
+            [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            const int64_t first = perm[segment_starts[i]];
             for (int64_t d = 0; d < sparse_dim; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+              newIndicesAccessor[d][i] = indicesAccessor[d][first];
+            }
+            if (values.numel() == 0) {  // if values is an empty tensor, there are no elements to copy
+              continue;
+            }
+            scalar_t* dst_ptr = newValues_ptr + i * blockSize;
+            const scalar_t* src_ptr = values_ptr + first * blockSize;
+            for (int64_t k = 0; k < blockSize; k++) {
+              dst_ptr[k] = src_ptr[k];
             }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+            for (int64_t j = segment_starts[i] + 1; j < segment_starts[i + 1]; j++) {
+              src_ptr = values_ptr + perm[j] * blockSize;
+              for (int64_t k = 0; k < blockSize; k++) {
+                dst_ptr[k] += src_ptr[k];
+              }
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
-
   return dst;
 }
 
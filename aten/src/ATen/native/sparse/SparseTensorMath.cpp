@@ -12,6 +12,10 @@
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -41,6 +45,30 @@ namespace {
     return csr;
   }
 
+  // Returns the CSR row pointers of the coalesced matrix `sparse`. They are
+  // cached on the tensor, so that repeated products with the same matrix
+  // only compute them once.
+  LongTensor _cached_to_csr(const SparseTensor& sparse) {
+    AT_ASSERT(sparse.is_coalesced() && sparse.sparse_dim() == 2);
+    auto impl = get_sparse_impl(sparse);
+    LongTensor csr = impl->csr_cache().first;
+    if (!csr.defined()) {
+      int64_t dim = sparse.size(0);
+      int64_t nnz = sparse._nnz();
+      LongTensor indices = sparse._indices().contiguous();
+      if (nnz > 0) {
+        // Coalesced indices are sorted, so checking the ends checks all rows
+        auto row_accessor = indices.accessor<int64_t, 2>()[0];
+        TORCH_CHECK(row_accessor[0] >= 0 && row_accessor[nnz - 1] < dim,
+            "addmm: index out of row bound: ", row_accessor[0] < 0 ? row_accessor[0] : row_accessor[nnz - 1],
+            " not between 1 and ", dim);
+      }
+      csr = _to_csr(indices.data_ptr<int64_t>(), dim, nnz);
+      impl->set_csr_cache(csr, indices.select(0, 1));
+    }
+    return csr;
+  }
+
 }
 
 // --------------------------------------------------------------------
@@ -257,78 +285,120 @@ Tensor& sub_out_sparse(Tensor& r, const Tensor& self, const Tensor& other, Scala
 }
 
 
+// Number of entries below which the merge of two sparse tensors does not use
+// threads
+constexpr int64_t kSparseMergeGrainSize = 32768;
+
+// Adds two coalesced tensors with contiguous values. Coalesced indices are
+// sorted in the order of their flattened (linear) indices, so this is a merge
+// of two sorted lists of unique keys. The merge is split into chunks at evenly
+// spaced keys of the longer list; the entries of the other list with the same
+// keys go to the same chunk. Every chunk counts its output entries, and then
+// writes them at the offsets given by the prefix sum of the counts.
 SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value, ScalarType commonDtype) {
     // saving those because they can be overwritten when doing in-place operations
-    int64_t t_nnz = t._nnz(), s_nnz = src._nnz(), max_nnz = t_nnz + s_nnz;
-    bool coalesced = t.is_coalesced() && src.is_coalesced();
+    int64_t t_nnz = t._nnz(), s_nnz = src._nnz();
     int64_t sparse_dim = src.sparse_dim();
 
-    LongTensor r_indices = at::empty({src.sparse_dim(), max_nnz}, t._indices().options());
-
+    auto t_indices = t._indices();
+    auto src_indices = src._indices();
     Tensor t_values = t._values().to(commonDtype);
     Tensor s_values = src._values().to(commonDtype);
 
-    Tensor r_values = new_values_with_size_of(s_values, max_nnz).zero_();
+    LongTensor t_keys_tensor = flatten_indices(t_indices, t.sizes()).contiguous();
+    LongTensor s_keys_tensor = flatten_indices(src_indices, src.sizes()).contiguous();
+    const int64_t* t_keys = t_keys_tensor.data_ptr<int64_t>();
+    const int64_t* s_keys = s_keys_tensor.data_ptr<int64_t>();
+
+    // chunk c merges t[t_bounds[c], t_bounds[c + 1]) with s[s_bounds[c], s_bounds[c + 1])
+    const int64_t num_chunks = std::max<int64_t>(1, std::min<int64_t>(
+        at::get_num_threads(), divup(t_nnz + s_nnz, kSparseMergeGrainSize)));
+    std::vector<int64_t> t_bounds(num_chunks + 1), s_bounds(num_chunks + 1);
+    t_bounds[num_chunks] = t_nnz;
+    s_bounds[num_chunks] = s_nnz;
+    for (int64_t c = 0; c < num_chunks; c++) {
+      if (t_nnz >= s_nnz) {
+        t_bounds[c] = c * t_nnz / num_chunks;
+        s_bounds[c] = c == 0 ? 0 : std::lower_bound(s_keys, s_keys + s_nnz, t_keys[t_bounds[c]]) - s_keys;
+      } else {
+        s_bounds[c] = c * s_nnz / num_chunks;
+        t_bounds[c] = c == 0 ? 0 : std::lower_bound(t_keys, t_keys + t_nnz, s_keys[s_bounds[c]]) - t_keys;
+      }
+    }
+
+    // Calls fn(r_i, t_i, s_i) for every output entry of chunk c, where t_i or
+    // s_i is -1 when only the other tensor has the entry
+    auto merge_chunk = [&](int64_t c, int64_t r_i, const auto& fn) {
+      int64_t t_i = t_bounds[c], s_i = s_bounds[c];
+      const int64_t t_end = t_bounds[c + 1], s_end = s_bounds[c + 1];
+      while (t_i < t_end || s_i < s_end) {
+        if (s_i >= s_end || (t_i < t_end && t_keys[t_i] < s_keys[s_i])) {
+          fn(r_i++, t_i++, -1);
+        } else if (t_i >= t_end || s_keys[s_i] < t_keys[t_i]) {
+          fn(r_i++, -1, s_i++);
+        } else {
+          fn(r_i++, t_i++, s_i++);
+        }
+      }
+      return r_i;
+    };
 
-    int64_t blockSize = r_values.stride(0);
-    int64_t cmp, d;
-    int64_t r_i = 0, t_i = 0, s_i = 0;
-    auto t_indices = t._indices();
-    auto src_indices = src._indices();
+    std::vector<int64_t> r_offsets(num_chunks + 1, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        r_offsets[c + 1] = merge_chunk(c, 0, [](int64_t, int64_t, int64_t) {});
+      }
+    });
+    std::partial_sum(r_offsets.begin(), r_offsets.end(), r_offsets.begin());
+    const int64_t r_nnz = r_offsets[num_chunks];
 
-    // NB: relies on nnz tests above
+    LongTensor r_indices = at::empty({sparse_dim, r_nnz}, t_indices.options());
+    Tensor r_values = new_values_with_size_of(s_values, r_nnz);
+
+    int64_t blockSize = r_values.stride(0);
     auto t_indices_accessor = t_indices.accessor<int64_t, 2>();
     auto r_indices_accessor = r_indices.accessor<int64_t, 2>();
     auto src_indices_accessor = src_indices.accessor<int64_t, 2>();
 
     AT_DISPATCH_ALL_TYPES(
         commonDtype, "cadd_sparse", [&] {
-          scalar_t* t_values_ptr = t_values.data_ptr<scalar_t>();
-          scalar_t* s_values_ptr = s_values.data_ptr<scalar_t>();
+          const scalar_t* t_values_ptr = t_values.data_ptr<scalar_t>();
+          const scalar_t* s_values_ptr = s_values.data_ptr<scalar_t>();
           scalar_t* r_values_ptr = r_values.data_ptr<scalar_t>();
           scalar_t cast_value = value.to<scalar_t>();
-          while (t_i < t_nnz || s_i < s_nnz) {
-            if (t_i >= t_nnz) {
-              cmp = -1;
-            } else if (s_i >= s_nnz) {
-              cmp = 1;
-            } else {
-              cmp = 0;
-              for (d = 0; d < sparse_dim; d++) {
-                if (t_indices_accessor[d][t_i] < src_indices_accessor[d][s_i]) {
-                  cmp = 1;
-                  break;
+          // values may be empty when a dense dimension has size 0
+          const bool has_values = r_values.numel() > 0;
+          at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+            for (int64_t c = begin; c < end; c++) {
+              merge_chunk(c, r_offsets[c], [&](int64_t r_i, int64_t t_i, int64_t s_i) {
+                for (int64_t d = 0; d < sparse_dim; d++) {
+                  r_indices_accessor[d][r_i] = t_i >= 0
+                      ? t_indices_accessor[d][t_i] : src_indices_accessor[d][s_i];
                 }
-                if (t_indices_accessor[d][t_i] > src_indices_accessor[d][s_i]) {
-                  cmp = -1;
-                  break;
+                if (!has_values) {
+                  return;
                 }
-              }
-            }
-            if (cmp >= 0) {
-              for (d = 0; d < sparse_dim; d++) {
-                r_indices_accessor[d][r_i] = t_indices_accessor[d][t_i];
-              }
-              if (t_values.numel() > 0) {  // We add all elements from t_values to r_values only if t_values is not an empty tensor
-                THBlas_axpy<scalar_t>(blockSize, 1,
-                  t_values_ptr + t_i * blockSize, 1,
-                  r_values_ptr + r_i * blockSize, 1);
-              }
-              t_i++;
-            }
-            if (cmp <= 0) {
-              for (d = 0; d < sparse_dim; d++) {
-                r_indices_accessor[d][r_i] = src_indices_accessor[d][s_i];
-              }
-              if (s_values.numel() > 0) {  // We add all elements from s_values to r_values only if s_values is not an empty tensor
-                THBlas_axpy<scalar_t>(blockSize, cast_value,
-                  s_values_ptr + s_i * blockSize, 1,
-                  r_values_ptr + r_i * blockSize, 1);
-              }
-              s_i++;
+                scalar_t* r_ptr = r_values_ptr + r_i * blockSize;
+                if (t_i < 0) {
+                  const scalar_t* s_ptr = s_values_ptr + s_i * blockSize;
+                  for (int64_t k = 0; k < blockSize; k++) {
+                    r_ptr[k] = cast_value * s_ptr[k];
+                  }
+                } else if (s_i < 0) {
+                  const scalar_t* t_ptr = t_values_ptr + t_i * blockSize;
+                  for (int64_t k = 0; k < blockSize; k++) {
+                    r_ptr[k] = t_ptr[k];
+                  }
+                } else {
+                  const scalar_t* t_ptr = t_values_ptr + t_i * blockSize;
+                  const scalar_t* s_ptr = s_values_ptr + s_i * blockSize;
+                  for (int64_t k = 0; k < blockSize; k++) {
+                    r_ptr[k] = t_ptr[k] + cast_value * s_ptr[k];
+                  }
+                }
+              });
             }
-            r_i++;
-          }
+          });
         }
     );
 
@@ -336,13 +406,7 @@ SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t,
       r_values = r_values.to(r.scalar_type());
     }
     get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
-    get_sparse_impl(r)->set_nnz_and_narrow(r_i);
-
-    // TODO: I think it may be possible to track inside the loop and
-    // detect when we are uncoalesced (e.g., by observing that an
-    // index goes backwards) which may be more precise than using the
-    // coalesced flag here.  But this is easy.
-    return r._coalesced_(coalesced);
+    return r._coalesced_(true);
 }
 
 SparseTensor& add_out_sparse_non_contiguous(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value, ScalarType commonDtype) {
@@ -394,7 +458,10 @@ SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const S
 
   r.resize_as_(src);
 
-  if (src._values().is_contiguous() && t._values().is_contiguous()) {
+  // The sum of uncoalesced tensors is uncoalesced anyway, so their entries
+  // are simply concatenated
+  if (src._values().is_contiguous() && t._values().is_contiguous() &&
+      t.is_coalesced() && src.is_coalesced()) {
     return add_out_sparse_contiguous(r, t, src, value, commonDtype);
   } else {
     return add_out_sparse_non_contiguous(r, t, src, value, commonDtype);
@@ -608,9 +675,7 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // --------------------------------------------------------------------
 
 template <typename scalar_t>
-void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t i;
-
+void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense, const Tensor& csr) {
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
   scalar_t cast_beta = beta.to<scalar_t>();
@@ -634,7 +699,46 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-  for (i = 0; i < nnz; i++) {
+
+  if (csr.defined()) {
+    // Every row of the result only depends on one row of the sparse matrix,
+    // so the rows are split among threads
+    auto csr_accessor = csr.accessor<int64_t, 1>();
+    int64_t row_cost = std::max<int64_t>(1, nnz / std::max<int64_t>(1, dim_i) * dim_k);
+    int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / row_cost);
+    at::parallel_for(0, dim_i, grain_size, [&](int64_t start, int64_t end) {
+      for (int64_t row = start; row < end; row++) {
+        int64_t i_start = csr_accessor[row];
+        int64_t i_end = csr_accessor[row + 1];
+        if (dim_k == 1) {
+          // Matrix-vector product: one dot product per row
+          scalar_t sum = 0;
+          for (int64_t i = i_start; i < i_end; i++) {
+            int64_t col = indices_accessor[1][i];
+            TORCH_CHECK(col >= 0 && col < dim_j,
+                "addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+            sum += values_accessor[i] * dense_ptr[col * dense_stride0];
+          }
+          r_ptr[row * r_stride0] += cast_alpha * sum;
+        } else {
+          for (int64_t i = i_start; i < i_end; i++) {
+            int64_t col = indices_accessor[1][i];
+            TORCH_CHECK(col >= 0 && col < dim_j,
+                "addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+            THBlas_axpy<scalar_t>(dim_k,
+                  cast_alpha * values_accessor[i],
+                  dense_ptr + col * dense_stride0, dense_stride1,
+                  r_ptr + row * r_stride0, r_stride1);
+          }
+        }
+      }
+    });
+    return;
+  }
+
+  // Uncoalesced matrices may have duplicate entries in any order, so they
+  // are accumulated serially
+  for (int64_t i = 0; i < nnz; i++) {
     scalar_t val = values_accessor[i];
     int64_t row = indices_accessor[0][i];
     int64_t col = indices_accessor[1][i];
@@ -694,10 +798,14 @@ Tensor& s_addmm_out_sparse_dense_cpu(
 
   LongTensor indices = sparse_._indices();
   Tensor values      = sparse_._values();
+  LongTensor csr;
+  if (sparse_.is_coalesced()) {
+    csr = _cached_to_csr(sparse_);
+  }
 
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "addmm_sparse_dense", [&] {
-        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense);
+        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense, csr);
       }
   );
 
@@ -914,7 +1022,7 @@ SparseTensor& _sspaddmm_out_cpu(
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
 
-  LongTensor csr = _to_csr(indices.data_ptr<int64_t>(), dim_i, nnz);
+  LongTensor csr = _cached_to_csr(sparse);
 
   int64_t t_nnz = t._nnz();
   int64_t r_nnz = nnz * dim_k + t_nnz;
@@ -43,6 +43,26 @@ namespace {
     sparse::cuda::Xcoo2csr(rowIndicesInt.data_ptr<int32_t>(), nnz, dim, csr.data_ptr<int32_t>());
     return csr;
   }
+
+  // Returns the CSR row pointers and column indices of the coalesced matrix
+  // `sparse` as int tensors, which is what cuSPARSE takes. They are cached on
+  // the tensor, so that repeated products with the same matrix only convert
+  // the indices once.
+  std::pair<IntTensor, IntTensor> _cached_to_csr_int(const SparseTensor& sparse) {
+    auto impl = get_sparse_impl(sparse);
+    IntTensor csr, colIndicesInt;
+    std::tie(csr, colIndicesInt) = impl->csr_cache();
+    if (!csr.defined()) {
+      LongTensor indices = sparse._indices();
+      LongTensor rowIndices = indices.select(0, 0);
+      LongTensor colIndices = indices.select(0, 1);
+      csr = _to_csr_int(rowIndices, sparse.size(0), sparse._nnz());
+      colIndicesInt = at::empty({colIndices.size(0)}, indices.options().dtype(kInt));
+      colIndicesInt.copy_(colIndices);
+      impl->set_csr_cache(csr, colIndicesInt);
+    }
+    return std::make_pair(csr, colIndicesInt);
+  }
 }
 
 // NB: Deleted spaddcmul (aka addcmul_, but not actually wired up), spaddcdiv (not
@@ -81,14 +101,10 @@ Tensor& s_addmm_out_sparse_dense_cuda(Tensor& r_, const Tensor& t, const SparseT
   SparseTensor sparse = sparse_.coalesce();
 
   int64_t nnz = sparse._nnz();
-  LongTensor indices = sparse._indices();
   Tensor values = sparse._values();
 
-  LongTensor rowIndices = indices.select(0, 0);
-  LongTensor colIndices = indices.select(0, 1);
-  IntTensor csr = _to_csr_int(rowIndices, m, nnz);
-  IntTensor colIndicesInt = at::empty({colIndices.size(0)}, indices.options().dtype(kInt));
-  colIndicesInt.copy_(colIndices);
+  IntTensor csr, colIndicesInt;
+  std::tie(csr, colIndicesInt) = _cached_to_csr_int(sparse);
 
   // No half support, so we don't have to use CUDATypeConversion
   Tensor r__;
@@ -286,7 +286,9 @@ Tensor quantize_tensor(Tensor rtensor, Tensor qtensor, double scale, int64_t zer
   checkFloatCPUTensor(fn_name, rtensor);
   checkQuantizedCPUTensor<T>(fn_name, qtensor);
   checkZeroPoint<typename T::underlying>(fn_name, zero_point);
-  TORCH_CHECK(rtensor.is_contiguous(), "Float tensor should be contiguous");
+  TORCH_CHECK(
+      rtensor.is_contiguous(rtensor.suggest_memory_format()),
+      "Float tensor should be contiguous");
   const float* const rdata = rtensor.data_ptr<float>();
   // If QEngine is set to QNNPACK, use caffe2 specialized Int8Quantize implementation on ARM
 #if defined(__ARM_NEON__)
@@ -564,12 +566,16 @@ Tensor PerTensorAffineQuantizer::quantize(Tensor rtensor) {
       "quantize only works for CPU backend right now.");
   // Here we need a std::intrusive_ptr<Quantizer>.. but actually "this" is the
   // quantizer that can be reused, so I'm using intrusive_from_this here
+  // The elements are quantized in memory order, so the quantized tensor can
+  // keep the layout of the input, e.g. channels last.
+  const auto memory_format = rtensor.suggest_memory_format();
   Tensor qtensor = new_qtensor_cpu(
       rtensor.sizes(),
       rtensor.options().dtype(scalar_type_),
-      intrusive_from_this());
+      intrusive_from_this(),
+      memory_format);
 
-  rtensor = rtensor.contiguous();
+  rtensor = rtensor.contiguous(memory_format);
   AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(), "quantize_tensor", [&]() {
     qtensor = quantize_tensor<scalar_t>(rtensor, qtensor, scale_, zero_point_);
   });
@@ -582,8 +588,10 @@ Tensor PerTensorAffineQuantizer::dequantize(Tensor qtensor) {
   TORCH_CHECK(
       qtensor.device() == kCPU,
       "dequantize only works for CPU backend right now.");
-  Tensor rtensor = at::empty(qtensor.sizes(), qtensor.options().dtype(at::kFloat));
-  qtensor = qtensor.contiguous();
+  const auto memory_format = qtensor.suggest_memory_format();
+  Tensor rtensor = at::empty(
+      qtensor.sizes(), qtensor.options().dtype(at::kFloat), memory_format);
+  qtensor = qtensor.contiguous(memory_format);
 
   AT_DISPATCH_QINT_TYPES(qtensor.scalar_type(), "dequantize_tensor", [&]() {
     rtensor = dequantize_tensor<scalar_t>(qtensor, rtensor, scale_, zero_point_);
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+
+using namespace c10::cuda;
+
+// Verifies that blocks freed into a private pool are not handed out to the
+// default pool, and are reused by allocations routed to the same pool.
+TEST(CUDACachingAllocatorTest, PrivatePoolIsolation) {
+  if (!at::cuda::is_available()) return;
+  auto* allocator = CUDACachingAllocator::get();
+  const auto pool = CUDACachingAllocator::createPool("replica0");
+
+  void* pool_ptr = nullptr;
+  {
+    CUDACachingAllocator::MemPoolGuard guard(pool);
+    auto data = allocator->allocate(4 << 20);
+    pool_ptr = data.get();
+  }
+
+  {
+    auto data = allocator->allocate(4 << 20);
+    ASSERT_NE(data.get(), pool_ptr);
+  }
+
+  {
+    CUDACachingAllocator::MemPoolGuard guard(pool);
+    auto data = allocator->allocate(4 << 20);
+    ASSERT_EQ(data.get(), pool_ptr);
+  }
+
+  CUDACachingAllocator::releasePool(pool);
+  ASSERT_ANY_THROW(CUDACachingAllocator::MemPoolGuard guard(pool));
+}
+
+// Verifies that segments owned by a private pool show up in the snapshot
+// with their pool and stream, and disappear once the pool is released.
+TEST(CUDACachingAllocatorTest, SnapshotReportsPools) {
+  if (!at::cuda::is_available()) return;
+  auto* allocator = CUDACachingAllocator::get();
+  const auto pool = CUDACachingAllocator::createPool("replica1");
+
+  auto count_segments = [pool]() {
+    int count = 0;
+    for (const auto& segment : CUDACachingAllocator::snapshot()) {
+      if (segment.pool_id == pool) {
+        EXPECT_EQ(segment.pool_name, "replica1");
+        EXPECT_EQ(
+            segment.stream,
+            reinterpret_cast<int64_t>(at::cuda::getCurrentCUDAStream().stream()));
+        count++;
+      }
+    }
+    return count;
+  };
+
+  {
+    CUDACachingAllocator::MemPoolGuard guard(pool);
+    auto data = allocator->allocate(1 << 10);
+    ASSERT_EQ(count_segments(), 1);
+  }
+  ASSERT_EQ(count_segments(), 1);
+
+  CUDACachingAllocator::releasePool(pool);
+  ASSERT_EQ(count_segments(), 0);
+}
@@ -224,3 +224,31 @@ TEST(TensorIteratorTest, FailNonPromotingBinaryOp) {
   iter.add_input(at::ones({1,1}, at::dtype(at::kInt)));
   ASSERT_ANY_THROW(iter.build());
 }
+
+TEST(TensorIteratorTest, PlanCache) {
+  auto a = at::randn({3, 4, 5}, kCPU).transpose(0, 2);
+  auto b = at::randn({4, 1}, kCPU);
+  auto a_contiguous = a.contiguous();
+  auto b_double = b.to(kDouble);
+  auto expected = a + b;
+
+  TensorIteratorPlanCacheGuard guard;
+  TensorIteratorPlanCacheGuard::clear_cache();
+  for (int i = 0; i < 3; i++) {
+    Tensor out;
+    auto iter = TensorIterator::binary_op(out, a, b);
+    at::native::cpu_serial_kernel(iter, [](float x, float y) -> float { return x + y; });
+    EXPECT_TRUE(iter.output().strides().equals(expected.strides()));
+    EXPECT_TRUE(iter.output().equal(expected));
+    EXPECT_EQ(TensorIteratorPlanCacheGuard::cache_size(), 1u);
+  }
+  // A different geometry gets a plan of its own
+  Tensor out;
+  TensorIterator::binary_op(out, a_contiguous, b);
+  EXPECT_EQ(TensorIteratorPlanCacheGuard::cache_size(), 2u);
+  // Promoting by copy can't be replayed from a plan, so it isn't cached
+  Tensor out_double;
+  TensorIterator::binary_op(out_double, a, b_double);
+  EXPECT_EQ(TensorIteratorPlanCacheGuard::cache_size(), 2u);
+  TensorIteratorPlanCacheGuard::clear_cache();
+}
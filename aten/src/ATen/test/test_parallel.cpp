@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
+#include <c10/util/tempfile.h>
 
 #include <iostream>
 #include <string.h>
@@ -69,3 +70,29 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, GrainSizeAutotuning) {
+  at::set_grain_size_autotuning(true);
+  std::atomic<int64_t> sum{0};
+  auto reduce_fn = [](int64_t begin, int64_t end, int64_t ident) {
+    return ident + end - begin;
+  };
+  for (int iter = 0; iter < 100; ++iter) {
+    // Results must not depend on the grain size the tuner picks.
+    at::parallel_for(0, 1000, 1, [&](int64_t begin, int64_t end) {
+      sum += end - begin;
+    });
+    ASSERT_EQ(
+        at::parallel_reduce(0, 1000, 1, (int64_t)0, reduce_fn, std::plus<int64_t>()),
+        1000);
+  }
+  ASSERT_EQ(sum, 100 * 1000);
+
+  auto tempfile = c10::make_tempfile();
+  at::save_grain_size_autotuning(tempfile.name);
+  at::load_grain_size_autotuning(tempfile.name);
+  at::set_grain_size_autotuning(false);
+
+  ASSERT_THROW(
+      at::load_grain_size_autotuning(tempfile.name + ".missing"), c10::Error);
+}
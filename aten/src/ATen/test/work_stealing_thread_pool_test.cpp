@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <ATen/WorkStealingThreadPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+using at::WorkStealingThreadPool;
+
+TEST(WorkStealingThreadPoolTest, RunsEveryIndexOnce) {
+  WorkStealingThreadPool pool(3);
+  for (size_t n : {1, 2, 3, 4, 5, 100, 10000}) {
+    std::vector<std::atomic<int>> counts(n);
+    for (auto& count : counts) {
+      count = 0;
+    }
+    pool.parallelRun(n, [&](size_t i, size_t thread_id) {
+      ASSERT_LT(thread_id, pool.size() + 1);
+      ++counts[i];
+    });
+    for (size_t i = 0; i < n; ++i) {
+      ASSERT_EQ(counts[i], 1);
+    }
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, SpreadsSkewedWork) {
+  WorkStealingThreadPool pool(3);
+  // All of the expensive indices fall into the calling thread's initial share;
+  // the other threads only get anything to do by stealing from it.
+  std::mutex mutex;
+  std::set<size_t> threads;
+  pool.parallelRun(64, [&](size_t i, size_t thread_id) {
+    if (i < 16) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(thread_id);
+    }
+  });
+  ASSERT_GT(threads.size(), 1);
+}
+
+TEST(WorkStealingThreadPoolTest, PropagatesExceptions) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> calls{0};
+  ASSERT_THROW(
+      pool.parallelRun(
+          100,
+          [&](size_t i, size_t /* unused */) {
+            ++calls;
+            if (i == 42) {
+              throw std::runtime_error("exception");
+            }
+          }),
+      std::runtime_error);
+  ASSERT_EQ(calls, 100);
+}
+
+TEST(WorkStealingThreadPoolTest, ConcurrentCallers) {
+  WorkStealingThreadPool pool(2);
+  std::vector<std::thread> callers;
+  std::atomic<size_t> total{0};
+  for (int t = 0; t < 4; ++t) {
+    callers.emplace_back([&]() {
+      for (int iter = 0; iter < 50; ++iter) {
+        pool.parallelRun(
+            37, [&](size_t /* unused */, size_t /* unused */) { ++total; });
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  ASSERT_EQ(total, 4 * 50 * 37);
+}
+
+TEST(WorkStealingThreadPoolTest, NestedCalls) {
+  WorkStealingThreadPool pool(3);
+  std::atomic<size_t> total{0};
+  pool.parallelRun(16, [&](size_t /* unused */, size_t /* unused */) {
+    // Threads executing the same call must never share a thread_id.
+    std::vector<std::atomic<int>> busy(pool.size() + 1);
+    for (auto& b : busy) {
+      b = 0;
+    }
+    pool.parallelRun(16, [&](size_t /* unused */, size_t thread_id) {
+      ASSERT_EQ(busy[thread_id]++, 0);
+      std::this_thread::yield();
+      ++total;
+      --busy[thread_id];
+    });
+  });
+  ASSERT_EQ(total, 16 * 16);
+}
+
+TEST(WorkStealingThreadPoolTest, NestedCallFromTask) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<size_t> total{0};
+  std::atomic<bool> done{false};
+  pool.run([&]() {
+    pool.parallelRun(100, [&](size_t /* unused */, size_t thread_id) {
+      ASSERT_NE(thread_id, 0);
+      ++total;
+    });
+    done = true;
+  });
+  while (!done) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(total, 100);
+}
+
+TEST(WorkStealingThreadPoolTest, RunsTasks) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 10; ++i) {
+    pool.run([&]() {
+      ASSERT_TRUE(pool.inThreadPool());
+      ++count;
+    });
+  }
+  while (count < 10) {
+    std::this_thread::yield();
+  }
+  ASSERT_FALSE(pool.inThreadPool());
+}
+
+TEST(WorkStealingThreadPoolTest, EmptyPool) {
+  WorkStealingThreadPool pool(0);
+  size_t sum = 0;
+  pool.parallelRun(10, [&](size_t i, size_t thread_id) {
+    ASSERT_EQ(thread_id, 0);
+    sum += i;
+  });
+  ASSERT_EQ(sum, 45);
+}
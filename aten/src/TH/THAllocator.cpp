@@ -11,6 +11,7 @@
 #endif
 
 #include <c10/core/CPUAllocator.h>
+#include <c10/util/numa.h>
 
 #if defined(HAVE_MMAP)
 #include <sys/types.h>
@@ -317,6 +318,15 @@ THMapAllocator::THMapAllocator(WithFd, const char *filename, int fd, int flags,
     if (base_ptr_ == MAP_FAILED) {
       AT_ERROR("$ Torch: unable to mmap memory: you tried to mmap ", size_/1073741824, " GB.");
     }
+
+    // A freshly created shared memory segment has no pages yet. Spread them
+    // over all NUMA nodes before anyone touches them, so that processes
+    // pinned to different nodes (e.g. Hogwild workers sharing parameters)
+    // don't all end up reading from the node of the process that filled it.
+    if (base_ptr_ && (flags_ & TH_ALLOCATOR_MAPPED_SHAREDMEM) &&
+        (flags_ & TH_ALLOCATOR_MAPPED_EXCLUSIVE)) {
+      c10::NUMAInterleave(base_ptr_, size_);
+    }
   }
 #endif
 }
@@ -0,0 +1,22 @@
+from __future__ import absolute_import, division, print_function, unicode_literals
+import torch
+from utils import NUM_LOOP_ITERS
+
+def overloaded_ops_loop(x, y):
+    # Each of these ops has several Python signatures, so that the time per
+    # iteration is dominated by the argument parsing
+    z = torch.add(x, y)
+    for i in range(NUM_LOOP_ITERS):
+        z = torch.add(z, x)
+        z = z.mul(2.0)
+        z = torch.sub(z, y, alpha=1)
+        z = z.sum(0, keepdim=True)
+    return z
+
+class OverloadedOpsModule(torch.nn.Module):
+    def __init__(self, ops):
+        super(OverloadedOpsModule, self).__init__()
+        self.ops = ops
+
+    def forward(self, x, y):
+        return self.ops(x, y)
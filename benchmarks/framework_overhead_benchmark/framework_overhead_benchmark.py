@@ -4,11 +4,13 @@ import argparse
 from C2Module import C2SimpleNet
 
 from SimpleAddModule import SimpleAddModule, add_tensors_loop
+from OverloadedOpsModule import OverloadedOpsModule, overloaded_ops_loop
 from pt_wrapper_module import WrapperModule
 
 """ Framework overhead benchmark script.
 Benchmark framework overhead.
-Currently supported ops: add.
+Currently supported ops: add, overloaded_ops (add, mul, sub and sum, whose
+Python argument parsing has to pick among several signatures).
 As of now runs only forward pass.
 Supports both graph mode and eager mode. In graph mode the module is traced via JIT tracing.
 Debug option prints the traced graph is graph_mode is enabled.
@@ -24,7 +26,7 @@ buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_ben
  --add_op --benchmark_c2_net
 """
 
-SUPPORTED_OPS = {"add_op"}
+SUPPORTED_OPS = {"add_op", "overloaded_ops"}
 
 def parse_op_args(op):
     op_list = ops.split(",")
@@ -94,6 +96,10 @@ def main():
         else:
             module_config = ModuleConfig(add_tensors_loop, None, num_params, graph_mode)
         benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+    elif args.op == "overloaded_ops":
+        assert not args.benchmark_c2_net, "overloaded_ops has no C2 version"
+        module_config = ModuleConfig(overloaded_ops_loop, None, 2, graph_mode)
+        benchmark_simple_fn(args, config, module_config, OverloadedOpsModule, result)
     print_results(result)
 
 if __name__ == "__main__":
@@ -0,0 +1,88 @@
+#include <torch/data/detail/bounded_queue.h>
+#include <torch/data/detail/queue.h>
+
+#include "c10/util/Flags.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+C10_DEFINE_int(producers, 8, "Number of threads pushing to the queue");
+C10_DEFINE_int(consumers, 1, "Number of threads popping from the queue");
+C10_DEFINE_int(iter, 10e5, "Number of elements to push per producer");
+C10_DEFINE_int(capacity, 64, "Capacity of the bounded queue");
+C10_DEFINE_int(benchmark_iter, 3, "Number of times to run benchmark");
+
+namespace {
+
+// Pushes FLAGS_iter elements from every producer and pops all of them, like
+// DataLoader workers pushing small batches to the main thread. An empty
+// pointer stops a consumer.
+template <typename Queue>
+float run(Queue& queue) {
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::microseconds us;
+
+  std::chrono::time_point<clock> start_time = clock::now();
+  std::vector<std::thread> producers;
+  for (auto p = 0; p < FLAGS_producers; ++p) {
+    producers.emplace_back([&queue] {
+      for (auto idx = 0; idx < FLAGS_iter; ++idx) {
+        queue.push(std::make_shared<int>(idx));
+      }
+    });
+  }
+  std::vector<std::thread> consumers;
+  for (auto c = 0; c < FLAGS_consumers; ++c) {
+    consumers.emplace_back([&queue] {
+      while (queue.pop()) {
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  for (auto c = 0; c < FLAGS_consumers; ++c) {
+    queue.push(nullptr);
+  }
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  return static_cast<float>(
+      std::chrono::duration_cast<us>(clock::now() - start_time).count());
+}
+
+template <typename Queue>
+void benchmark(const char* name, Queue& queue) {
+  const auto elements = static_cast<float>(FLAGS_producers) * FLAGS_iter;
+  for (auto bench_iter = 0; bench_iter < FLAGS_benchmark_iter; ++bench_iter) {
+    const auto duration = run(queue);
+    std::cout << name << ": " << (duration / 1000.0) << " ms, "
+              << (duration * 1000.0 / elements) << " ns per element"
+              << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+
+  std::cout << FLAGS_producers << " producers, " << FLAGS_consumers
+            << " consumers, " << FLAGS_iter << " elements per producer"
+            << std::endl;
+
+  torch::data::detail::Queue<std::shared_ptr<int>> queue;
+  benchmark("Queue", queue);
+
+  torch::data::detail::BoundedQueue<std::shared_ptr<int>> bounded_queue(
+      FLAGS_capacity);
+  benchmark("BoundedQueue", bounded_queue);
+
+  return 0;
+}
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <thread>
 #include <vector>
@@ -32,19 +33,37 @@ C10_DEFINE_int(
     num_read_threads,
     1,
     "The number of concurrent reading threads.");
+C10_DEFINE_int(
+    batch_size,
+    0,
+    "If positive, read batches of this many records with ReadBatch().");
+C10_DEFINE_int(
+    prefetch_batch_size,
+    0,
+    "If positive, prefetch batches of this many records in the reader.");
 
 using caffe2::db::Cursor;
 using caffe2::db::DB;
 using caffe2::db::DBReader;
+using caffe2::db::RecordBatch;
 using caffe2::string;
 
 void TestThroughputWithDB() {
   std::unique_ptr<DB> in_db(caffe2::db::CreateDB(
       FLAGS_input_db_type, FLAGS_input_db, caffe2::db::READ));
   std::unique_ptr<Cursor> cursor(in_db->NewCursor());
+  RecordBatch batch;
   for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
     caffe2::Timer timer;
-    for (int i = 0; i < FLAGS_report_interval; ++i) {
+    for (int i = 0; i < FLAGS_report_interval && FLAGS_batch_size > 0;) {
+      batch.Clear();
+      i += cursor->ReadBatch(
+          std::min(FLAGS_batch_size, FLAGS_report_interval - i), &batch);
+      if (!cursor->Valid()) {
+        cursor->SeekToFirst();
+      }
+    }
+    for (int i = 0; i < FLAGS_report_interval && FLAGS_batch_size <= 0; ++i) {
       string key = cursor->key();
       string value = cursor->value();
       //VLOG(1) << "Key " << key;
@@ -64,9 +83,15 @@ void TestThroughputWithDB() {
 
 void TestThroughputWithReaderWorker(const DBReader* reader, int thread_id) {
   string key, value;
+  RecordBatch batch;
   for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
     caffe2::Timer timer;
-    for (int i = 0; i < FLAGS_report_interval; ++i) {
+    for (int i = 0; i < FLAGS_report_interval && FLAGS_batch_size > 0;) {
+      const int n = std::min(FLAGS_batch_size, FLAGS_report_interval - i);
+      reader->ReadBatch(n, &batch);
+      i += n;
+    }
+    for (int i = 0; i < FLAGS_report_interval && FLAGS_batch_size <= 0; ++i) {
       reader->Read(&key, &value);
     }
     double elapsed_seconds = timer.Seconds();
@@ -82,6 +107,9 @@ void TestThroughputWithReaderWorker(const DBReader* reader, int thread_id) {
 
 void TestThroughputWithReader() {
   caffe2::db::DBReader reader(FLAGS_input_db_type, FLAGS_input_db);
+  if (FLAGS_prefetch_batch_size > 0) {
+    reader.StartPrefetch(FLAGS_prefetch_batch_size);
+  }
   std::vector<std::unique_ptr<std::thread>> reading_threads(
       FLAGS_num_read_threads);
   for (int i = 0; i < reading_threads.size(); ++i) {
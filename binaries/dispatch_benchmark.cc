@@ -0,0 +1,96 @@
+// Measures the overhead of calling a trivial operator through the c10
+// dispatcher, compared with calling its kernel directly.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+namespace {
+
+NOINLINE int64_t noop_kernel(at::Tensor self) {
+  return self.dim();
+}
+
+static auto registry = c10::RegisterOperators()
+    .op("_bench::noop(Tensor self) -> int", c10::RegisterOperators::options()
+        .kernel<decltype(noop_kernel), &noop_kernel>(c10::DispatchKey::CPUTensorId))
+    // Only reachable through the catch-all kernel, i.e. after the (cached)
+    // lookup of the CPU kernel and the CPU backend fallback kernel failed.
+    .op("_bench::noop_catchall(Tensor self) -> int", c10::RegisterOperators::options()
+        .catchAllKernel<decltype(noop_kernel), &noop_kernel>());
+
+c10::OperatorHandle findOp(const char* name) {
+  return c10::Dispatcher::singleton().findSchemaOrThrow(name, "");
+}
+
+} // namespace
+
+static void BM_DirectCall(benchmark::State& state) {
+  at::Tensor self = at::empty({1});
+  int64_t sum = 0;
+  for (auto _ : state) {
+    sum += noop_kernel(self);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_DirectCall);
+
+static void BM_DispatchUnboxed(benchmark::State& state) {
+  static auto op = findOp("_bench::noop");
+  at::Tensor self = at::empty({1});
+  int64_t sum = 0;
+  for (auto _ : state) {
+    sum += op.callUnboxed<int64_t, at::Tensor>(self);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_DispatchUnboxed);
+
+static void BM_DispatchUnboxedCatchall(benchmark::State& state) {
+  static auto op = findOp("_bench::noop_catchall");
+  at::Tensor self = at::empty({1});
+  int64_t sum = 0;
+  for (auto _ : state) {
+    sum += op.callUnboxed<int64_t, at::Tensor>(self);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_DispatchUnboxedCatchall);
+
+// Skips computing the dispatch key from the arguments.
+static void BM_DispatchUnboxedWithDispatchKey(benchmark::State& state) {
+  static auto op = findOp("_bench::noop");
+  at::Tensor self = at::empty({1});
+  int64_t sum = 0;
+  for (auto _ : state) {
+    sum += op.callUnboxedWithDispatchKey<int64_t, at::Tensor>(
+        c10::DispatchKey::CPUTensorId, self);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_DispatchUnboxedWithDispatchKey);
+
+static void BM_DispatchBoxed(benchmark::State& state) {
+  static auto op = findOp("_bench::noop");
+  at::Tensor self = at::empty({1});
+  int64_t sum = 0;
+  torch::jit::Stack stack;
+  for (auto _ : state) {
+    stack.emplace_back(self);
+    op.callBoxed(&stack);
+    sum += stack.back().toInt();
+    stack.clear();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_DispatchBoxed);
+
+BENCHMARK_MAIN();
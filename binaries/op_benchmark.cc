@@ -0,0 +1,84 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "c10/util/Flags.h"
+#include "op_benchmark_helper.h"
+
+C10_DEFINE_string(
+    configs,
+    "",
+    "The specs of the benchmarks to run, separated by semicolons, e.g. "
+    "\"add M=8,64 N=32 K=256 device=cpu threads=1,4\". The values of each "
+    "attribute are crossed, like op_bench.cross_product_configs. Ops named "
+    "like aten::add.Tensor are called through the JIT operator registry, "
+    "with tensors of the shapes attribute, e.g. shapes=8x32/8x32.");
+C10_DEFINE_string(
+    config_file,
+    "",
+    "A file with a spec per line, in the format of --configs.");
+C10_DEFINE_int(warmup, 10, "The number of runs to warm up.");
+C10_DEFINE_int(iter, 100, "The number of runs to time.");
+C10_DEFINE_string(
+    json_output,
+    "",
+    "If set, the results are written to this file as JSON.");
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Run operator benchmarks without Python overhead.\n"
+      "Example usage:\n"
+      "./op_benchmark"
+      " --configs=\"addmm M=64,128 N=64 K=64; relu M=8 N=32 K=256\""
+      " --iter=1000"
+      " --json_output=results.json");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cerr << "Failed to parse command line flags!" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> lines;
+  std::stringstream configs(FLAGS_configs);
+  std::string line;
+  while (getline(configs, line, ';')) {
+    lines.push_back(line);
+  }
+  if (!FLAGS_config_file.empty()) {
+    std::ifstream config_file(FLAGS_config_file);
+    if (!config_file) {
+      std::cerr << "Could not open " << FLAGS_config_file << std::endl;
+      return 1;
+    }
+    while (getline(config_file, line)) {
+      lines.push_back(line);
+    }
+  }
+
+  std::vector<op_bench::Result> results;
+  for (const std::string& spec_line : lines) {
+    for (const op_bench::Spec& spec : op_bench::parseSpecs(spec_line)) {
+      const op_bench::OpBenchmark* benchmark =
+          op_bench::findOpBenchmark(spec.op);
+      op_bench::OpBenchmark dispatched;
+      if (!benchmark) {
+        if (spec.op.find("::") == std::string::npos) {
+          std::cerr << "Unknown op " << spec.op << std::endl;
+          return 1;
+        }
+        dispatched = op_bench::makeDispatchedOpBenchmark(spec.op);
+        benchmark = &dispatched;
+      }
+      results.push_back(op_bench::runBenchmark(
+          spec.op, *benchmark, spec.config, FLAGS_warmup, FLAGS_iter));
+      std::cout << op_bench::toString(results.back()) << std::endl;
+    }
+  }
+
+  if (!FLAGS_json_output.empty()) {
+    std::ofstream json_output(FLAGS_json_output);
+    json_output << op_bench::toJson(results);
+  }
+  return 0;
+}
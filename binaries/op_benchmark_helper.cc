@@ -0,0 +1,427 @@
+#include "op_benchmark_helper.h"
+
+#include "ATen/Parallel.h"
+#include "ATen/detail/CUDAHooksInterface.h"
+#include "torch/csrc/jit/operator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace op_bench {
+
+namespace {
+
+std::vector<std::string> split(char separator, const std::string& string) {
+  std::vector<std::string> pieces;
+  std::stringstream ss(string);
+  std::string item;
+  while (getline(ss, item, separator)) {
+    if (!item.empty()) {
+      pieces.push_back(std::move(item));
+    }
+  }
+  return pieces;
+}
+
+// Parses a shape like 8x32x256
+std::vector<int64_t> parseShape(const std::string& shape) {
+  std::vector<int64_t> sizes;
+  for (const std::string& size : split('x', shape)) {
+    sizes.push_back(std::stoll(size));
+  }
+  return sizes;
+}
+
+at::Tensor makeInput(const Config& config, at::IntArrayRef sizes) {
+  at::Tensor input = at::rand(sizes, at::TensorOptions(config.device()));
+  if (config.dtype() != at::kFloat) {
+    // Integral inputs span more than 0 and 1
+    if (!at::isFloatingType(config.dtype())) {
+      input = input.mul_(100);
+    }
+    input = input.to(config.dtype());
+  }
+  return input;
+}
+
+std::vector<int64_t> sizesMNK(const Config& config) {
+  return {config.getInt("M"), config.getInt("N"), config.getInt("K")};
+}
+
+double numelMNK(const Config& config) {
+  return static_cast<double>(config.getInt("M")) * config.getInt("N") *
+      config.getInt("K");
+}
+
+OpBenchmark unaryMNK(at::Tensor (*op)(const at::Tensor&)) {
+  OpBenchmark benchmark;
+  benchmark.init = [](const Config& config) {
+    return std::vector<at::Tensor>{makeInput(config, sizesMNK(config))};
+  };
+  benchmark.forward = [op](const std::vector<at::Tensor>& inputs) {
+    return op(inputs[0]);
+  };
+  benchmark.flops = numelMNK;
+  return benchmark;
+}
+
+OpBenchmark binaryMNK(
+    std::function<at::Tensor(const at::Tensor&, const at::Tensor&)> op) {
+  OpBenchmark benchmark;
+  benchmark.init = [](const Config& config) {
+    return std::vector<at::Tensor>{makeInput(config, sizesMNK(config)),
+                                   makeInput(config, sizesMNK(config))};
+  };
+  benchmark.forward = [op](const std::vector<at::Tensor>& inputs) {
+    return op(inputs[0], inputs[1]);
+  };
+  benchmark.flops = numelMNK;
+  return benchmark;
+}
+
+std::unordered_map<std::string, OpBenchmark> makeOpBenchmarks() {
+  std::unordered_map<std::string, OpBenchmark> benchmarks;
+  benchmarks["add"] = binaryMNK(
+      [](const at::Tensor& a, const at::Tensor& b) { return at::add(a, b); });
+  benchmarks["mul"] = binaryMNK(
+      [](const at::Tensor& a, const at::Tensor& b) { return at::mul(a, b); });
+  benchmarks["relu"] = unaryMNK(at::relu);
+  benchmarks["sigmoid"] = unaryMNK(at::sigmoid);
+  benchmarks["exp"] = unaryMNK(at::exp);
+
+  // Like benchmarks/operator_benchmark/pt/add_test.py
+  OpBenchmark addmm;
+  addmm.init = [](const Config& config) {
+    int64_t M = config.getInt("M"), N = config.getInt("N"),
+            K = config.getInt("K");
+    return std::vector<at::Tensor>{makeInput(config, {M, K}),
+                                   makeInput(config, {M, N}),
+                                   makeInput(config, {N, K})};
+  };
+  addmm.forward = [](const std::vector<at::Tensor>& inputs) {
+    return at::addmm(inputs[0], inputs[1], inputs[2]);
+  };
+  addmm.flops = [](const Config& config) {
+    return 2 * numelMNK(config) +
+        static_cast<double>(config.getInt("M")) * config.getInt("K");
+  };
+  benchmarks["addmm"] = addmm;
+
+  OpBenchmark matmul;
+  matmul.init = [](const Config& config) {
+    int64_t M = config.getInt("M"), N = config.getInt("N"),
+            K = config.getInt("K");
+    return std::vector<at::Tensor>{makeInput(config, {M, N}),
+                                   makeInput(config, {N, K})};
+  };
+  matmul.forward = [](const std::vector<at::Tensor>& inputs) {
+    return at::matmul(inputs[0], inputs[1]);
+  };
+  matmul.flops = [](const Config& config) { return 2 * numelMNK(config); };
+  benchmarks["matmul"] = matmul;
+
+  OpBenchmark softmax = unaryMNK(nullptr);
+  softmax.forward = [](const std::vector<at::Tensor>& inputs) {
+    return at::softmax(inputs[0], -1);
+  };
+  softmax.flops = nullptr;
+  benchmarks["softmax"] = softmax;
+
+  OpBenchmark sum = unaryMNK(nullptr);
+  sum.forward = [](const std::vector<at::Tensor>& inputs) {
+    return at::sum(inputs[0]);
+  };
+  benchmarks["sum"] = sum;
+
+  OpBenchmark cat = binaryMNK(nullptr);
+  cat.forward = [](const std::vector<at::Tensor>& inputs) {
+    return at::cat(inputs, 0);
+  };
+  cat.flops = nullptr;
+  benchmarks["cat"] = cat;
+  return benchmarks;
+}
+
+double percentile(const std::vector<double>& sorted_times, double p) {
+  size_t index = static_cast<size_t>(p * sorted_times.size());
+  return sorted_times[std::min(index, sorted_times.size() - 1)];
+}
+
+double nbytes(const at::Tensor& tensor) {
+  return tensor.defined()
+      ? static_cast<double>(tensor.numel()) * tensor.element_size()
+      : 0;
+}
+
+} // namespace
+
+bool Config::has(const std::string& name) const {
+  return std::any_of(attrs.begin(), attrs.end(), [&](const auto& attr) {
+    return attr.first == name;
+  });
+}
+
+const std::string& Config::get(const std::string& name) const {
+  auto it = std::find_if(attrs.begin(), attrs.end(), [&](const auto& attr) {
+    return attr.first == name;
+  });
+  TORCH_CHECK(
+      it != attrs.end(), "The config ", str(), " has no attribute ", name);
+  return it->second;
+}
+
+int64_t Config::getInt(const std::string& name) const {
+  return std::stoll(get(name));
+}
+
+at::Device Config::device() const {
+  return has("device") ? at::Device(get("device")) : at::Device(at::kCPU);
+}
+
+at::ScalarType Config::dtype() const {
+  if (!has("dtype")) {
+    return at::kFloat;
+  }
+  static const std::unordered_map<std::string, at::ScalarType> dtypes = {
+      {"float", at::kFloat},
+      {"float32", at::kFloat},
+      {"double", at::kDouble},
+      {"float64", at::kDouble},
+      {"half", at::kHalf},
+      {"float16", at::kHalf},
+      {"int", at::kInt},
+      {"int32", at::kInt},
+      {"long", at::kLong},
+      {"int64", at::kLong},
+      {"uint8", at::kByte},
+  };
+  auto it = dtypes.find(get("dtype"));
+  TORCH_CHECK(it != dtypes.end(), "Unknown dtype ", get("dtype"));
+  return it->second;
+}
+
+int Config::threads() const {
+  return has("threads") ? static_cast<int>(getInt("threads")) : 0;
+}
+
+std::string Config::str() const {
+  std::string result;
+  for (const auto& attr : attrs) {
+    if (!result.empty()) {
+      result += "_";
+    }
+    result += attr.first + attr.second;
+  }
+  return result;
+}
+
+std::vector<Spec> parseSpecs(const std::string& line) {
+  std::vector<std::string> words = split(' ', line);
+  if (words.empty() || words[0][0] == '#') {
+    return {};
+  }
+  std::vector<Spec> specs = {Spec{words[0], Config()}};
+  for (size_t i = 1; i < words.size(); ++i) {
+    size_t equal = words[i].find('=');
+    TORCH_CHECK(
+        equal != std::string::npos,
+        "Expected an attribute like name=value1,value2 in ",
+        line);
+    std::string name = words[i].substr(0, equal);
+    std::vector<std::string> values = split(',', words[i].substr(equal + 1));
+    TORCH_CHECK(!values.empty(), "No values for ", name, " in ", line);
+    std::vector<Spec> product;
+    for (const Spec& spec : specs) {
+      for (const std::string& value : values) {
+        product.push_back(spec);
+        product.back().config.attrs.emplace_back(name, value);
+      }
+    }
+    specs = std::move(product);
+  }
+  return specs;
+}
+
+const OpBenchmark* findOpBenchmark(const std::string& name) {
+  static const std::unordered_map<std::string, OpBenchmark> benchmarks =
+      makeOpBenchmarks();
+  auto it = benchmarks.find(name);
+  return it != benchmarks.end() ? &it->second : nullptr;
+}
+
+OpBenchmark makeDispatchedOpBenchmark(const std::string& name) {
+  size_t dot = name.find('.');
+  c10::OperatorName op_name(
+      name.substr(0, dot),
+      dot != std::string::npos ? name.substr(dot + 1) : "");
+  std::shared_ptr<torch::jit::Operator> op =
+      torch::jit::findOperatorFor(op_name);
+  TORCH_CHECK(op, "Unknown operator ", name);
+
+  // The arguments of the op, created by init and copied by every run
+  auto args = std::make_shared<torch::jit::Stack>();
+  OpBenchmark benchmark;
+  benchmark.init = [op, args, name](const Config& config) {
+    std::vector<std::string> shapes =
+        config.has("shapes") ? split('/', config.get("shapes"))
+                             : std::vector<std::string>();
+    size_t next_shape = 0;
+    std::vector<at::Tensor> inputs;
+    args->clear();
+    for (const c10::Argument& arg : op->schema().arguments()) {
+      c10::TypeKind kind = arg.type()->kind();
+      if (kind == c10::TypeKind::TensorType) {
+        TORCH_CHECK(
+            next_shape < shapes.size(),
+            "No shape for argument ",
+            arg.name(),
+            " of ",
+            name);
+        inputs.push_back(makeInput(config, parseShape(shapes[next_shape++])));
+        args->emplace_back(inputs.back());
+      } else if (config.has(arg.name())) {
+        const std::string& value = config.get(arg.name());
+        if (kind == c10::TypeKind::IntType) {
+          args->emplace_back(static_cast<int64_t>(std::stoll(value)));
+        } else if (kind == c10::TypeKind::FloatType) {
+          args->emplace_back(std::stod(value));
+        } else if (kind == c10::TypeKind::BoolType) {
+          args->emplace_back(value == "true" || value == "1");
+        } else {
+          TORCH_CHECK(
+              false,
+              "Can't set argument ",
+              arg.name(),
+              " of type ",
+              arg.type()->str());
+        }
+      } else {
+        TORCH_CHECK(
+            arg.default_value(),
+            "No value for argument ",
+            arg.name(),
+            " of ",
+            name);
+        args->push_back(*arg.default_value());
+      }
+    }
+    return inputs;
+  };
+  torch::jit::Operation operation = op->getOperation();
+  benchmark.forward = [operation, args](const std::vector<at::Tensor>&) {
+    torch::jit::Stack stack = *args;
+    operation(stack);
+    return !stack.empty() && stack.back().isTensor() ? stack.back().toTensor()
+                                                     : at::Tensor();
+  };
+  return benchmark;
+}
+
+double Result::gbps() const {
+  return p50_us > 0 ? bytes / (p50_us * 1e3) : 0;
+}
+
+double Result::gflops() const {
+  return p50_us > 0 ? flops / (p50_us * 1e3) : 0;
+}
+
+Result runBenchmark(
+    const std::string& op,
+    const OpBenchmark& benchmark,
+    const Config& config,
+    int warmup,
+    int iters) {
+  TORCH_CHECK(iters > 0, "Expected at least one iteration");
+  int num_threads = at::get_num_threads();
+  if (config.threads() > 0) {
+    at::set_num_threads(config.threads());
+  }
+  bool cuda = config.device().is_cuda();
+  // Kernels are timed until they finish, not until they are launched
+  auto sync = [cuda]() {
+    if (cuda) {
+      at::detail::getCUDAHooks().deviceSynchronize();
+    }
+  };
+
+  std::vector<at::Tensor> inputs = benchmark.init(config);
+  at::Tensor output;
+  for (int i = 0; i < warmup; ++i) {
+    output = benchmark.forward(inputs);
+  }
+  sync();
+  std::vector<double> times;
+  times.reserve(iters);
+  for (int i = 0; i < iters; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    output = benchmark.forward(inputs);
+    sync();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  at::set_num_threads(num_threads);
+
+  Result result;
+  result.op = op;
+  result.config = config;
+  result.iters = iters;
+  double total = 0;
+  for (double time : times) {
+    total += time;
+  }
+  result.mean_us = total / iters;
+  std::sort(times.begin(), times.end());
+  result.min_us = times.front();
+  result.p50_us = percentile(times, 0.5);
+  result.p90_us = percentile(times, 0.9);
+  result.p99_us = percentile(times, 0.99);
+  for (const at::Tensor& input : inputs) {
+    result.bytes += nbytes(input);
+  }
+  result.bytes += nbytes(output);
+  result.flops = benchmark.flops ? benchmark.flops(config) : 0;
+  return result;
+}
+
+std::string toString(const Result& result) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(3) << result.op << "_"
+     << result.config.str() << ": p50 " << result.p50_us << " us, p90 "
+     << result.p90_us << " us, p99 " << result.p99_us << " us, "
+     << result.gbps() << " GB/s";
+  if (result.flops > 0) {
+    ss << ", " << result.gflops() << " GFLOPS";
+  }
+  return ss.str();
+}
+
+std::string toJson(const std::vector<Result>& results) {
+  std::ostringstream ss;
+  ss << std::setprecision(6) << "[";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    ss << (i > 0 ? ",\n " : "\n ") << "{\"op\": \"" << result.op
+       << "\", \"config\": {";
+    for (size_t j = 0; j < result.config.attrs.size(); ++j) {
+      const auto& attr = result.config.attrs[j];
+      ss << (j > 0 ? ", " : "") << "\"" << attr.first << "\": \""
+         << attr.second << "\"";
+    }
+    ss << "}, \"iters\": " << result.iters
+       << ", \"mean_us\": " << result.mean_us
+       << ", \"min_us\": " << result.min_us
+       << ", \"p50_us\": " << result.p50_us
+       << ", \"p90_us\": " << result.p90_us
+       << ", \"p99_us\": " << result.p99_us << ", \"bytes\": " << result.bytes
+       << ", \"gbps\": " << result.gbps() << ", \"flops\": " << result.flops
+       << ", \"gflops\": " << result.gflops() << "}";
+  }
+  ss << "\n]\n";
+  return ss.str();
+}
+
+} // namespace op_bench
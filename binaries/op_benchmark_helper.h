@@ -0,0 +1,95 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ATen/ATen.h"
+
+namespace op_bench {
+
+// The attributes a benchmark builds its inputs from, like the configs of
+// benchmarks/operator_benchmark: sizes like M, N and K, the arguments of
+// dispatched operators, and the reserved device, dtype and threads.
+struct Config {
+  // In the order of the spec
+  std::vector<std::pair<std::string, std::string>> attrs;
+
+  bool has(const std::string& name) const;
+  const std::string& get(const std::string& name) const;
+  int64_t getInt(const std::string& name) const;
+  // The device and dtype of the inputs, cpu and float by default
+  at::Device device() const;
+  at::ScalarType dtype() const;
+  // The number of intra-op threads, or 0 to keep the default
+  int threads() const;
+  // e.g. "M8_N32_K256_devicecpu", like the names of the Python benchmarks
+  std::string str() const;
+};
+
+struct Spec {
+  std::string op;
+  Config config;
+};
+
+// Parses a line like
+//
+//   add M=8,128 N=32 K=256,512 device=cpu,cuda threads=1,4
+//
+// into a spec per element of the cross product of the values of each
+// attribute, like op_bench.cross_product_configs. Empty lines and lines
+// starting with # have no specs.
+std::vector<Spec> parseSpecs(const std::string& line);
+
+struct OpBenchmark {
+  // Creates the inputs of the op
+  std::function<std::vector<at::Tensor>(const Config&)> init;
+  std::function<at::Tensor(const std::vector<at::Tensor>&)> forward;
+  // The floating point operations of a run, or 0 if they aren't counted
+  std::function<double(const Config&)> flops;
+};
+
+// The benchmarks calling ATen ops directly, e.g. "add" or "addmm", which
+// mirror the ones of benchmarks/operator_benchmark/pt. Returns nullptr for
+// unknown names.
+const OpBenchmark* findOpBenchmark(const std::string& name);
+
+// Benchmarks an operator of the JIT operator registry, e.g.
+// "aten::add.Tensor", with the dispatch overhead of TorchScript. Its tensor
+// arguments are created from the shapes attribute, e.g. shapes=8x32/8x32 for
+// two 8x32 tensors, and its other arguments from the attributes named like
+// them, or their default values.
+OpBenchmark makeDispatchedOpBenchmark(const std::string& name);
+
+struct Result {
+  std::string op;
+  Config config;
+  int64_t iters = 0;
+  double mean_us = 0;
+  double min_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  // The bytes of the inputs and output of a run
+  double bytes = 0;
+  double flops = 0;
+
+  // The achieved bandwidth and throughput at the median latency
+  double gbps() const;
+  double gflops() const;
+};
+
+// Times iters runs of the benchmark one by one, after warmup runs
+Result runBenchmark(
+    const std::string& op,
+    const OpBenchmark& benchmark,
+    const Config& config,
+    int warmup,
+    int iters);
+
+std::string toString(const Result& result);
+// A JSON array with an object per result, for regression tracking
+std::string toJson(const std::vector<Result>& results);
+
+} // namespace op_bench
@@ -14,13 +14,28 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 #include "ATen/ATen.h"
+#include "c10/core/Allocator.h"
 #include "caffe2/core/timer.h"
 #include "caffe2/utils/string_utils.h"
 #include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/jit/import.h"
 #include "torch/script.h"
 
@@ -41,14 +56,52 @@ C10_DEFINE_bool(
   print_output,
   false,
   "Whether to print output with all one input tensor.");
-C10_DEFINE_int(warmup, 0, "The number of iterations to warm up.");
-C10_DEFINE_int(iter, 10, "The number of iterations to run.");
+C10_DEFINE_int(
+    warmup,
+    0,
+    "The number of iterations to warm up, after the first inference.");
+C10_DEFINE_int(
+    iter,
+    10,
+    "The number of iterations to run, on each of the --threads.");
 C10_DEFINE_bool(
   report_pep,
   false,
   "Whether to print performance stats for AI-PEP.");
 
 C10_DEFINE_int(pytext_len, 0, "Length of input sequence.");
+C10_DEFINE_int(
+    threads,
+    1,
+    "The number of threads running requests concurrently in the main runs.");
+C10_DEFINE_bool(
+    optimize,
+    false,
+    "Whether to run the graph optimizations of the JIT, like fusion, which "
+    "profile and compile the model during the first iterations.");
+C10_DEFINE_double(
+    steady_tolerance,
+    0.1,
+    "The relative distance to the median latency of the main runs within "
+    "which a warmup iteration counts as being in the steady state.");
+C10_DEFINE_int(
+    per_op_iter,
+    10,
+    "The number of iterations to run with the profiler after the main runs, "
+    "for the time of each op. 0 skips them.");
+C10_DEFINE_string(
+    json_output,
+    "",
+    "If set, the results are written to this file as JSON.");
+C10_DEFINE_string(
+    baseline,
+    "",
+    "A --json_output of an earlier run. The benchmark fails if the latency or "
+    "memory regressed by more than --max_regression from it.");
+C10_DEFINE_double(
+    max_regression,
+    0.05,
+    "The relative regression from the --baseline that fails the benchmark.");
 
 std::vector<std::string>
 split(char separator, const std::string& string, bool ignore_empty = true) {
@@ -63,6 +116,219 @@ split(char separator, const std::string& string, bool ignore_empty = true) {
   return pieces;
 }
 
+namespace {
+
+double percentile(const std::vector<double>& sorted_times, double p) {
+  if (sorted_times.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(p * sorted_times.size());
+  return sorted_times[std::min(index, sorted_times.size() - 1)];
+}
+
+double elapsedUs(high_resolution_clock::time_point start) {
+  return duration_cast<nanoseconds>(high_resolution_clock::now() - start)
+             .count() /
+      1000.0;
+}
+
+// The bytes allocated by the CPU allocator since the memory reporter was set
+std::atomic<int64_t> allocated_bytes{0};
+std::atomic<int64_t> peak_allocated_bytes{0};
+
+void reportMemoryUsage(
+    void* /* unused */,
+    int64_t alloc_size,
+    c10::Device device) {
+  if (device.type() != c10::DeviceType::CPU) {
+    return;
+  }
+  int64_t allocated = allocated_bytes += alloc_size;
+  int64_t peak = peak_allocated_bytes.load();
+  while (allocated > peak &&
+         !peak_allocated_bytes.compare_exchange_weak(peak, allocated)) {
+  }
+}
+
+// The peak resident set size of the process, or -1 if it isn't known
+int64_t peakRssKb() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+  }
+#endif
+  return -1;
+}
+
+// The time spent in an op per inference
+struct OpStats {
+  std::string name;
+  double calls = 0;
+  double self_us = 0;
+  double total_us = 0;
+};
+
+// Aggregates the ranges recorded by the profiler over iters inferences, sorted
+// by decreasing self time
+std::vector<OpStats> aggregateOps(
+    const torch::autograd::profiler::thread_event_lists& event_lists,
+    int iters) {
+  using torch::autograd::profiler::Event;
+  using torch::autograd::profiler::EventKind;
+  std::unordered_map<std::string, OpStats> ops;
+  for (const auto& events : event_lists) {
+    // The open ranges, with the time spent in their children
+    std::vector<std::tuple<const Event*, int64_t>> stack;
+    for (const Event& event : events) {
+      if (event.eventKind() == EventKind::PushRange) {
+        stack.emplace_back(&event, 0);
+      } else if (event.eventKind() == EventKind::PopRange && !stack.empty()) {
+        const Event* start;
+        int64_t children_ns;
+        std::tie(start, children_ns) = stack.back();
+        stack.pop_back();
+        const int64_t total_ns = event.cpu_ns() - start->cpu_ns();
+        OpStats& op = ops[start->name()];
+        op.name = start->name();
+        op.calls += 1.0 / iters;
+        op.total_us += total_ns / 1000.0 / iters;
+        op.self_us += (total_ns - children_ns) / 1000.0 / iters;
+        if (!stack.empty()) {
+          std::get<1>(stack.back()) += total_ns;
+        }
+      }
+    }
+  }
+  std::vector<OpStats> result;
+  for (auto& entry : ops) {
+    result.push_back(std::move(entry.second));
+  }
+  std::sort(
+      result.begin(), result.end(), [](const OpStats& a, const OpStats& b) {
+        return a.self_us > b.self_us;
+      });
+  return result;
+}
+
+struct Results {
+  double load_ms = 0;
+  double first_inference_us = 0;
+  // The latency of the first inference and of every warmup iteration
+  std::vector<double> warmup_us;
+  // The first iteration of warmup_us from which all are within
+  // --steady_tolerance of the median of the main runs, or -1 if the warmup
+  // never got there
+  int64_t steady_state_iter = -1;
+  int64_t iters = 0;
+  double mean_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+  double inferences_per_s = 0;
+  int64_t peak_allocated_bytes = 0;
+  int64_t peak_rss_kb = -1;
+  std::vector<OpStats> ops;
+};
+
+std::string jsonString(const std::string& s) {
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+
+std::string toJson(const Results& results) {
+  std::ostringstream ss;
+  ss << std::setprecision(6) << "{\n"
+     << " \"model\": " << jsonString(FLAGS_model) << ",\n"
+     << " \"threads\": " << FLAGS_threads << ",\n"
+     << " \"optimize\": " << (FLAGS_optimize ? "true" : "false") << ",\n"
+     << " \"load_ms\": " << results.load_ms << ",\n"
+     << " \"first_inference_us\": " << results.first_inference_us << ",\n"
+     << " \"warmup_us\": [";
+  for (size_t i = 0; i < results.warmup_us.size(); ++i) {
+    ss << (i > 0 ? ", " : "") << results.warmup_us[i];
+  }
+  ss << "],\n"
+     << " \"steady_state_iter\": " << results.steady_state_iter << ",\n"
+     << " \"iters\": " << results.iters << ",\n"
+     << " \"mean_us\": " << results.mean_us << ",\n"
+     << " \"p50_us\": " << results.p50_us << ",\n"
+     << " \"p90_us\": " << results.p90_us << ",\n"
+     << " \"p99_us\": " << results.p99_us << ",\n"
+     << " \"max_us\": " << results.max_us << ",\n"
+     << " \"inferences_per_s\": " << results.inferences_per_s << ",\n"
+     << " \"peak_allocated_bytes\": " << results.peak_allocated_bytes << ",\n"
+     << " \"peak_rss_kb\": " << results.peak_rss_kb << ",\n"
+     << " \"ops\": [";
+  for (size_t i = 0; i < results.ops.size(); ++i) {
+    const OpStats& op = results.ops[i];
+    ss << (i > 0 ? ",\n  " : "\n  ") << "{\"name\": " << jsonString(op.name)
+       << ", \"calls\": " << op.calls << ", \"self_us\": " << op.self_us
+       << ", \"total_us\": " << op.total_us << "}";
+  }
+  ss << "\n ]\n}\n";
+  return ss.str();
+}
+
+// Reads a number field of a --json_output, or returns false if it is missing
+bool readJsonNumber(
+    const std::string& json,
+    const std::string& key,
+    double* value) {
+  const std::string pattern = "\"" + key + "\": ";
+  size_t pos = json.find(pattern);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  *value = strtod(json.c_str() + pos + pattern.size(), nullptr);
+  return true;
+}
+
+// Compares the results to the --baseline, printing the regressions. Returns
+// whether there were none.
+bool checkBaseline(const Results& results) {
+  std::ifstream file(FLAGS_baseline);
+  CAFFE_ENFORCE(file, "Could not open the baseline ", FLAGS_baseline);
+  std::stringstream json;
+  json << file.rdbuf();
+  // Lower is better for all of them
+  const std::vector<std::pair<std::string, double>> metrics = {
+      {"first_inference_us", results.first_inference_us},
+      {"p50_us", results.p50_us},
+      {"p90_us", results.p90_us},
+      {"p99_us", results.p99_us},
+      {"peak_allocated_bytes",
+       static_cast<double>(results.peak_allocated_bytes)},
+  };
+  bool passed = true;
+  for (const auto& metric : metrics) {
+    double baseline = 0;
+    if (!readJsonNumber(json.str(), metric.first, &baseline) || baseline <= 0) {
+      continue;
+    }
+    const double change = metric.second / baseline - 1;
+    const bool regressed = change > FLAGS_max_regression;
+    passed = passed && !regressed;
+    std::cout << (regressed ? "REGRESSION " : "") << metric.first << ": "
+              << baseline << " -> " << metric.second << " (" << std::showpos
+              << change * 100 << std::noshowpos << "%)" << std::endl;
+  }
+  return passed;
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   c10::SetUsageMessage(
     "Run speed benchmark for pytorch model.\n"
@@ -72,7 +338,10 @@ int main(int argc, char** argv) {
     " --input_dims=\"1,3,224,224\""
     " --input_type=float"
     " --warmup=5"
-    " --iter=20");
+    " --iter=20"
+    " --threads=4"
+    " --json_output=results.json"
+    " --baseline=baseline.json");
   if (!c10::ParseCommandLineFlags(&argc, &argv)) {
     std::cerr << "Failed to parse command line flags!" << std::endl;
     return 1;
@@ -80,6 +349,7 @@ int main(int argc, char** argv) {
 
   CAFFE_ENFORCE_GE(FLAGS_input_dims.size(), 0, "Input dims must be specified.");
   CAFFE_ENFORCE_GE(FLAGS_input_type.size(), 0, "Input type must be specified.");
+  CAFFE_ENFORCE_GE(FLAGS_threads, 1, "There must be at least one thread.");
 
   std::vector<std::string> input_dims_list = split(';', FLAGS_input_dims);
   std::vector<std::string> input_type_list = split(';', FLAGS_input_type);
@@ -115,16 +385,25 @@ int main(int argc, char** argv) {
   if (std::find(qengines.begin(), qengines.end(), at::QEngine::QNNPACK) != qengines.end()) {
     at::globalContext().setQEngine(at::QEngine::QNNPACK);
   }
+  // Both are thread local, and set again on every request thread
   torch::autograd::AutoGradMode guard(false);
-  torch::jit::GraphOptimizerEnabledGuard no_optimizer_guard(false);
-  auto module = torch::jit::load(FLAGS_model);
+  torch::jit::GraphOptimizerEnabledGuard no_optimizer_guard(FLAGS_optimize);
 
+  Results results;
+  auto load_start = high_resolution_clock::now();
+  auto module = torch::jit::load(FLAGS_model);
   module.eval();
+  results.load_ms = elapsedUs(load_start) / 1000.0;
+
+  std::cout << "Starting benchmark." << std::endl;
+  auto first_start = high_resolution_clock::now();
+  auto first_output = module.forward(inputs);
+  results.first_inference_us = elapsedUs(first_start);
+  results.warmup_us.push_back(results.first_inference_us);
   if (FLAGS_print_output) {
-    std::cout << module.forward(inputs) << std::endl;
+    std::cout << first_output << std::endl;
   }
 
-  std::cout << "Starting benchmark." << std::endl;
   std::cout << "Running warmup runs." << std::endl;
   CAFFE_ENFORCE(
       FLAGS_warmup >= 0,
@@ -132,7 +411,9 @@ int main(int argc, char** argv) {
       FLAGS_warmup,
       ".");
   for (int i = 0; i < FLAGS_warmup; ++i) {
+    auto start = high_resolution_clock::now();
     module.forward(inputs);
+    results.warmup_us.push_back(elapsedUs(start));
   }
 
   std::cout << "Main runs." << std::endl;
@@ -141,26 +422,109 @@ int main(int argc, char** argv) {
       "Number of main runs should be non negative, provided ",
       FLAGS_iter,
       ".");
+  std::vector<std::vector<double>> thread_times(FLAGS_threads);
+  auto run_requests = [&](int thread) {
+    torch::autograd::AutoGradMode thread_guard(false);
+    torch::jit::GraphOptimizerEnabledGuard optimizer_guard(FLAGS_optimize);
+    for (int i = 0; i < FLAGS_iter; ++i) {
+      auto start = high_resolution_clock::now();
+      module.forward(inputs);
+      thread_times[thread].push_back(elapsedUs(start));
+    }
+  };
   caffe2::Timer timer;
-  std::vector<float> times;
+  if (FLAGS_threads == 1) {
+    run_requests(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < FLAGS_threads; ++t) {
+      threads.emplace_back(run_requests, t);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
   auto millis = timer.MilliSeconds();
-  for (int i = 0; i < FLAGS_iter; ++i) {
-    auto start = high_resolution_clock::now();
-    module.forward(inputs);
-    auto stop = high_resolution_clock::now();
-    auto duration = duration_cast<milliseconds>(stop - start);
-    times.push_back(duration.count());
+
+  std::vector<double> times;
+  for (const auto& t : thread_times) {
+    times.insert(times.end(), t.begin(), t.end());
   }
-  millis = timer.MilliSeconds();
   if (FLAGS_report_pep) {
     for (auto t : times) {
       std::cout << "PyTorchObserver {\"type\": \"NET\", \"unit\": \"us\", \"metric\": \"latency\", \"value\": \"" << t << "\"}" << std::endl;
     }
   }
+  std::sort(times.begin(), times.end());
+  results.iters = times.size();
+  for (double t : times) {
+    results.mean_us += t / times.size();
+  }
+  results.p50_us = percentile(times, 0.5);
+  results.p90_us = percentile(times, 0.9);
+  results.p99_us = percentile(times, 0.99);
+  results.max_us = times.empty() ? 0 : times.back();
+  results.inferences_per_s = millis > 0 ? 1000.0 * times.size() / millis : 0;
+  if (!times.empty()) {
+    size_t steady = results.warmup_us.size();
+    while (steady > 0 &&
+           std::abs(results.warmup_us[steady - 1] - results.p50_us) <=
+               FLAGS_steady_tolerance * results.p50_us) {
+      --steady;
+    }
+    if (steady < results.warmup_us.size()) {
+      results.steady_state_iter = steady;
+    }
+  }
+
+  // The memory reporter and the profiler slow down the runs, which are
+  // repeated with them once timed
+  c10::SetMemoryReporter(&reportMemoryUsage);
+  module.forward(inputs);
+  c10::SetMemoryReporter(nullptr);
+  results.peak_allocated_bytes = peak_allocated_bytes.load();
+  results.peak_rss_kb = peakRssKb();
+
+  if (FLAGS_per_op_iter > 0) {
+    using namespace torch::autograd::profiler;
+    enableProfiler(ProfilerConfig(ProfilerState::CPU, false));
+    for (int i = 0; i < FLAGS_per_op_iter; ++i) {
+      module.forward(inputs);
+    }
+    results.ops = aggregateOps(disableProfiler(), FLAGS_per_op_iter);
+  }
+
   std::cout << "Main run finished. Milliseconds per iter: "
             << millis / FLAGS_iter
             << ". Iters per second: " << 1000.0 * FLAGS_iter / millis
             << std::endl;
+  std::cout << std::fixed << std::setprecision(3)
+            << "Load: " << results.load_ms << " ms, first inference: "
+            << results.first_inference_us
+            << " us, steady state from warmup iter "
+            << results.steady_state_iter << std::endl
+            << "Latency over " << FLAGS_threads << " threads: p50 "
+            << results.p50_us << " us, p90 " << results.p90_us << " us, p99 "
+            << results.p99_us << " us, max " << results.max_us << " us, "
+            << results.inferences_per_s << " inferences/s" << std::endl
+            << "Peak allocated: " << results.peak_allocated_bytes
+            << " bytes, peak RSS: " << results.peak_rss_kb << " KB"
+            << std::endl;
+  const size_t kTopOps = 20;
+  for (size_t i = 0; i < std::min(kTopOps, results.ops.size()); ++i) {
+    const OpStats& op = results.ops[i];
+    std::cout << "  " << std::left << std::setw(40) << op.name << std::right
+              << " self " << std::setw(12) << op.self_us << " us, total "
+              << std::setw(12) << op.total_us << " us, " << op.calls
+              << " calls per inference" << std::endl;
+  }
 
+  if (!FLAGS_json_output.empty()) {
+    std::ofstream json_output(FLAGS_json_output);
+    json_output << toJson(results);
+  }
+  if (!FLAGS_baseline.empty() && !checkBaseline(results)) {
+    return 2;
+  }
   return 0;
 }
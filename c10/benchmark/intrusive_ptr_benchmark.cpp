@@ -40,6 +40,20 @@ static void BM_SharedPtrCtorDtor(benchmark::State& state) {
 }
 BENCHMARK(BM_SharedPtrCtorDtor);
 
+static void BM_IntrusivePtrMakeDestroy(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    volatile intrusive_ptr<Foo> var = make_intrusive<Foo>(0);
+  }
+}
+BENCHMARK(BM_IntrusivePtrMakeDestroy);
+
+static void BM_SharedPtrMakeDestroy(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    volatile std::shared_ptr<Bar> var = std::make_shared<Bar>(0);
+  }
+}
+BENCHMARK(BM_SharedPtrMakeDestroy);
+
 static void BM_IntrusivePtrArray(benchmark::State& state) {
   intrusive_ptr<Foo> var = make_intrusive<Foo>(0);
   const size_t kLength = state.range(0);
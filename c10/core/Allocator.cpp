@@ -1,5 +1,7 @@
 #include <c10/core/Allocator.h>
 
+#include <atomic>
+
 namespace c10 {
 
 static void deleteInefficientStdFunctionContext(void* ptr) {
@@ -28,4 +30,25 @@ at::Allocator* GetAllocator(const at::DeviceType& t) {
   return alloc;
 }
 
+static std::atomic<MemoryReporterFn> memory_reporter{nullptr};
+
+void SetMemoryReporter(MemoryReporterFn reporter) {
+  memory_reporter.store(reporter);
+}
+
+bool memoryProfilingEnabled() {
+  return memory_reporter.load(std::memory_order_relaxed) != nullptr;
+}
+
+void reportMemoryUsageToProfiler(
+    void* ptr,
+    int64_t alloc_size,
+    Device device) {
+  // The reporter may have been unset since the caller checked
+  auto* reporter = memory_reporter.load();
+  if (reporter) {
+    reporter(ptr, alloc_size, device);
+  }
+}
+
 } // namespace c10
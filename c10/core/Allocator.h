@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <cstdint>
 #include <memory>
 
 #include <c10/core/Device.h>
@@ -214,4 +215,19 @@ struct AllocatorRegisterer {
   static AllocatorRegisterer<t> g_allocator_d(f); \
   }
 
+// Receives the allocations and frees of the allocators that report them, i.e.
+// the default CPU allocator and the CUDA caching allocator, while memory is
+// being profiled. alloc_size is the size of the allocation at ptr, and is
+// negative when ptr is freed.
+using MemoryReporterFn = void (*)(void* ptr, int64_t alloc_size, Device device);
+
+// Sets the function the allocators report to, e.g. when the autograd profiler
+// is enabled with profile_memory, or unsets it with nullptr.
+C10_API void SetMemoryReporter(MemoryReporterFn reporter);
+C10_API bool memoryProfilingEnabled();
+C10_API void reportMemoryUsageToProfiler(
+    void* ptr,
+    int64_t alloc_size,
+    Device device);
+
 } // namespace c10
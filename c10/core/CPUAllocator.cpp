@@ -71,8 +71,9 @@ void* alloc_cpu(size_t nbytes) {
       nbytes,
       " bytes. Buy new RAM!");
 
-  // move data to a thread's NUMA node
-  NUMAMove(data, nbytes, GetCurrentNUMANode());
+  // move data to the NUMA node of the enclosing NUMAScope, or to the
+  // thread's NUMA node
+  NUMAMove(data, nbytes, GetAllocationNUMANode());
   CHECK(
       !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
       !FLAGS_caffe2_cpu_allocator_do_junk_fill)
@@ -108,13 +109,70 @@ class C10_API MemoryAllocationReporter {
   size_t allocated_;
 };
 
+// Remembers the sizes of the allocations reported to the memory profiler, so
+// that their frees are reported with the same sizes
+class C10_API ProfiledCPUMemoryReporter {
+ public:
+  ProfiledCPUMemoryReporter() {}
+  void New(void* ptr, size_t nbytes);
+  void Delete(void* ptr);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<void*, size_t> size_table_;
+};
+
+namespace {
+
+// In the CAFFE2_FB_LIMITED_MOBILE_CAPABILITY build setting, thread_local is
+// not supported, and allocations aren't counted.
+#ifndef CAFFE2_FB_LIMITED_MOBILE_CAPABILITY
+thread_local CPUAllocationCounter* current_allocation_counter = nullptr;
+#else
+CPUAllocationCounter* const current_allocation_counter = nullptr;
+#endif
+
+} // namespace
+
+void CountCPUAllocation(size_t nbytes) {
+  if (C10_UNLIKELY(current_allocation_counter != nullptr)) {
+    current_allocation_counter->allocations_++;
+    current_allocation_counter->bytes_ += nbytes;
+  }
+}
+
+CPUAllocationCounter::CPUAllocationCounter()
+    : prev_(current_allocation_counter) {
+#ifndef CAFFE2_FB_LIMITED_MOBILE_CAPABILITY
+  current_allocation_counter = this;
+#endif
+}
+
+CPUAllocationCounter::~CPUAllocationCounter() {
+#ifndef CAFFE2_FB_LIMITED_MOBILE_CAPABILITY
+  current_allocation_counter = prev_;
+#endif
+  if (prev_) {
+    prev_->allocations_ += allocations_;
+    prev_->bytes_ += bytes_;
+  }
+}
+
 struct C10_API DefaultCPUAllocator final : at::Allocator {
   DefaultCPUAllocator() {}
   ~DefaultCPUAllocator() override {}
   at::DataPtr allocate(size_t nbytes) const override {
     void* data = alloc_cpu(nbytes);
-    if (FLAGS_caffe2_report_cpu_memory_usage && nbytes > 0) {
-      getMemoryAllocationReporter().New(data, nbytes);
+    CountCPUAllocation(nbytes);
+    bool profile_memory = memoryProfilingEnabled();
+    if ((FLAGS_caffe2_report_cpu_memory_usage || profile_memory) &&
+        nbytes > 0) {
+      if (FLAGS_caffe2_report_cpu_memory_usage) {
+        getMemoryAllocationReporter().New(data, nbytes);
+      }
+      if (profile_memory) {
+        getProfiledMemoryReporter().New(data, nbytes);
+      }
       return {data, data, &ReportAndDelete, at::Device(at::DeviceType::CPU)};
     }
     return {data, data, &free_cpu, at::Device(at::DeviceType::CPU)};
@@ -124,7 +182,10 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
     if (!ptr) {
       return;
     }
-    getMemoryAllocationReporter().Delete(ptr);
+    if (FLAGS_caffe2_report_cpu_memory_usage) {
+      getMemoryAllocationReporter().Delete(ptr);
+    }
+    getProfiledMemoryReporter().Delete(ptr);
     free_cpu(ptr);
   }
 
@@ -141,6 +202,11 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
     return reporter_;
   }
 
+  static ProfiledCPUMemoryReporter& getProfiledMemoryReporter() {
+    static ProfiledCPUMemoryReporter reporter_;
+    return reporter_;
+  }
+
 };
 
 void NoDelete(void*) {}
@@ -180,4 +246,31 @@ void MemoryAllocationReporter::Delete(void* ptr) {
   size_table_.erase(it);
 }
 
+void ProfiledCPUMemoryReporter::New(void* ptr, size_t nbytes) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_table_[ptr] = nbytes;
+  }
+  reportMemoryUsageToProfiler(
+      ptr, static_cast<int64_t>(nbytes), at::Device(at::DeviceType::CPU));
+}
+
+void ProfiledCPUMemoryReporter::Delete(void* ptr) {
+  size_t nbytes = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = size_table_.find(ptr);
+    // Allocated before the memory profiler was enabled
+    if (it == size_table_.end()) {
+      return;
+    }
+    nbytes = it->second;
+    size_table_.erase(it);
+  }
+  if (memoryProfilingEnabled()) {
+    reportMemoryUsageToProfiler(
+        ptr, -static_cast<int64_t>(nbytes), at::Device(at::DeviceType::CPU));
+  }
+}
+
 } // namespace c10
@@ -39,4 +39,29 @@ C10_API void SetCPUAllocator(at::Allocator* alloc);
 // Get the Default CPU Allocator
 C10_API at::Allocator* GetDefaultCPUAllocator();
 
+// Counts the allocations of the default CPU allocator on the current thread
+// while it is alive, e.g. for the lite interpreter profiler. Counters nest:
+// the allocations seen by an inner counter are added to the outer one when
+// the inner one is destroyed.
+class C10_API CPUAllocationCounter {
+ public:
+  CPUAllocationCounter();
+  ~CPUAllocationCounter();
+  C10_DISABLE_COPY_AND_ASSIGN(CPUAllocationCounter);
+
+  int64_t allocations() const {
+    return allocations_;
+  }
+  int64_t bytes() const {
+    return bytes_;
+  }
+
+ private:
+  friend void CountCPUAllocation(size_t nbytes);
+
+  CPUAllocationCounter* prev_;
+  int64_t allocations_ = 0;
+  int64_t bytes_ = 0;
+};
+
 } // namespace c10
@@ -0,0 +1,379 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/DeviceType.h>
+#include <c10/util/llvmMathExtras.h>
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+//
+// Yet another caching allocator, this time for CPU memory.
+//
+// - Every block is laid out as a kHeaderSize header followed by the user
+//   data. The header records the size class of the block, so the deleter only
+//   needs the data pointer; this keeps the context of the DataPtr equal to its
+//   data and lets raw_allocate()/raw_deallocate() work as they do with the
+//   default CPU allocator.
+// - Requested sizes (including the header) are rounded up to one of
+//   kClassesPerDoubling equally spaced size classes per power of two, which
+//   bounds the rounding waste to 25% while keeping the number of free lists
+//   small.
+// - Freed blocks go to the freeing thread's cache until it holds
+//   kThreadCacheMaxBytes, and to the shared pool after that. Threads that
+//   exit hand their cached blocks over to the shared pool.
+// - Blocks larger than kMaxCachedSize are never cached.
+// - emptyCache() bumps a global epoch. Each thread cache compares the epoch
+//   on its next use and, if it changed, releases its blocks to the system.
+//   This lets emptyCache() drain other threads' caches without having to
+//   lock them on the fast path.
+//
+
+namespace {
+
+constexpr size_t kHeaderSize = gAlignment;
+constexpr size_t kMinBlockSizeLog2 = 6; // 64 bytes
+constexpr size_t kMinBlockSize = size_t(1) << kMinBlockSizeLog2;
+constexpr size_t kClassesPerDoublingLog2 = 2;
+constexpr size_t kClassesPerDoubling = size_t(1) << kClassesPerDoublingLog2;
+constexpr size_t kMaxCachedSizeLog2 = 30; // 1 GiB
+constexpr size_t kMaxCachedSize = size_t(1) << kMaxCachedSizeLog2;
+constexpr size_t kNumSizeClasses =
+    kClassesPerDoubling * (kMaxCachedSizeLog2 - kMinBlockSizeLog2 - 1);
+constexpr size_t kThreadCacheMaxBytes = 16 * 1024 * 1024; // 16 MiB
+
+static_assert(
+    kMinBlockSize == gAlignment,
+    "smallest size class must preserve the allocation alignment");
+
+struct Block {
+  size_t size; // block size including the header
+  size_t size_class; // kNumSizeClasses if the block is not cached
+  int numa_node; // NUMA node the block was last moved to, -1 if none
+};
+
+static_assert(sizeof(Block) <= kHeaderSize, "Block does not fit the header");
+
+inline Block* header_of(void* data) {
+  return reinterpret_cast<Block*>(static_cast<char*>(data) - kHeaderSize);
+}
+
+inline void* data_of(Block* block) {
+  return reinterpret_cast<char*>(block) + kHeaderSize;
+}
+
+// Rounds `size` up to its size class. Only valid for
+// 0 < size <= kMaxCachedSize.
+size_t size_class(size_t size, size_t* rounded) {
+  if (size <= kMinBlockSize * kClassesPerDoubling) {
+    size_t blocks = (size + kMinBlockSize - 1) / kMinBlockSize;
+    *rounded = blocks * kMinBlockSize;
+    return blocks - 1;
+  }
+  size_t log2 = llvm::Log2_64(size - 1);
+  size_t step = size_t(1) << (log2 - kClassesPerDoublingLog2);
+  *rounded = (size + step - 1) & ~(step - 1);
+  return kClassesPerDoubling * (log2 - kMinBlockSizeLog2 - 1) +
+      *rounded / step - kClassesPerDoubling - 1;
+}
+
+struct AtomicStat {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<int64_t> allocated{0};
+  std::atomic<int64_t> freed{0};
+
+  void increase(int64_t amount) {
+    int64_t now =
+        current.fetch_add(amount, std::memory_order_relaxed) + amount;
+    allocated.fetch_add(amount, std::memory_order_relaxed);
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while (now > prev &&
+           !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {
+    }
+  }
+
+  void decrease(int64_t amount) {
+    current.fetch_sub(amount, std::memory_order_relaxed);
+    freed.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  Stat load() const {
+    Stat stat;
+    stat.current = current.load(std::memory_order_relaxed);
+    stat.peak = peak.load(std::memory_order_relaxed);
+    stat.allocated = allocated.load(std::memory_order_relaxed);
+    stat.freed = freed.load(std::memory_order_relaxed);
+    return stat;
+  }
+
+  void reset_accumulated() {
+    allocated.store(0, std::memory_order_relaxed);
+    freed.store(0, std::memory_order_relaxed);
+  }
+
+  void reset_peak() {
+    peak.store(current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+};
+
+struct AtomicStats {
+  AtomicStat allocation;
+  AtomicStat allocated_bytes;
+  AtomicStat reserved_bytes;
+  std::atomic<int64_t> num_cache_hits{0};
+  std::atomic<int64_t> num_cache_misses{0};
+};
+
+AtomicStats& stats() {
+  // Leaked so that tensors destroyed during static destruction can still be
+  // accounted for.
+  static AtomicStats* stats_ = new AtomicStats();
+  return *stats_;
+}
+
+std::atomic<uint64_t> empty_cache_epoch{0};
+
+using FreeLists = std::array<std::vector<Block*>, kNumSizeClasses>;
+
+void release_block(Block* block) {
+  stats().reserved_bytes.decrease(block->size);
+  free_cpu(block);
+}
+
+void release_free_lists(FreeLists& free_lists) {
+  for (auto& blocks : free_lists) {
+    for (Block* block : blocks) {
+      release_block(block);
+    }
+    blocks.clear();
+  }
+}
+
+struct SharedPool {
+  std::mutex mutex;
+  FreeLists free_lists;
+
+  Block* pop(size_t cls) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& blocks = free_lists[cls];
+    if (blocks.empty()) {
+      return nullptr;
+    }
+    Block* block = blocks.back();
+    blocks.pop_back();
+    return block;
+  }
+
+  void push(Block* block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_lists[block->size_class].push_back(block);
+  }
+
+  void release_all() {
+    std::lock_guard<std::mutex> lock(mutex);
+    release_free_lists(free_lists);
+  }
+};
+
+SharedPool& shared_pool() {
+  // Leaked for the same reason as stats().
+  static SharedPool* pool = new SharedPool();
+  return *pool;
+}
+
+// Trivially destructible, so it stays readable while (and after) the thread
+// cache of an exiting thread is destroyed.
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache {
+  FreeLists free_lists;
+  size_t cached_bytes = 0;
+  uint64_t epoch = empty_cache_epoch.load(std::memory_order_relaxed);
+
+  ~ThreadCache() {
+    thread_cache_destroyed = true;
+    for (auto& blocks : free_lists) {
+      for (Block* block : blocks) {
+        shared_pool().push(block);
+      }
+    }
+  }
+
+  void sync_epoch() {
+    uint64_t current = empty_cache_epoch.load(std::memory_order_relaxed);
+    if (C10_UNLIKELY(current != epoch)) {
+      release_free_lists(free_lists);
+      cached_bytes = 0;
+      epoch = current;
+    }
+  }
+
+  Block* pop(size_t cls) {
+    sync_epoch();
+    auto& blocks = free_lists[cls];
+    if (blocks.empty()) {
+      return nullptr;
+    }
+    Block* block = blocks.back();
+    blocks.pop_back();
+    cached_bytes -= block->size;
+    return block;
+  }
+
+  bool push(Block* block) {
+    sync_epoch();
+    if (cached_bytes + block->size > kThreadCacheMaxBytes) {
+      return false;
+    }
+    free_lists[block->size_class].push_back(block);
+    cached_bytes += block->size;
+    return true;
+  }
+
+  void release_all() {
+    release_free_lists(free_lists);
+    cached_bytes = 0;
+  }
+};
+
+ThreadCache* thread_cache() {
+  if (C10_UNLIKELY(thread_cache_destroyed)) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void fill(void* data, size_t nbytes) {
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+void* malloc_block(size_t nbytes) {
+  size_t size = nbytes + kHeaderSize;
+  size_t cls = kNumSizeClasses;
+  if (size <= kMaxCachedSize) {
+    cls = size_class(size, &size);
+    ThreadCache* cache = thread_cache();
+    Block* block = cache ? cache->pop(cls) : nullptr;
+    if (!block) {
+      block = shared_pool().pop(cls);
+    }
+    if (block) {
+      stats().num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      stats().allocation.increase(1);
+      stats().allocated_bytes.increase(block->size);
+      void* data = data_of(block);
+      if (IsNUMAEnabled()) {
+        // Only move cached blocks that were placed for another node.
+        int numa_node = GetAllocationNUMANode();
+        if (numa_node != block->numa_node) {
+          NUMAMove(block, block->size, numa_node);
+          block->numa_node = numa_node;
+        }
+      }
+      fill(data, nbytes);
+      return data;
+    }
+  }
+
+  // alloc_cpu() takes care of zero/junk filling fresh memory and of moving it
+  // to the allocation NUMA node.
+  Block* block = static_cast<Block*>(alloc_cpu(size));
+  block->size = size;
+  block->size_class = cls;
+  block->numa_node = GetAllocationNUMANode();
+  stats().num_cache_misses.fetch_add(1, std::memory_order_relaxed);
+  stats().reserved_bytes.increase(size);
+  stats().allocation.increase(1);
+  stats().allocated_bytes.increase(size);
+  return data_of(block);
+}
+
+void free_block(void* data) {
+  if (!data) {
+    return;
+  }
+  Block* block = header_of(data);
+  stats().allocation.decrease(1);
+  stats().allocated_bytes.decrease(block->size);
+  if (block->size_class == kNumSizeClasses) {
+    release_block(block);
+    return;
+  }
+  ThreadCache* cache = thread_cache();
+  if (cache && cache->push(block)) {
+    return;
+  }
+  shared_pool().push(block);
+}
+
+struct CPUCachingAllocator final : public at::Allocator {
+  at::DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &free_block, at::Device(at::DeviceType::CPU)};
+    }
+    void* data = malloc_block(nbytes);
+    return {data, data, &free_block, at::Device(at::DeviceType::CPU)};
+  }
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &free_block;
+  }
+};
+
+CPUCachingAllocator caching_allocator;
+
+} // namespace
+
+at::Allocator* get() {
+  return &caching_allocator;
+}
+
+void emptyCache() {
+  empty_cache_epoch.fetch_add(1, std::memory_order_relaxed);
+  ThreadCache* cache = thread_cache();
+  if (cache) {
+    cache->release_all();
+    cache->epoch = empty_cache_epoch.load(std::memory_order_relaxed);
+  }
+  shared_pool().release_all();
+}
+
+AllocatorStats getStats() {
+  AllocatorStats result;
+  result.allocation = stats().allocation.load();
+  result.allocated_bytes = stats().allocated_bytes.load();
+  result.reserved_bytes = stats().reserved_bytes.load();
+  result.num_cache_hits = stats().num_cache_hits.load(std::memory_order_relaxed);
+  result.num_cache_misses =
+      stats().num_cache_misses.load(std::memory_order_relaxed);
+  return result;
+}
+
+void resetAccumulatedStats() {
+  stats().allocation.reset_accumulated();
+  stats().allocated_bytes.reset_accumulated();
+  stats().reserved_bytes.reset_accumulated();
+  stats().num_cache_hits.store(0, std::memory_order_relaxed);
+  stats().num_cache_misses.store(0, std::memory_order_relaxed);
+}
+
+void resetPeakStats() {
+  stats().allocation.reset_peak();
+  stats().allocated_bytes.reset_peak();
+  stats().reserved_bytes.reset_peak();
+}
+
+} // namespace CPUCachingAllocator
+} // namespace c10
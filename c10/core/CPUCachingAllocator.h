@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+// Caching allocator for CPU memory.
+//
+// Memory returned by alloc_cpu() is rounded up to a size class and, when
+// freed, is kept in a cache instead of being returned to the system, so that
+// repeated allocations of the same shape never reach malloc. The cache has
+// two levels:
+//
+//  - each thread owns a small set of per-size-class free lists that are
+//    accessed without any locking;
+//  - once a thread's cache holds more than a fixed number of bytes, further
+//    freed blocks overflow into a pool shared by all threads, protected by a
+//    mutex.
+//
+// Allocations are served from the calling thread's cache first, then from the
+// shared pool, and only fall back to alloc_cpu() when both are empty.
+// Requests larger than the largest size class bypass the cache entirely.
+//
+// The allocator is opt-in; install it with
+//
+//   c10::SetCPUAllocator(c10::CPUCachingAllocator::get());
+//
+// before any tensors are allocated.
+namespace CPUCachingAllocator {
+
+struct Stat {
+  int64_t current = 0;
+  int64_t peak = 0;
+  int64_t allocated = 0;
+  int64_t freed = 0;
+};
+
+// Struct containing memory allocator summary statistics.
+struct AllocatorStats {
+  // COUNT: allocations requested by client code
+  Stat allocation;
+  // SUM: bytes handed out to client code, rounded up to the size class
+  Stat allocated_bytes;
+  // SUM: bytes obtained from alloc_cpu(), both cached and in use
+  Stat reserved_bytes;
+
+  // COUNT: allocations served from a thread cache or the shared pool
+  int64_t num_cache_hits = 0;
+  // COUNT: allocations that had to call alloc_cpu()
+  int64_t num_cache_misses = 0;
+};
+
+C10_API at::Allocator* get();
+
+// Releases all cached blocks held in the shared pool and in the calling
+// thread's cache back to the system. Blocks cached by other threads are
+// released the next time those threads allocate or free memory through this
+// allocator.
+C10_API void emptyCache();
+
+C10_API AllocatorStats getStats();
+C10_API void resetAccumulatedStats();
+C10_API void resetPeakStats();
+
+} // namespace CPUCachingAllocator
+} // namespace c10
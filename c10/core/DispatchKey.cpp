@@ -42,6 +42,8 @@ const char* toString(DispatchKey t) {
       return "VariableTensorId";
     case DispatchKey::BackendSelect:
       return "BackendSelect";
+    case DispatchKey::AutocastTensorId:
+      return "AutocastTensorId";
     case DispatchKey::TESTING_ONLY_GenericModeTensorId:
       return "TESTING_ONLY_GenericModeTensorId";
     case DispatchKey::TESTING_ONLY_GenericWrapperTensorId:
@@ -139,6 +139,13 @@ enum class DispatchKey : uint8_t {
   // autograd; for example, error checking, tracing, profiling or vmap.  They
   // go here.
 
+  // Autocasting precedes autograd, so that the casts it inserts are
+  // recorded by autograd like any other op.  It is only considered when it
+  // is in the thread-local included set, i.e. inside an autocast-enabled
+  // region (see aten/src/ATen/autocast_mode.cpp).  Operators without an
+  // autocast kernel fall through to the next key.
+  AutocastTensorId,
+
   // TESTING: This is intended to be a generic testing tensor type id.
   // Don't use it for anything real; its only acceptable use is within a single
   // process test.  Use it by creating a TensorImpl with this DispatchKey, and
@@ -129,6 +129,147 @@ void ThreadPool::main_loop(std::size_t index) {
   } // while running_
 }
 
+namespace {
+
+// The pool and the queue index of the current thread, if it is a pool thread
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    int numa_node_id,
+    std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      pending_(0),
+      available_(threads_.size()),
+      next_queue_(0),
+      running_(true),
+      sleeping_(0) {
+  // NUMA binding is left to init_thread, as in ThreadPool
+  (void)numa_node_id;
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread](){
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+    sleep_condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return available_;
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_pool == this;
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  if (current_pool == this) {
+    // Local-first: the task runs next on this thread, unless stolen
+    auto& queue = *queues_[current_queue];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.tasks.push_front(func);
+  } else {
+    auto& queue = *queues_[next_queue_++ % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.tasks.push_back(func);
+  }
+  // A thread going to sleep counts itself in sleeping_ before it checks
+  // pending_ a last time, so either it sees the task or it is notified. The
+  // mutex is only taken when some thread sleeps.
+  ++pending_;
+  if (sleeping_ > 0) {
+    std::lock_guard<std::mutex> guard(sleep_mutex_);
+    sleep_condition_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::pop(
+    std::size_t index,
+    std::function<void()>& task) {
+  auto& queue = *queues_[index];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.front());
+  queue.tasks.pop_front();
+  return true;
+}
+
+bool WorkStealingThreadPool::steal(
+    std::size_t index,
+    std::function<void()>& task) {
+  for (std::size_t i = 1; i < queues_.size(); ++i) {
+    auto& queue = *queues_[(index + i) % queues_.size()];
+    std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || queue.tasks.empty()) {
+      continue;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_pool = this;
+  current_queue = index;
+  while (running_) {
+    std::function<void()> task;
+    if (!pop(index, task) && !steal(index, task)) {
+      if (pending_ > 0) {
+        // A task is queued but its queue was busy while stealing, retry
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      ++sleeping_;
+      sleep_condition_.wait(lock, [this] { return pending_ > 0 || !running_; });
+      --sleeping_;
+      continue;
+    }
+    --pending_;
+    --available_;
+    try {
+      task();
+    } catch (const std::exception&) {
+    }
+    ++available_;
+  }
+  current_pool = nullptr;
+}
+
 C10_DEFINE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
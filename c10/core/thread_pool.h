@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <c10/util/Optional.h>
 #include <c10/util/intrusive_ptr.h>
@@ -115,6 +119,71 @@ class C10_API TaskThreadPool : public c10::ThreadPool {
       }) {}
 };
 
+/**
+ * A thread pool with one task queue per thread, for many small tasks.
+ *
+ * Unlike ThreadPool, where all threads share one queue and one mutex, tasks
+ * are spread over per-thread deques. A task scheduled from a pool thread goes
+ * to the front of that thread's own deque, and runs next on the same thread,
+ * which keeps the tasks a task makes ready close to the data it produced.
+ * Tasks scheduled from other threads are distributed round-robin. A thread
+ * whose deque is empty steals from the back of the others' before it goes to
+ * sleep.
+ */
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(const std::function<void()>& func) override;
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // @brief Entry point for pool threads.
+  void main_loop(std::size_t index);
+
+  bool pop(std::size_t index, std::function<void()>& task);
+  bool steal(std::size_t index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+  // Number of queued tasks, sleeping threads wait for it to be positive
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> available_;
+  std::atomic<std::size_t> next_queue_;
+  std::atomic_bool running_;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::atomic<std::size_t> sleeping_;
+};
+
+class C10_API WorkStealingTaskThreadPool : public c10::WorkStealingThreadPool {
+ public:
+  explicit WorkStealingTaskThreadPool(
+      std::size_t pool_size,
+      int numa_node_id = -1)
+      : WorkStealingThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        setThreadName("CaffeTaskThread");
+        NUMABind(numa_node_id);
+      }) {}
+};
+
 C10_DECLARE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
@@ -8,6 +8,8 @@
 #include <cuda_runtime_api.h>
 #include <algorithm>
 #include <bitset>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <iterator>
 #include <map>
@@ -18,6 +20,13 @@
 #include <unordered_set>
 #include <vector>
 
+#if defined(CUDART_VERSION) && CUDART_VERSION >= 10020 && \
+    !defined(_WIN32) && !defined(__HIP_PLATFORM_HCC__)
+#include <cuda.h>
+#include <dlfcn.h>
+#define C10_CUDA_EXPANDABLE_SEGMENTS
+#endif
+
 namespace c10 {
 
 C10_DEFINE_REGISTRY(FreeCudaMemoryCallbacksRegistry, FreeMemoryCallback);
@@ -51,6 +60,41 @@ namespace CUDACachingAllocator {
 // ensure that the block is not reused before each recorded stream completes
 // work.
 //
+// Expandable segments (PYTORCH_CUDA_ALLOC_CONF=expandable_segments:True):
+// - Instead of creating a new cudaMalloc segment whenever no cached large
+//   block fits, the allocator reserves a range of virtual addresses per
+//   (device, stream) and maps physical memory at the end of that range as
+//   needed (CUDA >= 10.2 virtual memory management API). All large blocks of
+//   a stream thus live in a single segment and freed neighbours always
+//   coalesce, so differently sized requests stop fragmenting the cache into
+//   segments that are too small to be reused.
+// - When the cache is flushed (emptyCache(), or before retrying a failed
+//   allocation), the free memory at the end of each expandable segment is
+//   unmapped and returned to the driver.
+// - Memory from expandable segments cannot be shared with other processes
+//   through CUDA IPC.
+// - Expandable segments are only used for the default pool.
+//
+// Private pools:
+// - createPool() creates a pool with its own set of cached blocks. While a
+//   MemPoolGuard for the pool is alive, all allocations made by the thread go
+//   to that pool, and blocks freed into it are only reused for allocations
+//   routed to the same pool. Workloads using separate pools therefore never
+//   take over (or fragment) each other's cached memory.
+// - If a cudaMalloc fails, the cached blocks of the pool that is allocating
+//   are freed first; only if that is not enough are all other pools flushed.
+// - releasePool() returns the cached memory of a pool to the system at once.
+//   Blocks of the pool that are still in use are returned as they get freed.
+//
+// CUDA graph capture (see at::cuda::CUDAGraph):
+// - The graph allocates from a private pool, whose blocks stay reserved for
+//   replays until the graph releases the pool.
+// - Between notifyCaptureBegin() and notifyCaptureEnd(), nothing that
+//   synchronizes with or queries the device is allowed: outstanding events are
+//   not processed, events for blocks used on other streams are only recorded
+//   once the capture ended, and a failed cudaMalloc is reported as out of
+//   memory instead of freeing cached blocks and retrying.
+//
 
 
 namespace {
@@ -66,6 +110,45 @@ constexpr size_t kRoundLarge = 2097152;     // round up large allocs to 2 MiB
 
 typedef std::bitset<static_cast<size_t>(StatType::NUM_TYPES)> StatTypes;
 
+// Allocator settings, read once from the PYTORCH_CUDA_ALLOC_CONF environment
+// variable, e.g. PYTORCH_CUDA_ALLOC_CONF=expandable_segments:True. Options are
+// separated by commas and given as name:value.
+struct AllocatorConfig {
+  bool expandable_segments = false;
+
+  AllocatorConfig() {
+    const char* env = std::getenv("PYTORCH_CUDA_ALLOC_CONF");
+    if (!env) {
+      return;
+    }
+    std::string config(env);
+    size_t begin = 0;
+    while (begin < config.size()) {
+      size_t end = config.find(',', begin);
+      if (end == std::string::npos) {
+        end = config.size();
+      }
+      std::string option = config.substr(begin, end - begin);
+      size_t colon = option.find(':');
+      TORCH_CHECK(
+          colon != std::string::npos,
+          "Invalid PYTORCH_CUDA_ALLOC_CONF option '", option,
+          "', expected name:value");
+      std::string name = option.substr(0, colon);
+      std::string value = option.substr(colon + 1);
+      if (name == "expandable_segments") {
+        TORCH_CHECK(
+            value == "True" || value == "False",
+            "Expected True or False for expandable_segments, got ", value);
+        expandable_segments = (value == "True");
+      } else {
+        TORCH_CHECK(false, "Unrecognized PYTORCH_CUDA_ALLOC_CONF option: ", name);
+      }
+      begin = end + 1;
+    }
+  }
+};
+
 void update_stat(Stat& stat, int64_t amount) {
   stat.current += amount;
 
@@ -98,8 +181,11 @@ void update_stat_array(StatArray& stat_array, int64_t amount, const StatTypes& s
 }
 
 struct Block;
+struct BlockPool;
+struct PrivatePool;
+struct ExpandableSegment;
 typedef bool (*Comparison)(const Block*, const Block*);
-typedef std::set<Block*, Comparison> BlockPool;
+typedef std::set<Block*, Comparison> BlockSet;
 
 struct Block {
   int           device;      // gpu
@@ -112,15 +198,18 @@ struct Block {
   Block*        prev;        // prev block if split from a larger allocation
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
+  ExpandableSegment* expandable_segment; // owning segment if expandable
 
   Block(int device, cudaStream_t stream, size_t size, BlockPool* pool, void* ptr) :
     device(device), stream(stream), stream_uses(), size(size), pool(pool),
-    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    expandable_segment(nullptr) { }
 
   // constructor for search key
   Block(int device, cudaStream_t stream, size_t size) :
     device(device), stream(stream), stream_uses(), size(size), pool(nullptr),
-    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    expandable_segment(nullptr) { }
 
   bool is_split() const {
     return (prev != nullptr) || (next != nullptr);
@@ -141,6 +230,208 @@ static bool BlockComparator(const Block* a, const Block* b)
   return (uintptr_t)a->ptr < (uintptr_t)b->ptr;
 }
 
+struct BlockPool {
+  BlockPool(bool is_small, PrivatePool* private_pool = nullptr) :
+    blocks(BlockComparator), is_small(is_small), private_pool(private_pool) { }
+
+  BlockSet      blocks;       // unallocated cached blocks
+  const bool    is_small;     // pool of blocks 1 MB or smaller
+  PrivatePool*  private_pool; // owning private pool, nullptr for the default pool
+};
+
+struct PrivatePool {
+  PrivatePool(MemPoolId id, std::string name) :
+    id(id), name(std::move(name)), large_blocks(false, this),
+    small_blocks(true, this), use_count(0), released(false) { }
+
+  const MemPoolId   id;
+  const std::string name;
+  BlockPool         large_blocks;
+  BlockPool         small_blocks;
+  int               use_count; // blocks allocated or pending events
+  bool              released;  // releasePool() was called
+};
+
+// Pool that allocations of the current thread are routed to (see MemPoolGuard)
+thread_local MemPoolId current_pool_id = 0;
+
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS
+
+// The virtual memory management functions live in the CUDA driver API, which
+// c10_cuda does not link against; look them up in the already loaded driver
+// instead.
+struct DriverAPI {
+#define C10_CUDA_DRIVER_FUNCTIONS(_) \
+  _(cuGetErrorString)                \
+  _(cuMemAddressReserve)             \
+  _(cuMemAddressFree)                \
+  _(cuMemCreate)                     \
+  _(cuMemRelease)                    \
+  _(cuMemMap)                        \
+  _(cuMemUnmap)                      \
+  _(cuMemSetAccess)                  \
+  _(cuMemGetAllocationGranularity)
+
+#define DECLARE_MEMBER(name) decltype(&name) name##_;
+  C10_CUDA_DRIVER_FUNCTIONS(DECLARE_MEMBER)
+#undef DECLARE_MEMBER
+
+  DriverAPI() {
+    void* handle = dlopen("libcuda.so.1", RTLD_LAZY | RTLD_LOCAL);
+    TORCH_CHECK(handle, "expandable_segments: unable to load libcuda.so.1: ", dlerror());
+#define LOOKUP_MEMBER(name)                                     \
+    name##_ = reinterpret_cast<decltype(&name)>(dlsym(handle, #name)); \
+    TORCH_CHECK(name##_, "expandable_segments: unable to find " #name \
+        " in the CUDA driver; a driver supporting CUDA 10.2 is required");
+    C10_CUDA_DRIVER_FUNCTIONS(LOOKUP_MEMBER)
+#undef LOOKUP_MEMBER
+  }
+
+  static DriverAPI& get() {
+    static DriverAPI driver;
+    return driver;
+  }
+#undef C10_CUDA_DRIVER_FUNCTIONS
+};
+
+#define C10_CUDA_DRIVER_CHECK(EXPR)                         \
+  do {                                                      \
+    CUresult __err = EXPR;                                  \
+    if (__err != CUDA_SUCCESS) {                            \
+      const char* __msg = nullptr;                          \
+      DriverAPI::get().cuGetErrorString_(__err, &__msg);    \
+      AT_ERROR("CUDA driver error: ", __msg ? __msg : "unknown error"); \
+    }                                                       \
+  } while (0)
+
+// A range of virtual addresses reserved for the large blocks of one stream.
+// Physical memory is mapped at the end of the range in chunks of
+// `granularity` bytes, each with its own handle so that the end can be
+// unmapped again chunk by chunk.
+struct ExpandableSegment {
+  int device;
+  cudaStream_t stream;
+  CUdeviceptr base;
+  size_t reserved_size;
+  size_t granularity;
+  std::vector<CUmemGenericAllocationHandle> handles;
+  // Block ending at base + mapped_size(), or nullptr if nothing is mapped.
+  Block* tail;
+
+  ExpandableSegment(int device, cudaStream_t stream)
+      : device(device), stream(stream), base(0), granularity(0), tail(nullptr) {
+    auto& driver = DriverAPI::get();
+    // Make sure the primary context of the device is initialized.
+    C10_CUDA_CHECK(cudaFree(nullptr));
+    CUmemAllocationProp prop = allocation_prop();
+    C10_CUDA_DRIVER_CHECK(driver.cuMemGetAllocationGranularity_(
+        &granularity, &prop, CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+    // A segment can never need more than the whole device.
+    reserved_size = granularity * ((device_total + granularity - 1) / granularity);
+    C10_CUDA_DRIVER_CHECK(
+        driver.cuMemAddressReserve_(&base, reserved_size, 0, 0, 0));
+  }
+
+  ~ExpandableSegment() {
+    shrink(mapped_size());
+    DriverAPI::get().cuMemAddressFree_(base, reserved_size);
+  }
+
+  size_t mapped_size() const {
+    return handles.size() * granularity;
+  }
+
+  char* ptr() const {
+    return reinterpret_cast<char*>(base);
+  }
+
+  size_t round_size(size_t size) const {
+    return granularity * ((size + granularity - 1) / granularity);
+  }
+
+  // Maps `size` more bytes (a multiple of the granularity) at the end of the
+  // segment. Returns false, leaving the segment unchanged, if the device is
+  // out of memory.
+  bool grow(size_t size) {
+    auto& driver = DriverAPI::get();
+    if (mapped_size() + size > reserved_size) {
+      return false;
+    }
+    CUmemAllocationProp prop = allocation_prop();
+    const size_t old_size = mapped_size();
+    for (size_t offset = 0; offset < size; offset += granularity) {
+      CUmemGenericAllocationHandle handle;
+      CUresult err = driver.cuMemCreate_(&handle, granularity, &prop, 0);
+      if (err == CUDA_ERROR_OUT_OF_MEMORY) {
+        shrink(mapped_size() - old_size);
+        return false;
+      }
+      C10_CUDA_DRIVER_CHECK(err);
+      C10_CUDA_DRIVER_CHECK(
+          driver.cuMemMap_(base + mapped_size(), granularity, 0, handle, 0));
+      handles.push_back(handle);
+    }
+    CUmemAccessDesc desc;
+    desc.location = prop.location;
+    desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    C10_CUDA_DRIVER_CHECK(
+        driver.cuMemSetAccess_(base + old_size, size, &desc, 1));
+    return true;
+  }
+
+  // Unmaps the last `size` bytes (a multiple of the granularity).
+  void shrink(size_t size) {
+    auto& driver = DriverAPI::get();
+    if (size == 0) {
+      return;
+    }
+    // Blocks in the unmapped range may still be referenced by pending work.
+    cuda::CUDAGuard device_guard(device);
+    C10_CUDA_CHECK(cudaDeviceSynchronize());
+    for (size_t unmapped = 0; unmapped < size; unmapped += granularity) {
+      C10_CUDA_DRIVER_CHECK(driver.cuMemUnmap_(
+          base + mapped_size() - granularity, granularity));
+      C10_CUDA_DRIVER_CHECK(driver.cuMemRelease_(handles.back()));
+      handles.pop_back();
+    }
+  }
+
+ private:
+  CUmemAllocationProp allocation_prop() const {
+    CUmemAllocationProp prop;
+    memset(&prop, 0, sizeof(prop));
+    prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    prop.location.id = device;
+    return prop;
+  }
+};
+
+#else // C10_CUDA_EXPANDABLE_SEGMENTS
+
+struct ExpandableSegment {
+  int device;
+  cudaStream_t stream;
+  Block* tail;
+
+  ExpandableSegment(int device, cudaStream_t stream)
+      : device(device), stream(stream), tail(nullptr) {
+    TORCH_CHECK(false,
+        "expandable_segments requires PyTorch to be built with CUDA 10.2 or "
+        "newer on Linux");
+  }
+  size_t mapped_size() const { return 0; }
+  char* ptr() const { return nullptr; }
+  size_t round_size(size_t size) const { return size; }
+  bool grow(size_t size) { return false; }
+  void shrink(size_t size) {}
+};
+
+#endif // C10_CUDA_EXPANDABLE_SEGMENTS
+
 static std::string format_size(uint64_t size) {
   std::ostringstream os;
   os.precision(2);
@@ -181,17 +472,35 @@ class THCCachingAllocator {
   // unallocated cached blocks 1 MB or smaller
   BlockPool small_blocks;
 
+  // private pools created with createPool()
+  std::unordered_map<MemPoolId, std::unique_ptr<PrivatePool>> private_pools;
+
+  MemPoolId next_pool_id = 1;
+
   // allocated blocks by device pointer
   std::unordered_map<void*, Block*> allocated_blocks;
 
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
 
+  // number of CUDA graph captures in progress
+  int captures_underway = 0;
+
+  // blocks freed during a capture whose stream uses still need events
+  std::vector<Block*> needs_events_deferred_until_no_capture;
+
+  // settings from PYTORCH_CUDA_ALLOC_CONF
+  AllocatorConfig config;
+
+  // expandable segments, at most one per (device, stream); intentionally
+  // leaked at exit like the rest of the cache
+  std::vector<ExpandableSegment*> expandable_segments;
+
  public:
 
   THCCachingAllocator() :
-      large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      large_blocks(false),
+      small_blocks(true) {}
 
   std::mutex* getCudaFreeMutex() const {
     return &cuda_free_mutex;
@@ -208,13 +517,16 @@ class THCCachingAllocator {
     int device;
     C10_CUDA_CHECK(cudaGetDevice(&device));
 
-    // process outstanding cudaEvents
-    process_events();
+    // process outstanding cudaEvents; querying events is not allowed while a
+    // graph is being captured
+    if (captures_underway == 0) {
+      process_events();
+    }
 
     size = round_size(size);
 
     Block search_key(device, stream, size);
-    auto& pool = get_pool(size);
+    auto& pool = get_pool(size, current_pool_id);
 
     DeviceStats& stats = get_stats_for_device(device);
     StatTypes stat_types;
@@ -222,18 +534,19 @@ class THCCachingAllocator {
     stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
 
     auto find_free_block = [&]()->Block*{
-      auto it = pool.lower_bound(&search_key);
-      if (it != pool.end() && (*it)->device == device &&
+      auto it = pool.blocks.lower_bound(&search_key);
+      if (it != pool.blocks.end() && (*it)->device == device &&
           (*it)->stream == stream) {
         Block* block = *it;
-        pool.erase(it);
+        pool.blocks.erase(it);
         return block;
       }
       return nullptr;
     };
 
     Block* block = find_free_block();
-    if (block == nullptr) {
+    // the callbacks may free memory, which is not allowed during a capture
+    if (block == nullptr && captures_underway == 0) {
       bool freed_memory = false;
       for (const auto& name : FreeCudaMemoryCallbacksRegistry()->Keys()) {
         freed_memory |=
@@ -243,10 +556,13 @@ class THCCachingAllocator {
         block = find_free_block();
       }
     }
+    if (block == nullptr && config.expandable_segments && &pool == &large_blocks) {
+      block = try_expand_segment(device, stream, size, stats, stat_types);
+    }
     if (block == nullptr) {
       void* ptr;
       size_t alloc_size = get_allocation_size(size);
-      cudaError_t err = cuda_malloc_with_retry(device, &ptr, alloc_size);
+      cudaError_t err = cuda_malloc_with_retry(device, &ptr, alloc_size, pool);
 
       if (err == cudaSuccess) {
         block = new Block(device, stream, alloc_size, &pool, ptr);
@@ -300,6 +616,7 @@ class THCCachingAllocator {
       remaining = block;
 
       block = new Block(device, stream, size, &pool, block->ptr);
+      block->expandable_segment = remaining->expandable_segment;
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -309,7 +626,7 @@ class THCCachingAllocator {
       remaining->prev = block;
       remaining->ptr = static_cast<char*>(remaining->ptr) + size;
       remaining->size -= size;
-      pool.insert(remaining);
+      pool.blocks.insert(remaining);
 
       if (already_split) {
         // An already-split inactive block is being shrunk by size bytes.
@@ -328,6 +645,9 @@ class THCCachingAllocator {
 
     block->allocated = true;
     allocated_blocks[block->ptr] = block;
+    if (pool.private_pool) {
+      pool.private_pool->use_count++;
+    }
 
     *devPtr = block->ptr;
 
@@ -335,6 +655,13 @@ class THCCachingAllocator {
     update_stat_array(stats.allocated_bytes, block->size, stat_types);
     update_stat_array(stats.active, 1, stat_types);
     update_stat_array(stats.active_bytes, block->size, stat_types);
+
+    if (C10_UNLIKELY(memoryProfilingEnabled())) {
+      reportMemoryUsageToProfiler(
+          block->ptr,
+          static_cast<int64_t>(block->size),
+          c10::Device(c10::DeviceType::CUDA, device));
+    }
   }
 
   void free(void* ptr)
@@ -360,8 +687,19 @@ class THCCachingAllocator {
     update_stat_array(stats.allocation, -1, {stat_types});
     update_stat_array(stats.allocated_bytes, -block->size, {stat_types});
 
+    if (C10_UNLIKELY(memoryProfilingEnabled())) {
+      reportMemoryUsageToProfiler(
+          block->ptr,
+          -static_cast<int64_t>(block->size),
+          c10::Device(c10::DeviceType::CUDA, block->device));
+    }
+
     if (!block->stream_uses.empty()) {
-      insert_events(block);
+      if (captures_underway > 0) {
+        needs_events_deferred_until_no_capture.push_back(block);
+      } else {
+        insert_events(block);
+      }
     } else {
       free_block(block);
     }
@@ -373,6 +711,10 @@ class THCCachingAllocator {
     if (!block) {
       AT_ERROR("invalid device pointer: ", ptr);
     }
+    TORCH_CHECK(!block->expandable_segment,
+        "getBaseAllocation: memory allocated from an expandable segment cannot "
+        "be shared through CUDA IPC; unset expandable_segments in "
+        "PYTORCH_CUDA_ALLOC_CONF to share CUDA tensors between processes");
     while (block->prev) {
       block = block->prev;
     }
@@ -419,16 +761,73 @@ class THCCachingAllocator {
   /** returns cached blocks to the system allocator **/
   void emptyCache() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_CHECK(captures_underway == 0,
+        "emptyCache() cannot be called while a CUDA graph is being captured");
     synchronize_and_free_events(nullopt);
-    free_blocks(large_blocks, large_blocks.begin(), large_blocks.end());
-    free_blocks(small_blocks, small_blocks.begin(), small_blocks.end());
+    free_blocks(large_blocks, large_blocks.blocks.begin(), large_blocks.blocks.end());
+    free_blocks(small_blocks, small_blocks.blocks.begin(), small_blocks.blocks.end());
+    for (auto& item : private_pools) {
+      PrivatePool& private_pool = *item.second;
+      free_blocks(private_pool.large_blocks,
+                  private_pool.large_blocks.blocks.begin(),
+                  private_pool.large_blocks.blocks.end());
+      free_blocks(private_pool.small_blocks,
+                  private_pool.small_blocks.blocks.begin(),
+                  private_pool.small_blocks.blocks.end());
+    }
+    release_expandable_segments(nullopt);
   }
 
-  /** Retrieves info (total size + largest block) of the memory cache **/
+  /** Retrieves info (total size + largest block) of the memory cache
+   *  available to allocations of the calling thread **/
   void cacheInfo(int dev_id, size_t* total, size_t* largest) {
     std::lock_guard<std::recursive_mutex> lock(mutex);
-    cache_info_aux(large_blocks, dev_id, total, largest);
-    cache_info_aux(small_blocks, dev_id, total, largest);
+    cache_info_aux(get_pool(kSmallSize + 1, current_pool_id), dev_id, total, largest);
+    cache_info_aux(get_pool(kSmallSize, current_pool_id), dev_id, total, largest);
+  }
+
+  /** creates a new private pool **/
+  MemPoolId createPool(const std::string& name) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    MemPoolId id = next_pool_id++;
+    private_pools.emplace(id, std::unique_ptr<PrivatePool>(new PrivatePool(id, name)));
+    return id;
+  }
+
+  /** returns the cached blocks of a private pool to the system and destroys
+   *  the pool once all of its blocks have been freed **/
+  void releasePool(MemPoolId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    PrivatePool& private_pool = get_private_pool(id);
+    private_pool.released = true;
+    free_private_pool_if_unused(private_pool);
+  }
+
+  /** called by CUDAGraph before it starts capturing **/
+  void notifyCaptureBegin() {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    captures_underway++;
+  }
+
+  /** called by CUDAGraph once the capture has ended **/
+  void notifyCaptureEnd() {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_INTERNAL_ASSERT(captures_underway > 0);
+    captures_underway--;
+    if (captures_underway == 0) {
+      for (Block* block : needs_events_deferred_until_no_capture) {
+        insert_events(block);
+      }
+      needs_events_deferred_until_no_capture.clear();
+    }
+  }
+
+  /** checks that a private pool exists and can be allocated from **/
+  void checkPool(MemPoolId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (id != 0) {
+      get_private_pool(id);
+    }
   }
 
   /** Returns a copy of the memory allocator stats for the device **/
@@ -489,7 +888,13 @@ class THCCachingAllocator {
       SegmentInfo& segment_info = result.back();
       segment_info.device = head_block->device;
       segment_info.address = reinterpret_cast<int64_t>(head_block->ptr);
-      segment_info.is_large = (head_block->pool == &large_blocks);
+      segment_info.stream = reinterpret_cast<int64_t>(head_block->stream);
+      segment_info.is_large = !head_block->pool->is_small;
+      segment_info.is_expandable = (head_block->expandable_segment != nullptr);
+      if (head_block->pool->private_pool) {
+        segment_info.pool_id = head_block->pool->private_pool->id;
+        segment_info.pool_name = head_block->pool->private_pool->name;
+      }
 
       const Block* block = head_block;
       while (block != nullptr) {
@@ -536,8 +941,15 @@ class THCCachingAllocator {
 
   std::vector<const Block*> get_all_blocks() const {
     std::vector<const Block*> blocks;
-    blocks.insert(blocks.end(), small_blocks.begin(), small_blocks.end());
-    blocks.insert(blocks.end(), large_blocks.begin(), large_blocks.end());
+    blocks.insert(blocks.end(), small_blocks.blocks.begin(), small_blocks.blocks.end());
+    blocks.insert(blocks.end(), large_blocks.blocks.begin(), large_blocks.blocks.end());
+    for (const auto& item : private_pools) {
+      const PrivatePool& private_pool = *item.second;
+      blocks.insert(blocks.end(), private_pool.small_blocks.blocks.begin(),
+                    private_pool.small_blocks.blocks.end());
+      blocks.insert(blocks.end(), private_pool.large_blocks.blocks.begin(),
+                    private_pool.large_blocks.blocks.end());
+    }
     for (const auto& item : allocated_blocks) {
       blocks.push_back(item.second);
     }
@@ -564,7 +976,7 @@ class THCCachingAllocator {
       }
     }
 
-    pool.insert(block);
+    pool.blocks.insert(block);
 
     if (block->is_split()) {
       net_change_inactive_split_blocks += 1;
@@ -579,6 +991,11 @@ class THCCachingAllocator {
     update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
     update_stat_array(stats.active, -1, stat_types);
     update_stat_array(stats.active_bytes, -original_block_size, stat_types);
+
+    if (pool.private_pool) {
+      pool.private_pool->use_count--;
+      free_private_pool_if_unused(*pool.private_pool);
+    }
   }
 
   /** combine previously split blocks. returns the size of the subsumed block, or 0 on failure. */
@@ -603,15 +1020,24 @@ class THCCachingAllocator {
       }
     }
 
+    ExpandableSegment* segment = src->expandable_segment;
+    if (segment && segment->tail == src) {
+      segment->tail = dst;
+    }
+
     const size_t subsumed_size = src->size;
     dst->size += subsumed_size;
-    pool.erase(src);
+    pool.blocks.erase(src);
     delete src;
 
     return subsumed_size;
   }
 
-  BlockPool& get_pool(size_t size) {
+  BlockPool& get_pool(size_t size, MemPoolId pool_id) {
+    if (pool_id != 0) {
+      PrivatePool& private_pool = get_private_pool(pool_id);
+      return size <= kSmallSize ? private_pool.small_blocks : private_pool.large_blocks;
+    }
     if (size <= kSmallSize) {
       return small_blocks;
     } else {
@@ -619,24 +1045,44 @@ class THCCachingAllocator {
     }
   }
 
-  StatType get_stat_type_for_pool(const BlockPool& pool) {
-    if (&pool == &small_blocks) {
-      return StatType::SMALL_POOL;
-    } else if (&pool == &large_blocks) {
-      return StatType::LARGE_POOL;
-    } else {
-      AT_ERROR("get_stat_type_for_pool: invalid pool");
+  PrivatePool& get_private_pool(MemPoolId id) {
+    auto it = private_pools.find(id);
+    TORCH_CHECK(it != private_pools.end(), "invalid memory pool id: ", id);
+    TORCH_CHECK(!it->second->released,
+        "memory pool '", it->second->name, "' has been released");
+    return *it->second;
+  }
+
+  /** destroys a released private pool once none of its blocks is in use,
+   *  freeing its cached blocks in either case **/
+  void free_private_pool_if_unused(PrivatePool& private_pool) {
+    if (!private_pool.released) {
+      return;
     }
+    free_blocks(private_pool.large_blocks,
+                private_pool.large_blocks.blocks.begin(),
+                private_pool.large_blocks.blocks.end());
+    free_blocks(private_pool.small_blocks,
+                private_pool.small_blocks.blocks.begin(),
+                private_pool.small_blocks.blocks.end());
+    if (private_pool.use_count == 0) {
+      // All blocks have been merged back into whole segments and freed above.
+      AT_ASSERT(private_pool.large_blocks.blocks.empty() &&
+                private_pool.small_blocks.blocks.empty());
+      private_pools.erase(private_pool.id);
+    }
+  }
+
+  StatType get_stat_type_for_pool(const BlockPool& pool) {
+    return pool.is_small ? StatType::SMALL_POOL : StatType::LARGE_POOL;
   }
 
   bool should_split(const Block* block, size_t size) {
     size_t remaining = block->size - size;
-    if (block->pool == &small_blocks) {
+    if (block->pool->is_small) {
       return remaining >= kMinBlockSize;
-    } else if (block->pool == &large_blocks) {
-      return remaining > kSmallSize;
     } else {
-      AT_ERROR("should_split: invalid pool");
+      return remaining > kSmallSize;
     }
   }
 
@@ -658,18 +1104,29 @@ class THCCachingAllocator {
     }
   }
 
-  cudaError_t cuda_malloc_with_retry(int device, void** devPtr, size_t size)
+  cudaError_t cuda_malloc_with_retry(int device, void** devPtr, size_t size,
+                                     const BlockPool& pool)
   {
     // Try cudaMalloc. If cudaMalloc fails, frees all non-split cached blocks
-    // and retries.
+    // of the allocating pool and retries. If that fails as well and there are
+    // private pools, frees the cached blocks of every pool and retries once
+    // more.
     cudaError_t err = cudaMalloc(devPtr, size);
 
-    if (err != cudaSuccess) {
+    // freeing cached blocks synchronizes with the device, which would
+    // invalidate a capture in progress
+    if (err != cudaSuccess && captures_underway == 0) {
       DeviceStats& stats = get_stats_for_device(device);
       stats.num_alloc_retries += 1;
       cudaGetLastError();  // reset the last CUDA error
-      free_cached_blocks(device);
+      const MemPoolId pool_id = pool.private_pool ? pool.private_pool->id : 0;
+      free_cached_blocks(device, pool_id);
       err = cudaMalloc(devPtr, size);
+      if (err != cudaSuccess && !private_pools.empty()) {
+        cudaGetLastError();  // reset the last CUDA error
+        free_cached_blocks(device, nullopt);
+        err = cudaMalloc(devPtr, size);
+      }
       if (err != cudaSuccess) {
         return err;
       }
@@ -678,32 +1135,167 @@ class THCCachingAllocator {
     return cudaSuccess;
   }
 
-  void free_cached_blocks(int device)
+  /** frees the non-split cached blocks on device, limited to the given pool
+   *  (0 for the default pool) if specified **/
+  void free_cached_blocks(int device, optional<MemPoolId> pool_id)
   {
     // First ensure that all blocks that can't currently be allocated due to
     // outstanding events are returned to the pool.
     synchronize_and_free_events(device);
 
+    if (!pool_id.has_value() || *pool_id == 0) {
+      free_cached_blocks_in_pool(device, large_blocks);
+      free_cached_blocks_in_pool(device, small_blocks);
+      release_expandable_segments(device);
+    }
+    for (auto& item : private_pools) {
+      if (!pool_id.has_value() || *pool_id == item.first) {
+        free_cached_blocks_in_pool(device, item.second->large_blocks);
+        free_cached_blocks_in_pool(device, item.second->small_blocks);
+      }
+    }
+  }
+
+  void free_cached_blocks_in_pool(int device, BlockPool& pool)
+  {
     // Free all non-split cached blocks on device
     Block lower_bound(device, nullptr, 0);
     Block upper_bound(device + 1, nullptr, 0);
 
     free_blocks(
-        large_blocks,
-        large_blocks.lower_bound(&lower_bound),
-        large_blocks.lower_bound(&upper_bound));
-    free_blocks(
-        small_blocks,
-        small_blocks.lower_bound(&lower_bound),
-        small_blocks.lower_bound(&upper_bound));
+        pool,
+        pool.blocks.lower_bound(&lower_bound),
+        pool.blocks.lower_bound(&upper_bound));
+  }
+
+  /** grows the expandable segment of (device, stream) so that a block of
+   *  `size` bytes fits at its end. Returns that block or nullptr if the device
+   *  is out of memory. */
+  Block* try_expand_segment(int device, cudaStream_t stream, size_t size,
+                            DeviceStats& stats, const StatTypes& stat_types)
+  {
+    ExpandableSegment* segment = nullptr;
+    for (ExpandableSegment* candidate : expandable_segments) {
+      if (candidate->device == device && candidate->stream == stream) {
+        segment = candidate;
+        break;
+      }
+    }
+    if (!segment) {
+      segment = new ExpandableSegment(device, stream);
+      expandable_segments.push_back(segment);
+      update_stat_array(stats.segment, 1, stat_types);
+    }
+
+    // A free block at the end of the segment is extended instead of placing
+    // the new block after it.
+    Block* tail = segment->tail;
+    const bool extend_tail = tail && !tail->allocated && tail->event_count == 0;
+    const size_t grow_size =
+        segment->round_size(extend_tail ? size - tail->size : size);
+    if (!segment->grow(grow_size)) {
+      return nullptr;
+    }
+    update_stat_array(stats.reserved_bytes, grow_size, stat_types);
+
+    // The returned block is accounted for as a cached (inactive) block; the
+    // caller updates the stats when it becomes active.
+    if (extend_tail) {
+      large_blocks.blocks.erase(tail);
+      tail->size += grow_size;
+      if (tail->is_split()) {
+        update_stat_array(stats.inactive_split_bytes, grow_size, stat_types);
+      }
+      return tail;
+    }
+
+    Block* block = new Block(device, stream, grow_size, &large_blocks,
+                             segment->ptr() + segment->mapped_size() - grow_size);
+    block->expandable_segment = segment;
+    block->prev = tail;
+    if (tail) {
+      tail->next = block;
+    }
+    segment->tail = block;
+    if (block->is_split()) {
+      update_stat_array(stats.inactive_split_bytes, block->size, stat_types);
+      update_stat_array(stats.inactive_split, 1, stat_types);
+    }
+    return block;
   }
 
-  void free_blocks(BlockPool& blocks, BlockPool::iterator it, BlockPool::iterator end)
+  /** unmaps the free memory at the end of expandable segments, optionally
+   *  limited to the given device, and drops segments that become empty */
+  void release_expandable_segments(optional<int> device)
+  {
+    for (auto it = expandable_segments.begin(); it != expandable_segments.end();) {
+      ExpandableSegment* segment = *it;
+      Block* tail = segment->tail;
+      if ((device.has_value() && segment->device != *device) ||
+          !tail || tail->allocated || tail->event_count > 0) {
+        ++it;
+        continue;
+      }
+
+      DeviceStats& stats = get_stats_for_device(segment->device);
+      StatTypes stat_types;
+      stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+      stat_types[static_cast<size_t>(StatType::LARGE_POOL)] = true;
+
+      // Only whole chunks that lie entirely within the tail can be unmapped.
+      const size_t tail_offset = static_cast<char*>(tail->ptr) - segment->ptr();
+      const size_t keep = segment->round_size(tail_offset);
+      const size_t release_size = segment->mapped_size() - keep;
+      if (release_size == 0) {
+        ++it;
+        continue;
+      }
+
+      large_blocks.blocks.erase(tail);
+      if (tail->is_split()) {
+        update_stat_array(stats.inactive_split_bytes, -tail->size, stat_types);
+        update_stat_array(stats.inactive_split, -1, stat_types);
+      }
+      segment->shrink(release_size);
+      update_stat_array(stats.reserved_bytes, -release_size, stat_types);
+
+      if (keep > tail_offset) {
+        // Part of the tail shares a chunk with the previous block and stays.
+        tail->size = keep - tail_offset;
+        large_blocks.blocks.insert(tail);
+        if (tail->is_split()) {
+          update_stat_array(stats.inactive_split_bytes, tail->size, stat_types);
+          update_stat_array(stats.inactive_split, 1, stat_types);
+        }
+        ++it;
+        continue;
+      }
+
+      Block* prev = tail->prev;
+      segment->tail = prev;
+      delete tail;
+      if (prev) {
+        prev->next = nullptr;
+        if (!prev->allocated && prev->event_count == 0 && !prev->is_split()) {
+          // prev was an inactive split block but no longer is split.
+          update_stat_array(stats.inactive_split_bytes, -prev->size, stat_types);
+          update_stat_array(stats.inactive_split, -1, stat_types);
+        }
+        ++it;
+      } else {
+        update_stat_array(stats.segment, -1, stat_types);
+        delete segment;
+        it = expandable_segments.erase(it);
+      }
+    }
+  }
+
+  void free_blocks(BlockPool& pool, BlockSet::iterator it, BlockSet::iterator end)
   {
     // Frees all non-split blocks between `it` and `end`
     while (it != end) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
+      if (!block->prev && !block->next && !block->expandable_segment) {
         C10_CUDA_CHECK(cudaFree((void*)block->ptr));
 
         DeviceStats& stats = get_stats_for_device(block->device);
@@ -715,7 +1307,7 @@ class THCCachingAllocator {
 
         auto cur = it;
         ++it;
-        blocks.erase(cur);
+        pool.blocks.erase(cur);
         delete block;
       } else {
         ++it;
@@ -810,11 +1402,11 @@ class THCCachingAllocator {
   }
 
   // Accumulates sizes of all memory blocks for given device in given pool
-  void cache_info_aux(BlockPool& blocks, int dev_id, size_t* total, size_t* largest)
+  void cache_info_aux(BlockPool& pool, int dev_id, size_t* total, size_t* largest)
   {
     Block search_key(dev_id, 0, 0);
-    auto it = blocks.lower_bound(&search_key);
-    for (; it != blocks.end() && *it && (*it)->device == dev_id; ++it) {
+    auto it = pool.blocks.lower_bound(&search_key);
+    for (; it != pool.blocks.end() && *it && (*it)->device == dev_id; ++it) {
       size_t blocksize = (*it)->size;
       *total += blocksize;
       if (blocksize > *largest) {
@@ -898,6 +1490,32 @@ std::vector<SegmentInfo> snapshot() {
   return caching_allocator.snapshot();
 }
 
+MemPoolId createPool(const std::string& name) {
+  return caching_allocator.createPool(name);
+}
+
+void releasePool(MemPoolId pool_id) {
+  caching_allocator.releasePool(pool_id);
+}
+
+void notifyCaptureBegin() {
+  caching_allocator.notifyCaptureBegin();
+}
+
+void notifyCaptureEnd() {
+  caching_allocator.notifyCaptureEnd();
+}
+
+MemPoolGuard::MemPoolGuard(MemPoolId pool_id)
+    : prev_pool_id_(current_pool_id) {
+  caching_allocator.checkPool(pool_id);
+  current_pool_id = pool_id;
+}
+
+MemPoolGuard::~MemPoolGuard() {
+  current_pool_id = prev_pool_id_;
+}
+
 //
 // In CUDA IPC, sender sends a tensor to receiver, getIpcDevPtr
 // is called by the receiving process to map the CUDA memory from the sending
@@ -914,18 +1532,72 @@ std::vector<SegmentInfo> snapshot() {
 // will be used to reconstruct all storages in this CudaMalloc allocation.
 // And it will deleted in cudaIpcCloseMemHandle when its reference count is 0.
 //
+// A process that receives tensors from the same producer over and over (e.g.
+// the activations of every request of a multi-process server) would open and
+// close the producer's blocks for every tensor, because the mapping goes away
+// with the last storage that uses it. ipcRetainedDevPtrs keeps strong
+// references to the ipcRetention most recently used mappings, so that
+// receiving a tensor from an already mapped block costs no CUDA IPC call.
+// It is leaked so that the mappings are not closed after CUDA shut down.
+//
 namespace {
   std::mutex IpcMutex;
   std::unordered_map<std::string, std::weak_ptr<void>> ipcMemHandle_to_devptr;
+  size_t ipcRetention = 0;
+  auto& ipcRetainedDevPtrs =
+      *new std::deque<std::pair<std::string, std::shared_ptr<void>>>();
+
+  // Moves handle to the front of ipcRetainedDevPtrs, and returns the mappings
+  // that no longer fit, which must be released after IpcMutex is.
+  std::vector<std::shared_ptr<void>> retainIpcDevPtr(
+      const std::string& handle,
+      const std::shared_ptr<void>& devptr) {
+    std::vector<std::shared_ptr<void>> evicted;
+    if (ipcRetention == 0) {
+      return evicted;
+    }
+    auto it = std::find_if(
+        ipcRetainedDevPtrs.begin(), ipcRetainedDevPtrs.end(),
+        [&](const std::pair<std::string, std::shared_ptr<void>>& e) {
+          return e.first == handle;
+        });
+    if (it == ipcRetainedDevPtrs.begin() && it != ipcRetainedDevPtrs.end()) {
+      return evicted;
+    }
+    if (it != ipcRetainedDevPtrs.end()) {
+      ipcRetainedDevPtrs.erase(it);
+    }
+    ipcRetainedDevPtrs.emplace_front(handle, devptr);
+    while (ipcRetainedDevPtrs.size() > ipcRetention) {
+      evicted.push_back(std::move(ipcRetainedDevPtrs.back().second));
+      ipcRetainedDevPtrs.pop_back();
+    }
+    return evicted;
+  }
+}
+
+void setIpcMemHandleRetention(size_t n) {
+  std::vector<std::shared_ptr<void>> evicted;
+  std::lock_guard<std::mutex> lock(IpcMutex);
+  ipcRetention = n;
+  while (ipcRetainedDevPtrs.size() > ipcRetention) {
+    evicted.push_back(std::move(ipcRetainedDevPtrs.back().second));
+    ipcRetainedDevPtrs.pop_back();
+  }
 }
 
 std::shared_ptr<void> getIpcDevPtr(std::string handle) {
+  // Declared before the lock: the deleters of the evicted mappings take it
+  std::vector<std::shared_ptr<void>> evicted;
   std::lock_guard<std::mutex> lock(IpcMutex);
 
   auto iter = ipcMemHandle_to_devptr.find(handle);
   if (iter != ipcMemHandle_to_devptr.end()) {
     auto devptr = iter->second.lock();
-    if (devptr) return devptr;
+    if (devptr) {
+      evicted = retainIpcDevPtr(handle, devptr);
+      return devptr;
+    }
   }
   // This ipcMemHandle hasn't been opened, or already expired, open it to
   // enable IPC access to that mem block.
@@ -948,6 +1620,7 @@ std::shared_ptr<void> getIpcDevPtr(std::string handle) {
   // But in the deleter for sp we erased the entry,
   // this should be safe to do now.
   ipcMemHandle_to_devptr.insert(iter, {handle, wp});
+  evicted = retainIpcDevPtr(handle, sp);
 
   return sp;
 }
@@ -8,6 +8,8 @@
 
 #include <array>
 #include <mutex>
+#include <string>
+#include <vector>
 
 namespace c10 {
 
@@ -94,17 +96,38 @@ struct BlockInfo {
   bool active = false;
 };
 
+// Identifies a private memory pool; 0 denotes the default pool.
+typedef uint64_t MemPoolId;
+
 // Struct containing info of a memory segment (i.e. one contiguous cudaMalloc).
 struct SegmentInfo {
   int64_t device = 0;
   int64_t address = 0;
+  int64_t stream = 0;
   int64_t total_size = 0;
   int64_t allocated_size = 0;
   int64_t active_size = 0;
   bool is_large = false;
+  bool is_expandable = false;
+  MemPoolId pool_id = 0;
+  std::string pool_name;
   std::vector<BlockInfo> blocks;
 };
 
+// Routes all allocations made by the current thread to a private pool (see
+// createPool()) for the lifetime of the guard.
+class C10_CUDA_API MemPoolGuard {
+ public:
+  explicit MemPoolGuard(MemPoolId pool_id);
+  ~MemPoolGuard();
+
+  MemPoolGuard(const MemPoolGuard&) = delete;
+  MemPoolGuard& operator=(const MemPoolGuard&) = delete;
+
+ private:
+  MemPoolId prev_pool_id_;
+};
+
 C10_CUDA_API void* raw_alloc(size_t nbytes);
 C10_CUDA_API void raw_delete(void* ptr);
 
@@ -118,9 +141,24 @@ C10_CUDA_API void resetAccumulatedStats(int device);
 C10_CUDA_API void resetPeakStats(int device);
 C10_CUDA_API std::vector<SegmentInfo> snapshot();
 
+// Creates a private pool whose cached blocks are only reused by allocations
+// made under a MemPoolGuard for it. `name` is reported in snapshot().
+C10_CUDA_API MemPoolId createPool(const std::string& name);
+// Frees the cached blocks of a private pool; blocks still in use are freed as
+// they are released. The pool id becomes invalid.
+C10_CUDA_API void releasePool(MemPoolId pool_id);
+
+// Called around a CUDA graph capture (see at::cuda::CUDAGraph), during which
+// the allocator refrains from calls that are illegal while capturing.
+C10_CUDA_API void notifyCaptureBegin();
+C10_CUDA_API void notifyCaptureEnd();
+
 C10_CUDA_API std::mutex* getFreeMutex();
 
 C10_CUDA_API std::shared_ptr<void> getIpcDevPtr(std::string handle);
+// Keeps the n most recently used CUDA IPC mappings open after their last
+// storage is freed. 0 (the default) closes them as soon as they are unused.
+C10_CUDA_API void setIpcMemHandleRetention(size_t n);
 } // namespace CUDACachingAllocator
 
 }} // namespace c10::cuda
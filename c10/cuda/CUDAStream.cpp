@@ -6,7 +6,10 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include <iostream>
@@ -35,14 +38,23 @@ struct LeakyStreamInternals {
   DeviceIndex device_index = -1;
   int32_t stream_id = -1;
   cudaStream_t stream = nullptr;
+  // Set while the stream is reserved by reserveStreamFromPool; reserved
+  // streams are not returned by getStreamFromPool.
+  std::atomic<bool> reserved{false};
 };
 
 // Global stream state and constants
 static DeviceIndex num_gpus = -1;
-static constexpr int kStreamsPerPoolBits = 5;
-static constexpr int kStreamsPerPool = 1 << kStreamsPerPoolBits;
+static constexpr int kStreamsPerPoolBits = 10;
+static constexpr int kMaxStreamsPerPool = 1 << kStreamsPerPoolBits;
+static constexpr int kDefaultStreamsPerPool = 32;
 static constexpr unsigned int kDefaultFlags = cudaStreamNonBlocking;
 
+// The number of streams in each pool, read from the
+// PYTORCH_CUDA_STREAMS_PER_POOL environment variable when the stream state is
+// first initialized.
+static int streams_per_pool = kDefaultStreamsPerPool;
+
 // Note: stream priority is not supported by HIP
 // Note: lower numbers are higher priorities, zero is default priority
 #ifndef __HIP_PLATFORM_HCC__
@@ -61,23 +73,26 @@ static LeakyStreamInternals default_streams[C10_COMPILE_TIME_MAX_GPUS];
 // The device flags track the initialization of each device, while
 // the low and high priority counters track, for each device, the next stream
 // in the pool to be returned when a stream is requested (round-robin fashion
-// , see the note in CUDAStream.h).
+// , see the note in CUDAStream.h). The reserved counters track how many
+// streams of each pool are reserved.
 //
 // unique_ptr<T[]> is used instead of vector<T> because T might be non-moveable
 // and non-copyable.
 static std::once_flag device_flags[C10_COMPILE_TIME_MAX_GPUS];
 static std::atomic<uint32_t> low_priority_counters[C10_COMPILE_TIME_MAX_GPUS];
 static std::atomic<uint32_t> high_priority_counters[C10_COMPILE_TIME_MAX_GPUS];
-static std::array<LeakyStreamInternals, kStreamsPerPool>
+static std::atomic<int> low_priority_reserved[C10_COMPILE_TIME_MAX_GPUS];
+static std::atomic<int> high_priority_reserved[C10_COMPILE_TIME_MAX_GPUS];
+static std::unique_ptr<LeakyStreamInternals[]>
     low_priority_streams[C10_COMPILE_TIME_MAX_GPUS];
-static std::array<LeakyStreamInternals, kStreamsPerPool>
+static std::unique_ptr<LeakyStreamInternals[]>
     high_priority_streams[C10_COMPILE_TIME_MAX_GPUS];
 
 // Note [StreamId assignment]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // How do we assign stream IDs?
 //
-// -- 25 bits -- -- 2 bits --  -- 5 bits -----
+// -- 20 bits -- -- 2 bits --  -- 10 bits -----
 // zeros         StreamIdType  stream id index
 //
 // Where StreamIdType:
@@ -141,10 +156,10 @@ StreamId makeStreamId(StreamIdType st, size_t si) {
       static_cast<StreamId>(si);
 }
 
-template <typename T, typename A>
-static bool pointer_within(const T* ptr, const A& arr) {
-  return std::greater_equal<const T*>()(ptr, arr.data()) &&
-      std::less<const T*>()(ptr, arr.data() + arr.size());
+template <typename T>
+static bool pointer_within(const T* ptr, const std::unique_ptr<T[]>& arr) {
+  return std::greater_equal<const T*>()(ptr, arr.get()) &&
+      std::less<const T*>()(ptr, arr.get() + streams_per_pool);
 }
 
 static StreamId CUDAStream_getStreamId(const LeakyStreamInternals* ptr) {
@@ -168,14 +183,14 @@ static StreamId CUDAStream_getStreamId(const LeakyStreamInternals* ptr) {
   if (pointer_within<LeakyStreamInternals>(
           ptr, low_priority_streams[device_index])) {
     return makeStreamId(
-        StreamIdType::LOW, ptr - low_priority_streams[device_index].data());
+        StreamIdType::LOW, ptr - low_priority_streams[device_index].get());
   }
 
   // Check if it's a high priority stream
   if (pointer_within<LeakyStreamInternals>(
           ptr, high_priority_streams[device_index])) {
     return makeStreamId(
-        StreamIdType::HIGH, ptr - high_priority_streams[device_index].data());
+        StreamIdType::HIGH, ptr - high_priority_streams[device_index].get());
   }
 
   AT_ASSERTM(
@@ -207,11 +222,25 @@ static void initGlobalStreamState() {
       C10_COMPILE_TIME_MAX_GPUS,
       "). Increase that and recompile.");
 
+  const char* pool_size = std::getenv("PYTORCH_CUDA_STREAMS_PER_POOL");
+  if (pool_size) {
+    int size = std::atoi(pool_size);
+    AT_ASSERTM(
+        size >= 1 && size <= kMaxStreamsPerPool,
+        "PYTORCH_CUDA_STREAMS_PER_POOL must be between 1 and ",
+        kMaxStreamsPerPool,
+        ", but got ",
+        pool_size);
+    streams_per_pool = size;
+  }
+
   // Initializes default streams
   for (auto i = decltype(num_gpus){0}; i < num_gpus; ++i) {
     default_streams[i].device_index = i;
     low_priority_counters[i] = 0;
     high_priority_counters[i] = 0;
+    low_priority_reserved[i] = 0;
+    high_priority_reserved[i] = 0;
   }
 }
 
@@ -222,7 +251,11 @@ static void initDeviceStreamState(DeviceIndex device_index) {
   // with it.
   CUDAGuard device_guard{device_index};
 
-  for (auto i = decltype(kStreamsPerPool){0}; i < kStreamsPerPool; ++i) {
+  low_priority_streams[device_index].reset(
+      new LeakyStreamInternals[streams_per_pool]);
+  high_priority_streams[device_index].reset(
+      new LeakyStreamInternals[streams_per_pool]);
+  for (auto i = decltype(streams_per_pool){0}; i < streams_per_pool; ++i) {
     auto& lowpri_stream = low_priority_streams[device_index][i];
     auto& hipri_stream = high_priority_streams[device_index][i];
 
@@ -265,11 +298,33 @@ static inline void check_gpu(DeviceIndex device_index) {
   AT_ASSERT(device_index >= 0 && device_index < num_gpus);
 }
 
-// Helper to determine the index of the stream to return
-// Note: Streams are returned round-robin (see note in CUDAStream.h)
-static uint32_t get_idx(std::atomic<uint32_t>& counter) {
-  auto raw_idx = counter++;
-  return raw_idx % kStreamsPerPool;
+// Helper to determine the stream to return
+// Note: Streams are returned round-robin (see note in CUDAStream.h), skipping
+// the reserved ones. reserveStreamFromPool always leaves one stream of the
+// pool unreserved, so this terminates.
+static LeakyStreamInternals* get_pooled_stream(
+    LeakyStreamInternals* pool,
+    std::atomic<uint32_t>& counter) {
+  while (true) {
+    auto raw_idx = counter++;
+    auto* ptr = &pool[raw_idx % streams_per_pool];
+    if (!ptr->reserved.load()) {
+      return ptr;
+    }
+  }
+}
+
+// Initializes the streams and the pools of the device, returning its index
+static DeviceIndex initDevicePools(DeviceIndex device_index) {
+  initCUDAStreamsOnce();
+  if (device_index == -1)
+    device_index = current_device();
+  check_gpu(device_index);
+
+  // Initializes the stream pools (once)
+  std::call_once(
+      device_flags[device_index], initDeviceStreamState, device_index);
+  return device_index;
 }
 
 // See Note [StreamId assignment]
@@ -327,22 +382,67 @@ cudaStream_t CUDAStream::stream() const {
 CUDAStream getStreamFromPool(
     const bool isHighPriority,
     DeviceIndex device_index) {
-  initCUDAStreamsOnce();
-  if (device_index == -1)
-    device_index = current_device();
-  check_gpu(device_index);
-
-  // Initializes the stream pools (once)
-  std::call_once(
-      device_flags[device_index], initDeviceStreamState, device_index);
+  device_index = initDevicePools(device_index);
 
   if (isHighPriority) {
-    const auto idx = get_idx(high_priority_counters[device_index]);
-    return CUDAStream_fromInternals(&high_priority_streams[device_index][idx]);
+    return CUDAStream_fromInternals(get_pooled_stream(
+        high_priority_streams[device_index].get(),
+        high_priority_counters[device_index]));
   }
 
-  const auto idx = get_idx(low_priority_counters[device_index]);
-  return CUDAStream_fromInternals(&low_priority_streams[device_index][idx]);
+  return CUDAStream_fromInternals(get_pooled_stream(
+      low_priority_streams[device_index].get(),
+      low_priority_counters[device_index]));
+}
+
+CUDAStream reserveStreamFromPool(
+    const bool isHighPriority,
+    DeviceIndex device_index) {
+  device_index = initDevicePools(device_index);
+
+  auto& reserved = isHighPriority ? high_priority_reserved[device_index]
+                                  : low_priority_reserved[device_index];
+  if (reserved++ >= streams_per_pool - 1) {
+    reserved--;
+    AT_ERROR(
+        "Cannot reserve more than ",
+        streams_per_pool - 1,
+        " streams of the ",
+        isHighPriority ? "high" : "low",
+        " priority pool of device ",
+        static_cast<int>(device_index),
+        ". Increase PYTORCH_CUDA_STREAMS_PER_POOL or release reserved streams.");
+  }
+
+  auto* pool = isHighPriority ? high_priority_streams[device_index].get()
+                              : low_priority_streams[device_index].get();
+  auto& counter = isHighPriority ? high_priority_counters[device_index]
+                                 : low_priority_counters[device_index];
+  // The reserved counter guarantees there is an unreserved stream left
+  while (true) {
+    auto* ptr = get_pooled_stream(pool, counter);
+    bool expected = false;
+    if (ptr->reserved.compare_exchange_strong(expected, true)) {
+      return CUDAStream_fromInternals(ptr);
+    }
+  }
+}
+
+void releaseStreamToPool(CUDAStream stream) {
+  initCUDAStreamsOnce();
+  StreamIdType st = streamIdType(stream.unwrap().id());
+  auto ptr = CUDAStream_internals(stream);
+  AT_ASSERT(ptr);
+  bool was_reserved = st != StreamIdType::DEFAULT && ptr->reserved.exchange(false);
+  AT_ASSERTM(
+      was_reserved,
+      "Stream ",
+      stream.unwrap(),
+      " was not reserved with reserveStreamFromPool");
+  auto& reserved = st == StreamIdType::HIGH
+      ? high_priority_reserved[ptr->device_index]
+      : low_priority_reserved[ptr->device_index];
+  reserved--;
 }
 
 CUDAStream getDefaultCUDAStream(DeviceIndex device_index) {
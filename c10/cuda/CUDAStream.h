@@ -184,6 +184,25 @@ private:
 CAFFE2_API CUDAStream
 getStreamFromPool(const bool isHighPriority = false, DeviceIndex device = -1);
 
+/**
+ * Reserve a stream of the CUDA stream pool for exclusive use.  Until it is
+ * released with releaseStreamToPool, getStreamFromPool will not return the
+ * stream, so work queued on it does not falsely depend on unrelated work, e.g.
+ * when each worker of a server reserves its own stream.  Streams handed out
+ * by getStreamFromPool before the reservation may still be in use.
+ *
+ * At least one stream of each pool stays unreserved.  The number of streams
+ * per pool (32 by default) can be set with the PYTORCH_CUDA_STREAMS_PER_POOL
+ * environment variable before the first stream is requested.
+ */
+CAFFE2_API CUDAStream
+reserveStreamFromPool(const bool isHighPriority = false, DeviceIndex device = -1);
+
+/**
+ * Return a stream reserved with reserveStreamFromPool to the pool.
+ */
+CAFFE2_API void releaseStreamToPool(CUDAStream stream);
+
 /**
  * Get the default CUDA stream, for the passed CUDA device, or for the
  * current device if no device index is passed.  The default stream is
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
+#include <c10/util/numa.h>
+
+using namespace c10;
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlock) {
+  CPUCachingAllocator::emptyCache();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  void* first = nullptr;
+  {
+    auto ptr = allocator->allocate(1000);
+    first = ptr.get();
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0);
+  }
+  auto before = CPUCachingAllocator::getStats();
+  auto ptr = allocator->allocate(1000);
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(ptr.get(), first);
+  ASSERT_EQ(after.num_cache_hits, before.num_cache_hits + 1);
+  ASSERT_EQ(after.num_cache_misses, before.num_cache_misses);
+}
+
+TEST(CPUCachingAllocatorTest, SizeClassesDoNotOverlap) {
+  CPUCachingAllocator::emptyCache();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  for (size_t nbytes = 1; nbytes < (1 << 20); nbytes = nbytes * 3 / 2 + 1) {
+    auto ptr = allocator->allocate(nbytes);
+    // Writing the full requested size must not clobber the block header.
+    memset(ptr.get(), 0xff, nbytes);
+  }
+  SUCCEED();
+}
+
+TEST(CPUCachingAllocatorTest, Stats) {
+  CPUCachingAllocator::emptyCache();
+  CPUCachingAllocator::resetAccumulatedStats();
+  CPUCachingAllocator::resetPeakStats();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  {
+    auto a = allocator->allocate(4096);
+    auto b = allocator->allocate(4096);
+    auto stats = CPUCachingAllocator::getStats();
+    ASSERT_EQ(stats.allocation.current, 2);
+    ASSERT_GE(stats.allocated_bytes.current, 2 * 4096);
+    ASSERT_EQ(stats.reserved_bytes.current, stats.allocated_bytes.current);
+  }
+  auto stats = CPUCachingAllocator::getStats();
+  ASSERT_EQ(stats.allocation.current, 0);
+  ASSERT_EQ(stats.allocation.peak, 2);
+  ASSERT_EQ(stats.allocated_bytes.current, 0);
+  ASSERT_GT(stats.reserved_bytes.current, 0);
+
+  CPUCachingAllocator::emptyCache();
+  stats = CPUCachingAllocator::getStats();
+  ASSERT_EQ(stats.reserved_bytes.current, 0);
+}
+
+TEST(CPUCachingAllocatorTest, CrossThreadFree) {
+  CPUCachingAllocator::emptyCache();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  auto ptr = allocator->allocate(1 << 16);
+  void* data = ptr.get();
+  // The block is freed on another thread; when that thread exits its cache is
+  // handed over to the shared pool, where this thread can pick it up again.
+  std::thread t([&]() { ptr.clear(); });
+  t.join();
+  auto again = allocator->allocate(1 << 16);
+  ASSERT_EQ(again.get(), data);
+}
+
+TEST(CPUCachingAllocatorTest, LargeAllocationsAreNotCached) {
+  CPUCachingAllocator::emptyCache();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  { auto ptr = allocator->allocate((size_t(1) << 30) + 1); }
+  auto stats = CPUCachingAllocator::getStats();
+  ASSERT_EQ(stats.reserved_bytes.current, 0);
+}
+
+TEST(CPUCachingAllocatorTest, RawInterface) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  void* data = allocator->raw_allocate(128);
+  ASSERT_NE(data, nullptr);
+  allocator->raw_deallocate(data);
+}
+
+TEST(CPUCachingAllocatorTest, NUMAScope) {
+  const bool numa_enabled = FLAGS_caffe2_cpu_numa_enabled;
+  FLAGS_caffe2_cpu_numa_enabled = true;
+  CPUCachingAllocator::emptyCache();
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  constexpr size_t kSize = 1 << 16;
+  if (!IsNUMAEnabled()) {
+    // Without NUMA support the scope is ignored.
+    NUMAScope scope(0);
+    EXPECT_EQ(GetAllocationNUMANode(), -1);
+    auto ptr = allocator->allocate(kSize);
+    EXPECT_NE(ptr.get(), nullptr);
+  } else {
+    const int last_node = GetNumNUMANodes() - 1;
+    void* data = nullptr;
+    {
+      NUMAScope scope(0);
+      {
+        NUMAScope inner(last_node);
+        EXPECT_EQ(GetAllocationNUMANode(), last_node);
+      }
+      EXPECT_EQ(GetAllocationNUMANode(), 0);
+      auto ptr = allocator->allocate(kSize);
+      data = ptr.get();
+      memset(data, 0, kSize);
+      EXPECT_EQ(GetNUMANode(data), 0);
+    }
+    // The cached block is moved when it is reused for another node.
+    NUMAScope scope(last_node);
+    auto ptr = allocator->allocate(kSize);
+    EXPECT_EQ(ptr.get(), data);
+    EXPECT_EQ(GetNUMANode(data), last_node);
+  }
+  FLAGS_caffe2_cpu_numa_enabled = numa_enabled;
+}
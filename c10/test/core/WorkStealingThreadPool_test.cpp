@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/thread_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace {
+
+// Waits until `count` reaches `expected`.
+class Counter {
+ public:
+  void increment() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++count_;
+    cv_.notify_all();
+  }
+
+  void waitFor(int expected) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return count_ >= expected; });
+  }
+
+  int count() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return count_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int count_ = 0;
+};
+
+TEST(WorkStealingThreadPoolTest, RunsAllTasks) {
+  c10::WorkStealingThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4);
+  EXPECT_FALSE(pool.inThreadPool());
+  Counter counter;
+  constexpr int kTasks = 10000;
+  for (int i = 0; i < kTasks; ++i) {
+    pool.run([&] { counter.increment(); });
+  }
+  counter.waitFor(kTasks);
+  EXPECT_EQ(counter.count(), kTasks);
+}
+
+TEST(WorkStealingThreadPoolTest, TasksScheduleTasks) {
+  c10::WorkStealingThreadPool pool(4);
+  Counter counter;
+  std::atomic<bool> in_pool{true};
+  // Every task schedules two more, down to a depth of 10
+  std::function<void(int)> spawn = [&](int depth) {
+    in_pool = in_pool && pool.inThreadPool();
+    counter.increment();
+    if (depth > 0) {
+      pool.run([&, depth] { spawn(depth - 1); });
+      pool.run([&, depth] { spawn(depth - 1); });
+    }
+  };
+  pool.run([&] { spawn(10); });
+  counter.waitFor((1 << 11) - 1);
+  EXPECT_TRUE(in_pool);
+}
+
+TEST(WorkStealingThreadPoolTest, LocalTasksCanBeStolen) {
+  c10::WorkStealingThreadPool pool(2);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool released = false;
+  Counter counter;
+  // The first task blocks its thread after it scheduled a second one on its
+  // own queue, which the other thread has to steal
+  pool.run([&] {
+    pool.run([&] { counter.increment(); });
+    counter.waitFor(1);
+    std::lock_guard<std::mutex> guard(mutex);
+    released = true;
+    cv.notify_all();
+  });
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return released; });
+  EXPECT_EQ(counter.count(), 1);
+}
+
+} // namespace
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <map>
 #include <set>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -1580,6 +1581,37 @@ TEST(IntrusivePtrTest, givenStackObject_whenReclaimed_thenCrashes) {
 #endif
 }*/
 
+TEST(
+    IntrusivePtrTest,
+    givenPtr_whenCopiedAndDestructedConcurrently_thenIsDestructedOnce) {
+  bool resourcesReleased = false;
+  bool wasDestructed = false;
+  {
+    auto obj =
+        make_intrusive<DestructableMock>(&resourcesReleased, &wasDestructed);
+    weak_intrusive_ptr<DestructableMock> weak(obj);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([copy = obj, weak]() mutable {
+        for (int i = 0; i < 1000; ++i) {
+          intrusive_ptr<DestructableMock> a = copy;
+          auto b = weak.lock();
+          EXPECT_TRUE(b.defined());
+          weak_intrusive_ptr<DestructableMock> c = weak;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(1, obj.use_count());
+    EXPECT_EQ(2, obj.weak_use_count());
+    EXPECT_FALSE(resourcesReleased);
+  }
+  EXPECT_TRUE(resourcesReleased);
+  EXPECT_TRUE(wasDestructed);
+}
+
 TEST(IntrusivePtrTest, givenPtr_whenNonOwningReclaimed_thenDoesntCrash) {
   intrusive_ptr<SomeClass> obj = make_intrusive<SomeClass>();
   SomeClass* raw_ptr = obj.get();
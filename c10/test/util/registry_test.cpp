@@ -47,6 +47,11 @@ TEST(RegistryTest, ReturnNullOnNonExistingCreator) {
   EXPECT_EQ(FooRegistry()->Create("Non-existing bar", 1), nullptr);
 }
 
+TEST(RegistryTest, IsNamedAfterItsFunction) {
+  // The name the registrations are timed under
+  EXPECT_STREQ(FooRegistry()->Name(), "FooRegistry");
+}
+
 // C10_REGISTER_CLASS_WITH_PRIORITY defines static variable
 void RegisterFooDefault() {
   C10_REGISTER_CLASS_WITH_PRIORITY(
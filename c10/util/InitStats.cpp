@@ -0,0 +1,87 @@
+#include <c10/util/InitStats.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace c10 {
+
+namespace {
+
+struct InitStatsStore {
+  ~InitStatsStore() {
+    // Only enabled stores have stats
+    std::vector<InitStat> stats = sorted();
+    if (stats.empty()) {
+      return;
+    }
+    // use stderr to avoid messing with glog
+    fprintf(stderr, "PYTORCH_INIT_STATS registry, count, total ms\n");
+    for (const InitStat& stat : stats) {
+      fprintf(
+          stderr,
+          "PYTORCH_INIT_STATS %s, %zu, %.3f\n",
+          stat.name.c_str(),
+          stat.count,
+          stat.total.count() / 1e6);
+    }
+  }
+
+  std::vector<InitStat> sorted() {
+    std::vector<InitStat> result;
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      for (const auto& entry : stats) {
+        result.push_back(entry.second);
+      }
+    }
+    std::sort(
+        result.begin(),
+        result.end(),
+        [](const InitStat& a, const InitStat& b) { return a.total > b.total; });
+    return result;
+  }
+
+  std::mutex mutex;
+  // Keyed by the address of the name literal, to record without allocating
+  std::vector<std::pair<const char*, InitStat>> stats;
+};
+
+InitStatsStore& GetInitStatsStore() {
+  static InitStatsStore store;
+  return store;
+}
+
+} // namespace
+
+bool InitStatsEnabled() {
+  static const bool enabled = [] {
+    const char* val = getenv("PYTORCH_INIT_STATS");
+    return val && *val; // any non-empty value
+  }();
+  return enabled;
+}
+
+void RecordInitTime(const char* name, std::chrono::nanoseconds time) {
+  InitStatsStore& store = GetInitStatsStore();
+  std::lock_guard<std::mutex> guard(store.mutex);
+  auto it = std::find_if(
+      store.stats.begin(), store.stats.end(), [&](const auto& entry) {
+        return entry.first == name || strcmp(entry.first, name) == 0;
+      });
+  if (it == store.stats.end()) {
+    store.stats.emplace_back(name, InitStat());
+    it = store.stats.end() - 1;
+    it->second.name = name;
+  }
+  ++it->second.count;
+  it->second.total += time;
+}
+
+std::vector<InitStat> GetInitStats() {
+  return GetInitStatsStore().sorted();
+}
+
+} // namespace c10
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <c10/macros/Macros.h>
+
+/**
+ * Counters of the time spent filling the global registries, like the
+ * operator registries and the c10::Registry of every Caffe2 op type, most of
+ * it in static initializers when the libraries are loaded, and the rest
+ * lazily on the first lookups. They tell which registries make loading
+ * PyTorch slow.
+ *
+ * They are only collected when the PYTORCH_INIT_STATS environment variable is
+ * set to a non-empty value, and then also printed to stderr when the process
+ * exits. The time of a registration includes the time of the registrations it
+ * triggers, e.g. registering a c10 operator also registers it with the JIT.
+ */
+
+namespace c10 {
+
+struct C10_API InitStat {
+  std::string name;
+  size_t count = 0;
+  std::chrono::nanoseconds total{0};
+};
+
+C10_API bool InitStatsEnabled();
+
+C10_API void RecordInitTime(const char* name, std::chrono::nanoseconds time);
+
+/// The time spent in every registry so far, sorted by decreasing time.
+C10_API std::vector<InitStat> GetInitStats();
+
+/// Records the time until it is destroyed under `name`, which must be a
+/// string literal.
+class InitTimer {
+ public:
+  explicit InitTimer(const char* name)
+      : name_(InitStatsEnabled() ? name : nullptr) {
+    if (name_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~InitTimer() {
+    if (name_) {
+      RecordInitTime(
+          name_,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_));
+    }
+  }
+
+  InitTimer(const InitTimer&) = delete;
+  InitTimer& operator=(const InitTimer&) = delete;
+
+ private:
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace c10
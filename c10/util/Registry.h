@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "c10/macros/Macros.h"
+#include "c10/util/InitStats.h"
 #include "c10/util/Type.h"
 
 namespace c10 {
@@ -55,8 +56,14 @@ class Registry {
  public:
   typedef std::function<ObjectPtrType(Args...)> Creator;
 
-  Registry(bool warning = true)
-    : registry_(), priority_(), terminate_(true), warning_(warning) {}
+  // name is the string literal the registrations are timed under, see
+  // c10/util/InitStats.h
+  Registry(bool warning = true, const char* name = "c10::Registry")
+    : registry_(),
+      priority_(),
+      terminate_(true),
+      warning_(warning),
+      name_(name) {}
 
   void Register(
       const SrcType& key,
@@ -150,11 +157,16 @@ class Registry {
     terminate_ = terminate;
   }
 
+  const char* Name() const {
+    return name_;
+  }
+
  private:
   std::unordered_map<SrcType, Creator> registry_;
   std::unordered_map<SrcType, RegistryPriority> priority_;
   bool terminate_;
   const bool warning_;
+  const char* const name_;
   std::unordered_map<SrcType, std::string> help_message_;
   std::mutex register_mutex_;
 
@@ -169,6 +181,7 @@ class Registerer {
       Registry<SrcType, ObjectPtrType, Args...>* registry,
       typename Registry<SrcType, ObjectPtrType, Args...>::Creator creator,
       const std::string& help_msg = "") {
+    InitTimer timer(registry->Name());
     registry->Register(key, creator, help_msg);
   }
 
@@ -178,6 +191,7 @@ class Registerer {
       Registry<SrcType, ObjectPtrType, Args...>* registry,
       typename Registry<SrcType, ObjectPtrType, Args...>::Creator creator,
       const std::string& help_msg = "") {
+    InitTimer timer(registry->Name());
     registry->Register(key, creator, help_msg, priority);
   }
 
@@ -218,7 +232,8 @@ class Registerer {
   RegistryName() {                                                         \
     static ::c10::Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>*   \
         registry = new ::c10::                                             \
-            Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>();       \
+            Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>(         \
+                true, #RegistryName);                                      \
     return registry;                                                       \
   }
 
@@ -228,7 +243,8 @@ class Registerer {
   RegistryName() {                                                         \
     static ::c10::Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>*   \
         registry = new ::c10::                                             \
-            Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>(false);  \
+            Registry<SrcType, PtrType<ObjectType>, ##__VA_ARGS__>(         \
+                false, #RegistryName);                                     \
     return registry;                                                       \
   }
 
@@ -63,6 +63,30 @@ class C10_API intrusive_ptr_target {
   //    atomically increment the use count, if it is greater than 0.
   //    If it is not, you must report that the storage is dead.
   //
+  // Note [Uniquely owned intrusive_ptr_target fast path]
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Most targets (e.g. the TensorImpl of a short-lived intermediate) are
+  // created, used and destroyed by a single owner. Atomic read-modify-write
+  // operations on the counts are then pure overhead, so:
+  //
+  //  - make_intrusive() initializes the counts with plain stores; the object
+  //    cannot be visible to any other thread yet.
+  //
+  //  - When the last strong reference goes away and weakcount == 1, there are
+  //    no weak references left either, and nobody can create a new one. The
+  //    object is destroyed without the second atomic decrement. (Checking for
+  //    refcount == 1 up front would save the first one too, but the extra
+  //    load right after an increment makes every copy measurably slower.)
+  //
+  //  - Increments only need to be atomic, not ordered (relaxed), exactly like
+  //    std::shared_ptr; decrements are acq_rel so that all uses of the object
+  //    happen-before its destruction.
+  //
+  // A fully biased scheme (non-atomic counts for an owning thread, atomic for
+  // everyone else) would additionally need the owning thread to merge counts
+  // whenever a reference escapes to another thread and at thread exit;
+  // intrusive_ptr has no hook for that, and references routinely leave the
+  // thread that created them (data loader workers, autograd threads).
   mutable std::atomic<size_t> refcount_;
   mutable std::atomic<size_t> weakcount_;
 
@@ -184,7 +208,8 @@ class intrusive_ptr final {
 
   void retain_() {
     if (target_ != NullType::singleton()) {
-      size_t new_refcount = ++target_->refcount_;
+      size_t new_refcount =
+          target_->refcount_.fetch_add(1, std::memory_order_relaxed) + 1;
       TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
           new_refcount != 1,
           "intrusive_ptr: Cannot increase refcount after it reached zero.");
@@ -192,15 +217,22 @@ class intrusive_ptr final {
   }
 
   void reset_() noexcept {
-    if (target_ != NullType::singleton() && --target_->refcount_ == 0) {
+    if (target_ != NullType::singleton() &&
+        target_->refcount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
       // justification for const_cast: release_resources is basically a destructor
       // and a destructor always mutates the object, even for const objects.
       const_cast<std::remove_const_t<TTarget>*>(target_)->release_resources();
 
       // See comment above about weakcount. As long as refcount>0,
       // weakcount is one larger than the actual number of weak references.
-      // So we need to decrement it here.
-      if (--target_->weakcount_ == 0) {
+      // So we need to decrement it here. If there are no weak references,
+      // nobody else can reach the object anymore and the decrement can be
+      // skipped; see Note [Uniquely owned intrusive_ptr_target fast path].
+      if (target_->weakcount_.load(std::memory_order_acquire) == 1) {
+        target_->weakcount_.store(0, std::memory_order_relaxed);
+        delete target_;
+      } else if (
+          target_->weakcount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
         delete target_;
       }
     }
@@ -355,9 +387,15 @@ class intrusive_ptr final {
     auto result = intrusive_ptr(new TTarget(std::forward<Args>(args)...));
     // We can't use retain_(), because we also have to increase weakcount
     // and because we allow raising these values from 0, which retain_()
-    // has an assertion against.
-    ++result.target_->refcount_;
-    ++result.target_->weakcount_;
+    // has an assertion against. The object is not shared with any other
+    // thread yet, so plain stores suffice.
+    // See Note [Uniquely owned intrusive_ptr_target fast path]
+    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
+        result.target_->refcount_.load(std::memory_order_relaxed) == 0 &&
+            result.target_->weakcount_.load(std::memory_order_relaxed) == 0,
+        "intrusive_ptr: Object acquired references during construction.");
+    result.target_->refcount_.store(1, std::memory_order_relaxed);
+    result.target_->weakcount_.store(1, std::memory_order_relaxed);
 
     return result;
   }
@@ -441,7 +479,8 @@ class weak_intrusive_ptr final {
 
   void retain_() {
     if (target_ != NullType::singleton()) {
-      size_t new_weakcount = ++target_->weakcount_;
+      size_t new_weakcount =
+          target_->weakcount_.fetch_add(1, std::memory_order_relaxed) + 1;
       TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
           new_weakcount != 1,
           "weak_intrusive_ptr: Cannot increase weakcount after it reached zero.");
@@ -449,7 +488,8 @@ class weak_intrusive_ptr final {
   }
 
   void reset_() noexcept {
-    if (target_ != NullType::singleton() && --target_->weakcount_ == 0) {
+    if (target_ != NullType::singleton() &&
+        target_->weakcount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
       delete target_;
     }
     target_ = NullType::singleton();
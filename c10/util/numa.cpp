@@ -14,6 +14,20 @@ C10_DEFINE_bool(caffe2_cpu_numa_enabled, false, "Use NUMA whenever possible.");
 
 namespace c10 {
 
+namespace {
+// NUMA node set by the innermost NUMAScope of this thread, -1 if none
+thread_local int scope_numa_node_id = -1;
+} // namespace
+
+NUMAScope::NUMAScope(int numa_node_id)
+    : prev_numa_node_id_(scope_numa_node_id) {
+  scope_numa_node_id = numa_node_id;
+}
+
+NUMAScope::~NUMAScope() {
+  scope_numa_node_id = prev_numa_node_id_;
+}
+
 #ifdef C10_ENABLE_NUMA
 bool IsNUMAEnabled() {
   return FLAGS_caffe2_cpu_numa_enabled && numa_available() >= 0;
@@ -94,6 +108,27 @@ void NUMAMove(void* ptr, size_t size, int numa_node_id) {
       "Could not move memory to a NUMA node");
 }
 
+void NUMAInterleave(void* ptr, size_t size) {
+  if (!IsNUMAEnabled()) {
+    return;
+  }
+  AT_ASSERT(ptr);
+
+  uintptr_t page_start_ptr =
+      ((reinterpret_cast<uintptr_t>(ptr)) & ~(getpagesize() - 1));
+  ptrdiff_t offset = reinterpret_cast<uintptr_t>(ptr) - page_start_ptr;
+  struct bitmask* nodes = numa_all_nodes_ptr;
+  TORCH_CHECK(
+      mbind(
+          reinterpret_cast<void*>(page_start_ptr),
+          size + offset,
+          MPOL_INTERLEAVE,
+          nodes->maskp,
+          nodes->size + 1,
+          0) == 0,
+      "Could not interleave memory across NUMA nodes");
+}
+
 int GetCurrentNUMANode() {
   if (!IsNUMAEnabled()) {
     return -1;
@@ -103,6 +138,17 @@ int GetCurrentNUMANode() {
   return n;
 }
 
+int GetAllocationNUMANode() {
+  if (!IsNUMAEnabled()) {
+    return -1;
+  }
+
+  if (scope_numa_node_id >= 0) {
+    return scope_numa_node_id;
+  }
+  return GetCurrentNUMANode();
+}
+
 #else // C10_ENABLE_NUMA
 
 bool IsNUMAEnabled() {
@@ -123,10 +169,17 @@ int GetNumNUMANodes() {
 void NUMAMove(void* ptr, size_t size, int numa_node_id) {
 }
 
+void NUMAInterleave(void* ptr, size_t size) {
+}
+
 int GetCurrentNUMANode() {
   return -1;
 }
 
+int GetAllocationNUMANode() {
+  return -1;
+}
+
 #endif // C10_NUMA_ENABLED
 
 } // namespace c10
@@ -32,9 +32,40 @@ C10_API int GetNumNUMANodes();
  */
 C10_API void NUMAMove(void* ptr, size_t size, int numa_node_id);
 
+/**
+ * Interleave the pages of the memory pointed to by `ptr` of a given size
+ * across all NUMA nodes. Only pages that are faulted in afterwards are
+ * affected, so this should be called before the memory is first touched
+ */
+C10_API void NUMAInterleave(void* ptr, size_t size);
+
 /**
  * Get the current NUMA node id
  */
 C10_API int GetCurrentNUMANode();
 
+/**
+ * Get the NUMA node id that CPU memory allocated by the current thread
+ * should be placed on: the node of the innermost active NUMAScope, or the
+ * current NUMA node if there is none
+ */
+C10_API int GetAllocationNUMANode();
+
+/**
+ * RAII guard that directs CPU memory allocated by the current thread to a
+ * given NUMA node for the duration of the scope. Has no effect when NUMA is
+ * disabled.
+ */
+class C10_API NUMAScope {
+ public:
+  explicit NUMAScope(int numa_node_id);
+  ~NUMAScope();
+
+  NUMAScope(const NUMAScope&) = delete;
+  NUMAScope& operator=(const NUMAScope&) = delete;
+
+ private:
+  int prev_numa_node_id_;
+};
+
 } // namespace c10
@@ -1,5 +1,6 @@
 #include "caffe2/core/blob_serialization.h"
 
+#include <algorithm>
 #include <sstream>
 #include <mutex>
 
@@ -148,8 +149,12 @@ void TensorSerializer::SerializeWithChunkSize(
   };
   std::vector<std::future<void>> futures;
   if (tensor.numel() > chunk_size) {
-    futures.reserve(FLAGS_caffe2_max_tensor_serializer_threads);
-    for (int i = 0; i < FLAGS_caffe2_max_tensor_serializer_threads; ++i) {
+    // The calling thread serializes chunks too once they are all queued
+    const int64_t num_chunks = (tensor.numel() + chunk_size - 1) / chunk_size;
+    const int num_threads = std::min<int64_t>(
+        FLAGS_caffe2_max_tensor_serializer_threads, num_chunks - 1);
+    futures.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
       futures.emplace_back(std::async(std::launch::async, task));
     }
   }
@@ -177,6 +182,7 @@ void TensorSerializer::SerializeWithChunkSize(
 
 #ifndef __ANDROID__
   chunkQueue.NoMoreJobs();
+  task();
   for (auto& fut : futures) {
     fut.get();
   }
@@ -1,5 +1,6 @@
 #include "caffe2/core/db.h"
 
+#include <algorithm>
 #include <mutex>
 
 #include "caffe2/core/blob_serialization.h"
@@ -14,6 +15,138 @@ namespace db {
 
 C10_DEFINE_REGISTRY(Caffe2DBRegistry, DB, const string&, Mode);
 
+size_t Cursor::ReadBatch(size_t n, RecordBatch* batch) {
+  size_t count = 0;
+  for (; count < n && Valid(); ++count) {
+    batch->AddCopy(key(), value());
+    Next();
+  }
+  return count;
+}
+
+void DBReader::ReadBatch(size_t n, RecordBatch* batch) const {
+  CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+  batch->Clear();
+  if (prefetch_thread_.joinable()) {
+    TakePrefetched(n, batch);
+    return;
+  }
+  std::lock_guard<std::mutex> mutex_lock(reader_mutex_);
+  ReadRecords(n, batch);
+}
+
+void DBReader::ReadRecords(size_t n, RecordBatch* batch) const {
+  // Like Read(), in sharded mode each record is followed by num_shards_ - 1
+  // records of the other shards.
+  const size_t records_per_read = num_shards_ == 1 ? n : 1;
+  while (n > 0) {
+    if (!cursor_->Valid()) {
+      MoveToBeginning();
+      CAFFE_ENFORCE(cursor_->Valid(), "Db has no rows");
+    }
+    n -= cursor_->ReadBatch(std::min(n, records_per_read), batch);
+    for (uint32_t s = 1; s < num_shards_ && cursor_->Valid(); s++) {
+      cursor_->Next();
+    }
+  }
+  if (!cursor_->Valid()) {
+    MoveToBeginning();
+  }
+}
+
+void DBReader::StartPrefetch(size_t batch_size, size_t depth) {
+  CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+  CAFFE_ENFORCE_GT(batch_size, 0);
+  CAFFE_ENFORCE_GT(depth, 0);
+  StopPrefetch();
+  prefetch_batch_size_ = batch_size;
+  prefetch_depth_ = depth;
+  stop_prefetch_ = false;
+  prefetch_thread_ = std::thread([this] { PrefetchLoop(); });
+}
+
+void DBReader::StopPrefetch() {
+  if (!prefetch_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    stop_prefetch_ = true;
+    prefetch_cv_.notify_all();
+  }
+  prefetch_thread_.join();
+  // Move the cursor back to the records that weren't taken, if it can.
+  if (!prefetched_.empty() && cursor_->SupportsSeek()) {
+    cursor_->Seek(string(prefetched_.front().key(prefetched_offset_)));
+  }
+  prefetched_.clear();
+  prefetched_offset_ = 0;
+  prefetch_error_ = nullptr;
+}
+
+void DBReader::PrefetchLoop() {
+  while (true) {
+    RecordBatch batch;
+    {
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      prefetch_cv_.wait(lock, [this] {
+        return stop_prefetch_ || prefetched_.size() < prefetch_depth_;
+      });
+      if (stop_prefetch_) {
+        return;
+      }
+    }
+    // The batch is queued before the cursor can move again, so that the
+    // queue and the cursor always agree on the next record.
+    std::lock_guard<std::mutex> mutex_lock(reader_mutex_);
+    std::exception_ptr error;
+    try {
+      ReadRecords(prefetch_batch_size_, &batch);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    if (error) {
+      prefetch_error_ = error;
+      prefetch_cv_.notify_all();
+      return;
+    }
+    prefetched_.push_back(std::move(batch));
+    prefetch_cv_.notify_all();
+  }
+}
+
+void DBReader::TakePrefetched(size_t n, RecordBatch* batch) const {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  while (n > 0) {
+    prefetch_cv_.wait(
+        lock, [this] { return !prefetched_.empty() || prefetch_error_; });
+    if (prefetched_.empty()) {
+      std::rethrow_exception(prefetch_error_);
+    }
+    const RecordBatch& front = prefetched_.front();
+    for (; n > 0 && prefetched_offset_ < front.size(); --n) {
+      batch->Add(front, prefetched_offset_++);
+    }
+    if (prefetched_offset_ == front.size()) {
+      prefetched_.pop_front();
+      prefetched_offset_ = 0;
+      prefetch_cv_.notify_all();
+    }
+  }
+}
+
+string DBReader::NextKey() const {
+  std::lock_guard<std::mutex> mutex_lock(reader_mutex_);
+  if (prefetch_thread_.joinable()) {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    if (!prefetched_.empty()) {
+      return string(prefetched_.front().key(prefetched_offset_));
+    }
+  }
+  return cursor_->key();
+}
+
 // Below, we provide a bare minimum database "minidb" as a reference
 // implementation as well as a portable choice to store data.
 // Note that the MiniDB classes are not exposed via a header file - they should
@@ -183,7 +316,7 @@ void DBReaderSerializer::Serialize(
   proto.set_source(reader.source_);
   proto.set_db_type(reader.db_type_);
   if (reader.cursor() && reader.cursor()->SupportsSeek()) {
-    proto.set_key(reader.cursor()->key());
+    proto.set_key(reader.NextKey());
   }
   BlobProto blob_proto;
   blob_proto.set_name(name);
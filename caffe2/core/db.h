@@ -1,9 +1,14 @@
 #ifndef CAFFE2_CORE_DB_H_
 #define CAFFE2_CORE_DB_H_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
 
 #include "c10/util/Registry.h"
+#include "c10/util/string_view.h"
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/proto/caffe2_pb.h"
 
@@ -16,6 +21,74 @@ namespace db {
  */
 enum Mode { READ, WRITE, NEW };
 
+/**
+ * A batch of records read with Cursor::ReadBatch() or DBReader::ReadBatch().
+ *
+ * Keys and values are views. A db whose records stay where they are while the
+ * cursor lives, like the memory map of LMDB, adds views into its own memory
+ * and nothing is copied. Other dbs add copies, which the batch owns and reuses
+ * for the next batch once it is cleared.
+ */
+class CAFFE2_API RecordBatch {
+ public:
+  size_t size() const {
+    return records_.size();
+  }
+  c10::string_view key(size_t i) const {
+    const Record& record = records_[i];
+    return record.copy < 0 ? record.key
+                           : c10::string_view(copies_[record.copy].first);
+  }
+  c10::string_view value(size_t i) const {
+    const Record& record = records_[i];
+    return record.copy < 0 ? record.value
+                           : c10::string_view(copies_[record.copy].second);
+  }
+  void Clear() {
+    records_.clear();
+    num_copies_ = 0;
+  }
+  /**
+   * Adds a record that stays valid while the cursor it was read from lives.
+   */
+  void AddView(c10::string_view key, c10::string_view value) {
+    records_.push_back({key, value, -1});
+  }
+  /**
+   * Adds a copy of a record that is only valid until the cursor moves.
+   */
+  void AddCopy(c10::string_view key, c10::string_view value) {
+    if (num_copies_ == copies_.size()) {
+      copies_.emplace_back();
+    }
+    copies_[num_copies_].first.assign(key.data(), key.size());
+    copies_[num_copies_].second.assign(value.data(), value.size());
+    records_.push_back({{}, {}, static_cast<int64_t>(num_copies_++)});
+  }
+  /**
+   * Adds the i-th record of another batch, which may be cleared afterwards.
+   */
+  void Add(const RecordBatch& other, size_t i) {
+    if (other.records_[i].copy < 0) {
+      records_.push_back(other.records_[i]);
+    } else {
+      AddCopy(other.key(i), other.value(i));
+    }
+  }
+
+ private:
+  struct Record {
+    c10::string_view key;
+    c10::string_view value;
+    // The index of the copy of the record, or -1 for a view.
+    int64_t copy;
+  };
+
+  vector<Record> records_;
+  vector<std::pair<string, string>> copies_;
+  size_t num_copies_ = 0;
+};
+
 /**
  * An abstract class for the cursor of the database while reading.
  */
@@ -51,6 +124,13 @@ class CAFFE2_API Cursor {
    * reached the end of the database, return false.
    */
   virtual bool Valid() = 0;
+  /**
+   * Appends up to n records, starting with the current one, to the batch and
+   * moves past them. Returns the number of records added, which is less than
+   * n only if the end of the database was reached. In default, the records
+   * are copied one by one through key() and value().
+   */
+  virtual size_t ReadBatch(size_t n, RecordBatch* batch);
 
   C10_DISABLE_COPY_AND_ASSIGN(Cursor);
 };
@@ -175,6 +255,10 @@ class CAFFE2_API DBReader {
     cursor_ = db_->NewCursor();
   }
 
+  ~DBReader() {
+    StopPrefetch();
+  }
+
   void Open(
       const string& db_type,
       const string& source,
@@ -182,6 +266,7 @@ class CAFFE2_API DBReader {
       const int32_t shard_id = 0) {
     // Note(jiayq): resetting is needed when we re-open e.g. leveldb where no
     // concurrent access is allowed.
+    StopPrefetch();
     cursor_.reset();
     db_.reset();
     db_type_ = db_type;
@@ -201,6 +286,7 @@ class CAFFE2_API DBReader {
       unique_ptr<DB>&& db,
       const int32_t num_shards = 1,
       const int32_t shard_id = 0) {
+    StopPrefetch();
     cursor_.reset();
     db_.reset();
     db_ = std::move(db);
@@ -227,6 +313,13 @@ class CAFFE2_API DBReader {
    */
   void Read(string* key, string* value) const {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    if (prefetch_thread_.joinable()) {
+      RecordBatch batch;
+      TakePrefetched(1, &batch);
+      *key = string(batch.key(0));
+      *value = string(batch.value(0));
+      return;
+    }
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
     *key = cursor_->key();
     *value = cursor_->value();
@@ -241,6 +334,27 @@ class CAFFE2_API DBReader {
     }
   }
 
+  /**
+   * Reads the next n records into the batch, the same records that n calls
+   * to Read() would return, and moves past them. The batch is cleared first,
+   * and the records stay valid until it is cleared again, or the reader is
+   * reopened or destroyed. Thread safe: the records of a batch are
+   * consecutive.
+   */
+  void ReadBatch(size_t n, RecordBatch* batch) const;
+
+  /**
+   * Starts a thread that reads batches of batch_size records ahead, while
+   * the callers of Read() and ReadBatch() work on the records they got, and
+   * keeps up to depth of them. This is meant for sequential scans: the
+   * records are read in the same order as without prefetching, but the
+   * cursor runs ahead of them. Prefetching stops when the reader is reopened.
+   * Stopping it seeks the cursor back to the next record that wasn't taken,
+   * if the db supports seeking, and drops the records read ahead otherwise.
+   */
+  void StartPrefetch(size_t batch_size, size_t depth = 2);
+  void StopPrefetch();
+
   /**
    * @brief Seeks to the first key. Thread safe.
    */
@@ -248,6 +362,13 @@ class CAFFE2_API DBReader {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
     MoveToBeginning();
+    if (prefetch_thread_.joinable()) {
+      // Drop the batches read before the seek.
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      prefetched_.clear();
+      prefetched_offset_ = 0;
+      prefetch_cv_.notify_all();
+    }
   }
 
   /**
@@ -274,6 +395,15 @@ class CAFFE2_API DBReader {
     SeekToFirst();
   }
 
+  // Appends the next n records to the batch, wrapping around at the end of
+  // the db. Must be called with reader_mutex_.
+  void ReadRecords(size_t n, RecordBatch* batch) const;
+  // Appends the next n prefetched records to the batch.
+  void TakePrefetched(size_t n, RecordBatch* batch) const;
+  void PrefetchLoop();
+  // The key of the next record Read() returns.
+  string NextKey() const;
+
   void MoveToBeginning() const {
     cursor_->SeekToFirst();
     for (uint32_t s = 0; s < shard_id_; s++) {
@@ -291,6 +421,20 @@ class CAFFE2_API DBReader {
   uint32_t num_shards_{};
   uint32_t shard_id_{};
 
+  // See StartPrefetch(). The prefetch thread holds reader_mutex_ while it
+  // reads a batch and queues it with prefetch_mutex_, and an error it runs
+  // into is raised by the next read.
+  std::thread prefetch_thread_;
+  size_t prefetch_batch_size_{};
+  size_t prefetch_depth_{};
+  bool stop_prefetch_{false};
+  mutable std::mutex prefetch_mutex_;
+  mutable std::condition_variable prefetch_cv_;
+  mutable std::deque<RecordBatch> prefetched_;
+  std::exception_ptr prefetch_error_;
+  // The number of records of the front batch that were taken.
+  mutable size_t prefetched_offset_{};
+
   C10_DISABLE_COPY_AND_ASSIGN(DBReader);
 };
 
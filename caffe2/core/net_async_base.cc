@@ -1,5 +1,9 @@
 #include "caffe2/core/net_async_base.h"
 
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "caffe2/core/net_async_tracing.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/timer.h"
@@ -51,6 +55,12 @@ C10_DEFINE_bool(
     false,
     "Use per net thread pools");
 
+C10_DEFINE_string(
+    caffe2_net_async_cpu_thread_pool,
+    "CPU",
+    "ThreadPoolRegistry key of the CPU thread pools: CPU, or CPUWorkStealing"
+    " for nets with many small ops");
+
 C10_DEFINE_bool(
     caffe2_net_async_run_root_tasks_inline,
     false,
@@ -109,6 +119,11 @@ AsyncNetBase::AsyncNetBase(
   if (tracer_) {
     LOG(INFO) << "Tracing net: " << net_def->name();
   }
+
+  if (options_.free_intermediate_blobs_) {
+    blob_releaser_ =
+        std::make_unique<TaskBlobReleaser>(*net_def, ws, operators_, chains_);
+  }
 }
 
 bool AsyncNetBase::handleRunError() {
@@ -157,7 +172,7 @@ TaskThreadPoolBase* AsyncNetBase::poolGetter(
   auto pool = pools[device_id][pool_size];
   if (!pool) {
     pool = c10::ThreadPoolRegistry()->Create(
-        DeviceTypeName(device_type),
+        ThreadPoolRegistryKey(device_type),
         device_id,
         pool_size,
         options_.use_per_net_pools_);
@@ -366,6 +381,9 @@ void AsyncNetBase::reset() {
     task_op_node.runtime_parent_count_ = parents(task_id).size();
     task_op_node.scheduled_.clear();
   }
+  if (blob_releaser_) {
+    blob_releaser_->Reset();
+  }
 
   success_ = true;
 }
@@ -593,6 +611,10 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "free_intermediate_blobs") {
+      CAFFE_ENFORCE(arg.has_i(), "free_intermediate_blobs should be an int");
+      free_intermediate_blobs_ = arg.i() == 1;
+    }
   }
 
   if (FLAGS_caffe2_net_async_profile_operators) {
@@ -601,6 +623,101 @@ ExecutionOptions::ExecutionOptions(
   run_root_tasks_inline_ = FLAGS_caffe2_net_async_run_root_tasks_inline;
 }
 
+std::string ThreadPoolRegistryKey(int device_type) {
+  if (IsCPUDeviceType(device_type)) {
+    return FLAGS_caffe2_net_async_cpu_thread_pool;
+  }
+  return DeviceTypeName(device_type);
+}
+
+TaskBlobReleaser::TaskBlobReleaser(
+    const NetDef& net_def,
+    Workspace* ws,
+    const std::vector<OperatorBase*>& operators,
+    const std::vector<std::vector<int>>& chains) {
+  task_blobs_.resize(chains.size());
+  for (const auto& op_def : net_def.op()) {
+    for (const auto& arg : op_def.arg()) {
+      if (arg.has_n() || arg.nets_size() > 0) {
+        VLOG(1) << "Not freeing blobs of net " << net_def.name()
+                << ", op " << op_def.type() << " runs a nested net";
+        return;
+      }
+    }
+  }
+
+  std::unordered_set<std::string> produced;
+  std::unordered_set<std::string> consumed;
+  for (const auto& op_def : net_def.op()) {
+    produced.insert(op_def.output().begin(), op_def.output().end());
+    consumed.insert(op_def.input().begin(), op_def.input().end());
+  }
+  std::unordered_set<std::string> kept(
+      net_def.external_input().begin(), net_def.external_input().end());
+  kept.insert(
+      net_def.external_output().begin(), net_def.external_output().end());
+
+  // the intermediate blobs each task uses
+  std::vector<std::set<std::string>> task_names(chains.size());
+  for (size_t task_id = 0; task_id < chains.size(); ++task_id) {
+    bool is_sync = true;
+    for (auto op_id : chains[task_id]) {
+      const auto* op = operators[op_id];
+      is_sync &= IsCPUDeviceType(op->device_option().device_type()) &&
+          !op->HasAsyncPart();
+      const auto& op_def = net_def.op(op_id);
+      for (const auto* names : {&op_def.input(), &op_def.output()}) {
+        for (const auto& name : *names) {
+          if (produced.count(name) && consumed.count(name) &&
+              !kept.count(name)) {
+            task_names[task_id].insert(name);
+          }
+        }
+      }
+    }
+    if (!is_sync) {
+      kept.insert(task_names[task_id].begin(), task_names[task_id].end());
+    }
+  }
+
+  std::unordered_map<std::string, int> blob_ids;
+  for (size_t task_id = 0; task_id < chains.size(); ++task_id) {
+    for (const auto& name : task_names[task_id]) {
+      if (kept.count(name)) {
+        continue;
+      }
+      auto it = blob_ids.find(name);
+      if (it == blob_ids.end()) {
+        auto* blob = ws->GetBlob(name);
+        CAFFE_ENFORCE(blob, "Blob does not exist: ", name);
+        it = blob_ids.emplace(name, blobs_.size()).first;
+        blobs_.push_back(blob);
+        init_counts_.push_back(0);
+      }
+      ++init_counts_[it->second];
+      task_blobs_[task_id].push_back(it->second);
+    }
+  }
+  counts_.reset(new std::atomic<int>[blobs_.size()]);
+  VLOG(1) << "Net " << net_def.name() << " frees " << blobs_.size()
+          << " intermediate blobs";
+  Reset();
+}
+
+void TaskBlobReleaser::Reset() {
+  for (size_t i = 0; i < blobs_.size(); ++i) {
+    counts_[i] = init_counts_[i];
+  }
+}
+
+void TaskBlobReleaser::TaskFinished(int task_id) {
+  for (auto blob_id : task_blobs_[task_id]) {
+    if (--counts_[blob_id] == 0) {
+      blobs_[blob_id]->Reset();
+    }
+  }
+}
+
 } // namespace caffe2
 
 namespace c10 {
@@ -609,6 +726,12 @@ C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CPU,
     caffe2::GetAsyncNetThreadPool<TaskThreadPool, caffe2::PROTO_CPU>);
+C10_REGISTER_CREATOR(
+    ThreadPoolRegistry,
+    CPUWorkStealing,
+    caffe2::GetAsyncNetThreadPool<
+        WorkStealingTaskThreadPool,
+        caffe2::PROTO_CPU>);
 C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CUDA,
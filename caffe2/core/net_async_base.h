@@ -24,6 +24,7 @@ C10_DECLARE_bool(caffe2_net_async_use_single_pool);
 C10_DECLARE_bool(caffe2_net_async_use_per_net_pools);
 C10_DECLARE_bool(caffe2_net_async_run_root_tasks_inline);
 C10_DECLARE_bool(caffe2_net_async_profile_operators);
+C10_DECLARE_string(caffe2_net_async_cpu_thread_pool);
 
 namespace caffe2 {
 
@@ -55,6 +56,53 @@ struct ExecutionOptions {
   bool use_dfs_scheduling_ = false;
   // run net's root tasks in RunAsync thread instead of in thread pool
   bool run_root_tasks_inline_ = false;
+  // free intermediate blobs once all their tasks finished, see
+  // TaskBlobReleaser
+  bool free_intermediate_blobs_ = false;
+};
+
+// TaskBlobReleaser frees the intermediate blobs of an async net during a run,
+// like SimpleRefCountNet does for sequential nets. A blob is intermediate if it
+// is both produced and consumed by the ops of the net and is neither an
+// external input nor an external output. Each such blob is counted once for
+// every task that reads or writes it, and is reset when the last of these
+// tasks has finished, so that the order of the frees follows the task graph
+// rather than the op order.
+//
+// Blobs used by tasks that finish asynchronously (non-CPU devices, ops with
+// an async part) are kept, since the end of such a task isn't known when it
+// returns. Nothing is freed in nets with ops that run nested nets, which can
+// use blobs that aren't listed as op inputs.
+//
+// As with SimpleRefCountNet, the intermediate blobs are no longer visible in
+// the workspace after a run; it is enabled with the free_intermediate_blobs
+// net argument.
+class CAFFE2_API TaskBlobReleaser {
+ public:
+  TaskBlobReleaser(
+      const NetDef& net_def,
+      Workspace* ws,
+      const std::vector<OperatorBase*>& operators,
+      const std::vector<std::vector<int>>& chains);
+
+  // Prepares the counts for a new run
+  void Reset();
+
+  // Called once the task has finished in the current run
+  void TaskFinished(int task_id);
+
+  size_t NumBlobs() const {
+    return blobs_.size();
+  }
+
+ private:
+  std::vector<Blob*> blobs_;
+  std::vector<int> init_counts_;
+  std::unique_ptr<std::atomic<int>[]> counts_;
+  // indices into blobs_, per task
+  std::vector<std::vector<int>> task_blobs_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(TaskBlobReleaser);
 };
 
 class CAFFE2_API AsyncNetBase : public NetBase {
@@ -152,6 +200,9 @@ class CAFFE2_API AsyncNetBase : public NetBase {
   // Tracing
   std::shared_ptr<tracing::Tracer> tracer_;
 
+  // set if options_.free_intermediate_blobs_
+  std::unique_ptr<TaskBlobReleaser> blob_releaser_;
+
   // execution mode flags
   ExecutionOptions options_;
 
@@ -180,6 +231,11 @@ class AsyncNetExecutorHelper : public ExecutorHelper {
   AsyncNetBase* net_;
 };
 
+// The ThreadPoolRegistry key of the pools for a device type. CPU pools can be
+// switched to the work stealing pool, CPUWorkStealing, by
+// --caffe2_net_async_cpu_thread_pool.
+CAFFE2_API std::string ThreadPoolRegistryKey(int device_type);
+
 template <class TaskThreadPoolImpl, int device_type>
 std::shared_ptr<TaskThreadPoolBase>
 GetAsyncNetThreadPool(int device_id, int pool_size, bool create_new) {
@@ -56,6 +56,12 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
         }
       }
 
+      // Once the task ran, or was skipped because of a failure, it doesn't
+      // use its blobs anymore
+      if (blob_releaser_) {
+        blob_releaser_->TaskFinished(task_id);
+      }
+
       if (options_.report_stats_) {
         try {
           auto last_op_id = lastTaskOpId(task_id);
@@ -123,6 +123,11 @@ AsyncTaskFuture* AsyncTaskGraph::GetFuture() {
   return run_future_.get();
 }
 
+AsyncTaskFuture* AsyncTaskGraph::GetTaskFuture(int node_id) {
+  CAFFE_ENFORCE(nodes_.count(node_id));
+  return &nodes_[node_id]->GetFuture();
+}
+
 void AsyncTaskGraph::Reset() {
   CAFFE_ENFORCE(frozen_);
   for (auto& kv : nodes_) {
@@ -33,6 +33,9 @@ class AsyncTaskGraphBase {
 
   virtual AsyncTaskFuture* GetFuture() = 0;
 
+  // Future of a single node, completed when the node's task finishes
+  virtual AsyncTaskFuture* GetTaskFuture(int node_id) = 0;
+
   virtual void Reset() = 0;
 
   virtual ~AsyncTaskGraphBase() noexcept {}
@@ -53,6 +56,8 @@ class AsyncTaskGraph : public AsyncTaskGraphBase {
 
   AsyncTaskFuture* GetFuture() override;
 
+  AsyncTaskFuture* GetTaskFuture(int node_id) override;
+
   void Reset() override;
 
  private:
@@ -69,6 +69,19 @@ ParallelNet::ParallelNet(
     }
     CAFFE_ENFORCE(task_graph_->CreateNode(chain_id, ops));
   }
+
+  // The callbacks that free blobs are set before the graph's own, so that
+  // the blobs of the last tasks are freed by the time the run completes
+  if (options_.free_intermediate_blobs_) {
+    blob_releaser_ =
+        std::make_unique<TaskBlobReleaser>(*net_def, ws, operators_, chains);
+    for (auto chain_id = 0; chain_id < chains.size(); ++chain_id) {
+      task_graph_->GetTaskFuture(chain_id)->SetCallback(
+          [this, chain_id](const AsyncTaskFuture* /* unused */) {
+            blob_releaser_->TaskFinished(chain_id);
+          });
+    }
+  }
   for (auto chain_id = 0; chain_id < chain_nodes.size(); ++chain_id) {
     if (!chain_nodes[chain_id].parents_.empty()) {
       CAFFE_ENFORCE(
@@ -112,6 +125,9 @@ void ParallelNet::Wait() {
 
 void ParallelNet::reset() {
   task_graph_->Reset();
+  if (blob_releaser_) {
+    blob_releaser_->Reset();
+  }
 }
 
 bool ParallelNet::handleRunError() {
@@ -133,7 +149,7 @@ TaskThreadPoolBase* ParallelNet::poolGetter(
   auto pool = pools[device_id][pool_size];
   if (!pool) {
     pool = c10::ThreadPoolRegistry()->Create(
-        DeviceTypeName(device_type),
+        ThreadPoolRegistryKey(device_type),
         device_id,
         pool_size,
         options_.use_per_net_pools_);
@@ -37,6 +37,9 @@ class CAFFE2_API ParallelNet : public NetBase {
   std::vector<dag_utils::OperatorNode> operator_nodes_;
   std::vector<OperatorBase*> operators_;
 
+  // set if options_.free_intermediate_blobs_
+  std::unique_ptr<TaskBlobReleaser> blob_releaser_;
+
   std::mutex pools_mutex_;
   typedef std::unordered_map<
       int,
@@ -66,5 +66,48 @@ TEST(NetSimpleRefCountTest, TestCorrectness) {
   EXPECT_EQ(ws.GetBlob("e")->Get<int32_t>(), 4);
 }
 
+// The same net as above, run by an async net that frees its intermediate
+// blobs once the tasks using them finished.
+void testAsyncNetFreesBlobs(const std::string& net_type) {
+  Workspace ws;
+  *(ws.CreateBlob("a")->GetMutable<int32_t>()) = 1;
+  NetDef net_def;
+  net_def.set_type(net_type);
+  net_def.set_num_workers(2);
+  auto* arg = net_def.add_arg();
+  arg->set_name("free_intermediate_blobs");
+  arg->set_i(1);
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("NetSimpleRefCountTest", "", {"a"}, {"b"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("NetSimpleRefCountTest", "", {"b"}, {"c"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("NetSimpleRefCountTest", "", {"b"}, {"d"}));
+  net_def.add_op()->CopyFrom(
+      CreateOperatorDef("NetSimpleRefCountTest", "", {"c"}, {"e"}));
+  net_def.add_external_output("e");
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  // The blobs have to be recreated by every run
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(net->Run());
+    ASSERT_TRUE(ws.GetBlob("a")->IsType<int32_t>());
+    EXPECT_EQ(ws.GetBlob("a")->Get<int32_t>(), 1);
+    EXPECT_EQ(ws.GetBlob("b")->GetRaw(), nullptr);
+    EXPECT_EQ(ws.GetBlob("c")->GetRaw(), nullptr);
+    ASSERT_TRUE(ws.GetBlob("d")->IsType<int32_t>());
+    EXPECT_EQ(ws.GetBlob("d")->Get<int32_t>(), 3);
+    ASSERT_TRUE(ws.GetBlob("e")->IsType<int32_t>());
+    EXPECT_EQ(ws.GetBlob("e")->Get<int32_t>(), 4);
+  }
+}
+
+TEST(NetSimpleRefCountTest, TestAsyncSchedulingNet) {
+  testAsyncNetFreesBlobs("async_scheduling");
+}
+
+TEST(NetSimpleRefCountTest, TestParallelNet) {
+  testAsyncNetFreesBlobs("parallel");
+}
+
 } // namespace
 } // namespace caffe2
@@ -74,15 +74,12 @@ vector<string> Workspace::LocalBlobs() const {
   for (auto& entry : blob_map_) {
     names.push_back(entry.first);
   }
+  std::sort(names.begin(), names.end());
   return names;
 }
 
 vector<string> Workspace::Blobs() const {
-  vector<string> names;
-  names.reserve(blob_map_.size());
-  for (auto& entry : blob_map_) {
-    names.push_back(entry.first);
-  }
+  vector<string> names = LocalBlobs();
   for (const auto& forwarded : forwarded_blobs_) {
     const auto parent_ws = forwarded.second.first;
     const auto& parent_name = forwarded.second.second;
@@ -98,27 +95,32 @@ vector<string> Workspace::Blobs() const {
 }
 
 Blob* Workspace::CreateBlob(const string& name) {
-  if (HasBlob(name)) {
+  if (const Blob* blob = FindBlob(name)) {
     VLOG(1) << "Blob " << name << " already exists. Skipping.";
-  } else if (forwarded_blobs_.count(name)) {
+    return const_cast<Blob*>(blob);
+  }
+  const auto it = forwarded_blobs_.find(name);
+  if (it != forwarded_blobs_.end()) {
     // possible if parent workspace deletes forwarded blob
     VLOG(1) << "Blob " << name << " is already forwarded from parent workspace "
-            << "(blob " << forwarded_blobs_[name].second << "). Skipping.";
-  } else {
-    VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+            << "(blob " << it->second.second << "). Skipping.";
+    return GetBlob(name);
   }
-  return GetBlob(name);
+  VLOG(1) << "Creating blob " << name;
+  auto& blob = blob_map_[name];
+  blob.reset(new Blob());
+  return blob.get();
 }
 
 Blob* Workspace::CreateLocalBlob(const string& name) {
-  if (blob_map_.count(name)) {
+  auto& blob = blob_map_[name];
+  if (blob) {
     VLOG(1) << "Blob " << name << " already exists. Skipping.";
   } else {
     VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+    blob.reset(new Blob());
   }
-  return GetBlob(name);
+  return blob.get();
 }
 
 Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
@@ -157,15 +159,26 @@ bool Workspace::RemoveBlob(const string& name) {
   return false;
 }
 
+const Blob* Workspace::FindBlob(const string& name) const {
+  const auto it = blob_map_.find(name);
+  if (it != blob_map_.end()) {
+    return it->second.get();
+  }
+  const auto forwarded = forwarded_blobs_.find(name);
+  if (forwarded != forwarded_blobs_.end()) {
+    const auto parent_ws = forwarded->second.first;
+    const auto& parent_name = forwarded->second.second;
+    return parent_ws->FindBlob(parent_name);
+  }
+  if (shared_) {
+    return shared_->FindBlob(name);
+  }
+  return nullptr;
+}
+
 const Blob* Workspace::GetBlob(const string& name) const {
-  if (blob_map_.count(name)) {
-    return blob_map_.at(name).get();
-  } else if (forwarded_blobs_.count(name)) {
-    const auto parent_ws = forwarded_blobs_.at(name).first;
-    const auto& parent_name = forwarded_blobs_.at(name).second;
-    return parent_ws->GetBlob(parent_name);
-  } else if (shared_ && shared_->HasBlob(name)) {
-    return shared_->GetBlob(name);
+  if (const Blob* blob = FindBlob(name)) {
+    return blob;
   }
   LOG(WARNING) << "Blob " << name << " not in the workspace.";
   // TODO(Yangqing): do we want to always print out the list of blobs here?
@@ -301,6 +314,9 @@ bool Workspace::RunPlan(const PlanDef& plan, ShouldContinue shouldContinue) {
 }
 
 ThreadPool* Workspace::GetThreadPool() {
+  if (auto* pool = ThreadPool::sharedThreadPool()) {
+    return pool;
+  }
   std::lock_guard<std::mutex> guard(thread_pool_creation_mutex_);
   if (!thread_pool_) {
     thread_pool_ = ThreadPool::defaultThreadPool();
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "c10/util/Registry.h"
+#include "c10/util/flat_hash_map.h"
 #include "caffe2/core/blob.h"
 #include "caffe2/core/net.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -47,7 +48,9 @@ struct CAFFE2_API StopOnSignal {
 class CAFFE2_API Workspace {
  public:
   typedef std::function<bool(int)> ShouldContinue;
-  typedef CaffeMap<string, unique_ptr<Blob> > BlobMap;
+  // Blobs are looked up by name on every operator and net creation, so they
+  // live in a hash map. Blobs() and LocalBlobs() still return sorted names.
+  typedef ska::flat_hash_map<string, unique_ptr<Blob>> BlobMap;
   typedef CaffeMap<string, unique_ptr<NetBase> > NetMap;
   /**
    * Initializes an empty workspace.
@@ -177,18 +180,7 @@ class CAFFE2_API Workspace {
    * Checks if a blob with the given name is present in the current workspace.
    */
   inline bool HasBlob(const string& name) const {
-    // First, check the local workspace,
-    // Then, check the forwarding map, then the parent workspace
-    if (blob_map_.count(name)) {
-      return true;
-    } else if (forwarded_blobs_.count(name)) {
-      const auto parent_ws = forwarded_blobs_.at(name).first;
-      const auto& parent_name = forwarded_blobs_.at(name).second;
-      return parent_ws->HasBlob(parent_name);
-    } else if (shared_) {
-      return shared_->HasBlob(name);
-    }
-    return false;
+    return FindBlob(name) != nullptr;
   }
 
   void PrintBlobSizes();
@@ -280,7 +272,9 @@ class CAFFE2_API Workspace {
   /*
    * Returns a CPU threadpool instance for parallel execution of
    * work. The threadpool is created lazily; if no operators use it,
-   * then no threadpool will be created.
+   * then no threadpool will be created. If a process-wide pool was set with
+   * ThreadPool::setSharedThreadPoolGetter() (ATen sets its intra-op pool),
+   * that pool is returned instead.
    */
   ThreadPool* GetThreadPool();
 
@@ -318,6 +312,11 @@ class CAFFE2_API Workspace {
 
   static std::shared_ptr<Bookkeeper> bookkeeper();
 
+  // Looks up a blob in the local workspace, then in the forwarding map, then
+  // in the shared workspace, with one lookup in each. Returns nullptr if the
+  // blob doesn't exist.
+  const Blob* FindBlob(const string& name) const;
+
   BlobMap blob_map_;
   const string root_folder_;
   const Workspace* shared_;
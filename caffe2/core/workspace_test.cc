@@ -114,6 +114,20 @@ TEST(WorkspaceTest, BlobMapping) {
   }
 }
 
+TEST(WorkspaceTest, BlobNames) {
+  Workspace parent;
+  EXPECT_TRUE(parent.CreateBlob("z"));
+  Workspace child(&parent);
+  for (const auto& name : {"c", "a", "b"}) {
+    EXPECT_TRUE(child.CreateBlob(name));
+  }
+  EXPECT_EQ(child.LocalBlobs(), std::vector<string>({"a", "b", "c"}));
+  EXPECT_EQ(child.Blobs(), std::vector<string>({"a", "b", "c", "z"}));
+  EXPECT_TRUE(child.RenameBlob("a", "d"));
+  EXPECT_FALSE(child.HasBlob("a"));
+  EXPECT_EQ(child.LocalBlobs(), std::vector<string>({"b", "c", "d"}));
+}
+
 /**
  * Checks that Workspace::ForEach(f) applies f on  the specified set of
  * workspaces in any order.
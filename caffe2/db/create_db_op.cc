@@ -3,7 +3,20 @@
 namespace caffe2 {
 REGISTER_CPU_OPERATOR(CreateDB, CreateDBOp<CPUContext>);
 
-OPERATOR_SCHEMA(CreateDB).NumInputs(0).NumOutputs(1);
+OPERATOR_SCHEMA(CreateDB)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("db_type", "(string, default \"leveldb\") The type of the db")
+    .Arg("db", "(string) The path of the db")
+    .Arg("num_shards", "(int, default 1) The number of shards of the db")
+    .Arg("shard_id", "(int, default 0) The shard to read")
+    .Arg(
+        "prefetch_batch_size",
+        "(int, default 0) If positive, a thread reads batches of this many "
+        "records ahead of the readers, for sequential scans")
+    .Arg(
+        "prefetch_depth",
+        "(int, default 2) The number of batches read ahead");
 
 NO_GRADIENT(CreateDB);
 }  // namespace caffe2
@@ -196,5 +196,82 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+static void DBReadBatchTestWrapper(const string& db_type) {
+  std::string name = std::tmpnam(nullptr);
+  if (!CreateAndFill(db_type, name)) {
+    EXPECT_TRUE(0);
+    return;
+  }
+  RecordBatch batch;
+  {
+    std::unique_ptr<DB> db(CreateDB(db_type, name, READ));
+    std::unique_ptr<Cursor> cursor(db->NewCursor());
+    EXPECT_EQ(cursor->ReadBatch(4, &batch), 4);
+    EXPECT_EQ(batch.size(), 4);
+    EXPECT_EQ(batch.key(0), "00");
+    EXPECT_EQ(batch.value(3), "03");
+    EXPECT_EQ(cursor->key(), "04");
+    // The batch stops at the end of the db, and the records read before stay
+    // valid.
+    EXPECT_EQ(cursor->ReadBatch(100, &batch), kMaxItems - 4);
+    EXPECT_FALSE(cursor->Valid());
+    EXPECT_EQ(batch.size(), kMaxItems);
+    EXPECT_EQ(batch.key(1), "01");
+    EXPECT_EQ(batch.key(kMaxItems - 1), "09");
+  }
+
+  // The reader wraps around like Read().
+  DBReader reader(db_type, name);
+  reader.ReadBatch(12, &batch);
+  EXPECT_EQ(batch.size(), 12);
+  EXPECT_EQ(batch.key(9), "09");
+  EXPECT_EQ(batch.key(10), "00");
+  EXPECT_EQ(batch.value(11), "01");
+  string key;
+  string value;
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "02");
+
+  DBReader sharded_reader(db_type, name, 3, 1);
+  sharded_reader.ReadBatch(4, &batch);
+  EXPECT_EQ(batch.key(0), "01");
+  EXPECT_EQ(batch.key(1), "04");
+  EXPECT_EQ(batch.key(2), "07");
+  EXPECT_EQ(batch.key(3), "01");
+
+  // Prefetching reads the same records, and the reader is still saved at
+  // the next record it returns.
+  reader.SeekToFirst();
+  reader.StartPrefetch(3);
+  reader.ReadBatch(5, &batch);
+  EXPECT_EQ(batch.key(0), "00");
+  EXPECT_EQ(batch.key(4), "04");
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "05");
+  EXPECT_EQ(value, "05");
+  Blob reader_blob;
+  reader_blob.ShareExternal<DBReader>(&reader);
+  BlobProto blob_proto;
+  CHECK(blob_proto.ParseFromString(SerializeBlob(reader_blob, "reader")));
+  DBReaderProto proto;
+  CHECK(proto.ParseFromString(blob_proto.content()));
+  EXPECT_EQ(proto.key(), "06");
+  reader.SeekToFirst();
+  reader.ReadBatch(11, &batch);
+  EXPECT_EQ(batch.key(0), "00");
+  EXPECT_EQ(batch.key(10), "00");
+  reader.StopPrefetch();
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "01");
+}
+
+TEST(DBReadBatchTest, LevelDB) {
+  DBReadBatchTestWrapper("leveldb");
+}
+
+TEST(DBReadBatchTest, LMDB) {
+  DBReadBatchTestWrapper("lmdb");
+}
+
 }  // namespace db
 }  // namespace caffe2
@@ -70,7 +70,23 @@ class LMDBCursor : public Cursor {
 
   bool Valid() override { return valid_; }
 
+  size_t ReadBatch(size_t n, RecordBatch* batch) override {
+    // The cursor reads in a read-only transaction, whose records stay in the
+    // memory map until it ends, so they don't need to be copied.
+    size_t count = 0;
+    for (; count < n && valid_; ++count) {
+      batch->AddView(View(mdb_key_), View(mdb_value_));
+      Next();
+    }
+    return count;
+  }
+
  private:
+  static c10::string_view View(const MDB_val& mdb_val) {
+    return c10::string_view(
+        static_cast<const char*>(mdb_val.mv_data), mdb_val.mv_size);
+  }
+
   void SeekLMDB(MDB_cursor_op op) {
     int mdb_status = mdb_cursor_get(mdb_cursor_, &mdb_key_, &mdb_value_, op);
     if (mdb_status == MDB_NOTFOUND) {
@@ -134,6 +134,12 @@ The dimension of the output image will always be cropxcrop
         "decode_threads",
         "Number of CPU decode/transform threads."
         " Defaults to 4")
+    .Arg(
+        "dct_downscale",
+        "1 to let the JPEG decoder downscale images by 2, 4 or 8 while "
+        "decoding when their shortest side stays at least scale. Only used "
+        "with scale, without scale jitter and without bounding boxes. "
+        "Defaults to 0")
     .Arg("output_type", "If gpu_transform, can set to FLOAT or FLOAT16.")
     .Arg("db", "Name of the database (if not passed as input)")
     .Arg(
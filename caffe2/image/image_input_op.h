@@ -75,19 +75,23 @@ class ImageInputOp final : public PrefetchOperator<Context> {
   using PerImageArg = struct { BoundingBox bounding_params; };
 
   bool GetImageAndLabelAndInfoFromDBValue(
-      const string& value,
+      c10::string_view value,
       cv::Mat* img,
       PerImageArg& info,
       int item_id,
       std::mt19937* randgen);
+  cv::Mat DecodeEncodedImage(
+      const char* data,
+      int size,
+      const PerImageArg& info);
   void DecodeAndTransform(
-      const std::string& value,
+      c10::string_view value,
       float* image_data,
       int item_id,
       const int channels,
       std::size_t thread_index);
   void DecodeAndTransposeOnly(
-      const std::string& value,
+      c10::string_view value,
       uint8_t* image_data,
       int item_id,
       const int channels,
@@ -98,6 +102,7 @@ class ImageInputOp final : public PrefetchOperator<Context> {
 
   unique_ptr<db::DBReader> owned_reader_;
   const db::DBReader* reader_;
+  db::RecordBatch records_;
   Tensor prefetched_image_;
   Tensor prefetched_label_;
   vector<Tensor> prefetched_additional_outputs_;
@@ -135,6 +140,9 @@ class ImageInputOp final : public PrefetchOperator<Context> {
   bool is_test_;
   bool use_caffe_datum_;
   bool gpu_transform_;
+  // Let the JPEG decoder downscale by 2, 4 or 8 in the DCT domain when the
+  // image is later scaled down to scale_ anyway
+  bool dct_downscale_;
   bool mean_std_copied_ = false;
 
   // thread pool for parse + decode
@@ -205,6 +213,8 @@ ImageInputOp<Context>::ImageInputOp(
       gpu_transform_(OperatorBase::template GetSingleArgument<int>(
           "use_gpu_transform",
           0)),
+      dct_downscale_(
+          OperatorBase::template GetSingleArgument<int>("dct_downscale", 0)),
       num_decode_threads_(
           OperatorBase::template GetSingleArgument<int>("decode_threads", 4)),
       additional_output_sizes_(
@@ -339,6 +349,14 @@ ImageInputOp<Context>::ImageInputOp(
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
   }
+  if (dct_downscale_) {
+    if (scale_ > 0 && scale_jitter_type_ == NO_SCALE_JITTER) {
+      LOG(INFO) << "    Downscaling JPEGs while decoding when possible";
+    } else {
+      LOG(INFO) << "    Ignoring dct_downscale, which needs scale and no "
+                   "scale jitter";
+    }
+  }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
             << (color_ ? "color " : "grayscale ") << "image;";
@@ -445,9 +463,95 @@ bool RandomSizedCropping(cv::Mat* img, const int crop, std::mt19937* randgen) {
   return inception_scale_jitter;
 }
 
+// Reads the size of a baseline or progressive JPEG from its SOF segment
+// without decoding it. Returns false if `data` is not a JPEG or the header
+// is truncated.
+inline bool GetJpegSize(const char* data, int size, int* height, int* width) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+  if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+    return false;
+  }
+  int pos = 2;
+  while (pos + 4 <= size) {
+    if (bytes[pos] != 0xFF) {
+      return false;
+    }
+    const unsigned char marker = bytes[pos + 1];
+    if (marker == 0xFF) {
+      // fill byte
+      ++pos;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      // markers without a payload
+      pos += 2;
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA) {
+      // end of image or start of scan before any frame header
+      return false;
+    }
+    const int length = (bytes[pos + 2] << 8) | bytes[pos + 3];
+    // SOF0 - SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      if (pos + 9 > size) {
+        return false;
+      }
+      *height = (bytes[pos + 5] << 8) | bytes[pos + 6];
+      *width = (bytes[pos + 7] << 8) | bytes[pos + 8];
+      return true;
+    }
+    pos += 2 + length;
+  }
+  return false;
+}
+
+template <class Context>
+cv::Mat ImageInputOp<Context>::DecodeEncodedImage(
+    const char* data,
+    int size,
+    const PerImageArg& info) {
+  int flags = color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE;
+  // The image is going to be resized so that its shortest side is scale_, so
+  // decoding it at 1/2, 1/4 or 1/8 of its size loses nothing as long as the
+  // shortest side stays at least scale_. libjpeg does this in the DCT domain,
+  // which skips most of the decoding work. Bounding boxes are in the
+  // coordinates of the full image and Inception-style jitter picks crops
+  // relative to it, so neither is combined with a reduced decode.
+  int height, width;
+  if (dct_downscale_ && scale_ > 0 && scale_jitter_type_ == NO_SCALE_JITTER &&
+      !info.bounding_params.valid && GetJpegSize(data, size, &height, &width)) {
+    const int shortest_side = std::min(height, width);
+    if (shortest_side >= 8 * scale_) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+    } else if (shortest_side >= 4 * scale_) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+    } else if (shortest_side >= 2 * scale_) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+    }
+  }
+
+  cv::Mat src;
+  // count the number of exceptions from opencv imdecode
+  try {
+    // We use a cv::Mat to wrap the encoded data so we do not need a copy.
+    src = cv::imdecode(
+        cv::Mat(1, &size, CV_8UC1, const_cast<char*>(data)), flags);
+    if (src.rows == 0 || src.cols == 0) {
+      num_decode_errors_in_batch_++;
+      src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+    }
+  } catch (cv::Exception& e) {
+    num_decode_errors_in_batch_++;
+    src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+  }
+  return src;
+}
+
 template <class Context>
 bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
-    const string& value,
+    c10::string_view value,
     cv::Mat* img,
     PerImageArg& info,
     int item_id,
@@ -464,28 +568,13 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   if (use_caffe_datum_) {
     // The input is a caffe datum format.
     CaffeDatum datum;
-    CAFFE_ENFORCE(datum.ParseFromString(value));
+    CAFFE_ENFORCE(datum.ParseFromArray(value.data(), value.size()));
 
     prefetched_label_.mutable_data<int>()[item_id] = datum.label();
     if (datum.encoded()) {
       // encoded image in datum.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                datum.data().size(),
-                CV_8UC1,
-                const_cast<char*>(datum.data().data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeEncodedImage(
+          datum.data().data(), datum.data().size(), info);
     } else {
       // Raw image in datum.
       CAFFE_ENFORCE(datum.channels() == 3 || datum.channels() == 1);
@@ -515,7 +604,7 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   } else {
     // The input is a caffe2 format.
     TensorProtos protos;
-    CAFFE_ENFORCE(protos.ParseFromString(value));
+    CAFFE_ENFORCE(protos.ParseFromArray(value.data(), value.size()));
     const TensorProto& image_proto = protos.protos(0);
     const TensorProto& label_proto = protos.protos(1);
     // add handle protos
@@ -542,25 +631,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
       // encoded image string.
       DCHECK_EQ(image_proto.string_data_size(), 1);
       const string& encoded_image_str = image_proto.string_data(0);
-      int encoded_size = encoded_image_str.size();
-      // We use a cv::Mat to wrap the encoded str so we do not need a copy.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                &encoded_size,
-                CV_8UC1,
-                const_cast<char*>(encoded_image_str.data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeEncodedImage(
+          encoded_image_str.data(), encoded_image_str.size(), info);
     } else if (image_proto.data_type() == TensorProto::BYTE) {
       // raw image content.
       int src_c = (image_proto.dims_size() == 3) ? image_proto.dims(2) : 1;
@@ -1079,7 +1151,7 @@ void CropTransposeImage(
 // Intended as entry point for binding to thread pool
 template <class Context>
 void ImageInputOp<Context>::DecodeAndTransform(
-    const std::string& value,
+    c10::string_view value,
     float* image_data,
     int item_id,
     const int channels,
@@ -1118,7 +1190,7 @@ void ImageInputOp<Context>::DecodeAndTransform(
 
 template <class Context>
 void ImageInputOp<Context>::DecodeAndTransposeOnly(
-    const std::string& value,
+    c10::string_view value,
     uint8_t* image_data,
     int item_id,
     const int channels,
@@ -1166,12 +1238,10 @@ bool ImageInputOp<Context>::Prefetch() {
   prefetched_label_.mutable_data<int>();
   // Prefetching handled with a thread pool of "decode_threads" threads.
 
+  // read data. The records stay valid until the decode threads are done.
+  reader_->ReadBatch(batch_size_, &records_);
   for (int item_id = 0; item_id < batch_size_; ++item_id) {
-    std::string key, value;
-    cv::Mat img;
-
-    // read data
-    reader_->Read(&key, &value);
+    const c10::string_view value = records_.value(item_id);
 
     // determine label type based on first item
     if (item_id == 0) {
@@ -1179,7 +1249,7 @@ bool ImageInputOp<Context>::Prefetch() {
         prefetched_label_.mutable_data<int>();
       } else {
         TensorProtos protos;
-        CAFFE_ENFORCE(protos.ParseFromString(value));
+        CAFFE_ENFORCE(protos.ParseFromArray(value.data(), value.size()));
         TensorProto_DataType labeldt = protos.protos(1).data_type();
         if (labeldt == TensorProto::INT32) {
           prefetched_label_.mutable_data<int>();
@@ -1225,7 +1295,7 @@ bool ImageInputOp<Context>::Prefetch() {
       thread_pool_->runTaskWithID(std::bind(
           &ImageInputOp<Context>::DecodeAndTransposeOnly,
           this,
-          std::string(value),
+          value,
           image_data,
           item_id,
           channels,
@@ -1236,7 +1306,7 @@ bool ImageInputOp<Context>::Prefetch() {
       thread_pool_->runTaskWithID(std::bind(
           &ImageInputOp<Context>::DecodeAndTransform,
           this,
-          std::string(value),
+          value,
           image_data,
           item_id,
           channels,
@@ -0,0 +1,142 @@
+#include "roofline_observer.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator_schema.h"
+
+namespace caffe2 {
+
+namespace {
+
+bool sameShapes(
+    const std::vector<TensorShape>& a,
+    const std::vector<TensorShape>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].unknown_shape() != b[i].unknown_shape() ||
+        a[i].data_type() != b[i].data_type() ||
+        a[i].dims_size() != b[i].dims_size()) {
+      return false;
+    }
+    for (int d = 0; d < a[i].dims_size(); ++d) {
+      if (a[i].dims(d) != b[i].dims(d)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+RooflineStats& RooflineStats::operator+=(const RooflineStats& other) {
+  runs += other.runs;
+  time_ms += other.time_ms;
+  flops += other.flops;
+  bytes += other.bytes;
+  return *this;
+}
+
+RooflineOperatorObserver::RooflineOperatorObserver(
+    OperatorBase* subject,
+    RooflineObserver* /* unused */)
+    : ObserverBase<OperatorBase>(subject) {
+  if (subject && subject->has_debug_def()) {
+    schema_ = OpSchemaRegistry::Schema(subject->debug_def().type());
+    if (schema_ && !schema_->HasCostInferenceFunction()) {
+      schema_ = nullptr;
+    }
+  }
+}
+
+void RooflineOperatorObserver::updateCost() {
+  // Operators exported to c10 don't know their input shapes
+  if (!schema_ || !subject_->isLegacyOperator()) {
+    return;
+  }
+  auto shapes = subject_->InputTensorShapes();
+  if (stats_.runs > 0 && sameShapes(shapes, shapes_)) {
+    return;
+  }
+  cost_ = OpSchema::Cost();
+  bool all_good_shapes = true;
+  for (const auto& shape : shapes) {
+    all_good_shapes = all_good_shapes && !shape.unknown_shape();
+  }
+  if (all_good_shapes) {
+    try {
+      cost_ = schema_->InferCost(subject_->debug_def(), shapes);
+    } catch (const std::exception& e) {
+      VLOG(1) << "Cost inference of " << subject_->debug_def().type()
+              << " failed: " << e.what();
+    }
+  }
+  shapes_ = std::move(shapes);
+}
+
+void RooflineOperatorObserver::Start() {
+  updateCost();
+  start_time_ = timer_.MilliSeconds();
+}
+
+void RooflineOperatorObserver::Stop() {
+  stats_.time_ms += timer_.MilliSeconds() - start_time_;
+  ++stats_.runs;
+  stats_.flops += cost_.flops;
+  stats_.bytes += cost_.bytes_read + cost_.bytes_written + cost_.params_bytes;
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>> RooflineOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int rnn_order) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new RooflineOperatorObserver(subject, nullptr));
+}
+
+void RooflineObserver::Start() {
+  start_time_ = timer_.MilliSeconds();
+}
+
+void RooflineObserver::Stop() {
+  time_ms_ += timer_.MilliSeconds() - start_time_;
+  ++runs_;
+}
+
+RooflineStats RooflineObserver::net_stats() const {
+  RooflineStats stats;
+  for (const auto* observer : operator_observers_) {
+    stats += observer->stats();
+  }
+  stats.runs = runs_;
+  stats.time_ms = time_ms_;
+  return stats;
+}
+
+std::map<std::string, RooflineStats> RooflineObserver::op_type_stats() const {
+  std::map<std::string, RooflineStats> stats;
+  for (const auto* observer : operator_observers_) {
+    stats[observer->subject()->debug_def().type()] += observer->stats();
+  }
+  return stats;
+}
+
+std::string RooflineObserver::debugInfo() {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  const auto print = [&ss](const std::string& name, const RooflineStats& s) {
+    ss << name << ": " << s.runs << " runs, " << s.time_ms << " ms, "
+       << s.gflops_per_second() << " GFLOP/s, " << s.gbytes_per_second()
+       << " GB/s, " << s.arithmetic_intensity() << " FLOP/byte\n";
+  };
+  print("Net " + subject_->Name(), net_stats());
+  for (const auto& op_type : op_type_stats()) {
+    print(op_type.first, op_type.second);
+  }
+  return ss.str();
+}
+
+} // namespace caffe2
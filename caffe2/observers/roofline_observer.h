@@ -0,0 +1,112 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+/**
+ * Accumulated time and work of a set of operator runs. The work comes from
+ * the cost inference function of the operator schema, for the shapes the
+ * inputs had on each run, and is 0 for operators without one.
+ **/
+struct CAFFE2_API RooflineStats {
+  int64_t runs = 0;
+  double time_ms = 0;
+  double flops = 0;
+  // Inputs read, outputs written and parameters read.
+  double bytes = 0;
+
+  double gflops_per_second() const {
+    return time_ms > 0 ? 1.0e-6 * flops / time_ms : 0;
+  }
+  double gbytes_per_second() const {
+    return time_ms > 0 ? 1.0e-6 * bytes / time_ms : 0;
+  }
+  // FLOPs per byte moved. Ops below the machine balance (peak FLOP/s over
+  // peak bandwidth) are bound by memory, the others by compute.
+  double arithmetic_intensity() const {
+    return bytes > 0 ? flops / bytes : 0;
+  }
+
+  RooflineStats& operator+=(const RooflineStats& other);
+};
+
+class RooflineObserver;
+
+class CAFFE2_API RooflineOperatorObserver final
+    : public ObserverBase<OperatorBase> {
+ public:
+  explicit RooflineOperatorObserver(OperatorBase* subject) = delete;
+  explicit RooflineOperatorObserver(
+      OperatorBase* subject,
+      RooflineObserver* /* unused */);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+  const RooflineStats& stats() const {
+    return stats_;
+  }
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  void updateCost();
+
+  const OpSchema* schema_ = nullptr;
+  Timer timer_;
+  double start_time_ = 0;
+  RooflineStats stats_;
+
+  // The cost is only inferred again when the input shapes change.
+  std::vector<TensorShape> shapes_;
+  OpSchema::Cost cost_;
+};
+
+/**
+ * This observer reports the achieved GFLOP/s and GB/s of every operator of a
+ * net, aggregated by operator type, so that one can tell which operators are
+ * compute or bandwidth bound. Like TimeObserver it measures the time from the
+ * start to the end of Run() of an operator, which for asynchronous devices is
+ * not the time the kernels took.
+ **/
+class CAFFE2_API RooflineObserver final
+    : public OperatorAttachingNetObserver<
+          RooflineOperatorObserver,
+          RooflineObserver> {
+ public:
+  explicit RooflineObserver(NetBase* subject)
+      : OperatorAttachingNetObserver<RooflineOperatorObserver, RooflineObserver>(
+            subject,
+            this) {}
+
+  // Stats of the whole net, with the time of its runs rather than the sum
+  // of the operator times.
+  RooflineStats net_stats() const;
+
+  // Stats of the operators of the net, by operator type.
+  std::map<std::string, RooflineStats> op_type_stats() const;
+
+  std::string debugInfo() override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  Timer timer_;
+  double start_time_ = 0;
+  int64_t runs_ = 0;
+  double time_ms_ = 0;
+};
+
+} // namespace caffe2
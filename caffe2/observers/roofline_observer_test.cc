@@ -0,0 +1,124 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "roofline_observer.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+class RooflineTestOp final : public Operator<CPUContext> {
+ public:
+  using Operator<CPUContext>::Operator;
+  bool RunOnDevice() override {
+    Output(0, Input(0).sizes(), at::dtype<float>());
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(RooflineTestOp, RooflineTestOp);
+REGISTER_CPU_OPERATOR(RooflineTestNoCostOp, RooflineTestOp);
+
+OpSchema::Cost CostInferenceForRooflineTest(
+    const OperatorDef& /* unused */,
+    const vector<TensorShape>& inputs) {
+  uint64_t size = 1;
+  for (auto dim : inputs[0].dims()) {
+    size *= dim;
+  }
+  OpSchema::Cost c;
+  c.flops = 2 * size;
+  c.bytes_read = 4 * size;
+  c.bytes_written = 4 * size;
+  return c;
+}
+
+OPERATOR_SCHEMA(RooflineTestOp)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .CostInferenceFunction(CostInferenceForRooflineTest);
+OPERATOR_SCHEMA(RooflineTestNoCostOp).NumInputs(1).NumOutputs(1);
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws) {
+  NetDef net_def;
+  net_def.set_name("roofline_test");
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("RooflineTestOp");
+    op.add_input("in");
+    op.add_output("hidden");
+  }
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("RooflineTestOp");
+    op.add_input("hidden");
+    op.add_output("hidden2");
+  }
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("RooflineTestNoCostOp");
+    op.add_input("hidden2");
+    op.add_output("out");
+  }
+  net_def.add_external_input("in");
+  net_def.add_external_output("out");
+
+  return CreateNet(net_def, ws);
+}
+
+void SetInput(Workspace* ws, int64_t size) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob("in"), CPU);
+  tensor->Resize(size);
+  tensor->mutable_data<float>();
+}
+
+} // namespace
+
+TEST(RooflineObserverTest, AggregatesByOpType) {
+  Workspace ws;
+  SetInput(&ws, 100);
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  auto net_ob = std::make_unique<RooflineObserver>(net.get());
+  const auto* ob = net_ob.get();
+  net->AttachObserver(std::move(net_ob));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+
+  const auto stats = ob->op_type_stats();
+  ASSERT_EQ(stats.size(), 2);
+  const auto& with_cost = stats.at("RooflineTestOp");
+  EXPECT_EQ(with_cost.runs, 6);
+  EXPECT_EQ(with_cost.flops, 6 * 200);
+  EXPECT_EQ(with_cost.bytes, 6 * 800);
+  EXPECT_EQ(with_cost.arithmetic_intensity(), 0.25);
+  const auto& without_cost = stats.at("RooflineTestNoCostOp");
+  EXPECT_EQ(without_cost.runs, 3);
+  EXPECT_EQ(without_cost.flops, 0);
+  EXPECT_EQ(without_cost.bytes, 0);
+
+  const auto net_stats = ob->net_stats();
+  EXPECT_EQ(net_stats.runs, 3);
+  EXPECT_EQ(net_stats.flops, 6 * 200);
+  EXPECT_GE(net_stats.time_ms, with_cost.time_ms + without_cost.time_ms);
+}
+
+TEST(RooflineObserverTest, ShapeChange) {
+  Workspace ws;
+  SetInput(&ws, 100);
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  auto net_ob = std::make_unique<RooflineObserver>(net.get());
+  const auto* ob = net_ob.get();
+  net->AttachObserver(std::move(net_ob));
+  ASSERT_TRUE(net->Run());
+  SetInput(&ws, 10);
+  ASSERT_TRUE(net->Run());
+
+  const auto stats = ob->op_type_stats();
+  EXPECT_EQ(stats.at("RooflineTestOp").flops, 2 * (200 + 20));
+}
+
+} // namespace caffe2
@@ -192,7 +192,12 @@ print("Y:", workspace.FetchBlob("Y"))
         "source_blob_names",
         "*(type: List(string))* If set, used instead of output blob names to "
         "specify which blobs in the db shall be loaded. Must be the same "
-        "length as number of output blobs.");
+        "length as number of output blobs.")
+    .Arg(
+        "num_threads",
+        "*(type: int; default: 1)* Number of threads parsing and copying the "
+        "blobs read from the db(s). With more than one, the chunks of a CPU "
+        "tensor are deserialized in parallel.");
 
 OPERATOR_SCHEMA(Save)
     .NumInputs(1, INT_MAX)
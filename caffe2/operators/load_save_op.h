@@ -71,7 +71,9 @@ class LoadOp final : public Operator<Context> {
             this->template GetSingleArgument<bool>("allow_incomplete", false)),
         blob_names_(
             this->template GetRepeatedArgument<string>("source_blob_names")),
-        shape_(this->template GetRepeatedArgument<int64_t>("shape")) {
+        shape_(this->template GetRepeatedArgument<int64_t>("shape")),
+        num_threads_(this->template GetSingleArgument<int>("num_threads", 1)) {
+    CAFFE_ENFORCE_GE(num_threads_, 1, "num_threads has to be positive.");
     if (InputSize() == 0) {
       CAFFE_ENFORCE_GT(db_type_.size(), 0, "Must specify a db type.");
       if (db_names_.empty()) {
@@ -194,15 +196,35 @@ class LoadOp final : public Operator<Context> {
       Cursor* cursor,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
       int* total_loaded_blobs) {
+    std::unique_ptr<load_save_op_util::ParallelBlobLoader> loader;
+    if (num_threads_ > 1) {
+      // The device is resolved here, the current device of the
+      // deserializing threads is not the one of the op
+      std::function<void(BlobProto*)> prepare;
+      if (!keep_device_) {
+        BlobProto device_proto;
+        device_proto.mutable_tensor();
+        SetCurrentDevice(&device_proto);
+        const auto device_detail = device_proto.tensor().device_detail();
+        prepare = [device_detail](BlobProto* proto) {
+          if (proto->has_tensor()) {
+            *proto->mutable_tensor()->mutable_device_detail() = device_detail;
+          }
+        };
+      }
+      loader = make_unique<load_save_op_util::ParallelBlobLoader>(
+          num_threads_, blob_states, std::move(prepare));
+    }
     if (load_all_) {
-      extractAll(db_id, cursor, blob_states, total_loaded_blobs);
+      extractAll(db_id, cursor, blob_states, total_loaded_blobs, loader.get());
     } else {
       extractFrom(
           db_id,
           cursor,
           OperatorBase::Outputs(),
           blob_states,
-          total_loaded_blobs);
+          total_loaded_blobs,
+          loader.get());
     }
   }
 
@@ -210,7 +232,8 @@ class LoadOp final : public Operator<Context> {
       int db_id,
       Cursor* cursor,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
-      int* total_loaded_blobs) {
+      int* total_loaded_blobs,
+      load_save_op_util::ParallelBlobLoader* loader) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
     int loaded_blobs = 0;
     for (; cursor->Valid(); cursor->Next()) {
@@ -222,6 +245,10 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
+      if (loader) {
+        loader->Load(ws_->CreateBlob(key), key, cursor->value());
+        continue;
+      }
       BlobProto proto;
       CAFFE_ENFORCE(
           proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
@@ -234,6 +261,9 @@ class LoadOp final : public Operator<Context> {
       load_save_op_util::ProcessBlob(
           blob, proto, blob_states, key, &loaded_blobs);
     }
+    if (loader) {
+      loaded_blobs = loader->Wait();
+    }
     *total_loaded_blobs += loaded_blobs;
   }
 
@@ -242,7 +272,8 @@ class LoadOp final : public Operator<Context> {
       Cursor* cursor,
       const vector<Blob*>& outputs,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
-      int* total_loaded_blobs) {
+      int* total_loaded_blobs,
+      load_save_op_util::ParallelBlobLoader* loader) {
     CAFFE_ENFORCE(cursor);
     int loaded_blobs = 0;
     for (; cursor->Valid(); cursor->Next()) {
@@ -258,6 +289,15 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
+        if (loader) {
+          loader->Load(
+              outputs.at(output_indices_[key]), key, cursor->value());
+          // Blobs still being deserialized are only counted by Wait()
+          if (*total_loaded_blobs + loader->loaded_blobs() == OutputSize()) {
+            break;
+          }
+          continue;
+        }
         BlobProto proto;
         CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
         if (!keep_device_) {
@@ -275,6 +315,9 @@ class LoadOp final : public Operator<Context> {
         }
       }
     }
+    if (loader) {
+      loaded_blobs = loader->Wait();
+    }
 
     *total_loaded_blobs += loaded_blobs;
   }
@@ -294,6 +337,7 @@ class LoadOp final : public Operator<Context> {
   std::map<string, int> key_to_dbid_;
   std::vector<std::string> blob_names_;
   std::vector<int64_t> shape_;
+  int num_threads_;
 };
 
 template <class Context>
@@ -1,5 +1,7 @@
 #include "caffe2/operators/load_save_op_util.h"
 
+#include <algorithm>
+
 namespace caffe2 {
 namespace load_save_op_util {
 
@@ -18,22 +20,14 @@ std::string buildBlobNameFromDbKey(
   return key;
 }
 
-void ProcessBlob(
-    Blob* blob,
+namespace {
+
+void updateBlobState(
     const BlobProto& proto,
     std::unordered_map<std::string, BlobState>* blob_states_ptr,
     const std::string& key,
     int* loaded_blobs) {
   auto& blob_states = *blob_states_ptr;
-  if (blob_states.count(key) == 0) {
-    // We reset the blob so that any existing content is destroyed. This
-    // is to guarantee correct device placement: if we are deserializing
-    // into a TensorCUDA, without explicit Reset we might be loading data
-    // into an existing TensorCUDA that has pre-allocated memory on a
-    // different GPU.
-    blob->Reset();
-  }
-  DeserializeBlob(proto, blob);
   if (proto.has_content_num_chunks()) {
     if (!blob_states.count(key)) {
       blob_states[key] = BlobState(proto.content_num_chunks());
@@ -109,6 +103,158 @@ void ProcessBlob(
   }
 }
 
+} // namespace
+
+void ProcessBlob(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  if (blob_states_ptr->count(key) == 0) {
+    // We reset the blob so that any existing content is destroyed. This
+    // is to guarantee correct device placement: if we are deserializing
+    // into a TensorCUDA, without explicit Reset we might be loading data
+    // into an existing TensorCUDA that has pre-allocated memory on a
+    // different GPU.
+    blob->Reset();
+  }
+  DeserializeBlob(proto, blob);
+  updateBlobState(proto, blob_states_ptr, key, loaded_blobs);
+}
+
+ParallelBlobLoader::ParallelBlobLoader(
+    int num_threads,
+    std::unordered_map<std::string, BlobState>* blob_states,
+    std::function<void(BlobProto*)> prepare)
+    : blob_states_(blob_states),
+      prepare_(std::move(prepare)),
+      max_queued_(2 * std::max(num_threads, 1)) {
+  CAFFE_ENFORCE_GE(num_threads, 1);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+ParallelBlobLoader::~ParallelBlobLoader() {
+  stop();
+}
+
+void ParallelBlobLoader::stop() {
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex_);
+    stopped_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void ParallelBlobLoader::Load(
+    Blob* blob,
+    const std::string& key,
+    std::string value) {
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    CAFFE_ENFORCE(!stopped_, "Cannot load into a stopped ParallelBlobLoader");
+    queue_cv_.wait(lock, [this] { return queue_.size() < max_queued_; });
+    queue_.push_back(Job{blob, key, std::move(value)});
+    ++in_flight_;
+  }
+  queue_cv_.notify_all();
+}
+
+int ParallelBlobLoader::Wait() {
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    queue_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+  return loaded_blobs();
+}
+
+int ParallelBlobLoader::loaded_blobs() {
+  std::lock_guard<std::mutex> guard(state_mutex_);
+  return loaded_blobs_;
+}
+
+void ParallelBlobLoader::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    // Wakes up the producer, which may wait for room in the queue
+    queue_cv_.notify_all();
+    std::exception_ptr error;
+    try {
+      process(job);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> guard(queue_mutex_);
+      if (error && !error_) {
+        error_ = error;
+      }
+      --in_flight_;
+    }
+    queue_cv_.notify_all();
+  }
+}
+
+void ParallelBlobLoader::process(Job& job) {
+  BlobProto proto;
+  CAFFE_ENFORCE(proto.ParseFromString(job.value), "Couldn't parse Proto");
+  // The serialized proto can be as large as the tensor chunk
+  std::string().swap(job.value);
+  if (prepare_) {
+    prepare_(&proto);
+  }
+
+  const bool parallel = proto.has_tensor() &&
+      proto.tensor().data_type() != TensorProto_DataType_UNDEFINED &&
+      proto.tensor().device_detail().device_type() == PROTO_CPU;
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  if (!parallel) {
+    ProcessBlob(job.blob, proto, blob_states_, job.key, &loaded_blobs_);
+    return;
+  }
+
+  // The checks on the chunk are done before its data is copied, by the
+  // bookkeeping of ProcessBlob
+  const bool first_chunk = blob_states_->count(job.key) == 0;
+  updateBlobState(proto, blob_states_, job.key, &loaded_blobs_);
+  Tensor* tensor = nullptr;
+  if (first_chunk) {
+    job.blob->Reset();
+    tensor = BlobSetTensor(job.blob, EmptyTensorFromProto(proto.tensor()));
+    tensors_[job.key] = tensor;
+  } else {
+    auto it = tensors_.find(job.key);
+    CAFFE_ENFORCE(
+        it != tensors_.end(), "Blob was not loaded as a CPU tensor: ", job.key);
+    tensor = it->second;
+  }
+  lock.unlock();
+
+  // Chunks cover disjoint segments of the tensor, so that they can be copied
+  // at the same time
+  TensorDeserializer().DeserializeToTensor(proto.tensor(), tensor);
+}
+
 void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states) {
   for (const auto& iter : blob_states) {
@@ -1,9 +1,16 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "caffe2/core/blob.h"
 #include "caffe2/core/blob_serialization.h"
@@ -40,6 +47,65 @@ CAFFE2_API void ProcessBlob(
     const std::string& key,
     int* loaded_blobs);
 
+// Deserializes blobs read from a db on a pool of threads, for the bookkeeping
+// of ProcessBlob. A CPU tensor is allocated when its first chunk is seen, and
+// its chunks are then parsed and copied into it in parallel. Other blobs are
+// deserialized one at a time.
+class CAFFE2_API ParallelBlobLoader {
+ public:
+  // `prepare` is called on every proto after it's parsed, on the thread that
+  // deserializes it.
+  ParallelBlobLoader(
+      int num_threads,
+      std::unordered_map<std::string, BlobState>* blob_states,
+      std::function<void(BlobProto*)> prepare);
+  // Waits for the blobs queued so far, dropping their errors.
+  ~ParallelBlobLoader();
+
+  ParallelBlobLoader(const ParallelBlobLoader&) = delete;
+  ParallelBlobLoader& operator=(const ParallelBlobLoader&) = delete;
+
+  // Queues the serialized BlobProto `value` of `key`, to be loaded into
+  // `blob`. Blocks while too many values are queued, to bound the memory
+  // held by the queue.
+  void Load(Blob* blob, const std::string& key, std::string value);
+
+  // Waits for the blobs queued so far and rethrows the first error. Returns
+  // the number of blobs that were fully loaded.
+  int Wait();
+
+  // The number of blobs fully loaded so far.
+  int loaded_blobs();
+
+ private:
+  struct Job {
+    Blob* blob;
+    std::string key;
+    std::string value;
+  };
+
+  void workerLoop();
+  void process(Job& job);
+  void stop();
+
+  std::unordered_map<std::string, BlobState>* blob_states_;
+  std::function<void(BlobProto*)> prepare_;
+  const size_t max_queued_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<Job> queue_;
+  size_t in_flight_ = 0;
+  bool stopped_ = false;
+  std::exception_ptr error_;
+  std::vector<std::thread> workers_;
+
+  // Guards blob_states_, tensors_ and loaded_blobs_.
+  std::mutex state_mutex_;
+  std::unordered_map<std::string, Tensor*> tensors_;
+  int loaded_blobs_ = 0;
+};
+
 CAFFE2_API void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states);
 
@@ -0,0 +1,107 @@
+#include "caffe2/operators/ssd_embedding_ops.h"
+
+#ifndef _WIN32
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(CreateSSDEmbeddingTable, CreateSSDEmbeddingTableOp);
+REGISTER_CPU_OPERATOR(SSDSparseLengthsSum, SSDSparseLengthsSumOp<false>);
+REGISTER_CPU_OPERATOR(
+    SSDSparseLengthsWeightedSum,
+    SSDSparseLengthsSumOp<true>);
+REGISTER_CPU_OPERATOR(SSDRowWiseSparseAdagrad, SSDRowWiseSparseAdagradOp);
+REGISTER_CPU_OPERATOR(FlushSSDEmbeddingTable, FlushSSDEmbeddingTableOp);
+
+OPERATOR_SCHEMA(CreateSSDEmbeddingTable)
+    .NumInputs(0, 1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Creates an embedding table whose rows are stored in a file, with `cache_rows`
+of them cached in memory. The file holds the float rows one after the other.
+If `DATA` is given, the file is written from it first, otherwise it must hold
+`num_rows` rows of `block_size` floats already.
+
+Rows missing from the cache are read in one batch for each operator run, with
+`num_io_threads` threads, and rows are evicted with the CLOCK algorithm. Rows
+changed by SSDRowWiseSparseAdagrad are written back to the file when they are
+evicted, by FlushSSDEmbeddingTable and when the table is destroyed. This lets
+tables that don't fit in memory be trained and served from an SSD.
+)DOC")
+    .Input(0, "DATA", "(Optional) Initial rows of the table, a matrix.")
+    .Output(0, "table", "A blob pointing to the embedding table.")
+    .Arg("path", "(string) File holding the rows of the table.")
+    .Arg("num_rows", "(int) Number of rows, if DATA is not given.")
+    .Arg("block_size", "(int) Floats per row, if DATA is not given.")
+    .Arg(
+        "cache_rows",
+        "(int) Number of rows cached in memory. One operator run can't use "
+        "more distinct rows than that.")
+    .Arg(
+        "num_io_threads",
+        "(int, default 4) Threads reading and writing rows. With 0 or 1, the "
+        "operators do their reads and writes themselves.");
+
+OPERATOR_SCHEMA(SSDSparseLengthsSum)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Same as SparseLengthsSum, with the rows looked up in an embedding table created
+by CreateSSDEmbeddingTable.
+)DOC")
+    .Input(0, "TABLE", "The embedding table.")
+    .Input(1, "INDICES", "Integer vector of the rows to sum.")
+    .Input(2, "LENGTHS", "Vector of the number of rows in each segment.")
+    .Output(0, "OUTPUT", "Matrix of the sums of the segments.");
+
+OPERATOR_SCHEMA(SSDSparseLengthsWeightedSum)
+    .NumInputs(4)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Same as SparseLengthsWeightedSum, with the rows looked up in an embedding table
+created by CreateSSDEmbeddingTable.
+)DOC")
+    .Input(0, "TABLE", "The embedding table.")
+    .Input(1, "WEIGHT", "Vector of the weights of the rows.")
+    .Input(2, "INDICES", "Integer vector of the rows to sum.")
+    .Input(3, "LENGTHS", "Vector of the number of rows in each segment.")
+    .Output(0, "OUTPUT", "Matrix of the weighted sums of the segments.");
+
+OPERATOR_SCHEMA(SSDRowWiseSparseAdagrad)
+    .NumInputs(5)
+    .NumOutputs(1)
+    .EnforceInplace({{1, 0}})
+    .SetDoc(R"DOC(
+Same as RowWiseSparseAdagrad, updating the rows of an embedding table created
+by CreateSSDEmbeddingTable. The rows are updated in the cache and written back
+to the file later.
+)DOC")
+    .Input(0, "table", "The embedding table.")
+    .Input(1, "moment", "Moment history, one per row of the table.")
+    .Input(2, "indices", "Integer vector of the rows to update.")
+    .Input(3, "grad", "Gradient of the rows, one row per index.")
+    .Input(4, "lr", "learning rate")
+    .Output(0, "output_moment_1", "Updated moment")
+    .Arg("epsilon", "Default 1e-5");
+
+OPERATOR_SCHEMA(FlushSSDEmbeddingTable)
+    .NumInputs(1)
+    .NumOutputs(0)
+    .SetDoc(R"DOC(
+Writes the rows of an embedding table created by CreateSSDEmbeddingTable that
+changed back to its file.
+)DOC")
+    .Input(0, "table", "The embedding table.");
+
+SHOULD_NOT_DO_GRADIENT(CreateSSDEmbeddingTable);
+// The gradient of the rows, one per index, is the one LengthsSumGradient
+// computes. It goes to SSDRowWiseSparseAdagrad along with the indices.
+SHOULD_NOT_DO_GRADIENT(SSDSparseLengthsSum);
+SHOULD_NOT_DO_GRADIENT(SSDSparseLengthsWeightedSum);
+SHOULD_NOT_DO_GRADIENT(SSDRowWiseSparseAdagrad);
+SHOULD_NOT_DO_GRADIENT(FlushSSDEmbeddingTable);
+
+CAFFE_KNOWN_TYPE(SSDEmbeddingTablePtr);
+
+} // namespace caffe2
+
+#endif // _WIN32
@@ -0,0 +1,201 @@
+#ifndef CAFFE2_OPERATORS_SSD_EMBEDDING_OPS_H_
+#define CAFFE2_OPERATORS_SSD_EMBEDDING_OPS_H_
+
+#include <memory>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/ssd_embedding_table.h"
+#include "caffe2/perfkernels/adagrad.h"
+#include "caffe2/perfkernels/embedding_lookup.h"
+
+namespace caffe2 {
+
+using SSDEmbeddingTablePtr = std::unique_ptr<SSDEmbeddingTable>;
+
+class CreateSSDEmbeddingTableOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  template <class... Args>
+  explicit CreateSSDEmbeddingTableOp(Args&&... args)
+      : Operator<CPUContext>(std::forward<Args>(args)...),
+        path_(this->template GetSingleArgument<std::string>("path", "")),
+        num_rows_(this->template GetSingleArgument<int64_t>("num_rows", -1)),
+        block_size_(
+            this->template GetSingleArgument<int64_t>("block_size", -1)),
+        cache_rows_(
+            this->template GetSingleArgument<int64_t>("cache_rows", 0)),
+        num_io_threads_(
+            this->template GetSingleArgument<int>("num_io_threads", 4)) {
+    CAFFE_ENFORCE(!path_.empty(), "path must be given");
+    CAFFE_ENFORCE_GT(cache_rows_, 0, "cache_rows must be given");
+  }
+
+  bool RunOnDevice() override {
+    auto num_rows = num_rows_;
+    auto block_size = block_size_;
+    if (InputSize() == 1) {
+      // Start the table from the given rows
+      const auto& data = Input(0);
+      CAFFE_ENFORCE_EQ(data.dim(), 2, "DATA must be a matrix");
+      num_rows = data.size(0);
+      block_size = data.size(1);
+      SSDEmbeddingTable::WriteFile(
+          path_, data.template data<float>(), num_rows, block_size);
+    }
+    CAFFE_ENFORCE_GE(num_rows, 0, "num_rows must be given");
+    CAFFE_ENFORCE_GT(block_size, 0, "block_size must be given");
+    *OperatorBase::Output<SSDEmbeddingTablePtr>(0) =
+        SSDEmbeddingTablePtr(new SSDEmbeddingTable(
+            path_, num_rows, block_size, cache_rows_, num_io_threads_));
+    return true;
+  }
+
+ private:
+  std::string path_;
+  int64_t num_rows_;
+  int64_t block_size_;
+  int64_t cache_rows_;
+  int num_io_threads_;
+};
+
+template <bool USE_WEIGHT>
+class SSDSparseLengthsSumOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename IndexType>
+  bool DoRunWithType() {
+    auto& table = OperatorBase::Input<SSDEmbeddingTablePtr>(TABLE);
+    CAFFE_ENFORCE(table, "The embedding table wasn't created");
+    const auto& indices_input = Input(INDICES);
+    const auto& lengths_input = Input(LENGTHS);
+    CAFFE_ENFORCE_EQ(1, indices_input.dim(), "INDICES must be a vector");
+    CAFFE_ENFORCE_EQ(1, lengths_input.dim(), "LENGTHS must be a vector");
+    const int64_t N = indices_input.numel();
+    const int64_t M = lengths_input.numel();
+    const int64_t D = table->block_size();
+    const float* weights = nullptr;
+    if (USE_WEIGHT) {
+      const auto& weight_input = Input(WEIGHT);
+      CAFFE_ENFORCE_EQ(1, weight_input.dim(), "WEIGHT must be a vector");
+      CAFFE_ENFORCE_EQ(
+          weight_input.numel(),
+          N,
+          "WEIGHT should have the same length as INDICES.");
+      weights = weight_input.template data<float>();
+    }
+
+    auto* output = Output(0, {M, D}, at::dtype<float>());
+    slots_.resize(N);
+    std::lock_guard<std::mutex> guard(table->mutex());
+    table->Lookup(
+        indices_input.template data<IndexType>(), N, false, slots_.data());
+    // The rows are summed straight out of the cache slots
+    EmbeddingLookup<int64_t, float, float>(
+        D,
+        M,
+        N,
+        table->cache_rows(),
+        table->cache(),
+        slots_.data(),
+        lengths_input.template data<int>(),
+        weights,
+        nullptr,
+        false,
+        output->template mutable_data<float>());
+    return true;
+  }
+
+ private:
+  enum {
+    TABLE = 0,
+    WEIGHT = 1,
+    INDICES = 1 + USE_WEIGHT,
+    LENGTHS = 2 + USE_WEIGHT,
+  };
+
+  std::vector<int64_t> slots_;
+};
+
+class SSDRowWiseSparseAdagradOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  template <class... Args>
+  explicit SSDRowWiseSparseAdagradOp(Args&&... args)
+      : Operator<CPUContext>(std::forward<Args>(args)...),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename SIndex>
+  bool DoRunWithType() {
+    auto& table = OperatorBase::Input<SSDEmbeddingTablePtr>(TABLE);
+    CAFFE_ENFORCE(table, "The embedding table wasn't created");
+    CAFFE_ENFORCE_EQ(Input(MOMENT_1).numel(), table->num_rows());
+    CAFFE_ENFORCE_EQ(Input(LR).numel(), 1);
+    const auto n = Input(INDICES).numel();
+    const auto block_size = table->block_size();
+    CAFFE_ENFORCE_EQ(Input(GRAD).numel(), n * block_size);
+
+    const auto* lr = Input(LR).template data<float>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* grad = Input(GRAD).template data<float>();
+    // The update is done in place, the output is the input
+    auto* moment = Output(OUTPUT_MOMENT_1)->template mutable_data<float>();
+
+    slots_.resize(n);
+    std::lock_guard<std::mutex> guard(table->mutex());
+    table->Lookup(indices, n, true, slots_.data());
+    float* cache = table->mutable_cache();
+    const int64_t zero = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      // The parameters of a row are in its cache slot, its moment is
+      // indexed by the row
+      rowwise_sparse_adagrad(
+          1,
+          block_size,
+          block_size,
+          cache + slots_[i] * block_size,
+          grad + i * block_size,
+          moment + indices[i],
+          &zero,
+          epsilon_,
+          lr[0]);
+    }
+    return true;
+  }
+
+ private:
+  float epsilon_;
+  std::vector<int64_t> slots_;
+  INPUT_TAGS(TABLE, MOMENT_1, INDICES, GRAD, LR);
+  OUTPUT_TAGS(OUTPUT_MOMENT_1);
+};
+
+class FlushSSDEmbeddingTableOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    auto& table = OperatorBase::Input<SSDEmbeddingTablePtr>(0);
+    CAFFE_ENFORCE(table, "The embedding table wasn't created");
+    std::lock_guard<std::mutex> guard(table->mutex());
+    table->Flush();
+    return true;
+  }
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_SSD_EMBEDDING_OPS_H_
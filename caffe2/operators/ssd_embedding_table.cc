@@ -0,0 +1,301 @@
+#include "caffe2/operators/ssd_embedding_table.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "caffe2/core/logging.h"
+
+namespace caffe2 {
+
+namespace {
+
+// pread/pwrite may transfer fewer bytes than asked for
+template <typename F>
+bool transferAll(F f, char* buf, size_t size, off_t offset) {
+  while (size > 0) {
+    const auto n = f(buf, size, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    buf += n;
+    size -= n;
+    offset += n;
+  }
+  return true;
+}
+
+} // namespace
+
+SSDEmbeddingTable::SSDEmbeddingTable(
+    const std::string& path,
+    int64_t num_rows,
+    int64_t block_size,
+    int64_t cache_rows,
+    int num_io_threads)
+    : path_(path),
+      num_rows_(num_rows),
+      block_size_(block_size),
+      cache_rows_(cache_rows) {
+  CAFFE_ENFORCE_GT(block_size_, 0);
+  CAFFE_ENFORCE_GT(cache_rows_, 0);
+  CAFFE_ENFORCE_GE(num_io_threads, 0);
+  fd_ = open(path_.c_str(), O_RDWR);
+  CAFFE_ENFORCE_GE(
+      fd_, 0, "Cannot open embedding table ", path_, ": ", strerror(errno));
+  struct stat st;
+  CAFFE_ENFORCE_EQ(fstat(fd_, &st), 0, strerror(errno));
+  CAFFE_ENFORCE_EQ(
+      st.st_size,
+      num_rows_ * block_size_ * sizeof(float),
+      "Embedding table ",
+      path_,
+      " doesn't hold ",
+      num_rows_,
+      " rows of ",
+      block_size_,
+      " floats");
+
+  cache_.resize(cache_rows_ * block_size_);
+  row_to_slot_.reserve(cache_rows_);
+  slot_row_.assign(cache_rows_, -1);
+  slot_referenced_.assign(cache_rows_, 0);
+  slot_dirty_.assign(cache_rows_, 0);
+  slot_lookup_.assign(cache_rows_, -1);
+  if (num_io_threads > 1) {
+    io_pool_.reset(new c10::TaskThreadPool(num_io_threads));
+  }
+}
+
+SSDEmbeddingTable::~SSDEmbeddingTable() {
+  try {
+    Flush();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Cannot write back embedding table " << path_ << ": "
+               << e.what();
+  }
+  io_pool_.reset();
+  close(fd_);
+}
+
+void SSDEmbeddingTable::WriteFile(
+    const std::string& path,
+    const float* data,
+    int64_t num_rows,
+    int64_t block_size) {
+  const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  CAFFE_ENFORCE_GE(
+      fd, 0, "Cannot create embedding table ", path, ": ", strerror(errno));
+  const bool ok = transferAll(
+      [fd](char* buf, size_t size, off_t offset) {
+        return pwrite(fd, buf, size, offset);
+      },
+      reinterpret_cast<char*>(const_cast<float*>(data)),
+      num_rows * block_size * sizeof(float),
+      0);
+  const int err = errno;
+  close(fd);
+  CAFFE_ENFORCE(ok, "Cannot write embedding table ", path, ": ", strerror(err));
+}
+
+template <typename IndexType>
+void SSDEmbeddingTable::Lookup(
+    const IndexType* indices,
+    int64_t n,
+    bool dirty,
+    int64_t* slots) {
+  ++lookup_id_;
+  // Rows of this lookup that are not resident yet, and the rows that have to
+  // be written back before their slots are reused
+  std::vector<RowIO> reads;
+  std::vector<RowIO> writes;
+  try {
+    assignSlots(indices, n, dirty, slots, &reads, &writes);
+  } catch (...) {
+    // The rows that were not read yet leave the cache again, the rows to
+    // write back are still in their slots
+    for (const auto& r : reads) {
+      row_to_slot_.erase(r.row);
+      slot_row_[r.slot] = -1;
+      slot_dirty_[r.slot] = 0;
+    }
+    writeRows(&writes);
+    throw;
+  }
+  // A slot is reused at most once per lookup, so the rows are written back
+  // before other rows are read into their slots
+  writeRows(&writes);
+  readRows(&reads);
+}
+
+template <typename IndexType>
+void SSDEmbeddingTable::assignSlots(
+    const IndexType* indices,
+    int64_t n,
+    bool dirty,
+    int64_t* slots,
+    std::vector<RowIO>* reads,
+    std::vector<RowIO>* writes) {
+  for (int64_t i = 0; i < n; ++i) {
+    const int64_t row = indices[i];
+    CAFFE_ENFORCE(
+        0 <= row && row < num_rows_,
+        "Index ",
+        row,
+        " is out of bounds of embedding table ",
+        path_,
+        " of ",
+        num_rows_,
+        " rows");
+    int64_t slot;
+    const auto it = row_to_slot_.find(row);
+    if (it != row_to_slot_.end()) {
+      slot = it->second;
+      if (slot_lookup_[slot] != lookup_id_) {
+        ++hits_;
+      }
+    } else {
+      ++misses_;
+      slot = reclaimSlot();
+      const int64_t old_row = slot_row_[slot];
+      if (old_row >= 0) {
+        if (slot_dirty_[slot]) {
+          writes->push_back({old_row, slot});
+        }
+        row_to_slot_.erase(old_row);
+      }
+      slot_row_[slot] = row;
+      slot_dirty_[slot] = 0;
+      row_to_slot_.emplace(row, slot);
+      reads->push_back({row, slot});
+    }
+    slot_referenced_[slot] = 1;
+    slot_lookup_[slot] = lookup_id_;
+    slot_dirty_[slot] |= dirty;
+    slots[i] = slot;
+  }
+}
+
+template CAFFE2_API void SSDEmbeddingTable::Lookup<int32_t>(
+    const int32_t* indices,
+    int64_t n,
+    bool dirty,
+    int64_t* slots);
+template CAFFE2_API void SSDEmbeddingTable::Lookup<int64_t>(
+    const int64_t* indices,
+    int64_t n,
+    bool dirty,
+    int64_t* slots);
+
+void SSDEmbeddingTable::Flush() {
+  std::vector<RowIO> writes;
+  for (int64_t slot = 0; slot < cache_rows_; ++slot) {
+    if (slot_row_[slot] >= 0 && slot_dirty_[slot]) {
+      writes.push_back({slot_row_[slot], slot});
+      slot_dirty_[slot] = 0;
+    }
+  }
+  writeRows(&writes);
+}
+
+int64_t SSDEmbeddingTable::reclaimSlot() {
+  // Going around twice clears all referenced bits, so a slot is found unless
+  // all of them held rows of the current lookup
+  for (int64_t step = 0; step < 2 * cache_rows_; ++step) {
+    const int64_t slot = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % cache_rows_;
+    if (slot_lookup_[slot] == lookup_id_) {
+      continue;
+    }
+    if (slot_row_[slot] >= 0 && slot_referenced_[slot]) {
+      slot_referenced_[slot] = 0;
+      continue;
+    }
+    return slot;
+  }
+  CAFFE_THROW(
+      "A lookup of embedding table ",
+      path_,
+      " needs more than the ",
+      cache_rows_,
+      " rows of its cache");
+}
+
+void SSDEmbeddingTable::readRows(std::vector<RowIO>* rows) {
+  runIO(rows, false);
+}
+
+void SSDEmbeddingTable::writeRows(std::vector<RowIO>* rows) {
+  runIO(rows, true);
+}
+
+void SSDEmbeddingTable::runIO(std::vector<RowIO>* rows, bool write) {
+  if (rows->empty()) {
+    return;
+  }
+  // Sorted by row, the accesses of each thread go forward through the file
+  std::sort(rows->begin(), rows->end(), [](const RowIO& a, const RowIO& b) {
+    return a.row < b.row;
+  });
+  const size_t row_bytes = block_size_ * sizeof(float);
+  std::atomic<bool> ok{true};
+  const auto transfer = [this, rows, write, row_bytes, &ok](
+                            size_t begin, size_t end) {
+    for (size_t i = begin; i < end && ok; ++i) {
+      const auto& r = (*rows)[i];
+      char* buf = reinterpret_cast<char*>(cache_.data() + r.slot * block_size_);
+      const off_t offset = r.row * row_bytes;
+      const bool done = write
+          ? transferAll(
+                [this](char* b, size_t size, off_t o) {
+                  return pwrite(fd_, b, size, o);
+                },
+                buf,
+                row_bytes,
+                offset)
+          : transferAll(
+                [this](char* b, size_t size, off_t o) {
+                  return pread(fd_, b, size, o);
+                },
+                buf,
+                row_bytes,
+                offset);
+      if (!done) {
+        ok = false;
+      }
+    }
+  };
+
+  const size_t num_chunks =
+      io_pool_ ? std::min(io_pool_->size(), rows->size()) : 1;
+  if (num_chunks <= 1) {
+    transfer(0, rows->size());
+  } else {
+    const size_t chunk = (rows->size() + num_chunks - 1) / num_chunks;
+    for (size_t begin = 0; begin < rows->size(); begin += chunk) {
+      const size_t end = std::min(begin + chunk, rows->size());
+      io_pool_->run([&transfer, begin, end] { transfer(begin, end); });
+    }
+    io_pool_->waitWorkComplete();
+  }
+  CAFFE_ENFORCE(
+      ok,
+      "Cannot ",
+      write ? "write to" : "read from",
+      " embedding table ",
+      path_);
+}
+
+} // namespace caffe2
+
+#endif // _WIN32
@@ -0,0 +1,142 @@
+#ifndef CAFFE2_OPERATORS_SSD_EMBEDDING_TABLE_H_
+#define CAFFE2_OPERATORS_SSD_EMBEDDING_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "c10/core/thread_pool.h"
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * An embedding table of float rows stored in a file, of which a fixed number
+ * of rows is cached in memory.
+ *
+ * Row r of the table is stored at offset r * block_size * sizeof(float) of
+ * the file. Lookup() makes rows resident in the cache and returns the cache
+ * slot of each of them. The rows that miss are read from the file in one
+ * batch, split over num_io_threads threads. When the cache is full, slots are
+ * reclaimed with the CLOCK algorithm: a slot that was used since the hand last
+ * passed it gets a second chance. Rows marked dirty are written back to the
+ * file when their slot is reclaimed, on Flush() and on destruction.
+ *
+ * The table is not thread safe, callers hold mutex() while they look up rows
+ * and use the slots.
+ */
+class CAFFE2_API SSDEmbeddingTable {
+ public:
+  SSDEmbeddingTable(
+      const std::string& path,
+      int64_t num_rows,
+      int64_t block_size,
+      int64_t cache_rows,
+      int num_io_threads);
+  ~SSDEmbeddingTable();
+
+  // Writes num_rows x block_size floats to a new table file at path.
+  static void WriteFile(
+      const std::string& path,
+      const float* data,
+      int64_t num_rows,
+      int64_t block_size);
+
+  int64_t num_rows() const {
+    return num_rows_;
+  }
+  int64_t block_size() const {
+    return block_size_;
+  }
+  int64_t cache_rows() const {
+    return cache_rows_;
+  }
+
+  // The cache, cache_rows x block_size floats indexed by slot.
+  const float* cache() const {
+    return cache_.data();
+  }
+  float* mutable_cache() {
+    return cache_.data();
+  }
+
+  std::mutex& mutex() {
+    return mutex_;
+  }
+
+  // Makes the n rows resident and writes the slot of each of them to slots.
+  // The slots stay valid until the next call. If dirty is set, the rows are
+  // written back to the file once they leave the cache. The number of
+  // distinct rows can't exceed cache_rows.
+  template <typename IndexType>
+  void Lookup(const IndexType* indices, int64_t n, bool dirty, int64_t* slots);
+
+  // Writes all dirty rows back to the file.
+  void Flush();
+
+  // Number of rows looked up that were resident, and that were read.
+  int64_t hits() const {
+    return hits_;
+  }
+  int64_t misses() const {
+    return misses_;
+  }
+
+ private:
+  struct RowIO {
+    int64_t row;
+    int64_t slot;
+  };
+
+  // Assigns a slot to each row, and lists the rows to read into their slots
+  // and the evicted rows to write back from theirs.
+  template <typename IndexType>
+  void assignSlots(
+      const IndexType* indices,
+      int64_t n,
+      bool dirty,
+      int64_t* slots,
+      std::vector<RowIO>* reads,
+      std::vector<RowIO>* writes);
+
+  // Reclaims a slot that isn't used by the current lookup.
+  int64_t reclaimSlot();
+
+  // Reads (or writes) the rows from (or to) their slots, in row order.
+  void readRows(std::vector<RowIO>* rows);
+  void writeRows(std::vector<RowIO>* rows);
+  void runIO(std::vector<RowIO>* rows, bool write);
+
+  const std::string path_;
+  const int64_t num_rows_;
+  const int64_t block_size_;
+  const int64_t cache_rows_;
+  int fd_{-1};
+
+  std::vector<float> cache_;
+  std::unordered_map<int64_t, int64_t> row_to_slot_;
+  // Row held by each slot, or -1
+  std::vector<int64_t> slot_row_;
+  std::vector<uint8_t> slot_referenced_;
+  std::vector<uint8_t> slot_dirty_;
+  // Lookup that last used each slot, so that a lookup never reclaims the
+  // slots of its own rows
+  std::vector<int64_t> slot_lookup_;
+  int64_t lookup_id_{0};
+  int64_t clock_hand_{0};
+
+  std::unique_ptr<c10::TaskThreadPool> io_pool_;
+  std::mutex mutex_;
+
+  int64_t hits_{0};
+  int64_t misses_{0};
+
+  C10_DISABLE_COPY_AND_ASSIGN(SSDEmbeddingTable);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_SSD_EMBEDDING_TABLE_H_
@@ -27,8 +27,7 @@ class TensorProtosDBInput final : public PrefetchOperator<Context> {
   vector<Blob> prefetched_blobs_;
   int batch_size_;
   bool shape_inferred_ = false;
-  string key_;
-  string value_;
+  db::RecordBatch records_;
 };
 
 template <class Context>
@@ -47,9 +46,10 @@ bool TensorProtosDBInput<Context>::Prefetch() {
   if (batch_size_ == 0) {
     // We do not need to construct a batch. As a result, we will simply
     // deserialize everything into the target prefetched blob.
-    reader.Read(&key_, &value_);
+    reader.ReadBatch(1, &records_);
+    const auto value = records_.value(0);
     TensorProtos protos;
-    CAFFE_ENFORCE(protos.ParseFromString(value_));
+    CAFFE_ENFORCE(protos.ParseFromArray(value.data(), value.size()));
     CAFFE_ENFORCE(protos.protos_size() == OutputSize());
     for (int i = 0; i < protos.protos_size(); ++i) {
       if (protos.protos(i).has_device_detail()) {
@@ -62,10 +62,12 @@ bool TensorProtosDBInput<Context>::Prefetch() {
       //     CPU));
     }
   } else {
+    // Read the whole batch at once, the records are only parsed from there.
+    reader.ReadBatch(batch_size_, &records_);
     for (int item_id = 0; item_id < batch_size_; ++item_id) {
-      reader.Read(&key_, &value_);
+      const auto value = records_.value(item_id);
       TensorProtos protos;
-      CAFFE_ENFORCE(protos.ParseFromString(value_));
+      CAFFE_ENFORCE(protos.ParseFromArray(value.data(), value.size()));
       CAFFE_ENFORCE(protos.protos_size() == OutputSize());
       // Note: shape_inferred_ is ignored, we'll always get dimensions from
       // proto
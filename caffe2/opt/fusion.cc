@@ -2,6 +2,7 @@
 #include "caffe2/core/logging.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
 namespace opt {
@@ -121,5 +122,87 @@ void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
 
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
 
+// $$ Y = X W^T + b_{fc} + b_{add} $$
+// where $b_{add}$ is a constant broadcast along the last dimension, so the
+// Add is folded into the FC by replacing $b_{fc}$ with $b_{fc} + b_{add}$.
+bool fuseFCAddHelper(repr::NNModule* nn, caffe2::Workspace* ws) {
+  for (auto node_pair : repr::nn::dataIterator<repr::FC>(nn->dataFlow)) {
+    repr::NNGraph::NodeRef fcNode;
+    repr::FC* fc;
+    std::tie(fc, fcNode) = node_pair;
+
+    auto fcInputs = repr::nn::getInputs(fcNode);
+    NOM_REQUIRE_OR_CONT(fcInputs.size() == 3);
+    auto fcOutputs = repr::nn::getOutputs(fcNode);
+    NOM_REQUIRE_OR_CONT(fcOutputs.size() == 1);
+    auto output = fcOutputs.front();
+
+    auto consumers = repr::nn::getConsumers(output);
+    NOM_REQUIRE_OR_CONT(consumers.size() == 1);
+    auto addNode = consumers.front();
+    NOM_REQUIRE_OR_CONT(repr::nn::is<repr::NeuralNetOperator>(addNode));
+    auto add = repr::nn::get<repr::NeuralNetOperator>(addNode);
+    NOM_REQUIRE_OR_CONT(add->getAnnotation() != nullptr);
+    const auto& addDef =
+        dyn_cast<caffe2::Caffe2Annotation>(add->getAnnotation())
+            ->getOperatorDef();
+    NOM_REQUIRE_OR_CONT(addDef.type() == "Add");
+    // With an explicit axis, a legacy broadcast Add may not add along the
+    // last dimension.
+    NOM_REQUIRE_OR_CONT(!ArgumentHelper::HasArgument(addDef, "axis"));
+
+    auto addInputs = repr::nn::getInputs(addNode);
+    auto addOutputs = repr::nn::getOutputs(addNode);
+    NOM_REQUIRE_OR_CONT(addInputs.size() == 2 && addOutputs.size() == 1);
+    auto addBiasNode = addInputs[0] == output ? addInputs[1] : addInputs[0];
+    NOM_REQUIRE_OR_CONT(addBiasNode != output);
+    NOM_REQUIRE_OR_CONT(!repr::nn::hasProducer(addBiasNode));
+
+    // The FC bias is updated in place, so it must not be used elsewhere.
+    auto fcBiasNode = fcInputs[2];
+    NOM_REQUIRE_OR_CONT(!repr::nn::hasProducer(fcBiasNode));
+    NOM_REQUIRE_OR_CONT(repr::nn::getConsumers(fcBiasNode).size() == 1);
+
+    auto filterName = repr::nn::get<repr::Tensor>(fcInputs[1])->getName();
+    auto fcBiasName = repr::nn::get<repr::Tensor>(fcBiasNode)->getName();
+    auto addBiasName = repr::nn::get<repr::Tensor>(addBiasNode)->getName();
+    NOM_REQUIRE_OR_CONT(
+        ws->HasBlob(filterName) && ws->HasBlob(fcBiasName) &&
+        ws->HasBlob(addBiasName));
+    NOM_REQUIRE_OR_CONT(
+        BlobIsTensorType(*ws->GetBlob(fcBiasName), CPU) &&
+        BlobIsTensorType(*ws->GetBlob(addBiasName), CPU));
+    const auto& filterTensor = ws->GetBlob(filterName)->Get<TensorCPU>();
+    auto fcBiasTensor = BlobGetMutableTensor(ws->GetBlob(fcBiasName), CPU);
+    const auto& addBiasTensor = ws->GetBlob(addBiasName)->Get<TensorCPU>();
+    NOM_REQUIRE_OR_CONT(
+        fcBiasTensor->IsType<float>() && addBiasTensor.IsType<float>());
+
+    const auto n = filterTensor.size_to_dim(
+        filterTensor.canonical_axis_index(fc->getAxisW()));
+    NOM_REQUIRE_OR_CONT(fcBiasTensor->numel() == n);
+    NOM_REQUIRE_OR_CONT(addBiasTensor.dim() == 1 && addBiasTensor.numel() == n);
+
+    auto fcBiasData = fcBiasTensor->mutable_data<float>();
+    const auto addBiasData = addBiasTensor.data<float>();
+    for (int64_t i = 0; i < n; ++i) {
+      fcBiasData[i] += addBiasData[i];
+    }
+
+    nn->dataFlow.deleteNode(output);
+    nn->dataFlow.createEdge(fcNode, addOutputs.front());
+    nn->dataFlow.deleteNode(addNode);
+    return true;
+  }
+  return false;
+}
+
+void fuseFCAdd(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
+  while (fuseFCAddHelper(nn, ws)) {
+  }
+}
+
+REGISTER_WS_OPT_PASS_FROM_FUNC(FuseFCAdd, fuseFCAdd);
+
 } // namespace opt
 } // namespace caffe2
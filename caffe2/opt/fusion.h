@@ -27,6 +27,9 @@ using namespace nom;
 
 CAFFE2_API void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// Folds an Add of a constant vector into the bias of the FC it follows.
+CAFFE2_API void fuseFCAdd(repr::NNModule* nn, caffe2::Workspace* ws);
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
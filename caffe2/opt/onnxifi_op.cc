@@ -1,4 +1,8 @@
 #include "caffe2/opt/onnxifi_op.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "caffe2/operators/slice_op.h"
 #include "caffe2/opt/bound_shape_inferencer.h"
 
@@ -163,6 +167,46 @@ void BlobToTensorDescriptor(
   }
 }
 
+// The first dimension of a shape bounded at max_batch_size, bounded at
+// batch_size instead
+int64_t scaleFirstDim(
+    TensorBoundShape_DimType dim_type,
+    int64_t dim,
+    int64_t max_batch_size,
+    int64_t batch_size) {
+  switch (dim_type) {
+    case TensorBoundShape_DimType_BATCH:
+      return batch_size;
+    case TensorBoundShape_DimType_BATCH_OF_FEATURE_MAX:
+    case TensorBoundShape_DimType_BATCH_OF_FEATURE_MAX_DEFAULT:
+      return dim / max_batch_size * batch_size;
+    default:
+      return dim;
+  }
+}
+
+template <typename T>
+ShapeInfo rescaleShapeInfo(
+    const google::protobuf::RepeatedField<int32_t>& dim_type_data,
+    T* t,
+    int64_t max_batch_size,
+    int64_t batch_size) {
+  std::vector<TensorBoundShape::DimType> dim_types;
+  for (const auto d : dim_type_data) {
+    dim_types.push_back(static_cast<TensorBoundShape::DimType>(d));
+  }
+  if (t->dims_size() && !dim_types.empty()) {
+    t->set_dims(
+        0, scaleFirstDim(dim_types[0], t->dims(0), max_batch_size, batch_size));
+  }
+  TensorShape shape;
+  shape.set_data_type(t->data_type());
+  for (const auto d : t->dims()) {
+    shape.add_dims(d);
+  }
+  return ShapeInfo(dim_types, std::move(shape));
+}
+
 } // namespace
 
 template <>
@@ -198,6 +242,141 @@ OnnxifiOp<CPUContext>::buildInitializationList(
   return descs;
 }
 
+template <>
+void OnnxifiOp<CPUContext>::buildBatchBuckets(
+    Workspace* ws,
+    const std::vector<uint64_t>& property_pointers,
+    std::vector<int> batch_sizes) {
+  std::sort(batch_sizes.begin(), batch_sizes.end());
+  batch_sizes.erase(
+      std::unique(batch_sizes.begin(), batch_sizes.end()), batch_sizes.end());
+  CAFFE_ENFORCE_GT(batch_sizes.front(), 0, "Batch size buckets must be > 0");
+
+  for (const auto batch_size : batch_sizes) {
+    // Batches that don't fit in a smaller bucket run on the max_batch_size
+    // graph anyway
+    if (batch_size >= max_batch_size_) {
+      break;
+    }
+    NetDef net(netdef_);
+    ShapeInfoMap shape_info = input_shape_info_;
+    for (auto& arg : *net.mutable_arg()) {
+      if (arg.name() == "input_shape_info") {
+        for (auto& t : *arg.mutable_tensors()) {
+          shape_info[t.name()] = rescaleShapeInfo(
+              t.int32_data(), &t, max_batch_size_, batch_size);
+        }
+      } else if (arg.name() == "input_qshape_info") {
+        for (auto& t : *arg.mutable_qtensors()) {
+          auto info =
+              rescaleShapeInfo(t.data(), &t, max_batch_size_, batch_size);
+          info.is_quantized = true;
+          info.q_info.axis = t.axis();
+          info.q_info.scale.assign(t.scales().begin(), t.scales().end());
+          info.q_info.offset.assign(t.biases().begin(), t.biases().end());
+          shape_info[t.name()] = std::move(info);
+        }
+      }
+    }
+
+    BatchBucket bucket;
+    bucket.batch_size = batch_size;
+    std::string model_str;
+    net.SerializeToString(&model_str);
+    bucket.backend_graph = insertBackendGraph(
+        ws, property_pointers, batchBucketId(batch_size), model_str);
+
+    // The outputs of the graph are bounded by the bucket too
+    BoundShapeSpec spec(batch_size, max_seq_size_);
+    auto bound_shape_inferencer =
+        BoundShapeInferencerRegistry()->Create("C10", spec);
+    bound_shape_inferencer->InferBoundShapeAndType(net, shape_info, nullptr);
+    const auto& inferred_shape_info = bound_shape_inferencer->shape_info();
+    for (const auto& kv : output_shape_hints_) {
+      const auto& name = output_names_[kv.first];
+      const auto it = inferred_shape_info.find(name);
+      CAFFE_ENFORCE(
+          it != inferred_shape_info.end(),
+          "Cannot infer the shape of output ",
+          name,
+          " at batch size ",
+          batch_size);
+      TensorInfo info;
+      info.onnxifi_type = kv.second.onnxifi_type;
+      for (const auto d : it->second.shape.dims()) {
+        info.dims.push_back(d);
+      }
+      bucket.output_shape_hints.emplace(kv.first, std::move(info));
+    }
+    batch_buckets_.push_back(std::move(bucket));
+  }
+
+  // Find out which inputs get padded to the batch size of the bucket
+  std::unordered_set<std::string> batched_inputs;
+  for (const auto& arg : netdef_.arg()) {
+    if (arg.name() == "input_shape_info") {
+      for (const auto& t : arg.tensors()) {
+        if (t.int32_data_size() &&
+            t.int32_data(0) == TensorBoundShape_DimType_BATCH) {
+          batched_inputs.emplace(t.name());
+        }
+      }
+    } else if (arg.name() == "input_qshape_info") {
+      for (const auto& t : arg.qtensors()) {
+        if (t.data_size() && t.data(0) == TensorBoundShape_DimType_BATCH) {
+          batched_inputs.emplace(t.name());
+        }
+      }
+    }
+  }
+  for (const auto& input : input_names_) {
+    batched_inputs_.push_back(batched_inputs.count(input));
+    padded_inputs_.emplace_back(CPU);
+  }
+}
+
+template <>
+void OnnxifiOp<CPUContext>::selectBatchBucket() {
+  const BatchBucket* selected = nullptr;
+  if (InputSize() > nominal_batch_idx_ &&
+      !Input(nominal_batch_idx_).sizes().empty()) {
+    const auto batch_size = Input(nominal_batch_idx_).size(0);
+    for (const auto& bucket : batch_buckets_) {
+      if (bucket.batch_size >= batch_size) {
+        selected = &bucket;
+        break;
+      }
+    }
+  }
+  const auto& backend_graph =
+      selected ? selected->backend_graph : backend_graph_shared_ptr_;
+  backend_ = backend_graph->backend;
+  graph_ = backend_graph->graph;
+  current_batch_size_ = selected ? selected->batch_size : max_batch_size_;
+  current_output_shape_hints_ =
+      selected ? &selected->output_shape_hints : &output_shape_hints_;
+}
+
+template <>
+const Tensor& OnnxifiOp<CPUContext>::maybePadInput(int input_idx) {
+  const auto& input_tensor = Input(input_idx);
+  if (batch_buckets_.empty() || !batched_inputs_[input_idx] ||
+      input_tensor.dim() == 0 || input_tensor.size(0) >= current_batch_size_) {
+    return input_tensor;
+  }
+  auto dims = input_tensor.sizes().vec();
+  dims[0] = current_batch_size_;
+  auto& padded = padded_inputs_[input_idx];
+  ReinitializeTensor(
+      &padded, dims, at::dtype(input_tensor.dtype()).device(CPU));
+  auto* data =
+      static_cast<char*>(padded.raw_mutable_data(input_tensor.dtype()));
+  std::memcpy(data, input_tensor.raw_data(), input_tensor.nbytes());
+  std::memset(
+      data + input_tensor.nbytes(), 0, padded.nbytes() - input_tensor.nbytes());
+  return padded;
+}
+
 template <>
 void OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
   output_reshape_info_.skip = false;
@@ -206,15 +385,15 @@ void OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
     return;
   }
 
-  // Get the real batch size from nominal input. If it's equal to
-  // max_batch_size, mark that we don't need to adjust batch size and return.
+  // Get the real batch size from nominal input. If it's equal to the batch
+  // size of the graph, mark that we don't need to adjust batch size and return.
   // Otherwise, do a pass of shape inference to get the real shapes of the
   // outputs.
   const auto& t = Input(nominal_batch_idx_);
   const auto dims = t.sizes();
   CAFFE_ENFORCE(
       !t.sizes().empty(), input_names_[nominal_batch_idx_], " cannot be empty");
-  if (dims[0] == max_batch_size_) {
+  if (dims[0] == current_batch_size_) {
     output_reshape_info_.skip = true;
     return;
   }
@@ -301,9 +480,13 @@ void OnnxifiOp<CPUContext>::maybeAdjustOutputBatchSizes() {
 
 template <>
 bool OnnxifiOp<CPUContext>::RunOnDevice() {
+  if (!batch_buckets_.empty()) {
+    selectBatchBucket();
+  }
+
   CAFFE_ENFORCE_EQ(input_desc_.size(), InputSize());
   for (unsigned i = 0U; i < InputSize(); ++i) {
-    const auto& input_tensor = Input(i);
+    const auto& input_tensor = maybePadInput(i);
     const at::IntArrayRef tensor_dims = input_tensor.sizes();
     auto& tensor_descriptor = input_desc_[i];
     tensor_descriptor.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
@@ -446,6 +629,9 @@ OPERATOR_SCHEMA(Onnxifi)
     .Arg(
         "initializers",
         "Initialization pair indicating the mapping of the name between NetDef and ONNX model")
+    .Arg(
+        "batch_size_buckets",
+        "(list of ints, default empty) Batch sizes smaller than max_batch_size to lower the c2 model for, in addition to max_batch_size. Each run uses the smallest one that fits the batch of the inputs, padding the batched inputs with zeros")
     .Arg(
         "output_resize_hints",
         "A list of key/value pairs indicating which input index to look up for real batch size for the given max output batch size");
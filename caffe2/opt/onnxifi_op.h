@@ -33,6 +33,14 @@ class OnnxifiOp final : public Operator<Context> {
     bool skip{false};
   };
 
+  // A backend graph lowered for a batch size smaller than max_batch_size,
+  // with the output shapes it produces at that batch size
+  struct BatchBucket {
+    int batch_size{0};
+    onnx::SharedPtrBackendGraphInfo backend_graph;
+    std::unordered_map<int, TensorInfo> output_shape_hints;
+  };
+
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   explicit OnnxifiOp(const OperatorDef& operator_def, Workspace* ws)
@@ -42,7 +50,9 @@ class OnnxifiOp final : public Operator<Context> {
             this->template GetSingleArgument<int>("max_batch_size", 0)),
         max_seq_size_(this->template GetSingleArgument<int>("max_seq_size", 0)),
         nominal_batch_idx_(
-            this->template GetSingleArgument<int>("nominal_batch_idx", 0)) {
+            this->template GetSingleArgument<int>("nominal_batch_idx", 0)),
+        current_batch_size_(max_batch_size_),
+        current_output_shape_hints_(&output_shape_hints_) {
     lib_ = onnx::initOnnxifiLibrary();
     backend_graph_map_ptr_ = onnx::getOnnxBackendGraphMap();
     CAFFE_ENFORCE(lib_, "Cannot initialize ONNXIFI library");
@@ -64,8 +74,15 @@ class OnnxifiOp final : public Operator<Context> {
       input_desc_.push_back(onnxTensorDescriptorV1());
       input_desc_.back().name = input.c_str();
     }
-    all_offsets_.reserve(ws->Blobs().size());
-    all_scales_.reserve(ws->Blobs().size());
+    auto batch_size_buckets =
+        this->template GetRepeatedArgument<int>("batch_size_buckets");
+    CAFFE_ENFORCE(
+        batch_size_buckets.empty() || !use_onnx_,
+        "batch_size_buckets is only supported for c2 models");
+    // The quantization params of the weights are referenced by the
+    // descriptors of every graph we build, so they must not be reallocated
+    all_offsets_.reserve(ws->Blobs().size() * (batch_size_buckets.size() + 1));
+    all_scales_.reserve(ws->Blobs().size() * (batch_size_buckets.size() + 1));
     input_shapes_.resize(input_names_.size());
     output_shapes_.resize(output_names_.size());
     output_reshape_info_.begins.reserve(output_names_.size());
@@ -122,11 +139,21 @@ class OnnxifiOp final : public Operator<Context> {
     // cached backend and therefore there is no need to repeat the above
     // process.
     buildBackendAndGraph(ws, property_pointers, onnx_model_str);
+
+    // Lower the model once more for each batch size bucket, so that small
+    // batches don't have to run at max_batch_size
+    if (!batch_size_buckets.empty()) {
+      buildBatchBuckets(ws, property_pointers, batch_size_buckets);
+    }
   }
 
   ~OnnxifiOp() {
     backend_graph_shared_ptr_.reset();
     backend_graph_map_ptr_->remove(op_id_string_);
+    for (auto& bucket : batch_buckets_) {
+      bucket.backend_graph.reset();
+      backend_graph_map_ptr_->remove(batchBucketId(bucket.batch_size));
+    }
 #ifdef ONNXIFI_ENABLE_EXT
     traces_.reset();
 #endif
@@ -146,8 +173,8 @@ class OnnxifiOp final : public Operator<Context> {
  private:
   uint64_t SetOutputShapeAndType(int output_idx, std::vector<size_t>* dims) {
     uint64_t type = ONNXIFI_DATATYPE_FLOAT32;
-    const auto it = output_shape_hints_.find(output_idx);
-    if (it != output_shape_hints_.end()) {
+    const auto it = current_output_shape_hints_->find(output_idx);
+    if (it != current_output_shape_hints_->end()) {
       std::copy(
           it->second.dims.begin(),
           it->second.dims.end(),
@@ -172,7 +199,24 @@ class OnnxifiOp final : public Operator<Context> {
     op_id_string_ =
         this->template GetSingleArgument<std::string>("model_id", "") + ":" +
         this->template GetSingleArgument<std::string>("net_pos", "");
+    backend_graph_shared_ptr_ = insertBackendGraph(
+        ws, property_pointers, op_id_string_, onnx_model_str);
+
+    backend_id_ = backend_graph_shared_ptr_->backend_id;
+    backend_ = backend_graph_shared_ptr_->backend;
+    graph_ = backend_graph_shared_ptr_->graph;
+    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
+
+    getExtFunctionPointers();
+  }
 
+  // Get the backend graph of the model from the backend graph map, or build
+  // it and insert it into the map if there is none under the given id yet
+  onnx::SharedPtrBackendGraphInfo insertBackendGraph(
+      Workspace* ws,
+      const std::vector<uint64_t>& property_pointers,
+      const std::string& id,
+      const std::string& onnx_model_str) {
     auto initializers =
         this->template GetRepeatedArgument<std::string>("initializers");
     // Build the Onnxifi engine
@@ -263,17 +307,28 @@ class OnnxifiOp final : public Operator<Context> {
       return std::make_shared<onnx::BackendGraphInfo>(
           backend_id, backend, graph, lib_, std::move(weight_shape_info));
     };
-    backend_graph_shared_ptr_ =
-        backend_graph_map_ptr_->insert(op_id_string_, creator);
-
-    backend_id_ = backend_graph_shared_ptr_->backend_id;
-    backend_ = backend_graph_shared_ptr_->backend;
-    graph_ = backend_graph_shared_ptr_->graph;
-    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
+    return backend_graph_map_ptr_->insert(id, creator);
+  }
 
-    getExtFunctionPointers();
+  std::string batchBucketId(int batch_size) const {
+    return c10::str(op_id_string_, ":batch", batch_size);
   }
 
+  // Build a backend graph for each of the batch sizes, by rewriting the batch
+  // dimension of the input shapes of the c2 model
+  void buildBatchBuckets(
+      Workspace* ws,
+      const std::vector<uint64_t>& property_pointers,
+      std::vector<int> batch_sizes);
+
+  // Pick the graph of the smallest batch size bucket that fits the batch of
+  // the inputs, or the max_batch_size one if none does
+  void selectBatchBucket();
+
+  // Copy the input into a tensor with the batch size of the selected graph,
+  // filling the rows past the input with zeros
+  const Tensor& maybePadInput(int input_idx);
+
   /// Set up function pointer if onnxifi_ext is enabled
   void getExtFunctionPointers() {
 #ifdef ONNXIFI_ENABLE_EXT
@@ -394,6 +449,20 @@ class OnnxifiOp final : public Operator<Context> {
 
   // Whether we enable tracing in one run of inference
   bool enable_tracing_{false};
+
+  // Graphs for batch size buckets, in increasing order of batch size
+  std::vector<BatchBucket> batch_buckets_;
+
+  // Batch size and output shapes of the graph selected for the current run
+  int current_batch_size_;
+  const std::unordered_map<int, TensorInfo>* current_output_shape_hints_{
+      nullptr};
+
+  // Whether the first dimension of each input is the batch, and the buffers
+  // that inputs are padded into when they are smaller than the selected batch
+  // size. Only used with batch size buckets.
+  std::vector<bool> batched_inputs_;
+  std::vector<Tensor> padded_inputs_;
 };
 
 } // namespace caffe2
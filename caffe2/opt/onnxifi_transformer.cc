@@ -660,6 +660,13 @@ OperatorDef OnnxifiTransformer::buildOnnxifiOp(
   AddArgument("max_batch_size", opts_.bound_shape_spec.max_batch_size, &op);
   AddArgument("max_seq_size", opts_.bound_shape_spec.max_seq_size, &op);
   AddArgument("nominal_batch_idx", nominal_batch_idx, &op);
+  if (!opts_.batch_size_buckets.empty() && !opts_.use_onnx) {
+    auto* buckets_arg = op.add_arg();
+    buckets_arg->set_name("batch_size_buckets");
+    for (const auto b : opts_.batch_size_buckets) {
+      buckets_arg->add_ints(b);
+    }
+  }
 
   return op;
 }
@@ -34,6 +34,10 @@ struct OnnxifiTransformerOptions final : public BackendTransformOptions {
 
   // Enter loop test mode
   bool loop_test{false};
+
+  // Batch sizes smaller than max_batch_size that the Onnxifi ops lower the
+  // model for too, only for c2 models
+  std::vector<int> batch_size_buckets;
 };
 
 class CAFFE2_API OnnxifiTransformer final : public BackendTransformerBase {
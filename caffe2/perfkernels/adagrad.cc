@@ -202,6 +202,7 @@ void rowwise_adagrad_update(
 
 SPARSE_ADAGRAD_SPECIALIZATION(int32_t, base);
 
+decltype(sparse_adagrad_int32_t__base) sparse_adagrad_int32_t__avx512;
 decltype(sparse_adagrad_int32_t__base) sparse_adagrad_int32_t__avx_f16c;
 template <>
 int sparse_adagrad(
@@ -216,6 +217,19 @@ int sparse_adagrad(
     float* nh,
     float epsilon,
     float lr) {
+  AVX512_DO(
+      sparse_adagrad_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      nw,
+      nh,
+      epsilon,
+      lr);
   AVX_F16C_DO(
       sparse_adagrad_int32_t,
       num_rows,
@@ -246,6 +260,7 @@ int sparse_adagrad(
 
 SPARSE_ADAGRAD_SPECIALIZATION(int64_t, base);
 
+decltype(sparse_adagrad_int64_t__base) sparse_adagrad_int64_t__avx512;
 decltype(sparse_adagrad_int64_t__base) sparse_adagrad_int64_t__avx_f16c;
 template <>
 int sparse_adagrad(
@@ -260,6 +275,19 @@ int sparse_adagrad(
     float* nh,
     float epsilon,
     float lr) {
+  AVX512_DO(
+      sparse_adagrad_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      nw,
+      nh,
+      epsilon,
+      lr);
   AVX_F16C_DO(
       sparse_adagrad_int64_t,
       num_rows,
@@ -288,4 +316,108 @@ int sparse_adagrad(
       lr);
 }
 
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int32_t, base);
+
+decltype(rowwise_sparse_adagrad_int32_t__base)
+    rowwise_sparse_adagrad_int32_t__avx512;
+decltype(rowwise_sparse_adagrad_int32_t__base)
+    rowwise_sparse_adagrad_int32_t__avx_f16c;
+template <>
+int rowwise_sparse_adagrad(
+    int num_rows,
+    int block_size,
+    uint64_t param_size,
+    float* w,
+    const float* g,
+    float* h,
+    const int32_t* indices,
+    float epsilon,
+    float lr) {
+  AVX512_DO(
+      rowwise_sparse_adagrad_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+  AVX_F16C_DO(
+      rowwise_sparse_adagrad_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+  BASE_DO(
+      rowwise_sparse_adagrad_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+}
+
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int64_t, base);
+
+decltype(rowwise_sparse_adagrad_int64_t__base)
+    rowwise_sparse_adagrad_int64_t__avx512;
+decltype(rowwise_sparse_adagrad_int64_t__base)
+    rowwise_sparse_adagrad_int64_t__avx_f16c;
+template <>
+int rowwise_sparse_adagrad(
+    int num_rows,
+    int block_size,
+    uint64_t param_size,
+    float* w,
+    const float* g,
+    float* h,
+    const int64_t* indices,
+    float epsilon,
+    float lr) {
+  AVX512_DO(
+      rowwise_sparse_adagrad_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+  AVX_F16C_DO(
+      rowwise_sparse_adagrad_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+  BASE_DO(
+      rowwise_sparse_adagrad_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      h,
+      indices,
+      epsilon,
+      lr);
+}
+
 } // namespace caffe2
@@ -4,6 +4,9 @@
     (defined(__x86_64__) || defined(_M_X64) || defined(__i386__))
 #define CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
 #include <immintrin.h>
+#if defined(__AVX512F__)
+#define CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+#endif
 #endif
 #include <c10/util/Half.h>
 
@@ -50,7 +53,9 @@ static inline void adagrad_update_base_inlined(
 // for training
 // TODO(msmelyan)
 // explore streaming stores, but need to have unique indices (deduplication)
-inline void adagrad_update_prefetch_inlined(
+// These are static since they are compiled for a different ISA in every
+// translation unit that uses them.
+static inline void adagrad_update_prefetch_inlined(
     int N,
     const float* w,
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
@@ -86,6 +91,26 @@ inline void adagrad_update_prefetch_inlined(
     float lr) {
   auto i = 0;
 
+#ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+  constexpr int kSize512 = 16;
+  for (; i + kSize512 <= N; i += kSize512) {
+    _mm_prefetch(reinterpret_cast<const char*>(&w_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&h_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&nw_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&nh_n[i]), _MM_HINT_T0);
+
+    __m512 gi = _mm512_loadu_ps(g + i);
+    __m512 hi = _mm512_loadu_ps(h + i);
+    __m512 wi = _mm512_loadu_ps(w + i);
+
+    __m512 nhi = _mm512_fmadd_ps(gi, gi, hi);
+    _mm512_storeu_ps(nh + i, nhi);
+    __m512 vtmp = _mm512_div_ps(
+        gi, _mm512_add_ps(_mm512_sqrt_ps(nhi), _mm512_set1_ps(epsilon)));
+    _mm512_storeu_ps(nw + i, _mm512_fmadd_ps(_mm512_set1_ps(lr), vtmp, wi));
+  }
+#endif
+
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
   constexpr int kSize = 8;
   for (; i + kSize <= N; i += kSize) {
@@ -111,7 +136,7 @@ inline void adagrad_update_prefetch_inlined(
       N - i, w + i, g + i, h + i, nw + i, nh + i, 1.0f, epsilon, lr);
 }
 
-inline void rowwise_adagrad_update_inlined(
+static inline void rowwise_adagrad_update_inlined(
     int N,
     float* w,
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
@@ -136,6 +161,16 @@ inline void rowwise_adagrad_update_inlined(
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
   constexpr int kSize = 8;
   _mm_prefetch(reinterpret_cast<const char*>(h_n), _MM_HINT_T0);
+  float final_sum = 0.0f;
+#ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+  constexpr int kSize512 = 16;
+  __m512 partial_sum_512 = _mm512_setzero_ps();
+  for (; i + kSize512 <= N; i += kSize512) {
+    __m512 gi = _mm512_loadu_ps(g + i);
+    partial_sum_512 = _mm512_fmadd_ps(gi, gi, partial_sum_512);
+  }
+  final_sum += _mm512_reduce_add_ps(partial_sum_512);
+#endif
   __m256 partial_sum = _mm256_setzero_ps();
   for (; i + kSize <= N; i += kSize) {
     __m256 gi = _mm256_loadu_ps(g + i);
@@ -144,7 +179,7 @@ inline void rowwise_adagrad_update_inlined(
   // Reduce sum to 1 value
   __m256 partial_sum_2 = _mm256_hadd_ps(partial_sum, partial_sum);
   __m256 partial_sum_3 = _mm256_hadd_ps(partial_sum_2, partial_sum_2);
-  float final_sum = _mm_cvtss_f32(_mm256_castps256_ps128(partial_sum_3)) +
+  final_sum += _mm_cvtss_f32(_mm256_castps256_ps128(partial_sum_3)) +
       _mm_cvtss_f32(_mm256_extractf128_ps(partial_sum_3, 1));
 #else
   float final_sum = 0.0f;
@@ -159,10 +194,22 @@ inline void rowwise_adagrad_update_inlined(
   float float_step = lr / (std::sqrt(hi) + epsilon);
 
   i = 0;
+#ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+  __m512 step_512 = _mm512_set1_ps(float_step);
+
+  for (; i + kSize512 <= N; i += kSize512) {
+    _mm_prefetch(reinterpret_cast<const char*>(&w_n[i]), _MM_HINT_T0);
+
+    __m512 gi = _mm512_loadu_ps(g + i);
+    __m512 wi = _mm512_loadu_ps(w + i);
+
+    _mm512_storeu_ps(w + i, _mm512_fmadd_ps(gi, step_512, wi));
+  }
+#endif
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
   __m256 step = _mm256_set1_ps(float_step);
 
-  for (i = 0; i + kSize <= N; i += kSize) {
+  for (; i + kSize <= N; i += kSize) {
     _mm_prefetch(reinterpret_cast<const char*>(&w_n[i]), _MM_HINT_T0);
 
     __m256 gi = _mm256_loadu_ps(g + i);
@@ -324,8 +371,67 @@ int sparse_adagrad(
     return num_rows;                                                     \
   };
 
+/**
+ * Row-wise sparse Adagrad, with one moment per row of the parameters, updated
+ * in place.
+ *
+ * @return num_rows if succeeds otherwise return the row idx where we pass
+ *         the boundary of param_size
+ */
+template <typename SIndex>
+int rowwise_sparse_adagrad(
+    int num_rows, // number of rows reading
+    int block_size, // number of parameters per rows
+    std::uint64_t param_size, // total number of parameters
+    float* w, // parameters
+    const float* g, // input gradients
+    float* h, // momentums, one per row
+    const SIndex* indices, // indices of each row
+    float epsilon,
+    float lr);
+
+#define ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(SIndex, ISA)              \
+  int rowwise_sparse_adagrad_##SIndex##__##ISA(                          \
+      int num_rows,                                                      \
+      int block_size,                                                    \
+      std::uint64_t param_size,                                          \
+      float* w,                                                          \
+      const float* g,                                                    \
+      float* h,                                                          \
+      const SIndex* indices,                                             \
+      float epsilon,                                                     \
+      float lr) {                                                        \
+    for (int i = 0; i < num_rows; ++i) {                                 \
+      std::uint64_t idx = indices[i];                                    \
+      auto offsetI = i * block_size;                                     \
+      auto offsetIdx = idx * block_size;                                 \
+                                                                         \
+      if (block_size + offsetIdx > param_size) {                         \
+        return i;                                                        \
+      }                                                                  \
+                                                                         \
+      const int prefdist_T0 = 16;                                        \
+      int i_pref = (i < num_rows - prefdist_T0) ? i + prefdist_T0 : i;   \
+      std::uint64_t idx_pref = indices[i_pref];                          \
+                                                                         \
+      internal::rowwise_adagrad_update_inlined(                          \
+          block_size,                                                    \
+          w + offsetIdx,                                                 \
+          &w[idx_pref * block_size],                                     \
+          g + offsetI,                                                   \
+          h + idx,                                                       \
+          h + idx_pref,                                                  \
+          epsilon,                                                       \
+          lr);                                                           \
+    }                                                                    \
+    return num_rows;                                                     \
+  };
+
 } // namespace caffe2
 
+#ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+#undef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_AVX512
+#endif
 #ifdef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
 #undef CAFFE2_PERFKERNELS_ADAGRAD_H_USE_INTRINSIC
 #endif
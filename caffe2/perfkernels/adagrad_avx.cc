@@ -131,4 +131,7 @@ void rowwise_adagrad_update__avx_f16c(
 SPARSE_ADAGRAD_SPECIALIZATION(int32_t, avx_f16c);
 SPARSE_ADAGRAD_SPECIALIZATION(int64_t, avx_f16c);
 
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int32_t, avx_f16c);
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int64_t, avx_f16c);
+
 } // namespace caffe2
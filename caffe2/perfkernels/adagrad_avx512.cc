@@ -0,0 +1,35 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+void adagrad_update_prefetch__avx512(
+    int N,
+    const float* w,
+    const float* w_n, // prefetch ptr
+
+    const float* g,
+
+    const float* h,
+    const float* h_n, // prefetch ptr
+
+    float* nw,
+    float* nw_n, // prefetch ptr
+
+    float* nh,
+    float* nh_n, // prefetch ptr
+
+    float epsilon,
+    float lr) {
+  internal::adagrad_update_prefetch_inlined(
+      N, w, w_n, g, h, h_n, nw, nw_n, nh, nh_n, epsilon, lr);
+}
+
+SPARSE_ADAGRAD_SPECIALIZATION(int32_t, avx512);
+SPARSE_ADAGRAD_SPECIALIZATION(int64_t, avx512);
+
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int32_t, avx512);
+ROWWISE_SPARSE_ADAGRAD_SPECIALIZATION(int64_t, avx512);
+
+} // namespace caffe2
@@ -0,0 +1,131 @@
+#include "caffe2/perfkernels/adam.h"
+
+#include "caffe2/perfkernels/common.h"
+
+namespace caffe2 {
+
+SPARSE_ADAM_SPECIALIZATION(int32_t, base);
+
+decltype(sparse_adam_int32_t__base) sparse_adam_int32_t__avx512;
+decltype(sparse_adam_int32_t__base) sparse_adam_int32_t__avx2_fma;
+template <>
+int sparse_adam(
+    int num_rows,
+    int block_size,
+    uint64_t param_size,
+    float* w,
+    const float* g,
+    float* m,
+    float* v,
+    const int32_t* indices,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr) {
+  AVX512_DO(
+      sparse_adam_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+  AVX2_FMA_DO(
+      sparse_adam_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+  BASE_DO(
+      sparse_adam_int32_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+}
+
+SPARSE_ADAM_SPECIALIZATION(int64_t, base);
+
+decltype(sparse_adam_int64_t__base) sparse_adam_int64_t__avx512;
+decltype(sparse_adam_int64_t__base) sparse_adam_int64_t__avx2_fma;
+template <>
+int sparse_adam(
+    int num_rows,
+    int block_size,
+    uint64_t param_size,
+    float* w,
+    const float* g,
+    float* m,
+    float* v,
+    const int64_t* indices,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr) {
+  AVX512_DO(
+      sparse_adam_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+  AVX2_FMA_DO(
+      sparse_adam_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+  BASE_DO(
+      sparse_adam_int64_t,
+      num_rows,
+      block_size,
+      param_size,
+      w,
+      g,
+      m,
+      v,
+      indices,
+      beta1,
+      beta2,
+      epsilon,
+      lr);
+}
+
+} // namespace caffe2
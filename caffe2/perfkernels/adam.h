@@ -0,0 +1,177 @@
+#pragma once
+
+#if defined(__AVX2__) && defined(__FMA__) && !defined(__NVCC__) && \
+    (defined(__x86_64__) || defined(_M_X64) || defined(__i386__))
+#define CAFFE2_PERFKERNELS_ADAM_H_USE_INTRINSIC
+#include <immintrin.h>
+#if defined(__AVX512F__)
+#define CAFFE2_PERFKERNELS_ADAM_H_USE_AVX512
+#endif
+#endif
+
+#include <cmath>
+#include <cstdint>
+
+namespace caffe2 {
+
+namespace internal {
+
+// Adam update of one row, in place. `lr` already includes the bias
+// correction. Static since it's compiled for a different ISA in every
+// translation unit that uses it.
+static inline void adam_update_prefetch_inlined(
+    int N,
+    float* w,
+    const float* w_n, // prefetch ptr
+    const float* g,
+    float* m,
+    const float* m_n, // prefetch ptr
+    float* v,
+    const float* v_n, // prefetch ptr
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr) {
+  auto i = 0;
+
+#ifdef CAFFE2_PERFKERNELS_ADAM_H_USE_AVX512
+  constexpr int kSize512 = 16;
+  for (; i + kSize512 <= N; i += kSize512) {
+    _mm_prefetch(reinterpret_cast<const char*>(&w_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&m_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&v_n[i]), _MM_HINT_T0);
+
+    __m512 gi = _mm512_loadu_ps(g + i);
+    __m512 mi = _mm512_fmadd_ps(
+        _mm512_loadu_ps(m + i),
+        _mm512_set1_ps(beta1),
+        _mm512_mul_ps(gi, _mm512_set1_ps(1 - beta1)));
+    __m512 vi = _mm512_fmadd_ps(
+        _mm512_loadu_ps(v + i),
+        _mm512_set1_ps(beta2),
+        _mm512_mul_ps(_mm512_mul_ps(gi, gi), _mm512_set1_ps(1 - beta2)));
+    _mm512_storeu_ps(m + i, mi);
+    _mm512_storeu_ps(v + i, vi);
+    __m512 vtmp = _mm512_div_ps(
+        mi, _mm512_add_ps(_mm512_sqrt_ps(vi), _mm512_set1_ps(epsilon)));
+    _mm512_storeu_ps(
+        w + i,
+        _mm512_fmadd_ps(_mm512_set1_ps(lr), vtmp, _mm512_loadu_ps(w + i)));
+  }
+#endif
+
+#ifdef CAFFE2_PERFKERNELS_ADAM_H_USE_INTRINSIC
+  constexpr int kSize = 8;
+  for (; i + kSize <= N; i += kSize) {
+    _mm_prefetch(reinterpret_cast<const char*>(&w_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&m_n[i]), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(&v_n[i]), _MM_HINT_T0);
+
+    __m256 gi = _mm256_loadu_ps(g + i);
+    __m256 mi = _mm256_fmadd_ps(
+        _mm256_loadu_ps(m + i),
+        _mm256_set1_ps(beta1),
+        _mm256_mul_ps(gi, _mm256_set1_ps(1 - beta1)));
+    __m256 vi = _mm256_fmadd_ps(
+        _mm256_loadu_ps(v + i),
+        _mm256_set1_ps(beta2),
+        _mm256_mul_ps(_mm256_mul_ps(gi, gi), _mm256_set1_ps(1 - beta2)));
+    _mm256_storeu_ps(m + i, mi);
+    _mm256_storeu_ps(v + i, vi);
+    __m256 vtmp = _mm256_div_ps(
+        mi, _mm256_add_ps(_mm256_sqrt_ps(vi), _mm256_set1_ps(epsilon)));
+    _mm256_storeu_ps(
+        w + i,
+        _mm256_fmadd_ps(_mm256_set1_ps(lr), vtmp, _mm256_loadu_ps(w + i)));
+  }
+#else
+  (void)w_n;
+  (void)m_n;
+  (void)v_n;
+#endif
+
+  for (; i < N; ++i) {
+    float gi = g[i];
+    float mi = m[i] = m[i] * beta1 + gi * (1 - beta1);
+    float vi = v[i] = v[i] * beta2 + gi * gi * (1 - beta2);
+    w[i] = w[i] + lr * mi / (std::sqrt(vi) + epsilon);
+  }
+}
+
+} // namespace internal
+
+/**
+ * Sparse Adam, updating the parameters and both moments of the rows in
+ * `indices` in place. The learning rate already includes the bias
+ * correction.
+ *
+ * @return num_rows if succeeds otherwise return the row idx where we pass
+ *         the boundary of param_size
+ */
+template <typename SIndex>
+int sparse_adam(
+    int num_rows, // number of rows reading
+    int block_size, // number of parameters per rows
+    std::uint64_t param_size, // total number of parameters
+    float* w, // parameters
+    const float* g, // input gradients
+    float* m, // first moments
+    float* v, // second moments
+    const SIndex* indices, // indices of each row
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr);
+
+#define SPARSE_ADAM_SPECIALIZATION(SIndex, ISA)                          \
+  int sparse_adam_##SIndex##__##ISA(                                     \
+      int num_rows,                                                      \
+      int block_size,                                                    \
+      std::uint64_t param_size,                                          \
+      float* w,                                                          \
+      const float* g,                                                    \
+      float* m,                                                          \
+      float* v,                                                          \
+      const SIndex* indices,                                             \
+      float beta1,                                                       \
+      float beta2,                                                       \
+      float epsilon,                                                     \
+      float lr) {                                                        \
+    for (int i = 0; i < num_rows; ++i) {                                 \
+      std::uint64_t idx = indices[i];                                    \
+      auto offsetI = i * block_size;                                     \
+      auto offsetIdx = idx * block_size;                                 \
+                                                                         \
+      if (block_size + offsetIdx > param_size) {                         \
+        return i;                                                        \
+      }                                                                  \
+                                                                         \
+      const int prefdist_T0 = 16;                                        \
+      int i_pref = (i < num_rows - prefdist_T0) ? i + prefdist_T0 : i;   \
+      std::uint64_t offset_pref = indices[i_pref] * block_size;          \
+                                                                         \
+      internal::adam_update_prefetch_inlined(                            \
+          block_size,                                                    \
+          w + offsetIdx,                                                 \
+          w + offset_pref,                                               \
+          g + offsetI,                                                   \
+          m + offsetIdx,                                                 \
+          m + offset_pref,                                               \
+          v + offsetIdx,                                                 \
+          v + offset_pref,                                               \
+          beta1,                                                         \
+          beta2,                                                         \
+          epsilon,                                                       \
+          lr);                                                           \
+    }                                                                    \
+    return num_rows;                                                     \
+  };
+
+} // namespace caffe2
+
+#ifdef CAFFE2_PERFKERNELS_ADAM_H_USE_AVX512
+#undef CAFFE2_PERFKERNELS_ADAM_H_USE_AVX512
+#endif
+#ifdef CAFFE2_PERFKERNELS_ADAM_H_USE_INTRINSIC
+#undef CAFFE2_PERFKERNELS_ADAM_H_USE_INTRINSIC
+#endif
@@ -0,0 +1,8 @@
+#include "caffe2/perfkernels/adam.h"
+
+namespace caffe2 {
+
+SPARSE_ADAM_SPECIALIZATION(int32_t, avx2_fma);
+SPARSE_ADAM_SPECIALIZATION(int64_t, avx2_fma);
+
+} // namespace caffe2
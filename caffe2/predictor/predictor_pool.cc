@@ -0,0 +1,289 @@
+#include "caffe2/predictor/predictor_pool.h"
+
+#include <unordered_set>
+
+#include "caffe2/core/context.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Concatenates tensors of the same type and trailing dimensions along the
+// first dimension.
+void concatRows(const std::vector<const Tensor*>& parts, Tensor* output) {
+  const auto& first = *parts.front();
+  CAFFE_ENFORCE_GE(first.dim(), 1, "Batched inputs need a batch dimension");
+  auto dims = first.sizes().vec();
+  dims[0] = 0;
+  for (const auto* part : parts) {
+    CAFFE_ENFORCE(
+        part->dtype() == first.dtype(),
+        "Batched inputs have different types: ",
+        part->dtype().name(),
+        " and ",
+        first.dtype().name());
+    CAFFE_ENFORCE_EQ(part->dim(), first.dim());
+    for (int i = 1; i < part->dim(); ++i) {
+      CAFFE_ENFORCE_EQ(
+          part->size(i), first.size(i), "Batched inputs have different shapes");
+    }
+    dims[0] += part->size(0);
+  }
+  output->Resize(dims);
+  auto* data = static_cast<char*>(output->raw_mutable_data(first.dtype()));
+  CPUContext context;
+  for (const auto* part : parts) {
+    context.CopyItemsSameDevice(
+        first.dtype(), part->numel(), part->raw_data(), data);
+    data += part->nbytes();
+  }
+}
+
+// Copies `rows` rows from row `offset` on of `input`.
+Tensor sliceRows(const Tensor& input, int64_t offset, int64_t rows) {
+  auto dims = input.sizes().vec();
+  dims[0] = rows;
+  Tensor output(dims, CPU);
+  const int64_t row_numel = input.size_from_dim(1);
+  CPUContext context;
+  context.CopyItemsSameDevice(
+      input.dtype(),
+      rows * row_numel,
+      static_cast<const char*>(input.raw_data()) +
+          offset * row_numel * input.itemsize(),
+      output.raw_mutable_data(input.dtype()));
+  return output;
+}
+
+} // namespace
+
+PredictorPool::PredictorPool(
+    PredictorConfig config,
+    PredictorPoolOptions options)
+    : config_(std::move(config)), options_(options) {
+  CAFFE_ENFORCE(config_.ws, "PredictorPool needs the parameter workspace");
+  CAFFE_ENFORCE_GE(options_.max_batch_size, 1);
+  CAFFE_ENFORCE(
+      !options_.max_workspaces ||
+          options_.num_workspaces <= options_.max_workspaces,
+      "num_workspaces is larger than max_workspaces");
+  for (size_t i = 0; i < options_.num_workspaces; ++i) {
+    free_instances_.push_back(createInstance());
+  }
+  num_instances_ = options_.num_workspaces;
+}
+
+size_t PredictorPool::num_workspaces() const {
+  std::lock_guard<std::mutex> guard(pool_mutex_);
+  return num_instances_;
+}
+
+std::unique_ptr<PredictorPool::Instance> PredictorPool::createInstance() const {
+  const auto& net_def = *config_.predict_net;
+  auto instance = make_unique<Instance>();
+  instance->ws = make_unique<Workspace>(config_.ws.get());
+  auto* ws = instance->ws.get();
+
+  // Everything the net writes is local to the request workspace, even if a
+  // blob of the same name was initialized in the parameter workspace, so that
+  // concurrent requests never write to a shared blob.
+  const std::unordered_set<std::string> input_names(
+      config_.input_names.begin(), config_.input_names.end());
+  for (const auto& name : net_def.external_input()) {
+    const bool is_input = config_.input_names.empty()
+        ? !config_.ws->HasBlob(name)
+        : input_names.count(name) > 0;
+    if (is_input) {
+      auto* blob = ws->CreateLocalBlob(name);
+      BlobGetMutableTensor(blob, CPU);
+      instance->inputs.push_back(blob);
+    } else {
+      instance->inputs.push_back(nullptr);
+    }
+  }
+  for (const auto& op : net_def.op()) {
+    for (const auto& output : op.output()) {
+      ws->CreateLocalBlob(output);
+    }
+  }
+  instance->net = ws->CreateNet(config_.predict_net);
+  CAFFE_ENFORCE(instance->net, "Failed to create net ", net_def.name());
+  for (const auto& name : net_def.external_output()) {
+    const auto* blob = ws->GetBlob(name);
+    CAFFE_ENFORCE(blob, "Blob does not exist: ", name);
+    instance->outputs.push_back(blob);
+  }
+  return instance;
+}
+
+std::unique_ptr<PredictorPool::Instance> PredictorPool::acquire() {
+  std::unique_lock<std::mutex> lock(pool_mutex_);
+  if (free_instances_.empty() &&
+      (!options_.max_workspaces || num_instances_ < options_.max_workspaces)) {
+    // Nets are created outside of the lock, they can take a while
+    ++num_instances_;
+    lock.unlock();
+    try {
+      return createInstance();
+    } catch (...) {
+      lock.lock();
+      --num_instances_;
+      pool_cv_.notify_one();
+      throw;
+    }
+  }
+  pool_cv_.wait(lock, [this] { return !free_instances_.empty(); });
+  auto instance = std::move(free_instances_.back());
+  free_instances_.pop_back();
+  return instance;
+}
+
+void PredictorPool::release(std::unique_ptr<Instance> instance) {
+  std::lock_guard<std::mutex> guard(pool_mutex_);
+  free_instances_.push_back(std::move(instance));
+  pool_cv_.notify_one();
+}
+
+bool PredictorPool::operator()(const TensorList& inputs, TensorList* outputs) {
+  if (options_.max_batch_size == 1 || inputs.empty()) {
+    return run(inputs, outputs);
+  }
+  CAFFE_ENFORCE_GE(
+      inputs[0].dim(), 1, "Batched inputs need a batch dimension");
+  const int64_t rows = inputs[0].size(0);
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE(
+        input.dim() >= 1 && input.size(0) == rows,
+        "Batched inputs need the same first dimension");
+  }
+  if (rows >= options_.max_batch_size) {
+    return run(inputs, outputs);
+  }
+  return runBatched(inputs, outputs, rows);
+}
+
+bool PredictorPool::run(const TensorList& inputs, TensorList* outputs) {
+  auto instance = acquire();
+  CAFFE_ENFORCE_LE(inputs.size(), instance->inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto* blob = instance->inputs[i];
+    CAFFE_ENFORCE(
+        blob,
+        "Input ",
+        config_.predict_net->external_input(i),
+        " is a parameter that is shared between requests");
+    // Like Predictor, the blob shares the memory of the input
+    BlobSetTensor(blob, inputs[i].UnsafeSharedInstance());
+  }
+  bool success = false;
+  try {
+    success = instance->net->Run();
+  } catch (...) {
+    release(std::move(instance));
+    throw;
+  }
+  if (success) {
+    outputs->clear();
+    for (const auto* blob : instance->outputs) {
+      outputs->push_back(blob->Get<Tensor>().Clone());
+    }
+  }
+  release(std::move(instance));
+  return success;
+}
+
+bool PredictorPool::runBatched(
+    const TensorList& inputs,
+    TensorList* outputs,
+    int64_t rows) {
+  std::unique_lock<std::mutex> lock(batch_mutex_);
+  if (open_batch_ && open_batch_->size + rows <= options_.max_batch_size) {
+    auto batch = open_batch_;
+    batch->inputs.push_back(&inputs);
+    batch->outputs.push_back(outputs);
+    batch->size += rows;
+    if (batch->size == options_.max_batch_size) {
+      // The batch is full, its first request doesn't need to wait any longer
+      open_batch_.reset();
+      batch->cv.notify_all();
+    }
+    batch->cv.wait(lock, [&] { return batch->done; });
+    if (batch->error) {
+      std::rethrow_exception(batch->error);
+    }
+    return batch->success;
+  }
+
+  // The first request of a batch runs it. A batch that can't fit this request
+  // is closed and goes on running without it.
+  if (open_batch_) {
+    open_batch_->cv.notify_all();
+  }
+  auto batch = std::make_shared<Batch>();
+  batch->inputs.push_back(&inputs);
+  batch->outputs.push_back(outputs);
+  batch->size = rows;
+  open_batch_ = batch;
+  batch->cv.wait_for(lock, options_.max_batch_delay, [&] {
+    return open_batch_ != batch;
+  });
+  if (open_batch_ == batch) {
+    open_batch_.reset();
+  }
+  lock.unlock();
+
+  try {
+    batch->success = runBatch(*batch);
+  } catch (...) {
+    batch->error = std::current_exception();
+  }
+  lock.lock();
+  batch->done = true;
+  batch->cv.notify_all();
+  lock.unlock();
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+  return batch->success;
+}
+
+bool PredictorPool::runBatch(const Batch& batch) {
+  if (batch.inputs.size() == 1) {
+    return run(*batch.inputs[0], batch.outputs[0]);
+  }
+
+  const size_t num_inputs = batch.inputs[0]->size();
+  TensorList inputs;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    std::vector<const Tensor*> parts;
+    for (const auto* request : batch.inputs) {
+      CAFFE_ENFORCE_EQ(
+          request->size(), num_inputs, "Batched requests have different inputs");
+      parts.push_back(&(*request)[i]);
+    }
+    inputs.emplace_back(CPU);
+    concatRows(parts, &inputs.back());
+  }
+
+  TensorList outputs;
+  if (!run(inputs, &outputs)) {
+    return false;
+  }
+  for (auto* request : batch.outputs) {
+    request->clear();
+  }
+  for (const auto& output : outputs) {
+    CAFFE_ENFORCE(
+        output.dim() >= 1 && output.size(0) == batch.size,
+        "Batched outputs need the batch as their first dimension");
+    int64_t offset = 0;
+    for (size_t r = 0; r < batch.inputs.size(); ++r) {
+      const int64_t rows = (*batch.inputs[r])[0].size(0);
+      batch.outputs[r]->push_back(sliceRows(output, offset, rows));
+      offset += rows;
+    }
+  }
+  return true;
+}
+
+} // namespace caffe2
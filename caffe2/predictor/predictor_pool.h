@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/predictor.h"
+#include "caffe2/predictor/predictor_config.h"
+
+namespace caffe2 {
+
+struct CAFFE2_API PredictorPoolOptions {
+  // Number of request workspaces created along with the pool.
+  size_t num_workspaces = 1;
+  // Upper bound on the number of request workspaces, and so on the number of
+  // nets running at the same time. More than `num_workspaces` are only
+  // created when all of them are busy. 0 means no limit.
+  size_t max_workspaces = 0;
+  // Concurrent requests are concatenated along the first dimension of their
+  // inputs and run as one, up to this many rows. 1 disables batching.
+  int64_t max_batch_size = 1;
+  // How long the first request of a batch waits for others to join before
+  // the batch runs without them.
+  std::chrono::microseconds max_batch_delay{0};
+};
+
+/**
+ * A thread-safe Predictor for serving concurrent requests.
+ *
+ * The parameters are initialized once, in the workspace of the config, and
+ * shared read-only by every request. Each request runs in one of a pool of
+ * child workspaces that hold the inputs and activations of the net and that
+ * are reused by later requests, so activation memory stays allocated between
+ * them.
+ *
+ * Unlike Predictor, the outputs are copied out of the request workspace and
+ * stay valid after the call returns.
+ */
+class CAFFE2_API PredictorPool {
+ public:
+  using TensorList = Predictor::TensorList;
+
+  explicit PredictorPool(
+      PredictorConfig config,
+      PredictorPoolOptions options = PredictorPoolOptions());
+
+  PredictorPool(const PredictorPool&) = delete;
+  PredictorPool& operator=(const PredictorPool&) = delete;
+
+  // Executes the net on the inputs, which go to the first `inputs.size()`
+  // external inputs of the net like in Predictor. Can be called from any
+  // number of threads. When batching is enabled all inputs and outputs must
+  // have the batch as their first dimension.
+  //
+  // Returns true on success
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+
+  const NetDef& def() const {
+    return *config_.predict_net;
+  }
+
+  // The number of request workspaces created so far.
+  size_t num_workspaces() const;
+
+ private:
+  struct Instance {
+    std::unique_ptr<Workspace> ws;
+    NetBase* net;
+    std::vector<Blob*> inputs;
+    std::vector<const Blob*> outputs;
+  };
+
+  struct Batch {
+    std::vector<const TensorList*> inputs;
+    std::vector<TensorList*> outputs;
+    int64_t size = 0;
+    bool done = false;
+    bool success = false;
+    std::exception_ptr error;
+    std::condition_variable cv;
+  };
+
+  std::unique_ptr<Instance> createInstance() const;
+  std::unique_ptr<Instance> acquire();
+  void release(std::unique_ptr<Instance> instance);
+
+  bool run(const TensorList& inputs, TensorList* outputs);
+  bool runBatched(const TensorList& inputs, TensorList* outputs, int64_t rows);
+  bool runBatch(const Batch& batch);
+
+  PredictorConfig config_;
+  PredictorPoolOptions options_;
+
+  mutable std::mutex pool_mutex_;
+  std::condition_variable pool_cv_;
+  std::vector<std::unique_ptr<Instance>> free_instances_;
+  size_t num_instances_ = 0;
+
+  // The batch new requests join, if any.
+  std::mutex batch_mutex_;
+  std::shared_ptr<Batch> open_batch_;
+};
+
+} // namespace caffe2
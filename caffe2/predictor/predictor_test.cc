@@ -2,10 +2,13 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/predictor/predictor.h"
+#include "caffe2/predictor/predictor_pool.h"
 #include "caffe2/utils/math.h"
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 namespace caffe2 {
 
 namespace {
@@ -205,4 +208,89 @@ TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   EXPECT_NEAR(output.front().data<float>()[4], 0.1209, 1E-4);
 }
 
+class PredictorPoolTest : public PredictorTest {
+ public:
+  // Runs `num_threads` requests of `rows` rows each at the same time and
+  // checks them against the Predictor.
+  void runConcurrently(
+      PredictorPool& pool,
+      int num_threads,
+      int64_t rows) {
+    std::vector<std::unique_ptr<Blob>> inputs;
+    std::vector<Predictor::TensorList> outputs(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      inputs.push_back(randomTensor({rows, 4}, ctx_.get()));
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&, i] {
+        Predictor::TensorList input;
+        input.emplace_back(
+            BlobGetMutableTensor(inputs[i].get(), CPU)->Alias());
+        EXPECT_TRUE(pool(input, &outputs[i]));
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < num_threads; ++i) {
+      Predictor::TensorList input, expected;
+      input.emplace_back(BlobGetMutableTensor(inputs[i].get(), CPU)->Alias());
+      (*p_)(input, &expected);
+      ASSERT_EQ(outputs[i].size(), 1);
+      ASSERT_EQ(outputs[i].front().sizes(), expected.front().sizes());
+      for (int64_t j = 0; j < expected.front().numel(); ++j) {
+        EXPECT_NEAR(
+            outputs[i].front().data<float>()[j],
+            expected.front().data<float>()[j],
+            1E-5);
+      }
+    }
+  }
+};
+
+TEST_F(PredictorPoolTest, SharesParameters) {
+  PredictorPoolOptions options;
+  options.num_workspaces = 2;
+  PredictorPool pool(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)),
+      options);
+  EXPECT_EQ(pool.num_workspaces(), 2);
+  runConcurrently(pool, 8, 1);
+  EXPECT_GE(pool.num_workspaces(), 2);
+}
+
+TEST_F(PredictorPoolTest, MaxWorkspaces) {
+  PredictorPoolOptions options;
+  options.max_workspaces = 2;
+  PredictorPool pool(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)),
+      options);
+  runConcurrently(pool, 8, 3);
+  EXPECT_LE(pool.num_workspaces(), 2);
+}
+
+TEST_F(PredictorPoolTest, Batching) {
+  PredictorPoolOptions options;
+  options.max_batch_size = 8;
+  options.max_batch_delay = std::chrono::milliseconds(10);
+  PredictorPool pool(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)),
+      options);
+  runConcurrently(pool, 8, 1);
+  runConcurrently(pool, 8, 3);
+  runConcurrently(pool, 2, 8);
+}
+
+TEST_F(PredictorPoolTest, SharedParameterInput) {
+  PredictorPool pool(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)));
+  auto inputData = randomTensor({1, 4}, ctx_.get());
+  auto weight = randomTensor({10, 4}, ctx_.get());
+  Predictor::TensorList input, output;
+  input.emplace_back(BlobGetMutableTensor(inputData.get(), CPU)->Alias());
+  input.emplace_back(BlobGetMutableTensor(weight.get(), CPU)->Alias());
+  EXPECT_THROW(pool(input, &output), EnforceNotMet);
+}
+
 } // namespace caffe2
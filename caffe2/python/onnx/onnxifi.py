@@ -26,9 +26,14 @@ def onnxifi_caffe2_net(
         merge_fp32_inputs_into_fp16=False,
         adjust_batch=True,
         black_list=None,
-        weight_names=None):
+        weight_names=None,
+        batch_size_buckets=None):
     """
     Transform the caffe2_net by collapsing ONNXIFI-runnable nodes into Onnxifi c2 ops
+
+    batch_size_buckets: batch sizes smaller than max_batch_size that the
+    Onnxifi ops also lower the net for, to run small batches at the smallest
+    one that fits. Only supported with use_onnx=False.
     """
     shape_hints = {}
     for k, v in input_shapes.items():
@@ -42,7 +47,8 @@ def onnxifi_caffe2_net(
                              adjust_batch,
                              debug,
                              merge_fp32_inputs_into_fp16,
-                             use_onnx)
+                             use_onnx,
+                             batch_size_buckets if batch_size_buckets else [])
     pred_net_cut = caffe2_pb2.NetDef()
     pred_net_cut.ParseFromString(pred_net_str)
     return pred_net_cut
@@ -481,6 +481,44 @@ class TestLoadSave(TestLoadSaveBase):
             if e.errno != errno.ENOENT:
                 raise
 
+    def testLoadChunksInParallel(self):
+        tmp_folder = tempfile.mkdtemp()
+        arrays = [
+            np.random.rand(100, 10).astype(np.float32),
+            np.random.permutation(1000).astype(np.int64),
+            np.array([str(i).encode() for i in range(50)], dtype=np.object),
+            np.random.rand(3).astype(np.float64),
+        ]
+        blobs = [str(i) for i in range(len(arrays))]
+        for name, arr in zip(blobs, arrays):
+            self.assertTrue(workspace.FeedBlob(name, arr))
+        tmp_file = os.path.join(tmp_folder, "db")
+        self.assertTrue(workspace.RunOperatorOnce(core.CreateOperator(
+            "Save",
+            blobs, [],
+            absolute_path=1,
+            db=tmp_file, db_type=self._db_type,
+            chunk_size=7)))
+
+        for load_all in [False, True]:
+            workspace.ResetWorkspace()
+            self.assertTrue(workspace.RunOperatorOnce(core.CreateOperator(
+                "Load",
+                [], [] if load_all else blobs,
+                absolute_path=1,
+                db=tmp_file, db_type=self._db_type,
+                load_all=load_all,
+                num_threads=4)))
+            for name, arr in zip(blobs, arrays):
+                fetched = workspace.FetchBlob(name)
+                self.assertEqual(fetched.dtype, arr.dtype)
+                np.testing.assert_array_equal(fetched, arr)
+        try:
+            shutil.rmtree(tmp_folder)
+        except OSError as e:
+            if e.errno != errno.ENOENT:
+                raise
+
 
 if __name__ == '__main__':
     unittest.main()
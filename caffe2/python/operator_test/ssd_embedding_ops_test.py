@@ -0,0 +1,128 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import os
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+from caffe2.python import core, workspace
+from caffe2.python.test_util import TestCase
+
+
+@unittest.skipIf(os.name == "nt", "The SSD embedding table needs POSIX I/O")
+class TestSSDEmbeddingOps(TestCase):
+    def setUp(self):
+        super(TestSSDEmbeddingOps, self).setUp()
+        self.tmp_dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.tmp_dir, "table.bin")
+
+    def tearDown(self):
+        workspace.ResetWorkspace()
+        shutil.rmtree(self.tmp_dir)
+        super(TestSSDEmbeddingOps, self).tearDown()
+
+    def create_table(self, data, cache_rows, num_io_threads):
+        workspace.FeedBlob("data", data)
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "CreateSSDEmbeddingTable", ["data"], ["table"], path=self.path,
+            cache_rows=cache_rows, num_io_threads=num_io_threads))
+
+    def test_sparse_lengths_sum(self):
+        np.random.seed(0)
+        data = np.random.rand(50, 8).astype(np.float32)
+        # The cache is smaller than the table, so rows get evicted
+        self.create_table(data, cache_rows=20, num_io_threads=4)
+        for _ in range(10):
+            lengths = np.random.randint(0, 5, size=4).astype(np.int32)
+            indices = np.random.randint(
+                0, 50, size=lengths.sum()).astype(np.int64)
+            weights = np.random.rand(lengths.sum()).astype(np.float32)
+            workspace.FeedBlob("indices", indices)
+            workspace.FeedBlob("lengths", lengths)
+            workspace.FeedBlob("weights", weights)
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "SSDSparseLengthsSum", ["table", "indices", "lengths"],
+                ["sum"]))
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "SSDSparseLengthsWeightedSum",
+                ["table", "weights", "indices", "lengths"], ["weighted_sum"]))
+
+            expected_sum = np.zeros((4, 8), dtype=np.float32)
+            expected_weighted_sum = np.zeros((4, 8), dtype=np.float32)
+            pos = 0
+            for i, length in enumerate(lengths):
+                for j in range(pos, pos + length):
+                    expected_sum[i] += data[indices[j]]
+                    expected_weighted_sum[i] += weights[j] * data[indices[j]]
+                pos += length
+            np.testing.assert_allclose(
+                workspace.FetchBlob("sum"), expected_sum, rtol=1e-5)
+            np.testing.assert_allclose(
+                workspace.FetchBlob("weighted_sum"), expected_weighted_sum,
+                rtol=1e-5)
+
+    def test_rowwise_sparse_adagrad(self):
+        np.random.seed(1)
+        data = np.random.rand(30, 4).astype(np.float32)
+        moment = np.random.rand(30).astype(np.float32)
+        self.create_table(data, cache_rows=8, num_io_threads=0)
+        workspace.FeedBlob("moment", moment)
+        lr = np.array([0.1], dtype=np.float32)
+        workspace.FeedBlob("lr", lr)
+        epsilon = 1e-5
+        for _ in range(20):
+            indices = np.random.choice(30, size=5, replace=False).astype(
+                np.int32)
+            grad = np.random.rand(5, 4).astype(np.float32)
+            workspace.FeedBlob("indices", indices)
+            workspace.FeedBlob("grad", grad)
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "SSDRowWiseSparseAdagrad",
+                ["table", "moment", "indices", "grad", "lr"], ["moment"],
+                epsilon=epsilon))
+            for i, index in enumerate(indices):
+                moment[index] += np.mean(np.square(grad[i]))
+                data[index] += (
+                    lr[0] * grad[i] / (np.sqrt(moment[index]) + epsilon))
+
+        np.testing.assert_allclose(
+            workspace.FetchBlob("moment"), moment, rtol=1e-5)
+        workspace.FeedBlob("all", np.arange(30, dtype=np.int64)[:8])
+        workspace.FeedBlob("ones", np.ones(8, dtype=np.int32))
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "SSDSparseLengthsSum", ["table", "all", "ones"], ["rows"]))
+        np.testing.assert_allclose(
+            workspace.FetchBlob("rows"), data[:8], rtol=1e-5)
+
+        # The updated rows reach the file once they are flushed
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "FlushSSDEmbeddingTable", ["table"], []))
+        stored = np.fromfile(self.path, dtype=np.float32).reshape(30, 4)
+        np.testing.assert_allclose(stored, data, rtol=1e-5)
+
+        # And another table can open the file
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "CreateSSDEmbeddingTable", [], ["table2"], path=self.path,
+            num_rows=30, block_size=4, cache_rows=8))
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "SSDSparseLengthsSum", ["table2", "all", "ones"], ["rows2"]))
+        np.testing.assert_allclose(
+            workspace.FetchBlob("rows2"), data[:8], rtol=1e-5)
+
+    def test_too_many_rows(self):
+        data = np.random.rand(10, 2).astype(np.float32)
+        self.create_table(data, cache_rows=4, num_io_threads=0)
+        workspace.FeedBlob("indices", np.arange(5, dtype=np.int64))
+        workspace.FeedBlob("lengths", np.array([5], dtype=np.int32))
+        with self.assertRaises(RuntimeError):
+            workspace.RunOperatorOnce(core.CreateOperator(
+                "SSDSparseLengthsSum", ["table", "indices", "lengths"],
+                ["sum"]))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -15,6 +15,7 @@
 #include "caffe2/core/stats.h"
 #include "caffe2/core/transform.h"
 #include "caffe2/observers/profile_observer.h"
+#include "caffe2/observers/roofline_observer.h"
 #include "caffe2/observers/runcnt_observer.h"
 #include "caffe2/observers/time_observer.h"
 #include "caffe2/onnx/backend.h"
@@ -378,6 +379,31 @@ void addObjectMethods(py::module& m) {
                 cast_ob, "Observer does not implement this function.");
             return cast_ob->average_time_children();
           })
+      .def(
+          "roofline_stats",
+          [](ObserverBase<NetBase>* ob) {
+            auto* cast_ob = dynamic_cast_if_rtti<RooflineObserver*>(ob);
+            CAFFE_ENFORCE(
+                cast_ob, "Observer does not implement this function.");
+            const auto to_dict = [](const RooflineStats& stats) {
+              py::dict d;
+              d["runs"] = stats.runs;
+              d["time_ms"] = stats.time_ms;
+              d["flops"] = stats.flops;
+              d["bytes"] = stats.bytes;
+              d["gflops_per_second"] = stats.gflops_per_second();
+              d["gbytes_per_second"] = stats.gbytes_per_second();
+              return d;
+            };
+            py::dict op_types;
+            for (const auto& op_type : cast_ob->op_type_stats()) {
+              op_types[py::str(op_type.first)] = to_dict(op_type.second);
+            }
+            py::dict result;
+            result["net"] = to_dict(cast_ob->net_stats());
+            result["op_types"] = op_types;
+            return result;
+          })
       .def("debug_info", [](ObserverBase<NetBase>* ob) {
         return ob->debugInfo();
       });
@@ -1232,6 +1258,7 @@ void addGlobalMethods(py::module& m) {
   }
 
         REGISTER_PYTHON_EXPOSED_OBSERVER(ProfileObserver);
+        REGISTER_PYTHON_EXPOSED_OBSERVER(RooflineObserver);
         REGISTER_PYTHON_EXPOSED_OBSERVER(TimeObserver);
 #undef REGISTER_PYTHON_EXPOSED_OBSERVER
 
@@ -1717,7 +1744,8 @@ void addGlobalMethods(py::module& m) {
          bool adjust_batch,
          bool debug_builder,
          bool merge_fp32_inputs_into_fp16,
-         bool use_onnx) -> py::bytes {
+         bool use_onnx,
+         const std::vector<int>& batch_size_buckets) -> py::bytes {
         caffe2::NetDef pred_net;
         CAFFE_ENFORCE(
             ParseProtoFromLargeString(
@@ -1737,6 +1765,7 @@ void addGlobalMethods(py::module& m) {
         opts.debug = debug_builder;
         opts.merge_fp32_inputs_into_fp16 = merge_fp32_inputs_into_fp16;
         opts.use_onnx = use_onnx;
+        opts.batch_size_buckets = batch_size_buckets;
         OnnxifiTransformer ts(opts);
         Workspace* curr_ws = GetCurrentWorkspace();
         std::unordered_set<int> blacklist_set(
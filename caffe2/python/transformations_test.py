@@ -320,6 +320,54 @@ class TestTransformations(tu.TestCase):
             atol=1e-04
         )
 
+    @given(
+        batch_size=st.integers(1, 8),
+        input_dim=st.integers(1, 16),
+        output_dim=st.integers(1, 16),
+        seed=st.integers(0, 65535),
+    )
+    def test_transformer_FuseFCAdd(self, batch_size, input_dim, output_dim, seed):
+        workspace.ResetWorkspace()
+        net = core.Net("net")
+        net.FC(["X", "w", "b"], ["Y"])
+        net.Add(["Y", "b2"], ["Y2"], broadcast=1)
+        net.Relu(["Y2"], ["Y3"])
+
+        np.random.seed(seed)
+        tu.randBlobFloat32("X", batch_size, input_dim)
+        tu.randBlobFloat32("w", output_dim, input_dim)
+        tu.randBlobsFloat32(["b", "b2"], output_dim)
+        workspace.RunNetOnce(net)
+        preTransformOutput = workspace.FetchBlob("Y3").flatten()
+        workspace.FeedBlob("Y3", np.zeros((1, 1)))
+        transformer.FuseFCAdd(net)
+
+        # Ensure fusion
+        assert tu.numOps(net) == 2
+        workspace.RunNetOnce(net)
+        postTransformOutput = workspace.FetchBlob("Y3").flatten()
+        # Check that there is no numerical difference
+        assert np.allclose(
+            preTransformOutput,
+            postTransformOutput,
+            rtol=1e-05,
+            atol=1e-05
+        )
+
+    def test_transformer_FuseFCAddSharedBias(self):
+        workspace.ResetWorkspace()
+        net = core.Net("net")
+        net.FC(["X", "w", "b"], ["Y"])
+        net.Add(["Y", "b2"], ["Y2"], broadcast=1)
+        net.FC(["X", "w", "b"], ["Z"])
+        tu.randBlobFloat32("X", 2, 3)
+        tu.randBlobFloat32("w", 4, 3)
+        tu.randBlobsFloat32(["b", "b2"], 4)
+        transformer.FuseFCAdd(net)
+
+        # The bias of the first FC is also used by the second one
+        assert tu.numOps(net) == 3
+
     def test_converterDontEnforceUnusedInputs(self):
         net = core.Net("net")
         net.Relu(["X"], ["Y"])
@@ -71,10 +71,10 @@ bool BlobsQueue::blockingRead(
   CAFFE_EVENT(stats_, queue_balance, -1);
   if (timeout_secs > 0) {
     std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
+    cvEmpty_.wait_for(
         g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
   } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
+    cvEmpty_.wait(g, [this, canRead]() { return closing_ || canRead(); });
   }
   if (!canRead()) {
     if (timeout_secs > 0 && !closing_) {
@@ -88,16 +88,25 @@ bool BlobsQueue::blockingRead(
   DCHECK(canRead());
   auto& result = queue_[reader_ % queue_.size()];
   CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+  const auto numBlobs = result.size();
+  for (auto i = 0; i < numBlobs; ++i) {
     using std::swap;
     swap(*(inputs[i]), *(result[i]));
   }
   CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
   ++reader_;
-  cv_.notify_all();
+  const auto depth = writer_ - reader_;
+  g.unlock();
+  cvOverflow_.notify_one();
+
+  // The dequeued blobs belong to the caller now, so their sizes are
+  // recorded without holding the lock.
+  for (auto i = 0; i < numBlobs; ++i) {
+    auto bytes = BlobStat::sizeBytes(*inputs[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+  }
+  CAFFE_EVENT(stats_, queue_dequeued_records);
+  CAFFE_EVENT(stats_, queue_depth, depth);
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
   return true;
 }
@@ -116,7 +125,7 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
   DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(g, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -130,13 +139,13 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
+  cvOverflow_.wait(g, [this]() { return closing_ || canWrite(); });
   if (!canWrite()) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(g, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -144,8 +153,13 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
 void BlobsQueue::close() {
   closing_ = true;
 
-  std::lock_guard<std::mutex> g(mutex_);
-  cv_.notify_all();
+  {
+    // Taking the lock orders closing_ before the predicate check of any
+    // thread that is about to wait.
+    std::lock_guard<std::mutex> g(mutex_);
+  }
+  cvEmpty_.notify_all();
+  cvOverflow_.notify_all();
 }
 
 bool BlobsQueue::canWrite() {
@@ -156,7 +170,10 @@ bool BlobsQueue::canWrite() {
   return writer_ != reader_ + queue_.size();
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
+// Writes under the lock held by `g`, then releases it before waking a reader.
+void BlobsQueue::doWrite(
+    std::unique_lock<std::mutex>& g,
+    const std::vector<Blob*>& inputs) {
   auto& result = queue_[writer_ % queue_.size()];
   CAFFE_ENFORCE(inputs.size() >= result.size());
   const auto& name = name_.c_str();
@@ -167,7 +184,10 @@ void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
   CAFFE_SDT(
       queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
   ++writer_;
-  cv_.notify_all();
+  const auto depth = writer_ - reader_;
+  g.unlock();
+  cvEmpty_.notify_one();
+  CAFFE_EVENT(stats_, queue_depth, depth);
 }
 
 } // namespace caffe2
@@ -46,13 +46,17 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
 
  private:
   bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+  void doWrite(std::unique_lock<std::mutex>& g, const std::vector<Blob*>& inputs);
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
   std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
+  // Readers wait on cvEmpty_ and writers on cvOverflow_, so every read or
+  // write wakes a single waiter of the other side instead of every thread
+  // blocked on the queue.
+  std::condition_variable cvEmpty_;
+  std::condition_variable cvOverflow_;
   int64_t reader_{0};
   int64_t writer_{0};
   std::vector<std::vector<Blob*>> queue_;
@@ -61,6 +65,10 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   struct QueueStats {
     CAFFE_STAT_CTOR(QueueStats);
     CAFFE_EXPORTED_STAT(queue_balance);
+    // number of records in the queue after each read and write; close to
+    // the capacity when readers cannot keep up, close to 0 when writers
+    // cannot
+    CAFFE_AVG_EXPORTED_STAT(queue_depth);
     CAFFE_EXPORTED_STAT(queue_dequeued_records);
     CAFFE_DETAILED_EXPORTED_STAT(queue_dequeued_bytes);
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
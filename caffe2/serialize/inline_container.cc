@@ -7,6 +7,7 @@
 
 #include <c10/core/Allocator.h>
 #include <c10/core/Backend.h>
+#include <c10/core/thread_pool.h>
 
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
@@ -211,12 +212,42 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   return result;
 }
 
+static int64_t read_le_16(uint8_t* buf) {
+  return buf[0] + (buf[1] << 8);
+}
+
+// the offset of the data of a file from the offset of its local header
+static size_t getDataOffset(
+    const ReadAdapterInterface& in,
+    uint64_t local_header_ofs) {
+  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+  in.read(
+      local_header_ofs,
+      local_header,
+      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
+      "reading file header");
+  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
+  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+  return local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+}
+
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
+
+  // Files that are stored uncompressed can point straight into inputs that
+  // share their memory, e.g. a MmapAdapter.
+  if (stat.m_method == 0 && !stat.m_is_encrypted) {
+    at::DataPtr retval = in_->getDataPtr(
+        getDataOffset(*in_, stat.m_local_header_ofs), stat.m_uncomp_size);
+    if (retval) {
+      return std::make_tuple(std::move(retval), stat.m_uncomp_size);
+    }
+  }
+
   void * ptr = malloc(stat.m_uncomp_size);
   mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
   valid("reading file ", name.c_str());
@@ -225,27 +256,81 @@ std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
-static int64_t read_le_16(uint8_t* buf) {
-  return buf[0] + (buf[1] << 8);
+std::vector<std::future<std::tuple<at::DataPtr, size_t>>>
+PyTorchStreamReader::getRecordsAsync(
+    const std::vector<std::string>& names,
+    size_t num_threads) {
+  using Record = std::tuple<at::DataPtr, size_t>;
+  std::vector<std::future<Record>> records;
+  records.reserve(names.size());
+  // The zip archive is only used on this thread; the reads on the pool only
+  // go through the input.
+  for (const auto& name : names) {
+    mz_zip_archive_file_stat stat;
+    mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
+    valid("retrieving file meta-data for ", name.c_str());
+    if (num_threads == 0 || !in_->supportsConcurrentReads() ||
+        stat.m_method != 0 || stat.m_is_encrypted) {
+      records.push_back(std::async(
+          std::launch::deferred, [this, name]() { return getRecord(name); }));
+      continue;
+    }
+
+    if (!read_pool_) {
+      read_pool_ = std::make_unique<c10::ThreadPool>(num_threads);
+    }
+    uint64_t local_header_ofs = stat.m_local_header_ofs;
+    size_t size = stat.m_uncomp_size;
+    mz_uint32 crc32 = stat.m_crc32;
+    auto task = std::make_shared<std::packaged_task<Record()>>(
+        [this, name, local_header_ofs, size, crc32]() {
+          size_t offset = getDataOffset(*in_, local_header_ofs);
+          at::DataPtr retval = in_->getDataPtr(offset, size);
+          if (retval) {
+            return std::make_tuple(std::move(retval), size);
+          }
+          void* ptr = malloc(size);
+          retval = at::DataPtr(ptr, ptr, free, at::kCPU);
+          in_->read(offset, ptr, size, "reading file");
+          if (mz_crc32(MZ_CRC32_INIT, static_cast<const mz_uint8*>(ptr), size) !=
+              crc32) {
+            CAFFE_THROW(
+                "PytorchStreamReader failed reading file ",
+                name,
+                ": CRC-32 check failed");
+          }
+          return std::make_tuple(std::move(retval), size);
+        });
+    records.push_back(task->get_future());
+    read_pool_->run([task]() { (*task)(); });
+  }
+  return records;
+}
+
+std::vector<std::tuple<at::DataPtr, size_t>> PyTorchStreamReader::getRecords(
+    const std::vector<std::string>& names,
+    size_t num_threads) {
+  auto futures = getRecordsAsync(names, num_threads);
+  std::vector<std::tuple<at::DataPtr, size_t>> records;
+  records.reserve(futures.size());
+  for (auto& future : futures) {
+    records.push_back(future.get());
+  }
+  return records;
 }
 
 size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retrieving file meta-data for ", name.c_str());
-  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
-  in_->read(
-      stat.m_local_header_ofs,
-      local_header,
-      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
-      "reading file header");
-  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
-  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return getDataOffset(*in_, stat.m_local_header_ofs);
 }
 
-
 PyTorchStreamReader::~PyTorchStreamReader() {
+  // The pending reads of getRecordsAsync use the input.
+  if (read_pool_) {
+    read_pool_->waitWorkComplete();
+  }
   mz_zip_clear_last_error(ar_.get());
   mz_zip_reader_end(ar_.get());
   valid("closing reader for archive ", archive_name_.c_str());
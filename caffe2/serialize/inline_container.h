@@ -6,6 +6,8 @@
 #include <istream>
 #include <ostream>
 #include <fstream>
+#include <future>
+#include <vector>
 
 #include <c10/core/Allocator.h>
 #include <c10/core/Backend.h>
@@ -18,6 +20,10 @@ extern "C" {
 typedef struct mz_zip_archive mz_zip_archive;
 }
 
+namespace c10 {
+class ThreadPool;
+}
+
 // PyTorch containers are a special zip archive with the following layout
 // archive_name.zip contains:
 //    archive_name/
@@ -96,6 +102,9 @@ constexpr uint64_t kProducedFileFormatVersion = 0x2L;
 // Writer-specific constants
 constexpr uint64_t kFieldAlignment = 64;
 
+// Reader-specific constants
+constexpr size_t kDefaultConcurrentReads = 16;
+
 class CAFFE2_API PyTorchStreamReader final {
  public:
   explicit PyTorchStreamReader(const std::string& file_name);
@@ -104,6 +113,19 @@ class CAFFE2_API PyTorchStreamReader final {
 
   // return dataptr, size
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
+  // Starts reading the records and returns a future for each of them. If the
+  // input supports concurrent reads, the records stored uncompressed are read
+  // with concurrent range reads on up to num_threads threads, which hides the
+  // latency of inputs like network filesystems. Other records are read by the
+  // thread that calls get() on their future. The reader can be used again
+  // right away, from one thread at a time, and must outlive the futures.
+  std::vector<std::future<std::tuple<at::DataPtr, size_t>>> getRecordsAsync(
+      const std::vector<std::string>& names,
+      size_t num_threads = kDefaultConcurrentReads);
+  // Like getRecordsAsync, but waits for all the records.
+  std::vector<std::tuple<at::DataPtr, size_t>> getRecords(
+      const std::vector<std::string>& names,
+      size_t num_threads = kDefaultConcurrentReads);
   size_t getRecordOffset(const std::string& name);
   bool hasRecord(const std::string& name);
   std::vector<std::string> getAllRecords();
@@ -125,6 +147,8 @@ class CAFFE2_API PyTorchStreamReader final {
   std::string archive_name_plus_slash_;
   std::unique_ptr<ReadAdapterInterface> in_;
   int64_t version_;
+  // Runs the reads of getRecordsAsync, created by its first call.
+  std::unique_ptr<c10::ThreadPool> read_pool_;
 };
 
 class CAFFE2_API PyTorchStreamWriter final {
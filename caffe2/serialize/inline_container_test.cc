@@ -1,10 +1,12 @@
 #include <cstdio>
 #include <string>
 #include <array>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +65,67 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, LoadFromMmap) {
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  {
+    PyTorchStreamWriter writer("mmap_output.zip");
+    writer.writeRecord("key1", data1.data(), data1.size());
+    writer.writeEndOfFile();
+  }
+
+  PyTorchStreamReader reader(
+      std::make_unique<MmapAdapter>("mmap_output.zip"));
+  ASSERT_TRUE(reader.hasRecord("key1"));
+  at::DataPtr data_ptr;
+  int64_t size;
+  std::tie(data_ptr, size) = reader.getRecord("key1");
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  // the record points into the mapping rather than a malloc'ed copy
+  ASSERT_NE(data_ptr.get_deleter(), &free);
+  ASSERT_EQ(reinterpret_cast<size_t>(data_ptr.get()) % kFieldAlignment, 0);
+
+  // the mapping is copy-on-write, the file keeps the written data
+  static_cast<char*>(data_ptr.get())[0] = 0;
+  PyTorchStreamReader file_reader("mmap_output.zip");
+  at::DataPtr file_data_ptr;
+  std::tie(file_data_ptr, size) = file_reader.getRecord("key1");
+  ASSERT_EQ(memcmp(file_data_ptr.get(), data1.data(), data1.size()), 0);
+  std::remove("mmap_output.zip");
+}
+
+TEST(PyTorchStreamWriterAndReader, GetRecords) {
+  std::vector<std::string> names;
+  {
+    PyTorchStreamWriter writer("records_output.zip");
+    for (int i = 0; i < 40; ++i) {
+      std::vector<char> data(100 + i, static_cast<char>(i));
+      names.push_back("data/" + c10::to_string(i));
+      writer.writeRecord(names.back(), data.data(), data.size());
+    }
+    writer.writeEndOfFile();
+  }
+
+  PyTorchStreamReader file_reader("records_output.zip");
+  PyTorchStreamReader mmap_reader(
+      std::make_unique<MmapAdapter>("records_output.zip"));
+  for (auto* reader : {&file_reader, &mmap_reader}) {
+    auto records = reader->getRecords(names, /*num_threads=*/4);
+    ASSERT_EQ(records.size(), names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+      std::vector<char> expected(100 + i, static_cast<char>(i));
+      ASSERT_EQ(std::get<1>(records[i]), expected.size());
+      ASSERT_EQ(
+          memcmp(std::get<0>(records[i]).get(), expected.data(), expected.size()),
+          0);
+    }
+  }
+  std::remove("records_output.zip");
+}
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
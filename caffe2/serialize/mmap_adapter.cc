@@ -0,0 +1,76 @@
+#include "caffe2/serialize/mmap_adapter.h"
+#include "caffe2/serialize/file_adapter.h"
+
+#include <cstring>
+
+#include <TH/THAllocator.h>
+#include <c10/util/Exception.h>
+
+namespace caffe2 {
+namespace serialize {
+
+namespace {
+
+void deleteMappingRef(void* ctx) {
+  delete static_cast<std::shared_ptr<at::DataPtr>*>(ctx);
+}
+
+} // namespace
+
+MmapAdapter::MmapAdapter(const std::string& file_name)
+    : mapping_(std::make_shared<at::DataPtr>()),
+      size_(FileAdapter(file_name).size()) {
+  if (size_ > 0) {
+    // No flags: the file is opened read-only and mapped private, i.e.
+    // copy-on-write.
+    *mapping_ = THMapAllocator::makeDataPtr(
+        file_name.c_str(), /*flags=*/0, size_, /*actual_size_out=*/nullptr);
+  }
+}
+
+size_t MmapAdapter::size() const {
+  return size_;
+}
+
+size_t MmapAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  TORCH_CHECK(
+      pos <= size_ && n <= size_ - pos,
+      "mmap reader failed: ",
+      what,
+      ", reading ",
+      n,
+      " bytes at ",
+      pos,
+      " of a ",
+      size_,
+      " byte file.");
+  std::memcpy(buf, static_cast<const char*>(mapping_->get()) + pos, n);
+  return n;
+}
+
+at::DataPtr MmapAdapter::getDataPtr(uint64_t pos, size_t n) const {
+  TORCH_CHECK(
+      pos <= size_ && n <= size_ - pos,
+      "mmap reader failed: mapping ",
+      n,
+      " bytes at ",
+      pos,
+      " of a ",
+      size_,
+      " byte file.");
+  return at::DataPtr(
+      static_cast<char*>(mapping_->get()) + pos,
+      new std::shared_ptr<at::DataPtr>(mapping_),
+      deleteMappingRef,
+      at::kCPU);
+}
+
+bool MmapAdapter::supportsConcurrentReads() const {
+  return true;
+}
+
+MmapAdapter::~MmapAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/core/Allocator.h"
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// this is a reader that maps the whole file into memory. The mapping is
+// private: pages are shared with the page cache (and so with other processes
+// mapping the same file) until they are written to, which copies them.
+// getDataPtr() returns pointers straight into the mapping that keep it alive,
+// so PyTorchStreamReader::getRecord() doesn't copy uncompressed records.
+// Storages loaded from them are lazy: their pages are only read from the file
+// when the tensor data is first accessed, and tensors that are never used are
+// never read and never become resident.
+class CAFFE2_API MmapAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapAdapter);
+  explicit MmapAdapter(const std::string& file_name);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr getDataPtr(uint64_t pos, size_t n) const override;
+  bool supportsConcurrentReads() const override;
+  ~MmapAdapter();
+
+ private:
+  std::shared_ptr<at::DataPtr> mapping_;
+  size_t size_;
+};
+
+} // namespace serialize
+} // namespace caffe2
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "c10/core/Allocator.h"
 #include "c10/macros/Macros.h"
 
 namespace caffe2 {
@@ -16,6 +17,14 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // Returns a pointer to the n bytes at pos that shares memory with the
+  // input and keeps it alive, so that records can be loaded without a copy.
+  // The default returns an empty DataPtr, for inputs that can only be read().
+  virtual at::DataPtr getDataPtr(uint64_t pos, size_t n) const;
+  // Whether read() and getDataPtr() can be called from several threads at
+  // once, which lets PyTorchStreamReader::getRecordsAsync() issue concurrent
+  // range reads. The default is false.
+  virtual bool supportsConcurrentReads() const;
   virtual ~ReadAdapterInterface();
 };
 
@@ -184,50 +184,30 @@ class SparseAdagradOp final : public Operator<Context> {
       return true;
     }
 
-    auto block_size = Input(GRAD).numel() / n;
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).numel(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).numel(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-        adagrad_update(
-            block_size,
-            paramIn + offsetIdx,
-            gradIn + offsetI,
-            momentIn + offsetIdx,
-            paramOut + offsetIdx,
-            momentOut + offsetIdx,
-            epsilon_,
-            1.0f,
-            lr,
-            &context_);
-      }
-    }
+    const auto block_size = Input(GRAD).numel() / n;
+    // The perfkernel fuses the loop over rows and prefetches the next ones
+    const auto num_rows_processed = sparse_adagrad(
+        n,
+        block_size,
+        Input(PARAM).numel(),
+        paramIn,
+        gradIn,
+        momentIn,
+        indices,
+        paramOut,
+        momentOut,
+        epsilon_,
+        lr[0]);
+    CAFFE_ENFORCE_EQ(
+        num_rows_processed,
+        n,
+        this->debug_def().input(PARAM),
+        ", out of bound,  idx:",
+        indices[num_rows_processed],
+        " for input i:",
+        num_rows_processed,
+        " and block size:",
+        block_size);
     return true;
   }
 
@@ -262,8 +242,6 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
     const auto* lr = Input(LR).template data<T>();
     const auto* indices = Input(INDICES).template data<SIndex>();
     const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* paramIn = Input(PARAM).template data<T>();
-    const auto* momentIn = Input(MOMENT_1).template data<T>();
     auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
     auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
 
@@ -272,56 +250,28 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
       return true;
     }
 
-    auto block_size = Input(GRAD).numel() / n;
-
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).numel(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).numel(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-
-        const float* w = paramIn + offsetIdx;
-        const float* g = gradIn + offsetI;
-        const float* h = momentIn + idx;
-        float* nw = paramOut + offsetIdx;
-        float* nh = momentOut + idx;
-        float hs = 0.;
-        for (auto j = 0; j < block_size; ++j) {
-          float gj = g[j];
-          hs += gj * gj;
-        }
-        float hi = nh[0] = h[0] + hs / block_size;
-        float step = lr[0] / (std::sqrt(hi) + epsilon_);
-        for (auto j = 0; j < block_size; ++j) {
-          nw[j] = w[j] + g[j] * step;
-        }
-      }
-    }
+    const auto block_size = Input(GRAD).numel() / n;
+    // The update is done in place, the outputs are the inputs
+    const auto num_rows_processed = rowwise_sparse_adagrad(
+        n,
+        block_size,
+        Input(PARAM).numel(),
+        paramOut,
+        gradIn,
+        momentOut,
+        indices,
+        epsilon_,
+        lr[0]);
+    CAFFE_ENFORCE_EQ(
+        num_rows_processed,
+        n,
+        this->debug_def().input(PARAM),
+        ", out of bound,  idx:",
+        indices[num_rows_processed],
+        " for input i:",
+        num_rows_processed,
+        " and block size:",
+        block_size);
     return true;
   }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/adam.h"
 
 namespace caffe2 {
 
@@ -310,7 +311,32 @@ class SparseAdamOp final : public Operator<Context> {
     auto* moment1Out = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
     auto* moment2Out = Output(OUTPUT_MOMENT_2)->template mutable_data<T>();
 
-    if (OutputSize() == 3) {
+    if (OutputSize() == 3 && !enableRAdam_) {
+      // The update is done in place, the outputs are the inputs
+      const auto num_rows_processed = sparse_adam(
+          n,
+          block_size,
+          Input(PARAM).numel(),
+          paramOut,
+          gradIn,
+          moment1Out,
+          moment2Out,
+          indices,
+          beta1_,
+          beta2_,
+          epsilon_,
+          lr[0] * correction);
+      CAFFE_ENFORCE_EQ(
+          num_rows_processed,
+          n,
+          this->debug_def().input(PARAM),
+          ", out of bound,  idx:",
+          indices[num_rows_processed],
+          " for input i:",
+          num_rows_processed,
+          " and block size:",
+          block_size);
+    } else if (OutputSize() == 3) {
       for (auto i = 0; i < n; ++i) {
         auto idx = indices[i];
 
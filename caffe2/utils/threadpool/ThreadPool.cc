@@ -21,6 +21,19 @@ namespace caffe2 {
 // multiple threads; the runtime value is configurable
 constexpr size_t kDefaultMinWorkSize = 1;
 
+namespace {
+std::atomic<ThreadPool* (*)()> sharedThreadPoolGetter{nullptr};
+} // namespace
+
+ThreadPool* ThreadPool::sharedThreadPool() {
+  auto getter = sharedThreadPoolGetter.load();
+  return getter ? getter() : nullptr;
+}
+
+void ThreadPool::setSharedThreadPoolGetter(ThreadPool* (*getter)()) {
+  sharedThreadPoolGetter = getter;
+}
+
 std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
   CAFFE_ENFORCE(cpuinfo_initialize(), "cpuinfo initialization failed");
   int numThreads = cpuinfo_get_processors_count();
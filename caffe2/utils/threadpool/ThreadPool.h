@@ -33,18 +33,25 @@ constexpr size_t kCacheLineSize = 64;
 class CAFFE2_API /*alignas(kCacheLineSize)*/ ThreadPool {
  public:
   static std::unique_ptr<ThreadPool> defaultThreadPool();
+  // The pool that every Workspace hands to its operators, if a getter was
+  // set with setSharedThreadPoolGetter(), nullptr otherwise (in which case
+  // each Workspace creates its own pool, see Workspace::GetThreadPool).
+  static ThreadPool* sharedThreadPool();
+  static void setSharedThreadPoolGetter(ThreadPool* (*getter)());
   ThreadPool(int numThreads);
-  ~ThreadPool();
+  virtual ~ThreadPool();
   // Returns the number of threads currently in use
-  int getNumThreads() const;
-  void setNumThreads(size_t numThreads);
+  virtual int getNumThreads() const;
+  virtual void setNumThreads(size_t numThreads);
 
   // Sets the minimum work size (range) for which to invoke the
   // threadpool; work sizes smaller than this will just be run on the
   // main (calling) thread
   void setMinWorkSize(size_t size);
   size_t getMinWorkSize() const { return minWorkSize_; }
-  void run(const std::function<void(int, size_t)>& fn, size_t range);
+  // Virtual so that a pthreadpool_t can hand its work to another pool of
+  // threads, see pthreadpool_impl.cc.
+  virtual void run(const std::function<void(int, size_t)>& fn, size_t range);
 
   // Run an arbitrary function in a thread-safe manner accessing the Workers
   // Pool
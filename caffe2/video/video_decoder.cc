@@ -425,6 +425,16 @@ void VideoDecoder::decodeLoop(
       mustDecodeAll = true;
     }
 
+    // When decoding starts from start_ts, the frames between the keyframe
+    // found by av_seek_frame and start_ts are only decoded to reconstruct the
+    // frames after them. Frames that no other frame references (typically
+    // B-frames) are useless there, so let the decoder drop them until the
+    // packets reach start_ts.
+    bool skipNonRefFrames = !mustDecodeAll && start_ts > 0;
+    if (skipNonRefFrames) {
+      videoCodecContext_->skip_frame = AVDISCARD_NONREF;
+    }
+
     int gotPicture = 0;
     int eof = 0;
     int selectiveDecodedFrames = 0;
@@ -486,6 +496,12 @@ void VideoDecoder::decodeLoop(
             av_free_packet(&packet);
             continue;
           }
+
+          if (skipNonRefFrames &&
+              (packet.pts == AV_NOPTS_VALUE || packet.pts >= start_ts)) {
+            videoCodecContext_->skip_frame = AVDISCARD_DEFAULT;
+            skipNonRefFrames = false;
+          }
         }
 
         ret = avcodec_decode_video2(
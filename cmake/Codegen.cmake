@@ -110,13 +110,34 @@ if (INTERN_BUILD_ATEN_OPS)
     ENDIF(COMPILER_SUPPORTS_NO_AVX256_SPLIT)
 
     LIST(APPEND CPU_CAPABILITY_NAMES "AVX2")
+    # Every CPU with AVX2 has the F16C conversions, which Vec256<Half> uses.
     IF(MSVC)
       LIST(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX2")
     ELSE(MSVC)
-      LIST(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx2 -mfma ${CPU_NO_AVX256_SPLIT_FLAGS}")
+      LIST(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx2 -mfma -mf16c ${CPU_NO_AVX256_SPLIT_FLAGS}")
     ENDIF(MSVC)
   ENDIF(CXX_AVX2_FOUND)
 
+  # Kernels compiled for AVX512 use the Vec256 code of AVX2, and the compiler
+  # vectorizes the rest of them with 512 bit instructions.
+  IF(CXX_AVX512_FOUND AND CXX_AVX2_FOUND)
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+
+    # GCC tuned for some AVX512 processors prefers 256 bit vectors when it
+    # vectorizes loops.
+    check_cxx_compiler_flag("-mprefer-vector-width=512" COMPILER_SUPPORTS_PREFER_VECTOR_WIDTH)
+    IF(COMPILER_SUPPORTS_PREFER_VECTOR_WIDTH)
+      SET(CPU_PREFER_VECTOR_WIDTH_FLAGS "-mprefer-vector-width=512")
+    ENDIF(COMPILER_SUPPORTS_PREFER_VECTOR_WIDTH)
+
+    LIST(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    IF(MSVC)
+      LIST(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512")
+    ELSE(MSVC)
+      LIST(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx2 -mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma -mf16c ${CPU_NO_AVX256_SPLIT_FLAGS} ${CPU_PREFER_VECTOR_WIDTH_FLAGS}")
+    ENDIF(MSVC)
+  ENDIF(CXX_AVX512_FOUND AND CXX_AVX2_FOUND)
+
   list(LENGTH CPU_CAPABILITY_NAMES NUM_CPU_CAPABILITY_NAMES)
   math(EXPR NUM_CPU_CAPABILITY_NAMES "${NUM_CPU_CAPABILITY_NAMES}-1")
 
@@ -78,6 +78,7 @@ function (caffe2_print_configuration_summary)
     message(STATUS "    NVCC executable     : ${CUDA_NVCC_EXECUTABLE}")
     message(STATUS "    NVCC flags          : ${CUDA_NVCC_FLAGS}")
     message(STATUS "    CUDA host compiler  : ${CUDA_HOST_COMPILER}")
+    message(STATUS "    USE_CUPTI           : ${USE_CUPTI}")
     message(STATUS "    USE_TENSORRT        : ${USE_TENSORRT}")
     if(${USE_TENSORRT})
       message(STATUS "      TensorRT runtime library: ${TENSORRT_LIBRARY}")
@@ -30,6 +30,9 @@
 #   USE_CUDNN=0
 #     disables the cuDNN build
 #
+#   USE_CUPTI=1
+#     enables tracing CUDA activities with CUPTI in the autograd profiler
+#
 #   USE_FBGEMM=0
 #     disables the FBGEMM build
 #
@@ -155,6 +158,7 @@
 #     possible values:
 #       OMP - use OpenMP for intra-op and native backend for inter-op tasks
 #       NATIVE - use native thread pool for both intra- and inter-op tasks
+#       NATIVE_WS - like NATIVE, but with a work-stealing intra-op thread pool
 #       TBB - using TBB for intra- and native thread pool for inter-op parallelism
 #
 #   USE_TBB
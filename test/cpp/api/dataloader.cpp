@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <torch/data/detail/queue.h>
 #include <torch/torch.h>
 
 #include <test/cpp/api/support.h>
@@ -8,11 +9,13 @@
 #include <c10/util/tempfile.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <stdexcept>
@@ -688,6 +691,92 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, BoundedQueuePushAndPopFromSameThread) {
+  torch::data::detail::BoundedQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  ASSERT_EQ(queue.pop(), 1);
+  ASSERT_EQ(queue.pop(), 2);
+}
+
+TEST(DataTest, BoundedQueueRoundsUpItsCapacity) {
+  ASSERT_EQ(torch::data::detail::BoundedQueue<int>(0).capacity(), 2);
+  ASSERT_EQ(torch::data::detail::BoundedQueue<int>(5).capacity(), 8);
+}
+
+TEST(DataTest, BoundedQueueTryPushFailsWhenFull) {
+  torch::data::detail::BoundedQueue<int> queue(2);
+  int value = 1;
+  ASSERT_TRUE(queue.try_push(value));
+  ASSERT_TRUE(queue.try_push(value));
+  ASSERT_FALSE(queue.try_push(value));
+  ASSERT_TRUE(queue.try_pop(value));
+  ASSERT_TRUE(queue.try_push(value));
+}
+
+TEST(DataTest, BoundedQueuePopWithTimeoutThrowsUponTimeout) {
+  torch::data::detail::BoundedQueue<int> queue(2);
+  ASSERT_THROWS_WITH(
+      queue.pop(10 * kMillisecond),
+      "Timeout in DataLoader queue while waiting for next batch "
+      "(timeout was 10 ms)");
+}
+
+TEST(DataTest, BoundedQueuePushBlocksUntilThereIsSpace) {
+  torch::data::detail::BoundedQueue<int> queue(2);
+  queue.push(1);
+  queue.push(2);
+  std::thread thread([&queue] {
+    std::this_thread::sleep_for(20 * kMillisecond);
+    queue.pop();
+  });
+  queue.push(3);
+  thread.join();
+  ASSERT_EQ(queue.pop(), 2);
+  ASSERT_EQ(queue.pop(), 3);
+}
+
+TEST(DataTest, BoundedQueueWithManyProducersAndConsumers) {
+  torch::data::detail::BoundedQueue<std::unique_ptr<int>> queue(4);
+  const int kProducers = 4, kConsumers = 3, kValues = 1000;
+  std::atomic<int64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kValues; ++i) {
+        queue.push(torch::make_unique<int>(i));
+      }
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      while (auto value = queue.pop()) {
+        sum += *value;
+      }
+    });
+  }
+  for (int p = 0; p < kProducers; ++p) {
+    threads[p].join();
+  }
+  // An empty pointer stops a consumer.
+  for (int c = 0; c < kConsumers; ++c) {
+    queue.push(nullptr);
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads[kProducers + c].join();
+  }
+  ASSERT_EQ(sum, kProducers * kValues * (kValues - 1) / 2);
+}
+
+TEST(DataTest, BoundedQueueClearEmptiesTheQueue) {
+  torch::data::detail::BoundedQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+  ASSERT_EQ(queue.clear(), 3);
+  ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -1030,6 +1119,9 @@ TEST(DataLoaderTest, DataLoaderOptionsDefaultAsExpected) {
   ASSERT_EQ(full_options.max_jobs, 0);
   ASSERT_FALSE(full_options.timeout.has_value());
   ASSERT_TRUE(full_options.enforce_ordering);
+  ASSERT_FALSE(full_options.pin_memory);
+  ASSERT_FALSE(full_options.device.has_value());
+  ASSERT_EQ(full_options.device_prefetch, 2);
 }
 
 TEST(DataLoaderTest, DataLoaderOptionsCoalesceOptionalValues) {
@@ -2302,4 +2394,208 @@ TEST(DataLoaderTest, CustomPreprocessPolicy) {
       }
     }
   }
-}
\ No newline at end of file
+}
+struct SequentialChunkReader : public datasets::ChunkDataReader<int> {
+  using BatchType = datasets::ChunkDataReader<int>::ChunkType;
+  explicit SequentialChunkReader(size_t chunk_count, size_t chunk_size = 5)
+      : chunk_count_(chunk_count), chunk_size_(chunk_size) {}
+
+  // Chunk i holds the examples [i * chunk_size, (i + 1) * chunk_size).
+  BatchType read_chunk(size_t chunk_index) override {
+    BatchType batch_data(chunk_size_);
+    std::iota(batch_data.begin(), batch_data.end(), chunk_index * chunk_size_);
+    return batch_data;
+  }
+
+  size_t chunk_count() override {
+    return chunk_count_;
+  };
+
+  void reset() override{};
+
+  size_t chunk_count_;
+  size_t chunk_size_;
+};
+
+template <typename ChunkReader, typename ChunkSampler>
+std::vector<int> read_all_examples(
+    ChunkReader reader,
+    ChunkSampler chunk_sampler,
+    datasets::ChunkDatasetOptions options) {
+  const size_t batch_size = options.batch_size();
+  samplers::SequentialSampler example_sampler(0);
+  auto dataset = datasets::make_shared_dataset<datasets::
+      ChunkDataset<ChunkReader, ChunkSampler, samplers::SequentialSampler>>(
+      std::move(reader),
+      std::move(chunk_sampler),
+      example_sampler,
+      std::move(options));
+  auto data_loader = torch::data::make_data_loader(
+      dataset, DataLoaderOptions(batch_size).workers(0));
+  std::vector<int> result;
+  for (auto& batch : *data_loader) {
+    std::copy(batch.begin(), batch.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+TEST(DataLoaderTest, ChunkDatasetReadsInFlight) {
+  struct Reads {
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> max{0};
+  };
+
+  struct R : public SequentialChunkReader {
+    explicit R(std::shared_ptr<Reads> reads)
+        : SequentialChunkReader(20), reads_(std::move(reads)) {}
+
+    BatchType read_chunk(size_t chunk_index) override {
+      const size_t current = ++reads_->current;
+      size_t max = reads_->max;
+      while (current > max && !reads_->max.compare_exchange_weak(max, current)) {
+      }
+      std::this_thread::sleep_for(5 * kMillisecond);
+      --reads_->current;
+      return SequentialChunkReader::read_chunk(chunk_index);
+    }
+
+    std::shared_ptr<Reads> reads_;
+  };
+
+  for (size_t reads_in_flight : {1, 4}) {
+    auto reads = std::make_shared<Reads>();
+    auto result = read_all_examples(
+        R(reads),
+        samplers::SequentialSampler(0),
+        datasets::ChunkDatasetOptions(1, 5).reads_in_flight(reads_in_flight));
+    std::vector<int> expected(100);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(result, expected);
+    if (reads_in_flight == 1) {
+      ASSERT_EQ(reads->max, 1);
+    } else {
+      ASSERT_GT(reads->max, 1);
+      ASSERT_LE(reads->max, reads_in_flight);
+    }
+  }
+}
+
+TEST(DataLoaderTest, ChunkDatasetShuffleBuffer) {
+  const size_t shuffle_buffer_size = 7;
+  auto result = read_all_examples(
+      SequentialChunkReader(10),
+      samplers::SequentialSampler(0),
+      datasets::ChunkDatasetOptions(1, 5).shuffle_buffer_size(
+          shuffle_buffer_size));
+
+  std::vector<int> expected(50);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_NE(result, expected);
+  // An example can only be held back by the shuffle buffer, not moved up by
+  // more than its size.
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_LE(result[i], static_cast<int>(i + shuffle_buffer_size));
+  }
+  std::sort(result.begin(), result.end());
+  ASSERT_EQ(result, expected);
+}
+
+TEST(DataLoaderTest, ChunkDatasetShardsChunksAcrossRanks) {
+  const size_t num_replicas = 3;
+  std::vector<int> all_examples;
+  for (size_t rank = 0; rank < num_replicas; ++rank) {
+    auto result = read_all_examples(
+        SequentialChunkReader(9),
+        samplers::DistributedSequentialSampler(0, num_replicas, rank),
+        datasets::ChunkDatasetOptions(1, 5).reads_in_flight(2));
+    // Every rank reads 3 contiguous chunks.
+    std::vector<int> expected(15);
+    std::iota(expected.begin(), expected.end(), rank * 15);
+    ASSERT_EQ(result, expected);
+    all_examples.insert(all_examples.end(), result.begin(), result.end());
+  }
+  std::vector<int> expected(45);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(all_examples, expected);
+}
+
+TEST(DataLoaderTest, CopyingBatchesToTheCPUThrows) {
+  ASSERT_THROWS_WITH(
+      torch::data::make_data_loader(
+          DummyDataset(), DataLoaderOptions().device(torch::kCPU)),
+      "The DataLoader can only copy batches to devices other than the CPU");
+}
+
+TEST(DataLoaderTest, PinsBatchesWithPinMemory_CUDA) {
+  auto dataset = datasets::TensorDataset(torch::arange(12).view({6, 2}))
+                     .map(transforms::Stack<TensorExample>());
+  for (size_t workers : {0, 2}) {
+    auto data_loader = torch::data::make_data_loader(
+        dataset, DataLoaderOptions(2).workers(workers).pin_memory(true));
+    size_t batches = 0;
+    for (auto& batch : *data_loader) {
+      ASSERT_TRUE(batch.data.is_pinned());
+      ASSERT_EQ(batch.data.size(0), 2);
+      ++batches;
+    }
+    ASSERT_EQ(batches, 3);
+  }
+}
+
+TEST(DataLoaderTest, CopiesBatchesToTheDevice_CUDA) {
+  auto data = torch::arange(200).view({100, 2});
+  auto dataset =
+      datasets::TensorDataset(data).map(transforms::Stack<TensorExample>());
+  for (size_t device_prefetch : {0, 1, 4}) {
+    auto data_loader = torch::data::make_data_loader(
+        dataset,
+        DataLoaderOptions(10)
+            .workers(2)
+            .pin_memory(true)
+            .device(torch::kCUDA)
+            .device_prefetch(device_prefetch));
+    // Twice, to check that resetting the DataLoader drops nothing.
+    for (size_t epoch = 0; epoch < 2; ++epoch) {
+      std::vector<torch::Tensor> batches;
+      for (auto& batch : *data_loader) {
+        ASSERT_TRUE(batch.data.is_cuda());
+        batches.push_back(batch.data);
+      }
+      ASSERT_EQ(batches.size(), 10);
+      ASSERT_TRUE(torch::cat(batches).cpu().equal(data));
+    }
+  }
+}
+
+TEST(DataLoaderTest, ReportsStats) {
+  const size_t kWorkers = 2;
+  auto data_loader = torch::data::make_data_loader(
+      DummyDataset(100), DataLoaderOptions(10).workers(kWorkers));
+  for (auto& batch : *data_loader) {
+    (void)batch;
+  }
+
+  auto stats = data_loader->stats();
+  // 2 * kWorkers requests are prefetched, and one more after every batch.
+  ASSERT_EQ(stats.sampler.count, 2 * kWorkers + 10);
+  ASSERT_EQ(stats.get_batch.count, 10);
+  ASSERT_GE(stats.get_batch.max, stats.get_batch.mean());
+  ASSERT_EQ(stats.pin_memory.count, 0);
+  ASSERT_EQ(stats.copy_to_device.count, 0);
+  // The last wait finds the DataLoader exhausted.
+  ASSERT_EQ(stats.wait.count, 11);
+  ASSERT_EQ(stats.worker_busy.size(), kWorkers);
+  ASSERT_EQ(stats.worker_idle.size(), kWorkers);
+  ASSERT_EQ(stats.queue_depth.size(), 2 * kWorkers + 1);
+  size_t requests = 0;
+  for (size_t count : stats.queue_depth) {
+    requests += count;
+  }
+  ASSERT_EQ(requests, 11);
+
+  data_loader->reset_stats();
+  stats = data_loader->stats();
+  ASSERT_EQ(stats.sampler.count, 0);
+  ASSERT_EQ(stats.get_batch.total.count(), 0);
+  ASSERT_EQ(stats.worker_busy[0].count(), 0);
+}
@@ -608,6 +608,37 @@ TEST_F(ModuleTest, ContainsParametersWithTheCorrectName) {
   ASSERT_TRUE(parameters.contains("c"));
 }
 
+TEST_F(ModuleTest, ParametersCacheIsInvalidatedByStructuralChanges) {
+  struct TestModel : public torch::nn::Module {
+    torch::nn::Linear l1{nullptr};
+    TestModel() {
+      l1 = register_module("l1", torch::nn::Linear(3, 4));
+    }
+  };
+  auto model = std::make_shared<TestModel>();
+  ASSERT_EQ(model->parameters().size(), 2);
+  ASSERT_TRUE(model->parameters()[0].is_same(model->l1->weight));
+
+  model->l1->register_parameter("extra", torch::ones({2}));
+  ASSERT_EQ(model->parameters().size(), 3);
+
+  model->l1 = model->replace_module("l1", torch::nn::Linear(5, 6));
+  ASSERT_EQ(model->parameters().size(), 2);
+  ASSERT_TRUE(model->parameters()[0].is_same(model->l1->weight));
+
+  model->register_module("l2", torch::nn::Linear(6, 1));
+  ASSERT_EQ(model->parameters().size(), 4);
+
+  model->unregister_module("l2");
+  ASSERT_EQ(model->parameters().size(), 2);
+
+  auto clone = std::dynamic_pointer_cast<Linear>(model->l1->clone());
+  auto clone_parameters = clone->parameters();
+  ASSERT_EQ(clone_parameters.size(), 2);
+  ASSERT_TRUE(clone_parameters[0].is_same(clone->weight));
+  ASSERT_FALSE(clone_parameters[0].is_same(model->l1->weight));
+}
+
 struct BufferTestModule : Module {
   BufferTestModule() {
     a = register_buffer("a", torch::zeros({2, 2}));
@@ -301,6 +301,34 @@ TEST(OptimTest, ProducesPyTorchValues_SGDWithWeightDecayAndNesterovMomentum) {
       expected_parameters::SGD_with_weight_decay_and_nesterov_momentum());
 }
 
+TEST(OptimTest, SparseAdagradMatchesDense) {
+  torch::manual_seed(0);
+
+  Embedding sparse_embedding(EmbeddingOptions(20, 16).sparse(true));
+  Embedding dense_embedding(EmbeddingOptions(20, 16));
+  {
+    torch::NoGradGuard no_grad;
+    dense_embedding->weight.copy_(sparse_embedding->weight);
+  }
+  const auto options = AdagradOptions(0.1).lr_decay(1e-3);
+  Adagrad sparse_optimizer(sparse_embedding->parameters(), options);
+  Adagrad dense_optimizer(dense_embedding->parameters(), options);
+
+  for (int step = 0; step < 5; ++step) {
+    const auto indices = torch::randint(20, {8}, torch::kLong);
+    const auto target = torch::randn({8, 16});
+    sparse_optimizer.zero_grad();
+    dense_optimizer.zero_grad();
+    (sparse_embedding->forward(indices) - target).pow(2).sum().backward();
+    (dense_embedding->forward(indices) - target).pow(2).sum().backward();
+    ASSERT_TRUE(sparse_embedding->weight.grad().is_sparse());
+    sparse_optimizer.step();
+    dense_optimizer.step();
+  }
+  ASSERT_TRUE(torch::allclose(
+      sparse_embedding->weight, dense_embedding->weight, 1e-5, 1e-6));
+}
+
 TEST(OptimTest, ZeroGrad) {
   torch::manual_seed(0);
 
@@ -328,6 +356,45 @@ TEST(OptimTest, ZeroGrad) {
   }
 }
 
+TEST(OptimTest, FlattenedSGDMatchesUnflattened) {
+  torch::manual_seed(0);
+
+  Sequential flat_model(Linear(3, 4), Functional(torch::tanh), Linear(4, 2));
+  Sequential model(Linear(3, 4), Functional(torch::tanh), Linear(4, 2));
+  {
+    torch::NoGradGuard no_grad;
+    auto flat_parameters = flat_model->parameters();
+    auto parameters = model->parameters();
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      parameters[i].copy_(flat_parameters[i]);
+    }
+  }
+  const auto options =
+      SGDOptions(0.1).momentum(0.9).weight_decay(1e-2).nesterov(true);
+  SGD flat_optimizer(flat_model->parameters(), options);
+  SGD optimizer(model->parameters(), options);
+  flat_optimizer.flatten_param_groups();
+  ASSERT_TRUE(
+      torch::optim::detail::flat_view(flat_model->parameters()).defined());
+
+  for (int step = 0; step < 5; ++step) {
+    const auto input = torch::randn({8, 3});
+    flat_optimizer.zero_grad();
+    optimizer.zero_grad();
+    flat_model->forward(input).pow(2).sum().backward();
+    model->forward(input).pow(2).sum().backward();
+    flat_optimizer.step();
+    optimizer.step();
+  }
+
+  auto flat_parameters = flat_model->parameters();
+  auto parameters = model->parameters();
+  ASSERT_TRUE(torch::optim::detail::flat_view(flat_parameters).defined());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    ASSERT_TRUE(torch::allclose(flat_parameters[i], parameters[i]));
+  }
+}
+
 TEST(OptimTest, ExternalVectorOfParameters) {
   torch::manual_seed(0);
 
@@ -436,3 +436,36 @@ TEST_F(SequentialTest, PrettyPrintSequential) {
       "  (lstm): torch::nn::LSTM(input_size=4, hidden_size=5, layers=1, dropout=0)\n"
       ")");
 }
+
+TEST_F(SequentialTest, StaticSequentialForwardMatchesSequential) {
+  Linear first(3, 4), second(4, 2);
+  Sequential sequential(first, ReLU(), second);
+  auto static_sequential = make_static_sequential(first, ReLU(), second);
+  ASSERT_EQ(static_sequential->size(), 3);
+  ASSERT_EQ(static_sequential->parameters().size(), 4);
+
+  auto input = torch::randn({5, 3});
+  torch::Tensor output = static_sequential->forward(input);
+  ASSERT_TRUE(output.equal(sequential->forward(input)));
+}
+
+TEST_F(SequentialTest, StaticSequentialClone) {
+  auto static_sequential =
+      make_static_sequential(Linear(3, 4), Functional(torch::relu), Linear(4, 2));
+  auto clone = std::dynamic_pointer_cast<
+      StaticSequentialImpl<Linear, Functional, Linear>>(
+      static_sequential->clone());
+  ASSERT_NE(clone, nullptr);
+  ASSERT_NE(clone->get<0>().get(), static_sequential->get<0>().get());
+
+  auto params = static_sequential->named_parameters();
+  auto cloned_params = clone->named_parameters();
+  ASSERT_EQ(params.size(), cloned_params.size());
+  for (auto& param : params) {
+    ASSERT_FALSE(param->is_same(cloned_params[param.key()]));
+    ASSERT_TRUE(param->equal(cloned_params[param.key()]));
+  }
+
+  auto input = torch::randn({5, 3});
+  ASSERT_TRUE(clone->forward(input).equal(static_sequential->forward(input)));
+}
@@ -0,0 +1,87 @@
+#include <torch/csrc/jit/interpreter.h>
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/irparser.h>
+#include <torch/csrc/jit/passes/batch_mm.h>
+#include <torch/csrc/jit/testing/file_check.h>
+#include "test/cpp/jit/test_base.h"
+#include "test/cpp/jit/test_utils.h"
+
+namespace torch {
+namespace jit {
+
+void testBatchMMGroups() {
+  auto run_graph = [](const std::shared_ptr<Graph>& graph, Stack stack) {
+    Code code(graph);
+    InterpreterState(code).run(stack);
+    return stack;
+  };
+  auto check_batched = [&](const std::string& ir,
+                           const std::vector<Stack>& input_stacks) {
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(ir, &*graph);
+    auto batched = graph->copy();
+    BatchMM(batched);
+    batched->lint();
+    testing::FileCheck()
+        .check("prim::MMBatchGroup")
+        ->check_not("aten::matmul")
+        ->check_not("aten::linear")
+        ->check_not("aten::addmm")
+        ->run(*batched);
+    for (const Stack& inputs : input_stacks) {
+      auto expected = run_graph(graph, inputs);
+      auto outputs = run_graph(batched, inputs);
+      ASSERT_EQ(outputs.size(), expected.size());
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        ASSERT_TRUE(
+            outputs[i].toTensor().allclose(expected[i].toTensor(), 1e-5, 1e-5));
+      }
+    }
+  };
+
+  auto a = at::randn({5, 2, 3}, at::kCPU);
+  auto b = at::randn({5, 3, 4}, at::kCPU);
+  // the last stack can't be batched, so the matmuls are computed one by one
+  check_batched(
+      R"IR(
+graph(%a0 : Tensor, %a1 : Tensor, %a2 : Tensor, %b0 : Tensor, %b1 : Tensor, %b2 : Tensor):
+  %c0 : Tensor = aten::matmul(%a0, %b0)
+  %c1 : Tensor = aten::matmul(%a1, %b1)
+  %c2 : Tensor = aten::matmul(%a2, %b2)
+  return (%c0, %c1, %c2)
+  )IR",
+      {{a, a * 2, a * 3, b, b * 2, b * 3},
+       {at::randn({1, 2, 3}, at::kCPU), a, a, b, b, b}});
+
+  auto x = at::randn({4, 7, 8}, at::kCPU);
+  auto w = at::randn({6, 8}, at::kCPU);
+  auto bias = at::randn({6}, at::kCPU);
+  // a shared input makes the group a single wider GEMM, separate inputs a bmm
+  check_batched(
+      R"IR(
+graph(%x0 : Tensor, %x1 : Tensor, %x2 : Tensor, %w0 : Tensor, %w1 : Tensor, %w2 : Tensor, %b0 : Tensor, %b1 : Tensor, %b2 : Tensor):
+  %q : Tensor = aten::linear(%x0, %w0, %b0)
+  %k : Tensor = aten::linear(%x1, %w1, %b1)
+  %v : Tensor = aten::linear(%x2, %w2, %b2)
+  return (%q, %k, %v)
+  )IR",
+      {{x, x, x, w, w * 2, w * 3, bias, bias * 2, bias * 3},
+       {x, x * 2, x * 3, w, w * 2, w * 3, bias, bias * 2, bias * 3}});
+
+  auto m = at::randn({4, 8}, at::kCPU);
+  check_batched(
+      R"IR(
+graph(%s0 : Tensor, %s1 : Tensor, %s2 : Tensor, %m0 : Tensor, %m1 : Tensor, %m2 : Tensor, %w0 : Tensor, %w1 : Tensor, %w2 : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %two : int = prim::Constant[value=2]()
+  %c0 : Tensor = aten::addmm(%s0, %m0, %w0, %two, %one)
+  %c1 : Tensor = aten::addmm(%s1, %m1, %w1, %two, %one)
+  %c2 : Tensor = aten::addmm(%s2, %m2, %w2, %two, %one)
+  return (%c0, %c1, %c2)
+  )IR",
+      {{bias, bias, bias, m, m, m, w.t(), w.t() * 2, w.t() * 3},
+       {bias, bias * 2, bias * 3, m, m * 2, m * 3, w.t(), w.t(), w.t()}});
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,71 @@
+#include <torch/csrc/jit/interpreter.h>
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/irparser.h>
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
+#include <torch/csrc/jit/testing/file_check.h>
+#include "test/cpp/jit/test_base.h"
+#include "test/cpp/jit/test_utils.h"
+
+namespace torch {
+namespace jit {
+
+void testForkIndependentBranches() {
+  auto run_graph = [](const std::shared_ptr<Graph>& graph, Stack stack) {
+    Code code(graph);
+    InterpreterState(code).run(stack);
+    return stack.at(0).toTensor();
+  };
+  auto x = at::randn({4, 5}, at::kCPU);
+  auto y = at::randn({4, 5}, at::kCPU);
+  {
+    // two towers joined by a mul, the first one is forked and the second
+    // one runs on the calling thread meanwhile
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%x : Tensor, %y : Tensor):
+  %a : Tensor = aten::relu(%x)
+  %b : Tensor = aten::tanh(%a)
+  %c : Tensor = aten::sigmoid(%y)
+  %d : Tensor = aten::neg(%c)
+  %e : Tensor = aten::mul(%b, %d)
+  return (%e)
+  )IR",
+        &*graph);
+    auto expected = run_graph(graph, {x, y});
+    ASSERT_TRUE(ForkIndependentBranches(graph));
+    graph->lint();
+    testing::FileCheck()
+        .check("prim::fork")
+        ->check("aten::sigmoid")
+        ->check("aten::neg")
+        ->check("aten::wait")
+        ->check("aten::mul")
+        ->run(*graph);
+    testing::FileCheck()
+        .check_count("= prim::fork", 1, /*exactly*/ true)
+        ->run(*graph);
+    ASSERT_TRUE(exactlyEqual(run_graph(graph, {x, y}), expected));
+  }
+  {
+    // %y is written to, so nothing reading it may be moved
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%x : Tensor, %y : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %a : Tensor = aten::relu(%x)
+  %b : Tensor = aten::add(%a, %y, %one)
+  %c : Tensor = aten::sigmoid_(%y)
+  %d : Tensor = aten::neg(%c)
+  %e : Tensor = aten::mul(%b, %d)
+  return (%e)
+  )IR",
+        &*graph);
+    ASSERT_FALSE(ForkIndependentBranches(graph));
+    testing::FileCheck().check_not("prim::fork")->run(*graph);
+  }
+}
+
+} // namespace jit
+} // namespace torch
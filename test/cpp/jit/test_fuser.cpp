@@ -9,6 +9,7 @@
 #include "torch/csrc/jit/autodiff.h"
 #include "torch/csrc/jit/code_template.h"
 #include "torch/csrc/jit/custom_operator.h"
+#include "torch/csrc/jit/fuser/disk_cache.h"
 #include "torch/csrc/jit/fuser/interface.h"
 #include "torch/csrc/jit/import.h"
 #include "torch/csrc/jit/irparser.h"
@@ -43,9 +44,19 @@
 #include <ATen/ATen.h>
 
 #include <c10/util/Exception.h>
+#include <c10/util/tempfile.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdio>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -178,6 +189,210 @@ void testFusion() {
   };
 }
 
+void testFusionCPU() {
+  // CPU kernels are interpreted by default, so this needs no compiler.
+  torch::jit::overrideCanFuseOnCPU(true);
+
+  auto testLSTMCell = [&](int ti, int tj) {
+    const auto graph_string = R"IR(
+      graph(%0 : Tensor,
+            %1 : Tensor,
+            %2 : Tensor,
+            %3 : Tensor,
+            %4 : Tensor):
+        %5 : Tensor = aten::sigmoid(%4)
+        %6 : Tensor = aten::sigmoid(%3)
+        %7 : Tensor = aten::tanh(%2)
+        %8 : Tensor = aten::sigmoid(%1)
+        %9 : Tensor = aten::mul(%6, %0)
+        %10 : Tensor = aten::mul(%5, %7)
+        %11 : int = prim::Constant[value=1]()
+        %12 : Tensor = aten::add(%9, %10, %11)
+        %13 : Tensor = aten::tanh(%12)
+        %14 : Tensor = aten::mul(%8, %13)
+        return (%14, %12))IR";
+    Graph graph;
+    torch::jit::script::parseIR(graph_string, &graph);
+
+    std::vector<at::Tensor> inputs;
+    for (size_t i = 0; i < graph.inputs().size(); i++) {
+      std::vector<int64_t> dims = {16, 17, 33};
+      std::swap(dims[ti], dims[tj]);
+      inputs.push_back(at::rand(dims).transpose(ti, tj));
+    }
+    auto out1 = inputs[3].sigmoid() * inputs[0] +
+        inputs[4].sigmoid() * inputs[2].tanh();
+    auto out0 = inputs[1].sigmoid() * out1.tanh();
+
+    auto code = debugGetFusedKernelCode(graph, inputs);
+    testing::FileCheck().check("interpreted fusion")->run(code);
+    auto outputs = debugLaunchGraph(graph, inputs);
+    ASSERT_EQ(outputs.size(), 2);
+    ASSERT_TRUE(outputs[0].allclose(out0, 1e-5, 1e-6));
+    ASSERT_TRUE(outputs[1].allclose(out1, 1e-5, 1e-6));
+  };
+  testLSTMCell(0, 0);
+  testLSTMCell(0, 1);
+  testLSTMCell(1, 2);
+
+  {
+    // Comparisons produce bools, clamp bounds may be None and doubles are
+    // computed in double.
+    const auto graph_string = R"IR(
+      graph(%0 : Tensor,
+            %1 : Tensor):
+        %none : None = prim::Constant()
+        %zero : float = prim::Constant[value=0.]()
+        %half : float = prim::Constant[value=0.5]()
+        %2 : Tensor = aten::gt(%0, %half)
+        %3 : Tensor = aten::clamp(%1, %zero, %none)
+        %4 : Tensor = aten::neg(%0)
+        %5 : Tensor = aten::where(%2, %3, %4)
+        return (%5, %2))IR";
+    Graph graph;
+    torch::jit::script::parseIR(graph_string, &graph);
+
+    for (auto dtype : {at::kFloat, at::kDouble}) {
+      auto a = at::rand({100, 7}, dtype);
+      auto b = at::randn({100, 7}, dtype);
+      auto cond = a > 0.5;
+      auto expected = at::where(cond, b.clamp_min(0), a.neg());
+      auto outputs = debugLaunchGraph(graph, {a, b});
+      ASSERT_EQ(outputs.size(), 2);
+      ASSERT_EQ(outputs[0].scalar_type(), dtype);
+      ASSERT_TRUE(outputs[0].equal(expected));
+      ASSERT_TRUE(outputs[1].equal(cond));
+    }
+  }
+
+  {
+    // Concatenated outputs
+    const auto graph_string = R"IR(
+      graph(%0 : Tensor,
+            %1 : Tensor):
+        %2 : Tensor = aten::mul(%0, %1)
+        %3 : Tensor = prim::FusedConcat[dim=1](%0, %2)
+        return (%2, %3))IR";
+    Graph graph;
+    torch::jit::script::parseIR(graph_string, &graph);
+
+    auto a = at::rand({3, 4, 5});
+    auto b = at::rand({4, 3, 5}).transpose(0, 1);
+    auto outputs = debugLaunchGraph(graph, {a, b});
+    ASSERT_EQ(outputs.size(), 2);
+    ASSERT_TRUE(outputs[0].equal(a * b));
+    ASSERT_TRUE(outputs[1].equal(at::cat({a, a * b}, 1)));
+  }
+
+  torch::jit::overrideCanFuseOnCPU(false);
+}
+
+void testFusionRowwise() {
+  torch::jit::overrideCanFuseOnCPU(true);
+
+  auto runGraph = [](const std::shared_ptr<Graph>& graph,
+                     std::vector<IValue> inputs) {
+    Code code(graph);
+    InterpreterState interp(code);
+    Stack stack(inputs.begin(), inputs.end());
+    interp.run(stack);
+    return stack.at(0).toTensor();
+  };
+
+  {
+    // Layer norm ends the group of its input.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%x : Float(16, 33),
+      %y : Float(16, 33),
+      %w : Float(33),
+      %b : Float(33)):
+  %one : int = prim::Constant[value=1]()
+  %eps : float = prim::Constant[value=1e-05]()
+  %shape : int[] = prim::Constant[value=[33]]()
+  %cudnn : bool = prim::Constant[value=0]()
+  %z : Float(16, 33) = aten::add(%x, %y, %one)
+  %n : Float(16, 33) = aten::layer_norm(%z, %shape, %w, %b, %eps, %cudnn)
+  return (%n)
+  )IR",
+        &*graph);
+    FuseGraph(graph);
+    testing::FileCheck()
+        .check("prim::FusionGroup")
+        ->check_not("aten::layer_norm")
+        ->check("aten::add")
+        ->check("aten::layer_norm")
+        ->run(*graph);
+
+    auto x = at::randn({16, 33});
+    auto y = at::randn({16, 33});
+    auto w = at::randn({33});
+    auto b = at::randn({33});
+    auto expected = at::layer_norm(x + y, {33}, w, b);
+    auto output = runGraph(graph, {x, y, w, b});
+    ASSERT_TRUE(output.allclose(expected, 1e-4, 1e-5));
+  }
+
+  {
+    // Row reductions are fused into the ops using them, but are never
+    // outputs of a group.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%x : Float(16, 33)):
+  %one : int = prim::Constant[value=1]()
+  %minus_one : int = prim::Constant[value=-1]()
+  %dims : int[] = prim::Constant[value=[-1]]()
+  %keepdim : bool = prim::Constant[value=1]()
+  %none : None = prim::Constant()
+  %m : Float(16, 1) = aten::mean(%x, %dims, %keepdim, %none)
+  %c : Float(16, 33) = aten::sub(%x, %m, %one)
+  %s : Float(16, 33) = aten::log_softmax(%c, %minus_one, %none)
+  %t : Float(16, 1) = aten::sum(%s, %dims, %keepdim, %none)
+  return (%s, %t)
+  )IR",
+        &*graph);
+    FuseGraph(graph);
+    testing::FileCheck()
+        .check("prim::FusionGroup")
+        ->check("aten::sum")
+        ->check("aten::mean")
+        ->check("aten::log_softmax")
+        ->run(*graph);
+
+    auto x = at::randn({16, 33});
+    auto expected = at::log_softmax(x - x.mean(-1, true), -1);
+    auto output = runGraph(graph, {x});
+    ASSERT_TRUE(output.allclose(expected, 1e-4, 1e-5));
+  }
+
+  {
+    // Runs the fallback when the result only has the shape of a reduction.
+    const auto graph_string = R"IR(
+      graph(%0 : Tensor,
+            %1 : Tensor):
+        %one : int = prim::Constant[value=1]()
+        %dims : int[] = prim::Constant[value=[-1]]()
+        %keepdim : bool = prim::Constant[value=1]()
+        %none : None = prim::Constant()
+        %2 : Tensor = aten::sum(%0, %dims, %keepdim, %none)
+        %3 : Tensor = aten::add(%2, %1, %one)
+        return (%3))IR";
+    Graph graph;
+    torch::jit::script::parseIR(graph_string, &graph);
+
+    auto a = at::randn({8, 5});
+    auto b = at::randn({8, 1});
+    ASSERT_ANY_THROW(debugGetFusedKernelCode(graph, {a, b}));
+    auto outputs = debugLaunchGraph(graph, {a, b});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_TRUE(outputs[0].allclose(a.sum(-1, true) + b, 1e-4, 1e-5));
+  }
+
+  torch::jit::overrideCanFuseOnCPU(false);
+}
+
 void testRegisterFusionCachesKernel() {
   // Constructs two functionally equivalent graphs
   const auto graph0_string = R"IR(
@@ -226,5 +441,83 @@ void testRegisterFusionCachesKernel() {
   // and therefore share a KernelSpec to share kernels for specializations
   ASSERT_EQ(second_key, expected_key);
 }
+
+namespace {
+// Removes a directory and the files in it, if any, when destroyed.
+struct TempDirGuard {
+  explicit TempDirGuard(std::string dir) : dir(std::move(dir)) {}
+
+  ~TempDirGuard() {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    struct _finddata_t data;
+    intptr_t handle = _findfirst((dir + "/*").c_str(), &data);
+    if (handle != -1) {
+      do {
+        names.emplace_back(data.name);
+      } while (_findnext(handle, &data) == 0);
+      _findclose(handle);
+    }
+#else
+    if (DIR* d = opendir(dir.c_str())) {
+      while (struct dirent* e = readdir(d)) {
+        names.emplace_back(e->d_name);
+      }
+      closedir(d);
+    }
+#endif
+    for (const auto& name : names) {
+      if (name != "." && name != "..") {
+        std::remove((dir + "/" + name).c_str());
+      }
+    }
+#ifdef _WIN32
+    _rmdir(dir.c_str());
+#else
+    rmdir(dir.c_str());
+#endif
+  }
+
+  const std::string dir;
+};
+} // namespace
+
+void testKernelDiskCache() {
+  using namespace fuser;
+  // Created by the first store
+  const TempDirGuard guard(
+      c10::make_tempfile("torch-fusion-cache-").name + "_d");
+  const std::string& dir = guard.dir;
+  overrideKernelDiskCache(dir, 1 << 20);
+  ASSERT_TRUE(kernelDiskCacheEnabled());
+
+  const std::string code = "void kernel_3(int n) { kernel_3_impl(n); }";
+  const auto key = kernelDiskCacheKey("backend", code, "kernel_3");
+  // Kernel names are numbered per process and are not part of the key
+  ASSERT_EQ(
+      key,
+      kernelDiskCacheKey(
+          "backend", "void kernel_7(int n) { kernel_7_impl(n); }", "kernel_7"));
+  const auto other_key = kernelDiskCacheKey("other backend", code, "kernel_3");
+  ASSERT_NE(key, other_key);
+
+  ASSERT_FALSE(loadCachedKernelBinary(key));
+  const std::string binary("\0binary\ndata", 12);
+  storeCachedKernelBinary(key, CachedKernelBinary{"kernel_3", binary});
+  auto cached = loadCachedKernelBinary(key);
+  ASSERT_TRUE(cached);
+  ASSERT_EQ(cached->kernel_name, "kernel_3");
+  ASSERT_EQ(cached->binary, binary);
+  ASSERT_FALSE(loadCachedKernelBinary(other_key));
+
+  // Entries are evicted to stay within the size limit
+  overrideKernelDiskCache(dir, 0);
+  storeCachedKernelBinary(other_key, CachedKernelBinary{"kernel_3", binary});
+  ASSERT_FALSE(loadCachedKernelBinary(key));
+  ASSERT_FALSE(loadCachedKernelBinary(other_key));
+
+  overrideKernelDiskCache("", 0);
+  ASSERT_FALSE(kernelDiskCacheEnabled());
+}
 } // namespace jit
 } // namespace torch
@@ -1,6 +1,11 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
 
+#include "torch/csrc/jit/instruction.h"
+#include "torch/jit.h"
+
+#include <algorithm>
+
 namespace torch {
 namespace jit {
 
@@ -27,5 +32,45 @@ void testInterp() {
   ASSERT_TRUE(exactlyEqual(outputs[0], hx));
   ASSERT_TRUE(exactlyEqual(outputs[1], cx));
 }
+
+void testInterpSuperinstructions() {
+  auto cu = compile(R"JIT(
+    def f(x, n: int):
+        y = x
+        for i in range(n):
+            if i % 2 == 0:
+                y = y * 2 + x
+            else:
+                y = torch.relu(y - 1)
+        return y
+  )JIT");
+  auto graph = cu->get_function("f").graph();
+  Code plain(graph, 0, /*emit_superinstructions=*/false);
+  Code fused(graph, 0, /*emit_superinstructions=*/true);
+
+  auto count_superinstructions = [](const Code& code) {
+    return std::count_if(
+        code.instructions().begin(),
+        code.instructions().end(),
+        [](const Instruction& inst) {
+          return inst.op == LOADOP || inst.op == MOVEOP ||
+              inst.op == LOADCOP || inst.op == OPSTORE;
+        });
+  };
+  ASSERT_EQ(count_superinstructions(plain), 0);
+  ASSERT_TRUE(count_superinstructions(fused) > 0);
+  ASSERT_TRUE(fused.instructions().size() < plain.instructions().size());
+  ASSERT_EQ(fused.instructions().size(), fused.instructions_source().size());
+
+  auto x = at::randn({3, 4}, at::kCPU);
+  for (int64_t n : {0, 1, 4, 7}) {
+    Stack plain_stack{x, n};
+    InterpreterState(plain).run(plain_stack);
+    Stack fused_stack{x, n};
+    InterpreterState(fused).run(fused_stack);
+    ASSERT_TRUE(exactlyEqual(
+        plain_stack.at(0).toTensor(), fused_stack.at(0).toTensor()));
+  }
+}
 } // namespace jit
 } // namespace torch
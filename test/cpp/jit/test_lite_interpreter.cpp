@@ -3,7 +3,10 @@
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/mobile/import.h>
 #include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/mobile/observer.h>
+#include <torch/csrc/jit/mobile/profiler.h>
 #include <torch/csrc/jit/import.h>
+#include <c10/util/tempfile.h>
 
 // Tests go in torch::jit
 namespace torch {
@@ -190,5 +193,99 @@ void testLiteInterpreterLoadOrigJit() {
   ASSERT_THROWS_WITH(_load_for_mobile(ss), "file not found");
 }
 
+void testLiteInterpreterControlFlow() {
+  // The jumps have to survive fusing the bytecode into superinstructions.
+  script::Module m("m");
+  m.register_parameter("foo", torch::ones({}), false);
+  m.define(R"(
+    def forward(self, x, n: int):
+      y = x
+      for i in range(n):
+        if i % 2 == 0:
+          y = y + self.foo
+        else:
+          y = y * 2
+      return y
+  )");
+
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  for (int64_t n = 0; n < 5; ++n) {
+    std::vector<IValue> inputs{torch::ones({}), n};
+    auto ref = m.run_method("forward", torch::ones({}), n);
+    auto res = bc.run_method("forward", inputs);
+    AT_ASSERT(res.toTensor().item<float>() == ref.toTensor().item<float>());
+  }
+}
+
+void testLiteInterpreterProfiler() {
+  script::Module m("m");
+  m.register_parameter("foo", torch::ones({}), false);
+  m.define(R"(
+    def add_it(self, x):
+      return self.foo + x
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+
+  auto& profiler = mobile::MobileProfiler::get();
+  profiler.enable(/*capacity=*/2);
+  {
+    auto debug_info = std::make_shared<MobileDebugInfo>();
+    debug_info->setModelName("model");
+    debug_info->setMethodName("add_it");
+    at::DebugInfoGuard guard(debug_info);
+    for (int i = 0; i < 3; ++i) {
+      bc.run_method("add_it", {torch::ones({})});
+    }
+  }
+  profiler.disable();
+  bc.run_method("add_it", {torch::ones({})});
+
+  auto records = profiler.records();
+  auto names = profiler.names();
+  ASSERT_EQ(records.size(), 2);
+  ASSERT_EQ(profiler.dropped(), 1);
+  for (const auto& record : records) {
+    ASSERT_EQ(names[record.op_name], "aten::add.Tensor");
+    ASSERT_EQ(names[record.model_name], "model");
+    ASSERT_EQ(names[record.method_name], "add_it");
+    ASSERT_GE(record.duration_ns, 0);
+    // The output of the add.
+    ASSERT_GE(record.allocations, 1);
+  }
+  ASSERT_LE(records[0].start_ns, records[1].start_ns);
+
+  std::stringstream out;
+  profiler.save(out);
+  ASSERT_EQ(out.str().substr(0, 4), "PTMP");
+}
+
+void testLiteInterpreterMmap() {
+  script::Module m("m");
+  m.register_parameter("foo", 3 * torch::ones({16}), false);
+  m.define(R"(
+    def forward(self, x):
+      return self.foo + x
+  )");
+  m.define(R"(
+    def unused(self, x):
+      return self.foo * x
+  )");
+
+  auto input = torch::ones({16});
+  auto ref = m.run_method("forward", input);
+
+  auto tempfile = c10::make_tempfile("torch-lite-interpreter-");
+  m._save_for_mobile(tempfile.name);
+  mobile::Module bc = _load_for_mobile(tempfile.name, c10::nullopt, true);
+  for (int i = 0; i < 2; ++i) {
+    auto res = bc.run_method("forward", {input});
+    ASSERT_TRUE(res.toTensor().equal(ref.toTensor()));
+  }
+}
+
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,128 @@
+#include <torch/csrc/jit/interpreter.h>
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/irparser.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+#include <torch/csrc/jit/testing/file_check.h>
+#include "test/cpp/jit/test_base.h"
+#include "test/cpp/jit/test_utils.h"
+
+namespace torch {
+namespace jit {
+
+void testMemoryPlanning() {
+  {
+    // %c and %e are never live at the same time and share their memory,
+    // the graph output is not planned.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%a : Float(2, 3),
+      %b : Float(2, 3)):
+  %one : int = prim::Constant[value=1]()
+  %c : Float(2, 3) = aten::add(%a, %b, %one)
+  %d : Float(2, 3) = aten::mul(%c, %a)
+  %e : Float(2, 3) = aten::mul(%d, %b)
+  %f : Float(2, 3) = aten::add(%e, %d, %one)
+  return (%f)
+  )IR",
+        &*graph);
+    ASSERT_TRUE(PlanMemory(graph));
+    testing::FileCheck()
+        .check_count("prim::AllocateStorage[size=128]", 1, /*exactly*/ true)
+        ->check("prim::AllocateTensor[offset=0")
+        ->check("aten::add")
+        ->check("prim::AllocateTensor[offset=64")
+        ->check("aten::mul")
+        ->check("prim::AllocateTensor[offset=0")
+        ->check("aten::mul")
+        ->check_not("prim::AllocateTensor")
+        ->check("aten::add")
+        ->run(*graph);
+
+    Code code(graph);
+    auto a = at::randn({2, 3});
+    auto b = at::randn({2, 3});
+    auto d = (a + b) * a;
+    auto expected = d * b + d;
+    for (int i = 0; i < 3; ++i) {
+      InterpreterState interp(code);
+      auto outputs = run(interp, {a, b});
+      ASSERT_TRUE(exactlyEqual(outputs[0], expected));
+    }
+  }
+  {
+    // Views of %c outlive it, so it is not planned.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%a : Float(2, 3),
+      %b : Float(2, 3)):
+  %one : int = prim::Constant[value=1]()
+  %c : Float(2, 3) = aten::add(%a, %b, %one)
+  %d : Float(3, 2) = aten::t(%c)
+  return (%d)
+  )IR",
+        &*graph);
+    ASSERT_FALSE(PlanMemory(graph));
+    testing::FileCheck().check_not("prim::AllocateTensor")->run(*graph);
+  }
+}
+
+void testElideConcat() {
+  {
+    // %c and %d are written into the output, %a is an input of the graph and
+    // is copied.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%a : Float(2, 3),
+      %b : Float(2, 3)):
+  %one : int = prim::Constant[value=1]()
+  %c : Float(2, 3) = aten::add(%a, %b, %one)
+  %d : Float(2, 3) = aten::mul(%a, %b)
+  %l : Tensor[] = prim::ListConstruct(%c, %d, %a)
+  %e : Float(2, 9) = aten::cat(%l, %one)
+  return (%e)
+  )IR",
+        &*graph);
+    ASSERT_TRUE(ElideConcat(graph));
+    testing::FileCheck()
+        .check("aten::empty")
+        ->check("aten::narrow")
+        ->check("aten::add")
+        ->check("aten::narrow")
+        ->check("aten::mul")
+        ->check("aten::narrow")
+        ->check("aten::copy_")
+        ->check_not("aten::cat")
+        ->run(*graph);
+
+    Code code(graph);
+    auto a = at::randn({2, 3});
+    auto b = at::randn({2, 3});
+    InterpreterState interp(code);
+    auto outputs = run(interp, {a, b});
+    ASSERT_TRUE(exactlyEqual(outputs[0], at::cat({a + b, a * b, a}, 1)));
+  }
+  {
+    // %c is also returned, so it can't be written into the output.
+    auto graph = std::make_shared<Graph>();
+    script::parseIR(
+        R"IR(
+graph(%a : Float(2, 3),
+      %b : Float(2, 3)):
+  %zero : int = prim::Constant[value=0]()
+  %one : int = prim::Constant[value=1]()
+  %c : Float(2, 3) = aten::add(%a, %b, %one)
+  %l : Tensor[] = prim::ListConstruct(%c, %b)
+  %e : Float(4, 3) = aten::cat(%l, %zero)
+  return (%c, %e)
+  )IR",
+        &*graph);
+    ASSERT_FALSE(ElideConcat(graph));
+    testing::FileCheck().check("aten::cat")->run(*graph);
+  }
+}
+
+} // namespace jit
+} // namespace torch
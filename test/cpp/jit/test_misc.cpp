@@ -42,6 +42,7 @@
 #include "torch/csrc/jit/tracer.h"
 
 #include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/profiler_histograms.h"
 #include "torch/csrc/autograd/variable.h"
 
 #include <torch/csrc/jit/testing/file_check.h>
@@ -62,6 +63,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
@@ -539,6 +541,57 @@ void testTorchSaveError() {
   ASSERT_TRUE(passed);
 }
 
+void testUnpickleSpan() {
+  // Containers big enough to need more than the reader's small buffer, with
+  // memoized (BINGET) strings.
+  c10::impl::GenericDict dict(StringType::get(), TensorType::get());
+  c10::impl::GenericList list(AnyType::get());
+  std::string key_prefix(100, 'k');
+  for (int64_t i = 0; i < 1000; ++i) {
+    auto key = key_prefix + c10::to_string(i);
+    dict.insert(key, torch::full({2}, i));
+    list.emplace_back(
+        c10::ivalue::Tuple::create({IValue(i), IValue(key), IValue(key)}));
+  }
+  IValue value = c10::ivalue::Tuple::create({dict, list});
+
+  std::vector<at::Tensor> tensor_table;
+  auto data = pickle(value, &tensor_table);
+
+  // From a span.
+  auto from_span = unpickle(data.data(), data.size(), nullptr, &tensor_table);
+  // Through a reader, a few bytes at a time.
+  size_t pos = 0;
+  auto from_reader = unpickle(
+      [&](char* buffer, size_t len) -> size_t {
+        len = std::min({len, data.size() - pos, size_t(7)});
+        std::memcpy(buffer, data.data() + pos, len);
+        pos += len;
+        return len;
+      },
+      nullptr,
+      &tensor_table);
+
+  for (const auto& result : {from_span, from_reader}) {
+    auto elements = result.toTuple()->elements();
+    auto result_dict = elements.at(0).toGenericDict();
+    auto result_list = elements.at(1).toList();
+    ASSERT_EQ(result_dict.size(), 1000);
+    ASSERT_EQ(result_list.size(), 1000);
+    for (int64_t i = 0; i < 1000; ++i) {
+      auto key = key_prefix + c10::to_string(i);
+      ASSERT_TRUE(result_dict.at(key).toTensor().equal(torch::full({2}, i)));
+      auto tuple = result_list.get(i).toTuple()->elements();
+      ASSERT_EQ(tuple.at(0).toInt(), i);
+      ASSERT_EQ(tuple.at(1).toStringRef(), key);
+      ASSERT_EQ(tuple.at(2).toStringRef(), key);
+    }
+  }
+
+  // A truncated pickle fails cleanly.
+  ASSERT_ANY_THROW(unpickle(data.data(), data.size() / 2, nullptr, &tensor_table));
+}
+
 // test a few features that are not directly used in schemas yet
 void testSchemaParser() {
   // nested arrays
@@ -856,6 +909,81 @@ void testRecordFunction() {
 
   autograd::profiler::popCallback();
   autograd::profiler::popCallback();
+
+  // callbacks sampled with their own probability; the inputs are only
+  // captured if a callback that runs needs them
+  int never_cb_ctr = 0;
+  autograd::profiler::pushSampledCallback(
+      [&never_cb_ctr](const autograd::profiler::RecordFunction& fn) {
+        if (std::string(fn.name().str()) == "test") {
+          ++never_cb_ctr;
+        }
+      },
+      [](const autograd::profiler::RecordFunction&) {},
+      /* sampling_prob */ 0.0,
+      /* needs_inputs */ true);
+
+  int always_cb_ctr = 0;
+  bool inputs_captured = false;
+  autograd::profiler::pushSampledCallback(
+      [&always_cb_ctr,
+       &inputs_captured](const autograd::profiler::RecordFunction& fn) {
+        if (std::string(fn.name().str()) == "test") {
+          ++always_cb_ctr;
+          inputs_captured = inputs_captured || !fn.inputs().empty();
+        }
+      },
+      [](const autograd::profiler::RecordFunction&) {},
+      /* sampling_prob */ 1.0);
+
+  run_test_function();
+
+  TORCH_CHECK(never_cb_ctr == 0);
+  TORCH_CHECK(always_cb_ctr == 1000);
+  TORCH_CHECK(!inputs_captured);
+
+  autograd::profiler::popCallback();
+  autograd::profiler::popCallback();
+}
+
+void testOpHistograms() {
+  auto run_test_function = [](int times) {
+    for (int i = 0; i < times; ++i) {
+      RECORD_FUNCTION("test_histogram", std::vector<c10::IValue>());
+    }
+  };
+  auto test_histogram = []() {
+    auto histograms = autograd::profiler::getOpHistograms();
+    auto it = histograms.find("test_histogram");
+    return it == histograms.end() ? autograd::profiler::OpHistogram()
+                                  : it->second;
+  };
+
+  autograd::profiler::enableOpHistograms();
+  TORCH_CHECK(autograd::profiler::opHistogramsEnabled());
+  autograd::profiler::resetOpHistograms();
+  run_test_function(10);
+  // events of other threads are added up
+  std::thread thread([&]() { run_test_function(5); });
+  thread.join();
+  auto histogram = test_histogram();
+  TORCH_CHECK(histogram.count == 15);
+  uint64_t bucket_sum = 0;
+  for (uint64_t bucket : histogram.buckets) {
+    bucket_sum += bucket;
+  }
+  TORCH_CHECK(bucket_sum == 15);
+  autograd::profiler::disableOpHistograms();
+
+  run_test_function(10);
+  TORCH_CHECK(test_histogram().count == 15);
+  autograd::profiler::resetOpHistograms();
+  TORCH_CHECK(test_histogram().count == 0);
+
+  autograd::profiler::enableOpHistograms(/*sampling_probability=*/0.0);
+  run_test_function(10);
+  TORCH_CHECK(test_histogram().count == 0);
+  autograd::profiler::disableOpHistograms();
 }
 
 class TestThreadLocalDebugInfo
@@ -1192,6 +1320,90 @@ void testProfiler() {
   checkShape(*tanh_n, eltwise);
 }
 
+void testProfilerDynamicShapes() {
+  auto graph = std::make_shared<Graph>();
+  const auto graph_string = R"IR(
+    graph(%x : Tensor):
+      %y : Tensor = aten::relu(%x)
+      return (%y))IR";
+  script::parseIR(graph_string, graph.get());
+
+  bool old_value = getProfilingDynamicShapes();
+  getProfilingDynamicShapes() = true;
+  auto pr = ProfilingRecord::instrumentGraph(graph);
+  Code cd(pr->profiled_graph_);
+  for (int64_t batch_size : {2, 5}) {
+    auto stack = createStack({at::randn({batch_size, 3}, at::kCPU)});
+    InterpreterState is{cd};
+    is.run(stack);
+  }
+  getProfilingDynamicShapes() = old_value;
+
+  auto nodes = pr->profiled_graph_->block()->nodes();
+  auto relu = std::find_if(nodes.begin(), nodes.end(), [](Node* n) {
+    return n->kind() == aten::relu;
+  });
+  ASSERT_NE(relu, nodes.end());
+  auto ptp = relu->input()->type()->expect<TensorType>();
+  ASSERT_EQ(*ptp->dim(), 2);
+  ASSERT_FALSE(ptp->sizes().concrete_sizes().has_value());
+  ASSERT_EQ(ptp->scalarType(), at::kFloat);
+  // A guard on the profiled type accepts inputs of any size.
+  auto other = at::randn({7, 11}, at::kCPU);
+  ASSERT_TRUE(ptp->isCompatibleWithInCurrentExecutionContext(other));
+}
+
+void testProfileSaveLoad() {
+  const auto graph_string = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %z : Tensor = aten::mul(%x, %y)
+      %w : Tensor = aten::relu(%z)
+      return (%w))IR";
+  auto profiledMul = [](ProfilingRecord& pr) {
+    auto nodes = pr.profiled_graph_->block()->nodes();
+    auto mul = std::find_if(nodes.begin(), nodes.end(), [](Node* n) {
+      return n->kind() == aten::mul;
+    });
+    return *mul;
+  };
+
+  auto graph = std::make_shared<Graph>();
+  script::parseIR(graph_string, graph.get());
+  auto pr = ProfilingRecord::instrumentGraph(graph);
+  Code cd(pr->profiled_graph_);
+  auto stack = createStack(
+      {at::randn({2, 3}, at::kCPU), at::randn({2, 3}, at::kCPU)});
+  InterpreterState is{cd};
+  is.run(stack);
+  auto profile = pr->saveProfile();
+
+  auto loaded_graph = std::make_shared<Graph>();
+  script::parseIR(graph_string, loaded_graph.get());
+  auto loaded = ProfilingRecord::instrumentGraph(loaded_graph);
+  ASSERT_FALSE(loaded->ready());
+  ASSERT_TRUE(loaded->loadProfile(profile));
+  ASSERT_TRUE(loaded->ready());
+  Node* mul = profiledMul(*loaded);
+  for (size_t i = 0; i < 2; ++i) {
+    auto ptp = mul->inputs()[i]->type()->expect<TensorType>();
+    auto expected = profiledMul(*pr)->inputs()[i]->type();
+    ASSERT_TRUE(*ptp == *expected);
+    ASSERT_EQ(*ptp->sizes().concrete_sizes(), std::vector<int64_t>({2, 3}));
+  }
+
+  // a profile of a different graph is rejected
+  auto other_graph = std::make_shared<Graph>();
+  script::parseIR(
+      R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %z : Tensor = aten::div(%x, %y)
+      return (%z))IR",
+      other_graph.get());
+  auto other = ProfilingRecord::instrumentGraph(other_graph);
+  ASSERT_FALSE(other->loadProfile(profile));
+  ASSERT_FALSE(other->ready());
+}
+
 void testCallStack() {
   const auto text = R"(
 def ham(x):
@@ -27,8 +27,11 @@ namespace jit {
   _(FromQualString)                    \
   _(InternedStrings)                   \
   _(IValue)                            \
+  _(KernelDiskCache)                   \
   _(PassManagement)                    \
   _(Proto)                             \
+  _(FusionCPU)                         \
+  _(FusionRowwise)                     \
   _(RegisterFusionCachesKernel)        \
   _(SchemaParser)                      \
   _(TopologicalIndex)                  \
@@ -49,10 +52,13 @@ namespace jit {
   _(ClassParser)                       \
   _(UnifyTypes)                        \
   _(Profiler)                          \
+  _(ProfilerDynamicShapes)             \
+  _(ProfileSaveLoad)                   \
   _(InsertAndEliminateRedundantGuards) \
   _(InsertBailOuts)                    \
   _(PeepholeOptimize)                  \
   _(RecordFunction)                    \
+  _(OpHistograms)                      \
   _(ThreadLocalDebugInfo)              \
   _(SubgraphMatching)                  \
   _(SubgraphRewriter)                  \
@@ -81,7 +87,16 @@ namespace jit {
   _(AutogradSymbols)                   \
   _(MobileTypeParser)                  \
   _(LiteInterpreterPrim)               \
-  _(LiteInterpreterLoadOrigJit)
+  _(LiteInterpreterLoadOrigJit)        \
+  _(LiteInterpreterMmap)               \
+  _(LiteInterpreterControlFlow)        \
+  _(LiteInterpreterProfiler)           \
+  _(MemoryPlanning)                    \
+  _(ElideConcat)                       \
+  _(InterpSuperinstructions)           \
+  _(ForkIndependentBranches)           \
+  _(BatchMMGroups)                     \
+  _(UnpickleSpan)
 
 #define TH_FORALL_TESTS_CUDA(_) \
   _(ArgumentSpec)               \
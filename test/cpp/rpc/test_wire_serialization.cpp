@@ -49,3 +49,39 @@ TEST(WireSerialize, RecopySparseTensors) {
   EXPECT_TRUE(torch::equal(tiny, deser.second[0]));
   EXPECT_LT(ser.size(), (tiny.element_size() * k1K) + k1K);
 }
+
+TEST(WireSerialize, Split) {
+  std::vector<char> payload = {'h', 'i'};
+  at::Tensor main = torch::randn({5, 5});
+  std::vector<at::Tensor> tensors = {main, torch::rand({3}), main.select(0, 1)};
+  auto ser = torch::distributed::rpc::wireSerializeSplit(payload, tensors);
+  // The two tensors sharing a storage need a single section, which points
+  // into the storage.
+  ASSERT_EQ(2, ser.second.size());
+  EXPECT_EQ(main.data_ptr(), ser.second[0].data_ptr());
+  auto sizes = torch::distributed::rpc::wireTensorSectionSizes(
+      ser.first.data(), ser.first.size());
+  ASSERT_EQ(2, sizes.size());
+  EXPECT_EQ(main.nbytes(), sizes[0]);
+  EXPECT_EQ(3 * sizeof(float), sizes[1]);
+
+  std::vector<at::Tensor> received;
+  for (const auto& section : ser.second) {
+    received.push_back(section.clone());
+  }
+  const void* receivedData = received[1].data_ptr();
+  auto deser = torch::distributed::rpc::wireDeserializeSplit(
+      ser.first.data(), ser.first.size(), std::move(received));
+  EXPECT_EQ(payload, deser.first);
+  ASSERT_EQ(tensors.size(), deser.second.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_TRUE(torch::equal(tensors[i], deser.second[i]));
+  }
+  // The received sections are used without copying them.
+  EXPECT_EQ(receivedData, deser.second[1].data_ptr());
+
+  EXPECT_THROW(
+      torch::distributed::rpc::wireDeserializeSplit(
+          ser.first.data(), ser.first.size(), {}),
+      c10::Error);
+}
@@ -0,0 +1,18 @@
+#!/usr/bin/env python3
+from __future__ import absolute_import, division, print_function, unicode_literals
+
+from torch.testing._internal.distributed.rpc.sharded_embedding_test import ShardedEmbeddingTest
+from torch.testing._internal.common_distributed import MultiProcessTestCase
+from torch.testing._internal.common_utils import TEST_WITH_ASAN, run_tests
+
+import unittest
+
+@unittest.skipIf(TEST_WITH_ASAN, "Skip ASAN as torch + multiprocessing spawn have known issues")
+class ShardedEmbeddingTestWithSpawn(MultiProcessTestCase, ShardedEmbeddingTest):
+
+    def setUp(self):
+        super(ShardedEmbeddingTestWithSpawn, self).setUp()
+        self._spawn_processes()
+
+if __name__ == '__main__':
+    run_tests()
@@ -214,6 +214,19 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def _test_multi_set_get(self, fs):
+        keys = ["multi_key{}".format(i) for i in range(10)]
+        values = ["multi_value{}".format(i) for i in range(10)]
+        fs.multi_set(keys, values)
+        fs.set("multi_key3", "updated")
+        values[3] = "updated"
+        self.assertEqual([v.encode() for v in values], fs.multi_get(keys))
+        self.assertEqual([b"updated", b"multi_value0"],
+                         fs.multi_get(["multi_key3", "multi_key0"]))
+
+    def test_multi_set_get(self):
+        self._test_multi_set_get(self._create_store())
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -272,6 +285,17 @@ class TCPStoreTest(TestCase, StoreTestBase):
             store1 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
             store2 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
 
+    @retry_on_address_already_in_use_error
+    def test_sharded(self):
+        port = common.find_free_port()
+        store = c10d.TCPStore('localhost', port, 1, True, num_shards=3,
+                              num_server_threads=2)
+        client = c10d.TCPStore('localhost', port, 1, num_shards=3)
+        self._test_set_get(client)
+        self._test_multi_set_get(client)
+        self.assertEqual(b"21", store.get("key3"))
+        self.assertEqual(b"updated", store.multi_get(["multi_key3"])[0])
+
 
 class PrefixTCPStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -1344,6 +1368,74 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                                     "Invalid function argument.*output_tensor_lists"):
             c10d.all_gather_coalesced(dummy_output_lists, dummy_input, pg)
 
+    def _test_alltoall_base_basics(self, fn):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Rank r sends i + 1 rows to rank i, so every rank receives r + 1
+        # rows from each peer.
+        input_split_sizes = [i + 1 for i in range(self.world_size)]
+        output_split_sizes = [self.rank + 1] * self.world_size
+        input = fn(torch.full((sum(input_split_sizes), 2), float(self.rank)))
+        output = fn(torch.full((sum(output_split_sizes), 2), -1.0))
+        expected = torch.cat([
+            torch.full((self.rank + 1, 2), float(i)) for i in range(self.world_size)
+        ])
+        work = pg.alltoall_base(output, input, output_split_sizes, input_split_sizes)
+        work.wait()
+        self.assertEqual(expected, output)
+
+        # Empty split sizes split dim 0 equally.
+        input = fn(torch.arange(self.world_size).float() + 10 * self.rank)
+        output = fn(torch.full((self.world_size,), -1.0))
+        expected = torch.arange(self.world_size).float() * 10 + self.rank
+        work = pg.alltoall_base(output, input, [], [])
+        work.wait()
+        self.assertEqual(expected, output)
+
+    def test_alltoall_base_basics(self):
+        self._test_alltoall_base_basics(lambda t: t.clone())
+
+    @skip_if_not_multigpu
+    @skip_if_rocm
+    def test_alltoall_base_basics_cuda(self):
+        self._test_alltoall_base_basics(lambda t: t.clone().cuda())
+
+    def test_alltoall_coalesced(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Tensors of different sizes and shapes, one per peer.
+        inputs = [
+            torch.full((i + 1, self.rank + 1), float(self.rank))
+            for i in range(self.world_size)
+        ]
+        outputs = [
+            torch.full((self.rank + 1, i + 1), -1.0)
+            for i in range(self.world_size)
+        ]
+        expected = [
+            torch.full((self.rank + 1, i + 1), float(i))
+            for i in range(self.world_size)
+        ]
+        c10d.all_to_all(outputs, inputs, pg)
+        self.assertEqual(expected, outputs)
+
+    def test_alltoall_checks(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        t1 = torch.zeros([self.world_size], dtype=torch.float32)
+        t2 = torch.zeros([self.world_size], dtype=torch.float64)
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.alltoall_base(t1, t2, [], [])
+
+        with self.assertRaisesRegex(RuntimeError, "Split sizes doesn't match"):
+            pg.alltoall_base(t1, t1, [], [2] * self.world_size)
+
+        with self.assertRaisesRegex(ValueError, "one input and one output tensor per rank"):
+            pg.alltoall([t1], [t1])
 
     def test_reduce_checks(self):
         store = c10d.FileStore(self.file_name, self.world_size)
@@ -1551,6 +1643,40 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             del pg
 
 
+    def test_hierarchical(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+
+        def factory(store, rank, size):
+            return c10d.ProcessGroupGloo(store, rank, size, self.opts())
+
+        # Pretend that every pair of ranks runs on its own node.
+        pg = c10d.ProcessGroupHierarchical(
+            store, self.rank, self.world_size, factory,
+            host_name="node%d" % (self.rank // 2))
+        self.assertEqual(self.rank % 2, pg.local_rank)
+        self.assertEqual(2, pg.local_size)
+        self.assertEqual(self.world_size // 2, pg.node_count)
+
+        for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+            opts = c10d.AllreduceOptions()
+            opts.reduceOp = op
+            tensor = input.clone()
+            pg.allreduce([tensor], opts).wait()
+            self.assertEqual(output, tensor)
+
+        # The number of elements doesn't divide into the shards.
+        tensor = torch.arange(7.).view(7, 1) + self.rank
+        pg.allreduce(tensor).wait()
+        expected = (torch.arange(7.) * self.world_size +
+                    self.world_size * (self.world_size - 1) / 2)
+        self.assertEqual(expected.view(7, 1), tensor)
+
+        # Other collectives run on all ranks.
+        tensor = torch.full([10], self.rank)
+        pg.broadcast(tensor, root=0).wait()
+        self.assertEqual(torch.full([10], 0), tensor)
+        pg.barrier().wait()
+
 @requires_nccl()
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
@@ -1612,6 +1738,28 @@ class ProcessGroupNCCLTest(TestCase):
             for i in range(self.num_gpus):
                 self.assertEqual(tensors[i], tensors[rt])
 
+    def test_comm_pool(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(
+            store, self.rank, self.world_size, comm_pool_size=3)
+
+        # Issue more allreduce calls than there are communicators before
+        # waiting for any of them.
+        num = 8
+        inputs = [
+            [torch.full([100], float(j + i)).cuda(i) for i in range(self.num_gpus)]
+            for j in range(num)]
+        works = [pg.allreduce(tensors) for tensors in inputs]
+        for j, (work, tensors) in enumerate(zip(works, inputs)):
+            work.wait()
+            expected = self.num_gpus * j + self.num_gpus * (self.num_gpus - 1) / 2
+            for tensor in tensors:
+                self.assertEqual(torch.full([100], float(expected)), tensor)
+
+        with self.assertRaisesRegex(RuntimeError, "at least one NCCL"):
+            c10d.ProcessGroupNCCL(
+                store, self.rank, self.world_size, comm_pool_size=0)
+
     def test_allreduce_ops(self):
         store = c10d.FileStore(self.file.name, self.world_size)
         pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
@@ -3021,6 +3169,75 @@ class ReducerTest(TestCase):
         reducer.prepare_for_backward(output)
         output.backward()
 
+    def _check_comm_hook(self, hook, exact):
+        batch_size = 10
+        model = self._create_mixed_precision_model()
+        reference = copy.deepcopy(model)
+        reducer = self._create_reducer_for_models([model])
+        reducer.register_comm_hook(hook)
+        with self.assertRaisesRegex(RuntimeError, "only be registered once"):
+            reducer.register_comm_hook(hook)
+        loss = nn.CrossEntropyLoss()
+        for _ in range(3):
+            input = torch.rand([batch_size, 2], dtype=torch.double)
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            for m in (model, reference):
+                m.zero_grad()
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            loss(reference(input), target).backward()
+            for p, ref in zip(model.parameters(), reference.parameters()):
+                self.assertEqual(p.grad.shape, ref.grad.shape)
+                if exact:
+                    self.assertEqual(p.grad, ref.grad, prec=1e-3)
+
+    def test_fp16_compress_hook(self):
+        self._check_comm_hook(c10d.FP16CompressHook(), exact=True)
+
+    def test_power_sgd_hook(self):
+        self._check_comm_hook(c10d.PowerSGDHook(rank=1), exact=False)
+
+    def test_top_k_sparsify_hook(self):
+        # all entries are sent with a ratio of 1
+        self._check_comm_hook(c10d.TopKSparsifyHook(ratio=1.0), exact=True)
+        self._check_comm_hook(c10d.TopKSparsifyHook(ratio=0.1), exact=False)
+
+    def test_rebuild_buckets(self):
+        batch_size = 10
+        model = ReducerModule()
+        parameters = list(model.parameters())
+        # One bucket per parameter, in the order they are defined, while
+        # gradients are ready in the reverse order.
+        buckets = [[i] for i in range(len(parameters))]
+        reducer = dist.Reducer(
+            [parameters], buckets, self.process_group,
+            bucket_size_limits=[1])
+        loss = nn.CrossEntropyLoss()
+        for i in range(3):
+            input = torch.rand([batch_size, 2])
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            model.zero_grad()
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            # The order is recorded in the first iteration and the buckets
+            # are rebuilt when the second one starts.
+            expected = buckets if i == 0 else [[2], [1], [0]]
+            self.assertEqual(reducer.get_bucket_indices(), expected)
+
+        # Without size limits the buckets are never rebuilt.
+        model = ReducerModule()
+        parameters = list(model.parameters())
+        reducer = dist.Reducer([parameters], buckets, self.process_group)
+        for _ in range(2):
+            input = torch.rand([batch_size, 2])
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+        self.assertEqual(reducer.get_bucket_indices(), buckets)
+
     def test_forward_backward_multi_replica(self):
         batch_size = 10
         num_replicas = 2
@@ -3061,6 +3278,34 @@ class ReducerTest(TestCase):
         # is considered being globally unused, it will be kept untouched as None.
         self.assertEqual(None, model.fc3.weight.grad)
 
+    def test_forward_backward_unused_parameters_by_hooks(self):
+        batch_size = 10
+        model = self._create_mixed_precision_model()
+        parameters = [list(model.parameters())]
+        group_by_type = groupby(
+            range(len(parameters[0])),
+            key=lambda i: parameters[0][i].type())
+        buckets = [list(indices) for _, indices in group_by_type]
+        reducer = dist.Reducer(
+            parameters, buckets, self.process_group,
+            find_unused_parameters_by_hooks=True)
+        loss = nn.CrossEntropyLoss()
+        for use_fc3 in (False, True, False):
+            model.zero_grad()
+            input = torch.rand([batch_size, 2], dtype=torch.double)
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            output = loss(model(input, use_fc3=use_fc3), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            # fc3 is marked ready at the end of the backward pass when it
+            # went unused, and is then left untouched.
+            if use_fc3:
+                self.assertIsNotNone(model.fc3.weight.grad)
+            else:
+                self.assertTrue(
+                    model.fc3.weight.grad is None or
+                    not model.fc3.weight.grad.any())
+
     def test_forward_backward_optimizer(self):
         batch_size = 10
         model = self._create_mixed_precision_model()
@@ -3071,9 +3316,8 @@ class ReducerTest(TestCase):
             input = torch.rand([batch_size, 2], dtype=torch.double)
             target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
 
-            # The `zero_grad` function calls `detach_` and `zero_` on the grad
-            # tensors of model parameters. If we tried to set the grad tensors
-            # to a view of the reducer's bucket tensors, this would blow up.
+            # The `zero_grad` function detaches and zeros the grad tensors of
+            # model parameters in place.
             optimizer.zero_grad()
 
             # Unused parameter only in the first iteration.
@@ -3083,6 +3327,44 @@ class ReducerTest(TestCase):
             optimizer.step()
 
 
+    def test_gradient_as_bucket_view(self):
+        batch_size = 10
+        model = ReducerModule()
+        reference = copy.deepcopy(model)
+        parameters = list(model.parameters())
+        buckets = [[i] for i in range(len(parameters))]
+        reducer = dist.Reducer(
+            [parameters], buckets, self.process_group,
+            bucket_size_limits=[1024], gradient_as_bucket_view=True)
+        reference_reducer = dist.Reducer(
+            [list(reference.parameters())], buckets, self.process_group)
+        loss = nn.CrossEntropyLoss()
+        optimizer = torch.optim.SGD(model.parameters(), lr=0.1)
+        reference_optimizer = torch.optim.SGD(reference.parameters(), lr=0.1)
+        for i in range(4):
+            input = torch.rand([batch_size, 2])
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            optimizer.zero_grad()
+            reference_optimizer.zero_grad()
+            if i == 2:
+                # Replaced gradients become views again.
+                model.fc1.weight.grad = None
+            for m, r in ((model, reducer), (reference, reference_reducer)):
+                output = loss(m(input), target)
+                r.prepare_for_backward(output)
+                output.backward()
+            for p, ref in zip(model.parameters(), reference.parameters()):
+                self.assertEqual(p.grad, ref.grad)
+            # After the first iteration the buckets are rebuilt into a single
+            # one that all gradients are views of.
+            if i > 0:
+                self.assertEqual(reducer.get_bucket_indices(), [[2, 1, 0]])
+                self.assertEqual(
+                    len({p.grad.storage().data_ptr() for p in parameters}), 1)
+            optimizer.step()
+            reference_optimizer.step()
+
+
 class ComputeBucketAssignmentTest(TestCase):
     def test_single_limit_single_dtype(self):
         tensors = [
@@ -3379,6 +3661,36 @@ class CommTest(MultiProcessTestCase):
         device = torch.device('cpu')
         self._test_broadcast_coalesced(process_group, device)
 
+    @requires_gloo()
+    def test_persistent_broadcast_gloo_cpu(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_device(interface=LOOPBACK)]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        target = list(torch.arange(60, dtype=torch.float32).chunk(5))
+        target += list(torch.arange(60, dtype=torch.float64).chunk(5))
+        target.append(torch.arange(12, dtype=torch.float32).view(4, 3).t())
+        tensors = [torch.zeros_like(tensor) for tensor in target[:-1]]
+        tensors.append(torch.zeros(4, 3).t())
+        broadcast = c10d._PersistentBroadcast(process_group, tensors, buffer_size=256)
+
+        # Contiguous tensors now alias the flat buckets, the transposed one
+        # is copied in and out.
+        self.assertEqual(tensors[-1].stride(), target[-1].stride())
+
+        for i in range(3):
+            for tensor, expected in zip(tensors, target):
+                # Update in place, like BatchNorm does with its buffers.
+                tensor.copy_(expected * i if self.rank == 0 else -expected)
+            broadcast.broadcast()
+            self.assertEqual(tensors, [expected * i for expected in target])
+
+        # A tensor that was pointed elsewhere is still synchronized.
+        tensors[0].set_(torch.full_like(target[0], self.rank))
+        broadcast.broadcast()
+        self.assertEqual(tensors[0], torch.zeros_like(target[0]))
+
 
 if __name__ == '__main__':
     assert not torch.cuda._initialized, "test_distributed must not have initialized CUDA context on main process"
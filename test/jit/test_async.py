@@ -119,6 +119,39 @@ class TestAsync(JitTestCase):
 
         self.assertEqual(y, y_hat)
 
+    def test_async_script_fork_tree(self):
+        # More interpreters wait at once than the inter-op pool has threads
+        @torch.jit.script
+        def leaf(x):
+            return torch.neg(x)
+
+        @torch.jit.script
+        def level1(x):
+            a = torch.jit._fork(leaf, x)
+            b = torch.jit._fork(leaf, x)
+            c = torch.jit._fork(leaf, x)
+            d = torch.jit._fork(leaf, x)
+            return torch.jit._wait(a) + torch.jit._wait(b) + torch.jit._wait(c) + torch.jit._wait(d)
+
+        @torch.jit.script
+        def level2(x):
+            a = torch.jit._fork(level1, x)
+            b = torch.jit._fork(level1, x)
+            c = torch.jit._fork(level1, x)
+            d = torch.jit._fork(level1, x)
+            return torch.jit._wait(a) + torch.jit._wait(b) + torch.jit._wait(c) + torch.jit._wait(d)
+
+        @torch.jit.script
+        def level3(x):
+            a = torch.jit._fork(level2, x)
+            b = torch.jit._fork(level2, x)
+            c = torch.jit._fork(level2, x)
+            d = torch.jit._fork(level2, x)
+            return torch.jit._wait(a) + torch.jit._wait(b) + torch.jit._wait(c) + torch.jit._wait(d)
+
+        x = torch.rand(3, 4)
+        self.assertEqual(level3(x), -64 * x)
+
     def test_async_script_no_script_mod(self):
         x = torch.rand(3, 4)
 
@@ -637,6 +637,29 @@ class TestList(JitTestCase):
 
         self.checkScript(test_pop_at_negative2, ())
 
+    def test_mutable_list_pop_out_of_range(self):
+        def test_pop_out_of_range():
+            a = [1, 2, 3, 4]
+            return a.pop(4)
+
+        self.checkScriptRaisesRegex(test_pop_out_of_range, (), Exception,
+                                    "out of range")
+
+        def test_pop_out_of_range_negative():
+            a = [1, 2, 3, 4]
+            return a.pop(-5)
+
+        self.checkScriptRaisesRegex(test_pop_out_of_range_negative, (), Exception,
+                                    "out of range")
+
+        def test_pop_first_negative():
+            a = [1, 2, 3, 4]
+            b = a.pop(-4)
+
+            return b == 1 and a == [2, 3, 4]
+
+        self.checkScript(test_pop_first_negative, ())
+
     def test_mutable_list_pop_slice(self):
         def test_pop_slice():
             a = [1, 2, 3, 4]
@@ -76,6 +76,7 @@ if PY33:
         'distributed/rpc/test_rpc_spawn',
         'distributed/rpc/test_dist_autograd_spawn',
         'distributed/rpc/test_dist_optimizer_spawn',
+        'distributed/rpc/test_sharded_embedding_spawn',
     ])
 
 # skip < 3.6 b/c fstrings added in 3.6
@@ -89,6 +90,7 @@ WINDOWS_BLACKLIST = [
     'distributed/rpc/test_rpc_spawn',
     'distributed/rpc/test_dist_autograd_spawn',
     'distributed/rpc/test_dist_optimizer_spawn',
+    'distributed/rpc/test_sharded_embedding_spawn',
 ]
 
 ROCM_BLACKLIST = [
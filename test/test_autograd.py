@@ -2,6 +2,7 @@ import contextlib
 import gc
 import sys
 import math
+import subprocess
 import tempfile
 import time
 import unittest
@@ -257,6 +258,49 @@ class TestAutograd(TestCase):
             torch.sparse_coo_tensor(torch.tensor([[1, 1]]).long(), torch.tensor([1., 1.])),
             True)
 
+    def test_input_buffer_accumulate_inplace(self):
+        returned = []
+        kept = []
+
+        class Scale(Function):
+            @staticmethod
+            def forward(ctx, x, scale, keep):
+                ctx.scale = scale
+                ctx.keep = keep
+                return x * scale
+
+            @staticmethod
+            def backward(ctx, grad):
+                grad = grad * ctx.scale
+                returned.append(grad.data_ptr())
+                if ctx.keep:
+                    kept.append(grad)
+                return grad, None, None
+
+        def run(keep=False, transpose=False):
+            del returned[:]
+            del kept[:]
+            x = torch.randn(3, 4, requires_grad=True)
+            y = x * 1
+            accumulated = []
+            y.register_hook(lambda grad: accumulated.append(grad.data_ptr()))
+            a = Scale.apply(y, 2., keep)
+            if transpose:
+                b = Scale.apply(y.t(), 3., False).t()
+            else:
+                b = Scale.apply(y, 3., False)
+            (a.sum() + b.sum()).backward()
+            self.assertEqual(x.grad, torch.full((3, 4), 5.))
+            return accumulated[0]
+
+        # The gradients of y are summed into one of the buffers they came in
+        self.assertIn(run(), returned)
+        # A gradient referenced elsewhere is never added to in place
+        run(keep=True)
+        self.assertEqual(kept[0], torch.full((3, 4), 2.))
+        # Only contiguous gradients are summed in place
+        self.assertNotIn(run(transpose=True), returned)
+
     @skipIfNoLapack
     def test_slogdet_sign(self):
         a = torch.randn(3, 3, requires_grad=True)
@@ -2683,6 +2727,89 @@ class TestAutograd(TestCase):
         print(prof.table())
         print(prof.key_averages(group_by_input_shape=True).table())
 
+    def test_profiler_memory(self):
+        with profile(profile_memory=True) as prof:
+            with record_function("outer"):
+                y = torch.rand(100, 100)
+                z = y * 2
+                del z
+
+        outer = [evt for evt in prof.function_events if evt.name == "outer"]
+        self.assertEqual(len(outer), 1)
+        # z is freed before outer ends, but held at the same time as y
+        self.assertEqual(outer[0].cpu_memory_usage, 100 * 100 * 4)
+        self.assertGreaterEqual(outer[0].cpu_memory_peak, 2 * 100 * 100 * 4)
+        # outer itself only frees z
+        self.assertEqual(outer[0].self_cpu_memory_usage, -100 * 100 * 4)
+
+        stats = {evt.key: evt for evt in prof.key_averages()}
+        self.assertEqual(stats["mul"].cpu_memory_usage, 100 * 100 * 4)
+        self.assertIn("CPU Mem", prof.key_averages().table())
+
+    @unittest.skipIf(not torch.autograd._perf_events_available(),
+                     "perf events are not available")
+    def test_profiler_perf_events(self):
+        x = torch.randn(256, 256)
+        with profile(perf_events=["cycles", "instructions"]) as prof:
+            with record_function("outer"):
+                torch.mm(x, x)
+
+        outer = [evt for evt in prof.function_events if evt.name == "outer"][0]
+        mm = [evt for evt in prof.function_events if evt.name == "mm"][0]
+        self.assertGreater(mm.perf_counters["instructions"], 0)
+        self.assertGreater(mm.perf_counters["cycles"], 0)
+        # The counts of outer include the ones of mm
+        prof.function_events.populate_cpu_children()
+        self.assertGreaterEqual(outer.perf_counters["instructions"], mm.perf_counters["instructions"])
+        self.assertLess(outer.self_perf_counters["instructions"], outer.perf_counters["instructions"])
+
+        stats = {evt.key: evt for evt in prof.key_averages()}
+        self.assertEqual(stats["mm"].perf_counters["instructions"], mm.perf_counters["instructions"])
+        table = prof.key_averages().table(sort_by="self_instructions")
+        self.assertIn("Self instructions", table)
+        self.assertIn("Self IPC", table)
+
+        with self.assertRaisesRegex(RuntimeError, "Unknown perf event"):
+            with profile(perf_events=["not_an_event"]):
+                pass
+
+    @unittest.skipIf(not torch.cuda.is_available() or not torch.autograd._cupti_enabled(),
+                     "CUPTI is not available")
+    def test_profiler_cupti(self):
+        x = torch.randn(64, 64, device='cuda')
+        with profile(use_cuda=True, use_cupti=True) as prof:
+            with record_function("outer"):
+                y = torch.mm(x, x)
+                y.cpu()
+
+        outer = [evt for evt in prof.function_events if evt.name == "outer"][0]
+        mm = [evt for evt in prof.function_events if evt.name == "mm"][0]
+        # The kernels are attributed to the functions launching them, and
+        # their time to the functions containing those
+        self.assertTrue(len(mm.kernels) > 0)
+        self.assertEqual(len(outer.kernels), 0)
+        prof.function_events.populate_cpu_children()
+        self.assertGreater(mm.cuda_time_total, 0)
+        self.assertGreaterEqual(outer.cuda_time_total, mm.cuda_time_total)
+
+    def test_profiler_trace_path(self):
+        import json
+        with tempfile.NamedTemporaryFile() as trace, tempfile.NamedTemporaryFile(mode='r') as chrome_trace:
+            with profile(trace_path=trace.name) as prof:
+                with record_function("outer"):
+                    torch.randn(10, 10).mul(2)
+            self.assertEqual(len(prof.function_events), 0)
+
+            torch.autograd.profiler.convert_trace(trace.name, chrome_trace.name)
+            events = json.load(chrome_trace)
+            names = [event["name"] for event in events]
+            self.assertIn("outer", names)
+            self.assertIn("mul", names)
+            outer = events[names.index("outer")]
+            mul = events[names.index("mul")]
+            self.assertGreaterEqual(mul["ts"], outer["ts"])
+            self.assertLessEqual(mul["ts"] + mul["dur"], outer["ts"] + outer["dur"])
+
     def test_profiler_no_cuda(self):
         print("")
         layer = torch.nn.Linear(20, 30)
@@ -2993,6 +3120,24 @@ class TestAutograd(TestCase):
         gradcheck(fn, [r])
         gradgradcheck(fn, [r])
 
+    def test_view_shares_version_with_base(self):
+        # Views reuse the TensorImpl made by the view op when nobody else
+        # refers to it, check that they still share the version counter of
+        # their base, including when the op returned its input
+        x = torch.randn(4, 3)
+        views = [x.view(12), x.t(), x.transpose(0, 0), x.select(0, 1),
+                 x[1:3], x.narrow(1, 0, 2), x.unbind(0)[2]]
+        for v in views:
+            self.assertTrue(v._is_view())
+            self.assertIs(v._base, x)
+        detached = x.detach()
+        for v in views + [detached]:
+            version = v._version
+            x.add_(1)
+            self.assertEqual(v._version, version + 1)
+        self.assertEqual(x.size(), (4, 3))
+        self.assertEqual(views[0].size(), (12,))
+
     def test_inplace_view_python(self):
         # in-place modifications of Python-autograd created view
         a = torch.randn(4, 4, requires_grad=True)
@@ -3407,6 +3552,149 @@ for shape in [(1,), ()]:
         self.assertEqual(order.count("Reentrant"), 10)
         self.assertEqual(order[-1], "MyFunction")
 
+    def test_static_graph(self):
+        x = torch.randn(4, requires_grad=True)
+        w = torch.randn(4, 4, requires_grad=True)
+        y = torch.tanh(w.mv(x)) * x.exp()
+
+        vjp = torch.autograd.StaticGraph(y, [x, w])
+        self.assertTrue(vjp._graph.is_static())
+        for v in torch.eye(4):
+            expected = torch.autograd.grad(y, [x, w], v, retain_graph=True)
+            self.assertEqual(vjp(v), expected)
+
+        # Accumulates into the leaves without inputs, every call again
+        backward = torch.autograd.StaticGraph(y.sum())
+        self.assertIsNone(backward())
+        backward()
+        gx, gw = torch.autograd.grad(y.sum(), [x, w], retain_graph=True)
+        self.assertEqual(x.grad, gx * 2)
+        self.assertEqual(w.grad, gw * 2)
+
+        # Higher order gradients
+        z = (x ** 3).sum()
+        gz, = torch.autograd.StaticGraph(z, x)(create_graph=True)
+        hessian_vjp = torch.autograd.StaticGraph(gz, x)
+        for v in torch.eye(4):
+            self.assertEqual(hessian_vjp(v)[0], 6 * x.detach() * v)
+
+        # An unused input has no gradient
+        u = torch.randn(4, requires_grad=True)
+        self.assertIsNone(torch.autograd.StaticGraph(y.sum(), [x, u])()[1])
+
+        # Hooks on functions go through the engine
+        calls = []
+        y = x.exp()
+        y.grad_fn.register_hook(lambda grad_inputs, grad_outputs: calls.append(1))
+        vjp = torch.autograd.StaticGraph(y, x)
+        self.assertFalse(vjp._graph.is_static())
+        self.assertEqual(vjp(torch.ones(4))[0], x.detach().exp())
+        self.assertEqual(len(calls), 1)
+
+    def test_offload_saved_tensors(self):
+        def run(device, budget):
+            x = torch.randn(64, 64, device=device, requires_grad=True)
+            with torch.autograd.offload_saved_tensors(budget) as ctx:
+                y = x.mm(x).tanh()
+                z = (y * y).mm(x).sum()
+            offloaded = ctx.hooks.offloaded_bytes()
+            z.backward()
+            return x.grad, offloaded, ctx.hooks
+
+        # CPU tensors are always saved as is
+        grad, offloaded, _ = run('cpu', 0)
+        self.assertEqual(offloaded, 0)
+        self.assertIsNone(torch.autograd._get_saved_variable_hooks())
+
+        if torch.cuda.is_available():
+            torch.manual_seed(0)
+            expected, _, _ = run('cuda', 2 ** 30)
+            torch.manual_seed(0)
+            grad, offloaded, hooks = run('cuda', 64 * 64 * 4)
+            self.assertEqual(grad, expected)
+            self.assertGreater(offloaded, 0)
+            # Freeing the graph releases the saved tensors
+            self.assertEqual(hooks.offloaded_bytes(), 0)
+            self.assertEqual(hooks.device_bytes(), 0)
+
+    def test_num_cpu_threads(self):
+        # The number of threads can't be lowered again, so this runs in a
+        # separate process to leave the engine of the other tests alone.
+        script = """
+import torch
+from torch.utils.checkpoint import checkpoint
+
+torch.autograd.set_num_cpu_threads(4)
+try:
+    torch.autograd.set_num_cpu_threads(2)
+    raise AssertionError("expected the number of threads to only grow")
+except RuntimeError:
+    pass
+
+# A wide graph of towers sharing the same input and weight
+x = torch.randn(8, 16, requires_grad=True)
+w = torch.randn(16, 16, requires_grad=True)
+for _ in range(10):
+    outs = [torch.tanh(x.mm(w) * i).sum() for i in range(32)]
+    gx, gw = torch.autograd.grad(sum(outs), [x, w])
+    z = x.detach().mm(w.detach())
+    gz = sum((1 - torch.tanh(z * i) ** 2) * i for i in range(32))
+    assert torch.allclose(gx, gz.mm(w.detach().t()), atol=1e-5)
+    assert torch.allclose(gw, x.detach().t().mm(gz), atol=1e-5)
+
+# Accumulation into leaves and reentrant backward from the CPU threads
+x.grad = None
+loss = sum(checkpoint(lambda t: torch.sin(t) * i, x).sum() for i in range(16))
+loss.backward()
+assert torch.allclose(x.grad, torch.cos(x.detach()) * sum(range(16)))
+"""
+        subprocess.check_call([sys.executable, '-c', script])
+
+    def test_max_reentrant_threads(self):
+        # This changes the engine for good, so it runs in a separate process.
+        script = """
+import os
+import sys
+import torch
+from torch.autograd import Function
+
+try:
+    torch.autograd.set_max_reentrant_threads(-1)
+    raise AssertionError("expected a negative number of threads to fail")
+except RuntimeError:
+    pass
+
+class DeepReentrant(Function):
+    @staticmethod
+    def forward(ctx, x):
+        with torch.enable_grad():
+            ctx.x = x.detach().requires_grad_() - 1
+        return ctx.x.detach()
+
+    @staticmethod
+    def backward(ctx, x):
+        if ctx.x < 0:
+            return x
+        with torch.enable_grad():
+            DeepReentrant.apply(ctx.x).sum().backward()
+        return x
+
+def num_threads():
+    return len(os.listdir('/proc/self/task'))
+
+torch.autograd.set_max_reentrant_threads(0)
+# Starts the threads of the engine
+torch.ones(1, requires_grad=True).sum().backward()
+
+before = num_threads() if sys.platform.startswith('linux') else 0
+# Nested deeper than the depth at which a reentrant thread would be started
+v = torch.tensor(150.0, requires_grad=True)
+DeepReentrant.apply(v).sum().backward()
+after = num_threads() if sys.platform.startswith('linux') else 0
+assert before == after, (before, after)
+"""
+        subprocess.check_call([sys.executable, '-c', script])
+
     @slowTest
     def test_checkpointing(self):
         num_inp = 2000
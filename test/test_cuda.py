@@ -45,6 +45,8 @@ TEST_MAGMA = TEST_CUDA
 TEST_LARGE_TENSOR = TEST_CUDA
 TEST_MEDIUM_TENSOR = TEST_CUDA
 TEST_CUDNN = TEST_CUDA
+TEST_CUDA_GRAPH = TEST_CUDA and not TEST_WITH_ROCM and \
+    int(torch.version.cuda.split(".")[0]) >= 11
 if TEST_CUDA:
     torch.ones(1).cuda()  # has_magma shows up after cuda is initialized
     TEST_CUDNN = TEST_CUDA and (TEST_WITH_ROCM or
@@ -337,6 +339,31 @@ class TestCuda(TestCase):
                 end1 = advance(gen1, end1)
                 t += 1
 
+    @unittest.skipIf(IS_WINDOWS, "expandable segments are only available on Linux")
+    def test_expandable_segments_split_merge(self):
+        # The allocator reads PYTORCH_CUDA_ALLOC_CONF once, so run in a new process
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF='expandable_segments:True')
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+mb = 1024 * 1024
+x = torch.empty(8 * mb, dtype=torch.uint8, device='cuda')
+del x
+# Both allocations are split off the front of the freed 8 MB block
+a = torch.empty(2 * mb, dtype=torch.uint8, device='cuda')
+b = torch.empty(2 * mb, dtype=torch.uint8, device='cuda')
+assert all(s['is_expandable'] for s in torch.cuda.memory_snapshot())
+# Freeing them merges the blocks back into one
+del a
+del b
+segments = torch.cuda.memory_snapshot()
+assert len(segments) == 1 and segments[0]['is_expandable']
+assert len(segments[0]['blocks']) == 1
+torch.cuda.empty_cache()
+assert torch.cuda.memory_reserved() == 0
+"""], env=env)
+
     def test_out_of_memory(self):
         tensor = torch.zeros(1024, device='cuda')
 
@@ -461,6 +488,33 @@ class TestCuda(TestCase):
         y = torch.ones(10000000, dtype=torch.uint8).cuda()
         _test_copy_non_blocking(x, y)
 
+    def test_copy_non_blocking_pageable(self):
+        # pageable sources are staged through pinned memory, so they can be
+        # modified right after the copy is issued
+        y = torch.ones(10000000, dtype=torch.uint8)
+        x = y.cuda(non_blocking=True)
+        y.zero_()
+        torch.cuda.synchronize()
+        self.assertEqual(x, torch.ones(10000000, dtype=torch.uint8))
+
+    def test_copy_to_device(self):
+        tensors = [
+            torch.randn(5),
+            torch.arange(7),
+            torch.randn(3, 4).t(),
+            torch.empty(0),
+            torch.rand(3) > 0.5,
+            torch.randn(2000),
+            torch.randn(5).half(),
+        ]
+        for buffer_size in [64, 1024, 1048576]:
+            outputs = torch.cuda.comm.copy_to_device(tensors, buffer_size=buffer_size)
+            self.assertEqual(len(outputs), len(tensors))
+            for t, o in zip(tensors, outputs):
+                self.assertTrue(o.is_cuda)
+                self.assertEqual(o.dtype, t.dtype)
+                self.assertEqual(o.cpu(), t)
+
     def test_serialization_array_with_storage(self):
         x = torch.randn(5, 5).cuda()
         y = torch.IntTensor(2, 5).fill_(0).cuda()
@@ -987,6 +1041,18 @@ class TestCuda(TestCase):
         default_stream.synchronize()
         self.assertTrue(default_stream.query())
 
+    def test_exclusive_streams(self):
+        for priority in [0, -1]:
+            exclusive = torch.cuda.Stream(priority=priority, exclusive=True)
+            # a full round of the pool never hands out the reserved stream
+            others = [torch.cuda.Stream(priority=priority) for _ in range(64)]
+            self.assertTrue(all(s != exclusive for s in others))
+            handle = exclusive.cuda_stream
+            # destroying the stream returns it to the pool
+            del exclusive
+            others = [torch.cuda.Stream(priority=priority) for _ in range(64)]
+            self.assertIn(handle, [s.cuda_stream for s in others])
+
     @unittest.skipIf(not TEST_MULTIGPU, "detected only one GPU")
     def test_stream_event_device(self):
         d0 = torch.device('cuda:0')
@@ -1511,6 +1577,52 @@ class TestCuda(TestCase):
         # cached blocks in case it affects future tests.
         torch.cuda.empty_cache()
 
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_capture_simple(self):
+        s = torch.cuda.Stream()
+
+        with torch.cuda.stream(s):
+            a = torch.full((1000,), 1, device="cuda")
+            g = torch.classes.CUDAGraph()
+            g.capture_begin()
+            b = a
+            for _ in range(10):
+                b = b + 1
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        # replays run on the memory of the capture, so b sees updates to a
+        a.fill_(2)
+        g.replay()
+        self.assertEqual(b.sum().item(), 12000.0)
+        a.fill_(3)
+        g.replay()
+        self.assertEqual(b.sum().item(), 13000.0)
+
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_rng_functional(self):
+        size = 10000
+        a = torch.randn((size,), device="cuda", dtype=torch.float)
+
+        torch.cuda.manual_seed(5)
+        eager = [torch.nn.functional.dropout(a, p=0.1) for _ in range(3)]
+        after_eager = torch.cuda.get_rng_state()
+
+        s = torch.cuda.Stream()
+        torch.cuda.manual_seed(5)
+        with torch.cuda.stream(s):
+            g = torch.classes.CUDAGraph()
+            g.capture_begin()
+            b = torch.nn.functional.dropout(a, p=0.1)
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        # every replay draws the randoms the eager op would have drawn next
+        for expected in eager:
+            g.replay()
+            self.assertEqual(b, expected)
+        self.assertEqual(torch.cuda.get_rng_state(), after_eager)
+
     # Tests for historic illegal memory access, see #17040.
     def test_reduction_gpu_memory_accessing(self):
         x = torch.ones(512, 8, dtype=torch.float32, device='cuda')
@@ -2137,5 +2249,58 @@ t2.start()
             for t in range(num_threads):
                 self.assertEqual(results[t].sum().item(), size * size)
 
+    def test_autocast(self):
+        a = torch.randn(8, 8, device='cuda')
+        w = torch.randn(8, 8, device='cuda', requires_grad=True)
+        with torch.cuda.amp.autocast():
+            self.assertTrue(torch._C._is_autocast_enabled())
+            out = a.mm(w)
+            self.assertEqual(out.dtype, torch.half)
+            self.assertEqual(out.float(), a.half().mm(w.half()).float())
+            # Reductions and softmax run in float
+            self.assertEqual(out.sum().dtype, torch.float)
+            self.assertEqual(torch.softmax(out, -1).dtype, torch.float)
+            # Multi-input ops run in the widest type
+            self.assertEqual(torch.cat([out, a]).dtype, torch.float)
+            self.assertEqual(torch.cat([out, out]).dtype, torch.half)
+            # Other ops keep the type of their inputs, and double and CPU
+            # tensors are not cast
+            self.assertEqual((out + 1).dtype, torch.half)
+            self.assertEqual(a.double().mm(a.double()).dtype, torch.double)
+            self.assertEqual(a.cpu().mm(a.cpu()).dtype, torch.float)
+            with torch.cuda.amp.autocast(enabled=False):
+                self.assertEqual(a.mm(w).dtype, torch.float)
+            self.assertEqual(a.mm(w).dtype, torch.half)
+        self.assertFalse(torch._C._is_autocast_enabled())
+        self.assertEqual(a.mm(w).dtype, torch.float)
+
+        # Gradients flow back through the casts in the type of the inputs
+        with torch.cuda.amp.autocast():
+            loss = torch.nn.functional.linear(a, w).sum()
+        loss.backward()
+        self.assertEqual(w.grad.dtype, torch.float)
+        self.assertEqual(w.grad, torch.ones(8, 8, device='cuda').mm(a), prec=5e-2)
+
+    def test_autocast_decorator_and_threads(self):
+        @torch.cuda.amp.autocast()
+        def mm(a, b):
+            return a.mm(b)
+
+        a = torch.randn(4, 4, device='cuda')
+        self.assertEqual(mm(a, a).dtype, torch.half)
+        self.assertEqual(a.mm(a).dtype, torch.float)
+
+        # Autocasting is thread local
+        results = []
+
+        def _worker():
+            results.append(a.mm(a).dtype)
+
+        with torch.cuda.amp.autocast():
+            thread = threading.Thread(target=_worker)
+            thread.start()
+            thread.join()
+        self.assertEqual(results, [torch.float])
+
 if __name__ == '__main__':
     run_tests()
@@ -61,7 +61,8 @@ from torch.testing._internal.common_utils import run_tests, IS_WINDOWS, TEST_WIT
     skipIfRocm, suppress_warnings, IS_SANDCASTLE, GRAPH_EXECUTOR, ProfilingMode, \
     freeze_rng_state, set_rng_seed, slowTest, TemporaryFileName, skipIfCompiledWithoutNumpy, \
     enable_profiling_mode
-from torch.testing._internal.jit_utils import JitTestCase, enable_cpu_fuser, disable_autodiff_subgraph_inlining, \
+from torch.testing._internal.jit_utils import JitTestCase, enable_cpu_fuser, enable_cpu_fuser_compiler, \
+    disable_autodiff_subgraph_inlining, \
     _trace, enable_cpu_fuser_if, do_input_map, \
     execWrapper, _inline_everything, _tmp_donotuse_dont_inline_everything, \
     get_forward, get_forward_graph, get_module_method, \
@@ -525,6 +526,23 @@ class TestJit(JitTestCase):
         self.assertTrue(m2.b0.is_shared())
         self.assertEqual(m2.b0.storage().data_ptr(), m2.p0.storage().data_ptr())
 
+    @unittest.skipIf(not RUN_CUDA, "restore device requires CUDA")
+    def test_restore_large_tensors_on_cuda(self):
+        class Foo(torch.jit.ScriptModule):
+            def __init__(self):
+                super(Foo, self).__init__()
+                # bigger than a staging chunk, and of different dtypes
+                self.p0 = nn.Parameter(torch.randn(5 * 1024 * 1024 + 3))
+                self.register_buffer('b0', torch.randint(0, 100, (3 * 1024 * 1024,)))
+                self.register_buffer('b1', torch.rand(17) > 0.5)
+
+        m = Foo()
+        m2 = self.getExportImportCopy(m, map_location=torch.device('cuda:0'))
+        self.assertTrue(m2.p0.is_cuda)
+        self.assertEqual(m.p0, m2.p0.cpu())
+        self.assertEqual(m.b0, m2.b0.cpu())
+        self.assertEqual(m.b1, m2.b1.cpu())
+
     def test_typeas_trace_check(self):
         a = torch.tensor([0.4], requires_grad=True)
         b = torch.tensor([0.7], requires_grad=True)
@@ -1466,6 +1484,63 @@ graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r
         %r = aten::matmul(%a_dequant, %w_dequant_t)
         %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
         %r_dequant = aten::dequantize(%r_quant)
+        return (%r_dequant)""",
+            # conv2d + relu -> quantized::conv2d_relu
+            """
+graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype,
+%r_scale, %r_zero_point, %r_dtype, %stride, %padding, %dilation, %groups):
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        %a_dequant = aten::dequantize(%a_quant)
+        %packed_params = prim::GetAttr[name="_packed_params"](%packed_params_module)
+        %w_quant : Tensor, %b : Tensor? = quantized::conv2d_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        # CHECK: quantized::conv2d_relu
+        # CHECK-NOT: aten::conv2d
+        # CHECK-NOT: aten::relu
+        %conv_out = aten::conv2d(%a_dequant, %w_dequant, %b, %stride, %padding, %dilation, %groups)
+        %r = aten::relu(%conv_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        %r_dequant = aten::dequantize(%r_quant)
+        return (%r_dequant)""",
+            # addmm + relu -> quantized::linear_relu
+            """
+graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r_zero_point, %r_dtype, %4):
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        %a_dequant = aten::dequantize(%a_quant)
+        %packed_params = prim::GetAttr[name="_packed_params"](%packed_params_module)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %w_dequant_t = aten::t(%w_dequant)
+        # CHECK: quantized::linear_relu
+        # CHECK-NOT: aten::addmm
+        # CHECK-NOT: aten::relu
+        %linear_out = aten::addmm(%b, %a_dequant, %w_dequant_t, %4, %4)
+        %r = aten::relu(%linear_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        %r_dequant = aten::dequantize(%r_quant)
+        return (%r_dequant)""",
+            # conv2d -> add + relu -> quantized::conv2d_add_relu
+            """
+graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype, %c_scale, %c_zero_point,
+%r_scale, %r_zero_point, %r_dtype, %stride, %padding, %dilation, %groups, %other_quant):
+        %alpha : int = prim::Constant[value=1]()
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        %a_dequant = aten::dequantize(%a_quant)
+        %packed_params = prim::GetAttr[name="_packed_params"](%packed_params_module)
+        %w_quant : Tensor, %b : Tensor? = quantized::conv2d_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        # CHECK: quantized::conv2d_add_relu
+        # CHECK-NOT: quantized::conv2d(
+        # CHECK-NOT: aten::add_
+        # CHECK-NOT: aten::relu
+        %conv_out = aten::conv2d(%a_dequant, %w_dequant, %b, %stride, %padding, %dilation, %groups)
+        %c_quant = aten::quantize_per_tensor(%conv_out, %c_scale, %c_zero_point, %r_dtype)
+        %c_dequant = aten::dequantize(%c_quant)
+        %other_dequant = aten::dequantize(%other_quant)
+        %add_out = aten::add_(%c_dequant, %other_dequant, %alpha)
+        %r = aten::relu(%add_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        %r_dequant = aten::dequantize(%r_quant)
         return (%r_dequant)"""
         ]
         for input_str in input_strs:
@@ -1473,6 +1548,51 @@ graph(%packed_params_module, %a, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r
             torch._C._jit_pass_quant_fusion(graph)
             FileCheck().run(input_str, graph)
 
+    def test_propagate_quantized_memory_format(self):
+        input_str = """
+graph(%a, %a_scale, %a_zero_point, %a_dtype, %r_scale, %r_zero_point, %mf):
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        # CHECK-NOT: aten::contiguous
+        %a_contig = aten::contiguous(%a_quant, %mf)
+        %r = quantized::add(%a_contig, %a_contig, %r_scale, %r_zero_point)
+        # CHECK: quantized::add_relu
+        %r_contig = aten::contiguous(%r, %mf)
+        %r_relu = quantized::add_relu(%r_contig, %r_contig, %r_scale, %r_zero_point)
+        # CHECK: aten::contiguous
+        %r_relu_contig = aten::contiguous(%r_relu, %mf)
+        %r_dequant = aten::dequantize(%r_relu_contig)
+        return (%r_dequant)"""
+        graph = parse_ir(input_str)
+        torch._C._jit_pass_propagate_quantized_memory_format(graph)
+        FileCheck().run(input_str, graph)
+
+    def test_fuse_quantized_lut_chains(self):
+        input_str = """
+graph(%a, %a_scale, %a_zero_point, %a_dtype, %min, %max, %slope):
+        %false = prim::Constant[value=0]()
+        # CHECK: aten::quantize_per_tensor
+        %a_quant = aten::quantize_per_tensor(%a, %a_scale, %a_zero_point, %a_dtype)
+        # CHECK: aten::relu(%a_quant)
+        %b = aten::relu(%a_quant)
+        # CHECK: quantized::lut_domain(%a_quant)
+        # CHECK: quantized::clamp
+        # CHECK: aten::sigmoid
+        # CHECK: quantized::relu6
+        # CHECK: aten::leaky_relu
+        # CHECK: quantized::apply_lut(%a_quant
+        %r1 = quantized::clamp(%a_quant, %min, %max)
+        %r2 = aten::sigmoid(%r1)
+        %r3 = quantized::relu6(%r2, %false)
+        %r4 = aten::leaky_relu(%r3, %slope)
+        # CHECK-NOT: quantized::lut_domain
+        # CHECK: aten::dequantize
+        %r4_dequant = aten::dequantize(%r4)
+        %r4_tanh = aten::tanh(%r4_dequant)
+        return (%r4_tanh, %b)"""
+        graph = parse_ir(input_str)
+        torch._C._jit_pass_fuse_quantized_lut_chains(graph)
+        FileCheck().run(input_str, graph)
+
     @_tmp_donotuse_dont_inline_everything
     def test_foldbn_trivial(self):
         # Test trivial case
@@ -1610,6 +1730,138 @@ graph(%input, %weight):
             torch._C._jit_pass_fuse_linear(graph)
             FileCheck().run(input_str, graph)
 
+    def test_fuse_dropout_add_layer_norm(self):
+        input_strs = ["""
+graph(%input, %residual, %p, %train, %shape, %weight, %bias, %eps, %cudnn):
+    # CHECK-NOT: aten::dropout(
+    # CHECK-NOT: aten::add
+    # CHECK-NOT: aten::layer_norm
+    # CHECK: aten::dropout_add_layer_norm
+    %alpha : int = prim::Constant[value=1]()
+    %dropped = aten::dropout(%input, %p, %train)
+    %sum = aten::add(%dropped, %residual, %alpha)
+    %res = aten::layer_norm(%sum, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)""", """
+graph(%input, %residual, %p, %train, %shape, %weight, %bias, %eps, %cudnn):
+    # CHECK-NOT: aten::dropout(
+    # CHECK-NOT: aten::add
+    # CHECK-NOT: aten::layer_norm
+    # CHECK: aten::dropout_add_layer_norm
+    %alpha : int = prim::Constant[value=1]()
+    %dropped = aten::dropout(%input, %p, %train)
+    %sum = aten::add(%residual, %dropped, %alpha)
+    %res = aten::layer_norm(%sum, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)""", """
+graph(%input, %residual, %p, %train, %shape, %weight, %bias, %eps, %cudnn):
+    # CHECK: aten::dropout
+    # CHECK: aten::add
+    # CHECK: aten::layer_norm
+    # CHECK-NOT: aten::dropout_add_layer_norm
+    %alpha : int = prim::Constant[value=2]()
+    %dropped = aten::dropout(%input, %p, %train)
+    %sum = aten::add(%dropped, %residual, %alpha)
+    %res = aten::layer_norm(%sum, %shape, %weight, %bias, %eps, %cudnn)
+    return (%res)"""]
+        for input_str in input_strs:
+            graph = parse_ir(input_str)
+            torch._C._jit_pass_fuse_dropout_add_layer_norm(graph)
+            FileCheck().run(input_str, graph)
+
+    def test_freeze_module(self):
+        class SubModule(torch.nn.Module):
+            def __init__(self):
+                super(SubModule, self).__init__()
+                self.conv = torch.nn.Conv2d(3, 8, 3)
+                self.bn = torch.nn.BatchNorm2d(8)
+                self.scale = 2.0
+
+            def forward(self, x):
+                return self.bn(self.conv(x)) * self.scale
+
+        class TestModule(torch.nn.Module):
+            def __init__(self):
+                super(TestModule, self).__init__()
+                self.sub = SubModule()
+                self.linear = torch.nn.Linear(8, 4)
+                self.register_buffer('calls', torch.zeros(1))
+
+            def forward(self, x):
+                # calls is written, so it is left an attribute
+                self.calls.add_(1)
+                return self.linear(self.sub(x).mean(dim=[2, 3]))
+
+        m = TestModule()
+        m.sub.bn.running_mean.uniform_()
+        m.sub.bn.running_var.uniform_(0.5, 2)
+        m = torch.jit.script(m.eval())
+        with self.assertRaisesRegex(RuntimeError, "eval mode"):
+            torch.jit._freeze_module(torch.jit.script(TestModule()))
+
+        frozen = torch.jit._freeze_module(m)
+        graph = frozen.graph
+        FileCheck().check("aten::conv2d").check_not("aten::batch_norm").check("aten::linear") \
+            .run(str(graph))
+        FileCheck().check_count('prim::GetAttr[name="calls"]', 1, exactly=True).run(str(graph))
+        FileCheck().check_not('prim::GetAttr[name="sub"]').check_not('prim::GetAttr[name="weight"]') \
+            .run(str(graph))
+        # The original module is left as it is
+        FileCheck().check('prim::GetAttr[name="sub"]').run(str(m.graph))
+
+        x = torch.randn(2, 3, 10, 10)
+        with torch.no_grad():
+            self.assertEqual(frozen(x), m(x))
+        # The attribute values are shared
+        self.assertEqual(m.calls, torch.full((1,), 2))
+
+    def test_freeze_module_detach_nested(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = torch.nn.Parameter(torch.rand(3))
+                self.tensors = [torch.rand(3, requires_grad=True), torch.rand(3)]
+                self.pair = (torch.rand(3, requires_grad=True), 2)
+
+            def forward(self, x):
+                return x * self.weight + self.tensors[0] * self.tensors[1] + self.pair[0] * self.pair[1]
+
+        m = torch.jit.script(M().eval())
+        frozen = torch.jit._freeze_module(m)
+        FileCheck().check_not("prim::GetAttr").run(str(frozen.graph))
+        x = torch.randn(3)
+        with torch.no_grad():
+            self.assertEqual(frozen(x), m(x))
+
+    @unittest.skipIf(not torch._C.has_mkldnn, "MKL-DNN build is disabled")
+    def test_freeze_module_convert_to_mkldnn(self):
+        class TestModule(torch.nn.Module):
+            def __init__(self):
+                super(TestModule, self).__init__()
+                self.conv1 = torch.nn.Conv2d(3, 8, 3)
+                self.conv2 = torch.nn.Conv2d(8, 8, 3, groups=2)
+                self.linear = torch.nn.Linear(8, 4)
+
+            def forward(self, x):
+                x = F.max_pool2d(F.relu(self.conv1(x)), 2)
+                x = F.adaptive_avg_pool2d(self.conv2(x), 1)
+                return self.linear(torch.flatten(x, 1))
+
+        m = torch.jit.script(TestModule().eval())
+        frozen = torch.jit._freeze_module(m)
+        torch._C._jit_pass_convert_frozen_ops_to_mkldnn(frozen.graph)
+        graph = str(frozen.graph)
+        # The activations stay in MKL-DNN layout up to flatten, which doesn't
+        # support it
+        FileCheck().check_count("aten::to_mkldnn", 2, exactly=True).run(graph)
+        FileCheck().check_count("aten::to_dense", 2, exactly=True).run(graph)
+        FileCheck().check("aten::to_mkldnn").check("aten::conv2d").check("aten::relu") \
+            .check("aten::max_pool2d").check("aten::conv2d").check("aten::adaptive_avg_pool2d") \
+            .check("aten::to_dense").check("aten::flatten").check("aten::to_mkldnn") \
+            .check("aten::linear").check("aten::to_dense").run(graph)
+
+        x = torch.randn(2, 3, 16, 16)
+        with torch.no_grad():
+            self.assertEqual(frozen(x), m(x), prec=1e-4)
+
     @_tmp_donotuse_dont_inline_everything
     def test_fold_quantize(self):
         class M(torch.nn.Module):
@@ -1627,6 +1879,22 @@ graph(%input, %weight):
                    .check('GetAttr[name="_quantized_weight"]') \
                    .run(m._c._get_method('forward').graph)
 
+    def test_quantize_embedding_bag(self):
+        for use_4bit in [False, True]:
+            ref_m = torch.nn.EmbeddingBag(10, 8, mode='sum')
+            m = torch.jit.script(copy.deepcopy(ref_m))
+            torch._C._jit_pass_quantize_embedding_bag(m._c, use_4bit)
+            lookup = 'quantized::embedding_bag_4bit' if use_4bit else 'quantized::embedding_bag_byte'
+            FileCheck().check('GetAttr[name="_packed_weight"]') \
+                       .check(lookup) \
+                       .check_not('aten::embedding_bag') \
+                       .run(m._c._get_method('forward').graph)
+            self.assertEqual(m._c.getattr('weight').numel(), 0)
+
+            indices = torch.tensor([1, 2, 4, 5, 4, 3, 2, 9])
+            offsets = torch.tensor([0, 4])
+            self.assertEqual(ref_m(indices, offsets), m(indices, offsets), prec=0.5)
+
     @unittest.skipUnless(
         'fbgemm' in torch.backends.quantized.supported_engines,
         " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
@@ -1890,6 +2158,38 @@ graph(%Ra, %Rb):
         torch._C._jit_pass_complete_shape_analysis(graph, (x, y), False)
         FileCheck().check("Double(4, 3, 8, 5)").run(str(graph))
 
+    def test_symbolic_shapes(self):
+        def fn(x, w):
+            y = torch.relu(torch.matmul(x, w))
+            z = y.view(y.size(0), -1)
+            return torch.cat([z, y.flatten(1)], 1)
+
+        graph = torch.jit.script(fn).graph
+        shapes = torch._C._jit_symbolic_shapes(graph, [[None, None, 3], [None, 5]])
+        batch, seq = shapes['x'][:2]
+        self.assertTrue(isinstance(batch, str) and isinstance(seq, str))
+        # The inner dims of the matmul are equal
+        self.assertEqual(shapes['w'], [3, 5])
+        self.assertEqual(shapes['y'], [batch, seq, 5])
+        # view and flatten give the same symbol to seq * 5
+        flat = shapes[graph.findNode("aten::flatten").output().debugName()]
+        self.assertEqual(shapes['z'], flat)
+        self.assertEqual(flat[0], batch)
+        out = shapes[next(graph.outputs()).debugName()]
+        self.assertEqual(out[0], batch)
+        self.assertNotIn(out[1], [batch, seq, flat[1]])
+
+        def loop(x, n):
+            # type: (Tensor, int) -> Tensor
+            for _ in range(n):
+                x = torch.relu(x) + 1
+            return x
+
+        graph = torch.jit.script(loop).graph
+        shapes = torch._C._jit_symbolic_shapes(graph, [[None, 4], None])
+        self.assertEqual(shapes[next(graph.outputs()).debugName()],
+                         shapes[next(graph.inputs()).debugName()])
+
     # TODO: update verify to work with GraphExecutors
     @unittest.skip("verify needs to be updated to work with GraphExecutors")
     def test_verify(self):
@@ -5335,6 +5635,21 @@ def foo(xyz):
         fc.run(scripted.graph)
         fc.run(str(scripted.graph))
 
+    def test_file_line_trace_loop(self):
+        def foobar(xyz):
+            for _ in range(3):
+                xyz = torch.neg(xyz)
+                xyz = torch.relu(xyz)
+            return xyz
+
+        traced = torch.jit.trace(foobar, (torch.rand(3, 4)))
+
+        _, lineno = inspect.getsourcelines(foobar)
+        fc = FileCheck()
+        for _ in range(3):
+            fc.check('test_jit.py:{}:0'.format(lineno + 3)).check('test_jit.py:{}:0'.format(lineno + 4))
+        fc.run(str(traced.graph))
+
     def test_serialized_source_ranges(self):
 
         class FooTest(torch.jit.ScriptModule):
@@ -6510,6 +6825,20 @@ a")
             bailout_graph_str = str(my_slice.graph_for(a))
             FileCheck().check_count("prim::BailOut", 1).run(bailout_graph_str)
 
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "skip if profiling isn't enabled")
+    def test_unary_reduction_guard_elimination(self):
+        @torch.jit.script
+        def my_exp_sum(x):
+            return (torch.exp(x) * torch.sqrt(x)).transpose(0, 1).sum(1)
+
+        a = torch.rand(32, 4)
+
+        with enable_profiling_mode():
+            my_exp_sum(a)
+            bailout_graph_str = str(my_exp_sum.graph_for(a))
+            FileCheck().check_count("prim::BailOut", 1).run(bailout_graph_str)
+            self.assertEqual(my_exp_sum(a), (torch.exp(a) * torch.sqrt(a)).t().sum(1))
+
 
     def test_resize_input_ops(self):
         # resize_ and resize_as resize the input tensor. because our shape analysis
@@ -6679,7 +7008,7 @@ a")
 
     @unittest.skipIf(RUN_CUDA, 'This tests the CPU fuser')
     @unittest.skipIf(IS_SANDCASTLE, "NYI: fuser support for Sandcastle")
-    @enable_cpu_fuser
+    @enable_cpu_fuser_compiler
     def test_batchnorm_fuser_cpu(self):
         code = '''
             graph(%3 : Tensor,
@@ -6709,7 +7038,7 @@ a")
     @slowTest
     @unittest.skipIf(RUN_CUDA, 'This tests the CPU fuser')
     @unittest.skipIf(IS_SANDCASTLE, "NYI: fuser support for Sandcastle")
-    @enable_cpu_fuser
+    @enable_cpu_fuser_compiler
     def test_fuser_double_float_codegen(self):
         fns = ['log', 'log10', 'log1p', 'log2', 'lgamma', 'exp', 'expm1', 'erf',
                'erfc', 'cos', 'acos', 'cosh', 'sin', 'asin', 'sinh', 'tan',
@@ -6763,7 +7092,7 @@ a")
 
     @unittest.skipIf(RUN_CUDA, 'This tests the CPU fuser')
     @unittest.skipIf(IS_SANDCASTLE, "NYI: fuser support for Sandcastle")
-    @enable_cpu_fuser
+    @enable_cpu_fuser_compiler
     def test_fuser_double_literal_precision(self):
         code = '''
         graph(%2 : Float(*, *)):
@@ -9592,6 +9921,44 @@ a")
 
         test_bad_input()
 
+    def test_script_module_run_concurrently(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(4, 3)
+
+            def forward(self, x, scale=1.0):
+                # type: (Tensor, float) -> Tensor
+                if bool(x.sum() < -1000):
+                    raise RuntimeError("bad input")
+                return torch.relu(self.linear(x)) * scale
+
+            @torch.jit.export
+            def pair(self, x, y):
+                return x + y, x * y
+
+        m = torch.jit.script(M())
+        inputs = [torch.randn(5, 4) for _ in range(20)]
+        with torch.no_grad():
+            outputs = torch.jit._run_concurrently(m, inputs, num_threads=4)
+        self.assertEqual(len(outputs), len(inputs))
+        for x, out in zip(inputs, outputs):
+            self.assertEqual(out, m(x))
+            self.assertFalse(out.requires_grad)
+
+        # tuples hold the arguments of a call, and methods can be run as well
+        outputs = torch.jit._run_concurrently(m, [(x, 2.) for x in inputs])
+        for x, out in zip(inputs, outputs):
+            self.assertEqual(out, m(x) * 2)
+        outputs = torch.jit._run_concurrently(m.pair, [(x, x) for x in inputs], num_threads=3)
+        for x, out in zip(inputs, outputs):
+            self.assertEqual(out, (x + x, x * x))
+        self.assertEqual(torch.jit._run_concurrently(m, []), [])
+
+        bad = inputs[:5] + [torch.full((5, 4), -100.)] + inputs[5:]
+        with self.assertRaisesRegex(Exception, "bad input"):
+            torch.jit._run_concurrently(m, bad, num_threads=4)
+
     def test_script_module_call_noscript(self):
         class M(torch.jit.ScriptModule):
             def __init__(self):
@@ -12290,6 +12657,26 @@ a")
             self.assertEqual(torch.autograd.grad(sout.sum(), inputs),
                              torch.autograd.grad(out.sum(), inputs))
 
+    def test_mm_group_batching(self):
+        def projections(x, w_q, w_k, w_v, b_q, b_k, b_v):
+            q = torch.addmm(b_q, x, w_q)
+            k = torch.addmm(b_k, x, w_k)
+            v = torch.addmm(b_v, x, w_v)
+            return q, k, v
+
+        def heads(a0, a1, a2, b0, b1, b2):
+            return torch.matmul(a0, b0) * torch.matmul(a1, b1) * torch.matmul(a2, b2)
+
+        x = torch.randn(4, 8)
+        projection_inputs = [x] + [torch.randn(8, 6) for _ in range(3)] + [torch.randn(6) for _ in range(3)]
+        head_inputs = [torch.randn(5, 2, 3) for _ in range(3)] + [torch.randn(5, 3, 4) for _ in range(3)]
+        for fn, inputs in ((projections, projection_inputs), (heads, head_inputs)):
+            scripted = torch.jit.script(fn)
+            for _ in range(2):
+                self.assertEqual(scripted(*inputs), fn(*inputs))
+            if GRAPH_EXECUTOR == ProfilingMode.LEGACY:
+                FileCheck().check("prim::MMBatchGroup").run(scripted.graph_for(*inputs))
+
     def test_loop_unrolling(self):
         def fn(x):
             y = 0
@@ -12369,6 +12756,53 @@ a")
         self.checkScript(fn, (torch.tensor(1),))
         self.checkScript(fn, (torch.tensor(2),))
 
+    def test_hoist_loop_invariants(self):
+        def fn(x, w, n):
+            # type: (Tensor, Tensor, int) -> Tensor
+            for _ in range(n):
+                x = torch.mm(x, w.t())
+            return x
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('hoist_loop_invariants', graph)
+        FileCheck().check("prim::If").check("aten::t").check("prim::Loop").check_not("aten::t") \
+            .check("aten::mm").run(str(graph))
+
+        for n in range(3):
+            self.checkScript(fn, (torch.rand(3, 3), torch.rand(3, 3), n))
+
+    def test_hoist_loop_invariants_mutated(self):
+        def fn(x, n):
+            # type: (Tensor, int) -> Tensor
+            y = x
+            for _ in range(n):
+                z = torch.zeros(3)
+                z.add_(x)
+                y = y + z
+            return y
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('hoist_loop_invariants', graph)
+        FileCheck().check("prim::Loop").check("aten::zeros").run(str(graph))
+        self.checkScript(fn, (torch.rand(3), 2))
+
+    def test_batch_per_example_loops(self):
+        def fn(x, y, w):
+            outs = torch.jit.annotate(List[Tensor], [])
+            for i in range(x.size(0)):
+                outs.append(torch.relu(x[i] * w + y[i]))
+            return torch.stack(outs)
+
+        graph = torch.jit.script(fn).graph
+        self.run_pass('batch_per_example_loops', graph)
+        FileCheck().check("prim::If").check("aten::mul").check("aten::add").check("aten::relu") \
+            .check("prim::Loop").check("aten::stack").run(str(graph))
+
+        # batched
+        self.checkScript(fn, (torch.rand(4, 3), torch.rand(4, 3), torch.rand(3)))
+        # w has as many dims as x, the original loop runs
+        self.checkScript(fn, (torch.rand(4, 3), torch.rand(4, 3), torch.rand(2, 1, 3)))
+
     def test_where(self):
         def fn(x, y):
             return torch.where(x > 0.0, x, y)
@@ -16771,6 +17205,69 @@ a")
         self.assertEqual(m.int64_max, imported.int64_max)
         self.assertEqual(m.int64_min, imported.int64_min)
 
+    @unittest.skipIf(IS_WINDOWS, "NYI: TemporaryFileName on Windows")
+    def test_load_mmap(self):
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = torch.nn.Parameter(torch.randn(100, 100))
+                self.bias = torch.nn.Parameter(torch.randn(100))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return torch.addmm(self.bias, x, self.weight)
+
+        m = M()
+        x = torch.randn(3, 100)
+        with TemporaryFileName() as fname:
+            m.save(fname)
+            loaded = torch.jit.load(fname, mmap=True)
+            self.assertEqual(m(x), loaded(x))
+            self.assertEqual(m.weight, loaded.weight)
+
+            # the mapping is copy-on-write, the file keeps the saved values
+            with torch.no_grad():
+                loaded.weight.zero_()
+            self.assertEqual(torch.jit.load(fname).weight, m.weight)
+
+            with self.assertRaisesRegex(ValueError, "requires a file name"):
+                with open(fname, 'rb') as f:
+                    torch.jit.load(f, mmap=True)
+
+    @unittest.skipIf(not sys.platform.startswith('linux'), "reads the RSS from /proc")
+    def test_load_mmap_lazy(self):
+        class Head(torch.nn.Module):
+            def __init__(self):
+                super(Head, self).__init__()
+                self.weight = torch.nn.Parameter(torch.randn(2048, 2048))
+
+            def forward(self, x):
+                return x.mm(self.weight)
+
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.a = Head()
+                self.b = Head()
+
+            def forward(self, x):
+                return self.a(x)
+
+        def rss():
+            with open('/proc/self/statm') as f:
+                return int(f.read().split()[1]) * os.sysconf('SC_PAGE_SIZE')
+
+        m = torch.jit.script(M())
+        head_size = m.a.weight.numel() * m.a.weight.element_size()
+        x = torch.randn(1, 2048)
+        with TemporaryFileName() as fname:
+            m.save(fname)
+            before = rss()
+            loaded = torch.jit.load(fname, mmap=True)
+            # the records are only read when the tensors are used
+            self.assertLess(rss() - before, head_size)
+            self.assertEqual(m(x), loaded(x))
+
     def test_script_scope(self):
         scripted = torch.jit.script(torch.nn.functional.pad)
 
@@ -80,6 +80,15 @@ def receive_and_send(queue, out_queue, event, count):
     event.wait()
 
 
+def receive_and_free(queue, received, release, freed):
+    t = queue.get()
+    t.add_(1)
+    received.set()
+    release.wait()
+    del t
+    freed.set()
+
+
 def call_backward():
     x = torch.randn(3, 3, requires_grad=True)
     x.sum().backward()
@@ -318,6 +327,29 @@ class TestMultiprocessing(TestCase):
     def test_fd_preserve_sharing(self):
         self._test_preserve_sharing(repeat=TEST_REPEATS)
 
+    @unittest.skipIf(platform == 'darwin', "file descriptor strategy is not supported on macOS")
+    def test_fd_pooled_storage_reuse(self):
+        t = torch.zeros(16).share_memory_()
+        data_ptr = t.data_ptr()
+        del t
+        t = torch.zeros(16).share_memory_()
+        self.assertEqual(t.data_ptr(), data_ptr)
+
+        # The segment isn't reused while another process uses it
+        q = mp.Queue()
+        received, release, freed = mp.Event(), mp.Event(), mp.Event()
+        p = mp.Process(target=receive_and_free, args=(q, received, release, freed))
+        p.start()
+        q.put(t)
+        received.wait()
+        self.assertEqual(t, torch.ones(16))
+        del t
+        self.assertNotEqual(torch.zeros(16).share_memory_().data_ptr(), data_ptr)
+        release.set()
+        freed.wait()
+        self.assertEqual(torch.zeros(16).share_memory_().data_ptr(), data_ptr)
+        p.join()
+
     @unittest.skipIf(platform == 'darwin', "file descriptor strategy is not supported on macOS")
     def test_fd_pool(self):
         self._test_pool(repeat=TEST_REPEATS)
@@ -410,6 +442,29 @@ class TestMultiprocessing(TestCase):
         p2.join(1)
         p3.join(1)
 
+    @unittest.skipIf(NO_MULTIPROCESSING_SPAWN, "Disabled for environments that \
+                     don't support multiprocessing with spawn start method")
+    @unittest.skipIf(not TEST_CUDA_IPC, 'CUDA IPC not available')
+    def test_cuda_ipc_mem_handle_retention(self):
+        # The tensors are freed as soon as they are checked, so without
+        # retention every one of them opens the producer's block again
+        torch.cuda.set_ipc_mem_handle_retention(4)
+        try:
+            ctx = mp.get_context('spawn')
+            q = ctx.Queue()
+            e = ctx.Event()
+            count = 100
+            p = ctx.Process(target=send_and_delete_tensors, args=(q, e, torch.cuda.LongTensor, count))
+            p.start()
+            for i in range(count):
+                t = q.get()
+                self.assertEqual(t, torch.full([5], i).long())
+                del t
+            e.set()
+            p.join(1)
+        finally:
+            torch.cuda.set_ipc_mem_handle_retention(0)
+
     @unittest.skipIf(NO_MULTIPROCESSING_SPAWN, "Disabled for environments that \
                      don't support multiprocessing with spawn start method")
     @unittest.skipIf(not TEST_CUDA_IPC, 'CUDA IPC not available')
@@ -5,6 +5,7 @@ import random
 import string
 import unittest
 import io
+import os
 try:
     import unittest.mock as mock
 except ImportError:
@@ -4024,6 +4025,29 @@ class TestNN(NNTestCase):
             self.assertEqual(conv1.bias.grad.data, conv2.bias.grad.data, prec=0.0)
             self.assertEqual(conv1.weight.grad.data, conv2.weight.grad.data, prec=0.0)
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_cudnn_benchmark_cache_save_load(self):
+        inputs = torch.randn(2, 3, 13, 11, device="cuda", requires_grad=True)
+        conv = torch.nn.Conv2d(3, 5, 3).cuda()
+        old_limit = cudnn.benchmark_workspace_limit
+        try:
+            cudnn.benchmark_workspace_limit = 1 << 20
+            self.assertEqual(cudnn.benchmark_workspace_limit, 1 << 20)
+            with cudnn.flags(enabled=True, benchmark=True):
+                conv(inputs).sum().backward()
+        finally:
+            cudnn.benchmark_workspace_limit = old_limit
+
+        with TemporaryFileName() as fname:
+            cudnn.save_benchmark_cache(fname)
+            self.assertGreater(os.path.getsize(fname), 0)
+            # every entry in the file came from this process
+            self.assertEqual(cudnn.load_benchmark_cache(fname), 0)
+            with open(fname, 'wb') as f:
+                f.write(b'not a cache')
+            self.assertRaises(RuntimeError, lambda: cudnn.load_benchmark_cache(fname))
+
     def test_Conv2d_missing_argument(self):
         c = nn.Conv2d(3, 3, 3)
         self.assertRaises(TypeError, lambda: c(None))
@@ -5558,6 +5582,36 @@ class TestNN(NNTestCase):
             self.assertEqual(output1, output2)
             self.assertEqual(hidden1, hidden2)
 
+    def test_rnn_fused_cpu_gates_no_grad(self):
+        # Without grad, float LSTM/GRU on CPU take the fused gate kernels;
+        # they must match the autograd-enabled path. Hidden size 21 leaves a
+        # partial vector at the end of every row.
+        for mode in ['GRU', 'LSTM']:
+            for bidirectional in [False, True]:
+                rnn = getattr(nn, mode)(13, 21, 2, bidirectional=bidirectional)
+                input = torch.randn(7, 5, 13)
+                output1, hidden1 = rnn(input)
+                with torch.no_grad():
+                    output2, hidden2 = rnn(input)
+                self.assertEqual(output1, output2)
+                self.assertEqual(hidden1, hidden2)
+
+    def test_rnn_packed_no_grad(self):
+        # Without grad, packed layers write each step straight into the packed
+        # output; this must match the autograd-enabled path, including for an
+        # unsorted batch of variable lengths.
+        lengths = torch.tensor([3, 7, 1, 5, 7])
+        for mode in ['RNN', 'GRU', 'LSTM']:
+            for bidirectional in [False, True]:
+                rnn = getattr(nn, mode)(13, 21, 2, bidirectional=bidirectional)
+                input = rnn_utils.pack_padded_sequence(
+                    torch.randn(7, 5, 13), lengths, enforce_sorted=False)
+                output1, hidden1 = rnn(input)
+                with torch.no_grad():
+                    output2, hidden2 = rnn(input)
+                self.assertEqual(output1.data, output2.data)
+                self.assertEqual(hidden1, hidden2)
+
     def _test_RNN_cpu_vs_cudnn(self, dropout, dtype=torch.double):
 
         def forward_backward(cuda, rnn, input_val, hx_val, grad_output, grad_hy, weights_val):
@@ -6960,6 +7014,36 @@ class TestNN(NNTestCase):
 
                     test(N, C, D, H, W, mode, padding_mode, align_corners)
 
+    def test_grid_sample_3d_flat_depth(self):
+        # A 3D sample on an input of depth 1 at z = 0 is a 2D sample
+        # repeated over the output depth.
+        for mode in ('bilinear', 'nearest'):
+            for padding_mode in ('zeros', 'border', 'reflection'):
+                for align_corners in (True, False):
+                    N, C, IH, IW, D, H, W = 2, 3, 5, 6, 3, 4, 11
+                    input_2d = torch.randn(N, C, IH, IW, dtype=torch.double, requires_grad=True)
+                    grid_2d = torch.randn(N, H, W, 2, dtype=torch.double).mul_(1.2).requires_grad_()
+                    out_2d = F.grid_sample(input_2d, grid_2d, mode=mode, padding_mode=padding_mode,
+                                           align_corners=align_corners)
+                    grad_out = torch.randn_like(out_2d)
+                    out_2d.backward(grad_out)
+
+                    input_3d = input_2d.detach().unsqueeze(2).requires_grad_()
+                    # [N, 3, D, H, W] permuted to [N, D, H, W, 3] so that the
+                    # coordinates of the grid are not interleaved
+                    grid_3d = torch.cat([grid_2d.detach().unsqueeze(1).expand(N, D, H, W, 2),
+                                         torch.zeros(N, D, H, W, 1, dtype=torch.double)], dim=4)
+                    grid_3d = grid_3d.permute(0, 4, 1, 2, 3).contiguous().permute(0, 2, 3, 4, 1)
+                    grid_3d.requires_grad_()
+                    out_3d = F.grid_sample(input_3d, grid_3d, mode=mode, padding_mode=padding_mode,
+                                           align_corners=align_corners)
+                    self.assertEqual(out_3d, out_2d.unsqueeze(2).expand(N, C, D, H, W))
+
+                    out_3d.backward(grad_out.unsqueeze(2).expand(N, C, D, H, W))
+                    self.assertEqual(input_3d.grad.squeeze(2), input_2d.grad * D)
+                    for d in range(D):
+                        self.assertEqual(grid_3d.grad[:, d, :, :, :2], grid_2d.grad)
+
     def test_affine_grid(self):
         # test known input on CPU
         input = torch.arange(1., 7).view(1, 2, 3)
@@ -7875,6 +7959,88 @@ class TestNN(NNTestCase):
                     for gr, gr_expected in zip(grads, grads_expected):
                         self.assertAlmostEqual(gr, gr_expected, delta=3e-4)
 
+    def test_winograd_conv(self):
+        for tile_size, (height, width), padding, has_bias in \
+                product([2, 4], [(3, 3), (5, 8), (9, 6)], [0, 1, 2], [True, False]):
+            input = torch.randn(2, 3, height, width, dtype=torch.double, requires_grad=True)
+            weight = torch.randn(4, 3, 3, 3, dtype=torch.double, requires_grad=True)
+            bias = torch.randn(4, dtype=torch.double, requires_grad=True) if has_bias else None
+            output = torch._winograd_convolution(input, weight, bias, [padding, padding], tile_size)
+            # few channels, so conv2d doesn't use Winograd itself
+            output_expected = F.conv2d(input, weight, bias, padding=padding)
+            self.assertEqual(output, output_expected)
+
+            inputs = (input, weight, bias) if has_bias else (input, weight)
+            self.assertTrue(gradcheck(
+                lambda *args: torch._winograd_convolution(
+                    args[0], args[1], args[2] if has_bias else None, [padding, padding], tile_size),
+                inputs))
+
+        with self.assertRaisesRegex(RuntimeError, "output_tile_size must be 2 or 4"):
+            torch._winograd_convolution(torch.randn(1, 1, 4, 4), torch.randn(1, 1, 3, 3), None, [0, 0], 3)
+
+    def test_conv1x1_cpu(self):
+        for stride, has_bias, channels_last in product([1, 2], [True, False], [True, False]):
+            input = torch.randn(2, 5, 7, 6, dtype=torch.double)
+            if channels_last:
+                input = input.contiguous(memory_format=torch.channels_last)
+            input.requires_grad_()
+            weight = torch.randn(3, 5, 1, 1, dtype=torch.double, requires_grad=True)
+            bias = torch.randn(3, dtype=torch.double, requires_grad=True) if has_bias else None
+            output = F.conv2d(input, weight, bias, stride=stride)
+            output_expected = torch.einsum('nchw,kc->nkhw', input[:, :, ::stride, ::stride], weight[:, :, 0, 0])
+            if has_bias:
+                output_expected = output_expected + bias.view(1, -1, 1, 1)
+            self.assertEqual(output, output_expected)
+            if channels_last:
+                self.assertTrue(output.is_contiguous(memory_format=torch.channels_last))
+
+            inputs = (input, weight, bias) if has_bias else (input, weight)
+            self.assertTrue(gradcheck(
+                lambda *args: F.conv2d(args[0], args[1], args[2] if has_bias else None, stride=stride),
+                inputs))
+
+    def test_channels_last_cpu_kernels(self):
+        # 11 channels, so that the vectorized kernels have a partial vector left
+        ops = [
+            lambda x: F.max_pool2d(x, 3, stride=2, padding=1, return_indices=True),
+            lambda x: F.max_pool2d(x, 2, dilation=2, ceil_mode=True, return_indices=True),
+            lambda x: F.adaptive_avg_pool2d(x, (4, 3)),
+            lambda x: F.adaptive_avg_pool2d(x, 1),
+            lambda x: F.interpolate(x, scale_factor=2, mode='nearest'),
+            lambda x: F.interpolate(x, size=(5, 13), mode='nearest'),
+            lambda x: F.interpolate(x, scale_factor=2, mode='bilinear', align_corners=False),
+            lambda x: F.interpolate(x, size=(4, 11), mode='bilinear', align_corners=True),
+        ]
+        for op, dtype in product(ops, [torch.float, torch.double]):
+            input = torch.randn(2, 11, 7, 9, dtype=dtype)
+            input[0, 3, 2, 2] = float('nan')
+            input = input.contiguous(memory_format=torch.channels_last).requires_grad_()
+            ref_input = input.detach().clone().contiguous().requires_grad_()
+
+            out = op(input)
+            ref_out = op(ref_input)
+            out, ref_out = (out, ref_out) if isinstance(out, tuple) else ((out,), (ref_out,))
+            for o, ref_o in zip(out, ref_out):
+                self.assertTrue(o.is_contiguous(memory_format=torch.channels_last))
+                self.assertEqual(o, ref_o)
+
+            # the backward of the contiguous kernels takes channels last grads
+            grad = torch.randn_like(ref_out[0])
+            out[0].backward(grad.contiguous(memory_format=torch.channels_last))
+            ref_out[0].backward(grad)
+            self.assertEqual(input.grad, ref_input.grad)
+
+        for stride, padding, dilation, has_bias in product([1, 2], [0, 1], [1, 2], [True, False]):
+            input = torch.randn(2, 11, 8, 7, dtype=torch.double).contiguous(memory_format=torch.channels_last)
+            weight = torch.randn(11, 1, 3, 3, dtype=torch.double)
+            bias = torch.randn(11, dtype=torch.double) if has_bias else None
+            with torch.no_grad():
+                output = F.conv2d(input, weight, bias, stride, padding, dilation, groups=11)
+            output_expected = F.conv2d(input.contiguous(), weight, bias, stride, padding, dilation, groups=11)
+            self.assertTrue(output.is_contiguous(memory_format=torch.channels_last))
+            self.assertEqual(output, output_expected)
+
     def test_fold_invalid_arg(self):
         # input wrong dimension
 
@@ -8069,6 +8235,42 @@ class TestNN(NNTestCase):
         self.assertEqual(input.grad.dtype, dtype)
         self.assertEqual(input.grad, inputf.grad, prec=1e-1)
 
+    def test_cross_entropy_loss_fused(self):
+        # (N, C) inputs use a fused kernel, compare it with the composition
+        devices = ['cpu'] + (['cuda'] if TEST_CUDA else [])
+        for device, dtype, C in product(devices, [torch.float, torch.double], [1, 7, 1003]):
+            input = torch.randn(37, C, device=device, dtype=dtype) * 5
+            target = torch.randint(C, (37,), device=device)
+            if C > 1:
+                input[0, 0] = -float('inf')
+                target[0] = 1
+            target[1::3] = -100
+            weight = torch.rand(C, device=device, dtype=dtype)
+            for reduction, w in product(['none', 'mean', 'sum'], [None, weight]):
+                input1 = input.clone().requires_grad_()
+                input2 = input.clone().requires_grad_()
+                out1 = F.cross_entropy(input1, target, w, reduction=reduction)
+                out2 = F.nll_loss(F.log_softmax(input2, 1), target, w, reduction=reduction)
+                self.assertEqual(out1, out2)
+                grad = torch.randn_like(out1)
+                out1.backward(grad)
+                out2.backward(grad)
+                self.assertEqual(input1.grad, input2.grad)
+
+        # everything ignored
+        input = torch.randn(4, 3)
+        target = torch.full((4,), -100, dtype=torch.long)
+        self.assertEqual(F.cross_entropy(input, target), F.nll_loss(F.log_softmax(input, 1), target))
+        with self.assertRaisesRegex(IndexError, "out of bounds"):
+            F.cross_entropy(input, torch.full((4,), 3, dtype=torch.long))
+
+        input = torch.randn(5, 4, dtype=torch.double, requires_grad=True)
+        target = torch.tensor([0, 3, -100, 2, 1])
+        weight = torch.rand(4, dtype=torch.double)
+        for reduction in ['none', 'mean', 'sum']:
+            gradcheck(lambda x: F.cross_entropy(x, target, weight, reduction=reduction), (input,))
+            gradgradcheck(lambda x: F.cross_entropy(x, target, weight, reduction=reduction), (input,))
+
     @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
     def test_convert_sync_batchnorm(self):
         module = torch.nn.Sequential(
@@ -8970,6 +9172,30 @@ class TestNNDeviceType(NNTestCase):
         output.sum().backward()
         self.assertEqual(output.type(), input.type())
 
+    def _test_LayerNorm_mixed_precision(self, device, dtype):
+        # low precision inputs are accumulated in float, compare with float
+        for shape, normalized_shape in [((70, 33), [33]), ((5, 4, 100), [4, 100])]:
+            x = torch.randn(*shape, device=device)
+            grad = torch.randn(*shape, device=device)
+            ln = nn.LayerNorm(normalized_shape).to(device)
+            ln.weight.data.uniform_(0.5, 2)
+            ln.bias.data.uniform_(-1, 1)
+            ln_low = nn.LayerNorm(normalized_shape).to(device, dtype)
+            ln_low.load_state_dict(ln.to(dtype).float().state_dict())
+
+            x_ref = x.to(dtype).float().requires_grad_()
+            out_ref = ln(x_ref)
+            out_ref.backward(grad.to(dtype).float())
+            x_low = x.to(dtype).requires_grad_()
+            out = ln_low(x_low)
+            out.backward(grad.to(dtype))
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(x_low.grad.dtype, dtype)
+            self.assertEqual(out.float(), out_ref, prec=5e-2)
+            self.assertEqual(x_low.grad.float(), x_ref.grad, prec=5e-2)
+            self.assertEqual(ln_low.weight.grad.float(), ln.weight.grad, prec=0.5)
+            self.assertEqual(ln_low.bias.grad.float(), ln.bias.grad, prec=0.5)
+
     def _test_GroupNorm_general(self, device, dtype=torch.float):
         good_shape_g = {
             (1, 2, 3, 4): 2,
@@ -9104,6 +9330,35 @@ class TestNNDeviceType(NNTestCase):
 
         if self.device_type == 'cuda':
             self._test_LayerNorm_cuda_half(device)
+            self._test_LayerNorm_mixed_precision(device, torch.half)
+        self._test_LayerNorm_mixed_precision(device, torch.bfloat16)
+
+    def test_dropout_add_layer_norm(self, device):
+        # N = 10 leaves a partial group of four columns at the end of each row
+        x = torch.randn(3, 4, 10, device=device, dtype=torch.double, requires_grad=True)
+        residual = torch.randn(3, 4, 10, device=device, dtype=torch.double, requires_grad=True)
+        weight = torch.randn(10, device=device, dtype=torch.double, requires_grad=True)
+        bias = torch.randn(10, device=device, dtype=torch.double, requires_grad=True)
+        p = 0.4
+
+        expected = F.layer_norm(x + residual, [10], weight, bias)
+        self.assertEqual(torch.dropout_add_layer_norm(x, residual, [10], weight, bias, p, False), expected)
+
+        # The mask is not stored; recover it from the gradient of x, which is
+        # the gradient of residual where the element was kept and 0 elsewhere.
+        out = torch.dropout_add_layer_norm(x, residual, [10], weight, bias, p, True)
+        grad = torch.randn_like(out)
+        grad_x, grad_residual = torch.autograd.grad(out, (x, residual), grad)
+        mask = (grad_x != 0).to(x.dtype)
+        self.assertEqual(grad_x, grad_residual * mask / (1 - p))
+        self.assertEqual(out, F.layer_norm(x * mask / (1 - p) + residual, [10], weight, bias))
+        self.assertGreater(mask.sum().item(), 0)
+        self.assertLess(mask.sum().item(), mask.numel())
+
+        def fn(x, residual, weight, bias):
+            torch.manual_seed(0)
+            return torch.dropout_add_layer_norm(x, residual, [10], weight, bias, p, True)
+        gradcheck(fn, (x, residual, weight, bias))
 
     def test_GroupNorm_general(self, device):
         self._test_GroupNorm_general(device)
@@ -9638,6 +9893,27 @@ class TestNNDeviceType(NNTestCase):
         out_ref = m(inp_ref)
         self.assertEqual(out_ref, out)
 
+    @onlyCUDA
+    def test_upsamplingBilinear2d_backward_integer_scale(self, device):
+        # integer scale factors without align_corners take the gather-based
+        # backward kernel, the others the atomic one
+        for size, scale_factor in [((5, 7), 2), ((3, 4), 3), ((4, 4), 1), ((5, 6), 1.5)]:
+            kwargs = dict(scale_factor=scale_factor, mode='bilinear', align_corners=False)
+            inp = torch.randn(2, 3, *size, dtype=torch.double, requires_grad=True)
+            out = F.interpolate(inp, **kwargs)
+            grad_out = torch.randn_like(out)
+            grad_ref, = torch.autograd.grad(out, inp, grad_out)
+
+            inp_cuda = inp.detach().to(device).requires_grad_()
+            out_cuda = F.interpolate(inp_cuda, **kwargs)
+            grad_cuda, = torch.autograd.grad(out_cuda, inp_cuda, grad_out.to(device))
+            self.assertEqual(grad_ref, grad_cuda)
+
+            inp_half = inp.detach().to(device, torch.half).requires_grad_()
+            out_half = F.interpolate(inp_half, **kwargs)
+            grad_half, = torch.autograd.grad(out_half, inp_half, grad_out.to(device, torch.half))
+            self.assertEqual(grad_ref, grad_half.double(), prec=5e-2)
+
     @unittest.expectedFailure
     @skipIfRocm
     @onlyCUDA
@@ -9771,6 +10047,34 @@ class TestNNDeviceType(NNTestCase):
         # should be bitwise equal
         self.assertEqual(input.grad, inputf.grad.to(dtype), prec=0)
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.double)
+    def test_softmax_large_dim_and_masked(self, device, dtype):
+        # dims past the single-warp kernels, up to the largest persistent one
+        for dim_size in [1000, 1025, 3000, 16384, 20000]:
+            input = torch.randn(4, dim_size, device=device, dtype=dtype, requires_grad=True)
+            out = F.softmax(input, dim=-1)
+            expected = F.softmax(input.cpu(), dim=-1)
+            self.assertEqual(out, expected)
+            gO = torch.randn_like(out)
+            grad, = torch.autograd.grad(out, input, gO)
+            expected_grad, = torch.autograd.grad(expected, input, gO.cpu())
+            self.assertEqual(grad, expected_grad)
+
+        for mask_shape in [(2, 1, 1, 37), (5, 37), (2, 3, 5, 37), (1, 3, 1, 37)]:
+            for src_len in [37, 2000]:
+                input = torch.randn(2, 3, 5, src_len, device=device, dtype=dtype, requires_grad=True)
+                mask = torch.rand(mask_shape[:-1] + (src_len,), device=device) > 0.7
+                mask[..., 0] = False
+                out = torch._masked_softmax(input, mask)
+                expected = torch._masked_softmax(input.cpu(), mask.cpu())
+                self.assertEqual(out, expected)
+                self.assertEqual(out, input.masked_fill(mask, float('-inf')).softmax(-1))
+                gO = torch.randn_like(out)
+                grad, = torch.autograd.grad(out, input, gO)
+                expected_grad, = torch.autograd.grad(expected, input, gO.cpu())
+                self.assertEqual(grad, expected_grad)
+
     @onlyCUDA
     def test_pool3d_size_one_feature_dim(self, device):
         # Tests crazy strides for feature dim of size 1
@@ -9960,6 +10264,28 @@ class TestNNDeviceType(NNTestCase):
         for dtype, mode, trainable, include_last_offset in itertools.product(dtypes, modes, trainable_scale, include_last_offset):
             test_per_sample_weights_new_offsets(mode, dtype, trainable, include_last_offset)
 
+    @dtypes(torch.float, torch.double)
+    def test_EmbeddingBag_include_last_offset_modes(self, device, dtype):
+        input = torch.tensor([3, 1, 1, 1, 4, 0, 2, 2], device=device, dtype=torch.long)
+        offsets = torch.tensor([0, 2, 2, 5, 8], device=device, dtype=torch.long)
+        for mode, sparse in (('sum', False), ('sum', True), ('mean', False),
+                             ('mean', True), ('max', False)):
+            es = nn.EmbeddingBag(5, 3, mode=mode, sparse=sparse,
+                                 include_last_offset=True).to(dtype=dtype, device=device)
+            ref = nn.EmbeddingBag(5, 3, mode=mode, sparse=sparse).to(dtype=dtype, device=device)
+            ref.weight.data.copy_(es.weight.data)
+
+            result = es(input, offsets)
+            expected = ref(input, offsets[:-1])
+            self.assertEqual(result, expected, prec=dtype2prec[dtype])
+
+            grad = torch.randn_like(expected)
+            result.backward(grad)
+            expected.backward(grad)
+            self.assertEqual(es.weight.grad.to_dense() if sparse else es.weight.grad,
+                             ref.weight.grad.to_dense() if sparse else ref.weight.grad,
+                             prec=dtype2prec[dtype])
+
     def _test_EmbeddingBag_vs_Embedding(self, N, D, B, L, max_norm=None,
                                         mode='mean',
                                         device='cpu',
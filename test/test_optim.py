@@ -334,6 +334,78 @@ class TestOptim(TestCase):
                 lr=1e-3)
         )
 
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
+    def test_fused_steps(self):
+        # The fused CUDA steps match the CPU ones, including parameters split
+        # across launches, non-contiguous tensors and mixed dtypes
+        sizes = [(3,), (70000,), (5, 7), (0,), (200, 700)] + [(i + 1,) for i in range(120)]
+        params = [torch.randn(size, dtype=torch.double) for size in sizes]
+        params.append(torch.randn(7, 5, dtype=torch.double).t())
+        params.append(torch.randn(4, dtype=torch.float))
+        grads = [torch.randn_like(p) for p in params]
+
+        def check(fn, num_buffers):
+            buffers = [[torch.rand_like(p) for p in params] for _ in range(num_buffers)]
+            cpu = [[t.clone() for t in ts] for ts in [params, grads] + buffers]
+            cuda = [[t.cuda() for t in ts] for ts in [params, grads] + buffers]
+            fn(*cpu)
+            fn(*cuda)
+            for cpu_ts, cuda_ts in zip(cpu, cuda):
+                for cpu_t, cuda_t in zip(cpu_ts, cuda_ts):
+                    self.assertEqual(cpu_t, cuda_t.cpu())
+
+        for decoupled in [False, True]:
+            check(lambda *ts: torch._fused_adam(*ts, 1e-2, 0.9, 0.99, 1e-8, 0.1, 3, decoupled), 2)
+        for first_step in [False, True]:
+            for nesterov in [False, True]:
+                check(lambda *ts: torch._fused_sgd(*ts, 1e-2, 0.9, 0, 0.1, nesterov, first_step), 1)
+        check(lambda *ts: torch._fused_sgd(*ts, [], 1e-2, 0, 0, 0.1, False, False), 0)
+
+    def test_sparse_steps(self):
+        # The sparse steps sum the entries of the touched rows of an
+        # uncoalesced gradient and leave the other rows untouched
+        devices = ['cpu'] + (['cuda'] if torch.cuda.is_available() else [])
+        for device in devices:
+            for sparse_dims, shape in [(1, (50, 4)), (2, (10, 6, 3)), (1, (30,))]:
+                param = torch.randn(shape, dtype=torch.double, device=device)
+                indices = torch.stack([torch.randint(0, shape[d], (40,), device=device)
+                                       for d in range(sparse_dims)])
+                indices = torch.cat([indices, indices[:, :10]], 1)
+                values = torch.randn((50,) + shape[sparse_dims:], dtype=torch.double, device=device)
+                grad = torch.sparse_coo_tensor(indices, values, shape)
+                coalesced = grad.coalesce()
+                mask = torch.sparse_coo_tensor(
+                    coalesced._indices(), torch.ones_like(coalesced._values()), shape).to_dense()
+                g = coalesced.to_dense()
+
+                p, s = param.clone(), torch.rand_like(param)
+                expected_s = s + g * g
+                expected_p = param - 0.1 * g / (expected_s.sqrt() + 1e-10)
+                torch._sparse_adagrad_step(p, grad, s, 0.1, 1e-10)
+                self.assertEqual(p, expected_p)
+                self.assertEqual(s, expected_s)
+
+                p, m, v = param.clone(), torch.rand_like(param), torch.rand_like(param)
+                step_size = 0.1 * math.sqrt(1 - 0.999 ** 3) / (1 - 0.9 ** 3)
+                expected_m = torch.where(mask.bool(), 0.9 * m + 0.1 * g, m)
+                expected_v = torch.where(mask.bool(), 0.999 * v + 0.001 * g * g, v)
+                expected_p = param - mask * step_size * expected_m / (expected_v.sqrt() + 1e-8)
+                torch._sparse_adam_step(p, grad, m, v, 0.1, 0.9, 0.999, 1e-8, 3)
+                self.assertEqual(p, expected_p)
+                self.assertEqual(m, expected_m)
+                self.assertEqual(v, expected_v)
+
+            # Non-contiguous state is updated through a contiguous copy
+            param = torch.randn(8, 20, dtype=torch.double, device=device)
+            grad = torch.sparse_coo_tensor(torch.tensor([[1, 3, 1]], device=device),
+                                           torch.randn(3, 8, dtype=torch.double, device=device), (20, 8))
+            p, s = param.t(), torch.zeros(8, 20, dtype=torch.double, device=device).t()
+            g = grad.to_dense()
+            expected_p = p - 0.1 * g / (g.abs() + 1e-10)
+            torch._sparse_adagrad_step(p, grad, s, 0.1, 1e-10)
+            self.assertEqual(s, g * g)
+            self.assertEqual(p, expected_p)
+
     def test_sparse_adam(self):
         self._test_rosenbrock_sparse(
             lambda params: optim.SparseAdam(params, lr=4e-2),
@@ -288,6 +288,7 @@ IGNORED_TORCH_FUNCTIONS = (
     torch.initial_seed,
     torch.seed,
     torch.save,
+    torch.save_async,
     torch.load,
     torch.set_printoptions,
     torch.fork,
@@ -309,6 +310,7 @@ IGNORED_TORCH_FUNCTIONS = (
     torch.wait,
     torch.as_tensor,
     torch.from_numpy,
+    torch.frombuffer,
     torch.get_device,
     torch.tensor,
     torch.default_generator,
@@ -423,6 +425,7 @@ TENSOR_LIKE_TORCH_IMPLEMENTATIONS = (
     (torch.cartesian_prod, lambda *tensors: -1),
     (torch.cat, lambda tensors, dim=0, out=None: -1),
     (torch.cdist, lambda x1, c2, p=2, compute_mode=None: -1),
+    (torch.cdist_topk, lambda x1, x2, k, p=2, compute_mode=None: -1),
     (torch.ceil, lambda input, out=None: -1),
     (torch.celu, lambda input, alhpa=1., inplace=False: -1),
     (torch.chain_matmul, lambda *matrices: -1),
@@ -465,6 +468,7 @@ TENSOR_LIKE_TORCH_IMPLEMENTATIONS = (
     (torch.div, lambda input, other, out=None: -1),
     (torch.dot, lambda mat1, mat2: -1),
     (torch.dropout, lambda input, p, train, inplace=False: -1),
+    (torch.dropout_add_layer_norm, lambda input, residual, normalized_shape, weight=None, bias=None, p=0.5, train=True, eps=1e-05: -1),
     (torch.dsmm, lambda input, mat2: -1),
     (torch.hsmm, lambda mat1, mat2: -1),
     (torch.eig, lambda input, eigenvectors=False, out=None: -1),
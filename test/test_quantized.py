@@ -1122,6 +1122,33 @@ class TestQuantizedOps(TestCase):
             quantize_ref = torch.quantize_per_tensor(float_ref, Y_scale, Y_zero_point, dtype_x)
             self.assertEqual(qy.int_repr().numpy(), quantize_ref.int_repr().numpy())
 
+    """Tests that a chain of elementwise ops composed into a lookup table gives
+    the result of the chain."""
+    @given(X=hu.tensor(shapes=hu.array_shapes(1, 5, 1, 20),
+                       qparams=hu.qparams()),
+           channels_last=st.booleans())
+    def test_apply_lut(self, X, channels_last):
+        X, (scale, zero_point, torch_type) = X
+        qX = torch.quantize_per_tensor(torch.from_numpy(X), scale, zero_point, torch_type)
+        if channels_last and qX.dim() == 4:
+            qX = qX.contiguous(memory_format=torch.channels_last)
+
+        def chain(x):
+            x = torch.ops.quantized.clamp(x, -1.0, 2.0)
+            x = torch.sigmoid(x)
+            return torch.relu(x)
+
+        lut = chain(torch.ops.quantized.lut_domain(qX))
+        self.assertEqual(lut.numel(), 256)
+        qY = torch.ops.quantized.apply_lut(qX, lut)
+        qY_ref = chain(qX)
+        self.assertEqual(qY.q_scale(), qY_ref.q_scale())
+        self.assertEqual(qY.q_zero_point(), qY_ref.q_zero_point())
+        self.assertEqual(qY.dtype, qY_ref.dtype)
+        self.assertEqual(qY.int_repr(), qY_ref.int_repr())
+        if channels_last and qX.dim() == 4:
+            self.assertTrue(qY.is_contiguous(memory_format=torch.channels_last))
+
 @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
                      " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
                      " with instruction set support avx2 or newer.")
@@ -1742,6 +1769,44 @@ class TestQuantizedConv(unittest.TestCase):
                 dilations, X_scale, X_zero_point, W_scale, W_zero_point,
                 Y_scale, Y_zero_point, use_bias, use_relu, use_channelwise)
 
+    """Tests the correctness of the fused quantized::conv2d_add_relu op."""
+    @given(batch_size=st.integers(1, 3),
+           input_channels=st.sampled_from([2, 4, 8]),
+           output_channels=st.sampled_from([2, 4, 8]),
+           height=st.integers(6, 10),
+           width=st.integers(6, 10),
+           kernel=st.sampled_from([1, 3]),
+           qengine=st.sampled_from(("qnnpack", "fbgemm")))
+    def test_qconv_add_relu(self, batch_size, input_channels, output_channels,
+                            height, width, kernel, qengine):
+        if qengine not in torch.backends.quantized.supported_engines:
+            return
+        if qengine == 'qnnpack':
+            if IS_PPC or TEST_WITH_UBSAN or IS_MACOS:
+                return
+
+        with override_quantized_engine(qengine):
+            X = torch.randn(batch_size, input_channels, height, width)
+            W = torch.randn(output_channels, input_channels, kernel, kernel)
+            b = torch.randn(output_channels)
+            X_q = torch.quantize_per_tensor(X, 0.05, 128, torch.quint8)
+            W_q = torch.quantize_per_tensor(W, 0.02, 0, torch.qint8)
+            padding = (kernel // 2, kernel // 2)
+            W_prepack = torch.ops.quantized.conv2d_prepack(
+                W_q, b, [1, 1], padding, [1, 1], 1)
+            other = torch.randn(batch_size, output_channels, height, width)
+            other_q = torch.quantize_per_tensor(other, 0.1, 64, torch.quint8)
+
+            conv_q = torch.ops.quantized.conv2d(
+                X_q, W_prepack, [1, 1], padding, [1, 1], 1, 0.2, 100)
+            Y_ref = torch.ops.quantized.add_relu(conv_q, other_q, 0.25, 0)
+            Y = torch.ops.quantized.conv2d_add_relu(
+                X_q, W_prepack, other_q, [1, 1], padding, [1, 1], 1,
+                0.2, 100, 0.25, 0)
+            self.assertEqual(Y_ref.q_scale(), Y.q_scale())
+            self.assertEqual(Y_ref.q_zero_point(), Y.q_zero_point())
+            self.assertEqual(Y_ref.int_repr(), Y.int_repr())
+
     """Tests the correctness of the quantized::qconv_unpack op."""
     @given(
         inputs=hu.tensor_conv(
@@ -2195,6 +2260,46 @@ class TestQNNPackOps(TestCase):
             qY = torch.mean(qX, dim)
             np.testing.assert_array_almost_equal(Y.int_repr().numpy(), qY.int_repr().numpy(), decimal=0)
 
+"""Tests the correctness of the rowwise quantized embedding bag ops."""
+class TestQuantizedEmbeddingBag(TestCase):
+    def _test_embedding_bag(self, bit_rate, tolerance):
+        prepack = getattr(torch.ops.quantized, 'embedding_bag_{}_prepack'.format(bit_rate))
+        unpack = getattr(torch.ops.quantized, 'embedding_bag_{}_unpack'.format(bit_rate))
+        lookup = getattr(torch.ops.quantized, 'embedding_bag_{}'.format(bit_rate))
+
+        weight = torch.randn(20, 16)
+        packed_weight = prepack(weight)
+        unpacked_weight = unpack(packed_weight)
+        self.assertEqual(unpacked_weight.size(), weight.size())
+        self.assertEqual(unpacked_weight, weight, prec=tolerance)
+
+        indices = torch.tensor([1, 3, 5, 19, 0, 0, 7])
+        offsets = torch.tensor([0, 2, 2, 5])
+        per_sample_weights = torch.rand(indices.numel())
+        for index_dtype in [torch.int64, torch.int32]:
+            for mode, weights in [(0, None), (1, None), (0, per_sample_weights)]:
+                ref = torch.nn.functional.embedding_bag(
+                    indices, unpacked_weight, offsets, mode=['sum', 'mean'][mode],
+                    per_sample_weights=weights)
+                out = lookup(packed_weight, indices.to(index_dtype), offsets,
+                             mode, weights)
+                self.assertEqual(ref, out, prec=1e-4)
+                out = lookup(packed_weight, indices.to(index_dtype),
+                             torch.cat([offsets, torch.tensor([indices.numel()])]),
+                             mode, weights, True)
+                self.assertEqual(ref, out, prec=1e-4)
+
+    def test_embedding_bag_byte(self):
+        self._test_embedding_bag('byte', 0.05)
+
+    def test_embedding_bag_4bit(self):
+        self._test_embedding_bag('4bit', 0.5)
+
+    def test_embedding_bag_4bit_odd_dim(self):
+        with self.assertRaisesRegex(RuntimeError, "even embedding dimension"):
+            torch.ops.quantized.embedding_bag_4bit_prepack(torch.randn(4, 5))
+
+
 """Tests the correctness of the tensor comparators."""
 class TestComparatorOps(TestCase):
     """Tests the element-wise equality ops."""
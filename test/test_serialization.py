@@ -671,6 +671,44 @@ class TestSerialization(TestCase, SerializationMixin):
 
         test(io.BytesIO())
 
+    def _test_save_async(self, device):
+        x = torch.randn(100, 10, device=device)
+        data = {'x': x, 'row': x[3], 'step': 7, 'empty': torch.empty(0, device=device)}
+        expected = copy.deepcopy(data)
+
+        def check(result):
+            self.assertEqual(result, expected)
+            self.assertEqual(result['row'].data_ptr(), result['x'][3].data_ptr())
+            self.assertEqual(result['x'].device, x.device)
+
+        buf = io.BytesIO()
+        future = torch.save_async(data, buf)
+        # Later modifications are not saved
+        x.add_(1)
+        future.wait()
+        self.assertTrue(future.done())
+        buf.seek(0)
+        check(torch.load(buf))
+
+        with tempfile.NamedTemporaryFile() as f:
+            future = torch.save_async(data, f.name)
+            x.zero_()
+            future.wait()
+            check(torch.load(f.name))
+
+        future = torch.save_async(data, os.path.join(tempfile.gettempdir(), 'no', 'such', 'dir', 'f.pt'))
+        with self.assertRaises(RuntimeError):
+            future.wait()
+
+    @unittest.skipIf(IS_WINDOWS, "NamedTemporaryFile on windows")
+    def test_save_async(self):
+        self._test_save_async('cpu')
+
+    @unittest.skipIf(IS_WINDOWS, "NamedTemporaryFile on windows")
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    def test_save_async_cuda(self):
+        self._test_save_async('cuda')
+
     def run(self, *args, **kwargs):
         with serialization_method(use_zip=True):
             return super(TestSerialization, self).run(*args, **kwargs)
@@ -968,6 +968,29 @@ class TestSparse(TestCase):
         test_shape(7, 8, 9, 20, False)
         test_shape(7, 8, 9, 20, True)
 
+    def test_sparse_mm_reuse(self):
+        # Products with a coalesced matrix reuse its CSR form, which must be
+        # refreshed when the indices change
+        def test_shape(di, dj, dk, nnz):
+            x = self._gen_sparse(2, nnz, [di, dj])[0].coalesce()
+            for _ in range(3):
+                y = self.randn(dj, dk)
+                self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+                # Matrix-vector products
+                v = self.randn(dj, 1)
+                self.assertEqual(torch.mm(x, v), torch.mm(self.safeToDense(x), v))
+
+            x.mul_(2)
+            self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+            other = self._gen_sparse(2, nnz, [di, dj])[0].coalesce()
+            x.copy_(other)
+            self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(other), y))
+
+        test_shape(7, 8, 9, 20)
+        test_shape(1000, 100, 30, 2000)
+        test_shape(10, 100, 0, 20)
+        test_shape(0, 100, 100, 0)
+
     def test_dsmm(self):
         def test_shape(di, dj, dk, nnz):
             x = self._gen_sparse(2, nnz, [di, dj])[0]
@@ -1265,6 +1288,30 @@ class TestSparse(TestCase):
         expected = self.safeToDense(x) + self.safeToDense(x)
         self.assertEqual(self.safeToDense(y), expected)
 
+    def test_coalesce_and_add_large(self):
+        # Enough entries for coalesce and add to be split among threads
+        def test_shape(nnz, shape_i, shape_v=None):
+            shape = shape_i + (shape_v or [])
+            x = self._gen_sparse(len(shape_i), nnz, shape)[0]
+            y = self._gen_sparse(len(shape_i), nnz // 3, shape)[0]
+            xc = x.coalesce()
+            self.assertTrue(xc.is_coalesced())
+            self.assertEqual(self.safeToDense(xc), self.safeToDense(x))
+
+            # Indices that are already sorted and unique
+            again = self.sparse_tensor(xc._indices(), xc._values(), xc.shape).coalesce()
+            self.assertEqual(again._nnz(), xc._nnz())
+            self.assertEqual(self.safeToDense(again), self.safeToDense(xc))
+
+            res = xc + y.coalesce() * 2
+            self.assertTrue(res.is_coalesced())
+            self.assertEqual(self.safeToDense(res), self.safeToDense(x) + 2 * self.safeToDense(y))
+            self.assertEqual(self.safeToDense(x + y), self.safeToDense(x) + self.safeToDense(y))
+
+        test_shape(40000, [100])
+        test_shape(40000, [300, 300])
+        test_shape(40000, [50, 50], [3])
+
     def _test_sparse_mask_shape(self, nnz_x1, nnz_x2, shape_i, shape_v=None):
         shape = shape_i + (shape_v or [])
         x1, _, _ = self._gen_sparse(len(shape_i), nnz_x1, shape)
@@ -1,5 +1,7 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 
+import threading
+
 import torch
 from torch.utils import ThroughputBenchmark
 from torch.testing import assert_allclose
@@ -74,5 +76,41 @@ class TestThroughputBenchmark(TestCase):
     def test_module(self):
         self.linear_test(TwoLayerNetModule)
 
+class TestBatchingExecutor(TestCase):
+    def test_batching(self):
+        module = TwoLayerNet(10, 5, 15)
+        config = torch._C.BatchingConfig()
+        config.max_batch_size = 4
+        config.max_batch_delay_us = 10000
+        config.num_worker_threads = 2
+        executor = torch._C.BatchingExecutor(module._c, config)
+
+        NUM_REQUESTS = 16
+        inputs = [(torch.randn(10), torch.randn(10)) for _ in range(NUM_REQUESTS)]
+        results = [None] * NUM_REQUESTS
+
+        def request(i):
+            results[i] = executor.run(*inputs[i])
+
+        threads = [threading.Thread(target=request, args=(i,)) for i in range(NUM_REQUESTS)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for i in range(NUM_REQUESTS):
+            expected = module(inputs[i][0].unsqueeze(0), inputs[i][1].unsqueeze(0)).squeeze(0)
+            assert_allclose(results[i], expected)
+
+        stats = executor.stats()
+        self.assertEqual(stats.num_iters, NUM_REQUESTS)
+        self.assertGreater(stats.latency_avg_ms, 0)
+
+    def test_mismatched_inputs(self):
+        module = TwoLayerNet(10, 5, 15)
+        executor = torch._C.BatchingExecutor(module._c, torch._C.BatchingConfig())
+        with self.assertRaisesRegex(RuntimeError, "size"):
+            executor.run(torch.randn(3), torch.randn(10))
+
 if __name__ == '__main__':
     run_tests()
@@ -1,5 +1,7 @@
 import sys
 import io
+import array
+import struct
 import inspect
 import math
 import random
@@ -8,6 +10,7 @@ import copy
 import torch
 import torch.cuda
 import torch.backends.cuda
+import torch.backends.mkl
 import tempfile
 import unittest
 import warnings
@@ -1041,6 +1044,22 @@ class _TestTorchMixin(object):
         self.assertEqual(y[:, 0], range(100))
         self.assertEqual(y[:, 40], range(4000, 4100))
 
+    def test_copy_permute(self):
+        # The reference copies convert the dtype and don't take the transpose path
+        for dtype, ref_dtype in [(torch.uint8, torch.int), (torch.half, torch.double),
+                                 (torch.float, torch.double), (torch.double, torch.float),
+                                 (torch.complex128, torch.complex64)]:
+            x = torch.arange(3 * 37 * 9 * 11).to(dtype).reshape(3, 37, 9, 11)
+            # NCHW <-> NHWC, and permutes that move the contiguous dimension
+            for dims in [(0, 2, 3, 1), (0, 3, 1, 2), (3, 1, 0, 2), (2, 3, 0, 1)]:
+                y = x.permute(dims)
+                z = y.contiguous()
+                self.assertTrue(z.is_contiguous())
+                self.assertEqual(z.to(ref_dtype), y.to(ref_dtype, memory_format=torch.contiguous_format))
+            y = x.contiguous(memory_format=torch.channels_last)
+            self.assertEqual(y.permute(0, 2, 3, 1).contiguous().view(-1), x.permute(0, 2, 3, 1).reshape(-1))
+            self.assertEqual(y.contiguous(), x)
+
     def test_device(self):
         cpu = torch.device('cpu')
         self.assertEqual('cpu', str(cpu))
@@ -1476,6 +1495,64 @@ class _TestTorchMixin(object):
                 n_astensor[0][2] = 250.9
                 self.assertNotEqual(torch.tensor(n, device='cuda'), n_astensor)
 
+        # objects that only expose the buffer protocol share their memory
+        if hasattr(pickle, 'PickleBuffer'):
+            b = bytearray(struct.pack('=3d', 1., 2., 3.))
+            t = torch.as_tensor(pickle.PickleBuffer(memoryview(b).cast('d')))
+            self.assertEqual(t, torch.tensor([1., 2., 3.], dtype=torch.float64))
+            t[0] = 5
+            self.assertEqual(struct.unpack('=3d', b), (5., 2., 3.))
+
+    def test_tensor_from_nested_lists(self):
+        # the innermost lists mix plain numbers with other number types
+        x = [[1., 2, True], [4, 5., 6.]]
+        for dtype in [torch.float32, torch.float64, torch.float16]:
+            t = torch.tensor(x, dtype=dtype)
+            self.assertEqual(t.dtype, dtype)
+            self.assertEqual(t.tolist(), [[1, 2, 1], [4, 5, 6]])
+        x = [[1, 2, True], [4, 5, 6]]
+        for dtype in [torch.int64, torch.int32, torch.uint8]:
+            t = torch.tensor(x, dtype=dtype)
+            self.assertEqual(t.dtype, dtype)
+            self.assertEqual(t.tolist(), [[1, 2, 1], [4, 5, 6]])
+        self.assertEqual(torch.tensor(x).dtype, torch.int64)
+        self.assertEqual(torch.tensor([(1, 2), [3, 4.5]]).dtype, torch.get_default_dtype())
+        self.assertEqual(torch.tensor([[1, 2], [3, 4.5]], dtype=torch.float64)[1, 1].item(), 4.5)
+        with self.assertRaisesRegex(RuntimeError, "Overflow"):
+            torch.tensor([1, 2 ** 64])
+
+    def test_frombuffer(self):
+        a = array.array('i', [1, 2, 3, 4])
+        t = torch.frombuffer(a)
+        self.assertEqual(t.dtype, torch.int32)
+        self.assertEqual(t, torch.tensor([1, 2, 3, 4], dtype=torch.int32))
+        # shares the memory, and keeps the buffer alive
+        t[0] = -1
+        self.assertEqual(a[0], -1)
+        del a
+        self.assertEqual(t[0].item(), -1)
+
+        a = array.array('d', [1., 2., 3.])
+        self.assertEqual(torch.frombuffer(a).dtype, torch.float64)
+        self.assertEqual(torch.frombuffer(a, offset=8, count=1), torch.tensor([2.], dtype=torch.float64))
+
+        b = bytearray(struct.pack('=4h', 1, 2, 3, 4))
+        self.assertEqual(torch.frombuffer(b).dtype, torch.uint8)
+        self.assertEqual(torch.frombuffer(b, dtype=torch.int16, offset=2),
+                         torch.tensor([2, 3, 4], dtype=torch.int16))
+        self.assertEqual(torch.frombuffer(memoryview(b)[2:], dtype=torch.int16),
+                         torch.tensor([2, 3, 4], dtype=torch.int16))
+        self.assertEqual(torch.frombuffer(b, offset=8).numel(), 0)
+
+        with self.assertRaisesRegex(RuntimeError, "not a multiple of the element size"):
+            torch.frombuffer(b, dtype=torch.int32, offset=2)
+        with self.assertRaisesRegex(RuntimeError, "past the end of the buffer"):
+            torch.frombuffer(b, dtype=torch.int16, count=5)
+        with self.assertRaisesRegex(RuntimeError, "offset must be between"):
+            torch.frombuffer(b, offset=9)
+        with self.assertRaisesRegex(TypeError, "buffer protocol"):
+            torch.frombuffer([1, 2, 3])
+
     def test_renorm(self):
         m1 = torch.randn(10, 5)
         res1 = torch.Tensor()
@@ -1925,6 +2002,22 @@ class _TestTorchMixin(object):
         # Make sure True isn't mistakenly taken as the 2nd dimension (interpreted as 1)
         self.assertRaises(TypeError, lambda: q.topk(4, True))
 
+    def test_topk_large_slice(self):
+        # A single large slice is split into chunks that are searched in parallel
+        x = torch.randn(1000 * 1000)
+        x[12345] = nan
+        for k in [1, 10, 100]:
+            for largest in [True, False]:
+                values, indices = x.topk(k, largest=largest)
+                expected, _ = x.sort(descending=largest)
+                if largest:
+                    self.assertTrue(torch.isnan(values[0]))
+                    self.assertEqual(indices[0], 12345)
+                    self.assertEqual(values[1:], expected[1:k])
+                else:
+                    self.assertEqual(values, expected[:k])
+                self.assertEqual(x[indices][~torch.isnan(values)], values[~torch.isnan(values)])
+
     def test_median(self):
         for size in (155, 156):
             x = torch.rand(size, size)
@@ -2256,6 +2349,44 @@ class _TestTorchMixin(object):
     def test_fft_ifft_rfft_irfft(self):
         self._test_fft_ifft_rfft_irfft(self)
 
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_mkl_fft_plan_cache(self):
+        plan_cache = torch.backends.mkl.fft_plan_cache
+        original = plan_cache.max_size
+        try:
+            plan_cache.clear()
+            self.assertEqual(plan_cache.size, 0)
+            x = torch.randn(4, 6, 2, dtype=torch.double)
+            y = x.fft(1)
+            self.assertEqual(plan_cache.size, 1)
+            # same geometry and configuration hits the cache
+            self.assertEqual(x.fft(1), y)
+            self.assertEqual(plan_cache.size, 1)
+            x.ifft(1)
+            x.fft(1, normalized=True)
+            self.assertEqual(plan_cache.size, 3)
+
+            plan_cache.max_size = 2
+            self.assertEqual(plan_cache.size, 2)
+
+            for max_size in [max(1, plan_cache.size - 1), 0, 10]:
+                plan_cache.max_size = max_size
+                self._test_fft_ifft_rfft_irfft(self)
+                self.assertLessEqual(plan_cache.size, max_size)
+
+            plan_cache.clear()
+            self.assertEqual(plan_cache.size, 0)
+            # check that it still works after clearing the cache
+            self.assertEqual(x.fft(1), y)
+
+            with self.assertRaisesRegex(RuntimeError, r"must be non-negative"):
+                plan_cache.max_size = -1
+
+            with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+                plan_cache.size = -1
+        finally:
+            plan_cache.max_size = original
+
     @unittest.skip("Not implemented yet")
     def test_conv2(self):
         x = torch.rand(math.floor(torch.uniform(50, 100)), math.floor(torch.uniform(50, 100)))
@@ -3711,6 +3842,43 @@ class _TestTorchMixin(object):
         num_zeros = (torch.bernoulli(b) == 0).sum()
         self.assertEqual(num_zeros, 0)
 
+    def test_sampling_cpu_thread_count(self):
+        # uniform_, normal_ and bernoulli_(p) give the same values for a seed
+        # whatever the number of threads splitting the (non contiguous) output
+        def sample(num_threads):
+            num_threads_before = torch.get_num_threads()
+            torch.set_num_threads(num_threads)
+            try:
+                torch.manual_seed(123)
+                results = []
+                for dtype in [torch.float, torch.double]:
+                    x = torch.empty(300001, dtype=dtype)
+                    results.append(x.clone().uniform_(-1, 3))
+                    results.append(x.clone().normal_(1.5, 2))
+                    results.append(torch.empty(1001, 300, dtype=dtype).t().normal_())
+                    results.append(x.clone().bernoulli_(0.3))
+                results.append(torch.empty(300001, dtype=torch.bool).bernoulli_(0.3))
+                return results
+            finally:
+                torch.set_num_threads(num_threads_before)
+
+        results = sample(1)
+        for a, b in zip(results, sample(4)):
+            self.assertEqual(a, b, 0)
+        for i, dtype in enumerate([torch.float, torch.double]):
+            uniform, normal, normal_t, bernoulli = results[4 * i:4 * i + 4]
+            self.assertTrue(uniform.min() >= -1 and uniform.max() < 3)
+            self.assertEqual(uniform.mean(), 1, 0.02)
+            self.assertEqual(uniform.std(), 4 / math.sqrt(12), 0.02)
+            self.assertEqual(normal.mean(), 1.5, 0.02)
+            self.assertEqual(normal.std(), 2, 0.02)
+            self.assertEqual(normal_t.mean(), 0, 0.02)
+            self.assertEqual(normal_t.std(), 1, 0.02)
+            self.assertEqual(bernoulli.mean(), 0.3, 0.01)
+        self.assertEqual(results[-1].float().mean(), 0.3, 0.01)
+        # consecutive calls use different streams
+        self.assertNotEqual(torch.rand(1000), torch.rand(1000))
+
     def test_generator_cpu(self):
         # test default generators are equal
         self.assertEqual(torch.default_generator, torch.default_generator)
@@ -3847,6 +4015,23 @@ class _TestTorchMixin(object):
         self.assertRaises(TypeError,
                           lambda: torch.isclose(x, x, torch.tensor(1.5), torch.tensor(1., requires_grad=True)).all())
 
+    def test_parsing_repeated_calls(self):
+        # The parser tries the signature of the last call with the same
+        # argument types first; this must not change the signature picked
+        x = torch.arange(6.).view(2, 3)
+        for _ in range(3):
+            self.assertEqual(torch.add(x, x), 2 * x)
+            self.assertEqual(torch.add(x, 2), x + 2)
+            self.assertEqual(torch.add(x, torch.tensor(2.)), x + 2)
+            self.assertEqual(x.sum(0), torch.tensor([3., 5., 7.]))
+            self.assertEqual(x.sum((0, 1)), torch.tensor(15.))
+            self.assertEqual(x.sum(), torch.tensor(15.))
+            self.assertEqual(torch.cumsum(x, torch.tensor(1)), torch.cumsum(x, 1))
+            self.assertRaises(TypeError, lambda: torch.cumsum(x, torch.tensor(1.)))
+            self.assertRaises(TypeError, lambda: torch.cumsum(x, torch.tensor([1])))
+            self.assertEqual(torch.ones(3, 2).shape, torch.Size([3, 2]))
+            self.assertEqual(torch.ones(torch.tensor(3), 2).shape, torch.Size([3, 2]))
+
     def test_parsing_intlist(self):
         #  parse with integer variables
         self.assertEqual(torch.Size([3, 4]), torch.ones((torch.tensor(3), torch.tensor(4))).shape)
@@ -9721,6 +9906,26 @@ class TestTorchDeviceType(TestCase):
             expected = brute_cdist(x, y, p=2)
             self.assertTrue(torch.allclose(expected, actual))
 
+    def test_cdist_topk(self, device):
+        # x2 spans several tiles, so running results get merged across tiles
+        for x_shape, y_shape in [((60, 8), (2500, 8)), ((2, 30, 8), (1, 2500, 8))]:
+            x = torch.randn(x_shape, device=device, dtype=torch.double)
+            y = torch.randn(y_shape, device=device, dtype=torch.double)
+            for p in [0.5, 1, 2, 3, float('inf')]:
+                for k in [1, 5, 1500]:
+                    values, indices = torch.cdist_topk(x, y, k, p)
+                    expected_values, expected_indices = torch.cdist(x, y, p).topk(k, largest=False)
+                    self.assertEqual(values, expected_values)
+                    self.assertEqual(indices, expected_indices)
+
+        x = torch.randn(4, 3, device=device)
+        y = torch.randn(5, 3, device=device)
+        values, indices = torch.cdist_topk(x, y, 0)
+        self.assertEqual(values.shape, (4, 0))
+        self.assertEqual(indices.dtype, torch.long)
+        with self.assertRaisesRegex(RuntimeError, 'must be between 0'):
+            torch.cdist_topk(x, y, 6)
+
     def test_cdist_non_contiguous(self, device):
         for cm in ['use_mm_for_euclid_dist', 'donot_use_mm_for_euclid_dist']:
             x = torch.randn(5, 7, device=device).transpose(-1, -2)
@@ -9939,6 +10144,33 @@ class TestTorchDeviceType(TestCase):
             self.assertEqual(a1 * a2, torch.tensor([0.11, 0.01], dtype=torch.bfloat16, device=device), 0.01)
             self.assertEqual(a1.mul(a2), a1 * a2)
 
+    @onlyCPU
+    def test_bfloat16_unary_ops(self, device):
+        # bfloat16 is computed in float, so it must match the float result
+        # rounded to bfloat16. The sizes cover the vectorized loop, its tail,
+        # and strided inputs.
+        ops = [
+            (torch.sigmoid, -5, 5),
+            (torch.exp, -5, 5),
+            (torch.log, 0.1, 10),
+            (torch.tanh, -3, 3),
+            (torch.sqrt, 0, 10),
+            (torch.rsqrt, 0.1, 10),
+            (torch.reciprocal, 0.1, 10),
+            (torch.neg, -10, 10),
+            (torch.floor, -10, 10),
+            (torch.sin, -3, 3),
+        ]
+        for op, low, high in ops:
+            for size in (7, 16, 33, 1000):
+                x = torch.empty(size, 2, device=device).uniform_(low, high).bfloat16()
+                for t in (x[:, 0].contiguous(), x[:, 0]):
+                    expected = op(t.float()).bfloat16()
+                    actual = op(t)
+                    self.assertEqual(actual.dtype, torch.bfloat16)
+                    self.assertEqual(actual.float(), expected.float(),
+                                     prec=expected.float().abs().max().item() * 1e-2 + 1e-2)
+
     def test_cumsum(self, device):
         x = torch.rand(100, 100, device=device)
         res1 = torch.cumsum(x, 1)
@@ -10033,6 +10265,26 @@ class TestTorchDeviceType(TestCase):
         # Check that output maintained correct shape
         self.assertEqual(raw_tensor.shape, raw_tensor.grad.shape)
 
+    @unittest.skipIf(not TEST_NUMPY, 'Numpy not found')
+    def test_cumsum_cumprod_large_and_batched(self, device):
+        # Long single rows take the blocked CPU scan and the cub path on CUDA;
+        # many short rows and scans over outer dims take the batched kernels.
+        for shape, dim in [((200000,), 0), ((3, 150000), 1), ((1000, 7), 1),
+                           ((1000, 33), 1), ((7, 300, 5), 1), ((4, 5), 0)]:
+            x = torch.randint(-3, 4, shape, device=device, dtype=torch.int64)
+            self.assertEqual(torch.cumsum(x, dim).cpu(),
+                             torch.from_numpy(np.cumsum(x.cpu().numpy(), dim)))
+
+            x = 1 + (torch.rand(shape, device=device, dtype=torch.double) - 0.5) * 1e-3
+            self.assertEqual(torch.cumprod(x, dim).cpu(),
+                             torch.from_numpy(np.cumprod(x.cpu().numpy(), dim)))
+
+        # non-contiguous output
+        x = torch.randn(1000, 7, device=device, dtype=torch.double)
+        out = torch.empty(7, 1000, device=device, dtype=torch.double).t()
+        torch.cumsum(x, 1, out=out)
+        self.assertEqual(out.cpu(), torch.from_numpy(np.cumsum(x.cpu().numpy(), 1)))
+
     def test_cummax_cummin(self, device):
         def test_ops(op, string_of_function_name, expected_output):
             x = torch.rand(100, 100, device=device)
@@ -10131,6 +10383,27 @@ class TestTorchDeviceType(TestCase):
             self.assertEqual(var1, var2)
             self.assertEqual(mean1, mean2)
 
+    @dtypes(torch.float, torch.double, torch.int8, torch.int, torch.long, torch.uint8)
+    def test_aminmax(self, device, dtype):
+        x = torch.randint(-50, 50, (10, 30, 20), device=device).to(dtype)
+        min1, max1 = torch._aminmax(x)
+        self.assertEqual(min1, x.min())
+        self.assertEqual(max1, x.max())
+        for dim in [0, 1, 2, (0, 2)]:
+            for keepdim in [False, True]:
+                min1, max1 = torch._aminmax(x, dim=dim, keepdim=keepdim)
+                self.assertEqual(min1, x.min_values(dim=dim, keepdim=keepdim))
+                self.assertEqual(max1, x.max_values(dim=dim, keepdim=keepdim))
+
+        if dtype.is_floating_point:
+            x[3, 4, 5] = nan
+            min1, max1 = torch._aminmax(x, dim=0)
+            self.assertTrue(torch.isnan(min1[4, 5]) and torch.isnan(max1[4, 5]))
+            self.assertEqual(torch.isnan(min1).sum(), 1)
+
+        with self.assertRaisesRegex(RuntimeError, "no elements"):
+            torch._aminmax(torch.empty(0, 3, device=device, dtype=dtype))
+
     def test_std_mean_some_dims(self, device):
         sizes = (4, 6, 7, 5, 3)
         dims = len(sizes)
@@ -10726,6 +10999,42 @@ class TestTorchDeviceType(TestCase):
                                             [False, True, False, True, False],
                                             [True, False, True, False, True]], device=device))
 
+    def test_scatter_add_gather_large(self, device):
+        # Long index lines take the parallel CPU paths, including the
+        # by-destination split of one-dimensional scatter_add.
+        src = torch.randint(0, 10, (100000,), device=device, dtype=torch.long)
+        index = torch.randint(0, 1000, (100000,), device=device)
+        expected = torch.zeros(1000, dtype=torch.long)
+        expected.index_put_((index.cpu(),), src.cpu(), accumulate=True)
+        res = torch.zeros(1000, dtype=torch.long, device=device).scatter_add_(0, index, src)
+        self.assertEqual(res, expected.to(device))
+        self.assertEqual(res.gather(0, index), expected[index.cpu()].to(device))
+        self.assertEqual(res.index_select(0, index), expected[index.cpu()].to(device))
+
+        src2 = src.view(-1, 1).expand(-1, 8).contiguous()
+        res2 = torch.zeros(1000, 8, dtype=torch.long, device=device)
+        res2.scatter_add_(0, index.view(-1, 1).expand(-1, 8), src2)
+        self.assertEqual(res2, expected.view(-1, 1).expand(-1, 8).to(device))
+
+    @dtypes(torch.float, torch.double, torch.long)
+    def test_accumulate_duplicate_indices(self, device, dtype):
+        # Many duplicates in few destinations, in every accumulating indexing op
+        index = torch.randint(0, 3, (1000,), device=device)
+        src = torch.randint(0, 10, (1000, 5), device=device).to(dtype)
+        expected = torch.zeros(3, 5, dtype=dtype)
+        for i, j in enumerate(index.tolist()):
+            expected[j] += src[i].cpu()
+        expected = expected.to(device)
+
+        res = torch.zeros(3, 5, dtype=dtype, device=device).index_add_(0, index, src)
+        self.assertEqual(res, expected)
+        res = torch.zeros(3, 5, dtype=dtype, device=device).index_put_((index,), src, accumulate=True)
+        self.assertEqual(res, expected)
+        res = torch.zeros(3, 5, dtype=dtype, device=device).scatter_add_(0, index.unsqueeze(1).expand(-1, 5), src)
+        self.assertEqual(res, expected)
+        res = torch.zeros(5, 3, dtype=dtype, device=device).t().scatter_add_(0, index.unsqueeze(1).expand(-1, 5), src)
+        self.assertEqual(res, expected)
+
     def test_masked_scatter_bool_tensor(self, device):
         src = torch.tensor([True, True, True], device=device)
         dst = torch.tensor([False, False, False], device=device)
@@ -12102,6 +12411,39 @@ class TestTorchDeviceType(TestCase):
         self.assertEqual(top1, top2)
         self.assertEqual(idx1, idx2)
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.half, torch.long)
+    def test_sort_topk_mode_many_slices(self, device, dtype):
+        # Medium rows in a batch, and rows longer than the in-block sorts handle
+        for shape in ((512, 300), (3, 5000)):
+            x = torch.randint(-50, 50, shape, device=device).to(dtype)
+            x_cpu = x.cpu().double()
+            for dim in (0, 1):
+                for descending in (False, True):
+                    values, indices = x.sort(dim, descending)
+                    expected_values, _ = x_cpu.sort(dim, descending)
+                    self.assertEqual(values.cpu().double(), expected_values)
+                    self.assertEqual(x.gather(dim, indices), values)
+
+                values, indices = x.topk(10, dim)
+                expected_values, _ = x_cpu.topk(10, dim)
+                self.assertEqual(values.cpu().double(), expected_values)
+                self.assertEqual(x.gather(dim, indices), values)
+
+                values, indices = x.mode(dim)
+                expected_values, expected_indices = x_cpu.mode(dim)
+                self.assertEqual(values.cpu().double(), expected_values)
+                self.assertEqual(indices.cpu(), expected_indices)
+
+    @onlyCUDA
+    def test_sort_nan_gpu(self, device):
+        x = torch.tensor([1., float('nan'), -float('inf'), -float('nan'), float('inf')], device=device)
+        values, _ = x.sort()
+        self.assertEqual(values[:3], torch.tensor([-float('inf'), 1., float('inf')], device=device))
+        self.assertTrue(torch.isnan(values[3:]).all())
+        values, _ = x.sort(descending=True)
+        self.assertTrue(torch.isnan(values[:2]).all())
+
     def test_is_signed(self, device):
         self.assertEqual(torch.IntTensor(5).to(device).is_signed(), True)
         self.assertEqual(torch.ByteTensor(5).to(device).is_signed(), False)
@@ -12427,6 +12769,31 @@ class TestTorchDeviceType(TestCase):
             self._test_unique_with_expects(device, dtype, f, x, expected_unique, expected_inverse, expected_counts, (3, 3))
             self._test_unique_scalar_empty(dtype, device, f)
 
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    @dtypes(torch.long, torch.int, torch.int8, torch.float, torch.double)
+    def test_unique_large(self, device, dtype):
+        # large enough for the CPU implementation to hash in parallel
+        for high in [100, 100000]:
+            x = torch.randint(-high, high, (300000,), device=device).to(dtype)
+            expected_unique, expected_inverse, expected_counts = (
+                torch.from_numpy(a).to(device) for a in
+                np.unique(x.cpu().numpy(), return_inverse=True, return_counts=True))
+            unique, inverse, counts = torch.unique(x, sorted=True, return_inverse=True, return_counts=True)
+            self.assertEqual(unique, expected_unique)
+            self.assertEqual(inverse, expected_inverse)
+            self.assertEqual(counts, expected_counts)
+
+            unique, inverse, counts = torch.unique(x, sorted=False, return_inverse=True, return_counts=True)
+            self.assertEqual(unique.sort()[0], expected_unique)
+            self.assertEqual(unique[inverse], x)
+            self.assertEqual(counts, torch.zeros_like(counts).index_add_(0, inverse, torch.ones_like(inverse)))
+
+            x = x.sort()[0].repeat_interleave(2)
+            unique, inverse, counts = torch.unique_consecutive(x, return_inverse=True, return_counts=True)
+            self.assertEqual(unique, expected_unique)
+            self.assertEqual(inverse, torch.arange(len(unique), device=device).repeat_interleave(counts))
+            self.assertEqual(counts, 2 * expected_counts)
+
     @dtypesIfCUDA(torch.half, torch.float, torch.double)
     @dtypes(torch.float, torch.double)
     def test_erfinv(self, device, dtype):
@@ -13672,6 +14039,47 @@ class TestTorchDeviceType(TestCase):
         res6 = torch.baddbmm(res2, b1, b2, beta=.1, alpha=.5)
         self.assertEqual(res6, res2 * .1 + res * .5)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_small_gemm(self, device, dtype):
+        # small products skip BLAS, compare them with double precision ones
+        def ref(a, b):
+            return torch.mm(a.double(), b.double()).to(dtype)
+
+        prec = 1e-4 if dtype == torch.float else 1e-10
+
+        for m, n, k in [(1, 1, 1), (3, 5, 7), (4, 16, 8), (16, 64, 64), (23, 17, 9)]:
+            for ta, tb in product([False, True], repeat=2):
+                a = torch.randn(k, m, dtype=dtype, device=device).t() if ta else \
+                    torch.randn(m, k, dtype=dtype, device=device)
+                b = torch.randn(n, k, dtype=dtype, device=device).t() if tb else \
+                    torch.randn(k, n, dtype=dtype, device=device)
+                c = torch.randn(m, n, dtype=dtype, device=device)
+                self.assertEqual(torch.mm(a, b), ref(a, b), prec=prec)
+                self.assertEqual(torch.addmm(c, a, b, beta=0.5, alpha=2), 0.5 * c + 2 * ref(a, b), prec=prec)
+                self.assertEqual(torch.addmm(c[0], a, b), c[0] + ref(a, b), prec=prec)
+                c2 = c.clone()
+                c2.addmm_(a, b, beta=-1)
+                self.assertEqual(c2, ref(a, b) - c, prec=prec)
+
+                # beta=0 ignores NaN in self
+                nan = torch.full((m, n), float('nan'), dtype=dtype, device=device)
+                self.assertEqual(torch.addmm(nan, a, b, beta=0), ref(a, b), prec=prec)
+
+                batch1 = torch.stack([a, 2 * a])
+                batch2 = torch.stack([b, b])
+                res = torch.bmm(batch1, batch2)
+                self.assertEqual(res[0], ref(a, b), prec=prec)
+                self.assertEqual(res[1], 2 * ref(a, b), prec=prec)
+                self.assertEqual(torch.baddbmm(res, batch1, batch2, beta=0.5), res * 1.5, prec=prec)
+
+        # the output may be one of the inputs
+        a = torch.randn(5, 5, dtype=dtype, device=device)
+        b = torch.randn(5, 5, dtype=dtype, device=device)
+        expected = ref(a, b)
+        torch.mm(a, b, out=a)
+        self.assertEqual(a, expected, prec=prec)
+
     def _test_cop(self, torchfn, mathfn, dtype, device):
         def reference_implementation(res2):
             for i, j in iter_indices(sm1):
@@ -13816,6 +14224,45 @@ class TestTorchDeviceType(TestCase):
         self.assertRaises(RuntimeError, lambda: torch.cat([]))
         self.assertRaisesRegex(TypeError, 'got None', lambda: torch.cat([x, None]))
 
+    @onlyCPU
+    @dtypes(torch.bool, torch.float, torch.double, torch.int64)
+    def test_cat_memory_formats(self, device, dtype):
+        def make(*size):
+            return torch.randint(low=0, high=2, size=size, device=device).to(dtype)
+
+        for dim in range(4):
+            sizes = [[2, 3, 4, 5] for _ in range(3)]
+            for i, size in enumerate(sizes):
+                size[dim] = i + 2
+            xs = [make(*size).contiguous(memory_format=torch.channels_last) for size in sizes]
+            expected = torch.cat([x.contiguous() for x in xs], dim)
+            res = torch.cat(xs, dim)
+            self.assertEqual(res, expected, 0)
+            self.assertTrue(res.is_contiguous(memory_format=torch.channels_last))
+
+            # inputs with other strides and types are copied one by one
+            mixed = [xs[0], xs[1].contiguous(), xs[2].to(torch.int)]
+            res = torch.cat(mixed, dim)
+            self.assertEqual(res, expected, 0)
+            self.assertTrue(res.is_contiguous())
+
+            # a preallocated output keeps its memory format
+            out = torch.empty_like(expected).contiguous(memory_format=torch.channels_last)
+            out_data = out.data_ptr()
+            torch.cat(mixed, dim, out=out)
+            self.assertEqual(out, expected, 0)
+            self.assertEqual(out.data_ptr(), out_data)
+            self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+
+        # many small inputs, some of them empty or skipped
+        xs = [make(3, i % 4, 2) for i in range(200)] + [make(0)]
+        res = torch.cat(xs, 1)
+        self.assertEqual(res.size(), (3, sum(x.size(1) for x in xs[:-1]), 2))
+        offset = 0
+        for x in xs[:-1]:
+            self.assertEqual(res.narrow(1, offset, x.size(1)), x, 0)
+            offset += x.size(1)
+
     @onlyCPU
     def test_cat_scalars(self, device):
         x = torch.tensor(0, device=device)
@@ -14017,6 +14464,44 @@ class TestDevicePrecision(TestCase):
         self.assertEqual(x.sum(dim=(-1, -2)).cpu(), y.sum(dim=(-1, -2)))
         self.assertEqual(x.sum(dim=(1, 3)).cpu(), y.sum(dim=(1, 3)))
 
+    @dtypes(torch.double)
+    def test_reduce_skinny(self, device, dtype):
+        # Few outputs over a long reduced dimension, which split the reduction
+        # across blocks
+        x = torch.randn(1, 1000003, dtype=dtype, device=device)
+        y = x.cpu()
+        self.assertEqual(x.sum().cpu(), y.sum())
+        self.assertEqual(x.sum(1).cpu(), y.sum(1))
+        self.assertEqual(x.max(1)[0].cpu(), y.max(1)[0])
+        self.assertEqual(x.t().sum(0).cpu(), y.t().sum(0))
+        # per-channel reduction of a large feature map
+        x = torch.randn(4, 3, 300, 301, dtype=dtype, device=device)
+        y = x.cpu()
+        self.assertEqual(x.sum(dim=(0, 2, 3)).cpu(), y.sum(dim=(0, 2, 3)))
+        self.assertEqual(x.var(dim=(0, 2, 3)).cpu(), y.var(dim=(0, 2, 3)))
+        # results do not depend on the order the blocks finish in
+        self.assertEqual(x.sum(dim=(0, 2, 3)), x.sum(dim=(0, 2, 3)), prec=0)
+
+    @dtypes(torch.float, torch.double, torch.int)
+    def test_elementwise_noncontig(self, device, dtype):
+        # Transposed, channels last, strided and broadcast operands, with
+        # sizes around the vector size and the tile size of the CPU loops
+        for m, n in ((3, 5), (8, 8), (37, 70), (130, 65)):
+            a = torch.randn(m, n, device=device).mul(10).to(dtype)
+            b = torch.randn(n, m, device=device).mul(10).to(dtype)
+            c = torch.randn(m, 2 * n, device=device).mul(10).to(dtype)
+            operands = (a.t(), b, c[:, ::2].t(), a[:1].t().expand(n, m))
+            for x, y in product(operands, operands):
+                self.assertEqual(x + y, x.contiguous() + y.contiguous())
+                self.assertEqual(x * y, x.contiguous() * y.contiguous())
+            if dtype.is_floating_point:
+                self.assertEqual(a.t().exp(), a.t().contiguous().exp())
+                self.assertEqual(a.t().sigmoid(), a.t().contiguous().sigmoid())
+        x = torch.randn(2, 16, 9, 9, device=device).to(dtype)
+        x = x.contiguous(memory_format=torch.channels_last)
+        y = torch.randn(2, 16, 9, 9, device=device).to(dtype)
+        self.assertEqual(x + y, x.contiguous() + y)
+
     def test_device_serialization(self, device):
         x = torch.randn(4, 4, device=device)
 
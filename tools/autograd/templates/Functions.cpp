@@ -1046,6 +1046,22 @@ Tensor mse_loss_double_backward_grad_output(const Tensor & grad, const Tensor &
   return (r * grad).sum();
 }
 
+// _cross_entropy_loss_backward computes
+//   grad_losses[i] * target_weight[i] * (softmax(self)[i] - one_hot(target[i]))
+// Ignored rows have a zero target weight, so their target is clamped to a
+// valid class before it is used as an index.
+Tensor cross_entropy_loss_double_backward_grad_losses(const Tensor & grad, const Tensor & self, const Tensor & target, const Tensor & target_weight) {
+  auto valid_target = target.clamp(0, self.size(1) - 1).unsqueeze(1);
+  auto softmax_grad = (grad * at::softmax(self, 1)).sum(1);
+  return (softmax_grad - grad.gather(1, valid_target).squeeze(1)) * target_weight;
+}
+
+Tensor cross_entropy_loss_double_backward(const Tensor & grad, const Tensor & grad_losses, const Tensor & self, const Tensor & target_weight) {
+  auto output = at::softmax(self, 1);
+  auto scaled_grad = grad * (grad_losses * target_weight).unsqueeze(1);
+  return output * (scaled_grad - (scaled_grad * output).sum(1, true));
+}
+
 Tensor soft_margin_loss_double_backward(const Tensor & grad, const Tensor & input, const Tensor & target, int64_t reduction) {
   auto z = (input * -target).exp();
   auto zplus1 = z + 1;
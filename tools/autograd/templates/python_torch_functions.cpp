@@ -302,6 +302,16 @@ static PyObject * THPVariable_as_tensor(PyObject* self, PyObject* args, PyObject
   END_HANDLE_TH_ERRORS
 }
 
+// implemented on python object to share the memory of any object that exposes
+// the buffer protocol
+static PyObject * THPVariable_frombuffer(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+  HANDLE_TH_ERRORS
+  jit::tracer::warn("torch.frombuffer", jit::tracer::WARN_CONSTRUCTOR);
+  return THPVariable_Wrap(torch::utils::frombuffer(args, kwargs));
+  END_HANDLE_TH_ERRORS
+}
+
 // implemented on python object here because PyObject currently not natively declarable
 // See: ATen/native/README.md for more context
 static PyObject * THPVariable_from_numpy(PyObject* module, PyObject* arg)
@@ -392,6 +402,7 @@ static PyObject * TypeError_to_NotImplemented_(PyObject* self, PyObject* args, P
 static PyMethodDef torch_functions[] = {
   {"arange", (PyCFunction)(void(*)(void))THPVariable_arange, METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
   {"as_tensor", (PyCFunction)(void(*)(void))THPVariable_as_tensor, METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
+  {"frombuffer", (PyCFunction)(void(*)(void))THPVariable_frombuffer, METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
   {"dsmm", (PyCFunction)(void(*)(void))THPVariable_mm, METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
   {"from_numpy", (PyCFunction)THPVariable_from_numpy, METH_STATIC | METH_O, NULL},
   {"hsmm", (PyCFunction)(void(*)(void))THPVariable_hspmm, METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
@@ -424,6 +424,7 @@ def gen_pyi(declarations_path, out):
         'clamp': ["def clamp(self, min: _float=-inf, max: _float=inf,"
                   " *, out: Optional[Tensor]=None) -> Tensor: ..."],
         'as_tensor': ["def as_tensor(data: Any, dtype: _dtype=None, device: Optional[_device]=None) -> Tensor: ..."],
+        'frombuffer': ["def frombuffer(buffer: Any, *, dtype: _dtype=None, count: _int=-1, offset: _int=0) -> Tensor: ..."],
         'get_num_threads': ['def get_num_threads() -> _int: ...'],
         'set_num_threads': ['def set_num_threads(num: _int) -> None: ...'],
         'get_num_interop_threads': ['def get_num_interop_threads() -> _int: ...'],
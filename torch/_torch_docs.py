@@ -541,7 +541,8 @@ as_tensor(data, dtype=None, device=None) -> Tensor
 Convert the data into a `torch.Tensor`. If the data is already a `Tensor` with the same `dtype` and `device`,
 no copy will be performed, otherwise a new `Tensor` will be returned with computational graph retained if data
 `Tensor` has ``requires_grad=True``. Similarly, if the data is an ``ndarray`` of the corresponding `dtype` and
-the `device` is the cpu, no copy will be performed.
+the `device` is the cpu, no copy will be performed. The same holds for objects that implement the Python buffer
+protocol without being sequences; use :func:`torch.frombuffer` for sequences like :class:`bytearray`.
 
 Args:
     {data}
@@ -567,6 +568,46 @@ Example::
     array([1,  2,  3])
 """.format(**factory_data_common_args))
 
+add_docstr(torch.frombuffer,
+           r"""
+frombuffer(buffer, *, dtype=None, count=-1, offset=0) -> Tensor
+
+Creates a 1-dimensional :class:`Tensor` that shares the memory of an object
+that implements the Python buffer protocol, like :class:`bytearray`,
+:class:`array.array` or :class:`memoryview`, without copying it.
+
+The bytes of the buffer, starting at :attr:`offset`, are read as elements of
+type :attr:`dtype`. Modifications to the tensor will be reflected in the buffer
+and vice versa. The buffer must be contiguous and it is kept alive by the
+tensor. If it is read-only, a warning is given once, since tensors can't be
+read-only.
+
+Args:
+    buffer (object): an object that exposes the buffer protocol.
+
+Keyword args:
+    dtype (:class:`torch.dtype`, optional): the type of the elements. Default:
+        the element type of the buffer, or ``torch.uint8`` if it has none.
+    count (int, optional): the number of elements to read. Default: ``-1``,
+        all the elements after :attr:`offset`.
+    offset (int, optional): the number of bytes to skip at the start of the
+        buffer. Default: ``0``.
+
+Example::
+
+    >>> import array
+    >>> a = array.array('i', [1, 2, 3])
+    >>> t = torch.frombuffer(a)
+    >>> t
+    tensor([1, 2, 3], dtype=torch.int32)
+    >>> t[0] = -1
+    >>> a
+    array('i', [-1, 2, 3])
+
+    >>> torch.frombuffer(bytearray(b'\x01\x02\x03\x04'), dtype=torch.int16, offset=2)
+    tensor([1027], dtype=torch.int16)
+""")
+
 add_docstr(torch.asin,
            r"""
 asin(input, out=None) -> Tensor
@@ -975,6 +1016,43 @@ Example::
              -0.5790,  0.1497]])
 """.format(**common_args))
 
+add_docstr(torch.cdist_topk,
+           r"""
+cdist_topk(x1, x2, k, p=2, compute_mode=None) -> (Tensor, LongTensor)
+
+For every row vector of :attr:`x1`, returns the :attr:`k` smallest p-norm
+distances to the row vectors of :attr:`x2` and their row indices in :attr:`x2`,
+sorted from nearest to farthest.
+
+The result equals ``torch.cdist(x1, x2, p).topk(k, largest=False)`` up to the
+order of ties, but the full distance matrix is never materialized: :attr:`x1`
+and :attr:`x2` are processed in blocks whose distances fit in a bounded amount
+of memory, so it can be used for k-nearest-neighbour search over collections
+whose distance matrix would not fit in memory.
+
+A namedtuple of `(values, indices)` is returned.
+
+Args:
+    x1 (Tensor): input tensor of shape :math:`B \times P \times M`.
+    x2 (Tensor): input tensor of shape :math:`B \times R \times M`.
+    k (int): number of nearest rows of :attr:`x2` to return, at most :math:`R`
+    p (float, optional): p value for the p-norm distance, as in :func:`torch.cdist`
+    compute_mode (int, optional): ``None`` to use matrix multiplication for
+        euclidean distance (p = 2) on large blocks, ``1`` to always use it, ``2``
+        to never use it
+
+Example::
+
+    >>> x1 = torch.tensor([[0., 0.], [5., 5.]])
+    >>> x2 = torch.tensor([[1., 0.], [4., 4.], [0., 3.]])
+    >>> torch.cdist_topk(x1, x2, 2)
+    torch.return_types.cdist_topk(
+    values=tensor([[1.0000, 3.0000],
+            [1.4142, 5.3852]]),
+    indices=tensor([[0, 2],
+            [1, 2]]))
+""")
+
 add_docstr(torch.ceil,
            r"""
 ceil(input, out=None) -> Tensor
@@ -1852,6 +1930,38 @@ Example::
     tensor(7)
 """)
 
+add_docstr(torch.dropout_add_layer_norm,
+           r"""
+dropout_add_layer_norm(input, residual, normalized_shape, weight=None, bias=None, p=0.5, train=True, eps=1e-05) -> Tensor
+
+Computes ``torch.layer_norm(torch.dropout(input, p, train) + residual,
+normalized_shape, weight, bias, eps)``, the sequence that ends every sublayer
+of a transformer block, in a single pass.
+
+In training mode the dropout mask is generated on the fly and not stored: the
+backward regenerates it from the random seed, so only the sum that is
+normalized is saved for the backward.
+
+Args:
+    input (Tensor): the tensor to apply dropout to
+    residual (Tensor): the tensor added to the result of dropout, of the same
+        shape and dtype as :attr:`input`
+    normalized_shape (list or torch.Size): the trailing dimensions to normalize
+        over, as in :func:`torch.nn.functional.layer_norm`
+    weight (Tensor, optional): elementwise scale of the normalized result
+    bias (Tensor, optional): elementwise shift of the normalized result
+    p (float, optional): probability of an element of :attr:`input` to be zeroed
+    train (bool, optional): apply dropout if ``True``
+    eps (float, optional): value added to the variance for numerical stability
+
+Example::
+
+    >>> x = torch.randn(2, 5, 8)
+    >>> residual = torch.randn(2, 5, 8)
+    >>> torch.dropout_add_layer_norm(x, residual, [8], p=0.1).shape
+    torch.Size([2, 5, 8])
+""")
+
 add_docstr(torch.eig,
            r"""
 eig(input, eigenvectors=False, out=None) -> (Tensor, Tensor)
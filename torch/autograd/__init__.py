@@ -157,6 +157,145 @@ def grad(outputs, inputs, grad_outputs=None, retain_graph=None, create_graph=Fal
         inputs, allow_unused)
 
 
+class StaticGraph(object):
+    r"""Runs the backward pass of the same graph again and again.
+
+    The graph behind ``outputs`` is discovered once, when the
+    :class:`StaticGraph` is created, together with the order to compute the
+    gradients in. Every call then only computes the gradients for new
+    ``grad_outputs``, without building the bookkeeping of :func:`backward`
+    again, e.g. to compute a Jacobian one row at a time. The graph is never
+    freed by a call, it lives as long as the tensors and the
+    :class:`StaticGraph` do.
+
+    Graphs with functions on other devices than the CPU, with hooks on
+    functions (e.g. the ones of
+    :class:`~torch.nn.parallel.DistributedDataParallel`) or with anomaly
+    detection enabled still work, but calls then go through the regular
+    engine.
+
+    .. warning::
+        The graph must not change, e.g. by registering hooks on its
+        functions, while the :class:`StaticGraph` is in use.
+
+    Arguments:
+        outputs (sequence of Tensor): outputs of the differentiated function.
+        inputs (sequence of Tensor, optional): Inputs w.r.t. which the gradient
+            will be returned, like :func:`grad`, instead of accumulating it
+            into the ``.grad`` of the leaves, like :func:`backward`. Gradients
+            of inputs that weren't used to compute the outputs are ``None``.
+
+    Example::
+
+        >>> x = torch.randn(3, requires_grad=True)
+        >>> y = x.exp()
+        >>> vjp = torch.autograd.StaticGraph(y, x)
+        >>> jacobian = torch.stack([vjp(v)[0] for v in torch.eye(3)])
+    """
+
+    def __init__(self, outputs, inputs=None):
+        self._outputs = (outputs,) if isinstance(outputs, torch.Tensor) else tuple(outputs)
+        if inputs is not None:
+            inputs = (inputs,) if isinstance(inputs, torch.Tensor) else tuple(inputs)
+        self._inputs = inputs
+        self._graph = torch.autograd._StaticGraph(list(self._outputs), list(inputs or ()))
+
+    def __call__(self, grad_outputs=None, create_graph=False):
+        r"""Computes the gradients for ``grad_outputs``, see :func:`grad`.
+
+        Returns the gradients w.r.t. ``inputs`` if they were given, ``None``
+        otherwise.
+        """
+        if grad_outputs is None:
+            grad_outputs = [None] * len(self._outputs)
+        elif isinstance(grad_outputs, torch.Tensor):
+            grad_outputs = [grad_outputs]
+        grad_outputs = _make_grads(self._outputs, list(grad_outputs))
+        grads = self._graph.run(list(grad_outputs), create_graph)
+        return tuple(grads) if self._inputs is not None else None
+
+
+def set_num_cpu_threads(num_threads):
+    r"""Sets the number of threads that run the CPU parts of backward passes.
+
+    By default a single thread computes the gradients of all CPU functions,
+    one function at a time. With more threads, functions whose inputs are
+    ready at the same time are computed in parallel, e.g. the towers of a wide
+    model. Each function still uses the intra-op thread pool as usual.
+
+    The number of threads can only be increased.
+
+    .. note::
+        With multiple threads, gradients flowing into the same function from
+        more than two other functions may be summed up in a different order
+        from run to run.
+
+    Arguments:
+        num_threads (int): the number of CPU threads of the autograd engine.
+    """
+    Variable._execution_engine.set_num_cpu_threads(num_threads)
+
+
+def set_max_reentrant_threads(num_threads):
+    r"""Limits the number of threads started for nested backward passes.
+
+    A backward pass started from within another one, as done by
+    :func:`torch.utils.checkpoint.checkpoint`, normally runs on the thread of
+    the outer one. Once they are nested too deeply for its stack, the nested
+    pass is handed to another thread, and a new one is started if none is
+    idle. By default there is no limit on the number of these threads. Once
+    ``num_threads`` of them have been started and are all busy, nested
+    backward passes run on the thread that started them instead, which keeps
+    the thread count bounded but needs a larger stack for very deep nesting.
+
+    Arguments:
+        num_threads (int): the maximum number of threads started for nested
+            backward passes.
+    """
+    Variable._execution_engine.set_max_reentrant_threads(num_threads)
+
+
+class offload_saved_tensors(object):
+    r"""Context-manager that moves the tensors saved for backward to host memory.
+
+    Tensors that the forward pass saves for backward, e.g. the inputs of a
+    matrix multiplication, stay in device memory until the backward pass frees
+    them. Within this context, saved CUDA tensors are kept on their device up
+    to a total of ``device_budget`` bytes. Tensors saved beyond that are copied
+    to pinned host memory, and copied back to their device when backward needs
+    them. The copies don't block the host, they run on the current stream.
+
+    This trades device memory for the bandwidth between host and device, when
+    activations rather than weights limit the size of a model. Unlike
+    :func:`torch.utils.checkpoint.checkpoint`, nothing is recomputed.
+
+    Only the tensors saved while the context is active on the current thread
+    are affected. CPU tensors are always saved as is.
+
+    Arguments:
+        device_budget (int): number of bytes of saved tensors to keep on the
+            device. Default: ``0``
+
+    Example::
+
+        >>> with torch.autograd.offload_saved_tensors(device_budget=2 ** 30):
+        ...     loss = model(input).sum()
+        >>> loss.backward()
+    """
+
+    def __init__(self, device_budget=0):
+        self.hooks = torch.autograd._CPUOffloadHooks(device_budget)
+
+    def __enter__(self):
+        self.prev = torch.autograd._get_saved_variable_hooks()
+        torch.autograd._set_saved_variable_hooks(self.hooks)
+        return self
+
+    def __exit__(self, *args):
+        torch.autograd._set_saved_variable_hooks(self.prev)
+        return False
+
+
 # This function applies in case of gradient checkpointing for memory
 # optimization. Currently, for gradient checkpointing, we only support imperative
 # backwards call i.e. torch.autograd.backward() and the torch.autograd.grad() won't
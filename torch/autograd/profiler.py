@@ -24,9 +24,13 @@ class EventList(list):
     """A list of Events (for pretty printing)"""
     def __init__(self, *args, **kwargs):
         use_cuda = kwargs.pop('use_cuda', True)
+        profile_memory = kwargs.pop('profile_memory', False)
+        perf_events = kwargs.pop('perf_events', ())
         super(EventList, self).__init__(*args, **kwargs)
         self._cpu_children_populated = False
         self._use_cuda = use_cuda
+        self._profile_memory = profile_memory
+        self._perf_events = perf_events
 
     def __str__(self):
         return self.table()
@@ -100,13 +104,17 @@ class EventList(list):
             sort_by (str, optional): Attribute used to sort entries. By default
                 they are printed in the same order as they were registered.
                 Valid keys include: ``cpu_time``, ``cuda_time``, ``cpu_time_total``,
-                ``cuda_time_total``, ``count``.
+                ``cuda_time_total``, ``count``, and, when memory was profiled,
+                ``cpu_memory_usage``, ``self_cpu_memory_usage``, ``cpu_memory_peak``
+                and their ``cuda`` counterparts, and when perf events were counted,
+                ``self_`` followed by the event, e.g. ``self_cache_misses``.
 
         Returns:
             A string containing the table.
         """
         return build_table(
-            self, sort_by=sort_by, row_limit=row_limit, header=header, use_cuda=self._use_cuda)
+            self, sort_by=sort_by, row_limit=row_limit, header=header, use_cuda=self._use_cuda,
+            profile_memory=self._profile_memory, perf_events=self._perf_events)
 
     def export_chrome_trace(self, path):
         """Exports an EventList as a Chrome tracing tools file.
@@ -147,7 +155,7 @@ class EventList(list):
                     f.write('{"name": "%s", '
                             '"ph": "f", '
                             '"ts": %s, '
-                            'tid": %s, '
+                            '"tid": %s, '
                             '"pid": "CUDA functions", '
                             '"id": %s, '
                             '"cat": "cpu_to_cuda", '
@@ -189,7 +197,8 @@ class EventList(list):
         for evt in self:
             stats[get_key(evt, group_by_input_shapes)].add(
                 evt, group_by_input_shapes)
-        return EventList(stats.values(), use_cuda=self._use_cuda)
+        return EventList(stats.values(), use_cuda=self._use_cuda, profile_memory=self._profile_memory,
+                         perf_events=self._perf_events)
 
     def total_average(self):
         """Averages all events.
@@ -230,6 +239,43 @@ class profile(object):
             self cpu time might be artificially increased because of the shape
             collection.
 
+        use_cupti (bool, optional): With ``use_cuda``, traces the CUDA kernels, memcpys and
+            memsets with the CUPTI activity API instead of recording CUDA events around
+            every op. This also collects the kernels launched by libraries like cuDNN or
+            NCCL, with exact device timestamps, and attributes each to the innermost
+            function that launched it, so that the CUDA time of a function includes the
+            CUDA time of its children. Requires PyTorch to be built with ``USE_CUPTI=1``.
+            Default: ``False``
+
+        profile_memory (bool, optional): Records the allocations and frees of the CPU
+            allocator and of the CUDA caching allocator, and attributes them to the
+            functions running when they are made. Each function then reports the net
+            memory it allocated (``cpu_memory_usage``, ``cuda_memory_usage``), the part
+            of it not allocated by its children (``self_cpu_memory_usage``,
+            ``self_cuda_memory_usage``), and the most memory it held at any point
+            (``cpu_memory_peak``, ``cuda_memory_peak``), which
+            ``prof.key_averages()`` sums, or for peaks takes the maximum of, per function.
+            Only the memory allocated while the profiler is enabled is accounted for.
+            Default: ``False``
+
+        trace_path (str, optional): Streams the events to this file in a compact binary
+            format as they are recorded, instead of keeping them all in memory until the
+            profiler is disabled, so that long runs can be profiled. The events are then not
+            available to the profile object; :func:`convert_trace` turns the file into a
+            Chrome trace. Only supported without ``use_cuda``.
+            Default: ``None``
+
+        perf_events (list of str, optional): Counts these hardware events with the Linux
+            ``perf_event_open`` API while every function runs, on the thread running it,
+            e.g. ``["cycles", "instructions", "cache_misses"]``. Each function then reports
+            the counts of its range in ``perf_counters`` and the part of them not counted
+            by its children in ``self_perf_counters``, which ``prof.key_averages()`` sums
+            per function and the table shows, along with the instructions per cycle when
+            both are counted. ``torch.autograd._perf_event_names()`` lists the events.
+            Counting them may need a low ``kernel.perf_event_paranoid`` setting, and the
+            counts of small functions include some of the overhead of the profiler.
+            Default: ``None``
+
     .. warning:
         This context managers should not be called recursively, i.e. at most one
         instance should be enabled at any given time.
@@ -259,14 +305,19 @@ class profile(object):
         -----------------------------------  ---------------  ---------------  ---------------
 
     """
-    def __init__(self, enabled=True, use_cuda=False, record_shapes=False):
+    def __init__(self, enabled=True, use_cuda=False, record_shapes=False, profile_memory=False,
+                 use_cupti=False, trace_path=None, perf_events=None):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.use_cupti = use_cuda and use_cupti
         self.function_events = None
         if not self.enabled:
             return
         self.entered = False
         self.record_shapes = record_shapes
+        self.profile_memory = profile_memory
+        self.trace_path = trace_path
+        self.perf_events = list(perf_events or [])
 
     def __enter__(self):
         if not self.enabled:
@@ -274,17 +325,31 @@ class profile(object):
         if self.entered:
             raise RuntimeError("autograd profiler traces are not reentrant")
         self.entered = True
-        profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
-            else torch.autograd.ProfilerState.CPU
+        if self.use_cupti:
+            profiler_kind = torch.autograd.ProfilerState.CUPTI
+        elif self.use_cuda:
+            profiler_kind = torch.autograd.ProfilerState.CUDA
+        else:
+            profiler_kind = torch.autograd.ProfilerState.CPU
         torch.autograd._enable_profiler(
-            torch.autograd.ProfilerConfig(profiler_kind, self.record_shapes))
+            torch.autograd.ProfilerConfig(
+                profiler_kind, self.record_shapes, self.profile_memory, self.trace_path or "",
+                self.perf_events))
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
         records = torch.autograd._disable_profiler()
-        self.function_events = EventList(parse_cpu_trace(records), use_cuda=self.use_cuda)
+        if self.trace_path is not None:
+            # The events were written to the trace file
+            self.function_events = EventList(use_cuda=self.use_cuda)
+            return False
+        cuda_activities = torch.autograd._get_cuda_activities() if self.use_cupti else None
+        self.function_events = EventList(
+            parse_cpu_trace(records, cuda_activities, self.perf_events),
+            use_cuda=self.use_cuda, profile_memory=self.profile_memory,
+            perf_events=self.perf_events)
         return False
 
     def __repr__(self):
@@ -484,6 +549,57 @@ class emit_nvtx(object):
         return False
 
 
+def convert_trace(path, chrome_trace_path):
+    """Converts a trace streamed by :class:`profile` with ``trace_path`` into a
+    Chrome trace, reading it event by event.
+
+    Arguments:
+        path (str): path to the streamed trace
+        chrome_trace_path (str): path where the Chrome trace will be written
+    """
+    import struct
+    header = struct.Struct('=8sq')
+    event_header = struct.Struct('=BHqI')
+    memory_usage = struct.Struct('=qq')
+    string_table = StringTable()
+    # The ranges open on each thread
+    stacks = defaultdict(list)
+    with open(path, 'rb') as f, open(chrome_trace_path, 'w') as out:
+        magic, start_ns = header.unpack(f.read(header.size))
+        if magic != b'PTTRACE1':
+            raise RuntimeError("{} is not a profiler trace".format(path))
+        out.write("[")
+        first = True
+        while True:
+            data = f.read(event_header.size)
+            if len(data) < event_header.size:
+                break
+            kind, thread, time_ns, name_size = event_header.unpack(data)
+            name = f.read(name_size).decode('utf-8')
+            if kind == 0:  # mark
+                continue
+            elif kind == 1:  # push
+                stacks[thread].append((name, time_ns))
+            elif kind == 2:  # pop
+                start_name, range_start_ns = stacks[thread].pop()
+                if not first:
+                    out.write(", ")
+                first = False
+                out.write('{"name": "%s", '
+                          '"ph": "X", '
+                          '"ts": %s, '
+                          '"dur": %s, '
+                          '"tid": %s, '
+                          '"pid": "CPU functions", '
+                          '"args": {}}' % (string_table[start_name],
+                                           (range_start_ns - start_ns) / 1000.0,
+                                           (time_ns - range_start_ns) / 1000.0,
+                                           thread))
+            elif kind == 3:  # memory_alloc
+                f.read(memory_usage.size)
+        out.write("]")
+
+
 def load_nvprof(path):
     """Opens an nvprof trace file and parses autograd annotations.
 
@@ -507,6 +623,29 @@ def format_time(time_us):
     return '{:.3f}us'.format(time_us)
 
 
+def format_memory(nbytes):
+    """Returns a formatted memory size string"""
+    KB = 1024
+    MB = 1024 * KB
+    GB = 1024 * MB
+    if abs(nbytes) >= GB:
+        return '{:.2f} Gb'.format(nbytes * 1.0 / GB)
+    elif abs(nbytes) >= MB:
+        return '{:.2f} Mb'.format(nbytes * 1.0 / MB)
+    elif abs(nbytes) >= KB:
+        return '{:.2f} Kb'.format(nbytes * 1.0 / KB)
+    else:
+        return str(nbytes) + ' b'
+
+
+def format_count(count):
+    """Returns a formatted count of perf events"""
+    for divisor, suffix in ((1e9, 'G'), (1e6, 'M'), (1e3, 'K')):
+        if abs(count) >= divisor:
+            return '{:.3f}{}'.format(count / divisor, suffix)
+    return str(count)
+
+
 def format_time_share(time_us, total_time_us):
     """Defines how to format time in FunctionEvent"""
     if total_time_us == 0:
@@ -554,7 +693,10 @@ Kernel = namedtuple('Kernel', ['name', 'device', 'interval'])
 # TODO: record TID too
 class FunctionEvent(FormattedTimesMixin):
     """Profiling information about a single function."""
-    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None):
+    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None,
+                 cpu_memory_usage=0, cuda_memory_usage=0,
+                 cpu_memory_peak=0, cuda_memory_peak=0, kernels_exclusive=False,
+                 perf_counters=None):
         self.id = id
         self.name = name
         self.cpu_interval = Interval(cpu_start, cpu_end)
@@ -563,6 +705,15 @@ class FunctionEvent(FormattedTimesMixin):
         self.count = 1
         self.cpu_children = []
         self.input_shapes = input_shapes
+        self.cpu_memory_usage = cpu_memory_usage
+        self.cuda_memory_usage = cuda_memory_usage
+        self.cpu_memory_peak = cpu_memory_peak
+        self.cuda_memory_peak = cuda_memory_peak
+        # Whether kernels only holds the kernels launched by this function
+        # itself, and not the ones of its children, as traced by CUPTI
+        self.kernels_exclusive = kernels_exclusive
+        # The counts of the perf events during the function, by event name
+        self.perf_counters = perf_counters or {}
 
     def append_kernel(self, name, device, start, end):
         self.kernels.append(Kernel(name, device, Interval(start, end)))
@@ -582,9 +733,31 @@ class FunctionEvent(FormattedTimesMixin):
             [child.cpu_time_total for child in self.cpu_children]
         )
 
+    @property
+    def self_cpu_memory_usage(self):
+        return self.cpu_memory_usage - sum(
+            [child.cpu_memory_usage for child in self.cpu_children]
+        )
+
+    @property
+    def self_cuda_memory_usage(self):
+        return self.cuda_memory_usage - sum(
+            [child.cuda_memory_usage for child in self.cpu_children]
+        )
+
+    @property
+    def self_perf_counters(self):
+        return {
+            name: count - sum(child.perf_counters.get(name, 0) for child in self.cpu_children)
+            for name, count in self.perf_counters.items()
+        }
+
     @property
     def cuda_time_total(self):
-        return sum(kinfo.interval.elapsed_us() for kinfo in self.kernels)
+        total = sum(kinfo.interval.elapsed_us() for kinfo in self.kernels)
+        if self.kernels_exclusive:
+            total += sum(child.cuda_time_total for child in self.cpu_children)
+        return total
 
     @property
     def cpu_time_total(self):
@@ -620,6 +793,14 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cuda_time_total = 0
         self.self_cpu_time_total = 0
         self.input_shapes = None
+        self.cpu_memory_usage = 0
+        self.cuda_memory_usage = 0
+        self.self_cpu_memory_usage = 0
+        self.self_cuda_memory_usage = 0
+        self.cpu_memory_peak = 0
+        self.cuda_memory_peak = 0
+        self.perf_counters = defaultdict(int)
+        self.self_perf_counters = defaultdict(int)
 
     def add(self, other, group_by_input_shapes=False):
         if self.key is None:
@@ -636,6 +817,17 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cpu_time_total += other.cpu_time_total
         self.cuda_time_total += other.cuda_time_total
         self.self_cpu_time_total += other.self_cpu_time_total
+        self.cpu_memory_usage += other.cpu_memory_usage
+        self.cuda_memory_usage += other.cuda_memory_usage
+        self.self_cpu_memory_usage += other.self_cpu_memory_usage
+        self.self_cuda_memory_usage += other.self_cuda_memory_usage
+        self.cpu_memory_peak = max(self.cpu_memory_peak, other.cpu_memory_peak)
+        self.cuda_memory_peak = max(self.cuda_memory_peak, other.cuda_memory_peak)
+        # Snapshot the counters first, as other may be self
+        for name, count in list(other.perf_counters.items()):
+            self.perf_counters[name] += count
+        for name, count in list(other.self_perf_counters.items()):
+            self.self_perf_counters[name] += count
         self.count += other.count
         return self
 
@@ -667,13 +859,17 @@ class StringTable(defaultdict):
 ################################################################################
 # CPU checkpoints
 
-def parse_cpu_trace(thread_records):
+def parse_cpu_trace(thread_records, cuda_activities=None, perf_events=()):
     next_id = 0
     start_record = None
     cuda_records = {}
     functions = []
     record_stack = []
     string_table = StringTable()
+    # The net memory allocated since each open range was pushed, and its peak,
+    # as [cpu net, cpu peak, cuda net, cuda peak]
+    memory_usage = {}
+    functions_by_correlation_id = {}
 
     # cuda start events and the overall profiler start event don't happen
     # at exactly the same time because we need to record an event on each device
@@ -697,18 +893,45 @@ def parse_cpu_trace(thread_records):
     for record in itertools.chain(*thread_records):
         if record.kind() == 'mark':
             continue
+        elif record.kind() == 'memory_alloc':
+            # An allocation is attributed to every function running on the
+            # thread that made it, so that parents include their children
+            for function_id, _ in record_stack:
+                usage = memory_usage[function_id]
+                usage[0] += record.cpu_memory_usage()
+                usage[1] = max(usage[1], usage[0])
+                usage[2] += record.cuda_memory_usage()
+                usage[3] = max(usage[3], usage[2])
         elif record.kind() == 'push':
             record_stack.append((next_id, record))
+            memory_usage[next_id] = [0, 0, 0, 0]
             next_id += 1
         elif record.kind() == 'pop':
             function_id, start = record_stack.pop()
+            cpu_usage, cpu_peak, cuda_usage, cuda_peak = memory_usage.pop(function_id)
+            perf_counters = None
+            start_counts = start.perf_counters() if perf_events else []
+            end_counts = record.perf_counters() if perf_events else []
+            # The counters are missing when a range ended on another thread,
+            # or the thread could not open them
+            if len(start_counts) == len(perf_events) and len(end_counts) == len(perf_events):
+                perf_counters = {
+                    name: end - begin
+                    for name, begin, end in zip(perf_events, start_counts, end_counts)
+                }
             fe = FunctionEvent(
                 id=function_id,
                 name=string_table[start.name()],
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
                 cpu_end=start_record.cpu_elapsed_us(record),
-                input_shapes=start.shapes())
+                input_shapes=start.shapes(),
+                cpu_memory_usage=cpu_usage,
+                cuda_memory_usage=cuda_usage,
+                cpu_memory_peak=cpu_peak,
+                cuda_memory_peak=cuda_peak,
+                kernels_exclusive=cuda_activities is not None,
+                perf_counters=perf_counters)
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
@@ -716,8 +939,20 @@ def parse_cpu_trace(thread_records):
                                  start.device(),
                                  cuda_start,
                                  cuda_end)
+            if start.correlation_id() != 0:
+                functions_by_correlation_id[start.correlation_id()] = fe
             functions.append(fe)
 
+    # CUPTI timestamps are on the clock of CPU events
+    for activity in cuda_activities or []:
+        fe = functions_by_correlation_id.get(activity.correlation_id)
+        if fe is None:
+            continue
+        fe.append_kernel(activity.name,
+                         activity.device,
+                         (activity.start_ns - start_record.cpu_ns()) / 1000.0,
+                         (activity.end_ns - start_record.cpu_ns()) / 1000.0)
+
     functions.sort(key=lambda evt: evt.cpu_interval.start)
     return functions
 
@@ -802,15 +1037,21 @@ def parse_nvprof_trace(path):
 # Pretty printer
 
 
-def build_table(events, sort_by=None, header=None, row_limit=100, use_cuda=True):
+def build_table(events, sort_by=None, header=None, row_limit=100, use_cuda=True, profile_memory=False,
+                perf_events=()):
     """Prints a summary of events (which can be a list of FunctionEvent or FunctionEventAvg)."""
     if len(events) == 0:
         return ""
 
+    def sort_key(evt):
+        if sort_by.startswith('self_') and sort_by[len('self_'):] in perf_events:
+            return evt.self_perf_counters.get(sort_by[len('self_'):], 0)
+        return getattr(evt, sort_by)
+
     if sort_by is not None:
         events = EventList(sorted(
-            events, key=lambda evt: getattr(evt, sort_by), reverse=True
-        ), use_cuda=use_cuda)
+            events, key=sort_key, reverse=True
+        ), use_cuda=use_cuda, profile_memory=profile_memory, perf_events=perf_events)
 
     has_input_shapes = any(
         [event.input_shapes is not None for event in events])
@@ -832,9 +1073,28 @@ def build_table(events, sort_by=None, header=None, row_limit=100, use_cuda=True)
             'CUDA total',
             'CUDA time avg',
         ])
+    if profile_memory:
+        headers.extend([
+            'CPU Mem',
+            'Self CPU Mem',
+            'CPU Mem peak',
+        ])
+        if use_cuda:
+            headers.extend([
+                'CUDA Mem',
+                'Self CUDA Mem',
+                'CUDA Mem peak',
+            ])
+    perf_headers = ['Self ' + name for name in perf_events]
+    has_ipc = 'cycles' in perf_events and 'instructions' in perf_events
+    if has_ipc:
+        perf_headers.append('Self IPC')
+    headers.extend(perf_headers)
     headers.append(
         'Number of Calls'
     )
+    # Event names can be longer than the default width
+    column_widths = {h: max(DEFAULT_COLUMN_WIDTH, len(h)) for h in perf_headers}
 
     # Have to use a list because nonlocal is Py3 only...
     SPACING_SIZE = 2
@@ -848,8 +1108,8 @@ def build_table(events, sort_by=None, header=None, row_limit=100, use_cuda=True)
         line_length[0] += padding + SPACING_SIZE
 
     add_column(name_column_width)
-    for _ in headers[1:]:
-        add_column(DEFAULT_COLUMN_WIDTH)
+    for h in headers[1:]:
+        add_column(column_widths.get(h, DEFAULT_COLUMN_WIDTH))
 
     if has_input_shapes:
         headers.append('Input Shapes')
@@ -896,6 +1156,25 @@ def build_table(events, sort_by=None, header=None, row_limit=100, use_cuda=True)
                 evt.cuda_time_total_str,
                 evt.cuda_time_str,  # Cuda time avg
             ])
+        if profile_memory:
+            row_values.extend([
+                format_memory(evt.cpu_memory_usage),
+                format_memory(evt.self_cpu_memory_usage),
+                format_memory(evt.cpu_memory_peak),
+            ])
+            if use_cuda:
+                row_values.extend([
+                    format_memory(evt.cuda_memory_usage),
+                    format_memory(evt.self_cuda_memory_usage),
+                    format_memory(evt.cuda_memory_peak),
+                ])
+        if perf_events:
+            self_counts = evt.self_perf_counters
+            row_values.extend([format_count(self_counts.get(name, 0)) for name in perf_events])
+            if has_ipc:
+                cycles = self_counts.get('cycles', 0)
+                row_values.append(
+                    '{:.2f}'.format(self_counts.get('instructions', 0) * 1.0 / cycles) if cycles > 0 else 'NaN')
         row_values.append(
             evt.count,  # Number of calls
         )
@@ -115,6 +115,28 @@ def is_acceptable(tensor):
     return True
 
 
+def save_benchmark_cache(path):
+    r"""Writes the convolution algorithms picked so far by ``benchmark`` mode
+    to :attr:`path`, so that other processes can skip benchmarking them with
+    :func:`load_benchmark_cache`.
+
+    The file records the cuDNN version and the model of the current GPU, and
+    is only picked up by processes that match both.
+    """
+    torch._cudnn_save_benchmark_cache(path)
+
+
+def load_benchmark_cache(path):
+    r"""Adds the convolution algorithms saved by :func:`save_benchmark_cache`
+    to the benchmark cache of this process and returns how many were added.
+
+    With ``benchmark`` enabled, only convolutions missing from the cache are
+    benchmarked. A file written with another cuDNN version or on another GPU
+    model is ignored with a warning.
+    """
+    return torch._cudnn_load_benchmark_cache(path)
+
+
 _handles = {}
 
 verbose = False
@@ -429,6 +451,8 @@ class CudnnModule(PropModule):
     enabled = ContextProp(torch._C._get_cudnn_enabled, torch._C._set_cudnn_enabled)
     deterministic = ContextProp(torch._C._get_cudnn_deterministic, torch._C._set_cudnn_deterministic)
     benchmark = ContextProp(torch._C._get_cudnn_benchmark, torch._C._set_cudnn_benchmark)
+    benchmark_workspace_limit = ContextProp(torch._C._get_cudnn_benchmark_workspace_limit,
+                                            torch._C._set_cudnn_benchmark_workspace_limit)
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
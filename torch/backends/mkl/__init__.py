@@ -4,3 +4,35 @@ import torch
 def is_available():
     r"""Returns whether PyTorch is built with MKL support."""
     return torch._C.has_mkl
+
+
+class MKLFFTPlanCache(object):
+    r"""
+    Represents the plan cache of MKL FFT descriptors, which is shared by all
+    threads. The attributes `size` and `max_size`, and method `clear`, can
+    fetch and/ or change properties of the C++ MKL FFT plan cache.
+    """
+
+    @property
+    def size(self):
+        return torch._mkl_fft_get_plan_cache_size()
+
+    @size.setter
+    def size(self, val):
+        raise RuntimeError(
+            '.size is a read-only property showing the number of plans currently in the '
+            'cache. To change the cache capacity, set fft_plan_cache.max_size.')
+
+    @property
+    def max_size(self):
+        return torch._mkl_fft_get_plan_cache_max_size()
+
+    @max_size.setter
+    def max_size(self, val):
+        torch._mkl_fft_set_plan_cache_max_size(val)
+
+    def clear(self):
+        return torch._mkl_fft_clear_plan_cache()
+
+
+fft_plan_cache = MKLFFTPlanCache()
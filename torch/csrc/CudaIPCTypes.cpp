@@ -28,6 +28,14 @@ void warnProducerTerminatedBeforeSharedTensorsReleased() {
 struct CudaIPCGlobalEntities {
   std::mutex ref_counters_mutex_;
   std::atomic<int64_t> sync_events_used_;
+  // Interprocess events of the sent blocks that have been released, by device.
+  // They are recorded again for the next blocks instead of being destroyed, so
+  // that consumers see the same event handles and can keep them open.
+  std::mutex free_events_mutex_;
+  std::map<c10::DeviceIndex, std::vector<cudaEvent_t>> free_events_;
+  // Events opened by this process as a consumer, by device and handle.
+  std::mutex opened_events_mutex_;
+  std::map<std::pair<c10::DeviceIndex, std::string>, cudaEvent_t> opened_events_;
   std::map<std::string, std::shared_ptr<CudaIPCRefCountersFile>>
       ref_counters_files_;
   std::shared_ptr<CudaIPCRefCountersFile> next_available_ref_counters_file_;
@@ -134,7 +142,19 @@ CudaIPCSentData::CudaIPCSentData(
   //  [i.record() for i in a]
   //  ```
   //
-  if (cuda_ipc_global_entities.sync_events_used_.load() < CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
+  bool have_event = false;
+  {
+    std::lock_guard<std::mutex> lock(
+        cuda_ipc_global_entities.free_events_mutex_);
+    auto& free_events = cuda_ipc_global_entities.free_events_[device.index()];
+    if (!free_events.empty()) {
+      event_ = free_events.back();
+      free_events.pop_back();
+      have_event = true;
+    }
+  }
+  if (!have_event &&
+      cuda_ipc_global_entities.sync_events_used_.load() < CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
     // TODO: More efficient would be to create event inside of main thread (at
     // the moment of the queue.put). The reason this is more efficient is
     // because the main thread may have queued extra work on the stream, which
@@ -144,6 +164,9 @@ CudaIPCSentData::CudaIPCSentData(
         &event_,
         cudaEventDisableTiming | cudaEventInterprocess |
             cudaEventBlockingSync));
+    have_event = true;
+  }
+  if (have_event) {
     C10_CUDA_CHECK(cudaEventRecord(
         event_, c10::cuda::getCurrentCUDAStream(device.index())));
     event_sync_required_ = true;
@@ -166,9 +189,11 @@ CudaIPCSentData::~CudaIPCSentData() {
 #ifndef __HIP_PLATFORM_HCC__
   try {
     if (event_sync_required_) {
-      at::cuda::CUDAGuard device_guard(device_.index());
-      cudaEventDestroy(event_);
-      cuda_ipc_global_entities.sync_events_used_ --;
+      // The counter is 0, so the consumers are done waiting on the event and
+      // it can be recorded for another block.
+      std::lock_guard<std::mutex> lock(
+          cuda_ipc_global_entities.free_events_mutex_);
+      cuda_ipc_global_entities.free_events_[device_.index()].push_back(event_);
     }
   } catch (...) { /* No throw */
   }
@@ -221,6 +246,34 @@ at::DataPtr GetNewRefCountedSentData(void* data, at::Device device) {
   return at::DataPtr(data, sent_data, CudaIPCSentDataDelete, device);
 }
 
+cudaEvent_t CudaIPCOpenEventHandle(const std::string& handle, c10::DeviceIndex device) {
+  std::lock_guard<std::mutex> lock(
+      cuda_ipc_global_entities.opened_events_mutex_);
+  auto& opened_events = cuda_ipc_global_entities.opened_events_;
+  auto key = std::make_pair(device, handle);
+  auto it = opened_events.find(key);
+  if (it != opened_events.end()) {
+    return it->second;
+  }
+  // Producers reuse at most CUDA_IPC_MAXIMUM_EVENTS_TO_USE events each, so
+  // this only fills up with several producers or with producers that exited.
+  // Destroying events that streams still wait on is fine, their resources are
+  // released once the waits complete.
+  if (opened_events.size() >= CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
+    at::cuda::CUDAGuard device_guard(device);
+    for (auto& e : opened_events) {
+      device_guard.set_index(e.first.first);
+      cudaEventDestroy(e.second);
+    }
+    opened_events.clear();
+  }
+  cudaEvent_t event;
+  C10_CUDA_CHECK(cudaIpcOpenEventHandle(
+      &event, *reinterpret_cast<const cudaIpcEventHandle_t*>(handle.c_str())));
+  opened_events.emplace(std::move(key), event);
+  return event;
+}
+
 bool CudaIPCCollect() {
   bool freed_memory = cuda_ipc_global_entities.CudaIPCSentDataLimbo_.collect();
   if (cuda_ipc_global_entities.CudaIPCSentDataLimbo_.size() == 0) {
@@ -13,6 +13,11 @@ namespace torch {
 
 bool CudaIPCCollect();
 
+// Opens the interprocess event of a received block on the current device, which
+// must be device. The events are cached and owned by the cache, as producers
+// record the same events again for later blocks.
+cudaEvent_t CudaIPCOpenEventHandle(const std::string& handle, c10::DeviceIndex device);
+
 struct CudaIPCReceivedData final {
   explicit CudaIPCReceivedData(std::shared_ptr<void> shared_ptr)
       : shared_ptr_(std::move(shared_ptr)) {}
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <libshm.h>
 #include <TH/TH.h>
+#include <c10/util/InitStats.h>
 #include <c10/util/Logging.h>
 #include <ATen/ATen.h>
 #include <ATen/ExpandUtils.h>
@@ -460,6 +461,21 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused, PyObject *noargs)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setBenchmarkWorkspaceLimitCuDNN(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "set_cudnn_benchmark_workspace_limit expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setBenchmarkWorkspaceLimitCuDNN(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject *THPModule_benchmarkWorkspaceLimitCuDNN(PyObject *_unused, PyObject *noargs)
+{
+  return THPUtils_packInt64(at::globalContext().benchmarkWorkspaceLimitCuDNN());
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -544,6 +560,8 @@ static PyMethodDef TorchMethods[] = {
   {"_set_mkldnn_enabled", (PyCFunction)THPModule_setUserEnabledMkldnn, METH_O,  nullptr},
   {"_get_cudnn_benchmark", (PyCFunction)THPModule_benchmarkCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  nullptr},
+  {"_get_cudnn_benchmark_workspace_limit", (PyCFunction)THPModule_benchmarkWorkspaceLimitCuDNN, METH_NOARGS,     nullptr},
+  {"_set_cudnn_benchmark_workspace_limit", (PyCFunction)THPModule_setBenchmarkWorkspaceLimitCuDNN, METH_O,  nullptr},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  nullptr},
   {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       nullptr},
@@ -745,6 +763,15 @@ PyObject* initModule() {
   auto py_module = py::reinterpret_borrow<py::module>(module);
   py_module.def("_demangle", &c10::demangle);
   py_module.def("_log_api_usage_once", &LogAPIUsageOnceFromPython);
+  // The (registry, count, total us) initialization times, collected when
+  // PYTORCH_INIT_STATS is set
+  py_module.def("_get_init_stats", []() {
+    std::vector<std::tuple<std::string, size_t, double>> stats;
+    for (const c10::InitStat& stat : c10::GetInitStats()) {
+      stats.emplace_back(stat.name, stat.count, stat.total.count() / 1000.0);
+    }
+    return stats;
+  });
 
   ASSERT_TRUE(set_module_attr("has_openmp", at::hasOpenMP() ? Py_True : Py_False));
   ASSERT_TRUE(set_module_attr("has_mkl", at::hasMKL() ? Py_True : Py_False));
@@ -0,0 +1,280 @@
+#include <torch/csrc/SharedMemoryPool.h>
+
+#include <c10/util/Exception.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace torch {
+
+namespace {
+
+// See Note [Pooled shared memory]
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kMinSegmentSize = 4096;
+constexpr size_t kMaxSegmentSize = 64 << 20;
+constexpr size_t kMaxPooledBytes = 1 << 30;
+constexpr uint64_t kMagic = 0x6c6f6f7068637274; // "trchpool"
+
+struct Header {
+  std::atomic<int64_t> refcount;
+  uint64_t magic;
+};
+static_assert(sizeof(Header) <= kHeaderSize, "Header doesn't fit");
+
+int currentPid() {
+#ifdef _WIN32
+  return 0;
+#else
+  return getpid();
+#endif
+}
+
+} // namespace
+
+struct PooledSharedMemory::Segment {
+  Segment(int fd, void* base, size_t size) : fd(fd), base(base), size(size) {}
+
+  ~Segment() {
+#ifndef _WIN32
+    munmap(base, size);
+    ::close(fd);
+#endif
+  }
+
+  Header* header() const {
+    return static_cast<Header*>(base);
+  }
+
+  int fd;
+  void* base;
+  size_t size;
+};
+
+namespace {
+
+using Segment = PooledSharedMemory::Segment;
+
+struct Pool {
+  explicit Pool(int pid) : pid(pid) {}
+
+  const int pid;
+  std::mutex mutex;
+  // The segments of every size class, kMinSegmentSize << i for class i.
+  std::vector<std::vector<std::shared_ptr<Segment>>> classes;
+  size_t bytes = 0;
+};
+
+// The pool of this process. A forked child starts with a new one, and leaks
+// the pool of its parent, whose mutex may even be locked.
+Pool& getPool() {
+  static std::atomic<Pool*> current{nullptr};
+  const int pid = currentPid();
+  Pool* pool = current.load();
+  while (!pool || pool->pid != pid) {
+    auto* new_pool = new Pool(pid);
+    if (current.compare_exchange_strong(pool, new_pool)) {
+      pool = new_pool;
+    } else {
+      delete new_pool;
+    }
+  }
+  return *pool;
+}
+
+void deletePooledSharedMemory(void* ptr) {
+  delete static_cast<PooledSharedMemory*>(ptr);
+}
+
+at::DataPtr makeDataPtr(std::shared_ptr<Segment> segment) {
+  auto* context = new PooledSharedMemory(std::move(segment));
+  return {context->data(),
+          context,
+          &deletePooledSharedMemory,
+          at::DeviceType::CPU};
+}
+
+#ifndef _WIN32
+std::shared_ptr<Segment> createSegment(size_t size) {
+  static std::atomic<uint64_t> counter{0};
+  const std::string name = "/torch_pool_" + std::to_string(getpid()) + "_" +
+      std::to_string(counter++);
+  const int fd =
+      shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  TORCH_CHECK(
+      fd != -1,
+      "unable to open shared memory object <",
+      name,
+      "> in read-write mode: ",
+      strerror(errno));
+  // Only the file descriptor is shared, there is nothing to clean up later.
+  shm_unlink(name.c_str());
+  if (ftruncate(fd, size) == -1) {
+    const int error = errno;
+    ::close(fd);
+    AT_ERROR(
+        "unable to resize shared memory object <",
+        name,
+        "> to ",
+        size,
+        " bytes: ",
+        strerror(error));
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    ::close(fd);
+    AT_ERROR(
+        "unable to mmap ", size, " bytes of shared memory: ", strerror(error));
+  }
+  auto segment = std::make_shared<Segment>(fd, base, size);
+  new (base) Header();
+  segment->header()->refcount.store(0);
+  segment->header()->magic = kMagic;
+  return segment;
+}
+#endif
+
+} // namespace
+
+at::DataPtr PooledSharedMemory::allocate(size_t nbytes) {
+#ifdef _WIN32
+  return {};
+#else
+  if (nbytes == 0 || nbytes > kMaxSegmentSize - kHeaderSize) {
+    return {};
+  }
+  size_t size = kMinSegmentSize;
+  size_t size_class = 0;
+  while (size < nbytes + kHeaderSize) {
+    size *= 2;
+    size_class++;
+  }
+
+  auto& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  if (pool.classes.size() <= size_class) {
+    pool.classes.resize(size_class + 1);
+  }
+  // Only the owner takes the first reference to a free segment, other
+  // processes only take references while they hold one.
+  for (const auto& segment : pool.classes[size_class]) {
+    int64_t expected = 0;
+    if (segment->header()->refcount.compare_exchange_strong(expected, 1)) {
+      return makeDataPtr(segment);
+    }
+  }
+
+  // Make room by releasing free segments of other size classes.
+  for (auto& segments : pool.classes) {
+    for (auto it = segments.begin();
+         it != segments.end() && pool.bytes + size > kMaxPooledBytes;) {
+      if ((*it)->header()->refcount.load() == 0) {
+        pool.bytes -= (*it)->size;
+        it = segments.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (pool.bytes + size > kMaxPooledBytes) {
+    return {};
+  }
+
+  auto segment = createSegment(size);
+  segment->header()->refcount.store(1);
+  pool.classes[size_class].push_back(segment);
+  pool.bytes += size;
+  return makeDataPtr(std::move(segment));
+#endif
+}
+
+at::DataPtr PooledSharedMemory::fromFd(int fd, size_t nbytes) {
+#ifdef _WIN32
+  AT_ERROR("Pooled shared memory is not supported on Windows");
+#else
+  struct stat file_stat;
+  TORCH_CHECK(
+      fstat(fd, &file_stat) != -1,
+      "unable to stat shared memory: ",
+      strerror(errno));
+  const size_t size = file_stat.st_size;
+  TORCH_CHECK(
+      size >= nbytes + kHeaderSize,
+      "Expected a pooled shared memory segment of at least ",
+      nbytes + kHeaderSize,
+      " bytes, got ",
+      size);
+  const int new_fd = dup(fd);
+  TORCH_CHECK(
+      new_fd != -1,
+      "could not duplicate a shared memory file descriptor: ",
+      strerror(errno));
+  void* base =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, new_fd, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    ::close(new_fd);
+    AT_ERROR(
+        "unable to mmap ", size, " bytes of shared memory: ", strerror(error));
+  }
+  auto segment = std::make_shared<Segment>(new_fd, base, size);
+  TORCH_CHECK(
+      segment->header()->magic == kMagic,
+      "Expected a pooled shared memory segment");
+  // The sender holds a reference for us until we took our own.
+  segment->header()->refcount++;
+  return makeDataPtr(std::move(segment));
+#endif
+}
+
+PooledSharedMemory* PooledSharedMemory::fromDataPtr(
+    const at::DataPtr& data_ptr) {
+  return data_ptr.cast_context<PooledSharedMemory>(&deletePooledSharedMemory);
+}
+
+PooledSharedMemory::PooledSharedMemory(std::shared_ptr<Segment> segment)
+    : segment_(std::move(segment)), pid_(currentPid()) {}
+
+PooledSharedMemory::~PooledSharedMemory() {
+  if (pid_ == currentPid()) {
+    decref();
+  }
+}
+
+int PooledSharedMemory::fd() const {
+  return segment_->fd;
+}
+
+void* PooledSharedMemory::data() const {
+  return static_cast<char*>(segment_->base) + kHeaderSize;
+}
+
+void PooledSharedMemory::incref() {
+  segment_->header()->refcount++;
+}
+
+void PooledSharedMemory::decref() {
+  segment_->header()->refcount--;
+}
+
+size_t PooledSharedMemory::pooledBytes() {
+  auto& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  return pool.bytes;
+}
+
+} // namespace torch
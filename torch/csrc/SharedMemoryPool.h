@@ -0,0 +1,75 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace torch {
+
+// Note [Pooled shared memory]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With the file_descriptor sharing strategy, every storage moved to shared
+// memory gets its own segment: shm_open, ftruncate, mmap and unlink when it
+// is created, munmap when it is freed. DataLoader workers do this for every
+// tensor of every batch, and with small batches the syscalls dominate.
+//
+// Instead, every process keeps a pool of segments, in power-of-two size
+// classes. The first 64 bytes of a segment hold a reference count of the
+// storages using it, across all processes:
+//
+//   - The storage a segment is allocated for holds a reference.
+//   - A process sending the storage takes another reference for the receiver
+//     (_shared_incref in reduce_storage), which the receiver gives up again
+//     once it mapped the segment and took its own (_shared_decref in
+//     rebuild_storage_fd), like with the file_system strategy.
+//   - Freeing a storage gives up its reference.
+//
+// The segment is free again once the count drops to zero, which the owning
+// process checks when it looks for a segment to allocate. The segment stays
+// mapped in the owner and its file descriptor stays open, so reusing it
+// takes no syscalls at all.
+//
+// A forked child doesn't own the segments of its parent: it starts with an
+// empty pool, and storages it inherited don't touch the reference counts.
+//
+// Storages larger than the largest size class, and storages that would grow
+// the pool beyond its limit while nothing is free, aren't pooled: allocate()
+// returns an empty DataPtr and they get a segment of their own as before.
+
+class PooledSharedMemory {
+ public:
+  struct Segment;
+
+  // Returns a DataPtr of at least `nbytes` from the pool of this process, or
+  // an empty DataPtr if the storage isn't pooled.
+  static at::DataPtr allocate(size_t nbytes);
+
+  // Maps a pooled segment of at least `nbytes` that was sent by another
+  // process, and takes a reference to it. The file descriptor is duplicated.
+  static at::DataPtr fromFd(int fd, size_t nbytes);
+
+  static PooledSharedMemory* fromDataPtr(const at::DataPtr& data_ptr);
+
+  // Takes over a reference to `segment` that the caller took.
+  explicit PooledSharedMemory(std::shared_ptr<Segment> segment);
+  ~PooledSharedMemory();
+
+  int fd() const;
+  void* data() const;
+
+  // A reference for a process the storage is sent to.
+  void incref();
+  void decref();
+
+  // The total size of the segments pooled by this process, for tests.
+  static size_t pooledBytes();
+
+ private:
+  std::shared_ptr<Segment> segment_;
+  // The process that holds the reference of this context. Contexts
+  // inherited through fork don't hold one.
+  int pid_;
+};
+
+} // namespace torch
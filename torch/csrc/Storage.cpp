@@ -17,6 +17,7 @@
 #include <torch/csrc/copy_utils.h>
 #include <torch/csrc/DynamicTypes.h>
 #include <torch/csrc/CudaIPCTypes.h>
+#include <torch/csrc/SharedMemoryPool.h>
 #include <torch/csrc/Device.h>
 #include <torch/csrc/autograd/utils/wrap_outputs.h>
 
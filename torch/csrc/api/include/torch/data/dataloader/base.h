@@ -1,8 +1,11 @@
 #pragma once
 
 #include <torch/data/dataloader_options.h>
+#include <torch/data/dataloader_stats.h>
 #include <torch/data/detail/data_shuttle.h>
+#include <torch/data/detail/device_transfer.h>
 #include <torch/data/detail/sequencers.h>
+#include <torch/data/detail/stage_counters.h>
 #include <torch/data/iterator.h>
 #include <torch/data/samplers/random.h>
 #include <torch/data/worker_exception.h>
@@ -11,9 +14,14 @@
 #include <torch/csrc/utils/memory.h>
 #include <torch/csrc/utils/variadic.h>
 
+#include <c10/core/DeviceGuard.h>
+#include <c10/core/Event.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <c10/util/Exception.h>
 
 #include <cstddef>
+#include <deque>
 #include <exception>
 #include <memory>
 #include <thread>
@@ -37,7 +45,15 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
-        sequencer_(new_sequencer()) {}
+        // There are at most `max_jobs` jobs in flight, plus one `QuitWorker`
+        // per worker when joining.
+        shuttle_(options_.max_jobs + options_.workers),
+        sequencer_(new_sequencer()),
+        counters_(options_.workers, options_.max_jobs) {
+    TORCH_CHECK(
+        !options_.device || options_.device->type() != kCPU,
+        "The DataLoader can only copy batches to devices other than the CPU");
+  }
 
   virtual ~DataLoaderBase() {
     join();
@@ -96,6 +112,17 @@ class DataLoaderBase {
     return options_;
   }
 
+  /// Returns where the time of the DataLoader went so far. See
+  /// `DataLoaderStats`.
+  DataLoaderStats stats() const {
+    return counters_.snapshot();
+  }
+
+  /// Restarts the counters of `stats()`.
+  void reset_stats() {
+    counters_.reset();
+  }
+
  protected:
   /// Simple mix-in to give something a sequence number.
   struct Sequenced {
@@ -136,7 +163,9 @@ class DataLoaderBase {
   /// Resets the internal state of the DataLoader, optionally pre-fetching
   /// new jobs.
   virtual void reset() {
+    device_batches_.clear();
     shuttle_.drain();
+    counters_.ready_batches = 0;
     sequence_number_ = 0;
     sequencer_ = new_sequencer();
     prefetch();
@@ -146,7 +175,7 @@ class DataLoaderBase {
   /// number of jobs scheduled may be less if the DataLoader exhausts.
   void prefetch(size_t requested_jobs) {
     for (size_t r = 0; r < requested_jobs; ++r) {
-      if (auto batch_request = get_batch_request()) {
+      if (auto batch_request = next_batch_request()) {
         this->push_job(std::move(*batch_request));
       } else {
         break;
@@ -163,8 +192,34 @@ class DataLoaderBase {
   /// is exhausted. This operation will block until a batch is available if one
   /// is still expected.
   optional<BatchType> next() {
+    if (!options_.device) {
+      return next_batch();
+    }
+    // Keep `device_prefetch` batches in flight to the device besides the one
+    // returned, so that their copies overlap with the work on this batch.
+    while (device_batches_.size() <= options_.device_prefetch) {
+      auto batch = next_batch();
+      if (!batch) {
+        break;
+      }
+      device_batches_.push_back(copy_to_device(std::move(*batch)));
+    }
+    if (device_batches_.empty()) {
+      return nullopt;
+    }
+    auto device_batch = std::move(device_batches_.front());
+    device_batches_.pop_front();
+    const c10::impl::VirtualGuardImpl impl(options_.device->type());
+    device_batch.copied.block(impl.getStream(device_batch.device));
+    return std::move(device_batch.batch);
+  }
+
+  /// Returns the next batch on the CPU, pinned if `pin_memory` is set.
+  optional<BatchType> next_batch() {
     if (options_.workers > 0) {
+      counters_.sample_queue_depth();
       while (optional<Result> result = this->pop_result()) {
+        --counters_.ready_batches;
         if (result->exception) {
           throw WorkerException(result->exception);
         } else if (result->batch) {
@@ -172,25 +227,130 @@ class DataLoaderBase {
           return std::move(result->batch);
         }
       }
-    } else if (auto batch_request = get_batch_request()) {
-      return this->main_thread_dataset_->get_batch(std::move(*batch_request));
+    } else if (auto batch_request = next_batch_request()) {
+      return fetch(*this->main_thread_dataset_, std::move(*batch_request));
     }
     return nullopt;
   }
 
-  /// The function that worker threads run.
-  void worker_thread(Dataset& dataset) {
+  /// Gets a batch request from the subclass, timing it.
+  optional<BatchRequestType> next_batch_request() {
+    detail::StageTimer timer(counters_.sampler, "DataLoader::sampler");
+    return get_batch_request();
+  }
+
+  /// Gets the batch of `request` from `dataset` and pins it if `pin_memory`
+  /// is set. Stateful datasets return an empty `optional` once they are
+  /// exhausted.
+  optional<Batch> fetch(Dataset& dataset, BatchRequest request) {
+    optional<Batch> batch;
+    {
+      detail::StageTimer timer(counters_.get_batch, "DataLoader::get_batch");
+      batch = dataset.get_batch(std::move(request));
+    }
+    if (batch && options_.pin_memory) {
+      detail::StageTimer timer(counters_.pin_memory, "DataLoader::pin_memory");
+      batch = pin(std::move(*batch));
+    }
+    return batch;
+  }
+
+  /// A batch whose tensors are being copied to the device on `copy_stream_`.
+  struct DeviceBatch {
+    DeviceBatch(Batch&& b, Device d, DeviceType type)
+        : batch(std::move(b)), device(d), copied(type) {}
+    Batch batch;
+    Device device;
+    /// Recorded on the copy stream once the copies are enqueued.
+    c10::Event copied;
+  };
+
+  /// Returns `batch` with its CPU tensors pinned.
+  static Batch pin(Batch batch) {
+    auto pin_tensor = [](const Tensor& tensor) {
+      if (!tensor.defined() || !tensor.device().is_cpu() ||
+          tensor.is_pinned()) {
+        return tensor;
+      }
+      return tensor.pin_memory();
+    };
+    return detail::apply_to_tensors(std::move(batch), pin_tensor);
+  }
+
+  /// Enqueues the copies of the tensors of `batch` to the device on the copy
+  /// stream. The device tensors are allocated on the current stream, which
+  /// the returned batch must be used on. The copy stream waits for the work
+  /// enqueued on the current stream so far, which may still use the memory of
+  /// the device tensors, so no stream but the current one ever holds them.
+  DeviceBatch copy_to_device(Batch batch) {
+    detail::StageTimer timer(
+        counters_.copy_to_device, "DataLoader::copy_to_device");
+    const c10::impl::VirtualGuardImpl impl(options_.device->type());
+    const c10::DeviceGuard device_guard(*options_.device);
+    const Device device = impl.getDevice();
+    if (!copy_stream_ || copy_stream_->device() != device) {
+      copy_stream_ = impl.getStreamFromPool(device);
+    }
+
+    std::vector<std::pair<Tensor, Tensor>> copies;
+    auto allocate = [&](const Tensor& tensor) {
+      if (!tensor.defined()) {
+        return tensor;
+      }
+      auto copy = at::empty(tensor.sizes(), tensor.options().device(device));
+      copies.emplace_back(tensor, copy);
+      return copy;
+    };
+    DeviceBatch device_batch(
+        detail::apply_to_tensors(std::move(batch), allocate),
+        device,
+        device.type());
+
+    c10::Event allocated(device.type());
+    allocated.record(impl.getStream(device));
+    allocated.block(*copy_stream_);
+    {
+      const c10::StreamGuard stream_guard(*copy_stream_);
+      for (auto& copy : copies) {
+        // Copies from pinned memory don't block the host. The caching host
+        // allocator keeps the pinned source alive until its copy is done.
+        copy.second.copy_(copy.first, /*non_blocking=*/true);
+      }
+    }
+    device_batch.copied.record(*copy_stream_);
+    return device_batch;
+  }
+
+  /// The function that the `worker`-th worker thread runs.
+  void worker_thread(Dataset& dataset, size_t worker) {
+    using std::chrono::steady_clock;
     while (true) {
+      const auto idle_start = steady_clock::now();
       auto job = shuttle_.pop_job();
+      const auto busy_start = steady_clock::now();
+      counters_.worker_idle_ns[worker] +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              busy_start - idle_start)
+              .count();
       if (job.quit) {
         break;
       }
+      optional<Result> result;
       try {
-        auto batch = dataset.get_batch(std::move(*job.batch_request));
-        shuttle_.push_result({std::move(batch), job.sequence_number});
+        result = Result(
+            fetch(dataset, std::move(*job.batch_request)),
+            job.sequence_number);
       } catch (...) {
-        shuttle_.push_result({std::current_exception(), job.sequence_number});
+        result = Result(std::current_exception(), job.sequence_number);
       }
+      counters_.worker_busy_ns[worker] +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              steady_clock::now() - busy_start)
+              .count();
+      // Counted before it is pushed, so that the main thread never pops a
+      // result that is not counted yet.
+      ++counters_.ready_batches;
+      shuttle_.push_result(std::move(*result));
     }
   }
 
@@ -203,6 +363,7 @@ class DataLoaderBase {
 
   /// Convenience method that gets the next result from the sequencer.
   optional<Result> pop_result() {
+    detail::StageTimer timer(counters_.wait, "DataLoader::wait");
     return sequencer_->next(
         [this] { return this->shuttle_.pop_result(this->options_.timeout); });
   }
@@ -241,6 +402,16 @@ class DataLoaderBase {
 
   /// True if the DataLoader has joined its worker threads.
   bool joined_ = false;
+
+  /// The batches being copied to the `device`, in the order they are
+  /// returned.
+  std::deque<DeviceBatch> device_batches_;
+
+  /// The side stream that copies batches to the `device`.
+  optional<c10::Stream> copy_stream_;
+
+  /// The counters behind `stats()`.
+  detail::StageCounters counters_;
 };
 } // namespace data
 } // namespace torch
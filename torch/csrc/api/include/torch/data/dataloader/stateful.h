@@ -42,7 +42,7 @@ class StatefulDataLoader : public DataLoaderBase<
       // As opposed to the stateless case, here all worker threads access the
       // same underlying dataset.
       this->workers_.emplace_back(
-          [this] { this->worker_thread(*this->main_thread_dataset_); });
+          [this, w] { this->worker_thread(*this->main_thread_dataset_, w); });
     }
   }
 
@@ -46,7 +46,7 @@ class StatelessDataLoader : public DataLoaderBase<
       // trivially copiable, or else we don't expect more than one worker to
       // be in use.
       this->workers_.emplace_back(
-          [this, dataset]() mutable { this->worker_thread(dataset); });
+          [this, dataset, w]() mutable { this->worker_thread(dataset, w); });
     }
     if (this->options_.workers == 0) {
       this->main_thread_dataset_ =
@@ -37,6 +37,22 @@ struct DataLoaderOptions {
   /// Whether to omit the last batch if it contains less than `batch_size`
   /// examples.
   TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether to copy the tensors of every batch into pinned (page-locked)
+  /// memory before returning it. Pinned memory comes from the caching host
+  /// allocator, which reuses the buffers of batches that were freed. If there
+  /// are worker threads, they pin the batches they fetched.
+  TORCH_ARG(bool, pin_memory) = false;
+
+  /// An optional device to copy the tensors of every batch to. The copies run
+  /// on a side stream of the device and overlap with the work of the current
+  /// stream. A batch is ready to use on the current stream when it is
+  /// returned.
+  TORCH_ARG(optional<Device>, device);
+
+  /// The number of batches, besides the one returned, that are copied to the
+  /// `device` ahead of time.
+  TORCH_ARG(size_t, device_prefetch) = 2;
 };
 
 /// Like `DataLoaderOptions`, but without any unconfigured state.
@@ -52,7 +68,10 @@ struct FullDataLoaderOptions {
         max_jobs(options.max_jobs().value_or(2 * workers)),
         timeout(options.timeout()),
         enforce_ordering(options.enforce_ordering()),
-        drop_last(options.drop_last()) {}
+        drop_last(options.drop_last()),
+        pin_memory(options.pin_memory()),
+        device(options.device()),
+        device_prefetch(options.device_prefetch()) {}
 
   size_t batch_size;
   size_t workers;
@@ -60,6 +79,9 @@ struct FullDataLoaderOptions {
   optional<std::chrono::milliseconds> timeout;
   bool enforce_ordering;
   bool drop_last;
+  bool pin_memory;
+  optional<Device> device;
+  size_t device_prefetch;
 };
 } // namespace data
 } // namespace torch
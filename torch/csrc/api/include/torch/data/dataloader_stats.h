@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// The time spent in one stage of a `DataLoader`.
+struct DataLoaderLatency {
+  /// The number of times the stage ran.
+  size_t count = 0;
+  std::chrono::nanoseconds total{0};
+  std::chrono::nanoseconds max{0};
+
+  std::chrono::nanoseconds mean() const {
+    return count == 0 ? std::chrono::nanoseconds(0) : total / count;
+  }
+};
+
+/// Counters of where the time of a `DataLoader` goes, to tell whether a
+/// training loop waiting for its data is bound by the sampler, the dataset,
+/// pinning memory or copying to the device. They are accumulated from the
+/// construction of the `DataLoader` or the last `reset_stats()`, and can be
+/// read at any time, also while iterating. The stages are also recorded as
+/// `DataLoader::<stage>` ranges for the profiler.
+struct DataLoaderStats {
+  /// Getting batch requests from the sampler.
+  DataLoaderLatency sampler;
+  /// `Dataset::get_batch`, which includes the collation of transforms like
+  /// `Stack`.
+  DataLoaderLatency get_batch;
+  /// Copying batches into pinned memory, with the `pin_memory` option.
+  DataLoaderLatency pin_memory;
+  /// Enqueueing the copies of batches to the `device`. The copies themselves
+  /// run asynchronously on a side stream.
+  DataLoaderLatency copy_to_device;
+  /// The main thread blocking in `next()` until a worker finished a batch.
+  DataLoaderLatency wait;
+
+  /// The time every worker thread spent on jobs, and waiting for jobs.
+  std::vector<std::chrono::nanoseconds> worker_busy;
+  std::vector<std::chrono::nanoseconds> worker_idle;
+
+  /// `queue_depth[d]` is the number of times the main thread asked for a
+  /// batch with `d` batches finished by the workers and ready to return. Many
+  /// requests at depth zero mean that the workers are the bottleneck, and
+  /// many at the largest depths that the training loop is. The last element
+  /// counts all larger depths.
+  std::vector<size_t> queue_depth;
+};
+
+} // namespace data
+} // namespace torch
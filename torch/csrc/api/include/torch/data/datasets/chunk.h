@@ -4,7 +4,12 @@
 #include <torch/csrc/utils/memory.h>
 #include <torch/data/datasets/stateful.h>
 #include <torch/data/samplers.h>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <limits>
 #include <queue>
+#include <random>
 #include <thread>
 
 #include <torch/serialize.h>
@@ -30,6 +35,16 @@ class ChunkDataReader {
   /// Read an entire chunk.
   virtual ChunkType read_chunk(size_t chunk_index) = 0;
 
+  /// Starts reading an entire chunk. `ChunkDataset` calls this instead of
+  /// `read_chunk()` if it is configured with more than one read in flight. By
+  /// default, `read_chunk()` runs on a new thread; readers with asynchronous
+  /// I/O can override this to issue the read directly.
+  virtual std::future<ChunkType> read_chunk_async(size_t chunk_index) {
+    return std::async(std::launch::async, [this, chunk_index] {
+      return this->read_chunk(chunk_index);
+    });
+  }
+
   /// Returns the number of chunks available in this reader.
   virtual size_t chunk_count() = 0;
 
@@ -55,10 +70,19 @@ class BatchDataBuffer {
   BatchDataBuffer(
       size_t batch_size,
       ExampleSampler& example_sampler,
-      size_t queue_capacity)
+      size_t queue_capacity,
+      size_t shuffle_buffer_size = 0)
       : batch_size_(batch_size),
         example_sampler_(example_sampler),
-        queue_capacity_(queue_capacity) {}
+        queue_capacity_(queue_capacity),
+        shuffle_buffer_size_(shuffle_buffer_size) {
+    if (shuffle_buffer_size_ > 0) {
+      shuffle_buffer_.reserve(shuffle_buffer_size_);
+      shuffle_engine_.seed(torch::randint(
+          std::numeric_limits<int32_t>::max(), {1}, torch::kInt64)
+          .item<int64_t>());
+    }
+  }
 
   /// Return batch data from the queue. Called from the ChunkDataset main
   /// thread.
@@ -106,51 +130,57 @@ class BatchDataBuffer {
     }
 
     auto data_size = data.size();
-    auto remaining_size = data_size;
     example_sampler_.reset(data_size);
-
-    auto fill_batch = [&](size_t example_count, UnwrappedBatchType& batch) {
-      auto batch_example_indices = this->example_sampler_.next(example_count);
-      AT_ASSERT(
-          batch_example_indices &&
-          batch_example_indices.value().size() == example_count);
-      BatchRequestType& indices = batch_example_indices.value();
-      for (size_t i : indices) {
-        TORCH_CHECK(i < data_size, "Index out of range");
-        batch.emplace_back(std::move(data[i]));
-      }
-      remaining_size -= example_count;
-    };
-
-    if (!batch_queue_.empty()) {
-      // if the queue has existing data, and the last batch doesn't have enough
-      // examples to fill a batch_size batch, add more example to this batch first.
-      auto& batch = batch_queue_.back();
-      size_t current_count = batch.batch_data.size();
-      if (current_count < batch_size_) {
-        auto example_count =
-            std::min(remaining_size, batch_size_ - current_count);
-        fill_batch(example_count, batch.batch_data);
-      }
+    auto indices = example_sampler_.next(data_size);
+    AT_ASSERT(indices && indices.value().size() == data_size);
+    for (size_t i : *indices) {
+      TORCH_CHECK(i < data_size, "Index out of range");
     }
 
-    // If we still have data remaining after filling the last pushed batch, add
-    // them to the queue too.
-    while (remaining_size > 0) {
-      UnwrappedBatchType current_batch;
-
-      // Allocate the batch memory ahead of time.
-      current_batch.reserve(batch_size_);
-
-      auto example_count = std::min(remaining_size, batch_size_);
-      fill_batch(example_count, current_batch);
-      batch_queue_.emplace(std::move(current_batch));
+    size_t next_index = 0;
+    if (shuffle_buffer_size_ == 0) {
+      append_examples(data_size, [&] {
+        return std::move(data[(*indices)[next_index++]]);
+      });
+    } else {
+      // Fill the shuffle buffer first. Once it is full, every new example
+      // takes the place of a random one, which goes to the batches.
+      while (next_index < data_size &&
+             shuffle_buffer_.size() < shuffle_buffer_size_) {
+        shuffle_buffer_.emplace_back(std::move(data[(*indices)[next_index++]]));
+      }
+      std::uniform_int_distribution<size_t> distribution(
+          0, shuffle_buffer_size_ - 1);
+      append_examples(data_size - next_index, [&] {
+        auto& slot = shuffle_buffer_[distribution(shuffle_engine_)];
+        auto example = std::move(slot);
+        slot = std::move(data[(*indices)[next_index++]]);
+        return example;
+      });
     }
-    total_example_count_in_queue_ += data_size;
     lock.unlock();
     cv_read_.notify_all();
   }
 
+  /// Called from the last ChunkDataset worker thread once all chunks are
+  /// loaded. Sends the examples left in the shuffle buffer to the batches in
+  /// random order, and stops the buffer.
+  void finish() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (!stop_ && !shuffle_buffer_.empty()) {
+        std::shuffle(
+            shuffle_buffer_.begin(), shuffle_buffer_.end(), shuffle_engine_);
+        size_t next_index = 0;
+        append_examples(shuffle_buffer_.size(), [&] {
+          return std::move(shuffle_buffer_[next_index++]);
+        });
+        shuffle_buffer_.clear();
+      }
+    }
+    stop();
+  }
+
   /// Push exceptions thrown during preloading into batch queue. Called from
   /// the ChunkDataset worker threads.
   void add_chunk_data(std::exception_ptr e_ptr) {
@@ -195,6 +225,46 @@ class BatchDataBuffer {
     // notify all readers too.
     cv_read_.notify_all();
   }
+
+  /// Appends `count` examples returned by `next_example` to the batches in the
+  /// queue. Must be called with `queue_mutex_` held.
+  template <typename NextExample>
+  void append_examples(size_t count, NextExample next_example) {
+    auto remaining_size = count;
+    auto fill_batch = [&](size_t example_count, UnwrappedBatchType& batch) {
+      for (size_t i = 0; i < example_count; ++i) {
+        batch.emplace_back(next_example());
+      }
+      remaining_size -= example_count;
+    };
+
+    if (!batch_queue_.empty()) {
+      // if the queue has existing data, and the last batch doesn't have enough
+      // examples to fill a batch_size batch, add more example to this batch first.
+      auto& batch = batch_queue_.back();
+      size_t current_count = batch.batch_data.size();
+      if (current_count < batch_size_) {
+        auto example_count =
+            std::min(remaining_size, batch_size_ - current_count);
+        fill_batch(example_count, batch.batch_data);
+      }
+    }
+
+    // If we still have data remaining after filling the last pushed batch, add
+    // them to the queue too.
+    while (remaining_size > 0) {
+      UnwrappedBatchType current_batch;
+
+      // Allocate the batch memory ahead of time.
+      current_batch.reserve(batch_size_);
+
+      auto example_count = std::min(remaining_size, batch_size_);
+      fill_batch(example_count, current_batch);
+      batch_queue_.emplace(std::move(current_batch));
+    }
+    total_example_count_in_queue_ += count;
+  }
+
   /// The batch size is needed to create batches from the chunk data. Similar to
   /// regular dataloader where the batches are created with prefetches,
   /// BatchDataBuffer perform the batch creation using the provided batch size.
@@ -233,6 +303,15 @@ class BatchDataBuffer {
   // configurable maximun number of elements the queue can hold at one time.
   size_t queue_capacity_;
 
+  // The number of examples shuffled across chunks before they are batched, 0
+  // if examples are only shuffled within a chunk by the example sampler.
+  size_t shuffle_buffer_size_;
+
+  // The examples waiting in the shuffle buffer.
+  UnwrappedBatchType shuffle_buffer_;
+
+  std::mt19937_64 shuffle_engine_;
+
   // When set to true, it wakes the writer threads from the wait and exit current
   // function call. This is needed when ChunkDataSet.Reset is called while the
   // previous epoch is not exhausted yet. When ChunkDataset is waiting its
@@ -292,6 +371,17 @@ struct ChunkDatasetOptions {
   // penalty when this value is greater than 1, as we need to do extra merge
   // between multiple chunks before performing example sampling.
   TORCH_ARG(size_t, cross_chunk_shuffle_count) = 1;
+
+  // The number of examples in a buffer that shuffles examples across chunks
+  // as they stream through, without loading several chunks at once. Every
+  // example that is loaded replaces a random one of the buffer, which is
+  // batched instead. Default to 0 meaning no shuffle buffer.
+  TORCH_ARG(size_t, shuffle_buffer_size) = 0;
+
+  // The number of chunk reads every preloader keeps in flight. When it is
+  // greater than 1, preloaders read chunks with `read_chunk_async()` and
+  // `read_chunk()` has to be thread-safe, like for more than one preloader.
+  TORCH_ARG(size_t, reads_in_flight) = 1;
 };
 
 /// A stateful dataset that support hierarchical sampling and prefetching of
@@ -332,7 +422,11 @@ class ChunkDataset final
         preprocessing_policy_(preprocessing_policy),
         quit_worker_(false),
         running_preloaders_(0),
-        load_checkpoint_(false) {}
+        load_checkpoint_(false) {
+    TORCH_CHECK(
+        options_.reads_in_flight() > 0,
+        "reads_in_flight needs to be greater than 0.");
+  }
 
   virtual ~ChunkDataset() {
     // stop batch buffer first.
@@ -387,7 +481,8 @@ class ChunkDataset final
         detail::BatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>(
         options_.batch_size(),
         example_sampler_,
-        options_.cache_size());
+        options_.cache_size(),
+        options_.shuffle_buffer_size());
 
     // create new workers for this new epoch.
     quit_worker_ = false;
@@ -422,22 +517,41 @@ class ChunkDataset final
   }
 
  private:
+  using ChunkType = typename ChunkReader::ChunkType;
+
   /// running on worker thread to preload chunk data.
   void preloader(size_t id) {
+    // The reads of the next chunks to load, `cross_chunk_shuffle_count` chunks
+    // at a time.
+    std::deque<std::vector<std::future<ChunkType>>> reads;
+    bool exhausted = false;
     while (!quit_worker_.load()) {
       try {
-        std::vector<size_t> chunk_idx;
-        {
-          std::lock_guard<std::mutex> lock(chunk_index_guard_);
-          if (auto chunk_sampler_result = chunk_sampler_.next(this->options_.cross_chunk_shuffle_count())) {
-            chunk_idx = chunk_sampler_result.value();
-          } else {
-            break;
+        while (!exhausted && reads.size() < options_.reads_in_flight()) {
+          std::vector<size_t> chunk_idx;
+          {
+            std::lock_guard<std::mutex> lock(chunk_index_guard_);
+            if (auto chunk_sampler_result = chunk_sampler_.next(this->options_.cross_chunk_shuffle_count())) {
+              chunk_idx = chunk_sampler_result.value();
+            } else {
+              exhausted = true;
+              break;
+            }
           }
+          reads.emplace_back();
+          for (size_t index : chunk_idx) {
+            reads.back().push_back(start_read(index));
+          }
+        }
+        if (reads.empty()) {
+          break;
         }
-        UnwrappedBatchType data = chunk_reader_.read_chunk(chunk_idx[0]);
-        for (size_t i = 1; i < chunk_idx.size(); ++i) {
-          auto chunk_data = chunk_reader_.read_chunk(chunk_idx[i]);
+        auto chunk_reads = std::move(reads.front());
+        reads.pop_front();
+
+        UnwrappedBatchType data = chunk_reads[0].get();
+        for (size_t i = 1; i < chunk_reads.size(); ++i) {
+          auto chunk_data = chunk_reads[i].get();
           std::move(
               chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
         }
@@ -455,8 +569,19 @@ class ChunkDataset final
     --running_preloaders_;
     if (running_preloaders_.load() == 0) {
       // all preloaders are completed, so we can notify the batch_buffer.
-      batch_buffer_->stop();
+      batch_buffer_->finish();
+    }
+  }
+
+  /// Starts reading a chunk. With a single read in flight, the read runs
+  /// synchronously on the preloader when the result is needed.
+  std::future<ChunkType> start_read(size_t chunk_index) {
+    if (options_.reads_in_flight() == 1) {
+      return std::async(std::launch::deferred, [this, chunk_index] {
+        return this->chunk_reader_.read_chunk(chunk_index);
+      });
     }
+    return chunk_reader_.read_chunk_async(chunk_index);
   }
 
   /// Block the current thread until the workers finish execution and exit.
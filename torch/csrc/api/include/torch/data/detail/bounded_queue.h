@@ -0,0 +1,282 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A bounded, lock-free MPMC queue.
+///
+/// The elements live in a ring buffer of cells, each with a sequence number
+/// that tells whether the cell is ready to be written or to be read in the
+/// current lap around the ring (see Dmitry Vyukov's bounded MPMC queue).
+/// Producers and consumers claim cells by advancing the tail or the head with
+/// a compare-and-swap, so `try_push` and `try_pop` never take a lock.
+///
+/// `push` blocks while the queue is full, which applies backpressure to the
+/// producers, and `pop` blocks while it is empty. They spin for a short while
+/// and then wait on a condition variable. The mutex of the condition variable
+/// is only ever taken if a thread is waiting.
+///
+/// Like `Queue`, this data structure is written specifically for use with the
+/// `DataLoader` and raises the same error when `pop` times out.
+template <typename T>
+class BoundedQueue {
+ public:
+  /// Creates a queue that holds at least `capacity` elements.
+  explicit BoundedQueue(size_t capacity)
+      : capacity_(round_up_to_power_of_two(capacity)),
+        cells_(new Cell[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  ~BoundedQueue() {
+    clear();
+  }
+
+  /// Moves `value` into the queue if it is not full. Returns false, leaving
+  /// `value` untouched, if it is.
+  bool try_push(T& value) {
+    Cell* cell = nullptr;
+    size_t position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & (capacity_ - 1)];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto lap = static_cast<std::ptrdiff_t>(sequence - position);
+      if (lap == 0) {
+        if (tail_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    ::new (&cell->storage) T(std::move(value));
+    cell->sequence.store(position + 1, std::memory_order_release);
+    notify(not_empty_, waiting_to_pop_);
+    return true;
+  }
+
+  /// Moves the front element of the queue into `value` if the queue is not
+  /// empty. Returns false if it is.
+  bool try_pop(T& value) {
+    return pop_front([&value](T& element) { value = std::move(element); });
+  }
+
+  /// Pushes a new value to the back of the queue, blocking while it is full.
+  void push(T value) {
+    for (size_t spin = 0; spin < kSpins; ++spin) {
+      if (try_push(value)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    wait(
+        not_full_,
+        waiting_to_push_,
+        nullopt,
+        [&] { return this->try_push(value); },
+        [this] { return this->has_space(); });
+  }
+
+  /// Blocks until an element can be popped from the front of the queue. An
+  /// optional `timeout` can be used to limit the time spent waiting for an
+  /// element. If the wait times out, an exception is raised.
+  T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
+    optional<T> value;
+    auto try_pop_value = [&] {
+      return this->pop_front(
+          [&value](T& element) { value.emplace(std::move(element)); });
+    };
+    for (size_t spin = 0; spin < kSpins; ++spin) {
+      if (try_pop_value()) {
+        return std::move(*value);
+      }
+      std::this_thread::yield();
+    }
+    if (!wait(
+            not_empty_,
+            waiting_to_pop_,
+            timeout,
+            try_pop_value,
+            [this] { return this->has_element(); })) {
+      // clang-format off
+      AT_ERROR(
+          "Timeout in DataLoader queue while waiting for next batch"
+          " (timeout was ", timeout->count(), " ms)");
+      // clang-format on
+    }
+    return std::move(*value);
+  }
+
+  /// Empties the queue and returns the number of elements that were popped.
+  /// Like `Queue::clear()`, it is meant for draining the queue while no
+  /// element is pushed.
+  size_t clear() {
+    size_t size = 0;
+    while (pop_front([](T& /*element*/) {})) {
+      ++size;
+    }
+    return size;
+  }
+
+  /// The number of elements the queue can hold.
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+ private:
+  /// The number of times `push` and `pop` retry before they wait.
+  static constexpr size_t kSpins = 64;
+  /// Keeps the head and the tail on separate cache lines.
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  static size_t round_up_to_power_of_two(size_t capacity) {
+    size_t power = 2;
+    while (power < capacity) {
+      power *= 2;
+    }
+    return power;
+  }
+
+  /// Claims the front cell of the queue, passes its element to `consume` and
+  /// destroys it. Returns false if the queue is empty.
+  template <typename Consume>
+  bool pop_front(Consume consume) {
+    Cell* cell = nullptr;
+    size_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & (capacity_ - 1)];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto lap = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+      if (lap == 0) {
+        if (head_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+    T* element = reinterpret_cast<T*>(&cell->storage);
+    consume(*element);
+    element->~T();
+    cell->sequence.store(position + capacity_, std::memory_order_release);
+    notify(not_full_, waiting_to_push_);
+    return true;
+  }
+
+  /// Whether a `try_pop` may succeed, without popping anything.
+  bool has_element() const {
+    const size_t position = head_.load(std::memory_order_relaxed);
+    const size_t sequence = cells_[position & (capacity_ - 1)].sequence.load(
+        std::memory_order_acquire);
+    return static_cast<std::ptrdiff_t>(sequence - (position + 1)) >= 0;
+  }
+
+  /// Whether a `try_push` may succeed, without pushing anything.
+  bool has_space() const {
+    const size_t position = tail_.load(std::memory_order_relaxed);
+    const size_t sequence = cells_[position & (capacity_ - 1)].sequence.load(
+        std::memory_order_acquire);
+    return static_cast<std::ptrdiff_t>(sequence - position) >= 0;
+  }
+
+  /// Wakes up the threads waiting on `cv`, if there are any. The fence
+  /// orders the update of the cell before the load of `waiting`, and pairs
+  /// with the fence in `wait()`: either the waiting thread sees the update,
+  /// or this thread sees the waiting thread and notifies it.
+  void notify(std::condition_variable& cv, std::atomic<size_t>& waiting) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv.notify_all();
+    }
+  }
+
+  /// Waits on `cv` until `ready()` returns true or `timeout` expires, and
+  /// returns false in the latter case. `ready()` runs without the mutex,
+  /// since it notifies the other side. `could_be_ready()` is checked with the
+  /// mutex before waiting, so that a notification in between isn't lost.
+  template <typename Ready, typename CouldBeReady>
+  bool wait(
+      std::condition_variable& cv,
+      std::atomic<size_t>& waiting,
+      optional<std::chrono::milliseconds> timeout,
+      Ready ready,
+      CouldBeReady could_be_ready) {
+    const auto deadline = std::chrono::steady_clock::now() +
+        timeout.value_or(std::chrono::milliseconds(0));
+    waiting.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool done = false;
+    while (!(done = ready())) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (could_be_ready()) {
+        continue;
+      }
+      if (!timeout) {
+        cv.wait(lock);
+      } else if (cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+        lock.unlock();
+        done = ready();
+        break;
+      }
+    }
+    waiting.fetch_sub(1, std::memory_order_relaxed);
+    return done;
+  }
+
+  const size_t capacity_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> tail_{0};
+  char pad1_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_{0};
+  char pad2_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::atomic<size_t> waiting_to_pop_{0};
+  std::atomic<size_t> waiting_to_push_{0};
+};
+
+template <typename T>
+constexpr size_t BoundedQueue<T>::kSpins;
+template <typename T>
+constexpr size_t BoundedQueue<T>::kCacheLineSize;
+
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <torch/data/detail/queue.h>
+#include <torch/data/detail/bounded_queue.h>
 #include <torch/types.h>
 
 #include <c10/util/Exception.h>
@@ -22,9 +22,18 @@ namespace detail {
 /// dequeues a result is the count of in-flight jobs decremented. When the main
 /// thread attempts to dequeue a job but no jobs are in-flight, that means the
 /// epoch is complete and `pop_result` returns an empty optional.
+///
+/// Jobs and results go through lock-free queues that hold `capacity` elements
+/// each. Pushing to a full queue blocks until there is space again, so the
+/// capacity should be at least the number of jobs that are ever in flight.
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  explicit DataShuttle(size_t capacity = kDefaultCapacity)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
@@ -74,14 +83,17 @@ class DataShuttle {
 
  private:
   /// The queue for jobs that are not yet in flight.
-  Queue<Job> new_jobs_;
+  BoundedQueue<Job> new_jobs_;
   /// The number of in-flight jobs.
   /// NOTE: Not atomic because only manipulated by the main thread.
   size_t in_flight_jobs_ = 0;
   /// The queue for results of finished jobs.
-  Queue<Result> results_;
+  BoundedQueue<Result> results_;
 };
 
+template <typename Job, typename Result>
+constexpr size_t DataShuttle<Job, Result>::kDefaultCapacity;
+
 } // namespace detail
 } // namespace data
 } // namespace torch
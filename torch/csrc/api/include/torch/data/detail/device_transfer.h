@@ -0,0 +1,54 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Applies `function` to every tensor of a batch and returns the batch with
+/// the results. This is how the DataLoader pins batches and copies them to a
+/// device. Tensors, `Example`s and vectors of them are supported; batches of
+/// any other type are returned unchanged.
+template <typename Batch, typename F>
+Batch apply_to_tensors(Batch batch, F& /*function*/) {
+  return batch;
+}
+
+template <typename F>
+Tensor apply_to_tensors(Tensor tensor, F& function) {
+  return function(tensor);
+}
+
+template <typename Data, typename Target, typename F>
+Example<Data, Target> apply_to_tensors(
+    Example<Data, Target> example,
+    F& function) {
+  example.data = apply_to_tensors(std::move(example.data), function);
+  example.target = apply_to_tensors(std::move(example.target), function);
+  return example;
+}
+
+template <typename Data, typename F>
+Example<Data, example::NoTarget> apply_to_tensors(
+    Example<Data, example::NoTarget> example,
+    F& function) {
+  example.data = apply_to_tensors(std::move(example.data), function);
+  return example;
+}
+
+template <typename T, typename F>
+std::vector<T> apply_to_tensors(std::vector<T> batch, F& function) {
+  for (auto& element : batch) {
+    element = apply_to_tensors(std::move(element), function);
+  }
+  return batch;
+}
+
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <torch/data/dataloader_stats.h>
+
+#include <torch/csrc/autograd/record_function.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Accumulates the latencies of a stage. Safe to update from several threads
+/// while it is read.
+class LatencyCounter {
+ public:
+  void add(std::chrono::nanoseconds latency) {
+    const int64_t ns = latency.count();
+    ++count_;
+    total_ns_ += ns;
+    int64_t max = max_ns_.load();
+    while (ns > max && !max_ns_.compare_exchange_weak(max, ns)) {
+    }
+  }
+
+  DataLoaderLatency snapshot() const {
+    DataLoaderLatency latency;
+    latency.count = count_.load();
+    latency.total = std::chrono::nanoseconds(total_ns_.load());
+    latency.max = std::chrono::nanoseconds(max_ns_.load());
+    return latency;
+  }
+
+  void reset() {
+    count_ = 0;
+    total_ns_ = 0;
+    max_ns_ = 0;
+  }
+
+ private:
+  std::atomic<size_t> count_{0};
+  std::atomic<int64_t> total_ns_{0};
+  std::atomic<int64_t> max_ns_{0};
+};
+
+/// The counters behind `DataLoaderStats`, updated by the main thread and the
+/// worker threads of a `DataLoader`.
+struct StageCounters {
+  StageCounters(size_t workers, size_t max_jobs)
+      : worker_busy_ns(workers),
+        worker_idle_ns(workers),
+        queue_depth(max_jobs + 1) {}
+
+  DataLoaderStats snapshot() const {
+    DataLoaderStats stats;
+    stats.sampler = sampler.snapshot();
+    stats.get_batch = get_batch.snapshot();
+    stats.pin_memory = pin_memory.snapshot();
+    stats.copy_to_device = copy_to_device.snapshot();
+    stats.wait = wait.snapshot();
+    for (size_t w = 0; w < worker_busy_ns.size(); ++w) {
+      stats.worker_busy.emplace_back(worker_busy_ns[w].load());
+      stats.worker_idle.emplace_back(worker_idle_ns[w].load());
+    }
+    for (const auto& count : queue_depth) {
+      stats.queue_depth.push_back(count.load());
+    }
+    return stats;
+  }
+
+  void reset() {
+    sampler.reset();
+    get_batch.reset();
+    pin_memory.reset();
+    copy_to_device.reset();
+    wait.reset();
+    for (size_t w = 0; w < worker_busy_ns.size(); ++w) {
+      worker_busy_ns[w] = 0;
+      worker_idle_ns[w] = 0;
+    }
+    for (auto& count : queue_depth) {
+      count = 0;
+    }
+  }
+
+  /// Samples the number of ready batches when the main thread asks for one.
+  void sample_queue_depth() {
+    const size_t depth =
+        std::min<size_t>(ready_batches.load(), queue_depth.size() - 1);
+    ++queue_depth[depth];
+  }
+
+  LatencyCounter sampler;
+  LatencyCounter get_batch;
+  LatencyCounter pin_memory;
+  LatencyCounter copy_to_device;
+  LatencyCounter wait;
+  std::vector<std::atomic<int64_t>> worker_busy_ns;
+  std::vector<std::atomic<int64_t>> worker_idle_ns;
+  std::vector<std::atomic<size_t>> queue_depth;
+  /// The number of batches finished by the workers and not yet returned.
+  std::atomic<size_t> ready_batches{0};
+};
+
+/// Times a stage into a `LatencyCounter` for as long as it lives, and records
+/// the stage as a range named `name` for the profiler.
+class StageTimer {
+ public:
+  StageTimer(LatencyCounter& counter, const char* name)
+      : counter_(counter), start_(std::chrono::steady_clock::now()) {
+    if (autograd::profiler::hasCallbacks() && record_.sampleCallbacks()) {
+      record_.before(name);
+    }
+  }
+
+  ~StageTimer() {
+    counter_.add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_));
+  }
+
+ private:
+  LatencyCounter& counter_;
+  std::chrono::steady_clock::time_point start_;
+  autograd::profiler::RecordFunction record_;
+};
+
+} // namespace detail
+} // namespace data
+} // namespace torch
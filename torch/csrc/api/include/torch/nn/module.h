@@ -7,6 +7,8 @@
 
 #include <ATen/ATen.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <map>
@@ -203,6 +205,11 @@ class TORCH_API Module : public std::enable_shared_from_this<Module> {
 
   /// Returns the parameters of this `Module` and if `recurse` is true, also
   /// recursively of every submodule.
+  ///
+  /// The recursive list is cached, so calling this repeatedly does not walk
+  /// the module tree again. The cache of every `Module` is invalidated when
+  /// a parameter or a submodule is registered, replaced or unregistered
+  /// anywhere.
   std::vector<Tensor> parameters(bool recurse = true) const;
 
   /// Returns an `OrderedDict` with the parameters of this `Module` along with
@@ -553,6 +560,28 @@ class TORCH_API Module : public std::enable_shared_from_this<Module> {
   /// Returns a shared_ptr to `this` in a safe (checked) way.
   std::shared_ptr<Module> shared_from_this_checked() const;
 
+  /// A `parameters(/*recurse=*/true)` result together with the value of
+  /// `structure_version_` it was computed at. Copying a `Module` does not
+  /// copy its cache.
+  struct ParametersCache {
+    using Entry = std::pair<uint64_t, std::vector<Tensor>>;
+
+    ParametersCache() = default;
+    ParametersCache(const ParametersCache&) {}
+    ParametersCache& operator=(const ParametersCache&) {
+      entry.reset();
+      return *this;
+    }
+
+    // Read and written with std::atomic_load/std::atomic_store, since
+    // `parameters()` is const and may be called from several threads.
+    std::shared_ptr<const Entry> entry;
+  };
+
+  /// Incremented whenever a parameter or a submodule of any `Module` is
+  /// registered, replaced or unregistered.
+  static std::atomic<uint64_t> structure_version_;
+
   /// The registered parameters of this `Module`.
   OrderedDict<std::string, Tensor> parameters_;
 
@@ -567,6 +596,9 @@ class TORCH_API Module : public std::enable_shared_from_this<Module> {
 
   /// Whether the module is in training mode.
   bool is_training_{true};
+
+  /// The cached recursive `parameters()` of this `Module`.
+  mutable ParametersCache parameters_cache_;
 };
 
 /// Serialize a `Module` pointer into an `OutputArchive`.
@@ -616,6 +648,7 @@ std::shared_ptr<ModuleType> Module::register_module(
       name,
       "')");
   auto& base_module = children_.insert(std::move(name), std::move(module));
+  ++structure_version_;
   return std::dynamic_pointer_cast<ModuleType>(base_module);
 }
 
@@ -631,6 +664,7 @@ std::shared_ptr<ModuleType> Module::replace_module(
     const std::string& name,
     std::shared_ptr<ModuleType> module) {
   auto& base_module = (children_[name] = std::move(module));
+  ++structure_version_;
   return std::dynamic_pointer_cast<ModuleType>(base_module);
 }
 
@@ -6,6 +6,7 @@
 #include <torch/nn/modules/container/modulelist.h>
 #include <torch/nn/modules/container/named_any.h>
 #include <torch/nn/modules/container/sequential.h>
+#include <torch/nn/modules/container/static_sequential.h>
 
 // Layers
 #include <torch/nn/modules/batchnorm.h>
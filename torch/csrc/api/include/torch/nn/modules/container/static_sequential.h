@@ -0,0 +1,176 @@
+#pragma once
+
+#include <torch/nn/cloneable.h>
+#include <torch/nn/module.h>
+#include <torch/nn/pimpl.h>
+#include <torch/types.h>
+
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace torch {
+namespace nn {
+namespace detail {
+
+/// Calls `forward()` on the module at `Index` of a tuple of `ModuleHolder`s,
+/// then passes its output to the module at `Index + 1`, until the end of the
+/// tuple is reached.
+template <size_t Index, size_t Size>
+struct StaticSequentialForward {
+  template <typename Tuple, typename... InputTypes>
+  static decltype(auto) run(Tuple& modules, InputTypes&&... inputs) {
+    return StaticSequentialForward<Index + 1, Size>::run(
+        modules,
+        std::get<Index>(modules)->forward(std::forward<InputTypes>(inputs)...));
+  }
+};
+
+template <size_t Size>
+struct StaticSequentialForward<Size, Size> {
+  template <typename Tuple, typename InputType>
+  static typename std::decay<InputType>::type run(
+      Tuple& /*modules*/,
+      InputType&& input) {
+    return std::forward<InputType>(input);
+  }
+};
+
+} // namespace detail
+
+/// A `Sequential` whose module types are fixed at compile time.
+///
+/// `Sequential` stores its modules as `AnyModule`s, so every call to
+/// `forward()` goes through a virtual call and boxes the output of each module
+/// into an `AnyValue`. `StaticSequential` instead stores a `std::tuple` of
+/// `ModuleHolder`s and chains the `forward()` calls of its modules directly,
+/// which lets the compiler inline the whole chain. The return type of
+/// `forward()` is that of the last module, so it does not need to be spelled
+/// out. For example:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   auto seq = torch::nn::make_static_sequential(
+///     torch::nn::Linear(3, 4),
+///     torch::nn::ReLU(),
+///     torch::nn::Linear(4, 1)
+///   );
+///
+///   torch::Tensor output = seq->forward(torch::ones({2, 3}));
+///
+/// \endrst
+///
+/// The modules are registered as submodules named "0", "1", ..., exactly like
+/// in `Sequential`, so `parameters()`, `to()`, serialization and so on behave
+/// the same way. Since `forward()` is a template, a `StaticSequential` cannot
+/// itself be stored in an `AnyModule` or in another `Sequential`.
+template <typename... Modules>
+class StaticSequentialImpl
+    : public Cloneable<StaticSequentialImpl<Modules...>> {
+ public:
+  static_assert(
+      sizeof...(Modules) > 0,
+      "StaticSequential must contain at least one module");
+
+  /// Constructs the `StaticSequential` from its modules, which must be
+  /// `ModuleHolder`s (e.g. `Linear`, `ReLU`, `Sequential`).
+  explicit StaticSequentialImpl(Modules... modules)
+      : modules_(std::move(modules)...) {
+    register_modules(std::index_sequence_for<Modules...>{});
+  }
+
+  /// Special cloning function for `StaticSequential` because it does not use
+  /// `reset()`.
+  std::shared_ptr<Module> clone(
+      const optional<Device>& device = nullopt) const override {
+    return clone_modules(device, std::index_sequence_for<Modules...>{});
+  }
+
+  /// `reset()` is empty for `StaticSequential`, since it does not have
+  /// parameters of its own.
+  void reset() override {}
+
+  /// Pretty prints the `StaticSequential` module into the given `stream`.
+  void pretty_print(std::ostream& stream) const override {
+    stream << "torch::nn::StaticSequential";
+  }
+
+  /// Feeds `inputs` to the first module and then chains outputs to inputs,
+  /// returning the output of the last module.
+  template <typename... InputTypes>
+  decltype(auto) forward(InputTypes&&... inputs) {
+    return detail::StaticSequentialForward<0, sizeof...(Modules)>::run(
+        modules_, std::forward<InputTypes>(inputs)...);
+  }
+
+  /// Returns the module at `Index`.
+  template <size_t Index>
+  typename std::tuple_element<Index, std::tuple<Modules...>>::type& get() {
+    return std::get<Index>(modules_);
+  }
+
+  /// Returns the module at `Index`.
+  template <size_t Index>
+  const typename std::tuple_element<Index, std::tuple<Modules...>>::type& get()
+      const {
+    return std::get<Index>(modules_);
+  }
+
+  /// The number of modules in the `StaticSequential`.
+  static constexpr size_t size() noexcept {
+    return sizeof...(Modules);
+  }
+
+ private:
+  template <size_t... Indices>
+  void register_modules(std::index_sequence<Indices...>) {
+    // Expands to one `register_module()` call per module, in order.
+    int expand[] = {
+        0,
+        (this->register_module(
+             c10::to_string(Indices), std::get<Indices>(modules_).ptr()),
+         0)...};
+    (void)expand;
+  }
+
+  template <size_t... Indices>
+  std::shared_ptr<Module> clone_modules(
+      const optional<Device>& device,
+      std::index_sequence<Indices...>) const {
+    return std::make_shared<StaticSequentialImpl>(Modules(
+        std::dynamic_pointer_cast<typename Modules::ContainedType>(
+            std::get<Indices>(modules_)->clone(device)))...);
+  }
+
+  std::tuple<Modules...> modules_;
+};
+
+/// A `ModuleHolder` subclass for `StaticSequentialImpl`.
+/// See the documentation for `StaticSequentialImpl` class to learn what methods
+/// it provides, or the documentation for `ModuleHolder` to learn about
+/// PyTorch's module storage semantics.
+template <typename... Modules>
+class StaticSequential
+    : public torch::nn::ModuleHolder<StaticSequentialImpl<Modules...>> {
+ public:
+  using torch::nn::ModuleHolder<StaticSequentialImpl<Modules...>>::ModuleHolder;
+};
+
+/// Constructs a `StaticSequential` from the given modules, deducing their
+/// types.
+template <typename... Modules>
+StaticSequential<typename std::decay<Modules>::type...> make_static_sequential(
+    Modules&&... modules) {
+  return StaticSequential<typename std::decay<Modules>::type...>(
+      std::make_shared<StaticSequentialImpl<typename std::decay<Modules>::type...>>(
+          std::forward<Modules>(modules)...));
+}
+
+} // namespace nn
+} // namespace torch
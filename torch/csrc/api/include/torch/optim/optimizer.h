@@ -76,6 +76,13 @@ class TORCH_API OptimizerParamGroup {
   std::vector<Tensor>& params();
   const std::vector<Tensor>& params() const;
 
+  /// Moves the parameters of this group into one contiguous buffer, and their
+  /// gradients into another, leaving each parameter and gradient as a view
+  /// into its buffer. Optimizers can then update the whole group with a few
+  /// large kernels instead of a few small kernels per parameter. All
+  /// parameters must be dense and share a dtype and a device.
+  void flatten();
+
  protected:
   std::vector<Tensor> params_;
   std::unique_ptr<OptimizerOptions> options_;
@@ -83,6 +90,17 @@ class TORCH_API OptimizerParamGroup {
 
 namespace detail {
 
+/// Returns a 1-D tensor aliasing all of `tensors` if they are dense,
+/// contiguous, share a dtype, a device and a storage and are laid out back to
+/// back in that order (as they are after `OptimizerParamGroup::flatten()`).
+/// Returns an undefined tensor otherwise.
+TORCH_API Tensor flat_view(const std::vector<Tensor>& tensors);
+
+/// Returns a contiguous tensor of shape `sizes` aliasing the 1-D tensor `flat`
+/// from element `offset` on. Unlike `narrow()` and `view()`, the result is not
+/// an autograd view of `flat`, so it can be detached in-place.
+TORCH_API Tensor flat_slice(const Tensor& flat, int64_t offset, IntArrayRef sizes);
+
 /// Base class for all optimizers, that does not yet define a `step()`
 /// mechanism. All it specifies is that optimizers must be supplied with a
 /// vector of parameters. It also defines certain methods that all optimizers
@@ -106,6 +124,9 @@ class TORCH_API OptimizerBase {
   /// Adds the given param_group to the optimizer's param_group list.
   void add_param_group(const OptimizerParamGroup& param_group);
 
+  /// Calls `flatten()` on every param_group of the optimizer.
+  void flatten_param_groups();
+
   virtual ~OptimizerBase() = default;
 
   // TODO: when all optimizers use the new design, we can devirtualize some of the following methods
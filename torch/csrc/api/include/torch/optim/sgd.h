@@ -76,6 +76,15 @@ class TORCH_API SGD : public Optimizer {
   void load(serialize::InputArchive& archive) override;
 
  private:
+  /// Updates a param_group whose parameters and gradients were flattened with
+  /// `OptimizerParamGroup::flatten()`, with a handful of kernels over
+  /// `flat_param` and `flat_grad` and a flat momentum buffer.
+  void step_flat(
+      const std::vector<Tensor>& params,
+      Tensor flat_param,
+      const Tensor& flat_grad,
+      const SGDOptions& options);
+
   template <typename Self, typename Archive>
   static void serialize(Self& self, Archive& archive) {
     _TORCH_OPTIM_SERIALIZE_WITH_TEMPLATE_ARG(SGD);
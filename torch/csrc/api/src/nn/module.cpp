@@ -34,6 +34,8 @@ std::string join_name(const std::string& name_prefix, const std::string& name) {
 }
 } // namespace
 
+std::atomic<uint64_t> Module::structure_version_{1};
+
 Module::Module()
     : parameters_("Parameter"), buffers_("Buffer"), children_("Submodule") {}
 
@@ -132,7 +134,20 @@ void Module::apply(
 }
 
 std::vector<Tensor> Module::parameters(bool recurse) const {
-  return named_parameters(recurse).values();
+  if (!recurse) {
+    return named_parameters(/*recurse=*/false).values();
+  }
+  const uint64_t version = structure_version_.load();
+  auto entry = std::atomic_load(&parameters_cache_.entry);
+  if (entry && entry->first == version) {
+    return entry->second;
+  }
+  auto parameters = named_parameters(/*recurse=*/true).values();
+  std::atomic_store(
+      &parameters_cache_.entry,
+      std::shared_ptr<const ParametersCache::Entry>(
+          std::make_shared<ParametersCache::Entry>(version, parameters)));
+  return parameters;
 }
 
 OrderedDict<std::string, Tensor> Module::named_parameters(bool recurse) const {
@@ -318,7 +333,9 @@ Tensor& Module::register_parameter(
   } else {
     tensor.set_requires_grad(requires_grad);
   }
-  return parameters_.insert(std::move(name), std::move(tensor));
+  auto& parameter = parameters_.insert(std::move(name), std::move(tensor));
+  ++structure_version_;
+  return parameter;
 }
 
 Tensor& Module::register_buffer(std::string name, Tensor tensor) {
@@ -338,6 +355,7 @@ void Module::unregister_module(const std::string& name) {
       name,
       "` is registered");
   children_.erase(name);
+  ++structure_version_;
 }
 
 void Module::pretty_print(std::ostream& stream) const {
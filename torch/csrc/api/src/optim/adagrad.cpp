@@ -6,8 +6,10 @@
 #include <torch/optim/serialize.h>
 
 #include <ATen/ATen.h>
+#include <caffe2/perfkernels/adagrad.h>
 
 #include <functional>
+#include <limits>
 
 namespace torch {
 namespace optim {
@@ -53,6 +55,22 @@ void AdagradParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, sum);
 }
 
+namespace {
+// Sparse gradients of a contiguous float CPU parameter, dense in all but the
+// first dimension, like the ones of an embedding, are applied by the
+// caffe2 perfkernel.
+bool can_use_sparse_adagrad_kernel(
+    const Tensor& param,
+    const Tensor& sum,
+    const Tensor& grad) {
+  return param.device().is_cpu() && param.scalar_type() == kFloat &&
+      param.is_contiguous() && param.dim() >= 1 && sum.is_contiguous() &&
+      sum.scalar_type() == kFloat && sum.sizes() == param.sizes() &&
+      grad.sparse_dim() == 1 && grad._values().scalar_type() == kFloat &&
+      param.numel() <= std::numeric_limits<int>::max();
+}
+} // namespace
+
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 void Adagrad::step() {
@@ -76,22 +94,39 @@ void Adagrad::step() {
           (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
 
       if (grad.is_sparse()) {
-        grad = grad.coalesce();
-        auto grad_indices = grad._indices();
-        auto grad_values = grad._values();
-        auto size = grad.sizes();
-
-        auto make_sparse = [&] (const Tensor& values) -> Tensor {
-          if (grad_indices.dim() == 0 || values.dim() == 0) {
-            return torch::empty({0}, grad.options()).resize_as_(grad);
-          }
-          return torch::sparse_coo_tensor(grad_indices, values, size, grad.options());
-        };
-        state.sum(state.sum().add_(make_sparse(grad_values.pow(2))));
-        auto std = state.sum().sparse_mask(grad);
-        const auto std_values = std._values().sqrt_().add_(options.eps());
-
-        p.data().add_(make_sparse(grad_values / std_values), -clr);
+        if (grad.is_coalesced() &&
+            can_use_sparse_adagrad_kernel(p.data(), state.sum(), grad)) {
+          // Coalesced gradients have one row per index, so that the rows can
+          // be updated in place by the fused kernel
+          const auto indices = grad._indices()[0].contiguous();
+          const auto values = grad._values().contiguous();
+          const auto num_rows = indices.numel();
+          const auto block_size = num_rows ? values.numel() / num_rows : 0;
+          float* param = p.data().data_ptr<float>();
+          float* sum = state.sum().data_ptr<float>();
+          const auto num_rows_processed = caffe2::sparse_adagrad(
+              num_rows,
+              block_size,
+              p.numel(),
+              param,
+              values.data_ptr<float>(),
+              sum,
+              indices.data_ptr<int64_t>(),
+              param,
+              sum,
+              options.eps(),
+              -clr);
+          TORCH_CHECK(
+              num_rows_processed == num_rows,
+              "Sparse gradient index out of bounds for parameter of size ",
+              p.sizes());
+          continue;
+        }
+        // Uncoalesced gradients, like the ones of embeddings, are not
+        // coalesced first: the entries of each touched row are summed and only
+        // those rows are updated
+        NoGradGuard guard;
+        at::_sparse_adagrad_step(p.data(), grad, state.sum(), clr, options.eps());
       }
       else {
         state.sum(state.sum().addcmul_(grad, grad, 1.0));
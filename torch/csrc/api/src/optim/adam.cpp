@@ -7,8 +7,10 @@
 
 #include <ATen/ATen.h>
 
+#include <array>
 #include <cmath>
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -16,6 +18,48 @@ AdamOptions::AdamOptions(double learning_rate)
     : learning_rate_(learning_rate) {}
 
 void Adam::step() {
+  // Parameters with dense gradients on the GPU are stepped by the fused
+  // kernels, a few launches for all of them
+  std::vector<size_t> indices;
+  bool fused = !options.amsgrad();
+  for (size_t i = 0; i < parameters_.size(); ++i) {
+    const auto& p = parameters_[i];
+    if (p.grad().defined()) {
+      indices.push_back(i);
+      fused &= p.is_cuda() && !p.grad().is_sparse();
+    }
+  }
+  if (fused && !indices.empty()) {
+    // Parameters added later may be at a different step
+    std::map<int64_t, std::array<std::vector<Tensor>, 4>> buckets;
+    for (auto i : indices) {
+      const auto& p = parameters_[i];
+      auto& exp_average = buffer_at(exp_average_buffers, i);
+      auto& exp_average_sq = buffer_at(exp_average_sq_buffers, i);
+      auto& bucket = buckets[buffer_at(step_buffers, i) += 1];
+      bucket[0].push_back(p.data());
+      bucket[1].push_back(p.grad().data());
+      bucket[2].push_back(exp_average);
+      bucket[3].push_back(exp_average_sq);
+    }
+    NoGradGuard guard;
+    for (auto& bucket : buckets) {
+      at::_fused_adam(
+          bucket.second[0],
+          bucket.second[1],
+          bucket.second[2],
+          bucket.second[3],
+          options.learning_rate(),
+          options.beta1(),
+          options.beta2(),
+          options.eps(),
+          options.weight_decay(),
+          bucket.first,
+          /*decoupled_weight_decay=*/false);
+    }
+    return;
+  }
+
   for (size_t i = 0; i < parameters_.size(); ++i) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
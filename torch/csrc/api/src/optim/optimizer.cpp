@@ -4,6 +4,7 @@
 #include <torch/ordered_dict.h>
 #include <torch/types.h>
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,6 +38,48 @@ const std::vector<Tensor>& OptimizerParamGroup::params() const {
   return params_;
 }
 
+void OptimizerParamGroup::flatten() {
+  TORCH_CHECK(!params_.empty(), "Cannot flatten an empty param_group");
+  const auto& first = params_.front();
+  int64_t numel = 0;
+  for (const auto& param : params_) {
+    TORCH_CHECK(
+        param.layout() == kStrided,
+        "Only dense parameters can be flattened");
+    TORCH_CHECK(
+        param.scalar_type() == first.scalar_type() &&
+            param.device() == first.device(),
+        "All parameters of a flattened param_group must have the same dtype "
+        "and device, but got ", param.toString(), " on ", param.device(),
+        " and ", first.toString(), " on ", first.device());
+    numel += param.numel();
+  }
+  if (detail::flat_view(params_).defined()) {
+    return;
+  }
+
+  NoGradGuard guard;
+  const auto options =
+      TensorOptions().dtype(first.scalar_type()).device(first.device());
+  auto flat_params = at::empty({numel}, options);
+  auto flat_grads = at::zeros({numel}, options);
+  int64_t offset = 0;
+  for (auto& param : params_) {
+    auto param_slice = detail::flat_slice(flat_params, offset, param.sizes());
+    param_slice.copy_(param);
+    auto grad_slice = detail::flat_slice(flat_grads, offset, param.sizes());
+    if (param.grad().defined()) {
+      grad_slice.copy_(param.grad());
+    }
+    param.set_data(param_slice);
+    // A defined gradient is accumulated into in-place by the autograd engine,
+    // so it stays inside `flat_grads` across backward passes and
+    // `zero_grad()` calls.
+    param.grad() = grad_slice;
+    offset += param.numel();
+  }
+}
+
 std::unique_ptr<OptimizerParamState> OptimizerParamState::clone() const {
   TORCH_CHECK(false,
       "clone() has not been implemented for torch::optim::OptimizerParamState. ",
@@ -76,6 +119,42 @@ void OptimizerOptions::serialize(torch::serialize::OutputArchive& archive) const
 }
 
 namespace detail {
+Tensor flat_view(const std::vector<Tensor>& tensors) {
+  if (tensors.empty()) {
+    return Tensor();
+  }
+  const auto& first = tensors.front();
+  if (!first.defined() || first.layout() != kStrided) {
+    return Tensor();
+  }
+  const auto storage_offset = first.storage_offset();
+  int64_t numel = 0;
+  for (const auto& tensor : tensors) {
+    if (!tensor.defined() || tensor.layout() != kStrided ||
+        !tensor.is_contiguous() ||
+        tensor.scalar_type() != first.scalar_type() ||
+        tensor.device() != first.device() ||
+        !tensor.storage().is_alias_of(first.storage()) ||
+        tensor.storage_offset() != storage_offset + numel) {
+      return Tensor();
+    }
+    numel += tensor.numel();
+  }
+  return at::empty({0}, first.options())
+      .set_(first.storage(), storage_offset, {numel}, {1});
+}
+
+Tensor flat_slice(const Tensor& flat, int64_t offset, IntArrayRef sizes) {
+  std::vector<int64_t> strides(sizes.size());
+  int64_t stride = 1;
+  for (int64_t i = static_cast<int64_t>(sizes.size()) - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= std::max<int64_t>(sizes[i], 1);
+  }
+  return at::empty({0}, flat.options())
+      .set_(flat.storage(), flat.storage_offset() + offset, sizes, strides);
+}
+
 OptimizerBase::OptimizerBase(std::vector<Tensor> parameters)
     : parameters_(std::move(parameters)) {}
 
@@ -96,6 +175,12 @@ void OptimizerBase::add_param_group(const OptimizerParamGroup& param_group) {
   param_groups_.emplace_back(std::move(param_group_));
 }
 
+void OptimizerBase::flatten_param_groups() {
+  for (auto& group : param_groups_) {
+    group.flatten();
+  }
+}
+
 void OptimizerBase::add_parameters(const std::vector<Tensor>& parameters) {
   parameters_.insert(parameters_.end(), parameters.begin(), parameters.end());
 }
@@ -9,6 +9,7 @@
 
 #include <ATen/ATen.h>
 
+#include <array>
 #include <functional>
 
 namespace torch {
@@ -60,6 +61,63 @@ void SGD::step() {
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
 
+    std::vector<Tensor> params;
+    bool fused = true;
+    for (auto& p : group.params()) {
+      if (p.grad().defined()) {
+        params.push_back(p);
+        fused &= p.is_cuda() && !p.grad().is_sparse();
+      }
+    }
+    if (!params.empty() && params.size() == group.params().size()) {
+      std::vector<Tensor> grads;
+      grads.reserve(params.size());
+      for (auto& p : params) {
+        grads.push_back(p.grad());
+      }
+      auto flat_param = detail::flat_view(params);
+      auto flat_grad = detail::flat_view(grads);
+      if (flat_param.defined() && flat_grad.defined()) {
+        step_flat(params, flat_param, flat_grad, options);
+        continue;
+      }
+    }
+    if (fused && !params.empty()) {
+      // Parameters without a momentum buffer yet take their first step
+      // separately, since their buffer is set to the gradient
+      std::array<std::array<std::vector<Tensor>, 3>, 2> buckets;
+      for (auto& p : params) {
+        bool first_step = false;
+        if (momentum != 0) {
+          auto key = c10::guts::to_string(p.unsafeGetTensorImpl());
+          auto param_state = state_.find(key);
+          Tensor buf;
+          if (param_state == state_.end()) {
+            buf = torch::empty_like(p.data());
+            auto state = std::make_unique<SGDParamState>();
+            state->momentum_buffer(buf);
+            state_[key] = std::move(state);
+            first_step = true;
+          } else {
+            buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
+          }
+          buckets[first_step][2].push_back(buf);
+        }
+        buckets[first_step][0].push_back(p.data());
+        buckets[first_step][1].push_back(p.grad().data());
+      }
+      NoGradGuard guard;
+      for (int first_step = 0; first_step < 2; first_step++) {
+        auto& bucket = buckets[first_step];
+        if (!bucket[0].empty()) {
+          at::_fused_sgd(
+              bucket[0], bucket[1], bucket[2], options.lr(), momentum,
+              dampening, weight_decay, nesterov, first_step);
+        }
+      }
+      continue;
+    }
+
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -91,6 +149,72 @@ void SGD::step() {
   }
 }
 
+void SGD::step_flat(
+    const std::vector<Tensor>& params,
+    Tensor flat_param,
+    const Tensor& flat_grad,
+    const SGDOptions& options) {
+  NoGradGuard guard;
+  auto weight_decay = options.weight_decay();
+  auto momentum = options.momentum();
+  auto dampening = options.dampening();
+
+  auto d_p = flat_grad;
+  if (weight_decay != 0) {
+    d_p = d_p.add(flat_param, weight_decay);
+  }
+  if (momentum != 0) {
+    std::vector<Tensor> buffers;
+    buffers.reserve(params.size());
+    for (auto& p : params) {
+      auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+      if (param_state == state_.end()) {
+        break;
+      }
+      buffers.push_back(
+          static_cast<SGDParamState&>(*param_state->second).momentum_buffer());
+    }
+    Tensor buf;
+    if (buffers.size() == params.size()) {
+      buf = detail::flat_view(buffers);
+    }
+    if (buf.defined()) {
+      buf.mul_(momentum).add_(d_p, 1 - dampening);
+    } else {
+      // Some parameters take their first step, or their buffers were loaded
+      // from an archive, so gather all momentum buffers into one flat buffer
+      // that later steps can update at once.
+      buf = torch::empty({flat_param.numel()}, flat_param.options());
+      int64_t offset = 0;
+      for (auto& p : params) {
+        auto key = c10::guts::to_string(p.unsafeGetTensorImpl());
+        auto p_buf = detail::flat_slice(buf, offset, p.sizes());
+        auto p_d_p = detail::flat_slice(d_p, offset, p.sizes());
+        auto param_state = state_.find(key);
+        if (param_state == state_.end()) {
+          p_buf.copy_(p_d_p);
+          auto state = std::make_unique<SGDParamState>();
+          state->momentum_buffer(p_buf);
+          state_[key] = std::move(state);
+        } else {
+          auto& state = static_cast<SGDParamState&>(*param_state->second);
+          p_buf.copy_(state.momentum_buffer())
+              .mul_(momentum)
+              .add_(p_d_p, 1 - dampening);
+          state.momentum_buffer(p_buf);
+        }
+        offset += p.numel();
+      }
+    }
+    if (options.nesterov()) {
+      d_p = d_p.add(buf, momentum);
+    } else {
+      d_p = buf;
+    }
+  }
+  flat_param.add_(d_p, -1 * options.lr());
+}
+
 void SGD::add_parameters(const std::vector<Tensor>& parameters) {
   param_groups_.emplace_back(OptimizerParamGroup(parameters, defaults_->clone()));
 }
@@ -49,9 +49,10 @@ static thread_local bool checkpoint_valid = true;
 // XXX: Changes to the way multithreading works in execute should be done with
 // great care. Right now the implementation guarantees that a single function's
 // apply will never be entered concurrently (even if multiple graphs are
-// executed at the same time). Adding multiple threads per-device or removing
-// engine thread affinity to the device can break this invariant, and we depend
-// on it in a few places (e.g. AccumulateGrad function).
+// executed at the same time), unless there are multiple CPU threads, see
+// Note [CPU threads]. Adding multiple threads per-device or removing engine
+// thread affinity to the device can break this invariant, and we depend on it
+// in a few places (e.g. AccumulateGrad function).
 
 // Number of nested reentrant backwards calls currently on this thread
 static thread_local int current_depth = 0;
@@ -89,7 +90,12 @@ struct ReadyQueue {
   // might set this to false.
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
-  NodeTask pop();
+  // A reentrant thread passes the GraphTask it is waiting for. pop() returns
+  // nullopt instead of a task once that GraphTask has no outstanding tasks
+  // left and notify_completed() was called.
+  c10::optional<NodeTask> pop(
+      const std::shared_ptr<GraphTask>& awaited_task = nullptr);
+  void notify_completed();
   size_t size() const;
 };
 
@@ -122,6 +128,36 @@ struct ReadyQueue {
 //
 // When the GraphTask is finished, the parent worker thread that is waiting on
 // the task is notified and the current thread returns to the pool.
+//
+// The pool has no size limit by default, so deeply nested reentrant backwards
+// (e.g. checkpointed models) can end up starting a thread for every
+// max_recursion_depth_ levels of nesting. With
+// Engine::set_max_reentrant_threads(), once that many threads have been
+// started and none of them is idle, the current thread runs the nested
+// GraphTask itself, as it does below max_recursion_depth_, at the cost of a
+// deeper stack.
+
+// Note [CPU threads]
+// ~~~~~~~~~~~~~~~~~~
+// By default a single thread runs the CPU functions of all backward passes.
+// With Engine::set_num_cpu_threads(), several threads pop from the CPU ready
+// queue instead. Functions are still popped in the order of the queue, i.e. by
+// reentrant depth and then by sequence_nr, but functions that are ready at the
+// same time run in parallel, which helps wide graphs like many embedding
+// tables or towers of MLPs. Gradients are still accumulated into an
+// InputBuffer while holding the mutex of the GraphTask, but contributions from
+// different threads arrive in the order their producers finish.
+//
+// Two things change with multiple CPU threads:
+//
+//  1. The same function can be applied concurrently by GraphTasks that share
+//     it. AccumulateGrad takes a lock for that, other functions may not be
+//     safe for it.
+//
+//  2. A CPU thread that waits for a reentrant backward can't be woken up by
+//     a dummy task, any of the CPU threads may pop it. Instead, pop() also
+//     returns when the awaited GraphTask completes, and the thread completing
+//     a GraphTask owned by a CPU thread calls notify_completed().
 
 // Note [Streaming backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -197,17 +233,32 @@ size_t ReadyQueue::size() const {
   return heap_.size();
 }
 
-auto ReadyQueue::pop() -> NodeTask {
+auto ReadyQueue::pop(const std::shared_ptr<GraphTask>& awaited_task)
+    -> c10::optional<NodeTask> {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
-  not_empty_.wait(lock, [this]{ return !heap_.empty(); });
+  not_empty_.wait(lock, [this, &awaited_task] {
+    return !heap_.empty() ||
+        (awaited_task && awaited_task->outstanding_tasks_.load() == 0);
+  });
+  if (heap_.empty()) {
+    return c10::nullopt;
+  }
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
   return task;
 }
 
+void ReadyQueue::notify_completed() {
+  {
+    // Orders the notification after the check of a waiting thread in pop()
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  not_empty_.notify_all();
+}
+
 // This limit is based on the default python recursion limit which is 1000
-Engine::Engine() : max_recursion_depth_(100) {}
+Engine::Engine() : max_recursion_depth_(100), num_cpu_threads_(1) {}
 
 // Send shutdown tasks to all ReadyQueues if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest
@@ -222,6 +273,10 @@ Engine::~Engine() {
     for (auto& queue : ready_queues_) {
      queue->pushShutdownTask();
     }
+    // The CPU queue has a shutdown task for every CPU thread
+    for (int i = 1; !ready_queues_.empty() && i < num_cpu_threads_; ++i) {
+      ready_queues_[0]->pushShutdownTask();
+    }
   }
   // Othewise threads are leaked
 }
@@ -295,7 +350,12 @@ auto Engine::thread_main(
   // Why the test on graph_task->outstanding_tasks_?  See
   // Note [Reentrant backwards]
   while (!reentrant_thread || graph_task->outstanding_tasks_ > 0) {
-    NodeTask task = queue->pop();
+    auto popped = queue->pop(graph_task);
+    if (!popped) {
+      // Our graph_task completed on another thread, see Note [CPU threads]
+      break;
+    }
+    NodeTask task = std::move(*popped);
     // This will only work if the worker is running a non backward task
     // TODO Needs to be fixed this to work in all cases
     if (task.isShutdownTask_) {
@@ -311,8 +371,12 @@ auto Engine::thread_main(
       // Reentrant thread's graph task should not expire since we hold a
       // reference to it in this method.
       TORCH_INTERNAL_ASSERT(!reentrant_thread);
-      LOG(INFO) << "GraphTask for function " << task.fn_->name()
-                << " is no longer valid, skipping execution";
+      // A dummy task may outlive the GraphTask it was sent for when the owner
+      // got woken up by pop() already.
+      if (task.fn_) {
+        LOG(INFO) << "GraphTask for function " << task.fn_->name()
+                  << " is no longer valid, skipping execution";
+      }
       continue;
     }
 
@@ -338,13 +402,17 @@ auto Engine::thread_main(
     }
 
     auto base_owner = local_graph_task->owner_;
-    // Send a dummy function task to the owning thread just to
-    // ensure that it's not sleeping. If it has work, it might see that
-    // graph_task->outstanding_tasks_ == 0 before it gets to the task, but
-    // it's a no-op anyway.
-    // This is not necessary if the owning thread is not a device thread or the
-    // current thread is the owning thread.
-    if (base_owner != NO_DEVICE && base_owner != worker_device &&
+    if (base_owner == -1 && num_cpu_threads_ > 1 && gt_completed) {
+      // Any CPU thread might be the owner, see Note [CPU threads]
+      ready_queue_by_index(base_owner).notify_completed();
+    } else if (
+        // Send a dummy function task to the owning thread just to
+        // ensure that it's not sleeping. If it has work, it might see that
+        // graph_task->outstanding_tasks_ == 0 before it gets to the task, but
+        // it's a no-op anyway.
+        // This is not necessary if the owning thread is not a device thread
+        // or the current thread is the owning thread.
+        base_owner != NO_DEVICE && base_owner != worker_device &&
         gt_completed) {
       // Synchronize outstanding_tasks_ with queue mutex
       std::atomic_thread_fence(std::memory_order_release);
@@ -545,11 +613,16 @@ void Engine::evaluate_function(
   if (!exec_info_.empty()) {
     auto& fn_info = exec_info_.at(func);
     if (auto* capture_vec = fn_info.captures_.get()) {
-      // Lock mutex for writing to graph_task->captured_vars_.
-      std::lock_guard<std::mutex> lock(graph_task->mutex_);
-      for (auto capture : *capture_vec) {
+      for (const auto& capture : *capture_vec) {
+        at::Tensor captured_grad = inputs[capture.input_idx_];
+        // The hooks run without the lock, they may do a lot of work.
+        for (const auto& hook : capture.hooks_) {
+          captured_grad = (*hook)(captured_grad);
+        }
+        // Lock mutex for writing to graph_task->captured_vars_.
+        std::lock_guard<std::mutex> lock(graph_task->mutex_);
         graph_task->captured_vars_[capture.output_idx_] =
-            inputs[capture.input_idx_];
+            std::move(captured_grad);
       }
     }
     if (!fn_info.needed_) {
@@ -751,10 +824,11 @@ std::shared_ptr<FutureVariableList> Engine::execute_with_graph_task(
     return graph_task->future_result_;
   } else {
     graph_task->owner_ = worker_device;
-    if (current_depth >= max_recursion_depth_) {
-      // See Note [Reentrant backwards]
-      // If reached the max depth, switch to a different thread
-      add_thread_pool_task(graph_task);
+    // See Note [Reentrant backwards]
+    // If reached the max depth, switch to a different thread, unless the
+    // pool has no thread left to give
+    if (current_depth >= max_recursion_depth_ &&
+        add_thread_pool_task(graph_task)) {
       // graph_task_exec_post_processing is done when the Future is marked as
       // completed in mark_graph_task_completed.
       return graph_task->future_result_;
@@ -915,12 +989,49 @@ auto Engine::start_threads() -> void {
   }
 }
 
-void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
+void Engine::set_num_cpu_threads(int num_threads) {
+  TORCH_CHECK(
+      num_threads >= 1,
+      "The autograd engine needs at least one CPU thread, got ",
+      num_threads);
+  std::call_once(start_threads_flag_, &Engine::start_threads, this);
+  std::lock_guard<std::mutex> lock(cpu_threads_mutex_);
+  TORCH_CHECK(
+      num_threads >= num_cpu_threads_,
+      "The number of CPU threads of the autograd engine can only grow, it is ",
+      num_cpu_threads_.load(),
+      " but got ",
+      num_threads);
+  // The first CPU thread was started by start_threads()
+  for (; num_cpu_threads_ < num_threads; ++num_cpu_threads_) {
+    std::thread t(&Engine::thread_init, this, -1);
+    t.detach();
+  }
+}
+
+void Engine::set_max_reentrant_threads(int num_threads) {
+  TORCH_CHECK(
+      num_threads >= 0,
+      "The maximum number of reentrant threads can't be negative, got ",
+      num_threads);
+  std::call_once(start_threads_flag_, &Engine::start_threads, this);
+  std::lock_guard<std::mutex> lock(thread_pool_shared_->mutex_);
+  thread_pool_shared_->max_threads_ = num_threads;
+}
+
+bool Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   std::unique_lock<std::mutex> lck(thread_pool_shared_->mutex_);
   // There may already be some items on the graphtasks_queue_ added by other
   // threads but not enough workers to get to the the new task that will be
   // added
   bool create_thread = (thread_pool_shared_->num_workers_ <= thread_pool_shared_->graphtasks_queue_.size());
+  if (create_thread) {
+    if (thread_pool_shared_->num_threads_ >= thread_pool_shared_->max_threads_) {
+      // The caller runs the GraphTask itself
+      return false;
+    }
+    ++thread_pool_shared_->num_threads_;
+  }
   thread_pool_shared_->graphtasks_queue_.push(graph_task);
   // Don't need to be holding the lock while actually creating the thread
   lck.unlock();
@@ -931,6 +1042,7 @@ void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   // This works even if new thread is created because wait() will test the
   // predicate before waiting
   thread_pool_shared_->work_.notify_one();
+  return true;
 }
 
 void GraphTask::init_to_execute(Node& graph_root, const edge_list& outputs) {
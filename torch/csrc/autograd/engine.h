@@ -14,6 +14,7 @@
 #include <deque>
 #include <exception>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <unordered_map>
@@ -59,6 +60,16 @@ struct GraphTask {
           : input_idx_(input_idx), output_idx_(output_idx) {}
       int input_idx_; // within Node inputs
       int output_idx_; // within the output vector of a GraphTask
+
+      // Called with the captured grad as soon as it is computed, before it is
+      // stored in the output vector. A hook can consume the grad (e.g. the
+      // distributed engine accumulates it right away) and return the grad to
+      // store instead.
+      struct GradCaptureHook {
+        virtual ~GradCaptureHook() = default;
+        virtual at::Tensor operator()(const at::Tensor& grad) = 0;
+      };
+      std::vector<std::unique_ptr<GradCaptureHook>> hooks_;
     };
 
     bool should_execute() const {
@@ -197,6 +208,17 @@ struct TORCH_API Engine {
 
   size_t ready_queue_size(at::Device device);
 
+  // Sets the number of threads that run the CPU functions of all backward
+  // passes, pulling from the same ready queue. The default is one. The number
+  // can only grow. See Note [CPU threads]
+  void set_num_cpu_threads(int num_threads);
+
+  // Sets how many threads may be started to run reentrant backward passes
+  // nested deeper than max_recursion_depth_. Once that many threads are busy,
+  // deeper reentrant backward passes run on the thread that started them. The
+  // default is no limit. See Note [Reentrant backwards]
+  void set_max_reentrant_threads(int num_threads);
+
  protected:
   void compute_dependencies(Node* root, GraphTask& task);
   void evaluate_function(
@@ -215,7 +237,7 @@ struct TORCH_API Engine {
       const std::shared_ptr<GraphTask>& task,
       bool reentrant_thread);
   void reentrant_thread_init();
-  void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  bool add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
   void set_device(int device);
 
   // Ensures ready_queues_ are initialized only once
@@ -227,6 +249,10 @@ struct TORCH_API Engine {
   std::mutex post_callbacks_lock_;
   // How many nested reentrant calls are allowed until a new thread is used
   int max_recursion_depth_;
+  // The number of threads working on the CPU ready queue
+  std::atomic<int> num_cpu_threads_;
+  // To protect starting additional CPU threads
+  std::mutex cpu_threads_mutex_;
 
   struct ThreadPoolShared {
     // Data structures used by the threads for executing reentrant backwards
@@ -241,8 +267,14 @@ struct TORCH_API Engine {
     // Workers will process the GraphTasks added to this queue. A GraphTask is
     // allocated inside Engine::execute and lives for the duration of execute
     std::queue<std::weak_ptr<GraphTask>> graphtasks_queue_;
-
-    ThreadPoolShared() : num_workers_(0) {}
+    // Number of threads started so far and the most that may be started
+    unsigned int num_threads_;
+    unsigned int max_threads_;
+
+    ThreadPoolShared()
+        : num_workers_(0),
+          num_threads_(0),
+          max_threads_(std::numeric_limits<unsigned int>::max()) {}
  };
 
  // Temporary workaround until shutting down threads is done
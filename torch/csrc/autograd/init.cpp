@@ -1,11 +1,18 @@
 #include <torch/csrc/python_headers.h>
 
+#include <ATen/autocast_mode.h>
+
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/utils/pybind.h>
+#include <torch/csrc/utils/python_numbers.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_histograms.h>
+#include <torch/csrc/autograd/profiler_perf.h>
 #include <torch/csrc/autograd/python_function.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/saved_variable.h>
+#include <torch/csrc/autograd/static_graph.h>
 
 PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   using namespace torch::autograd::profiler;
@@ -33,10 +40,19 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .value("Disabled", ProfilerState::Disabled)
       .value("CPU", ProfilerState::CPU)
       .value("CUDA", ProfilerState::CUDA)
-      .value("NVTX", ProfilerState::NVTX);
+      .value("NVTX", ProfilerState::NVTX)
+      .value("CUPTI", ProfilerState::CUPTI);
 
   py::class_<ProfilerConfig>(m, "ProfilerConfig")
-      .def(py::init<ProfilerState, bool>());
+      .def(py::init<ProfilerState, bool>())
+      .def(py::init<ProfilerState, bool, bool>())
+      .def(py::init<ProfilerState, bool, bool, std::string>())
+      .def(py::init<
+           ProfilerState,
+           bool,
+           bool,
+           std::string,
+           std::vector<std::string>>());
 
   py::class_<Event>(m, "ProfilerEvent")
       .def("kind", &Event::kind)
@@ -46,19 +62,106 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .def("cpu_elapsed_us", &Event::cpu_elapsed_us)
       .def("cuda_elapsed_us", &Event::cuda_elapsed_us)
       .def("has_cuda", &Event::has_cuda)
-      .def("shapes", &Event::shapes);
+      .def("shapes", &Event::shapes)
+      .def("cpu_memory_usage", &Event::cpu_memory_usage)
+      .def("cuda_memory_usage", &Event::cuda_memory_usage)
+      .def("correlation_id", &Event::correlation_id)
+      .def("perf_counters", &Event::perf_counters)
+      .def("cpu_ns", &Event::cpu_ns);
+
+  py::class_<CUDAActivity>(m, "CUDAActivity")
+      .def_readonly("kind", &CUDAActivity::kind)
+      .def_readonly("name", &CUDAActivity::name)
+      .def_readonly("device", &CUDAActivity::device)
+      .def_readonly("stream", &CUDAActivity::stream)
+      .def_readonly("start_ns", &CUDAActivity::start_ns)
+      .def_readonly("end_ns", &CUDAActivity::end_ns)
+      .def_readonly("correlation_id", &CUDAActivity::correlation_id);
 
   m.def("_enable_profiler", enableProfiler);
   m.def("_disable_profiler", disableProfiler);
   m.def("_profiler_enabled", profilerEnabled);
+  m.def("_get_cuda_activities", getCUDAActivities);
+  m.def("_cupti_enabled", cuptiEnabled);
+  m.def("_perf_event_names", perfEventNames);
+  m.def("_perf_events_available", perfEventsAvailable);
 
   m.def("_push_range", [](std::string name) { pushRange(std::move(name)); });
   m.def("_pop_range", []() { popRange(); });
   m.def("_run_before_callbacks", runBeforeCallbacks);
 
+  py::class_<OpHistogram>(m, "_OpHistogram")
+      .def_readonly("count", &OpHistogram::count)
+      .def_readonly("total_ns", &OpHistogram::total_ns)
+      .def_readonly("buckets", &OpHistogram::buckets);
+
+  m.def(
+      "_enable_op_histograms",
+      enableOpHistograms,
+      py::arg("sampling_probability") = 1.0);
+  m.def("_disable_op_histograms", disableOpHistograms);
+  m.def("_op_histograms_enabled", opHistogramsEnabled);
+  m.def("_get_op_histograms", getOpHistograms);
+  m.def("_reset_op_histograms", resetOpHistograms);
+
   py::class_<RecordFunction, std::shared_ptr<RecordFunction>>(m, "_RecordFunction")
     .def(py::init<>());
 
+  using torch::autograd::StaticGraph;
+  py::class_<StaticGraph, std::shared_ptr<StaticGraph>>(m, "_StaticGraph")
+      .def(
+          py::init([](const std::vector<at::Tensor>& tensors,
+                      const std::vector<at::Tensor>& inputs) {
+            torch::autograd::edge_list roots;
+            for (const auto& tensor : tensors) {
+              auto gradient_edge = torch::autograd::impl::gradient_edge(tensor);
+              TORCH_CHECK(
+                  gradient_edge.function,
+                  "One of the tensors does not require grad and does not ",
+                  "have a grad_fn");
+              roots.push_back(std::move(gradient_edge));
+            }
+            torch::autograd::edge_list outputs;
+            for (const auto& input : inputs) {
+              TORCH_CHECK(
+                  input.requires_grad(),
+                  "One of the differentiated Tensors does not require grad");
+              auto grad_fn = input.grad_fn();
+              if (!grad_fn) {
+                grad_fn = torch::autograd::impl::try_get_grad_accumulator(input);
+              }
+              if (!grad_fn) {
+                outputs.emplace_back();
+              } else {
+                outputs.emplace_back(grad_fn, input.output_nr());
+              }
+            }
+            return std::make_shared<StaticGraph>(
+                std::move(roots), std::move(outputs));
+          }))
+      .def(
+          "run",
+          &StaticGraph::run,
+          py::arg("grad_tensors"),
+          py::arg("create_graph") = false,
+          py::call_guard<py::gil_scoped_release>())
+      .def("is_static", &StaticGraph::is_static)
+      .def("num_functions", &StaticGraph::num_functions);
+
+  using torch::autograd::CPUOffloadHooks;
+  using torch::autograd::SavedVariableHooks;
+  py::class_<SavedVariableHooks, std::shared_ptr<SavedVariableHooks>>(
+      m, "_SavedVariableHooks");
+  py::class_<
+      CPUOffloadHooks,
+      SavedVariableHooks,
+      std::shared_ptr<CPUOffloadHooks>>(m, "_CPUOffloadHooks")
+      .def(py::init<int64_t>(), py::arg("device_budget") = 0)
+      .def("device_bytes", &CPUOffloadHooks::device_bytes)
+      .def("offloaded_bytes", &CPUOffloadHooks::offloaded_bytes);
+  m.def("_get_saved_variable_hooks", &SavedVariableHooks::get);
+  m.def("_set_saved_variable_hooks", &SavedVariableHooks::set);
+
   Py_RETURN_TRUE;
 }
 
@@ -104,12 +207,56 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autocast_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  at::autocast::set_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autocast_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (at::autocast::is_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * clear_autocast_cache(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  at::autocast::clear_cache();
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * autocast_increment_nesting(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return THPUtils_packInt64(at::autocast::increment_nesting());
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * autocast_decrement_nesting(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return THPUtils_packInt64(at::autocast::decrement_nesting());
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_set_autocast_enabled", (PyCFunction)set_autocast_enabled, METH_O, nullptr},
+  {"_is_autocast_enabled", (PyCFunction)is_autocast_enabled, METH_NOARGS, nullptr},
+  {"_clear_autocast_cache", (PyCFunction)clear_autocast_cache, METH_NOARGS, nullptr},
+  {"_autocast_increment_nesting", (PyCFunction)autocast_increment_nesting, METH_NOARGS, nullptr},
+  {"_autocast_decrement_nesting", (PyCFunction)autocast_decrement_nesting, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
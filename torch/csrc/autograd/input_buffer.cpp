@@ -11,6 +11,18 @@
 
 namespace torch { namespace autograd {
 
+  // Whether the dense `var` can be added to the dense `old_var` in place,
+  // without anything else seeing the change.
+  static bool can_accumulate_inplace(const Variable& old_var, const Variable& var) {
+    return old_var.layout() == at::kStrided && var.layout() == at::kStrided
+        && !old_var.requires_grad() && !var.requires_grad()
+        && old_var.scalar_type() == var.scalar_type()
+        && old_var.sizes() == var.sizes()
+        && old_var.is_contiguous() && var.is_contiguous()
+        && old_var.use_count() == 1
+        && old_var.storage().use_count() == 1;
+  }
+
   static void accumulate(std::vector<Variable>& buffer,
                          const size_t pos,
                          Variable&& var) {
@@ -28,6 +40,10 @@ namespace torch { namespace autograd {
     } else {
       if (var.is_sparse() && !old_var.is_sparse() && old_var.is_contiguous() && old_var.storage().use_count() == 1) {
           buffer[pos] = old_var.add_(var);
+      } else if (can_accumulate_inplace(old_var, var)) {
+          // The buffer holds the only reference to old_var, summing into it
+          // saves allocating the sum.
+          old_var.add_(var);
       } else {
           buffer[pos] = old_var + var;
       }
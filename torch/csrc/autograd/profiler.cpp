@@ -1,6 +1,10 @@
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_perf.h>
 #include <torch/csrc/jit/code_template.h>
+#include <torch/csrc/utils/memory.h>
 
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <list>
 #include <mutex>
@@ -28,6 +32,48 @@ std::unordered_map<uint16_t, std::shared_ptr<RangeEventList>>
     all_event_lists_map;
 thread_local std::shared_ptr<RangeEventList> event_list;
 thread_local uint16_t thread_id;
+// The correlation ids of ranges start at 1, 0 meaning no range
+std::atomic<uint64_t> next_correlation_id{1};
+std::vector<CUDAActivity> cuda_activities;
+
+// Writes the events of the thread event lists to the trace file of the
+// profiler, as described for writeTraceEvents
+struct TraceWriter {
+  explicit TraceWriter(const std::string& path)
+      : out_(path, std::ios::binary) {
+    TORCH_CHECK(out_, "could not open profiler trace file ", path);
+    int64_t start_ns = getTime();
+    out_.write("PTTRACE1", 8);
+    writeValue(start_ns);
+  }
+
+  void write(const std::vector<Event>& events) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const Event& e : events) {
+      writeValue(static_cast<uint8_t>(e.eventKind()));
+      writeValue(e.thread_id());
+      writeValue(e.cpu_ns());
+      uint32_t name_size = strlen(e.name());
+      writeValue(name_size);
+      out_.write(e.name(), name_size);
+      if (e.eventKind() == EventKind::MemoryAlloc) {
+        writeValue(e.cpu_memory_usage());
+        writeValue(e.cuda_memory_usage());
+      }
+    }
+    TORCH_CHECK(out_, "could not write profiler trace file");
+  }
+
+ private:
+  template <typename T>
+  void writeValue(T value) {
+    out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  std::mutex mutex_;
+  std::ofstream out_;
+};
+std::unique_ptr<TraceWriter> trace_writer;
 
 uint16_t getThreadId() {
   return thread_id;
@@ -60,6 +106,22 @@ void mark(std::string name, bool include_cuda /* = true */) {
   }
 }
 
+// Records the allocations and frees of the allocators, while memory is
+// profiled, in the event list of the thread that makes them. They are
+// attributed to the ranges open on that thread when the events are parsed.
+void reportMemoryUsage(
+    void* /* unused */,
+    int64_t alloc_size,
+    c10::Device device) {
+  if (state == ProfilerState::Disabled || state == ProfilerState::NVTX) {
+    return;
+  }
+  RangeEventList& list = getEventList();
+  Event& evt =
+      list.record(EventKind::MemoryAlloc, StringView(""), thread_id, false);
+  evt.updateMemoryStats(alloc_size, device);
+}
+
 bool profilerEnabled() {
   return state != ProfilerState::Disabled;
 }
@@ -101,12 +163,24 @@ void pushRangeImpl(
       cuda_stubs->nvtxRangePushA(name.str());
     }
   } else {
-    getEventList().record(
+    Event& evt = getEventList().record(
         EventKind::PushRange,
         name,
         thread_id,
         state == ProfilerState::CUDA,
         std::move(shapes));
+    if (state == ProfilerState::CUPTI) {
+      uint64_t correlation_id = next_correlation_id++;
+      evt.setCorrelationId(correlation_id);
+      cuda_stubs->pushCorrelationId(correlation_id);
+    }
+    // Read last, and first when the range is popped, to leave the profiler
+    // out of the counts of the range
+    if (perfEventsEnabled()) {
+      std::vector<int64_t> counts;
+      readPerfCounters(counts);
+      evt.setPerfCounters(std::move(counts));
+    }
   }
 }
 
@@ -121,11 +195,19 @@ void popRange() {
   if (state == ProfilerState::NVTX) {
     cuda_stubs->nvtxRangePop();
   } else {
-    getEventList().record(
+    std::vector<int64_t> counts;
+    if (perfEventsEnabled()) {
+      readPerfCounters(counts);
+    }
+    Event& evt = getEventList().record(
         EventKind::PopRange,
         StringView(""),
         thread_id,
         state == ProfilerState::CUDA);
+    evt.setPerfCounters(std::move(counts));
+    if (state == ProfilerState::CUPTI) {
+      cuda_stubs->popCorrelationId();
+    }
   }
 }
 
@@ -134,9 +216,29 @@ void enableProfiler(ProfilerConfig config) {
   AT_ASSERT(new_state != ProfilerState::Disabled);
   if (new_state == ProfilerState::NVTX && !cuda_stubs->enabled())
     throw std::runtime_error("Can't use NVTX profiler - PyTorch was compiled without CUDA");
+  if (new_state == ProfilerState::CUPTI && !cuda_stubs->cuptiEnabled())
+    throw std::runtime_error("Can't use CUPTI profiler - PyTorch was compiled without CUPTI");
   if (state != ProfilerState::Disabled && new_state != state) {
     throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
+  if (!config.trace_path.empty()) {
+    // CUDA events are only timed once the profiler is disabled
+    TORCH_CHECK(
+        new_state == ProfilerState::CPU,
+        "Can only stream the events of the CPU profiler to a trace file");
+    TORCH_CHECK(
+        config.perf_events.empty(),
+        "Can't stream the counts of perf events to a trace file");
+    if (state == ProfilerState::Disabled) {
+      trace_writer = torch::make_unique<TraceWriter>(config.trace_path);
+    }
+  }
+  if (!config.perf_events.empty()) {
+    TORCH_CHECK(
+        new_state != ProfilerState::NVTX,
+        "Can't count perf events with the NVTX profiler");
+    enablePerfEvents(config.perf_events);
+  }
 
   pushCallback(
       [config](const RecordFunction& fn) {
@@ -180,6 +282,8 @@ void enableProfiler(ProfilerConfig config) {
                 fn.getThreadId());
 
             auto& eventList = eventListIter->second;
+            // The correlation id of the range can't be popped from here, as
+            // CUPTI keeps them per thread
             eventList->record(
                       EventKind::PopRange,
                       StringView(""),
@@ -191,7 +295,14 @@ void enableProfiler(ProfilerConfig config) {
         }
       },
       config.report_input_shapes);
+  if (new_state == ProfilerState::CUPTI && state != ProfilerState::CUPTI) {
+    cuda_activities.clear();
+    cuda_stubs->enableActivityTracing();
+  }
   state = new_state;
+  if (config.profile_memory && state != ProfilerState::NVTX) {
+    c10::SetMemoryReporter(&reportMemoryUsage);
+  }
 
   if(state == ProfilerState::CUDA) {
     // event recording appears to have some startup overhead, so we need to
@@ -220,9 +331,14 @@ thread_event_lists disableProfiler() {
   ProfilerState old_state = state;
   mark("__stop_profile");
 
+  c10::SetMemoryReporter(nullptr);
   popCallback();
   state = ProfilerState::Disabled;
+  disablePerfEvents();
 
+  if (old_state == ProfilerState::CUPTI) {
+    cuda_activities = cuda_stubs->disableActivityTracing();
+  }
   if (old_state == ProfilerState::NVTX) {
     return thread_event_lists();
   } else {
@@ -230,7 +346,11 @@ thread_event_lists disableProfiler() {
     std::lock_guard<std::mutex> guard(all_event_lists_map_mutex);
     for (auto it = all_event_lists_map.begin(); it != all_event_lists_map.end();) {
       auto & list = it->second;
-      result.emplace_back(list->consolidate());
+      if (trace_writer) {
+        trace_writer->write(list->consolidate());
+      } else {
+        result.emplace_back(list->consolidate());
+      }
       // GC lists that are not held by any threads
       if (list.use_count() == 1) {
         auto current_it = it;
@@ -240,10 +360,28 @@ thread_event_lists disableProfiler() {
         ++it;
       }
     }
+    trace_writer.reset();
     return result;
   }
 }
 
+bool writeTraceEvents(std::vector<Event>& events) {
+  if (!trace_writer) {
+    return false;
+  }
+  trace_writer->write(events);
+  events.clear();
+  return true;
+}
+
+std::vector<CUDAActivity> getCUDAActivities() {
+  return cuda_activities;
+}
+
+bool cuptiEnabled() {
+  return cuda_stubs->cuptiEnabled();
+}
+
 void Event::record(bool record_cuda) {
   if (record_cuda) {
     cuda_stubs->record(&device_, &event, &cpu_ns_);
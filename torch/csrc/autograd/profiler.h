@@ -27,6 +27,20 @@ namespace profiler {
 
 TORCH_API uint16_t getThreadId();
 
+// A kernel, memcpy or memset run on a CUDA device, as traced by CUPTI
+struct TORCH_API CUDAActivity {
+  std::string kind;
+  std::string name;
+  int device;
+  uint32_t stream;
+  // On the clock of getTime
+  int64_t start_ns;
+  int64_t end_ns;
+  // The correlation id of the innermost range open on the thread that
+  // launched it, or 0 if there was none
+  uint64_t correlation_id;
+};
+
 struct TORCH_API CUDAStubs {
   virtual void record(int* device, CUDAEventStub* event, int64_t* cpu_ns) {
     fail();
@@ -53,6 +67,25 @@ struct TORCH_API CUDAStubs {
   virtual void synchronize() {
     fail();
   }
+  // Whether the CUPTI activity tracing below is available
+  virtual bool cuptiEnabled() {
+    return false;
+  }
+  virtual void enableActivityTracing() {
+    fail();
+  }
+  virtual std::vector<CUDAActivity> disableActivityTracing() {
+    fail();
+    return {};
+  }
+  // Attributes the CUDA work launched by the current thread to the range with
+  // the given correlation id, until it is popped
+  virtual void pushCorrelationId(uint64_t correlation_id) {
+    fail();
+  }
+  virtual void popCorrelationId() {
+    fail();
+  }
   virtual ~CUDAStubs();
 
 private:
@@ -104,20 +137,37 @@ enum class TORCH_API ProfilerState {
     CPU, // CPU-only profiling
     CUDA, // CPU + CUDA events
     NVTX,  // only emit NVTX markers
+    CUPTI, // CPU events + CUDA activities traced by CUPTI
 };
 
 struct TORCH_API ProfilerConfig {
-  ProfilerConfig(ProfilerState state, bool report_input_shapes)
-      : state(state), report_input_shapes(report_input_shapes) {}
+  ProfilerConfig(
+      ProfilerState state,
+      bool report_input_shapes,
+      bool profile_memory = false,
+      std::string trace_path = "",
+      std::vector<std::string> perf_events = {})
+      : state(state),
+        report_input_shapes(report_input_shapes),
+        profile_memory(profile_memory),
+        trace_path(std::move(trace_path)),
+        perf_events(std::move(perf_events)) {}
   ~ProfilerConfig();
   ProfilerState state;
   bool report_input_shapes;
+  // Records the allocations and frees of the CPU and CUDA allocators
+  bool profile_memory;
+  // If set, the events are streamed to this file, see writeTraceEvents
+  std::string trace_path;
+  // The hardware counters read around every range, see profiler_perf.h
+  std::vector<std::string> perf_events;
 };
 
 enum class TORCH_API EventKind : uint16_t {
   Mark,
   PushRange,
-  PopRange
+  PopRange,
+  MemoryAlloc,
 };
 #ifndef _MSC_VER
 #  pragma GCC diagnostic pop
@@ -138,11 +188,15 @@ struct TORCH_API Event final {
   }
 
   void record(bool record_cuda);
+  EventKind eventKind() const {
+    return kind_;
+  }
   std::string kind() const {
     switch(kind_) {
       case EventKind::Mark: return "mark";
       case EventKind::PushRange: return "push";
       case EventKind::PopRange: return "pop";
+      case EventKind::MemoryAlloc: return "memory_alloc";
     }
     throw std::runtime_error("unknown EventKind");
   }
@@ -155,6 +209,9 @@ struct TORCH_API Event final {
   std::vector<std::vector<int64_t>> shapes() const {
     return shapes_;
   }
+  int64_t cpu_ns() const {
+    return cpu_ns_;
+  }
   double cpu_elapsed_us(const Event & e) {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
   }
@@ -165,6 +222,35 @@ struct TORCH_API Event final {
   int device() const {
     return device_;
   }
+  // Records an allocation of alloc_size bytes, or a free when it is negative
+  void updateMemoryStats(int64_t alloc_size, c10::Device device) {
+    if (device.type() == c10::DeviceType::CUDA) {
+      cuda_memory_usage_ = alloc_size;
+      device_ = device.index();
+    } else {
+      cpu_memory_usage_ = alloc_size;
+    }
+  }
+  int64_t cpu_memory_usage() const {
+    return cpu_memory_usage_;
+  }
+  int64_t cuda_memory_usage() const {
+    return cuda_memory_usage_;
+  }
+  void setCorrelationId(uint64_t correlation_id) {
+    correlation_id_ = correlation_id;
+  }
+  uint64_t correlation_id() const {
+    return correlation_id_;
+  }
+  // The counts of the perf events of the profiler when the event was
+  // recorded, empty if they weren't counted
+  void setPerfCounters(std::vector<int64_t>&& counts) {
+    perf_counters_ = std::move(counts);
+  }
+  const std::vector<int64_t>& perf_counters() const {
+    return perf_counters_;
+  }
 private:
   // signed to allow for negative intervals, initialized for safety.
   int64_t cpu_ns_ = 0;
@@ -172,10 +258,28 @@ private:
   EventKind kind_;
   uint16_t thread_id_;
   std::vector<std::vector<int64_t>> shapes_;
+  int64_t cpu_memory_usage_ = 0;
+  int64_t cuda_memory_usage_ = 0;
+  uint64_t correlation_id_ = 0;
+  std::vector<int64_t> perf_counters_;
   int device_ = -1;
   struct CUevent_st* event = nullptr;
 };
 
+// When the profiler streams its events to a file, writes events to it and
+// clears them, so that the thread event lists keep a single block. Returns
+// false when the events are kept in memory instead.
+//
+// The file starts with the 8 bytes "PTTRACE1" and the time the profiler was
+// enabled, followed by the events of every thread, each thread's in order:
+//
+//   uint8 kind, uint16 thread id, int64 time, uint32 name size, name,
+//   and for memory events, int64 CPU and CUDA memory usage
+//
+// with the integers in native byte order and the times in ns on the clock of
+// getTime. torch.autograd.profiler.convert_trace turns it into a Chrome trace.
+TORCH_API bool writeTraceEvents(std::vector<Event>& events);
+
 // a linked-list of fixed sized vectors, to avoid
 // a std::vector resize from taking a large amount of time inside
 // a profiling  event
@@ -201,11 +305,15 @@ struct RangeEventList {
   }
 
   template<typename... Args>
-  void record(Args&&... args) {
-    if (blocks.empty() || blocks.front().size() == num_block_elements) {
+  Event& record(Args&&... args) {
+    if (blocks.empty()) {
+      allocBlock();
+    } else if (blocks.front().size() == num_block_elements &&
+               !writeTraceEvents(blocks.front())) {
       allocBlock();
     }
     blocks.front().emplace_back(std::forward<Args>(args)...);
+    return blocks.front().back();
   }
 
   std::vector<Event> consolidate() {
@@ -233,6 +341,10 @@ using thread_event_lists = std::vector<std::vector<Event>>;
 TORCH_API void enableProfiler(ProfilerConfig);
 TORCH_API thread_event_lists disableProfiler();
 TORCH_API bool profilerEnabled();
+// The CUDA activities traced by the last CUPTI profiling session, collected
+// when it was disabled
+TORCH_API std::vector<CUDAActivity> getCUDAActivities();
+TORCH_API bool cuptiEnabled();
 
 
 // Usage:
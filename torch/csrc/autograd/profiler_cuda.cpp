@@ -1,8 +1,15 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <c10/cuda/CUDAGuard.h>
 #include <nvToolsExt.h>
+#ifdef USE_CUPTI
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Type.h>
+#include <cupti.h>
+#endif
 
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 namespace torch { namespace autograd { namespace profiler {
 
@@ -31,6 +38,129 @@ static inline void cudaCheck(cudaError_t result, const char * file, int line) {
 }
 #define TORCH_CUDA_CHECK(result) cudaCheck(result,__FILE__,__LINE__);
 
+#ifdef USE_CUPTI
+static inline void cuptiCheck(CUptiResult result, const char * file, int line) {
+  if(result != CUPTI_SUCCESS) {
+    const char* message = nullptr;
+    cuptiGetResultString(result, &message);
+    std::stringstream ss;
+    ss << file << ":" << line << ": " << message;
+    throw std::runtime_error(ss.str());
+  }
+}
+#define TORCH_CUPTI_CHECK(result) cuptiCheck(result,__FILE__,__LINE__);
+
+// CUPTI writes the activity records into buffers it asks for, and hands them
+// back once they are full or flushed
+constexpr size_t kActivityBufferSize = 8 * 1024 * 1024;
+
+const CUpti_ActivityKind kTracedActivities[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL,
+    CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,
+    CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION,
+};
+
+struct ActivityTrace {
+  std::mutex mutex;
+  // Their correlation ids are the ones of the CUDA API calls that launched
+  // them until tracing is disabled
+  std::vector<CUDAActivity> activities;
+  // The correlation ids of the ranges open when CUDA API calls were made
+  std::unordered_map<uint32_t, uint64_t> range_correlation_ids;
+  // getTime() - cuptiGetTimestamp()
+  int64_t clock_offset_ns = 0;
+};
+
+ActivityTrace& activityTrace() {
+  static ActivityTrace trace;
+  return trace;
+}
+
+const char* memcpyName(uint8_t copy_kind) {
+  switch (copy_kind) {
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD: return "Memcpy HtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH: return "Memcpy DtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD: return "Memcpy DtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOH: return "Memcpy HtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP: return "Memcpy PtoP";
+    default: return "Memcpy";
+  }
+}
+
+void CUPTIAPI bufferRequested(
+    uint8_t** buffer,
+    size_t* size,
+    size_t* max_num_records) {
+  // alloc_cpu aligns the buffer as CUPTI requires
+  *buffer = static_cast<uint8_t*>(c10::alloc_cpu(kActivityBufferSize));
+  *size = kActivityBufferSize;
+  *max_num_records = 0;
+}
+
+void CUPTIAPI bufferCompleted(
+    CUcontext context,
+    uint32_t stream_id,
+    uint8_t* buffer,
+    size_t size,
+    size_t valid_size) {
+  ActivityTrace& trace = activityTrace();
+  std::lock_guard<std::mutex> guard(trace.mutex);
+  CUpti_Activity* record = nullptr;
+  while (cuptiActivityGetNextRecord(buffer, valid_size, &record) ==
+         CUPTI_SUCCESS) {
+    switch (record->kind) {
+      case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+        auto* kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+        trace.activities.push_back(CUDAActivity{
+            "kernel",
+            c10::demangle(kernel->name),
+            static_cast<int>(kernel->deviceId),
+            kernel->streamId,
+            static_cast<int64_t>(kernel->start),
+            static_cast<int64_t>(kernel->end),
+            kernel->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMCPY: {
+        auto* copy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+        trace.activities.push_back(CUDAActivity{
+            "memcpy",
+            memcpyName(copy->copyKind),
+            static_cast<int>(copy->deviceId),
+            copy->streamId,
+            static_cast<int64_t>(copy->start),
+            static_cast<int64_t>(copy->end),
+            copy->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_MEMSET: {
+        auto* fill = reinterpret_cast<CUpti_ActivityMemset*>(record);
+        trace.activities.push_back(CUDAActivity{
+            "memset",
+            "Memset",
+            static_cast<int>(fill->deviceId),
+            fill->streamId,
+            static_cast<int64_t>(fill->start),
+            static_cast<int64_t>(fill->end),
+            fill->correlationId});
+        break;
+      }
+      case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+        auto* correlation =
+            reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+        trace.range_correlation_ids[correlation->correlationId] =
+            correlation->externalId;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  c10::free_cpu(buffer);
+}
+#endif
+
 struct CUDAMethods : public CUDAStubs {
   void record(int* device, CUDAEventStub* event, int64_t* cpu_ns) override {
     TORCH_CUDA_CHECK(cudaGetDevice(device));
@@ -69,6 +199,52 @@ struct CUDAMethods : public CUDAStubs {
   bool enabled() override {
     return true;
   }
+#ifdef USE_CUPTI
+  bool cuptiEnabled() override {
+    return true;
+  }
+  void enableActivityTracing() override {
+    TORCH_CUPTI_CHECK(
+        cuptiActivityRegisterCallbacks(bufferRequested, bufferCompleted));
+    for (CUpti_ActivityKind kind : kTracedActivities) {
+      TORCH_CUPTI_CHECK(cuptiActivityEnable(kind));
+    }
+    uint64_t cupti_ns;
+    TORCH_CUPTI_CHECK(cuptiGetTimestamp(&cupti_ns));
+    activityTrace().clock_offset_ns = getTime() - static_cast<int64_t>(cupti_ns);
+  }
+  std::vector<CUDAActivity> disableActivityTracing() override {
+    // The activities are only recorded once they ran
+    TORCH_CUDA_CHECK(cudaDeviceSynchronize());
+    for (CUpti_ActivityKind kind : kTracedActivities) {
+      TORCH_CUPTI_CHECK(cuptiActivityDisable(kind));
+    }
+    TORCH_CUPTI_CHECK(cuptiActivityFlushAll(0));
+
+    ActivityTrace& trace = activityTrace();
+    std::lock_guard<std::mutex> guard(trace.mutex);
+    std::vector<CUDAActivity> activities = std::move(trace.activities);
+    trace.activities.clear();
+    for (CUDAActivity& activity : activities) {
+      auto it = trace.range_correlation_ids.find(activity.correlation_id);
+      activity.correlation_id =
+          it != trace.range_correlation_ids.end() ? it->second : 0;
+      activity.start_ns += trace.clock_offset_ns;
+      activity.end_ns += trace.clock_offset_ns;
+    }
+    trace.range_correlation_ids.clear();
+    return activities;
+  }
+  void pushCorrelationId(uint64_t correlation_id) override {
+    TORCH_CUPTI_CHECK(cuptiActivityPushExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, correlation_id));
+  }
+  void popCorrelationId() override {
+    uint64_t correlation_id;
+    TORCH_CUPTI_CHECK(cuptiActivityPopExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &correlation_id));
+  }
+#endif
 
 };
 
@@ -0,0 +1,177 @@
+#include <torch/csrc/autograd/profiler_histograms.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/llvmMathExtras.h>
+#include <c10/util/string_view.h>
+#include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/utils/memory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace autograd { namespace profiler {
+
+constexpr size_t OpHistogram::kNumBuckets;
+
+namespace {
+
+struct OpStats {
+  explicit OpStats(std::string name) : name(std::move(name)) {
+    reset();
+  }
+
+  void record(uint64_t ns) {
+    size_t bucket = ns == 0 ? 0 : llvm::Log2_64(ns);
+    bucket = std::min(bucket, OpHistogram::kNumBuckets - 1);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(ns, std::memory_order_relaxed);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void addTo(OpHistogram& histogram) const {
+    histogram.count += count.load(std::memory_order_relaxed);
+    histogram.total_ns += total_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < OpHistogram::kNumBuckets; ++i) {
+      histogram.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  void reset() {
+    count.store(0, std::memory_order_relaxed);
+    total_ns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const std::string name;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> total_ns;
+  std::array<std::atomic<uint64_t>, OpHistogram::kNumBuckets> buckets;
+};
+
+// std::hash of a string_view goes through a std::string, which allocates.
+struct NameHash {
+  size_t operator()(c10::string_view name) const {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+struct ThreadHistograms {
+  ThreadHistograms() {
+    running.reserve(64);
+  }
+
+  OpStats& statsFor(const char* name) {
+    c10::string_view key(name);
+    auto it = stats.find(key);
+    if (it != stats.end()) {
+      return *it->second;
+    }
+    auto op_stats = torch::make_unique<OpStats>(name);
+    OpStats& result = *op_stats;
+    // the key views the name owned by the stats
+    std::lock_guard<std::mutex> guard(mutex);
+    stats.emplace(c10::string_view(result.name), std::move(op_stats));
+    return result;
+  }
+
+  // Only the owning thread changes stats, and it holds mutex while doing so,
+  // so that other threads can read it under mutex.
+  std::mutex mutex;
+  std::unordered_map<c10::string_view, std::unique_ptr<OpStats>, NameHash>
+      stats;
+  // Start times of the events of the thread that are still running.
+  std::vector<std::pair<const RecordFunction*, int64_t>> running;
+};
+
+bool enabled = false;
+// Protects all_histograms.
+std::mutex all_histograms_mutex;
+std::vector<std::shared_ptr<ThreadHistograms>> all_histograms;
+thread_local std::shared_ptr<ThreadHistograms> histograms;
+
+ThreadHistograms& getThreadHistograms() {
+  if (!histograms) {
+    std::lock_guard<std::mutex> guard(all_histograms_mutex);
+    histograms = std::make_shared<ThreadHistograms>();
+    all_histograms.push_back(histograms);
+  }
+  return *histograms;
+}
+
+void onStart(const RecordFunction& fn) {
+  getThreadHistograms().running.emplace_back(&fn, getTime());
+}
+
+void onEnd(const RecordFunction& fn) {
+  int64_t end = getTime();
+  auto& thread_histograms = getThreadHistograms();
+  auto& running = thread_histograms.running;
+  // Events normally end in reverse order of their start. An event that ends
+  // on another thread than it started on is not found and not recorded.
+  auto it = std::find_if(
+      running.rbegin(),
+      running.rend(),
+      [&](const std::pair<const RecordFunction*, int64_t>& event) {
+        return event.first == &fn;
+      });
+  if (it == running.rend()) {
+    return;
+  }
+  int64_t start = it->second;
+  running.erase(std::next(it).base());
+  thread_histograms.statsFor(fn.name().str())
+      .record(static_cast<uint64_t>(std::max<int64_t>(end - start, 0)));
+}
+
+} // namespace
+
+void enableOpHistograms(double sampling_probability) {
+  TORCH_CHECK(!enabled, "op histograms are already enabled");
+  pushSampledCallback(onStart, onEnd, sampling_probability);
+  enabled = true;
+}
+
+void disableOpHistograms() {
+  TORCH_CHECK(enabled, "op histograms are not enabled");
+  popCallback();
+  enabled = false;
+}
+
+bool opHistogramsEnabled() {
+  return enabled;
+}
+
+std::unordered_map<std::string, OpHistogram> getOpHistograms() {
+  std::unordered_map<std::string, OpHistogram> result;
+  std::lock_guard<std::mutex> guard(all_histograms_mutex);
+  for (const auto& thread_histograms : all_histograms) {
+    std::lock_guard<std::mutex> stats_guard(thread_histograms->mutex);
+    for (const auto& item : thread_histograms->stats) {
+      item.second->addTo(result[item.second->name]);
+    }
+  }
+  return result;
+}
+
+void resetOpHistograms() {
+  std::lock_guard<std::mutex> guard(all_histograms_mutex);
+  for (const auto& thread_histograms : all_histograms) {
+    std::lock_guard<std::mutex> stats_guard(thread_histograms->mutex);
+    for (const auto& item : thread_histograms->stats) {
+      item.second->reset();
+    }
+  }
+}
+
+}}} // namespace torch::autograd::profiler
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace torch { namespace autograd { namespace profiler {
+
+// Aggregate mode of the profiler, cheap enough to be left on in production.
+// Instead of recording every RecordFunction event into a RangeEventList, the
+// latency of each (sampled) event is added to a fixed-bucket histogram of its
+// name, e.g. of an ATen op or of an operator run by the JIT interpreter.
+//
+// The histograms are kept in thread local tables, so recording an event takes
+// no lock and, once a thread has seen an op, allocates nothing.
+
+// The latency histogram of one op, summed over all threads. Bucket i counts
+// the events that took [2^i, 2^(i+1)) nanoseconds; the first bucket also
+// counts shorter events and the last one longer events.
+struct TORCH_API OpHistogram {
+  static constexpr size_t kNumBuckets = 32;
+
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  std::array<uint64_t, kNumBuckets> buckets{};
+};
+
+// Starts recording the histograms of a sample of the events, each event is
+// recorded with the given probability.
+// WARNING: like pushCallback, this is not thread safe and registers a
+// callback, which disableOpHistograms pops again.
+TORCH_API void enableOpHistograms(double sampling_probability = 1.0);
+TORCH_API void disableOpHistograms();
+TORCH_API bool opHistogramsEnabled();
+
+// The histograms recorded so far, by op name. They can be read while the
+// histograms are being recorded.
+TORCH_API std::unordered_map<std::string, OpHistogram> getOpHistograms();
+TORCH_API void resetOpHistograms();
+
+}}} // namespace torch::autograd::profiler
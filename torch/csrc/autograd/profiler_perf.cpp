@@ -0,0 +1,295 @@
+#include <torch/csrc/autograd/profiler_perf.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/StringUtil.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch { namespace autograd { namespace profiler {
+
+#ifdef __linux__
+
+namespace {
+
+struct PerfEventType {
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t cacheEvent(uint64_t cache, uint64_t op, uint64_t result) {
+  return cache | (op << 8) | (result << 16);
+}
+
+const PerfEventType kPerfEventTypes[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+    {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"stalled_cycles_frontend",
+     PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+    {"stalled_cycles_backend",
+     PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+    {"llc_loads",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_LL,
+         PERF_COUNT_HW_CACHE_OP_READ,
+         PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+    {"llc_load_misses",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_LL,
+         PERF_COUNT_HW_CACHE_OP_READ,
+         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llc_stores",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_LL,
+         PERF_COUNT_HW_CACHE_OP_WRITE,
+         PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+    {"llc_store_misses",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_LL,
+         PERF_COUNT_HW_CACHE_OP_WRITE,
+         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"l1d_load_misses",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_L1D,
+         PERF_COUNT_HW_CACHE_OP_READ,
+         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"dtlb_load_misses",
+     PERF_TYPE_HW_CACHE,
+     cacheEvent(
+         PERF_COUNT_HW_CACHE_DTLB,
+         PERF_COUNT_HW_CACHE_OP_READ,
+         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+const PerfEventType* findPerfEventType(const std::string& name) {
+  for (const PerfEventType& type : kPerfEventTypes) {
+    if (name == type.name) {
+      return &type;
+    }
+  }
+  return nullptr;
+}
+
+int openPerfEvent(const PerfEventType& type, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type.type;
+  attr.config = type.config;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // The group is enabled at once through its leader
+  attr.disabled = group_fd == -1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(
+      __NR_perf_event_open,
+      &attr,
+      0 /* the calling thread */,
+      -1 /* on any CPU */,
+      group_fd,
+      0 /* flags */);
+}
+
+// The counters of one thread, read at once as a group
+struct PerfGroup {
+  PerfGroup() = default;
+  PerfGroup(const PerfGroup&) = delete;
+  PerfGroup& operator=(const PerfGroup&) = delete;
+  ~PerfGroup() {
+    close();
+  }
+
+  // Returns false, with errno set, if an event can't be opened
+  bool open(const std::vector<const PerfEventType*>& types) {
+    close();
+    for (const PerfEventType* type : types) {
+      int fd = openPerfEvent(*type, fds.empty() ? -1 : fds.front());
+      if (fd < 0) {
+        int error = errno;
+        close();
+        errno = error;
+        return false;
+      }
+      fds.push_back(fd);
+    }
+    if (fds.empty()) {
+      return true;
+    }
+    ioctl(fds.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    // The number of events, the times the group was enabled and running,
+    // and the count of every event
+    buffer.resize(3 + fds.size());
+    return true;
+  }
+
+  void close() {
+    for (int fd : fds) {
+      ::close(fd);
+    }
+    fds.clear();
+  }
+
+  bool read(std::vector<int64_t>& counts) {
+    const ssize_t size = buffer.size() * sizeof(uint64_t);
+    if (fds.empty() || ::read(fds.front(), buffer.data(), size) != size) {
+      return false;
+    }
+    const uint64_t time_enabled = buffer[1];
+    const uint64_t time_running = buffer[2];
+    counts.resize(fds.size());
+    for (size_t i = 0; i < fds.size(); ++i) {
+      uint64_t count = buffer[3 + i];
+      // The group only ran part of the time when the kernel multiplexed it
+      // with other events
+      if (time_running > 0 && time_running < time_enabled) {
+        count = static_cast<uint64_t>(
+            static_cast<double>(count) * time_enabled / time_running);
+      }
+      counts[i] = static_cast<int64_t>(count);
+    }
+    return true;
+  }
+
+  std::vector<int> fds;
+  std::vector<uint64_t> buffer;
+  // The configuration of the events this group was opened for
+  uint64_t generation = 0;
+};
+
+std::atomic<bool> perf_events_enabled{false};
+// Bumped every time the events are enabled, so that the threads reopen their
+// groups for the new events
+std::atomic<uint64_t> perf_events_generation{0};
+// Protects perf_event_types
+std::mutex perf_events_mutex;
+std::vector<const PerfEventType*> perf_event_types;
+thread_local PerfGroup perf_group;
+
+} // namespace
+
+std::vector<std::string> perfEventNames() {
+  std::vector<std::string> names;
+  for (const PerfEventType& type : kPerfEventTypes) {
+    names.emplace_back(type.name);
+  }
+  return names;
+}
+
+bool perfEventsAvailable() {
+  PerfGroup group;
+  return group.open({findPerfEventType("cycles")});
+}
+
+void enablePerfEvents(const std::vector<std::string>& events) {
+  std::vector<const PerfEventType*> types;
+  for (const std::string& name : events) {
+    const PerfEventType* type = findPerfEventType(name);
+    TORCH_CHECK(
+        type,
+        "Unknown perf event ",
+        name,
+        ", expected one of ",
+        c10::Join(", ", perfEventNames()));
+    types.push_back(type);
+  }
+  {
+    PerfGroup group;
+    TORCH_CHECK(
+        group.open(types),
+        "Could not open the perf events ",
+        c10::Join(", ", events),
+        ": ",
+        strerror(errno),
+        ". The CPU may not support them, or counting them may need a lower "
+        "kernel.perf_event_paranoid");
+  }
+  std::lock_guard<std::mutex> guard(perf_events_mutex);
+  perf_event_types = std::move(types);
+  ++perf_events_generation;
+  perf_events_enabled = true;
+}
+
+void disablePerfEvents() {
+  perf_events_enabled = false;
+}
+
+bool perfEventsEnabled() {
+  return perf_events_enabled.load(std::memory_order_relaxed);
+}
+
+void readPerfCounters(std::vector<int64_t>& counts) {
+  counts.clear();
+  if (!perfEventsEnabled()) {
+    // The thread may not read them again before it exits
+    perf_group.close();
+    return;
+  }
+  const uint64_t generation = perf_events_generation.load();
+  if (perf_group.generation != generation) {
+    perf_group.generation = generation;
+    std::lock_guard<std::mutex> guard(perf_events_mutex);
+    if (!perf_group.open(perf_event_types)) {
+      TORCH_WARN(
+          "Could not open the perf events on this thread: ",
+          strerror(errno),
+          ", its functions won't report them");
+    }
+  }
+  if (!perf_group.read(counts)) {
+    counts.clear();
+  }
+}
+
+#else // __linux__
+
+std::vector<std::string> perfEventNames() {
+  return {};
+}
+
+bool perfEventsAvailable() {
+  return false;
+}
+
+void enablePerfEvents(const std::vector<std::string>& events) {
+  TORCH_CHECK(
+      events.empty(), "Perf events can only be counted on Linux");
+}
+
+void disablePerfEvents() {}
+
+bool perfEventsEnabled() {
+  return false;
+}
+
+void readPerfCounters(std::vector<int64_t>& counts) {
+  counts.clear();
+}
+
+#endif // __linux__
+
+}}} // namespace torch::autograd::profiler
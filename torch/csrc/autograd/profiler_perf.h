@@ -0,0 +1,42 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch { namespace autograd { namespace profiler {
+
+// Hardware performance counters of the profiler, read with Linux
+// perf_event_open around every range so that each op reports e.g. the cycles,
+// instructions and cache misses it took on the thread that ran it.
+//
+// Each thread opens its own group of counters, counting in user space only,
+// the first time it reads them while the events are enabled. The counts are
+// scaled when the kernel multiplexes more events than the CPU has counters.
+
+// The names of the events that can be counted: "cycles", "instructions",
+// "cache_references", "cache_misses" (last level cache), "branches",
+// "branch_misses", "stalled_cycles_frontend", "stalled_cycles_backend",
+// "llc_loads", "llc_load_misses", "llc_stores", "llc_store_misses",
+// "l1d_load_misses", "dtlb_load_misses", "page_faults" and "context_switches".
+TORCH_API std::vector<std::string> perfEventNames();
+
+// Whether perf_event_open can open counters in this process, which it can't on
+// other platforms than Linux, or when kernel.perf_event_paranoid forbids it.
+TORCH_API bool perfEventsAvailable();
+
+// Starts counting the given events on every thread that reads them. Throws if
+// an event is unknown or can't be opened on the calling thread.
+// WARNING: like enableProfiler, this is not thread safe.
+TORCH_API void enablePerfEvents(const std::vector<std::string>& events);
+TORCH_API void disablePerfEvents();
+TORCH_API bool perfEventsEnabled();
+
+// Reads the counts of the enabled events on the calling thread since it opened
+// them, in the order of enablePerfEvents. Leaves counts empty when no events
+// are enabled, or when they can't be opened on this thread.
+TORCH_API void readPerfCounters(std::vector<int64_t>& counts);
+
+}}} // namespace torch::autograd::profiler
@@ -241,6 +241,32 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self, PyObject *noargs) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg),
+      "set_num_cpu_threads expects an int, but got %s", THPUtils_typename(arg));
+  int num_threads = (int)THPUtils_unpackLong(arg);
+  {
+    pybind11::gil_scoped_release no_gil;
+    engine.set_num_cpu_threads(num_threads);
+  }
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_set_max_reentrant_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg),
+      "set_max_reentrant_threads expects an int, but got %s", THPUtils_typename(arg));
+  int num_threads = (int)THPUtils_unpackLong(arg);
+  {
+    pybind11::gil_scoped_release no_gil;
+    engine.set_max_reentrant_threads(num_threads);
+  }
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -250,6 +276,8 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)(void(*)(void))THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"set_num_cpu_threads", (PyCFunction)THPEngine_set_num_cpu_threads, METH_O, nullptr},
+  {(char*)"set_max_reentrant_threads", (PyCFunction)THPEngine_set_max_reentrant_threads, METH_O, nullptr},
   {nullptr}
 };
 
@@ -11,6 +11,21 @@ namespace profiler {
 
 namespace {
 
+// The active_callbacks_ of a RecordFunction is a bit mask.
+constexpr size_t kMaxCallbacks = 64;
+
+// The per thread state of the sampled callbacks: how many more functions each
+// sampled callback skips before it runs again. Drawing these from a geometric
+// distribution samples every function with the callback's probability, but
+// needs only a decrement for the functions that are skipped.
+struct ThreadSamplingState {
+  // the CallbackManager::version the countdowns were drawn for
+  uint64_t version = 0;
+  std::vector<int64_t> countdowns;
+};
+
+thread_local ThreadSamplingState sampling_state;
+
 class CallbackManager {
  public:
   void setSamplingProbability(double prob) {
@@ -21,6 +36,7 @@ class CallbackManager {
       sampling_prop_set = true;
     }
     sampling_prob = prob;
+    ++version;
   }
 
   double getSamplingProbability() {
@@ -32,20 +48,31 @@ class CallbackManager {
         (!sampling_prop_set || (sample_zero_one() < sampling_prob));
   }
 
+  // A negative sampling_prob makes a sampled callback use sampling_prob of
+  // the manager.
   void pushCallback(
       RecordFunctionCallback start,
       RecordFunctionCallback end,
       bool needs_inputs,
-      bool sampled) {
+      bool sampled,
+      double sampling_prob = -1.0) {
+    TORCH_CHECK(
+        start_callbacks.size() < kMaxCallbacks,
+        "At most ",
+        kMaxCallbacks,
+        " RecordFunction callbacks can be registered");
     start_callbacks.push_back(std::move(start));
     end_callbacks.push_back(std::move(end));
-    if (callback_needs_inputs > 0 || needs_inputs) {
-      ++callback_needs_inputs;
+    callback_needs_inputs.push_back(needs_inputs);
+    if (needs_inputs) {
+      ++num_callbacks_needing_inputs;
     }
     is_callback_sampled.push_back(sampled);
+    callback_sampling_probs.push_back(sampling_prob);
     if (sampled) {
       ++num_sampled_callbacks;
     }
+    ++version;
   }
 
   void popCallback() {
@@ -54,13 +81,36 @@ class CallbackManager {
     }
     start_callbacks.pop_back();
     end_callbacks.pop_back();
-    if (callback_needs_inputs > 0) {
-      --callback_needs_inputs;
+    if (callback_needs_inputs.back()) {
+      --num_callbacks_needing_inputs;
     }
+    callback_needs_inputs.pop_back();
     if (is_callback_sampled.back()) {
       --num_sampled_callbacks;
     }
     is_callback_sampled.pop_back();
+    callback_sampling_probs.pop_back();
+    ++version;
+  }
+
+  // Returns the mask of the callbacks that run for the next function of this
+  // thread, and whether any of them needs the inputs.
+  uint64_t sampleCallbacks(bool& needs_inputs) {
+    if (sampling_state.version != version) {
+      sampling_state.countdowns.assign(start_callbacks.size(), -1);
+      sampling_state.version = version;
+    }
+    uint64_t mask = 0;
+    needs_inputs = false;
+    for (size_t idx = 0; idx < start_callbacks.size(); ++idx) {
+      if (is_callback_sampled[idx] &&
+          !sampleCallback(idx, sampling_state.countdowns[idx])) {
+        continue;
+      }
+      mask |= (uint64_t)1 << idx;
+      needs_inputs = needs_inputs || callback_needs_inputs[idx];
+    }
+    return mask;
   }
 
   bool hasCallbacks() {
@@ -68,7 +118,7 @@ class CallbackManager {
   }
 
   bool needsInputs() {
-    return callback_needs_inputs > 0;
+    return num_callbacks_needing_inputs > 0;
   }
 
   bool hasNonSampledCallbacks() {
@@ -77,17 +127,55 @@ class CallbackManager {
 
   std::vector<RecordFunctionCallback> start_callbacks;
   std::vector<RecordFunctionCallback> end_callbacks;
+  std::vector<bool> callback_needs_inputs;
   std::vector<bool> is_callback_sampled;
+  std::vector<double> callback_sampling_probs;
   size_t num_sampled_callbacks = 0;
-  size_t callback_needs_inputs = 0;
+  size_t num_callbacks_needing_inputs = 0;
   bool sampling_prop_set = false;
   double sampling_prob = 1.0;
+  // Changes whenever the callbacks or their probabilities do, so that the
+  // threads draw their countdowns again.
+  uint64_t version = 1;
 
-  static double sample_zero_one() {
+  static std::mt19937& generator() {
     static thread_local auto gen =
         torch::make_unique<std::mt19937>(std::random_device()());
+    return *gen;
+  }
+
+  static double sample_zero_one() {
     std::uniform_real_distribution<double> dist(0.0, 1.0);
-    return dist(*gen);
+    return dist(generator());
+  }
+
+ private:
+  bool sampleCallback(size_t idx, int64_t& countdown) {
+    double prob = callback_sampling_probs[idx] >= 0.0
+        ? callback_sampling_probs[idx]
+        : sampling_prob;
+    if (prob >= 1.0) {
+      return true;
+    }
+    if (prob <= 0.0) {
+      return false;
+    }
+    if (countdown < 0) {
+      countdown = sample_skipped(prob);
+    }
+    if (countdown > 0) {
+      --countdown;
+      return false;
+    }
+    countdown = sample_skipped(prob);
+    return true;
+  }
+
+  // The number of functions skipped before a callback sampled with
+  // probability prob runs again.
+  static int64_t sample_skipped(double prob) {
+    std::geometric_distribution<int64_t> dist(prob);
+    return dist(generator());
   }
 };
 
@@ -122,6 +210,20 @@ void pushCallback(
       std::move(start), std::move(end), needs_inputs, sampled);
 }
 
+void pushSampledCallback(
+    RecordFunctionCallback start,
+    RecordFunctionCallback end,
+    double sampling_prob,
+    bool needs_inputs) {
+  TORCH_CHECK(sampling_prob >= 0.0 && sampling_prob <= 1.0);
+  manager().pushCallback(
+      std::move(start),
+      std::move(end),
+      needs_inputs,
+      /*sampled=*/true,
+      sampling_prob);
+}
+
 void popCallback() {
   manager().popCallback();
 }
@@ -142,20 +244,25 @@ void runBeforeCallbacks(RecordFunction* rf, const std::string& funcName) {
   TORCH_INTERNAL_ASSERT(
       rf != nullptr,
       "The RecordFunction passed to before callbacks should not be null.");
-  if (hasCallbacks()) {
-    auto run_samples = shouldRunSampledCallbacks();
-    if (run_samples || hasNonSampledCallbacks()) {
-      rf->setRunSampled(run_samples);
-      rf->before(funcName);
-    }
+  if (hasCallbacks() && rf->sampleCallbacks()) {
+    rf->before(funcName);
   }
 }
 
+bool RecordFunction::sampleCallbacks() {
+  active_callbacks_ = manager().sampleCallbacks(needs_inputs_);
+  callbacks_sampled_ = true;
+  return active_callbacks_ != 0;
+}
+
 void RecordFunction::before(const char* name, int64_t sequence_nr) {
   if (!hasCallbacks()) {
     return;
   }
   AT_ASSERT(!initialized_);
+  if (!callbacks_sampled_) {
+    sampleCallbacks();
+  }
   name_ = StringView(name);
   sequence_nr_ = sequence_nr;
 
@@ -168,6 +275,9 @@ void RecordFunction::before(std::string name, int64_t sequence_nr) {
     return;
   }
   AT_ASSERT(!initialized_);
+  if (!callbacks_sampled_) {
+    sampleCallbacks();
+  }
   name_ = StringView(std::move(name));
   sequence_nr_ = sequence_nr;
 
@@ -180,6 +290,9 @@ void RecordFunction::before(Node* fn, int64_t sequence_nr) {
     return;
   }
   AT_ASSERT(!initialized_);
+  if (!callbacks_sampled_) {
+    sampleCallbacks();
+  }
   fn_ = fn;
   name_ = StringView(fn->name());
   sequence_nr_ = (sequence_nr >= 0) ? sequence_nr : fn->sequence_nr();
@@ -193,7 +306,7 @@ void RecordFunction::processCallbacks() {
   thread_local_func_ = this;
 
   for (size_t idx = 0; idx < manager().start_callbacks.size(); ++idx) {
-    if (!manager().is_callback_sampled[idx] || run_sampled_) {
+    if (active_callbacks_ & ((uint64_t)1 << idx)) {
       manager().start_callbacks[idx](*this);
     }
   }
@@ -218,7 +331,7 @@ RecordFunction::~RecordFunction() {
 void RecordFunction::end() {
   if (initialized_) {
     for (size_t idx = 0; idx < manager().end_callbacks.size(); ++idx) {
-      if (!manager().is_callback_sampled[idx] || run_sampled_) {
+      if (active_callbacks_ & ((uint64_t)1 << idx)) {
         manager().end_callbacks[idx](*this);
       }
     }
@@ -235,6 +348,7 @@ void RecordFunction::end() {
         "thread.");
     thread_local_func_ = parent_;
     initialized_ = false;
+    callbacks_sampled_ = false;
   }
 }
 
@@ -101,8 +101,16 @@ struct TORCH_API RecordFunction {
     return initialized_;
   }
 
-  void setRunSampled(bool run_sampled) {
-    run_sampled_ = run_sampled;
+  // Picks the callbacks that run for this function, drawing whether each
+  // sampled callback runs. This only touches thread local state, so that it
+  // can be checked before the name and inputs are built: if it returns false,
+  // no callback runs and before() need not be called. before() picks the
+  // callbacks itself if this wasn't called.
+  bool sampleCallbacks();
+
+  // Whether one of the picked callbacks needs the inputs.
+  bool needsInputs() const {
+    return needs_inputs_;
   }
 
   void end();
@@ -132,7 +140,10 @@ struct TORCH_API RecordFunction {
   RecordFunction* parent_ = nullptr;
 
   bool initialized_ = false;
-  bool run_sampled_ = false;
+  bool callbacks_sampled_ = false;
+  bool needs_inputs_ = false;
+  // Bit i is set if the i-th callback runs for this function.
+  uint64_t active_callbacks_ = 0;
   // The thread_id that this RecordFunction was created with. If 0, this means
   // that it was not set with setThreadId() and this RecordFunction's callbacks
   // cannot be invoked from a separate thread.
@@ -154,28 +165,34 @@ TORCH_API void runBeforeCallbacks(
     const std::string& funcName);
 
 // optional argument - function's seq_no
+// The inputs are only captured if one of the callbacks picked for this
+// function needs them.
 #define RECORD_FUNCTION(fn, inputs, ...) \
   torch::autograd::profiler::RecordFunction guard; \
-  if (torch::autograd::profiler::hasCallbacks()) { \
-    auto run_sampled = torch::autograd::profiler::shouldRunSampledCallbacks(); \
-    if (run_sampled || torch::autograd::profiler::hasNonSampledCallbacks()) { \
-      guard.setRunSampled(run_sampled); \
-      if (torch::autograd::profiler::needsInputs()) { \
-        guard.before(fn, inputs, ##__VA_ARGS__); \
-      } else { \
-        guard.before(fn, ##__VA_ARGS__); \
-      } \
+  if (torch::autograd::profiler::hasCallbacks() && guard.sampleCallbacks()) { \
+    if (guard.needsInputs()) { \
+      guard.before(fn, inputs, ##__VA_ARGS__); \
+    } else { \
+      guard.before(fn, ##__VA_ARGS__); \
     } \
   }
 
 // WARNING: all calls to pushCallback/popCallback are not thread safe and
 // must not overlap with other code execution
 using RecordFunctionCallback = std::function<void(const RecordFunction&)>;
+// A sampled callback runs with the probability set by setSamplingProbability.
 TORCH_API void pushCallback(
     RecordFunctionCallback start,
     RecordFunctionCallback end = [](const RecordFunction&){},
     bool needs_inputs = false,
     bool sampled = false);
+// Like pushCallback, but the callback is sampled with its own probability,
+// independently of the other callbacks.
+TORCH_API void pushSampledCallback(
+    RecordFunctionCallback start,
+    RecordFunctionCallback end,
+    double sampling_prob,
+    bool needs_inputs = false);
 TORCH_API void popCallback();
 
 } // namespace profiler
@@ -4,9 +4,11 @@
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
+#include <torch/csrc/autograd/grad_mode.h>
 
 #include <ATen/Tensor.h>
 
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -14,6 +16,117 @@
 
 namespace torch { namespace autograd {
 
+namespace {
+
+thread_local std::shared_ptr<SavedVariableHooks> saved_variable_hooks;
+
+} // namespace
+
+std::shared_ptr<SavedVariableHooks> SavedVariableHooks::get() {
+  return saved_variable_hooks;
+}
+
+void SavedVariableHooks::set(std::shared_ptr<SavedVariableHooks> hooks) {
+  saved_variable_hooks = std::move(hooks);
+}
+
+// Shared with the packed data, which outlives the hooks that packed it.
+struct CPUOffloadHooks::Counters {
+  std::atomic<int64_t> device_bytes{0};
+  std::atomic<int64_t> offloaded_bytes{0};
+};
+
+namespace {
+
+struct DevicePackedData : public PackedData {
+  DevicePackedData(
+      at::Tensor data,
+      std::shared_ptr<std::atomic<int64_t>> bytes_counter,
+      int64_t bytes)
+      : data_(std::move(data)),
+        bytes_counter_(std::move(bytes_counter)),
+        bytes_(bytes) {}
+
+  ~DevicePackedData() override {
+    *bytes_counter_ -= bytes_;
+  }
+
+  at::Tensor unpack() const override {
+    return data_;
+  }
+
+  at::Tensor data_;
+  std::shared_ptr<std::atomic<int64_t>> bytes_counter_;
+  int64_t bytes_;
+};
+
+struct HostPackedData : public PackedData {
+  HostPackedData(
+      const at::Tensor& data,
+      std::shared_ptr<std::atomic<int64_t>> bytes_counter,
+      int64_t bytes)
+      : options_(data.options()),
+        bytes_counter_(std::move(bytes_counter)),
+        bytes_(bytes) {
+    AutoGradMode grad_mode(false);
+    host_ = at::empty(
+        data.sizes(), options_.device(at::kCPU).pinned_memory(true));
+    host_.copy_(data, /*non_blocking=*/true);
+  }
+
+  ~HostPackedData() override {
+    *bytes_counter_ -= bytes_;
+  }
+
+  at::Tensor unpack() const override {
+    AutoGradMode grad_mode(false);
+    auto data = at::empty(host_.sizes(), options_);
+    data.copy_(host_, /*non_blocking=*/true);
+    return data;
+  }
+
+  at::TensorOptions options_;
+  at::Tensor host_;
+  std::shared_ptr<std::atomic<int64_t>> bytes_counter_;
+  int64_t bytes_;
+};
+
+} // namespace
+
+CPUOffloadHooks::CPUOffloadHooks(int64_t device_budget)
+    : device_budget_(device_budget), counters_(std::make_shared<Counters>()) {}
+
+std::unique_ptr<PackedData> CPUOffloadHooks::pack(const at::Tensor& data) {
+  if (!data.is_cuda() || data.layout() != at::kStrided) {
+    return nullptr;
+  }
+  const int64_t bytes = data.numel() * data.element_size();
+  // The packed data keeps the counters alive through an aliasing shared_ptr
+  // to the counter it decrements.
+  if (counters_->device_bytes.fetch_add(bytes) + bytes <= device_budget_) {
+    return std::make_unique<DevicePackedData>(
+        data,
+        std::shared_ptr<std::atomic<int64_t>>(
+            counters_, &counters_->device_bytes),
+        bytes);
+  }
+  counters_->device_bytes -= bytes;
+  counters_->offloaded_bytes += bytes;
+  return std::make_unique<HostPackedData>(
+      data,
+      std::shared_ptr<std::atomic<int64_t>>(
+          counters_, &counters_->offloaded_bytes),
+      bytes);
+}
+
+int64_t CPUOffloadHooks::device_bytes() const {
+  return counters_->device_bytes;
+}
+
+int64_t CPUOffloadHooks::offloaded_bytes() const {
+  return counters_->offloaded_bytes;
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_inplace_view) {
   if (variable.defined()) {
     was_default_constructed_ = false;
@@ -24,6 +137,12 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.tensor_data();
+    if (auto hooks = SavedVariableHooks::get()) {
+      packed_ = hooks->pack(data_);
+      if (packed_) {
+        data_.reset();
+      }
+    }
     if (variable.is_leaf()) {
       grad_accumulator_ = impl::grad_accumulator(variable);
     } else if (!is_output) {
@@ -37,7 +156,7 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
 }
 
 Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && !packed_) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -54,11 +173,13 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
     grad_fn = std::move(saved_for);
   }
 
+  auto data = packed_ ? packed_->unpack() : data_;
+
   if (saved_version_ != version_counter_.current_version()) {
     std::stringstream message;
     message << "one of the variables needed for gradient computation has been "
-        "modified by an inplace operation: [" << data_.toString() << " "
-        << data_.sizes() << "]";
+        "modified by an inplace operation: [" << data.toString() << " "
+        << data.sizes() << "]";
     if (grad_fn) {
         message << ", which is output " << output_nr_
             << " of " << grad_fn->name() << ",";
@@ -83,9 +204,9 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   impl::set_version_counter(var, saved_version_);
 
@@ -14,6 +14,66 @@ struct Node;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
+/// The data of a `SavedVariable` packed by `SavedVariableHooks`.
+struct TORCH_API PackedData {
+  virtual ~PackedData() = default;
+
+  /// Reconstructs the data. Called by every `SavedVariable::unpack`, so
+  /// possibly more than once if the graph is retained.
+  virtual at::Tensor unpack() const = 0;
+};
+
+/// Hooks that pack the data of variables saved for backward, e.g. to keep it
+/// outside of device memory until backward needs it. Like grad mode, the hooks
+/// are thread local: the `SavedVariable`s created on a thread pack their data
+/// with the hooks set on that thread.
+struct TORCH_API SavedVariableHooks {
+  virtual ~SavedVariableHooks() = default;
+
+  /// Returns the packed `data` of a variable being saved, or nullptr to save
+  /// `data` as is.
+  virtual std::unique_ptr<PackedData> pack(const at::Tensor& data) = 0;
+
+  static std::shared_ptr<SavedVariableHooks> get();
+  static void set(std::shared_ptr<SavedVariableHooks> hooks);
+};
+
+/// Saved data on a CUDA device stays there until `device_budget` bytes of it
+/// are saved. Data saved beyond the budget is copied to pinned host memory,
+/// with non-blocking copies on the current stream, and copied back to the
+/// device when it is unpacked. Saved data is counted until the graph holding
+/// it is freed.
+struct TORCH_API CPUOffloadHooks : public SavedVariableHooks {
+  explicit CPUOffloadHooks(int64_t device_budget = 0);
+
+  std::unique_ptr<PackedData> pack(const at::Tensor& data) override;
+
+  /// The number of bytes of saved data kept on devices.
+  int64_t device_bytes() const;
+  /// The number of bytes of saved data copied to host memory.
+  int64_t offloaded_bytes() const;
+
+ private:
+  struct Counters;
+
+  int64_t device_budget_;
+  std::shared_ptr<Counters> counters_;
+};
+
+/// Sets the `SavedVariableHooks` of this thread for the lifetime of the guard.
+struct TORCH_API SavedVariableHooksGuard {
+  explicit SavedVariableHooksGuard(std::shared_ptr<SavedVariableHooks> hooks)
+      : prev_hooks_(SavedVariableHooks::get()) {
+    SavedVariableHooks::set(std::move(hooks));
+  }
+  ~SavedVariableHooksGuard() {
+    SavedVariableHooks::set(std::move(prev_hooks_));
+  }
+
+ private:
+  std::shared_ptr<SavedVariableHooks> prev_hooks_;
+};
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class TORCH_API SavedVariable {
@@ -29,6 +89,7 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
   void reset_data() {
+    packed_.reset();
     return data_.reset();
   }
 
@@ -38,6 +99,8 @@ class TORCH_API SavedVariable {
 
  private:
   at::Tensor data_;
+  // Set instead of data_ if the SavedVariableHooks packed the data.
+  std::unique_ptr<PackedData> packed_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
@@ -0,0 +1,184 @@
+#include <torch/csrc/autograd/static_graph.h>
+
+#include <torch/csrc/autograd/anomaly_mode.h>
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/grad_mode.h>
+#include <torch/csrc/autograd/input_buffer.h>
+
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+
+namespace torch { namespace autograd {
+
+StaticGraph::StaticGraph(edge_list roots, edge_list outputs)
+    : roots_(std::move(roots)), outputs_(std::move(outputs)), is_static_(true) {
+  // Find the functions reachable from the roots and count their dependencies
+  std::unordered_map<Node*, std::shared_ptr<Node>> nodes;
+  std::unordered_map<Node*, int> dependencies;
+  std::vector<Node*> stack;
+  for (const auto& root : roots_) {
+    if (root.function && nodes.emplace(root.function.get(), root.function).second) {
+      stack.push_back(root.function.get());
+    }
+  }
+  while (!stack.empty()) {
+    Node* fn = stack.back();
+    stack.pop_back();
+    for (const auto& edge : fn->next_edges()) {
+      if (Node* next = edge.function.get()) {
+        dependencies[next] += 1;
+        if (nodes.emplace(next, edge.function).second) {
+          stack.push_back(next);
+        }
+      }
+    }
+  }
+
+  // Take the ready functions in the order the Engine pops them from its
+  // ready queue, the highest sequence_nr first
+  auto runs_later = [](Node* a, Node* b) {
+    return a->sequence_nr() < b->sequence_nr();
+  };
+  std::priority_queue<Node*, std::vector<Node*>, decltype(runs_later)> ready(
+      runs_later);
+  for (const auto& node : nodes) {
+    if (dependencies.count(node.first) == 0) {
+      ready.push(node.first);
+    }
+  }
+  std::vector<Node*> order;
+  std::unordered_map<Node*, size_t> position;
+  order.reserve(nodes.size());
+  while (!ready.empty()) {
+    Node* fn = ready.top();
+    ready.pop();
+    position[fn] = order.size();
+    order.push_back(fn);
+    for (const auto& edge : fn->next_edges()) {
+      if (Node* next = edge.function.get()) {
+        if (--dependencies.at(next) == 0) {
+          ready.push(next);
+        }
+      }
+    }
+  }
+  TORCH_INTERNAL_ASSERT(order.size() == nodes.size());
+
+  // Like GraphTask::init_to_execute, a function only needs to run if it leads
+  // to an output. Going backwards through the order sees the next functions
+  // of a function before the function itself.
+  std::unordered_map<Node*, std::vector<std::pair<size_t, uint32_t>>> captures;
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (outputs_[i].function) {
+      captures[outputs_[i].function.get()].emplace_back(
+          i, outputs_[i].input_nr);
+    }
+  }
+  std::vector<bool> needed(order.size(), outputs_.empty());
+  std::vector<bool> should_execute(order.size(), outputs_.empty());
+  for (size_t i = order.size(); !outputs_.empty() && i-- > 0;) {
+    for (const auto& edge : order[i]->next_edges()) {
+      if (edge.function && should_execute[position.at(edge.function.get())]) {
+        needed[i] = true;
+        break;
+      }
+    }
+    should_execute[i] = needed[i] || captures.count(order[i]) > 0;
+  }
+
+  std::vector<int64_t> step_of(order.size(), -1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (should_execute[i]) {
+      step_of[i] = schedule_.size();
+      Step step;
+      step.fn = nodes.at(order[i]);
+      step.needed = needed[i];
+      auto it = captures.find(order[i]);
+      if (it != captures.end()) {
+        step.captures = std::move(it->second);
+      }
+      schedule_.push_back(std::move(step));
+    }
+  }
+  for (auto& step : schedule_) {
+    for (const auto& edge : step.fn->next_edges()) {
+      step.next_steps.push_back(
+          edge.function ? step_of[position.at(edge.function.get())] : -1);
+    }
+    for (size_t i = 0; i < step.fn->num_inputs(); ++i) {
+      if (step.fn->input_metadata(i).device().type() != at::kCPU) {
+        is_static_ = false;
+      }
+    }
+    if (!step.fn->post_hooks().empty()) {
+      is_static_ = false;
+    }
+  }
+  for (const auto& root : roots_) {
+    root_steps_.push_back(
+        root.function ? step_of[position.at(root.function.get())] : -1);
+  }
+}
+
+variable_list StaticGraph::run(
+    const variable_list& grad_roots,
+    bool create_graph) const {
+  if (!is_static_ || AnomalyMode::is_enabled()) {
+    return Engine::get_default_engine().execute(
+        roots_, grad_roots, /*keep_graph=*/true, create_graph, outputs_);
+  }
+
+  variable_list grads = grad_roots;
+  validate_outputs(
+      roots_, grads, [](const std::string& msg) { return msg; });
+
+  AutoGradMode grad_mode(create_graph);
+  std::vector<InputBuffer> buffers;
+  buffers.reserve(schedule_.size());
+  for (const auto& step : schedule_) {
+    buffers.emplace_back(step.fn->num_inputs());
+  }
+  for (size_t i = 0; i < roots_.size(); ++i) {
+    if (root_steps_[i] >= 0) {
+      buffers[root_steps_[i]].add(
+          roots_[i].input_nr, std::move(grads[i]), c10::nullopt, c10::nullopt);
+    }
+  }
+
+  variable_list captured(outputs_.size());
+  for (size_t i = 0; i < schedule_.size(); ++i) {
+    const auto& step = schedule_[i];
+    for (const auto& capture : step.captures) {
+      captured[capture.first] = buffers[i][capture.second];
+    }
+    if (!step.needed) {
+      continue;
+    }
+
+    auto& fn = *step.fn;
+    auto inputs = InputBuffer::variables(std::move(buffers[i]));
+    for (const auto& hook : fn.pre_hooks()) {
+      inputs = (*hook)(inputs);
+    }
+    auto outputs = fn(std::move(inputs));
+    validate_outputs(fn.next_edges(), outputs, [&](const std::string& msg) {
+      std::ostringstream ss;
+      ss << "Function " << fn.name() << " returned an " << msg;
+      return ss.str();
+    });
+
+    for (size_t j = 0; j < outputs.size(); ++j) {
+      if (step.next_steps[j] >= 0) {
+        buffers[step.next_steps[j]].add(
+            fn.next_edge(j).input_nr,
+            std::move(outputs[j]),
+            c10::nullopt,
+            c10::nullopt);
+      }
+    }
+  }
+  return captured;
+}
+
+}} // namespace torch::autograd
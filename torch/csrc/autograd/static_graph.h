@@ -0,0 +1,78 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/edge.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+// StaticGraph runs the backward pass of a retained autograd graph again and
+// again with new gradients, e.g. for vector-Jacobian products with many
+// vectors. The graph is discovered once: the dependencies and a schedule of
+// the functions are computed when the StaticGraph is created. Every run()
+// then goes through the schedule on the calling thread, with the InputBuffers
+// of the functions in a vector, instead of discovering the graph again and
+// going through the hash maps, ready queues and worker threads of the Engine.
+//
+// The schedule takes functions in the same order as the Engine with a single
+// thread: among the functions whose inputs are complete, the one with the
+// highest sequence_nr goes first.
+//
+// The graph has to be retained, every run() needs its saved variables again,
+// and the graph must not change while a StaticGraph of it is used. run()
+// falls back to the Engine if
+//
+//   - a function of the graph has inputs on a device other than the CPU, the
+//     Engine takes care of the devices and their streams,
+//   - a function has post hooks (e.g. the ones of DistributedDataParallel),
+//     they may queue callbacks with the Engine,
+//   - or anomaly mode is enabled.
+//
+// run() must not be called concurrently.
+struct TORCH_API StaticGraph {
+  // `roots` are the gradient edges of the tensors to differentiate. If
+  // `outputs` is not empty, run() returns the gradients flowing into these
+  // edges, like grad(), and only runs the functions needed for them.
+  explicit StaticGraph(edge_list roots, edge_list outputs = {});
+
+  variable_list run(
+      const variable_list& grad_roots,
+      bool create_graph = false) const;
+
+  // Whether run() goes through the schedule rather than the Engine.
+  bool is_static() const {
+    return is_static_;
+  }
+
+  size_t num_functions() const {
+    return schedule_.size();
+  }
+
+ private:
+  struct Step {
+    std::shared_ptr<Node> fn;
+    // The step of every next edge of fn, -1 for edges that are invalid or
+    // lead to functions that don't need to run.
+    std::vector<int64_t> next_steps;
+    // The (output index, input_nr) pairs of the gradients to capture from
+    // the inputs of fn.
+    std::vector<std::pair<size_t, uint32_t>> captures;
+    // False if fn only has its inputs captured.
+    bool needed;
+  };
+
+  edge_list roots_;
+  edge_list outputs_;
+  std::vector<Step> schedule_;
+  // The step that every root passes its gradient to, or -1.
+  std::vector<int64_t> root_steps_;
+  bool is_static_;
+};
+
+}} // namespace torch::autograd
@@ -365,6 +365,26 @@ struct TORCH_API DifferentiableViewMeta : public AutogradMeta {
 /// `allow_tensor_metadata_change_` to false by default would unnecessarily
 /// prevent those changes from happening and is undesirable.
 
+// The view functions below usually get the result of a view op, whose
+// TensorImpl nobody else refers to. They turn it into the view in place, like
+// make_variable does, instead of copying it, so that a view allocates a single
+// TensorImpl. The TensorImpl is copied if it is shared, e.g. with the base
+// when the op returned its input.
+inline c10::intrusive_ptr<at::TensorImpl> view_impl_from_data(
+    at::Tensor data,
+    const c10::VariableVersion& version_counter,
+    bool allow_tensor_metadata_change) {
+  if (data.getIntrusivePtr().use_count() == 1 && data.getIntrusivePtr()->unique_version()) {
+    auto data_impl = data.getIntrusivePtr();
+    data_impl->set_version_counter(version_counter);
+    data_impl->set_allow_tensor_metadata_change(allow_tensor_metadata_change);
+    return data_impl;
+  }
+  return data.getIntrusivePtr()->shallow_copy_and_detach(
+    /*version_counter=*/version_counter,
+    /*allow_tensor_metadata_change=*/allow_tensor_metadata_change);
+}
+
 // See NOTE [ Autograd View Variables ] for details.
 // Differentiable view. Track history with DifferentiableViewMeta.
 inline Variable make_variable_differentiable_view(
@@ -372,13 +392,15 @@ inline Variable make_variable_differentiable_view(
     at::Tensor data,
     bool allow_rebase_history) {
   if (data.defined()) {
-    auto data_impl_copy = data.getIntrusivePtr()->shallow_copy_and_detach(
+    // DifferentiableViewMeta sets the version counter to the one of the base
+    auto data_impl = view_impl_from_data(
+      std::move(data),
       /*version_counter=*/0,
       /*allow_tensor_metadata_change=*/true);
-    data_impl_copy->set_autograd_meta(std::make_unique<DifferentiableViewMeta>(
-      data_impl_copy.get(), std::move(base), allow_rebase_history));
-    return Variable(data_impl_copy);
-    }
+    data_impl->set_autograd_meta(std::make_unique<DifferentiableViewMeta>(
+      data_impl.get(), std::move(base), allow_rebase_history));
+    return Variable(std::move(data_impl));
+  }
   return Variable();
 }
 
@@ -389,11 +411,12 @@ inline Variable make_variable_non_differentiable_view(
     at::Tensor data,
     bool allow_tensor_metadata_change = true) {
   if (data.defined()) {
-    auto data_impl_copy = data.getIntrusivePtr()->shallow_copy_and_detach(
+    auto data_impl = view_impl_from_data(
+      std::move(data),
       /*version_counter=*/impl::version_counter(base),
       /*allow_tensor_metadata_change=*/allow_tensor_metadata_change);
-    data_impl_copy->set_autograd_meta(nullptr);
-    return Variable(data_impl_copy);
+    data_impl->set_autograd_meta(nullptr);
+    return Variable(std::move(data_impl));
   }
   return Variable();
 }
@@ -189,6 +189,17 @@ PyObject * THCPModule_cudaIPCCollect(PyObject *_unused, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_cudaSetIPCMemHandleRetention(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to set_ipc_mem_handle_retention");
+  int64_t n = THPUtils_unpackLong(arg);
+  THPUtils_assert(n >= 0, "set_ipc_mem_handle_retention expects a non-negative number of handles");
+  c10::cuda::CUDACachingAllocator::setIpcMemHandleRetention(static_cast<size_t>(n));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject * THCPModule_cudaSleep(PyObject *_unused, PyObject *cycles)
 {
   HANDLE_TH_ERRORS
@@ -336,10 +347,14 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
     py::dict segmentDict;
     segmentDict["device"] = segmentInfo.device;
     segmentDict["address"] = segmentInfo.address;
+    segmentDict["stream"] = segmentInfo.stream;
     segmentDict["total_size"] = segmentInfo.total_size;
     segmentDict["allocated_size"] = segmentInfo.allocated_size;
     segmentDict["active_size"] = segmentInfo.active_size;
     segmentDict["segment_type"] = (segmentInfo.is_large ? "large" : "small");
+    segmentDict["pool_id"] = segmentInfo.pool_id;
+    segmentDict["pool_name"] = segmentInfo.pool_name;
+    segmentDict["is_expandable"] = segmentInfo.is_expandable;
 
     py::list blocks;
     for (const auto& blockInfo : segmentInfo.blocks) {
@@ -489,6 +504,7 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_cudaHostAllocator", (PyCFunction)THCPModule_cudaHostAllocator, METH_NOARGS, nullptr},
   {"_cuda_synchronize", (PyCFunction)THCPModule_cudaSynchronize, METH_NOARGS, nullptr},
   {"_cuda_ipc_collect", (PyCFunction)THCPModule_cudaIPCCollect, METH_NOARGS, nullptr},
+  {"_cuda_set_ipc_mem_handle_retention", (PyCFunction)THCPModule_cudaSetIPCMemHandleRetention, METH_O, nullptr},
   {"_cuda_sleep", (PyCFunction)THCPModule_cudaSleep, METH_O, nullptr},
   {"_cuda_lock_mutex",   (PyCFunction)THCPModule_cudaLockMutex,   METH_NOARGS,  nullptr},
   {"_cuda_unlock_mutex", (PyCFunction)THCPModule_cudaUnlockMutex, METH_NOARGS,  nullptr},
@@ -20,10 +20,11 @@ static PyObject * THCPStream_pynew(
 
   int priority = 0;
   uint64_t cdata = 0;
+  int exclusive = 0;
 
-  static char *kwlist[] = {"priority", "_cdata", nullptr};
+  static char *kwlist[] = {"priority", "_cdata", "exclusive", nullptr};
   if (!PyArg_ParseTupleAndKeywords(
-      args, kwargs, "|iK", kwlist, &priority, &cdata)) {
+      args, kwargs, "|iKi", kwlist, &priority, &cdata, &exclusive)) {
     return nullptr;
   }
 
@@ -32,14 +33,19 @@ static PyObject * THCPStream_pynew(
     return nullptr;
   }
 
+  bool reserved = !cdata && exclusive;
   at::cuda::CUDAStream stream =
     cdata ?
     at::cuda::CUDAStream::unpack(cdata) :
+    reserved ?
+    at::cuda::reserveStreamFromPool(
+      /* isHighPriority */ priority < 0 ? true : false) :
     at::cuda::getStreamFromPool(
       /* isHighPriority */ priority < 0 ? true : false);
 
   THCPStream* self = (THCPStream *)ptr.get();
   self->cdata = stream.pack();
+  self->reserved = reserved;
   new (&self->cuda_stream) at::cuda::CUDAStream(stream);
 
   return (PyObject *)ptr.release();
@@ -47,6 +53,9 @@ static PyObject * THCPStream_pynew(
 }
 
 static void THCPStream_dealloc(THCPStream *self) {
+  if (self->reserved) {
+    at::cuda::releaseStreamToPool(self->cuda_stream);
+  }
   self->cuda_stream.~CUDAStream();
   Py_TYPE(self)->tp_free((PyObject*)self);
 }
@@ -9,6 +9,8 @@ struct THCPStream {
   PyObject_HEAD
   uint64_t cdata;
   at::cuda::CUDAStream cuda_stream;
+  // Whether this object reserved the stream, and releases it when destroyed
+  bool reserved;
 };
 extern PyObject *THCPStreamClass;
 
@@ -14,6 +14,7 @@
 #include <torch/csrc/autograd/variable.h>
 
 #include <cstddef>
+#include <cstring>
 #include <vector>
 
 namespace torch { namespace cuda {
@@ -159,6 +160,79 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntArrayRef devices, size_
   return outputs;
 }
 
+// Moving many small CPU tensors to a GPU one by one costs a host-to-device
+// copy each. copy_to_device packs the small tensors into pinned staging
+// buffers of at most buffer_size bytes, copies every buffer with a single
+// asynchronous DMA and unpacks it with device-to-device copies. Larger tensors
+// are copied on their own.
+std::vector<Tensor> copy_to_device(TensorList tensors, int64_t device, size_t buffer_size) {
+  // Keep every packed tensor aligned for vectorized access on the device
+  constexpr size_t alignment = 16;
+  auto round_up = [&](size_t n) { return (n + alignment - 1) / alignment * alignment; };
+
+  at::cuda::CUDAGuard device_guard(device);
+  auto cuda_device = at::Device(kCUDA, device);
+  std::vector<Tensor> outputs(tensors.size());
+  std::vector<size_t> batch;
+  size_t batch_bytes = 0;
+
+  auto flush = [&]() {
+    if (batch.empty()) {
+      return;
+    }
+    auto staging = at::empty(
+        {static_cast<int64_t>(batch_bytes)},
+        at::TensorOptions(kByte).pinned_memory(true));
+    char* staging_ptr = static_cast<char*>(staging.data_ptr());
+    std::vector<size_t> offsets;
+    offsets.reserve(batch.size());
+    size_t offset = 0;
+    for (auto i : batch) {
+      auto src = tensors[i].contiguous();
+      if (src.nbytes() > 0) {
+        std::memcpy(staging_ptr + offset, src.data_ptr(), src.nbytes());
+      }
+      offsets.push_back(offset);
+      offset += round_up(src.nbytes());
+    }
+
+    // The staging buffer is not freed for reuse until the copy has completed
+    auto buffer = staging.to(cuda_device, kByte, /*non_blocking=*/true);
+    char* buffer_ptr = static_cast<char*>(buffer.data_ptr());
+    auto stream = at::cuda::getCurrentCUDAStream();
+    for (size_t j = 0; j < batch.size(); ++j) {
+      const auto& src = tensors[batch[j]];
+      auto output = at::empty(src.sizes(), src.options().device(cuda_device));
+      AT_CUDA_CHECK(cudaMemcpyAsync(
+          output.data_ptr(),
+          buffer_ptr + offsets[j],
+          output.nbytes(),
+          cudaMemcpyDeviceToDevice,
+          stream));
+      outputs[batch[j]] = output;
+    }
+    batch.clear();
+    batch_bytes = 0;
+  };
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    size_t nbytes = round_up(tensor.numel() * tensor.element_size());
+    if (!tensor.device().is_cpu() || tensor.is_sparse() || nbytes > buffer_size) {
+      outputs[i] = tensor.to(
+          cuda_device, tensor.scalar_type(), /*non_blocking=*/true, /*copy=*/true);
+      continue;
+    }
+    if (batch_bytes + nbytes > buffer_size) {
+      flush();
+    }
+    batch.push_back(i);
+    batch_bytes += nbytes;
+  }
+  flush();
+  return outputs;
+}
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntArrayRef devices,
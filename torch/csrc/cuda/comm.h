@@ -17,6 +17,11 @@ TORCH_CUDA_API std::vector<at::Tensor> broadcast(const at::Tensor& tensor, at::I
 TORCH_CUDA_API tensor_list2d broadcast_coalesced(at::TensorList tensors, at::IntArrayRef devices,
                                   size_t buffer_size);
 
+TORCH_CUDA_API std::vector<at::Tensor> copy_to_device(
+    at::TensorList tensors,
+    int64_t device,
+    size_t buffer_size);
+
 TORCH_CUDA_API std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntArrayRef devices,
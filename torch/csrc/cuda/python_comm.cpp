@@ -32,6 +32,17 @@ void initCommMethods(PyObject *module) {
             return broadcast(tensor, devices);
           },
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_copy_to_device",
+          [](std::vector<at::Tensor>& tensors,
+             int64_t device,
+             size_t buffer_size) {
+            return copy_to_device(tensors, device, buffer_size);
+          },
+          py::arg("tensors"),
+          py::arg("device"),
+          py::arg("buffer_size"),
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "_scatter",
           [](at::Tensor& tensor,
@@ -0,0 +1,32 @@
+#include <ATen/cuda/CUDAGraph.h>
+#include <torch/custom_class.h>
+
+namespace torch { namespace cuda {
+
+namespace {
+
+// Exposes at::cuda::CUDAGraph as torch.classes.CUDAGraph, so that it can be
+// used from TorchScript (and from Python through torch.classes).
+struct ScriptCUDAGraph : torch::jit::CustomClassHolder, at::cuda::CUDAGraph {};
+
+using ScriptCUDAGraphPtr = c10::intrusive_ptr<ScriptCUDAGraph>;
+
+static auto register_cuda_graph =
+    torch::jit::class_<ScriptCUDAGraph>("CUDAGraph")
+        .def(torch::jit::init<>())
+        .def(
+            "capture_begin",
+            [](const ScriptCUDAGraphPtr& self) { self->capture_begin(); })
+        .def(
+            "capture_end",
+            [](const ScriptCUDAGraphPtr& self) { self->capture_end(); })
+        .def(
+            "replay",
+            [](const ScriptCUDAGraphPtr& self) { self->replay(); })
+        .def(
+            "reset",
+            [](const ScriptCUDAGraphPtr& self) { self->reset(); });
+
+} // namespace
+
+}} // namespace torch::cuda
@@ -67,22 +67,113 @@ void DistAutogradContext::accumulateGrad(
   TORCH_INTERNAL_ASSERT(grad.defined());
   TORCH_INTERNAL_ASSERT(variable.requires_grad());
 
-  std::lock_guard<std::mutex> guard(lock_);
-  auto it = accumulatedGrads_.find(variable);
-  if (it != accumulatedGrads_.end()) {
-    // Accumulate multiple grads on the same variable.
-    it->value().add_(grad);
-  } else {
-    // First grad for this variable.
-    if (grad.is_sparse()) {
-      accumulatedGrads_.insert(variable, grad.clone());
+  std::shared_ptr<GradBucket> bucket;
+  {
+    auto& gradLock = gradLocks_
+        [std::hash<c10::TensorImpl*>()(variable.unsafeGetTensorImpl()) %
+         kNumGradLocks];
+    std::lock_guard<std::mutex> gradGuard(gradLock);
+
+    at::Tensor accumulatedGrad;
+    at::Tensor bucketView;
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      auto it = accumulatedGrads_.find(variable);
+      if (it != accumulatedGrads_.end()) {
+        accumulatedGrad = it->value();
+      }
+      auto bucketIt = gradBuckets_.find(variable.unsafeGetTensorImpl());
+      if (bucketIt != gradBuckets_.end()) {
+        bucket = bucketIt->second.bucket;
+        bucketView = bucketIt->second.view;
+      }
+    }
+
+    if (accumulatedGrad.defined()) {
+      // Accumulate multiple grads on the same variable.
+      accumulatedGrad.add_(grad);
     } else {
-      accumulatedGrads_.insert(
-          variable, grad.clone(at::MemoryFormat::Contiguous));
+      // First grad for this variable.
+      at::Tensor firstGrad;
+      if (bucketView.defined()) {
+        TORCH_CHECK(
+            !grad.is_sparse(), "Sparse gradients can't be put in a bucket");
+        firstGrad = bucketView.copy_(grad);
+      } else if (grad.is_sparse()) {
+        firstGrad = grad.clone();
+      } else {
+        firstGrad = grad.clone(at::MemoryFormat::Contiguous);
+      }
+      std::lock_guard<std::mutex> guard(lock_);
+      accumulatedGrads_.insert(variable, std::move(firstGrad));
+    }
+  }
+
+  if (bucket) {
+    bool ready = false;
+    {
+      std::lock_guard<std::mutex> guard(bucket->mutex);
+      if (--bucket->pending == 0) {
+        bucket->pending = bucket->variables.size();
+        ready = true;
+      }
+    }
+    // Called without any lock of the context, it may send RPCs.
+    if (ready) {
+      bucket->callback(bucket->flat);
     }
   }
 }
 
+void DistAutogradContext::addGradBucket(
+    const std::vector<torch::autograd::Variable>& variables,
+    GradBucketCallback callback) {
+  TORCH_CHECK(!variables.empty(), "A gradient bucket needs variables");
+  TORCH_CHECK(callback, "A gradient bucket needs a callback");
+  const auto& first = variables.front();
+  int64_t numel = 0;
+  for (const auto& variable : variables) {
+    TORCH_CHECK(
+        variable.requires_grad(),
+        "Variables of a gradient bucket need to require grad");
+    TORCH_CHECK(
+        variable.layout() == at::kStrided,
+        "Variables of a gradient bucket need to be dense");
+    TORCH_CHECK(
+        variable.scalar_type() == first.scalar_type() &&
+            variable.device() == first.device(),
+        "Variables of a gradient bucket need to have the same dtype and ",
+        "device");
+    numel += variable.numel();
+  }
+
+  auto bucket = std::make_shared<GradBucket>();
+  bucket->variables = variables;
+  bucket->flat = at::zeros(
+      {numel},
+      at::TensorOptions().dtype(first.scalar_type()).device(first.device()));
+  bucket->callback = std::move(callback);
+  bucket->pending = variables.size();
+
+  std::lock_guard<std::mutex> guard(lock_);
+  std::unordered_set<c10::TensorImpl*> seen;
+  for (const auto& variable : variables) {
+    TORCH_CHECK(
+        seen.insert(variable.unsafeGetTensorImpl()).second &&
+            !accumulatedGrads_.contains(variable) &&
+            !gradBuckets_.count(variable.unsafeGetTensorImpl()),
+        "Variable already has a gradient or a bucket in this context");
+  }
+  int64_t offset = 0;
+  for (const auto& variable : variables) {
+    auto view =
+        bucket->flat.narrow(0, offset, variable.numel()).view(variable.sizes());
+    offset += variable.numel();
+    gradBuckets_.emplace(
+        variable.unsafeGetTensorImpl(), GradBucketEntry{bucket, view});
+  }
+}
+
 std::shared_ptr<torch::autograd::GraphTask> DistAutogradContext::
     retrieveGraphTask() {
   std::lock_guard<std::mutex> guard(lock_);
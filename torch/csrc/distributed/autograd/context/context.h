@@ -5,12 +5,15 @@
 #include <torch/csrc/distributed/autograd/functions/recvrpc_backward.h>
 #include <torch/csrc/distributed/autograd/functions/sendrpc_backward.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
+#include <array>
 #include <cstdint>
+#include <functional>
 
 namespace torch {
 namespace distributed {
 namespace autograd {
 
+class DistAccumulateGradCaptureHook;
 class RecvRpcBackward;
 
 // DistAutogradContext which stores information for a single distributed
@@ -53,6 +56,19 @@ class TORCH_API DistAutogradContext {
   // Returns all gradients.
   const c10::Dict<torch::Tensor, torch::Tensor> getGradients() const;
 
+  using GradBucketCallback = std::function<void(const at::Tensor& bucket)>;
+
+  // Groups the gradients of ``variables`` into one flat, contiguous bucket.
+  // The gradients accumulated for them in this context are views into the
+  // bucket. Once all of them got their gradient, ``callback`` is called with
+  // the bucket on the thread of the backward pass while the rest of the pass
+  // goes on, so that it can send the gradients off, e.g. to their owner. The
+  // variables must be dense, have the same dtype and device, and must have
+  // no gradient or bucket in this context yet.
+  void addGradBucket(
+      const std::vector<torch::autograd::Variable>& variables,
+      GradBucketCallback callback);
+
   DistAutogradContext(const DistAutogradContext&) = delete;
   DistAutogradContext& operator=(const DistAutogradContext&) = delete;
   DistAutogradContext(DistAutogradContext&&) = delete;
@@ -69,6 +85,7 @@ class TORCH_API DistAutogradContext {
 
  private:
   friend class BackwardPassCleanupGuard;
+  friend class DistAccumulateGradCaptureHook;
   friend class DistEngine;
   friend class RecvRpcBackward;
 
@@ -121,8 +138,34 @@ class TORCH_API DistAutogradContext {
   // successfully only if all these futures are done and are successful.
   std::vector<std::shared_ptr<rpc::FutureMessage>> outStandingRpcs_;
 
+  struct GradBucket {
+    std::vector<torch::autograd::Variable> variables;
+    at::Tensor flat;
+    GradBucketCallback callback;
+    // Number of variables that didn't get a gradient since the callback was
+    // called last, protected by mutex.
+    size_t pending;
+    std::mutex mutex;
+  };
+
+  // The bucket of a variable, and the view of its gradient in the bucket.
+  struct GradBucketEntry {
+    std::shared_ptr<GradBucket> bucket;
+    at::Tensor view;
+  };
+
+  // Bucket entries by variable.
+  std::unordered_map<c10::TensorImpl*, GradBucketEntry> gradBuckets_;
+
   // Lock to protect concurrent modification of the context.
   mutable std::mutex lock_;
+
+  // Locks held while accumulating a gradient, picked by the variable. They
+  // serialize accumulation into the same variable, while lock_ is only held
+  // to look up and insert entries of accumulatedGrads_. This lets gradients
+  // for different variables accumulate concurrently.
+  static constexpr size_t kNumGradLocks = 16;
+  std::array<std::mutex, kNumGradLocks> gradLocks_;
 };
 
 using ContextPtr = std::shared_ptr<DistAutogradContext>;
@@ -24,6 +24,38 @@ static constexpr char* kEngineCPUQueueSize =
     "local_autograd_engine_cpu_queue_size";
 static constexpr char* kNumAutogradContexts = "num_autograd_contexts";
 
+// Accumulates the gradient of a variable in the autograd context as soon as
+// the local engine computed it, so that it (and its bucket, see
+// DistAutogradContext::addGradBucket) is available while the rest of the
+// backward pass runs. The captured gradient is consumed.
+class DistAccumulateGradCaptureHook
+    : public GraphTask::ExecInfo::Capture::GradCaptureHook {
+ public:
+  DistAccumulateGradCaptureHook(
+      std::shared_ptr<AccumulateGrad> accumulateGrad,
+      const ContextPtr& autogradContext)
+      : accumulateGrad_(std::move(accumulateGrad)),
+        autogradContext_(autogradContext) {}
+
+  at::Tensor operator()(const at::Tensor& grad) override {
+    // It is possible that the grad is not defined since a separate
+    // invocation of the autograd engine on the same node might actually
+    // compute this gradient.
+    if (grad.defined()) {
+      auto autogradContext = autogradContext_.lock();
+      TORCH_INTERNAL_ASSERT(
+          autogradContext, "Autograd context is gone during backward pass");
+      autogradContext->accumulateGrad(accumulateGrad_->variable, grad);
+    }
+    return at::Tensor();
+  }
+
+ private:
+  std::shared_ptr<AccumulateGrad> accumulateGrad_;
+  // Weak since the context owns the GraphTask which owns this hook.
+  std::weak_ptr<DistAutogradContext> autogradContext_;
+};
+
 DistEngine::DistEngine()
     : initializedContextIds_(), engine_(Engine::get_default_engine()) {}
 
@@ -173,6 +205,23 @@ void DistEngine::computeDependencies(
     for (const auto& recvBackwardEdge : recvBackwardEdges) {
       graphTask->exec_info_[recvBackwardEdge.function.get()].needed_ = true;
     }
+
+    // Accumulate the gradients of all AccumulateGrad functions in the context
+    // as soon as they are computed.
+    for (const auto& outputEdge : outputEdges) {
+      auto accumulateGrad =
+          std::dynamic_pointer_cast<AccumulateGrad>(outputEdge.function);
+      if (!accumulateGrad) {
+        continue;
+      }
+      auto& captures = graphTask->exec_info_[accumulateGrad.get()].captures_;
+      TORCH_INTERNAL_ASSERT(captures);
+      for (auto& capture : *captures) {
+        capture.hooks_.push_back(
+            std::make_unique<DistAccumulateGradCaptureHook>(
+                accumulateGrad, autogradContext));
+      }
+    }
   }
 
   // Let autograd context take ownership of the GraphTask.
@@ -192,30 +241,17 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::runEngineAndAccumulateGradients(
   auto accumulateGradFuture = std::make_shared<rpc::FutureMessage>();
 
   futureGrads->addCallback(
-      [autogradContext, outputEdges, accumulateGradFuture](
+      [outputEdges, accumulateGradFuture](
           const variable_list& grads,
           const c10::optional<torch::utils::FutureError>& error) {
         if (error) {
-          // Don't accumulate gradients if we receive an error.
           accumulateGradFuture->setError(error->what());
           return;
         }
 
-        // Accumulate all the gradients in the context.
+        // All the gradients have already been accumulated in the context by
+        // DistAccumulateGradCaptureHook while the engine was running.
         TORCH_INTERNAL_ASSERT(grads.size() == outputEdges.size());
-        for (size_t i = 0; i < grads.size(); i++) {
-          // It is possible that the grad is not defined since a separate
-          // invocation of the autograd engine on the same node might actually
-          // compute this gradient. Also accumulate grads only for
-          // AccumulateGrad function.
-          if (grads[i].defined() &&
-              dynamic_cast<AccumulateGrad*>(outputEdges[i].function.get())) {
-            auto& variable = std::static_pointer_cast<AccumulateGrad>(
-                                 outputEdges[i].function)
-                                 ->variable;
-            autogradContext->accumulateGrad(variable, grads[i]);
-          }
-        }
 
         accumulateGradFuture->markCompleted(rpc::Message());
       });
@@ -223,13 +259,24 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::runEngineAndAccumulateGradients(
   return accumulateGradFuture;
 }
 
+std::shared_ptr<DistEngine::ContextInitialization> DistEngine::
+    getContextInitialization(int64_t contextId) {
+  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+  auto& initialization = initializedContextIds_[contextId];
+  if (!initialization) {
+    initialization = std::make_shared<ContextInitialization>();
+  }
+  return initialization;
+}
+
 std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
     const ContextPtr& autogradContext,
     const std::shared_ptr<Node>& sendFunction,
     bool retainGraph) {
-  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
-  if (initializedContextIds_.find(autogradContext->contextId()) ==
-      initializedContextIds_.end()) {
+  auto initialization =
+      getContextInitialization(autogradContext->contextId());
+  std::unique_lock<std::mutex> lock(initialization->mutex);
+  if (!initialization->initialized) {
     edge_list outputEdges;
     // Pass in a dummy graphRoot since all send functions are the roots.
     auto dummyRoot = std::make_shared<GraphRoot>(edge_list(), variable_list());
@@ -237,7 +284,7 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
         autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
 
     // Mark the autograd context id as initialized and unlock.
-    initializedContextIds_.insert(autogradContext->contextId());
+    initialization->initialized = true;
     lock.unlock();
 
     // Enqueue the current send function.
@@ -313,17 +360,35 @@ void DistEngine::execute(const variable_list& roots, bool retainGraph) {
   // Compute dependencies locally, starting from all roots and all 'send'
   // functions.
   {
-    std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-    // Context should not have been initialized already.
-    TORCH_INTERNAL_ASSERT(
-        initializedContextIds_.find(autogradContext->contextId()) ==
-        initializedContextIds_.end());
+    auto initialization = std::make_shared<ContextInitialization>();
+    std::lock_guard<std::mutex> initializationGuard(initialization->mutex);
+    {
+      std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+      bool inserted =
+          initializedContextIds_
+              .emplace(autogradContext->contextId(), initialization)
+              .second;
+      // Context should not have been initialized already.
+      TORCH_INTERNAL_ASSERT(inserted);
+    }
 
-    computeDependencies(
-        autogradContext, rootEdges, grads, graphRoot, outputEdges, retainGraph);
+    try {
+      computeDependencies(
+          autogradContext,
+          rootEdges,
+          grads,
+          graphRoot,
+          outputEdges,
+          retainGraph);
+    } catch (...) {
+      // Allow another backward pass on the context.
+      std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+      initializedContextIds_.erase(autogradContext->contextId());
+      throw;
+    }
 
     // Mark the autograd context id as initialized.
-    initializedContextIds_.insert(autogradContext->contextId());
+    initialization->initialized = true;
   }
 
   BackwardPassCleanupGuard guard(autogradContext);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <torch/csrc/autograd/engine.h>
@@ -85,9 +86,10 @@ class TORCH_API DistEngine {
       torch::autograd::edge_list& outputEdges,
       bool retainGraph);
 
-  // Run the local autograd engine using the provided graphTask and graphRoot
-  // and accumulate the gradients part 'outputEdges' in the provided autograd
-  // context.
+  // Run the local autograd engine using the provided graphTask and graphRoot.
+  // The gradients part 'outputEdges' are accumulated in the provided autograd
+  // context as soon as they are computed, the returned future completes when
+  // the engine is done.
   std::shared_ptr<rpc::FutureMessage> runEngineAndAccumulateGradients(
       const ContextPtr& autogradContext,
       const std::shared_ptr<torch::autograd::Node>& graphRoot,
@@ -96,9 +98,23 @@ class TORCH_API DistEngine {
   // Run after the backward pass is done to appropriately cleanup structures.
   void cleanupBackwardPass(const ContextPtr& autogradContext);
 
-  // Set of autograd context_ids, which we have already initialized for
-  // distributed autograd on this node (e.g.: already computed dependencies)
-  std::unordered_set<int64_t> initializedContextIds_;
+  // Initialization state of a context on this node. Dependencies are
+  // computed while holding its mutex instead of initializedContextIdsLock_, so
+  // that backward passes of different contexts don't serialize on each other.
+  struct ContextInitialization {
+    std::mutex mutex;
+    bool initialized = false;
+  };
+
+  // Returns the initialization state of the context, creating it if needed.
+  std::shared_ptr<ContextInitialization> getContextInitialization(
+      int64_t contextId);
+
+  // Map of autograd context_ids, which we have already initialized for
+  // distributed autograd on this node (e.g.: already computed dependencies) or
+  // are initializing.
+  std::unordered_map<int64_t, std::shared_ptr<ContextInitialization>>
+      initializedContextIds_;
 
   mutable std::mutex initializedContextIdsLock_;
 
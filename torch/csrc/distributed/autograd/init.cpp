@@ -188,6 +188,63 @@ Example::
 )",
       py::arg("context_id"));
 
+  module.def(
+      "add_grad_bucket",
+      [](int64_t contextId,
+         const std::vector<torch::Tensor>& tensors,
+         py::function callback) {
+        const auto& autogradContext =
+            DistAutogradContainer::getInstance().retrieveContext(contextId);
+        torch::autograd::variable_list variables(tensors.begin(), tensors.end());
+        // The callback is released with the context, possibly on a thread
+        // without the GIL.
+        std::shared_ptr<py::function> pyCallback(
+            new py::function(std::move(callback)), [](py::function* fn) {
+              pybind11::gil_scoped_acquire ag;
+              delete fn;
+            });
+        autogradContext->addGradBucket(
+            variables, [pyCallback](const at::Tensor& bucket) {
+              pybind11::gil_scoped_acquire ag;
+              (*pyCallback)(bucket);
+            });
+      },
+      R"(
+add_grad_bucket(context_id: int, tensors: List[Tensor], callback: Callable[[Tensor], None]) -> None
+
+Groups the gradients accumulated for ``tensors`` in the provided
+``context_id`` into one flat, contiguous bucket. As soon as all of them got
+their gradient in :meth:`torch.distributed.autograd.backward`, ``callback``
+is called with the bucket, while the rest of the backward pass goes on. This
+allows sending the gradients to where they are needed (e.g. with
+:meth:`~torch.distributed.rpc.rpc_async`) overlapped with the backward pass.
+The gradients returned by :meth:`~torch.distributed.autograd.get_gradients`
+for ``tensors`` are views into the bucket.
+
+All tensors need to be dense and have the same dtype and device. This must
+be called before the backward pass, and a tensor can only be added to one
+bucket per context.
+
+Arguments:
+    context_id(int): The autograd context id in which the gradients are
+                     accumulated.
+    tensors(list): Tensors which gradients are put into the bucket.
+    callback(callable): Called with the bucket, a 1-D tensor of the
+                        flattened gradients in the order of ``tensors``.
+
+Example::
+
+    >> import torch.distributed.autograd as dist_autograd
+    >> with dist_autograd.context() as context_id:
+    >>      dist_autograd.add_grad_bucket(
+    >>          context_id, [t1, t2], lambda bucket: print(bucket))
+    >>      loss = rpc.rpc_sync("worker1", torch.add, args=(t1, t2)).sum()
+    >>      dist_autograd.backward([loss])
+)",
+      py::arg("context_id"),
+      py::arg("tensors"),
+      py::arg("callback"));
+
   Py_RETURN_TRUE;
 }
 } // namespace
@@ -3,6 +3,7 @@
 #include <deque>
 
 #include <ATen/core/functional.h>
+#include <ATen/core/grad_mode.h>
 #include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/tensor_flatten.h>
 
@@ -79,4 +80,79 @@ void broadcast_coalesced(
   }
 }
 
+namespace {
+
+// Whether `tensor` still aliases the slice `view` of a flat bucket tensor.
+bool aliases(const at::Tensor& tensor, const at::Tensor& view) {
+  return tensor.data_ptr() == view.data_ptr() &&
+      tensor.sizes() == view.sizes() && tensor.strides() == view.strides();
+}
+
+} // namespace
+
+PersistentBroadcast::PersistentBroadcast(
+    std::shared_ptr<c10d::ProcessGroup> process_group,
+    std::vector<at::Tensor> tensors,
+    size_t buffer_size)
+    : process_group_(std::move(process_group)) {
+  const auto bucket_indices =
+      compute_bucket_assignment_by_size(tensors, {buffer_size});
+
+  at::NoGradGuard no_grad;
+  buckets_.reserve(bucket_indices.size());
+  for (const auto& indices : bucket_indices) {
+    int64_t numel = 0;
+    for (const auto index : indices) {
+      numel += tensors[index].numel();
+    }
+
+    Bucket bucket;
+    const auto flat = at::empty({numel}, tensors[indices.front()].options());
+    int64_t offset = 0;
+    for (const auto index : indices) {
+      auto& tensor = tensors[index];
+      auto view =
+          flat.narrow(0, offset, tensor.numel()).view(tensor.sizes());
+      view.copy_(tensor);
+      if (tensor.is_contiguous()) {
+        tensor.set_(flat.storage(), offset, tensor.sizes(), view.strides());
+      }
+      bucket.tensors.push_back(tensor);
+      bucket.views.push_back(std::move(view));
+      offset += tensor.numel();
+    }
+    bucket.flat.push_back(flat);
+    buckets_.push_back(std::move(bucket));
+  }
+}
+
+void PersistentBroadcast::broadcast() {
+  at::NoGradGuard no_grad;
+  for (auto& bucket : buckets_) {
+    for (size_t i = 0; i < bucket.tensors.size(); i++) {
+      if (!aliases(bucket.tensors[i], bucket.views[i])) {
+        bucket.views[i].copy_(bucket.tensors[i], /*non_blocking=*/true);
+      }
+    }
+  }
+
+  // The flat tensors are not allocated per call, so all buckets can be in
+  // flight at the same time.
+  std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> work;
+  work.reserve(buckets_.size());
+  for (auto& bucket : buckets_) {
+    work.push_back(process_group_->broadcast(bucket.flat));
+  }
+
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    work[i]->wait();
+    auto& bucket = buckets_[i];
+    for (size_t j = 0; j < bucket.tensors.size(); j++) {
+      if (!aliases(bucket.tensors[j], bucket.views[j])) {
+        bucket.tensors[j].copy_(bucket.views[j], /*non_blocking=*/true);
+      }
+    }
+  }
+}
+
 } // namespace c10d
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <ATen/ATen.h>
 #include <c10d/ProcessGroup.hpp>
@@ -13,4 +14,36 @@ void broadcast_coalesced(
     at::TensorList tensors,
     size_t buffer_size);
 
+// Broadcasts the same tensors from rank 0 over and over, e.g. the buffers of a
+// module before every forward pass in DDP. The tensors are bucketed once and
+// every bucket is backed by a flat tensor allocated on construction. The
+// contiguous tensors of a bucket are pointed at their slice of the flat
+// tensor with `set_`, so a broadcast is a single collective per bucket that
+// neither flattens nor unflattens them. Tensors that are not contiguous, or
+// that were since pointed elsewhere, are copied in and out of their slice.
+class PersistentBroadcast {
+ public:
+  PersistentBroadcast(
+      std::shared_ptr<c10d::ProcessGroup> process_group,
+      std::vector<at::Tensor> tensors,
+      size_t buffer_size);
+
+  // Broadcasts the current values of the tensors from rank 0.
+  void broadcast();
+
+ protected:
+  struct Bucket {
+    // The flat tensor. It must be stored in a vector because
+    // c10d::ProcessGroup::broadcast takes a vector argument.
+    std::vector<at::Tensor> flat;
+
+    // The tensors of the bucket and the views of `flat` they correspond to.
+    std::vector<at::Tensor> tensors;
+    std::vector<at::Tensor> views;
+  };
+
+  std::shared_ptr<c10d::ProcessGroup> process_group_;
+  std::vector<Bucket> buckets_;
+};
+
 } // namespace c10d
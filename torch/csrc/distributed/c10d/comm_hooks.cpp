@@ -0,0 +1,183 @@
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace c10d {
+
+std::shared_ptr<ProcessGroup::Work> FP16CompressHook::runHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& compressed = compressed_[bucket_index];
+  compressed.clear();
+  for (const auto& tensor : tensors) {
+    compressed.push_back(tensor.to(at::kHalf));
+  }
+  return process_group.allreduce(compressed);
+}
+
+void FP16CompressHook::finalizeHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  const auto& compressed = compressed_.at(bucket_index);
+  for (size_t i = 0; i < tensors.size(); i++) {
+    tensors[i].copy_(compressed[i]);
+  }
+}
+
+namespace {
+
+// The shape of the matrix the flat contents of a bucket are viewed as.
+std::pair<int64_t, int64_t> matrixShape(int64_t length) {
+  const auto cols = static_cast<int64_t>(std::ceil(std::sqrt(length)));
+  const auto rows = (length + cols - 1) / cols;
+  return {rows, cols};
+}
+
+} // namespace
+
+PowerSGDHook::PowerSGDHook(int64_t rank) : rank_(rank) {
+  TORCH_CHECK(rank > 0, "PowerSGD requires a positive rank, got ", rank);
+}
+
+std::shared_ptr<ProcessGroup::Work> PowerSGDHook::runHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& state = states_[bucket_index];
+  const auto length = tensors[0].numel();
+  int64_t rows, cols;
+  std::tie(rows, cols) = matrixShape(length);
+  const auto rank = std::min({rank_, rows, cols});
+  state.compressed = rank * (rows + cols) < length;
+  if (!state.compressed) {
+    return process_group.allreduce(tensors);
+  }
+
+  // (Re-)initialize the state if this is the first iteration or the buckets
+  // were rebuilt.
+  if (state.matrices.size() != tensors.size() ||
+      state.matrices[0].numel() != rows * cols ||
+      state.qs[0].size(1) != rank) {
+    state = BucketState();
+    state.compressed = true;
+    for (const auto& tensor : tensors) {
+      state.matrices.push_back(at::zeros({rows, cols}, tensor.options()));
+      state.errors.push_back(at::zeros({rows, cols}, tensor.options()));
+      state.qs.push_back(at::randn({cols, rank}, tensor.options()));
+    }
+    // All processes have to start from the same Q.
+    process_group.broadcast(state.qs)->wait();
+  }
+
+  state.ps.clear();
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto& matrix = state.matrices[i];
+    auto flat = matrix.view({-1});
+    flat.narrow(0, 0, length).copy_(tensors[i]);
+    flat.narrow(0, length, rows * cols - length).zero_();
+    matrix.add_(state.errors[i]);
+    state.ps.push_back(at::mm(matrix, state.qs[i]));
+  }
+  return process_group.allreduce(state.ps);
+}
+
+void PowerSGDHook::finalizeHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& state = states_.at(bucket_index);
+  if (!state.compressed) {
+    return;
+  }
+  const auto length = tensors[0].numel();
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto& p = state.ps[i];
+    p = std::get<0>(at::qr(p));
+    auto& q = state.qs[i];
+    q = at::mm(state.matrices[i].t(), p);
+    // Error feedback: what the local approximation misses is added to the
+    // bucket in the next iteration. The padding of the matrix must stay zero.
+    auto& error = state.errors[i];
+    at::sub_out(error, state.matrices[i], at::mm(p, q.t()));
+    auto flat_error = error.view({-1});
+    flat_error.narrow(0, length, flat_error.numel() - length).zero_();
+  }
+  process_group.allreduce(state.qs)->wait();
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto approximation = at::mm(state.ps[i], state.qs[i].t()).view({-1});
+    tensors[i].copy_(approximation.narrow(0, 0, length));
+  }
+}
+
+TopKSparsifyHook::TopKSparsifyHook(double ratio) : ratio_(ratio) {
+  TORCH_CHECK(
+      ratio > 0 && ratio <= 1,
+      "Top-k sparsification requires a ratio in (0, 1], got ",
+      ratio);
+}
+
+std::shared_ptr<ProcessGroup::Work> TopKSparsifyHook::runHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& state = states_[bucket_index];
+  const auto length = tensors[0].numel();
+  const auto k = std::min(
+      length, std::max<int64_t>(1, static_cast<int64_t>(ratio_ * length)));
+
+  // (Re-)initialize the state if this is the first iteration or the buckets
+  // were rebuilt.
+  if (state.errors.size() != tensors.size() ||
+      state.errors[0].numel() != length) {
+    state = BucketState();
+    for (const auto& tensor : tensors) {
+      state.errors.push_back(at::zeros_like(tensor));
+    }
+  }
+
+  state.indices.clear();
+  state.values.clear();
+  for (size_t i = 0; i < tensors.size(); i++) {
+    // The error starts out as what was not sent in the last iteration and
+    // ends up as what will not be sent in this one.
+    auto& error = state.errors[i];
+    error.add_(tensors[i]);
+    auto indices = std::get<1>(error.abs().topk(k));
+    state.values.push_back(error.index_select(0, indices));
+    state.indices.push_back(indices);
+    error.index_fill_(0, indices, 0);
+  }
+
+  const auto num_gathered = tensors.size() * process_group.getSize();
+  state.gathered_indices.assign(tensors.size(), {});
+  state.gathered_values.assign(tensors.size(), {});
+  for (size_t i = 0; i < tensors.size(); i++) {
+    for (size_t j = 0; j < num_gathered; j++) {
+      state.gathered_indices[i].push_back(at::empty_like(state.indices[i]));
+      state.gathered_values[i].push_back(at::empty_like(state.values[i]));
+    }
+  }
+  state.indices_work =
+      process_group.allgather(state.gathered_indices, state.indices);
+  return process_group.allgather(state.gathered_values, state.values);
+}
+
+void TopKSparsifyHook::finalizeHook(
+    ProcessGroup& process_group,
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& state = states_.at(bucket_index);
+  state.indices_work->wait();
+  state.indices_work.reset();
+  for (size_t i = 0; i < tensors.size(); i++) {
+    tensors[i].zero_();
+    tensors[i].index_add_(
+        0, at::cat(state.gathered_indices[i]), at::cat(state.gathered_values[i]));
+  }
+}
+
+} // namespace c10d
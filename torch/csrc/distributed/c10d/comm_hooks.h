@@ -0,0 +1,126 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/ATen.h>
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// A communication hook replaces the allreduce that the Reducer uses to reduce
+// the contents of a dense bucket, e.g. to compress them before they are sent.
+//
+// When the bucket at `bucket_index` is ready, runHook is called with its flat
+// contents, one tensor per model replica, which are already divided by the
+// number of processes. It kicks off the communication and returns its work.
+// The Reducer waits for that work when the backward pass is finalized and
+// then calls finalizeHook, which must leave the (approximate) sum of the
+// contents over all replicas and processes in `tensors`, like allreduce would.
+//
+// Buckets of sparse gradients are always allreduced. Hooks are called with
+// the Reducer's mutex held and may keep per bucket state across iterations.
+class CommHook {
+ public:
+  virtual ~CommHook() = default;
+
+  virtual std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) = 0;
+
+  virtual void finalizeHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) {}
+};
+
+// Allreduces the buckets in half precision, halving the bytes sent.
+class FP16CompressHook : public CommHook {
+ public:
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+  void finalizeHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  std::unordered_map<size_t, std::vector<at::Tensor>> compressed_;
+};
+
+// PowerSGD low-rank compression with error feedback (Vogels et al., 2019).
+//
+// The flat contents of a bucket (plus the error left over from the previous
+// iteration) are viewed as a roughly square matrix M, which is approximated
+// by P Q^T with `rank` columns: P = M Q is allreduced and orthogonalized,
+// then Q = M^T P is allreduced, so only the two thin factors are sent. Q is
+// reused as the starting point of the next iteration. Buckets too small to
+// be compressed at this rank are allreduced as they are.
+class PowerSGDHook : public CommHook {
+ public:
+  explicit PowerSGDHook(int64_t rank);
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+  void finalizeHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  struct BucketState {
+    // One per replica.
+    std::vector<at::Tensor> matrices;
+    std::vector<at::Tensor> errors;
+    std::vector<at::Tensor> ps;
+    std::vector<at::Tensor> qs;
+    bool compressed = false;
+  };
+
+  const int64_t rank_;
+  std::unordered_map<size_t, BucketState> states_;
+};
+
+// Top-k sparsification with error feedback: every process only sends the
+// `ratio` fraction of the entries of a bucket with the largest magnitude
+// (with their indices). The entries that are not sent are added to the
+// bucket in the next iteration.
+class TopKSparsifyHook : public CommHook {
+ public:
+  explicit TopKSparsifyHook(double ratio);
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+  void finalizeHook(
+      ProcessGroup& process_group,
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  struct BucketState {
+    // One per replica.
+    std::vector<at::Tensor> errors;
+    std::vector<at::Tensor> indices;
+    std::vector<at::Tensor> values;
+    // Gathered from all replicas and processes, for every replica.
+    std::vector<std::vector<at::Tensor>> gathered_indices;
+    std::vector<std::vector<at::Tensor>> gathered_values;
+    std::shared_ptr<ProcessGroup::Work> indices_work;
+  };
+
+  const double ratio_;
+  std::unordered_map<size_t, BucketState> states_;
+};
+
+} // namespace c10d
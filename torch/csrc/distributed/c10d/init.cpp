@@ -17,9 +17,11 @@
 #endif
 
 #include <c10d/PrefixStore.hpp>
+#include <c10d/ProcessGroupHierarchical.hpp>
 #include <c10d/ProcessGroupRoundRobin.hpp>
 #include <c10d/TCPStore.hpp>
 #include <pybind11/chrono.h>
+#include <pybind11/functional.h>
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/comm.h>
@@ -116,21 +118,44 @@ PyObject* c10d_init(PyObject* _unused) {
 
   auto module = py::handle(c10d_module).cast<py::module>();
 
+  auto commHook = shared_ptr_class_<::c10d::CommHook>(module, "CommHook");
+
+  shared_ptr_class_<::c10d::FP16CompressHook>(
+      module, "FP16CompressHook", commHook)
+      .def(py::init<>());
+
+  shared_ptr_class_<::c10d::PowerSGDHook>(module, "PowerSGDHook", commHook)
+      .def(py::init<int64_t>(), py::arg("rank"));
+
+  shared_ptr_class_<::c10d::TopKSparsifyHook>(
+      module, "TopKSparsifyHook", commHook)
+      .def(py::init<double>(), py::arg("ratio"));
+
   shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
       .def(
           py::init<
               std::vector<std::vector<torch::autograd::Variable>>,
               std::vector<std::vector<size_t>>,
               std::shared_ptr<::c10d::ProcessGroup>,
-              std::vector<std::vector<bool>>>(),
+              std::vector<std::vector<bool>>,
+              std::vector<size_t>,
+              bool,
+              bool>(),
           py::arg("replicas"),
           py::arg("bucket_indices"),
           py::arg("process_group"),
-          py::arg("expect_sparse_gradients") = std::vector<std::vector<bool>>())
+          py::arg("expect_sparse_gradients") = std::vector<std::vector<bool>>(),
+          py::arg("bucket_size_limits") = std::vector<size_t>(),
+          py::arg("gradient_as_bucket_view") = false,
+          py::arg("find_unused_parameters_by_hooks") = false)
       .def(
           "initialize_buckets",
           &::c10d::Reducer::initialize_buckets,
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "get_bucket_indices",
+          &::c10d::Reducer::get_bucket_indices,
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "prepare_for_backward",
           &::c10d::Reducer::prepare_for_backward,
@@ -140,6 +165,10 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "register_comm_hook",
+          &::c10d::Reducer::register_comm_hook,
+          py::arg("hook"))
       .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
@@ -200,6 +229,10 @@ They are used in specifying strategies for reduction collectives, e.g.,
       .def_readwrite("reduceOp", &::c10d::ReduceScatterOptions::reduceOp)
       .def_readwrite("timeout", &::c10d::ReduceScatterOptions::timeout);
 
+  py::class_<::c10d::AllToAllOptions>(module, "AllToAllOptions")
+      .def(py::init<>())
+      .def_readwrite("timeout", &::c10d::AllToAllOptions::timeout);
+
   py::class_<::c10d::BarrierOptions>(module, "BarrierOptions")
       .def(py::init<>())
       .def_readwrite("timeout", &::c10d::BarrierOptions::timeout);
@@ -233,6 +266,35 @@ They are used in specifying strategies for reduction collectives, e.g.,
               "add",
               &::c10d::Store::add,
               py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (const auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<const char*>(value.data()),
+                      value.size()));
+                }
+                return result;
+              })
           .def(
               "set_timeout",
               &::c10d::Store::setTimeout,
@@ -259,7 +321,25 @@ They are used in specifying strategies for reduction collectives, e.g.,
       .def(py::init<>());
 
   shared_ptr_class_<::c10d::TCPStore>(module, "TCPStore", store)
-      .def(py::init<const std::string&, int, int, bool>());
+      .def(
+          py::init<
+              const std::string&,
+              int,
+              int,
+              bool,
+              std::chrono::milliseconds,
+              bool,
+              int,
+              int>(),
+          py::arg("host_name"),
+          py::arg("port"),
+          py::arg("world_size"),
+          py::arg("is_master") = false,
+          py::arg("timeout") =
+              std::chrono::milliseconds(::c10d::Store::kDefaultTimeout),
+          py::arg("wait_for_workers") = true,
+          py::arg("num_shards") = 1,
+          py::arg("num_server_threads") = 1);
 
   shared_ptr_class_<::c10d::PrefixStore>(module, "PrefixStore", store)
       .def(py::init<const std::string&, std::shared_ptr<::c10d::Store>>());
@@ -457,6 +537,24 @@ They are used in specifying strategies for reduction collectives, e.g.,
               py::arg("input_tensor"),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "alltoall_base",
+              &::c10d::ProcessGroup::alltoall_base,
+              py::arg("output_tensor"),
+              py::arg("input_tensor"),
+              py::arg("output_split_sizes"),
+              py::arg("input_split_sizes"),
+              py::arg("opts") = ::c10d::AllToAllOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "alltoall",
+              &::c10d::ProcessGroup::alltoall,
+              py::arg("output_tensors"),
+              py::arg("input_tensors"),
+              py::arg("opts") = ::c10d::AllToAllOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "send",
               &::c10d::ProcessGroup::send,
@@ -492,6 +590,28 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("process_groups"),
       py::call_guard<py::gil_scoped_release>());
 
+  // The factory is called from the constructor, so it keeps the GIL.
+  shared_ptr_class_<::c10d::ProcessGroupHierarchical>(
+      module, "ProcessGroupHierarchical", processGroup)
+      .def(
+          py::init<
+              const std::shared_ptr<::c10d::Store>&,
+              int,
+              int,
+              ::c10d::ProcessGroupHierarchical::Factory,
+              std::string>(),
+          py::arg("store"),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("factory"),
+          py::arg("host_name") = "")
+      .def_property_readonly(
+          "local_rank", &::c10d::ProcessGroupHierarchical::getLocalRank)
+      .def_property_readonly(
+          "local_size", &::c10d::ProcessGroupHierarchical::getLocalSize)
+      .def_property_readonly(
+          "node_count", &::c10d::ProcessGroupHierarchical::getNodeCount);
+
 #ifdef USE_C10D_GLOO
   auto processGroupGloo = shared_ptr_class_<::c10d::ProcessGroupGloo>(
       module, "ProcessGroupGloo", processGroup);
@@ -568,12 +688,14 @@ They are used in specifying strategies for reduction collectives, e.g.,
               const std::shared_ptr<::c10d::Store>&,
               int,
               int,
-              const std::chrono::milliseconds&>(),
+              const std::chrono::milliseconds&,
+              int>(),
           py::arg("store"),
           py::arg("rank"),
           py::arg("size"),
           py::arg("timeout") = std::chrono::milliseconds(
-              ::c10d::ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis));
+              ::c10d::ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis),
+          py::arg("comm_pool_size") = 1);
 #endif
 
 #ifdef USE_C10D_MPI
@@ -673,6 +795,22 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("buffer_size"),
       py::call_guard<py::gil_scoped_release>());
 
+  shared_ptr_class_<::c10d::PersistentBroadcast>(
+      module, "_PersistentBroadcast")
+      .def(
+          py::init<
+              std::shared_ptr<::c10d::ProcessGroup>,
+              std::vector<at::Tensor>,
+              size_t>(),
+          py::arg("process_group"),
+          py::arg("tensors"),
+          py::arg("buffer_size"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "broadcast",
+          &::c10d::PersistentBroadcast::broadcast,
+          py::call_guard<py::gil_scoped_release>());
+
   module.def(
       "_test_python_store",
       // Define a function that takes a c10d store and runs a few tests.
@@ -43,7 +43,10 @@ Reducer::Reducer(
     std::vector<std::vector<torch::autograd::Variable>> replicas,
     std::vector<std::vector<size_t>> bucket_indices,
     std::shared_ptr<c10d::ProcessGroup> process_group,
-    std::vector<std::vector<bool>> expect_sparse_gradients)
+    std::vector<std::vector<bool>> expect_sparse_gradients,
+    std::vector<size_t> bucket_size_limits,
+    bool gradient_as_bucket_view,
+    bool find_unused_parameters_by_hooks)
     : replicas_(std::move(replicas)),
       process_group_(std::move(process_group)),
       expect_sparse_gradients_(std::move(expect_sparse_gradients)),
@@ -51,7 +54,12 @@ Reducer::Reducer(
       require_finalize_(false),
       next_bucket_(0),
       has_marked_unused_parameters_(false),
+      find_unused_parameters_by_hooks_(find_unused_parameters_by_hooks),
+      mark_unused_after_backward_(false),
       local_used_maps_reduced_(false),
+      gradient_as_bucket_view_(gradient_as_bucket_view),
+      bucket_size_limits_(std::move(bucket_size_limits)),
+      has_rebuilt_buckets_(bucket_size_limits_.empty()),
       backward_stats_base_(0) {
   TORCH_CHECK(replicas_.size() >= 1, "Expected at least one model replica.");
   TORCH_CHECK(replicas_[0].size() >= 1, "Expected at least one parameter.");
@@ -160,6 +168,7 @@ Reducer::Reducer(
         backward_stats_.begin(),
         backward_stats_.end(),
         [=](std::vector<int64_t>& v) { v.resize(variable_count); });
+    marked_ready_.assign(replica_count, std::vector<bool>(variable_count));
   }
 
   // Initialize locally used parameter maps
@@ -230,14 +239,18 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
         bucket_view.toString(),
         ", got ",
         grad.toString());
-    // Assert that the grad tensor and the bucket don't share storage.
-    // If they did, we could avoid the copy altogether.
-    // The reason for not doing this is that existing code calls
-    // `detach_` from `zero_grad`, which is incompatible with views.
-    TORCH_INTERNAL_ASSERT(!grad.is_alias_of(bucket_view));
+    // With `gradient_as_bucket_view_`, the gradient was accumulated into the
+    // bucket already, unless it was replaced since the buckets were set up.
+    if (grad.is_alias_of(bucket_view)) {
+      TORCH_INTERNAL_ASSERT(gradient_as_bucket_view_);
+      return;
+    }
     TORCH_INTERNAL_ASSERT(grad.device() == bucket_view.device());
     TORCH_INTERNAL_ASSERT(grad.numel() == bucket_view.numel());
     bucket_view.copy_(grad.view({-1}), /* non_blocking */ true);
+    if (gradient_as_bucket_view_) {
+      grad = bucket_view.view(variable.sizes());
+    }
   } else {
     bucket_view.zero_();
   }
@@ -282,6 +295,16 @@ void Reducer::autograd_hook(VariableIndex index) {
     return;
   }
 
+  // When finding unused parameters by hooks, the variables that haven't been
+  // marked ready once the backward pass is over are the unused ones.
+  if (mark_unused_after_backward_ && !has_marked_unused_parameters_) {
+    has_marked_unused_parameters_ = true;
+    torch::autograd::Engine::get_default_engine().queue_callback([=] {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->mark_unmarked_variables_ready();
+    });
+  }
+
   // If there are model parameters that went unused when computing the model
   // output, they won't be part of the autograd graph, and won't receive
   // gradients. These parameters are discovered in the `prepare_for_backward`
@@ -306,6 +329,10 @@ void Reducer::mark_variable_ready(VariableIndex index) {
       "Out of range variable index.");
   backward_stats_[replica_index][variable_index] =
       current_time_in_nanos() - backward_stats_base_;
+  marked_ready_[replica_index][variable_index] = true;
+  if (!has_rebuilt_buckets_ && replica_index == 0) {
+    ready_order_.push_back(variable_index);
+  }
 
   // Any time we mark a variable ready (be it in line due to unused parameters,
   // or via an autograd hook), we require a call to the finalize function. If
@@ -382,6 +409,30 @@ void Reducer::mark_variable_ready(VariableIndex index) {
   }
 }
 
+void Reducer::mark_unmarked_variables_ready() {
+  for (size_t replica_index = 0; replica_index < marked_ready_.size();
+       replica_index++) {
+    const auto& marked = marked_ready_[replica_index];
+    for (size_t variable_index = 0; variable_index < marked.size();
+         variable_index++) {
+      if (!marked[variable_index]) {
+        mark_variable_ready(VariableIndex{replica_index, variable_index});
+      }
+    }
+  }
+}
+
+void Reducer::register_comm_hook(std::shared_ptr<CommHook> hook) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(hook, "Expected a communication hook, got None");
+  TORCH_CHECK(
+      !comm_hook_, "A communication hook can only be registered once");
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "A communication hook must be registered before the backward pass");
+  comm_hook_ = std::move(hook);
+}
+
 // Called when the bucket at the specified index is ready to be reduced.
 void Reducer::mark_bucket_ready(size_t bucket_index) {
   TORCH_INTERNAL_ASSERT(bucket_index >= next_bucket_);
@@ -412,8 +463,23 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
-    bucket.work = process_group_->allreduce(tensors);
+    if (comm_hook_ && !bucket.expect_sparse_gradient) {
+      bucket.work =
+          comm_hook_->runHook(*process_group_, next_bucket_, tensors);
+    } else {
+      bucket.work = process_group_->allreduce(tensors);
+    }
+  }
+}
+
+std::vector<std::vector<size_t>> Reducer::get_bucket_indices() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::vector<size_t>> bucket_indices;
+  bucket_indices.reserve(buckets_.size());
+  for (const auto& bucket : buckets_) {
+    bucket_indices.push_back(bucket.variable_indices);
   }
+  return bucket_indices;
 }
 
 void Reducer::initialize_buckets(
@@ -502,6 +568,25 @@ void Reducer::initialize_buckets(
 
         // Allocate bucket contents tensor.
         replica.contents = at::empty({static_cast<long>(offset)}, options);
+
+        // Move existing gradients into the bucket, e.g. when the buckets are
+        // rebuilt. Undefined gradients become views once they are computed.
+        if (gradient_as_bucket_view_) {
+          for (size_t i = 0; i < replica.variables.size(); i++) {
+            auto& variable = replica.variables[i];
+            auto& grad = variable.grad();
+            if (grad.defined()) {
+              auto bucket_view = replica.contents
+                                     .narrow(
+                                         0,
+                                         replica.offsets[i],
+                                         replica.lengths[i])
+                                     .view(variable.sizes());
+              bucket_view.copy_(grad);
+              grad = bucket_view;
+            }
+          }
+        }
       }
 
       // Add bucket replica to enclosing bucket.
@@ -532,8 +617,65 @@ void Reducer::initialize_buckets(
 // for reduction as soon as the first autograd hook is called. This is not
 // done immediately because the model output may be ignored, and we only
 // want to start performing reductions on `torch.autograd.backward()`.
+void Reducer::rebuild_buckets() {
+  std::vector<std::vector<size_t>> bucket_indices;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto variable_count = replicas_[0].size();
+    // Don't rebuild if the previous iteration was cut short (it would fail
+    // below anyway) or didn't record the order.
+    if (has_rebuilt_buckets_ || require_finalize_ ||
+        ready_order_.size() != variable_count) {
+      ready_order_.clear();
+      return;
+    }
+
+    // Processes may see gradients in a different order, take the one of the
+    // first process.
+    auto order = at::tensor(
+        std::vector<int64_t>(ready_order_.begin(), ready_order_.end()),
+        at::TensorOptions().dtype(at::kLong));
+    std::vector<at::Tensor> tensors = {order.to(replicas_[0][0].device())};
+    process_group_->broadcast(tensors)->wait();
+    order = tensors[0].cpu();
+    const auto order_data = order.data_ptr<int64_t>();
+
+    std::vector<at::Tensor> ordered_variables;
+    std::vector<bool> ordered_expect_sparse_gradient;
+    ordered_variables.reserve(variable_count);
+    ordered_expect_sparse_gradient.reserve(variable_count);
+    for (size_t i = 0; i < variable_count; i++) {
+      const auto variable_index = static_cast<size_t>(order_data[i]);
+      TORCH_INTERNAL_ASSERT(variable_index < variable_count);
+      ordered_variables.push_back(replicas_[0][variable_index]);
+      ordered_expect_sparse_gradient.push_back(
+          expect_sparse_gradients_[0][variable_index]);
+    }
+
+    // The buckets come back sorted by their position in the ready order, which
+    // is the order they are reduced in.
+    bucket_indices = compute_bucket_assignment_by_size(
+        ordered_variables,
+        bucket_size_limits_,
+        ordered_expect_sparse_gradient);
+    for (auto& bucket : bucket_indices) {
+      for (auto& index : bucket) {
+        index = static_cast<size_t>(order_data[index]);
+      }
+    }
+
+    has_rebuilt_buckets_ = true;
+    ready_order_.clear();
+  }
+  initialize_buckets(std::move(bucket_indices));
+}
+
 void Reducer::prepare_for_backward(
     const std::vector<torch::autograd::Variable>& outputs) {
+  if (!has_rebuilt_buckets_) {
+    rebuild_buckets();
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
   std::unordered_set<torch::autograd::Node*> seen;
   std::vector<torch::autograd::Node*> queue;
@@ -576,7 +718,11 @@ void Reducer::prepare_for_backward(
 
   // Reset unused parameter accounting.
   has_marked_unused_parameters_ = false;
+  mark_unused_after_backward_ = false;
   unused_parameters_.clear();
+  for (auto& marked : marked_ready_) {
+    std::fill(marked.begin(), marked.end(), false);
+  }
 
   // If no outputs are specified, we assume that autograd hooks for ALL
   // variables will be called, and we don't have to search the autograd graph
@@ -585,6 +731,13 @@ void Reducer::prepare_for_backward(
     return;
   }
 
+  // The unused parameters are marked at the end of the backward pass instead,
+  // see `find_unused_parameters_by_hooks`.
+  if (find_unused_parameters_by_hooks_) {
+    mark_unused_after_backward_ = true;
+    return;
+  }
+
   // Seed queue with the grad functions of all outputs.
   for (const auto& output : outputs) {
     const auto& grad_fn = output.grad_fn();
@@ -669,12 +822,20 @@ void Reducer::finalize_bucket_dense(Bucket& bucket) {
           replica.contents.narrow(0, offset, length).view(variable.sizes());
       auto& grad = variable.grad();
 
-      // If a parameter is globally unused, we keep its grad untouched.
+      // If a parameter is globally unused, we keep its grad untouched. Only
+      // with `gradient_as_bucket_view_` a grad that is a view of the bucket
+      // was averaged in place with the others.
       if (!global_unused) {
-        if (!grad.defined()) {
-          grad = at::empty(bucket_view.sizes(), bucket_view.options());
+        if (gradient_as_bucket_view_) {
+          if (!grad.defined() || !grad.is_alias_of(bucket_view)) {
+            grad = bucket_view;
+          }
+        } else {
+          if (!grad.defined()) {
+            grad = at::empty(bucket_view.sizes(), bucket_view.options());
+          }
+          grad.copy_(bucket_view);
         }
-        grad.copy_(bucket_view);
       }
     }
   }
@@ -706,12 +867,22 @@ void Reducer::finalize_backward() {
   TORCH_INTERNAL_ASSERT(next_bucket_ == buckets_.size());
 
   // Wait for asynchronous reduction to complete and unflatten contents.
-  for (auto& bucket : buckets_) {
+  for (size_t bucket_index = 0; bucket_index < buckets_.size();
+       bucket_index++) {
+    auto& bucket = buckets_[bucket_index];
     TORCH_INTERNAL_ASSERT(bucket.work);
     bucket.work->wait();
     if (bucket.expect_sparse_gradient) {
       finalize_bucket_sparse(bucket);
     } else {
+      if (comm_hook_) {
+        std::vector<at::Tensor> tensors;
+        tensors.reserve(bucket.replicas.size());
+        for (const auto& replica : bucket.replicas) {
+          tensors.push_back(replica.contents);
+        }
+        comm_hook_->finalizeHook(*process_group_, bucket_index, tensors);
+      }
       finalize_bucket_dense(bucket);
     }
   }
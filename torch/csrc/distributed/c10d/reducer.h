@@ -10,6 +10,7 @@
 #include <c10d/ProcessGroup.hpp>
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/autograd/variable.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 
 namespace c10d {
 
@@ -19,11 +20,33 @@ class Reducer {
   // The bucket assignment for this reducer is specified as a list of
   // buckets, each of which is specified as a list of indices into the
   // variables list for **a single replica** (i.e. `variables[0]`).
+  //
+  // If `bucket_size_limits` is not empty, the order in which gradients become
+  // ready is recorded during the first iteration, and before the second one
+  // the buckets are rebuilt once in that order using these size limits (see
+  // `compute_bucket_assignment_by_size`).
+  //
+  // If `gradient_as_bucket_view` is true, the grad of every variable in a
+  // dense bucket is a view into the bucket's contents, so that gradients are
+  // accumulated right into the buckets and reduced without copying them in
+  // and out. A grad that is replaced, e.g. by setting it to None, is copied
+  // once and then becomes a view again.
+  //
+  // If `find_unused_parameters_by_hooks` is true, `prepare_for_backward` does
+  // not traverse the autograd graph of the outputs to find the parameters
+  // that won't receive a gradient. Instead, the parameters whose autograd
+  // hook hasn't fired by the end of the backward pass are marked ready then.
+  // This makes the detection free, but the buckets holding unused parameters
+  // (and the buckets after them) are only reduced at the end of the backward
+  // pass instead of overlapping with it.
   explicit Reducer(
       std::vector<std::vector<torch::autograd::Variable>> replicas,
       std::vector<std::vector<size_t>> bucket_indices,
       std::shared_ptr<c10d::ProcessGroup> process_group,
-      std::vector<std::vector<bool>> expect_sparse_gradients);
+      std::vector<std::vector<bool>> expect_sparse_gradients,
+      std::vector<size_t> bucket_size_limits = {},
+      bool gradient_as_bucket_view = false,
+      bool find_unused_parameters_by_hooks = false);
 
   ~Reducer() noexcept(false);
 
@@ -33,6 +56,10 @@ class Reducer {
   // all live on the same device and have the same dimensionality.
   void initialize_buckets(std::vector<std::vector<size_t>> bucket_indices);
 
+  // Returns the current bucket assignment, as a list of buckets each of which
+  // is a list of indices in the variables list.
+  std::vector<std::vector<size_t>> get_bucket_indices();
+
   // This function is called when the forward function has produced an output,
   // and the user wishes to reduce gradients in the backwards pass.
   // If they don't, and wish to accumulate gradients before reducing them,
@@ -47,6 +74,11 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Registers a hook that reduces the dense buckets instead of allreduce,
+  // see CommHook. It can only be registered once, and not while a backward
+  // pass is reducing gradients.
+  void register_comm_hook(std::shared_ptr<CommHook> hook);
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -74,6 +106,14 @@ class Reducer {
 
   bool has_marked_unused_parameters_;
   std::vector<VariableIndex> unused_parameters_;
+  // Whether to mark the variables whose hook didn't fire as ready at the end
+  // of the current backward pass, see `find_unused_parameters_by_hooks`.
+  const bool find_unused_parameters_by_hooks_;
+  bool mark_unused_after_backward_;
+  // Whether each variable has been marked ready in the current iteration.
+  // The outer vector is for model replicas and the inner vector is for
+  // parameters.
+  std::vector<std::vector<bool>> marked_ready_;
   // Locally used parameter maps indicating if parameters are used locally
   // during the current iteration or no_sync session if no_sync is on. One
   // tensor for each model replica and each tensor is one-dim int32 tensor of
@@ -92,12 +132,35 @@ class Reducer {
   // Work handle for allreduce on local_used_maps_
   std::shared_ptr<c10d::ProcessGroup::Work> local_used_work_;
 
+  // Whether the grads of variables in dense buckets are views into the bucket
+  // contents.
+  const bool gradient_as_bucket_view_;
+
+  // Reduces the dense buckets if set, instead of allreduce.
+  std::shared_ptr<CommHook> comm_hook_;
+
+  // Bucket size limits to rebuild the buckets with, empty if the buckets are
+  // never rebuilt.
+  const std::vector<size_t> bucket_size_limits_;
+  bool has_rebuilt_buckets_;
+  // Indices of the variables of the first replica in the order their
+  // gradients became ready, recorded until the buckets are rebuilt.
+  std::vector<size_t> ready_order_;
+
+  // Rebuilds the buckets in the recorded order if the previous iteration
+  // recorded the order of all variables. The order of rank 0 is broadcast
+  // first, so that all processes end up with the same bucket assignment.
+  void rebuild_buckets();
+
   void mark_variable_ready_dense(VariableIndex index);
 
   void mark_variable_ready_sparse(VariableIndex index);
 
   void mark_variable_ready(VariableIndex index);
 
+  // Marks every variable that hasn't been marked ready in this iteration.
+  void mark_unmarked_variables_ready();
+
   void autograd_hook(VariableIndex index);
 
   void mark_bucket_ready(size_t bucket_index);
@@ -274,6 +274,11 @@ If the future completes with an error, an exception is thrown.
     RRefContext::getInstance().destroyInstance(ignoreRRefLeak).clear();
   });
 
+  module.def(
+      "_stop_rref_control_message_batching",
+      []() { RRefContext::getInstance().stopBatchingControlMessages(); },
+      py::call_guard<py::gil_scoped_release>());
+
   module.def("_rref_context_get_debug_info", []() {
     return RRefContext::getInstance().getDebugInfo();
   });
@@ -423,6 +428,22 @@ If the future completes with an error, an exception is thrown.
         flag (bool): True to set GIL profiling, False to disable.
       )");
 
+  module.def(
+      "enable_latency_profiling",
+      [](bool flag) {
+        RpcAgent::getCurrentRpcAgent()->enableLatencyProfiling(flag);
+      },
+      R"(
+    Set whether the time messages spend in every stage of sending, receiving
+    and processing them should be profiled or not. The latencies are reported
+    by the ``get_metrics`` method of the agent, per stage and per message type
+    or peer. This incurs a slight overhead cost. Default is disabled for
+    performance reasons.
+
+    Arguments:
+        flag (bool): True to set latency profiling, False to disable.
+      )");
+
   module.def(
       "_set_rpc_timeout",
       [](const std::chrono::milliseconds& rpcTimeout) {
@@ -44,6 +44,10 @@ enum MessageType {
   CLEANUP_AUTOGRAD_CONTEXT_REQ = 19,
   CLEANUP_AUTOGRAD_CONTEXT_RESP = 20,
 
+  // RREF_USER_DELETE, RREF_FORK_REQUEST and RREF_CHILD_ACCEPT messages to the
+  // same worker sent together, answered by a single RREF_ACK.
+  RREF_BATCH = 21,
+
   // Other internal message types
   EXCEPTION = 55,
   UNKNOWN = 60
@@ -45,6 +45,37 @@ double ProcessGroupAgent::AverageMetricsTracker::computeAverage() {
   return currentCount_ == 0 ? 0 : currentSum_ / (double)currentCount_;
 }
 
+void ProcessGroupAgent::LatencyHistogram::addData(uint64_t latencyUs) {
+  size_t bucket = 0;
+  while (bucket + 1 < buckets_.size() && (latencyUs >> bucket) > 0) {
+    ++bucket;
+  }
+  ++buckets_[bucket];
+  ++count_;
+  sum_ += latencyUs;
+  max_ = std::max(max_, latencyUs);
+}
+
+uint64_t ProcessGroupAgent::LatencyHistogram::percentile(double q) const {
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+    seen += buckets_[bucket];
+    if (seen > 0 && seen >= q * count_) {
+      return std::min(max_, bucket == 0 ? 0 : (uint64_t)1 << bucket);
+    }
+  }
+  return max_;
+}
+
+std::string ProcessGroupAgent::LatencyHistogram::summary() const {
+  std::ostringstream ss;
+  ss << "count=" << count_
+     << ",mean=" << (count_ == 0 ? 0 : sum_ / (double)count_)
+     << ",p50=" << percentile(0.5) << ",p90=" << percentile(0.9)
+     << ",p99=" << percentile(0.99) << ",max=" << max_;
+  return ss.str();
+}
+
 ////////////////////////  ProcessGroupAgent  /////////////////////////////////
 
 const ProcessGroupAgent::steady_clock_time_point
@@ -54,6 +85,19 @@ const std::string kNumPendingRequests = "agent.num_pending_requests";
 const std::string kThreadPoolSize = "agent.thread_pool_size";
 const std::string kNumIdleThreads = "agent.num_idle_threads";
 const std::string kGilAverageWaitTime = "agent.gil_average_wait_time_us";
+// e.g. agent.latency_us.serialize.type_0 and agent.latency_us.send.peer_1
+const std::string kLatencyPrefix = "agent.latency_us.";
+const std::vector<std::string> kLatencyStageNames = {
+    "serialize",
+    "enqueue",
+    "send",
+    "network",
+    "receive",
+    "dequeue",
+    "deserialize",
+    "execute",
+    "response",
+};
 
 void ProcessGroupAgent::collectNames() {
   const std::string& workerName = workerInfo_.name_;
@@ -105,6 +149,10 @@ ProcessGroupAgent::ProcessGroupAgent(
   metrics_.resize(ProcessGroupAgentMetrics::N_METRICS);
   metrics_[ProcessGroupAgentMetrics::GIL_WAIT_TIME] =
       std::make_unique<AverageMetricsTracker>(kGilAverageWaitTime);
+  latencyByType_.resize(LatencyStage::N_LATENCY_STAGES);
+  latencyByPeer_.assign(
+      LatencyStage::N_LATENCY_STAGES,
+      std::vector<LatencyHistogram>(pg_->getSize()));
   collectNames();
   TORCH_CHECK(
       nameMap_.size() > 1,
@@ -297,7 +345,13 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
       futures_.emplace(
           std::piecewise_construct,
           std::forward_as_tuple(requestId),
-          std::forward_as_tuple(FutureInfo(future, endTime, to.id_, timeout)));
+          std::forward_as_tuple(FutureInfo(
+              future,
+              endTime,
+              to.id_,
+              timeout,
+              message.type(),
+              futureStartTime)));
       // insert future into timeouts map to keep track of its timeout
       auto& requestIds = futureTimeouts_[endTime];
       requestIds.insert(requestId);
@@ -361,36 +415,74 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
 }
 
 void ProcessGroupAgent::handleSend(const SendWork& work) {
-  std::string serializedPayload =
-      wireSerialize(work.message_.payload(), work.message_.tensors());
+  const bool profiling = isLatencyProfilingEnabled();
+  const auto startTime = std::chrono::steady_clock::now();
+  // The tensor data is sent straight from the storages of the tensors after
+  // the header, instead of being copied into one buffer with it.
+  auto serialized =
+      wireSerializeSplit(work.message_.payload(), work.message_.tensors());
+  const std::string& serializedHeader = serialized.first;
+  const auto dst = work.to_.id_;
+  const auto sendTime = std::chrono::steady_clock::now();
 
+  // Responses tell the caller how long the request took to process, so that
+  // it can tell the time spent on the network.
+  int64_t processingTimeUs = work.message_.isResponse()
+      ? takeRequestProcessingTime(dst, work.message_.id())
+      : -1;
   std::vector<torch::Tensor> preamble = {torch::tensor(
       {(int64_t)pg_->getRank(),
-       (int64_t)serializedPayload.length(),
+       (int64_t)serializedHeader.length(),
        (int64_t)work.message_.type(),
-       (int64_t)work.message_.id()},
+       (int64_t)work.message_.id(),
+       processingTimeUs},
       {torch::kInt64})};
 
+  if (profiling && work.message_.isRequest()) {
+    std::lock_guard<std::mutex> lock{futureMutex_};
+    auto futureInfo = futures_.find(work.message_.id());
+    if (futureInfo != futures_.end()) {
+      futureInfo->second.sendTime_ = sendTime;
+    }
+  }
+
   // ProcessGroup is not thread-safe when sending with the same tag,
   // hence the lock
   std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
-  const auto dst = work.to_.id_;
-  std::vector<torch::Tensor> payload = {torch::from_blob(
-      (void*)serializedPayload.c_str(),
-      serializedPayload.length(),
-      {torch::kChar})};
-  pendingSends.reserve(2);
+  std::vector<std::vector<torch::Tensor>> payloads;
+  payloads.reserve(serialized.second.size() + 1);
+  payloads.push_back({torch::from_blob(
+      (void*)serializedHeader.c_str(),
+      serializedHeader.length(),
+      {torch::kChar})});
+  for (auto& tensorSection : serialized.second) {
+    // Empty sections are not sent, the receiver knows their sizes.
+    if (tensorSection.numel() > 0) {
+      payloads.push_back({std::move(tensorSection)});
+    }
+  }
+  pendingSends.reserve(payloads.size() + 1);
 
   sendCounts_.increment(dst);
 
   {
     std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
     pendingSends.emplace_back(pg_->send(preamble, dst, dst /* channelTag */));
-    pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    for (auto& payload : payloads) {
+      pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    }
   }
   for (auto& pendingSend : pendingSends) {
     pendingSend->wait();
   }
+
+  if (profiling) {
+    const auto type = work.message_.type();
+    recordLatency(ENQUEUE, type, dst, startTime - work.enqueueTime_);
+    recordLatency(SERIALIZE, type, dst, sendTime - startTime);
+    recordLatency(
+        SEND, type, dst, std::chrono::steady_clock::now() - sendTime);
+  }
 }
 
 void ProcessGroupAgent::enqueueSend(SendWork work) {
@@ -416,16 +508,46 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 void ProcessGroupAgent::enqueueRecv(RecvWork work) {
   threadPool_.run(std::bind(
       [&](RecvWork& work) {
+        const bool profiling = isLatencyProfilingEnabled();
+        const auto startTime = std::chrono::steady_clock::now();
         torch::Tensor& payload = work.payload_;
-        auto data = wireDeserialize(payload.storage().data(), payload.numel());
+        auto data = work.tensorSections_.empty()
+            ? wireDeserialize(payload.storage().data(), payload.numel())
+            : wireDeserializeSplit(
+                  payload.storage().data(),
+                  payload.numel(),
+                  std::move(work.tensorSections_));
         Message message(
             std::move(data.first),
             std::move(data.second),
             work.type_,
             work.id_);
+        const auto executeTime = std::chrono::steady_clock::now();
+        if (profiling) {
+          recordLatency(
+              DEQUEUE,
+              work.type_,
+              work.from_.id_,
+              startTime - work.enqueueTime_);
+          recordLatency(
+              DESERIALIZE, work.type_, work.from_.id_, executeTime - startTime);
+        }
         if (message.isRequest()) {
+          // Requests sent to ourselves have no preamble.
+          if (profiling &&
+              work.recvTime_ != std::chrono::steady_clock::time_point()) {
+            std::lock_guard<std::mutex> lock(metricsMutex_);
+            requestRecvTimes_[{work.from_.id_, work.id_}] = work.recvTime_;
+          }
           auto futureResponse = cb_->operator()(message);
           if (futureResponse->completed()) {
+            if (profiling) {
+              recordLatency(
+                  EXECUTE,
+                  work.type_,
+                  work.from_.id_,
+                  std::chrono::steady_clock::now() - executeTime);
+            }
             if (!futureResponse->hasError()) {
               send(work.from_, std::move(*futureResponse).moveValue());
             } else {
@@ -437,10 +559,24 @@ void ProcessGroupAgent::enqueueRecv(RecvWork work) {
           } else {
             auto fromId = work.from_.id_;
             auto requestId = work.id_;
+            auto requestType = work.type_;
             futureResponse->addCallback(
-                [this, fromId, requestId, futureResponse](
+                [this,
+                 fromId,
+                 requestId,
+                 requestType,
+                 profiling,
+                 executeTime,
+                 futureResponse](
                     const Message& /* unused */,
                     const c10::optional<utils::FutureError>& err) {
+                  if (profiling) {
+                    recordLatency(
+                        EXECUTE,
+                        requestType,
+                        fromId,
+                        std::chrono::steady_clock::now() - executeTime);
+                  }
                   if (!err) {
                     send(
                         getWorkerInfo(fromId),
@@ -460,6 +596,9 @@ void ProcessGroupAgent::enqueueRecv(RecvWork work) {
         } else if (message.isResponse()) {
           auto id = message.id();
           std::shared_ptr<FutureMessage> fm = nullptr;
+          MessageType requestType = MessageType::UNKNOWN;
+          steady_clock_time_point requestStartTime;
+          steady_clock_time_point requestSendTime;
           {
             std::lock_guard<std::mutex> lock{futureMutex_};
             const auto& futureInfo = futures_.find(id);
@@ -472,6 +611,9 @@ void ProcessGroupAgent::enqueueRecv(RecvWork work) {
             // Use futureInfo before destructing it.
             fm = futureInfo->second.future_;
             auto endTime = futureInfo->second.endTime_;
+            requestType = futureInfo->second.type_;
+            requestStartTime = futureInfo->second.startTime_;
+            requestSendTime = futureInfo->second.sendTime_;
             futures_.erase(id);
             // look up the corresponding future by its time out and request ID,
             // and remove it from the timeouts map
@@ -486,6 +628,25 @@ void ProcessGroupAgent::enqueueRecv(RecvWork work) {
               futureTimeouts_.erase(endTime);
             }
           }
+          if (profiling) {
+            const auto from = work.from_.id_;
+            recordLatency(
+                RESPONSE,
+                requestType,
+                from,
+                std::chrono::steady_clock::now() - requestStartTime);
+            // Only known if both sides profiled the request, and it was sent
+            // to another worker.
+            if (work.processingTimeUs_ >= 0 &&
+                requestSendTime != steady_clock_time_point()) {
+              recordLatency(
+                  NETWORK,
+                  requestType,
+                  from,
+                  work.recvTime_ - requestSendTime -
+                      std::chrono::microseconds(work.processingTimeUs_));
+            }
+          }
           futureCV_.notify_all();
           if (message.type() == MessageType::EXCEPTION) {
             fm->setError(std::string(
@@ -572,8 +733,8 @@ void ProcessGroupAgent::listenLoop() {
 
 void ProcessGroupAgent::listenLoopInternal() {
   while (rpcRunning_.load()) {
-    // rank, tensor size, message type
-    std::vector<torch::Tensor> preamble = {torch::empty({4}, {torch::kInt64})};
+    // rank, tensor size, message type, message id, processing time
+    std::vector<torch::Tensor> preamble = {torch::empty({5}, {torch::kInt64})};
     auto work = pg_->recvAnysource(preamble, pg_->getRank());
     {
       std::lock_guard<std::mutex> guard(recvWorkMutex_);
@@ -583,6 +744,7 @@ void ProcessGroupAgent::listenLoopInternal() {
     if (!rpcRunning_.load() || !work->wait() /* aborted */) {
       return;
     }
+    const auto recvTime = std::chrono::steady_clock::now();
 
     int64_t* preamble_items = preamble.front().storage().data<int64_t>();
 
@@ -590,12 +752,36 @@ void ProcessGroupAgent::listenLoopInternal() {
     auto size = preamble_items[1];
     MessageType type = MessageType(preamble_items[2]);
     int64_t id = preamble_items[3];
+    int64_t processingTimeUs = preamble_items[4];
 
     std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
     pg_->recv(tensors, srcRank, pg_->getRank())->wait();
 
-    enqueueRecv(
-        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(tensors[0])));
+    // Receive the tensor sections listed in the header, each into its own
+    // buffer, which the deserialized tensors use without copying.
+    std::vector<torch::Tensor> tensorSections;
+    for (auto sectionSize : wireTensorSectionSizes(
+             tensors[0].storage().data(), tensors[0].numel())) {
+      std::vector<torch::Tensor> section = {
+          torch::empty({(int64_t)sectionSize}, {torch::kChar})};
+      if (sectionSize > 0) {
+        pg_->recv(section, srcRank, pg_->getRank())->wait();
+      }
+      tensorSections.push_back(std::move(section[0]));
+    }
+    if (isLatencyProfilingEnabled()) {
+      recordLatency(
+          RECEIVE, type, srcRank, std::chrono::steady_clock::now() - recvTime);
+    }
+
+    enqueueRecv(RecvWork(
+        allWorkerInfo_[srcRank],
+        type,
+        id,
+        std::move(tensors[0]),
+        std::move(tensorSections),
+        recvTime,
+        processingTimeUs));
   }
 }
 
@@ -708,6 +894,23 @@ std::unordered_map<std::string, std::string> ProcessGroupAgent::getMetrics() {
       metrics[kGilAverageWaitTime] = c10::to_string(avgGilWaitTime);
     }
   }
+  if (isLatencyProfilingEnabled()) {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    for (int stage = 0; stage < N_LATENCY_STAGES; ++stage) {
+      const std::string prefix = kLatencyPrefix + kLatencyStageNames[stage];
+      for (const auto& entry : latencyByType_[stage]) {
+        metrics[prefix + ".type_" + c10::to_string(entry.first)] =
+            entry.second.summary();
+      }
+      for (size_t peer = 0; peer < latencyByPeer_[stage].size(); ++peer) {
+        const auto& histogram = latencyByPeer_[stage][peer];
+        if (histogram.count() > 0) {
+          metrics[prefix + ".peer_" + c10::to_string(peer)] =
+              histogram.summary();
+        }
+      }
+    }
+  }
   return metrics;
 }
 
@@ -718,6 +921,35 @@ void ProcessGroupAgent::addGilWaitTime(
       gilWaitTime.count());
 }
 
+void ProcessGroupAgent::recordLatency(
+    LatencyStage stage,
+    MessageType type,
+    worker_id_t peer,
+    std::chrono::steady_clock::duration latency) {
+  // Stages that are derived from several clock readings can come out
+  // slightly negative.
+  auto latencyUs = std::max<int64_t>(
+      0,
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  std::lock_guard<std::mutex> lock(metricsMutex_);
+  latencyByType_[stage][type].addData(latencyUs);
+  latencyByPeer_[stage][peer].addData(latencyUs);
+}
+
+int64_t ProcessGroupAgent::takeRequestProcessingTime(
+    worker_id_t dst,
+    int64_t requestId) {
+  std::lock_guard<std::mutex> lock(metricsMutex_);
+  auto it = requestRecvTimes_.find({dst, requestId});
+  if (it == requestRecvTimes_.end()) {
+    return -1;
+  }
+  auto processingTime = std::chrono::steady_clock::now() - it->second;
+  requestRecvTimes_.erase(it);
+  return std::chrono::duration_cast<std::chrono::microseconds>(processingTime)
+      .count();
+}
+
 } // namespace rpc
 } // namespace distributed
 } // namespace torch
@@ -5,7 +5,9 @@
 #include <torch/csrc/distributed/rpc/python_rpc_handler.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 
+#include <array>
 #include <atomic>
+#include <map>
 #include <thread>
 
 namespace torch {
@@ -21,26 +23,49 @@ struct ProcessGroupRpcBackendOptions : public RpcBackendOptions {
 // worker threads from the same ThreadPool.
 struct SendWork {
   SendWork(const WorkerInfo& to, Message&& message)
-      : to_(to), message_(message) {}
+      : to_(to),
+        message_(message),
+        enqueueTime_(std::chrono::steady_clock::now()) {}
 
   const WorkerInfo& to_;
   Message message_;
+  std::chrono::steady_clock::time_point enqueueTime_;
 };
 
 // SendWork wraps a Message and RecvWork wraps a Tensor. The difference here is
 // to allow us to run serialization/deserialization in the worker threads.
+//
+// If the message was received from another worker, the payload only holds
+// the header of wireSerializeSplit, and the contents of the tensor sections
+// are in `tensorSections_`. `recvTime_` is when its preamble arrived, and
+// `processingTimeUs_` how long the sender of a response took to process the
+// request, or -1 if it is unknown.
 struct RecvWork {
   RecvWork(
       const WorkerInfo& from,
       MessageType type,
       int64_t id,
-      torch::Tensor&& payload)
-      : from_(from), type_(type), id_(id), payload_(payload) {}
+      torch::Tensor&& payload,
+      std::vector<torch::Tensor>&& tensorSections = {},
+      std::chrono::steady_clock::time_point recvTime = {},
+      int64_t processingTimeUs = -1)
+      : from_(from),
+        type_(type),
+        id_(id),
+        payload_(payload),
+        tensorSections_(std::move(tensorSections)),
+        recvTime_(recvTime),
+        processingTimeUs_(processingTimeUs),
+        enqueueTime_(std::chrono::steady_clock::now()) {}
 
   const WorkerInfo& from_;
   const MessageType type_;
   const int64_t id_;
   torch::Tensor payload_;
+  std::vector<torch::Tensor> tensorSections_;
+  const std::chrono::steady_clock::time_point recvTime_;
+  const int64_t processingTimeUs_;
+  const std::chrono::steady_clock::time_point enqueueTime_;
 };
 
 class ProcessGroupAgent : public RpcAgent {
@@ -109,23 +134,83 @@ class ProcessGroupAgent : public RpcAgent {
     double computeAverage();
   };
 
+  // A histogram of latencies in microseconds, with power of two buckets from
+  // which the percentiles are estimated.
+  class LatencyHistogram {
+   public:
+    void addData(uint64_t latencyUs);
+    uint64_t count() const {
+      return count_;
+    }
+    // e.g. "count=10,mean=21.3,p50=16,p90=32,p99=64,max=57"
+    std::string summary() const;
+
+   private:
+    // The upper bound of the bucket of the q-th quantile, at most the max
+    uint64_t percentile(double q) const;
+
+    // buckets_[i] counts the latencies in [2^(i-1), 2^i)
+    std::array<uint64_t, 64> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+  };
+
+  // The stages of messages that are timed when latency profiling is enabled,
+  // each with the clock of a single process:
+  //   SERIALIZE:   wire serializing a message.
+  //   ENQUEUE:     waiting in the thread pool to be serialized and sent.
+  //   SEND:        sending a serialized message through the ProcessGroup.
+  //   NETWORK:     from sending a request until the preamble of its response
+  //                arrives, minus the time the callee took from the preamble
+  //                of the request arriving until it sent the response.
+  //   RECEIVE:     receiving a message after its preamble arrived.
+  //   DEQUEUE:     waiting in the thread pool to be deserialized.
+  //   DESERIALIZE: wire deserializing a message.
+  //   EXECUTE:     running a request until its response is ready.
+  //   RESPONSE:    from sending a request until its response is processed.
+  // NETWORK, EXECUTE and RESPONSE are recorded for the type of the request,
+  // the others for the type of the message sent or received.
+  enum LatencyStage {
+    SERIALIZE = 0,
+    ENQUEUE,
+    SEND,
+    NETWORK,
+    RECEIVE,
+    DEQUEUE,
+    DESERIALIZE,
+    EXECUTE,
+    RESPONSE,
+
+    N_LATENCY_STAGES,
+  };
+
   // The FutureInfo struct stores a shared_ptr to the future, as well as
   // additional information to manage timeouts and destination information,
   // which is needed for termination detection.
+  // The type, start time and the time the request was handed to the
+  // ProcessGroup (if latency profiling is enabled) are used to profile it.
   struct FutureInfo {
     std::shared_ptr<FutureMessage> future_;
     steady_clock_time_point endTime_;
     int dstRank_;
     std::chrono::milliseconds timeout_;
+    MessageType type_;
+    steady_clock_time_point startTime_;
+    steady_clock_time_point sendTime_;
     FutureInfo(
         const std::shared_ptr<FutureMessage>& future,
         const steady_clock_time_point& endTime,
         int dstRank,
-        const std::chrono::milliseconds timeout)
+        const std::chrono::milliseconds timeout,
+        MessageType type,
+        const steady_clock_time_point& startTime)
         : future_(future),
           endTime_(endTime),
           dstRank_(dstRank),
-          timeout_(timeout) {}
+          timeout_(timeout),
+          type_(type),
+          startTime_(startTime) {}
     FutureInfo() = delete;
   };
 
@@ -250,6 +335,24 @@ class ProcessGroupAgent : public RpcAgent {
   std::mutex metricsMutex_;
   std::vector<std::unique_ptr<AverageMetricsTracker>> metrics_;
   void addGilWaitTime(const std::chrono::microseconds gilWaitTime) override;
+
+  // Latencies of every LatencyStage, per message type and per peer rank,
+  // guarded by metricsMutex_.
+  std::vector<std::map<MessageType, LatencyHistogram>> latencyByType_;
+  std::vector<std::vector<LatencyHistogram>> latencyByPeer_;
+  // When the preambles of the requests being processed arrived, keyed by the
+  // rank of the caller and the request id, so that the responses can tell the
+  // callers how long the requests took to process. Guarded by metricsMutex_.
+  std::map<std::pair<worker_id_t, int64_t>, steady_clock_time_point>
+      requestRecvTimes_;
+  void recordLatency(
+      LatencyStage stage,
+      MessageType type,
+      worker_id_t peer,
+      std::chrono::steady_clock::duration latency);
+  // Returns how long the request answered by a response to dst took to
+  // process in microseconds, or -1 if it is unknown.
+  int64_t takeRequestProcessingTime(worker_id_t dst, int64_t requestId);
 };
 
 } // namespace rpc
@@ -87,6 +87,25 @@ std::vector<char> PythonRpcHandler::generatePythonUDFResult(
   return payload;
 }
 
+std::shared_ptr<FutureMessage> PythonRpcHandler::
+    generatePythonUDFResultOrFuture(
+        const std::vector<char>& pickledPayload,
+        const std::vector<torch::Tensor>& requestTensorTable,
+        std::vector<char>& payload,
+        std::vector<torch::Tensor>& responseTensorTable) {
+  PROFILE_GIL_SCOPED_ACQUIRE;
+  auto pargs = py::bytes(pickledPayload.data(), pickledPayload.size());
+  py::object result = pyRunFunction_(pargs, requestTensorTable);
+  if (py::isinstance<FutureMessage>(result)) {
+    return result.cast<std::shared_ptr<FutureMessage>>();
+  }
+  py::tuple pres = pySerialize_(result);
+  const auto& presStr = pres[0].cast<std::string>();
+  responseTensorTable = pres[1].cast<std::vector<torch::Tensor>>();
+  payload.assign(presStr.begin(), presStr.end());
+  return nullptr;
+}
+
 py::object PythonRpcHandler::loadPythonUDFResult(
     const std::vector<char>& pickledPayload,
     const std::vector<torch::Tensor>& tensorTable) {
@@ -25,6 +25,15 @@ class PYBIND11_EXPORT PythonRpcHandler {
       const std::vector<torch::Tensor>& requestTensorTable,
       std::vector<torch::Tensor>& responseTensorTable);
 
+  // Like generatePythonUDFResult, but if the function returns the Future of
+  // another RPC, that future is returned without waiting for it and nothing is
+  // serialized. Returns nullptr otherwise.
+  std::shared_ptr<FutureMessage> generatePythonUDFResultOrFuture(
+      const std::vector<char>& pickledPayload,
+      const std::vector<torch::Tensor>& requestTensorTable,
+      std::vector<char>& payload,
+      std::vector<torch::Tensor>& responseTensorTable);
+
   // Returned python UDF result is pickled binary string, so run python
   // function to unpickle the python UDF result and return py::object to user
   py::object loadPythonUDFResult(
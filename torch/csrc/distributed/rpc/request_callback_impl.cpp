@@ -11,6 +11,7 @@
 #include <torch/csrc/distributed/autograd/rpc_messages/rpc_with_autograd.h>
 #include <torch/csrc/distributed/autograd/utils.h>
 #include <torch/csrc/distributed/rpc/python_call.h>
+#include <torch/csrc/distributed/rpc/python_functions.h>
 #include <torch/csrc/distributed/rpc/python_remote_call.h>
 #include <torch/csrc/distributed/rpc/python_resp.h>
 #include <torch/csrc/distributed/rpc/python_rpc_handler.h>
@@ -66,13 +67,69 @@ std::shared_ptr<FutureMessage> RequestCallbackImpl::processRpc(
           "size ",
           stack.size());
 
+      if (stack.front().isFuture()) {
+        // The function forked its work or waits for another RPC. Respond when
+        // the future completes instead of blocking this thread until then.
+        auto valueFuture = stack.front().toFuture();
+        auto responseFuture = std::make_shared<FutureMessage>();
+        valueFuture->addCallback([responseFuture, messageId, valueFuture]() {
+          try {
+            Message m = ScriptResp(valueFuture->value()).toMessage();
+            m.setId(messageId);
+            responseFuture->markCompleted(std::move(m));
+          } catch (const std::exception& e) {
+            responseFuture->setError(e.what());
+          }
+        });
+        return responseFuture;
+      }
+
       return wrap(std::move(ScriptResp(std::move(stack.front()))).toMessage());
     }
     case MessageType::PYTHON_CALL: {
       auto& pyCall = static_cast<PythonCall&>(rpc);
+      std::vector<char> payload;
       std::vector<torch::Tensor> responseTensorTable;
-      auto payload = PythonRpcHandler::getInstance().generatePythonUDFResult(
-          pyCall.pickledPayload(), pyCall.tensors(), responseTensorTable);
+      auto udfFuture =
+          PythonRpcHandler::getInstance().generatePythonUDFResultOrFuture(
+              pyCall.pickledPayload(),
+              pyCall.tensors(),
+              payload,
+              responseTensorTable);
+      if (udfFuture) {
+        // The UDF returned the future of another RPC. Respond with its value
+        // when it completes instead of blocking this thread until then.
+        auto responseFuture = std::make_shared<FutureMessage>();
+        udfFuture->addCallback(
+            [responseFuture, messageId](
+                const Message& message,
+                const c10::optional<utils::FutureError>& error) {
+              if (error) {
+                responseFuture->setError(error->what());
+                return;
+              }
+              try {
+                auto& handler = PythonRpcHandler::getInstance();
+                std::vector<char> payload;
+                std::vector<torch::Tensor> tensors;
+                {
+                  pybind11::gil_scoped_acquire ag;
+                  SerializedPyObj result = handler.serialize(toPyObj(message));
+                  payload.assign(
+                      result.payload_.begin(), result.payload_.end());
+                  tensors = result.tensors_;
+                }
+                Message m =
+                    PythonResp(std::move(payload), std::move(tensors))
+                        .toMessage();
+                m.setId(messageId);
+                responseFuture->markCompleted(std::move(m));
+              } catch (const std::exception& e) {
+                responseFuture->setError(e.what());
+              }
+            });
+        return responseFuture;
+      }
       return wrap(
           std::move(
               PythonResp(std::move(payload), std::move(responseTensorTable)))
@@ -244,6 +301,17 @@ std::shared_ptr<FutureMessage> RequestCallbackImpl::processRpc(
       ctx.addForkOfOwner(rfr.rrefId(), rfr.forkId());
       return wrap(RRefAck().toMessage());
     }
+    case MessageType::RREF_BATCH: {
+      auto& batch = static_cast<RRefBatch&>(rpc);
+      // The batched messages are all handled synchronously and answered with
+      // an RRefAck, so a single RRefAck answers the batch.
+      for (const auto& message : batch.messages()) {
+        std::unique_ptr<RpcCommandBase> batchedRpc =
+            deserializeRequest(message);
+        processRpc(*batchedRpc, message.type(), messageId);
+      }
+      return wrap(RRefAck().toMessage());
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       auto& rpcWithAutograd = static_cast<RpcWithAutograd&>(rpc);
 
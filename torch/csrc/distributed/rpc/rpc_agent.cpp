@@ -13,7 +13,8 @@ RpcAgent::RpcAgent(
     : workerInfo_(std::move(workerId)),
       cb_(std::move(cb)),
       rpcTimeout_(rpcTimeout),
-      profilingEnabled_(false) {}
+      profilingEnabled_(false),
+      latencyProfilingEnabled_(false) {}
 
 RpcAgent::~RpcAgent() = default;
 
@@ -49,6 +50,14 @@ bool RpcAgent::isGILProfilingEnabled() {
   return profilingEnabled_.load();
 }
 
+void RpcAgent::enableLatencyProfiling(bool flag) {
+  latencyProfilingEnabled_ = flag;
+}
+
+bool RpcAgent::isLatencyProfilingEnabled() {
+  return latencyProfilingEnabled_.load();
+}
+
 std::unordered_map<std::string, std::string> RpcAgent::getDebugInfo() {
   /* This would later include more info other than metrics for eg: may include
      stack traces for the threads owned by the agent */
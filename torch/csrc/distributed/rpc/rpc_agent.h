@@ -154,11 +154,20 @@ class TORCH_API RpcAgent {
   // Retrieve wheher we should profile GIL wait times or not.
   bool isGILProfilingEnabled();
 
+  // Flag to control whether the time messages spend in every stage of
+  // sending, receiving and processing them should be profiled or not. The
+  // agent reports the latencies through ``getMetrics``.
+  void enableLatencyProfiling(bool flag);
+
+  // Retrieve whether we should profile the stages of messages or not.
+  bool isLatencyProfilingEnabled();
+
  protected:
   const WorkerInfo workerInfo_;
   const std::unique_ptr<RequestCallback> cb_;
   std::atomic<std::chrono::milliseconds> rpcTimeout_;
   std::atomic<bool> profilingEnabled_;
+  std::atomic<bool> latencyProfilingEnabled_;
 
  private:
   static std::shared_ptr<RpcAgent> currentRpcAgent_;
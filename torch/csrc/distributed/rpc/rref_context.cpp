@@ -22,6 +22,11 @@ void confirmPendingUser(
 const std::string kNumOwnerRRefs = "num_owner_rrefs";
 const std::string kNumPendingUsers = "num_pending_users";
 
+// How long RRef control messages wait for others to the same worker, and how
+// many of them are sent in a batch at most.
+constexpr std::chrono::milliseconds kControlMessageWindow(5);
+constexpr size_t kControlMessageBatchSize = 1024;
+
 RRefContext& RRefContext::getInstance() {
   // Leaky singleton to avoid module destructor races.
   static RRefContext* context = new RRefContext(RpcAgent::getCurrentRpcAgent());
@@ -31,6 +36,7 @@ RRefContext& RRefContext::getInstance() {
 std::vector<c10::intrusive_ptr<RRef>> RRefContext::destroyInstance(
     bool ignoreRRefLeak) {
   auto& ctx = RRefContext::getInstance();
+  ctx.stopBatchingControlMessages();
   {
     std::lock_guard<std::mutex> lock(ctx.destroyedMutex_);
     ctx.destroyed_ = true;
@@ -57,9 +63,15 @@ void RRefContext::handleException(
 }
 
 RRefContext::RRefContext(std::shared_ptr<RpcAgent> agent)
-    : agent_(std::move(agent)), destroyed_(false) {}
+    : agent_(std::move(agent)),
+      destroyed_(false),
+      batchControlMessages_(true),
+      controlBatchFull_(false) {
+  controlThread_ = std::thread(&RRefContext::runControlMessageLoop, this);
+}
 
 RRefContext::~RRefContext() {
+  stopBatchingControlMessages();
   if (!owners_.empty()) {
     VLOG(1) << "Destructing RRefContext with non-empty OwnerRRef set. "
             << "This would likely cause Python deref error. "
@@ -67,6 +79,103 @@ RRefContext::~RRefContext() {
   }
 }
 
+void RRefContext::stopBatchingControlMessages() {
+  {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    batchControlMessages_ = false;
+  }
+  controlCV_.notify_all();
+  if (controlThread_.joinable()) {
+    controlThread_.join();
+  }
+}
+
+void RRefContext::runControlMessageLoop() {
+  std::unique_lock<std::mutex> lock(controlMutex_);
+  while (batchControlMessages_ || !pendingControlMessages_.empty()) {
+    controlCV_.wait(lock, [this] {
+      return !batchControlMessages_ || !pendingControlMessages_.empty();
+    });
+    // Give other control messages the window to join the batches.
+    controlCV_.wait_for(lock, kControlMessageWindow, [this] {
+      return !batchControlMessages_ || controlBatchFull_;
+    });
+    auto pending = std::move(pendingControlMessages_);
+    pendingControlMessages_.clear();
+    controlBatchFull_ = false;
+    lock.unlock();
+
+    for (auto& entry : pending) {
+      try {
+        sendControlMessages(entry.first, std::move(entry.second));
+      } catch (const std::exception& e) {
+        // There is no caller to rethrow to on this thread.
+        LOG(ERROR) << "Failed to send RRef control messages to worker "
+                   << entry.first << ": " << e.what();
+      }
+    }
+
+    lock.lock();
+  }
+}
+
+void RRefContext::sendControlMessage(
+    worker_id_t dst,
+    Message message,
+    ControlMessageCallback callback) {
+  std::unique_lock<std::mutex> lock(controlMutex_);
+  if (!batchControlMessages_) {
+    lock.unlock();
+    ControlMessages messages;
+    messages.emplace_back(std::move(message), std::move(callback));
+    sendControlMessages(dst, std::move(messages));
+    return;
+  }
+  auto& messages = pendingControlMessages_[dst];
+  messages.emplace_back(std::move(message), std::move(callback));
+  if (messages.size() >= kControlMessageBatchSize) {
+    controlBatchFull_ = true;
+  } else if (messages.size() > 1) {
+    // The loop is already waiting for the window to pass.
+    return;
+  }
+  lock.unlock();
+  controlCV_.notify_one();
+}
+
+void RRefContext::sendControlMessages(
+    worker_id_t dst,
+    ControlMessages messages) {
+  if (messages.empty()) {
+    return;
+  }
+  Message message;
+  std::vector<ControlMessageCallback> callbacks;
+  if (messages.size() == 1) {
+    message = std::move(messages.front().first);
+    callbacks.emplace_back(std::move(messages.front().second));
+  } else {
+    std::vector<Message> batch;
+    batch.reserve(messages.size());
+    callbacks.reserve(messages.size());
+    for (auto& entry : messages) {
+      batch.emplace_back(std::move(entry.first));
+      callbacks.emplace_back(std::move(entry.second));
+    }
+    message = RRefBatch(std::move(batch)).toMessage();
+  }
+
+  auto fm = agent_->send(agent_->getWorkerInfo(dst), std::move(message));
+  fm->addCallback(
+      [callbacks](
+          const Message& /* unused */,
+          const c10::optional<utils::FutureError>& futErr) {
+        for (const auto& callback : callbacks) {
+          callback(futErr);
+        }
+      });
+}
+
 std::unordered_map<std::string, std::string> RRefContext::getDebugInfo() {
   std::unordered_map<std::string, std::string> info;
   std::unique_lock<std::mutex> lock(mutex_);
@@ -143,14 +252,12 @@ void RRefContext::delUser(
     const ForkId& forkId) {
   std::lock_guard<std::mutex> lock(destroyedMutex_);
   if (!destroyed_) {
-    auto fm = agent_->send(
-        agent_->getWorkerInfo(owner),
-        RRefUserDelete(rrefId, forkId).toMessage());
-
-    fm->addCallback([](const Message& /* unused */,
-                       const c10::optional<utils::FutureError>& futErr) {
-      RRefContext::handleException(futErr);
-    });
+    sendControlMessage(
+        owner,
+        RRefUserDelete(rrefId, forkId).toMessage(),
+        [](const c10::optional<utils::FutureError>& futErr) {
+          RRefContext::handleException(futErr);
+        });
   }
 }
 
@@ -284,24 +391,22 @@ void RRefContext::notifyOwnerAndParentOfFork(
     // In this case, the owner is the caller, and it does not add the fork id
     // into forks_. Because, there will be no real `UserRRef` associated with
     // this fork ID.
-    auto fm = agent_->send(
-        agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
-    fm->addCallback([](const Message& /* unused */,
-                       const c10::optional<utils::FutureError>& futErr) {
-      handleException(futErr);
-    });
+    sendControlMessage(
+        parent,
+        RRefChildAccept(forkId).toMessage(),
+        [](const c10::optional<utils::FutureError>& futErr) {
+          handleException(futErr);
+        });
   } else {
-    auto fm = agent_->send(
-        agent_->getWorkerInfo(rref->owner()),
-        RRefForkRequest(rref->rrefId(), forkId).toMessage());
-
     addPendingUser(forkId, rref);
-    fm->addCallback([this, forkId, parent](
-                        const Message& /* unused */,
-                        const c10::optional<utils::FutureError>& futErr) {
-      handleException(futErr);
-      this->finishForkRequest(forkId, parent);
-    });
+    sendControlMessage(
+        rref->owner(),
+        RRefForkRequest(rref->rrefId(), forkId).toMessage(),
+        [this, forkId, parent](
+            const c10::optional<utils::FutureError>& futErr) {
+          handleException(futErr);
+          this->finishForkRequest(forkId, parent);
+        });
   }
 }
 
@@ -352,13 +457,12 @@ void RRefContext::delPendingUser(const ForkId& forkId) {
 
 void RRefContext::finishForkRequest(const ForkId& forkId, worker_id_t parent) {
   delPendingUser(forkId);
-  auto fm = agent_->send(
-      agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
-
-  fm->addCallback([](const Message& /* unused */,
-                     const c10::optional<utils::FutureError>& futErr) {
-    handleException(futErr);
-  });
+  sendControlMessage(
+      parent,
+      RRefChildAccept(forkId).toMessage(),
+      [](const c10::optional<utils::FutureError>& futErr) {
+        handleException(futErr);
+      });
 }
 
 void RRefContext::addSelfAsFork(c10::intrusive_ptr<OwnerRRef>& rref) {
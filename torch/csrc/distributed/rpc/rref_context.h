@@ -7,6 +7,9 @@
 #include <torch/csrc/distributed/rpc/types.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 
 namespace torch {
 namespace distributed {
@@ -137,9 +140,29 @@ class TORCH_API RRefContext {
 
   std::unordered_map<std::string, std::string> getDebugInfo();
 
+  // Sends the RRef control messages waiting to be batched, and sends later
+  // ones right away. This is called on shutdown, so that the agent's join()
+  // sees all of them.
+  void stopBatchingControlMessages();
+
  private:
+  using ControlMessageCallback =
+      std::function<void(const c10::optional<utils::FutureError>&)>;
+  using ControlMessages =
+      std::vector<std::pair<Message, ControlMessageCallback>>;
+
   RRefContext(std::shared_ptr<RpcAgent>);
 
+  // Sends an RRefUserDelete, RRefForkRequest or RRefChildAccept message to
+  // ``dst`` and runs ``callback`` when it is acked. The control messages to
+  // the same worker within a short window are sent as one RRefBatch.
+  void sendControlMessage(
+      worker_id_t dst,
+      Message message,
+      ControlMessageCallback callback);
+  void sendControlMessages(worker_id_t dst, ControlMessages messages);
+  void runControlMessageLoop();
+
   c10::intrusive_ptr<UserRRef> createUserRRef(
       worker_id_t ownerId,
       const RRefId& rrefId,
@@ -200,6 +223,16 @@ class TORCH_API RRefContext {
 
   std::mutex destroyedMutex_;
   bool destroyed_;
+
+  // Control messages waiting to be sent, by destination. They are sent by
+  // controlThread_ after the batching window, or once there are enough of
+  // them for one destination.
+  std::mutex controlMutex_;
+  std::condition_variable controlCV_;
+  std::unordered_map<worker_id_t, ControlMessages> pendingControlMessages_;
+  bool batchControlMessages_;
+  bool controlBatchFull_;
+  std::thread controlThread_;
 };
 
 } // namespace rpc
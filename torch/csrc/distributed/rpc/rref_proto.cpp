@@ -186,6 +186,43 @@ std::unique_ptr<RRefForkRequest> RRefForkRequest::fromMessage(
   return std::make_unique<RRefForkRequest>(pair.first, pair.second);
 }
 
+const std::vector<Message>& RRefBatch::messages() const {
+  return messages_;
+}
+
+Message RRefBatch::toMessage() && {
+  // Control messages carry no tensors, so every message is only its type and
+  // its pickled payload.
+  std::vector<at::IValue> ivalues;
+  ivalues.reserve(messages_.size() * 2);
+  for (const auto& message : messages_) {
+    TORCH_INTERNAL_ASSERT(
+        message.tensors().empty(),
+        "RRefBatch expects messages without tensors.");
+    ivalues.emplace_back(static_cast<int64_t>(message.type()));
+    ivalues.emplace_back(
+        std::string(message.payload().begin(), message.payload().end()));
+  }
+  return fromIValues(std::move(ivalues), MessageType::RREF_BATCH);
+}
+
+std::unique_ptr<RRefBatch> RRefBatch::fromMessage(const Message& message) {
+  auto values = toIValues(message, MessageType::RREF_BATCH);
+  TORCH_INTERNAL_ASSERT(
+      values.size() % 2 == 0,
+      "RRefBatch expects pairs of IValues from message.");
+  std::vector<Message> messages;
+  messages.reserve(values.size() / 2);
+  for (size_t i = 0; i < values.size(); i += 2) {
+    const auto& payload = values[i + 1].toStringRef();
+    messages.emplace_back(
+        std::vector<char>(payload.begin(), payload.end()),
+        std::vector<torch::Tensor>(),
+        static_cast<MessageType>(values[i].toInt()));
+  }
+  return std::make_unique<RRefBatch>(std::move(messages));
+}
+
 Message RRefAck::toMessage() && {
   return Message({}, {}, MessageType::RREF_ACK);
 }
@@ -155,6 +155,23 @@ class TORCH_API RRefForkRequest final : public ForkMessageBase {
   static std::unique_ptr<RRefForkRequest> fromMessage(const Message& message);
 };
 
+// RRef control messages (RRefUserDelete, RRefForkRequest and RRefChildAccept)
+// to the same worker, sent as one message. The receiver processes them in
+// order and replies with a single RRefAck.
+class TORCH_API RRefBatch final : public RpcCommandBase {
+ public:
+  explicit RRefBatch(std::vector<Message> messages)
+      : messages_(std::move(messages)) {}
+
+  const std::vector<Message>& messages() const;
+
+  Message toMessage() && override;
+  static std::unique_ptr<RRefBatch> fromMessage(const Message& message);
+
+ private:
+  std::vector<Message> messages_;
+};
+
 class TORCH_API RRefAck final : public RpcCommandBase {
  public:
   RRefAck() {}
@@ -16,6 +16,10 @@
 #include <torch/csrc/jit/pickler.h>
 #include <torch/csrc/jit/unpickler.h>
 
+#include <algorithm>
+#include <cctype>
+#include <functional>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -49,6 +53,9 @@ std::unique_ptr<RpcCommandBase> deserializeRequest(const Message& request) {
     case MessageType::RREF_FORK_REQUEST: {
       return RRefForkRequest::fromMessage(request);
     }
+    case MessageType::RREF_BATCH: {
+      return RRefBatch::fromMessage(request);
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       return autograd::RpcWithAutograd::fromMessage(request);
     }
@@ -142,6 +149,11 @@ IValue deserializeRespToIValue(const Message& message) {
 
 namespace {
 
+// The tensor sections are named by their index.
+bool isTensorSection(const std::string& name) {
+  return !name.empty() && std::all_of(name.begin(), name.end(), ::isdigit);
+}
+
 // Helper for wireDeserialize() below.
 //
 // The format we use below looks like:
@@ -158,8 +170,15 @@ namespace {
 //
 // Note that per the header comments, the format is subject to change,
 // and is best used for rpcs, rather than persistent disk storage.
+//
+// In the split format of wireSerializeSplit() the tensor sections are listed
+// in the header but don't follow it, their sizes are returned in
+// `tensorSectionSizes` instead.
 std::unordered_map<std::string, std::pair<const char*, size_t>>
-parseWireSections(const void* data, size_t data_size) {
+parseWireSections(
+    const void* data,
+    size_t data_size,
+    std::vector<size_t>* tensorSectionSizes = nullptr) {
   const char* ptr = static_cast<const char*>(data);
   const char* endp = ptr + data_size;
 
@@ -201,6 +220,10 @@ parseWireSections(const void* data, size_t data_size) {
 
   std::unordered_map<std::string, std::pair<const char*, size_t>> out;
   for (const auto& headerEnt : headerEnts) {
+    if (tensorSectionSizes && isTensorSection(headerEnt.first)) {
+      tensorSectionSizes->push_back(headerEnt.second);
+      continue;
+    }
     out[headerEnt.first] = {ptr, headerEnt.second};
     ptr += headerEnt.second;
   }
@@ -235,18 +258,22 @@ c10::List<at::Tensor> cloneSparseTensors(
   return pTensors;
 }
 
-std::string wireSerialize(
-    const std::vector<char>& payload,
-    const std::vector<at::Tensor>& tensors) {
-  struct Ent {
-    std::string name;
-    const char* data;
-    size_t size;
-  };
-  std::vector<Ent> entries;
-  std::string metaEntry;
-  std::vector<jit::WriteableTensorData> tensorData;
+namespace {
+
+struct WireEntry {
+  std::string name;
+  const char* data;
+  size_t size;
+};
 
+// Appends the entries for the payload and the pickled tensors to `entries`.
+// `metaEntry` and `tensorData` hold the data of the entries.
+void wireEntries(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors,
+    std::vector<WireEntry>& entries,
+    std::string& metaEntry,
+    std::vector<jit::WriteableTensorData>& tensorData) {
   if (!payload.empty()) {
     entries.push_back({kPayload, payload.data(), payload.size()});
   }
@@ -261,7 +288,6 @@ std::string wireSerialize(
     pickler.protocol();
     pickler.pushIValue(cloneSparseTensors(tensors));
     pickler.stop();
-    // tensorData is in function scope so that the data() pointers stay valid.
     tensorData = pickler.tensorData();
     entries.push_back({kMeta, metaEntry.data(), metaEntry.size()});
     for (size_t i = 0; i < tensorData.size(); i++) {
@@ -270,11 +296,19 @@ std::string wireSerialize(
                          tensorData[i].sizeInBytes()});
     }
   }
+}
 
+// Writes the header listing all entries, followed by the data of the entries
+// for which `inline_` returns true.
+std::string writeWireEntries(
+    const std::vector<WireEntry>& entries,
+    const std::function<bool(const WireEntry&)>& inline_) {
   std::string header;
   size_t tot = 0;
   for (const auto& e : entries) {
-    tot += e.size;
+    if (inline_(e)) {
+      tot += e.size;
+    }
     header.append(e.name)
         .append(" ")
         .append(c10::to_string(e.size))
@@ -286,16 +320,17 @@ std::string wireSerialize(
   out.reserve(header.size() + tot);
   out.append(header);
   for (const auto& e : entries) {
-    out.append(e.data, e.size);
+    if (inline_(e)) {
+      out.append(e.data, e.size);
+    }
   }
   return out;
 }
 
-std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
-    const void* data,
-    size_t data_size) {
-  auto sections = parseWireSections(data, data_size);
-
+std::pair<std::vector<char>, std::vector<at::Tensor>> deserializeWireSections(
+    const std::unordered_map<std::string, std::pair<const char*, size_t>>&
+        sections,
+    const std::function<at::DataPtr(const std::string&)>& sectionReadFunc) {
   std::vector<char> payload;
   auto payloadIt = sections.find(kPayload);
   if (payloadIt != sections.end() && payloadIt->second.second != 0) {
@@ -308,31 +343,8 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
   auto metaIt = sections.find(kMeta);
   if (metaIt != sections.end()) {
     const auto& metaData = metaIt->second;
-    size_t metaDataPos = 0;
-    auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
-      if (metaDataPos >= metaData.second || n == 0) {
-        return 0;
-      }
-      size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
-      memcpy(buf, metaData.first + metaDataPos, toCopy);
-      metaDataPos += toCopy;
-      return toCopy;
-    };
-    auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
-      auto it = sections.find(ename);
-      if (it == sections.end()) {
-        throw std::runtime_error("Couldn't find entity " + ename);
-      }
-      const auto& idat = it->second;
-      auto dptr = at::getCPUAllocator()->allocate(idat.second);
-      if (idat.second != 0) {
-        memcpy(dptr.get(), idat.first, idat.second);
-      }
-      return dptr;
-    };
-
     torch::jit::Unpickler unpickler(
-        metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
+        metaData.first, metaData.second, nullptr, nullptr, sectionReadFunc, {});
     auto ival = unpickler.parse_ivalue();
     for (auto&& t : ival.toTensorList()) {
       tensors.emplace_back(std::move(t));
@@ -341,6 +353,106 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
   return {std::move(payload), std::move(tensors)};
 }
 
+} // namespace
+
+std::string wireSerialize(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<WireEntry> entries;
+  std::string metaEntry;
+  // tensorData is in function scope so that the data() pointers stay valid.
+  std::vector<jit::WriteableTensorData> tensorData;
+  wireEntries(payload, tensors, entries, metaEntry, tensorData);
+  return writeWireEntries(entries, [](const WireEntry&) { return true; });
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
+    const void* data,
+    size_t data_size) {
+  auto sections = parseWireSections(data, data_size);
+  return deserializeWireSections(
+      sections, [&](const std::string& ename) -> at::DataPtr {
+        auto it = sections.find(ename);
+        if (it == sections.end()) {
+          throw std::runtime_error("Couldn't find entity " + ename);
+        }
+        const auto& idat = it->second;
+        auto dptr = at::getCPUAllocator()->allocate(idat.second);
+        if (idat.second != 0) {
+          memcpy(dptr.get(), idat.first, idat.second);
+        }
+        return dptr;
+      });
+}
+
+std::pair<std::string, std::vector<at::Tensor>> wireSerializeSplit(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<WireEntry> entries;
+  std::string metaEntry;
+  std::vector<jit::WriteableTensorData> tensorData;
+  wireEntries(payload, tensors, entries, metaEntry, tensorData);
+  auto header = writeWireEntries(entries, [](const WireEntry& e) {
+    return !isTensorSection(e.name);
+  });
+
+  // The byte tensors keep the (CPU copies of the) storages alive.
+  std::vector<at::Tensor> tensorSections;
+  tensorSections.reserve(tensorData.size());
+  for (const auto& data : tensorData) {
+    tensorSections.push_back(at::from_blob(
+        const_cast<char*>(data.data()),
+        {static_cast<int64_t>(data.sizeInBytes())},
+        [data](void*) {},
+        at::TensorOptions().dtype(at::kChar)));
+  }
+  return {std::move(header), std::move(tensorSections)};
+}
+
+std::vector<size_t> wireTensorSectionSizes(
+    const void* header,
+    size_t header_size) {
+  std::vector<size_t> sizes;
+  parseWireSections(header, header_size, &sizes);
+  return sizes;
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeSplit(
+    const void* header,
+    size_t header_size,
+    std::vector<at::Tensor> tensorSections) {
+  std::vector<size_t> sizes;
+  auto sections = parseWireSections(header, header_size, &sizes);
+  TORCH_CHECK(
+      sizes.size() == tensorSections.size(),
+      "Expected ",
+      sizes.size(),
+      " tensor sections, got ",
+      tensorSections.size());
+  return deserializeWireSections(
+      sections, [&](const std::string& ename) -> at::DataPtr {
+        TORCH_CHECK(
+            isTensorSection(ename) &&
+                c10::stoull(ename) < tensorSections.size(),
+            "Couldn't find entity ",
+            ename);
+        const auto index = c10::stoull(ename);
+        auto& section = tensorSections[index];
+        TORCH_CHECK(
+            section.device().is_cpu() &&
+                static_cast<size_t>(section.nbytes()) == sizes[index],
+            "Unexpected data for tensor section ",
+            ename);
+        // Hand out the received data without copying it, the DataPtr keeps
+        // the section alive.
+        return at::DataPtr(
+            section.data_ptr(),
+            new at::Tensor(section),
+            [](void* ctx) { delete static_cast<at::Tensor*>(ctx); },
+            section.device());
+      });
+}
+
 } // namespace rpc
 } // namespace distributed
 } // namespace torch
@@ -39,6 +39,28 @@ TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size);
 
+// Same format as wireSerialize, except that the contents of the tensor
+// sections don't follow the header. They are returned as byte tensors
+// instead, which point into the storages of CPU tensors, so transports can
+// send them without copying them into one buffer first.
+TORCH_API std::pair<std::string, std::vector<at::Tensor>> wireSerializeSplit(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors);
+
+// Returns the sizes in bytes of the tensor sections listed in a header of
+// wireSerializeSplit, which are to be received separately.
+TORCH_API std::vector<size_t> wireTensorSectionSizes(
+    const void* header,
+    size_t header_size);
+
+// Inverse of wireSerializeSplit. The tensors share the memory of the
+// `tensorSections` byte tensors.
+TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>>
+wireDeserializeSplit(
+    const void* header,
+    size_t header_size,
+    std::vector<at::Tensor> tensorSections);
+
 // Some Tensors are effectively views of larger Tensors, where only a small
 // subset of the Storage data is referenced. This normally is good and avoids
 // copies when kept locally, but if we naively push the whole Storage over the
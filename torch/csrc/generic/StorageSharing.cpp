@@ -15,6 +15,9 @@ static PyObject * THPStorage_(sharedDecref)(THPStorage *self, PyObject *noargs)
   if (ctx) {
     ctx->decref();
   }
+  if (auto pooled_ctx = torch::PooledSharedMemory::fromDataPtr(storage->data_ptr())) {
+    pooled_ctx->decref();
+  }
 #endif
   Py_INCREF(self);
   return (PyObject *)self;
@@ -30,6 +33,9 @@ static PyObject * THPStorage_(sharedIncref)(THPStorage *self, PyObject *noargs)
   if (ctx) {
     ctx->incref();
   }
+  if (auto pooled_ctx = torch::PooledSharedMemory::fromDataPtr(storage->data_ptr())) {
+    pooled_ctx->incref();
+  }
 #endif
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
@@ -130,6 +136,10 @@ static PyObject * THPStorage_(newSharedFilename)(PyObject *_unused, PyObject *ar
 
 static THWStorage* THPStorage_(newFdStorage)(ptrdiff_t size)
 {
+  // See Note [Pooled shared memory]
+  if (auto pooled = torch::PooledSharedMemory::allocate(size * sizeof(scalar_t))) {
+    return THWStorage_(newWithDataAndAllocator)(std::move(pooled), size, /* allocator */ nullptr);
+  }
   int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM |
               TH_ALLOCATOR_MAPPED_EXCLUSIVE |
               TH_ALLOCATOR_MAPPED_KEEPFD |
@@ -150,31 +160,47 @@ static PyObject * THPStorage_(pyNewFdStorage)(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+// Returns the file descriptor of a storage in shared memory, or -1.
+static int THPStorage_(sharedMemoryFd)(THWStorage *storage, bool *pooled)
+{
+  if (auto ctx = torch::PooledSharedMemory::fromDataPtr(storage->data_ptr())) {
+    *pooled = true;
+    return ctx->fd();
+  }
+  *pooled = false;
+  if (auto ctx = THMapAllocator::fromDataPtr(storage->data_ptr())) {
+    return ctx->fd();
+  }
+  return -1;
+}
+
 static PyObject * THPStorage_(shareFd)(THPStorage *self, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
   THWStorage *storage = self->cdata;
-  THMapAllocator *ctx;
+  bool pooled;
+  int fd = THPStorage_(sharedMemoryFd)(storage, &pooled);
   // Storage is already in shared memory, just return a handle
-  if ((ctx = THMapAllocator::fromDataPtr(storage->data_ptr()))) {
+  if (fd != -1) {
     // done
   } else {
     THWStoragePtr new_storage(THPStorage_(newFdStorage)(storage->numel()));
     THWStorage_(copy)(new_storage, storage);
     THWStorage_(swap)(storage, new_storage);
-    ctx = THMapAllocator::fromDataPtr(storage->data_ptr());
-    AT_ASSERT(ctx);
+    fd = THPStorage_(sharedMemoryFd)(storage, &pooled);
+    AT_ASSERT(fd != -1);
   }
 
-  THPObjectPtr storage_handle(PyLong_FromLong(ctx->fd()));
+  THPObjectPtr storage_handle(PyLong_FromLong(fd));
   if (!storage_handle) return nullptr;
   THPObjectPtr size(PyLong_FromLong(storage->numel()));
   if (!size) return nullptr;
 
-  THPObjectPtr tuple(PyTuple_New(2));
+  THPObjectPtr tuple(PyTuple_New(3));
   if (!tuple) return nullptr;
   PyTuple_SET_ITEM(tuple.get(), 0, storage_handle.release());
   PyTuple_SET_ITEM(tuple.get(), 1, size.release());
+  PyTuple_SET_ITEM(tuple.get(), 2, PyBool_FromLong(pooled));
   return tuple.release();
   END_HANDLE_TH_ERRORS
 }
@@ -182,17 +208,25 @@ static PyObject * THPStorage_(shareFd)(THPStorage *self, PyObject *noargs)
 static PyObject * THPStorage_(newSharedFd)(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
-  THPUtils_assert(PyTuple_GET_SIZE(args) == 2, "tuple of 2 items expected");
+  Py_ssize_t num_args = PyTuple_GET_SIZE(args);
+  THPUtils_assert(num_args == 2 || num_args == 3, "tuple of 2 or 3 items expected");
   PyObject *_tmp_fd = PyTuple_GET_ITEM(args, 0);
   PyObject *_size = PyTuple_GET_ITEM(args, 1);
-  if (!THPUtils_checkLong(_tmp_fd) || !THPUtils_checkLong(_size)) {
+  PyObject *_pooled = num_args == 3 ? PyTuple_GET_ITEM(args, 2) : Py_False;
+  if (!THPUtils_checkLong(_tmp_fd) || !THPUtils_checkLong(_size) || !PyBool_Check(_pooled)) {
     THPUtils_invalidArguments(args, nullptr, "_new_shared in file descriptor mode",
-        1, "a file descriptor (int) and storage size (int)");
+        1, "a file descriptor (int), storage size (int) and whether it is pooled (bool)");
     return nullptr;
   }
   int fd;
   int tmp_fd = (int) THPUtils_unpackLong(_tmp_fd);
   int64_t size = THPUtils_unpackLong(_size);
+  if (_pooled == Py_True) {
+    return THPStorage_(New)(
+            THWStorage_(newWithDataAndAllocator)(
+              torch::PooledSharedMemory::fromFd(tmp_fd, size * sizeof(scalar_t)),
+              size, /* allocator */ nullptr));
+  }
   if ((fd = dup(tmp_fd)) == -1) {
     THPUtils_setError("could not duplicate a shared memory file descriptor");
     return nullptr;
@@ -378,10 +412,8 @@ static PyObject * THPStorage_(newSharedCuda)(PyObject *_unused, PyObject *args)
     // Ensure that producer prepared all tensor's data
     std::string s_ipc_event_handle =
         THPStorage_(bytesAsHandleString)(_event_handle);
-    auto ipc_event_handle = reinterpret_cast<const cudaIpcEventHandle_t*>(
-        s_ipc_event_handle.c_str());
-    cudaEvent_t event;
-    cudaIpcOpenEventHandle(&event, *ipc_event_handle);
+    cudaEvent_t event = torch::CudaIPCOpenEventHandle(
+        s_ipc_event_handle, static_cast<c10::DeviceIndex>(device));
     AT_CUDA_CHECK(
         cudaStreamWaitEvent(c10::cuda::getCurrentCUDAStream(device), event, 0));
   }
@@ -499,14 +531,14 @@ PyObject * THPStorage_(expired)(PyObject *_unused, PyObject *arg)
 PyObject * THPStorage_(sharedFd)(THPStorage *self, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
-  THMapAllocator *ctx = nullptr;
+  int fd = -1;
 #ifndef THC_GENERIC_FILE
-  THWStorage *storage = self->cdata;
-  ctx = THMapAllocator::fromDataPtr(storage->data_ptr());
+  bool pooled;
+  fd = THPStorage_(sharedMemoryFd)(self->cdata, &pooled);
 #endif
 
-  THPUtils_assert(ctx, "couldn't retrieve a shared file descriptor");
-  return PyLong_FromLong(ctx->fd());
+  THPUtils_assert(fd != -1, "couldn't retrieve a shared file descriptor");
+  return PyLong_FromLong(fd);
   END_HANDLE_TH_ERRORS
 }
 
@@ -516,7 +548,8 @@ PyObject * THPStorage_(isShared)(THPStorage *self, PyObject *noargs)
   Py_RETURN_TRUE;
 #else
   if (THMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
-      THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr())) {
+      THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
+      torch::PooledSharedMemory::fromDataPtr(self->cdata->data_ptr())) {
     Py_RETURN_TRUE;
   } else {
     Py_RETURN_FALSE;
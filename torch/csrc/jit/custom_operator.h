@@ -3,6 +3,7 @@
 #include <torch/csrc/jit/operator.h>
 #include <ATen/core/stack.h>
 #include <ATen/core/op_registration/op_registration.h>
+#include <c10/util/InitStats.h>
 
 namespace torch {
 namespace jit {
@@ -18,6 +19,7 @@ struct TORCH_API RegisterOperators {
 
   /// Registers a vector of already created `Operator`s.
   RegisterOperators(std::vector<Operator> operators) {
+    c10::InitTimer timer("jit::RegisterOperators");
     for (Operator& o : operators) {
       registerOperator(std::move(o));
     }
@@ -55,6 +55,7 @@ class ScriptModuleSerializer {
     std::vector<IValue> ivalue_constants(
         constant_table_.begin(), constant_table_.end());
     writeArchive("constants", c10::ivalue::Tuple::create(ivalue_constants));
+    writeProfiles();
     if (bytecode_format) {
       writeByteCode(module);
     }
@@ -107,6 +108,34 @@ class ScriptModuleSerializer {
     }
   }
 
+  // Saves what the executors of the methods have profiled, so that the
+  // loaded methods are optimized on their first run instead of profiling
+  // again (see GraphExecutor::saveProfile).
+  void writeProfiles() {
+    std::vector<IValue> profiles;
+    for (const auto& named_type : class_deps_) {
+      auto class_type = named_type->cast<ClassType>();
+      if (!class_type) {
+        continue;
+      }
+      for (Function* method : class_type->methods()) {
+        GraphExecutor* executor = method->executor_if_created();
+        if (!executor) {
+          continue;
+        }
+        if (auto profile = executor->saveProfile()) {
+          profiles.push_back(c10::ivalue::Tuple::create(
+              {class_type->name()->qualifiedName(),
+               method->name(),
+               std::move(*profile)}));
+        }
+      }
+    }
+    if (!profiles.empty()) {
+      writeArchive("profiles", c10::ivalue::Tuple::create(std::move(profiles)));
+    }
+  }
+
   void writeCode(const at::NamedTypePtr& root_type) {
     class_deps_.push_back(root_type);
     for (size_t i = 0; i < class_deps_.size(); ++i) {
@@ -151,7 +180,9 @@ class ScriptModuleSerializer {
       const auto& func = method.function();
       auto graph = func.graph()->copy();
       Inline(*graph);
-      torch::jit::Code code(graph);
+      // the mobile interpreter only runs the basic instructions
+      torch::jit::Code code(
+          graph, /*remaining_bailout_depth=*/0, /*emit_superinstructions=*/false);
       // Make a copy of opnames. Some of them may be changed for mobile later.
       std::vector<c10::OperatorName> opnames;
       for (size_t i = 0; i < code.instructions().size(); ++i) {
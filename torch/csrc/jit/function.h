@@ -103,6 +103,12 @@ struct TORCH_API Function {
     return executor_;
   }
 
+  // Returns the executor if get_executor() has created it, nullptr otherwise.
+  GraphExecutor* executor_if_created() {
+    std::lock_guard<std::recursive_mutex> lock(compile_mutex);
+    return executor_ ? &executor_ : nullptr;
+  }
+
  private:
   c10::QualifiedName name_;
   // The original, non-optimized graph
@@ -5,6 +5,7 @@
 #include <c10/util/Exception.h>
 #include <torch/csrc/jit/code_template.h>
 #include <torch/csrc/jit/fuser/codegen.h>
+#include <torch/csrc/jit/fuser/cpu/interpreted_kernel.h>
 #include <torch/csrc/jit/fuser/interface.h>
 #include <torch/csrc/jit/fuser/kernel_cache.h>
 #include <torch/csrc/jit/fuser/tensor_desc.h>
@@ -104,7 +105,14 @@ static void setInputChunkDescriptors(KernelSpec& spec) {
   }
 }
 
+static bool isRowReduction(const Node* node) {
+  return node->kind() == aten::sum || node->kind() == aten::mean;
+}
+
 // Run a DFS traversal to find all inputs that affect a given output value
+// Note: row reductions (see KernelSpec::hasRowwise) are not traversed, since
+// their results are broadcast along the last dimension instead of being
+// expanded to the map size.
 static std::vector<int64_t> getInputDependencies(const Value* output) {
   std::vector<const Value*> queue{output};
   std::unordered_set<const Value*> inputs;
@@ -126,6 +134,9 @@ static std::vector<int64_t> getInputDependencies(const Value* output) {
       inputs.insert(val);
       continue;
     }
+    if (isRowReduction(producer)) {
+      continue;
+    }
     for (const Value* input : producer->inputs()) {
       if (/*bool inserted = */ seen.insert(input).second) {
         queue.push_back(input);
@@ -156,6 +167,14 @@ static void setInputBroadcastGroups(KernelSpec& spec) {
       broadcast_groups.insert(getInputDependencies(output));
     }
   }
+  // Row-wise ops must see whole rows of the map size, and not rows that were
+  // expanded along the last dimension, so their inputs must also have the
+  // map size.
+  for (const Node* n : spec.graph()->nodes()) {
+    if (KernelSpec::isRowwiseKind(n->kind())) {
+      broadcast_groups.insert(getInputDependencies(n->input(0)));
+    }
+  }
   std::copy(
       broadcast_groups.begin(),
       broadcast_groups.end(),
@@ -281,6 +300,27 @@ std::shared_ptr<FusedKernel> compileKernel(
 
   const bool use_cuda = device.is_cuda();
   const std::string name = "kernel_" + c10::to_string(next_kernel_id++);
+  if (!use_cuda && !fuseOnCPUWithCompiler()) {
+    auto program = cpu::interpretFusionGroup(*graph, flat_inputs, flat_outputs);
+    if (program) {
+      if (debugFuser()) {
+        std::cerr << "fusion program:\n" << program->str() << std::endl;
+      }
+      return std::make_shared<cpu::InterpretedKernelCPU>(
+          name,
+          std::move(*program),
+          input_desc,
+          output_desc,
+          chunk_desc,
+          concat_desc,
+          spec.hasRandom());
+    }
+    // Falls back to the system compiler for what cannot be interpreted
+  }
+  if (spec.hasRowwise()) {
+    // Not supported by the generated kernels, the fallback is run instead.
+    return nullptr;
+  }
   std::string code =
       generateKernel(name, *graph, flat_inputs, flat_outputs, use_cuda);
   const FusedKernelConstructor& kernel_ctor =
@@ -23,6 +23,8 @@ TORCH_API int64_t registerFusion(const Node* fusion_group);
 // Performs device-specific "runtime" compilation of the given kernel
 //  with the runtime arguments specified in ArgSpec.
 //  Outputs are allocated using map_size on the specified device.
+//  Returns nullptr if the kernel cannot be run on the device, the fallback
+//  must be run instead.
 TORCH_API std::shared_ptr<FusedKernel> compileKernel(
     const KernelSpec& spec,
     const ArgSpec& arg_spec,
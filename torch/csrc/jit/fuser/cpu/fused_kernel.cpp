@@ -4,14 +4,20 @@
 #include <torch/csrc/jit/code_template.h>
 #include <torch/csrc/jit/fuser/compiler.h>
 #include <torch/csrc/jit/fuser/cpu/temp_file.h>
+#include <torch/csrc/jit/fuser/disk_cache.h>
 #include <torch/csrc/utils/memory.h>
 
 #ifdef _MSC_VER
 #include <torch/csrc/jit/fuser/cpu/msvc_arch.h>
 #endif
 
+#include <array>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -55,12 +61,15 @@ static bool programExists(const std::string& program) {
   return (system(cmd.c_str()) == 0);
 }
 
-#ifdef _MSC_VER
 c10::optional<std::string> exec(const std::string& cmd) {
   std::array<char, 128> buffer;
   std::string result;
+#ifdef _MSC_VER
   std::unique_ptr<FILE, decltype(&_pclose)> pipe(
       _popen(cmd.c_str(), "r"), _pclose);
+#else
+  std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
+#endif
   if (!pipe) {
     return c10::nullopt;
   }
@@ -70,6 +79,7 @@ c10::optional<std::string> exec(const std::string& cmd) {
   return result;
 }
 
+#ifdef _MSC_VER
 inline std::string& rtrim(std::string& s, const char* t = " \t\n\r\f\v") {
   s.erase(s.find_last_not_of(t) + 1);
   return s;
@@ -187,6 +197,20 @@ struct CompilerConfig {
 
   ~CompilerConfig() = default;
 
+  // Identifies the compiler for the kernel disk cache
+  const std::string& version() {
+    std::call_once(version_flag, [this] {
+#ifdef _MSC_VER
+      // cl prints its version in the banner when run without arguments
+      auto out = exec("\"" + cxx + "\" 2>&1");
+#else
+      auto out = exec("\"" + cxx + "\" --version 2>&1");
+#endif
+      version_ = cxx + "\n" + (out ? *out : "");
+    });
+    return version_;
+  }
+
   #ifdef _MSC_VER
     std::string cxx = "cl";
     const std::string openmp_flags = "/openmp";
@@ -195,6 +219,10 @@ struct CompilerConfig {
     const std::string openmp_flags = "-fopenmp";
   #endif
   bool openmp = true;
+
+ private:
+  std::once_flag version_flag;
+  std::string version_;
 };
 
 static CompilerConfig& getConfig() {
@@ -276,6 +304,24 @@ static void disas(const std::string& so_file) {
   AT_ASSERT(r == 0);
 }
 
+static std::string diskCacheKey(
+    const std::string& code,
+    const std::string& name) {
+  auto& config = getConfig();
+  std::ostringstream backend;
+  backend << "cpu\n"
+          << config.version() << "\n"
+          << compile_string << "\n"
+          << (config.openmp ? config.openmp_flags : "");
+  return kernelDiskCacheKey(backend.str(), code, name);
+}
+
+static std::string readFile(const std::string& name) {
+  std::ifstream in(name, std::ios::binary);
+  return std::string(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
 FusedKernelCPU::FusedKernelCPU(
     std::string name,
     std::string code,
@@ -293,20 +339,41 @@ FusedKernelCPU::FusedKernelCPU(
           std::move(concat_desc),
           has_random) {
   TempFile so_file(so_template, so_suffix_len);
-  TempFile cpp_file(cpp_template, cpp_suffix_len);
-  cpp_file.write(code_);
-  cpp_file.sync();
+  // The name of the kernel in the shared object
+  std::string symbol = name_;
+  c10::optional<std::string> cache_key;
+  c10::optional<CachedKernelBinary> cached;
+  if (kernelDiskCacheEnabled()) {
+    cache_key = diskCacheKey(code_, name_);
+    cached = loadCachedKernelBinary(*cache_key);
+  }
+  if (cached) {
+    symbol = cached->kernel_name;
+    so_file.write(cached->binary);
+    so_file.sync();
 #ifdef _MSC_VER
-  so_file.close();
-  cpp_file.close();
+    so_file.close();
 #endif
-  runCompiler(cpp_file.name(), so_file.name());
+  } else {
+    TempFile cpp_file(cpp_template, cpp_suffix_len);
+    cpp_file.write(code_);
+    cpp_file.sync();
+#ifdef _MSC_VER
+    so_file.close();
+    cpp_file.close();
+#endif
+    runCompiler(cpp_file.name(), so_file.name());
+    if (cache_key) {
+      storeCachedKernelBinary(
+          *cache_key, CachedKernelBinary{name_, readFile(so_file.name())});
+    }
+  }
   if (debugFuser() >= 2)
     disas(so_file.name());
   so_lib = make_unique<at::DynamicLibrary>(so_file.name().c_str());
 #pragma GCC diagnostic ignored "-Wpedantic"
   kernel =
-      reinterpret_cast<void (*)(uint32_t, void**)>(so_lib->sym(name_.c_str()));
+      reinterpret_cast<void (*)(uint32_t, void**)>(so_lib->sym(symbol.c_str()));
 #pragma GCC diagnostic pop
 }
 
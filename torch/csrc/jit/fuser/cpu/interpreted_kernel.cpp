@@ -0,0 +1,842 @@
+#include <torch/csrc/jit/fuser/cpu/interpreted_kernel.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/jit/fuser/tensor_info.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cpu {
+
+namespace {
+
+// Number of elements every instruction processes at once. Must be a multiple
+// of the vector width, the registers are padded to it.
+constexpr int64_t kBlockSize = 256;
+
+const char* opName(InterpretedOp op) {
+  switch (op) {
+#define DEFINE_CASE(name)    \
+  case InterpretedOp::name: \
+    return #name;
+    FORALL_INTERPRETED_OPS(DEFINE_CASE)
+#undef DEFINE_CASE
+  }
+  return "<unknown>";
+}
+
+bool isSupportedScalarType(at::ScalarType type) {
+  switch (type) {
+    case at::kFloat:
+    case at::kDouble:
+    case at::kBool:
+    case at::kByte:
+    case at::kChar:
+    case at::kShort:
+    case at::kInt:
+    case at::kLong:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Whether a float does not represent all values of type exactly.
+bool needsDouble(at::ScalarType type) {
+  return type == at::kDouble || type == at::kInt || type == at::kLong;
+}
+
+// Ops whose result is the same for all their overloads handled here, with
+// the number of inputs they take. aten::add, aten::clamp etc. are special
+// cased in interpretFusionGroup.
+const std::unordered_map<NodeKind, std::pair<InterpretedOp, size_t>>&
+simpleOps() {
+  static const std::unordered_map<NodeKind, std::pair<InterpretedOp, size_t>>
+      ops = {
+          {aten::abs, {InterpretedOp::Abs, 1}},
+          {aten::neg, {InterpretedOp::Neg, 1}},
+          {aten::exp, {InterpretedOp::Exp, 1}},
+          {aten::expm1, {InterpretedOp::Expm1, 1}},
+          {aten::log, {InterpretedOp::Log, 1}},
+          {aten::log10, {InterpretedOp::Log10, 1}},
+          {aten::log1p, {InterpretedOp::Log1p, 1}},
+          {aten::log2, {InterpretedOp::Log2, 1}},
+          {aten::lgamma, {InterpretedOp::Lgamma, 1}},
+          {aten::erf, {InterpretedOp::Erf, 1}},
+          {aten::erfc, {InterpretedOp::Erfc, 1}},
+          {aten::cos, {InterpretedOp::Cos, 1}},
+          {aten::acos, {InterpretedOp::Acos, 1}},
+          {aten::cosh, {InterpretedOp::Cosh, 1}},
+          {aten::sin, {InterpretedOp::Sin, 1}},
+          {aten::asin, {InterpretedOp::Asin, 1}},
+          {aten::sinh, {InterpretedOp::Sinh, 1}},
+          {aten::tan, {InterpretedOp::Tan, 1}},
+          {aten::atan, {InterpretedOp::Atan, 1}},
+          {aten::tanh, {InterpretedOp::Tanh, 1}},
+          {aten::sqrt, {InterpretedOp::Sqrt, 1}},
+          {aten::rsqrt, {InterpretedOp::Rsqrt, 1}},
+          {aten::ceil, {InterpretedOp::Ceil, 1}},
+          {aten::floor, {InterpretedOp::Floor, 1}},
+          {aten::round, {InterpretedOp::Round, 1}},
+          {aten::trunc, {InterpretedOp::Trunc, 1}},
+          {aten::frac, {InterpretedOp::Frac, 1}},
+          {aten::reciprocal, {InterpretedOp::Reciprocal, 1}},
+          {aten::sigmoid, {InterpretedOp::Sigmoid, 1}},
+          {aten::relu, {InterpretedOp::Relu, 1}},
+          {aten::mul, {InterpretedOp::Mul, 2}},
+          {aten::div, {InterpretedOp::Div, 2}},
+          {aten::atan2, {InterpretedOp::Atan2, 2}},
+          {aten::min, {InterpretedOp::Min, 2}},
+          {aten::max, {InterpretedOp::Max, 2}},
+          {aten::pow, {InterpretedOp::Pow, 2}},
+          {aten::fmod, {InterpretedOp::Fmod, 2}},
+          {aten::remainder, {InterpretedOp::Remainder, 2}},
+          {aten::eq, {InterpretedOp::Eq, 2}},
+          {aten::ne, {InterpretedOp::Ne, 2}},
+          {aten::lt, {InterpretedOp::Lt, 2}},
+          {aten::le, {InterpretedOp::Le, 2}},
+          {aten::gt, {InterpretedOp::Gt, 2}},
+          {aten::ge, {InterpretedOp::Ge, 2}},
+          {aten::_sigmoid_backward, {InterpretedOp::SigmoidBackward, 2}},
+          {aten::_tanh_backward, {InterpretedOp::TanhBackward, 2}},
+          {aten::add, {InterpretedOp::Add, 3}},
+          {aten::sub, {InterpretedOp::Sub, 3}},
+          {aten::lerp, {InterpretedOp::Lerp, 3}},
+          {aten::where, {InterpretedOp::Where, 3}},
+          {aten::threshold, {InterpretedOp::Threshold, 3}},
+          {aten::addcmul, {InterpretedOp::Addcmul, 4}},
+      };
+  return ops;
+}
+
+bool isComparison(InterpretedOp op) {
+  switch (op) {
+    case InterpretedOp::Eq:
+    case InterpretedOp::Ne:
+    case InterpretedOp::Lt:
+    case InterpretedOp::Le:
+    case InterpretedOp::Gt:
+    case InterpretedOp::Ge:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Same indexing as the generated kernels, see emitIndexingFor in codegen.cpp
+inline uint32_t offsetOf(
+    TensorInfo* info,
+    size_t nDim,
+    bool last_is_contiguous,
+    uint32_t linear_index) {
+  if (nDim == 1 && last_is_contiguous) {
+    return linear_index;
+  }
+  const uint32_t* sizes = info->sizes(nDim);
+  const uint32_t* strides = info->strides(nDim);
+  uint32_t offset = 0;
+  for (int64_t d = static_cast<int64_t>(nDim) - 1; d >= 0; --d) {
+    uint32_t index = d > 0 ? linear_index % sizes[d] : linear_index;
+    if (d < static_cast<int64_t>(nDim) - 1 || !last_is_contiguous) {
+      index *= strides[d];
+    }
+    offset += index;
+    if (d > 0) {
+      linear_index /= sizes[d];
+    }
+  }
+  return offset;
+}
+
+template <typename T>
+void load(
+    const InterpretedTensorArg& arg,
+    void** arguments,
+    uint32_t begin,
+    int64_t n,
+    T* out) {
+  auto info = static_cast<TensorInfo*>(arguments[arg.argument]);
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::Bool, arg.scalar_type, "fused_kernel_load", [&] {
+        const scalar_t* data = static_cast<const scalar_t*>(info->data);
+        if (arg.nDim == 1 && arg.last_is_contiguous) {
+          data += begin;
+          for (int64_t i = 0; i < n; ++i) {
+            out[i] = static_cast<T>(data[i]);
+          }
+        } else {
+          for (int64_t i = 0; i < n; ++i) {
+            out[i] = static_cast<T>(data[offsetOf(
+                info, arg.nDim, arg.last_is_contiguous, begin + i)]);
+          }
+        }
+      });
+}
+
+template <typename T>
+void store(
+    const InterpretedTensorArg& arg,
+    void** arguments,
+    uint32_t begin,
+    int64_t n,
+    const T* in) {
+  auto info = static_cast<TensorInfo*>(arguments[arg.argument]);
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::Bool, arg.scalar_type, "fused_kernel_store", [&] {
+        scalar_t* data = static_cast<scalar_t*>(info->data);
+        if (arg.nDim == 1 && arg.last_is_contiguous) {
+          data += begin;
+          for (int64_t i = 0; i < n; ++i) {
+            data[i] = static_cast<scalar_t>(in[i]);
+          }
+        } else {
+          for (int64_t i = 0; i < n; ++i) {
+            data[offsetOf(info, arg.nDim, arg.last_is_contiguous, begin + i)] =
+                static_cast<scalar_t>(in[i]);
+          }
+        }
+      });
+}
+
+// Row reductions over the first n elements of a register, not its padding.
+template <typename T>
+T rowSum(const T* data, int64_t n) {
+  using Vec = at::vec256::Vec256<T>;
+  return at::vec256::reduce_all<T>(
+      [](Vec x, Vec y) { return x + y; }, const_cast<T*>(data), n);
+}
+
+template <typename T>
+T rowMax(const T* data, int64_t n) {
+  using Vec = at::vec256::Vec256<T>;
+  return at::vec256::reduce_all<T>(
+      [](Vec x, Vec y) { return at::vec256::maximum(x, y); },
+      const_cast<T*>(data),
+      n);
+}
+
+// Runs a single instruction over the first n elements of its registers,
+// which are stride elements apart. n is the row size for row-wise programs.
+// Ops with a Vec256 implementation run over whole vectors and may compute
+// garbage in the padding of the registers, the others run elementwise in
+// the same way as the code generated for them (see encodeRHS in codegen.cpp)
+// and are left to the auto-vectorizer.
+template <typename T>
+void execute(
+    const InterpretedInstruction& instruction,
+    T* registers,
+    int64_t stride,
+    int64_t n) {
+  using Vec = at::vec256::Vec256<T>;
+  T* out = registers + instruction.output * stride;
+  const T* in[4] = {nullptr, nullptr, nullptr, nullptr};
+  for (size_t i = 0; i < instruction.inputs.size(); ++i) {
+    in[i] = registers + instruction.inputs[i] * stride;
+  }
+  const T* a = in[0];
+  const T* b = in[1];
+  const T* c = in[2];
+  const T* d = in[3];
+  const int64_t padded_n = (n + Vec::size() - 1) / Vec::size() * Vec::size();
+
+  auto vec_map = [&](auto f) {
+    for (int64_t i = 0; i < padded_n; i += Vec::size()) {
+      f(Vec::loadu(a + i)).store(out + i);
+    }
+  };
+  auto vec_map2 = [&](auto f) {
+    for (int64_t i = 0; i < padded_n; i += Vec::size()) {
+      f(Vec::loadu(a + i), Vec::loadu(b + i)).store(out + i);
+    }
+  };
+  auto vec_map3 = [&](auto f) {
+    for (int64_t i = 0; i < padded_n; i += Vec::size()) {
+      f(Vec::loadu(a + i), Vec::loadu(b + i), Vec::loadu(c + i))
+          .store(out + i);
+    }
+  };
+  auto vec_scale = [&](T scale) {
+    for (int64_t i = 0; i < padded_n; i += Vec::size()) {
+      (Vec::loadu(out + i) * Vec(scale)).store(out + i);
+    }
+  };
+  auto map = [&](auto f) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = f(a[i]);
+    }
+  };
+  auto map2 = [&](auto f) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = f(a[i], b[i]);
+    }
+  };
+  auto map3 = [&](auto f) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = f(a[i], b[i], c[i]);
+    }
+  };
+  const T one = 1;
+  const T zero = 0;
+
+  switch (instruction.op) {
+    case InterpretedOp::Abs:
+      return vec_map([](Vec x) { return x.abs(); });
+    case InterpretedOp::Neg:
+      return vec_map([](Vec x) { return x.neg(); });
+    case InterpretedOp::Exp:
+      return vec_map([](Vec x) { return x.exp(); });
+    case InterpretedOp::Expm1:
+      return vec_map([](Vec x) { return x.expm1(); });
+    case InterpretedOp::Log:
+      return vec_map([](Vec x) { return x.log(); });
+    case InterpretedOp::Log10:
+      return vec_map([](Vec x) { return x.log10(); });
+    case InterpretedOp::Log1p:
+      return vec_map([](Vec x) { return x.log1p(); });
+    case InterpretedOp::Log2:
+      return vec_map([](Vec x) { return x.log2(); });
+    case InterpretedOp::Lgamma:
+      return vec_map([](Vec x) { return x.lgamma(); });
+    case InterpretedOp::Erf:
+      return vec_map([](Vec x) { return x.erf(); });
+    case InterpretedOp::Erfc:
+      return vec_map([](Vec x) { return x.erfc(); });
+    case InterpretedOp::Cos:
+      return vec_map([](Vec x) { return x.cos(); });
+    case InterpretedOp::Acos:
+      return vec_map([](Vec x) { return x.acos(); });
+    case InterpretedOp::Cosh:
+      return vec_map([](Vec x) { return x.cosh(); });
+    case InterpretedOp::Sin:
+      return vec_map([](Vec x) { return x.sin(); });
+    case InterpretedOp::Asin:
+      return vec_map([](Vec x) { return x.asin(); });
+    case InterpretedOp::Sinh:
+      return vec_map([](Vec x) { return x.sinh(); });
+    case InterpretedOp::Tan:
+      return vec_map([](Vec x) { return x.tan(); });
+    case InterpretedOp::Atan:
+      return vec_map([](Vec x) { return x.atan(); });
+    case InterpretedOp::Tanh:
+      return vec_map([](Vec x) { return x.tanh(); });
+    case InterpretedOp::Sqrt:
+      return vec_map([](Vec x) { return x.sqrt(); });
+    case InterpretedOp::Rsqrt:
+      return vec_map([](Vec x) { return x.rsqrt(); });
+    case InterpretedOp::Ceil:
+      return vec_map([](Vec x) { return x.ceil(); });
+    case InterpretedOp::Floor:
+      return vec_map([](Vec x) { return x.floor(); });
+    case InterpretedOp::Round:
+      return vec_map([](Vec x) { return x.round(); });
+    case InterpretedOp::Trunc:
+      return vec_map([](Vec x) { return x.trunc(); });
+    case InterpretedOp::Frac:
+      return vec_map([](Vec x) { return x.frac(); });
+    case InterpretedOp::Reciprocal:
+      return vec_map([](Vec x) { return x.reciprocal(); });
+    case InterpretedOp::Sigmoid:
+      return vec_map(
+          [one](Vec x) { return Vec(one) / (Vec(one) + x.neg().exp()); });
+    case InterpretedOp::Relu:
+      return map([zero](T x) { return x < zero ? zero : x; });
+    case InterpretedOp::ToFloat:
+      return map([](T x) { return static_cast<T>(static_cast<float>(x)); });
+    case InterpretedOp::ToIntegral:
+      return vec_map([](Vec x) { return x.trunc(); });
+    case InterpretedOp::ToBool:
+      return map([](T x) { return static_cast<T>(x != 0); });
+    case InterpretedOp::Mul:
+      return vec_map2([](Vec x, Vec y) { return x * y; });
+    case InterpretedOp::Div:
+      return vec_map2([](Vec x, Vec y) { return x / y; });
+    case InterpretedOp::Atan2:
+      return vec_map2([](Vec x, Vec y) { return x.atan2(y); });
+    case InterpretedOp::Min:
+      return map2([](T x, T y) { return std::fmin(x, y); });
+    case InterpretedOp::Max:
+      return map2([](T x, T y) { return std::fmax(x, y); });
+    case InterpretedOp::Pow:
+      return vec_map2([](Vec x, Vec y) { return x.pow(y); });
+    case InterpretedOp::Fmod:
+      return map2([](T x, T y) { return std::fmod(x, y); });
+    case InterpretedOp::Remainder:
+      // Same as the eager kernel, the result has the sign of the divisor.
+      return map2([zero](T x, T y) {
+        T r = std::fmod(x, y);
+        return (r != zero && ((r < zero) != (y < zero))) ? r + y : r;
+      });
+    case InterpretedOp::Eq:
+      return map2([](T x, T y) { return static_cast<T>(x == y); });
+    case InterpretedOp::Ne:
+      return map2([](T x, T y) { return static_cast<T>(x != y); });
+    case InterpretedOp::Lt:
+      return map2([](T x, T y) { return static_cast<T>(x < y); });
+    case InterpretedOp::Le:
+      return map2([](T x, T y) { return static_cast<T>(x <= y); });
+    case InterpretedOp::Gt:
+      return map2([](T x, T y) { return static_cast<T>(x > y); });
+    case InterpretedOp::Ge:
+      return map2([](T x, T y) { return static_cast<T>(x >= y); });
+    case InterpretedOp::ClampMin:
+      return map2([](T x, T lo) { return x < lo ? lo : x; });
+    case InterpretedOp::ClampMax:
+      return map2([](T x, T hi) { return x > hi ? hi : x; });
+    case InterpretedOp::SigmoidBackward:
+      return vec_map2(
+          [one](Vec grad, Vec y) { return grad * y * (Vec(one) - y); });
+    case InterpretedOp::TanhBackward:
+      return vec_map2(
+          [one](Vec grad, Vec y) { return grad * (Vec(one) - y * y); });
+    case InterpretedOp::Add:
+      return vec_map3([](Vec x, Vec y, Vec alpha) { return x + alpha * y; });
+    case InterpretedOp::Sub:
+      return vec_map3([](Vec x, Vec y, Vec alpha) { return x - alpha * y; });
+    case InterpretedOp::Lerp:
+      return vec_map3(
+          [](Vec x, Vec end, Vec weight) { return x + weight * (end - x); });
+    case InterpretedOp::Where:
+      return map3([zero](T cond, T x, T y) { return cond != zero ? x : y; });
+    case InterpretedOp::Threshold:
+      return map3([](T x, T threshold, T value) {
+        return x <= threshold ? value : x;
+      });
+    case InterpretedOp::Clamp:
+      return map3(
+          [](T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); });
+    case InterpretedOp::Addcmul:
+      for (int64_t i = 0; i < padded_n; i += Vec::size()) {
+        (Vec::loadu(a + i) +
+         Vec::loadu(d + i) * Vec::loadu(b + i) * Vec::loadu(c + i))
+            .store(out + i);
+      }
+      return;
+    case InterpretedOp::RowSum:
+      std::fill_n(out, padded_n, rowSum(a, n));
+      return;
+    case InterpretedOp::RowMean:
+      std::fill_n(out, padded_n, rowSum(a, n) / static_cast<T>(n));
+      return;
+    case InterpretedOp::Softmax: {
+      const T max = rowMax(a, n);
+      vec_map([max](Vec x) { return (x - Vec(max)).exp(); });
+      vec_scale(one / rowSum(out, n));
+      return;
+    }
+    case InterpretedOp::LogSoftmax: {
+      const T max = rowMax(a, n);
+      vec_map([max](Vec x) { return (x - Vec(max)).exp(); });
+      const T shift = max + std::log(rowSum(out, n));
+      return vec_map([shift](Vec x) { return x - Vec(shift); });
+    }
+    case InterpretedOp::LayerNorm: {
+      // Same as the eager kernel, with the biased variance.
+      const T mean = rowSum(a, n) / static_cast<T>(n);
+      vec_map([mean](Vec x) { return x - Vec(mean); });
+      const T var = at::vec256::map_reduce_all<T>(
+                        [](Vec x) { return x * x; },
+                        [](Vec x, Vec y) { return x + y; },
+                        out,
+                        n) /
+          static_cast<T>(n);
+      vec_scale(one / std::sqrt(var + b[0]));
+      return;
+    }
+  }
+  TORCH_INTERNAL_ASSERT(false, "unknown interpreted op");
+}
+
+} // namespace
+
+std::string InterpretedProgram::str() const {
+  std::ostringstream out;
+  out << "interpreted fusion, computing in " << compute_type << "\n";
+  if (rowwise) {
+    out << "  row-wise, row size = args[" << row_size_argument << "]\n";
+  }
+  for (const auto& arg : loads) {
+    out << "  r" << arg.reg << " = load(args[" << arg.argument << "] : "
+        << arg.scalar_type << ", nDim=" << arg.nDim << ")\n";
+  }
+  for (const auto& scalar : scalar_loads) {
+    out << "  r" << scalar.first << " = load(args[" << scalar.second
+        << "] : double)\n";
+  }
+  for (const auto& constant : constants) {
+    out << "  r" << constant.first << " = " << constant.second << "\n";
+  }
+  for (const auto& instruction : instructions) {
+    out << "  r" << instruction.output << " = " << opName(instruction.op)
+        << "(";
+    for (size_t i = 0; i < instruction.inputs.size(); ++i) {
+      out << (i > 0 ? ", r" : "r") << instruction.inputs[i];
+    }
+    out << ")\n";
+  }
+  for (const auto& arg : stores) {
+    out << "  store(args[" << arg.argument << "] : " << arg.scalar_type
+        << ", nDim=" << arg.nDim << ", r" << arg.reg << ")\n";
+  }
+  return out.str();
+}
+
+c10::optional<InterpretedProgram> interpretFusionGroup(
+    const Graph& graph,
+    const std::vector<std::pair<const Value*, const c10::optional<TensorDesc>>>&
+        flat_inputs,
+    const std::vector<std::pair<const Value*, const TensorDesc>>&
+        flat_outputs) {
+  InterpretedProgram program;
+  std::unordered_map<const Value*, int> registers;
+  bool use_double = false;
+
+  // The first argument is numel, see launchFusion in executor.cpp
+  size_t argument = 1;
+  for (const auto& input : flat_inputs) {
+    const int reg = program.num_registers++;
+    registers[input.first] = reg;
+    if (input.second) {
+      const TensorDesc& desc = *input.second;
+      if (!isSupportedScalarType(desc.scalar_type)) {
+        return c10::nullopt;
+      }
+      use_double |= needsDouble(desc.scalar_type);
+      program.loads.push_back(InterpretedTensorArg{argument++,
+                                                   reg,
+                                                   desc.scalar_type,
+                                                   desc.nDim(),
+                                                   desc.lastIsContiguous()});
+    } else {
+      program.scalar_loads.emplace_back(reg, argument++);
+    }
+  }
+
+  // Note: Concat and Chunk are implicit, as in the generated kernels
+  for (const Node* n : graph.nodes()) {
+    if (n->kind() == prim::FusedConcat || n->kind() == prim::ConstantChunk ||
+        n->mustBeNone()) {
+      continue;
+    }
+    if (n->kind() == prim::Constant) {
+      const auto val = toIValue(n->output()).value();
+      if (val.isIntList()) {
+        // The dims of the row-wise ops, read from the ops themselves
+        continue;
+      }
+      double value;
+      if (val.isDouble()) {
+        value = val.toDouble();
+      } else if (val.isBool()) {
+        value = val.toBool();
+      } else if (val.isInt()) {
+        value = val.toInt();
+      } else {
+        return c10::nullopt;
+      }
+      const int reg = program.num_registers++;
+      registers[n->output()] = reg;
+      program.constants.emplace_back(reg, value);
+      continue;
+    }
+
+    if (n->outputs().size() != 1) {
+      return c10::nullopt;
+    }
+    const auto type = n->output()->type()->cast<TensorType>();
+    if (!type || !type->scalarType() ||
+        !isSupportedScalarType(*type->scalarType())) {
+      return c10::nullopt;
+    }
+    const at::ScalarType scalar_type = *type->scalarType();
+    use_double |= needsDouble(scalar_type);
+
+    // aten::clamp with a None bound, aten::type_as and aten::_cast_Float
+    // drop inputs, all other ops use all of theirs.
+    InterpretedOp op;
+    std::vector<const Value*> inputs;
+    if (n->kind() == aten::clamp) {
+      const Value* min = n->input(1);
+      const Value* max = n->input(2);
+      inputs.push_back(n->input(0));
+      if (!min->node()->mustBeNone() && !max->node()->mustBeNone()) {
+        op = InterpretedOp::Clamp;
+        inputs.push_back(min);
+        inputs.push_back(max);
+      } else if (!min->node()->mustBeNone()) {
+        op = InterpretedOp::ClampMin;
+        inputs.push_back(min);
+      } else if (!max->node()->mustBeNone()) {
+        op = InterpretedOp::ClampMax;
+        inputs.push_back(max);
+      } else {
+        return c10::nullopt;
+      }
+    } else if (n->kind() == aten::type_as || n->kind() == aten::_cast_Float) {
+      inputs.push_back(n->input(0));
+    } else if (
+        n->kind() == aten::sum || n->kind() == aten::mean ||
+        n->kind() == aten::softmax || n->kind() == aten::log_softmax) {
+      // Over the last dimension, see isRowwise in graph_fuser.cpp
+      op = n->kind() == aten::sum
+          ? InterpretedOp::RowSum
+          : n->kind() == aten::mean
+              ? InterpretedOp::RowMean
+              : n->kind() == aten::softmax ? InterpretedOp::Softmax
+                                           : InterpretedOp::LogSoftmax;
+      inputs.push_back(n->input(0));
+      program.rowwise = true;
+    } else if (n->kind() == aten::layer_norm) {
+      // The weight and bias are applied by separate instructions, below.
+      op = InterpretedOp::LayerNorm;
+      inputs.push_back(n->namedInput(attr::input));
+      inputs.push_back(n->namedInput(attr::eps));
+      program.rowwise = true;
+      program.normalized_sizes.push_back(
+          n->get<c10::List<int64_t>>(attr::normalized_shape).value().get(0));
+    } else {
+      const auto it = simpleOps().find(n->kind());
+      if (it == simpleOps().end() ||
+          n->inputs().size() != it->second.second) {
+        return c10::nullopt;
+      }
+      op = it->second.first;
+      inputs.assign(n->inputs().begin(), n->inputs().end());
+    }
+
+    InterpretedInstruction instruction;
+    for (const Value* input : inputs) {
+      const auto it = registers.find(input);
+      if (it == registers.end()) {
+        return c10::nullopt;
+      }
+      instruction.inputs.push_back(it->second);
+    }
+
+    if (n->kind() == aten::type_as || n->kind() == aten::_cast_Float) {
+      // Conversions only round to the output type, below.
+      registers[n->output()] = instruction.inputs[0];
+    } else {
+      instruction.op = op;
+      instruction.output = program.num_registers++;
+      registers[n->output()] = instruction.output;
+      const bool is_comparison = isComparison(op);
+      program.instructions.push_back(std::move(instruction));
+      if (is_comparison && scalar_type == at::kBool) {
+        continue;
+      }
+    }
+
+    if (n->kind() == aten::layer_norm) {
+      const Value* weight = n->namedInput(attr::weight);
+      const Value* bias = n->namedInput(attr::bias);
+      if (!weight->node()->mustBeNone()) {
+        const auto it = registers.find(weight);
+        if (it == registers.end()) {
+          return c10::nullopt;
+        }
+        program.instructions.push_back({InterpretedOp::Mul,
+                                        program.num_registers,
+                                        {registers[n->output()], it->second}});
+        registers[n->output()] = program.num_registers++;
+      }
+      if (!bias->node()->mustBeNone()) {
+        const auto it = registers.find(bias);
+        if (it == registers.end()) {
+          return c10::nullopt;
+        }
+        const int alpha = program.num_registers++;
+        program.constants.emplace_back(alpha, 1.0);
+        program.instructions.push_back(
+            {InterpretedOp::Add,
+             program.num_registers,
+             {registers[n->output()], it->second, alpha}});
+        registers[n->output()] = program.num_registers++;
+      }
+    }
+
+    // Values are computed in the compute type and rounded to their own type
+    // so that later instructions see the same values as in the generated
+    // kernels. Floats are rounded once the compute type is known.
+    const int result = registers[n->output()];
+    if (scalar_type == at::kBool) {
+      program.instructions.push_back(
+          {InterpretedOp::ToBool, program.num_registers, {result}});
+    } else if (at::isIntegralType(scalar_type, /*includeBool=*/false)) {
+      program.instructions.push_back(
+          {InterpretedOp::ToIntegral, program.num_registers, {result}});
+    } else if (scalar_type == at::kFloat) {
+      program.instructions.push_back(
+          {InterpretedOp::ToFloat, program.num_registers, {result}});
+    } else {
+      continue;
+    }
+    registers[n->output()] = program.num_registers++;
+  }
+
+  for (const auto& output : flat_outputs) {
+    const TensorDesc& desc = output.second;
+    const auto it = registers.find(output.first);
+    if (it == registers.end() || !isSupportedScalarType(desc.scalar_type)) {
+      return c10::nullopt;
+    }
+    use_double |= needsDouble(desc.scalar_type);
+    program.stores.push_back(InterpretedTensorArg{argument++,
+                                                  it->second,
+                                                  desc.scalar_type,
+                                                  desc.nDim(),
+                                                  desc.lastIsContiguous()});
+  }
+  if (program.rowwise) {
+    program.row_size_argument = argument++;
+  }
+
+  program.compute_type = use_double ? at::kDouble : at::kFloat;
+  if (!use_double) {
+    // Rounding to float is a no-op when computing in float.
+    std::unordered_map<int, int> forwarded;
+    std::vector<InterpretedInstruction> instructions;
+    for (auto& instruction : program.instructions) {
+      for (int& input : instruction.inputs) {
+        const auto it = forwarded.find(input);
+        if (it != forwarded.end()) {
+          input = it->second;
+        }
+      }
+      if (instruction.op == InterpretedOp::ToFloat) {
+        forwarded[instruction.output] = instruction.inputs[0];
+      } else {
+        instructions.push_back(std::move(instruction));
+      }
+    }
+    program.instructions = std::move(instructions);
+    for (auto& arg : program.stores) {
+      const auto it = forwarded.find(arg.reg);
+      if (it != forwarded.end()) {
+        arg.reg = it->second;
+      }
+    }
+  }
+  return program;
+}
+
+InterpretedKernelCPU::InterpretedKernelCPU(
+    std::string name,
+    InterpretedProgram program,
+    std::vector<TensorDesc> input_desc,
+    std::vector<TensorDesc> output_desc,
+    std::vector<PartitionDesc> chunk_desc,
+    std::vector<PartitionDesc> concat_desc,
+    bool has_random)
+    : FusedKernel(
+          std::move(name),
+          program.str(),
+          std::move(input_desc),
+          std::move(output_desc),
+          std::move(chunk_desc),
+          std::move(concat_desc),
+          has_random),
+      program_(std::move(program)) {
+  TORCH_INTERNAL_ASSERT(!has_random_, "random ops cannot be interpreted");
+}
+
+template <typename T>
+void InterpretedKernelCPU::run(uint32_t numel, void** arguments) const {
+  at::parallel_for(
+      0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        std::vector<T> registers(program_.num_registers * kBlockSize);
+        auto reg = [&](int r) { return registers.data() + r * kBlockSize; };
+        for (const auto& constant : program_.constants) {
+          std::fill_n(
+              reg(constant.first),
+              kBlockSize,
+              static_cast<T>(constant.second));
+        }
+        for (const auto& scalar : program_.scalar_loads) {
+          const double value = *static_cast<double*>(arguments[scalar.second]);
+          std::fill_n(reg(scalar.first), kBlockSize, static_cast<T>(value));
+        }
+        for (int64_t block = begin; block < end; block += kBlockSize) {
+          const int64_t n = std::min(kBlockSize, end - block);
+          for (const auto& arg : program_.loads) {
+            load(arg, arguments, block, n, reg(arg.reg));
+          }
+          for (const auto& instruction : program_.instructions) {
+            execute(instruction, registers.data(), kBlockSize, n);
+          }
+          for (const auto& arg : program_.stores) {
+            store(arg, arguments, block, n, reg(arg.reg));
+          }
+        }
+      });
+}
+
+template <typename T>
+void InterpretedKernelCPU::runRowwise(uint32_t numel, void** arguments) const {
+  using Vec = at::vec256::Vec256<T>;
+  const int64_t row_size =
+      *static_cast<int64_t*>(arguments[program_.row_size_argument]);
+  for (int64_t normalized_size : program_.normalized_sizes) {
+    TORCH_CHECK(
+        normalized_size == row_size,
+        "layer_norm: expected input with ",
+        normalized_size,
+        " elements in its last dimension, but got ",
+        row_size);
+  }
+  // Every register holds a row, padded to whole vectors.
+  const int64_t stride =
+      (row_size + Vec::size() - 1) / Vec::size() * Vec::size();
+  const int64_t num_rows = numel / row_size;
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / row_size);
+  at::parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<T> registers(program_.num_registers * stride);
+    auto reg = [&](int r) { return registers.data() + r * stride; };
+    for (const auto& constant : program_.constants) {
+      std::fill_n(reg(constant.first), stride, static_cast<T>(constant.second));
+    }
+    for (const auto& scalar : program_.scalar_loads) {
+      const double value = *static_cast<double*>(arguments[scalar.second]);
+      std::fill_n(reg(scalar.first), stride, static_cast<T>(value));
+    }
+    for (int64_t row = begin; row < end; ++row) {
+      const uint32_t first = row * row_size;
+      for (const auto& arg : program_.loads) {
+        load(arg, arguments, first, row_size, reg(arg.reg));
+      }
+      for (const auto& instruction : program_.instructions) {
+        execute(instruction, registers.data(), stride, row_size);
+      }
+      for (const auto& arg : program_.stores) {
+        store(arg, arguments, first, row_size, reg(arg.reg));
+      }
+    }
+  });
+}
+
+void InterpretedKernelCPU::launch_raw(
+    const uint32_t numel,
+    std::vector<void*>& arguments) const {
+  const bool use_double = program_.compute_type == at::kDouble;
+  if (program_.rowwise) {
+    use_double ? runRowwise<double>(numel, arguments.data())
+               : runRowwise<float>(numel, arguments.data());
+  } else {
+    use_double ? run<double>(numel, arguments.data())
+               : run<float>(numel, arguments.data());
+  }
+}
+
+} // namespace cpu
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/fuser/fused_kernel.h>
+#include <torch/csrc/jit/ir.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cpu {
+
+// A fused CPU kernel that is run by a small interpreter instead of being
+// compiled by a system compiler. The fusion group is translated into a
+// register program once; launching it evaluates the program over blocks of
+// elements, so that every instruction is a tight (vectorized) loop over a
+// block and the interpretation overhead is amortized over the block.
+//
+// The kernel takes the same arguments as the compiled kernels (see
+// FusedKernel::launch_raw) and computes in float, or in double if any value
+// of the group is a double or a 64-bit integer.
+//
+// Groups with row-wise ops (see KernelSpec::hasRowwise) are evaluated a row
+// (the last dimension of the map size) at a time instead, the results of
+// the row reductions being broadcast along the row.
+
+#define FORALL_INTERPRETED_OPS(_)  \
+  /* unary */                      \
+  _(Abs)                           \
+  _(Neg)                           \
+  _(Exp)                           \
+  _(Expm1)                         \
+  _(Log)                           \
+  _(Log10)                         \
+  _(Log1p)                         \
+  _(Log2)                          \
+  _(Lgamma)                        \
+  _(Erf)                           \
+  _(Erfc)                          \
+  _(Cos)                           \
+  _(Acos)                          \
+  _(Cosh)                          \
+  _(Sin)                           \
+  _(Asin)                          \
+  _(Sinh)                          \
+  _(Tan)                           \
+  _(Atan)                          \
+  _(Tanh)                          \
+  _(Sqrt)                          \
+  _(Rsqrt)                         \
+  _(Ceil)                          \
+  _(Floor)                         \
+  _(Round)                         \
+  _(Trunc)                         \
+  _(Frac)                          \
+  _(Reciprocal)                    \
+  _(Sigmoid)                       \
+  _(Relu)                          \
+  /* rounding to a value's type */ \
+  _(ToFloat)                       \
+  _(ToIntegral)                    \
+  _(ToBool)                        \
+  /* binary */                     \
+  _(Mul)                           \
+  _(Div)                           \
+  _(Atan2)                         \
+  _(Min)                           \
+  _(Max)                           \
+  _(Pow)                           \
+  _(Fmod)                          \
+  _(Remainder)                     \
+  _(Eq)                            \
+  _(Ne)                            \
+  _(Lt)                            \
+  _(Le)                            \
+  _(Gt)                            \
+  _(Ge)                            \
+  _(ClampMin)                      \
+  _(ClampMax)                      \
+  _(SigmoidBackward)               \
+  _(TanhBackward)                  \
+  /* ternary and more */           \
+  _(Add)                           \
+  _(Sub)                           \
+  _(Lerp)                          \
+  _(Where)                         \
+  _(Threshold)                     \
+  _(Clamp)                         \
+  _(Addcmul)                       \
+  /* row-wise */                   \
+  _(RowSum)                        \
+  _(RowMean)                       \
+  _(Softmax)                       \
+  _(LogSoftmax)                    \
+  _(LayerNorm)
+
+enum class InterpretedOp : uint8_t {
+#define DEFINE_OP(name) name,
+  FORALL_INTERPRETED_OPS(DEFINE_OP)
+#undef DEFINE_OP
+};
+
+struct InterpretedInstruction {
+  InterpretedOp op;
+  int output;
+  std::vector<int> inputs;
+};
+
+// A tensor argument of the kernel and the register it is loaded into or
+// stored from.
+struct InterpretedTensorArg {
+  size_t argument; // index into the arguments passed to launch_raw
+  int reg;
+  at::ScalarType scalar_type;
+  size_t nDim;
+  bool last_is_contiguous;
+};
+
+struct InterpretedProgram {
+  std::vector<InterpretedTensorArg> loads;
+  // (register, index into the arguments) of the scalar (double) inputs
+  std::vector<std::pair<int, size_t>> scalar_loads;
+  std::vector<std::pair<int, double>> constants;
+  std::vector<InterpretedInstruction> instructions;
+  std::vector<InterpretedTensorArg> stores;
+  int num_registers = 0;
+  at::ScalarType compute_type = at::kFloat;
+  // Whether the program is evaluated a row at a time, and the index of the
+  // row size argument if so.
+  bool rowwise = false;
+  size_t row_size_argument = 0;
+  // The normalized_shape of the layer norms, which must match the row size.
+  std::vector<int64_t> normalized_sizes;
+
+  std::string str() const;
+};
+
+// Translates the (shape propagated) fusion group graph into a program, or
+// returns nullopt if some node of the graph cannot be interpreted.
+// The flattened inputs and outputs are those computed by compileKernel.
+TORCH_API c10::optional<InterpretedProgram> interpretFusionGroup(
+    const Graph& graph,
+    const std::vector<std::pair<const Value*, const c10::optional<TensorDesc>>>&
+        flat_inputs,
+    const std::vector<std::pair<const Value*, const TensorDesc>>& flat_outputs);
+
+struct TORCH_API InterpretedKernelCPU
+    : public ::torch::jit::fuser::FusedKernel {
+  InterpretedKernelCPU(
+      std::string name,
+      InterpretedProgram program,
+      std::vector<TensorDesc> input_desc,
+      std::vector<TensorDesc> output_desc,
+      std::vector<PartitionDesc> chunk_desc,
+      std::vector<PartitionDesc> concat_desc,
+      bool has_random);
+
+  at::Backend backend() const override {
+    return at::Backend::CPU;
+  }
+
+  bool takesRowSize() const override {
+    return program_.rowwise;
+  }
+
+  void launch_raw(const uint32_t numel, std::vector<void*>& arguments)
+      const override;
+
+ private:
+  template <typename T>
+  void run(uint32_t numel, void** arguments) const;
+  template <typename T>
+  void runRowwise(uint32_t numel, void** arguments) const;
+
+  const InterpretedProgram program_;
+};
+
+} // namespace cpu
+} // namespace fuser
+} // namespace jit
+} // namespace torch
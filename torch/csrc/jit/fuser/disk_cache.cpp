@@ -0,0 +1,292 @@
+#include <torch/csrc/jit/fuser/disk_cache.h>
+
+#include <c10/util/Exception.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+
+namespace {
+
+const std::string kMagic = "pytorch fusion cache v1";
+const std::string kSuffix = ".bin";
+constexpr int64_t kDefaultMaxMegabytes = 512;
+
+struct DiskCacheConfig {
+  DiskCacheConfig() {
+    const char* dir_env = std::getenv("PYTORCH_FUSION_CACHE_DIR");
+    if (dir_env) {
+      dir = dir_env;
+    }
+    int64_t max_mb = kDefaultMaxMegabytes;
+    const char* size_env = std::getenv("PYTORCH_FUSION_CACHE_SIZE_MB");
+    if (size_env) {
+      max_mb = std::atoll(size_env);
+    }
+    max_bytes = max_mb * 1024 * 1024;
+  }
+
+  std::mutex mutex;
+  std::string dir;
+  int64_t max_bytes;
+};
+
+DiskCacheConfig& getConfig() {
+  static DiskCacheConfig config;
+  return config;
+}
+
+// Returns the directory, or an empty string if the cache is disabled.
+std::string getDir() {
+  auto& config = getConfig();
+  std::lock_guard<std::mutex> guard(config.mutex);
+  return config.dir;
+}
+
+// 64-bit FNV-1a. Collisions are harmless, entries store their full key.
+std::string hashKey(const std::string& key) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+  return hex;
+}
+
+std::string pathFor(const std::string& dir, const std::string& key) {
+  return dir + "/" + hashKey(key) + kSuffix;
+}
+
+int makeDir(const std::string& dir) {
+#ifdef _WIN32
+  return _mkdir(dir.c_str());
+#else
+  return mkdir(dir.c_str(), 0777);
+#endif
+}
+
+// Creates dir and its missing parents.
+void makeDirs(const std::string& dir) {
+  for (size_t pos = dir.find_first_of("/\\", 1); pos != std::string::npos;
+       pos = dir.find_first_of("/\\", pos + 1)) {
+    makeDir(dir.substr(0, pos));
+  }
+  makeDir(dir);
+}
+
+void touch(const std::string& path) {
+#ifdef _WIN32
+  _utime(path.c_str(), nullptr);
+#else
+  utime(path.c_str(), nullptr);
+#endif
+}
+
+struct Entry {
+  std::string path;
+  int64_t size;
+  int64_t mtime;
+};
+
+std::vector<Entry> listEntries(const std::string& dir) {
+  std::vector<Entry> entries;
+  auto add = [&](const std::string& name) {
+    if (name.size() <= kSuffix.size() ||
+        name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) !=
+            0) {
+      return;
+    }
+    const std::string path = dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+      entries.push_back(Entry{path, static_cast<int64_t>(st.st_size),
+                              static_cast<int64_t>(st.st_mtime)});
+    }
+  };
+#ifdef _WIN32
+  struct _finddata_t data;
+  intptr_t handle = _findfirst((dir + "/*" + kSuffix).c_str(), &data);
+  if (handle != -1) {
+    do {
+      add(data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+  }
+#else
+  DIR* d = opendir(dir.c_str());
+  if (d) {
+    while (struct dirent* e = readdir(d)) {
+      add(e->d_name);
+    }
+    closedir(d);
+  }
+#endif
+  return entries;
+}
+
+// Removes the least recently used entries until the cache fits max_bytes.
+void evict(const std::string& dir, int64_t max_bytes) {
+  auto entries = listEntries(dir);
+  int64_t total = 0;
+  for (const auto& e : entries) {
+    total += e.size;
+  }
+  if (total <= max_bytes) {
+    return;
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.mtime < b.mtime;
+  });
+  for (const auto& e : entries) {
+    if (total <= max_bytes) {
+      break;
+    }
+    if (std::remove(e.path.c_str()) == 0) {
+      total -= e.size;
+    }
+  }
+}
+
+int processId() {
+#ifdef _WIN32
+  return _getpid();
+#else
+  return getpid();
+#endif
+}
+
+} // namespace
+
+bool kernelDiskCacheEnabled() {
+  return !getDir().empty();
+}
+
+void overrideKernelDiskCache(std::string dir, int64_t max_bytes) {
+  auto& config = getConfig();
+  std::lock_guard<std::mutex> guard(config.mutex);
+  config.dir = std::move(dir);
+  config.max_bytes = max_bytes;
+}
+
+std::string kernelDiskCacheKey(
+    const std::string& backend,
+    const std::string& code,
+    const std::string& kernel_name) {
+  std::string normalized_code;
+  size_t begin = 0;
+  for (size_t pos = code.find(kernel_name); pos != std::string::npos;
+       pos = code.find(kernel_name, begin)) {
+    normalized_code.append(code, begin, pos - begin);
+    normalized_code.append("${kernel_name}");
+    begin = pos + kernel_name.size();
+  }
+  normalized_code.append(code, begin, std::string::npos);
+  return backend + "\n" + normalized_code;
+}
+
+c10::optional<CachedKernelBinary> loadCachedKernelBinary(
+    const std::string& key) {
+  const std::string dir = getDir();
+  if (dir.empty()) {
+    return c10::nullopt;
+  }
+  const std::string path = pathFor(dir, key);
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return c10::nullopt;
+  }
+  std::string magic;
+  CachedKernelBinary result;
+  size_t key_size = 0;
+  if (!std::getline(in, magic) || magic != kMagic ||
+      !std::getline(in, result.kernel_name) || !(in >> key_size) ||
+      in.get() != '\n') {
+    return c10::nullopt;
+  }
+  std::string stored_key(key_size, '\0');
+  if (!in.read(&stored_key[0], key_size) || stored_key != key) {
+    return c10::nullopt;
+  }
+  result.binary.assign(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (in.bad()) {
+    return c10::nullopt;
+  }
+  // Marks the entry as recently used for eviction
+  touch(path);
+  return result;
+}
+
+void storeCachedKernelBinary(
+    const std::string& key,
+    const CachedKernelBinary& binary) {
+  std::string dir;
+  int64_t max_bytes;
+  {
+    auto& config = getConfig();
+    std::lock_guard<std::mutex> guard(config.mutex);
+    dir = config.dir;
+    max_bytes = config.max_bytes;
+  }
+  if (dir.empty()) {
+    return;
+  }
+  makeDirs(dir);
+
+  // Writes to a file of our own and renames it, so that concurrent readers
+  // never see a partially written entry.
+  static std::atomic<int64_t> counter{0};
+  const std::string path = pathFor(dir, key);
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp" << processId() << "_" << counter++;
+  {
+    std::ofstream out(tmp_path.str(), std::ios::binary);
+    out << kMagic << "\n"
+        << binary.kernel_name << "\n"
+        << key.size() << "\n"
+        << key << binary.binary;
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.str().c_str());
+      return;
+    }
+  }
+#ifdef _WIN32
+  // rename does not replace existing files on Windows
+  std::remove(path.c_str());
+#endif
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.str().c_str());
+    return;
+  }
+  evict(dir, max_bytes);
+}
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+#include <string>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+
+// A persistent, content-addressed cache of compiled kernel binaries (shared
+// objects, PTX) that outlives the process, complementing the in-memory
+// kernel cache of KernelSpec. It is shared by all processes using the same
+// directory.
+//
+// The cache is enabled by setting PYTORCH_FUSION_CACHE_DIR to a directory
+// (created if necessary). Its size is bounded by PYTORCH_FUSION_CACHE_SIZE_MB
+// (default 512); the least recently used binaries are evicted first.
+//
+// Binaries are looked up by a key that must identify everything they depend
+// on, i.e. the generated code (which is determined by the KernelSpec graph
+// and the ArgSpec), the device architecture and the compiler, its version
+// and flags. The cache is best effort: failing to read or write it never
+// fails a compilation.
+
+// Returns true if the cache is enabled.
+TORCH_API bool kernelDiskCacheEnabled();
+
+// Overrides the directory and the size limit (in bytes) read from the
+// environment. An empty directory disables the cache.
+TORCH_API void overrideKernelDiskCache(std::string dir, int64_t max_bytes);
+
+// Returns the key of the kernel `kernel_name` compiled from `code` by a
+// backend described by `backend` (compiler, version, flags, architecture).
+// Kernel names are numbered per process, so the key does not depend on the
+// name; a cached binary keeps the name it was compiled with instead.
+TORCH_API std::string kernelDiskCacheKey(
+    const std::string& backend,
+    const std::string& code,
+    const std::string& kernel_name);
+
+struct CachedKernelBinary {
+  std::string kernel_name;
+  std::string binary;
+};
+
+// Returns the binary stored for key, if any.
+TORCH_API c10::optional<CachedKernelBinary> loadCachedKernelBinary(
+    const std::string& key);
+
+// Stores the binary for key and evicts old binaries if the cache grew past
+// its size limit.
+TORCH_API void storeCachedKernelBinary(
+    const std::string& key,
+    const CachedKernelBinary& binary);
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
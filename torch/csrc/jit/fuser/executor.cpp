@@ -313,6 +313,11 @@ void launchFusion(
       }
     }
   }
+  // Adds the row size
+  int64_t row_size = map_size.empty() ? 1 : map_size.back();
+  if (fusion.takesRowSize()) {
+    arguments.push_back(&row_size);
+  }
   // Skip launching the kernel for zero-element tensor inputs
   // launches are skipped, empty zero-sized output is returned
   if (numel > 0) {
@@ -382,6 +387,9 @@ bool runFusion(const int64_t key, Stack& stack, std::string* code_out) {
   }
   maybe_kernel = spec.findKernel(arg_spec);
   AT_ASSERT(maybe_kernel);
+  if (!*maybe_kernel) {
+    return false;
+  }
 
   if (code_out) {
     *code_out = maybe_kernel.value()->code();
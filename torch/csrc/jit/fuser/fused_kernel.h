@@ -47,6 +47,12 @@ struct FusedKernel {
   virtual void launch_raw(const uint32_t numel, std::vector<void*>& arguments)
       const = 0;
   virtual at::Backend backend() const = 0;
+  // Row-wise kernels (see KernelSpec::hasRowwise) additionally take a pointer
+  // to the size of the last dimension of the map size as an int64_t, after
+  // the outputs.
+  virtual bool takesRowSize() const {
+    return false;
+  }
 
   // Getters
   const std::string& name() const {
@@ -5,6 +5,7 @@
 #include <torch/csrc/jit/fuser/fallback.h>
 #include <torch/csrc/jit/fuser/kernel_cache.h>
 
+#include <cstdlib>
 #include <stdexcept>
 
 namespace torch {
@@ -15,6 +16,11 @@ namespace detail {
 // Note: CPU fusion is currently disabled due to test flakiness
 bool cpu_fuser_enabled = false;
 
+bool cpu_fuser_use_compiler = []() {
+  const char* cxx_env = getenv("PYTORCH_FUSION_CPU_CXX");
+  return cxx_env && atoi(cxx_env) != 0;
+}();
+
 } // namespace detail
 
 int64_t registerFusion(const Node* fusion_group) {
@@ -40,6 +46,14 @@ void overrideCanFuseOnCPU(bool value) {
   detail::cpu_fuser_enabled = value;
 }
 
+bool fuseOnCPUWithCompiler() {
+  return detail::cpu_fuser_use_compiler;
+}
+
+void overrideFuseOnCPUWithCompiler(bool value) {
+  detail::cpu_fuser_use_compiler = value;
+}
+
 // Uses the above interface by stuffing the graph into a node and treating that
 // node as a fusion group.
 std::vector<at::Tensor> debugLaunchGraph(
@@ -32,6 +32,12 @@ TORCH_API bool canFuseOnGPU();
 // flakiness)
 TORCH_API void overrideCanFuseOnCPU(bool value);
 
+// Sets whether fused CPU kernels are compiled with the system compiler
+// instead of being interpreted. Defaults to the interpreter, unless
+// PYTORCH_FUSION_CPU_CXX=1 is set. Only affects kernels compiled afterwards.
+TORCH_API bool fuseOnCPUWithCompiler();
+TORCH_API void overrideFuseOnCPUWithCompiler(bool value);
+
 // Treats the given graph as a fusion group and launches it on the
 // specified device with the given inputs.
 // Returns the outputs.
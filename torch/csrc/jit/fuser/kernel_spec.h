@@ -65,11 +65,13 @@ struct TORCH_API KernelSpec {
         inputBroadcastGroups_{},
         inputChunks_{},
         has_random_{false},
+        has_rowwise_{false},
         kernels_{} {
     for (const auto& n : graph_->nodes()) {
       if (n->kind() == aten::rand_like) {
         has_random_ = true;
-        break;
+      } else if (isRowwiseKind(n->kind())) {
+        has_rowwise_ = true;
       }
     }
     nTensorInputs_ = std::count_if(
@@ -113,6 +115,17 @@ struct TORCH_API KernelSpec {
     return has_random_;
   }
 
+  // Whether the graph contains row-wise reductions or normalizations (over
+  // the last dimension of the map size), which only the interpreted CPU
+  // kernels implement.
+  bool hasRowwise() const {
+    return has_rowwise_;
+  }
+  static bool isRowwiseKind(NodeKind kind) {
+    return kind == aten::sum || kind == aten::mean || kind == aten::softmax ||
+        kind == aten::log_softmax || kind == aten::layer_norm;
+  }
+
   // Cache functions
   c10::optional<std::shared_ptr<FusedKernel>> findKernel(
       const ArgSpec& arg_spec) const {
@@ -137,6 +150,7 @@ struct TORCH_API KernelSpec {
   std::vector<std::vector<int64_t>> inputBroadcastGroups_;
   std::vector<PartitionInfo> inputChunks_;
   bool has_random_;
+  bool has_rowwise_;
   mutable std::mutex mutex_;
   mutable std::
       unordered_map<ArgSpec, std::shared_ptr<FusedKernel>, torch::hash<ArgSpec>>
@@ -12,6 +12,7 @@
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/pass_manager.h>
 #include <torch/csrc/jit/passes/batch_mm.h>
+#include <torch/csrc/jit/passes/batch_per_example_loops.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
 #include <torch/csrc/jit/passes/constant_pooling.h>
@@ -19,10 +20,12 @@
 #include <torch/csrc/jit/passes/create_autodiff_subgraphs.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/decompose_ops.h>
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/inline_autodiff_subgraphs.h>
 #include <torch/csrc/jit/passes/inliner.h>
 #include <torch/csrc/jit/passes/inplace_check.h>
+#include <torch/csrc/jit/passes/loop_invariant_code_motion.h>
 #include <torch/csrc/jit/passes/loop_unrolling.h>
 #include <torch/csrc/jit/passes/lower_grad_of.h>
 #include <torch/csrc/jit/passes/lower_tuples.h>
@@ -72,6 +75,11 @@ bool getAutodiffSubgraphInlining() {
   return autodiff_subgraph_inlining;
 }
 
+static std::atomic<bool> fork_independent_branches{false};
+std::atomic<bool>& getForkIndependentBranchesMode() {
+  return fork_independent_branches;
+}
+
 thread_local std::weak_ptr<Graph> last_executed_optimized_graph;
 std::shared_ptr<Graph> lastExecutedOptimizedGraph() {
   return last_executed_optimized_graph.lock();
@@ -605,6 +613,9 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
           autodiff_subgraph_inlining ? autodiffSubgraphInlineThreshold : 1);
     } else {
       runNondiffOptimization(opt_graph);
+      if (getForkIndependentBranchesMode()) {
+        ForkIndependentBranches(opt_graph);
+      }
     }
     // Make sure there are no leftovers from any passes.
     EliminateDeadCode(opt_graph);
@@ -652,6 +663,14 @@ GraphExecutorState GraphExecutor::getDebugState() {
   return pImpl->getDebugState();
 }
 
+c10::optional<IValue> GraphExecutor::saveProfile() {
+  return pImpl->saveProfile();
+}
+
+bool GraphExecutor::loadProfile(const IValue& profile) {
+  return pImpl->loadProfile(profile);
+}
+
 void runRequiredPasses(const std::shared_ptr<Graph>& g) {
   // implicit inserted expand nodes are not necessarily always valid
   // when used inside script methods that might have unstable shapes
@@ -746,8 +765,12 @@ void runOptimization(std::shared_ptr<Graph>& graph) {
   ConstantPropagation(graph);
   ConstantPooling(graph);
 
-  // Unroll small loops, and eliminate expressions that are the same at every
-  // iteration.
+  // Move the expressions that are the same at every iteration out of loops,
+  // run loops over the examples of a batch on the whole batch, unroll small
+  // loops, and eliminate expressions that are the same in the unrolled
+  // iterations.
+  HoistLoopInvariants(graph);
+  BatchPerExampleLoops(graph);
   UnrollLoops(graph);
   EliminateCommonSubexpression(graph);
 
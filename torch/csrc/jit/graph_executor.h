@@ -60,6 +60,16 @@ struct TORCH_API GraphExecutor {
   std::shared_ptr<Graph> graph() const;
   GraphExecutorState getDebugState();
 
+  // The profiling information the executor has gathered, if profiling is
+  // done. Loading it into an executor of the same graph, e.g. in another
+  // process, lets that executor skip profiling: its first run already runs
+  // the graph optimized and specialized for the profile. Only the profiling
+  // executor profiles; the others return nullopt and ignore profiles.
+  c10::optional<IValue> saveProfile();
+  // Returns false if the profile was ignored, because it does not match the
+  // graph or the executor already finished profiling.
+  bool loadProfile(const IValue& profile);
+
   static size_t getDefaultNumBailOuts();
 
  private:
@@ -77,6 +87,13 @@ TORCH_API std::atomic<bool> &getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
 TORCH_API std::atomic<size_t>& getNumProfiledRuns();
 TORCH_API std::atomic<size_t>& getBailoutDepth();
+// When set, the profiling executor only records the rank of tensors and not
+// their sizes and strides, so that its guards (and the kernels specialized
+// under them) hold for inputs of any size, e.g. of varying sequence lengths.
+TORCH_API std::atomic<bool>& getProfilingDynamicShapes();
+// When set, the executors run independent branches of graphs that do not
+// require gradients concurrently (see ForkIndependentBranches).
+TORCH_API std::atomic<bool>& getForkIndependentBranchesMode();
 
 struct TORCH_API GraphOptimizerEnabledGuard {
   GraphOptimizerEnabledGuard(bool state)
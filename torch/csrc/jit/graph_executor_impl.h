@@ -66,6 +66,13 @@ struct GraphExecutorImplBase {
       Stack& stack,
       size_t remaining_bailout_depth) = 0;
   virtual GraphExecutorState getDebugState() = 0;
+  // see GraphExecutor::saveProfile and GraphExecutor::loadProfile
+  virtual c10::optional<IValue> saveProfile() {
+    return c10::nullopt;
+  }
+  virtual bool loadProfile(const IValue& profile) {
+    return false;
+  }
   virtual ~GraphExecutorImplBase() = default;
 
  protected:
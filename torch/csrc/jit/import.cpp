@@ -65,28 +65,41 @@ IValue readArchiveAndTensors(
   size_t pickle_size;
   std::tie(pickle_ptr, pickle_size) = stream_reader.getRecord(picklename);
 
-  size_t bytes_read = 0;
-  auto data = reinterpret_cast<const char*>(pickle_ptr.get());
-  auto reader = [&](char* buffer, size_t len) -> size_t {
-    if (bytes_read >= pickle_size) {
-      return 0;
+  // Start reading all the records of the archive (the tensor data) so that
+  // inputs that support concurrent reads fetch them in the background while
+  // the pickle is parsed and the modules are built. Otherwise each record is
+  // read when the unpickler asks for it.
+  std::string archive_name_plus_slash = archive_name + "/";
+  std::vector<std::string> record_names;
+  for (const auto& record : stream_reader.getAllRecords()) {
+    // Drop the leading archive folder, getRecord() adds it back.
+    auto pos = record.find('/');
+    if (pos == std::string::npos) {
+      continue;
     }
-    len = std::min(pickle_size - bytes_read, len);
-    // Copy len bytes into buffer
-    const char* start = data + bytes_read;
-    std::memcpy(buffer, start, len);
-    bytes_read += len;
-    return len;
-  };
+    auto name = record.substr(pos + 1);
+    if (name.compare(0, archive_name_plus_slash.size(), archive_name_plus_slash) == 0) {
+      record_names.push_back(std::move(name));
+    }
+  }
+  auto record_futures = stream_reader.getRecordsAsync(record_names);
+  std::unordered_map<std::string, size_t> record_indices;
+  for (size_t i = 0; i < record_names.size(); i++) {
+    record_indices.emplace(record_names[i], i);
+  }
 
-  std::string archive_name_plus_slash = archive_name + "/";
   auto read_record = [&](const std::string& name) {
     std::string ss = archive_name_plus_slash + name;
+    auto it = record_indices.find(ss);
+    if (it != record_indices.end() && record_futures[it->second].valid()) {
+      return std::get<0>(record_futures[it->second].get());
+    }
     return std::get<0>(stream_reader.getRecord(ss));
   };
 
   Unpickler unpickler(
-      reader,
+      reinterpret_cast<const char*>(pickle_ptr.get()),
+      pickle_size,
       class_resolver ? std::move(*class_resolver) : nullptr,
       obj_loader ? std::move(*obj_loader) : nullptr,
       std::move(read_record),
@@ -124,6 +137,7 @@ class ScriptModuleDeserializer final {
 
  private:
   IValue readArchive(const std::string& archive_name);
+  void loadProfiles(const IValue& profiles);
 
   std::shared_ptr<script::CompilationUnit> compilation_unit_;
   std::unique_ptr<PyTorchStreamReader> reader_;
@@ -205,7 +219,27 @@ script::Module ScriptModuleDeserializer::deserialize(
   for (auto constant : tuple->elements()) {
     constants_table_.push_back(constant.toTensor());
   }
-  return script::Module(readArchive("data").toObject());
+  auto module = script::Module(readArchive("data").toObject());
+  if (reader_->hasRecord("profiles.pkl")) {
+    loadProfiles(readArchive("profiles"));
+  }
+  return module;
+}
+
+void ScriptModuleDeserializer::loadProfiles(const IValue& profiles) {
+  for (const IValue& entry : profiles.toTuple()->elements()) {
+    const auto& elements = entry.toTuple()->elements();
+    auto class_type = compilation_unit_->get_class(
+        c10::QualifiedName(elements.at(0).toStringRef()));
+    if (!class_type) {
+      continue;
+    }
+    if (Function* method =
+            class_type->getMethod(elements.at(1).toStringRef())) {
+      // a profile taken for a different graph is ignored
+      method->get_executor().loadProfile(elements.at(2));
+    }
+  }
 }
 
 } // namespace
@@ -60,6 +60,10 @@ TORCH_API script::Module load(
 /// The reader adapter, which is for customized input stream, must contain a
 /// serialized `script::Module`, exported either via `ScriptModule.save()` in
 /// Python or `torch::jit::ExportModule` in C++.
+///
+/// Pass a `caffe2::serialize::MmapAdapter` to memory-map the file: tensors on
+/// the CPU then point into the (copy-on-write) mapping instead of copies, and
+/// their data is only read from the file when they are first accessed.
 TORCH_API script::Module load(
     std::unique_ptr<caffe2::serialize::ReadAdapterInterface> rai,
     c10::optional<c10::Device> device = c10::nullopt,
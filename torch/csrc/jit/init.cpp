@@ -9,22 +9,29 @@
 #include <torch/csrc/jit/import.h>
 #include <torch/csrc/jit/irparser.h>
 #include <torch/csrc/jit/operator.h>
+#include <torch/csrc/jit/passes/batch_per_example_loops.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
 #include <torch/csrc/jit/passes/constant_pooling.h>
 #include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/convert_to_mkldnn.h>
 #include <torch/csrc/jit/passes/create_autodiff_subgraphs.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/decompose_ops.h>
 #include <torch/csrc/jit/passes/erase_number_types.h>
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
+#include <torch/csrc/jit/passes/fuse_dropout_add_layer_norm.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/inline_fork_wait.h>
 #include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/passes/loop_invariant_code_motion.h>
 #include <torch/csrc/jit/passes/loop_unrolling.h>
 #include <torch/csrc/jit/passes/lower_graph.h>
 #include <torch/csrc/jit/passes/lower_tuples.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
 #include <torch/csrc/jit/passes/onnx.h>
 #include <torch/csrc/jit/passes/onnx/cast_all_constant_to_floating.h>
 #include <torch/csrc/jit/passes/onnx/constant_fold.h>
@@ -42,6 +49,7 @@
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
 #include <torch/csrc/jit/passes/utils/check_alias_annotation.h>
 #include <torch/csrc/jit/print_handler.h>
 #include <torch/csrc/jit/pybind_utils.h>
@@ -197,6 +205,12 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& g) { return QuantFusion(g); })
       .def("_jit_pass_fold_convbn", &FoldConvBatchNorm2d)
       .def("_jit_pass_fuse_linear", &FuseLinear)
+      .def("_jit_pass_fuse_dropout_add_layer_norm", &FuseDropoutAddLayerNorm)
+      .def("_jit_pass_fold_frozen_conv_bn", &FoldFrozenConvBatchNorm)
+      .def("_freeze_module", &freeze_module)
+      .def(
+          "_jit_pass_convert_frozen_ops_to_mkldnn",
+          &ConvertFrozenOpsToMKLDNN)
       .def(
           "_jit_pass_fold_quantize",
           [](script::Module& module, const std::string& method_name) {
@@ -204,6 +218,21 @@ void initJITBindings(PyObject* module) {
           })
       .def("_jit_pass_fold_prepack", &FoldPrepackedWeightIntoModule)
       .def("_jit_pass_dedup_module_uses", &DedupModuleUses)
+      .def(
+          "_jit_pass_propagate_quantized_memory_format",
+          [](std::shared_ptr<Graph>& g) {
+            return PropagateQuantizedMemoryFormat(g);
+          })
+      .def(
+          "_jit_pass_fuse_quantized_lut_chains",
+          [](std::shared_ptr<Graph>& g) { return FuseQuantizedLUTChains(g); })
+      .def(
+          "_jit_pass_quantize_embedding_bag",
+          [](script::Module& module, bool use_4bit) {
+            QuantizeEmbeddingBag(module, use_4bit);
+          },
+          py::arg("module"),
+          py::arg("use_4bit") = false)
       .def(
           "_jit_pass_pattern_based_rewrite",
           [](const script::Module& m) { return PatternBasedRewrite(m); })
@@ -234,6 +263,9 @@ void initJITBindings(PyObject* module) {
           "_jit_pass_remove_inplace_ops",
           [](std::shared_ptr<Graph> g) { return RemoveInplaceOps(g); })
       .def("_jit_pass_constant_pooling", ConstantPooling)
+      .def("_jit_pass_plan_memory", PlanMemory)
+      .def("_jit_pass_elide_concat", ElideConcat)
+      .def("_jit_pass_fork_independent_branches", ForkIndependentBranches)
       .def(
           "_jit_pass_peephole",
           [](const std::shared_ptr<Graph>& g, bool addmm_fusion_enabled) {
@@ -267,6 +299,63 @@ void initJITBindings(PyObject* module) {
             }
             PropagateInputShapes(graph);
           })
+      .def(
+          "_jit_symbolic_shapes",
+          [](const std::shared_ptr<Graph>& graph,
+             const std::vector<c10::optional<
+                 std::vector<c10::optional<int64_t>>>>& input_sizes) {
+            // Sizes of the inputs: None for a tensor of unknown rank, and None
+            // for the dims that are left symbolic
+            auto g = graph->copy();
+            TORCH_CHECK(
+                input_sizes.size() == g->inputs().size(),
+                "expected the sizes of the ",
+                g->inputs().size(),
+                " inputs of the graph, but got ",
+                input_sizes.size());
+            for (size_t i = 0; i < input_sizes.size(); i++) {
+              if (input_sizes[i]) {
+                g->inputs()[i]->setType(TensorType::create(
+                    c10::nullopt,
+                    c10::nullopt,
+                    VaryingShape(*input_sizes[i]),
+                    VaryingShape(input_sizes[i]->size()),
+                    c10::nullopt));
+              }
+            }
+            SymbolicShapes shapes(g);
+            // Maps the names of the values whose rank is known to their
+            // sizes, static dims as ints and symbolic ones as "s<n>"
+            py::dict result;
+            std::function<void(Block*)> visit = [&](Block* block) {
+              std::vector<Value*> values(
+                  block->inputs().begin(), block->inputs().end());
+              for (Node* n : block->nodes()) {
+                values.insert(
+                    values.end(), n->outputs().begin(), n->outputs().end());
+                for (Block* b : n->blocks()) {
+                  visit(b);
+                }
+              }
+              for (Value* v : values) {
+                auto shape = shapes.shapeOf(v);
+                if (!shape) {
+                  continue;
+                }
+                py::list dims;
+                for (int64_t dim : *shape) {
+                  if (SymbolicShapes::isStatic(dim)) {
+                    dims.append(dim);
+                  } else {
+                    dims.append("s" + std::to_string(-dim - 2));
+                  }
+                }
+                result[py::str(v->debugName())] = dims;
+              }
+            };
+            visit(g->block());
+            return result;
+          })
       .def("_jit_pass_remove_expands", RemoveExpands)
       .def("_jit_pass_erase_number_types", EraseNumberTypes)
       .def("_jit_pass_inline_fork_wait", InlineForkWait)
@@ -277,6 +366,8 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& graph, const script::Module& self) {
             return LowerGraph(*graph, self._ivalue());
           })
+      .def("_jit_pass_hoist_loop_invariants", HoistLoopInvariants)
+      .def("_jit_pass_batch_per_example_loops", BatchPerExampleLoops)
       .def("_jit_pass_loop_unrolling", UnrollLoops)
       .def(
           "_jit_pass_constant_propagation",
@@ -321,6 +412,9 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_decompose_ops", DecomposeOps)
       .def("_jit_pass_specialize_autogradzero", specializeAutogradZero)
       .def("_jit_override_can_fuse_on_cpu", &overrideCanFuseOnCPU)
+      .def(
+          "_jit_override_fuse_on_cpu_with_compiler",
+          &overrideFuseOnCPUWithCompiler)
       .def(
           "_jit_differentiate",
           [](Graph& g) {
@@ -366,6 +460,20 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_fork_independent_branches",
+          [](bool enabled) {
+            bool old_value = getForkIndependentBranchesMode();
+            getForkIndependentBranchesMode() = enabled;
+            return old_value;
+          })
+      .def(
+          "_jit_set_profiling_dynamic_shapes",
+          [](bool enabled) {
+            bool old_value = getProfilingDynamicShapes();
+            getProfilingDynamicShapes() = enabled;
+            return old_value;
+          })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { script::getInlineEverythingMode() = enabled; })
@@ -460,6 +568,8 @@ void initJITBindings(PyObject* module) {
       .def(py::init<std::string>())
       .def(py::init([](const py::object &buffer) {
         auto writer_func = [=](const void *data, size_t size) {
+          // Records given by address are written without the GIL
+          pybind11::gil_scoped_acquire gil;
           auto bytes = py::bytes(reinterpret_cast<const char *>(data), size);
           buffer.attr("write")(std::move(bytes));
           return size;
@@ -477,7 +587,8 @@ void initJITBindings(PyObject* module) {
               uintptr_t data, size_t size) {
              return self.writeRecord(name, reinterpret_cast<const char *>(data),
                                      size);
-           });
+           },
+           py::call_guard<py::gil_scoped_release>());
 
   // This allows PyTorchStreamReader to read from a Python buffer. It requires
   // that the buffer implement `seek()`, `tell()`, and `read()`.
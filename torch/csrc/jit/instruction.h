@@ -38,7 +38,12 @@ namespace jit {
   _(TAIL_CALL, "F") /* replace current frame with function F */             \
   _(INTERFACE_CALL, "CI") /* call method X on the first argument (of N) */  \
   _(GET_ATTR, "S") /* get attribute from slot X in an Object */             \
-  _(SET_ATTR, "S") /* set attribute to slot X in an Object */
+  _(SET_ATTR, "S") /* set attribute to slot X in an Object */            \
+  /* superinstructions, emitted by Code for common sequences */             \
+  _(LOADOP, "OR") /* push a value from register N, invoke operator X */     \
+  _(MOVEOP, "OR") /* MOVE from register N, invoke operator X */             \
+  _(LOADCOP, "OC") /* push the constant N, invoke operator X */             \
+  _(OPSTORE, "OR") /* invoke operator X, store its output to register N */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
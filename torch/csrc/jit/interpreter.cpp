@@ -20,6 +20,7 @@
 
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -206,6 +207,30 @@ void insertLastUses(Graph& g) {
 
   InsertLastUses ilu(g);
 }
+
+// Whether the thread runs an InterpreterContinuation, e.g. a forked subgraph
+// or an interpreter that resumed after a wait
+thread_local bool in_continuation = false;
+// Whether the thread is marking the future of the interpreter it runs as a
+// continuation completed. The continuation is done with the thread then, so
+// the interpreters that wait on the future resume on it instead of taking
+// another thread of the inter-op pool.
+thread_local bool completing_continuation = false;
+// The number of resumed continuations nested on the native stack of the thread
+thread_local size_t resume_depth = 0;
+constexpr size_t kMaxResumeDepth = 32;
+
+struct CompletingContinuationGuard {
+  CompletingContinuationGuard() : prev_(completing_continuation) {
+    completing_continuation = in_continuation;
+  }
+  ~CompletingContinuationGuard() {
+    completing_continuation = prev_;
+  }
+
+ private:
+  bool prev_;
+};
 } // namespace
 
 std::ostream& operator<<(std::ostream& out, Instruction inst);
@@ -384,10 +409,18 @@ struct CodeImpl {
   std::vector<std::unique_ptr<Function>> bailout_functions_;
   size_t remaining_bailout_depth_;
 
-  CodeImpl(const std::shared_ptr<Graph>& graph, size_t remaining_bailout_depth)
+  // whether to fuse common instruction sequences into superinstructions
+  // (LOADOP, MOVEOP, LOADCOP, OPSTORE)
+  bool emit_superinstructions_;
+
+  CodeImpl(
+      const std::shared_ptr<Graph>& graph,
+      size_t remaining_bailout_depth,
+      bool emit_superinstructions)
       : preprocess_(*graph),
         current_node_(preprocess_.graph->return_node()),
-        remaining_bailout_depth_(remaining_bailout_depth) {
+        remaining_bailout_depth_(remaining_bailout_depth),
+        emit_superinstructions_(emit_superinstructions) {
     graph_ = preprocess_.graph;
     n_outputs = graph_->outputs().size();
     if (n_outputs == 1) {
@@ -524,6 +557,40 @@ struct CodeImpl {
     emitLoadInputs(node->inputs());
     insertInstruction(OP, operator_table_.size());
     operator_table_.emplace_back(node->getOperation());
+    if (emit_superinstructions_) {
+      fuseLastInputWithOperator();
+    }
+  }
+
+  // Fuses the OP just emitted with the instruction pushing its last input,
+  // if that instruction was emitted for the same node. The fused instruction
+  // replaces the push, so any jump landing on the push still runs both,
+  // while nothing can jump to the OP itself.
+  void fuseLastInputWithOperator() {
+    size_t n = instructions_.size();
+    if (n < 2 || instructions_source_[n - 2] != current_node_) {
+      return;
+    }
+    const Instruction& push = instructions_[n - 2];
+    OpCode fused;
+    switch (push.op) {
+      case LOAD:
+        fused = LOADOP;
+        break;
+      case MOVE:
+        fused = MOVEOP;
+        break;
+      case LOADC:
+        fused = LOADCOP;
+        break;
+      default:
+        return;
+    }
+    if (push.X > std::numeric_limits<uint16_t>::max()) {
+      return;
+    }
+    instructions_[n - 2] = Instruction(fused, instructions_[n - 1].X, push.X);
+    truncateInstructions(n - 1);
   }
 
   void emitWait(Node* node) {
@@ -543,7 +610,17 @@ struct CodeImpl {
       return;
     int regs = allocRegs(node->outputs());
     if (N == 1) {
-      insertInstruction(STORE, regs);
+      // a STORE following the node's own OP is never a jump target, since
+      // the OP is not the end of a nested block
+      if (emit_superinstructions_ && !instructions_.empty() &&
+          instructions_.back().op == OP &&
+          instructions_source_.back() == node &&
+          regs <= std::numeric_limits<uint16_t>::max()) {
+        instructions_.back() =
+            Instruction(OPSTORE, instructions_.back().X, regs);
+      } else {
+        insertInstruction(STORE, regs);
+      }
     } else {
       insertInstruction(STOREN, regs, node->outputs().size());
     }
@@ -757,7 +834,9 @@ struct CodeImpl {
 
   void dump(std::ostream& out, size_t i) const {
     out << i << " " << instructions_[i];
-    if (instructions_[i].op == OP || instructions_[i].op == CALL) {
+    OpCode op = instructions_[i].op;
+    if (op == OP || op == CALL || op == LOADOP || op == MOVEOP ||
+        op == LOADCOP || op == OPSTORE) {
       out << " # " << *instructions_source_[i];
     } else {
       out << "\n";
@@ -922,6 +1001,26 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             stack.emplace_back(af.constants[inst.X]);
             ++af.pc;
             break;
+          case LOADOP:
+            stack.emplace_back(reg(inst.N));
+            af.operators[inst.X](stack);
+            ++af.pc;
+            break;
+          case MOVEOP:
+            stack.emplace_back(std::move(reg(inst.N)));
+            af.operators[inst.X](stack);
+            ++af.pc;
+            break;
+          case LOADCOP:
+            stack.emplace_back(af.constants[inst.N]);
+            af.operators[inst.X](stack);
+            ++af.pc;
+            break;
+          case OPSTORE:
+            af.operators[inst.X](stack);
+            reg(inst.N) = pop(stack);
+            ++af.pc;
+            break;
           case GET_ATTR: {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
@@ -1008,6 +1107,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               break;
             }
             if (future_) {
+              CompletingContinuationGuard guard;
               auto num_outputs = frames.back().function->n_outputs;
               if (num_outputs == 1) {
                 future_->markCompleted(stack.back());
@@ -1028,17 +1128,26 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 Callback(
                     c10::intrusive_ptr<InterpreterStateImpl> state,
                     Stack stack)
-                    : state_(std::move(state)), stack_(std::move(stack)) {}
+                    : state_(std::move(state)),
+                      stack_(std::move(stack)),
+                      grad_mode_enabled_(autograd::GradMode::is_enabled()) {}
                 void operator()() {
-                  at::launch(InterpreterContinuation(
-                      state_,
-                      std::move(stack_),
-                      autograd::GradMode::is_enabled()));
+                  InterpreterContinuation continuation(
+                      state_, std::move(stack_), grad_mode_enabled_);
+                  if (!completing_continuation ||
+                      resume_depth >= kMaxResumeDepth) {
+                    at::launch(std::move(continuation));
+                    return;
+                  }
+                  ++resume_depth;
+                  continuation();
+                  --resume_depth;
                 }
 
                private:
                 InterpreterState state_;
                 Stack stack_;
+                bool grad_mode_enabled_;
               };
 
               // we are suspending, so we need to reset the stack to where we
@@ -1151,6 +1260,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     ss << "Traceback (most recent call last):\n";
     formatStackTrace(ss);
     if (future_) {
+      CompletingContinuationGuard guard;
       future_->markCompleted(Future::FutureError(ss.str()));
     } else if (is_jit_exception) {
       throw JITException(ss.str());
@@ -1197,8 +1307,14 @@ std::ostream& operator<<(std::ostream& out, const Code& code) {
   return out;
 }
 
-Code::Code(const std::shared_ptr<Graph>& graph, size_t remaining_bailout_depth)
-    : pImpl(new CodeImpl(graph, remaining_bailout_depth)) {}
+Code::Code(
+    const std::shared_ptr<Graph>& graph,
+    size_t remaining_bailout_depth,
+    bool emit_superinstructions)
+    : pImpl(new CodeImpl(
+          graph,
+          remaining_bailout_depth,
+          emit_superinstructions)) {}
 Code::~Code() = default;
 
 const std::vector<GraphExecutor*>& Code::grad_executors() {
@@ -1259,7 +1375,13 @@ InterpreterState::InterpreterState(
 
 void InterpreterContinuation::operator()() {
   autograd::AutoGradMode grad_mode(grad_mode_enabled);
+  bool prev_in_continuation = in_continuation;
+  bool prev_completing = completing_continuation;
+  in_continuation = true;
+  completing_continuation = false;
   state.runAsync(stack);
+  in_continuation = prev_in_continuation;
+  completing_continuation = prev_completing;
 }
 } // namespace jit
 } // namespace torch
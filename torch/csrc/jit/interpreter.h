@@ -36,9 +36,14 @@ struct TORCH_API Code {
   // remaining_bailout_depth is irrelevant in a `Code` object unless the `Code`
   // is directly created by `GraphExecutor` in which case it's likely to contain
   // `prim::BailOut`s to control the maximum depth of bailout chains
+  // emit_superinstructions fuses common instruction sequences (pushing the
+  // last input of an operator and calling it, calling an operator and storing
+  // its output) into single instructions, which saves dispatches and stack
+  // traffic. They are not supported by the mobile interpreter.
   explicit Code(
       const std::shared_ptr<Graph>& graph,
-      size_t remaining_bailout_depth = 0);
+      size_t remaining_bailout_depth = 0,
+      bool emit_superinstructions = true);
   ~Code();
 
   const std::vector<GraphExecutor*>& grad_executors();
@@ -98,6 +98,10 @@ std::ostream& operator<<(
 }
 
 static void printAttribute(std::ostream& out, const at::Tensor& tensor) {
+  if (tensor.is_mkldnn()) {
+    printAttribute(out, tensor.to_dense());
+    return;
+  }
   // 1-elem tensors are usually boxed scalars, so print them like it
   if (tensor.numel() == 1) {
     auto scalar_tensor = tensor.view({}).item();
@@ -1047,6 +1051,7 @@ bool Node::hasSideEffects() const {
     case prim::profile:
     case prim::BailOut:
     case prim::Guard:
+    case prim::AllocateStorage:
       return true;
   }
 
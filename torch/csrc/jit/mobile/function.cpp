@@ -4,6 +4,8 @@
 #include <torch/csrc/jit/vararg_functions.h>
 #include <ATen/core/op_registration/op_registration.h>
 
+#include <limits>
+
 namespace torch{
 namespace jit{
 
@@ -77,6 +79,82 @@ void Function::build_vararg_operator_table() {
   }
 }
 
+// The bytecode is saved without superinstructions, so that it only contains
+// the instructions every lite interpreter supports (see export_module.cpp).
+// Like the emitter of the full interpreter, this fuses an OP with the LOAD,
+// MOVE or LOADC pushing its last input, or with the STORE of its output,
+// unless a jump lands between the two. Fusing removes instructions, so the
+// relative jump offsets are recomputed afterwards.
+void Function::emit_superinstructions() {
+#if !defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
+  const auto& instructions = code_->instructions_;
+  const size_t n = instructions.size();
+  auto is_jump = [](OpCode op) { return op == JF || op == JMP || op == LOOP; };
+  std::vector<bool> is_target(n + 1, false);
+  for (size_t pc = 0; pc < n; ++pc) {
+    if (is_jump(instructions[pc].op)) {
+      const size_t target = pc + instructions[pc].X;
+      TORCH_CHECK(target <= n, "Jump out of the function in ", name());
+      is_target[target] = true;
+    }
+  }
+
+  std::vector<Instruction> fused;
+  fused.reserve(n);
+  std::vector<uint32_t> bytecode_pcs;
+  bytecode_pcs.reserve(n);
+  // The index of every instruction of the bytecode in the fused ones.
+  std::vector<size_t> new_pc(n + 1);
+  const size_t max_operand = std::numeric_limits<uint16_t>::max();
+  for (size_t pc = 0; pc < n; ++pc) {
+    new_pc[pc] = fused.size();
+    const Instruction& inst = instructions[pc];
+    const bool can_fuse = pc + 1 < n && !is_target[pc + 1];
+    if (can_fuse && instructions[pc + 1].op == OP &&
+        static_cast<size_t>(inst.X) <= max_operand) {
+      OpCode fused_op = OP;
+      switch (inst.op) {
+        case LOAD:
+          fused_op = LOADOP;
+          break;
+        case MOVE:
+          fused_op = MOVEOP;
+          break;
+        case LOADC:
+          fused_op = LOADCOP;
+          break;
+        default:
+          break;
+      }
+      if (fused_op != OP) {
+        fused.emplace_back(fused_op, instructions[pc + 1].X, inst.X);
+        bytecode_pcs.push_back(pc + 1);
+        new_pc[++pc] = fused.size() - 1;
+        continue;
+      }
+    }
+    if (can_fuse && inst.op == OP && instructions[pc + 1].op == STORE &&
+        static_cast<size_t>(instructions[pc + 1].X) <= max_operand) {
+      fused.emplace_back(OPSTORE, inst.X, instructions[pc + 1].X);
+      bytecode_pcs.push_back(pc);
+      new_pc[++pc] = fused.size() - 1;
+      continue;
+    }
+    fused.push_back(inst);
+    bytecode_pcs.push_back(pc);
+  }
+  new_pc[n] = fused.size();
+
+  for (size_t pc = 0; pc < n; ++pc) {
+    if (is_jump(instructions[pc].op)) {
+      fused[new_pc[pc]].X = new_pc[pc + instructions[pc].X] - new_pc[pc];
+    }
+  }
+  code_->instructions_ = std::move(fused);
+  code_->bytecode_pcs_ = std::move(bytecode_pcs);
+#endif
+}
+
 void Function::append_constant(const c10::IValue& constant) {
   code_->constants_.push_back(constant);
 }
@@ -85,7 +163,27 @@ void Function::set_register_size(size_t size) {
   code_->register_size_ = size;
 }
 
+void Function::set_loader(std::function<void()> loader) {
+  loader_ = std::move(loader);
+}
+
+void Function::ensure_loaded() const {
+  std::call_once(loaded_, [this] {
+    if (!loader_) {
+      return;
+    }
+    try {
+      loader_();
+    } catch (...) {
+      // The next run tries again, from scratch.
+      *code_ = Code();
+      throw;
+    }
+  });
+}
+
 bool Function::run(Stack& stack) const {
+  ensure_loaded();
   InterpreterState interp_state(code_);
   return interp_state.run(stack);
 }
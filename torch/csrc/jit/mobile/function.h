@@ -1,6 +1,8 @@
 #pragma once
 #include <ATen/core/ivalue.h>
 //#include <aten/src/Aten/core/operator_name.h>
+#include <functional>
+#include <mutex>
 #include <vector>
 
 namespace torch{
@@ -23,12 +25,23 @@ class Function{
   void append_vararg_operator(const std::string& name,
                               const std::string& overload_name);
   void build_vararg_operator_table();
+  // Fuses the common instruction sequences of the bytecode into the
+  // superinstructions of the interpreter, once all instructions are appended.
+  void emit_superinstructions();
   void append_constant(const c10::IValue& constant);
   void set_register_size(size_t size);
+  // Defers appending the instructions, operators and constants to the first
+  // run of the function, which calls `loader`. Methods that are never run
+  // are never parsed, and their operators never looked up.
+  void set_loader(std::function<void()> loader);
 
  private:
+  void ensure_loaded() const;
+
   c10::QualifiedName name_;
   std::shared_ptr<Code> code_;
+  std::function<void()> loader_;
+  mutable std::once_flag loaded_;
 };
 
 } // namespace mobile
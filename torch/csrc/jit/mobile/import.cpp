@@ -3,6 +3,7 @@
 #include <torch/csrc/jit/script/compilation_unit.h>
 #include <torch/csrc/jit/unpickler.h>
 #include <caffe2/serialize/inline_container.h>
+#include <caffe2/serialize/mmap_adapter.h>
 #include <torch/csrc/jit/instruction.h>
 
 
@@ -40,63 +41,76 @@ using caffe2::serialize::ReadAdapterInterface;
 
 OpCode parseOpCode(const char *str);
 namespace {
+void parseMethod(const IValue& method, mobile::Function* function) {
+  auto comps = method.toTuple()->elements();
+
+  // The sequence of the named tuple is 0: instructions, 1: operators,
+  // 2: constants, 3: register_size
+  auto named_ins = comps[0].toTuple()->elements();
+  auto ins_name = named_ins[0].toString()->string();
+  TORCH_CHECK(ins_name == "instructions",
+              "instruction is expected, but get", ins_name);
+  auto ins_list = named_ins[1].toTuple()->elements();
+
+  auto named_ops = comps[1].toTuple()->elements();
+  auto ops_name = named_ops[0].toString()->string();
+  TORCH_CHECK(ops_name == "operators",
+              "operator is expected, but get", ops_name);
+  auto ops_list = named_ops[1].toTuple()->elements();
+
+  for (const auto& ins : ins_list) {
+    auto ins_item = ins.toTuple()->elements();
+    TORCH_CHECK(ins_item.size() == 3,
+                "There should be three parts in an instruction.");
+    OpCode op_code = parseOpCode(ins_item[0].toString()->string().c_str());
+    int X = ins_item[1].toInt();
+    int N = ins_item[2].toInt();
+    function->append_instruction(op_code, X, N);
+  }
+
+  for (const auto& op : ops_list) {
+    auto op_item = op.toTuple()->elements();
+    TORCH_CHECK(op_item.size() == 2,
+                "There should be two parts in an operator name.");
+    function->append_operator(op_item[0].toString()->string(),
+                         op_item[1].toString()->string());
+  }
+
+  // vararg operators are stored in a separate table.
+  function->build_vararg_operator_table();
+  function->emit_superinstructions();
+
+  auto named_consts = comps[2].toTuple()->elements();
+  auto consts_name = named_consts[0].toString()->string();
+  TORCH_CHECK(consts_name == "constants",
+              "constant is expected, but get", consts_name);
+  auto consts_list = named_consts[1].toTuple()->elements();
+  for (const auto& constant : consts_list) {
+    function->append_constant(constant);
+  }
+
+  auto named_agg_size = comps[3].toTuple()->elements();
+  auto size_name = named_agg_size[0].toString()->string();
+  TORCH_CHECK(size_name == "register_size",
+              "register_size is expected, but get", ops_name);
+  function->set_register_size(named_agg_size[1].toInt());
+}
+
+// The methods are only parsed when they are first run: the tables of a method
+// stay in the unpickled tuple until then. Apps usually run a few methods of a
+// module, and on a cold start looking up the operators of all of them takes
+// a large part of the load time.
 void parseMethods(const std::vector<IValue>& vals, std::shared_ptr<mobile::CompilationUnit> mcu) {
   for (const auto& element : vals) {
     const auto& m_tuple = element.toTuple()->elements();
 
     auto function = std::unique_ptr<mobile::Function>(new mobile::Function(
         c10::QualifiedName(m_tuple[0].toString()->string())));
-    auto comps = m_tuple[1].toTuple()->elements();
-
-    // The sequence of the named tuple is 0: instructions, 1: operators,
-    // 2: constants, 3: register_size
-    auto named_ins = comps[0].toTuple()->elements();
-    auto ins_name = named_ins[0].toString()->string();
-    TORCH_CHECK(ins_name == "instructions",
-                "instruction is expected, but get", ins_name);
-    auto ins_list = named_ins[1].toTuple()->elements();
-
-    auto named_ops = comps[1].toTuple()->elements();
-    auto ops_name = named_ops[0].toString()->string();
-    TORCH_CHECK(ops_name == "operators",
-                "operator is expected, but get", ops_name);
-    auto ops_list = named_ops[1].toTuple()->elements();
-
-    for (const auto& ins : ins_list) {
-      auto ins_item = ins.toTuple()->elements();
-      TORCH_CHECK(ins_item.size() == 3,
-                  "There should be three parts in an instruction.");
-      OpCode op_code = parseOpCode(ins_item[0].toString()->string().c_str());
-      int X = ins_item[1].toInt();
-      int N = ins_item[2].toInt();
-      function->append_instruction(op_code, X, N);
-    }
-
-    for (const auto& op : ops_list) {
-      auto op_item = op.toTuple()->elements();
-      TORCH_CHECK(op_item.size() == 2,
-                  "There should be two parts in an operator name.");
-      function->append_operator(op_item[0].toString()->string(),
-                           op_item[1].toString()->string());
-    }
-
-    // vararg operators are stored in a separate table.
-    function->build_vararg_operator_table();
-
-    auto named_consts = comps[2].toTuple()->elements();
-    auto consts_name = named_consts[0].toString()->string();
-    TORCH_CHECK(consts_name == "constants",
-                "constant is expected, but get", consts_name);
-    auto consts_list = named_consts[1].toTuple()->elements();
-    for (const auto& constant : consts_list) {
-      function->append_constant(constant);
-    }
-
-    auto named_agg_size = comps[3].toTuple()->elements();
-    auto size_name = named_agg_size[0].toString()->string();
-    TORCH_CHECK(size_name == "register_size",
-                "register_size is expected, but get", ops_name);
-    function->set_register_size(named_agg_size[1].toInt());
+    auto* function_ptr = function.get();
+    IValue method = m_tuple[1];
+    function->set_loader([function_ptr, method] {
+      parseMethod(method, function_ptr);
+    });
 
     mcu->register_function(std::move(function));
   }
@@ -135,20 +149,6 @@ c10::IValue BytecodeDeserializer::readArchive(const std::string& archive_name) {
   size_t pickle_size;
   std::tie(pickle_ptr, pickle_size) = reader_->getRecord(picklename.str());
 
-  size_t bytes_read = 0;
-  auto data = reinterpret_cast<const char*>(pickle_ptr.get());
-  auto reader = [&](char* buffer, size_t len) -> size_t {
-    if (bytes_read >= pickle_size) {
-      return 0;
-    }
-    len = std::min(pickle_size - bytes_read, len);
-    // Copy len bytes into buffer
-    const char* start = data + bytes_read;
-    std::memcpy(buffer, start, len);
-    bytes_read += len;
-    return len;
-  };
-
   auto class_resolver = [&](const c10::QualifiedName& qn) {
     if (compilation_unit_->get_class(qn) == nullptr) {
       auto typeptr = ClassType::create(qn, compilation_unit_, true);
@@ -176,7 +176,8 @@ c10::IValue BytecodeDeserializer::readArchive(const std::string& archive_name) {
     return std::get<0>(reader_->getRecord(ss.str()));
   };
 
-  Unpickler unpickler(reader, std::move(class_resolver),
+  Unpickler unpickler(reinterpret_cast<const char*>(pickle_ptr.get()),
+                      pickle_size, std::move(class_resolver),
                       std::move(obj_loader), std::move(read_record), device_);
   return unpickler.parse_ivalue();
 }
@@ -194,7 +195,12 @@ mobile::Module _load_for_mobile(
 
 mobile::Module _load_for_mobile(
     const std::string& filename,
-    c10::optional<at::Device> device) {
+    c10::optional<at::Device> device,
+    bool mmap) {
+  if (mmap) {
+    return _load_for_mobile(
+        std::make_unique<caffe2::serialize::MmapAdapter>(filename), device);
+  }
   std::unique_ptr<FileAdapter> rai = std::make_unique<FileAdapter>(filename);
   auto module = _load_for_mobile(std::move(rai), device);
   return module;
@@ -16,10 +16,19 @@ TORCH_API mobile::Module _load_for_mobile(
     std::istream& in,
     c10::optional<at::Device> device = c10::nullopt);
 
+// Pass `mmap` to memory-map the file, see the overload below.
 TORCH_API mobile::Module _load_for_mobile(
     const std::string& filename,
-    c10::optional<at::Device> device = c10::nullopt);
+    c10::optional<at::Device> device = c10::nullopt,
+    bool mmap = false);
 
+// Loads a module for the lite interpreter. The methods are only parsed, and
+// their operators looked up, when they are first run.
+//
+// With a `caffe2::serialize::MmapAdapter`, the pickles are read straight from
+// the mapping, and tensors on the CPU point into it instead of copies: the
+// weights stay in the page cache, shared with other processes, and are only
+// read from the file when they are first accessed.
 TORCH_API mobile::Module _load_for_mobile(
     std::unique_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device = c10::nullopt);
@@ -1,5 +1,6 @@
 #include "interpreter.h"
 #include <torch/csrc/jit/mobile/function.h>
+#include <torch/csrc/jit/mobile/profiler.h>
 #include <ATen/core/operator_name.h>
 
 #if defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
@@ -27,10 +28,106 @@ void listConstruct(Stack& stack, int num_inputs) {
 }
 }
 
+// Note [Direct-threaded dispatch]
+// With GCC and Clang, every handler jumps straight to the handler of the next
+// instruction through a table of label addresses, instead of going back to
+// the switch. Each handler ends in its own indirect branch, which predicts
+// the common instruction sequences much better on small cores, and the bounds
+// check of the switch is gone. The switch is still there for compilers
+// without labels as values, and to enter the loop.
+#if defined(__GNUC__) || defined(__clang__)
+#define MOBILE_DIRECT_THREADED
+#endif
+
+#define FORALL_MOBILE_OPCODES(_) \
+  _(OP)                          \
+  _(OPN)                         \
+  _(LOAD)                        \
+  _(MOVE)                        \
+  _(STORE)                       \
+  _(STOREN)                      \
+  _(DROP)                        \
+  _(DROPR)                       \
+  _(LOADC)                       \
+  _(GET_ATTR)                    \
+  _(SET_ATTR)                    \
+  _(JF)                          \
+  _(JMP)                         \
+  _(LOOP)                        \
+  _(RET)                         \
+  _(LOADOP)                      \
+  _(MOVEOP)                      \
+  _(LOADCOP)                     \
+  _(OPSTORE)
+
+namespace {
+// The index of the bytecode instruction the profiler reports for pc.
+size_t bytecodePc(const Code& code, size_t pc) {
+  return code.bytecode_pcs_.empty() ? pc : code.bytecode_pcs_[pc];
+}
+} // namespace
+
+#define COUNT_OPCODE(op, _) +1
+constexpr size_t kNumOpCodes = 0 FORALL_OPCODES(COUNT_OPCODE);
+#undef COUNT_OPCODE
+
 bool InterpreterState::run(Stack& stack) {
   size_t pc = 0;
+  const Instruction* instructions = code_->instructions_.data();
+  const auto& operators = code_->operators_;
+  const auto& constants = code_->constants_;
+  auto& dispatcher = c10::Dispatcher::singleton();
+  auto& profiler = MobileProfiler::get();
+  Instruction inst = instructions[0];
+
+#if defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
+#define RECORD_OPERATOR(X)                                            \
+  do {                                                                \
+    if (auto debug_info = at::getThreadLocalDebugInfo()) {            \
+      if (auto* mobile_debug_info =                                   \
+              dynamic_cast<MobileDebugInfo*>(debug_info.get())) {     \
+        mobile_debug_info->setOpIdx(pc);                              \
+      }                                                               \
+    }                                                                 \
+    RECORD_FUNCTION(code_->op_names_[X].name, stack);                 \
+  } while (0)
+#else
+#define RECORD_OPERATOR(X)
+#endif
+
+#define CALL_OPERATOR(X)                                            \
+  {                                                                 \
+    RECORD_OPERATOR(X);                                             \
+    if (C10_UNLIKELY(profiler.enabled())) {                         \
+      MobileProfiler::OpScope scope(                                \
+          profiler, code_->op_names_[X], bytecodePc(*code_, pc));   \
+      dispatcher.callBoxed(*operators[X], &stack);                  \
+    } else {                                                        \
+      dispatcher.callBoxed(*operators[X], &stack);                  \
+    }                                                               \
+  }
+
+#if defined(MOBILE_DIRECT_THREADED)
+  void* dispatch_table[kNumOpCodes];
+  for (auto& target : dispatch_table) {
+    target = &&invalid;
+  }
+#define SET_TARGET(op) dispatch_table[op] = &&target_##op;
+  FORALL_MOBILE_OPCODES(SET_TARGET)
+#undef SET_TARGET
+#define TARGET(op) \
+  target_##op:     \
+  case op
+#define DISPATCH()          \
+  inst = instructions[pc]; \
+  goto* dispatch_table[inst.op]
+#else
+#define TARGET(op) case op
+#define DISPATCH() continue
+#endif
+
   while (true) {
-    Instruction inst = code_->instructions_[pc];
+    inst = instructions[pc];
 
 //    std::cout << "RUNNING " << pc << " " << code_->instructions_[pc];
 //    if (inst.op == OP) {
@@ -46,73 +143,68 @@ bool InterpreterState::run(Stack& stack) {
 //      }
 //    }
     switch (inst.op) {
-      case OP: {
-#if defined(PYTORCH_MOBILE_OPERATOR_OBSERVER)
-        if (auto debug_info = at::getThreadLocalDebugInfo()) {
-          if (auto* mobile_debug_info = dynamic_cast<MobileDebugInfo*>(
-            debug_info.get())) {
-            mobile_debug_info->setOpIdx(pc);
-          }
-        }
-        RECORD_FUNCTION(code_->op_names_[inst.X].name, stack);
-#endif
-
-        c10::Dispatcher::singleton().callBoxed(*code_->operators_[inst.X], &stack);
+      TARGET(OP): {
+        CALL_OPERATOR(inst.X);
         ++pc;
-      } break;
-      case OPN: {
+      }
+      DISPATCH();
+      TARGET(OPN): {
         code_->vararg_operators_[inst.X](inst.N, stack);
         ++pc;
-      } break;
-      case LOAD:
+      }
+      DISPATCH();
+      TARGET(LOAD):
         stack.emplace_back(reg(inst.X));
         ++pc;
-        break;
-      case MOVE:
+        DISPATCH();
+      TARGET(MOVE):
         stack.emplace_back(std::move(reg(inst.X)));
         ++pc;
-        break;
-      case STORE:
+        DISPATCH();
+      TARGET(STORE):
         reg(inst.X) = pop(stack);
         ++pc;
-        break;
-      case STOREN:
+        DISPATCH();
+      TARGET(STOREN):
         for (size_t i = inst.N; i > 0; --i) {
           reg(inst.X + i - 1) = pop(stack);
         }
         ++pc;
-        break;
-      case DROP:
+        DISPATCH();
+      TARGET(DROP):
         pop(stack);
         ++pc;
-        break;
-      case DROPR:
+        DISPATCH();
+      TARGET(DROPR):
         reg(inst.X) = IValue();
         ++pc;
-        break;
-      case LOADC:
-        stack.emplace_back(code_->constants_[inst.X]);
+        DISPATCH();
+      TARGET(LOADC):
+        stack.emplace_back(constants[inst.X]);
         ++pc;
-        break;
-      case GET_ATTR: {
-        auto userObj = pop(stack).toObject();
-        auto value = userObj->getSlot(inst.X);
-        push(stack, std::move(value));
+        DISPATCH();
+      TARGET(GET_ATTR): {
+        // Replace the object with its attribute in place. The assignment
+        // copies the attribute before it releases the object.
+        IValue& top = stack.back();
+        top = top.toObjectRef().getSlot(inst.X);
         ++pc;
-      } break;
-      case SET_ATTR: {
+      }
+      DISPATCH();
+      TARGET(SET_ATTR): {
         auto v = pop(stack);
         auto userObj = pop(stack).toObject();
         userObj->setSlot(inst.X, std::move(v));
         ++pc;
-      } break;
-      case JF:
+      }
+      DISPATCH();
+      TARGET(JF):
         pc += (pop(stack).toBool()) ? 1 : inst.X;
-        break;
-      case JMP:
+        DISPATCH();
+      TARGET(JMP):
         pc += inst.X;
-        break;
-      case LOOP: {
+        DISPATCH();
+      TARGET(LOOP): {
         // stack: iteration_count, max_iter, cond, loop_carried_deps...
         auto frame = stack.end() - (inst.N + 1);
         int64_t trip_count = frame[0].toInt();
@@ -130,13 +222,42 @@ bool InterpreterState::run(Stack& stack) {
           drop(stack, 3); // iteration_count, max_iter, cond
           pc += inst.X;
         }
-      } break;
-      case RET:
+      }
+      DISPATCH();
+      TARGET(RET):
         return false;
+      // superinstructions, see Function::emit_superinstructions()
+      TARGET(LOADOP):
+        stack.emplace_back(reg(inst.N));
+        CALL_OPERATOR(inst.X);
+        ++pc;
+        DISPATCH();
+      TARGET(MOVEOP):
+        stack.emplace_back(std::move(reg(inst.N)));
+        CALL_OPERATOR(inst.X);
+        ++pc;
+        DISPATCH();
+      TARGET(LOADCOP):
+        stack.emplace_back(constants[inst.N]);
+        CALL_OPERATOR(inst.X);
+        ++pc;
+        DISPATCH();
+      TARGET(OPSTORE):
+        CALL_OPERATOR(inst.X);
+        reg(inst.N) = pop(stack);
+        ++pc;
+        DISPATCH();
       default:
+#if defined(MOBILE_DIRECT_THREADED)
+      invalid:
+#endif
         AT_ERROR(toString(inst.op), " is invalid.");
     }
   }
+#undef TARGET
+#undef DISPATCH
+#undef CALL_OPERATOR
+#undef RECORD_OPERATOR
   return false;
 }
 
@@ -16,6 +16,10 @@ struct Code {
   std::vector<VarargFuncton> vararg_operators_;
   std::vector<c10::IValue> constants_;
   size_t register_size_; // Aggregated output size.
+  // For every instruction, the index of the instruction of the bytecode that
+  // calls its operator, or that it is. Empty if the bytecode wasn't fused
+  // into superinstructions.
+  std::vector<uint32_t> bytecode_pcs_;
 };
 
 struct InterpreterState {
@@ -0,0 +1,159 @@
+#include <torch/csrc/jit/mobile/profiler.h>
+
+#include <ATen/ThreadLocalDebugInfo.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/jit/mobile/observer.h>
+
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+template <typename T>
+void writeLittleEndian(std::ostream& out, T value) {
+  char bytes[sizeof(T)];
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    bytes[i] =
+        static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+  }
+  out.write(bytes, sizeof(T));
+}
+
+} // namespace
+
+constexpr size_t MobileProfiler::kDefaultCapacity;
+
+MobileProfiler& MobileProfiler::get() {
+  static MobileProfiler profiler;
+  return profiler;
+}
+
+void MobileProfiler::enable(size_t capacity) {
+  TORCH_CHECK(capacity > 0, "The mobile profiler needs a capacity");
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_ = std::chrono::steady_clock::now();
+  ring_.clear();
+  ring_.reserve(capacity);
+  capacity_ = capacity;
+  next_ = 0;
+  recorded_ = 0;
+  names_.clear();
+  name_ids_.clear();
+  intern("");
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void MobileProfiler::disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+std::vector<ProfiledOp> MobileProfiler::records() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return orderedRecords();
+}
+
+std::vector<ProfiledOp> MobileProfiler::orderedRecords() const {
+  if (ring_.size() < capacity_) {
+    return ring_;
+  }
+  std::vector<ProfiledOp> records(ring_.begin() + next_, ring_.end());
+  records.insert(records.end(), ring_.begin(), ring_.begin() + next_);
+  return records;
+}
+
+std::vector<std::string> MobileProfiler::names() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return names_;
+}
+
+uint64_t MobileProfiler::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return recorded_ - ring_.size();
+}
+
+void MobileProfiler::save(std::ostream& out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto records = orderedRecords();
+  out.write("PTMP", 4);
+  writeLittleEndian<uint32_t>(out, 1);
+  writeLittleEndian<uint32_t>(out, names_.size());
+  for (const auto& name : names_) {
+    writeLittleEndian<uint32_t>(out, name.size());
+    out.write(name.data(), name.size());
+  }
+  writeLittleEndian<uint64_t>(out, recorded_ - ring_.size());
+  writeLittleEndian<uint32_t>(out, records.size());
+  for (const auto& record : records) {
+    writeLittleEndian<int64_t>(out, record.start_ns);
+    writeLittleEndian<int64_t>(out, record.duration_ns);
+    writeLittleEndian<int64_t>(out, record.allocations);
+    writeLittleEndian<int64_t>(out, record.allocated_bytes);
+    writeLittleEndian<uint32_t>(out, record.op_name);
+    writeLittleEndian<uint32_t>(out, record.model_name);
+    writeLittleEndian<uint32_t>(out, record.method_name);
+    writeLittleEndian<uint32_t>(out, record.pc);
+  }
+}
+
+uint32_t MobileProfiler::intern(const std::string& name) {
+  auto it = name_ids_.find(name);
+  if (it != name_ids_.end()) {
+    return it->second;
+  }
+  const uint32_t id = names_.size();
+  names_.push_back(name);
+  name_ids_.emplace(name, id);
+  return id;
+}
+
+MobileProfiler::OpScope::OpScope(
+    MobileProfiler& profiler,
+    const c10::OperatorName& op,
+    size_t pc)
+    : profiler_(profiler),
+      op_(op),
+      pc_(pc),
+      start_(std::chrono::steady_clock::now()) {}
+
+MobileProfiler::OpScope::~OpScope() {
+  const auto end = std::chrono::steady_clock::now();
+  if (!profiler_.enabled()) {
+    return;
+  }
+  MobileDebugInfo* debug_info = nullptr;
+  const auto thread_debug_info = at::getThreadLocalDebugInfo();
+  if (thread_debug_info) {
+    debug_info = dynamic_cast<MobileDebugInfo*>(thread_debug_info.get());
+  }
+
+  std::lock_guard<std::mutex> lock(profiler_.mutex_);
+  ProfiledOp record;
+  record.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        start_ - profiler_.start_)
+                        .count();
+  record.duration_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_)
+          .count();
+  record.allocations = allocations_.allocations();
+  record.allocated_bytes = allocations_.bytes();
+  record.op_name = op_.overload_name.empty()
+      ? profiler_.intern(op_.name)
+      : profiler_.intern(op_.name + "." + op_.overload_name);
+  record.model_name =
+      debug_info ? profiler_.intern(debug_info->getModelName()) : 0;
+  record.method_name =
+      debug_info ? profiler_.intern(debug_info->getMethodName()) : 0;
+  record.pc = pc_;
+  if (profiler_.ring_.size() < profiler_.capacity_) {
+    profiler_.ring_.push_back(record);
+  } else {
+    profiler_.ring_[profiler_.next_] = record;
+  }
+  profiler_.next_ = (profiler_.next_ + 1) % profiler_.capacity_;
+  profiler_.recorded_++;
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <ATen/core/operator_name.h>
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// One OP instruction run by the lite interpreter. The names are indices into
+// MobileProfiler::names(), so that a record stays small.
+struct ProfiledOp {
+  // Since the profiler was enabled.
+  int64_t start_ns;
+  int64_t duration_ns;
+  // Of the default CPU allocator, see c10::CPUAllocationCounter.
+  int64_t allocations;
+  int64_t allocated_bytes;
+  // "name.overload_name" of the operator.
+  uint32_t op_name;
+  // From the MobileDebugInfo of the thread, or the empty name 0.
+  uint32_t model_name;
+  uint32_t method_name;
+  // The index of the instruction in the method.
+  uint32_t pc;
+};
+
+// An opt-in profiler for the lite interpreter, for builds and devices that
+// can't afford the autograd profiler. While it is enabled, every OP
+// instruction run on any thread is recorded into a ring buffer, which keeps
+// the last `capacity` of them. While it is disabled, the interpreter only
+// checks a flag per operator.
+class TORCH_API MobileProfiler {
+ public:
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  static MobileProfiler& get();
+
+  // Clears the records and starts recording.
+  void enable(size_t capacity = kDefaultCapacity);
+  void disable();
+  bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // The records in the buffer, oldest first.
+  std::vector<ProfiledOp> records() const;
+  std::vector<std::string> names() const;
+  // The number of records that were overwritten.
+  uint64_t dropped() const;
+
+  // Writes the names and the records in a compact binary format, all
+  // integers in little endian:
+  //
+  //   "PTMP", uint32 version (1)
+  //   uint32 number of names, then for each: uint32 size, bytes
+  //   uint64 dropped records
+  //   uint32 number of records, then for each the fields of ProfiledOp
+  //
+  void save(std::ostream& out) const;
+
+  // Records the operator it is created for, meant to be used through the
+  // interpreter only.
+  class TORCH_API OpScope {
+   public:
+    OpScope(MobileProfiler& profiler, const c10::OperatorName& op, size_t pc);
+    ~OpScope();
+
+   private:
+    MobileProfiler& profiler_;
+    const c10::OperatorName& op_;
+    size_t pc_;
+    std::chrono::steady_clock::time_point start_;
+    c10::CPUAllocationCounter allocations_;
+  };
+
+ private:
+  MobileProfiler() = default;
+  // Must be called with mutex_.
+  uint32_t intern(const std::string& name);
+  std::vector<ProfiledOp> orderedRecords() const;
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::chrono::steady_clock::time_point start_;
+  std::vector<ProfiledOp> ring_;
+  size_t capacity_ = 0;
+  // The index the next record is written to.
+  size_t next_ = 0;
+  uint64_t recorded_ = 0;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
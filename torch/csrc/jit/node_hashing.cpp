@@ -16,6 +16,10 @@ namespace jit {
 namespace {
 
 bool tensorEqual(const at::Tensor& lhs, const at::Tensor& rhs) {
+  // MKL-DNN tensors can't be compared element by element
+  if (lhs.is_mkldnn() || rhs.is_mkldnn()) {
+    return lhs.is_same(rhs);
+  }
   return lhs.options().type_equal(rhs.options()) && lhs.equal(rhs);
 }
 
@@ -2,8 +2,10 @@
 #include <torch/csrc/jit/alias_info.h>
 #include <torch/csrc/jit/operator.h>
 #include <torch/csrc/jit/script/edit_distance.h>
+#include <c10/util/InitStats.h>
 
 #include <queue>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -17,9 +19,14 @@ struct OperatorRegistry {
  private:
   std::mutex lock;
   OperatorMap operators;
-  // list of operators whose schema have not yet been parsed, and must
-  // be registered before any call to lookup an operator
+  // list of operators registered since the last lookup, which must be sorted
+  // into pending before any call to lookup an operator
   std::vector<std::shared_ptr<Operator>> to_register;
+  // operators whose schemas have not been parsed yet, by name. Thousands of
+  // operators are registered at startup, and most processes only use a few of
+  // them, so an operator is only parsed and added to operators and
+  // operators_by_sig when an operator of its name is first looked up.
+  OperatorMap pending;
   // Those two maps are used to implement lookupByLiteral, which is needed for
   // the n->match(...) calls. Basically, every function schema is assigned a
   // unique string you can use to match it. However, parsing those strings or
@@ -35,15 +42,48 @@ struct OperatorRegistry {
       operators_by_sig_literal;
 
   // XXX - caller must be holding lock
-  void registerPendingOperators() {
-    for (const auto& op : to_register) {
-      Symbol sym = Symbol::fromQualString(op->schema().name());
-      operators[sym].push_back(op);
-      operators_by_sig[canonicalSchemaString(op->schema())] = op;
+  void sortPendingOperators() {
+    if (to_register.empty()) {
+      return;
+    }
+    c10::InitTimer timer("jit::OperatorRegistry");
+    for (auto& op : to_register) {
+      Symbol sym = Symbol::fromQualString(op->name());
+      pending[sym].push_back(std::move(op));
     }
     to_register.clear();
   }
 
+  // XXX - caller must be holding lock
+  void registerPendingOperators(Symbol name) {
+    sortPendingOperators();
+    auto it = pending.find(name);
+    if (it == pending.end()) {
+      return;
+    }
+    c10::InitTimer timer("jit::OperatorRegistry");
+    auto& ops = operators[name];
+    for (auto& op : it->second) {
+      TORCH_INTERNAL_ASSERT(
+          Symbol::fromQualString(op->schema().name()) == name,
+          "Operator ",
+          op->schema(),
+          " was registered under the wrong name ",
+          name.toQualString());
+      operators_by_sig[canonicalSchemaString(op->schema())] = op;
+      ops.push_back(std::move(op));
+    }
+    pending.erase(it);
+  }
+
+  // XXX - caller must be holding lock
+  void registerAllPendingOperators() {
+    sortPendingOperators();
+    while (!pending.empty()) {
+      registerPendingOperators(pending.begin()->first);
+    }
+  }
+
  public:
   void registerOperator(Operator&& op) {
     std::lock_guard<std::mutex> guard(lock);
@@ -52,11 +92,11 @@ struct OperatorRegistry {
 
   const std::shared_ptr<Operator>& lookupByLiteral(const char* name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
     auto it = operators_by_sig_literal.find(name);
     if (it == operators_by_sig_literal.end()) {
-      auto op_ptr_it =
-          operators_by_sig.find(canonicalSchemaString(parseSchema(name)));
+      FunctionSchema schema = parseSchema(name);
+      registerPendingOperators(Symbol::fromQualString(schema.name()));
+      auto op_ptr_it = operators_by_sig.find(canonicalSchemaString(schema));
       // Handy debugging code that dumps all operators we know about on mismatch
 #if 0
       if (op_ptr_it == operators_by_sig.end()) {
@@ -77,7 +117,7 @@ struct OperatorRegistry {
 
   const std::vector<std::shared_ptr<Operator>>& getOperators(Symbol name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerPendingOperators(name);
     static std::vector<std::shared_ptr<Operator>> empty;
     auto it = operators.find(name);
     if (it != operators.end())
@@ -87,7 +127,7 @@ struct OperatorRegistry {
 
   std::vector<Symbol> findSimilarOperators(Symbol input_op) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    sortPendingOperators();
 
     using EntryPair = std::pair<int64_t, Symbol>;
     auto cmp = [](const EntryPair& lhs, const EntryPair& rhs) {
@@ -97,11 +137,19 @@ struct OperatorRegistry {
     std::priority_queue<EntryPair, std::vector<EntryPair>, decltype(cmp)>
         rankings(cmp);
     static constexpr size_t MAX_EDIT_DIST = 2u;
+    // The names are known without parsing the pending operators
+    std::unordered_set<Symbol> names;
     for (const auto& op : operators) {
+      names.insert(op.first);
+    }
+    for (const auto& op : pending) {
+      names.insert(op.first);
+    }
+    for (Symbol name : names) {
       auto edit_dist = script::ComputeEditDistance(
-          input_op.toQualString(), op.first.toQualString(), MAX_EDIT_DIST);
+          input_op.toQualString(), name.toQualString(), MAX_EDIT_DIST);
       if (edit_dist <= MAX_EDIT_DIST) {
-        rankings.emplace(edit_dist, op.first);
+        rankings.emplace(edit_dist, name);
       }
     }
     std::vector<Symbol> ret;
@@ -114,7 +162,7 @@ struct OperatorRegistry {
 
   const std::vector<std::shared_ptr<Operator>> getAllOperators() {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerAllPendingOperators();
     std::vector<std::shared_ptr<Operator>> values;
     values.clear();
     for (auto & kv : operators) {
@@ -179,6 +227,7 @@ bool printerHasSpecialCaseFor(Symbol sym) {
       prim::Load, // used in interpreter only
       prim::MMTreeReduce, // used as an optimization
       prim::MMBatchSide, // used as an optimization
+      prim::MMBatchGroup, // used as an optimization
       prim::Store, // used in interpreter only
       prim::profile, // used in interpreter only
 
@@ -217,6 +266,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::GradOf,
       prim::MMTreeReduce,
       prim::MMBatchSide,
+      prim::MMBatchGroup,
       prim::BroadcastSizes,
       prim::ChunkSizes,
       prim::Function,
@@ -255,7 +305,9 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
 }
 
 void registerOperator(Operator&& op) {
-  if (op.schema().is_varret()) {
+  // Don't parse schemas given as strings here, they are parsed when the
+  // operator is first looked up
+  if (op.isVarRet()) {
     Symbol s = Symbol::fromQualString(op.schema().name());
     if (!printerHasSpecialCaseFor(s)) {
       AT_ERROR(
@@ -15,6 +15,8 @@
 #include <ATen/core/function_schema.h>
 #include <ATen/core/interned_strings.h>
 
+#include <algorithm>
+#include <cctype>
 #include <functional>
 #include <initializer_list>
 #include <memory>
@@ -143,6 +145,34 @@ struct TORCH_API Operator {
     return *schema_;
   }
 
+  // The qualified name of the operator, e.g. aten::add, without parsing a
+  // schema given as a string
+  std::string name() const {
+    if (!schema_string_) {
+      return schema_->name();
+    }
+    const std::string& schema = *schema_string_;
+    size_t begin = schema.find_first_not_of(" \t\n");
+    if (begin == std::string::npos) {
+      return "";
+    }
+    size_t end = std::min(schema.find('('), schema.find('.', begin));
+    end = std::min(end, schema.size());
+    while (end > begin && isspace(schema[end - 1])) {
+      --end;
+    }
+    return schema.substr(begin, end - begin);
+  }
+
+  // Whether the schema has variadic returns, only parsing a schema given as a
+  // string if it has an ellipsis
+  bool isVarRet() const {
+    if (schema_string_ && schema_string_->find("...") == std::string::npos) {
+      return false;
+    }
+    return schema().is_varret();
+  }
+
   bool isC10Op() const {
     return c10Handle_.has_value();
   }
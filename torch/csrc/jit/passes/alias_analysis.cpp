@@ -332,6 +332,7 @@ void AliasDb::analyzeImpl(Node* node) {
     case prim::FusedConcat:
     case prim::MMTreeReduce:
     case prim::MMBatchSide:
+    case prim::MMBatchGroup:
     case prim::BroadcastSizes:
     case prim::ChunkSizes:
     case prim::Function:
@@ -368,31 +368,47 @@ RegisterOperators mm_batch_side_reg({Operator(
     },
     aliasAnalysisIsSpecialCase())});
 
-std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
-    Value* value,
+std::vector<Node*> filterDependentMMs(
+    std::vector<Node*> mms,
     AliasDb& alias_db) {
-  const auto postprocess = [&](std::vector<Node*> mms) {
-    if (mms.size() == 0) {
-      return mms;
-    }
-    std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
-      return n->isBefore(m);
-    });
-    // Filter out dependent MMs. This algorithm might do very badly if e.g. you
-    // have a lot of independent MMs, that depend on the first one, but I doubt
-    // this will be a common scenario.
-    for (size_t i = 0; i < mms.size(); ++i) {
-      if (mms[i] == nullptr)
+  if (mms.size() == 0) {
+    return mms;
+  }
+  std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
+    return n->isBefore(m);
+  });
+  // Filter out dependent MMs. This algorithm might do very badly if e.g. you
+  // have a lot of independent MMs, that depend on the first one, but I doubt
+  // this will be a common scenario.
+  for (size_t i = 0; i < mms.size(); ++i) {
+    if (mms[i] == nullptr)
+      continue;
+    for (size_t j = i + 1; j < mms.size(); ++j) {
+      if (mms[j] == nullptr)
         continue;
-      for (size_t j = i + 1; j < mms.size(); ++j) {
-        if (mms[j] == nullptr)
-          continue;
-        if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
-          mms[j] = nullptr;
-        }
+      if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
+        mms[j] = nullptr;
       }
     }
-    return c10::filter(mms, [](Node* n) { return n != nullptr; });
+  }
+  return c10::filter(mms, [](Node* n) { return n != nullptr; });
+}
+
+// Moves the (independent) mms next to each other, so that a node computing
+// all of them can be inserted in place of the first one.
+void moveTogether(std::vector<Node*>& mms, AliasDb& alias_db) {
+  AT_ASSERT(!mms.empty());
+  for (int64_t i = static_cast<int64_t>(mms.size()) - 2; i >= 0; --i) {
+    bool move_ok = alias_db.moveBeforeTopologicallyValid(mms[i], mms[i + 1]);
+    AT_ASSERT(move_ok);
+  }
+}
+
+std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
+    Value* value,
+    AliasDb& alias_db) {
+  const auto postprocess = [&](std::vector<Node*> mms) {
+    return filterDependentMMs(std::move(mms), alias_db);
   };
 
   Block* block = value->node()->owningBlock();
@@ -415,11 +431,7 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   // NB: 8 is the current loop unrolling factor
   static constexpr size_t how_many_is_many = 8;
   const auto batch_side = [&](std::vector<Node*>& mms, Side side) {
-    AT_ASSERT(!mms.empty());
-    for (int64_t i = static_cast<int64_t>(mms.size()) - 2; i >= 0; --i) {
-      bool move_ok = alias_db.moveBeforeTopologicallyValid(mms[i], mms[i + 1]);
-      AT_ASSERT(move_ok);
-    }
+    moveTogether(mms, alias_db);
     WithInsertPoint insert_guard{mms[0]};
     Graph* graph = mms[0]->owningGraph();
     Node* batch_mm = graph->create(
@@ -459,6 +471,263 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// Besides the two patterns above, models like attention and multi-head
+// projections compute many independent matmuls of the same shape that neither
+// form a tree nor share an operand with 8 others, e.g.
+//
+//   %q = aten::linear(%x, %w_q, %b_q)
+//   %k = aten::linear(%x, %w_k, %b_k)
+//   %v = aten::linear(%x, %w_v, %b_v)
+//
+// Such groups of aten::matmul, aten::linear or aten::addmm nodes are replaced
+// by a single prim::MMBatchGroup, that computes them with one bmm (stacking
+// the operands of the individual ops) and splits its output again. When all
+// linear/addmm ops of a group share their input, the weights are concatenated
+// instead, and the group becomes a single wider GEMM. Whether the shapes
+// allow to batch the group is checked at runtime; if they do not, the ops are
+// computed one by one.
+
+// Tunable parameter.
+static constexpr size_t min_group_size = 3;
+
+enum class GroupKind { Matmul, Linear, Addmm };
+
+bool all_same_tensor(at::TensorList inputs) {
+  return std::all_of(inputs.begin(), inputs.end(), [&](const at::Tensor& t) {
+    return t.is_same(inputs[0]);
+  });
+}
+
+std::vector<at::Tensor> batch_matmuls(at::TensorList lhs, at::TensorList rhs) {
+  // With operands of the same rank, the batch dimensions of the individual
+  // matmuls line up, so one more leading dimension batches all of them.
+  if (have_same_shape(lhs) && have_same_shape(rhs) && lhs[0].dim() >= 2 &&
+      lhs[0].dim() == rhs[0].dim()) {
+    return at::matmul(at::stack(lhs), at::stack(rhs)).unbind(0);
+  }
+  std::vector<at::Tensor> outputs;
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    outputs.push_back(at::matmul(lhs[i], rhs[i]));
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> batch_linears(
+    at::TensorList inputs,
+    at::TensorList weights,
+    at::TensorList biases) {
+  int64_t num_mms = inputs.size();
+  bool has_bias = biases[0].defined();
+  if (have_same_shape(inputs) && have_same_shape(weights) &&
+      inputs[0].dim() >= 1 && inputs[0].numel() > 0 && weights[0].dim() == 2 &&
+      inputs[0].size(-1) == weights[0].size(1) &&
+      (!has_bias || (have_same_shape(biases) && biases[0].dim() == 1))) {
+    if (all_same_tensor(inputs)) {
+      auto output = at::linear(
+          inputs[0],
+          at::cat(weights, /*dim=*/0),
+          has_bias ? at::cat(biases, /*dim=*/0) : at::Tensor());
+      return at::chunk(output, num_mms, /*dim=*/-1);
+    }
+    auto input = at::stack(inputs).reshape({num_mms, -1, weights[0].size(1)});
+    auto weight = at::stack(weights).transpose(1, 2);
+    auto output = has_bias
+        ? at::baddbmm(at::stack(biases).unsqueeze(1), input, weight)
+        : at::bmm(input, weight);
+    auto output_sizes = inputs[0].sizes().vec();
+    output_sizes.back() = weights[0].size(0);
+    output_sizes.insert(output_sizes.begin(), num_mms);
+    return output.view(output_sizes).unbind(0);
+  }
+  std::vector<at::Tensor> outputs;
+  for (int64_t i = 0; i < num_mms; ++i) {
+    outputs.push_back(at::linear(inputs[i], weights[i], biases[i]));
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> batch_addmms(
+    at::TensorList selves,
+    at::TensorList mat1s,
+    at::TensorList mat2s,
+    at::Scalar beta,
+    at::Scalar alpha) {
+  int64_t num_mms = selves.size();
+  if (have_same_shape(selves) && have_same_shape(mat1s) &&
+      have_same_shape(mat2s) && mat1s[0].dim() == 2 && mat2s[0].dim() == 2 &&
+      selves[0].dim() <= 2) {
+    if (all_same_tensor(mat1s) && selves[0].dim() == 1 &&
+        selves[0].size(0) == mat2s[0].size(1)) {
+      auto output = at::addmm(
+          at::cat(selves, /*dim=*/0),
+          mat1s[0],
+          at::cat(mat2s, /*dim=*/1),
+          beta,
+          alpha);
+      return at::chunk(output, num_mms, /*dim=*/1);
+    }
+    auto self = at::stack(selves);
+    while (self.dim() < 3) {
+      self = self.unsqueeze(1);
+    }
+    self = self.expand({num_mms, mat1s[0].size(0), mat2s[0].size(1)});
+    return at::baddbmm(self, at::stack(mat1s), at::stack(mat2s), beta, alpha)
+        .unbind(0);
+  }
+  std::vector<at::Tensor> outputs;
+  for (int64_t i = 0; i < num_mms; ++i) {
+    outputs.push_back(at::addmm(selves[i], mat1s[i], mat2s[i], beta, alpha));
+  }
+  return outputs;
+}
+
+size_t num_operands(GroupKind kind) {
+  return kind == GroupKind::Matmul ? 2 : 3;
+}
+
+// The inputs of a prim::MMBatchGroup are the first operands of all its ops,
+// then the second operands and so on, followed by beta and alpha for addmm.
+RegisterOperators mm_batch_group_reg({Operator(
+    prim::MMBatchGroup,
+    [](const Node* node) -> Operation {
+      GroupKind kind = static_cast<GroupKind>(node->i(Symbol::attr("kind")));
+      size_t num_mms = node->outputs().size();
+      size_t num_inputs = node->inputs().size();
+      return [kind, num_mms, num_inputs](Stack& stack) {
+        auto inputs = last(stack, num_inputs);
+        size_t num_tensors = num_operands(kind) * num_mms;
+        std::vector<at::Tensor> tensors;
+        tensors.reserve(num_tensors);
+        for (size_t i = 0; i < num_tensors; ++i) {
+          // the bias of aten::linear is optional
+          tensors.push_back(
+              inputs[i].isNone() ? at::Tensor() : inputs[i].toTensor());
+        }
+        const auto operands = [&](size_t i) {
+          return at::TensorList(tensors).slice(i * num_mms, num_mms);
+        };
+
+        std::vector<at::Tensor> outputs;
+        switch (kind) {
+          case GroupKind::Matmul:
+            outputs = batch_matmuls(operands(0), operands(1));
+            break;
+          case GroupKind::Linear:
+            outputs = batch_linears(operands(0), operands(1), operands(2));
+            break;
+          case GroupKind::Addmm:
+            outputs = batch_addmms(
+                operands(0),
+                operands(1),
+                operands(2),
+                inputs[num_tensors].toScalar(),
+                inputs[num_tensors + 1].toScalar());
+            break;
+        }
+        drop(stack, num_inputs);
+        stack.insert(
+            stack.end(),
+            std::make_move_iterator(outputs.begin()),
+            std::make_move_iterator(outputs.end()));
+        return 0;
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+c10::optional<GroupKind> groupKindOf(Node* node) {
+  if (node->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    return GroupKind::Matmul;
+  }
+  if (node->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+    return GroupKind::Linear;
+  }
+  if (node->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    return GroupKind::Addmm;
+  }
+  return c10::nullopt;
+}
+
+// Ops are only put in the same group if they can possibly be batched: they
+// have the same kind, the same scalar arguments, and the sizes of their
+// operands don't differ where they are known.
+struct GroupKey {
+  GroupKind kind;
+  std::vector<Value*> scalars;
+  std::vector<bool> is_none;
+  std::vector<c10::optional<std::vector<int64_t>>> sizes;
+
+  GroupKey(Node* node, GroupKind kind) : kind(kind) {
+    for (size_t i = 0; i < num_operands(kind); ++i) {
+      Value* operand = node->inputs().at(i);
+      is_none.push_back(operand->mustBeNone());
+      auto tensor_type = operand->type()->cast<TensorType>();
+      sizes.push_back(
+          tensor_type ? tensor_type->sizes().concrete_sizes() : c10::nullopt);
+    }
+    for (size_t i = num_operands(kind); i < node->inputs().size(); ++i) {
+      scalars.push_back(node->inputs()[i]);
+    }
+  }
+
+  bool operator==(const GroupKey& other) const {
+    return kind == other.kind && scalars == other.scalars &&
+        is_none == other.is_none && sizes == other.sizes;
+  }
+};
+
+void BatchMMGroups(Block* block, AliasDb& alias_db) {
+  const auto batch_group = [&](std::vector<Node*>& mms, GroupKind kind) {
+    moveTogether(mms, alias_db);
+    WithInsertPoint insert_guard{mms[0]};
+    Graph* graph = mms[0]->owningGraph();
+    Node* batch_mm = graph->create(
+        prim::MMBatchGroup,
+        /*inputs=*/{},
+        /*num_outputs=*/mms.size());
+    graph->insertNode(batch_mm);
+    batch_mm->i_(Symbol::attr("kind"), static_cast<int>(kind));
+    for (size_t i = 0; i < num_operands(kind); ++i) {
+      for (Node* mm : mms) {
+        batch_mm->addInput(mm->inputs().at(i));
+      }
+    }
+    for (size_t i = num_operands(kind); i < mms[0]->inputs().size(); ++i) {
+      batch_mm->addInput(mms[0]->inputs()[i]);
+    }
+    for (size_t i = 0; i < mms.size(); ++i) {
+      mms[i]->output()->replaceAllUsesWith(batch_mm->outputs().at(i));
+    }
+  };
+
+  std::vector<GroupKey> keys;
+  std::vector<std::vector<Node*>> groups;
+  for (Node* node : block->nodes()) {
+    if (auto kind = groupKindOf(node)) {
+      GroupKey key(node, *kind);
+      auto it = std::find(keys.begin(), keys.end(), key);
+      if (it == keys.end()) {
+        keys.push_back(std::move(key));
+        groups.emplace_back();
+        it = keys.end() - 1;
+      }
+      groups[it - keys.begin()].push_back(node);
+    } else {
+      for (Block* subblock : node->blocks()) {
+        BatchMMGroups(subblock, alias_db);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < groups.size(); ++i) {
+    auto mms = filterDependentMMs(std::move(groups[i]), alias_db);
+    if (mms.size() >= min_group_size) {
+      batch_group(mms, keys[i].kind);
+    }
+  }
+}
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -479,6 +748,9 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
   AliasDb alias_db(graph);
   BatchMMTreeReduce(graph->block());
   BatchMMSide(graph->block(), alias_db);
+  // alias_db doesn't know about the nodes inserted by BatchMMSide
+  AliasDb group_alias_db(graph);
+  BatchMMGroups(graph->block(), group_alias_db);
   EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of
   // consecutive transposes that didn't exist before.
@@ -0,0 +1,245 @@
+#include <torch/csrc/jit/passes/batch_per_example_loops.h>
+
+#include <torch/csrc/jit/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Ops that compute each element of their output from the elements of their
+// tensor inputs at the same broadcast position
+const std::unordered_set<Symbol>& elementwiseOps() {
+  static const std::unordered_set<Symbol> ops = {
+      aten::add,   aten::sub,   aten::mul,        aten::div,
+      aten::neg,   aten::abs,   aten::reciprocal, aten::pow,
+      aten::exp,   aten::log,   aten::sqrt,       aten::rsqrt,
+      aten::sin,   aten::cos,   aten::floor,      aten::ceil,
+      aten::erf,   aten::relu,  aten::sigmoid,    aten::tanh,
+      aten::clamp, aten::where, aten::gt,         aten::lt,
+      aten::ge,    aten::le,    aten::eq,         aten::ne,
+  };
+  return ops;
+}
+
+bool isTrueConstant(Value* val) {
+  c10::optional<bool> maybe_value = constant_as<bool>(val);
+  return maybe_value && *maybe_value;
+}
+
+bool isConstantInt(Value* val, int64_t expected) {
+  c10::optional<int64_t> maybe_value = constant_as<int64_t>(val);
+  return maybe_value && *maybe_value == expected;
+}
+
+bool isTensor(Value* v) {
+  return v->type()->isSubtypeOf(TensorType::get());
+}
+
+struct PerExampleLoop {
+  Node* loop = nullptr;
+  Node* list = nullptr;
+  Node* append = nullptr;
+  Node* stack = nullptr;
+  // The tensors whose rows the body selects
+  std::vector<Value*> sources;
+  // The tensors defined outside the loop that the ops broadcast rows with
+  std::vector<Value*> broadcast;
+};
+
+bool matchBody(PerExampleLoop& match) {
+  Block* body = match.loop->blocks().at(0);
+  if (body->outputs().size() != 1 || !isTrueConstant(body->outputs()[0])) {
+    return false;
+  }
+  Value* index = body->inputs().at(0);
+  auto definedOutside = [&](Value* v) {
+    return v->node()->owningBlock() != body;
+  };
+
+  // The values of the body that hold a row, or a function of rows
+  std::unordered_set<Value*> rows;
+  for (Node* n : body->nodes()) {
+    if (n->kind() == prim::Constant) {
+      continue;
+    }
+    if (n->kind() == aten::select && n->inputs().size() == 3 &&
+        isTensor(n->input(0)) && definedOutside(n->input(0)) &&
+        isConstantInt(n->input(1), 0) && n->input(2) == index) {
+      match.sources.push_back(n->input(0));
+      rows.insert(n->output());
+      continue;
+    }
+    if (n->kind() == aten::append && !match.append &&
+        definedOutside(n->input(0)) && rows.count(n->input(1))) {
+      match.append = n;
+      continue;
+    }
+    if (!elementwiseOps().count(n->kind()) || n->outputs().size() != 1 ||
+        !isTensor(n->output()) || !n->maybeSchema()) {
+      GRAPH_DEBUG("Not batching the loop due to ", getHeader(n));
+      return false;
+    }
+    bool reads_row = false;
+    for (Value* v : n->inputs()) {
+      if (rows.count(v)) {
+        reads_row = true;
+      } else if (v == index) {
+        return false;
+      } else if (definedOutside(v)) {
+        if (isTensor(v)) {
+          match.broadcast.push_back(v);
+        } else if (!v->type()->isSubtypeOf(NumberType::get()) &&
+                   v->type() != NoneType::get()) {
+          return false;
+        }
+      } else if (v->node()->kind() != prim::Constant) {
+        return false;
+      }
+    }
+    // Loop invariant ops are left to HoistLoopInvariants
+    if (!reads_row) {
+      return false;
+    }
+    rows.insert(n->output());
+  }
+  return match.append != nullptr;
+}
+
+c10::optional<PerExampleLoop> matchLoop(Node* loop) {
+  if (loop->outputs().size() != 0 || !isTrueConstant(loop->input(1))) {
+    return c10::nullopt;
+  }
+  PerExampleLoop match;
+  match.loop = loop;
+  if (!matchBody(match)) {
+    return c10::nullopt;
+  }
+
+  // The list must be fresh, and only read by a stack along dim 0 after the
+  // loop, so that nothing else sees the rows in it
+  Value* list = match.append->input(0);
+  match.list = list->node();
+  if (match.list->kind() != prim::ListConstruct ||
+      match.list->inputs().size() != 0 ||
+      match.list->owningBlock() != loop->owningBlock() ||
+      list->uses().size() != 2) {
+    return c10::nullopt;
+  }
+  for (const Use& use : list->uses()) {
+    if (use.user == match.append) {
+      continue;
+    }
+    if (use.user->kind() != aten::stack || use.offset != 0 ||
+        use.user->owningBlock() != loop->owningBlock() ||
+        !use.user->isAfter(loop) || !isConstantInt(use.user->input(1), 0)) {
+      return c10::nullopt;
+    }
+    match.stack = use.user;
+  }
+  return match;
+}
+
+void batchLoop(const PerExampleLoop& match) {
+  Node* loop = match.loop;
+  Block* body = loop->blocks().at(0);
+  Graph* graph = loop->owningGraph();
+  GRAPH_UPDATE("Batching the per example ", getHeader(loop));
+
+  WithInsertPoint guard(loop);
+  auto both = [&](Value* a, Value* b) {
+    return graph->insert(aten::__and__, {a, b});
+  };
+  Value* trip_count = loop->input(0);
+  Value* rank = graph->insert(aten::dim, {match.sources[0]});
+  Value* batchable = both(
+      graph->insert(aten::gt, {trip_count, 0}),
+      graph->insert(aten::ge, {rank, 2}));
+  for (Value* source : match.sources) {
+    Value* source_rank = graph->insert(aten::dim, {source});
+    Value* rows = graph->insert(aten::size, {source, 0});
+    batchable = both(batchable, graph->insert(aten::eq, {source_rank, rank}));
+    batchable = both(batchable, graph->insert(aten::eq, {rows, trip_count}));
+  }
+  for (Value* v : match.broadcast) {
+    Value* v_rank = graph->insert(aten::dim, {v});
+    batchable = both(batchable, graph->insert(aten::lt, {v_rank, rank}));
+  }
+  // The stack moves before the nodes between the loop and it
+  match.stack->replaceInput(1, graph->insertConstant(0));
+
+  Node* if_node = graph->insertNode(graph->create(prim::If, {batchable}, 0));
+  Block* batched = if_node->addBlock();
+  Block* original = if_node->addBlock();
+
+  std::unordered_map<Value*, Value*> batched_values;
+  auto batchedValue = [&](Value* v) {
+    auto it = batched_values.find(v);
+    return it != batched_values.end() ? it->second : v;
+  };
+  for (Node* n : body->nodes()) {
+    if (n == match.append) {
+      continue;
+    }
+    if (n->kind() == aten::select) {
+      batched_values[n->output()] = n->input(0);
+      continue;
+    }
+    Node* batched_node =
+        batched->appendNode(graph->createClone(n, batchedValue));
+    // Shapes were inferred for rows
+    batched_node->output()->setType(unshapedType(n->output()->type()));
+    batched_values[n->output()] = batched_node->output();
+  }
+  Value* result = batchedValue(match.append->input(1));
+  {
+    // Like the stack, return a fresh contiguous tensor
+    WithInsertPoint result_guard(batched->return_node());
+    if (result->node()->owningBlock() != batched) {
+      result = graph->insert(aten::clone, {result});
+    }
+    result = graph->insert(aten::contiguous, {result});
+  }
+  batched->registerOutput(result);
+
+  match.list->moveBefore(original->return_node());
+  loop->moveBefore(original->return_node());
+  match.stack->moveBefore(original->return_node());
+  Value* output = if_node->addOutput()->copyMetadata(match.stack->output());
+  match.stack->output()->replaceAllUsesWith(output);
+  original->registerOutput(match.stack->output());
+}
+
+// Collects the loops of block, inner loops before the loops that contain them
+void collectLoops(Block* block, std::vector<Node*>& loops) {
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      collectLoops(b, loops);
+    }
+    if (n->kind() == prim::Loop) {
+      loops.push_back(n);
+    }
+  }
+}
+
+} // namespace
+
+void BatchPerExampleLoops(std::shared_ptr<Graph>& graph) {
+  GRAPH_DUMP("Before batching per example loops", graph);
+  // Collected first, as batching moves the nodes around the loops
+  std::vector<Node*> loops;
+  collectLoops(graph->block(), loops);
+  for (Node* loop : loops) {
+    if (auto match = matchLoop(loop)) {
+      batchLoop(*match);
+    }
+  }
+  GRAPH_DUMP("After batching per example loops", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Rewrites loops that compute a tensor per example of a batch into the same
+// elementwise ops over the whole batch. It matches loops like
+//
+//   outs = []
+//   for i in range(x.size(0)):
+//       outs.append(torch.relu(x[i] * w + y[i]))
+//   out = torch.stack(outs)
+//
+// whose body only selects the rows i of tensors defined outside the loop, runs
+// elementwise ops on them, tensors defined outside the loop and scalars, and
+// appends the result to a list that is only stacked along dim 0 after the loop.
+// Such a body has no loop-carried values, so running its ops on x and y
+// instead of their rows gives the stacked result, as long as broadcasting
+// treats the batch dim as a leading dim. That is checked when the graph runs:
+// the loop runs at least once, the tensors whose rows are selected have as
+// many rows as the loop runs, the same rank, and at least two dims, and the
+// other tensors have fewer dims. When the check fails, the original loop runs.
+TORCH_API void BatchPerExampleLoops(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,195 @@
+#include <torch/csrc/jit/passes/convert_to_mkldnn.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/constants.h>
+
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+const auto kToMKLDNN = Symbol::aten("to_mkldnn");
+const auto kReluInplace = Symbol::aten("relu_");
+const auto kSigmoidInplace = Symbol::aten("sigmoid_");
+
+// Returns the value of v if it is a constant dense float tensor on the CPU,
+// the only weights that MKL-DNN takes
+c10::optional<at::Tensor> constantWeight(Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isTensor()) {
+    return c10::nullopt;
+  }
+  at::Tensor t = iv->toTensor();
+  if (!t.defined() || t.layout() != at::kStrided || !t.device().is_cpu() ||
+      t.scalar_type() != at::kFloat) {
+    return c10::nullopt;
+  }
+  return t;
+}
+
+bool isInplace(Node* n) {
+  return n->kind() == kReluInplace || n->kind() == kSigmoidInplace;
+}
+
+// Whether n returns an MKL-DNN tensor when its first input is one, and takes no
+// other tensor
+bool keepsMKLDNNLayout(Node* n) {
+  if (n->kind() == aten::relu || n->kind() == aten::sigmoid ||
+      n->kind() == aten::max_pool2d || n->kind() == aten::adaptive_avg_pool2d) {
+    return true;
+  }
+  if (n->kind() == aten::avg_pool2d) {
+    // MKL-DNN doesn't take a divisor_override
+    return n->input(6)->mustBeNone();
+  }
+  // In place ops would change the value that a dense copy of their input was
+  // taken from, so they must be its only use
+  return isInplace(n) && n->input(0)->uses().size() == 1;
+}
+
+// Whether an op that doesn't support MKL-DNN tensors may write to v, which the
+// MKL-DNN ops that use v would then not see
+bool writtenByDenseOps(Value* v) {
+  for (const Use& use : v->uses()) {
+    if (isInplace(use.user) && v->uses().size() == 1) {
+      continue;
+    }
+    const FunctionSchema* schema = use.user->maybeSchema();
+    if (!schema || use.offset >= schema->arguments().size()) {
+      continue;
+    }
+    const AliasInfo* alias_info = schema->arguments()[use.offset].alias_info();
+    if (alias_info && alias_info->isWrite()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replaces the constant weight and bias of an aten::conv2d or aten::linear
+// with MKL-DNN tensors, the weight of a convolution reordered for its
+// parameters, and returns whether it could
+bool convertWeights(Node* n) {
+  auto weight = constantWeight(n->input(1));
+  auto bias = toIValue(n->input(2));
+  if (!weight || !bias ||
+      (!bias->isNone() && !constantWeight(n->input(2)))) {
+    return false;
+  }
+
+  at::NoGradGuard no_grad;
+  at::Tensor mkldnn_weight;
+  at::Tensor mkldnn_bias;
+  if (n->kind() == aten::conv2d) {
+    auto stride = toIValue(n->input(3));
+    auto padding = toIValue(n->input(4));
+    auto dilation = toIValue(n->input(5));
+    auto groups = toIValue(n->input(6));
+    if (weight->dim() != 4 || !stride || !stride->isIntList() || !padding ||
+        !padding->isIntList() || !dilation || !dilation->isIntList() ||
+        !groups || !groups->isInt()) {
+      return false;
+    }
+    mkldnn_weight = at::mkldnn_reorder_conv2d_weight(
+        weight->to_mkldnn(),
+        padding->toIntVector(),
+        stride->toIntVector(),
+        dilation->toIntVector(),
+        groups->toInt());
+    if (bias->isTensor()) {
+      mkldnn_bias = bias->toTensor().to_mkldnn();
+    }
+  } else {
+    if (weight->dim() != 2) {
+      return false;
+    }
+    mkldnn_weight = weight->to_mkldnn();
+    // mkldnn_linear needs a bias
+    mkldnn_bias = bias->isTensor()
+        ? bias->toTensor().to_mkldnn()
+        : at::zeros({weight->size(0)}, weight->options()).to_mkldnn();
+  }
+
+  WithInsertPoint guard(n);
+  Graph* graph = n->owningGraph();
+  n->replaceInput(1, graph->insertConstant(mkldnn_weight));
+  if (mkldnn_bias.defined()) {
+    n->replaceInput(2, graph->insertConstant(mkldnn_bias));
+  }
+  return true;
+}
+
+// Collects the nodes of block that are converted to run on MKL-DNN tensors,
+// and their outputs. A chain starts at a convolution or linear whose weights
+// are converted, and grows through the ops that keep the layout.
+void collectMKLDNNNodes(
+    Block* block,
+    std::vector<Node*>& nodes,
+    std::unordered_set<Value*>& values) {
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      collectMKLDNNNodes(b, nodes, values);
+    }
+    bool convert = false;
+    if (n->kind() == aten::conv2d || n->kind() == aten::linear) {
+      convert = !writtenByDenseOps(n->output()) && convertWeights(n);
+    } else if (keepsMKLDNNLayout(n)) {
+      convert = values.count(n->input(0)) && !writtenByDenseOps(n->output());
+    }
+    if (convert) {
+      nodes.push_back(n);
+      values.insert(n->output());
+    }
+  }
+}
+
+// Whether the use only reads the shape of the value, which MKL-DNN tensors
+// have too
+bool readsShape(const Use& use) {
+  return use.user->kind() == aten::size || use.user->kind() == aten::dim;
+}
+
+} // namespace
+
+void ConvertFrozenOpsToMKLDNN(std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKLDNN()) {
+    return;
+  }
+  std::vector<Node*> nodes;
+  std::unordered_set<Value*> values;
+  collectMKLDNNNodes(graph->block(), nodes, values);
+
+  for (Node* n : nodes) {
+    Value* input = n->input(0);
+    if (values.count(input)) {
+      continue;
+    }
+    // Right before n, so that the copy sees the writes made to input before it
+    WithInsertPoint guard(n);
+    n->replaceInput(0, graph->insert(kToMKLDNN, {input}));
+  }
+
+  std::unordered_set<Node*> converted(nodes.begin(), nodes.end());
+  for (Node* n : nodes) {
+    Value* output = n->output();
+    std::vector<Use> dense_uses;
+    for (const Use& use : output->uses()) {
+      if (!readsShape(use) && !converted.count(use.user)) {
+        dense_uses.push_back(use);
+      }
+    }
+    if (dense_uses.empty()) {
+      continue;
+    }
+    WithInsertPoint guard(n->next());
+    Value* dense = graph->insert(aten::to_dense, {output});
+    for (const Use& use : dense_uses) {
+      use.user->replaceInput(use.offset, dense);
+    }
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,30 @@
+/** \brief Running the convolutions and linears of frozen graphs with MKL-DNN
+ *
+ * MKL-DNN keeps its weights and activations in blocked layouts. The eager
+ * ops reorder dense weights into them on every call, and reorder back every
+ * output they return for a dense input. This pass does the weight reorders
+ * once, on the constant weights of a frozen graph, and keeps the activations
+ * in MKL-DNN layout between the ops that support it.
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Converts the constant float weights of aten::conv2d and aten::linear
+ * to MKL-DNN tensors, and runs the chains of ops that support MKL-DNN tensors
+ * and start at them on MKL-DNN activations
+ *
+ * An aten::to_mkldnn is inserted before the first op of a chain, and an
+ * aten::to_dense before the ops that use its results and don't support MKL-DNN
+ * tensors. It is meant to run last on a graph whose weights are constants,
+ * e.g. the forward of a module returned by freeze_module, and does nothing when
+ * PyTorch is built without MKL-DNN. Graphs with MKL-DNN constants can't be
+ * serialized.
+ */
+TORCH_API void ConvertFrozenOpsToMKLDNN(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
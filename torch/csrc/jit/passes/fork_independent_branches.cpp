@@ -0,0 +1,249 @@
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
+
+#include <torch/csrc/jit/passes/alias_analysis.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isForkable(Node* n, const AliasDb& aliasDb) {
+  if (n->kind() != prim::FusionGroup &&
+      (!n->kind().is_aten() || n->kind() == aten::wait)) {
+    return false;
+  }
+  return n->blocks().empty() && !n->hasSideEffects() &&
+      !n->isNondeterministic() && !aliasDb.hasWriters(n);
+}
+
+bool producesTensor(Node* n) {
+  for (Value* output : n->outputs()) {
+    if (output->type()->isSubtypeOf(TensorType::get())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct Branch {
+  std::vector<Node*> nodes;
+  // the values of the branch that are used outside of it
+  std::vector<Value*> outputs;
+  // the outputs are waited for right before this node
+  Node* wait_point = nullptr;
+};
+
+class BranchForker {
+ public:
+  explicit BranchForker(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)), aliasDb_(graph_) {}
+
+  bool run() {
+    partition();
+    // all decisions are made on the original graph, forking destroys nodes
+    std::vector<Branch*> to_fork;
+    for (Branch& branch : branches_) {
+      if (shouldFork(branch)) {
+        to_fork.push_back(&branch);
+      }
+    }
+    for (Branch* branch : to_fork) {
+      fork(*branch);
+    }
+    return !to_fork.empty();
+  }
+
+ private:
+  void partition() {
+    Block* block = graph_->block();
+    for (Node* n : block->nodes()) {
+      position_[n] = order_.size();
+      order_.push_back(n);
+      if (isForkable(n, aliasDb_)) {
+        size_t branch = branchFor(n);
+        branch_of_[n] = branch;
+        branches_[branch].nodes.push_back(n);
+      }
+    }
+    position_[block->return_node()] = order_.size();
+    order_.push_back(block->return_node());
+    for (Branch& branch : branches_) {
+      computeOutputs(branch);
+    }
+  }
+
+  size_t startBranch() {
+    branches_.emplace_back();
+    return branches_.size() - 1;
+  }
+
+  size_t branchFor(Node* n) {
+    c10::optional<size_t> joined;
+    for (Value* input : n->inputs()) {
+      auto it = branch_of_.find(input->node());
+      if (it == branch_of_.end()) {
+        continue;
+      }
+      if (joined && *joined != it->second) {
+        return startBranch();
+      }
+      joined = it->second;
+    }
+    if (!joined) {
+      return startBranch();
+    }
+    // all other inputs have to be available where the branch is forked
+    size_t start = position_.at(branches_[*joined].nodes.front());
+    for (Value* input : n->inputs()) {
+      Node* producer = input->node();
+      if (producer->kind() == prim::Param || branch_of_.count(producer)) {
+        continue;
+      }
+      if (position_.at(producer) > start) {
+        return startBranch();
+      }
+    }
+    return *joined;
+  }
+
+  Node* topLevelNode(Node* n) {
+    while (n->owningBlock() != graph_->block()) {
+      n = n->owningBlock()->owningNode();
+    }
+    return n;
+  }
+
+  // Where the outputs of another branch have to be available for user. If it
+  // is part of a branch, that is where this branch starts, since the branch
+  // may be forked.
+  size_t neededAt(Node* user) {
+    auto it = branch_of_.find(user);
+    if (it != branch_of_.end()) {
+      return position_.at(branches_[it->second].nodes.front());
+    }
+    return position_.at(user);
+  }
+
+  void computeOutputs(Branch& branch) {
+    std::unordered_set<Node*> members(
+        branch.nodes.begin(), branch.nodes.end());
+    size_t wait_position = std::numeric_limits<size_t>::max();
+    for (Node* n : branch.nodes) {
+      for (Value* output : n->outputs()) {
+        bool used_outside = false;
+        for (const Use& use : output->uses()) {
+          Node* user = topLevelNode(use.user);
+          if (!members.count(user)) {
+            used_outside = true;
+            wait_position = std::min(wait_position, neededAt(user));
+          }
+        }
+        if (used_outside) {
+          branch.outputs.push_back(output);
+        }
+      }
+    }
+    if (!branch.outputs.empty()) {
+      branch.wait_point = order_.at(wait_position);
+    }
+  }
+
+  bool shouldFork(const Branch& branch) {
+    if (branch.outputs.empty() ||
+        std::none_of(
+            branch.nodes.begin(), branch.nodes.end(), producesTensor)) {
+      return false;
+    }
+    // forking only pays off if the calling thread has something else to do
+    // until it waits for the branch
+    std::unordered_set<Node*> members(
+        branch.nodes.begin(), branch.nodes.end());
+    size_t begin = position_.at(branch.nodes.front());
+    size_t end = position_.at(branch.wait_point);
+    for (size_t i = begin + 1; i < end; ++i) {
+      if (!members.count(order_[i]) && order_[i]->kind() != prim::Constant) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void fork(const Branch& branch) {
+    auto subgraph = std::make_shared<Graph>();
+    Node* fork_node = graph_->create(prim::fork, 1)
+                          ->insertBefore(branch.nodes.front())
+                          ->setSourceRange(branch.nodes.front()->sourceRange());
+    std::unordered_map<Value*, Value*> env;
+    auto value_map = [&](Value* v) {
+      auto it = env.find(v);
+      if (it != env.end()) {
+        return it->second;
+      }
+      fork_node->addInput(v);
+      Value* input = subgraph->addInput()->copyMetadata(v);
+      env[v] = input;
+      return input;
+    };
+    for (Node* n : branch.nodes) {
+      Node* clone = subgraph->insertNode(subgraph->createClone(n, value_map));
+      for (size_t i = 0; i < n->outputs().size(); ++i) {
+        env[n->outputs()[i]] = clone->outputs()[i];
+      }
+    }
+    if (branch.outputs.size() == 1) {
+      subgraph->registerOutput(env.at(branch.outputs[0]));
+    } else {
+      std::vector<Value*> outputs;
+      for (Value* output : branch.outputs) {
+        outputs.push_back(env.at(output));
+      }
+      subgraph->registerOutput(
+          subgraph->insertNode(subgraph->createTuple(outputs))->output());
+    }
+    TypePtr result_type = subgraph->outputs().at(0)->type();
+    fork_node->g_(attr::Subgraph, subgraph);
+    fork_node->output()->setType(FutureType::create(result_type));
+
+    WithInsertPoint guard(branch.wait_point);
+    Value* result =
+        graph_->insertNode(graph_->create(aten::wait, {fork_node->output()}))
+            ->output()
+            ->setType(result_type);
+    std::vector<Value*> results = {result};
+    if (branch.outputs.size() > 1) {
+      results = graph_->insertNode(graph_->createTupleUnpack(result))
+                    ->outputs()
+                    .vec();
+    }
+    for (size_t i = 0; i < branch.outputs.size(); ++i) {
+      results[i]->copyMetadata(branch.outputs[i]);
+      branch.outputs[i]->replaceAllUsesWith(results[i]);
+    }
+    for (auto it = branch.nodes.rbegin(); it != branch.nodes.rend(); ++it) {
+      (*it)->destroy();
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  AliasDb aliasDb_;
+  // the nodes of the top-level block (and its return node) in order
+  std::vector<Node*> order_;
+  std::unordered_map<Node*, size_t> position_;
+  std::vector<Branch> branches_;
+  std::unordered_map<Node*, size_t> branch_of_;
+};
+
+} // namespace
+
+bool ForkIndependentBranches(const std::shared_ptr<Graph>& graph) {
+  return BranchForker(graph).run();
+}
+
+} // namespace jit
+} // namespace torch
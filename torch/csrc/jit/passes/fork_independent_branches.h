@@ -0,0 +1,31 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Runs independent branches of a graph concurrently on the inter-op thread
+// pool, similar to what caffe2's AsyncSchedulingNet does for nets.
+//
+// The pure nodes of the top-level block (no blocks, no side effects, not
+// nondeterministic, and none of the values they use or produce has writers
+// according to alias analysis) are partitioned into branches. A node
+// continues the branch of its producers if they are all in the same branch
+// and all its other inputs are defined before that branch starts; otherwise
+// it starts a new branch, e.g. where independent towers are joined.
+//
+// A branch is moved into a prim::fork placed where the branch started. Its
+// outputs are taken from an aten::wait placed right before their first use.
+// This only happens if some other work of the graph can run between the fork
+// and the wait, so the last of a set of independent branches stays on the
+// calling thread.
+//
+// Forks are not differentiable, so this must only run on graphs that do not
+// require gradients.
+//
+// Returns true if any branch was forked.
+TORCH_API bool ForkIndependentBranches(const std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,239 @@
+#include <torch/csrc/jit/passes/freeze_module.h>
+
+#include <ATen/core/functional.h>
+#include <torch/csrc/jit/constants.h>
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/jit/passes/constant_pooling.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/fuse_linear.h>
+#include <torch/csrc/jit/passes/inliner.h>
+
+#include <set>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using ModulePtr = c10::intrusive_ptr<c10::ivalue::Object>;
+
+void collectAttributeNodes(Block* block, std::vector<Node*>& nodes) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == prim::GetAttr || n->kind() == prim::SetAttr) {
+      nodes.push_back(n);
+    }
+    for (Block* b : n->blocks()) {
+      collectAttributeNodes(b, nodes);
+    }
+  }
+}
+
+// Constants can't require grad, so parameters, and tensors in list or tuple
+// attributes that require grad, are inlined detached. The detached tensors
+// share their storage with the attribute.
+IValue detachTensors(const IValue& value) {
+  if (value.isTensor()) {
+    const at::Tensor& t = value.toTensor();
+    return t.requires_grad() ? IValue(t.detach()) : value;
+  }
+  if (value.isTensorList()) {
+    c10::List<at::Tensor> list;
+    for (const at::Tensor& t : value.toTensorList()) {
+      list.push_back(t.requires_grad() ? t.detach() : t);
+    }
+    return list;
+  }
+  if (value.isTuple()) {
+    const auto& tuple = value.toTuple();
+    auto elements = fmap(tuple->elements(), detachTensors);
+    if (tuple->type()->schema()) {
+      return c10::ivalue::Tuple::createNamed(
+          std::move(elements), tuple->type());
+    }
+    return c10::ivalue::Tuple::create(std::move(elements));
+  }
+  return value;
+}
+
+// Returns whether the graph may write to the value of v, or to the values
+// that ops make alias it. It is conservative: v is assumed to be written if it
+// goes into a container or into a node without schema, e.g. a block output.
+bool mayBeWritten(Value* v) {
+  for (const Use& use : v->uses()) {
+    Node* user = use.user;
+    if (user->kind() == prim::ListConstruct ||
+        user->kind() == prim::TupleConstruct ||
+        user->kind() == prim::unchecked_cast) {
+      if (mayBeWritten(user->output())) {
+        return true;
+      }
+      continue;
+    }
+    const FunctionSchema* schema = user->maybeSchema();
+    if (!schema || use.offset >= schema->arguments().size()) {
+      return true;
+    }
+    const AliasInfo* alias_info = schema->arguments()[use.offset].alias_info();
+    if (!alias_info) {
+      continue;
+    }
+    if (alias_info->isWrite() || !alias_info->afterSets().empty()) {
+      return true;
+    }
+    for (size_t i = 0; i < schema->returns().size(); i++) {
+      if (schema->returns()[i].alias_info() && mayBeWritten(user->output(i))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Replaces the prim::GetAttr of the attributes of self and of its submodules
+// with constants, unless the graph writes to them, and returns whether it
+// replaced any. An attribute is written if it is the target of a
+// prim::SetAttr, or if it is mutable and mayBeWritten, e.g. the running stats
+// that a batch norm updates in training mode. Those writes are often in
+// branches that constant propagation removes once the attributes they depend
+// on are constants, so the caller runs this again until nothing changes.
+bool replaceAttributesWithConstants(
+    const std::shared_ptr<Graph>& graph,
+    const ModulePtr& self) {
+  std::vector<Node*> nodes;
+  collectAttributeNodes(graph->block(), nodes);
+
+  // The modules that values of the graph are known to be
+  std::unordered_map<Value*, ModulePtr> modules = {
+      {graph->inputs().at(0), self}};
+  std::set<std::pair<c10::ivalue::Object*, std::string>> written;
+  for (Node* n : nodes) {
+    auto it = modules.find(n->inputs().at(0));
+    if (it == modules.end()) {
+      continue;
+    }
+    const auto& name = n->s(attr::name);
+    if (n->kind() == prim::SetAttr) {
+      written.emplace(it->second.get(), name);
+      continue;
+    }
+    auto type = n->output()->type()->cast<ClassType>();
+    if (type && type->is_module()) {
+      modules.emplace(n->output(), it->second->getAttr(name).toObject());
+    } else if (AliasDb::mutableType(n->output()) && mayBeWritten(n->output())) {
+      written.emplace(it->second.get(), name);
+    }
+  }
+
+  bool changed = false;
+  for (Node* n : nodes) {
+    if (n->kind() != prim::GetAttr || modules.count(n->output())) {
+      continue;
+    }
+    auto it = modules.find(n->input());
+    if (it == modules.end() ||
+        written.count(std::make_pair(it->second.get(), n->s(attr::name)))) {
+      continue;
+    }
+    WithInsertPoint guard(n);
+    auto constant = tryInsertConstant(
+        *graph, detachTensors(it->second->getAttr(n->s(attr::name))));
+    if (!constant) {
+      continue;
+    }
+    n->output()->replaceAllUsesWith(*constant);
+    n->destroy();
+    changed = true;
+  }
+  return changed;
+}
+
+c10::optional<at::Tensor> constantTensor(Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isTensor()) {
+    return c10::nullopt;
+  }
+  return iv->toTensor();
+}
+
+void foldConvBatchNorm(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* bn = *it++;
+    for (Block* b : bn->blocks()) {
+      foldConvBatchNorm(b);
+    }
+    if (bn->kind() != aten::batch_norm) {
+      continue;
+    }
+    Node* conv = bn->input(0)->node();
+    if ((conv->kind() != aten::conv1d && conv->kind() != aten::conv2d &&
+         conv->kind() != aten::conv3d) ||
+        bn->input(0)->uses().size() != 1) {
+      continue;
+    }
+    auto conv_w = constantTensor(conv->input(1));
+    auto conv_b = toIValue(conv->input(2));
+    auto bn_w = toIValue(bn->input(1));
+    auto bn_b = toIValue(bn->input(2));
+    auto bn_rm = constantTensor(bn->input(3));
+    auto bn_rv = constantTensor(bn->input(4));
+    auto training = toIValue(bn->input(5));
+    auto eps = toIValue(bn->input(7));
+    if (!conv_w || !conv_b || !bn_w || !bn_b || !bn_rm || !bn_rv ||
+        !training || training->toBool() || !eps) {
+      continue;
+    }
+
+    at::NoGradGuard no_grad;
+    at::Tensor scale = at::rsqrt(*bn_rv + eps->toDouble());
+    if (bn_w->isTensor()) {
+      scale = scale * bn_w->toTensor();
+    }
+    at::Tensor bias = conv_b->isTensor() ? conv_b->toTensor()
+                                         : at::zeros_like(*bn_rm);
+    at::Tensor shift = (bias - *bn_rm) * scale;
+    if (bn_b->isTensor()) {
+      shift = shift + bn_b->toTensor();
+    }
+    std::vector<int64_t> shape(conv_w->dim(), 1);
+    shape[0] = -1;
+
+    WithInsertPoint guard(conv);
+    Graph* graph = block->owningGraph();
+    conv->replaceInput(1, graph->insertConstant(*conv_w * scale.reshape(shape)));
+    conv->replaceInput(2, graph->insertConstant(shift));
+    bn->output()->replaceAllUsesWith(conv->output());
+    bn->destroy();
+  }
+}
+
+} // namespace
+
+void FoldFrozenConvBatchNorm(std::shared_ptr<Graph>& graph) {
+  foldConvBatchNorm(graph->block());
+  EliminateDeadCode(graph);
+}
+
+script::Module freeze_module(const script::Module& module) {
+  script::Module frozen = module.clone();
+  TORCH_CHECK(
+      !frozen.is_training(),
+      "freeze_module expects a module in eval mode, call eval() on it first");
+  auto graph = frozen.get_method("forward").graph();
+  Inline(*graph);
+  // Before the weights are constants, which would fold their aten::t
+  FuseLinear(graph);
+  while (replaceAttributesWithConstants(graph, frozen._ivalue())) {
+    ConstantPropagation(graph);
+    EliminateDeadCode(graph);
+  }
+  FoldFrozenConvBatchNorm(graph);
+  ConstantPropagation(graph);
+  ConstantPooling(graph);
+  EliminateDeadCode(graph);
+  return frozen;
+}
+
+} // namespace jit
+} // namespace torch
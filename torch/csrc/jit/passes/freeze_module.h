@@ -0,0 +1,33 @@
+/** \brief Freezing of modules for inference
+ *
+ * Freezing turns the attributes that the forward method of a module reads,
+ * e.g. its parameters, buffers and `training` flag, into constants of the
+ * graph, so that the passes that need concrete values (constant propagation,
+ * folding of batch norms, ...) can work on them.
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/script/module.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Returns a copy of module, which must be in eval mode, whose forward
+ * method reads no attribute that it doesn't modify
+ *
+ * The graph of forward is inlined, the attributes it reads are replaced with
+ * constants, and constant propagation runs on the result. The batch norms that
+ * follow convolutions are folded into them, and the linear patterns are fused
+ * into aten::linear. The attributes of the copy share their values with the
+ * ones of module, and the other methods of the copy are left as they are.
+ */
+TORCH_API script::Module freeze_module(const script::Module& module);
+
+/** \brief Folds the eval mode aten::batch_norm that follow aten::conv1d/2d/3d
+ * into the weight and bias of the convolutions, when all of them are constants
+ */
+TORCH_API void FoldFrozenConvBatchNorm(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
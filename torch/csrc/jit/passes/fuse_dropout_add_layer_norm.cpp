@@ -0,0 +1,40 @@
+#include <torch/csrc/jit/passes/fuse_dropout_add_layer_norm.h>
+#include <torch/csrc/jit/passes/subgraph_rewrite.h>
+
+namespace torch {
+namespace jit {
+
+void FuseDropoutAddLayerNorm(std::shared_ptr<Graph>& graph) {
+  std::string dropout_add_pattern = R"IR(
+    graph(%input, %residual, %p, %train, %normalized_shape, %weight, %bias, %eps, %cudnn_enable):
+        %alpha : int = prim::Constant[value=1]()
+        %dropped = aten::dropout(%input, %p, %train)
+        %sum = aten::add(%dropped, %residual, %alpha)
+        %res = aten::layer_norm(%sum, %normalized_shape, %weight, %bias, %eps, %cudnn_enable)
+        return (%res))IR";
+  std::string add_dropout_pattern = R"IR(
+    graph(%input, %residual, %p, %train, %normalized_shape, %weight, %bias, %eps, %cudnn_enable):
+        %alpha : int = prim::Constant[value=1]()
+        %dropped = aten::dropout(%input, %p, %train)
+        %sum = aten::add(%residual, %dropped, %alpha)
+        %res = aten::layer_norm(%sum, %normalized_shape, %weight, %bias, %eps, %cudnn_enable)
+        return (%res))IR";
+  std::string fused_dropout_add_layer_norm = R"IR(
+    graph(%input, %residual, %p, %train, %normalized_shape, %weight, %bias, %eps, %cudnn_enable):
+        %res = aten::dropout_add_layer_norm(%input, %residual, %normalized_shape, %weight, %bias, %p, %train, %eps)
+        return (%res))IR";
+
+  // replace dropout(input) + residual pattern
+  SubgraphRewriter dropout_add_to_fused;
+  dropout_add_to_fused.RegisterRewritePattern(
+      dropout_add_pattern, fused_dropout_add_layer_norm);
+  dropout_add_to_fused.runOnGraph(graph);
+
+  // replace residual + dropout(input) pattern
+  SubgraphRewriter add_dropout_to_fused;
+  add_dropout_to_fused.RegisterRewritePattern(
+      add_dropout_pattern, fused_dropout_add_layer_norm);
+  add_dropout_to_fused.runOnGraph(graph);
+}
+} // namespace jit
+} // namespace torch
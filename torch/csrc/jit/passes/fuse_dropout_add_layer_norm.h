@@ -0,0 +1,19 @@
+/** \brief Fusing dropout + residual add + layer_norm into a single
+ * aten::dropout_add_layer_norm
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Match the dropout -> add -> layer_norm sequence that closes every
+ * transformer sublayer and replace it with aten::dropout_add_layer_norm,
+ * which does not store the dropout mask and normalizes in the same pass.
+ * The add must have alpha = 1 and its intermediate results must have no
+ * other uses.
+ */
+TORCH_API void FuseDropoutAddLayerNorm(std::shared_ptr<Graph>& graph);
+} // namespace jit
+} // namespace torch
@@ -119,6 +119,67 @@ bool isSimpleMap(Node* node) {
   return true;
 }
 
+// Row-wise reductions and normalizations over the last dimension of a
+// tensor. The results of the reductions (sum and mean, with keepdim) are
+// broadcast back along the rows by the ops using them, so they can only be
+// used inside of a fusion group, while the normalizations have the shape of
+// their input and can also be outputs of a group.
+// Unlike simple maps they need to see whole rows, which only the interpreted
+// CPU kernels can do (see fuser/cpu/interpreted_kernel.h). They are not
+// fused when the CPU kernels are compiled, nor for other devices.
+bool isRowReduction(Node* node) {
+  static OperatorSet row_reductions{{
+      "aten::sum(Tensor self, int[] dim, bool keepdim, *, int? dtype) -> Tensor",
+      "aten::mean(Tensor self, int[] dim, bool keepdim, *, int? dtype) -> Tensor",
+  }};
+  return node->isMemberOf(row_reductions);
+}
+
+bool isRowwise(Node* node) {
+  static OperatorSet row_normalizations{{
+      "aten::softmax(Tensor self, int dim, int? dtype) -> Tensor",
+      "aten::log_softmax(Tensor self, int dim, int? dtype) -> Tensor",
+      "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor? weight, Tensor? bias, float eps, bool cudnn_enable) -> Tensor",
+  }};
+  const bool is_reduction = isRowReduction(node);
+  if (!is_reduction && !node->isMemberOf(row_normalizations)) {
+    return false;
+  }
+  if (!canFuseOnCPU() || fuseOnCPUWithCompiler()) {
+    return false;
+  }
+  auto type = node->input(0)->type()->cast<TensorType>();
+  if (!type || !type->device() || !type->device()->is_cpu() ||
+      (type->scalarType() != at::kFloat && type->scalarType() != at::kDouble) ||
+      !type->dim() || *type->dim() == 0) {
+    return false;
+  }
+  for (Value* input : node->inputs().slice(1)) {
+    if (input->type()->isSubtypeOf(TensorType::get()) ||
+        input->type()->isSubtypeOf(FloatType::get())) {
+      continue;
+    }
+    if (input->node()->kind() != prim::Constant) {
+      return false;
+    }
+  }
+  const int64_t last_dim = static_cast<int64_t>(*type->dim()) - 1;
+  auto isLastDim = [&](int64_t dim) { return dim == -1 || dim == last_dim; };
+  if (is_reduction) {
+    auto dims = node->get<c10::List<int64_t>>(attr::dim).value();
+    return dims.size() == 1 && isLastDim(dims.get(0)) &&
+        node->get<bool>(attr::keepdim).value() &&
+        node->namedInput(attr::dtype)->node()->mustBeNone();
+  }
+  if (node->kind() == aten::layer_norm) {
+    return node->get<c10::List<int64_t>>(attr::normalized_shape)
+               .value()
+               .size() == 1;
+  }
+  return isLastDim(node->get<int64_t>(attr::dim).value()) &&
+      node->namedInput(attr::dtype)->node()->mustBeNone();
+}
+
 Value* broadcastSizes(at::ArrayRef<Value*> sizes) {
   AT_ASSERT(!sizes.empty());
   Graph* graph = sizes[0]->owningGraph();
@@ -199,7 +260,7 @@ struct GraphFuser {
         fusableDevice &= isFusableDevice(output);
       }
     }
-    return fusableDevice && isFusableMap(node);
+    return fusableDevice && (isFusableMap(node) || isFusableRowwise(node));
   }
 
   bool isFusableMap(Node* node) {
@@ -210,6 +271,11 @@ struct GraphFuser {
     return node->kind() == prim::FusionGroup || isSimpleMap(node);
   }
 
+  bool isFusableRowwise(Node* node) {
+    return node->owningBlock() == block_ && kind_ == prim::FusionGroup &&
+        isRowwise(node);
+  }
+
   bool isFusableCatNode(Node* node) {
     if (node->kind() != aten::cat)
       return false;
@@ -237,6 +303,14 @@ struct GraphFuser {
     return node->matches("aten::size(Tensor self) -> int[]");
   }
 
+  bool allUsersAreThisConsumer(Node* consumer, Value* producer) {
+    for (auto u : producer->uses()) {
+      if (u.user != consumer)
+        return false;
+    }
+    return true;
+  }
+
   bool allUsersAreThisConsumerOrCalcSizes(Node* consumer, Value* producer) {
     auto defining_node = producer->node();
     for (auto o : defining_node->outputs()) {
@@ -415,6 +489,10 @@ struct GraphFuser {
     // but this requires better handling of merging fusion groups so it is not
     // done now
     bool shouldFuse = isFusable(producer->node()) &&
+        // Row reductions have a different shape than the group, they can't
+        // be its outputs.
+        (!isRowReduction(producer->node()) ||
+         allUsersAreThisConsumer(consumer, producer)) &&
         // Rearrange nodes such that all uses of producer are after the
         // consumer. Fusion will rewrite those later uses to use the version of
         // producer generated by the fused blob. In this case, producer becomes
@@ -832,7 +910,8 @@ struct GraphFuser {
 
   // returns where to continue scanning, and whether any fusion was made
   std::pair<graph_node_list::iterator, bool> scanNode(Node* consumer) {
-    if (isFusable(consumer)) {
+    // Row reductions are only fused into the groups using them.
+    if (isFusable(consumer) && !isRowReduction(consumer)) {
       // handle inputs in reverse topological order as well...
       // otherwise in f(a,a+b) it will appear a is used twice if we consider
       // the f-a fusion before the f-(a+b) fusion first.
@@ -941,6 +1020,11 @@ struct GraphFuser {
       if (n->kind() == prim::Constant) {
         continue;
       }
+      // The shapes of row reductions, and of the values computed from them,
+      // are not broadcasts of the input shapes, so their queries are kept.
+      if (isRowReduction(n)) {
+        continue;
+      }
       if (n->kind() == prim::ConstantChunk) {
         Node* sizes_node = graph->insertNode(
             graph->create(prim::ChunkSizes, shape_of.at(n->input()), 2));
@@ -960,6 +1044,12 @@ struct GraphFuser {
       auto tensor_inputs = filter(n->inputs(), [](Value* v) {
         return v->type()->isSubtypeOf(TensorType::get());
       });
+      if (std::any_of(
+              tensor_inputs.begin(), tensor_inputs.end(), [&](Value* v) {
+                return shape_of.count(v) == 0;
+              })) {
+        continue;
+      }
       auto shapes =
           fmap(tensor_inputs, [&](Value* v) { return shape_of.at(v); });
       AT_ASSERT(!shapes.empty());
@@ -1001,7 +1091,7 @@ struct GraphFuser {
   }
 
   bool canFuseWithConcat(Value* producer, Node* before_check) {
-    if (!isFusable(producer->node())) {
+    if (!isFusable(producer->node()) || isRowReduction(producer->node())) {
       return false;
     }
     // NB: it is important that this check happens after isFusable, which checks
@@ -184,6 +184,18 @@ struct GuardElimination {
     return all_inputs_guarded;
   }
 
+  // `constantArguments` checks that all the inputs of `n` but the first,
+  // the tensor it runs on, are `prim::Constant`
+  bool constantArguments(Node* n) {
+    for (size_t i = 1; i < n->inputs().size(); i++) {
+      if (n->input(i)->node()->kind() != prim::Constant) {
+        GRAPH_DEBUG("argument ", n->input(i)->debugName(), " isn't constant");
+        return false;
+      }
+    }
+    return true;
+  }
+
 private:
   // `removableGuard` relies on the properties checked by `isSummarized()`
   // and passes shouldn't insert nodes between a guard and its uses that
@@ -246,7 +258,56 @@ private:
     case aten::rand_like:
     case aten::erf:
     case aten::erfc:
+    case aten::exp:
+    case aten::expm1:
+    case aten::log:
+    case aten::log1p:
+    case aten::log2:
+    case aten::log10:
+    case aten::sqrt:
+    case aten::rsqrt:
+    case aten::reciprocal:
+    case aten::sin:
+    case aten::cos:
+    case aten::tan:
+    case aten::asin:
+    case aten::acos:
+    case aten::atan:
+    case aten::sinh:
+    case aten::cosh:
+    case aten::floor:
+    case aten::ceil:
+    case aten::round:
+    case aten::trunc:
+    case aten::frac:
+    case aten::atan2:
+    case aten::remainder:
+    case aten::fmod:
+    case aten::where:
+    case aten::lerp:
+    case aten::addcmul:
+    case aten::addcdiv:
+    case aten::leaky_relu:
+    case aten::hardtanh:
+    case aten::elu:
+    case aten::gelu:
+    case aten::softplus:
+    case aten::bmm:
+    case aten::matmul:
+    case aten::addmm:
+    case aten::linear:
       return checkInputs(n, no_exceptions);
+    // the dims and dtypes these take decide the types of their outputs, so
+    // they must be constants rather than any number
+    case aten::softmax:
+    case aten::log_softmax:
+    case aten::transpose:
+    case aten::unsqueeze:
+    case aten::squeeze:
+    case aten::permute:
+    case aten::sum:
+    case aten::mean:
+      return checkInputs(n, no_exceptions) && constantArguments(n);
     case aten::slice:
       return !n->input(0)->type()->expect<TensorType>()->isSummarized() &&
              // check that the dimension argument is constant
@@ -0,0 +1,182 @@
+#include <torch/csrc/jit/passes/loop_invariant_code_motion.h>
+
+#include <torch/csrc/jit/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/utils/memory.h>
+
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isTrueConstant(Value* val) {
+  c10::optional<bool> maybe_value = constant_as<bool>(val);
+  return maybe_value && *maybe_value;
+}
+
+// Collects the loops of block, inner loops before the loops that contain them
+void collectLoops(Block* block, std::vector<Node*>& loops) {
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      collectLoops(b, loops);
+    }
+    if (n->kind() == prim::Loop) {
+      loops.push_back(n);
+    }
+  }
+}
+
+bool isInBlock(Node* n, Block* block) {
+  Block* b = n->owningBlock();
+  while (b && b != block) {
+    b = b->owningNode() ? b->owningNode()->owningBlock() : nullptr;
+  }
+  return b == block;
+}
+
+// Whether running n, and the nodes of its blocks, once instead of at every
+// iteration computes the same values
+bool isPure(Node* n, const AliasDb& aliasDb) {
+  if (n->hasSideEffects() || n->isNondeterministic() ||
+      aliasDb.isMutable(n) || aliasDb.hasWriters(n)) {
+    return false;
+  }
+  for (Block* b : n->blocks()) {
+    for (Node* inner : b->nodes()) {
+      if (!isPure(inner, aliasDb)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether n, or a node of its blocks, reads one of the values of variant
+bool readsAny(Node* n, const std::unordered_set<Value*>& variant) {
+  for (Value* v : n->inputs()) {
+    if (variant.count(v)) {
+      return true;
+    }
+  }
+  for (Block* b : n->blocks()) {
+    for (Node* inner : b->nodes()) {
+      if (readsAny(inner, variant)) {
+        return true;
+      }
+    }
+    for (Value* v : b->outputs()) {
+      if (variant.count(v)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Moves the loop invariant nodes of the body of loop before it, and returns
+// whether there were any
+bool hoistInvariants(Node* loop, const AliasDb& aliasDb) {
+  Graph* graph = loop->owningGraph();
+  Block* body = loop->blocks().at(0);
+
+  // The values that may differ between iterations
+  std::unordered_set<Value*> variant(
+      body->inputs().begin(), body->inputs().end());
+  std::vector<Node*> invariants;
+  std::vector<Node*> constants;
+  for (Node* n : body->nodes()) {
+    // Constants can't throw, and are moved out of the guard so that the
+    // passes that look for them still find them
+    if (n->kind() == prim::Constant) {
+      constants.push_back(n);
+      continue;
+    }
+    // The values of a node that is run once are shared by every iteration,
+    // which the caller would see if they are returned
+    if (!readsAny(n, variant) && isPure(n, aliasDb) &&
+        !aliasDb.mayContainAlias(n->outputs(), graph->outputs())) {
+      invariants.push_back(n);
+    } else {
+      variant.insert(n->outputs().begin(), n->outputs().end());
+    }
+  }
+  if (invariants.empty()) {
+    return false;
+  }
+  for (Node* n : constants) {
+    n->moveBefore(loop);
+  }
+
+  c10::optional<int64_t> trip_count = constant_as<int64_t>(loop->input(0));
+  if (trip_count && *trip_count > 0 && isTrueConstant(loop->input(1))) {
+    for (Node* n : invariants) {
+      GRAPH_UPDATE("Hoisting ", getHeader(n), " out of ", getHeader(loop));
+      n->moveBefore(loop);
+    }
+    return true;
+  }
+
+  // The loop may not run, e.g. a decoder loop that stops at the first token,
+  // and the hoisted nodes must then not run either, as they may throw
+  WithInsertPoint guard(loop);
+  Value* runs = graph->insert(aten::gt, {loop->input(0), 0});
+  if (!isTrueConstant(loop->input(1))) {
+    runs = graph->insert(aten::__and__, {runs, loop->input(1)});
+  }
+  Node* if_node = graph->insertNode(graph->create(prim::If, {runs}, 0));
+  Block* then_block = if_node->addBlock();
+  Block* else_block = if_node->addBlock();
+  for (Node* n : invariants) {
+    GRAPH_UPDATE("Hoisting ", getHeader(n), " out of ", getHeader(loop));
+    n->moveBefore(then_block->return_node());
+  }
+  for (Node* n : invariants) {
+    for (Value* output : n->outputs()) {
+      std::vector<Use> body_uses;
+      for (const Use& use : output->uses()) {
+        if (!isInBlock(use.user, then_block)) {
+          body_uses.push_back(use);
+        }
+      }
+      if (body_uses.empty()) {
+        continue;
+      }
+      then_block->registerOutput(output);
+      else_block->registerOutput(
+          graph->createUninitialized(output->type())
+              ->insertBefore(else_block->return_node())
+              ->output());
+      Value* guarded = if_node->addOutput()->copyMetadata(output);
+      for (const Use& use : body_uses) {
+        use.user->replaceInput(use.offset, guarded);
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> loops;
+  collectLoops(graph->block(), loops);
+  if (loops.empty()) {
+    return;
+  }
+  GRAPH_DUMP("Before hoisting loop invariants", graph);
+  // The nodes that guard hoisted nodes are new to the alias analysis, so it is
+  // redone after a loop changes
+  auto aliasDb = torch::make_unique<AliasDb>(graph);
+  for (Node* loop : loops) {
+    if (hoistInvariants(loop, *aliasDb)) {
+      aliasDb = torch::make_unique<AliasDb>(graph);
+    }
+  }
+  GRAPH_DUMP("After hoisting loop invariants", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Moves the nodes of loop bodies that compute the same values at every
+// iteration, e.g. the transpose of a weight or the construction of a mask,
+// before their loops. A node is hoisted when its inputs are defined outside the
+// loop or by hoisted nodes, and when it has no side effects, is deterministic,
+// and neither it nor the values it reads are written. Unless the loop is known
+// to run at least once, the hoisted nodes are guarded by a prim::If on its trip
+// count and initial condition, so that they run exactly when they did before.
+// Inner loops are handled first, so a node can be hoisted out of nested loops.
+TORCH_API void HoistLoopInvariants(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,479 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <torch/csrc/jit/constants.h>
+#include <torch/csrc/jit/custom_operator.h>
+#include <torch/csrc/jit/operator.h>
+#include <torch/csrc/jit/passes/liveness.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+c10::OperatorOptions aliasAnalysisFromSchema() {
+  c10::OperatorOptions result;
+  result.setAliasAnalysis(c10::AliasAnalysisKind::FROM_SCHEMA);
+  return result;
+}
+
+// Offsets of planned tensors are aligned to this many bytes, which is what
+// the CPU allocator aligns to as well.
+constexpr int64_t kPlanAlignment = 64;
+
+// Hands out the buffer of a planned graph. The buffer is kept between calls
+// and handed out again once nothing of the previous call refers to it
+// anymore; concurrent calls get a buffer of their own.
+class PlannedStorage {
+ public:
+  explicit PlannedStorage(int64_t nbytes) : nbytes_(nbytes) {}
+
+  at::Tensor get() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // New references to buffer_ are only ever created from this one or from
+    // references created from it while it was handed out, so once we hold
+    // the only reference, no one else can get hold of the buffer.
+    if (buffer_.defined() && buffer_.use_count() == 1) {
+      return buffer_;
+    }
+    auto buffer = at::empty({nbytes_}, at::kByte);
+    if (!buffer_.defined()) {
+      buffer_ = buffer;
+    }
+    return buffer;
+  }
+
+ private:
+  int64_t nbytes_;
+  std::mutex mutex_;
+  at::Tensor buffer_;
+};
+
+RegisterOperators reg_ops(
+    {Operator(
+         "prim::AllocateStorage() -> Tensor",
+         [](const Node* node) -> Operation {
+           auto storage = std::make_shared<PlannedStorage>(node->i(attr::size));
+           return [storage](Stack& stack) {
+             push(stack, storage->get());
+             return 0;
+           };
+         },
+         aliasAnalysisFromSchema()),
+     Operator(
+         "prim::AllocateTensor(Tensor(a) buffer) -> Tensor(a)",
+         [](const Node* node) -> Operation {
+           int64_t offset = node->i(attr::offset);
+           std::vector<int64_t> sizes = node->is(attr::size);
+           auto dtype = static_cast<at::ScalarType>(node->i(attr::dtype));
+           return [offset, sizes, dtype](Stack& stack) {
+             at::Tensor buffer = pop(stack).toTensor();
+             void* data = static_cast<uint8_t*>(buffer.data_ptr()) + offset;
+             // The tensor keeps the buffer alive. Its storage is not
+             // resizable, so an out= kernel cannot reallocate it.
+             push(
+                 stack,
+                 at::from_blob(
+                     data,
+                     sizes,
+                     [buffer](void*) {},
+                     at::device(at::kCPU).dtype(dtype)));
+             return 0;
+           };
+         },
+         aliasAnalysisFromSchema())});
+
+bool hasAliasInfo(const FunctionSchema& schema) {
+  for (const auto& arg : schema.arguments()) {
+    if (arg.alias_info()) {
+      return true;
+    }
+  }
+  for (const auto& ret : schema.returns()) {
+    if (ret.alias_info()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool aliasesFromSchema(const Operator& op) {
+  return op.aliasAnalysisKind() == c10::AliasAnalysisKind::FROM_SCHEMA ||
+      op.aliasAnalysisKind() == c10::AliasAnalysisKind::PURE_FUNCTION;
+}
+
+// Returns the out= overload of `schema`, i.e. the one that takes the same
+// arguments plus a trailing `Tensor(a!) out` and returns it.
+const Operator* findOutVariant(Symbol kind, const FunctionSchema& schema) {
+  const auto& args = schema.arguments();
+  for (const auto& op : getAllOperatorsFor(kind)) {
+    const FunctionSchema& candidate = op->schema();
+    const auto& candidate_args = candidate.arguments();
+    if (candidate.is_vararg() || candidate.returns().size() != 1 ||
+        candidate_args.size() != args.size() + 1) {
+      continue;
+    }
+    const Argument& out = candidate_args.back();
+    if (out.name() != "out" || *out.type() != *TensorType::get() ||
+        !out.alias_info() || !out.alias_info()->isWrite()) {
+      continue;
+    }
+    bool same_args = true;
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (candidate_args[i].name() != args[i].name() ||
+          *candidate_args[i].type() != *args[i].type()) {
+        same_args = false;
+        break;
+      }
+    }
+    if (same_args) {
+      return op.get();
+    }
+  }
+  return nullptr;
+}
+
+struct PlannedValue {
+  Value* value;
+  const Operator* out_variant;
+  std::vector<int64_t> sizes;
+  at::ScalarType dtype;
+  int64_t nbytes;
+  // Live range, as indices of the nodes of the top-level block.
+  size_t begin;
+  size_t end;
+  int64_t offset;
+};
+
+class MemoryPlanner {
+ public:
+  explicit MemoryPlanner(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  bool run() {
+    computeLiveRanges();
+    for (Node* node : graph_->nodes()) {
+      maybePlan(node);
+    }
+    if (planned_.empty()) {
+      return false;
+    }
+    int64_t nbytes = assignOffsets();
+    rewrite(nbytes);
+    return true;
+  }
+
+ private:
+  void computeLiveRanges() {
+    auto liveness = BuildLivenessSets(graph_);
+    size_t index = 0;
+    for (Node* node : graph_->nodes()) {
+      index_[node] = index;
+      // Values used in nested blocks are live at the node owning the block.
+      for (Value* v : liveness[node]) {
+        last_use_[v] = index;
+      }
+      ++index;
+    }
+  }
+
+  // Returns the index of the last node using `v` or anything that contains
+  // it, or nullopt if some use may keep a reference to it beyond that, e.g.
+  // by returning a view of it, storing it or returning it from the graph.
+  c10::optional<size_t> lastUse(Value* v, size_t def) {
+    size_t last = std::max(def, last_use_[v]);
+    for (const Use& use : v->uses()) {
+      Node* user = use.user;
+      if (user->kind() == prim::ListConstruct ||
+          user->kind() == prim::TupleConstruct) {
+        if (user->owningBlock() != graph_->block()) {
+          return c10::nullopt;
+        }
+        auto container_last = lastUse(user->output(), index_[user]);
+        if (!container_last) {
+          return c10::nullopt;
+        }
+        last = std::max(last, *container_last);
+        continue;
+      }
+      const Operator* op = user->maybeOperator();
+      if (!op || !aliasesFromSchema(*op) || op->schema().is_vararg() ||
+          use.offset >= op->schema().arguments().size() ||
+          op->schema().arguments()[use.offset].alias_info()) {
+        return c10::nullopt;
+      }
+    }
+    return last;
+  }
+
+  void maybePlan(Node* node) {
+    if (node->outputs().size() != 1 || node->blocks().size() > 0) {
+      return;
+    }
+    const Operator* op = node->maybeOperator();
+    if (!op || !aliasesFromSchema(*op) || hasAliasInfo(op->schema())) {
+      return;
+    }
+    Value* v = node->output();
+    auto type = v->type()->cast<TensorType>();
+    if (!type || !type->scalarType() || !type->device() ||
+        !type->device()->is_cpu() ||
+        (type->requiresGrad() && *type->requiresGrad())) {
+      return;
+    }
+    auto sizes = type->sizes().concrete_sizes();
+    if (!sizes) {
+      return;
+    }
+    const Operator* out_variant = findOutVariant(node->kind(), op->schema());
+    if (!out_variant) {
+      return;
+    }
+    size_t begin = index_[node];
+    auto end = lastUse(v, begin);
+    if (!end) {
+      return;
+    }
+    int64_t numel = 1;
+    for (int64_t size : *sizes) {
+      numel *= size;
+    }
+    int64_t nbytes = numel * c10::elementSize(*type->scalarType());
+    planned_.push_back(PlannedValue{
+        v, out_variant, *sizes, *type->scalarType(), nbytes, begin, *end, 0});
+  }
+
+  // Greedily places the largest tensors first, each at the lowest offset
+  // that does not overlap a placed tensor whose live range overlaps its own.
+  // Returns the size of the buffer.
+  int64_t assignOffsets() {
+    std::vector<PlannedValue*> order;
+    for (auto& p : planned_) {
+      order.push_back(&p);
+    }
+    std::stable_sort(
+        order.begin(), order.end(), [](PlannedValue* a, PlannedValue* b) {
+          return a->nbytes > b->nbytes;
+        });
+
+    int64_t total = 0;
+    std::vector<PlannedValue*> placed;
+    for (PlannedValue* p : order) {
+      std::vector<PlannedValue*> conflicts;
+      for (PlannedValue* q : placed) {
+        if (q->begin <= p->end && p->begin <= q->end) {
+          conflicts.push_back(q);
+        }
+      }
+      std::sort(
+          conflicts.begin(),
+          conflicts.end(),
+          [](PlannedValue* a, PlannedValue* b) { return a->offset < b->offset; });
+      int64_t offset = 0;
+      for (PlannedValue* q : conflicts) {
+        if (offset + p->nbytes <= q->offset) {
+          break;
+        }
+        offset = std::max(offset, roundUp(q->offset + q->nbytes));
+      }
+      p->offset = offset;
+      total = std::max(total, offset + p->nbytes);
+      placed.push_back(p);
+    }
+    return roundUp(total);
+  }
+
+  static int64_t roundUp(int64_t nbytes) {
+    return (nbytes + kPlanAlignment - 1) / kPlanAlignment * kPlanAlignment;
+  }
+
+  void rewrite(int64_t nbytes) {
+    Node* storage = graph_->create(prim::AllocateStorage);
+    storage->i_(attr::size, nbytes);
+    storage->output()->setType(TensorType::get());
+    graph_->prependNode(storage);
+
+    for (const auto& p : planned_) {
+      Node* node = p.value->node();
+      WithInsertPoint guard(node);
+      Node* alloc = graph_->create(prim::AllocateTensor, {storage->output()});
+      alloc->i_(attr::offset, p.offset);
+      alloc->is_(attr::size, p.sizes);
+      alloc->i_(attr::dtype, static_cast<int64_t>(p.dtype));
+      alloc->output()->setType(TensorType::get());
+      graph_->insertNode(alloc);
+
+      std::vector<Value*> inputs = node->inputs().vec();
+      inputs.push_back(alloc->output());
+      Node* out_node = graph_->create(node->kind(), inputs);
+      out_node->setSourceRange(node->sourceRange());
+      out_node->output()->copyMetadata(p.value);
+      graph_->insertNode(out_node);
+      // The node is matched against the overloads by its input types, which
+      // may select another overload than the out= one. Leave such nodes
+      // alone; their slot in the buffer just stays unused.
+      if (out_node->maybeOperator() != p.out_variant) {
+        out_node->destroy();
+        alloc->destroy();
+        continue;
+      }
+
+      p.value->replaceAllUsesWith(out_node->output());
+      node->destroy();
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  std::unordered_map<Node*, size_t> index_;
+  std::unordered_map<Value*, size_t> last_use_;
+  std::vector<PlannedValue> planned_;
+};
+
+// A tensor of a cat that a node can write into the output of the cat
+// through its out= overload, instead of into a tensor of its own.
+struct ConcatInput {
+  Value* value;
+  const Operator* out_variant;
+  int64_t offset;
+  int64_t size;
+};
+
+c10::optional<std::vector<int64_t>> completeSizes(
+    Value* v,
+    at::ScalarType dtype,
+    at::Device device) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type || type->scalarType() != dtype || type->device() != device ||
+      (type->requiresGrad() && *type->requiresGrad())) {
+    return c10::nullopt;
+  }
+  return type->sizes().concrete_sizes();
+}
+
+// Returns the out= overload that `v`'s node can write `v` into the output of
+// a cat with, i.e. if `v` is read by nothing else.
+const Operator* concatOutVariant(Value* v, Node* cat) {
+  Node* node = v->node();
+  if (v->uses().size() != 1 || node->owningBlock() != cat->owningBlock() ||
+      node->outputs().size() != 1 || node->blocks().size() > 0) {
+    return nullptr;
+  }
+  const Operator* op = node->maybeOperator();
+  if (!op || !aliasesFromSchema(*op) || hasAliasInfo(op->schema())) {
+    return nullptr;
+  }
+  return findOutVariant(node->kind(), op->schema());
+}
+
+bool elideConcat(Node* cat) {
+  Graph* graph = cat->owningGraph();
+  Node* list = cat->input(0)->node();
+  auto dim = constant_as<int64_t>(cat->input(1));
+  auto type = cat->output()->type()->cast<TensorType>();
+  if (list->kind() != prim::ListConstruct || cat->input(0)->uses().size() != 1 ||
+      !dim || !type || !type->scalarType() || !type->device()) {
+    return false;
+  }
+  auto sizes =
+      completeSizes(cat->output(), *type->scalarType(), *type->device());
+  if (!sizes || sizes->empty()) {
+    return false;
+  }
+  int64_t rank = sizes->size();
+  if (*dim < 0) {
+    *dim += rank;
+  }
+
+  std::vector<ConcatInput> inputs;
+  int64_t offset = 0;
+  Node* first_elided = nullptr;
+  for (Value* v : list->inputs()) {
+    auto input_sizes = completeSizes(v, *type->scalarType(), *type->device());
+    // cat skips empty 1-d tensors of another rank
+    if (!input_sizes || static_cast<int64_t>(input_sizes->size()) != rank) {
+      return false;
+    }
+    int64_t size = (*input_sizes)[*dim];
+    const Operator* out_variant = concatOutVariant(v, cat);
+    if (out_variant &&
+        (!first_elided || v->node()->isBefore(first_elided))) {
+      first_elided = v->node();
+    }
+    inputs.push_back(ConcatInput{v, out_variant, offset, size});
+    offset += size;
+  }
+  if (!first_elided || offset != (*sizes)[*dim]) {
+    return false;
+  }
+
+  Value* output;
+  {
+    WithInsertPoint guard(first_elided);
+    output = graph->insert(
+        aten::empty,
+        {*sizes},
+        {NamedValue("dtype", static_cast<int64_t>(*type->scalarType())),
+         NamedValue("device", *type->device())});
+    output->copyMetadata(cat->output());
+  }
+  for (const auto& input : inputs) {
+    if (input.out_variant) {
+      Node* node = input.value->node();
+      WithInsertPoint guard(node);
+      Value* slice =
+          graph->insert(aten::narrow, {output, *dim, input.offset, input.size});
+      std::vector<Value*> node_inputs = node->inputs().vec();
+      node_inputs.push_back(slice);
+      Node* out_node = graph->create(node->kind(), node_inputs);
+      out_node->setSourceRange(node->sourceRange());
+      out_node->output()->copyMetadata(input.value);
+      graph->insertNode(out_node);
+      // As in MemoryPlanner::rewrite, the node may match another overload
+      if (out_node->maybeOperator() == input.out_variant) {
+        list->replaceInputWith(input.value, out_node->output());
+        node->destroy();
+        continue;
+      }
+      out_node->destroy();
+      slice->node()->destroy();
+    }
+    WithInsertPoint guard(cat);
+    Value* slice =
+        graph->insert(aten::narrow, {output, *dim, input.offset, input.size});
+    graph->insert(aten::copy_, {slice, input.value});
+  }
+  cat->output()->replaceAllUsesWith(output);
+  cat->destroy();
+  list->destroy();
+  return true;
+}
+
+bool elideConcats(Block* block) {
+  bool changed = false;
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* node = *it++;
+    for (Block* b : node->blocks()) {
+      changed |= elideConcats(b);
+    }
+    if (node->kind() == aten::cat) {
+      changed |= elideConcat(node);
+    }
+  }
+  return changed;
+}
+
+} // namespace
+
+bool ElideConcat(const std::shared_ptr<Graph>& graph) {
+  return elideConcats(graph->block());
+}
+
+bool PlanMemory(const std::shared_ptr<Graph>& graph) {
+  return MemoryPlanner(graph).run();
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Plans the memory of the intermediate tensors of an inference graph whose
+// tensor shapes are known and stable across calls (e.g. after
+// PropagateInputShapes on a graph specialized to its inputs).
+//
+// Every intermediate tensor of the top-level block that
+//  - is produced by an operator with an out= overload,
+//  - has a complete type on the CPU, and
+//  - is only read by its uses, i.e. no view, alias or container of it
+//    outlives its last use,
+// is assigned an offset in a single buffer, such that tensors whose live
+// ranges (from liveness analysis) overlap never share memory. The producing
+// node is rewritten to write into a prim::AllocateTensor view of that buffer
+// through its out= overload. The buffer itself is allocated by a
+// prim::AllocateStorage node at the start of the graph, which hands out the
+// same buffer on every call unless a previous call is still using it.
+//
+// The planned tensors cannot be resized, so running the graph with inputs
+// of other shapes than the ones it was planned for raises an error.
+//
+// Returns true if any tensor was planned.
+TORCH_API bool PlanMemory(const std::shared_ptr<Graph>& graph);
+
+// Removes the copies of the aten::cat nodes of a graph whose tensor shapes are
+// known and stable across calls, like the ones PlanMemory plans.
+//
+// The output of a cat of a prim::ListConstruct, along a constant dim, is
+// allocated up front. Every input of the cat that
+//  - is produced by an operator with an out= overload in the same block, and
+//  - is only read by the cat
+// is written into its aten::narrow slice of the output by the out= overload of
+// its producer. The other inputs are copied into their slices, which is what
+// the cat did. A cat is only rewritten if at least one of its inputs is
+// written in place, and if it and its inputs have complete types of the same
+// dtype and device.
+//
+// As with PlanMemory, running the graph with inputs of other shapes than the
+// ones it was specialized to is an error: the out= kernels would resize the
+// slices instead of writing into the output.
+//
+// Returns true if any cat was removed.
+TORCH_API bool ElideConcat(const std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
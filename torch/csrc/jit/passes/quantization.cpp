@@ -13,6 +13,7 @@
 #include <torch/csrc/jit/script/schema_matching.h>
 #include <torch/csrc/jit/subgraph_matcher.h>
 
+#include <ATen/core/dispatch/Dispatcher.h>
 #include <c10/core/QScheme.h>
 
 #include <algorithm>
@@ -425,6 +426,33 @@ graph(%self, %input):
     %relu = match::module[name="ReLU"](%self)
     %r = prim::CallMethod[name="forward"](%relu, %intermediate_val)
     return (%r) )");
+  const PatternInfo linear_functional_relu = PatternInfo::parse_from_str(R"(
+graph(%self, %input, %inplace):
+    %relu = prim::Constant[name="relu"]()
+    %linear = match::module[name="Linear"](%self)
+    %intermediate_val = prim::CallMethod[name="forward"](%linear, %input)
+    %r = prim::CallFunction(%relu, %intermediate_val, %inplace)
+    return (%r) )");
+  const PatternInfo linear_relu_module = PatternInfo::parse_from_str(R"(
+graph(%self, %input):
+    %linear = match::module[name="Linear"](%self)
+    %intermediate_val = prim::CallMethod[name="forward"](%linear, %input)
+    %relu = match::module[name="ReLU"](%self)
+    %r = prim::CallMethod[name="forward"](%relu, %intermediate_val)
+    return (%r) )");
+  // The residual add of a ResNet block, the conv before it is still observed
+  const PatternInfo add_functional_relu = PatternInfo::parse_from_str(R"(
+graph(%a, %b, %alpha, %inplace):
+    %relu = prim::Constant[name="relu"]()
+    %intermediate_val = aten::add_(%a, %b, %alpha)
+    %r = prim::CallFunction(%relu, %intermediate_val, %inplace)
+    return (%r) )");
+  const PatternInfo add_relu_module = PatternInfo::parse_from_str(R"(
+graph(%self, %a, %b, %alpha):
+    %intermediate_val = aten::add_(%a, %b, %alpha)
+    %relu = match::module[name="ReLU"](%self)
+    %r = prim::CallMethod[name="forward"](%relu, %intermediate_val)
+    return (%r) )");
   const PatternInfo matmul_add = PatternInfo::parse_from_str(R"(
 graph(%input, %weight, %bias, %4):
      %weight_t = aten::t(%weight)
@@ -434,6 +462,10 @@ graph(%input, %weight, %bias, %4):
   const std::vector<std::reference_wrapper<const PatternInfo>> patterns = {
       conv_functional_relu,
       conv_relu_module,
+      linear_functional_relu,
+      linear_relu_module,
+      add_functional_relu,
+      add_relu_module,
       matmul_add};
 };
 
@@ -1618,10 +1650,21 @@ void FoldQuantNodesIntoInputsOutputs(std::shared_ptr<Graph>& graph) {
 }
 
 void QuantFusion(std::shared_ptr<Graph>& graph) {
+  // quantized::add has no alpha, patterns with an add only match alpha = 1
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    if (!vmap.count("alpha")) {
+      return true;
+    }
+    auto alpha = getIValue("alpha", match.values_map, vmap);
+    return alpha.has_value() &&
+        ((alpha->isInt() && alpha->toInt() == 1) ||
+         (alpha->isDouble() && alpha->toDouble() == 1.0));
+  };
   for (const auto& item : quant_fusion_pattern_and_replacements()) {
     SubgraphRewriter rewriter;
     rewriter.RegisterRewritePattern(item.first, item.second);
-    rewriter.runOnGraph(graph);
+    rewriter.runOnGraph(graph, filter);
   }
 }
 
@@ -1893,5 +1936,308 @@ void DedupModuleUses(script::Module& module) {
   d.dedup();
 }
 
+namespace {
+
+bool isQuantizedOp(const Node* n) {
+  static const auto quantized_ns = Symbol::fromQualString("namespaces::quantized");
+  return n->kind().ns() == quantized_ns;
+}
+
+bool producesQuantizedTensor(const Node* n) {
+  return isQuantizedOp(n) || n->kind() == Symbol::aten("quantize_per_tensor");
+}
+
+void removeContiguousBetweenQuantizedOps(Block* block) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* n = *it++;
+    for (Block* sub_block : n->blocks()) {
+      removeContiguousBetweenQuantizedOps(sub_block);
+    }
+    if (n->kind() != aten::contiguous ||
+        !producesQuantizedTensor(n->input(0)->node())) {
+      continue;
+    }
+    const auto& uses = n->output()->uses();
+    const bool only_quantized_uses =
+        std::all_of(uses.begin(), uses.end(), [](const Use& use) {
+          return isQuantizedOp(use.user);
+        });
+    if (!only_quantized_uses) {
+      continue;
+    }
+    GRAPH_UPDATE(
+        "Removing ", n->output()->debugName(), " = aten::contiguous(",
+        n->input(0)->debugName(), ")");
+    n->output()->replaceAllUsesWith(n->input(0));
+    n->destroy();
+  }
+}
+
+} // namespace
+
+void PropagateQuantizedMemoryFormat(std::shared_ptr<Graph>& graph) {
+  removeContiguousBetweenQuantizedOps(graph->block());
+}
+
+namespace {
+
+// Elementwise ops with quantized kernels whose output only depends on the
+// value of the element, the first input.
+bool isLUTComposable(const Node* n) {
+  static const std::vector<Symbol> unary_ops = {
+      Symbol::aten("relu"),
+      Symbol::aten("sigmoid"),
+      Symbol::aten("tanh"),
+      Symbol::aten("leaky_relu"),
+      Symbol::aten("clamp"),
+      Symbol::fromQualString("quantized::clamp"),
+  };
+  if (std::find(unary_ops.begin(), unary_ops.end(), n->kind()) !=
+      unary_ops.end()) {
+    return true;
+  }
+  // The in-place variant would write to the input of the chain
+  if (n->kind() == Symbol::fromQualString("quantized::relu6")) {
+    auto inplace = toIValue(n->input(1));
+    return inplace && inplace->isBool() && !inplace->toBool();
+  }
+  return false;
+}
+
+// The ops from `start` on that can be composed into one table, see
+// Note [Quantized lookup tables]. All but the last output are only used by
+// the next op of the chain.
+std::vector<Node*> findLUTChain(Node* start) {
+  std::vector<Node*> chain = {start};
+  while (true) {
+    Value* out = chain.back()->output();
+    if (out->uses().size() != 1) {
+      break;
+    }
+    const Use& use = out->uses()[0];
+    if (use.offset != 0 || !isLUTComposable(use.user)) {
+      break;
+    }
+    chain.push_back(use.user);
+  }
+  return chain;
+}
+
+void fuseLUTChain(
+    Value* input,
+    const std::vector<Node*>& chain,
+    std::shared_ptr<Graph>& graph) {
+  Node* last = chain.back();
+  WithInsertPoint guard(last);
+  Value* domain =
+      graph->insert(Symbol::fromQualString("quantized::lut_domain"), {input});
+  // Run the chain on the 256 values of the domain instead
+  std::unordered_map<Value*, Value*> value_map = {{input, domain}};
+  for (Node* n : chain) {
+    Node* clone = graph->insertNode(graph->createClone(
+        n, [&](Value* v) { return value_map.count(v) ? value_map[v] : v; }));
+    value_map[n->output()] = clone->output();
+  }
+  Value* output = graph->insert(
+      Symbol::fromQualString("quantized::apply_lut"),
+      {input, value_map.at(last->output())});
+  GRAPH_UPDATE(
+      "Fusing ",
+      chain.size(),
+      " ops after ",
+      input->debugName(),
+      " into a lookup table");
+  last->output()->replaceAllUsesWith(output);
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    (*it)->destroy();
+  }
+}
+
+void fuseLUTChains(Block* block, std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> seeds;
+  for (Node* n : block->nodes()) {
+    for (Block* sub_block : n->blocks()) {
+      fuseLUTChains(sub_block, graph);
+    }
+    if (producesQuantizedTensor(n) && n->outputs().size() == 1) {
+      seeds.push_back(n);
+    }
+  }
+  // Ops of a fused chain can be seeds themselves, e.g. quantized::clamp
+  std::unordered_set<Node*> fused;
+  for (Node* seed : seeds) {
+    if (fused.count(seed)) {
+      continue;
+    }
+    Value* input = seed->output();
+    std::vector<Node*> starts;
+    for (const Use& use : input->uses()) {
+      if (use.offset == 0 && use.user->owningBlock() == block &&
+          isLUTComposable(use.user)) {
+        starts.push_back(use.user);
+      }
+    }
+    for (Node* start : starts) {
+      std::vector<Node*> chain = findLUTChain(start);
+      if (chain.size() < 2) {
+        continue;
+      }
+      fused.insert(chain.begin(), chain.end());
+      fuseLUTChain(input, chain, graph);
+    }
+  }
+}
+
+} // namespace
+
+void FuseQuantizedLUTChains(std::shared_ptr<Graph>& graph) {
+  fuseLUTChains(graph->block(), graph);
+}
+
+namespace {
+
+void findNodes(Block* block, Symbol kind, std::vector<Node*>& nodes) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == kind) {
+      nodes.push_back(n);
+    }
+    for (Block* sub_block : n->blocks()) {
+      findNodes(sub_block, kind, nodes);
+    }
+  }
+}
+
+bool usesAttribute(Block* block, const std::string& name) {
+  std::vector<Node*> get_attrs;
+  findNodes(block, prim::GetAttr, get_attrs);
+  return std::any_of(get_attrs.begin(), get_attrs.end(), [&](Node* n) {
+    return n->s(attr::name) == name;
+  });
+}
+
+// Whether `n` is an embedding_bag on the weight of the module its graph
+// belongs to, which quantized::embedding_bag_* can compute
+bool isQuantizableEmbeddingBag(Node* n, Graph& graph) {
+  Node* weight = n->input(0)->node();
+  if (weight->kind() != prim::GetAttr || weight->s(attr::name) != "weight" ||
+      weight->input(0) != graph.inputs()[0]) {
+    return false;
+  }
+  // Only the sum and the mean are supported, and only the bags themselves
+  // are computed.
+  auto mode = toIValue(n->input(4));
+  if (!mode || !mode->isInt() || (mode->toInt() != 0 && mode->toInt() != 1)) {
+    return false;
+  }
+  return std::none_of(
+      n->outputs().begin() + 1, n->outputs().end(), [](Value* v) {
+        return v->hasUses();
+      });
+}
+
+// F.embedding_bag swaps its arguments depending on the dtype of the weight,
+// so the weight only reaches aten::embedding_bag through a prim::If. The
+// dtype of the weight is known here, folding it lets constant propagation
+// remove the If (and the checks of the mode, a constant of the module).
+void specializeWeightDtype(Graph& graph, const at::Tensor& weight) {
+  std::vector<Node*> dtypes;
+  findNodes(graph.block(), prim::dtype, dtypes);
+  for (Node* n : dtypes) {
+    Node* get_attr = n->input()->node();
+    if (get_attr->kind() != prim::GetAttr ||
+        get_attr->s(attr::name) != "weight" ||
+        get_attr->input() != graph.inputs()[0]) {
+      continue;
+    }
+    WithInsertPoint guard(n);
+    n->output()->replaceAllUsesWith(graph.insertConstant(
+        static_cast<int64_t>(weight.scalar_type())));
+    n->destroy();
+  }
+}
+
+} // namespace
+
+void QuantizeEmbeddingBag(script::Module& module, bool use_4bit) {
+  const std::string packed_name = "_packed_weight";
+  const auto lookup = Symbol::fromQualString(
+      use_4bit ? "quantized::embedding_bag_4bit"
+               : "quantized::embedding_bag_byte");
+  at::Tensor weight;
+  if (module.hasattr("weight") && module.attr("weight").isTensor()) {
+    weight = module.attr("weight").toTensor().detach();
+  }
+  const bool weight_quantizable = weight.defined() &&
+      weight.scalar_type() == at::kFloat && weight.dim() == 2 &&
+      (!use_4bit || weight.size(1) % 2 == 0);
+  bool packed = false;
+  for (auto& method : module.get_methods()) {
+    if (!weight_quantizable) {
+      break;
+    }
+    auto graph = method.graph();
+    std::vector<Node*> embedding_bags;
+    findNodes(graph->block(), aten::embedding_bag, embedding_bags);
+    if (embedding_bags.empty()) {
+      continue;
+    }
+    specializeWeightDtype(*graph, weight);
+    ConstantPropagation(graph);
+    embedding_bags.clear();
+    findNodes(graph->block(), aten::embedding_bag, embedding_bags);
+    for (Node* n : embedding_bags) {
+      if (!isQuantizableEmbeddingBag(n, *graph)) {
+        continue;
+      }
+      if (!packed) {
+        static const auto byte_prepack =
+            c10::Dispatcher::singleton().findSchemaOrThrow(
+                "quantized::embedding_bag_byte_prepack", "");
+        static const auto prepack_4bit =
+            c10::Dispatcher::singleton().findSchemaOrThrow(
+                "quantized::embedding_bag_4bit_prepack", "");
+        const auto& prepack = use_4bit ? prepack_4bit : byte_prepack;
+        module.register_buffer(
+            packed_name, prepack.callUnboxed<at::Tensor, at::Tensor>(weight));
+        packed = true;
+      }
+      Node* get_weight = n->input(0)->node();
+      WithInsertPoint guard(n);
+      Value* packed_weight =
+          graph->insertGetAttr(graph->inputs()[0], packed_name);
+      Value* output = graph->insert(
+          lookup,
+          {packed_weight,
+           n->input(1),
+           n->input(2),
+           n->input(4),
+           n->input(6),
+           n->input(7)});
+      GRAPH_UPDATE(
+          "Replacing ", n->output(0)->debugName(), " by ", output->debugName());
+      n->output(0)->replaceAllUsesWith(output);
+      n->destroy();
+      if (!get_weight->output()->hasUses()) {
+        get_weight->destroy();
+      }
+    }
+  }
+  // Drop the float table once nothing reads it any more, this is where the
+  // memory is saved.
+  if (packed) {
+    const auto methods = module.get_methods();
+    const bool weight_used =
+        std::any_of(methods.begin(), methods.end(), [](const script::Method& m) {
+          return usesAttribute(m.graph()->block(), "weight");
+        });
+    if (!weight_used) {
+      module._ivalue()->setAttr("weight", at::empty({0}));
+    }
+  }
+  for (script::Module child : module.children()) {
+    QuantizeEmbeddingBag(child, use_4bit);
+  }
+}
+
 } // namespace jit
 } // namespace torch
@@ -171,5 +171,39 @@ TORCH_API void FoldPrepackedWeightIntoModule(
  */
 TORCH_API void DedupModuleUses(script::Module& module);
 
+/** \brief Keep the memory format of quantized tensors between quantized ops
+ *
+ *  The quantized CPU kernels accept inputs in either memory format and keep
+ *  it in their outputs, so the channels last output of a quantized conv can
+ *  flow through the whole model. An `aten::contiguous` between quantized ops
+ *  would only convert it back to NCHW, and the next conv back to NHWC. This
+ *  pass removes such calls if their input comes from a quantized op (or
+ *  `aten::quantize_per_tensor`) and all of their uses are quantized ops.
+ */
+TORCH_API void PropagateQuantizedMemoryFormat(std::shared_ptr<Graph>& graph);
+
+/** \brief Compose chains of elementwise quantized ops into lookup tables
+ *
+ *  A chain of two or more elementwise ops (relu, relu6, leaky_relu, clamp,
+ *  sigmoid, tanh) on the output of a quantized op can produce only 256
+ *  different values. The pass runs the chain on those 256 values instead,
+ *  and replaces it by a single `quantized::apply_lut` pass over the tensor.
+ */
+TORCH_API void FuseQuantizedLUTChains(std::shared_ptr<Graph>& graph);
+
+/** \brief Quantize the tables of embedding bags rowwise
+ *
+ *  For every method of the module and its submodules, replaces the
+ * `aten::embedding_bag` calls on the "weight" of the module by
+ * `quantized::embedding_bag_byte` (or `quantized::embedding_bag_4bit` if
+ * `use_4bit` is set) calls on a new "_packed_weight" buffer, which holds the
+ * weight packed by the corresponding prepack op. Only the sum and mean modes
+ * are supported, and calls whose offset2bag, bag_size or max_indices outputs
+ * are used are left as they are. The dtype of the weight is folded into the
+ * graphs with an embedding bag and constants are propagated. The float weight
+ * is replaced by an empty tensor if no method reads it any more.
+ */
+TORCH_API void QuantizeEmbeddingBag(script::Module& module, bool use_4bit);
+
 } // namespace jit
 } // namespace torch
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace torch {
 namespace jit {
 
-std::unordered_map<std::string, std::string> quant_fusion_pattern_and_replacements() {
+// The patterns are applied in order, the ones with a fused ReLU have to come
+// before the ones that would match their first op alone.
+std::vector<std::pair<std::string, std::string>> quant_fusion_pattern_and_replacements() {
 
   std::string conv2d = R"(
 graph(%a_quant, %packed_params, %r_scale, %r_zero_point, %r_dtype, %stride, %padding, %dilation, %groups):
@@ -22,6 +25,99 @@ graph(%a_quant, %packed_params, %r_scale, %r_zero_point, %r_dtype, %stride, %pad
         %r_quant = quantized::conv2d(%a_quant, %packed_params, %stride, %padding, %dilation, %groups, %r_scale, %r_zero_point)
         return (%r_quant) )";
 
+  std::string conv2d_relu = R"(
+graph(%a_quant, %packed_params, %r_scale, %r_zero_point, %r_dtype, %stride, %padding, %dilation, %groups):
+        %a_dequant = aten::dequantize(%a_quant)
+        %w_quant : Tensor, %b : Tensor? = quantized::conv2d_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %conv_out = aten::conv2d(%a_dequant, %w_dequant, %b, %stride, %padding, %dilation, %groups)
+        %r = aten::relu(%conv_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+
+  std::string quantized_conv2d_relu = R"(
+graph(%a_quant, %packed_params, %r_scale, %r_zero_point, %r_dtype, %stride, %padding, %dilation, %groups):
+        %r_quant = quantized::conv2d_relu(%a_quant, %packed_params, %stride, %padding, %dilation, %groups, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  std::string addmm_relu = R"(
+graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype, %4):
+        %a_dequant = aten::dequantize(%a_quant)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %w_dequant_t = aten::t(%w_dequant)
+        %linear_out = aten::addmm(%b, %a_dequant, %w_dequant_t, %4, %4)
+        %r = aten::relu(%linear_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+
+  std::string matmul_with_bias_relu = R"(
+graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype, %4):
+        %a_dequant = aten::dequantize(%a_quant)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %w_dequant_t = aten::t(%w_dequant)
+        %output = aten::matmul(%a_dequant, %w_dequant_t)
+        %linear_out = aten::add_(%output, %b, %4)
+        %r = aten::relu(%linear_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+
+  std::string quantized_linear_relu = R"(
+graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype, %4):
+        %r = quantized::linear_relu(%a_quant, %packed_params, %r_scale, %r_zero_point)
+        return (%r) )";
+
+  std::string matmul_no_bias_relu = R"(
+graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype):
+        %a_dequant = aten::dequantize(%a_quant)
+        %w_quant : Tensor, %b : Tensor? = quantized::linear_unpack(%packed_params)
+        %w_dequant = aten::dequantize(%w_quant)
+        %w_dequant_t = aten::t(%w_dequant)
+        %linear_out = aten::matmul(%a_dequant, %w_dequant_t)
+        %r = aten::relu(%linear_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+
+  std::string quantized_linear_no_bias_relu = R"(
+graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype):
+        %r = quantized::linear_relu(%a_quant, %packed_params, %r_scale, %r_zero_point)
+        return (%r) )";
+
+  // Only matched with alpha = 1, see QuantFusion.
+  std::string add_relu = R"(
+graph(%a_quant, %b_quant, %alpha, %r_scale, %r_zero_point, %r_dtype):
+        %a_dequant = aten::dequantize(%a_quant)
+        %b_dequant = aten::dequantize(%b_quant)
+        %add_out = aten::add_(%a_dequant, %b_dequant, %alpha)
+        %r = aten::relu(%add_out)
+        %r_quant = aten::quantize_per_tensor(%r, %r_scale, %r_zero_point, %r_dtype)
+        return (%r_quant) )";
+
+  std::string quantized_add_relu = R"(
+graph(%a_quant, %b_quant, %alpha, %r_scale, %r_zero_point, %r_dtype):
+        %r_quant = quantized::add_relu(%a_quant, %b_quant, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  // The residual block of ResNet, matched after the patterns above turned
+  // its conv and add + relu into quantized ops.
+  std::string conv2d_add_relu = R"(
+graph(%a_quant, %packed_params, %other_quant, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point, %r_scale, %r_zero_point):
+        %c_quant = quantized::conv2d(%a_quant, %packed_params, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point)
+        %r_quant = quantized::add_relu(%c_quant, %other_quant, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  std::string conv2d_add_relu_reversed = R"(
+graph(%a_quant, %packed_params, %other_quant, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point, %r_scale, %r_zero_point):
+        %c_quant = quantized::conv2d(%a_quant, %packed_params, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point)
+        %r_quant = quantized::add_relu(%other_quant, %c_quant, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
+  std::string quantized_conv2d_add_relu = R"(
+graph(%a_quant, %packed_params, %other_quant, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point, %r_scale, %r_zero_point):
+        %r_quant = quantized::conv2d_add_relu(%a_quant, %packed_params, %other_quant, %stride, %padding, %dilation, %groups, %c_scale, %c_zero_point, %r_scale, %r_zero_point)
+        return (%r_quant) )";
+
   std::string addmm = R"(
 graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype, %4):
         %a_dequant = aten::dequantize(%a_quant)
@@ -64,10 +160,17 @@ graph(%packed_params, %a_quant, %r_scale, %r_zero_point, %r_dtype):
         return (%r) )";
 
   return {
+    {conv2d_relu, quantized_conv2d_relu},
+    {addmm_relu, quantized_linear_relu},
+    {matmul_with_bias_relu, quantized_linear_relu},
+    {matmul_no_bias_relu, quantized_linear_no_bias_relu},
+    {add_relu, quantized_add_relu},
     {conv2d, quantized_conv2d},
     {addmm, quantized_linear},
     {matmul_with_bias, quantized_linear},
-    {matmul_no_bias, quantized_linear_no_bias}
+    {matmul_no_bias, quantized_linear_no_bias},
+    {conv2d_add_relu, quantized_conv2d_add_relu},
+    {conv2d_add_relu_reversed, quantized_conv2d_add_relu}
   };
 
 }
@@ -0,0 +1,946 @@
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
+
+#include <torch/csrc/jit/constants.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+c10::optional<int64_t> constantInt(Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isInt()) {
+    return c10::nullopt;
+  }
+  return iv->toInt();
+}
+
+c10::optional<bool> constantBool(Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isBool()) {
+    return c10::nullopt;
+  }
+  return iv->toBool();
+}
+
+c10::optional<std::vector<int64_t>> constantInts(Value* v) {
+  auto iv = toIValue(v);
+  if (!iv || !iv->isIntList()) {
+    return c10::nullopt;
+  }
+  return iv->toIntVector();
+}
+
+// Wraps a possibly negative dim of a tensor of the given rank, returns -1 if
+// it is out of range
+int64_t wrapDim(int64_t dim, size_t rank) {
+  if (dim < 0) {
+    dim += rank;
+  }
+  return dim >= 0 && dim < static_cast<int64_t>(rank) ? dim : -1;
+}
+
+// The int[N] arguments of convolutions and poolings can hold a single value
+// for all the spatial dims
+c10::optional<std::vector<int64_t>> spatialParam(Value* v, size_t n) {
+  auto param = constantInts(v);
+  if (!param) {
+    return c10::nullopt;
+  }
+  if (param->size() == 1) {
+    param->resize(n, param->at(0));
+  }
+  if (param->size() != n) {
+    return c10::nullopt;
+  }
+  return param;
+}
+
+bool isTensor(Value* v) {
+  return v->type()->isSubtypeOf(TensorType::get());
+}
+
+// Ops whose tensor output has the shape of their first input, when it is the
+// only tensor they take
+const std::unordered_set<Symbol>& sameShapeOps() {
+  static const std::unordered_set<Symbol> ops = [] {
+    std::unordered_set<Symbol> ops;
+    for (const char* name :
+         {"abs",         "neg",          "sigmoid",      "tanh",
+          "relu",        "exp",          "log",          "sqrt",
+          "rsqrt",       "gelu",         "ceil",         "floor",
+          "round",       "sign",         "sin",          "cos",
+          "erf",         "reciprocal",   "clone",        "contiguous",
+          "dropout",     "clamp",        "clamp_min",    "clamp_max",
+          "hardtanh",    "leaky_relu",   "elu",          "softmax",
+          "log_softmax", "layer_norm",   "batch_norm",   "instance_norm",
+          "group_norm",  "to",           "type_as",      "detach",
+          "zeros_like",  "ones_like",    "full_like",    "empty_like",
+          "rand_like",   "randn_like",   "add",          "sub",
+          "mul",         "div",          "pow",          "remainder",
+          "fmod",        "eq",           "ne",           "lt",
+          "gt",          "le",           "ge",           "where",
+          "masked_fill", "threshold",    "softplus",     "selu",
+          "celu",        "alpha_dropout", "feature_dropout"}) {
+      ops.insert(Symbol::aten(name));
+    }
+    return ops;
+  }();
+  return ops;
+}
+
+// Ops that broadcast all their tensor inputs, a subset of the ones above
+const std::unordered_set<Symbol>& broadcastingOps() {
+  static const std::unordered_set<Symbol> ops = [] {
+    std::unordered_set<Symbol> ops;
+    for (const char* name :
+         {"add", "sub", "mul", "div", "pow", "remainder", "fmod", "eq", "ne",
+          "lt", "gt", "le", "ge", "where", "masked_fill"}) {
+      ops.insert(Symbol::aten(name));
+    }
+    return ops;
+  }();
+  return ops;
+}
+
+// The index of the input that the output of an in place op (or of an op with
+// an out argument) is, if n is one
+c10::optional<size_t> writtenInput(Node* n) {
+  const FunctionSchema* schema = n->maybeSchema();
+  if (!schema || schema->returns().size() != 1) {
+    return c10::nullopt;
+  }
+  const AliasInfo* ret = schema->returns()[0].alias_info();
+  if (!ret || !ret->isWrite()) {
+    return c10::nullopt;
+  }
+  for (size_t i = 0; i < schema->arguments().size(); i++) {
+    const AliasInfo* arg = schema->arguments()[i].alias_info();
+    if (arg && arg->isWrite() && arg->beforeSets() == ret->beforeSets()) {
+      return i;
+    }
+  }
+  return c10::nullopt;
+}
+
+} // namespace
+
+SymbolicShapes::SymbolicShapes(const std::shared_ptr<Graph>& graph) {
+  for (Value* input : graph->inputs()) {
+    setInputShape(input);
+  }
+  propagateBlock(graph->block());
+}
+
+// Symbols start at -2, so that they can't be confused with the -1 of the
+// inferred dim of a view
+int64_t SymbolicShapes::newSymbol() {
+  parents_.push_back(parents_.size());
+  bound_.push_back(-1);
+  return -static_cast<int64_t>(parents_.size()) - 1;
+}
+
+int64_t SymbolicShapes::find(int64_t dim) const {
+  if (isStatic(dim)) {
+    return dim;
+  }
+  size_t i = -dim - 2;
+  while (parents_[i] != i) {
+    i = parents_[i];
+  }
+  return isStatic(bound_[i]) ? bound_[i] : -static_cast<int64_t>(i) - 2;
+}
+
+void SymbolicShapes::unify(int64_t a, int64_t b) {
+  a = find(a);
+  b = find(b);
+  // Two different static sizes would make the op fail, there is nothing to
+  // record
+  if (a == b || (isStatic(a) && isStatic(b))) {
+    return;
+  }
+  if (isStatic(a)) {
+    std::swap(a, b);
+  }
+  size_t root = -a - 2;
+  if (isStatic(b)) {
+    bound_[root] = b;
+  } else {
+    parents_[root] = -b - 2;
+  }
+}
+
+int64_t SymbolicShapes::derived(char kind, std::vector<int64_t> dims) {
+  for (auto& dim : dims) {
+    dim = find(dim);
+  }
+  auto key = std::make_pair(kind, std::move(dims));
+  auto it = derived_.find(key);
+  if (it != derived_.end()) {
+    return it->second;
+  }
+  int64_t symbol = newSymbol();
+  derived_.emplace(std::move(key), symbol);
+  return symbol;
+}
+
+int64_t SymbolicShapes::broadcast(int64_t a, int64_t b) {
+  a = find(a);
+  b = find(b);
+  if (a == b || b == 1) {
+    return a;
+  }
+  if (a == 1) {
+    return b;
+  }
+  // A static size other than 1 is the result, the other dim is 1 or equal
+  if (isStatic(a)) {
+    return a;
+  }
+  if (isStatic(b)) {
+    return b;
+  }
+  if (a > b) {
+    std::swap(a, b);
+  }
+  return derived('b', {a, b});
+}
+
+int64_t SymbolicShapes::product(std::vector<int64_t> dims) {
+  int64_t static_product = 1;
+  std::vector<int64_t> symbols;
+  for (int64_t dim : dims) {
+    dim = find(dim);
+    if (isStatic(dim)) {
+      static_product *= dim;
+    } else {
+      symbols.push_back(dim);
+    }
+  }
+  if (symbols.empty() || static_product == 0) {
+    return static_product;
+  }
+  if (symbols.size() == 1 && static_product == 1) {
+    return symbols[0];
+  }
+  std::sort(symbols.begin(), symbols.end());
+  symbols.push_back(static_product);
+  return derived('*', std::move(symbols));
+}
+
+int64_t SymbolicShapes::sum(std::vector<int64_t> dims) {
+  int64_t static_sum = 0;
+  std::vector<int64_t> symbols;
+  for (int64_t dim : dims) {
+    dim = find(dim);
+    if (isStatic(dim)) {
+      static_sum += dim;
+    } else {
+      symbols.push_back(dim);
+    }
+  }
+  if (symbols.empty()) {
+    return static_sum;
+  }
+  if (symbols.size() == 1 && static_sum == 0) {
+    return symbols[0];
+  }
+  std::sort(symbols.begin(), symbols.end());
+  symbols.push_back(static_sum);
+  return derived('+', std::move(symbols));
+}
+
+// The dim of a value that is either a or b, e.g. the output of an if
+int64_t SymbolicShapes::merge(int64_t a, int64_t b) {
+  a = find(a);
+  b = find(b);
+  return a == b ? a : newSymbol();
+}
+
+c10::optional<std::vector<int64_t>> SymbolicShapes::shape(Value* v) const {
+  auto it = shapes_.find(v);
+  if (it == shapes_.end()) {
+    return c10::nullopt;
+  }
+  return it->second;
+}
+
+c10::optional<int64_t> SymbolicShapes::intOf(Value* v) const {
+  auto it = ints_.find(v);
+  if (it != ints_.end()) {
+    return it->second;
+  }
+  return constantInt(v);
+}
+
+c10::optional<std::vector<int64_t>> SymbolicShapes::intListOf(Value* v) const {
+  auto it = int_lists_.find(v);
+  if (it != int_lists_.end()) {
+    return it->second;
+  }
+  return constantInts(v);
+}
+
+c10::optional<std::vector<int64_t>> SymbolicShapes::shapeOf(Value* v) const {
+  auto result = shape(v);
+  if (result) {
+    for (auto& dim : *result) {
+      dim = find(dim);
+    }
+  }
+  return result;
+}
+
+c10::optional<int64_t> SymbolicShapes::sizeOf(Value* v) const {
+  auto it = ints_.find(v);
+  if (it == ints_.end()) {
+    return c10::nullopt;
+  }
+  return find(it->second);
+}
+
+bool SymbolicShapes::sameShape(Value* a, Value* b) const {
+  auto a_shape = shapeOf(a);
+  return a_shape && a_shape == shapeOf(b);
+}
+
+void SymbolicShapes::setInputShape(Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type || !type->sizes().sizes()) {
+    return;
+  }
+  std::vector<int64_t> dims;
+  for (const auto& size : *type->sizes().sizes()) {
+    dims.push_back(size ? *size : newSymbol());
+  }
+  shapes_[v] = std::move(dims);
+}
+
+void SymbolicShapes::propagateBlock(Block* block) {
+  for (Node* n : block->nodes()) {
+    propagateNode(n);
+  }
+}
+
+void SymbolicShapes::forgetBlock(Block* block) {
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      forgetBlock(b);
+    }
+    for (Value* output : n->outputs()) {
+      shapes_.erase(output);
+      ints_.erase(output);
+      int_lists_.erase(output);
+    }
+  }
+  for (Value* input : block->inputs()) {
+    shapes_.erase(input);
+    ints_.erase(input);
+  }
+}
+
+void SymbolicShapes::propagateIf(Node* n) {
+  for (Block* b : n->blocks()) {
+    propagateBlock(b);
+  }
+  for (size_t i = 0; i < n->outputs().size(); i++) {
+    Value* then_output = n->blocks().at(0)->outputs().at(i);
+    Value* else_output = n->blocks().at(1)->outputs().at(i);
+    auto then_shape = shape(then_output);
+    auto else_shape = shape(else_output);
+    if (then_shape && else_shape && then_shape->size() == else_shape->size()) {
+      std::vector<int64_t> dims;
+      for (size_t d = 0; d < then_shape->size(); d++) {
+        dims.push_back(merge(then_shape->at(d), else_shape->at(d)));
+      }
+      shapes_[n->output(i)] = std::move(dims);
+    }
+    auto then_int = intOf(then_output);
+    auto else_int = intOf(else_output);
+    if (then_int && else_int && n->output(i)->type() == IntType::get()) {
+      ints_[n->output(i)] = merge(*then_int, *else_int);
+    }
+  }
+}
+
+// The shapes of the values carried by a loop are the ones they have before it
+// if the body keeps them. Otherwise the dims that the body changes get fresh
+// symbols, and the body is analyzed again with them. If it still changes them,
+// the shapes of the body and of the outputs are left unknown.
+void SymbolicShapes::propagateLoop(Node* n) {
+  Block* body = n->blocks().at(0);
+  // Loop inputs: max trip count, initial condition, carried values. Body
+  // inputs: iteration, carried values. Body outputs: condition, carried values
+  const size_t num_carried = n->outputs().size();
+  std::vector<c10::optional<std::vector<int64_t>>> carried;
+  for (size_t i = 0; i < num_carried; i++) {
+    carried.push_back(shapeOf(n->input(i + 2)));
+  }
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    forgetBlock(body);
+    for (size_t i = 0; i < num_carried; i++) {
+      if (carried[i]) {
+        shapes_[body->inputs().at(i + 1)] = *carried[i];
+      }
+    }
+    propagateBlock(body);
+
+    bool fixpoint = true;
+    for (size_t i = 0; i < num_carried; i++) {
+      if (!carried[i]) {
+        continue;
+      }
+      auto body_shape = shapeOf(body->outputs().at(i + 1));
+      if (!body_shape || body_shape->size() != carried[i]->size()) {
+        carried[i] = c10::nullopt;
+        fixpoint = false;
+        continue;
+      }
+      for (size_t d = 0; d < body_shape->size(); d++) {
+        if (find(body_shape->at(d)) != find(carried[i]->at(d))) {
+          carried[i]->at(d) = newSymbol();
+          fixpoint = false;
+        }
+      }
+    }
+    if (fixpoint) {
+      for (size_t i = 0; i < num_carried; i++) {
+        if (carried[i]) {
+          shapes_[n->output(i)] = *carried[i];
+        }
+      }
+      return;
+    }
+  }
+  forgetBlock(body);
+}
+
+void SymbolicShapes::propagateNode(Node* n) {
+  if (n->kind() == prim::If) {
+    propagateIf(n);
+    return;
+  }
+  if (n->kind() == prim::Loop) {
+    propagateLoop(n);
+    return;
+  }
+  for (Block* b : n->blocks()) {
+    propagateBlock(b);
+  }
+
+  // Ints and lists of ints that hold sizes
+  if (n->kind() == prim::Constant) {
+    auto iv = toIValue(n->output());
+    if (iv && iv->isTensor() && iv->toTensor().defined()) {
+      auto sizes = iv->toTensor().sizes();
+      shapes_[n->output()] = std::vector<int64_t>(sizes.begin(), sizes.end());
+    }
+    return;
+  }
+  if (n->kind() == aten::size && n->inputs().size() == 1) {
+    if (auto self = shape(n->input(0))) {
+      int_lists_[n->output()] = *self;
+    }
+    return;
+  }
+  if (n->kind() == aten::size && n->inputs().size() == 2) {
+    auto self = shape(n->input(0));
+    auto dim = constantInt(n->input(1));
+    if (self && dim && wrapDim(*dim, self->size()) >= 0) {
+      ints_[n->output()] = self->at(wrapDim(*dim, self->size()));
+    }
+    return;
+  }
+  if (n->kind() == aten::dim) {
+    if (auto self = shape(n->input(0))) {
+      ints_[n->output()] = self->size();
+    }
+    return;
+  }
+  if (n->kind() == aten::__getitem__ && n->output()->type() == IntType::get()) {
+    auto list = intListOf(n->input(0));
+    auto index = constantInt(n->input(1));
+    if (list && index && wrapDim(*index, list->size()) >= 0) {
+      ints_[n->output()] = list->at(wrapDim(*index, list->size()));
+    }
+    return;
+  }
+  if (n->kind() == prim::ListUnpack) {
+    auto list = intListOf(n->input());
+    if (list && list->size() == n->outputs().size()) {
+      for (size_t i = 0; i < list->size(); i++) {
+        ints_[n->output(i)] = list->at(i);
+      }
+    }
+    return;
+  }
+  if (n->kind() == prim::ListConstruct) {
+    std::vector<int64_t> list;
+    for (Value* input : n->inputs()) {
+      auto dim = intOf(input);
+      if (!dim) {
+        return;
+      }
+      list.push_back(*dim);
+    }
+    int_lists_[n->output()] = std::move(list);
+    return;
+  }
+  if ((n->kind() == aten::mul || n->kind() == aten::add) &&
+      n->output()->type() == IntType::get()) {
+    auto a = intOf(n->input(0));
+    auto b = intOf(n->input(1));
+    if (a && b) {
+      ints_[n->output()] =
+          n->kind() == aten::mul ? product({*a, *b}) : sum({*a, *b});
+    }
+    return;
+  }
+
+  if (n->outputs().size() != 1 || !isTensor(n->output())) {
+    return;
+  }
+  if (auto output = outputShape(n)) {
+    shapes_[n->output()] = std::move(*output);
+  }
+}
+
+c10::optional<std::vector<int64_t>> SymbolicShapes::outputShape(Node* n) {
+  using shape_t = std::vector<int64_t>;
+  static const auto kMatmul = Symbol::aten("matmul");
+  static const auto kMm = Symbol::aten("mm");
+  static const auto kBmm = Symbol::aten("bmm");
+  static const auto kAddmm = Symbol::aten("addmm");
+  static const auto kLinear = Symbol::aten("linear");
+  static const auto kT = Symbol::aten("t");
+  static const auto kTranspose = Symbol::aten("transpose");
+  static const auto kPermute = Symbol::aten("permute");
+  static const auto kView = Symbol::aten("view");
+  static const auto kReshape = Symbol::aten("reshape");
+  static const auto kFlatten = Symbol::aten("flatten");
+  static const auto kUnsqueeze = Symbol::aten("unsqueeze");
+  static const auto kSqueeze = Symbol::aten("squeeze");
+  static const auto kSum = Symbol::aten("sum");
+  static const auto kMean = Symbol::aten("mean");
+  static const auto kCat = Symbol::aten("cat");
+  static const auto kSelect = Symbol::aten("select");
+  static const auto kExpandAs = Symbol::aten("expand_as");
+  static const auto kEmbedding = Symbol::aten("embedding");
+  static const auto kAdaptiveAvgPool2d = Symbol::aten("adaptive_avg_pool2d");
+  static const auto kMaxPool2d = Symbol::aten("max_pool2d");
+  static const auto kAvgPool2d = Symbol::aten("avg_pool2d");
+
+  const Symbol kind = n->kind();
+  c10::optional<shape_t> self;
+  if (!n->inputs().empty()) {
+    self = shape(n->input(0));
+  }
+
+  if (auto written = writtenInput(n)) {
+    return shape(n->input(*written));
+  }
+
+  if (broadcastingOps().count(kind)) {
+    shape_t result;
+    for (Value* input : n->inputs()) {
+      if (!isTensor(input)) {
+        continue;
+      }
+      auto input_shape = shape(input);
+      if (!input_shape) {
+        return c10::nullopt;
+      }
+      // Right aligned broadcast
+      if (input_shape->size() > result.size()) {
+        result.insert(result.begin(), input_shape->size() - result.size(), 1);
+      }
+      const size_t offset = result.size() - input_shape->size();
+      for (size_t d = 0; d < input_shape->size(); d++) {
+        result[offset + d] = broadcast(result[offset + d], input_shape->at(d));
+      }
+    }
+    return result;
+  }
+  if (sameShapeOps().count(kind)) {
+    for (size_t i = 1; i < n->inputs().size(); i++) {
+      if (isTensor(n->input(i))) {
+        // batch_norm, layer_norm, ... take parameters that don't change the
+        // shape of their input
+        if (kind != aten::batch_norm && kind != aten::layer_norm &&
+            kind != Symbol::aten("instance_norm") &&
+            kind != Symbol::aten("group_norm") &&
+            kind != Symbol::aten("type_as")) {
+          return c10::nullopt;
+        }
+      }
+    }
+    return self;
+  }
+  if (!self) {
+    return c10::nullopt;
+  }
+  const size_t rank = self->size();
+
+  if (kind == kMatmul || kind == kMm) {
+    auto other = shape(n->input(1));
+    if (!other || rank == 0 || other->empty()) {
+      return c10::nullopt;
+    }
+    // Vectors are promoted to matrices, and the promoted dims removed
+    shape_t a = rank == 1 ? shape_t{1, self->at(0)} : *self;
+    shape_t b = other->size() == 1 ? shape_t{other->at(0), 1} : *other;
+    unify(a.back(), b[b.size() - 2]);
+    shape_t a_batch(a.begin(), a.end() - 2);
+    shape_t b_batch(b.begin(), b.end() - 2);
+    if (a_batch.size() < b_batch.size()) {
+      a_batch.insert(a_batch.begin(), b_batch.size() - a_batch.size(), 1);
+    }
+    const size_t offset = a_batch.size() - b_batch.size();
+    for (size_t d = 0; d < b_batch.size(); d++) {
+      a_batch[offset + d] = broadcast(a_batch[offset + d], b_batch[d]);
+    }
+    shape_t result = a_batch;
+    if (rank > 1) {
+      result.push_back(a[a.size() - 2]);
+    }
+    if (other->size() > 1) {
+      result.push_back(b.back());
+    }
+    return result;
+  }
+  if (kind == kBmm) {
+    auto other = shape(n->input(1));
+    if (rank != 3 || !other || other->size() != 3) {
+      return c10::nullopt;
+    }
+    unify(self->at(0), other->at(0));
+    unify(self->at(2), other->at(1));
+    return shape_t{self->at(0), self->at(1), other->at(2)};
+  }
+  if (kind == kAddmm) {
+    auto mat1 = shape(n->input(1));
+    auto mat2 = shape(n->input(2));
+    if (!mat1 || !mat2 || mat1->size() != 2 || mat2->size() != 2) {
+      return c10::nullopt;
+    }
+    unify(mat1->at(1), mat2->at(0));
+    return shape_t{mat1->at(0), mat2->at(1)};
+  }
+  if (kind == kLinear) {
+    auto weight = shape(n->input(1));
+    if (rank == 0 || !weight || weight->size() != 2) {
+      return c10::nullopt;
+    }
+    unify(self->back(), weight->at(1));
+    shape_t result = *self;
+    result.back() = weight->at(0);
+    return result;
+  }
+  if (kind == kT) {
+    shape_t result = *self;
+    std::reverse(result.begin(), result.end());
+    return rank <= 2 ? c10::optional<shape_t>(result) : c10::nullopt;
+  }
+  if (kind == kTranspose) {
+    auto dim0 = constantInt(n->input(1));
+    auto dim1 = constantInt(n->input(2));
+    if (!dim0 || !dim1 || wrapDim(*dim0, rank) < 0 ||
+        wrapDim(*dim1, rank) < 0) {
+      return c10::nullopt;
+    }
+    shape_t result = *self;
+    std::swap(result[wrapDim(*dim0, rank)], result[wrapDim(*dim1, rank)]);
+    return result;
+  }
+  if (kind == kPermute) {
+    auto dims = constantInts(n->input(1));
+    if (!dims || dims->size() != rank) {
+      return c10::nullopt;
+    }
+    shape_t result;
+    for (int64_t dim : *dims) {
+      if (wrapDim(dim, rank) < 0) {
+        return c10::nullopt;
+      }
+      result.push_back(self->at(wrapDim(dim, rank)));
+    }
+    return result;
+  }
+  if (kind == kView || kind == kReshape) {
+    auto sizes = intListOf(n->input(1));
+    if (!sizes) {
+      return c10::nullopt;
+    }
+    shape_t result = *sizes;
+    auto inferred = std::find(result.begin(), result.end(), -1);
+    if (inferred == result.end()) {
+      return result;
+    }
+    // The inferred dim is the product of the dims of self that are left once
+    // the other dims of the result are matched with them
+    std::vector<int64_t> left;
+    for (int64_t dim : *self) {
+      left.push_back(find(dim));
+    }
+    std::vector<int64_t> known;
+    for (auto it = result.begin(); it != result.end(); ++it) {
+      if (it != inferred) {
+        known.push_back(find(*it));
+      }
+    }
+    bool matched = true;
+    for (int64_t dim : known) {
+      auto pos = std::find(left.begin(), left.end(), dim);
+      if (pos == left.end()) {
+        matched = false;
+        break;
+      }
+      left.erase(pos);
+    }
+    if (matched) {
+      *inferred = product(left);
+    } else {
+      int64_t numel = product(*self);
+      int64_t known_numel = product(known);
+      *inferred = isStatic(numel) && isStatic(known_numel) && known_numel > 0
+          ? numel / known_numel
+          : derived('/', {numel, known_numel});
+    }
+    return result;
+  }
+  if (kind == kFlatten) {
+    auto start = constantInt(n->input(1));
+    auto end = constantInt(n->input(2));
+    if (rank == 0) {
+      return shape_t{1};
+    }
+    if (!start || !end || wrapDim(*start, rank) < 0 ||
+        wrapDim(*end, rank) < 0 || wrapDim(*start, rank) > wrapDim(*end, rank)) {
+      return c10::nullopt;
+    }
+    auto first = self->begin() + wrapDim(*start, rank);
+    auto last = self->begin() + wrapDim(*end, rank) + 1;
+    shape_t result(self->begin(), first);
+    result.push_back(product(shape_t(first, last)));
+    result.insert(result.end(), last, self->end());
+    return result;
+  }
+  if (kind == kUnsqueeze) {
+    auto dim = constantInt(n->input(1));
+    if (!dim || wrapDim(*dim, rank + 1) < 0) {
+      return c10::nullopt;
+    }
+    shape_t result = *self;
+    result.insert(result.begin() + wrapDim(*dim, rank + 1), 1);
+    return result;
+  }
+  if (kind == kSqueeze) {
+    shape_t result;
+    if (n->inputs().size() == 1) {
+      for (int64_t dim : *self) {
+        dim = find(dim);
+        if (!isStatic(dim)) {
+          // It may or may not be 1, so the rank isn't known
+          return c10::nullopt;
+        }
+        if (dim != 1) {
+          result.push_back(dim);
+        }
+      }
+      return result;
+    }
+    auto dim = constantInt(n->input(1));
+    if (!dim || wrapDim(*dim, rank) < 0) {
+      return c10::nullopt;
+    }
+    const int64_t size = find(self->at(wrapDim(*dim, rank)));
+    if (!isStatic(size)) {
+      return c10::nullopt;
+    }
+    result = *self;
+    if (size == 1) {
+      result.erase(result.begin() + wrapDim(*dim, rank));
+    }
+    return result;
+  }
+  if (kind == kSum || kind == kMean) {
+    if (n->inputs().size() <= 2) {
+      // Full reductions, with an optional dtype
+      return shape_t{};
+    }
+    auto dims = constantInts(n->input(1));
+    auto keepdim = constantBool(n->input(2));
+    if (!dims || !keepdim) {
+      return c10::nullopt;
+    }
+    std::vector<bool> reduced(rank, dims->empty());
+    for (int64_t dim : *dims) {
+      if (wrapDim(dim, rank) < 0) {
+        return c10::nullopt;
+      }
+      reduced[wrapDim(dim, rank)] = true;
+    }
+    shape_t result;
+    for (size_t d = 0; d < rank; d++) {
+      if (!reduced[d]) {
+        result.push_back(self->at(d));
+      } else if (*keepdim) {
+        result.push_back(1);
+      }
+    }
+    return result;
+  }
+  if (kind == kSelect) {
+    auto dim = constantInt(n->input(1));
+    if (!dim || wrapDim(*dim, rank) < 0) {
+      return c10::nullopt;
+    }
+    shape_t result = *self;
+    result.erase(result.begin() + wrapDim(*dim, rank));
+    return result;
+  }
+  if (kind == kExpandAs) {
+    return shape(n->input(1));
+  }
+  if (kind == kEmbedding) {
+    // self is the weight
+    auto indices = shape(n->input(1));
+    if (rank != 2 || !indices) {
+      return c10::nullopt;
+    }
+    shape_t result = *indices;
+    result.push_back(self->at(1));
+    return result;
+  }
+  if (kind == aten::conv1d || kind == aten::conv2d || kind == aten::conv3d) {
+    auto weight = shape(n->input(1));
+    if (rank < 3 || !weight || weight->size() != rank) {
+      return c10::nullopt;
+    }
+    const size_t spatial = rank - 2;
+    auto stride = spatialParam(n->input(3), spatial);
+    auto padding = spatialParam(n->input(4), spatial);
+    auto dilation = spatialParam(n->input(5), spatial);
+    if (!stride || !padding || !dilation) {
+      return c10::nullopt;
+    }
+    shape_t result{self->at(0), weight->at(0)};
+    for (size_t d = 0; d < spatial; d++) {
+      const int64_t in = find(self->at(d + 2));
+      const int64_t kernel = find(weight->at(d + 2));
+      const int64_t s = stride->at(d);
+      const int64_t p = padding->at(d);
+      const int64_t dil = dilation->at(d);
+      if (isStatic(in) && isStatic(kernel)) {
+        result.push_back((in + 2 * p - dil * (kernel - 1) - 1) / s + 1);
+      } else if (isStatic(kernel) && s == 1 && 2 * p == dil * (kernel - 1)) {
+        result.push_back(in);
+      } else {
+        result.push_back(derived('c', {in, kernel, s, p, dil}));
+      }
+    }
+    return result;
+  }
+  if (kind == kMaxPool2d || kind == kAvgPool2d) {
+    if (rank != 3 && rank != 4) {
+      return c10::nullopt;
+    }
+    auto kernel = spatialParam(n->input(1), 2);
+    auto stride = constantInts(n->input(2));
+    auto padding = spatialParam(n->input(3), 2);
+    const bool is_max = kind == kMaxPool2d;
+    auto dilation = is_max ? spatialParam(n->input(4), 2)
+                           : c10::optional<shape_t>(shape_t{1, 1});
+    auto ceil_mode = constantBool(n->input(is_max ? 5 : 4));
+    if (!kernel || !stride || !padding || !dilation || !ceil_mode) {
+      return c10::nullopt;
+    }
+    // An empty stride is the kernel size
+    if (stride->empty()) {
+      stride = kernel;
+    } else if (stride->size() == 1) {
+      stride->resize(2, stride->at(0));
+    }
+    shape_t result(self->begin(), self->end() - 2);
+    for (size_t d = 0; d < 2; d++) {
+      const int64_t in = find(self->at(rank - 2 + d));
+      const int64_t k = kernel->at(d);
+      const int64_t s = stride->at(d);
+      const int64_t p = padding->at(d);
+      const int64_t dil = dilation->at(d);
+      if (isStatic(in)) {
+        const int64_t span = in + 2 * p - dil * (k - 1) - 1 + (*ceil_mode ? s - 1 : 0);
+        int64_t out = span / s + 1;
+        // The last window must start inside the input or its left padding
+        if (*ceil_mode && (out - 1) * s >= in + p) {
+          out--;
+        }
+        result.push_back(out);
+      } else if (s == 1 && 2 * p == dil * (k - 1)) {
+        result.push_back(in);
+      } else {
+        result.push_back(derived(
+            is_max ? 'm' : 'a', {in, k, s, p, dil, *ceil_mode ? 1 : 0}));
+      }
+    }
+    return result;
+  }
+  if (kind == kAdaptiveAvgPool2d) {
+    auto output_size = spatialParam(n->input(1), 2);
+    if ((rank != 3 && rank != 4) || !output_size) {
+      return c10::nullopt;
+    }
+    shape_t result(self->begin(), self->end() - 2);
+    result.insert(result.end(), output_size->begin(), output_size->end());
+    return result;
+  }
+  if (kind == kCat) {
+    Node* list = n->input(0)->node();
+    auto dim = constantInt(n->input(1));
+    if (list->kind() != prim::ListConstruct || !dim) {
+      return c10::nullopt;
+    }
+    c10::optional<shape_t> result;
+    std::vector<int64_t> cat_dims;
+    for (Value* input : list->inputs()) {
+      auto input_shape = shape(input);
+      if (!input_shape) {
+        return c10::nullopt;
+      }
+      // Legacy empty tensors of size [0] are skipped by cat
+      if (input_shape->size() == 1 && find(input_shape->at(0)) == 0) {
+        continue;
+      }
+      if (result && input_shape->size() != result->size()) {
+        return c10::nullopt;
+      }
+      const int64_t d = wrapDim(*dim, input_shape->size());
+      if (d < 0) {
+        return c10::nullopt;
+      }
+      if (result) {
+        for (size_t i = 0; i < result->size(); i++) {
+          if (static_cast<int64_t>(i) != d) {
+            unify(result->at(i), input_shape->at(i));
+          }
+        }
+      } else {
+        result = input_shape;
+      }
+      cat_dims.push_back(input_shape->at(d));
+    }
+    if (!result) {
+      return c10::nullopt;
+    }
+    result->at(wrapDim(*dim, result->size())) = sum(cat_dims);
+    return result;
+  }
+  return c10::nullopt;
+}
+
+} // namespace jit
+} // namespace torch
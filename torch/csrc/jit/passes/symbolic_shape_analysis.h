@@ -0,0 +1,82 @@
+/** \brief Symbolic shape analysis
+ *
+ * PropagateInputShapes only computes sizes when the inputs of a graph have
+ * complete shapes, and otherwise falls back to ranks. This analysis computes
+ * the sizes of the tensors of a graph in terms of symbolic dimensions, e.g.
+ * [s0, 4] for a batch of s0 vectors of size 4, so that relations like "the
+ * output has the shape of the input" or "these two dims are equal" hold for a
+ * whole family of input shapes.
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+#include <map>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+/** \brief The symbolic sizes of the values of a graph
+ *
+ * A dimension is either static, a size >= 0, or a symbol < 0. Dimensions with
+ * the same symbol are equal in every run of the graph. The sizes of the inputs
+ * come from their TensorTypes: known sizes are static, and the other dims of
+ * inputs with a known rank get fresh symbols. The ops that have a formula
+ * propagate them, and unify the dims that must be equal for the op to run,
+ * e.g. the inner dims of a matmul. The ints that hold sizes (aten::size) are
+ * tracked too, so that x.view(x.size(0), -1) keeps the symbol of x's first
+ * dim.
+ */
+struct TORCH_API SymbolicShapes {
+  explicit SymbolicShapes(const std::shared_ptr<Graph>& graph);
+
+  static bool isStatic(int64_t dim) {
+    return dim >= 0;
+  }
+
+  /** \brief The sizes of v, if it is a tensor whose rank is known, with the
+   * symbols that were unified replaced by a single one */
+  c10::optional<std::vector<int64_t>> shapeOf(Value* v) const;
+  /** \brief The size that v holds, if it is an int that holds a dimension */
+  c10::optional<int64_t> sizeOf(Value* v) const;
+  /** \brief Whether the tensors a and b have the same sizes in every run */
+  bool sameShape(Value* a, Value* b) const;
+
+ private:
+  int64_t newSymbol();
+  int64_t find(int64_t dim) const;
+  void unify(int64_t a, int64_t b);
+  // A symbol for a function of dims that aren't all static, the same one for
+  // the same kind of function of the same dims
+  int64_t derived(char kind, std::vector<int64_t> dims);
+  int64_t broadcast(int64_t a, int64_t b);
+  int64_t product(std::vector<int64_t> dims);
+  int64_t sum(std::vector<int64_t> dims);
+  int64_t merge(int64_t a, int64_t b);
+
+  c10::optional<std::vector<int64_t>> shape(Value* v) const;
+  c10::optional<int64_t> intOf(Value* v) const;
+  c10::optional<std::vector<int64_t>> intListOf(Value* v) const;
+
+  void setInputShape(Value* v);
+  void propagateBlock(Block* block);
+  void propagateNode(Node* n);
+  void propagateIf(Node* n);
+  void propagateLoop(Node* n);
+  void forgetBlock(Block* block);
+  c10::optional<std::vector<int64_t>> outputShape(Node* n);
+
+  // The parents in the union-find forest of the symbols, indexed by
+  // -symbol - 2, and the static size that a root is bound to, or -1
+  std::vector<size_t> parents_;
+  std::vector<int64_t> bound_;
+  std::map<std::pair<char, std::vector<int64_t>>, int64_t> derived_;
+
+  std::unordered_map<Value*, std::vector<int64_t>> shapes_;
+  std::unordered_map<Value*, int64_t> ints_;
+  std::unordered_map<Value*, std::vector<int64_t>> int_lists_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -132,21 +132,8 @@ IValue unpickle(
     size_t size,
     ClassResolver class_resolver,
     const std::vector<at::Tensor>* tensor_table) {
-  size_t bytes_read = 0;
-  return unpickle(
-      [&](char* buffer, size_t len) -> size_t {
-        if (bytes_read >= size) {
-          return 0;
-        }
-        len = std::min(size - bytes_read, len);
-        // Copy len bytes into buffer
-        const char* start = data + bytes_read;
-        std::memcpy(buffer, start, len);
-        bytes_read += len;
-        return len;
-      },
-      std::move(class_resolver),
-      tensor_table);
+  Unpickler unpickler(data, size, std::move(class_resolver), tensor_table);
+  return unpickler.parse_ivalue();
 }
 
 } // namespace jit
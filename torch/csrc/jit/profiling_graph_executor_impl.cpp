@@ -8,6 +8,7 @@
 #include <torch/csrc/jit/passes/create_autodiff_subgraphs.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/decompose_ops.h>
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/guard_elimination.h>
 #include <torch/csrc/jit/passes/inline_autodiff_subgraphs.h>
@@ -34,6 +35,7 @@ static std::atomic<bool> profiling_mode{true};
 
 static std::atomic<size_t> num_profiled_runs{1};
 static std::atomic<size_t> bailout_depth{1};
+static std::atomic<bool> profiling_dynamic_shapes{false};
 
 std::atomic<bool>& getProfilingMode() {
   return profiling_mode;
@@ -50,6 +52,10 @@ std::atomic<size_t>& getBailoutDepth() {
   return bailout_depth;
 }
 
+std::atomic<bool>& getProfilingDynamicShapes() {
+  return profiling_dynamic_shapes;
+}
+
 static bool needsGradientInProfilingMode(Block* b) {
   for (auto n : b->nodes()) {
     if (n->kind() == prim::BailOut) {
@@ -105,6 +111,9 @@ void ProfilingGraphExecutorImpl::runProfilingOptimizations(
 
   } else {
     runNondiffOptimization(copy);
+    if (getForkIndependentBranchesMode()) {
+      ForkIndependentBranches(copy);
+    }
   }
   EliminateDeadCode(copy);
   GRAPH_DUMP("Optimized Graph : ", copy);
@@ -159,12 +168,7 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
 
   // if a profiling graph hasn't been created yet
   if (!pr_) {
-    auto copy = graph->copy();
-    runProfilingInsensitiveOptimizations(copy);
-    pr_ = ProfilingRecord::instrumentGraph(copy);
-    auto pr_copy = pr_->graph()->copy();
-    GRAPH_DUMP("Profiled Graph: ", pr_copy);
-    profiling_plan_ = ExecutionPlan(pr_copy);
+    instrumentGraph();
     // fall-through
   }
 
@@ -180,6 +184,34 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
   return *optimized_plan_;
 }
 
+void ProfilingGraphExecutorImpl::instrumentGraph() {
+  auto copy = graph->copy();
+  runProfilingInsensitiveOptimizations(copy);
+  pr_ = ProfilingRecord::instrumentGraph(copy);
+  auto pr_copy = pr_->graph()->copy();
+  GRAPH_DUMP("Profiled Graph: ", pr_copy);
+  profiling_plan_ = ExecutionPlan(pr_copy);
+}
+
+c10::optional<IValue> ProfilingGraphExecutorImpl::saveProfile() {
+  std::lock_guard<std::mutex> lock(compile_mutex);
+  if (!pr_ || !pr_->ready()) {
+    return c10::nullopt;
+  }
+  return pr_->saveProfile();
+}
+
+bool ProfilingGraphExecutorImpl::loadProfile(const IValue& profile) {
+  std::lock_guard<std::mutex> lock(compile_mutex);
+  if (optimized_plan_ || (pr_ && pr_->ready())) {
+    return false;
+  }
+  if (!pr_) {
+    instrumentGraph();
+  }
+  return pr_->loadProfile(profile);
+}
+
 GraphExecutorState ProfilingGraphExecutorImpl::getDebugState() {
   GraphExecutorState state;
   TORCH_INTERNAL_ASSERT(optimized_plan_);
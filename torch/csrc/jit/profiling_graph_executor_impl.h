@@ -10,9 +10,12 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   ExecutionPlan getPlanFor(Stack& stack, size_t remaining_bailout_depth)
       override;
   GraphExecutorState getDebugState() override;
+  c10::optional<IValue> saveProfile() override;
+  bool loadProfile(const IValue& profile) override;
   ~ProfilingGraphExecutorImpl() override = default;
 
  private:
+  void instrumentGraph();
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
   void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
   std::unique_ptr<ProfilingRecord> pr_;
@@ -3,6 +3,8 @@
 #include <torch/csrc/jit/interpreter.h>
 #include <torch/csrc/jit/passes/constant_propagation.h>
 
+#include <sstream>
+
 namespace torch {
 namespace jit {
 
@@ -61,6 +63,9 @@ void ProfilingRecord::insertShapeProfile(Node *n, Value *i) {
 
       if (t.toTensor().defined()) {
         auto pttp = tensorTypeInCurrentExecutionContext(t.toTensor());
+        if (getProfilingDynamicShapes()) {
+          pttp = pttp->dimensionedOnly();
+        }
         std::lock_guard<std::mutex> lock(this->mutex_);
         if (auto type = pno->type()->cast<TensorType>()) {
           if (!first) {
@@ -102,6 +107,136 @@ void ProfilingRecord::instrumentBlock(Block *block) {
   }
 }
 
+namespace {
+
+void collectProfileNodes(Block* block, std::vector<Node*>& profile_nodes) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == prim::profile && n->outputs().size() == 1) {
+      profile_nodes.push_back(n);
+    }
+    for (Block* b : n->blocks()) {
+      collectProfileNodes(b, profile_nodes);
+    }
+  }
+}
+
+// identifies the profiled graph a profile was taken for
+std::string profileSignature(Block* block) {
+  std::stringstream ss;
+  for (Node* n : block->nodes()) {
+    ss << n->kind().toQualString() << "(" << n->inputs().size() << ")";
+    for (Block* b : n->blocks()) {
+      ss << "{" << profileSignature(b) << "}";
+    }
+    ss << ";";
+  }
+  return ss.str();
+}
+
+int64_t optionalToInt(c10::optional<bool> value) {
+  return value ? *value : -1;
+}
+
+c10::optional<bool> optionalFromInt(int64_t value) {
+  if (value < 0) {
+    return c10::nullopt;
+  }
+  return value != 0;
+}
+
+IValue shapeToIValue(const c10::VaryingShape& shape) {
+  if (!shape.size()) {
+    return IValue();
+  }
+  c10::List<int64_t> dims;
+  for (const auto& dim : *shape.sizes()) {
+    dims.push_back(dim ? *dim : -1);
+  }
+  return dims;
+}
+
+c10::VaryingShape shapeFromIValue(const IValue& value) {
+  if (value.isNone()) {
+    return c10::VaryingShape();
+  }
+  c10::VaryingShape::ListOfOptionalInts dims;
+  for (int64_t dim : value.toIntList()) {
+    dims.emplace_back(
+        dim < 0 ? c10::nullopt : c10::optional<int64_t>(dim));
+  }
+  return c10::VaryingShape(std::move(dims));
+}
+
+// (scalar type, device, sizes, strides, requires_grad, undefined), with -1,
+// "" and None for unknown values
+IValue typeToIValue(const TensorTypePtr& type) {
+  return c10::ivalue::Tuple::create(
+      {type->scalarType() ? static_cast<int64_t>(*type->scalarType())
+                          : int64_t(-1),
+       type->device() ? type->device()->str() : std::string(),
+       shapeToIValue(type->sizes()),
+       shapeToIValue(type->strides()),
+       optionalToInt(type->requiresGrad()),
+       optionalToInt(type->undefined())});
+}
+
+TensorTypePtr typeFromIValue(const IValue& value) {
+  const auto& elements = value.toTuple()->elements();
+  TORCH_CHECK(elements.size() == 6, "Malformed profiled type");
+  int64_t scalar_type = elements[0].toInt();
+  const std::string& device = elements[1].toStringRef();
+  return TensorType::create(
+      scalar_type < 0
+          ? c10::nullopt
+          : c10::optional<at::ScalarType>(
+                static_cast<at::ScalarType>(scalar_type)),
+      device.empty() ? c10::nullopt : c10::optional<at::Device>(device),
+      shapeFromIValue(elements[2]),
+      shapeFromIValue(elements[3]),
+      optionalFromInt(elements[4].toInt()),
+      optionalFromInt(elements[5].toInt()));
+}
+
+} // namespace
+
+IValue ProfilingRecord::saveProfile() {
+  std::vector<Node*> profile_nodes;
+  collectProfileNodes(profiled_graph_->block(), profile_nodes);
+  std::vector<IValue> types;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Node* n : profile_nodes) {
+      types.push_back(typeToIValue(n->output()->type()->expect<TensorType>()));
+    }
+  }
+  return c10::ivalue::Tuple::create(
+      {profileSignature(profiled_graph_->block()),
+       c10::ivalue::Tuple::create(std::move(types))});
+}
+
+bool ProfilingRecord::loadProfile(const IValue& profile) {
+  if (!profile.isTuple() || profile.toTuple()->elements().size() != 2) {
+    return false;
+  }
+  const auto& elements = profile.toTuple()->elements();
+  if (!elements[0].isString() ||
+      elements[0].toStringRef() != profileSignature(profiled_graph_->block())) {
+    return false;
+  }
+  std::vector<Node*> profile_nodes;
+  collectProfileNodes(profiled_graph_->block(), profile_nodes);
+  const auto& types = elements[1].toTuple()->elements();
+  if (types.size() != profile_nodes.size()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < types.size(); ++i) {
+    profile_nodes[i]->output()->setType(typeFromIValue(types[i]));
+  }
+  profiling_count_ = 0;
+  return true;
+}
+
 std::unique_ptr<ProfilingRecord> ProfilingRecord::instrumentGraph(
     const std::shared_ptr<Graph>& graph) {
   auto new_g = graph->copy();
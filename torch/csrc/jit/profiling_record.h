@@ -33,6 +33,14 @@ struct ProfilingRecord {
   std::shared_ptr<Graph> graph() const {
     return profiled_graph_;
   }
+  // Returns the types recorded so far as a serializable IValue, so that
+  // they can be reused by another process (see GraphExecutor::saveProfile).
+  TORCH_API IValue saveProfile();
+  // Restores the types of a profile returned by saveProfile() for the same
+  // graph and marks the profiling as done. Returns false and leaves the
+  // record unchanged if the profile was taken for another graph.
+  TORCH_API bool loadProfile(const IValue& profile);
+
  private:
   ProfileOp* createProfileNode(
       const std::function<void(Stack&)>& fp,
@@ -11,6 +11,7 @@
 
 #include <c10/util/Exception.h>
 
+#include <map>
 #include <sstream>
 
 using namespace torch::autograd;
@@ -21,16 +22,68 @@ namespace torch {
 namespace jit {
 namespace tracer {
 
+namespace {
+
+// The frames of a Python stack, from the innermost, as their code objects and
+// the offsets of their current instructions
+using PythonStackKey = std::vector<std::pair<PyCodeObject*, int>>;
+
+// Tracing records the Python stack of every node it creates, and the nodes of
+// a model come from a small number of distinct stacks, e.g. the ones of the
+// forward of a module that is called in a loop. The source ranges of the
+// stacks are built once per trace, which keeps the code objects of their keys
+// alive so that their addresses can't be reused.
+struct SourceRangeCache {
+  std::weak_ptr<TracingState> state;
+  std::map<PythonStackKey, SourceRange> ranges;
+  std::vector<PyObject*> code_objects;
+
+  // Must be called with the GIL
+  void clear() {
+    ranges.clear();
+    for (PyObject* code : code_objects) {
+      Py_DECREF(code);
+    }
+    code_objects.clear();
+  }
+};
+
+SourceRangeCache& sourceRangeCache() {
+  // Leaked, so that no Python object is released at thread exit without the
+  // GIL
+  static thread_local auto cache = new SourceRangeCache();
+  return *cache;
+}
+
+} // namespace
+
 // Python interpreter retrieval routine adapted from
 // https://stackoverflow.com/a/8706144
 SourceRange getPythonInterpreterSourceRange() {
+  pybind11::gil_scoped_acquire gil;
+  PyFrameObject* frame = PyEval_GetFrame();
+
+  PythonStackKey key;
+  for (PyFrameObject* f = frame; f != nullptr; f = f->f_back) {
+    key.emplace_back(f->f_code, f->f_lasti);
+  }
+  const auto& state = getTracingState();
+  auto& cache = sourceRangeCache();
+  if (state) {
+    if (cache.state.lock() != state) {
+      cache.clear();
+      cache.state = state;
+    }
+    auto it = cache.ranges.find(key);
+    if (it != cache.ranges.end()) {
+      return it->second;
+    }
+  }
+
   c10::optional<std::string> source_filename;
   size_t source_line = 0;
   std::stringstream stack_trace;
 
-  pybind11::gil_scoped_acquire gil;
-  PyFrameObject* frame = PyEval_GetFrame();
-
   while (nullptr != frame) {
     int line = PyCode_Addr2Line(frame->f_code, frame->f_lasti);
     std::string filename = THPUtils_unpackString(frame->f_code->co_filename);
@@ -46,7 +99,16 @@ SourceRange getPythonInterpreterSourceRange() {
   auto stack_trace_text = stack_trace.str();
   auto source =
       std::make_shared<Source>(stack_trace_text, source_filename, source_line);
-  return SourceRange(source, 0, stack_trace_text.size());
+  SourceRange range(source, 0, stack_trace_text.size());
+  if (state) {
+    for (const auto& entry : key) {
+      PyObject* code = reinterpret_cast<PyObject*>(entry.first);
+      Py_INCREF(code);
+      cache.code_objects.push_back(code);
+    }
+    cache.ranges.emplace(std::move(key), range);
+  }
+  return range;
 }
 
 std::pair<std::shared_ptr<Graph>, Stack> createGraphByTracing(
@@ -82,6 +144,7 @@ std::pair<std::shared_ptr<Graph>, Stack> createGraphByTracing(
       lookup_fn_adapter,
       force_outplace,
       self);
+  sourceRangeCache().clear();
   return std::make_pair(std::get<0>(outs)->graph, std::get<1>(outs));
 }
 
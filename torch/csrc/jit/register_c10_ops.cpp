@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/operator.h>
 #include <torch/csrc/jit/ir.h>
 #include <torch/csrc/jit/tracer.h>
+#include <c10/util/InitStats.h>
 #include <unordered_set>
 
 namespace torch {
@@ -14,10 +15,11 @@ namespace {
 // TODO This currently only handles tensors with requires_grad==False correctly.
 //      It should also handle autograd.
 Operator createOperatorFromC10(const c10::OperatorHandle& op) {
-  return Operator(op, [op](Stack& stack) {
+  // Looked up once here instead of on every call
+  const auto input_size = op.schema().arguments().size();
+  const auto output_size = op.schema().returns().size();
+  return Operator(op, [op, input_size, output_size](Stack& stack) {
       RECORD_FUNCTION(op.schema().name(), stack);
-      const auto input_size = op.schema().arguments().size();
-      const auto output_size = op.schema().returns().size();
 
       Node* node = nullptr;
       std::shared_ptr<jit::tracer::TracingState> tracer_state;
@@ -147,6 +149,7 @@ Operator createOperatorFromC10(const c10::OperatorHandle& op) {
 class RegistrationListener final : public c10::OpRegistrationListener {
 public:
   void onOperatorRegistered(const c10::OperatorHandle& op) override {
+    c10::InitTimer timer("jit::register_c10_ops");
     if(at::is_aten_op(op.schema().operator_name())) {
       // Ignore ATen ops for now because they have their own code
       // to expose them to JIT in register_aten_ops.cpp
@@ -1577,11 +1577,11 @@ template <typename T> int minList(Stack &stack) {
       continue;
     }
 
-    push(stack, a[i] < b[i] ? a : b);
+    push(stack, std::move(a[i] < b[i] ? a : b));
     return 0;
   }
 
-  push(stack, b.size() < a.size() ? b : a);
+  push(stack, std::move(b.size() < a.size() ? b : a));
   return 0;
 }
 
@@ -1595,11 +1595,11 @@ template <typename T> int maxList(Stack &stack) {
       continue;
     }
 
-    push(stack, a[i] > b[i] ? a : b);
+    push(stack, std::move(a[i] > b[i] ? a : b));
     return 0;
   }
 
-  push(stack, b.size() > a.size() ? b : a);
+  push(stack, std::move(b.size() > a.size() ? b : a));
   return 0;
 }
 
@@ -1614,8 +1614,12 @@ int listPopImpl(Stack& stack, const char* empty_message) {
   if (list_size == 0) {
     AT_ERROR(empty_message);
   }
+  if (normalized_idx < 0 || normalized_idx >= list_size) {
+    throw std::out_of_range("list index out of range");
+  }
 
-  push(stack, getItem(list, idx));
+  // The element is erased right after, so move it out instead of copying it.
+  push(stack, list.extract(normalized_idx));
   list.erase(list.begin() + normalized_idx);
 
   return 0;
@@ -1653,12 +1657,12 @@ int listInsert(Stack& stack) {
 
   if (normalized_idx < 0 || normalized_idx >= list_size) {
     if (normalized_idx < 0) {
-      list.insert(list.begin(), elem);
+      list.insert(list.begin(), std::move(elem));
     } else {
-      list.push_back(elem);
+      list.push_back(std::move(elem));
     }
   } else {
-    list.insert(list.begin() + normalized_idx, elem);
+    list.insert(list.begin() + normalized_idx, std::move(elem));
   }
 
   return 0;
@@ -2055,7 +2059,7 @@ int listCopyAndSort(Stack& stack) {
     }
     return a < b;
   });
-  push(stack, list_copied);
+  push(stack, std::move(list_copied));
   return 0;
 }
 
@@ -2070,7 +2074,7 @@ int listCopyAndSort<at::Tensor>(Stack& stack) {
       [](const at::Tensor& a, const at::Tensor& b) {
         return a.lt(b).is_nonzero();
       });
-  push(stack, list_copied);
+  push(stack, std::move(list_copied));
   return 0;
 }
 
@@ -2109,7 +2113,7 @@ int dictValues(Stack& stack) {
   for (const auto& p : order) {
     values.emplace_back(p.second);
   }
-  push(stack, values);
+  push(stack, std::move(values));
   return 0;
 }
 
@@ -2121,7 +2125,7 @@ int dictKeys(Stack& stack) {
   for (const auto& p : order) {
     keys.emplace_back(p.first);
   }
-  push(stack, keys);
+  push(stack, std::move(keys));
   return 0;
 }
 
@@ -2161,7 +2165,7 @@ int dictSetDefault(Stack& stack) {
   auto dict = pop(stack).toGenericDict();
   auto value = dict.find(key);
   if (value == dict.end()) {
-    dict.insert(key, default_value);
+    dict.insert(std::move(key), default_value);
     push(stack, std::move(default_value));
   } else {
     push(stack, value->value());
@@ -2180,16 +2184,15 @@ int dictPop(Stack& stack) {
   auto iter = dict.find(key);
   if (iter == dict.end()) {
     if (has_default) {
-      push(stack, default_value);
+      push(stack, std::move(default_value));
     } else {
       AT_ERROR("KeyError: ", key);
     }
   } else {
     // note: before erase
     push(stack, iter->value());
-    auto erase_count = dict.erase(key);
-    TORCH_CHECK(
-        erase_count == 1, "Expected to erase 1 item, found ", erase_count);
+    // erase through the iterator rather than the key, to skip a second lookup
+    dict.erase(iter);
   }
   return 0;
 }
@@ -2211,8 +2214,9 @@ int dictPopItem(Stack& stack) {
   TORCH_CHECK(
       erase_count == 1, "Expected to erase 1 item, found ", erase_count);
 
-  IValue tuple = c10::ivalue::Tuple::create({item.first, item.second});
-  push(stack, tuple);
+  IValue tuple = c10::ivalue::Tuple::create(
+      {std::move(item.first), std::move(item.second)});
+  push(stack, std::move(tuple));
   return 0;
 }
 
@@ -26,18 +26,22 @@
 #include <torch/csrc/api/include/torch/ordered_dict.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/function_schema.h>
 #include <ATen/core/qualified_name.h>
+#include <caffe2/serialize/mmap_adapter.h>
 
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -242,6 +246,74 @@ FunctionDefaults calcOverloadedFunctionDefaults(
   return updated_defaults;
 }
 
+// Runs method on every element of inputs, which holds the positional
+// arguments of a call (a tuple, or the single argument), on num_threads C++
+// threads. Only the conversions of the arguments and of the results hold the
+// GIL, so that the calls use as many cores as they can even if they were made
+// from a Python thread.
+py::list runMethodConcurrently(
+    Method& method,
+    const py::list& inputs,
+    int64_t num_threads) {
+  TORCH_CHECK(
+      !tracer::isTracing(), "running a method concurrently can't be traced");
+  TORCH_CHECK(num_threads >= 0, "num_threads must be non-negative");
+  Function& function = method.function();
+  const auto self = method.owner()._ivalue();
+  std::vector<Stack> stacks;
+  stacks.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    py::tuple args = py::isinstance<py::tuple>(input)
+        ? py::reinterpret_borrow<py::tuple>(input)
+        : py::make_tuple(input);
+    stacks.push_back(createStackForSchema(
+        function.getSchema(), tuple_slice(std::move(args)), py::kwargs(), self));
+  }
+
+  std::vector<std::exception_ptr> errors(stacks.size());
+  {
+    pybind11::gil_scoped_release no_gil_guard;
+    if (num_threads == 0) {
+      num_threads = at::get_num_interop_threads();
+    }
+    num_threads = std::max<int64_t>(
+        1, std::min<int64_t>(num_threads, stacks.size()));
+    // Grad mode is thread local, the workers run in the mode of the caller
+    const bool grad_enabled = at::GradMode::is_enabled();
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+      at::AutoGradMode grad_mode(grad_enabled);
+      for (size_t i = next++; i < stacks.size(); i = next++) {
+        try {
+          function.run(stacks[i]);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (int64_t t = 1; t < num_threads; t++) {
+      workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  py::list results;
+  for (auto& stack : stacks) {
+    results.append(toPyObject(std::move(stack.back())));
+  }
+  return results;
+}
+
 } // namespace
 
 bool checkMutableFunctionDefault(const py::object& def_arg) {
@@ -1016,6 +1088,11 @@ void initJitScriptBindings(PyObject* module) {
             return invokeScriptMethodFromPython(
                 method, tuple_slice(std::move(args), 1), std::move(kwargs));
           })
+      .def(
+          "_run_concurrently",
+          &runMethodConcurrently,
+          py::arg("inputs"),
+          py::arg("num_threads") = 0)
       .def_property_readonly("graph", &Method::graph)
       .def_property_readonly(
           "schema", [](Method& m) { return m.function().getSchema(); })
@@ -1140,13 +1217,21 @@ void initJitScriptBindings(PyObject* module) {
       [](std::shared_ptr<CompilationUnit> cu,
          const std::string& filename,
          py::object map_location,
-         ExtraFilesMap& extra_files) {
+         ExtraFilesMap& extra_files,
+         bool mmap) {
         c10::optional<at::Device> optional_device;
         if (!map_location.is(py::none())) {
           AT_ASSERT(THPDevice_Check(map_location.ptr()));
           optional_device =
               reinterpret_cast<THPDevice*>(map_location.ptr())->device;
         }
+        if (mmap) {
+          return import_ir_module(
+              std::move(cu),
+              std::make_unique<caffe2::serialize::MmapAdapter>(filename),
+              optional_device,
+              extra_files);
+        }
         return import_ir_module(
             std::move(cu), filename, optional_device, extra_files);
       });
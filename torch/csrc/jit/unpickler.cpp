@@ -1,8 +1,13 @@
 #include <ATen/ATen.h>
 #include <ATen/core/Dict.h>
+#include <c10/core/DeviceGuard.h>
+#include <c10/core/Event.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <torch/csrc/jit/function.h>
 #include <torch/csrc/jit/pickler.h>
 #include "unpickler.h"
+#include <algorithm>
 #include <string>
 
 namespace torch {
@@ -142,7 +147,14 @@ void restoreAccurateTypeTags(const IValue& root, const TypePtr& type_tag) {
 }
 
 IValue Unpickler::parse_ivalue() {
-  run();
+  try {
+    run();
+  } catch (...) {
+    // The device tensors are freed, wait for the copies into them first.
+    syncDeviceCopies();
+    throw;
+  }
+  syncDeviceCopies();
   TORCH_CHECK(
       stack_.size() == 1,
       "Unpickler expected 1 element on the stack, but found ",
@@ -293,7 +305,7 @@ PickleOpCode Unpickler::readInstruction() {
       tuple->elements().reserve(stack_.size() - start);
       auto start_it = stack_.begin() + start;
       for (auto it = start_it; it != stack_.end(); ++it) {
-        tuple->elements().emplace_back(*it);
+        tuple->elements().emplace_back(std::move(*it));
       }
       stack_.erase(start_it, stack_.end());
       stack_.emplace_back(tuple);
@@ -328,8 +340,9 @@ PickleOpCode Unpickler::readInstruction() {
       size_t start = marks_.back();
       marks_.pop_back();
       auto dict = c10::impl::GenericDict(AnyType::get(), AnyType::get());
+      dict.reserve((stack_.size() - start) / 2);
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
       stack_.push_back(std::move(dict));
@@ -338,8 +351,9 @@ PickleOpCode Unpickler::readInstruction() {
       size_t start = marks_.back();
       marks_.pop_back();
       auto dict = stack_.at(start - 1).toGenericDict();
+      dict.reserve(dict.size() + (stack_.size() - start) / 2);
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
     } break;
@@ -404,7 +418,7 @@ PickleOpCode Unpickler::readInstruction() {
       }
 
       if (device.type() == at::DeviceType::CUDA) {
-        tensor = tensor.to(device, tensor.scalar_type());
+        tensor = copyToDevice(tensor, device);
       } else if (device.type() != at::DeviceType::CPU) {
         AT_ERROR(
             "supported devices include CPU and CUDA, however got ",
@@ -603,14 +617,68 @@ void Unpickler::rebuildTensor(bool quantized) {
   });
 }
 
+// Size of the pinned buffers that records are staged in.
+constexpr int64_t kDeviceCopyChunkBytes = 16 * 1024 * 1024;
+
+// Copies a storage tensor that was just read to the device without building
+// up pageable host copies: the record goes through pinned chunks and the
+// host-to-device copies are issued asynchronously on a side stream, so they
+// overlap with the reads and copies of the following records. The caching
+// host allocator only hands a chunk out again once its copy is done.
+// syncDeviceCopies() makes the current streams wait for the copies.
+at::Tensor Unpickler::copyToDevice(
+    const at::Tensor& tensor,
+    c10::Device device) {
+  if (tensor.is_quantized()) {
+    return tensor.to(device, tensor.scalar_type());
+  }
+  c10::DeviceGuard device_guard(device);
+  device = device_guard.current_device();
+  auto it = std::find_if(
+      copy_streams_.begin(),
+      copy_streams_.end(),
+      [&](const c10::Stream& stream) { return stream.device() == device; });
+  if (it == copy_streams_.end()) {
+    c10::impl::VirtualGuardImpl impl(device.type());
+    copy_streams_.push_back(impl.getStreamFromPool(device));
+    it = copy_streams_.end() - 1;
+  }
+
+  auto result = at::empty({tensor.numel()}, tensor.options().device(device));
+  c10::StreamGuard stream_guard(*it);
+  const int64_t chunk_numel =
+      std::max<int64_t>(kDeviceCopyChunkBytes / tensor.element_size(), 1);
+  for (int64_t begin = 0; begin < tensor.numel(); begin += chunk_numel) {
+    int64_t length = std::min(chunk_numel, tensor.numel() - begin);
+    auto staging =
+        at::empty({length}, tensor.options().pinned_memory(true));
+    staging.copy_(tensor.narrow(0, begin, length));
+    result.narrow(0, begin, length).copy_(staging, /*non_blocking=*/true);
+  }
+  return result;
+}
+
+void Unpickler::syncDeviceCopies() {
+  for (const auto& stream : copy_streams_) {
+    c10::impl::VirtualGuardImpl impl(stream.device_type());
+    c10::Event event(stream.device_type());
+    event.record(stream);
+    event.block(impl.getStream(stream.device()));
+  }
+  copy_streams_.clear();
+}
+
 void Unpickler::readSlowWithBuffer(char *dest, size_t sz) {
   // First, read any partial from buffer (may be 0).
   // We explicitly assume that sz > buffer_remaining_,
   // and that sz is never bigger than buffer_.size().
   AT_ASSERT(sz > buffer_remaining_);
+  if (!reader_) {
+    AT_ERROR("Unexpected end of pickler archive.");
+  }
   const size_t from_old_buf = buffer_remaining_;
   if (from_old_buf != 0) {
-    memcpy(dest, buffer_.data() + buffer_pos_, from_old_buf);
+    memcpy(dest, buffer_data_ + buffer_pos_, from_old_buf);
   }
   const size_t needed = sz - from_old_buf;
   // Full read into the buffer. The calls here all explicitly
@@ -631,7 +699,7 @@ std::string Unpickler::readBytes(size_t length) {
   static const size_t kSmallString = 64;
   if (length <= buffer_remaining_) {
     // Fast-path: entirely in buffer.
-    memcpy(&data[0], buffer_.data() + buffer_pos_, length);
+    memcpy(&data[0], buffer_data_ + buffer_pos_, length);
     buffer_pos_ += length;
     buffer_remaining_ -= length;
   } else if (length <= kSmallString) {
@@ -641,9 +709,12 @@ std::string Unpickler::readBytes(size_t length) {
   } else {
     // Otherwise, for larger strings, read what we can from
     // the buffer, and then read directly to the destination.
+    if (!reader_) {
+      AT_ERROR("Unexpected end of pickler archive.");
+    }
     const size_t from_old_buf = buffer_remaining_;
     if (from_old_buf != 0) {
-      memcpy(&data[0], buffer_.data() + buffer_pos_, from_old_buf);
+      memcpy(&data[0], buffer_data_ + buffer_pos_, from_old_buf);
     }
     const size_t needed = length - from_old_buf;
     size_t nread = reader_(&data[from_old_buf], needed);
@@ -689,9 +760,10 @@ void Unpickler::readList(IValue list_ivalue) {
     }
   } else if (list_ivalue.isList()) {
     auto list = std::move(list_ivalue).toList();
-    list.reserve(num_elements);
-    for (const auto& elem : elements) {
-      list.emplace_back(elem);
+    list.reserve(list.size() + num_elements);
+    // the elements are erased from the stack below
+    for (size_t i = start; i < stack_.size(); ++i) {
+      list.emplace_back(std::move(stack_[i]));
     }
   } else {
     AT_ERROR("Unknown IValue list kind: ", list_ivalue.tagKind());
@@ -707,6 +779,25 @@ inline bool is_valid_python_id_char(char c) {
 
 // Read a newline terminated string
 std::string Unpickler::readString() {
+  // Fast path: the whole line is buffered.
+  const char* begin = buffer_data_ + buffer_pos_;
+  const void* newline = memchr(begin, '\n', buffer_remaining_);
+  if (newline) {
+    const char* end = static_cast<const char*>(newline);
+    for (const char* c = begin; c != end; ++c) {
+      TORCH_CHECK(
+          is_valid_python_id_char(*c),
+          "Found character '",
+          int(uint8_t(*c)),
+          "' in string, ",
+          "strings must be qualified Python identifiers");
+    }
+    size_t length = end - begin;
+    buffer_pos_ += length + 1;
+    buffer_remaining_ -= length + 1;
+    return std::string(begin, length);
+  }
+
   std::string ss;
   while (true) {
     char c = read<char>();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <c10/core/Stream.h>
+
 #include "pickler.h"
 
 namespace torch {
@@ -43,6 +45,34 @@ class Unpickler {
         read_record_(std::move(read_record)),
         device_(std::move(device)) {}
 
+  // Like the constructors above, for a pickle that is entirely in memory.
+  // It's parsed straight from `data`, which must outlive the Unpickler,
+  // instead of being copied through a reader and the small buffer.
+  Unpickler(
+      const char* data,
+      size_t size,
+      ClassResolver class_resolver,
+      const std::vector<at::Tensor>* tensor_table)
+      : buffer_data_(data),
+        buffer_remaining_(size),
+        tensor_table_(tensor_table),
+        class_resolver_(std::move(class_resolver)) {}
+
+  Unpickler(
+      const char* data,
+      size_t size,
+      ClassResolver class_resolver,
+      ObjLoader obj_loader,
+      std::function<at::DataPtr(const std::string&)> read_record,
+      c10::optional<at::Device> device)
+      : buffer_data_(data),
+        buffer_remaining_(size),
+        tensor_table_(nullptr),
+        class_resolver_(std::move(class_resolver)),
+        obj_loader_(std::move(obj_loader)),
+        read_record_(std::move(read_record)),
+        device_(std::move(device)) {}
+
   // consume the pickle stream, producing an IValue from the contents.
   // Type Tags: the pickler will restore the type tags on
   // List and Dict objects when possible IValue is an Object.
@@ -59,7 +89,7 @@ class Unpickler {
     T item;
     if (sizeof(T) <= buffer_remaining_) {
       // Fast path: entirely from buffer.
-      memcpy(&item, buffer_.data() + buffer_pos_, sizeof(T));
+      memcpy(&item, buffer_data_ + buffer_pos_, sizeof(T));
       buffer_remaining_ -= sizeof(T);
       buffer_pos_ += sizeof(T);
     } else {
@@ -76,6 +106,8 @@ class Unpickler {
       const std::string& module_name,
       const std::string& class_name);
   void rebuildTensor(bool quantized);
+  at::Tensor copyToDevice(const at::Tensor& tensor, c10::Device device);
+  void syncDeviceCopies();
   PickleOpCode readInstruction();
   PickleOpCode readOpCode() {
     return static_cast<PickleOpCode>(read<uint8_t>());
@@ -86,10 +118,13 @@ class Unpickler {
   void run();
 
   // Returns the number of bytes read. This should statefully
-  // remember the position. Don't call reader_ directly.
+  // remember the position. Don't call reader_ directly. Empty if the whole
+  // pickle is in buffer_data_.
   std::function<size_t(char*, size_t)> reader_;
   // Small buffer to avoid calling reader_ on a per-byte basis.
   std::array<char, 256> buffer_;
+  // The data being read: buffer_, or the pickle if it's all in memory.
+  const char* buffer_data_{buffer_.data()};
   size_t buffer_pos_{0};
   size_t buffer_remaining_{0};
 
@@ -109,6 +144,8 @@ class Unpickler {
 
   std::function<at::DataPtr(const std::string&)> read_record_;
   c10::optional<at::Device> device_;
+  // Side streams of copyToDevice, one per device.
+  std::vector<c10::Stream> copy_streams_;
 };
 
 void restoreAccurateTypeTags(const IValue& root, const c10::TypePtr& type_tag);
@@ -0,0 +1,196 @@
+#include <torch/csrc/utils/batching_executor.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace torch {
+namespace throughput_benchmark {
+
+BatchingExecutor::BatchingExecutor(
+    jit::script::Module module,
+    BatchingConfig config)
+    : module_(std::move(module)), config_(config) {
+  TORCH_CHECK(
+      config_.max_batch_size >= 1,
+      "max_batch_size has to be positive, got ",
+      config_.max_batch_size);
+  TORCH_CHECK(
+      config_.num_worker_threads >= 1,
+      "num_worker_threads has to be positive, got ",
+      config_.num_worker_threads);
+  for (int i = 0; i < config_.num_worker_threads; ++i) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+BatchingExecutor::~BatchingExecutor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  for (auto& request : queue_) {
+    request.result.set_exception(std::make_exception_ptr(
+        std::runtime_error("BatchingExecutor was destroyed")));
+  }
+}
+
+std::future<at::IValue> BatchingExecutor::submit(
+    std::vector<at::IValue> inputs) {
+  Request request;
+  request.inputs = std::move(inputs);
+  request.submit_time = Clock::now();
+  auto result = request.result.get_future();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_CHECK(!stopped_, "BatchingExecutor was destroyed");
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return result;
+}
+
+at::IValue BatchingExecutor::run(std::vector<at::IValue> inputs) {
+  return submit(std::move(inputs)).get();
+}
+
+BenchmarkExecutionStats BatchingExecutor::stats() const {
+  std::lock_guard<std::mutex> guard(stats_mutex_);
+  BenchmarkExecutionStats stats;
+  stats.num_iters = num_requests_;
+  if (num_requests_ > 0) {
+    stats.latency_avg_ms = total_latency_ms_ / num_requests_;
+  }
+  return stats;
+}
+
+void BatchingExecutor::workerLoop() {
+  while (true) {
+    std::vector<Request> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      // The deadline is counted from the oldest request, so that its latency
+      // is bounded by the delay and one forward call
+      const auto deadline =
+          queue_.front().submit_time + config_.max_batch_delay;
+      cv_.wait_until(lock, deadline, [this] {
+        return stopped_ ||
+            static_cast<int64_t>(queue_.size()) >= config_.max_batch_size;
+      });
+      if (stopped_) {
+        return;
+      }
+      if (queue_.empty()) {
+        // Another worker took the requests while this one waited
+        continue;
+      }
+      const size_t size =
+          std::min<size_t>(queue_.size(), config_.max_batch_size);
+      for (size_t i = 0; i < size; ++i) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      if (!queue_.empty()) {
+        cv_.notify_one();
+      }
+    }
+    runBatch(batch);
+  }
+}
+
+void BatchingExecutor::runBatch(std::vector<Request>& batch) {
+  const int64_t batch_size = batch.size();
+  std::vector<at::IValue> results;
+  try {
+    const auto& first = batch.front().inputs;
+    std::vector<at::IValue> inputs;
+    for (size_t i = 0; i < first.size(); ++i) {
+      if (!first[i].isTensor()) {
+        inputs.push_back(first[i]);
+        continue;
+      }
+      std::vector<at::Tensor> tensors;
+      for (const auto& request : batch) {
+        TORCH_CHECK(
+            request.inputs.size() == first.size() &&
+                request.inputs[i].isTensor(),
+            "Requests of a batch need the same arguments");
+        tensors.push_back(request.inputs[i].toTensor());
+      }
+      inputs.emplace_back(at::stack(tensors));
+    }
+
+    auto output = module_.forward(std::move(inputs));
+
+    if (output.isTensor()) {
+      auto parts = output.toTensor().unbind(0);
+      TORCH_CHECK(
+          static_cast<int64_t>(parts.size()) == batch_size,
+          "Expected an output with a batch of ",
+          batch_size,
+          ", got ",
+          parts.size());
+      results.assign(parts.begin(), parts.end());
+    } else {
+      TORCH_CHECK(
+          output.isTuple(),
+          "Expected forward to return a tensor or a tuple of tensors");
+      std::vector<std::vector<at::IValue>> elements(batch_size);
+      for (const auto& element : output.toTuple()->elements()) {
+        TORCH_CHECK(
+            element.isTensor(),
+            "Expected forward to return a tensor or a tuple of tensors");
+        auto parts = element.toTensor().unbind(0);
+        TORCH_CHECK(
+            static_cast<int64_t>(parts.size()) == batch_size,
+            "Expected outputs with a batch of ",
+            batch_size,
+            ", got ",
+            parts.size());
+        for (int64_t r = 0; r < batch_size; ++r) {
+          elements[r].emplace_back(std::move(parts[r]));
+        }
+      }
+      for (auto& request_elements : elements) {
+        results.emplace_back(
+            c10::ivalue::Tuple::create(std::move(request_elements)));
+      }
+    }
+  } catch (...) {
+    for (auto& request : batch) {
+      request.result.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  // The stats are updated first so that they include a request as soon as
+  // its caller sees the result
+  const auto end_time = Clock::now();
+  double latency_ms = 0;
+  for (const auto& request : batch) {
+    latency_ms += std::chrono::duration<double, std::milli>(
+                      end_time - request.submit_time)
+                      .count();
+  }
+  {
+    std::lock_guard<std::mutex> guard(stats_mutex_);
+    num_requests_ += batch_size;
+    total_latency_ms_ += latency_ms;
+  }
+  for (int64_t r = 0; r < batch_size; ++r) {
+    batch[r].result.set_value(std::move(results[r]));
+  }
+}
+
+} // namespace throughput_benchmark
+} // namespace torch
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/script/module.h>
+#include <torch/csrc/utils/throughput_benchmark_stats.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace throughput_benchmark {
+
+/**
+ * Use this struct in order to configure a BatchingExecutor.
+ */
+struct BatchingConfig {
+  // Largest number of requests stacked into one forward call.
+  int64_t max_batch_size{8};
+  // How long the first request of a batch waits for more requests before
+  // the batch runs without them.
+  std::chrono::microseconds max_batch_delay{1000};
+  // Threads running forward calls. Batches are formed while others run.
+  int num_worker_threads{1};
+};
+
+/**
+ * This class serves single-example requests to a ScriptModule from any
+ * number of calling threads, by running them in batches.
+ *
+ * Each request is the list of forward arguments for one example, without a
+ * batch dimension. Requests are queued, and a worker thread takes up to
+ * max_batch_size of them, waiting at most max_batch_delay after the first
+ * one, stacks each tensor argument along a new first dimension, and runs
+ * forward once. Non-tensor arguments are taken from the first request of the
+ * batch, they have to be the same for all of them. The output of forward, a
+ * tensor or a tuple of tensors with the batch as their first dimension, is
+ * unbound back into one result per request.
+ *
+ * Statistics are reported as BenchmarkExecutionStats, with the average
+ * latency of a request from submit() until its result is ready.
+ */
+class TORCH_API BatchingExecutor {
+ public:
+  BatchingExecutor(jit::script::Module module, BatchingConfig config);
+
+  BatchingExecutor(const BatchingExecutor&) = delete;
+  BatchingExecutor& operator=(const BatchingExecutor&) = delete;
+
+  // Requests still in the queue fail once the executor is destroyed.
+  ~BatchingExecutor();
+
+  // Queues a request. An error while running its batch is reported through
+  // the future.
+  std::future<at::IValue> submit(std::vector<at::IValue> inputs);
+
+  // Runs a request and waits for its result.
+  at::IValue run(std::vector<at::IValue> inputs);
+
+  // Statistics of the requests completed so far.
+  BenchmarkExecutionStats stats() const;
+
+  const jit::script::Module& module() const {
+    return module_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    std::vector<at::IValue> inputs;
+    std::promise<at::IValue> result;
+    Clock::time_point submit_time;
+  };
+
+  void workerLoop();
+  void runBatch(std::vector<Request>& batch);
+
+  jit::script::Module module_;
+  BatchingConfig config_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool stopped_{false};
+  std::vector<std::thread> workers_;
+
+  mutable std::mutex stats_mutex_;
+  int64_t num_requests_{0};
+  double total_latency_ms_{0};
+};
+
+} // namespace throughput_benchmark
+} // namespace torch
@@ -1,4 +1,5 @@
 #include <ATen/core/ivalue.h>
+#include <torch/csrc/utils/batching_executor.h>
 #include <torch/csrc/utils/init.h>
 #include <torch/csrc/utils/throughput_benchmark.h>
 
@@ -45,6 +46,40 @@ void initThroughputBenchmarkBindings(PyObject* module) {
         return self.benchmark(config);
       });
 
+  py::class_<BatchingConfig>(m, "BatchingConfig")
+      .def(py::init<>())
+      .def_readwrite("max_batch_size", &BatchingConfig::max_batch_size)
+      .def_property(
+          "max_batch_delay_us",
+          [](const BatchingConfig& self) {
+            return self.max_batch_delay.count();
+          },
+          [](BatchingConfig& self, int64_t us) {
+            self.max_batch_delay = std::chrono::microseconds(us);
+          })
+      .def_readwrite("num_worker_threads", &BatchingConfig::num_worker_threads);
+
+  py::class_<BatchingExecutor>(m, "BatchingExecutor")
+      .def(py::init<jit::script::Module, BatchingConfig>())
+      .def(
+          "run",
+          [](BatchingExecutor& self, py::args args, py::kwargs kwargs) {
+            auto inputs = jit::createStackForSchema(
+                self.module().get_method("forward").function().getSchema(),
+                std::move(args),
+                std::move(kwargs),
+                self.module()._ivalue());
+            // forward() takes the arguments without self
+            inputs.erase(inputs.begin());
+            c10::IValue result;
+            {
+              pybind11::gil_scoped_release no_gil_guard;
+              result = self.run(std::move(inputs));
+            }
+            return jit::toPyObject(std::move(result));
+          })
+      .def("stats", &BatchingExecutor::stats);
+
 
 }
 
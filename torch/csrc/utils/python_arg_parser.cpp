@@ -699,6 +699,91 @@ void PythonArgParser::check_deprecated(const FunctionSignature & signature) {
   }
 }
 
+namespace {
+
+// Types for which FunctionParameter::check gives the same answer for all
+// objects of the type, except in the cases handled by remember_call
+bool is_common_arg_type(PyTypeObject* type) {
+  return type == reinterpret_cast<PyTypeObject*>(THPVariableClass) ||
+      type == &PyLong_Type ||
+#if PY_MAJOR_VERSION == 2
+      type == &PyInt_Type ||
+#endif
+      type == &PyFloat_Type || type == &PyBool_Type || type == Py_TYPE(Py_None) ||
+      type == &PyTuple_Type || type == &PyList_Type;
+}
+
+} // namespace
+
+bool PythonArgParser::CallTypes::operator==(const CallTypes& other) const {
+  if (nargs != other.nargs) {
+    return false;
+  }
+  for (ssize_t i = 0; i < nargs; i++) {
+    if (types[i] != other.types[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PythonArgParser::get_call_types(PyObject* args, PyObject* kwargs, CallTypes& call) {
+  if (kwargs && PyDict_Size(kwargs) > 0) {
+    return false;
+  }
+  const auto nargs = PyTuple_GET_SIZE(args);
+  if (nargs > kMaxCachedArgs) {
+    return false;
+  }
+  for (ssize_t i = 0; i < nargs; i++) {
+    auto type = Py_TYPE(PyTuple_GET_ITEM(args, i));
+    if (!is_common_arg_type(type)) {
+      return false;
+    }
+    call.types[i] = type;
+  }
+  call.nargs = nargs;
+  return true;
+}
+
+void PythonArgParser::remember_call(const CallTypes& call, int signature) {
+  // The signatures before the one that bound the call rejected it, but some
+  // of them could accept other arguments of the same types:
+  //  - zero-dim tensors bind to number parameters,
+  //  - integer tensors bind to a var-args int list, through __index__,
+  //  - tuples and lists bind to Dimname lists depending on their elements.
+  // Such calls are not cached.
+  for (int i = 0; i < signature; i++) {
+    const auto& sig = signatures_[i];
+    for (ssize_t k = 0; k < call.nargs && k < static_cast<ssize_t>(sig.params.size()); k++) {
+      const auto type = sig.params[k].type_;
+      if (call.types[k] == reinterpret_cast<PyTypeObject*>(THPVariableClass)) {
+        if (type == ParameterType::SCALAR || type == ParameterType::COMPLEX ||
+            type == ParameterType::DOUBLE || type == ParameterType::INT64 ||
+            (type == ParameterType::INT_LIST && sig.max_pos_args == 1 && k == 0)) {
+          return;
+        }
+      } else if (call.types[k] == &PyTuple_Type || call.types[k] == &PyList_Type) {
+        if (type == ParameterType::DIMNAME_LIST) {
+          return;
+        }
+      }
+    }
+  }
+  if (!signatures_[signature].overloaded_args.empty()) {
+    return;
+  }
+  for (auto& cached : call_cache_) {
+    if (cached.signature >= 0 && cached.call == call) {
+      cached.signature = signature;
+      return;
+    }
+  }
+  call_cache_[next_cache_slot_].call = call;
+  call_cache_[next_cache_slot_].signature = signature;
+  next_cache_slot_ = (next_cache_slot_ + 1) % kCallCacheSize;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
@@ -707,8 +792,30 @@ PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject
     return PythonArgs(traceable, signature, parsed_args);
   }
 
-  for (auto& signature : signatures_) {
+  // Loops calling an overloaded function usually pass arguments of the same
+  // types every time, so the signature that bound the last such call is tried
+  // first
+  CallTypes call;
+  const bool cacheable = get_call_types(args, kwargs, call);
+  if (cacheable) {
+    for (const auto& cached : call_cache_) {
+      if (cached.signature >= 0 && cached.call == call) {
+        auto& signature = signatures_[cached.signature];
+        if (signature.parse(args, kwargs, parsed_args, false)) {
+          check_deprecated(signature);
+          return PythonArgs(traceable, signature, parsed_args);
+        }
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < signatures_.size(); i++) {
+    auto& signature = signatures_[i];
     if (signature.parse(args, kwargs, parsed_args, false)) {
+      if (cacheable) {
+        remember_call(call, i);
+      }
       check_deprecated(signature);
       return PythonArgs(traceable, signature, parsed_args);
     }
@@ -102,15 +102,39 @@ struct PythonArgParser {
   std::vector<std::string> get_signatures() const;
 
 private:
+  // The number and the exact types of the arguments of a positional call
+  // whose arguments are all of common types (tensors, numbers, None, tuples
+  // and lists). For these, whether a signature accepts the arguments
+  // depends only on their types, with the exceptions listed in
+  // PythonArgParser::remember_call.
+  static constexpr int kMaxCachedArgs = 6;
+  struct CallTypes {
+    ssize_t nargs = -1;
+    std::array<PyTypeObject*, kMaxCachedArgs> types;
+    bool operator==(const CallTypes& other) const;
+  };
+
+  // Signatures that bound recent calls, tried first for calls with the same
+  // argument types. Only used with the GIL held.
+  static constexpr int kCallCacheSize = 4;
+  struct CachedCall {
+    CallTypes call;
+    int signature = -1;
+  };
+
   [[noreturn]]
   void print_error(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
   void check_deprecated(const FunctionSignature & signature);
   PythonArgs raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
+  static bool get_call_types(PyObject* args, PyObject* kwargs, CallTypes& call);
+  void remember_call(const CallTypes& call, int signature);
 
   std::vector<FunctionSignature> signatures_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
+  std::array<CachedCall, kCallCacheSize> call_cache_;
+  int next_cache_slot_ = 0;
 };
 
 struct PYBIND11_EXPORT FunctionSignature {
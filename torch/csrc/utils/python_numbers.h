@@ -41,6 +41,10 @@ inline PyObject* THPUtils_packDoubleAsInt(double value) {
 }
 
 inline bool THPUtils_checkLong(PyObject* obj) {
+  // Fast path for plain ints, before the slower numpy type checks
+  if (PyLong_CheckExact(obj)) {
+    return true;
+  }
 #ifdef USE_NUMPY
   if (torch::utils::is_numpy_int(obj)) {
     return true;
@@ -106,6 +110,9 @@ inline bool THPUtils_unpackBool(PyObject* obj) {
 }
 
 inline bool THPUtils_checkDouble(PyObject* obj) {
+  if (PyFloat_CheckExact(obj) || PyLong_CheckExact(obj)) {
+    return true;
+  }
 #ifdef USE_NUMPY
   if (torch::utils::is_numpy_scalar(obj)) {
     return true;
@@ -23,7 +23,9 @@
 #include <c10/util/Exception.h>
 #include <c10/util/Optional.h>
 
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 using at::Backend;
@@ -149,6 +151,13 @@ std::vector<int64_t> compute_sizes(PyObject* seq) {
 }
 
 ScalarType infer_scalar_type(PyObject *obj) {
+  // Plain Python numbers first, they are the elements of nested lists
+  if (PyFloat_CheckExact(obj)) {
+    return torch::tensors::get_default_scalar_type();
+  }
+  if (PyLong_CheckExact(obj)) {
+    return ScalarType::Long;
+  }
 #ifdef USE_NUMPY
   if (PyArray_Check(obj)) {
     return numpy_dtype_to_aten(PyArray_TYPE((PyArrayObject*)obj));
@@ -182,10 +191,18 @@ ScalarType infer_scalar_type(PyObject *obj) {
     if (length < 0) throw python_error();
     // match NumPy semantics, except use default tensor type instead of double.
     if (length == 0) return torch::tensors::get_default_scalar_type();
+    // Lists and tuples lend their items without new references
+    const bool is_list_or_tuple = PyList_CheckExact(obj) || PyTuple_CheckExact(obj);
     for (int i = 0; i < length; ++i) {
-      THPObjectPtr handle(PySequence_GetItem(obj, i));
-      if (!handle) throw python_error();
-      auto cur_item = handle.get();
+      THPObjectPtr handle;
+      PyObject* cur_item;
+      if (is_list_or_tuple) {
+        cur_item = PySequence_Fast_GET_ITEM(obj, i);
+      } else {
+        handle = THPObjectPtr(PySequence_GetItem(obj, i));
+        if (!handle) throw python_error();
+        cur_item = handle.get();
+      }
       if (cur_item == obj) throw TypeError("new(): self-referential lists are incompatible");
       ScalarType item_scalarType = infer_scalar_type(cur_item);
       scalarType = (scalarType) ?
@@ -200,6 +217,45 @@ ScalarType infer_scalar_type(PyObject *obj) {
   AT_ERROR("Could not infer dtype of ", Py_TYPE(obj)->tp_name);
 }
 
+// Stores the elements of the innermost dimension. Python floats stored as
+// floating point tensors and Python ints stored as int64, the common cases,
+// are converted without going through store_scalar for every element.
+void store_innermost(char* data, int64_t stride, ScalarType scalarType, PyObject** items, int64_t n) {
+  switch (scalarType) {
+    case ScalarType::Float:
+      for (int64_t i = 0; i < n; i++, data += stride) {
+        if (PyFloat_CheckExact(items[i])) {
+          *(float*)data = (float)PyFloat_AS_DOUBLE(items[i]);
+        } else {
+          torch::utils::store_scalar(data, scalarType, items[i]);
+        }
+      }
+      break;
+    case ScalarType::Double:
+      for (int64_t i = 0; i < n; i++, data += stride) {
+        if (PyFloat_CheckExact(items[i])) {
+          *(double*)data = PyFloat_AS_DOUBLE(items[i]);
+        } else {
+          torch::utils::store_scalar(data, scalarType, items[i]);
+        }
+      }
+      break;
+    case ScalarType::Long:
+      for (int64_t i = 0; i < n; i++, data += stride) {
+        if (PyLong_CheckExact(items[i])) {
+          *(int64_t*)data = THPUtils_unpackLong(items[i]);
+        } else {
+          torch::utils::store_scalar(data, scalarType, items[i]);
+        }
+      }
+      break;
+    default:
+      for (int64_t i = 0; i < n; i++, data += stride) {
+        torch::utils::store_scalar(data, scalarType, items[i]);
+      }
+  }
+}
+
 void recursive_store(char* data, IntArrayRef sizes, IntArrayRef strides, int64_t dim,
                             ScalarType scalarType, int elementSize, PyObject* obj) {
   int64_t ndim = sizes.size();
@@ -218,12 +274,116 @@ void recursive_store(char* data, IntArrayRef sizes, IntArrayRef strides, int64_t
   }
 
   PyObject** items = PySequence_Fast_ITEMS(seq.get());
+  if (dim == ndim - 1) {
+    store_innermost(data, strides[dim] * elementSize, scalarType, items, n);
+    return;
+  }
   for (int64_t i = 0; i < n; i++) {
     recursive_store(data, sizes, strides, dim + 1, scalarType, elementSize, items[i]);
     data += strides[dim] * elementSize;
   }
 }
 
+struct BufferReleaser {
+  void operator()(Py_buffer* view) const {
+    PyBuffer_Release(view);
+    delete view;
+  }
+};
+using BufferPtr = std::unique_ptr<Py_buffer, BufferReleaser>;
+
+// Requests a buffer of obj with the given flags, writable if possible
+BufferPtr get_buffer(PyObject* obj, int flags) {
+  BufferPtr view(new Py_buffer());
+  if (PyObject_GetBuffer(obj, view.get(), flags | PyBUF_WRITABLE) < 0) {
+    PyErr_Clear();
+    if (PyObject_GetBuffer(obj, view.get(), flags) < 0) {
+      // the view was not filled, there is nothing to release
+      delete view.release();
+      throw python_error();
+    }
+    TORCH_WARN_ONCE(
+        "The given buffer is not writable, and PyTorch does not support non-writable tensors. "
+        "This means you can write to the underlying (supposedly non-writable) buffer using "
+        "the tensor. You may want to copy the buffer to protect its data or make it writable "
+        "before converting it to a tensor. This type of warning will be suppressed for the "
+        "rest of this program.");
+  }
+  return view;
+}
+
+// The ScalarType of the elements of a buffer, described by their struct
+// module format (PEP 3118) and size
+c10::optional<ScalarType> buffer_scalar_type(const char* format, Py_ssize_t itemsize) {
+  if (!format) {
+    return ScalarType::Byte;
+  }
+  // Only the native byte order is supported
+  const uint16_t one = 1;
+  const bool little_endian = *reinterpret_cast<const uint8_t*>(&one) == 1;
+  if (*format == '@' || *format == '=' ||
+      (*format == '<' && little_endian) ||
+      ((*format == '>' || *format == '!') && !little_endian)) {
+    format++;
+  }
+  const std::string f(format);
+  if (f == "?" && itemsize == 1) return ScalarType::Bool;
+  if (f == "b" && itemsize == 1) return ScalarType::Char;
+  if (f == "B" && itemsize == 1) return ScalarType::Byte;
+  if (f == "h" || f == "i" || f == "l" || f == "q" || f == "n") {
+    switch (itemsize) {
+      case 2: return ScalarType::Short;
+      case 4: return ScalarType::Int;
+      case 8: return ScalarType::Long;
+    }
+  }
+  if (f == "e" && itemsize == 2) return ScalarType::Half;
+  if (f == "f" && itemsize == 4) return ScalarType::Float;
+  if (f == "d" && itemsize == 8) return ScalarType::Double;
+  if (f == "Zf" && itemsize == 8) return ScalarType::ComplexFloat;
+  if (f == "Zd" && itemsize == 16) return ScalarType::ComplexDouble;
+  return c10::nullopt;
+}
+
+// A CPU tensor that shares the memory of the buffer, and keeps it alive
+Tensor tensor_from_buffer_view(
+    BufferPtr view, void* data, IntArrayRef sizes, IntArrayRef strides, ScalarType scalar_type) {
+  Py_buffer* raw_view = view.release();
+  return at::from_blob(
+      data,
+      sizes,
+      strides,
+      [raw_view](void*) {
+        pybind11::gil_scoped_acquire gil;
+        BufferReleaser()(raw_view);
+      },
+      at::device(kCPU).dtype(scalar_type));
+}
+
+// Shares the memory of an object that exposes the buffer protocol, with the
+// shape, strides and element type of the buffer
+Tensor tensor_from_buffer(PyObject* obj) {
+  auto view = get_buffer(obj, PyBUF_RECORDS_RO);
+  auto scalar_type = buffer_scalar_type(view->format, view->itemsize);
+  if (!scalar_type) {
+    throw TypeError("can't convert a buffer with format '%s' and item size %d to a tensor",
+        view->format, (int)view->itemsize);
+  }
+  std::vector<int64_t> sizes(view->shape, view->shape + view->ndim);
+  std::vector<int64_t> strides(view->ndim);
+  for (int i = 0; i < view->ndim; i++) {
+    // Buffer strides use bytes. Torch strides use element counts.
+    if (view->strides[i] < 0 || view->strides[i] % view->itemsize != 0) {
+      throw ValueError(
+          "the given buffer has negative strides or strides that are not a multiple of "
+          "the element size, which tensors do not support. Copy the buffer first.");
+    }
+    strides[i] = view->strides[i] / view->itemsize;
+  }
+  void* data = view->buf;
+  return tensor_from_buffer_view(std::move(view), data, sizes, strides, *scalar_type);
+}
+
 Tensor internal_new_from_data(
     c10::DispatchKey dispatch_key,
     at::ScalarType scalar_type,
@@ -275,6 +435,20 @@ Tensor internal_new_from_data(
   }
 #endif
 
+  // Objects that expose the buffer protocol without being sequences share
+  // their memory, like arrays. Sequences that also expose it (bytes,
+  // array.array, memoryview) are still read element by element, which
+  // keeps the dtype they were given so far.
+  if (PyObject_CheckBuffer(data) && !PySequence_Check(data)) {
+    TORCH_CHECK(!pin_memory, "Can't pin tensor constructed from a buffer");
+    auto tensor = tensor_from_buffer(data);
+    const auto& inferred_scalar_type = type_inference ? tensor.scalar_type() : scalar_type;
+    auto device = device_opt.has_value() ? *device_opt : at::Device(computeDeviceType(dispatch_key));
+    pybind11::gil_scoped_release no_gil;
+    maybe_initialize_cuda(device);
+    return tensor.to(device, inferred_scalar_type, /*non_blocking=*/false, /*copy=*/copy_numpy);
+  }
+
   auto sizes = compute_sizes(data);
   ScalarType inferred_scalar_type = type_inference ? infer_scalar_type(data) : scalar_type;
   // This exists to prevent us from tracing the call to empty().  The actual
@@ -664,6 +838,49 @@ Tensor as_tensor(c10::DispatchKey dispatch_key, at::ScalarType scalar_type, PyOb
   throw std::runtime_error("tensor(): invalid arguments");
 }
 
+Tensor frombuffer(PyObject* args, PyObject* kwargs) {
+  static PythonArgParser parser({
+    "frombuffer(PyObject* buffer, *, ScalarType dtype=None, int64_t count=-1, int64_t offset=0)",
+  });
+
+  ParsedArgs<4> parsed_args;
+  auto r = parser.parse(args, kwargs, parsed_args);
+  if (r.idx == 0) {
+    PyObject* obj = r.pyobject(0);
+    if (!PyObject_CheckBuffer(obj)) {
+      throw TypeError("frombuffer(): expected an object that exposes the buffer protocol (got %s)",
+          Py_TYPE(obj)->tp_name);
+    }
+    // The buffer must be contiguous, its bytes are read in memory order
+    auto view = get_buffer(obj, PyBUF_FORMAT | PyBUF_ANY_CONTIGUOUS);
+    auto scalar_type = r.isNone(1)
+        ? buffer_scalar_type(view->format, view->itemsize)
+        : c10::optional<ScalarType>(r.scalartype(1));
+    if (!scalar_type) {
+      throw TypeError("frombuffer(): can't infer the dtype of a buffer with format '%s', pass dtype",
+          view->format);
+    }
+    const int64_t element_size = c10::elementSize(*scalar_type);
+    const int64_t offset = r.toInt64(3);
+    const int64_t len = view->len;
+    int64_t count = r.toInt64(2);
+    TORCH_CHECK(offset >= 0 && offset <= len,
+        "frombuffer(): offset must be between 0 and the buffer length ", len, ", got ", offset);
+    if (count < 0) {
+      TORCH_CHECK((len - offset) % element_size == 0,
+          "frombuffer(): the buffer length minus the offset, ", len - offset,
+          ", is not a multiple of the element size ", element_size);
+      count = (len - offset) / element_size;
+    }
+    TORCH_CHECK(offset + count * element_size <= len,
+        "frombuffer(): ", count, " elements from offset ", offset,
+        " are past the end of the buffer of length ", len);
+    void* data = static_cast<char*>(view->buf) + offset;
+    return tensor_from_buffer_view(std::move(view), data, {count}, {1}, *scalar_type);
+  }
+  throw std::runtime_error("frombuffer(): invalid arguments");
+}
+
 Tensor new_tensor(c10::DispatchKey dispatch_key, at::ScalarType scalar_type, PyObject* args, PyObject* kwargs) {
   static PythonArgParser parser({
     "new_tensor(PyObject* data, *, ScalarType dtype=None, Device? device=None, bool requires_grad=False)",
@@ -5,6 +5,7 @@
 #include <pybind11/pybind11.h>
 
 #include <torch/csrc/jit/pybind_utils.h>
+#include <torch/csrc/utils/throughput_benchmark_stats.h>
 
 #include <vector>
 #include <memory>
@@ -14,15 +15,6 @@ namespace py = pybind11;
 namespace torch {
 namespace throughput_benchmark {
 
-/**
- * The struct is used to provide results of a benchmark to the caller
- * In the future all additional statics should be added here.
- */
-struct BenchmarkExecutionStats {
-  float latency_avg_ms{-1};
-  int64_t num_iters{-1};
-};
-
 /**
  * Use this struct in order to configure a throughput benchmark run.
  * This struct should include parameters related to threading, batching, number
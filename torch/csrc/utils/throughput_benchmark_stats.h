@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace torch {
+namespace throughput_benchmark {
+
+/**
+ * The struct is used to provide results of a benchmark to the caller
+ * In the future all additional statics should be added here.
+ */
+struct BenchmarkExecutionStats {
+  float latency_avg_ms{-1};
+  int64_t num_iters{-1};
+};
+
+} // namespace throughput_benchmark
+} // namespace torch
@@ -402,6 +402,29 @@ def ipc_collect():
     return torch._C._cuda_ipc_collect()
 
 
+def set_ipc_mem_handle_retention(n):
+    r"""Keeps the memory of the producers of the ``n`` most recently received
+    CUDA tensors mapped in this process.
+
+    Receiving a CUDA tensor from another process maps the block of memory of
+    the producer that holds it, and the mapping is closed when the last tensor
+    using it is freed. A consumer that receives tensors from the same producers
+    over and over can keep the mappings open, so that receiving a tensor from a
+    block it already mapped costs no CUDA IPC call.
+
+    .. warning::
+        The producers must not release the retained blocks to CUDA, e.g. with
+        :func:`~torch.cuda.empty_cache`, while they are mapped. Call this with
+        ``0`` to close the mappings that are no longer used.
+
+    Arguments:
+        n (int): number of mappings to keep open. ``0`` (default) closes the
+            mappings as soon as they are unused.
+    """
+    _lazy_init()
+    torch._C._cuda_set_ipc_mem_handle_retention(n)
+
+
 def current_stream(device=None):
     r"""Returns the currently selected :class:`Stream` for a given device.
 
@@ -542,4 +565,5 @@ torch._storage_classes.add(BFloat16Storage)
 from . import sparse
 from . import profiler
 from . import nvtx
+from . import amp
 from .streams import Stream, Event
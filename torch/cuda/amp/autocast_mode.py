@@ -0,0 +1,64 @@
+import torch
+from torch.autograd.grad_mode import _DecoratorContextManager
+
+
+class autocast(_DecoratorContextManager):
+    r"""Context-manager that runs the CUDA ops of a region in mixed precision.
+
+    Inside an enabled region, ops pick their own precision instead of the
+    precision of their inputs, so float32 models can run matmuls and
+    convolutions in float16 (and use tensor cores) without changing the model
+    code:
+
+    * matmul and convolution class ops (e.g. ``mm``, ``addmm``, ``bmm``,
+      ``matmul``, ``linear``, ``conv2d``) cast their floating point CUDA
+      inputs to float16 and return float16 results;
+    * ops that need the range or precision of float32 (e.g. ``softmax``,
+      ``log_softmax``, ``sum``, ``exp``, ``pow``, ``layer_norm``, the losses)
+      cast their inputs to float32 and return float32 results;
+    * ops that combine several tensors (e.g. ``cat``, ``stack``,
+      ``addcmul``) cast their inputs to the widest type among them.
+
+    Other ops run in the type of their inputs.  Only floating point CUDA
+    tensors are cast, and float64 tensors are never cast.
+
+    Float32 leaf tensors that require grad, i.e. the parameters of a model,
+    are cast to float16 once per region and the casts are reused by all the
+    ops that use them.
+
+    The backward pass should run outside of the region: the backward ops run
+    in the types their forward ops picked.
+
+    This context manager is thread local; it will not affect computation in
+    other threads.  Also functions as a decorator.
+
+    Example::
+
+        >>> model = Net().cuda()
+        >>> for input, target in data:
+        ...     optimizer.zero_grad()
+        ...     with torch.cuda.amp.autocast():
+        ...         output = model(input)
+        ...         loss = loss_fn(output, target)
+        ...     loss.backward()
+        ...     optimizer.step()
+
+    Arguments:
+        enabled (bool, optional): whether autocasting is enabled in the
+            region. Can be used to locally disable autocasting inside an
+            enabled region. Default: ``True``
+    """
+    def __init__(self, enabled=True):
+        self._enabled = enabled
+
+    def __enter__(self):
+        self.prev = torch._C._is_autocast_enabled()
+        torch._C._set_autocast_enabled(self._enabled)
+        torch._C._autocast_increment_nesting()
+
+    def __exit__(self, *args):
+        # Drop the cached casts when the outermost region exits
+        if torch._C._autocast_decrement_nesting() == 0:
+            torch._C._clear_autocast_cache()
+        torch._C._set_autocast_enabled(self.prev)
+        return False
@@ -1,5 +1,6 @@
 import torch
 from . import nccl
+from ._utils import _get_device_index
 from torch._utils import _take_tensors, _flatten_dense_tensors, \
     _unflatten_dense_tensors, _reorder_tensors_as
 
@@ -39,6 +40,28 @@ def broadcast_coalesced(tensors, devices, buffer_size=10485760):
     return torch._C._broadcast_coalesced(tensors, devices, buffer_size)
 
 
+def copy_to_device(tensors, device=None, buffer_size=1048576):
+    """Copies a sequence of CPU tensors to a GPU.
+    Small tensors are first packed into a pinned buffer, which is copied to
+    the GPU at once, to reduce the number of host-to-device copies.
+
+    The copies are asynchronous with respect to the host, like
+    :meth:`~torch.Tensor.to` with ``non_blocking=True``, and are ordered on
+    the current stream of ``device``.
+
+    Arguments:
+        tensors (sequence): tensors to copy.
+        device (torch.device or int, optional): the destination GPU (default:
+            current device).
+        buffer_size (int): maximum size of the buffer used for packing
+
+    Returns:
+        A tuple containing copies of ``tensors`` on ``device``.
+    """
+    device = _get_device_index(device, optional=True)
+    return tuple(torch._C._copy_to_device(tensors, device, buffer_size))
+
+
 def reduce_add(inputs, destination=None):
     """Sums tensors from multiple GPUs.
 
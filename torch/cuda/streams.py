@@ -15,11 +15,20 @@ class Stream(torch._C._CudaStreamBase):
             integer, this will use the current device.
         priority(int, optional): priority of the stream. Lower numbers
                                  represent higher priorities.
+        exclusive(bool, optional): if ``True``, the stream is reserved for
+            this object: other streams created afterwards do not share it
+            until this object is destroyed. Default: ``False``.
+
+    .. note:: Streams are taken round-robin from a fixed pool of streams per
+       device and priority, so non-exclusive streams may be shared with other
+       :class:`Stream` objects. The size of the pools (32 by default) can be
+       set with the ``PYTORCH_CUDA_STREAMS_PER_POOL`` environment variable
+       before the first stream is created.
     """
 
-    def __new__(cls, device=None, priority=0, **kwargs):
+    def __new__(cls, device=None, priority=0, exclusive=False, **kwargs):
         with torch.cuda.device(device):
-            return super(Stream, cls).__new__(cls, priority=priority, **kwargs)
+            return super(Stream, cls).__new__(cls, priority=priority, exclusive=exclusive, **kwargs)
 
     def wait_event(self, event):
         r"""Makes all future work submitted to the stream wait for an event.
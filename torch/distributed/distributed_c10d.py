@@ -10,6 +10,7 @@ from .rendezvous import rendezvous, register_rendezvous_handler  # noqa: F401
 from . import (
     AllreduceOptions,
     AllreduceCoalescedOptions,
+    AllToAllOptions,
     BroadcastOptions,
     GatherOptions,
     ReduceOptions,
@@ -1465,6 +1466,97 @@ def reduce_scatter(output,
         work.wait()
 
 
+def all_to_all_single(output,
+                      input,
+                      output_split_sizes=None,
+                      input_split_sizes=None,
+                      group=group.WORLD,
+                      async_op=False):
+    """
+    Splits ``input`` along its first dimension, scatters the splits to all
+    processes in a group and concatenates the splits received from them into
+    ``output``.
+
+    Arguments:
+        output (Tensor): Output tensor.
+        input (Tensor): Input tensor to scatter.
+        output_split_sizes (list[Int], optional): Number of rows of ``output``
+            received from each rank. If ``None`` or empty, dim 0 of ``output``
+            is divided equally by the world size.
+        input_split_sizes (list[Int], optional): Number of rows of ``input``
+            sent to each rank. If ``None`` or empty, dim 0 of ``input`` is
+            divided equally by the world size.
+        group (ProcessGroup, optional): The process group to work on.
+        async_op (bool, optional): Whether this op should be an async op.
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group.
+
+    """
+    _check_single_tensor(output, "output")
+    _check_single_tensor(input, "input")
+    if _rank_not_in_group(group):
+        return
+
+    opts = AllToAllOptions()
+    output_split_sizes = [] if output_split_sizes is None else output_split_sizes
+    input_split_sizes = [] if input_split_sizes is None else input_split_sizes
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.alltoall_base(
+            output, input, output_split_sizes, input_split_sizes, opts)
+    else:
+        work = group.alltoall_base(
+            output, input, output_split_sizes, input_split_sizes, opts)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
+
+def all_to_all(output_tensor_list,
+               input_tensor_list,
+               group=group.WORLD,
+               async_op=False):
+    """
+    Sends ``input_tensor_list[i]`` to rank ``i`` and receives
+    ``output_tensor_list[i]`` from rank ``i``. The tensors may have different
+    sizes. The backends coalesce them into a single buffer each way, so every
+    pair of ranks exchanges one message however many tensors there are.
+
+    Arguments:
+        output_tensor_list (list[Tensor]): One output tensor per rank.
+        input_tensor_list (list[Tensor]): One input tensor per rank.
+        group (ProcessGroup, optional): The process group to work on.
+        async_op (bool, optional): Whether this op should be an async op.
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group.
+
+    """
+    _check_tensor_list(output_tensor_list, "output_tensor_list")
+    _check_tensor_list(input_tensor_list, "input_tensor_list")
+    if _rank_not_in_group(group):
+        return
+
+    opts = AllToAllOptions()
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.alltoall(output_tensor_list, input_tensor_list, opts)
+    else:
+        work = group.alltoall(output_tensor_list, input_tensor_list, opts)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
+
 def barrier(group=group.WORLD,
             async_op=False):
     """
@@ -0,0 +1,8 @@
+"""
+:mod:`torch.distributed.nn` exposes modules whose parameters are partitioned
+across RPC workers, such as ShardedEmbedding. Lookups and gradients go through
+:mod:`torch.distributed.rpc` and :mod:`torch.distributed.autograd`, so the
+remote parameters can be trained with
+:class:`~torch.distributed.optim.DistributedOptimizer`.
+"""
+from .sharded_embedding import ShardedEmbedding
@@ -0,0 +1,195 @@
+import time
+from collections import OrderedDict
+
+import torch
+import torch.distributed.rpc as rpc
+from torch.nn import Module
+
+
+class _EmbeddingShard:
+    def __init__(self, num_rows, embedding_dim, weight=None):
+        if weight is None:
+            weight = torch.empty(num_rows, embedding_dim).normal_()
+        assert weight.size() == (num_rows, embedding_dim), \
+            'Shape of weight does not match the shard size'
+        self.weight = weight.detach().clone().requires_grad_()
+
+    def lookup(self, local_ids):
+        return self.weight.index_select(0, local_ids)
+
+
+def _new_embedding_shard(num_rows, embedding_dim, weight):
+    return rpc.RRef(_EmbeddingShard(num_rows, embedding_dim, weight))
+
+
+def _shard_lookup(shard_rref, local_ids):
+    return shard_rref.local_value().lookup(local_ids)
+
+
+def _shard_weight(shard_rref):
+    return shard_rref.local_value().weight
+
+
+def _wait_for_all(rpc_futs):
+    return [fut.wait() for fut in rpc_futs]
+
+
+class ShardedEmbedding(Module):
+    r"""
+    An embedding table whose rows are partitioned across RPC workers, as in a
+    parameter server. Row ``i`` lives on ``workers[i % len(workers)]``.
+
+    Each call to :meth:`forward` deduplicates the requested indices and sends
+    a single RPC per worker holding any of them, all in flight at once. When
+    the lookup runs inside a :class:`~torch.distributed.autograd.context`,
+    distributed autograd records a send/recv pair per RPC, so the backward
+    pass pushes one gradient message per worker as well, with the gradients
+    of repeated indices already summed locally. The shard weights can then be
+    updated with :class:`~torch.distributed.optim.DistributedOptimizer` using
+    :meth:`parameter_rrefs`.
+
+    With ``cache_size > 0``, rows are also kept in a client-side LRU cache.
+    Lookups done with gradients disabled (e.g. evaluation, or serving) are
+    answered from the cache for rows fetched at most ``max_staleness``
+    seconds ago, and only the remaining rows are fetched. Lookups done with
+    gradients enabled always fetch every row, since the gradients of cached
+    rows would not reach their owner, but they refresh the cache.
+
+    Args:
+        num_embeddings (int): size of the dictionary of embeddings
+        embedding_dim (int): the size of each embedding vector
+        workers (list): names or :class:`~torch.distributed.rpc.WorkerInfo`
+            of the workers holding the shards
+        cache_size (int, optional): maximum number of rows kept in the
+            client-side cache. Default: ``0`` (no cache)
+        max_staleness (float, optional): how long, in seconds, a cached row
+            may be used for. Default: ``0``
+        _weight (Tensor, optional): initial weight of the whole table, of
+            shape ``(num_embeddings, embedding_dim)``. If not given, the rows
+            are initialized from :math:`\mathcal{N}(0, 1)` like
+            :class:`~torch.nn.Embedding`
+
+    Example::
+
+        >> import torch.distributed.autograd as dist_autograd
+        >> from torch import optim
+        >> from torch.distributed.nn import ShardedEmbedding
+        >> from torch.distributed.optim import DistributedOptimizer
+        >>
+        >> emb = ShardedEmbedding(1000, 16, ["worker1", "worker2"])
+        >> dist_optim = DistributedOptimizer(
+        >>    optim.SGD, emb.parameter_rrefs(), lr=0.05)
+        >>
+        >> with dist_autograd.context():
+        >>   loss = emb(torch.tensor([[1, 2, 4], [4, 3, 1]])).sum()
+        >>   dist_autograd.backward([loss])
+        >>   dist_optim.step()
+    """
+
+    def __init__(self, num_embeddings, embedding_dim, workers, cache_size=0,
+                 max_staleness=0, _weight=None):
+        super(ShardedEmbedding, self).__init__()
+        if len(workers) == 0:
+            raise ValueError('ShardedEmbedding needs at least one worker')
+        if _weight is not None:
+            assert list(_weight.shape) == [num_embeddings, embedding_dim], \
+                'Shape of weight does not match num_embeddings and embedding_dim'
+        self.num_embeddings = num_embeddings
+        self.embedding_dim = embedding_dim
+        self.cache_size = cache_size
+        self.max_staleness = max_staleness
+        self._num_shards = len(workers)
+        # row id -> (row, time it was fetched), least recently used first
+        self._cache = OrderedDict()
+
+        shard_futs = []
+        for shard, worker in enumerate(workers):
+            num_rows = (num_embeddings - shard + self._num_shards - 1) // self._num_shards
+            weight = None if _weight is None else _weight[shard::self._num_shards].contiguous()
+            shard_futs.append(rpc.rpc_async(
+                worker,
+                _new_embedding_shard,
+                args=(num_rows, embedding_dim, weight),
+            ))
+        self._shards = _wait_for_all(shard_futs)
+
+    def parameter_rrefs(self):
+        r"""
+        Returns a list of :class:`~torch.distributed.rpc.RRef` to the weight
+        of each shard, to be passed to
+        :class:`~torch.distributed.optim.DistributedOptimizer`.
+        """
+        return [
+            rpc.remote(shard.owner(), _shard_weight, args=(shard,))
+            for shard in self._shards
+        ]
+
+    def invalidate_cache(self):
+        r"""Drops every row from the client-side cache."""
+        self._cache.clear()
+
+    def _fetch(self, ids):
+        # Fetches the rows `ids` (unique) from their shards, one RPC per
+        # shard, and returns them in the order of `ids`.
+        shard_of = ids % self._num_shards
+        rpc_futs = []
+        positions = []
+        for shard in range(self._num_shards):
+            mask = shard_of == shard
+            if not mask.any():
+                continue
+            rpc_futs.append(rpc.rpc_async(
+                self._shards[shard].owner(),
+                _shard_lookup,
+                args=(self._shards[shard], ids[mask] // self._num_shards),
+            ))
+            positions.append(mask.nonzero().view(-1))
+        rows = torch.cat(_wait_for_all(rpc_futs))
+        order = torch.empty_like(ids)
+        order[torch.cat(positions)] = torch.arange(ids.numel())
+        return rows.index_select(0, order)
+
+    def _update_cache(self, ids, rows):
+        now = time.monotonic()
+        for row_id, row in zip(ids.tolist(), rows.detach()):
+            self._cache[row_id] = (row, now)
+            self._cache.move_to_end(row_id)
+        while len(self._cache) > self.cache_size:
+            self._cache.popitem(last=False)
+
+    def _lookup_with_cache(self, ids):
+        now = time.monotonic()
+        rows = [None] * ids.numel()
+        missing = []
+        for i, row_id in enumerate(ids.tolist()):
+            entry = self._cache.get(row_id)
+            if entry is not None and now - entry[1] <= self.max_staleness:
+                rows[i] = entry[0]
+                self._cache.move_to_end(row_id)
+            else:
+                missing.append(i)
+        if missing:
+            missing = torch.tensor(missing, dtype=torch.long)
+            fetched = self._fetch(ids[missing])
+            self._update_cache(ids[missing], fetched)
+            for i, row in zip(missing.tolist(), fetched):
+                rows[i] = row
+        return torch.stack(rows)
+
+    def forward(self, input):
+        unique_ids, inverse = torch.unique(input.reshape(-1), return_inverse=True)
+        if unique_ids.numel() == 0:
+            return torch.empty(*input.shape, self.embedding_dim)
+        if self.cache_size > 0 and not torch.is_grad_enabled():
+            rows = self._lookup_with_cache(unique_ids)
+        else:
+            rows = self._fetch(unique_ids)
+            if self.cache_size > 0:
+                self._update_cache(unique_ids, rows)
+        return rows.index_select(0, inverse).view(*input.shape, self.embedding_dim)
+
+    def extra_repr(self):
+        s = '{num_embeddings}, {embedding_dim}, num_shards={_num_shards}'
+        if self.cache_size > 0:
+            s += ', cache_size={cache_size}, max_staleness={max_staleness}'
+        return s.format(**self.__dict__)
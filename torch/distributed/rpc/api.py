@@ -26,6 +26,7 @@ from . import (
     _reset_current_rpc_agent,
     _set_and_start_rpc_agent,
     _set_rpc_timeout,
+    _stop_rref_control_message_batching,
     backend_registry,
 )
 from .internal import (
@@ -233,6 +234,9 @@ def shutdown(graceful=True):
         >>> # wait for worker 0 to finish work, and then shutdown.
         >>> rpc.shutdown()
     """
+    # Send the batched RRef control messages now, and later ones right away,
+    # so that join() waits for them.
+    _stop_rref_control_message_batching()
     if graceful:
         _wait_all_workers()
         _get_current_rpc_agent().join()
@@ -482,7 +486,10 @@ def rpc_sync(to, func, args=None, kwargs=None):
                        invocation.
 
     Returns:
-        Returns the result of running ``func`` on ``args`` and ``kwargs``.
+        Returns the result of running ``func`` on ``args`` and ``kwargs``. If
+        ``func`` returns the future of another :meth:`rpc_async` call, or a
+        TorchScript function returns a ``Future``, the callee responds with
+        its value once it completes, without blocking a thread until then.
 
     Example::
         Make sure that ``MASTER_ADDRESS`` and ``MASTER_PORT`` are set properly
@@ -152,7 +152,7 @@ def save(m, f, _extra_files=DEFAULT_EXTRA_FILES_MAP):
         ret = m.save_to_buffer(_extra_files=_extra_files)
         f.write(ret)
 
-def load(f, map_location=None, _extra_files=DEFAULT_EXTRA_FILES_MAP):
+def load(f, map_location=None, _extra_files=DEFAULT_EXTRA_FILES_MAP, mmap=False):
     r"""
         Load a :class:`ScriptModule` or :class:`ScriptFunction` previously
         saved with :func:`torch.jit.save <torch.jit.save>`
@@ -169,6 +169,15 @@ def load(f, map_location=None, _extra_files=DEFAULT_EXTRA_FILES_MAP):
             _extra_files (dictionary of filename to content): The extra
                 filenames given in the map would be loaded and their content
                 would be stored in the provided map.
+            mmap (bool): if ``True``, ``f`` has to be a file name. The file is
+                memory-mapped copy-on-write and the tensors on the CPU point
+                into the mapping instead of being read into memory, so loading
+                is fast and processes loading the same file share its pages
+                until they write to them. The tensors are materialized lazily:
+                the data of a tensor is only read from the file when it is
+                first accessed, so parameters of submodules that are never
+                called cost neither load time nor resident memory. The file
+                must not be modified while the module is alive.
 
         Returns:
             A :class:`ScriptModule` object.
@@ -231,8 +240,10 @@ def load(f, map_location=None, _extra_files=DEFAULT_EXTRA_FILES_MAP):
     if isinstance(f, str) or \
             (sys.version_info[0] == 2 and isinstance(f, unicode)) or \
             (sys.version_info[0] == 3 and isinstance(f, pathlib.Path)):
-        cpp_module = torch._C.import_ir_module(cu, f, map_location, _extra_files)
+        cpp_module = torch._C.import_ir_module(cu, f, map_location, _extra_files, mmap)
     else:
+        if mmap:
+            raise ValueError("mmap=True requires a file name, not a file-like object")
         cpp_module = torch._C.import_ir_module_from_buffer(cu, f.read(), map_location, _extra_files)
 
     # TODO: Pretty sure this approach loses ConstSequential status and such
@@ -244,6 +255,51 @@ def export_opnames(m):
     """
     return torch._C._export_opnames(m._c)
 
+def _freeze_module(mod):
+    r"""
+    Returns a copy of the ``ScriptModule`` ``mod``, which must be in eval mode,
+    whose ``forward`` method has the attributes of ``mod`` it reads inlined as
+    constants, e.g. the parameters and buffers it doesn't modify. Constant
+    propagation then runs on the inlined graph, the batch norms that follow
+    convolutions are folded into them, and linear patterns are fused into
+    ``aten::linear``.
+
+    The frozen module shares the values of its attributes with ``mod``, but its
+    ``forward`` keeps the values they had when it was frozen.
+
+    Example::
+
+        >>> m = torch.jit.script(MyModule().eval())
+        >>> frozen = torch.jit._freeze_module(m)
+    """
+    if not isinstance(mod, ScriptModule):
+        raise RuntimeError("Freezing expects a ScriptModule, but got {}".format(type(mod)))
+    if mod.training:
+        raise RuntimeError("Freezing is only supported on modules in eval mode, call eval() first")
+    return torch.jit._recursive.wrap_cpp_module(torch._C._freeze_module(mod._c))
+
+def _run_concurrently(fn, inputs, num_threads=0):
+    r"""
+    Calls ``fn``, a ``ScriptModule`` (whose ``forward`` is called) or a
+    method of one, on every element of ``inputs`` and returns the list of the
+    results. An element holds the positional arguments of a call: a tuple, or
+    the single argument.
+
+    The calls run on ``num_threads`` C++ threads (``0`` for
+    :func:`torch.get_num_interop_threads`), and hold the GIL only while their
+    arguments and results are converted, so that a server hosted in Python can
+    use all the cores for inference. They run in the grad mode of the caller.
+    The first error raised by a call is raised once all the calls are done.
+
+    Example::
+
+        >>> m = torch.jit.script(MyModule())
+        >>> outputs = torch.jit._run_concurrently(m, [torch.rand(8, 3) for _ in range(16)])
+    """
+    if isinstance(fn, ScriptModule):
+        fn = fn.forward
+    return fn._run_concurrently(list(inputs), num_threads)
+
 def _get_trace_graph(f, args=(), kwargs=None, _force_outplace=False,
                      return_inputs=False, _return_inputs_states=False):
     """
@@ -72,4 +72,20 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroup::allgather_coalesced(
       "no support for allgather_coalesced in this process group");
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::alltoall_base(
+    at::Tensor& /* unused */,
+    at::Tensor& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error("no support for alltoall_base in this process group");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::alltoall(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<at::Tensor>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error("no support for alltoall in this process group");
+}
+
 } // namespace c10d
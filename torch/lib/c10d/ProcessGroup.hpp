@@ -162,6 +162,24 @@ class ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ReduceScatterOptions& opts = ReduceScatterOptions()) = 0;
 
+  // Scatters slices of inputTensor along its first dimension to all ranks and
+  // gathers the slices they send to this rank into outputTensor. Rank i gets
+  // inputSplitSizes[i] rows of the input and contributes outputSplitSizes[i]
+  // rows of the output; empty split sizes mean equal splits of getSize().
+  virtual std::shared_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions());
+
+  // Sends inputTensors[i] to rank i and receives outputTensors[i] from it.
+  // The tensors may have different sizes but must share a dtype and device.
+  virtual std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions());
+
   virtual std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank,
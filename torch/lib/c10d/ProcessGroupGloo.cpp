@@ -1843,6 +1843,312 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather_base(
 
 namespace {
 
+// Point-to-point messages of an alltoall are sent with the collective tag in
+// the low bits and this prefix in the high byte, so they never match the
+// slots of user send/recv calls, which use the plain tag.
+constexpr uint64_t kAlltoallSlotPrefix = 0x18;
+
+class AsyncAlltoallWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncAlltoallWork(
+      const std::shared_ptr<gloo::Context>& context,
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      std::vector<at::Tensor>& outputList,
+      uint32_t tag)
+      : context(context),
+        outputTensor(outputTensor),
+        inputTensor(inputTensor),
+        outputSplitSizes(outputSplitSizes),
+        inputSplitSizes(inputSplitSizes),
+        outputList(outputList),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  at::Tensor outputTensor;
+  at::Tensor inputTensor;
+  std::vector<int64_t> outputSplitSizes;
+  std::vector<int64_t> inputSplitSizes;
+  // Set by the coalesced alltoall: the tensors that outputTensor is the
+  // flattened concatenation of.
+  std::vector<at::Tensor> outputList;
+  const uint32_t tag;
+
+  void alltoall(at::Tensor& outputTensor, at::Tensor& inputTensor) {
+    const auto size = context->size;
+    const auto rank = context->rank;
+    const auto elementSize = inputTensor.element_size();
+
+    std::vector<int64_t> sendLengths, sendOffsets;
+    std::vector<int64_t> recvLengths, recvOffsets;
+    computeLengthsAndOffsets(
+        inputSplitSizes, inputTensor, size, sendLengths, sendOffsets);
+    computeLengthsAndOffsets(
+        outputSplitSizes, outputTensor, size, recvLengths, recvOffsets);
+
+    auto sendBuffer = context->createUnboundBuffer(
+        inputTensor.data_ptr(), inputTensor.numel() * elementSize);
+    auto recvBuffer = context->createUnboundBuffer(
+        outputTensor.data_ptr(), outputTensor.numel() * elementSize);
+    const uint64_t slot = (kAlltoallSlotPrefix << 56) | tag;
+
+    // Post every receive before the first send. Empty segments are skipped
+    // on both sides, since a peer computes the same length for a segment
+    // from its own split sizes.
+    size_t numRecvs = 0;
+    for (int i = 0; i < size; i++) {
+      if (i == rank || recvLengths[i] == 0) {
+        continue;
+      }
+      recvBuffer->recv(
+          i,
+          slot,
+          recvOffsets[i] * elementSize,
+          recvLengths[i] * elementSize);
+      numRecvs++;
+    }
+    size_t numSends = 0;
+    for (int i = 0; i < size; i++) {
+      if (i == rank || sendLengths[i] == 0) {
+        continue;
+      }
+      sendBuffer->send(
+          i,
+          slot,
+          sendOffsets[i] * elementSize,
+          sendLengths[i] * elementSize);
+      numSends++;
+    }
+
+    // The segment for this rank does not go through the transport.
+    TORCH_CHECK(
+        sendLengths[rank] == recvLengths[rank],
+        "ProcessGroupGloo::alltoall_base: input and output split sizes ",
+        "for the local rank differ");
+    if (sendLengths[rank] > 0) {
+      outputTensor.view({-1})
+          .narrow(0, recvOffsets[rank], recvLengths[rank])
+          .copy_(inputTensor.view({-1})
+                     .narrow(0, sendOffsets[rank], sendLengths[rank]));
+    }
+
+    for (size_t i = 0; i < numRecvs; i++) {
+      recvBuffer->waitRecv();
+    }
+    for (size_t i = 0; i < numSends; i++) {
+      sendBuffer->waitSend();
+    }
+  }
+
+  // Copies a flat coalesced output back into the tensors of outputList.
+  void unflattenOutput(at::Tensor& flatOutputTensor) {
+    int64_t offset = 0;
+    for (auto& output : outputList) {
+      output.copy_(
+          flatOutputTensor.narrow(0, offset, output.numel())
+              .view(output.sizes()),
+          /* non_blocking */ true);
+      offset += output.numel();
+    }
+  }
+
+  void run() override {
+    alltoall(outputTensor, inputTensor);
+    if (!outputList.empty()) {
+      unflattenOutput(outputTensor);
+    }
+  }
+};
+
+#ifdef USE_CUDA
+
+class AsyncAlltoallCUDAWork : public AsyncAlltoallWork {
+ public:
+  AsyncAlltoallCUDAWork(
+      const std::shared_ptr<gloo::Context>& context,
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      std::vector<at::Tensor>& outputList,
+      uint32_t tag)
+      : AsyncAlltoallWork(
+            context,
+            outputTensor,
+            inputTensor,
+            outputSplitSizes,
+            inputSplitSizes,
+            outputList,
+            tag) {
+    std::vector<at::Tensor> inputs{inputTensor};
+    std::vector<at::Tensor> outputs{outputTensor};
+    initializeStreamsEvents(inputs, inputStreams, inputEvents);
+    initializeStreamsEvents(outputs, outputStreams, outputEvents);
+
+    // Kick off copy from CUDA tensors to pinned CPU tensors.
+    at::cuda::OptionalCUDAStreamGuard guard;
+    guard.reset_stream(inputStreams[0]);
+    tmpInput = pinnedLike(inputTensor).copy_(inputTensor, true);
+    tmpOutput = pinnedLike(outputTensor);
+
+    // The coalesced outputs are written on the output stream as well.
+    for (auto& output : outputList) {
+      c10::cuda::CUDACachingAllocator::recordStream(
+          output.storage().data_ptr(), outputStreams[0]);
+    }
+  }
+
+  void run() override {
+    // Synchronize with copy operations.
+    at::cuda::OptionalCUDAGuard device_guard;
+    device_guard.set_index(inputTensor.device().index());
+    AT_CUDA_CHECK(cudaStreamSynchronize(inputStreams[0]));
+    device_guard.set_index(outputTensor.device().index());
+    AT_CUDA_CHECK(cudaStreamSynchronize(outputStreams[0]));
+
+    // Run alltoall on host side tensors.
+    alltoall(tmpOutput, tmpInput);
+
+    // Kick off copy back to the CUDA tensors.
+    at::cuda::OptionalCUDAStreamGuard stream_guard;
+    stream_guard.reset_stream(outputStreams[0]);
+    outputTensor.copy_(tmpOutput, /* non_blocking */ true);
+    if (!outputList.empty()) {
+      unflattenOutput(outputTensor);
+    }
+    outputEvents[0].record(outputStreams[0]);
+  }
+
+  void synchronize() override {
+    // Synchronize with the copy back to CUDA tensors.
+    at::cuda::OptionalCUDAGuard guard;
+    guard.set_index(outputTensor.device().index());
+    outputEvents[0].block(at::cuda::getCurrentCUDAStream());
+  }
+
+  at::Tensor tmpInput;
+  std::vector<at::cuda::CUDAStream> inputStreams;
+  std::vector<at::cuda::CUDAEvent> inputEvents;
+
+  at::Tensor tmpOutput;
+  std::vector<at::cuda::CUDAStream> outputStreams;
+  std::vector<at::cuda::CUDAEvent> outputEvents;
+};
+
+#endif
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoallImpl(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    std::vector<at::Tensor>& outputList) {
+  std::shared_ptr<AsyncAlltoallWork> work;
+  auto tag = nextTag();
+  auto context = getContext(tag);
+  const auto& device = outputTensor.device();
+  if (device.type() == at::kCPU) {
+    work = std::make_shared<AsyncAlltoallWork>(
+        std::move(context),
+        outputTensor,
+        inputTensor,
+        outputSplitSizes,
+        inputSplitSizes,
+        outputList,
+        tag);
+#ifdef USE_CUDA
+  } else if (device.type() == at::kCUDA) {
+    work = std::make_shared<AsyncAlltoallCUDAWork>(
+        std::move(context),
+        outputTensor,
+        inputTensor,
+        outputSplitSizes,
+        inputSplitSizes,
+        outputList,
+        tag);
+#endif
+  } else {
+    throw std::runtime_error("Invalid backend");
+  }
+  enqueue(work);
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::alltoall_base: " + msg);
+  };
+
+  std::vector<at::Tensor> tensors{outputTensor, inputTensor};
+  assertSameDevice(invalidArgument, tensors);
+  assertDense(invalidArgument, {outputTensor});
+  assertDense(invalidArgument, {inputTensor});
+  assertTypeMatch(invalidArgument, outputTensor.options(), tensors, 1);
+  if (!outputTensor.is_contiguous() || !inputTensor.is_contiguous()) {
+    invalidArgument("requires contiguous tensors");
+  }
+  checkSplitSizes(outputSplitSizes, outputTensor, getSize());
+  checkSplitSizes(inputSplitSizes, inputTensor, getSize());
+
+  std::vector<at::Tensor> outputList;
+  return alltoallImpl(
+      outputTensor, inputTensor, outputSplitSizes, inputSplitSizes, outputList);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::alltoall: " + msg);
+  };
+
+  if (outputTensors.size() != getSize() || inputTensors.size() != getSize()) {
+    invalidArgument("requires one input and one output tensor per rank");
+  }
+
+  std::vector<at::Tensor> tensors(inputTensors);
+  tensors.insert(tensors.end(), outputTensors.begin(), outputTensors.end());
+  assertSameDevice(invalidArgument, tensors);
+  assertDense(invalidArgument, inputTensors);
+  assertDense(invalidArgument, outputTensors);
+  for (size_t i = 1; i < tensors.size(); i++) {
+    assertTypeMatch(invalidArgument, tensors[0].options(), tensors, i);
+  }
+
+  // Coalesce the per-rank tensors into a single buffer each way, so that
+  // every peer gets one message instead of one per tensor.
+  std::vector<int64_t> inputSplitSizes(getSize());
+  std::vector<int64_t> outputSplitSizes(getSize());
+  int64_t outputNumel = 0;
+  for (int i = 0; i < getSize(); i++) {
+    inputSplitSizes[i] = inputTensors[i].numel();
+    outputSplitSizes[i] = outputTensors[i].numel();
+    outputNumel += outputSplitSizes[i];
+  }
+  auto flatInputTensor =
+      at::cat(fmap(inputTensors, [](at::Tensor& t) { return t.reshape({-1}); }));
+  auto flatOutputTensor = at::empty({outputNumel}, outputTensors[0].options());
+
+  return alltoallImpl(
+      flatOutputTensor,
+      flatInputTensor,
+      outputSplitSizes,
+      inputSplitSizes,
+      outputTensors);
+}
+
+namespace {
+
 class AsyncGatherWork : public ProcessGroupGloo::AsyncWork {
  public:
   AsyncGatherWork(
@@ -0,0 +1,286 @@
+#include <c10d/ProcessGroupHierarchical.hpp>
+
+#include <unistd.h>
+
+#include <array>
+#include <map>
+#include <system_error>
+
+#include <c10/core/DeviceGuard.h>
+#include <c10d/PrefixStore.hpp>
+
+namespace c10d {
+
+namespace {
+
+std::string getHostName() {
+  std::array<char, 256> hostName{};
+  if (gethostname(hostName.data(), hostName.size() - 1) != 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  return std::string(hostName.data());
+}
+
+} // namespace
+
+ProcessGroupHierarchical::ProcessGroupHierarchical(
+    const std::shared_ptr<Store>& store,
+    int rank,
+    int size,
+    Factory factory,
+    std::string hostName)
+    : ProcessGroup(rank, size), stop_(false) {
+  if (hostName.empty()) {
+    hostName = getHostName();
+  }
+
+  // Exchange host names to find the ranks on every node. Nodes are ordered
+  // by their lowest rank, and the ranks on a node by rank.
+  auto hierarchicalStore =
+      std::make_shared<PrefixStore>("hierarchical", store);
+  hierarchicalStore->set(
+      "host/" + std::to_string(rank_),
+      std::vector<uint8_t>(hostName.begin(), hostName.end()));
+  std::vector<std::string> keys;
+  for (int i = 0; i < size_; i++) {
+    keys.push_back("host/" + std::to_string(i));
+  }
+  hierarchicalStore->wait(keys);
+
+  std::vector<std::vector<int>> nodes;
+  std::map<std::string, size_t> nodeIndices;
+  int nodeIndex = -1;
+  for (int i = 0; i < size_; i++) {
+    const auto value = hierarchicalStore->get(keys[i]);
+    const auto it = nodeIndices
+                        .emplace(
+                            std::string(value.begin(), value.end()),
+                            nodes.size())
+                        .first;
+    if (it->second == nodes.size()) {
+      nodes.emplace_back();
+    }
+    if (i == rank_) {
+      nodeIndex = it->second;
+      localRank_ = nodes[it->second].size();
+    }
+    nodes[it->second].push_back(i);
+  }
+  TORCH_INTERNAL_ASSERT(nodeIndex >= 0);
+
+  nodeCount_ = nodes.size();
+  localSize_ = nodes[0].size();
+  for (const auto& node : nodes) {
+    TORCH_CHECK(
+        static_cast<int>(node.size()) == localSize_,
+        "ProcessGroupHierarchical requires the same number of ranks on ",
+        "every node, got ",
+        node.size(),
+        " and ",
+        localSize_);
+  }
+
+  flat_ = factory(
+      std::make_shared<PrefixStore>("flat", hierarchicalStore), rank_, size_);
+  intra_ = factory(
+      std::make_shared<PrefixStore>(
+          "intra/" + std::to_string(nodeIndex), hierarchicalStore),
+      localRank_,
+      localSize_);
+  inter_ = factory(
+      std::make_shared<PrefixStore>(
+          "inter/" + std::to_string(localRank_), hierarchicalStore),
+      nodeIndex,
+      nodeCount_);
+  TORCH_CHECK(flat_ && intra_ && inter_, "Expected a process group");
+
+  workerThread_ = std::thread(&ProcessGroupHierarchical::runLoop, this);
+}
+
+ProcessGroupHierarchical::~ProcessGroupHierarchical() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+  stop_ = true;
+  lock.unlock();
+  queueProduceCV_.notify_all();
+  workerThread_.join();
+}
+
+void ProcessGroupHierarchical::runLoop() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+
+  // Pending work is still run when stopping, other processes wait for it.
+  while (!stop_ || !queue_.empty()) {
+    if (queue_.empty()) {
+      queueProduceCV_.wait(lock);
+      continue;
+    }
+
+    auto entry = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    try {
+      entry.first();
+      entry.second->finish();
+    } catch (...) {
+      entry.second->finish(std::current_exception());
+    }
+
+    lock.lock();
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::enqueue(
+    std::function<void()> fn) {
+  auto work = std::make_shared<HierarchicalWork>();
+  std::unique_lock<std::mutex> lock(queueMutex_);
+  queue_.emplace_back(std::move(fn), work);
+  lock.unlock();
+  queueProduceCV_.notify_one();
+  return work;
+}
+
+void ProcessGroupHierarchical::runAllreduce(
+    at::Tensor tensor,
+    const AllreduceOptions& opts) {
+  c10::DeviceGuard guard(tensor.device());
+
+  // Pad the flattened tensor so that it splits into equal shards.
+  const auto numel = tensor.numel();
+  const auto shardNumel = (numel + localSize_ - 1) / localSize_;
+  auto buffer = at::zeros({shardNumel * localSize_}, tensor.options());
+  buffer.narrow(0, 0, numel).copy_(tensor.reshape({-1}));
+  auto shards = buffer.chunk(localSize_);
+
+  // Reduce shard i to local rank i (a reduce-scatter within the node).
+  std::vector<std::shared_ptr<ProcessGroup::Work>> works;
+  for (int i = 0; i < localSize_; i++) {
+    std::vector<at::Tensor> tensors = {shards[i]};
+    ReduceOptions reduceOpts;
+    reduceOpts.reduceOp = opts.reduceOp;
+    reduceOpts.rootRank = i;
+    works.push_back(intra_->reduce(tensors, reduceOpts));
+  }
+  for (auto& work : works) {
+    work->wait();
+  }
+
+  // Allreduce the shard of this rank with the same shard of the other nodes.
+  {
+    std::vector<at::Tensor> tensors = {shards[localRank_]};
+    inter_->allreduce(tensors, opts)->wait();
+  }
+
+  // Gather the reduced shards within the node.
+  {
+    std::vector<at::Tensor> inputs = {shards[localRank_].clone()};
+    std::vector<std::vector<at::Tensor>> outputs = {shards};
+    intra_->allgather(outputs, inputs)->wait();
+  }
+
+  tensor.copy_(buffer.narrow(0, 0, numel).view(tensor.sizes()));
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  return flat_->broadcast(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  // Nothing to gain without multiple ranks on multiple nodes.
+  if (nodeCount_ == 1 || localSize_ == 1) {
+    return flat_->allreduce(tensors, opts);
+  }
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "ProcessGroupHierarchical::allreduce takes a single tensor");
+  auto tensor = tensors[0];
+  return enqueue([this, tensor, opts] { runAllreduce(tensor, opts); });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allreduce_coalesced(
+        std::vector<at::Tensor>& tensors,
+        const AllreduceCoalescedOptions& opts) {
+  return flat_->allreduce_coalesced(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  return flat_->reduce(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const AllgatherOptions& opts) {
+  return flat_->allgather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather_base(
+    at::Tensor& outputBuffer,
+    at::Tensor& inputBuffer,
+    const AllgatherOptions& opts) {
+  return flat_->allgather_base(outputBuffer, inputBuffer, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allgather_coalesced(
+        std::vector<std::vector<at::Tensor>>& outputTensorLists,
+        std::vector<at::Tensor>& inputTensors,
+        const AllgatherOptions& opts) {
+  return flat_->allgather_coalesced(outputTensorLists, inputTensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::gather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const GatherOptions& opts) {
+  return flat_->gather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ScatterOptions& opts) {
+  return flat_->scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce_scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ReduceScatterOptions& opts) {
+  return flat_->reduce_scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  return flat_->send(tensors, dstRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  return flat_->recv(tensors, srcRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int tag) {
+  return flat_->recvAnysource(tensors, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::barrier(
+    const BarrierOptions& opts) {
+  // Also wait for the allreduce calls still queued on the worker thread.
+  return enqueue([this, opts] { flat_->barrier(opts)->wait(); });
+}
+
+} // namespace c10d
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Store.hpp>
+
+namespace c10d {
+
+// ProcessGroupHierarchical reduces traffic between machines for allreduce.
+//
+// It is constructed with a store and a factory for process groups of some
+// backend. The topology is discovered by exchanging host names through the
+// store: ranks with the same host name are on the same node. Every node must
+// have the same number of ranks. The factory is called for three process
+// groups, each over its own PrefixStore of the specified store:
+//
+//   - a flat group of all ranks,
+//   - an intra-node group of the ranks on the same node,
+//   - an inter-node group of the ranks with the same local rank on every node.
+//
+// An allreduce splits the tensor into as many shards as there are ranks on a
+// node. Shard `i` is reduced to local rank `i` within the node, allreduced
+// across nodes by the ranks with local rank `i`, and allgathered within the
+// node again. Only `1 / local size` of the tensor crosses the network per
+// rank, instead of all of it. The three steps run on a worker thread of this
+// process group, and so does the barrier to include them. All other
+// collectives are forwarded to the flat group.
+//
+// Like ProcessGroupMPI, allreduce only supports a single tensor.
+//
+// All functions of the class are expected to be called in the same order
+// across all processes in the process group. This is the only way that we
+// can guarantee to match up the same calls among all processes.
+//
+class ProcessGroupHierarchical final : public ProcessGroup {
+ public:
+  using Factory = std::function<std::shared_ptr<ProcessGroup>(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size)>;
+
+  // If `hostName` is empty, the host name of this machine is used.
+  explicit ProcessGroupHierarchical(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Factory factory,
+      std::string hostName = "");
+
+  ~ProcessGroupHierarchical() override;
+
+  int getLocalRank() const {
+    return localRank_;
+  }
+
+  int getLocalSize() const {
+    return localSize_;
+  }
+
+  int getNodeCount() const {
+    return nodeCount_;
+  }
+
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceCoalescedOptions& opts =
+          AllreduceCoalescedOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_base(
+      at::Tensor& outputBuffer,
+      at::Tensor& inputBuffer,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_coalesced(
+      std::vector<std::vector<at::Tensor>>& outputTensorLists,
+      std::vector<at::Tensor>& inputTensors,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce_scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> barrier(
+      const BarrierOptions& opts = BarrierOptions()) override;
+
+ private:
+  class HierarchicalWork : public ProcessGroup::Work {
+    friend class ProcessGroupHierarchical;
+  };
+
+  int localRank_;
+  int localSize_;
+  int nodeCount_;
+
+  std::shared_ptr<ProcessGroup> flat_;
+  std::shared_ptr<ProcessGroup> intra_;
+  std::shared_ptr<ProcessGroup> inter_;
+
+  // Runs the allreduce steps in the order they were enqueued.
+  bool stop_;
+  std::deque<
+      std::pair<std::function<void()>, std::shared_ptr<HierarchicalWork>>>
+      queue_;
+  std::mutex queueMutex_;
+  std::condition_variable queueProduceCV_;
+  std::thread workerThread_;
+
+  void runLoop();
+
+  std::shared_ptr<ProcessGroup::Work> enqueue(std::function<void()> fn);
+
+  void runAllreduce(at::Tensor tensor, const AllreduceOptions& opts);
+};
+
+} // namespace c10d
@@ -1,9 +1,15 @@
 #include <c10d/ProcessGroupMPI.hpp>
 
+#include <limits>
 #include <map>
 
 #include <c10/core/DeviceGuard.h>
 
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#endif
+
 #if defined(OPEN_MPI) && OPEN_MPI
 #include <mpi-ext.h> // Needed for CUDA-aware check
 #endif
@@ -91,6 +97,38 @@ void checkSameSizeAndType(
   }
 }
 
+// How long the worker thread sleeps between two polls of in-flight work
+// when there is nothing new to start.
+constexpr auto kProgressInterval = std::chrono::microseconds(50);
+
+// Records an event on the current stream of every CUDA tensor and returns a
+// function blocking on them, or an empty function if there is none.
+std::function<void()> recordTensorsReady(
+    const std::vector<at::Tensor>& src,
+    const std::vector<at::Tensor>& dst) {
+#ifdef USE_CUDA
+  std::vector<std::shared_ptr<at::cuda::CUDAEvent>> events;
+  for (const auto* tensors : {&src, &dst}) {
+    for (const auto& tensor : *tensors) {
+      if (!tensor.is_cuda()) {
+        continue;
+      }
+      auto event = std::make_shared<at::cuda::CUDAEvent>();
+      event->record(at::cuda::getCurrentCUDAStream(tensor.device().index()));
+      events.push_back(std::move(event));
+    }
+  }
+  if (!events.empty()) {
+    return [events]() {
+      for (const auto& event : events) {
+        event->synchronize();
+      }
+    };
+  }
+#endif
+  return nullptr;
+}
+
 } // namespace
 
 ProcessGroupMPI::AsyncWork::AsyncWork(at::Tensor tensor, MPI_Request request)
@@ -280,9 +318,19 @@ void ProcessGroupMPI::abort() {
 void ProcessGroupMPI::runLoop() {
   std::unique_lock<std::mutex> lock(pgMutex_);
 
-  while (!stop_) {
-    if (queue_.empty()) {
-      queueProduceCV_.wait(lock);
+  while (!stop_ || !inFlight_.empty()) {
+    if (!inFlight_.empty()) {
+      lock.unlock();
+      progressInFlight();
+      lock.lock();
+    }
+
+    if (queue_.empty() || inFlight_.size() >= kMaxInFlightWork) {
+      if (inFlight_.empty()) {
+        queueProduceCV_.wait(lock);
+      } else {
+        queueProduceCV_.wait_for(lock, kProgressInterval);
+      }
       continue;
     }
 
@@ -297,8 +345,18 @@ void ProcessGroupMPI::runLoop() {
     queueConsumeCV_.notify_one();
 
     try {
+      if (workEntry->waitForTensors) {
+        workEntry->waitForTensors();
+      }
       workEntry->run(workEntry);
-      work->finish();
+      if (workEntry->requests.empty()) {
+        if (workEntry->finalize) {
+          workEntry->finalize(workEntry);
+        }
+        work->finish();
+      } else {
+        inFlight_.push_back(std::move(workTuple));
+      }
     } catch (...) {
       work->finish(std::current_exception());
     }
@@ -307,9 +365,39 @@ void ProcessGroupMPI::runLoop() {
   }
 }
 
+void ProcessGroupMPI::progressInFlight() {
+  for (auto it = inFlight_.begin(); it != inFlight_.end();) {
+    auto& workEntry = std::get<0>(*it);
+    auto& work = std::get<1>(*it);
+    try {
+      int flag = 0;
+      {
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Testall(
+            workEntry->requests.size(),
+            workEntry->requests.data(),
+            &flag,
+            MPI_STATUSES_IGNORE));
+      }
+      if (!flag) {
+        ++it;
+        continue;
+      }
+      if (workEntry->finalize) {
+        workEntry->finalize(workEntry);
+      }
+      work->finish();
+    } catch (...) {
+      work->finish(std::current_exception());
+    }
+    it = inFlight_.erase(it);
+  }
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::enqueue(
     std::unique_ptr<WorkEntry> entry) {
   auto work = std::make_shared<WorkMPI>();
+  entry->waitForTensors = recordTensorsReady(entry->src, entry->dst);
   std::unique_lock<std::mutex> lock(pgMutex_);
   queue_.push_back(std::make_tuple(std::move(entry), work));
   lock.unlock();
@@ -326,12 +414,15 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::broadcast(
         auto data = (entry->src)[0];
         c10::DeviceGuard guard(data.device());
         std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
-        MPI_CHECK(MPI_Bcast(
+        MPI_Request request = MPI_REQUEST_NULL;
+        MPI_CHECK(MPI_Ibcast(
             data.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.scalar_type()),
             opts.rootRank,
-            pgComm_));
+            pgComm_,
+            &request));
+        entry->requests.push_back(request);
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
@@ -348,13 +439,16 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allreduce(
         auto data = (entry->src)[0];
         c10::DeviceGuard guard(data.device());
         std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
-        MPI_CHECK(MPI_Allreduce(
+        MPI_Request request = MPI_REQUEST_NULL;
+        MPI_CHECK(MPI_Iallreduce(
             MPI_IN_PLACE,
             data.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.scalar_type()),
             mpiOp.at(opts.reduceOp),
-            pgComm_));
+            pgComm_,
+            &request));
+        entry->requests.push_back(request);
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
@@ -382,14 +476,17 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduce(
 
         c10::DeviceGuard guard(data.device());
         std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
-        MPI_CHECK(MPI_Reduce(
+        MPI_Request request = MPI_REQUEST_NULL;
+        MPI_CHECK(MPI_Ireduce(
             sendbuf,
             recvbuf,
             data.numel(),
             mpiDatatype.at(data.scalar_type()),
             mpiOp.at(opts.reduceOp),
             opts.rootRank,
-            pgComm_));
+            pgComm_,
+            &request));
+        entry->requests.push_back(request);
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&tensors, nullptr, std::move(runFunc)));
@@ -422,18 +519,25 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allgather(
 
         c10::DeviceGuard guard(data.device());
         std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
-        MPI_CHECK(MPI_Allgather(
+        MPI_Request request = MPI_REQUEST_NULL;
+        MPI_CHECK(MPI_Iallgather(
             data.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.scalar_type()),
             flatOutputTensor.data_ptr(),
             data.numel(),
             mpiDatatype.at(data.scalar_type()),
-            pgComm_));
+            pgComm_,
+            &request));
+        entry->requests.push_back(request);
 
-        for (size_t i = 0; i < outputDataVec.size(); ++i) {
-          outputDataVec[i].copy_(flatOutputTensor[i]);
-        }
+        entry->finalize = [flatOutputTensor](
+                              std::unique_ptr<WorkEntry>& doneEntry) {
+          std::vector<at::Tensor>& outputDataVec = doneEntry->dst;
+          for (size_t i = 0; i < outputDataVec.size(); ++i) {
+            outputDataVec[i].copy_(flatOutputTensor[i]);
+          }
+        };
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(&inputTensors, &outputTensors[0], std::move(runFunc)));
@@ -588,6 +692,146 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduce_scatter(
   throw std::runtime_error("ProcessGroupMPI does not support reduce_scatter");
 }
 
+namespace {
+
+// MPI_Alltoallv takes int counts and displacements.
+void toIntLengthsAndOffsets(
+    const std::vector<int64_t>& lengths,
+    const std::vector<int64_t>& offsets,
+    std::vector<int>& intLengths,
+    std::vector<int>& intOffsets) {
+  intLengths.resize(lengths.size());
+  intOffsets.resize(offsets.size());
+  for (size_t i = 0; i < lengths.size(); i++) {
+    TORCH_CHECK(
+        offsets[i] + lengths[i] <= std::numeric_limits<int>::max(),
+        "MPI alltoall does not support tensors with more than INT_MAX elements");
+    intLengths[i] = static_cast<int>(lengths[i]);
+    intOffsets[i] = static_cast<int>(offsets[i]);
+  }
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& opts) {
+  checkSingleTensorHelper(inputTensor);
+  checkSingleTensorHelper(outputTensor);
+  checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  checkSplitSizes(outputSplitSizes, outputTensor, size_);
+  if (inputTensor.scalar_type() != outputTensor.scalar_type()) {
+    throw std::runtime_error("Tensors are not equal in data type");
+  }
+
+  std::vector<at::Tensor> inputTensors = {inputTensor};
+  std::vector<at::Tensor> outputTensors = {outputTensor};
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [this, inputSplitSizes, outputSplitSizes](
+          std::unique_ptr<WorkEntry>& entry) {
+        auto srcdata = (entry->src)[0];
+        auto dstdata = (entry->dst)[0];
+        std::vector<int64_t> sendLengths, sendOffsets;
+        std::vector<int64_t> recvLengths, recvOffsets;
+        computeLengthsAndOffsets(
+            inputSplitSizes, srcdata, size_, sendLengths, sendOffsets);
+        computeLengthsAndOffsets(
+            outputSplitSizes, dstdata, size_, recvLengths, recvOffsets);
+        std::vector<int> sendCounts, sendDispls, recvCounts, recvDispls;
+        toIntLengthsAndOffsets(sendLengths, sendOffsets, sendCounts, sendDispls);
+        toIntLengthsAndOffsets(recvLengths, recvOffsets, recvCounts, recvDispls);
+
+        c10::DeviceGuard guard(srcdata.device());
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Alltoallv(
+            srcdata.data_ptr(),
+            sendCounts.data(),
+            sendDispls.data(),
+            mpiDatatype.at(srcdata.scalar_type()),
+            dstdata.data_ptr(),
+            recvCounts.data(),
+            recvDispls.data(),
+            mpiDatatype.at(dstdata.scalar_type()),
+            pgComm_));
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors, &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& opts) {
+  if (static_cast<size_t>(size_) != inputTensors.size() ||
+      static_cast<size_t>(size_) != outputTensors.size()) {
+    throw std::runtime_error(
+        "All to all: number of input and output tensors should equal "
+        "to the world size");
+  }
+  for (size_t i = 0; i < inputTensors.size(); i++) {
+    checkSingleTensorHelper(inputTensors[i]);
+    checkSingleTensorHelper(outputTensors[i]);
+    if (inputTensors[i].scalar_type() != inputTensors[0].scalar_type() ||
+        outputTensors[i].scalar_type() != inputTensors[0].scalar_type()) {
+      throw std::runtime_error("Tensors are not equal in data type");
+    }
+  }
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [this](std::unique_ptr<WorkEntry>& entry) {
+        std::vector<at::Tensor>& inputDataVec = entry->src;
+        std::vector<at::Tensor>& outputDataVec = entry->dst;
+
+        // Coalesce the per-rank tensors into one buffer each way and
+        // exchange them with a single MPI_Alltoallv.
+        std::vector<int> sendCounts(size_), sendDispls(size_);
+        std::vector<int> recvCounts(size_), recvDispls(size_);
+        int64_t sendTotal = 0, recvTotal = 0;
+        for (int i = 0; i < size_; i++) {
+          sendCounts[i] = inputDataVec[i].numel();
+          sendDispls[i] = sendTotal;
+          sendTotal += sendCounts[i];
+          recvCounts[i] = outputDataVec[i].numel();
+          recvDispls[i] = recvTotal;
+          recvTotal += recvCounts[i];
+        }
+        TORCH_CHECK(
+            sendTotal <= std::numeric_limits<int>::max() &&
+                recvTotal <= std::numeric_limits<int>::max(),
+            "MPI alltoall does not support tensors with more than INT_MAX elements");
+        auto flatInputTensor = flattenDenseTensors(inputDataVec);
+        auto flatOutputTensor =
+            at::empty({recvTotal}, outputDataVec[0].options());
+
+        c10::DeviceGuard guard(flatInputTensor.device());
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Alltoallv(
+            flatInputTensor.data_ptr(),
+            sendCounts.data(),
+            sendDispls.data(),
+            mpiDatatype.at(flatInputTensor.scalar_type()),
+            flatOutputTensor.data_ptr(),
+            recvCounts.data(),
+            recvDispls.data(),
+            mpiDatatype.at(flatOutputTensor.scalar_type()),
+            pgComm_));
+        globalLock.unlock();
+
+        for (int i = 0; i < size_; i++) {
+          outputDataVec[i].copy_(
+              flatOutputTensor.narrow(0, recvDispls[i], recvCounts[i])
+                  .view(outputDataVec[i].sizes()));
+        }
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors, &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::send(
     std::vector<at::Tensor>& tensors,
     int dstRank,
@@ -667,7 +911,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::barrier(
   std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
       [this](std::unique_ptr<WorkEntry>& entry) {
         std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
-        MPI_CHECK(MPI_Barrier(pgComm_));
+        MPI_Request request = MPI_REQUEST_NULL;
+        MPI_CHECK(MPI_Ibarrier(pgComm_, &request));
+        entry->requests.push_back(request);
       };
   auto entry = std::unique_ptr<WorkEntry>(
       new WorkEntry(nullptr, nullptr, std::move(runFunc)));
@@ -3,6 +3,7 @@
 #include <condition_variable>
 #include <deque>
 #include <exception>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -44,6 +45,17 @@ struct WorkEntry {
   // src rank returned, for recv only
   int* srcRank = nullptr;
   std::function<void(std::unique_ptr<WorkEntry>&)> run;
+
+  // Requests of the non-blocking MPI call started by `run`, if any. The work
+  // stays in flight on the worker thread until all of them have completed.
+  std::vector<MPI_Request> requests;
+  // Run on the worker thread once `requests` have completed, e.g. to copy a
+  // flat output buffer into the output tensors.
+  std::function<void(std::unique_ptr<WorkEntry>&)> finalize;
+  // Blocks until the kernels producing or consuming the CUDA tensors in src
+  // and dst on their streams at enqueue time have finished, so that a
+  // CUDA-aware MPI does not touch them early. Empty for CPU tensors.
+  std::function<void()> waitForTensors;
 };
 
 // ProcessGroupMPI implements MPI bindings for c10d.
@@ -65,6 +77,12 @@ struct WorkEntry {
 // implemenation to have a thread support value of MPI_THREAD_MULTIPLE, that is,
 // multiple threads may call MPI, with no restriction.
 //
+// Broadcast, allreduce, reduce, allgather and barrier use the non-blocking
+// MPI-3 collectives: the worker thread starts them and keeps polling the
+// outstanding requests while it starts the next ones, so up to
+// kMaxInFlightWork of them overlap. The worker thread is the only one issuing
+// collectives, which keeps their order the same on every process.
+//
 // Also note that ProcessGroupMPI only supports a single Tensor operation. In
 // other words, the size of the input Tensor vector should always be 1.
 //
@@ -155,6 +173,18 @@ class ProcessGroupMPI : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
 
+  std::shared_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank,
@@ -181,6 +211,9 @@ class ProcessGroupMPI : public ProcessGroup {
       std::tuple<std::unique_ptr<WorkEntry>, std::shared_ptr<WorkMPI>>;
   // Worker thread loop
   void runLoop();
+  // Tests the requests of the in-flight work on the worker thread and
+  // finishes the work whose requests have all completed.
+  void progressInFlight();
   // Helper function that is called by the destructor
   void destroy();
 
@@ -192,6 +225,12 @@ class ProcessGroupMPI : public ProcessGroup {
   std::thread workerThread_;
 
   std::deque<WorkType> queue_;
+  // Upper bound on the size of inFlight_. The worker thread stops starting
+  // new work until some of it completes.
+  static constexpr size_t kMaxInFlightWork = 16;
+  // Work with outstanding non-blocking requests. Only touched by the worker
+  // thread.
+  std::list<WorkType> inFlight_;
   std::condition_variable queueProduceCV_;
   std::condition_variable queueConsumeCV_;
 
@@ -261,12 +261,18 @@ ProcessGroupNCCL::ProcessGroupNCCL(
     const std::shared_ptr<Store>& store,
     int rank,
     int size,
-    const std::chrono::milliseconds& opTimeout)
+    const std::chrono::milliseconds& opTimeout,
+    int commPoolSize)
     : ProcessGroup(rank, size),
       store_(store),
       ncclCommCounter_(0),
       terminateWatchdog_(false),
-      opTimeout_(opTimeout) {
+      opTimeout_(opTimeout),
+      commPoolSize_(commPoolSize) {
+  TORCH_CHECK(
+      commPoolSize_ >= 1,
+      "Expected at least one NCCL communicator per device set, got ",
+      commPoolSize_);
   char* blockingWait = getenv(NCCL_BLOCKING_WAIT);
   try {
     if (blockingWait != nullptr) {
@@ -616,6 +622,76 @@ std::vector<at::Tensor> flatten_for_scatter_gather(
   return flattened;
 }
 
+// Check the single tensors taken by alltoall_base, which do not have to have
+// the same shape.
+void check_gpu_single_tensor_pair(
+    const at::Tensor& output,
+    const at::Tensor& input) {
+  for (const auto& t : {output, input}) {
+    if (!t.is_cuda() || t.is_sparse()) {
+      throw std::runtime_error("Tensors must be CUDA and dense");
+    }
+    if (!t.is_contiguous()) {
+      throw std::runtime_error("Tensors must be contiguous");
+    }
+  }
+  if (output.scalar_type() != input.scalar_type()) {
+    throw std::runtime_error("Tensors must have identical type");
+  }
+  if (output.get_device() != input.get_device()) {
+    throw std::runtime_error("Tensors must be on the same GPU device");
+  }
+}
+
+#ifdef ENABLE_NCCL_P2P_SUPPORT
+
+// Exchanges the segments of `input' and `output' given by the lengths and
+// offsets (in elements) with every rank through ncclSend/ncclRecv. Must be
+// called between ncclGroupStart() and ncclGroupEnd().
+ncclResult_t ncclAlltoallv(
+    at::Tensor& input,
+    const std::vector<int64_t>& sendLengths,
+    const std::vector<int64_t>& sendOffsets,
+    at::Tensor& output,
+    const std::vector<int64_t>& recvLengths,
+    const std::vector<int64_t>& recvOffsets,
+    ncclComm_t comm,
+    at::cuda::CUDAStream& stream) {
+  const auto type = getNcclDataType(input.scalar_type());
+  const auto elementSize = input.element_size();
+  auto sendBuffer = static_cast<char*>(input.data_ptr());
+  auto recvBuffer = static_cast<char*>(output.data_ptr());
+  for (size_t r = 0; r < sendLengths.size(); r++) {
+    if (sendLengths[r] != 0) {
+      auto result = ncclSend(
+          sendBuffer + sendOffsets[r] * elementSize,
+          sendLengths[r],
+          type,
+          r,
+          comm,
+          stream.stream());
+      if (result != ncclSuccess) {
+        return result;
+      }
+    }
+    if (recvLengths[r] != 0) {
+      auto result = ncclRecv(
+          recvBuffer + recvOffsets[r] * elementSize,
+          recvLengths[r],
+          type,
+          r,
+          comm,
+          stream.stream());
+      if (result != ncclSuccess) {
+        return result;
+      }
+    }
+  }
+  return ncclSuccess;
+}
+
+#endif
+
 } // namespace
 
 std::shared_ptr<ProcessGroupNCCL::WorkNCCL> ProcessGroupNCCL::initWork(
@@ -631,7 +707,14 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     PreProcess pre,
     PostProcess post) {
   const auto devices = getDeviceList(inputs);
-  const auto key = getKeyFromDevices(devices);
+  auto key = getKeyFromDevices(devices);
+  if (commPoolSize_ > 1) {
+    // Collectives are issued in the same order on all processes, so they
+    // pick the same communicator of the pool everywhere.
+    auto& index = nextCommIndex_[key];
+    key += "#" + std::to_string(index);
+    index = (index + 1) % commPoolSize_;
+  }
   auto& ncclComms = getNCCLComm(key, devices);
 
   // First let NCCL streams wait for input tensors allocation streams
@@ -925,6 +1008,136 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::scatter(
   throw std::runtime_error("ProcessGroupNCCL does not support scatter");
 }
 
+#ifdef ENABLE_NCCL_P2P_SUPPORT
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  check_gpu_single_tensor_pair(outputTensor, inputTensor);
+  checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  checkSplitSizes(outputSplitSizes, outputTensor, size_);
+
+  std::vector<int64_t> sendLengths, sendOffsets;
+  std::vector<int64_t> recvLengths, recvOffsets;
+  computeLengthsAndOffsets(
+      inputSplitSizes, inputTensor, size_, sendLengths, sendOffsets);
+  computeLengthsAndOffsets(
+      outputSplitSizes, outputTensor, size_, recvLengths, recvOffsets);
+
+  std::vector<at::Tensor> inputTensors = {inputTensor};
+  std::vector<at::Tensor> outputTensors = {outputTensor};
+  return collective(
+      inputTensors,
+      outputTensors,
+      [&](at::Tensor& input,
+          at::Tensor& output,
+          ncclComm_t comm,
+          at::cuda::CUDAStream& stream) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            output.storage().data_ptr(), stream);
+        return ncclAlltoallv(
+            input,
+            sendLengths,
+            sendOffsets,
+            output,
+            recvLengths,
+            recvOffsets,
+            comm,
+            stream);
+      });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& /* unused */) {
+  if (outputTensors.size() != static_cast<size_t>(size_) ||
+      inputTensors.size() != static_cast<size_t>(size_)) {
+    throw std::runtime_error(
+        "Tensor lists to alltoall must have one tensor per rank");
+  }
+
+  // Coalesce the per-rank tensors into one buffer each way, so that every
+  // peer gets a single ncclSend/ncclRecv pair.
+  std::vector<int64_t> sendLengths(size_), sendOffsets(size_);
+  std::vector<int64_t> recvLengths(size_), recvOffsets(size_);
+  int64_t sendTotal = 0, recvTotal = 0;
+  for (int r = 0; r < size_; r++) {
+    check_gpu_single_tensor_pair(outputTensors[r], inputTensors[r]);
+    check_gpu_single_tensor_pair(outputTensors[r], inputTensors[0]);
+    sendLengths[r] = inputTensors[r].numel();
+    sendOffsets[r] = sendTotal;
+    sendTotal += sendLengths[r];
+    recvLengths[r] = outputTensors[r].numel();
+    recvOffsets[r] = recvTotal;
+    recvTotal += recvLengths[r];
+  }
+
+  std::vector<at::Tensor> inputFlattened = {
+      flattenDenseTensors(inputTensors)};
+  std::vector<at::Tensor> outputFlattened = {
+      at::empty({recvTotal}, outputTensors[0].options())};
+  return collective(
+      inputFlattened,
+      outputFlattened,
+      [&](at::Tensor& input,
+          at::Tensor& output,
+          ncclComm_t comm,
+          at::cuda::CUDAStream& stream) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            output.storage().data_ptr(), stream);
+        return ncclAlltoallv(
+            input,
+            sendLengths,
+            sendOffsets,
+            output,
+            recvLengths,
+            recvOffsets,
+            comm,
+            stream);
+      },
+      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {},
+      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {
+        // Copy the flattened output tensor to the outputs.
+        at::cuda::CUDAStreamGuard guard(ncclStreams[0]);
+        for (int r = 0; r < size_; r++) {
+          // See [Sync Streams].
+          c10::cuda::CUDACachingAllocator::recordStream(
+              outputTensors[r].storage().data_ptr(), ncclStreams[0]);
+          outputTensors[r].copy_(
+              outputFlattened[0]
+                  .narrow(0, recvOffsets[r], recvLengths[r])
+                  .view(outputTensors[r].sizes()),
+              true);
+        }
+      });
+}
+
+#else
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_base(
+    at::Tensor& /* unused */,
+    at::Tensor& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports alltoall_base for NCCL 2.7 or later");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<at::Tensor>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports alltoall for NCCL 2.7 or later");
+}
+
+#endif
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::send(
     std::vector<at::Tensor>& /* unused */,
     int /* unused */,
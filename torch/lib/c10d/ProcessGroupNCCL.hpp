@@ -140,12 +140,22 @@ class ProcessGroupNCCL : public ProcessGroup {
   // against a different set of devices, the process group creates another NCCL
   // communicator. These NCCL communicators are cached and reused if possible.
   //
+  // With `commPoolSize` > 1, every set of devices gets a pool of that many
+  // NCCL communicators, each with its own streams, and collectives use them
+  // round robin. Collectives issued back to back can then run concurrently,
+  // e.g. the allreduce calls of consecutive DDP buckets. Every collective
+  // still waits for the current stream of the caller, and `wait()` makes the
+  // current stream wait for the collective as before. But two collectives
+  // touching the same tensors are no longer ordered with respect to each
+  // other unless the caller waits for the first one.
+  //
   ProcessGroupNCCL(
       const std::shared_ptr<Store>& store,
       int rank,
       int size,
       const std::chrono::milliseconds& opTimeout =
-          std::chrono::milliseconds(kProcessGroupNCCLOpTimeoutMillis));
+          std::chrono::milliseconds(kProcessGroupNCCLOpTimeoutMillis),
+      int commPoolSize = 1);
 
   // This constructor includes the deprecated `groupName` argument.
   // If you have existing code that uses the `groupName`, you can replace
@@ -212,6 +222,18 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) override;
 
+  std::shared_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   std::shared_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank,
@@ -372,6 +394,13 @@ class ProcessGroupNCCL : public ProcessGroup {
   // Timeout for operations. This is only used when blockingWait_ is enabled.
   std::chrono::milliseconds opTimeout_;
 
+  // Number of NCCL communicators used round robin for every set of devices.
+  int commPoolSize_;
+
+  // Index of the communicator in the pool to use for the next collective,
+  // keyed like devNCCLCommMap_ without the index.
+  std::unordered_map<std::string, size_t> nextCommIndex_;
+
   // Set of communicators that this process group has aborted and their
   // ncclUniqueId has been written to the store. We don't need a lock
   // for this map since only the watchdog thread accesses this set. The
@@ -38,6 +38,17 @@ class Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Gets the values of several keys, waiting for all of them to be set.
+  // Stores that can fetch them in fewer round trips than one get per key
+  // override this.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Sets the values of several keys, see multiGet.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
   void setTimeout(const std::chrono::milliseconds& timeout);
 
  protected:
@@ -10,17 +10,54 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_GET,
+  MULTI_SET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+// Uses FNV-1a rather than std::hash, so that every process agrees on the
+// shard of a key.
+size_t shardOf(const std::string& key, size_t numShards) {
+  if (numShards == 1) {
+    return 0;
+  }
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  }
+  return hash % numShards;
+}
+
+// Sends the number of keys and the keys at the given indices.
+void sendKeys(
+    int socket,
+    const std::vector<std::string>& keys,
+    const std::vector<size_t>& indices) {
+  SizeType nkeys = indices.size();
+  tcputil::sendBytes<SizeType>(socket, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(socket, keys[indices[i]], (i != (nkeys - 1)));
+  }
+}
+
+std::string shardPortKey(int shard) {
+  return "shards/" + std::to_string(shard);
+}
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
-// Simply start the daemon thread
-TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
+// Simply start the daemon thread and its workers
+TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket, size_t numThreads)
     : storeListenSocket_(storeListenSocket) {
   // Use control pipe to signal instance destruction to the daemon thread.
   if (pipe(controlPipeFd_.data()) == -1) {
@@ -28,19 +65,39 @@ TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
         "Failed to create the control pipe to start the "
         "TCPStoreDaemon run");
   }
+  for (size_t i = 0; i < std::max<size_t>(numThreads, 1); i++) {
+    auto worker = std::unique_ptr<Worker>(new Worker());
+    if (pipe(worker->notifyPipeFd.data()) == -1) {
+      throw std::runtime_error(
+          "Failed to create the pipe to notify a TCPStoreDaemon worker");
+    }
+    workers_.push_back(std::move(worker));
+  }
+  for (auto& worker : workers_) {
+    worker->thread =
+        std::thread(&TCPStoreDaemon::runWorker, this, std::ref(*worker));
+  }
   daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
 }
 
 TCPStoreDaemon::~TCPStoreDaemon() {
   // Stop the run
   stop();
-  // Join the thread
+  // Join the threads
   join();
-  // Close unclosed sockets
-  for (auto socket : sockets_) {
-    if (socket != -1) {
+  for (auto& worker : workers_) {
+    // Close unclosed sockets
+    for (auto socket : worker->sockets) {
       ::close(socket);
     }
+    for (auto socket : worker->newSockets) {
+      ::close(socket);
+    }
+    for (auto fd : worker->notifyPipeFd) {
+      if (fd != -1) {
+        ::close(fd);
+      }
+    }
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -52,6 +109,9 @@ TCPStoreDaemon::~TCPStoreDaemon() {
 
 void TCPStoreDaemon::join() {
   daemonThread_.join();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
 }
 
 void TCPStoreDaemon::run() {
@@ -60,11 +120,11 @@ void TCPStoreDaemon::run() {
   // Push the read end of the pipe to signal the stopping of the daemon run
   fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
 
-  // receive the queries
-  bool finished = false;
-  while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
+  // accept the connections
+  size_t nextWorker = 0;
+  while (true) {
+    for (auto& fd : fds) {
+      fd.revents = 0;
     }
 
     SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
@@ -80,8 +140,15 @@ void TCPStoreDaemon::run() {
                 std::to_string(fds[0].revents));
       }
       int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
+      auto& worker = *workers_[nextWorker];
+      nextWorker = (nextWorker + 1) % workers_.size();
+      {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.newSockets.push_back(sockFd);
+      }
+      // Wake up the worker to start polling the connection
+      char byte = 0;
+      SYSCHECK_ERR_RETURN_NEG1(::write(worker.notifyPipeFd[1], &byte, 1));
     }
     // The pipe receives an event which tells us to shutdown the daemon
     if (fds[1].revents != 0) {
@@ -93,12 +160,59 @@ void TCPStoreDaemon::run() {
             "Unexpected poll revent on the control pipe's reading fd: " +
                 std::to_string(fds[1].revents));
       }
-      finished = true;
       break;
     }
+  }
+}
+
+void TCPStoreDaemon::runWorker(Worker& worker) {
+  std::vector<struct pollfd> fds;
+  // Push the read end of the pipe to signal the stopping of the daemon run
+  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
+  // and of the pipe to signal new connections of this worker
+  fds.push_back({.fd = worker.notifyPipeFd[0], .events = POLLIN});
+
+  // receive the queries
+  while (true) {
+    for (auto& fd : fds) {
+      fd.revents = 0;
+    }
+
+    SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
+
+    // The pipe receives an event which tells us to shutdown the daemon
+    if (fds[0].revents != 0) {
+      // Will be POLLUP when the pipe is closed
+      if (fds[0].revents ^ POLLHUP) {
+        throw std::system_error(
+            ECONNABORTED,
+            std::system_category(),
+            "Unexpected poll revent on the control pipe's reading fd: " +
+                std::to_string(fds[0].revents));
+      }
+      break;
+    }
+    // The daemon thread has accepted connections for this worker
+    if (fds[1].revents != 0) {
+      if (fds[1].revents ^ POLLIN) {
+        throw std::system_error(
+            ECONNABORTED,
+            std::system_category(),
+            "Unexpected poll revent on the worker pipe's reading fd: " +
+                std::to_string(fds[1].revents));
+      }
+      char byte;
+      SYSCHECK_ERR_RETURN_NEG1(::read(worker.notifyPipeFd[0], &byte, 1));
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      for (int sockFd : worker.newSockets) {
+        worker.sockets.push_back(sockFd);
+        fds.push_back({.fd = sockFd, .events = POLLIN});
+      }
+      worker.newSockets.clear();
+    }
     // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
+    // fds[0] is control pipe's reading fd
+    // fds[1] is worker pipe's reading fd
     for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
       if (fds[fdIdx].revents == 0) {
         continue;
@@ -115,32 +229,16 @@ void TCPStoreDaemon::run() {
         // exception, other connections will get an exception once they try to
         // use the store. We will go ahead and close this connection whenever
         // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
+        //
+        // The tracking state goes first, so that no other worker wakes up
+        // a socket that reuses the closed FD.
+        {
+          std::lock_guard<std::mutex> lock(storeMutex_);
+          removeSocketState(fds[fdIdx].fd);
         }
+        ::close(fds[fdIdx].fd);
         fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
+        worker.sockets.erase(worker.sockets.begin() + fdIdx - 2);
         --fdIdx;
         continue;
       }
@@ -148,6 +246,24 @@ void TCPStoreDaemon::run() {
   }
 }
 
+void TCPStoreDaemon::removeSocketState(int socket) {
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
+      if (*vecIt == socket) {
+        vecIt = it->second.erase(vecIt);
+      } else {
+        ++vecIt;
+      }
+    }
+    if (it->second.size() == 0) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  keysAwaited_.erase(socket);
+}
+
 void TCPStoreDaemon::stop() {
   if (controlPipeFd_[1] != -1) {
     // close the write end of the pipe
@@ -159,8 +275,11 @@ void TCPStoreDaemon::stop() {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of check, wait and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of multi set
+// type of query | number of keys | size of key1 | key1 | size of value1 |
+// value1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -180,6 +299,12 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -200,7 +325,9 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
 
 void TCPStoreDaemon::setHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+  auto value = tcputil::recvVector<uint8_t>(socket);
+  std::lock_guard<std::mutex> lock(storeMutex_);
+  tcpStore_[key] = std::move(value);
   // On "set", wake up all clients that have been waiting
   wakeupWaitingClients(key);
 }
@@ -209,26 +336,34 @@ void TCPStoreDaemon::addHandler(int socket) {
   std::string key = tcputil::recvString(socket);
   int64_t addVal = tcputil::recvValue<int64_t>(socket);
 
-  if (tcpStore_.find(key) != tcpStore_.end()) {
-    auto buf = reinterpret_cast<const char*>(tcpStore_[key].data());
-    auto len = tcpStore_[key].size();
-    addVal += std::stoll(std::string(buf, len));
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    auto it = tcpStore_.find(key);
+    if (it != tcpStore_.end()) {
+      auto buf = reinterpret_cast<const char*>(it->second.data());
+      auto len = it->second.size();
+      addVal += std::stoll(std::string(buf, len));
+    }
+    auto addValStr = std::to_string(addVal);
+    tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
+    // On "add", wake up all clients that have been waiting
+    wakeupWaitingClients(key);
   }
-  auto addValStr = std::to_string(addVal);
-  tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
   tcputil::sendValue<int64_t>(socket, addVal);
-  // On "add", wake up all clients that have been waiting
-  wakeupWaitingClients(key);
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
+void TCPStoreDaemon::getHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
+  std::vector<uint8_t> data;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    data = tcpStore_.at(key);
+  }
   tcputil::sendVector<uint8_t>(socket, data);
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
+void TCPStoreDaemon::checkHandler(int socket) {
   SizeType nargs;
   tcputil::recvBytes<SizeType>(socket, &nargs, 1);
   std::vector<std::string> keys(nargs);
@@ -236,7 +371,12 @@ void TCPStoreDaemon::checkHandler(int socket) const {
     keys[i] = tcputil::recvString(socket);
   }
   // Now we have received all the keys
-  if (checkKeys(keys)) {
+  bool ready;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    ready = checkKeys(keys);
+  }
+  if (ready) {
     tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::READY);
   } else {
     tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::NOT_READY);
@@ -250,14 +390,57 @@ void TCPStoreDaemon::waitHandler(int socket) {
   for (size_t i = 0; i < nargs; i++) {
     keys[i] = tcputil::recvString(socket);
   }
-  if (checkKeys(keys)) {
-    tcputil::sendValue<WaitResponseType>(
-        socket, WaitResponseType::STOP_WAITING);
-  } else {
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    // Only the keys that are not set yet can wake up the socket.
+    size_t numKeysToAwait = 0;
     for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+      if (tcpStore_.count(key) == 0) {
+        waitingSockets_[key].push_back(socket);
+        numKeysToAwait++;
+      }
     }
-    keysAwaited_[socket] = keys.size();
+    if (numKeysToAwait > 0) {
+      keysAwaited_[socket] = numKeysToAwait;
+      return;
+    }
+  }
+  tcputil::sendValue<WaitResponseType>(socket, WaitResponseType::STOP_WAITING);
+}
+
+void TCPStoreDaemon::multiGetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(nargs);
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    for (const auto& key : keys) {
+      values.push_back(tcpStore_.at(key));
+    }
+  }
+  for (size_t i = 0; i < nargs; i++) {
+    tcputil::sendVector<uint8_t>(socket, values[i], (i != (nargs - 1)));
+  }
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  std::vector<std::vector<uint8_t>> values(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+    values[i] = tcputil::recvVector<uint8_t>(socket);
+  }
+  std::lock_guard<std::mutex> lock(storeMutex_);
+  for (size_t i = 0; i < nargs; i++) {
+    tcpStore_[keys[i]] = std::move(values[i]);
+    wakeupWaitingClients(keys[i]);
   }
 }
 
@@ -274,7 +457,9 @@ TCPStore::TCPStore(
     int numWorkers,
     bool isServer,
     const std::chrono::milliseconds& timeout,
-    bool waitWorkers)
+    bool waitWorkers,
+    int numShards,
+    int numServerThreads)
     : Store(timeout),
       isServer_(isServer),
       tcpStoreAddr_(masterAddr),
@@ -282,16 +467,49 @@ TCPStore::TCPStore(
       numWorkers_(numWorkers),
       initKey_("init/"),
       regularPrefix_("/") {
+  if (numShards < 1 || numServerThreads < 1) {
+    throw std::invalid_argument(
+        "TCPStore expects at least one shard and one server thread");
+  }
+  std::vector<PortType> shardPorts;
   if (isServer_) {
     // Opening up the listening socket
     std::tie(masterListenSocket_, tcpStorePort_) = tcputil::listen(masterPort);
     // Now start the daemon
     tcpStoreDaemon_ = std::unique_ptr<TCPStoreDaemon>(
-        new TCPStoreDaemon(masterListenSocket_));
+        new TCPStoreDaemon(masterListenSocket_, numServerThreads));
+    // The other shards listen on any free port
+    for (int i = 1; i < numShards; i++) {
+      int listenSocket;
+      PortType port;
+      std::tie(listenSocket, port) = tcputil::listen(0);
+      shardListenSockets_.push_back(listenSocket);
+      shardDaemons_.emplace_back(
+          new TCPStoreDaemon(listenSocket, numServerThreads));
+      shardPorts.push_back(port);
+    }
   }
   // Connect to the daemon
-  storeSocket_ = tcputil::connect(
-      tcpStoreAddr_, tcpStorePort_, /* wait= */ true, timeout_);
+  storeSockets_.push_back(tcputil::connect(
+      tcpStoreAddr_, tcpStorePort_, /* wait= */ true, timeout_));
+
+  // Until the other shards are connected, all keys are on shard 0.
+  for (size_t i = 0; i < shardPorts.size(); i++) {
+    auto portStr = std::to_string(shardPorts[i]);
+    tcputil::sendValue<QueryType>(storeSockets_[0], QueryType::SET);
+    tcputil::sendString(storeSockets_[0], shardPortKey(i + 1), true);
+    tcputil::sendVector<uint8_t>(
+        storeSockets_[0], std::vector<uint8_t>(portStr.begin(), portStr.end()));
+  }
+  std::vector<int> shardSockets;
+  for (int i = 1; i < numShards; i++) {
+    auto value = getHelper_(shardPortKey(i));
+    auto port = std::stoi(std::string(value.begin(), value.end()));
+    shardSockets.push_back(tcputil::connect(
+        tcpStoreAddr_, port, /* wait= */ true, timeout_));
+  }
+  storeSockets_.insert(
+      storeSockets_.end(), shardSockets.begin(), shardSockets.end());
 
   if (waitWorkers) {
     waitForWorkers();
@@ -299,12 +517,18 @@ TCPStore::TCPStore(
 }
 
 TCPStore::~TCPStore() {
-  ::close(storeSocket_);
+  for (auto socket : storeSockets_) {
+    ::close(socket);
+  }
   if (isServer_) {
-    // Store daemon should end because of closed connection.
+    // Store daemons should end because of closed connection.
     // daemon destructor should join the thread
     tcpStoreDaemon_.reset(nullptr);
+    shardDaemons_.clear();
     ::close(masterListenSocket_);
+    for (auto socket : shardListenSockets_) {
+      ::close(socket);
+    }
   }
 }
 
@@ -333,11 +557,25 @@ void TCPStore::waitForWorkers() {
   }
 }
 
+int TCPStore::shardSocket_(const std::string& key) const {
+  return storeSockets_[shardOf(key, storeSockets_.size())];
+}
+
+std::vector<std::vector<size_t>> TCPStore::groupByShard_(
+    const std::vector<std::string>& keys) const {
+  std::vector<std::vector<size_t>> shards(storeSockets_.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    shards[shardOf(keys[i], storeSockets_.size())].push_back(i);
+  }
+  return shards;
+}
+
 void TCPStore::set(const std::string& key, const std::vector<uint8_t>& data) {
   std::string regKey = regularPrefix_ + key;
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::SET);
-  tcputil::sendString(storeSocket_, regKey, true);
-  tcputil::sendVector<uint8_t>(storeSocket_, data);
+  int socket = shardSocket_(regKey);
+  tcputil::sendValue<QueryType>(socket, QueryType::SET);
+  tcputil::sendString(socket, regKey, true);
+  tcputil::sendVector<uint8_t>(socket, data);
 }
 
 std::vector<uint8_t> TCPStore::get(const std::string& key) {
@@ -347,9 +585,10 @@ std::vector<uint8_t> TCPStore::get(const std::string& key) {
 
 std::vector<uint8_t> TCPStore::getHelper_(const std::string& key) {
   waitHelper_({key}, timeout_);
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
-  tcputil::sendString(storeSocket_, key);
-  return tcputil::recvVector<uint8_t>(storeSocket_);
+  int socket = shardSocket_(key);
+  tcputil::sendValue<QueryType>(socket, QueryType::GET);
+  tcputil::sendString(socket, key);
+  return tcputil::recvVector<uint8_t>(socket);
 }
 
 int64_t TCPStore::add(const std::string& key, int64_t value) {
@@ -358,28 +597,40 @@ int64_t TCPStore::add(const std::string& key, int64_t value) {
 }
 
 int64_t TCPStore::addHelper_(const std::string& key, int64_t value) {
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::ADD);
-  tcputil::sendString(storeSocket_, key, true);
-  tcputil::sendValue<int64_t>(storeSocket_, value);
-  return tcputil::recvValue<int64_t>(storeSocket_);
+  int socket = shardSocket_(key);
+  tcputil::sendValue<QueryType>(socket, QueryType::ADD);
+  tcputil::sendString(socket, key, true);
+  tcputil::sendValue<int64_t>(socket, value);
+  return tcputil::recvValue<int64_t>(socket);
 }
 
 bool TCPStore::check(const std::vector<std::string>& keys) {
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::CHECK);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    std::string regKey = regularPrefix_ + keys[i];
-    tcputil::sendString(storeSocket_, regKey, (i != (nkeys - 1)));
-  }
-  auto checkResponse = tcputil::recvValue<CheckResponseType>(storeSocket_);
-  if (checkResponse == CheckResponseType::READY) {
-    return true;
-  } else if (checkResponse == CheckResponseType::NOT_READY) {
-    return false;
-  } else {
-    throw std::runtime_error("ready or not_ready response expected");
+  std::vector<std::string> regKeys(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    regKeys[i] = regularPrefix_ + keys[i];
   }
+  // Ask all shards before receiving any of the responses
+  const auto shards = groupByShard_(regKeys);
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    if (!shards[shard].empty()) {
+      tcputil::sendValue<QueryType>(storeSockets_[shard], QueryType::CHECK);
+      sendKeys(storeSockets_[shard], regKeys, shards[shard]);
+    }
+  }
+  bool ready = true;
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    if (shards[shard].empty()) {
+      continue;
+    }
+    auto checkResponse =
+        tcputil::recvValue<CheckResponseType>(storeSockets_[shard]);
+    if (checkResponse == CheckResponseType::NOT_READY) {
+      ready = false;
+    } else if (checkResponse != CheckResponseType::READY) {
+      throw std::runtime_error("ready or not_ready response expected");
+    }
+  }
+  return ready;
 }
 
 void TCPStore::wait(const std::vector<std::string>& keys) {
@@ -400,26 +651,90 @@ void TCPStore::wait(
 void TCPStore::waitHelper_(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
-  // Set the socket timeout if there is a wait timeout
-  if (timeout != kNoTimeout) {
-    struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
-                                .tv_usec = (timeout.count() % 1000) * 1000};
-    SYSCHECK_ERR_RETURN_NEG1(::setsockopt(
-        storeSocket_,
-        SOL_SOCKET,
-        SO_RCVTIMEO,
-        reinterpret_cast<char*>(&timeoutTV),
-        sizeof(timeoutTV)));
-  }
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+  // Wait on all shards at once, so that the waits overlap
+  const auto shards = groupByShard_(keys);
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    if (shards[shard].empty()) {
+      continue;
+    }
+    int socket = storeSockets_[shard];
+    // Set the socket timeout if there is a wait timeout
+    if (timeout != kNoTimeout) {
+      struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
+                                  .tv_usec = (timeout.count() % 1000) * 1000};
+      SYSCHECK_ERR_RETURN_NEG1(::setsockopt(
+          socket,
+          SOL_SOCKET,
+          SO_RCVTIMEO,
+          reinterpret_cast<char*>(&timeoutTV),
+          sizeof(timeoutTV)));
+    }
+    tcputil::sendValue<QueryType>(socket, QueryType::WAIT);
+    sendKeys(socket, keys, shards[shard]);
+  }
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    if (shards[shard].empty()) {
+      continue;
+    }
+    auto waitResponse =
+        tcputil::recvValue<WaitResponseType>(storeSockets_[shard]);
+    if (waitResponse != WaitResponseType::STOP_WAITING) {
+      throw std::runtime_error("Stop_waiting response is expected");
+    }
+  }
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::string> regKeys(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    regKeys[i] = regularPrefix_ + keys[i];
   }
-  auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
-  if (waitResponse != WaitResponseType::STOP_WAITING) {
-    throw std::runtime_error("Stop_waiting response is expected");
+  waitHelper_(regKeys, timeout_);
+  const auto shards = groupByShard_(regKeys);
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    if (!shards[shard].empty()) {
+      tcputil::sendValue<QueryType>(storeSockets_[shard], QueryType::MULTI_GET);
+      sendKeys(storeSockets_[shard], regKeys, shards[shard]);
+    }
+  }
+  std::vector<std::vector<uint8_t>> values(keys.size());
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    for (auto index : shards[shard]) {
+      values[index] = tcputil::recvVector<uint8_t>(storeSockets_[shard]);
+    }
+  }
+  return values;
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects as many values as keys, got " +
+        std::to_string(values.size()) + " values for " +
+        std::to_string(keys.size()) + " keys");
+  }
+  std::vector<std::string> regKeys(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    regKeys[i] = regularPrefix_ + keys[i];
+  }
+  const auto shards = groupByShard_(regKeys);
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    const auto& indices = shards[shard];
+    if (indices.empty()) {
+      continue;
+    }
+    int socket = storeSockets_[shard];
+    tcputil::sendValue<QueryType>(socket, QueryType::MULTI_SET, true);
+    SizeType nkeys = indices.size();
+    tcputil::sendBytes<SizeType>(socket, &nkeys, 1, true);
+    for (size_t i = 0; i < nkeys; i++) {
+      tcputil::sendString(socket, regKeys[indices[i]], true);
+      tcputil::sendVector<uint8_t>(
+          socket, values[indices[i]], (i != (nkeys - 1)));
+    }
   }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 
@@ -9,49 +10,78 @@
 
 namespace c10d {
 
+// TCPStoreDaemon serves the store over the connections accepted on the
+// listening socket. The daemon thread only accepts connections and hands them
+// out round robin to `numThreads` worker threads, which each poll their own
+// connections and answer the queries on them. The store itself is shared by
+// all workers and guarded by a single mutex, that is never held while
+// receiving a query from a connection.
 class TCPStoreDaemon {
  public:
-  explicit TCPStoreDaemon(int storeListenSocket);
+  explicit TCPStoreDaemon(int storeListenSocket, size_t numThreads = 1);
   ~TCPStoreDaemon();
 
   void join();
 
  protected:
+  // The connections of a worker thread. Accepted connections are queued in
+  // `newSockets` and the worker is told about them through its pipe.
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::vector<int> newSockets;
+    std::vector<int> sockets;
+    std::vector<int> notifyPipeFd{-1, -1};
+  };
+
   void run();
+  void runWorker(Worker& worker);
   void stop();
 
   void query(int socket);
 
   void setHandler(int socket);
   void addHandler(int socket);
-  void getHandler(int socket) const;
-  void checkHandler(int socket) const;
+  void getHandler(int socket);
+  void checkHandler(int socket);
   void waitHandler(int socket);
+  void multiGetHandler(int socket);
+  void multiSetHandler(int socket);
 
+  // These require storeMutex_ to be held.
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
+  void removeSocketState(int socket);
 
   std::thread daemonThread_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex storeMutex_;
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
   // From key -> the list of sockets waiting on it
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
 
-  std::vector<int> sockets_;
   int storeListenSocket_;
   std::vector<int> controlPipeFd_{-1, -1};
 };
 
 class TCPStore : public Store {
  public:
+  // With `numShards` > 1 the server runs that many daemons and every key is
+  // held by one of them, chosen by a hash of the key. All processes have to
+  // pass the same `numShards`. Every daemon serves its connections from
+  // `numServerThreads` threads.
   explicit TCPStore(
       const std::string& masterAddr,
       PortType masterPort,
       int numWorkers,
       bool isServer = false,
       const std::chrono::milliseconds& timeout = kDefaultTimeout,
-      bool waitWorkers = true);
+      bool waitWorkers = true,
+      int numShards = 1,
+      int numServerThreads = 1);
 
   virtual ~TCPStore();
 
@@ -69,6 +99,16 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  // Waits for all keys in a single round trip per shard, then gets them in
+  // another one.
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  // Sets all keys with a single query per shard.
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
   // Waits for all workers to join.
   void waitForWorkers();
 
@@ -82,9 +122,18 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout);
 
+  // Returns the socket connected to the shard that holds the key.
+  int shardSocket_(const std::string& key) const;
+  // Returns the indices of the keys held by each shard.
+  std::vector<std::vector<size_t>> groupByShard_(
+      const std::vector<std::string>& keys) const;
+
   bool isServer_;
-  int storeSocket_ = -1;
+  // The connection to every shard. Shard 0 is the daemon at the master port,
+  // the other shards publish their ports through it.
+  std::vector<int> storeSockets_;
   int masterListenSocket_ = -1;
+  std::vector<int> shardListenSockets_;
 
   std::string tcpStoreAddr_;
   PortType tcpStorePort_;
@@ -95,6 +144,7 @@ class TCPStore : public Store {
 
   // Only needs to be launched as the server
   std::unique_ptr<TCPStoreDaemon> tcpStoreDaemon_ = nullptr;
+  std::vector<std::unique_ptr<TCPStoreDaemon>> shardDaemons_;
 };
 
 } // namespace c10d
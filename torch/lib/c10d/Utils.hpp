@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <functional>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <system_error>
 #include <tuple>
@@ -354,6 +355,51 @@ std::vector<T*> getDataPointers(const std::vector<at::Tensor>& tensors) {
   return ptrs;
 }
 
+// Checks the split sizes of an alltoall_base argument against the first
+// dimension of the tensor. Empty split sizes mean equal splits.
+inline void checkSplitSizes(
+    const std::vector<int64_t>& split_sizes,
+    const at::Tensor& tensor,
+    int group_size) {
+  if (split_sizes.size() == 0) {
+    TORCH_CHECK(
+        tensor.size(0) % group_size == 0,
+        "Tensor's dim 0 does not divide equally across group size");
+  } else {
+    TORCH_CHECK(
+        split_sizes.size() == group_size,
+        "Number of tensor splits not equal to group size");
+    const auto sum = std::accumulate(
+        split_sizes.begin(), split_sizes.end(), static_cast<int64_t>(0));
+    TORCH_CHECK(
+        sum == tensor.size(0), "Split sizes doesn't match total dim 0 size");
+  }
+}
+
+// Turns the split sizes of an alltoall_base argument into per-rank element
+// counts and offsets into the flat tensor. Returns the total element count.
+inline int64_t computeLengthsAndOffsets(
+    const std::vector<int64_t>& split_sizes,
+    const at::Tensor& tensor,
+    int group_size,
+    std::vector<int64_t>& lengths,
+    std::vector<int64_t>& offsets) {
+  lengths.resize(group_size);
+  offsets.resize(group_size);
+  const int64_t row_size = tensor.size(0) ? tensor.numel() / tensor.size(0) : 1;
+  const int64_t equal_split =
+      split_sizes.size() == 0 ? tensor.size(0) / group_size : 0;
+  int64_t offset = 0;
+  for (int i = 0; i < group_size; i++) {
+    const int64_t rows =
+        split_sizes.size() == 0 ? equal_split : split_sizes[i];
+    lengths[i] = rows * row_size;
+    offsets[i] = offset;
+    offset += lengths[i];
+  }
+  return offset;
+}
+
 using RankType = uint32_t;
 using PortType = uint16_t;
 using SizeType = uint64_t;
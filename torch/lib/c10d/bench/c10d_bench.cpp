@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+#include <c10/core/DeviceGuard.h>
+#include <c10/util/Flags.h>
+#include <c10d/FileStore.hpp>
+#include <c10d/TCPStore.hpp>
+#include <torch/csrc/autograd/autograd.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
+#include <torch/csrc/distributed/c10d/reducer.h>
+
+#ifdef USE_C10D_GLOO
+#include <c10d/ProcessGroupGloo.hpp>
+#endif
+
+#ifdef USE_C10D_NCCL
+#include <c10d/ProcessGroupNCCL.hpp>
+#endif
+
+#ifdef USE_C10D_MPI
+#include <c10d/ProcessGroupMPI.hpp>
+#endif
+
+C10_DEFINE_string(backend, "gloo", "The backend: gloo, nccl or mpi.");
+C10_DEFINE_string(
+    ops,
+    "allreduce,allgather,broadcast,reduce_scatter,alltoall",
+    "The collectives to benchmark, separated by commas.");
+C10_DEFINE_string(
+    dtypes,
+    "float",
+    "The dtypes to benchmark, separated by commas: float, double, half, "
+    "int or long.");
+C10_DEFINE_string(
+    device,
+    "cpu",
+    "The device of the tensors, cpu or cuda. With cuda, every process uses "
+    "the GPU of its rank modulo the number of GPUs.");
+C10_DEFINE_int64(min_bytes, 4, "The smallest message size.");
+C10_DEFINE_int64(max_bytes, 64 << 20, "The largest message size.");
+C10_DEFINE_int(step_factor, 2, "The factor between message sizes.");
+C10_DEFINE_int(warmup, 5, "The number of runs to warm up.");
+C10_DEFINE_int(iters, 20, "The number of runs to time.");
+C10_DEFINE_string(
+    store_path,
+    "/tmp/c10d_bench",
+    "The file of the FileStore, if MASTER_ADDR isn't set. It must not exist "
+    "when the processes start.");
+C10_DEFINE_int(gloo_threads, 2, "The number of threads of ProcessGroupGloo.");
+C10_DEFINE_int(
+    nccl_comm_pool_size,
+    1,
+    "The number of communicators per device of ProcessGroupNCCL.");
+C10_DEFINE_bool(
+    reducer,
+    false,
+    "Benchmark the DDP Reducer instead of the collectives.");
+C10_DEFINE_int(reducer_params, 100, "The number of synthetic parameters.");
+C10_DEFINE_int64(
+    reducer_param_numel,
+    256 << 10,
+    "The number of elements of every synthetic parameter.");
+C10_DEFINE_string(
+    bucket_cap_mb,
+    "1,5,25,100",
+    "The bucket caps of the Reducer to benchmark, separated by commas.");
+C10_DEFINE_string(
+    comm_hook,
+    "none",
+    "The communication hook of the Reducer: none, fp16 or powersgd.");
+C10_DEFINE_int(powersgd_rank, 1, "The rank of the PowerSGD approximation.");
+C10_DEFINE_bool(
+    gradient_as_bucket_view,
+    false,
+    "Whether the grads of the Reducer are views into its buckets.");
+
+using namespace ::c10d;
+
+namespace {
+
+// Launches a run of a collective, and returns the work to wait for
+using Launch =
+    std::function<std::vector<std::shared_ptr<ProcessGroup::Work>>()>;
+
+std::vector<std::string> split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream stream(str);
+  std::string item;
+  while (getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+int getEnvInt(const char* name, int default_value) {
+  const char* value = std::getenv(name);
+  return value ? atoi(value) : default_value;
+}
+
+at::ScalarType parseDtype(const std::string& name) {
+  if (name == "float") {
+    return at::kFloat;
+  } else if (name == "double") {
+    return at::kDouble;
+  } else if (name == "half") {
+    return at::kHalf;
+  } else if (name == "int") {
+    return at::kInt;
+  } else if (name == "long") {
+    return at::kLong;
+  }
+  TORCH_CHECK(false, "Unknown dtype ", name);
+}
+
+// Like example/allreduce.cpp, the rank and number of processes are read from
+// the RANK and SIZE environment variables. The processes rendezvous through
+// a TCPStore if MASTER_ADDR is set, or else through a FileStore.
+std::shared_ptr<ProcessGroup> createProcessGroup() {
+#ifdef USE_C10D_MPI
+  if (FLAGS_backend == "mpi") {
+    return ProcessGroupMPI::createProcessGroupMPI();
+  }
+#endif
+  const int rank = getEnvInt("RANK", 0);
+  const int size = getEnvInt("SIZE", 1);
+  std::shared_ptr<Store> store;
+  if (const char* master_addr = std::getenv("MASTER_ADDR")) {
+    store = std::make_shared<TCPStore>(
+        master_addr, getEnvInt("MASTER_PORT", 29500), size, rank == 0);
+  } else {
+    store = std::make_shared<FileStore>(FLAGS_store_path, size);
+  }
+#ifdef USE_C10D_GLOO
+  if (FLAGS_backend == "gloo") {
+    ProcessGroupGloo::Options options;
+    options.devices.push_back(ProcessGroupGloo::createDefaultDevice());
+    options.threads = FLAGS_gloo_threads;
+    return std::make_shared<ProcessGroupGloo>(store, rank, size, options);
+  }
+#endif
+#ifdef USE_C10D_NCCL
+  if (FLAGS_backend == "nccl") {
+    return std::make_shared<ProcessGroupNCCL>(
+        store,
+        rank,
+        size,
+        std::chrono::milliseconds(kProcessGroupNCCLOpTimeoutMillis),
+        FLAGS_nccl_comm_pool_size);
+  }
+#endif
+  TORCH_CHECK(false, "Backend ", FLAGS_backend, " is not available");
+}
+
+// The message size of a collective is defined like in nccl-tests: the bytes
+// of the tensor of every process for allreduce and broadcast, and the bytes
+// of the whole (gathered or scattered) tensor for allgather, reduce_scatter
+// and alltoall, of which every process holds a chunk per process.
+Launch makeCollective(
+    const std::string& name,
+    ProcessGroup& pg,
+    const at::TensorOptions& options,
+    int64_t numel) {
+  const int size = pg.getSize();
+  const int64_t chunk = numel / size;
+  if (name == "allreduce") {
+    std::vector<at::Tensor> tensors = {at::ones({numel}, options)};
+    return [&pg, tensors]() mutable {
+      return std::vector<std::shared_ptr<ProcessGroup::Work>>{
+          pg.allreduce(tensors)};
+    };
+  } else if (name == "broadcast") {
+    std::vector<at::Tensor> tensors = {at::ones({numel}, options)};
+    return [&pg, tensors]() mutable {
+      return std::vector<std::shared_ptr<ProcessGroup::Work>>{
+          pg.broadcast(tensors)};
+    };
+  } else if (name == "allgather") {
+    std::vector<at::Tensor> inputs = {at::ones({chunk}, options)};
+    std::vector<std::vector<at::Tensor>> outputs = {
+        at::empty({chunk * size}, options).chunk(size)};
+    return [&pg, inputs, outputs]() mutable {
+      return std::vector<std::shared_ptr<ProcessGroup::Work>>{
+          pg.allgather(outputs, inputs)};
+    };
+  } else if (name == "reduce_scatter") {
+    std::vector<at::Tensor> outputs = {at::empty({chunk}, options)};
+    std::vector<std::vector<at::Tensor>> inputs = {
+        at::ones({chunk * size}, options).chunk(size)};
+    return [&pg, inputs, outputs]() mutable {
+      return std::vector<std::shared_ptr<ProcessGroup::Work>>{
+          pg.reduce_scatter(outputs, inputs)};
+    };
+  } else if (name == "alltoall") {
+    // ProcessGroup has no alltoall, so every process sends a chunk to and
+    // receives a chunk from every other process
+    at::Tensor input = at::ones({chunk * size}, options);
+    at::Tensor output = at::empty({chunk * size}, options);
+    return [&pg, input, output, size]() {
+      std::vector<std::shared_ptr<ProcessGroup::Work>> pending;
+      for (int peer = 0; peer < size; peer++) {
+        at::Tensor send = input.chunk(size)[peer];
+        at::Tensor recv = output.chunk(size)[peer];
+        if (peer == pg.getRank()) {
+          recv.copy_(send);
+          continue;
+        }
+        std::vector<at::Tensor> send_tensors = {send};
+        std::vector<at::Tensor> recv_tensors = {recv};
+        pending.push_back(pg.send(send_tensors, peer, 0));
+        pending.push_back(pg.recv(recv_tensors, peer, 0));
+      }
+      return pending;
+    };
+  }
+  TORCH_CHECK(false, "Unknown collective ", name);
+}
+
+// The factor from the algorithm bandwidth to the bus bandwidth, i.e. the
+// fraction of the message that crosses the slowest link with the optimal
+// algorithm, like in nccl-tests. The bus bandwidth is comparable to the
+// hardware bandwidth, whatever the number of processes.
+double busBandwidthFactor(const std::string& name, int size) {
+  if (name == "allreduce") {
+    return 2.0 * (size - 1) / size;
+  } else if (name == "broadcast") {
+    return 1;
+  }
+  return static_cast<double>(size - 1) / size;
+}
+
+void synchronize(const at::Device& device) {
+  if (device.is_cuda()) {
+    at::detail::getCUDAHooks().deviceSynchronize();
+  }
+}
+
+// Returns the largest time over the processes, as a collective is only as
+// fast as its slowest process
+double maxOverProcesses(ProcessGroup& pg, double seconds, at::Device device) {
+  std::vector<at::Tensor> tensors = {
+      at::full({1}, seconds, at::TensorOptions(device).dtype(at::kDouble))};
+  AllreduceOptions opts;
+  opts.reduceOp = ReduceOp::MAX;
+  pg.allreduce(tensors, opts)->wait();
+  return tensors[0].item<double>();
+}
+
+// Runs fn iters times after warmup runs, and returns the average time of a
+// run in seconds
+double timeRuns(
+    ProcessGroup& pg,
+    at::Device device,
+    const std::function<void()>& fn) {
+  for (int i = 0; i < FLAGS_warmup; i++) {
+    fn();
+  }
+  synchronize(device);
+  pg.barrier()->wait();
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < FLAGS_iters; i++) {
+    fn();
+  }
+  synchronize(device);
+  std::chrono::duration<double> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  return maxOverProcesses(pg, elapsed.count() / FLAGS_iters, device);
+}
+
+// Prints the time and bandwidths of a run moving bytes per process
+void printRow(
+    const std::string& name,
+    const std::string& dtype,
+    const std::string& size,
+    int64_t bytes,
+    double seconds,
+    double busbw_factor) {
+  const double algbw = bytes / seconds / 1e9;
+  std::cout << std::setw(16) << name << std::setw(8) << dtype
+            << std::setw(14) << size << std::fixed << std::setprecision(2)
+            << std::setw(14) << seconds * 1e6 << std::setw(14) << algbw
+            << std::setw(14) << algbw * busbw_factor << std::endl;
+}
+
+void printHeader(const std::string& size_name) {
+  std::cout << std::setw(16) << "op" << std::setw(8) << "dtype"
+            << std::setw(14) << size_name << std::setw(14) << "time(us)"
+            << std::setw(14) << "algbw(GB/s)" << std::setw(14)
+            << "busbw(GB/s)" << std::endl;
+}
+
+void benchmarkCollectives(ProcessGroup& pg, at::Device device) {
+  const bool print = pg.getRank() == 0;
+  const int size = pg.getSize();
+  if (print) {
+    printHeader("bytes");
+  }
+  for (const std::string& dtype_name : split(FLAGS_dtypes)) {
+    at::TensorOptions options =
+        at::TensorOptions(device).dtype(parseDtype(dtype_name));
+    const int64_t element_size = c10::elementSize(parseDtype(dtype_name));
+    for (const std::string& name : split(FLAGS_ops)) {
+      for (int64_t bytes = FLAGS_min_bytes; bytes <= FLAGS_max_bytes;
+           bytes *= FLAGS_step_factor) {
+        // Every process holds the same number of elements of a chunk
+        int64_t numel = std::max<int64_t>(bytes / element_size, size);
+        numel -= numel % size;
+        Launch launch = makeCollective(name, pg, options, numel);
+        auto run = [&launch]() {
+          for (auto& work : launch()) {
+            work->wait();
+          }
+        };
+        try {
+          run();
+        } catch (const std::exception& e) {
+          // e.g. ProcessGroupGloo has no reduce_scatter, and
+          // ProcessGroupNCCL no send and recv
+          if (print) {
+            std::cout << "Skipping " << name << ": " << e.what() << std::endl;
+          }
+          break;
+        }
+        const double seconds = timeRuns(pg, device, run);
+        if (print) {
+          printRow(
+              name,
+              dtype_name,
+              std::to_string(numel * element_size),
+              numel * element_size,
+              seconds,
+              busBandwidthFactor(name, size));
+        }
+      }
+    }
+  }
+}
+
+// Benchmarks the backward pass of a model of synthetic parameters with the
+// buckets of DistributedDataParallel for every bucket cap, to tune it. The
+// backward pass without a Reducer is timed first, as the baseline of the
+// reduction overhead that isn't hidden by the computation.
+void benchmarkReducer(
+    const std::shared_ptr<ProcessGroup>& pg,
+    at::Device device) {
+  const bool print = pg->getRank() == 0;
+  at::TensorOptions options = at::TensorOptions(device).dtype(at::kFloat);
+  std::vector<at::Tensor> params;
+  for (int i = 0; i < FLAGS_reducer_params; i++) {
+    params.push_back(torch::autograd::make_variable(
+        at::zeros({FLAGS_reducer_param_numel}, options),
+        /*requires_grad=*/true));
+  }
+  const int64_t bytes =
+      FLAGS_reducer_params * FLAGS_reducer_param_numel * sizeof(float);
+
+  // The gradients become ready from the last parameter to the first one, like
+  // in the backward pass of a sequential model
+  auto backward = [&params]() {
+    for (at::Tensor& param : params) {
+      if (param.grad().defined()) {
+        param.grad().zero_();
+      }
+    }
+    at::Tensor loss = params[0].sum();
+    for (size_t i = 1; i < params.size(); i++) {
+      loss = loss + params[i].sum();
+    }
+    return loss;
+  };
+
+  if (print) {
+    printHeader("bucket_cap");
+  }
+  const double baseline = timeRuns(*pg, device, [&backward]() {
+    torch::autograd::backward({backward()});
+  });
+  if (print) {
+    std::cout << std::setw(16) << "backward" << std::setw(8) << "float"
+              << std::setw(14) << "-" << std::fixed << std::setprecision(2)
+              << std::setw(14) << baseline * 1e6 << std::endl;
+  }
+
+  for (const std::string& cap_mb : split(FLAGS_bucket_cap_mb)) {
+    const size_t cap = static_cast<size_t>(std::stod(cap_mb) * 1024 * 1024);
+    // Like DistributedDataParallel, with a small first bucket so that the
+    // reduction starts early in the backward pass
+    std::vector<std::vector<size_t>> bucket_indices =
+        compute_bucket_assignment_by_size(
+            params, {std::min<size_t>(1024 * 1024, cap), cap});
+    std::reverse(bucket_indices.begin(), bucket_indices.end());
+    Reducer reducer(
+        {params},
+        bucket_indices,
+        pg,
+        {std::vector<bool>(params.size(), false)},
+        /*bucket_size_limits=*/{},
+        FLAGS_gradient_as_bucket_view);
+    if (FLAGS_comm_hook == "fp16") {
+      reducer.register_comm_hook(std::make_shared<FP16CompressHook>());
+    } else if (FLAGS_comm_hook == "powersgd") {
+      reducer.register_comm_hook(
+          std::make_shared<PowerSGDHook>(FLAGS_powersgd_rank));
+    } else {
+      TORCH_CHECK(
+          FLAGS_comm_hook == "none", "Unknown comm hook ", FLAGS_comm_hook);
+    }
+    const double seconds = timeRuns(*pg, device, [&]() {
+      at::Tensor loss = backward();
+      reducer.prepare_for_backward({loss});
+      // Returns once the buckets are reduced
+      torch::autograd::backward({loss});
+    });
+    if (print) {
+      printRow(
+          "reducer",
+          "float",
+          cap_mb + "MB",
+          bytes,
+          seconds,
+          busBandwidthFactor("allreduce", pg->getSize()));
+      std::cout << std::setw(16) << "" << bucket_indices.size()
+                << " buckets, " << (seconds - baseline) * 1e6
+                << "us of reduction not hidden by the backward pass"
+                << std::endl;
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Benchmark the collectives of c10d process groups and the DDP Reducer.\n"
+      "Start a process per rank, e.g. with 2 processes:\n"
+      "RANK=0 SIZE=2 ./c10d_bench --backend=gloo --max_bytes=1048576 &\n"
+      "RANK=1 SIZE=2 ./c10d_bench --backend=gloo --max_bytes=1048576\n"
+      "or to tune the bucket cap of DDP:\n"
+      "RANK=0 SIZE=2 ./c10d_bench --reducer --bucket_cap_mb=1,25 &\n"
+      "RANK=1 SIZE=2 ./c10d_bench --reducer --bucket_cap_mb=1,25");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cerr << "Failed to parse command line flags!" << std::endl;
+    return 1;
+  }
+
+  std::shared_ptr<ProcessGroup> pg = createProcessGroup();
+  at::Device device(FLAGS_device);
+  if (device.is_cuda() && !device.has_index()) {
+    device = at::Device(
+        at::kCUDA,
+        pg->getRank() % at::detail::getCUDAHooks().getNumGPUs());
+  }
+  c10::DeviceGuard guard(device);
+
+  if (FLAGS_reducer) {
+    benchmarkReducer(pg, device);
+  } else {
+    benchmarkCollectives(*pg, device);
+  }
+  return 0;
+}
@@ -10,7 +10,10 @@
 #include <c10d/TCPStore.hpp>
 
 // Different ports for different tests.
-void testHelper(const std::string& prefix = "") {
+void testHelper(
+    const std::string& prefix = "",
+    int numShards = 1,
+    int numServerThreads = 1) {
   const auto numThreads = 16;
   const auto numWorkers = numThreads + 1;
 
@@ -20,7 +23,9 @@ void testHelper(const std::string& prefix = "") {
       numWorkers,
       true,
       std::chrono::seconds(30),
-      /* wait */ false);
+      /* wait */ false,
+      numShards,
+      numServerThreads);
 
   auto serverStore =
       std::make_unique<c10d::PrefixStore>(prefix, serverTCPStore);
@@ -48,7 +53,14 @@ void testHelper(const std::string& prefix = "") {
   std::vector<std::unique_ptr<c10d::PrefixStore>> clientStores;
   for (auto i = 0; i < numThreads; i++) {
     clientTCPStores.push_back(std::make_unique<c10d::TCPStore>(
-        "127.0.0.1", serverTCPStore->getPort(), numWorkers, false));
+        "127.0.0.1",
+        serverTCPStore->getPort(),
+        numWorkers,
+        false,
+        std::chrono::seconds(30),
+        /* wait */ true,
+        numShards,
+        numServerThreads));
     clientStores.push_back(std::unique_ptr<c10d::PrefixStore>(
         new c10d::PrefixStore(prefix, clientTCPStores[i])));
   }
@@ -68,6 +80,16 @@ void testHelper(const std::string& prefix = "") {
             c10d::test::set(*clientStores[i], key, val);
             c10d::test::check(*clientStores[i], key, val);
           }
+          // And a batch of keys in one go
+          std::vector<std::string> keys;
+          std::vector<std::vector<uint8_t>> values;
+          for (auto j = 0; j < 10; j++) {
+            keys.push_back(key + "_batch_" + std::to_string(j));
+            std::string val = "batch_val_" + std::to_string(j);
+            values.emplace_back(val.begin(), val.end());
+          }
+          clientStores[i]->multiSet(keys, values);
+          EXPECT_EQ(values, clientStores[i]->multiGet(keys));
 
           sem1.post();
           sem2.wait();
@@ -116,3 +138,11 @@ TEST(TCPStoreTest, testHelper) {
 TEST(TCPStoreTest, testHelperPrefix) {
   testHelper("testPrefix");
 }
+
+TEST(TCPStoreTest, testHelperSharded) {
+  testHelper("", /* numShards */ 4, /* numServerThreads */ 4);
+}
+
+TEST(TCPStoreTest, testHelperShardedPrefix) {
+  testHelper("testPrefix", /* numShards */ 3, /* numServerThreads */ 2);
+}
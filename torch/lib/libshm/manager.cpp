@@ -106,6 +106,7 @@ int main(int argc, char *argv[]) {
   int timeout = -1;
   std::vector<int> to_add;
   std::vector<int> to_remove;
+  std::set<std::string> to_free;
   for (;;) {
     int nevents;
     if (client_sessions.size() == 0)
@@ -132,23 +133,30 @@ int main(int argc, char *argv[]) {
           to_add.push_back(fd);
           client_sessions.emplace(fd, std::move(client));
         } else {
-          // someone wants to register a segment
-          DEBUG("got alloc info");
+          // someone wants to register or free segments
           auto &session = client_sessions.at(pfd.fd);
-          AllocInfo info = session.socket.receive();
-          session.pid = info.pid;
-          DEBUG("got alloc info: %d %d %s", (int)info.free, info.pid, info.filename);
-          if (info.free) {
-            free_used_object(info.filename);
-          } else {
-            used_objects.insert(info.filename);
-            DEBUG("registered object %s", info.filename);
-            session.socket.confirm();
-          }
+          do {
+            AllocInfo info = session.socket.receive();
+            session.pid = info.pid;
+            DEBUG("got alloc info: %d %d %s", (int)info.free, info.pid, info.filename);
+            if (info.free) {
+              to_free.insert(info.filename);
+            } else {
+              used_objects.insert(info.filename);
+              DEBUG("registered object %s", info.filename);
+              session.socket.confirm();
+            }
+          } while (session.socket.has_pending_data());
         }
       }
     }
 
+    // Every process that maps a segment reports it when it unmaps it, so the
+    // same name usually arrives several times. Check each one only once.
+    for (auto &name: to_free)
+      free_used_object(name);
+    to_free.clear();
+
     for (int fd: to_add)
       register_fd(fd);
     to_add.clear();
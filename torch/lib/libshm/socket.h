@@ -70,7 +70,7 @@ protected:
     size_t bytes_sent = 0;
     ssize_t step_sent;
     while (bytes_sent < num_bytes) {
-      SYSCHECK_ERR_RETURN_NEG1(step_sent = ::write(socket_fd, buffer, num_bytes));
+      SYSCHECK_ERR_RETURN_NEG1(step_sent = ::write(socket_fd, buffer, num_bytes - bytes_sent));
       bytes_sent += step_sent;
       buffer += step_sent;
     }
@@ -93,6 +93,16 @@ public:
     send("OK", 2);
   }
 
+  // Returns true if more data can be read right away, so that the manager
+  // can handle every message a client has queued in a single wakeup.
+  bool has_pending_data() {
+    struct pollfd pfd = {0};
+    pfd.fd = socket_fd;
+    pfd.events = POLLIN;
+    SYSCHECK_ERR_RETURN_NEG1(poll(&pfd, 1, 0));
+    return (pfd.revents & POLLIN) && !(pfd.revents & (POLLERR | POLLHUP));
+  }
+
 };
 
 
@@ -280,7 +280,7 @@ def storage_from_cache(cls, key):
     return cls._new_with_weak_ptr(storage_ref.cdata)
 
 
-def rebuild_storage_fd(cls, df, size):
+def rebuild_storage_fd(cls, df, size, pooled=False):
     if sys.version_info[0] == 2:
         while True:
             try:
@@ -294,10 +294,13 @@ def rebuild_storage_fd(cls, df, size):
         fd = df.detach()
     try:
         storage = storage_from_cache(cls, fd_id(fd))
-        if storage is not None:
-            return storage
-        storage = cls._new_shared_fd(fd, size)
-        shared_cache[fd_id(fd)] = StorageWeakRef(storage)
+        if storage is None:
+            storage = cls._new_shared_fd(fd, size, pooled)
+            shared_cache[fd_id(fd)] = StorageWeakRef(storage)
+        if pooled:
+            # Give up the reference the sender took for us, see
+            # Note [Pooled shared memory]
+            storage._shared_decref()
         return storage
     finally:
         os.close(fd)
@@ -330,14 +333,16 @@ def reduce_storage(storage):
         # (with size 0) cannot be mmapped.
         return (rebuild_storage_empty, (type(storage),))
     else:
-        fd, size = storage._share_fd_()
+        fd, size, pooled = storage._share_fd_()
         if sys.version_info[0] == 2:
             df = multiprocessing.reduction.reduce_handle(fd)
         else:
             df = multiprocessing.reduction.DupFd(fd)
         cache_key = fd_id(fd)
-        metadata = (df, size)
+        metadata = (df, size, pooled)
         rebuild = rebuild_storage_fd
+        if pooled:
+            storage._shared_incref()
 
     shared_cache[cache_key] = StorageWeakRef(storage)
     return (rebuild, (type(storage),) + metadata)
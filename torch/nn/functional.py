@@ -2035,6 +2035,9 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
     """
     if size_average is not None or reduce is not None:
         reduction = _Reduction.legacy_get_string(size_average, reduce)
+    if input.dim() == 2 and target.dim() == 1 and input.size(0) == target.size(0):
+        # fused kernel that never materializes the log probabilities
+        return torch._C._nn.cross_entropy_loss(input, target, weight, _Reduction.get_enum(reduction), ignore_index)
     return nll_loss(log_softmax(input, 1), target, weight, None, ignore_index, None, reduction)
 
 
@@ -3421,15 +3424,14 @@ def multi_head_attention_forward(query,                           # type: Tensor
         attn_output_weights += attn_mask
 
     if key_padding_mask is not None:
+        # masks the padded keys inside the softmax instead of materializing a masked copy
         attn_output_weights = attn_output_weights.view(bsz, num_heads, tgt_len, src_len)
-        attn_output_weights = attn_output_weights.masked_fill(
-            key_padding_mask.unsqueeze(1).unsqueeze(2),
-            float('-inf'),
-        )
+        attn_output_weights = torch._masked_softmax(
+            attn_output_weights, key_padding_mask.unsqueeze(1).unsqueeze(2).to(torch.bool))
         attn_output_weights = attn_output_weights.view(bsz * num_heads, tgt_len, src_len)
-
-    attn_output_weights = softmax(
-        attn_output_weights, dim=-1)
+    else:
+        attn_output_weights = softmax(
+            attn_output_weights, dim=-1)
     attn_output_weights = dropout(attn_output_weights, p=dropout_p, training=training)
 
     attn_output = torch.bmm(attn_output_weights, v)
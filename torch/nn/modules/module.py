@@ -1112,7 +1112,12 @@ class Module(object):
         r"""Sets gradients of all model parameters to zero."""
         for p in self.parameters():
             if p.grad is not None:
-                p.grad.detach_()
+                # Gradients may be views, e.g. into the buckets of
+                # DistributedDataParallel, which can't be detached in place.
+                if p.grad.grad_fn is not None:
+                    p.grad.detach_()
+                else:
+                    p.grad.requires_grad_(False)
                 p.grad.zero_()
 
     def share_memory(self):
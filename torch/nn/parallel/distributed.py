@@ -217,6 +217,23 @@ class DistributedDataParallel(Module):
                          are getting different gradients, which should not
                          happen if DistributedDataParallel is correctly used.
                          (default: ``False``)
+        gradient_as_bucket_view (bool): when set to ``True``, the ``.grad`` of
+                         every parameter is a view into the buffer that its
+                         gradient is all-reduced in. Gradients are then
+                         accumulated right into these buffers, which saves
+                         the memory of a second copy of the gradients and the
+                         time to copy them in and out. Gradients of parameters
+                         that are unused on all processes are averaged like
+                         the others instead of being left untouched.
+                         (default: ``False``)
+        find_unused_parameters_by_hooks (bool): with :attr:`find_unused_parameters`,
+                         find the unused parameters by checking which ones
+                         did not receive a gradient by the end of the backward
+                         pass, instead of traversing the autograd graph after
+                         every ``forward``. This removes the cost of the
+                         traversal, but the buckets holding unused parameters
+                         are only all-reduced once the backward pass is over.
+                         (default: ``False``)
 
     Attributes:
         module (Module): the module to be parallelized
@@ -230,7 +247,9 @@ class DistributedDataParallel(Module):
                  output_device=None, dim=0, broadcast_buffers=True,
                  process_group=None, bucket_cap_mb=25,
                  find_unused_parameters=False,
-                 check_reduction=False):
+                 check_reduction=False,
+                 gradient_as_bucket_view=False,
+                 find_unused_parameters_by_hooks=False):
 
         super(DistributedDataParallel, self).__init__()
 
@@ -278,6 +297,8 @@ class DistributedDataParallel(Module):
         self.module = module
         self.broadcast_buffers = broadcast_buffers
         self.find_unused_parameters = find_unused_parameters
+        self.gradient_as_bucket_view = gradient_as_bucket_view
+        self.find_unused_parameters_by_hooks = find_unused_parameters_by_hooks
         self.require_backward_grad_sync = True
         self.require_forward_param_sync = True
 
@@ -333,6 +354,17 @@ class DistributedDataParallel(Module):
         self.modules_params = [list(m.parameters()) for m in self._module_copies]
         self.modules_buffers = [list(m.buffers()) for m in self._module_copies]
 
+        # The buffers are broadcast before every forward pass. Point them at
+        # flat tensors that are allocated once, so that this doesn't flatten
+        # and unflatten them every time.
+        self._buffer_broadcast = None
+        if self.broadcast_buffers and len(self.modules_buffers[0]) > 0:
+            with torch.no_grad():
+                self._buffer_broadcast = dist._PersistentBroadcast(
+                    self.process_group,
+                    self.modules_buffers[0],
+                    self.broadcast_bucket_size)
+
         # Build tuple of (module, parameter) for all parameters that require grads.
         modules_and_parameters = [
             [
@@ -367,19 +399,25 @@ class DistributedDataParallel(Module):
         # that are defined first, such that their gradients don't spill into
         # a much larger bucket, adding unnecessary latency after gradient
         # computation finishes. Experiments showed 1MB is a reasonable value.
+        bucket_size_limits = [1024 * 1024, self.bucket_bytes_cap]
         bucket_indices = dist._compute_bucket_assignment_by_size(
             parameters[0],
-            [1024 * 1024, self.bucket_bytes_cap],
+            bucket_size_limits,
             expect_sparse_gradient[0])
 
         # Note: reverse list of buckets because we want to approximate the
         # order in which their gradients are produced, and assume they
         # are used in the forward pass in the order they are defined.
+        # The reducer records the actual order during the first iteration and
+        # rebuilds the buckets with the same size limits after it.
         self.reducer = dist.Reducer(
             parameters,
             list(reversed(bucket_indices)),
             self.process_group,
-            expect_sparse_gradient)
+            expect_sparse_gradient,
+            bucket_size_limits,
+            self.gradient_as_bucket_view,
+            self.find_unused_parameters_by_hooks)
 
         # passing a handle to torch.nn.SyncBatchNorm layer
         self._passing_sync_batchnorm_handle(self._module_copies)
@@ -389,6 +427,7 @@ class DistributedDataParallel(Module):
         attrs = copy.copy(self.__dict__)
         del attrs['process_group']
         del attrs['reducer']
+        del attrs['_buffer_broadcast']
         return attrs
 
     def __setstate__(self, state):
@@ -397,6 +436,8 @@ class DistributedDataParallel(Module):
         super(DistributedDataParallel, self).__setstate__(state)
         self.__dict__.setdefault('require_forward_param_sync', True)
         self.__dict__.setdefault('require_backward_grad_sync', True)
+        self.__dict__.setdefault('gradient_as_bucket_view', False)
+        self.__dict__.setdefault('find_unused_parameters_by_hooks', False)
         self._ddp_init_helper()
 
     def _check_default_group(self):
@@ -437,6 +478,26 @@ class DistributedDataParallel(Module):
         finally:
             self.require_backward_grad_sync = old_require_backward_grad_sync
 
+    def register_comm_hook(self, hook):
+        r"""
+        Registers a communication hook that reduces the gradient buckets
+        instead of the default allreduce, e.g. to compress the gradients sent
+        over slow links. The builtin hooks are
+        :class:`torch.distributed.FP16CompressHook`,
+        :class:`torch.distributed.PowerSGDHook` (low-rank compression) and
+        :class:`torch.distributed.TopKSparsifyHook` (top-k sparsification); the
+        last two feed the compression error back into the next iteration.
+        Buckets of sparse gradients are always allreduced.
+
+        The hook can only be registered once, before training.
+
+        Example::
+
+            >>> ddp = torch.nn.DistributedDataParallel(model, pg)
+            >>> ddp.register_comm_hook(torch.distributed.PowerSGDHook(rank=4))
+        """
+        self.reducer.register_comm_hook(hook)
+
     def forward(self, *inputs, **kwargs):
         if self.require_forward_param_sync:
             self._sync_params()
@@ -510,9 +571,7 @@ class DistributedDataParallel(Module):
             if self.broadcast_buffers and len(self.modules_buffers[0]) > 0:
                 # Synchronize buffers across processes.
                 # The process with rank 0 is considered the authoritative copy.
-                self._distributed_broadcast_coalesced(
-                    self.modules_buffers[0],
-                    self.broadcast_bucket_size)
+                self._buffer_broadcast.broadcast()
                 # only do intra-node buffer sync for replicated single-device
                 # CUDA modules
                 if self.device_ids and len(self.device_ids) > 1:
@@ -58,6 +58,8 @@ class Adam(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            if _fused_adam_step(self, group, decoupled_weight_decay=False):
+                continue
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -107,3 +109,38 @@ class Adam(Optimizer):
                 p.data.addcdiv_(-step_size, exp_avg, denom)
 
         return loss
+
+
+def _fused_adam_step(optimizer, group, decoupled_weight_decay):
+    """Steps all the parameters of ``group`` with the fused Adam kernels.
+
+    Returns ``False``, without changing anything, when the group has to be
+    stepped tensor by tensor: for AMSGrad and for parameters that are not on
+    a GPU or have sparse gradients.
+    """
+    params = [p for p in group['params'] if p.grad is not None]
+    if group['amsgrad'] or not params or \
+            not all(p.is_cuda and not p.grad.is_sparse for p in params):
+        return False
+
+    # Parameters that joined the group later may be at a different step
+    buckets = {}
+    for p in params:
+        state = optimizer.state[p]
+        if len(state) == 0:
+            state['step'] = 0
+            state['exp_avg'] = torch.zeros_like(p.data, memory_format=torch.preserve_format)
+            state['exp_avg_sq'] = torch.zeros_like(p.data, memory_format=torch.preserve_format)
+        state['step'] += 1
+        buckets.setdefault((p.device, p.dtype, state['step']), []).append(p)
+
+    beta1, beta2 = group['betas']
+    for (_, _, step), bucket in buckets.items():
+        states = [optimizer.state[p] for p in bucket]
+        torch._fused_adam([p.data for p in bucket],
+                          [p.grad.data for p in bucket],
+                          [state['exp_avg'] for state in states],
+                          [state['exp_avg_sq'] for state in states],
+                          group['lr'], beta1, beta2, group['eps'],
+                          group['weight_decay'], step, decoupled_weight_decay)
+    return True
@@ -1,6 +1,7 @@
 import math
 import torch
 from .optimizer import Optimizer
+from .adam import _fused_adam_step
 
 
 class AdamW(Optimizer):
@@ -61,6 +62,8 @@ class AdamW(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            if _fused_adam_step(self, group, decoupled_weight_decay=True):
+                continue
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -89,6 +89,11 @@ class SGD(Optimizer):
             dampening = group['dampening']
             nesterov = group['nesterov']
 
+            params = [p for p in group['params'] if p.grad is not None]
+            if params and all(p.is_cuda and not p.grad.is_sparse for p in params):
+                self._fused_step(group, params)
+                continue
+
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -110,3 +115,24 @@ class SGD(Optimizer):
                 p.data.add_(-group['lr'], d_p)
 
         return loss
+
+    def _fused_step(self, group, params):
+        # Parameters without a momentum buffer yet take their first step
+        # separately, since their buffer is set to the gradient
+        buckets = {}
+        for p in params:
+            first_step = False
+            if group['momentum'] != 0:
+                param_state = self.state[p]
+                if 'momentum_buffer' not in param_state:
+                    param_state['momentum_buffer'] = torch.empty_like(p.data, memory_format=torch.preserve_format)
+                    first_step = True
+            buckets.setdefault((p.device, p.dtype, first_step), []).append(p)
+
+        for (_, _, first_step), bucket in buckets.items():
+            buffers = [self.state[p]['momentum_buffer'] for p in bucket] if group['momentum'] != 0 else []
+            torch._fused_sgd([p.data for p in bucket],
+                             [p.grad.data for p in bucket],
+                             buffers, group['lr'], group['momentum'],
+                             group['dampening'], group['weight_decay'],
+                             group['nesterov'], first_step)
@@ -7,6 +7,7 @@ import sys
 import torch
 import tarfile
 import tempfile
+import threading
 import warnings
 import copyreg
 from contextlib import closing, contextmanager
@@ -449,6 +450,12 @@ def _legacy_save(obj, f, pickle_module, pickle_protocol):
 
 
 def _save(obj, zip_file, pickle_module, pickle_protocol):
+    data_value, serialized_storages = _pickle_with_storages(obj, pickle_module, pickle_protocol)
+    _write_zipfile_records(zip_file, data_value, serialized_storages)
+
+
+def _pickle_with_storages(obj, pickle_module, pickle_protocol):
+    # Returns the pickle data of `obj` and the storages it refers to, by key
     serialized_storages = {}
 
     def persistent_id(obj):
@@ -470,12 +477,15 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
                     obj.size())
         return None
 
-    # Write the pickle data for `obj`
     data_buf = io.BytesIO()
     pickler = pickle_module.Pickler(data_buf, protocol=pickle_protocol)
     pickler.persistent_id = persistent_id
     pickler.dump(obj)
-    data_value = data_buf.getvalue()
+    return data_buf.getvalue(), serialized_storages
+
+
+def _write_zipfile_records(zip_file, data_value, serialized_storages):
+    # Write the pickle data for `obj`
     zip_file.write_record('data.pkl', data_value, len(data_value))
 
     # Write each tensor to a file named tensor/the_tensor_key in the zip archive
@@ -485,7 +495,6 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
         if storage.device.type == 'cpu':
             # If it's on the CPU we can directly copy it into the zip file
             num_bytes = storage.size() * storage.element_size()
-            buf = io.BytesIO()
             zip_file.write_record(name, storage.data_ptr(), num_bytes)
         else:
             # Copy to a buffer, then serialize that
@@ -495,6 +504,97 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
             zip_file.write_record(name, buf_value, len(buf_value))
 
 
+def _snapshot_storage(storage):
+    # Returns a CPU copy of `storage`. Copies from CUDA are made into pinned
+    # memory on the current stream of the device of `storage` and may still be
+    # running: later work on that stream can't modify the data before it is
+    # copied, and the caller has to synchronize before reading the copy.
+    if storage.device.type == 'cpu':
+        return storage.clone()
+    with torch.cuda.device(storage.device):
+        src = storage_to_tensor_type(storage)().set_(storage)
+        dst = torch.empty(src.size(), dtype=src.dtype, pin_memory=True)
+        dst.copy_(src, non_blocking=True)
+        return dst.storage()
+
+
+class _SaveFuture(object):
+    r"""Completion handle of :func:`torch.save_async`."""
+
+    def __init__(self, target):
+        self._error = None
+        self._thread = threading.Thread(target=self._run, args=(target,))
+        self._thread.start()
+
+    def _run(self, target):
+        try:
+            target()
+        except BaseException as e:
+            self._error = e
+
+    def done(self):
+        r"""Returns whether the file has been written, or writing it failed."""
+        return not self._thread.is_alive()
+
+    def wait(self):
+        r"""Blocks until the file is written, and raises the error that
+        prevented writing it if any."""
+        self._thread.join()
+        if self._error is not None:
+            raise self._error
+
+
+def save_async(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL):
+    r"""Saves an object to a disk file like :func:`torch.save`, writing the file
+    from a background thread.
+
+    The data of the tensors in ``obj`` is copied when this function is called,
+    so that the file holds their values at that time even if they are modified
+    before it is written, e.g. by the next steps of a training loop. Copies of
+    CUDA tensors are made into pinned memory asynchronously, on the current
+    stream of their device, so the call does not wait for the device. The rest
+    of ``obj`` is pickled before returning as well.
+
+    The file is written in the format of ``torch.save`` with
+    ``_use_new_zipfile_serialization=True``, which :func:`torch.load` reads.
+
+    Args:
+        obj: saved object
+        f: a file-like object (has to implement write and flush) or a string
+           containing a file name. A file-like object must not be used until
+           the file is written.
+        pickle_module: module used for pickling metadata and objects
+        pickle_protocol: can be specified to override the default protocol
+
+    Returns:
+        A handle whose ``wait()`` method blocks until the file is written and
+        raises the error that prevented writing it if any, and whose ``done()``
+        method tells whether writing the file completed.
+
+    Example:
+        >>> future = torch.save_async(model.state_dict(), 'checkpoint.pt')
+        >>> # ... keep training ...
+        >>> future.wait()
+    """
+    _check_dill_version(pickle_module)
+    data_value, serialized_storages = _pickle_with_storages(obj, pickle_module, pickle_protocol)
+    snapshots = {key: _snapshot_storage(storage) for key, storage in serialized_storages.items()}
+    events = []
+    for device in set(storage.device for storage in serialized_storages.values()):
+        if device.type == 'cuda':
+            event = torch.cuda.Event()
+            event.record(torch.cuda.current_stream(device))
+            events.append(event)
+
+    def write():
+        for event in events:
+            event.synchronize()
+        with _open_zipfile_writer(f) as opened_file:
+            _write_zipfile_records(opened_file, data_value, snapshots)
+
+    return _SaveFuture(write)
+
+
 def load(f, map_location=None, pickle_module=pickle, **pickle_load_args):
     """Loads an object saved with :func:`torch.save` from a file.
 
@@ -1687,6 +1687,64 @@ class DistAutogradTest(RpcAgentTestFixture):
 
         dist.barrier()
 
+    @dist_init
+    def test_concurrent_backward_passes(self):
+        # Backward passes of several contexts, like the microbatches of a
+        # pipeline, run at the same time and accumulate their own gradients.
+        dst = "worker{}".format(self._next_rank())
+        t1 = torch.rand((3, 3), requires_grad=True)
+        t2 = torch.rand((3, 3), requires_grad=True)
+        expected = torch.autograd.grad(torch.matmul(t1, t2).sum(), [t1, t2])
+        errors = []
+
+        def run_microbatch(num_iterations):
+            try:
+                for _ in range(num_iterations):
+                    with dist_autograd.context() as context_id:
+                        t3 = rpc.rpc_sync(dst, torch.matmul, args=(t1, t2))
+                        dist_autograd.backward([t3.sum()])
+                        grads = dist_autograd.get_gradients(context_id)
+                        self.assertEqual(expected[0], grads[t1])
+                        self.assertEqual(expected[1], grads[t2])
+            except Exception as e:
+                errors.append(e)
+
+        threads = [
+            threading.Thread(target=run_microbatch, args=(5,)) for _ in range(8)
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual([], errors)
+
+    @dist_init
+    def test_grad_bucket(self):
+        t1 = torch.rand((3, 3), requires_grad=True)
+        t2 = torch.rand((2,), requires_grad=True)
+        t3 = torch.rand((3, 3), requires_grad=True)
+        buckets = []
+        with dist_autograd.context() as context_id:
+            dist_autograd.add_grad_bucket(
+                context_id, [t1, t2], lambda bucket: buckets.append(bucket.clone())
+            )
+            loss = rpc.rpc_sync(
+                "worker{}".format(self._next_rank()), torch.matmul, args=(t1, t3)
+            ).sum() + t2.sum()
+            dist_autograd.backward([loss])
+
+            # The callback ran once, with the flattened gradients of the bucket.
+            grads = dist_autograd.get_gradients(context_id)
+            self.assertEqual(1, len(buckets))
+            self.assertEqual(
+                torch.cat([grads[t1].view(-1), grads[t2].view(-1)]), buckets[0]
+            )
+            self.assertIn(t3, grads)
+
+            # A tensor can be in a single bucket only.
+            with self.assertRaisesRegex(RuntimeError, "already has a gradient"):
+                dist_autograd.add_grad_bucket(context_id, [t1], lambda bucket: None)
+
     @dist_init
     def test_backward_accumulate_grads(self):
         t1 = torch.rand((3, 3), requires_grad=True)
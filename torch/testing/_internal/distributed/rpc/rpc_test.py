@@ -185,6 +185,23 @@ def nested_rpc(dst):
     return rpc.rpc_sync(dst, torch.add, args=(torch.ones(2, 2), 1))
 
 
+def nested_rpc_future(dst):
+    # the response is sent when the returned future completes, without
+    # blocking a thread of the callee until then.
+    return rpc.rpc_async(dst, torch.add, args=(torch.ones(2, 2), 1))
+
+
+def chained_rpc_future(dst, world_size, ttl, value):
+    if ttl > 0:
+        next_dst = (dst + 1) % world_size
+        return rpc.rpc_async(
+            "worker{}".format(dst),
+            chained_rpc_future,
+            args=(next_dst, world_size, ttl - 1, value + 1),
+        )
+    return value
+
+
 def multi_layer_nested_async_rpc(dst, world_size, ttl):
     # this method returns immediately without blocking the callee, but will
     # generate additional requests.
@@ -902,6 +919,30 @@ class RpcTest(RpcAgentTestFixture):
         )
         self.assertEqual(ret, torch.ones(2, 2) + 1)
 
+    @dist_init
+    def test_nested_rpc_future(self):
+        n = self.rank + 1
+        dst_rank = n % self.world_size
+        ret = rpc.rpc_sync(
+            "worker{}".format(dst_rank),
+            nested_rpc_future,
+            args=("worker{}".format(self.rank),),
+        )
+        self.assertEqual(ret, torch.ones(2, 2) + 1)
+
+    @dist_init
+    def test_chained_rpc_future(self):
+        # more hops than threads in the pools, none of them is blocked
+        ttl = 20
+        n = self.rank + 1
+        dst_rank = n % self.world_size
+        ret = rpc.rpc_sync(
+            "worker{}".format(dst_rank),
+            chained_rpc_future,
+            args=((dst_rank + 1) % self.world_size, self.world_size, ttl, 0),
+        )
+        self.assertEqual(ret, ttl)
+
     def _stress_test_rpc(self, f, repeat=1000, args=()):
         n = self.rank + 1
         dst_rank = n % self.world_size
@@ -1408,6 +1449,29 @@ class RpcTest(RpcAgentTestFixture):
         # barrier after check 3
         dist.barrier()
 
+    @dist_init
+    def test_rref_batched_user_deletes(self):
+        # The deletes of RRefs owned by the same worker are sent in batches,
+        # and the owner still drops every OwnerRRef.
+        initialize_pg(self.init_method, self.rank, self.world_size)
+        dst_rank = (self.rank + 1) % self.world_size
+        rrefs = [
+            rpc.remote(
+                "worker{}".format(dst_rank), torch.add, args=(torch.ones(2, 2), i)
+            )
+            for i in range(100)
+        ]
+        for i, rref in enumerate(rrefs):
+            self.assertEqual(rref.to_here(), torch.ones(2, 2) + i)
+        wait_until_pending_users_flushed()
+        del rref, rrefs
+
+        # barrier before checking the OwnerRRefs of this worker
+        dist.barrier()
+        while int(_rref_context_get_debug_info()["num_owner_rrefs"]) != 0:
+            time.sleep(0.1)
+        dist.barrier()
+
     @dist_init
     def test_disable_gil_profiling(self):
         # test that rpc.enable_gil_profilig(false) will result in
@@ -1498,6 +1562,45 @@ class RpcTest(RpcAgentTestFixture):
         # add a barrier to make sure SHUTDOWN message is not sent
         dist.barrier()
 
+    @dist_init
+    @requires_process_group_agent("PROCESS_GROUP rpc backend specific test, skip")
+    def test_process_group_latency_profiling(self):
+        dst_rank = (self.rank + 1) % self.world_size
+        rpc.rpc_sync(
+            "worker{}".format(dst_rank), torch.add, args=(torch.ones(1), torch.ones(1))
+        )
+        # latency profiling should be disabled by default.
+        metrics = rpc.api._get_current_rpc_agent().get_metrics()
+        self.assertFalse(any(key.startswith("agent.latency_us.") for key in metrics))
+
+        initialize_pg(self.init_method, self.rank, self.world_size)
+        rpc.enable_latency_profiling(True)
+        # make sure the callee profiles the request too, so that the time
+        # spent on the network is known.
+        dist.barrier()
+        rpc.rpc_sync(
+            "worker{}".format(dst_rank), torch.add, args=(torch.ones(1), torch.ones(1))
+        )
+        metrics = rpc.api._get_current_rpc_agent().get_metrics()
+        # builtin operators are called with SCRIPT_CALL messages.
+        script_call = 0
+        for stage in ["serialize", "enqueue", "send", "network", "response"]:
+            self.assertIn("agent.latency_us.{}.type_{}".format(stage, script_call), metrics)
+            self.assertIn("agent.latency_us.{}.peer_{}".format(stage, dst_rank), metrics)
+        summary = dict(
+            item.split("=")
+            for item in metrics["agent.latency_us.response.type_{}".format(script_call)].split(",")
+        )
+        self.assertEqual(
+            set(summary.keys()), {"count", "mean", "p50", "p90", "p99", "max"}
+        )
+        self.assertEqual(int(summary["count"]), 1)
+        self.assertLessEqual(int(summary["p50"]), int(summary["max"]))
+
+        # make sure the requests of the other workers are answered before
+        # shutting down.
+        dist.barrier()
+
     @dist_init(setup_rpc=False)
     @requires_process_group_agent("PROCESS_GROUP rpc backend specific test, skip")
     def test_local_shutdown(self):
@@ -0,0 +1,96 @@
+from __future__ import absolute_import, division, print_function, unicode_literals
+
+import unittest
+
+import torch
+import torch.distributed.autograd as dist_autograd
+import torch.distributed.rpc as rpc
+from torch import optim
+from torch.testing._internal.dist_utils import dist_init
+from torch.testing._internal.distributed.rpc.rpc_agent_test_fixture import (
+    RpcAgentTestFixture,
+)
+
+
+@unittest.skipIf(
+    not torch._six.PY3, "Pytorch distributed nn does not support python2"
+)
+class ShardedEmbeddingTest(RpcAgentTestFixture):
+    def _other_workers(self):
+        return [
+            "worker%d" % ((self.rank + i) % self.world_size)
+            for i in range(1, self.world_size)
+        ]
+
+    @dist_init()
+    def test_sharded_embedding_forward(self):
+        from torch.distributed.nn import ShardedEmbedding
+
+        weight = torch.rand(10, 3)
+        local = torch.nn.Embedding(10, 3, _weight=weight.clone())
+        sharded = ShardedEmbedding(10, 3, self._other_workers(), _weight=weight)
+
+        indices = torch.tensor([[1, 2, 4, 5], [4, 3, 2, 9]])
+        self.assertEqual(local(indices), sharded(indices))
+        self.assertEqual(
+            local(torch.tensor([7])), sharded(torch.tensor([7]))
+        )
+
+    @dist_init()
+    def test_sharded_embedding_dist_optim(self):
+        from torch.distributed.nn import ShardedEmbedding
+        from torch.distributed.optim import DistributedOptimizer
+
+        weight = torch.rand(10, 3)
+        indices = torch.tensor([[1, 2, 4, 5], [4, 3, 2, 9]])
+
+        local = torch.nn.Embedding(10, 3, _weight=weight.clone())
+        local_optim = optim.SGD(local.parameters(), lr=0.05)
+        local(indices).sum().backward()
+        local_optim.step()
+
+        sharded = ShardedEmbedding(10, 3, self._other_workers(), _weight=weight)
+        dist_optim = DistributedOptimizer(
+            optim.SGD, sharded.parameter_rrefs(), lr=0.05
+        )
+        with dist_autograd.context():
+            loss = sharded(indices).sum()
+            dist_autograd.backward([loss])
+            dist_optim.step()
+
+        with torch.no_grad():
+            self.assertEqual(
+                local(torch.arange(10)), sharded(torch.arange(10))
+            )
+
+    @dist_init()
+    def test_sharded_embedding_cache(self):
+        from torch.distributed.nn import ShardedEmbedding
+        from torch.distributed.optim import DistributedOptimizer
+
+        weight = torch.rand(10, 3)
+        indices = torch.tensor([1, 2, 4])
+        sharded = ShardedEmbedding(
+            10, 3, self._other_workers(), cache_size=4, max_staleness=3600,
+            _weight=weight
+        )
+        dist_optim = DistributedOptimizer(
+            optim.SGD, sharded.parameter_rrefs(), lr=0.05
+        )
+
+        with torch.no_grad():
+            old_rows = sharded(indices)
+        self.assertEqual(weight[indices], old_rows)
+
+        # Update the rows behind the cache's back with a lookup that does not
+        # go through the cache.
+        sharded.cache_size = 0
+        with dist_autograd.context():
+            dist_autograd.backward([sharded(indices).sum()])
+            dist_optim.step()
+        sharded.cache_size = 4
+
+        with torch.no_grad():
+            self.assertEqual(old_rows, sharded(indices))
+            sharded.invalidate_cache()
+            self.assertEqual(old_rows - 0.05, sharded(indices))
@@ -595,6 +595,16 @@ def enable_cpu_fuser(fn):
     return wrapper
 
 
+def enable_cpu_fuser_compiler(fn):
+    def wrapper(*args, **kwargs):
+        torch._C._jit_override_fuse_on_cpu_with_compiler(True)
+        try:
+            enable_cpu_fuser(fn)(*args, **kwargs)
+        finally:
+            torch._C._jit_override_fuse_on_cpu_with_compiler(False)
+    return wrapper
+
+
 def enable_cpu_fuser_if(cond):
     if cond:
         return enable_cpu_fuser